@@ -0,0 +1,78 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// @file CounterBasedRandom.h
+/// @brief Counter-based random number generator for the ALICE3 fast simulation.
+///        The n-th number of a stream is a hash of (key, n), the SplitMix64 mixing function, such that a stream
+///        is set up for every particle from its indices at no cost and does not depend on what was drawn before.
+///        It derives from TRandom, hence Uniform, Gaus etc. can be used as for gRandom.
+///
+
+#ifndef ALICE3_CORE_COUNTERBASEDRANDOM_H_
+#define ALICE3_CORE_COUNTERBASEDRANDOM_H_
+
+#include <cstdint>
+
+#include "TRandom.h"
+
+namespace o2::delphes
+{
+
+class CounterBasedRandom : public TRandom
+{
+ public:
+  CounterBasedRandom() = default;
+  ~CounterBasedRandom() override = default;
+
+  /// Starts the stream of the given indices (e.g. seed, collision and particle index)
+  void setKey(uint64_t seed, uint64_t index1, uint64_t index2)
+  {
+    mKey = mix(mix(mix(seed) + index1) + index2);
+    mCounter = 0;
+  }
+
+  /// Uniform number in ]0, 1[ with 53 random bits
+  Double_t Rndm() override
+  {
+    const uint64_t bits = mix(mKey + (++mCounter) * kGamma);
+    return ((bits >> 11) + 0.5) * (1. / 9007199254740992.);
+  }
+  void RndmArray(Int_t n, Float_t* array) override
+  {
+    for (Int_t i = 0; i < n; ++i) {
+      array[i] = Rndm();
+    }
+  }
+  void RndmArray(Int_t n, Double_t* array) override
+  {
+    for (Int_t i = 0; i < n; ++i) {
+      array[i] = Rndm();
+    }
+  }
+
+ private:
+  static constexpr uint64_t kGamma = 0x9e3779b97f4a7c15ull;
+  uint64_t mKey = 0;
+  uint64_t mCounter = 0;
+
+  static uint64_t mix(uint64_t z)
+  {
+    z += kGamma;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+  }
+};
+
+} // namespace o2::delphes
+
+#endif // ALICE3_CORE_COUNTERBASEDRANDOM_H_
@@ -36,6 +36,15 @@
 
 #include "ALICE3/Core/DelphesO2TrackSmearer.h"
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
 namespace o2
 {
 namespace delphes
@@ -78,25 +87,20 @@ bool TrackSmearer::loadTable(int pdg, const char* filename, bool forceReload)
     mLUTHeader[ipdg] = nullptr;
     return false;
   }
-  const int nnch = mLUTHeader[ipdg]->nchmap.nbins;
-  const int nrad = mLUTHeader[ipdg]->radmap.nbins;
-  const int neta = mLUTHeader[ipdg]->etamap.nbins;
-  const int npt = mLUTHeader[ipdg]->ptmap.nbins;
-  mLUTEntry[ipdg] = new lutEntry_t****[nnch];
-  for (int inch = 0; inch < nnch; ++inch) {
-    mLUTEntry[ipdg][inch] = new lutEntry_t***[nrad];
-    for (int irad = 0; irad < nrad; ++irad) {
-      mLUTEntry[ipdg][inch][irad] = new lutEntry_t**[neta];
-      for (int ieta = 0; ieta < neta; ++ieta) {
-        mLUTEntry[ipdg][inch][irad][ieta] = new lutEntry_t*[npt];
-        for (int ipt = 0; ipt < npt; ++ipt) {
-          mLUTEntry[ipdg][inch][irad][ieta][ipt] = new lutEntry_t;
-          lutFile.read(reinterpret_cast<char*>(mLUTEntry[ipdg][inch][irad][ieta][ipt]), sizeof(lutEntry_t));
-          if (lutFile.gcount() != sizeof(lutEntry_t)) {
-            std::cout << " --- troubles reading covariance matrix entry for PDG " << pdg << ": " << filename << std::endl;
-            return false;
-          }
-        }
+  auto& lut = mLUT[ipdg];
+  lut.setHeader(*mLUTHeader[ipdg]);
+  if (mUseMemoryMappedTables) {
+    lutFile.close();
+    if (!mapTable(pdg, filename, lut)) {
+      return false;
+    }
+  } else {
+    lut.allocate();
+    for (size_t i = 0; i < lut.nEntries; ++i) {
+      lutFile.read(reinterpret_cast<char*>(&lut.ownEntries[i]), sizeof(lutEntry_t));
+      if (lutFile.gcount() != sizeof(lutEntry_t)) {
+        std::cout << " --- troubles reading covariance matrix entry for PDG " << pdg << ": " << filename << std::endl;
+        return false;
       }
     }
   }
@@ -107,6 +111,37 @@ bool TrackSmearer::loadTable(int pdg, const char* filename, bool forceReload)
   return true;
 }
 
+/*****************************************************************/
+// The entries are used in place from a private read-only mapping of the file: the pages are filled from the page cache,
+// shared by all the processes of the node mapping the same file, and only the pages of the bins actually looked up are read.
+
+bool TrackSmearer::mapTable(int pdg, const char* filename, flatLUT_t& lut)
+{
+  static_assert(sizeof(lutHeader_t) % alignof(lutEntry_t) == 0, "the LUT entries following the header in the file must be aligned");
+  const int fd = open(filename, O_RDONLY);
+  if (fd < 0) {
+    std::cout << " --- cannot open covariance matrix file for PDG " << pdg << ": " << filename << std::endl;
+    return false;
+  }
+  struct stat fileStat;
+  const size_t size = sizeof(lutHeader_t) + lut.nEntries * sizeof(lutEntry_t);
+  if (fstat(fd, &fileStat) != 0 || static_cast<size_t>(fileStat.st_size) < size) {
+    std::cout << " --- troubles reading covariance matrix entry for PDG " << pdg << ": " << filename << std::endl;
+    close(fd);
+    return false;
+  }
+  void* address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd); // the mapping stays valid
+  if (address == MAP_FAILED) {
+    std::cout << " --- cannot map covariance matrix file for PDG " << pdg << ": " << filename << std::endl;
+    return false;
+  }
+  lut.mapping.reset(address, [size](void* mapped) { munmap(mapped, size); });
+  lut.mappedEntries = reinterpret_cast<lutEntry_t*>(static_cast<char*>(address) + sizeof(lutHeader_t));
+  std::cout << " --- mapped covariance matrix table for PDG " << pdg << ": " << filename << std::endl;
+  return true;
+}
+
 /*****************************************************************/
 
 lutEntry_t*
@@ -115,59 +150,68 @@ lutEntry_t*
   auto ipdg = getIndexPDG(pdg);
   if (!mLUTHeader[ipdg])
     return nullptr;
-  auto inch = mLUTHeader[ipdg]->nchmap.find(nch);
-  auto irad = mLUTHeader[ipdg]->radmap.find(radius);
-  auto ieta = mLUTHeader[ipdg]->etamap.find(eta);
-  auto ipt = mLUTHeader[ipdg]->ptmap.find(pt);
+  auto& lut = mLUT[ipdg];
+  auto inch = lut.nchAxis.find(nch);
+  auto irad = lut.radAxis.find(radius);
+  auto ieta = lut.etaAxis.find(eta);
+  auto ipt = lut.ptAxis.find(pt);
+  const size_t index = lut.getIndex(inch, irad, ieta, ipt);
+  lutEntry_t* entries = lut.getEntries();
+  lutEntry_t* entry = &entries[index];
 
   // Interpolate if requested
-  auto fraction = mLUTHeader[ipdg]->nchmap.fracPositionWithinBin(nch);
   if (mInterpolateEfficiency) {
+    // the neighbouring bins in nch are strideNch entries away
+    auto fraction = lut.nchAxis.fracPositionWithinBin(nch);
     if (fraction > 0.5) {
+      const lutEntry_t* next = (inch < lut.nchAxis.nbins - 1) ? &entries[index + lut.strideNch] : nullptr;
       if (mWhatEfficiency == 1) {
-        if (inch < mLUTHeader[ipdg]->nchmap.nbins - 1) {
-          interpolatedEff = (1.5f - fraction) * mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff + (-0.5f + fraction) * mLUTEntry[ipdg][inch + 1][irad][ieta][ipt]->eff;
+        if (next) {
+          interpolatedEff = (1.5f - fraction) * entry->eff + (-0.5f + fraction) * next->eff;
         } else {
-          interpolatedEff = mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff;
+          interpolatedEff = entry->eff;
         }
       }
       if (mWhatEfficiency == 2) {
-        if (inch < mLUTHeader[ipdg]->nchmap.nbins - 1) {
-          interpolatedEff = (1.5f - fraction) * mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff2 + (-0.5f + fraction) * mLUTEntry[ipdg][inch + 1][irad][ieta][ipt]->eff2;
+        if (next) {
+          interpolatedEff = (1.5f - fraction) * entry->eff2 + (-0.5f + fraction) * next->eff2;
         } else {
-          interpolatedEff = mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff2;
+          interpolatedEff = entry->eff2;
         }
       }
     } else {
-      float comparisonValue = mLUTHeader[ipdg]->nchmap.log ? log10(nch) : nch;
+      float comparisonValue = lut.nchAxis.log ? log10(nch) : nch;
+      const lutEntry_t* previous = (inch > 0 && comparisonValue < lut.nchAxis.max) ? &entries[index - lut.strideNch] : nullptr;
       if (mWhatEfficiency == 1) {
-        if (inch > 0 && comparisonValue < mLUTHeader[ipdg]->nchmap.max) {
-          interpolatedEff = (0.5f + fraction) * mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff + (0.5f - fraction) * mLUTEntry[ipdg][inch - 1][irad][ieta][ipt]->eff;
+        if (previous) {
+          interpolatedEff = (0.5f + fraction) * entry->eff + (0.5f - fraction) * previous->eff;
         } else {
-          interpolatedEff = mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff;
+          interpolatedEff = entry->eff;
         }
       }
       if (mWhatEfficiency == 2) {
-        if (inch > 0 && comparisonValue < mLUTHeader[ipdg]->nchmap.max) {
-          interpolatedEff = (0.5f + fraction) * mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff2 + (0.5f - fraction) * mLUTEntry[ipdg][inch - 1][irad][ieta][ipt]->eff2;
+        if (previous) {
+          interpolatedEff = (0.5f + fraction) * entry->eff2 + (0.5f - fraction) * previous->eff2;
         } else {
-          interpolatedEff = mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff2;
+          interpolatedEff = entry->eff2;
         }
       }
     }
   } else {
     if (mWhatEfficiency == 1)
-      interpolatedEff = mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff;
+      interpolatedEff = entry->eff;
     if (mWhatEfficiency == 2)
-      interpolatedEff = mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff2;
+      interpolatedEff = entry->eff2;
   }
-  return mLUTEntry[ipdg][inch][irad][ieta][ipt];
+  return entry;
 } //;
 
 /*****************************************************************/
 
-bool TrackSmearer::smearTrack(O2Track& o2track, lutEntry_t* lutEntry, float interpolatedEff)
+bool TrackSmearer::smearTrack(O2Track& o2track, lutEntry_t* lutEntry, float interpolatedEff, TRandom* random)
 {
+  if (!random)
+    random = gRandom;
   bool isReconstructed = true;
   // generate efficiency
   if (mUseEfficiency) {
@@ -178,7 +222,7 @@ bool TrackSmearer::smearTrack(O2Track& o2track, lutEntry_t* lutEntry, float inte
       eff = lutEntry->eff2;
     if (mInterpolateEfficiency)
       eff = interpolatedEff;
-    if (gRandom->Uniform() > eff)
+    if (random->Uniform() > eff)
       isReconstructed = false;
   }
 
@@ -192,7 +236,7 @@ bool TrackSmearer::smearTrack(O2Track& o2track, lutEntry_t* lutEntry, float inte
     double val = 0.;
     for (int j = 0; j < 5; ++j)
       val += lutEntry->eigvec[j][i] * o2track.getParam(j);
-    params_[i] = gRandom->Gaus(val, sqrt(lutEntry->eigval[i]));
+    params_[i] = random->Gaus(val, sqrt(lutEntry->eigval[i]));
   }
   // transform back params vector
   for (int i = 0; i < 5; ++i) {
@@ -213,7 +257,7 @@ bool TrackSmearer::smearTrack(O2Track& o2track, lutEntry_t* lutEntry, float inte
 
 /*****************************************************************/
 
-bool TrackSmearer::smearTrack(O2Track& o2track, int pdg, float nch)
+bool TrackSmearer::smearTrack(O2Track& o2track, int pdg, float nch, TRandom* random)
 {
 
   auto pt = o2track.getPt();
@@ -225,7 +269,42 @@ bool TrackSmearer::smearTrack(O2Track& o2track, int pdg, float nch)
   auto lutEntry = getLUTEntry(pdg, nch, 0., eta, pt, interpolatedEff);
   if (!lutEntry || !lutEntry->valid)
     return false;
-  return smearTrack(o2track, lutEntry, interpolatedEff);
+  return smearTrack(o2track, lutEntry, interpolatedEff, random);
+}
+
+/*****************************************************************/
+
+size_t TrackSmearer::smearTracks(O2Track* o2tracks, const int* pdgs, size_t n, float nch, bool* isReconstructed)
+{
+  // look up all the entries first, such that the smearing loop only reads the selected entries
+  mBulkEntries.resize(n);
+  mBulkEfficiencies.resize(n);
+  for (size_t i = 0; i < n; ++i) {
+    auto pt = o2tracks[i].getPt();
+    if (abs(pdgs[i]) == 1000020030) {
+      pt *= 2.f;
+    }
+    mBulkEfficiencies[i] = 0.0f;
+    mBulkEntries[i] = getLUTEntry(pdgs[i], nch, 0., o2tracks[i].getEta(), pt, mBulkEfficiencies[i]);
+  }
+  size_t nReconstructed = 0;
+  for (size_t i = 0; i < n; ++i) {
+    const auto lutEntry = mBulkEntries[i];
+    isReconstructed[i] = lutEntry && lutEntry->valid && smearTrack(o2tracks[i], lutEntry, mBulkEfficiencies[i]);
+    if (isReconstructed[i]) {
+      nReconstructed++;
+    }
+  }
+  return nReconstructed;
+}
+
+size_t TrackSmearer::smearTracks(std::vector<O2Track>& o2tracks, const std::vector<int>& pdgs, float nch, std::vector<bool>& isReconstructed)
+{
+  const size_t n = std::min(o2tracks.size(), pdgs.size());
+  std::unique_ptr<bool[]> reconstructed(new bool[n]);
+  const size_t nReconstructed = smearTracks(o2tracks.data(), pdgs.data(), n, nch, reconstructed.get());
+  isReconstructed.assign(reconstructed.get(), reconstructed.get() + n);
+  return nReconstructed;
 }
 
 /*****************************************************************/
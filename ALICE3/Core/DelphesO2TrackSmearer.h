@@ -27,6 +27,8 @@
 #include <map>
 #include <iostream>
 #include <fstream>
+#include <memory>
+#include <vector>
 
 #include "TRandom.h"
 #include "ReconstructionDataFormats/Track.h"
@@ -177,6 +179,8 @@ class TrackSmearer
 
   /** LUT methods **/
   bool loadTable(int pdg, const char* filename, bool forceReload = false);
+  /// Map the LUT files in memory instead of reading them (see loadTable)
+  void useMemoryMappedTables(bool val) { mUseMemoryMappedTables = val; } //;
   void useEfficiency(bool val) { mUseEfficiency = val; }                      //;
   void interpolateEfficiency(bool val) { mInterpolateEfficiency = val; }      //;
   void skipUnreconstructed(bool val) { mSkipUnreconstructed = val; }          //;
@@ -184,8 +188,14 @@ class TrackSmearer
   lutHeader_t* getLUTHeader(int pdg) { return mLUTHeader[getIndexPDG(pdg)]; } //;
   lutEntry_t* getLUTEntry(int pdg, float nch, float radius, float eta, float pt, float& interpolatedEff);
 
-  bool smearTrack(O2Track& o2track, lutEntry_t* lutEntry, float interpolatedEff);
-  bool smearTrack(O2Track& o2track, int pdg, float nch);
+  /// The random numbers are drawn from gRandom, or from random if given (e.g. one generator per thread)
+  bool smearTrack(O2Track& o2track, lutEntry_t* lutEntry, float interpolatedEff, TRandom* random = nullptr);
+  bool smearTrack(O2Track& o2track, int pdg, float nch, TRandom* random = nullptr);
+  /// Smears n tracks of species pdgs[i], as n calls of smearTrack(o2tracks[i], pdgs[i], nch) in the same order (hence with the same random numbers).
+  /// The LUT entries of all tracks are looked up first, then the tracks are smeared. isReconstructed[i] is the return value of smearTrack.
+  /// Returns the number of reconstructed tracks.
+  size_t smearTracks(O2Track* o2tracks, const int* pdgs, size_t n, float nch, bool* isReconstructed);
+  size_t smearTracks(std::vector<O2Track>& o2tracks, const std::vector<int>& pdgs, float nch, std::vector<bool>& isReconstructed);
   // bool smearTrack(Track& track, bool atDCA = true); // Only in DelphesO2
   double getPtRes(int pdg, float nch, float eta, float pt);
   double getEtaRes(int pdg, float nch, float eta, float pt);
@@ -220,9 +230,92 @@ class TrackSmearer
   void setdNdEta(float val) { mdNdEta = val; } //;
 
  protected:
+  /// Binning of one LUT dimension, with the bin width of map_t computed once
+  struct lutAxis_t {
+    int nbins = 1;
+    float min = 0.;
+    float max = 1.e6;
+    float width = 1.e6;
+    bool log = false;
+    void setMap(const map_t& map)
+    {
+      nbins = map.nbins;
+      min = map.min;
+      max = map.max;
+      width = (max - min) / nbins;
+      log = map.log;
+    }
+    // same as map_t::find
+    int find(float val) const
+    {
+      int bin;
+      if (log)
+        bin = static_cast<int>((log10(val) - min) / width);
+      else
+        bin = static_cast<int>((val - min) / width);
+      if (bin < 0)
+        return 0;
+      if (bin > nbins - 1)
+        return nbins - 1;
+      return bin;
+    }
+    // same as map_t::fracPositionWithinBin
+    float fracPositionWithinBin(float val) const
+    {
+      int bin;
+      if (log) {
+        bin = static_cast<int>((log10(val) - min) / width);
+        return ((log10(val) - min) / width) - bin;
+      }
+      bin = static_cast<int>((val - min) / width);
+      return val / width - bin;
+    }
+  };
+
+  /// Entries of one LUT in a single contiguous array, row-major in (nch, radius, eta, pt)
+  /// This is also the layout of the entries in the LUT file, after the header, such that the array is either
+  /// read from the file into ownEntries or is the memory mapping of the file itself.
+  struct flatLUT_t {
+    lutAxis_t nchAxis;
+    lutAxis_t radAxis;
+    lutAxis_t etaAxis;
+    lutAxis_t ptAxis;
+    size_t strideNch = 0; // number of entries per nch bin
+    size_t nEntries = 0;
+    std::vector<lutEntry_t> ownEntries;
+    std::shared_ptr<void> mapping;       // unmaps the file when the last copy of the LUT goes away
+    lutEntry_t* mappedEntries = nullptr; // entries in the mapping, read-only
+    lutEntry_t* getEntries() { return mapping ? mappedEntries : ownEntries.data(); }
+    void setHeader(const lutHeader_t& header)
+    {
+      nchAxis.setMap(header.nchmap);
+      radAxis.setMap(header.radmap);
+      etaAxis.setMap(header.etamap);
+      ptAxis.setMap(header.ptmap);
+      strideNch = static_cast<size_t>(radAxis.nbins) * etaAxis.nbins * ptAxis.nbins;
+      nEntries = strideNch * nchAxis.nbins;
+      ownEntries.clear();
+      mapping.reset();
+      mappedEntries = nullptr;
+    }
+    void allocate()
+    {
+      ownEntries.assign(nEntries, lutEntry_t{});
+    }
+    size_t getIndex(int inch, int irad, int ieta, int ipt) const
+    {
+      return inch * strideNch + (static_cast<size_t>(irad) * etaAxis.nbins + ieta) * ptAxis.nbins + ipt;
+    }
+  };
+
   static constexpr unsigned int nLUTs = 8; // Number of LUT available
   lutHeader_t* mLUTHeader[nLUTs] = {nullptr};
-  lutEntry_t***** mLUTEntry[nLUTs] = {nullptr};
+  flatLUT_t mLUT[nLUTs];
+  std::vector<lutEntry_t*> mBulkEntries; // LUT entries of the tracks of smearTracks
+  std::vector<float> mBulkEfficiencies;  // interpolated efficiencies of the tracks of smearTracks
+
+  bool mapTable(int pdg, const char* filename, flatLUT_t& lut);
+  bool mUseMemoryMappedTables = false;
   bool mUseEfficiency = true;
   bool mInterpolateEfficiency = false;
   bool mSkipUnreconstructed = true; // don't smear tracks that are not reco'ed
@@ -18,6 +18,8 @@
 
 #include "ALICE3/Core/TOFResoALICE3.h"
 
+#include <cmath>
+
 namespace o2::pid::tof
 {
 
@@ -36,4 +38,46 @@ float TOFResoALICE3Param(const float& momentum, const float& momentumError, cons
   return sqrt(etexp * etexp + parameters[0] * parameters[0] + evtimereso * evtimereso);
 }
 
+void TOFExpectedTimesBulk(int nTracks, const float* momentum, const float* length, int nHypotheses, const float* masses, float* expTimes)
+{
+  for (int iHypothesis = 0; iHypothesis < nHypotheses; iHypothesis++) {
+    const float mass2 = masses[iHypothesis] * masses[iHypothesis];
+    float* out = expTimes + iHypothesis * nTracks;
+    for (int i = 0; i < nTracks; i++) {
+      out[i] = length[i] * std::sqrt(mass2 + momentum[i] * momentum[i]) / (kCSPEED * momentum[i]);
+    }
+  }
+}
+
+void TOFResoALICE3ParamBulk(int nTracks, const float* momentum, const float* momentumError, const float* evtimereso, const float* length, int nHypotheses, const float* masses, const Parameters& parameters, float* sigmas)
+{
+  const float reso2 = parameters[0] * parameters[0];
+  for (int iHypothesis = 0; iHypothesis < nHypotheses; iHypothesis++) {
+    const float mass2 = masses[iHypothesis] * masses[iHypothesis];
+    float* out = sigmas + iHypothesis * nTracks;
+    for (int i = 0; i < nTracks; i++) {
+      // same as TOFResoALICE3Param
+      const float p2 = momentum[i] * momentum[i];
+      const float Lc = length[i] / 0.0299792458f;
+      const float ep = momentumError[i] * momentum[i];
+      const float etexp = Lc * mass2 / p2 / std::sqrt(mass2 + p2) * ep;
+      const float sigma = std::sqrt(etexp * etexp + reso2 + evtimereso[i] * evtimereso[i]);
+      out[i] = momentum[i] > 0 ? sigma : -999.f;
+    }
+  }
+}
+
+void TOFNSigmaBulk(int nTracks, const float* times, const char* hasTOF, int nHypotheses, const float* expTimes, const float* sigmas, float* nSigmas)
+{
+  for (int iHypothesis = 0; iHypothesis < nHypotheses; iHypothesis++) {
+    const float* exp = expTimes + iHypothesis * nTracks;
+    const float* sigma = sigmas + iHypothesis * nTracks;
+    float* out = nSigmas + iHypothesis * nTracks;
+    for (int i = 0; i < nTracks; i++) {
+      const float nSigma = (times[i] - exp[i]) / sigma[i];
+      out[i] = hasTOF[i] ? nSigma : -999.f;
+    }
+  }
+}
+
 } // namespace o2::pid::tof
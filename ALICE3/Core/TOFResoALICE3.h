@@ -60,6 +60,19 @@ class TOFResoALICE3 : public Parametrization
 
 float TOFResoALICE3Param(const float& momentum, const float& momentumError, const float& evtimereso, const float& length, const float& mass, const Parameters& parameters);
 
+// Bulk evaluation over the tracks of a dataframe and a set of mass hypotheses, with the inputs as one array per
+// quantity and the outputs stored at [iHypothesis * nTracks + iTrack]. The loops run over the tracks for a fixed
+// hypothesis, without branches, such that they are vectorised by the compiler.
+
+/// Expected times (ps) for the momenta (GeV/c) and track lengths (cm)
+void TOFExpectedTimesBulk(int nTracks, const float* momentum, const float* length, int nHypotheses, const float* masses, float* expTimes);
+
+/// Resolutions of the expected times with the TOFResoALICE3 parametrization, -999 for the tracks with momentum <= 0
+void TOFResoALICE3ParamBulk(int nTracks, const float* momentum, const float* momentumError, const float* evtimereso, const float* length, int nHypotheses, const float* masses, const Parameters& parameters, float* sigmas);
+
+/// Number of sigmas of the measured times (ps, event time subtracted) from the expected times, -999 for the tracks without TOF
+void TOFNSigmaBulk(int nTracks, const float* times, const char* hasTOF, int nHypotheses, const float* expTimes, const float* sigmas, float* nSigmas);
+
 template <o2::track::PID::ID id, typename T>
 float TOFResoALICE3ParamTrack(const T& track, const Parameters& parameters)
 {
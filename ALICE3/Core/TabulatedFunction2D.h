@@ -0,0 +1,117 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// @file TabulatedFunction2D.h
+/// @brief Tabulation of a function of (pt, eta) on a grid in (log10(pt), eta), with bilinear interpolation.
+///        The grid is checked against the function when it is filled: a cell is only used if its corners are finite
+///        and the interpolation reproduces the function within the requested relative accuracy at the centre of the
+///        cell and of its edges. Lookups in the other cells, or out of the grid, fail, and the caller evaluates the
+///        function itself. Used by the on-the-fly PID tasks for the analytic parametrisations of one configuration.
+///
+
+#ifndef ALICE3_CORE_TABULATEDFUNCTION2D_H_
+#define ALICE3_CORE_TABULATEDFUNCTION2D_H_
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace o2::upgrade
+{
+
+class TabulatedFunction2D
+{
+ public:
+  /// Fills the grid with function(pt, eta)
+  /// \param accuracy maximum relative deviation of the interpolation from the function in a usable cell
+  template <typename Function>
+  void tabulate(Function&& function, int nBinsPt, float ptMin, float ptMax, int nBinsEta, float etaMin, float etaMax, float accuracy)
+  {
+    mNBinsPt = nBinsPt;
+    mNBinsEta = nBinsEta;
+    mLogPtMin = std::log10(ptMin);
+    mLogPtWidth = (std::log10(ptMax) - mLogPtMin) / nBinsPt;
+    mEtaMin = etaMin;
+    mEtaWidth = (etaMax - etaMin) / nBinsEta;
+    mValues.resize(static_cast<size_t>(nBinsPt + 1) * (nBinsEta + 1));
+    mValidCells.assign(static_cast<size_t>(nBinsPt) * nBinsEta, 0);
+    for (int iPt = 0; iPt <= nBinsPt; iPt++) {
+      for (int iEta = 0; iEta <= nBinsEta; iEta++) {
+        mValues[getNode(iPt, iEta)] = function(getPt(iPt), mEtaMin + iEta * mEtaWidth);
+      }
+    }
+    mNValidCells = 0;
+    const double fractions[][2] = {{0.5, 0.5}, {0.5, 0.}, {0.5, 1.}, {0., 0.5}, {1., 0.5}};
+    for (int iPt = 0; iPt < nBinsPt; iPt++) {
+      for (int iEta = 0; iEta < nBinsEta; iEta++) {
+        bool isValid = std::isfinite(mValues[getNode(iPt, iEta)]) && std::isfinite(mValues[getNode(iPt + 1, iEta)]) &&
+                       std::isfinite(mValues[getNode(iPt, iEta + 1)]) && std::isfinite(mValues[getNode(iPt + 1, iEta + 1)]);
+        for (const auto& fraction : fractions) {
+          if (!isValid) {
+            break;
+          }
+          const double exact = function(getPt(iPt + fraction[0]), mEtaMin + (iEta + fraction[1]) * mEtaWidth);
+          const double interpolated = interpolate(iPt, iEta, fraction[0], fraction[1]);
+          isValid = std::isfinite(exact) && std::abs(interpolated - exact) <= accuracy * std::abs(exact);
+        }
+        mValidCells[static_cast<size_t>(iPt) * nBinsEta + iEta] = isValid;
+        mNValidCells += isValid;
+      }
+    }
+  }
+
+  /// Interpolated value at (pt, eta), returns false if the point is not in a usable cell
+  bool evaluate(float pt, float eta, double& value) const
+  {
+    if (!(pt > 0.f)) {
+      return false;
+    }
+    const double xPt = (std::log10(pt) - mLogPtMin) / mLogPtWidth;
+    const double xEta = (eta - mEtaMin) / mEtaWidth;
+    if (!(xPt >= 0. && xPt < mNBinsPt && xEta >= 0. && xEta < mNBinsEta)) {
+      return false;
+    }
+    const int iPt = static_cast<int>(xPt);
+    const int iEta = static_cast<int>(xEta);
+    if (!mValidCells[static_cast<size_t>(iPt) * mNBinsEta + iEta]) {
+      return false;
+    }
+    value = interpolate(iPt, iEta, xPt - iPt, xEta - iEta);
+    return true;
+  }
+
+  size_t getNCells() const { return mValidCells.size(); }
+  size_t getNValidCells() const { return mNValidCells; }
+
+ private:
+  int mNBinsPt = 0;
+  int mNBinsEta = 0;
+  double mLogPtMin = 0.;
+  double mLogPtWidth = 1.;
+  double mEtaMin = 0.;
+  double mEtaWidth = 1.;
+  std::vector<double> mValues;      // values at the nodes, eta first
+  std::vector<uint8_t> mValidCells; // whether the interpolation can be used in each cell
+  size_t mNValidCells = 0;
+
+  size_t getNode(int iPt, int iEta) const { return static_cast<size_t>(iPt) * (mNBinsEta + 1) + iEta; }
+  double getPt(double iPt) const { return std::pow(10., mLogPtMin + iPt * mLogPtWidth); }
+  double interpolate(int iPt, int iEta, double fPt, double fEta) const
+  {
+    return (1. - fPt) * ((1. - fEta) * mValues[getNode(iPt, iEta)] + fEta * mValues[getNode(iPt, iEta + 1)]) +
+           fPt * ((1. - fEta) * mValues[getNode(iPt + 1, iEta)] + fEta * mValues[getNode(iPt + 1, iEta + 1)]);
+  }
+};
+
+} // namespace o2::upgrade
+
+#endif // ALICE3_CORE_TABULATEDFUNCTION2D_H_
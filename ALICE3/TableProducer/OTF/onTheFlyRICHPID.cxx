@@ -45,6 +45,7 @@
 
 #include "TableHelper.h"
 #include "ALICE3/Core/DelphesO2TrackSmearer.h"
+#include "ALICE3/Core/TabulatedFunction2D.h"
 
 /// \file onTheFlyRichPid.cxx
 ///
@@ -96,6 +97,11 @@ struct OnTheFlyRichPid {
   Configurable<bool> flagIncludeTrackAngularRes{"flagIncludeTrackAngularRes", true, "flag to include or exclude track time resolution"};
   Configurable<float> multiplicityEtaRange{"multiplicityEtaRange", 0.800000012, "eta range to compute the multiplicity"};
   Configurable<bool> flagRICHLoadDelphesLUTs{"flagRICHLoadDelphesLUTs", false, "flag to load Delphes LUTs for tracking correction (use recoTrack parameters if false)"};
+  Configurable<bool> memoryMappedLUTs{"memoryMappedLUTs", false, "map the LUT files in memory, shared by all processes of the node, instead of reading them"};
+  Configurable<bool> flagTabulateTrackAngularRes{"flagTabulateTrackAngularRes", false, "flag to interpolate the track angular resolution in a table vs (pt, eta) filled at init for this configuration"};
+  Configurable<float> tabulationAccuracy{"tabulationAccuracy", 1.e-3, "maximum relative deviation of the tabulated track angular resolution, computed exactly elsewhere"};
+  Configurable<int> tabulationNBinsPt{"tabulationNBinsPt", 400, "number of log(pt) bins of the track angular resolution table (0.01 < pt < 100 GeV/c)"};
+  Configurable<int> tabulationNBinsEta{"tabulationNBinsEta", 200, "number of eta bins of the track angular resolution table (|eta| < 4)"};
 
   Configurable<std::string> lutEl{"lutEl", "lutCovm.el.dat", "LUT for electrons"};
   Configurable<std::string> lutMu{"lutMu", "lutCovm.mu.dat", "LUT for muons"};
@@ -111,6 +117,10 @@ struct OnTheFlyRichPid {
   // needed: random number generator for smearing
   TRandom3 pRandomNumberGenerator;
 
+  // Derivatives of the Cherenkov angle on pt and eta for each mass hypothesis, if tabulated
+  o2::upgrade::TabulatedFunction2D tabulatedDthetaOnDpt[5];
+  o2::upgrade::TabulatedFunction2D tabulatedDthetaOnDeta[5];
+
   // for handling basic QA histograms if requested
   HistogramRegistry histos{"Histos", {}, OutputObjHandlingPolicy::AnalysisObject};
 
@@ -233,6 +243,7 @@ struct OnTheFlyRichPid {
       mapPdgLut.insert(std::make_pair(321, lutKaChar));
       mapPdgLut.insert(std::make_pair(2212, lutPrChar));
 
+      mSmearer.useMemoryMappedTables(memoryMappedLUTs);
       for (auto e : mapPdgLut) {
         if (!mSmearer.loadTable(e.first, e.second)) {
           LOG(fatal) << "Having issue with loading the LUT " << e.first << " " << e.second;
@@ -240,6 +251,19 @@ struct OnTheFlyRichPid {
       }
     }
 
+    if (flagIncludeTrackAngularRes && flagTabulateTrackAngularRes) {
+      int lpdg_array[5] = {kElectron, kMuonMinus, kPiPlus, kKPlus, kProton};
+      for (int ii = 0; ii < 5; ii++) {
+        const float mass = pdg->GetParticle(lpdg_array[ii])->Mass();
+        // with a unit resolution on one variable and none on the other, the resolution is the absolute derivative
+        tabulatedDthetaOnDpt[ii].tabulate([&](float pt, float eta) { return calculate_track_time_resolution_advanced(pt, eta, 1.f, 0.f, mass, bRichRefractiveIndex); },
+                                          tabulationNBinsPt, 0.01f, 100.f, tabulationNBinsEta, -4.f, 4.f, tabulationAccuracy);
+        tabulatedDthetaOnDeta[ii].tabulate([&](float pt, float eta) { return calculate_track_time_resolution_advanced(pt, eta, 0.f, 1.f, mass, bRichRefractiveIndex); },
+                                           tabulationNBinsPt, 0.01f, 100.f, tabulationNBinsEta, -4.f, 4.f, tabulationAccuracy);
+        LOGF(info, "Tabulated track angular resolution, hypothesis %d: %zu/%zu cells within accuracy", ii, tabulatedDthetaOnDpt[ii].getNValidCells(), tabulatedDthetaOnDpt[ii].getNCells());
+      }
+    }
+
     if (doQAplots) {
       const AxisSpec axisMomentum{static_cast<int>(nBinsP), 0.0f, +20.0f, "#it{p} (GeV/#it{c})"};
       const AxisSpec axisAngle{static_cast<int>(nBinsThetaRing), 0.0f, +0.30f, "Measured Cherenkov angle (rad)"};
@@ -428,6 +452,17 @@ struct OnTheFlyRichPid {
     return track_angular_resolution;
   }
 
+  /// returns track angular resolution, interpolated in the tables if they are filled and accurate at this (pt, eta)
+  /// \param iHypothesis the index of the mass hypothesis
+  double trackAngularResolution(int iHypothesis, float pt, float eta, float track_pt_resolution, float track_eta_resolution, float mass)
+  {
+    double dtheta_on_dpt = 0., dtheta_on_deta = 0.;
+    if (flagTabulateTrackAngularRes && tabulatedDthetaOnDpt[iHypothesis].evaluate(pt, eta, dtheta_on_dpt) && tabulatedDthetaOnDeta[iHypothesis].evaluate(pt, eta, dtheta_on_deta)) {
+      return std::hypot(dtheta_on_dpt * track_pt_resolution, dtheta_on_deta * track_eta_resolution);
+    }
+    return calculate_track_time_resolution_advanced(pt, eta, track_pt_resolution, track_eta_resolution, mass, bRichRefractiveIndex);
+  }
+
   void process(soa::Join<aod::Collisions, aod::McCollisionLabels>::iterator const& collision, soa::Join<aod::Tracks, aod::TracksCov, aod::McTrackLabels> const& tracks, aod::McParticles const&, aod::McCollisions const&)
   {
 
@@ -531,7 +566,7 @@ struct OnTheFlyRichPid {
             eta_resolution = mSmearer.getAbsEtaRes(pdgInfoThis->PdgCode(), dNdEta, recoTrack.getEta(), recoTrack.getP() / std::cosh(recoTrack.getEta()));
           }
           // cout << endl <<  "Pt resolution: " << pt_resolution << ", Eta resolution: " << eta_resolution << endl << endl;
-          float barrelTrackAngularReso = calculate_track_time_resolution_advanced(recoTrack.getP() / std::cosh(recoTrack.getEta()), recoTrack.getEta(), pt_resolution, eta_resolution, masses[ii], bRichRefractiveIndex);
+          float barrelTrackAngularReso = trackAngularResolution(ii, recoTrack.getP() / std::cosh(recoTrack.getEta()), recoTrack.getEta(), pt_resolution, eta_resolution, masses[ii]);
           barrelTotalAngularReso = std::hypot(barrelRICHAngularResolution, barrelTrackAngularReso);
           if (doQAplots && hypothesisAngleBarrelRich > error_value + 1. && measuredAngleBarrelRich > error_value + 1. && barrelRICHAngularResolution > error_value + 1. && flagReachesRadiator) {
             float momentum = recoTrack.getP();
@@ -41,6 +41,8 @@
 #include "DetectorsVertexing/HelixHelper.h"
 #include "TableHelper.h"
 #include "ALICE3/Core/DelphesO2TrackSmearer.h"
+#include "ALICE3/Core/TOFResoALICE3.h"
+#include "ALICE3/Core/TabulatedFunction2D.h"
 
 /// \file onTheFlyTOFPID.cxx
 ///
@@ -87,6 +89,11 @@ struct OnTheFlyTOFPID {
   Configurable<bool> flagIncludeTrackTimeRes{"flagIncludeTrackTimeRes", true, "flag to include or exclude track time resolution"};
   Configurable<float> multiplicityEtaRange{"multiplicityEtaRange", 0.800000012, "eta range to compute the multiplicity"};
   Configurable<bool> flagTOFLoadDelphesLUTs{"flagTOFLoadDelphesLUTs", false, "flag to load Delphes LUTs for tracking correction (use recoTrack parameters if false)"};
+  Configurable<bool> memoryMappedLUTs{"memoryMappedLUTs", false, "map the LUT files in memory, shared by all processes of the node, instead of reading them"};
+  Configurable<bool> flagTabulateTrackTimeRes{"flagTabulateTrackTimeRes", false, "flag to interpolate the track time resolution in a table vs (pt, eta) filled at init for this configuration"};
+  Configurable<float> tabulationAccuracy{"tabulationAccuracy", 1.e-3, "maximum relative deviation of the tabulated track time resolution, computed exactly elsewhere"};
+  Configurable<int> tabulationNBinsPt{"tabulationNBinsPt", 400, "number of log(pt) bins of the track time resolution table (0.01 < pt < 100 GeV/c)"};
+  Configurable<int> tabulationNBinsEta{"tabulationNBinsEta", 200, "number of eta bins of the track time resolution table (|eta| < 4)"};
 
   Configurable<std::string> lutEl{"lutEl", "lutCovm.el.dat", "LUT for electrons"};
   Configurable<std::string> lutMu{"lutMu", "lutCovm.mu.dat", "LUT for muons"};
@@ -102,6 +109,10 @@ struct OnTheFlyTOFPID {
   // needed: random number generator for smearing
   TRandom3 pRandomNumberGenerator;
 
+  // Derivatives of the time of flight on pt and eta for each layer (inner, outer) and mass hypothesis, if tabulated
+  o2::upgrade::TabulatedFunction2D tabulatedDtofOnDpt[2][5];
+  o2::upgrade::TabulatedFunction2D tabulatedDtofOnDeta[2][5];
+
   // for handling basic QA histograms if requested
   HistogramRegistry histos{"Histos", {}, OutputObjHandlingPolicy::AnalysisObject};
 
@@ -130,6 +141,7 @@ struct OnTheFlyTOFPID {
       mapPdgLut.insert(std::make_pair(321, lutKaChar));
       mapPdgLut.insert(std::make_pair(2212, lutPrChar));
 
+      mSmearer.useMemoryMappedTables(memoryMappedLUTs);
       for (auto e : mapPdgLut) {
         if (!mSmearer.loadTable(e.first, e.second)) {
           LOG(fatal) << "Having issue with loading the LUT " << e.first << " " << e.second;
@@ -137,6 +149,22 @@ struct OnTheFlyTOFPID {
       }
     }
 
+    if (flagIncludeTrackTimeRes && flagTabulateTrackTimeRes) {
+      int lpdg_array[5] = {kElectron, kMuonMinus, kPiPlus, kKPlus, kProton};
+      float radii[2] = {innerTOFRadius, outerTOFRadius};
+      for (int iLayer = 0; iLayer < 2; iLayer++) {
+        for (int ii = 0; ii < 5; ii++) {
+          const float mass = pdg->GetParticle(lpdg_array[ii])->Mass();
+          // with a unit resolution on one variable and none on the other, the resolution is the absolute derivative
+          tabulatedDtofOnDpt[iLayer][ii].tabulate([&](float pt, float eta) { return calculate_track_time_resolution_advanced(pt, eta, 1.f, 0.f, mass, radii[iLayer], dBz); },
+                                                  tabulationNBinsPt, 0.01f, 100.f, tabulationNBinsEta, -4.f, 4.f, tabulationAccuracy);
+          tabulatedDtofOnDeta[iLayer][ii].tabulate([&](float pt, float eta) { return calculate_track_time_resolution_advanced(pt, eta, 0.f, 1.f, mass, radii[iLayer], dBz); },
+                                                   tabulationNBinsPt, 0.01f, 100.f, tabulationNBinsEta, -4.f, 4.f, tabulationAccuracy);
+          LOGF(info, "Tabulated track time resolution, layer %d, hypothesis %d: %zu/%zu cells within accuracy", iLayer, ii, tabulatedDtofOnDpt[iLayer][ii].getNValidCells(), tabulatedDtofOnDpt[iLayer][ii].getNCells());
+        }
+      }
+    }
+
     if (doQAplots) {
       const AxisSpec axisMomentum{static_cast<int>(nBinsP), 0.0f, +4.0f, "#it{p} (GeV/#it{c})"};
       const AxisSpec axisMomentumSmall{static_cast<int>(nBinsP), 0.0f, +1.0f, "#it{p} (GeV/#it{c})"};
@@ -319,6 +347,18 @@ struct OnTheFlyTOFPID {
     return track_time_resolution;
   }
 
+  /// returns track time resolution, interpolated in the tables if they are filled and accurate at this (pt, eta)
+  /// \param iLayer the TOF layer (0 inner, 1 outer)
+  /// \param iHypothesis the index of the mass hypothesis
+  double trackTimeResolution(int iLayer, int iHypothesis, float pt, float eta, float track_pt_resolution, float track_eta_resolution, float mass, float det_radius)
+  {
+    double dtof_on_dpt = 0., dtof_on_deta = 0.;
+    if (flagTabulateTrackTimeRes && tabulatedDtofOnDpt[iLayer][iHypothesis].evaluate(pt, eta, dtof_on_dpt) && tabulatedDtofOnDeta[iLayer][iHypothesis].evaluate(pt, eta, dtof_on_deta)) {
+      return std::hypot(dtof_on_dpt * track_pt_resolution, dtof_on_deta * track_eta_resolution);
+    }
+    return calculate_track_time_resolution_advanced(pt, eta, track_pt_resolution, track_eta_resolution, mass, det_radius, dBz);
+  }
+
   void process(soa::Join<aod::Collisions, aod::McCollisionLabels>::iterator const& collision, soa::Join<aod::Tracks, aod::TracksCov, aod::McTrackLabels> const& tracks, aod::McParticles const&, aod::McCollisions const&)
   {
     o2::dataformats::VertexBase pvVtx({collision.posX(), collision.posY(), collision.posZ()},
@@ -403,6 +443,14 @@ struct OnTheFlyTOFPID {
       float deltaTimeOuterTOF[5], nSigmaOuterTOF[5];
       int lpdg_array[5] = {kElectron, kMuonMinus, kPiPlus, kKPlus, kProton};
       float masses[5];
+      for (int ii = 0; ii < 5; ii++) {
+        masses[ii] = pdg->GetParticle(lpdg_array[ii])->Mass();
+      }
+      // expected times of the mass hypotheses at the two layers, stored at [hypothesis * 2 + layer]
+      const float recoMomentum[2] = {recoTrack.getP(), recoTrack.getP()};
+      const float recoLengths[2] = {trackLengthRecoInnerTOF, trackLengthRecoOuterTOF};
+      float expectedTimes[10];
+      o2::pid::tof::TOFExpectedTimesBulk(2, recoMomentum, recoLengths, 5, masses, expectedTimes);
 
       if (doQAplots) {
         float momentum = recoTrack.getP();
@@ -426,9 +474,8 @@ struct OnTheFlyTOFPID {
         nSigmaOuterTOF[ii] = -100;
 
         auto pdgInfoThis = pdg->GetParticle(lpdg_array[ii]);
-        masses[ii] = pdgInfoThis->Mass();
-        deltaTimeInnerTOF[ii] = trackLengthRecoInnerTOF / velocity(recoTrack.getP(), masses[ii]) - measuredTimeInnerTOF;
-        deltaTimeOuterTOF[ii] = trackLengthRecoOuterTOF / velocity(recoTrack.getP(), masses[ii]) - measuredTimeOuterTOF;
+        deltaTimeInnerTOF[ii] = expectedTimes[ii * 2] - measuredTimeInnerTOF;
+        deltaTimeOuterTOF[ii] = expectedTimes[ii * 2 + 1] - measuredTimeOuterTOF;
 
         // Evaluate total sigma (layer + tracking resolution)
         float innerTotalTimeReso = innerTOFTimeReso;
@@ -440,8 +487,8 @@ struct OnTheFlyTOFPID {
             pt_resolution = mSmearer.getAbsPtRes(pdgInfoThis->PdgCode(), dNdEta, recoTrack.getEta(), recoTrack.getP() / std::cosh(recoTrack.getEta()));
             eta_resolution = mSmearer.getAbsEtaRes(pdgInfoThis->PdgCode(), dNdEta, recoTrack.getEta(), recoTrack.getP() / std::cosh(recoTrack.getEta()));
           }
-          float innerTrackTimeReso = calculate_track_time_resolution_advanced(recoTrack.getP() / std::cosh(recoTrack.getEta()), recoTrack.getEta(), pt_resolution, eta_resolution, masses[ii], innerTOFRadius, dBz);
-          float outerTrackTimeReso = calculate_track_time_resolution_advanced(recoTrack.getP() / std::cosh(recoTrack.getEta()), recoTrack.getEta(), pt_resolution, eta_resolution, masses[ii], outerTOFRadius, dBz);
+          float innerTrackTimeReso = trackTimeResolution(0, ii, recoTrack.getP() / std::cosh(recoTrack.getEta()), recoTrack.getEta(), pt_resolution, eta_resolution, masses[ii], innerTOFRadius);
+          float outerTrackTimeReso = trackTimeResolution(1, ii, recoTrack.getP() / std::cosh(recoTrack.getEta()), recoTrack.getEta(), pt_resolution, eta_resolution, masses[ii], outerTOFRadius);
           innerTotalTimeReso = std::hypot(innerTOFTimeReso, innerTrackTimeReso);
           outerTotalTimeReso = std::hypot(outerTOFTimeReso, outerTrackTimeReso);
 
@@ -23,7 +23,10 @@
 /// \author Roberto Preghenella preghenella@bo.infn.it
 ///
 
+#include <algorithm>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #include <TGeoGlobalMagField.h>
 
@@ -43,6 +46,7 @@
 #include "Field/MagneticField.h"
 
 #include "ALICE3/Core/DelphesO2TrackSmearer.h"
+#include "ALICE3/Core/CounterBasedRandom.h"
 #include "ALICE3/DataModel/collisionAlice3.h"
 #include "ALICE3/DataModel/tracksAlice3.h"
 
@@ -74,12 +78,17 @@ struct OnTheFlyTracker {
   Configurable<bool> enableNucleiSmearing{"enableNucleiSmearing", false, "Enable smearing of nuclei"};
   Configurable<bool> enablePrimaryVertexing{"enablePrimaryVertexing", true, "Enable primary vertexing"};
   Configurable<bool> interpolateLutEfficiencyVsNch{"interpolateLutEfficiencyVsNch", true, "interpolate LUT efficiency as f(Nch)"};
+  Configurable<bool> memoryMappedLUTs{"memoryMappedLUTs", false, "map the LUT files in memory, shared by all processes of the node, instead of reading them"};
 
   Configurable<bool> populateTracksDCA{"populateTracksDCA", true, "populate TracksDCA table"};
   Configurable<bool> populateTracksExtra{"populateTracksExtra", false, "populate TracksExtra table (legacy)"};
   Configurable<bool> populateTrackSelection{"populateTrackSelection", false, "populate TrackSelection table (legacy)"};
 
   Configurable<bool> processUnreconstructedTracks{"processUnreconstructedTracks", false, "process (smear) unreco-ed tracks"};
+  Configurable<bool> useCounterBasedRandom{"useCounterBasedRandom", false, "smear each particle with a random stream of (collision, particle index), reproducible for any number of threads"};
+  Configurable<int> counterBasedRandomSeed{"counterBasedRandomSeed", 0, "seed of the counter-based random streams"};
+  Configurable<int> nThreadsSmearing{"nThreadsSmearing", 1, "number of threads for the smearing of the particles of a collision (with useCounterBasedRandom)"};
+  Configurable<int> minParticlesPerThread{"minParticlesPerThread", 100, "minimum number of particles smeared per thread"};
   Configurable<bool> doExtraQA{"doExtraQA", false, "do extra 2D QA plots"};
   Configurable<bool> extraQAwithoutDecayDaughters{"extraQAwithoutDecayDaughters", false, "remove decay daughters from qa plots (yes/no)"};
 
@@ -128,6 +137,19 @@ struct OnTheFlyTracker {
   // Track smearer
   o2::delphes::DelphesO2TrackSmearer mSmearer;
 
+  // Particle of a collision to be smeared, in the counter-based random mode
+  struct SmearingCandidate {
+    o2::track::TrackParCov trackParCov;
+    int pdgCode;
+    float mcPt;
+    int64_t mcLabel;
+    bool isDecayDaughter;
+    bool reconstructed;
+    float time;
+  };
+  std::vector<SmearingCandidate> smearingCandidates;
+  std::vector<o2::delphes::CounterBasedRandom> randomStreams; // one per thread
+
   // For processing and vertexing
   std::vector<TrackAlice3> tracksAlice3;
   std::vector<TrackAlice3> ghostTracksAlice3;
@@ -165,6 +187,7 @@ struct OnTheFlyTracker {
         mapPdgLut.insert(std::make_pair(1000010030, lutTrChar));
         mapPdgLut.insert(std::make_pair(1000020030, lutHe3Char));
       }
+      mSmearer.useMemoryMappedTables(memoryMappedLUTs);
       for (auto e : mapPdgLut) {
         if (!mSmearer.loadTable(e.first, e.second)) {
           LOG(fatal) << "Having issue with loading the LUT " << e.first << " " << e.second;
@@ -177,6 +200,11 @@ struct OnTheFlyTracker {
       mSmearer.skipUnreconstructed(static_cast<bool>(!processUnreconstructedTracks));
     }
 
+    if (useCounterBasedRandom) {
+      randomStreams.resize(std::max(static_cast<int>(nThreadsSmearing), 1));
+      LOGF(info, "Smearing with counter-based random numbers and up to %zu threads", randomStreams.size());
+    }
+
     // Basic QA
     histos.add("hPtGenerated", "hPtGenerated", kTH1F, {axisMomentum});
     histos.add("hPtGeneratedEl", "hPtGeneratedEl", kTH1F, {axisMomentum});
@@ -263,12 +291,67 @@ struct OnTheFlyTracker {
     new (&o2track)(o2::track::TrackParCov)(x, particle.phi(), params, covm);
   }
 
+  /// Fills the QA of a smeared track and keeps it for the vertexing and the output tables
+  void addSmearedTrack(o2::track::TrackParCov const& trackParCov, int pdgCode, float mcPt, int64_t mcLabel, bool reconstructed, float t, bool isDecayDaughter)
+  {
+    // Base QA (note: reco pT here)
+    histos.fill(HIST("hPtReconstructed"), trackParCov.getPt());
+    if (TMath::Abs(pdgCode) == 11)
+      histos.fill(HIST("hPtReconstructedEl"), mcPt);
+    if (TMath::Abs(pdgCode) == 211)
+      histos.fill(HIST("hPtReconstructedPi"), mcPt);
+    if (TMath::Abs(pdgCode) == 321)
+      histos.fill(HIST("hPtReconstructedKa"), mcPt);
+    if (TMath::Abs(pdgCode) == 2212)
+      histos.fill(HIST("hPtReconstructedPr"), mcPt);
+
+    if (doExtraQA) {
+      histos.fill(HIST("hRecoTrackX"), trackParCov.getX());
+    }
+
+    // populate vector with track if we reco-ed it
+    if (reconstructed) {
+      tracksAlice3.push_back(TrackAlice3{trackParCov, mcLabel, t, 100.f * 1e-3, isDecayDaughter});
+    } else {
+      ghostTracksAlice3.push_back(TrackAlice3{trackParCov, mcLabel, t, 100.f * 1e-3, isDecayDaughter});
+    }
+  }
+
+  /// Smears the candidates of a collision in contiguous ranges, the first one in this thread
+  /// Each particle draws from its own stream of (collision, particle index), independently of the range it is in.
+  /// The LUTs are only read by the smearing, the QA and the tables are filled afterwards in the order of the particles.
+  void smearCandidates(int64_t collisionIndex, double collisionTimeNS)
+  {
+    const int nCandidates = smearingCandidates.size();
+    const int nThreads = std::clamp(nCandidates / std::max(static_cast<int>(minParticlesPerThread), 1), 1, static_cast<int>(randomStreams.size()));
+    const int nCandidatesPerThread = (nCandidates + nThreads - 1) / nThreads;
+    auto smearRange = [&](int iThread) {
+      auto& random = randomStreams[iThread];
+      const int last = std::min(nCandidates, (iThread + 1) * nCandidatesPerThread);
+      for (int i = iThread * nCandidatesPerThread; i < last; i++) {
+        auto& candidate = smearingCandidates[i];
+        random.setKey(counterBasedRandomSeed, collisionIndex, candidate.mcLabel);
+        candidate.reconstructed = mSmearer.smearTrack(candidate.trackParCov, candidate.pdgCode, dNdEta, &random);
+        candidate.time = (collisionTimeNS + random.Gaus(0., 100.)) * 1e-3;
+      }
+    };
+    std::vector<std::thread> threads;
+    for (int iThread = 1; iThread < nThreads; iThread++) {
+      threads.emplace_back(smearRange, iThread);
+    }
+    smearRange(0);
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
   float dNdEta = 0.f; // Charged particle multiplicity to use in the efficiency evaluation
   void process(aod::McCollision const& mcCollision, aod::McParticles const& mcParticles)
   {
     tracksAlice3.clear();
     ghostTracksAlice3.clear();
     bcData.clear();
+    smearingCandidates.clear();
 
     o2::dataformats::DCA dcaInfo;
     o2::dataformats::VertexBase vtx;
@@ -342,6 +425,12 @@ struct OnTheFlyTracker {
         histos.fill(HIST("hSimTrackX"), trackParCov.getX());
       }
 
+      if (useCounterBasedRandom) {
+        // smeared after the loop, possibly in parallel
+        smearingCandidates.push_back(SmearingCandidate{trackParCov, mcParticle.pdgCode(), mcParticle.pt(), mcParticle.globalIndex(), isDecayDaughter, false, 0.f});
+        continue;
+      }
+
       bool reconstructed = mSmearer.smearTrack(trackParCov, mcParticle.pdgCode(), dNdEta);
       if (!reconstructed && !processUnreconstructedTracks) {
         continue;
@@ -350,28 +439,21 @@ struct OnTheFlyTracker {
         // capture rare smearing mistakes / corrupted tracks
         continue;
       }
-
-      // Base QA (note: reco pT here)
-      histos.fill(HIST("hPtReconstructed"), trackParCov.getPt());
-      if (TMath::Abs(mcParticle.pdgCode()) == 11)
-        histos.fill(HIST("hPtReconstructedEl"), mcParticle.pt());
-      if (TMath::Abs(mcParticle.pdgCode()) == 211)
-        histos.fill(HIST("hPtReconstructedPi"), mcParticle.pt());
-      if (TMath::Abs(mcParticle.pdgCode()) == 321)
-        histos.fill(HIST("hPtReconstructedKa"), mcParticle.pt());
-      if (TMath::Abs(mcParticle.pdgCode()) == 2212)
-        histos.fill(HIST("hPtReconstructedPr"), mcParticle.pt());
-
-      if (doExtraQA) {
-        histos.fill(HIST("hRecoTrackX"), trackParCov.getX());
-      }
-
-      // populate vector with track if we reco-ed it
       const float t = (ir.timeInBCNS + gRandom->Gaus(0., 100.)) * 1e-3;
-      if (reconstructed) {
-        tracksAlice3.push_back(TrackAlice3{trackParCov, mcParticle.globalIndex(), t, 100.f * 1e-3, isDecayDaughter});
-      } else {
-        ghostTracksAlice3.push_back(TrackAlice3{trackParCov, mcParticle.globalIndex(), t, 100.f * 1e-3, isDecayDaughter});
+      addSmearedTrack(trackParCov, mcParticle.pdgCode(), mcParticle.pt(), mcParticle.globalIndex(), reconstructed, t, isDecayDaughter);
+    }
+
+    if (useCounterBasedRandom) {
+      smearCandidates(mcCollision.globalIndex(), ir.timeInBCNS);
+      for (const auto& candidate : smearingCandidates) {
+        if (!candidate.reconstructed && !processUnreconstructedTracks) {
+          continue;
+        }
+        if (TMath::IsNaN(candidate.trackParCov.getZ())) {
+          // capture rare smearing mistakes / corrupted tracks
+          continue;
+        }
+        addSmearedTrack(candidate.trackParCov, candidate.pdgCode, candidate.mcPt, candidate.mcLabel, candidate.reconstructed, candidate.time, candidate.isDecayDaughter);
       }
     }
 
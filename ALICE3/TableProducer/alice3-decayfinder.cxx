@@ -23,6 +23,7 @@
 #include <map>
 #include <iterator>
 #include <utility>
+#include <vector>
 
 #include "Framework/runDataProcessing.h"
 #include "Framework/RunningWorkflowInfo.h"
@@ -217,6 +218,7 @@ struct alice3decayFinder {
   Configurable<bool> doDCAplotsLc{"doDCAplotsLc", true, "do daughter prong DCA plots for Lc baryons"};
   Configurable<bool> mcSameMotherCheck{"mcSameMotherCheck", true, "check if tracks come from the same MC mother"};
   Configurable<float> dcaDaughtersSelection{"dcaDaughtersSelection", 1000.0f, "DCA between daughters (cm)"};
+  Configurable<float> maxDCAStraightLines{"maxDCAStraightLines", -1.0f, "prefilter before the fit: max. DCA between the daughter tracks as straight lines from their DCA to the PV (cm), negative: no prefilter"};
 
   Configurable<float> piFromD_dcaXYconstant{"piFromD_dcaXYconstant", -1.0f, "[0] in |DCAxy| > [0]+[1]/pT"};
   Configurable<float> piFromD_dcaXYpTdep{"piFromD_dcaXYpTdep", 0.0, "[1] in |DCAxy| > [0]+[1]/pT"};
@@ -298,6 +300,59 @@ struct alice3decayFinder {
     float eta;
   } lcbaryon;
 
+  // stages of the candidate selection, the combinations passing each stage are counted
+  enum CandidateStage { kStageAll = 0,
+                        kStagePrefilter,
+                        kStageSameMother,
+                        kStageFit,
+                        kStageDCADaughters,
+                        kNCandidateStages };
+  std::array<double, kNCandidateStages> candidateStages;
+
+  // Track as a straight line from its reference point, the point of closest approach to the PV for the ALICE3 tracks.
+  // Over the decay lengths of the charm hadrons the curvature is negligible, hence the DCA between the lines is a cheap
+  // prefilter on the DCA between the daughters, computed before the fit from the lines filled once per collision.
+  struct TrackLine {
+    std::array<float, 3> xyz;
+    std::array<float, 3> direction;
+  };
+  std::vector<TrackLine> linesProng0;
+  std::vector<TrackLine> linesProng1;
+  std::vector<TrackLine> linesProng2;
+
+  template <typename TTracks>
+  void fillTrackLines(TTracks const& tracks, std::vector<TrackLine>& lines)
+  {
+    lines.clear();
+    if (maxDCAStraightLines < 0.f)
+      return;
+    for (auto const& track : tracks) {
+      auto trackPar = getTrackPar(track);
+      TrackLine line;
+      trackPar.getXYZGlo(line.xyz);
+      trackPar.getPxPyPzGlo(line.direction);
+      lines.push_back(line);
+    }
+  }
+
+  /// whether the straight lines of the tracks at the given positions pass the prefilter
+  bool passStraightLinePrefilter(std::vector<TrackLine> const& lines0, int i0, std::vector<TrackLine> const& lines1, int i1)
+  {
+    if (maxDCAStraightLines < 0.f)
+      return true;
+    const TrackLine& line0 = lines0[i0];
+    const TrackLine& line1 = lines1[i1];
+    const std::array<float, 3> distance = {line1.xyz[0] - line0.xyz[0], line1.xyz[1] - line0.xyz[1], line1.xyz[2] - line0.xyz[2]};
+    const auto normal = RecoDecay::crossProd(line0.direction, line1.direction);
+    const double normal2 = RecoDecay::mag2(normal);
+    if (normal2 < 1e-12 * RecoDecay::mag2(line0.direction) * RecoDecay::mag2(line1.direction)) {
+      // parallel lines: distance of the reference point of track 1 to line 0
+      return RecoDecay::mag2(RecoDecay::crossProd(distance, line0.direction)) < maxDCAStraightLines * maxDCAStraightLines * RecoDecay::mag2(line0.direction);
+    }
+    const double projection = RecoDecay::dotProd(distance, normal);
+    return projection * projection < maxDCAStraightLines * maxDCAStraightLines * normal2;
+  }
+
   template <typename TTrackType>
   bool buildDecayCandidateTwoBody(TTrackType const& posTrackRow, TTrackType const& negTrackRow, float posMass, float negMass)
   {
@@ -315,6 +370,7 @@ struct alice3decayFinder {
     if (nCand == 0) {
       return false;
     }
+    candidateStages[kStageFit]++;
     //}-{}-{}-{}-{}-{}-{}-{}-{}-{}
 
     posTrack = fitter.getTrack(0);
@@ -327,6 +383,7 @@ struct alice3decayFinder {
     float dcaDau = TMath::Sqrt(fitter.getChi2AtPCACandidate());
     if (dcaDau > dcaDaughtersSelection)
       return false;
+    candidateStages[kStageDCADaughters]++;
 
     // return mass
     dmeson.mass = RecoDecay::m(array{array{posP[0], posP[1], posP[2]}, array{negP[0], negP[1], negP[2]}}, array{posMass, negMass});
@@ -353,6 +410,7 @@ struct alice3decayFinder {
     if (nCand == 0) {
       return false;
     }
+    candidateStages[kStageFit]++;
     //}-{}-{}-{}-{}-{}-{}-{}-{}-{}
 
     t0 = fitter.getTrack(0);
@@ -368,6 +426,7 @@ struct alice3decayFinder {
     float dcaDau = TMath::Sqrt(fitter3.getChi2AtPCACandidate());
     if (dcaDau > dcaDaughtersSelection)
       return false;
+    candidateStages[kStageDCADaughters]++;
 
     // return mass
     lcbaryon.mass = RecoDecay::m(array{array{P0[0], P0[1], P0[2]}, array{P1[0], P1[1], P1[2]}, array{P2[0], P2[1], P2[2]}}, array{p0mass, p1mass, p2mass});
@@ -399,6 +458,16 @@ struct alice3decayFinder {
     return returnValue;
   }
 
+  template <typename THistogram>
+  void setCandidateStageLabels(THistogram const& histogram, const char* combinations)
+  {
+    histogram->GetXaxis()->SetBinLabel(kStageAll + 1, combinations);
+    histogram->GetXaxis()->SetBinLabel(kStagePrefilter + 1, "Prefilter");
+    histogram->GetXaxis()->SetBinLabel(kStageSameMother + 1, "Same MC mother");
+    histogram->GetXaxis()->SetBinLabel(kStageFit + 1, "Fit");
+    histogram->GetXaxis()->SetBinLabel(kStageDCADaughters + 1, "DCA daughters");
+  }
+
   void init(InitContext&)
   {
     // initialize O2 2-prong fitter (only once)
@@ -432,6 +501,8 @@ struct alice3decayFinder {
 
       histos.add("hMassD", "hMassD", kTH1F, {axisDMass});
       histos.add("hMassDbar", "hMassDbar", kTH1F, {axisDMass});
+      histos.add("hDCandidateStages", "hDCandidateStages", kTH1D, {{kNCandidateStages, -0.5f, kNCandidateStages - 0.5f}});
+      setCandidateStageLabels(histos.get<TH1>(HIST("hDCandidateStages")), "Pairs");
 
       if (doDCAplotsD) {
         histos.add("h2dDCAxyVsPtPiPlusFromD", "h2dDCAxyVsPtPiPlusFromD", kTH2F, {axisPt, axisDCA});
@@ -448,6 +519,8 @@ struct alice3decayFinder {
 
       histos.add("hMassLc", "hMassLc", kTH1F, {axisLcMass});
       histos.add("hMassLcbar", "hMassLcbar", kTH1F, {axisLcMass});
+      histos.add("hLcCandidateStages", "hLcCandidateStages", kTH1D, {{kNCandidateStages, -0.5f, kNCandidateStages - 0.5f}});
+      setCandidateStageLabels(histos.get<TH1>(HIST("hLcCandidateStages")), "Triplets");
 
       if (doDCAplotsD) {
         histos.add("h2dDCAxyVsPtPiPlusFromLc", "h2dDCAxyVsPtPiPlusFromLc", kTH2F, {axisPt, axisDCA});
@@ -498,11 +571,24 @@ struct alice3decayFinder {
         histos.fill(HIST("h2dDCAxyVsPtKaMinusFromD"), track.pt(), track.dcaXY() * 1e+4);
     }
 
+    candidateStages.fill(0.);
+
     // D mesons
+    fillTrackLines(tracksPiPlusFromDgrouped, linesProng0);
+    fillTrackLines(tracksKaMinusFromDgrouped, linesProng1);
+    int iPos = -1;
     for (auto const& posTrackRow : tracksPiPlusFromDgrouped) {
+      iPos++;
+      int iNeg = -1;
       for (auto const& negTrackRow : tracksKaMinusFromDgrouped) {
+        iNeg++;
+        candidateStages[kStageAll]++;
+        if (!passStraightLinePrefilter(linesProng0, iPos, linesProng1, iNeg))
+          continue;
+        candidateStages[kStagePrefilter]++;
         if (mcSameMotherCheck && !checkSameMother(posTrackRow, negTrackRow))
           continue;
+        candidateStages[kStageSameMother]++;
         if (!buildDecayCandidateTwoBody(posTrackRow, negTrackRow, o2::constants::physics::MassPionCharged, o2::constants::physics::MassKaonCharged))
           continue;
         histos.fill(HIST("hMassD"), dmeson.mass);
@@ -510,16 +596,30 @@ struct alice3decayFinder {
       }
     }
     // D mesons
+    fillTrackLines(tracksKaPlusFromDgrouped, linesProng0);
+    fillTrackLines(tracksPiMinusFromDgrouped, linesProng1);
+    iPos = -1;
     for (auto const& posTrackRow : tracksKaPlusFromDgrouped) {
+      iPos++;
+      int iNeg = -1;
       for (auto const& negTrackRow : tracksPiMinusFromDgrouped) {
+        iNeg++;
+        candidateStages[kStageAll]++;
+        if (!passStraightLinePrefilter(linesProng0, iPos, linesProng1, iNeg))
+          continue;
+        candidateStages[kStagePrefilter]++;
         if (mcSameMotherCheck && !checkSameMother(posTrackRow, negTrackRow))
           continue;
+        candidateStages[kStageSameMother]++;
         if (!buildDecayCandidateTwoBody(posTrackRow, negTrackRow, o2::constants::physics::MassKaonCharged, o2::constants::physics::MassPionCharged))
           continue;
         histos.fill(HIST("hMassDbar"), dmeson.mass);
         histos.fill(HIST("h3dRecDbar"), dmeson.pt, dmeson.eta, dmeson.mass);
       }
     }
+
+    for (int iStage = 0; iStage < kNCandidateStages; iStage++)
+      histos.fill(HIST("hDCandidateStages"), iStage, candidateStages[iStage]);
   }
   //*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*
 
@@ -550,14 +650,32 @@ struct alice3decayFinder {
         histos.fill(HIST("h2dDCAxyVsPtPrMinusFromLc"), track.pt(), track.dcaXY() * 1e+4);
     }
 
+    candidateStages.fill(0.);
+
     // Lc+ baryons +4122 -> +2212 -321 +211
+    fillTrackLines(tracksPrPlusFromLcgrouped, linesProng0);
+    fillTrackLines(tracksKaMinusFromLcgrouped, linesProng1);
+    fillTrackLines(tracksPiPlusFromLcgrouped, linesProng2);
+    int iProton = -1;
     for (auto const& proton : tracksPrPlusFromLcgrouped) {
+      iProton++;
+      int iPion = -1;
       for (auto const& pion : tracksPiPlusFromLcgrouped) {
+        iPion++;
         if (pion.globalIndex() == proton.globalIndex())
           continue; // avoid self
+        candidateStages[kStageAll] += tracksKaMinusFromLcgrouped.size();
+        if (!passStraightLinePrefilter(linesProng0, iProton, linesProng2, iPion))
+          continue; // no kaon can make it
+        int iKaon = -1;
         for (auto const& kaon : tracksKaMinusFromLcgrouped) {
+          iKaon++;
+          if (!passStraightLinePrefilter(linesProng0, iProton, linesProng1, iKaon) || !passStraightLinePrefilter(linesProng1, iKaon, linesProng2, iPion))
+            continue;
+          candidateStages[kStagePrefilter]++;
           if (mcSameMotherCheck && (!checkSameMother(proton, kaon) || !checkSameMother(proton, pion)))
             continue;
+          candidateStages[kStageSameMother]++;
           if (!buildDecayCandidateThreeBody(proton, kaon, pion, o2::constants::physics::MassProton, o2::constants::physics::MassKaonCharged, o2::constants::physics::MassPionCharged))
             continue;
           histos.fill(HIST("hMassLc"), lcbaryon.mass);
@@ -566,13 +684,29 @@ struct alice3decayFinder {
       }
     }
     // Lc- baryons -4122 -> -2212 +321 -211
+    fillTrackLines(tracksPrMinusFromLcgrouped, linesProng0);
+    fillTrackLines(tracksKaPlusFromLcgrouped, linesProng1);
+    fillTrackLines(tracksPiMinusFromLcgrouped, linesProng2);
+    iProton = -1;
     for (auto const& proton : tracksPrMinusFromLcgrouped) {
+      iProton++;
+      int iPion = -1;
       for (auto const& pion : tracksPiMinusFromLcgrouped) {
+        iPion++;
         if (pion.globalIndex() == proton.globalIndex())
           continue; // avoid self
+        candidateStages[kStageAll] += tracksKaPlusFromLcgrouped.size();
+        if (!passStraightLinePrefilter(linesProng0, iProton, linesProng2, iPion))
+          continue; // no kaon can make it
+        int iKaon = -1;
         for (auto const& kaon : tracksKaPlusFromLcgrouped) {
+          iKaon++;
+          if (!passStraightLinePrefilter(linesProng0, iProton, linesProng1, iKaon) || !passStraightLinePrefilter(linesProng1, iKaon, linesProng2, iPion))
+            continue;
+          candidateStages[kStagePrefilter]++;
           if (mcSameMotherCheck && (!checkSameMother(proton, kaon) || !checkSameMother(proton, pion)))
             continue;
+          candidateStages[kStageSameMother]++;
           if (!buildDecayCandidateThreeBody(proton, kaon, pion, o2::constants::physics::MassProton, o2::constants::physics::MassKaonCharged, o2::constants::physics::MassPionCharged))
             continue;
           histos.fill(HIST("hMassLcbar"), lcbaryon.mass);
@@ -580,6 +714,9 @@ struct alice3decayFinder {
         }
       }
     }
+
+    for (int iStage = 0; iStage < kNCandidateStages; iStage++)
+      histos.fill(HIST("hLcCandidateStages"), iStage, candidateStages[iStage]);
   }
   //*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*
 
@@ -112,42 +112,66 @@ struct ALICE3pidTOFTask {
     }
   }
 
-  template <o2::track::PID::ID id>
-  float sigma(Trks::iterator track)
-  {
-    return o2::pid::tof::TOFResoALICE3ParamTrack<id>(track, resoParameters);
-  }
-  template <o2::track::PID::ID id>
-  float nsigma(Trks::iterator track)
-  {
-    if (!track.hasTOF()) {
-      return -999.f;
-    }
-    return ((track.trackTime() - track.collision().collisionTime()) * 1000.f - o2::pid::tof::ExpTimes<Trks::iterator, id>::ComputeExpectedTime(track.tofExpMom() / o2::pid::tof::kCSPEED,
-                                                                                                                                               track.length())) /
-           sigma<id>(track);
-  }
+  // Inputs and outputs of the bulk response of the tracks of the dataframe, outputs at [iSpecies * nTracks + iTrack]
+  static constexpr int NSpecies = 9;
+  static constexpr float Masses[NSpecies] = {o2::track::pid_constants::sMasses2Z[PID::Electron], o2::track::pid_constants::sMasses2Z[PID::Muon],
+                                             o2::track::pid_constants::sMasses2Z[PID::Pion], o2::track::pid_constants::sMasses2Z[PID::Kaon],
+                                             o2::track::pid_constants::sMasses2Z[PID::Proton], o2::track::pid_constants::sMasses2Z[PID::Deuteron],
+                                             o2::track::pid_constants::sMasses2Z[PID::Triton], o2::track::pid_constants::sMasses2Z[PID::Helium3],
+                                             o2::track::pid_constants::sMasses2Z[PID::Alpha]};
+  std::vector<float> momentum, momentumError, evTimeReso, length, expMomentum, times;
+  std::vector<char> hasTOF;
+  std::vector<float> expTimes, sigmas, nSigmas;
+
   void process(Trks const& tracks, Coll const&)
   {
-    tablePIDEl.reserve(tracks.size());
-    tablePIDMu.reserve(tracks.size());
-    tablePIDPi.reserve(tracks.size());
-    tablePIDKa.reserve(tracks.size());
-    tablePIDPr.reserve(tracks.size());
-    tablePIDDe.reserve(tracks.size());
-    tablePIDTr.reserve(tracks.size());
-    tablePIDHe.reserve(tracks.size());
-    tablePIDAl.reserve(tracks.size());
-    for (auto const& trk : tracks) {
-      tablePIDEl(sigma<PID::Electron>(trk), nsigma<PID::Electron>(trk));
-      tablePIDMu(sigma<PID::Muon>(trk), nsigma<PID::Muon>(trk));
-      tablePIDPi(sigma<PID::Pion>(trk), nsigma<PID::Pion>(trk));
-      tablePIDKa(sigma<PID::Kaon>(trk), nsigma<PID::Kaon>(trk));
-      tablePIDPr(sigma<PID::Proton>(trk), nsigma<PID::Proton>(trk));
-      tablePIDDe(sigma<PID::Deuteron>(trk), nsigma<PID::Deuteron>(trk));
-      tablePIDTr(sigma<PID::Triton>(trk), nsigma<PID::Triton>(trk));
-      tablePIDHe(sigma<PID::Helium3>(trk), nsigma<PID::Helium3>(trk));
-      tablePIDAl(sigma<PID::Alpha>(trk), nsigma<PID::Alpha>(trk));
+    const int nTracks = tracks.size();
+    momentum.resize(nTracks);
+    momentumError.resize(nTracks);
+    evTimeReso.resize(nTracks);
+    length.resize(nTracks);
+    expMomentum.resize(nTracks);
+    times.resize(nTracks);
+    hasTOF.resize(nTracks);
+    expTimes.resize(NSpecies * nTracks);
+    sigmas.resize(NSpecies * nTracks);
+    nSigmas.resize(NSpecies * nTracks);
+    int i = 0;
+    for (auto const& track : tracks) {
+      // momentum resolution as in TOFResoALICE3ParamTrack
+      const float BETA = tan(0.25f * static_cast<float>(M_PI) - 0.5f * atan(track.tgl()));
+      momentumError[i] = sqrt(track.pt() * track.pt() * track.sigma1Pt() * track.sigma1Pt() + (BETA * BETA - 1.f) / (BETA * (BETA * BETA + 1.f)) * (track.tgl() / sqrt(track.tgl() * track.tgl() + 1.f) - 1.f) * track.sigmaTgl() * track.sigmaTgl());
+      momentum[i] = track.p();
+      evTimeReso[i] = track.collision().collisionTimeRes() * 1000.f;
+      length[i] = track.length();
+      expMomentum[i] = track.tofExpMom() / o2::pid::tof::kCSPEED;
+      hasTOF[i] = track.hasTOF();
+      times[i] = hasTOF[i] ? (track.trackTime() - track.collision().collisionTime()) * 1000.f : 0.f;
+      i++;
+    }
+    o2::pid::tof::TOFExpectedTimesBulk(nTracks, expMomentum.data(), length.data(), NSpecies, Masses, expTimes.data());
+    o2::pid::tof::TOFResoALICE3ParamBulk(nTracks, momentum.data(), momentumError.data(), evTimeReso.data(), length.data(), NSpecies, Masses, resoParameters, sigmas.data());
+    o2::pid::tof::TOFNSigmaBulk(nTracks, times.data(), hasTOF.data(), NSpecies, expTimes.data(), sigmas.data(), nSigmas.data());
+
+    tablePIDEl.reserve(nTracks);
+    tablePIDMu.reserve(nTracks);
+    tablePIDPi.reserve(nTracks);
+    tablePIDKa.reserve(nTracks);
+    tablePIDPr.reserve(nTracks);
+    tablePIDDe.reserve(nTracks);
+    tablePIDTr.reserve(nTracks);
+    tablePIDHe.reserve(nTracks);
+    tablePIDAl.reserve(nTracks);
+    for (i = 0; i < nTracks; i++) {
+      tablePIDEl(sigmas[0 * nTracks + i], nSigmas[0 * nTracks + i]);
+      tablePIDMu(sigmas[1 * nTracks + i], nSigmas[1 * nTracks + i]);
+      tablePIDPi(sigmas[2 * nTracks + i], nSigmas[2 * nTracks + i]);
+      tablePIDKa(sigmas[3 * nTracks + i], nSigmas[3 * nTracks + i]);
+      tablePIDPr(sigmas[4 * nTracks + i], nSigmas[4 * nTracks + i]);
+      tablePIDDe(sigmas[5 * nTracks + i], nSigmas[5 * nTracks + i]);
+      tablePIDTr(sigmas[6 * nTracks + i], nSigmas[6 * nTracks + i]);
+      tablePIDHe(sigmas[7 * nTracks + i], nSigmas[7 * nTracks + i]);
+      tablePIDAl(sigmas[8 * nTracks + i], nSigmas[8 * nTracks + i]);
     }
   }
 };
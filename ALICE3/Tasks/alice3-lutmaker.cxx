@@ -13,10 +13,20 @@
 /// \brief Task to extract LUTs for the fast simulation from full simulation
 /// \since 27/04/2021
 
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
 // O2 includes
 #include "Framework/AnalysisTask.h"
+#include "Framework/CallbackService.h"
+#include "Framework/EndOfStreamContext.h"
 #include "ReconstructionDataFormats/Track.h"
 #include "SimulationDataFormat/MCUtils.h"
+#include "ALICE3/Core/DelphesO2TrackSmearer.h"
 
 using namespace o2;
 using namespace framework;
@@ -38,6 +48,92 @@ void customize(std::vector<o2::framework::ConfigParamSpec>& workflowOptions)
 
 #include "Framework/runDataProcessing.h"
 
+/// Partial sums of a LUT, one per worker thread, merged at the end of the processing
+/// The bins are those of the LUT entries, row-major in (nch, radius, eta, pt) as in the LUT file.
+struct LutAccumulator {
+  std::vector<double> nTracks;        // reconstructed tracks per bin
+  std::vector<double> sumCovm;        // sums of the 15 covariance matrix elements per bin
+  std::vector<double> nGenerated;     // generated primary particles per bin
+  std::vector<double> nReconstructed; // reconstructed generated primary particles per bin
+  std::vector<int64_t> recoParticles; // MC particles of the selected tracks of the current dataframe
+
+  void resize(size_t nBins)
+  {
+    nTracks.assign(nBins, 0.);
+    sumCovm.assign(15 * nBins, 0.);
+    nGenerated.assign(nBins, 0.);
+    nReconstructed.assign(nBins, 0.);
+  }
+  void merge(const LutAccumulator& other)
+  {
+    for (size_t i = 0; i < nTracks.size(); i++) {
+      nTracks[i] += other.nTracks[i];
+      nGenerated[i] += other.nGenerated[i];
+      nReconstructed[i] += other.nReconstructed[i];
+    }
+    for (size_t i = 0; i < sumCovm.size(); i++) {
+      sumCovm[i] += other.sumCovm[i];
+    }
+  }
+};
+
+/// Eigen decomposition of the symmetric 5x5 matrix m (cyclic Jacobi rotations), m = v diag(eigval) v^T
+void lutEigen(double m[5][5], float eigval[5], float eigvec[5][5], float eiginv[5][5])
+{
+  double v[5][5] = {{0.}};
+  for (int i = 0; i < 5; i++) {
+    v[i][i] = 1.;
+  }
+  for (int sweep = 0; sweep < 50; sweep++) {
+    double offDiagonal = 0.;
+    for (int p = 0; p < 5; p++) {
+      for (int q = p + 1; q < 5; q++) {
+        offDiagonal += m[p][q] * m[p][q];
+      }
+    }
+    if (offDiagonal < 1.e-40) {
+      break;
+    }
+    for (int p = 0; p < 5; p++) {
+      for (int q = p + 1; q < 5; q++) {
+        if (m[p][q] == 0.) {
+          continue;
+        }
+        const double theta = (m[q][q] - m[p][p]) / (2. * m[p][q]);
+        const double t = (theta >= 0. ? 1. : -1.) / (std::abs(theta) + std::sqrt(theta * theta + 1.));
+        const double c = 1. / std::sqrt(t * t + 1.);
+        const double s = t * c;
+        for (int k = 0; k < 5; k++) { // m = m J
+          const double mkp = m[k][p];
+          const double mkq = m[k][q];
+          m[k][p] = c * mkp - s * mkq;
+          m[k][q] = s * mkp + c * mkq;
+        }
+        for (int k = 0; k < 5; k++) { // m = J^T m
+          const double mpk = m[p][k];
+          const double mqk = m[q][k];
+          m[p][k] = c * mpk - s * mqk;
+          m[q][k] = s * mpk + c * mqk;
+        }
+        for (int k = 0; k < 5; k++) { // v = v J
+          const double vkp = v[k][p];
+          const double vkq = v[k][q];
+          v[k][p] = c * vkp - s * vkq;
+          v[k][q] = s * vkp + c * vkq;
+        }
+      }
+    }
+  }
+  // the eigenvectors are orthonormal, the inverse of the eigenvector matrix is its transpose
+  for (int i = 0; i < 5; i++) {
+    eigval[i] = m[i][i];
+    for (int j = 0; j < 5; j++) {
+      eigvec[i][j] = v[i][j];
+      eiginv[i][j] = v[j][i];
+    }
+  }
+}
+
 template <o2::track::pid_constants::ID particle>
 struct Alice3LutMaker {
   static constexpr int nSpecies = 8;
@@ -61,10 +157,36 @@ struct Alice3LutMaker {
   Configurable<float> ptMax{"ptMax", 2.f, "Upper limit in pT"};
   Configurable<int> ptLog{"ptLog", 1, "Flag to use a logarithmic pT axis, in this case the pT limits are the expontents"};
 
+  Configurable<std::string> lutFile{"lutFile", "", "If set, the LUT is accumulated by worker threads and written at the end of the processing in the format read by TrackSmearer::loadTable. The covariance and efficiency histograms are then not filled"};
+  Configurable<int> lutThreads{"lutThreads", 4, "Number of worker threads accumulating the LUT"};
+  Configurable<float> lutField{"lutField", 0.5f, "Magnetic field (T) written in the LUT header"};
+  Configurable<int> lutMinEntries{"lutMinEntries", 1, "Minimum number of tracks for a LUT entry to be valid"};
+
   HistogramRegistry histos{"Histos", {}, OutputObjHandlingPolicy::AnalysisObject};
 
-  void init(InitContext&)
+  lutHeader_t lutHeader;
+  std::vector<LutAccumulator> lutAccumulators; // one per worker thread
+  std::vector<int> nchOfCollision;
+  std::vector<int> nchOfMcCollision;
+  std::vector<bool> isRecoParticle;
+
+  void init(InitContext& context)
   {
+    if (!lutFile.value.empty()) {
+      lutHeader.pdg = pdg;
+      lutHeader.mass = o2::track::pid_constants::sMasses[particle];
+      lutHeader.field = lutField;
+      lutHeader.nchmap = {nchBins, nchMin, nchMax, static_cast<bool>(nchLog)};
+      lutHeader.radmap = {1, 0.f, 100.f, false};
+      lutHeader.etamap = {etaBins, etaMin, etaMax, false};
+      lutHeader.ptmap = {ptBins, ptMin, ptMax, static_cast<bool>(ptLog)};
+      lutAccumulators.resize(std::max(1, lutThreads.value));
+      for (auto& accumulator : lutAccumulators) {
+        accumulator.resize(static_cast<size_t>(nchBins) * etaBins * ptBins);
+      }
+      context.services().get<CallbackService>().set<CallbackService::Id::EndOfStream>([this](EndOfStreamContext&) { writeLut(); });
+    }
+
     const TString commonTitle = Form(" PDG %i", pdg);
     AxisSpec axisPt{ptBins, ptMin, ptMax, "#it{p}_{T} GeV/#it{c}"};
     if (ptLog) {
@@ -197,11 +319,152 @@ struct Alice3LutMaker {
     histos.add("QA/CovMat_c1Pt21Pt2", "c1Pt21Pt2" + commonTitle, kTH3F, {axisPt, axisEta, axisc1Pt21Pt2});
   }
 
+  /// LUT bin of a particle, the radius dimension has a single bin
+  size_t lutBin(int nch, float eta, float pt)
+  {
+    const int inch = lutHeader.nchmap.find(std::max(nch, 1)); // at least one track, for the logarithmic axis
+    const int ieta = lutHeader.etamap.find(eta);
+    const int ipt = lutHeader.ptmap.find(pt);
+    return (static_cast<size_t>(inch) * lutHeader.etamap.nbins + ieta) * lutHeader.ptmap.nbins + ipt;
+  }
+
+  /// Runs work(accumulator, first, last) for the ranges of n rows, one range per worker thread
+  template <typename TWork>
+  void runWorkers(size_t n, TWork const& work)
+  {
+    const size_t nWorkers = lutAccumulators.size();
+    const size_t rangeSize = (n + nWorkers - 1) / nWorkers;
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < nWorkers; i++) {
+      workers.emplace_back([&, i]() { work(lutAccumulators[i], std::min(n, i * rangeSize), std::min(n, (i + 1) * rangeSize)); });
+    }
+    work(lutAccumulators[0], 0, std::min(n, rangeSize));
+    for (auto& worker : workers) {
+      worker.join();
+    }
+  }
+
+  /// Accumulates the LUT of a dataframe: the tracks and then the MC particles are split among the worker threads,
+  /// each filling its own partial sums, such that no synchronisation is needed while filling
+  template <typename TMcParticles, typename TCollisions, typename TTracks, typename TMcCollisions>
+  void accumulateLut(TMcParticles const& mcParticles, TCollisions const& collisions, TTracks const& tracks, TMcCollisions const& mcCollisions)
+  {
+    // the multiplicity of a collision is its number of tracks, the one of an MC collision that of its first reconstructed collision
+    nchOfCollision.assign(collisions.size(), 0);
+    for (const auto& track : tracks) {
+      if (track.has_collision()) {
+        nchOfCollision[track.collisionId()]++;
+      }
+    }
+    nchOfMcCollision.assign(mcCollisions.size(), -1);
+    for (const auto& collision : collisions) {
+      if (collision.has_mcCollision() && nchOfMcCollision[collision.mcCollisionId()] < 0) {
+        nchOfMcCollision[collision.mcCollisionId()] = nchOfCollision[collision.globalIndex()];
+      }
+    }
+
+    runWorkers(tracks.size(), [&](LutAccumulator& accumulator, size_t first, size_t last) {
+      accumulator.recoParticles.clear();
+      for (size_t i = first; i < last; i++) {
+        const auto track = tracks.rawIteratorAt(i);
+        if (!track.has_mcParticle() || !track.has_collision()) {
+          continue;
+        }
+        const auto mcParticle = track.template mcParticle_as<TMcParticles>();
+        if (mcParticle.pdgCode() != pdg) {
+          continue;
+        }
+        if (selPrim.value && !mcParticle.isPhysicalPrimary()) { // Requiring is physical primary
+          continue;
+        }
+        accumulator.recoParticles.push_back(mcParticle.globalIndex());
+        const size_t bin = lutBin(nchOfCollision[track.collisionId()], mcParticle.eta(), mcParticle.pt());
+        const float covm[15] = {track.cYY(), track.cZY(), track.cZZ(), track.cSnpY(), track.cSnpZ(),
+                                track.cSnpSnp(), track.cTglY(), track.cTglZ(), track.cTglSnp(), track.cTglTgl(),
+                                track.c1PtY(), track.c1PtZ(), track.c1PtSnp(), track.c1PtTgl(), track.c1Pt21Pt2()};
+        accumulator.nTracks[bin]++;
+        double* sumCovm = accumulator.sumCovm.data() + 15 * bin;
+        for (int k = 0; k < 15; k++) {
+          sumCovm[k] += covm[k];
+        }
+      }
+    });
+
+    isRecoParticle.assign(mcParticles.size(), false);
+    for (const auto& accumulator : lutAccumulators) {
+      for (const auto& index : accumulator.recoParticles) {
+        isRecoParticle[index] = true;
+      }
+    }
+
+    runWorkers(mcParticles.size(), [&](LutAccumulator& accumulator, size_t first, size_t last) {
+      for (size_t i = first; i < last; i++) {
+        const auto mcParticle = mcParticles.rawIteratorAt(i);
+        if (mcParticle.pdgCode() != pdg || !mcParticle.isPhysicalPrimary() || nchOfMcCollision[mcParticle.mcCollisionId()] < 0) {
+          continue;
+        }
+        const size_t bin = lutBin(nchOfMcCollision[mcParticle.mcCollisionId()], mcParticle.eta(), mcParticle.pt());
+        accumulator.nGenerated[bin]++;
+        if (isRecoParticle[i]) {
+          accumulator.nReconstructed[bin]++;
+        }
+      }
+    });
+  }
+
+  /// Merges the partial sums of the worker threads and writes the LUT header and entries
+  void writeLut()
+  {
+    auto& lut = lutAccumulators[0];
+    for (size_t i = 1; i < lutAccumulators.size(); i++) {
+      lut.merge(lutAccumulators[i]);
+    }
+    std::ofstream out(lutFile.value, std::ofstream::binary);
+    if (!out.is_open()) {
+      LOG(error) << "Cannot open the LUT file " << lutFile.value;
+      return;
+    }
+    out.write(reinterpret_cast<const char*>(&lutHeader), sizeof(lutHeader_t));
+    int nValid = 0;
+    size_t bin = 0;
+    for (int inch = 0; inch < lutHeader.nchmap.nbins; inch++) {
+      for (int ieta = 0; ieta < lutHeader.etamap.nbins; ieta++) {
+        for (int ipt = 0; ipt < lutHeader.ptmap.nbins; ipt++, bin++) {
+          lutEntry_t entry;
+          entry.nch = lutHeader.nchmap.eval(inch);
+          entry.eta = lutHeader.etamap.eval(ieta);
+          entry.pt = lutHeader.ptmap.eval(ipt);
+          entry.eff = lut.nGenerated[bin] > 0. ? lut.nReconstructed[bin] / lut.nGenerated[bin] : 0.;
+          entry.eff2 = entry.eff;
+          entry.valid = lut.nTracks[bin] >= lutMinEntries;
+          if (entry.valid) {
+            nValid++;
+            double m[5][5];
+            for (int i = 0, k = 0; i < 5; i++) {
+              for (int j = 0; j < i + 1; j++, k++) {
+                entry.covm[k] = lut.sumCovm[15 * bin + k] / lut.nTracks[bin];
+                m[i][j] = m[j][i] = entry.covm[k];
+              }
+            }
+            lutEigen(m, entry.eigval, entry.eigvec, entry.eiginv);
+          }
+          out.write(reinterpret_cast<const char*>(&entry), sizeof(lutEntry_t));
+        }
+      }
+    }
+    LOG(info) << "Written the LUT for PDG " << pdg << " with " << nValid << " valid entries out of " << bin << " to " << lutFile.value;
+  }
+
   void process(const o2::aod::McParticles& mcParticles,
-               const o2::soa::Join<o2::aod::Collisions, o2::aod::McCollisionLabels>&,
+               const o2::soa::Join<o2::aod::Collisions, o2::aod::McCollisionLabels>& collisions,
                const o2::soa::Join<o2::aod::Tracks, o2::aod::TracksCov, o2::aod::McTrackLabels>& tracks,
-               const o2::aod::McCollisions&)
+               const o2::aod::McCollisions& mcCollisions)
   {
+    if (!lutFile.value.empty()) {
+      accumulateLut(mcParticles, collisions, tracks, mcCollisions);
+      return;
+    }
+
     std::vector<int64_t> recoTracks(tracks.size());
     int ntrks = 0;
 
@@ -0,0 +1,76 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#include "CcdbPrefetcher.h"
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace o2
+{
+CcdbPrefetcher::Request* CcdbPrefetcher::find(std::string const& path, int64_t timestamp)
+{
+  for (auto& request : mRequests) {
+    if (request.timestamp == timestamp && request.path == path) {
+      return &request;
+    }
+  }
+  return nullptr;
+}
+
+void CcdbPrefetcher::fetch()
+{
+  std::vector<Request*> pending;
+  for (auto& request : mRequests) {
+    if (!request.done) {
+      pending.push_back(&request);
+    }
+  }
+  if (pending.empty()) {
+    return;
+  }
+
+  // the CcdbApi instances are initialised here, in the calling thread, and each is used by a single worker
+  const int nWorkers = std::max(1, std::min(mMaxParallel, static_cast<int>(pending.size())));
+  std::vector<std::unique_ptr<o2::ccdb::CcdbApi>> apis;
+  for (int i = 0; i < nWorkers; i++) {
+    apis.push_back(std::make_unique<o2::ccdb::CcdbApi>());
+    apis.back()->init(mURL);
+  }
+  const std::string createdNotAfter = mCreatedNotAfter > 0 ? std::to_string(mCreatedNotAfter) : "";
+
+  std::atomic<size_t> next{0};
+  auto work = [&](o2::ccdb::CcdbApi& api) {
+    for (size_t i = next++; i < pending.size(); i = next++) {
+      pending[i]->object = pending[i]->retrieve(api, createdNotAfter);
+    }
+  };
+  std::vector<std::thread> workers;
+  for (int i = 1; i < nWorkers; i++) {
+    workers.emplace_back(work, std::ref(*apis[i]));
+  }
+  work(*apis[0]);
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  for (auto* request : pending) {
+    request->done = true;
+    if (!request->object) {
+      LOGF(warning, "Could not prefetch CCDB object %s for timestamp %lld, it will be retrieved through the CCDB manager", request->path, static_cast<long long>(request->timestamp));
+    }
+  }
+  LOGF(info, "Prefetched %d CCDB objects with %d threads", static_cast<int>(pending.size()), nWorkers);
+}
+} // namespace o2
@@ -0,0 +1,103 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#ifndef COMMON_CCDB_CCDBPREFETCHER_H_
+#define COMMON_CCDB_CCDBPREFETCHER_H_
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <typeindex>
+#include <vector>
+
+#include "CCDB/BasicCCDBManager.h"
+#include "CCDB/CcdbApi.h"
+#include "Framework/Logger.h"
+
+namespace o2
+{
+
+// Concurrent retrieval of a set of CCDB objects
+// The requests (path, type, timestamp) are registered with add() and are all retrieved together at the first get(),
+// each retrieval thread with its own CcdbApi, instead of one after the other through the BasicCCDBManager.
+// The objects are owned by the prefetcher and stay valid until clear(). The BasicCCDBManager cache cannot be filled
+// from outside, the objects not registered or whose retrieval failed are therefore taken from the BasicCCDBManager.
+class CcdbPrefetcher
+{
+ public:
+  CcdbPrefetcher() = default;
+
+  void setURL(std::string const& url) { mURL = url; }
+  void setCreatedNotAfter(int64_t createdNotAfter) { mCreatedNotAfter = createdNotAfter; }
+  /// Maximum number of concurrent retrievals
+  void setMaxParallel(int maxParallel) { mMaxParallel = maxParallel; }
+
+  /// Registers an object for the next fetch
+  template <typename T>
+  void add(std::string const& path, int64_t timestamp, std::map<std::string, std::string> const& metadata = {})
+  {
+    if (find(path, timestamp) != nullptr) {
+      return;
+    }
+    Request& request = mRequests.emplace_back();
+    request.path = path;
+    request.timestamp = timestamp;
+    request.type = std::type_index(typeid(T));
+    request.retrieve = [path, timestamp, metadata](o2::ccdb::CcdbApi& api, std::string const& createdNotAfter) -> std::shared_ptr<void> {
+      return std::shared_ptr<T>(api.retrieveFromTFileAny<T>(path, metadata, timestamp, nullptr, "", createdNotAfter));
+    };
+  }
+
+  /// Retrieves concurrently all the registered objects not fetched yet, blocks until they are all done
+  void fetch();
+
+  /// Object of a request, fetching the pending requests first
+  /// Falls back to the BasicCCDBManager for the objects not registered or not retrieved.
+  template <typename T>
+  T* get(o2::ccdb::BasicCCDBManager* ccdb, std::string const& path, int64_t timestamp)
+  {
+    fetch();
+    Request* request = find(path, timestamp);
+    if (request != nullptr) {
+      if (request->type != std::type_index(typeid(T))) {
+        LOGF(fatal, "CCDB object %s registered with type %s and requested with type %s", path, request->type.name(), typeid(T).name());
+      }
+      if (request->object) {
+        return static_cast<T*>(request->object.get());
+      }
+    }
+    return ccdb->getForTimeStamp<T>(path, timestamp);
+  }
+
+  /// Deletes the objects and the requests, e.g. at a run change
+  void clear() { mRequests.clear(); }
+
+ private:
+  struct Request {
+    std::string path;
+    int64_t timestamp = -1;
+    std::type_index type = std::type_index(typeid(void));
+    std::function<std::shared_ptr<void>(o2::ccdb::CcdbApi&, std::string const&)> retrieve;
+    std::shared_ptr<void> object;
+    bool done = false;
+  };
+
+  Request* find(std::string const& path, int64_t timestamp);
+
+  std::string mURL = "http://alice-ccdb.cern.ch";
+  int64_t mCreatedNotAfter = 0; // ms, 0 for no limit
+  int mMaxParallel = 8;
+  std::vector<Request> mRequests;
+};
+} // namespace o2
+
+#endif // COMMON_CCDB_CCDBPREFETCHER_H_
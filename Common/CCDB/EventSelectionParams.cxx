@@ -196,3 +196,13 @@ bool* EventSelectionParams::GetSelection(int iSelection)
   }
   return NULL;
 }
+
+uint64_t EventSelectionParams::GetSelectionMask(int iSelection) const
+{
+  const bool* selection = iSelection == 0 ? selectionBarrel : (iSelection == 1 ? selectionMuonWithPileupCuts : (iSelection == 2 ? selectionMuonWithoutPileupCuts : nullptr));
+  uint64_t mask = 0;
+  for (int i = 0; selection != nullptr && i < o2::aod::evsel::kNsel; i++) {
+    mask |= selection[i] ? 1ull << i : 0;
+  }
+  return mask;
+}
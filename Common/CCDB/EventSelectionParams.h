@@ -12,6 +12,7 @@
 #ifndef COMMON_CCDB_EVENTSELECTIONPARAMS_H_
 #define COMMON_CCDB_EVENTSELECTIONPARAMS_H_
 
+#include <cstdint>
 #include <Rtypes.h>
 #include <TMath.h>
 
@@ -74,6 +75,8 @@ class EventSelectionParams
   void DisableOutOfBunchPileupCuts();
   void SetOnVsOfParams(float newV0MOnVsOfA, float newV0MOnVsOfB, float newSPDOnVsOfA, float newSPDOnVsOfB);
   bool* GetSelection(int iSelection);
+  /// Bit mask of the selection criteria applied in a selection (see GetSelection), to be compared with the selection bits of a bc or collision
+  uint64_t GetSelectionMask(int iSelection) const;
 
   bool selectionBarrel[o2::aod::evsel::kNsel];
   bool selectionMuonWithPileupCuts[o2::aod::evsel::kNsel];
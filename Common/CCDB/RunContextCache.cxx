@@ -0,0 +1,105 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#include "RunContextCache.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "CommonConstants/LHCConstants.h"
+#include "DataFormatsParameters/GRPECSObject.h"
+#include "Common/CCDB/EventSelectionParams.h"
+
+namespace o2
+{
+RunContext& RunContextCache::getContext(int runNumber)
+{
+  if (mLastContext == nullptr || mLastContext->runNumber != runNumber) {
+    mLastContext = &mRunContexts[runNumber];
+    mLastContext->runNumber = runNumber;
+  }
+  return *mLastContext;
+}
+
+const RunContext& RunContextCache::getRunInformation(o2::ccdb::CcdbApi& ccdbApi, o2::ccdb::BasicCCDBManager* ccdb, int runNumber,
+                                                     std::string const& rctPath, std::string const& orbitResetPath, bool isRun2MC)
+{
+  RunContext& context = getContext(runNumber);
+  if (context.hasRunInformation) {
+    return context;
+  }
+
+  LOGF(debug, "Getting start-of-run and end-of-run timestamps from CCDB");
+  std::map<std::string, std::string> metadata, headers;
+  const std::string runPath = Form("%s/%i", rctPath.data(), runNumber);
+  headers = ccdbApi.retrieveHeaders(runPath, metadata, -1);
+  if (headers.count("SOR") == 0) {
+    LOGF(fatal, "Cannot find start-of-run timestamp for run number in path '%s'.", runPath.data());
+  }
+  if (headers.count("EOR") == 0) {
+    LOGF(fatal, "Cannot find end-of-run timestamp for run number in path '%s'.", runPath.data());
+  }
+  context.sorTimestamp = atol(headers["SOR"].c_str()); // timestamp of the SOR in ms
+  context.eorTimestamp = atol(headers["EOR"].c_str()); // timestamp of the EOR in ms
+
+  bool isUnanchoredRun3MC = runNumber >= 300000 && runNumber < 500000;
+  if (isRun2MC || isUnanchoredRun3MC) {
+    // isRun2MC: bc/orbit distributions are not simulated in Run2 MC. All bcs are set to 0.
+    // isUnanchoredRun3MC: assuming orbit-reset is done in the beginning of each run
+    // Setting orbit-reset timestamp to start-of-run timestamp
+    context.orbitResetTimestamp = context.sorTimestamp * 1000; // from ms to us
+  } else if (runNumber < 300000) {                             // Run 2
+    LOGF(debug, "Getting orbit-reset timestamp using start-of-run timestamp from CCDB");
+    auto ctp = ccdb->getForTimeStamp<std::vector<Long64_t>>(orbitResetPath, context.sorTimestamp);
+    context.orbitResetTimestamp = (*ctp)[0];
+  } else {
+    // sometimes orbit is reset after SOR. Using EOR timestamps for orbitReset query is more reliable
+    LOGF(debug, "Getting orbit-reset timestamp using end-of-run timestamp from CCDB");
+    auto ctp = ccdb->getForTimeStamp<std::vector<Long64_t>>(orbitResetPath, context.eorTimestamp);
+    context.orbitResetTimestamp = (*ctp)[0];
+  }
+  context.hasRunInformation = true;
+  LOGF(info, "Add new run number %i with orbit-reset timestamp %llu to cache", runNumber, context.orbitResetTimestamp);
+  return context;
+}
+
+const RunContext& RunContextCache::getTimeFrameInfo(o2::ccdb::BasicCCDBManager* ccdb, int runNumber, int64_t timestamp)
+{
+  RunContext& context = getContext(runNumber);
+  if (context.hasTimeFrameInfo) {
+    return context;
+  }
+
+  // access orbitShift, ITSROF and TF border margins
+  context.eventSelectionParams = ccdb->getForTimeStamp<EventSelectionParams>("EventSelection/EventSelectionParams", timestamp);
+  // access orbit-reset timestamp
+  auto ctpx = ccdb->getForTimeStamp<std::vector<Long64_t>>("CTP/Calib/OrbitReset", timestamp);
+  int64_t tsOrbitReset = (*ctpx)[0]; // us
+  // access TF duration, start-of-run and end-of-run timestamps from ECS GRP
+  std::map<std::string, std::string> metadata;
+  metadata["runNumber"] = Form("%d", runNumber);
+  auto grpecs = ccdb->getSpecific<o2::parameters::GRPECSObject>("GLO/Config/GRPECS", timestamp, metadata);
+  uint32_t nOrbitsPerTF = grpecs->getNHBFPerTF(); // assuming 1 orbit = 1 HBF;  nOrbitsPerTF=128 in 2022, 32 in 2023
+  int64_t tsSOR = grpecs->getTimeStart();         // ms
+  // calculate SOR orbit
+  int64_t orbitSOR = (tsSOR * 1000 - tsOrbitReset) / o2::constants::lhc::LHCOrbitMUS;
+  // adjust to the nearest TF edge
+  orbitSOR = orbitSOR / nOrbitsPerTF * nOrbitsPerTF + context.eventSelectionParams->fTimeFrameOrbitShift;
+  // first bc of the first orbit (should coincide with TF start)
+  context.bcSOR = orbitSOR * o2::constants::lhc::LHCMaxBunches;
+  // duration of TF in bcs
+  context.nBCsPerTF = nOrbitsPerTF * o2::constants::lhc::LHCMaxBunches;
+  context.hasTimeFrameInfo = true;
+  LOGP(info, "tsOrbitReset={} us, SOR = {} ms, orbitSOR = {}, nBCsPerTF = {}", tsOrbitReset, tsSOR, orbitSOR, context.nBCsPerTF);
+  return context;
+}
+} // namespace o2
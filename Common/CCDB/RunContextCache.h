@@ -0,0 +1,67 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#ifndef COMMON_CCDB_RUNCONTEXTCACHE_H_
+#define COMMON_CCDB_RUNCONTEXTCACHE_H_
+
+#include <map>
+#include <string>
+
+#include "CCDB/BasicCCDBManager.h"
+
+class EventSelectionParams;
+
+namespace o2
+{
+
+// Run-level quantities used by the Common producers
+struct RunContext {
+  int runNumber = -1;
+
+  // start-of-run, end-of-run and orbit-reset timestamps from the RCT run information
+  bool hasRunInformation = false;
+  int64_t sorTimestamp = 0;        // ms
+  int64_t eorTimestamp = 0;        // ms
+  int64_t orbitResetTimestamp = 0; // us
+
+  // time-frame structure from the event-selection parameters, the orbit reset and the ECS GRP (data and anchored MC)
+  bool hasTimeFrameInfo = false;
+  EventSelectionParams* eventSelectionParams = nullptr;
+  int64_t bcSOR = -1;     // global bc of the start of the first orbit, at the TF edge
+  int64_t nBCsPerTF = -1; // duration of TF in bcs
+};
+
+// Cache of the run contexts by run number
+// All the CCDB objects of a group are fetched together at the first request for a run, and are then reused for
+// all the BCs and dataframes of the run, also when the runs alternate as in short-run MC productions.
+class RunContextCache
+{
+ public:
+  RunContextCache() = default;
+
+  /// Run context with the start-of-run, end-of-run and orbit-reset timestamps
+  /// \param isRun2MC the orbit-reset timestamp is the start-of-run timestamp, as for unanchored Run 3 MC
+  const RunContext& getRunInformation(o2::ccdb::CcdbApi& ccdbApi, o2::ccdb::BasicCCDBManager* ccdb, int runNumber,
+                                      std::string const& rctPath, std::string const& orbitResetPath, bool isRun2MC);
+
+  /// Run context with the time-frame structure of the run
+  /// \param timestamp timestamp (ms) of a BC of the run
+  const RunContext& getTimeFrameInfo(o2::ccdb::BasicCCDBManager* ccdb, int runNumber, int64_t timestamp);
+
+ private:
+  RunContext& getContext(int runNumber);
+
+  std::map<int, RunContext> mRunContexts;
+  RunContext* mLastContext = nullptr; // context of the last requested run
+};
+} // namespace o2
+
+#endif // COMMON_CCDB_RUNCONTEXTCACHE_H_
@@ -53,6 +53,22 @@ void TriggerAliases::AddClassIdToAlias(uint32_t aliasId, int classId)
   }
 }
 
+TriggerAliasMasks TriggerAliases::GetAliasMasks() const
+{
+  TriggerAliasMasks masks;
+  for (const auto& alias : mAliasToTriggerMask) {
+    if (alias.first < kNaliases) {
+      masks.classMask[alias.first] = alias.second;
+    }
+  }
+  for (const auto& alias : mAliasToTriggerMaskNext50) {
+    if (alias.first < kNaliases) {
+      masks.classMaskNext50[alias.first] = alias.second;
+    }
+  }
+  return masks;
+}
+
 void TriggerAliases::Print()
 {
   for (const auto& alias : mAliasToTriggerMask) {
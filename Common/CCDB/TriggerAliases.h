@@ -51,6 +51,22 @@ enum triggerAliases {
 
 extern std::string aliasLabels[kNaliases];
 
+/// Trigger class masks of the aliases in flat arrays, to evaluate the fired aliases of a bc with a few bitwise operations
+struct TriggerAliasMasks {
+  uint64_t classMask[kNaliases] = {};       // classes 0-49 of each alias
+  uint64_t classMaskNext50[kNaliases] = {}; // classes 50-99 of each alias
+
+  /// Returns the bit mask of the aliases fired by the trigger classes of a bc, kALL not included
+  uint32_t getAliases(uint64_t triggerMask, uint64_t triggerMaskNext50 = 0) const
+  {
+    uint32_t alias = 0;
+    for (int i = 0; i < kNaliases; i++) {
+      alias |= static_cast<uint32_t>(((triggerMask & classMask[i]) | (triggerMaskNext50 & classMaskNext50[i])) != 0) << i;
+    }
+    return alias;
+  }
+};
+
 class TriggerAliases
 {
  public:
@@ -62,6 +78,7 @@ class TriggerAliases
   const std::map<uint32_t, std::string>& GetAliasToClassNamesMap() const { return mAliasToClassNames; }
   const std::map<uint32_t, ULong64_t>& GetAliasToTriggerMaskMap() const { return mAliasToTriggerMask; }
   const std::map<uint32_t, ULong64_t>& GetAliasToTriggerMaskNext50Map() const { return mAliasToTriggerMaskNext50; }
+  TriggerAliasMasks GetAliasMasks() const;
   void Print();
 
  private:
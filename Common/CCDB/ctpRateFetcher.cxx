@@ -11,7 +11,9 @@
 
 #include "ctpRateFetcher.h"
 
+#include <algorithm>
 #include <map>
+#include <string>
 #include <vector>
 
 #include "CommonConstants/LHCConstants.h"
@@ -25,6 +27,38 @@ namespace o2
 double ctpRateFetcher::fetch(o2::ccdb::BasicCCDBManager* ccdb, uint64_t timeStamp, int runNumber, std::string sourceName)
 {
   setupRun(runNumber, ccdb, timeStamp);
+  const double time = timeStamp * 1.e-3;
+  if (!mUseRateTable || mScalerTimes.size() < 2 || time < mScalerTimes.front() || time >= mScalerTimes.back()) {
+    return fetchFromScalers(ccdb, timeStamp, runNumber, sourceName);
+  }
+  // the rate of the scalers is constant between consecutive records: look up the interval, starting from the last one
+  RateTable& table = getRateTable(ccdb, runNumber, sourceName);
+  size_t interval = table.lastInterval;
+  if (time < mScalerTimes[interval] || time >= mScalerTimes[interval + 1]) {
+    interval = std::upper_bound(mScalerTimes.begin(), mScalerTimes.end(), time) - mScalerTimes.begin() - 1;
+    table.lastInterval = interval;
+  }
+  return table.rates[interval];
+}
+
+ctpRateFetcher::RateTable& ctpRateFetcher::getRateTable(o2::ccdb::BasicCCDBManager* ccdb, int runNumber, const std::string& sourceName)
+{
+  auto table = mRateTables.find(sourceName);
+  if (table != mRateTables.end()) {
+    return table->second;
+  }
+  LOG(info) << "Building the table of the " << sourceName << " rates for run " << runNumber << " over " << mScalerTimes.size() - 1 << " scaler intervals";
+  RateTable& newTable = mRateTables[sourceName];
+  newTable.rates.resize(mScalerTimes.size() - 1);
+  for (size_t interval = 0; interval + 1 < mScalerTimes.size(); interval++) {
+    const uint64_t midTimeStamp = 0.5e3 * (mScalerTimes[interval] + mScalerTimes[interval + 1]); // ms
+    newTable.rates[interval] = fetchFromScalers(ccdb, midTimeStamp, runNumber, sourceName);
+  }
+  return newTable;
+}
+
+double ctpRateFetcher::fetchFromScalers(o2::ccdb::BasicCCDBManager* ccdb, uint64_t timeStamp, int runNumber, const std::string& sourceName)
+{
   if (sourceName.find("ZNC") != std::string::npos) {
     if (runNumber < 544448) {
       return fetchCTPratesInputs(ccdb, timeStamp, runNumber, 25) / (sourceName.find("hadronic") != std::string::npos ? 28. : 1.);
@@ -89,9 +123,7 @@ double ctpRateFetcher::pileUpCorrection(double triggerRate)
   if (mLHCIFdata == nullptr) {
     LOG(fatal) << "No filling" << std::endl;
   }
-  auto bfilling = mLHCIFdata->getBunchFilling();
-  std::vector<int> bcs = bfilling.getFilledBCs();
-  double nbc = bcs.size();
+  double nbc = mNFilledBCs;
   double nTriggersPerFilledBC = triggerRate / nbc / constants::lhc::LHCRevFreq;
   double mu = -std::log(1 - nTriggersPerFilledBC);
   return mu * nbc * constants::lhc::LHCRevFreq;
@@ -114,6 +146,7 @@ void ctpRateFetcher::setupRun(int runNumber, o2::ccdb::BasicCCDBManager* ccdb, u
   if (mLHCIFdata == nullptr) {
     LOG(fatal) << "GRPLHCIFData not in database, timestamp:" << timeStamp;
   }
+  mNFilledBCs = mLHCIFdata->getBunchFilling().getFilledBCs().size();
   metadata["runNumber"] = std::to_string(mRunNumber);
   mConfig = ccdb->getSpecific<ctp::CTPConfiguration>("CTP/Config/Config", timeStamp, metadata);
   if (mConfig == nullptr) {
@@ -124,6 +157,11 @@ void ctpRateFetcher::setupRun(int runNumber, o2::ccdb::BasicCCDBManager* ccdb, u
     LOG(fatal) << "CTPRunScalers not in database, timestamp:" << timeStamp;
   }
   mScalers->convertRawToO2();
+  mScalerTimes.clear();
+  for (auto const& record : mScalers->getScalerRecordO2()) {
+    mScalerTimes.push_back(record.epochTime);
+  }
+  mRateTables.clear();
 }
 
 } // namespace o2
@@ -12,7 +12,9 @@
 #ifndef COMMON_CCDB_CTPRATEFETCHER_H_
 #define COMMON_CCDB_CTPRATEFETCHER_H_
 
+#include <map>
 #include <string>
+#include <vector>
 
 #include "CCDB/BasicCCDBManager.h"
 
@@ -36,16 +38,40 @@ class ctpRateFetcher
   ctpRateFetcher() = default;
   double fetch(o2::ccdb::BasicCCDBManager* ccdb, uint64_t timeStamp, int runNumber, std::string sourceName);
 
+  /// Fills the rates at the timestamps of all the BCs of a table
+  template <typename TBCs>
+  void fetch(o2::ccdb::BasicCCDBManager* ccdb, TBCs const& bcs, int runNumber, std::string const& sourceName, std::vector<double>& rates)
+  {
+    rates.resize(bcs.size());
+    size_t iBC = 0;
+    for (auto const& bc : bcs) {
+      rates[iBC++] = fetch(ccdb, bc.timestamp(), runNumber, sourceName);
+    }
+  }
+
   void setManualCleanup(bool manualCleanup = true) { mManualCleanup = manualCleanup; }
+  /// Rates from a table of the pile-up corrected rates per scaler interval, built once per run and source
+  void setUseRateTable(bool useRateTable = true) { mUseRateTable = useRateTable; }
 
  private:
+  struct RateTable {
+    std::vector<double> rates; // pile-up corrected rate per interval between consecutive scaler records
+    size_t lastInterval = 0;   // interval of the last lookup, tried first
+  };
+
+  double fetchFromScalers(o2::ccdb::BasicCCDBManager* ccdb, uint64_t timeStamp, int runNumber, const std::string& sourceName);
+  RateTable& getRateTable(o2::ccdb::BasicCCDBManager* ccdb, int runNumber, const std::string& sourceName);
   double fetchCTPratesInputs(o2::ccdb::BasicCCDBManager* ccdb, uint64_t timeStamp, int runNumber, int input);
   double fetchCTPratesClasses(o2::ccdb::BasicCCDBManager* ccdb, uint64_t timeStamp, int runNumber, const std::string& className, int inputType = 1);
   double pileUpCorrection(double rate);
   void setupRun(int runNumber, o2::ccdb::BasicCCDBManager* ccdb, uint64_t timeStamp);
 
   bool mManualCleanup = false;
+  bool mUseRateTable = false;
   int mRunNumber = -1;
+  double mNFilledBCs = 0.;                     // number of filled bunches of the run
+  std::vector<double> mScalerTimes;            // times (s) of the scaler records of the run
+  std::map<std::string, RateTable> mRateTables; // tables of the run per source
   ctp::CTPConfiguration* mConfig = nullptr;
   ctp::CTPRunScalers* mScalers = nullptr;
   parameters::GRPLHCIFData* mLHCIFdata = nullptr;
@@ -0,0 +1,122 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+//
+// Sorted index of global BCs (e.g. BCs with FT0 TVX, or collision BCs) of a time frame,
+// answering "closest entry" and "number of entries in a BC window" queries by binary search.
+// It replaces the std::map<globalBC, index> of the neighbour searches: filling is a push_back when the BCs
+// come in increasing order, as for the BC table, and the storage is contiguous.
+//
+
+#ifndef COMMON_CORE_BCNEIGHBOURINDEX_H_
+#define COMMON_CORE_BCNEIGHBOURINDEX_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <numeric>
+#include <vector>
+
+class BCNeighbourIndex
+{
+ public:
+  void clear()
+  {
+    mGlobalBCs.clear();
+    mIndices.clear();
+    mIsSorted = true;
+  }
+  void reserve(size_t n)
+  {
+    mGlobalBCs.reserve(n);
+    mIndices.reserve(n);
+  }
+  size_t size() const { return mGlobalBCs.size(); }
+  bool empty() const { return mGlobalBCs.empty(); }
+
+  /// Adds an entry. As for a std::map filled with operator[], a later entry with the same BC replaces the earlier one.
+  /// finalize() has to be called before the queries if the BCs were not added in increasing order.
+  void add(int64_t globalBC, int32_t index)
+  {
+    if (!mGlobalBCs.empty() && globalBC <= mGlobalBCs.back()) {
+      if (globalBC == mGlobalBCs.back() && mIsSorted) {
+        mIndices.back() = index;
+        return;
+      }
+      mIsSorted = false;
+    }
+    mGlobalBCs.push_back(globalBC);
+    mIndices.push_back(index);
+  }
+
+  /// Sorts the entries in BC if needed, keeping the last added entry of each BC
+  void finalize()
+  {
+    if (mIsSorted) {
+      return;
+    }
+    std::vector<size_t> order(mGlobalBCs.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) { return mGlobalBCs[a] < mGlobalBCs[b]; });
+    std::vector<int64_t> globalBCs;
+    std::vector<int32_t> indices;
+    globalBCs.reserve(order.size());
+    indices.reserve(order.size());
+    for (const auto position : order) {
+      if (!globalBCs.empty() && globalBCs.back() == mGlobalBCs[position]) {
+        indices.back() = mIndices[position];
+        continue;
+      }
+      globalBCs.push_back(mGlobalBCs[position]);
+      indices.push_back(mIndices[position]);
+    }
+    mGlobalBCs.swap(globalBCs);
+    mIndices.swap(indices);
+    mIsSorted = true;
+  }
+
+  int64_t getGlobalBC(size_t position) const { return mGlobalBCs[position]; }
+  int32_t getIndex(size_t position) const { return mIndices[position]; }
+
+  /// Position of the entry closest in BC to globalBC, the later entry is taken for equal distances. The index must not be empty.
+  size_t findClosestPosition(int64_t globalBC) const
+  {
+    auto it = std::lower_bound(mGlobalBCs.begin(), mGlobalBCs.end(), globalBC);
+    if (it == mGlobalBCs.end()) {
+      return mGlobalBCs.size() - 1;
+    }
+    if (it == mGlobalBCs.begin()) {
+      return 0;
+    }
+    size_t position = it - mGlobalBCs.begin();
+    return (std::abs(*it - globalBC) <= std::abs(*(it - 1) - globalBC)) ? position : position - 1;
+  }
+  /// Index of the entry closest in BC to globalBC
+  int32_t findClosest(int64_t globalBC) const { return mIndices[findClosestPosition(globalBC)]; }
+
+  /// Number of entries with minBC <= BC <= maxBC
+  size_t countInWindow(int64_t minBC, int64_t maxBC) const
+  {
+    if (maxBC < minBC) {
+      return 0;
+    }
+    auto first = std::lower_bound(mGlobalBCs.begin(), mGlobalBCs.end(), minBC);
+    auto last = std::upper_bound(first, mGlobalBCs.end(), maxBC);
+    return last - first;
+  }
+
+ private:
+  std::vector<int64_t> mGlobalBCs; // sorted once finalized
+  std::vector<int32_t> mIndices;   // index (e.g. in the BC table) of each entry
+  bool mIsSorted = true;
+};
+
+#endif // COMMON_CORE_BCNEIGHBOURINDEX_H_
@@ -20,6 +20,7 @@
 #ifndef COMMON_CORE_COLLISIONASSOCIATION_H_
 #define COMMON_CORE_COLLISIONASSOCIATION_H_
 
+#include <algorithm>
 #include <vector>
 #include <memory>
 #include <utility>
@@ -57,6 +58,8 @@ class CollisionAssociation
   void setIncludeUnassigned(bool enable = true) { mIncludeUnassigned = enable; }
   void setFillTableOfCollIdsPerTrack(bool fill = true) { mFillTableOfCollIdsPerTrack = fill; }
   void setBcWindow(int bcWindow = 115) { mBcWindowForOneSigma = bcWindow; }
+  void setUseSweepAssociation(bool enable = true) { mUseSweepAssociation = enable; }
+  void setUseCompactReverseIndices(bool enable = true) { mUseCompactReverseIndices = enable; }
 
   template <typename TTracks, typename Slice, typename Assoc, typename RevIndices>
   void runStandardAssoc(o2::aod::Collisions const& collisions,
@@ -131,6 +134,10 @@ class CollisionAssociation
     std::vector<std::pair<typename TTracks::iterator, typename TTracks::iterator>> trackIterationWindows; // continous regions in which we can count on increasing globalBC numbers
     globalBC.reserve(tracks.size());
     trackBCCache.reserve(tracks.size());
+    std::vector<int64_t> ambiguousTrackBC;
+    if (mIncludeUnassigned) {
+      fillAmbiguousTrackBCs<TTracks>(tracksUnfiltered, ambiguousTracks, ambiguousTrackBC);
+    }
     auto trackBegin = tracks.begin();
     int lastCollisionId = 0;
     if (tracks.size() > 0) {
@@ -142,22 +149,7 @@ class CollisionAssociation
       if (track.has_collision()) {
         trackBC = track.collision().bc().globalBC();
       } else if (mIncludeUnassigned) {
-        for (const auto& ambTrack : ambiguousTracks) {
-          if constexpr (isCentralBarrel) { // FIXME: to be removed as soon as it is possible to use getId<Table>() for joined tables
-            if (ambTrack.trackId() == track.globalIndex()) {
-              if (!ambTrack.has_bc() || ambTrack.bc().size() == 0) {
-                break;
-              }
-              trackBC = ambTrack.bc().begin().globalBC();
-              break;
-            }
-          } else {
-            if (ambTrack.template getId<TTracks>() == track.globalIndex()) {
-              trackBC = ambTrack.bc().begin().globalBC();
-              break;
-            }
-          }
-        }
+        trackBC = ambiguousTrackBC[track.globalIndex()];
       }
       globalBC.push_back(trackBC);
       trackBCCache.push_back(trackBC + track.trackTime() / o2::constants::lhc::LHCBunchSpacingNS);
@@ -178,105 +170,132 @@ class CollisionAssociation
     }
 
     // define vector of vectors to store indices of compatible collisions per track
-    std::vector<std::unique_ptr<std::vector<int>>> collsPerTrack(tracksUnfiltered.size());
+    std::vector<std::unique_ptr<std::vector<int>>> collsPerTrack(mFillTableOfCollIdsPerTrack && !mUseCompactReverseIndices ? tracksUnfiltered.size() : 0);
+    // or, in the compact storage, the number of compatible collisions per track (shifted by one, to become the offsets in the flat array of collisions)
+    // and the (track, collision) pairs in the order of association
+    std::vector<int> collOffsets(mFillTableOfCollIdsPerTrack && mUseCompactReverseIndices ? tracksUnfiltered.size() + 1 : 0, 0);
+    std::vector<std::pair<int, int>> trackCollPairs;
 
     // loop over collisions to find time-compatible tracks
     int64_t bcOffsetMax = mBcWindowForOneSigma * mNumSigmaForTimeCompat + mTimeMargin / o2::constants::lhc::LHCBunchSpacingNS;
-    for (const auto& collision : collisions) {
-      const float collTime = collision.collisionTime();
-      const float collTimeRes2 = collision.collisionTimeRes() * collision.collisionTimeRes();
-      uint64_t collBC = collision.bc().globalBC();
-
-      // This is done per block to allow optimization below. Within each block the globalBC increase continously
-      for (auto& iterationWindow : trackIterationWindows) {
-        bool iteratorMoved = false;
-        const bool isAssignedTrackWindow = (iterationWindow.first != iterationWindow.second) ? iterationWindow.first.has_collision() : false;
-        for (auto track = iterationWindow.first; track != iterationWindow.second; ++track) {
-          int64_t trackBC = globalBC[track.filteredIndex()];
-          if (trackBC < 0) {
-            continue;
+    auto associate = [&](int64_t collIdx, int64_t trackIdx) {
+      LOGP(debug, "Filling track id {} for coll id {}", trackIdx, collIdx);
+      association(collIdx, trackIdx);
+      if (mFillTableOfCollIdsPerTrack) {
+        if (mUseCompactReverseIndices) {
+          collOffsets[trackIdx + 1]++;
+          trackCollPairs.emplace_back(trackIdx, collIdx);
+        } else {
+          if (collsPerTrack[trackIdx] == nullptr) {
+            collsPerTrack[trackIdx] = std::make_unique<std::vector<int>>();
           }
+          collsPerTrack[trackIdx].get()->push_back(collIdx);
+        }
+      }
+    };
 
-          // Optimization to avoid looping over the full track list each time. This builds on that tracks are sorted by BCs (which they should be because collisions are sorted by BCs)
-          const int64_t bcOffset = trackBC - (int64_t)collBC;
-          if constexpr (isCentralBarrel) {
-            // only for blocks with collision association
-            if (isAssignedTrackWindow) {
-              constexpr int margin = 200;
-              if (!iteratorMoved && bcOffset > -bcOffsetMax - margin) {
-                iterationWindow.first.setCursor(track.filteredIndex());
-                iteratorMoved = true;
-                LOGP(debug, "Moving iterator begin {}", track.filteredIndex());
-              } else if (bcOffset > bcOffsetMax + margin) {
-                LOGP(debug, "Stopping iterator {}", track.filteredIndex());
-                break;
-              }
-            }
-          }
+    if (mUseSweepAssociation) {
+      // Sort the tracks once by their time in BC. For each collision, the tracks within the BC window are found by binary search,
+      // such that each collision only visits its candidate tracks, independently of how tracks and collisions are ordered
+      std::vector<std::pair<int64_t, int64_t>> sortedTrackBCs; // time in BC, filtered index of the track
+      sortedTrackBCs.reserve(trackBCCache.size());
+      for (size_t filteredIdx = 0; filteredIdx < trackBCCache.size(); filteredIdx++) {
+        if (globalBC[filteredIdx] >= 0) {
+          sortedTrackBCs.emplace_back(trackBCCache[filteredIdx], filteredIdx);
+        }
+      }
+      std::sort(sortedTrackBCs.begin(), sortedTrackBCs.end());
 
-          int64_t bcOffsetWindow = trackBCCache[track.filteredIndex()] - (int64_t)collBC;
-          if (std::abs(bcOffsetWindow) > bcOffsetMax) {
-            continue;
-          }
+      std::vector<int64_t> compatibleTracks; // filtered indices of the tracks compatible with the current collision
+      auto track = tracks.begin();
+      for (const auto& collision : collisions) {
+        const float collTime = collision.collisionTime();
+        const float collTimeRes2 = collision.collisionTimeRes() * collision.collisionTimeRes();
+        uint64_t collBC = collision.bc().globalBC();
 
-          float trackTime = 0;
-          float trackTimeRes = 0;
-          if constexpr (isCentralBarrel) {
-            if (mUsePvAssociation && track.isPVContributor()) {
-              trackTime = track.collision().collisionTime();        // if PV contributor, we assume the time to be the one of the collision
-              trackTimeRes = o2::constants::lhc::LHCBunchSpacingNS; // 1 BC
-            } else {
-              trackTime = track.trackTime();
-              trackTimeRes = track.trackTimeRes();
-            }
-          } else {
-            trackTime = track.trackTime();
-            trackTimeRes = track.trackTimeRes();
+        compatibleTracks.clear();
+        auto candidate = std::lower_bound(sortedTrackBCs.begin(), sortedTrackBCs.end(), std::make_pair(static_cast<int64_t>(collBC) - bcOffsetMax, static_cast<int64_t>(-1)));
+        for (; candidate != sortedTrackBCs.end() && candidate->first - static_cast<int64_t>(collBC) <= bcOffsetMax; ++candidate) {
+          track.setCursor(candidate->second);
+          if (isTimeCompatible<TTracks>(collision, collBC, collTime, collTimeRes2, track, globalBC[candidate->second])) {
+            compatibleTracks.push_back(candidate->second);
           }
+        }
+        // same order of the associations as in the iteration over the track blocks below
+        std::sort(compatibleTracks.begin(), compatibleTracks.end());
+        for (const auto filteredIdx : compatibleTracks) {
+          track.setCursor(filteredIdx);
+          associate(collision.globalIndex(), track.globalIndex());
+        }
+      }
+    } else {
+      for (const auto& collision : collisions) {
+        const float collTime = collision.collisionTime();
+        const float collTimeRes2 = collision.collisionTimeRes() * collision.collisionTimeRes();
+        uint64_t collBC = collision.bc().globalBC();
 
-          const float deltaTime = trackTime - collTime + bcOffset * o2::constants::lhc::LHCBunchSpacingNS;
-          float sigmaTimeRes2 = collTimeRes2 + trackTimeRes * trackTimeRes;
-          LOGP(debug, "collision time={}, collision time res={}, track time={}, track time res={}, bc collision={}, bc track={}, delta time={}", collTime, collision.collisionTimeRes(), track.trackTime(), track.trackTimeRes(), collBC, trackBC, deltaTime);
+        // This is done per block to allow optimization below. Within each block the globalBC increase continously
+        for (auto& iterationWindow : trackIterationWindows) {
+          bool iteratorMoved = false;
+          const bool isAssignedTrackWindow = (iterationWindow.first != iterationWindow.second) ? iterationWindow.first.has_collision() : false;
+          for (auto track = iterationWindow.first; track != iterationWindow.second; ++track) {
+            int64_t trackBC = globalBC[track.filteredIndex()];
+            if (trackBC < 0) {
+              continue;
+            }
 
-          float thresholdTime = 0.;
-          if constexpr (isCentralBarrel) {
-            if (mUsePvAssociation && track.isPVContributor()) {
-              thresholdTime = trackTimeRes;
-            } else if (TESTBIT(track.flags(), o2::aod::track::TrackTimeResIsRange)) {
-              // the track time resolution is a range, not a gaussian resolution
-              thresholdTime = trackTimeRes + mNumSigmaForTimeCompat * std::sqrt(collTimeRes2) + mTimeMargin;
-            } else {
-              thresholdTime = mNumSigmaForTimeCompat * std::sqrt(sigmaTimeRes2) + mTimeMargin;
+            // Optimization to avoid looping over the full track list each time. This builds on that tracks are sorted by BCs (which they should be because collisions are sorted by BCs)
+            const int64_t bcOffset = trackBC - (int64_t)collBC;
+            if constexpr (isCentralBarrel) {
+              // only for blocks with collision association
+              if (isAssignedTrackWindow) {
+                constexpr int margin = 200;
+                if (!iteratorMoved && bcOffset > -bcOffsetMax - margin) {
+                  iterationWindow.first.setCursor(track.filteredIndex());
+                  iteratorMoved = true;
+                  LOGP(debug, "Moving iterator begin {}", track.filteredIndex());
+                } else if (bcOffset > bcOffsetMax + margin) {
+                  LOGP(debug, "Stopping iterator {}", track.filteredIndex());
+                  break;
+                }
+              }
             }
-          } else {
-            // the track is not a central track
-            if constexpr (TTracks::template contains<o2::aod::MFTTracks>()) {
-              // then the track is an MFT track, or an MFT track with additionnal joined info
-              // in this case TrackTimeResIsRange
-              thresholdTime = trackTimeRes + mNumSigmaForTimeCompat * std::sqrt(collTimeRes2) + mTimeMargin;
-            } else if constexpr (TTracks::template contains<o2::aod::FwdTracks>()) {
-              // the track is a fwd track, with a gaussian time resolution
-              thresholdTime = mNumSigmaForTimeCompat * std::sqrt(sigmaTimeRes2) + mTimeMargin;
+
+            int64_t bcOffsetWindow = trackBCCache[track.filteredIndex()] - (int64_t)collBC;
+            if (std::abs(bcOffsetWindow) > bcOffsetMax) {
+              continue;
             }
-          }
 
-          if (std::abs(deltaTime) < thresholdTime) {
-            const auto collIdx = collision.globalIndex();
-            const auto trackIdx = track.globalIndex();
-            LOGP(debug, "Filling track id {} for coll id {}", trackIdx, collIdx);
-            association(collIdx, trackIdx);
-            if (mFillTableOfCollIdsPerTrack) {
-              if (collsPerTrack[trackIdx] == nullptr) {
-                collsPerTrack[trackIdx] = std::make_unique<std::vector<int>>();
-              }
-              collsPerTrack[trackIdx].get()->push_back(collIdx);
+            if (isTimeCompatible<TTracks>(collision, collBC, collTime, collTimeRes2, track, trackBC)) {
+              associate(collision.globalIndex(), track.globalIndex());
             }
           }
         }
       }
     }
     // create reverse index track to collisions if enabled
-    if (mFillTableOfCollIdsPerTrack) {
+    if (mFillTableOfCollIdsPerTrack && mUseCompactReverseIndices) {
+      // prefix sum of the counts: collOffsets[i] is the first position of the collisions of track i in the flat array
+      for (size_t i = 1; i < collOffsets.size(); i++) {
+        collOffsets[i] += collOffsets[i - 1];
+      }
+      // place the collisions in the order of association. Each offset is moved to the end of its track,
+      // i.e. afterwards the collisions of track i are in [collOffsets[i - 1], collOffsets[i]) with collOffsets[-1] = 0
+      std::vector<int> collIds(trackCollPairs.size());
+      for (const auto& [trackIdx, collIdx] : trackCollPairs) {
+        collIds[collOffsets[trackIdx]++] = collIdx;
+      }
+      trackCollPairs.clear();
+      trackCollPairs.shrink_to_fit();
+
+      std::vector<int> collsOfTrack; // reused for all tracks
+      for (const auto& track : tracksUnfiltered) {
+        const auto trackId = track.globalIndex();
+        const int first = trackId > 0 ? collOffsets[trackId - 1] : 0;
+        collsOfTrack.assign(collIds.begin() + first, collIds.begin() + collOffsets[trackId]);
+        reverseIndices(collsOfTrack);
+      }
+    } else if (mFillTableOfCollIdsPerTrack) {
       std::vector<int> empty{};
       for (const auto& track : tracksUnfiltered) {
 
@@ -291,6 +310,82 @@ class CollisionAssociation
   }
 
  private:
+  /// Checks the time compatibility of a track with a collision
+  /// \param collBC globalBC of the collision
+  /// \param collTimeRes2 squared time resolution of the collision
+  /// \param trackBC globalBC to which the track time refers
+  template <typename TTracks, typename TCollision, typename TTrack>
+  bool isTimeCompatible(TCollision const& collision, uint64_t collBC, float collTime, float collTimeRes2, TTrack const& track, int64_t trackBC)
+  {
+    float trackTime = 0;
+    float trackTimeRes = 0;
+    if constexpr (isCentralBarrel) {
+      if (mUsePvAssociation && track.isPVContributor()) {
+        trackTime = track.collision().collisionTime();        // if PV contributor, we assume the time to be the one of the collision
+        trackTimeRes = o2::constants::lhc::LHCBunchSpacingNS; // 1 BC
+      } else {
+        trackTime = track.trackTime();
+        trackTimeRes = track.trackTimeRes();
+      }
+    } else {
+      trackTime = track.trackTime();
+      trackTimeRes = track.trackTimeRes();
+    }
+
+    const int64_t bcOffset = trackBC - static_cast<int64_t>(collBC);
+    const float deltaTime = trackTime - collTime + bcOffset * o2::constants::lhc::LHCBunchSpacingNS;
+    float sigmaTimeRes2 = collTimeRes2 + trackTimeRes * trackTimeRes;
+    LOGP(debug, "collision time={}, collision time res={}, track time={}, track time res={}, bc collision={}, bc track={}, delta time={}", collTime, collision.collisionTimeRes(), track.trackTime(), track.trackTimeRes(), collBC, trackBC, deltaTime);
+
+    float thresholdTime = 0.;
+    if constexpr (isCentralBarrel) {
+      if (mUsePvAssociation && track.isPVContributor()) {
+        thresholdTime = trackTimeRes;
+      } else if (TESTBIT(track.flags(), o2::aod::track::TrackTimeResIsRange)) {
+        // the track time resolution is a range, not a gaussian resolution
+        thresholdTime = trackTimeRes + mNumSigmaForTimeCompat * std::sqrt(collTimeRes2) + mTimeMargin;
+      } else {
+        thresholdTime = mNumSigmaForTimeCompat * std::sqrt(sigmaTimeRes2) + mTimeMargin;
+      }
+    } else {
+      // the track is not a central track
+      if constexpr (TTracks::template contains<o2::aod::MFTTracks>()) {
+        // then the track is an MFT track, or an MFT track with additionnal joined info
+        // in this case TrackTimeResIsRange
+        thresholdTime = trackTimeRes + mNumSigmaForTimeCompat * std::sqrt(collTimeRes2) + mTimeMargin;
+      } else if constexpr (TTracks::template contains<o2::aod::FwdTracks>()) {
+        // the track is a fwd track, with a gaussian time resolution
+        thresholdTime = mNumSigmaForTimeCompat * std::sqrt(sigmaTimeRes2) + mTimeMargin;
+      }
+    }
+
+    return std::abs(deltaTime) < thresholdTime;
+  }
+
+  /// Fills the first BC of the ambiguous tracks, indexed by track, in one pass over the ambiguous tracks
+  /// -1 for the tracks which are not ambiguous or have no BC. If a track is present more than once, the first entry is used
+  template <typename TTracks, typename TTracksUnfiltered, typename TAmbiTracks>
+  void fillAmbiguousTrackBCs(TTracksUnfiltered const& tracksUnfiltered, TAmbiTracks const& ambiguousTracks, std::vector<int64_t>& ambiguousTrackBC)
+  {
+    ambiguousTrackBC.assign(tracksUnfiltered.size(), -1);
+    std::vector<bool> isFilled(tracksUnfiltered.size(), false);
+    for (const auto& ambTrack : ambiguousTracks) {
+      int64_t trackIdx = -1;
+      if constexpr (isCentralBarrel) { // FIXME: to be removed as soon as it is possible to use getId<Table>() for joined tables
+        trackIdx = ambTrack.trackId();
+      } else {
+        trackIdx = ambTrack.template getId<TTracks>();
+      }
+      if (trackIdx < 0 || trackIdx >= static_cast<int64_t>(ambiguousTrackBC.size()) || isFilled[trackIdx]) {
+        continue;
+      }
+      isFilled[trackIdx] = true;
+      if (ambTrack.has_bc() && ambTrack.bc().size() > 0) {
+        ambiguousTrackBC[trackIdx] = ambTrack.bc().begin().globalBC();
+      }
+    }
+  }
+
   float mNumSigmaForTimeCompat{4.};                                                  // number of sigma for time compatibility
   float mTimeMargin{500.};                                                           // additional time margin in ns
   int mTrackSelection{o2::aod::track_association::TrackSelection::GlobalTrackWoDCA}; // track selection for central barrel tracks (standard association only)
@@ -298,6 +393,8 @@ class CollisionAssociation
   bool mIncludeUnassigned{true};                                                     // include tracks that were originally not assigned to any collision
   bool mFillTableOfCollIdsPerTrack{false};                                           // fill additional table with vectors of compatible collisions per track
   int mBcWindowForOneSigma{115};                                                     // BC window to be multiplied by the number of sigmas to define maximum window to be considered
+  bool mUseSweepAssociation{false};                                                  // find the time-compatible tracks of each collision in the tracks sorted by time, instead of iterating over the track blocks
+  bool mUseCompactReverseIndices{false};                                             // store the collisions per track in flat arrays (CSR) instead of one vector per track
 };
 
 #endif // COMMON_CORE_COLLISIONASSOCIATION_H_
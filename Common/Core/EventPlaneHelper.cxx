@@ -102,6 +102,46 @@ void EventPlaneHelper::SumQvectors(int det, int chno, float ampl, int nmod, TCom
   sum += ampl;
 }
 
+void EventPlaneHelper::FillChannelTable(o2::ft0::Geometry ft0geom, o2::fv0::Geometry* fv0geom, int nHarmMax,
+                                        const std::vector<float>& gainFT0, const std::vector<float>& gainFV0)
+{
+  /* Fill the per-channel table of FT0 and FV0 with the current offsets. The channel
+    centers of FT0 are calculated only once here, instead of once per channel. */
+  mNHarmMaxTable = std::max(nHarmMax, 1);
+
+  auto fillDetector = [this](int nChannels, auto getPhi, const std::vector<float>& gain,
+                             std::vector<double>& phiTable, std::vector<double>& cosTable,
+                             std::vector<double>& sinTable, std::vector<float>& gainTable) {
+    phiTable.resize(nChannels);
+    cosTable.resize(nChannels * mNHarmMaxTable);
+    sinTable.resize(nChannels * mNHarmMaxTable);
+    gainTable.assign(nChannels, 1.);
+    for (int chno = 0; chno < nChannels; chno++) {
+      phiTable[chno] = getPhi(chno);
+      for (int nmod = 1; nmod <= mNHarmMaxTable; nmod++) {
+        cosTable[chno * mNHarmMaxTable + nmod - 1] = TMath::Cos(phiTable[chno] * nmod);
+        sinTable[chno * mNHarmMaxTable + nmod - 1] = TMath::Sin(phiTable[chno] * nmod);
+      }
+      if (chno < static_cast<int>(gain.size())) {
+        gainTable[chno] = gain[chno];
+      }
+    }
+  };
+
+  ft0geom.calculateChannelCenter();
+  fillDetector(
+    NChannelsFT0, [&](int chno) {
+      float offsetX = chno < 96 ? mOffsetFT0AX : 0.; // Offset only for FT0-A, as in GetPhiFT0.
+      float offsetY = chno < 96 ? mOffsetFT0AY : 0.;
+      auto chPos = ft0geom.getChannelCenter(chno);
+      return TMath::ATan2(chPos.Y() + offsetY, chPos.X() + offsetX);
+    },
+    gainFT0, mPhiFT0, mCosFT0, mSinFT0, mGainFT0);
+  fillDetector(
+    NChannelsFV0, [&](int chno) { return GetPhiFV0(chno, fv0geom); },
+    gainFV0, mPhiFV0, mCosFV0, mSinFV0, mGainFV0);
+}
+
 int EventPlaneHelper::GetCentBin(float cent)
 {
   const float centClasses[] = {0., 5., 10., 20., 30., 40., 50., 60., 80.};
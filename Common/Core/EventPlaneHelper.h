@@ -68,6 +68,32 @@ class EventPlaneHelper
   // the detector and amplitude.
   void SumQvectors(int det, int chno, float ampl, int nmod, TComplex& Qvec, float& sum, o2::ft0::Geometry ft0geom, o2::fv0::Geometry* fv0geom);
 
+  // Method to precompute, once per run and after setting the offsets, the azimuthal
+  // angle, cos(n*phi) and sin(n*phi) for n = 1..nHarmMax, and the gain equalisation
+  // factor of each channel in FT0 and FV0. Missing gain factors are set to 1.
+  void FillChannelTable(o2::ft0::Geometry ft0geom, o2::fv0::Geometry* fv0geom, int nHarmMax,
+                        const std::vector<float>& gainFT0 = {}, const std::vector<float>& gainFV0 = {});
+  bool IsChannelTableFilled() const { return mNHarmMaxTable > 0; }
+  int GetNHarmMaxTable() const { return mNHarmMaxTable; }
+
+  // Getters to the channel table, with 'det' = 0 for FT0 and 1 for FV0, and
+  // 'nmod' between 1 and the nHarmMax given to FillChannelTable.
+  double GetPhiTable(int det, int chno) const { return det == 0 ? mPhiFT0[chno] : mPhiFV0[chno]; }
+  double GetCosTable(int det, int chno, int nmod) const { return det == 0 ? mCosFT0[chno * mNHarmMaxTable + nmod - 1] : mCosFV0[chno * mNHarmMaxTable + nmod - 1]; }
+  double GetSinTable(int det, int chno, int nmod) const { return det == 0 ? mSinFT0[chno * mNHarmMaxTable + nmod - 1] : mSinFV0[chno * mNHarmMaxTable + nmod - 1]; }
+  float GetGainTable(int det, int chno) const { return det == 0 ? mGainFT0[chno] : mGainFV0[chno]; }
+
+  // Same as SumQvectors, using the channel table instead of the geometry. The
+  // amplitude is not gain equalised here.
+  void SumQvectorsTable(int det, int chno, float ampl, int nmod, TComplex& Qvec, float& sum) const
+  {
+    Qvec += TComplex(ampl * GetCosTable(det, chno, nmod), ampl * GetSinTable(det, chno, nmod));
+    sum += ampl;
+  }
+
+  static constexpr int NChannelsFT0 = 208; // 96 channels in FT0-A + 112 channels in FT0-C.
+  static constexpr int NChannelsFV0 = 48;
+
   // Method to get the bin corresponding to a centrality percentile, according to the
   // centClasses[] array defined in Tasks/qVectorsQA.cxx.
   // Note: Any change in one task should be reflected in the other.
@@ -108,7 +134,17 @@ class EventPlaneHelper
   double mOffsetFV0rightX = 0.; // X-coordinate of the offset of FV0-A right.
   double mOffsetFV0rightY = 0.; // Y-coordinate of the offset of FV0-A right.
 
-  ClassDefNV(EventPlaneHelper, 2)
+  int mNHarmMaxTable = 0;      //! Maximum harmonic in the channel table, 0 if not filled.
+  std::vector<double> mPhiFT0; //! Azimuthal angle of each FT0 channel.
+  std::vector<double> mCosFT0; //! cos(n*phi) of each FT0 channel, as [chno][n-1].
+  std::vector<double> mSinFT0; //! sin(n*phi) of each FT0 channel, as [chno][n-1].
+  std::vector<float> mGainFT0; //! Gain equalisation factor of each FT0 channel.
+  std::vector<double> mPhiFV0; //! Azimuthal angle of each FV0 channel.
+  std::vector<double> mCosFV0; //! cos(n*phi) of each FV0 channel, as [chno][n-1].
+  std::vector<double> mSinFV0; //! sin(n*phi) of each FV0 channel, as [chno][n-1].
+  std::vector<float> mGainFV0; //! Gain equalisation factor of each FV0 channel.
+
+  ClassDefNV(EventPlaneHelper, 3)
 };
 
 #endif // COMMON_CORE_EVENTPLANEHELPER_H_
@@ -0,0 +1,192 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file  EventPool.h
+/// \brief Event-mixing pool of the last events of each event class.
+///        The events are classified in N dimensions (e.g. z-vertex, multiplicity, event plane), and each class keeps
+///        the payloads of its last events in a ring buffer of fixed depth. The pool is meant to be a task member,
+///        such that it is kept across dataframes; the payload holds what the mixing needs from an event, e.g. the
+///        compact arrays of its selected tracks, or indices to a storage of the task.
+///        The partners of an event are either all the pooled events of its class or a random subset of them,
+///        drawn from a key of the event (e.g. its global index) such that the selection is reproducible.
+///
+
+#ifndef COMMON_CORE_EVENTPOOL_H_
+#define COMMON_CORE_EVENTPOOL_H_
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "Framework/HistogramSpec.h"
+#include "Framework/Logger.h"
+
+namespace eventmixing
+{
+
+/// \tparam EventData  payload of one event, has to be movable
+/// \tparam NDim  number of dimensions of the event classes
+template <typename EventData, int NDim>
+class EventPool
+{
+ public:
+  /// Sets the event classes and the depth and empties the pool.
+  /// The binnings are given in the ConfigurableAxis format: {VARIABLE_WIDTH, edges...} or {nBins, min, max}.
+  /// An empty binning makes a dimension with a single class accepting all values.
+  void init(std::array<std::vector<double>, NDim> const& binnings, int depth)
+  {
+    size_t nClasses = 1;
+    for (int iDim = 0; iDim < NDim; iDim++) {
+      mEdges[iDim] = getEdges(binnings[iDim]);
+      mNBins[iDim] = mEdges[iDim].empty() ? 1 : static_cast<int>(mEdges[iDim].size()) - 1;
+      if (mNBins[iDim] < 1) {
+        LOGF(fatal, "EventPool: binning of dimension %d has no bins", iDim);
+      }
+      nClasses *= mNBins[iDim];
+    }
+    mDepth = std::max(depth, 1);
+    mEvents.assign(nClasses, {});
+    mOldest.assign(nClasses, 0);
+    LOGF(info, "EventPool: %d classes with a depth of %d events", static_cast<int>(nClasses), mDepth);
+  }
+
+  /// Event class for the values of the NDim dimensions, -1 if outside the binning.
+  /// The first dimension runs fastest.
+  template <typename... T>
+  int getClass(T... values) const
+  {
+    static_assert(sizeof...(T) == NDim, "EventPool::getClass needs one value per dimension");
+    const std::array<double, NDim> arrValues{static_cast<double>(values)...};
+    int iClass = 0;
+    for (int iDim = NDim - 1; iDim >= 0; iDim--) {
+      int iBin = 0;
+      if (!mEdges[iDim].empty()) {
+        iBin = findBin(mEdges[iDim], arrValues[iDim]);
+        if (iBin < 0) {
+          return -1;
+        }
+      }
+      iClass = iClass * mNBins[iDim] + iBin;
+    }
+    return iClass;
+  }
+
+  /// Calls func(event) for the pooled events of a class, from the oldest to the newest
+  template <typename Func>
+  void forEachEvent(int iClass, Func&& func) const
+  {
+    if (iClass < 0) {
+      return;
+    }
+    const auto& events = mEvents[iClass];
+    for (size_t i = 0; i < events.size(); i++) {
+      func(events[(mOldest[iClass] + i) % events.size()]);
+    }
+  }
+
+  /// Calls func(event) for up to nPartners pooled events of a class, drawn without repetition.
+  /// The draw only depends on the key and on the content of the class, e.g. not on the order of the dataframes in a job.
+  /// \param key  key of the event to be mixed, e.g. its global index
+  template <typename Func>
+  void forEachRandomEvent(int iClass, int nPartners, uint64_t key, Func&& func) const
+  {
+    if (iClass < 0) {
+      return;
+    }
+    const auto& events = mEvents[iClass];
+    const int nEvents = static_cast<int>(events.size());
+    if (nPartners >= nEvents) {
+      forEachEvent(iClass, std::forward<Func>(func));
+      return;
+    }
+    mOrder.resize(nEvents);
+    std::iota(mOrder.begin(), mOrder.end(), 0);
+    uint64_t state = key;
+    for (int i = 0; i < nPartners; i++) { // partial Fisher-Yates shuffle
+      const int j = i + static_cast<int>(splitMix64(state) % static_cast<uint64_t>(nEvents - i));
+      std::swap(mOrder[i], mOrder[j]);
+      func(events[(mOldest[iClass] + mOrder[i]) % nEvents]);
+    }
+  }
+
+  /// Adds an event to its class, replacing the oldest event if the class is full
+  void add(int iClass, EventData&& event)
+  {
+    if (iClass < 0) {
+      return;
+    }
+    auto& events = mEvents[iClass];
+    if (static_cast<int>(events.size()) < mDepth) {
+      events.push_back(std::move(event));
+      return;
+    }
+    events[mOldest[iClass]] = std::move(event);
+    mOldest[iClass] = (mOldest[iClass] + 1) % mDepth;
+  }
+
+  int getNClasses() const { return static_cast<int>(mEvents.size()); }
+  int getDepth() const { return mDepth; }
+  size_t size(int iClass) const { return iClass < 0 ? 0 : mEvents[iClass].size(); }
+  void clear()
+  {
+    for (auto& events : mEvents) {
+      events.clear();
+    }
+    std::fill(mOldest.begin(), mOldest.end(), 0);
+  }
+
+ private:
+  static std::vector<double> getEdges(std::vector<double> const& bins)
+  {
+    std::vector<double> edges;
+    if (bins.empty()) {
+      return edges;
+    }
+    if (bins[0] == o2::framework::VARIABLE_WIDTH) {
+      edges.assign(bins.begin() + 1, bins.end());
+    } else if (bins.size() >= 3) {
+      int n = static_cast<int>(bins[0]);
+      for (int i = 0; i <= n; i++) {
+        edges.push_back(bins[1] + (bins[2] - bins[1]) * i / n);
+      }
+    }
+    return edges;
+  }
+  static int findBin(std::vector<double> const& edges, double value)
+  {
+    if (value < edges.front() || value >= edges.back()) {
+      return -1;
+    }
+    return std::upper_bound(edges.begin(), edges.end(), value) - edges.begin() - 1;
+  }
+  static uint64_t splitMix64(uint64_t& state)
+  {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  }
+
+  std::array<std::vector<double>, NDim> mEdges;
+  std::array<int, NDim> mNBins{};
+  int mDepth = 1;
+  std::vector<std::vector<EventData>> mEvents; // pooled events of each class, ring buffer of depth mDepth
+  std::vector<int> mOldest;                    // position of the oldest event of each full class
+  mutable std::vector<int> mOrder;             // buffer of the random draws
+};
+
+} // namespace eventmixing
+
+#endif // COMMON_CORE_EVENTPOOL_H_
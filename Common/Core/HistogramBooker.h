@@ -0,0 +1,162 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file  HistogramBooker.h
+/// \brief Booking of the histograms of a HistogramRegistry in groups, each group being booked only if it is used
+///        (e.g. if its process function is enabled), with an estimate of the memory of each group.
+///
+///        Usage:
+///          HistogramBooker booker(registry);
+///          booker.setGroup("data", doprocessData);  // histograms added from now on belong to the group "data"
+///          booker.add("hPt", "#it{p}_{T}", {HistType::kTH1F, {axisPt}});
+///          booker.setGroup("mc", doprocessMc);
+///          booker.add("hPtGen", ...);
+///          booker.print();                          // memory per group, booked or not
+///
+///        The histograms of a group that is not booked must not be filled: HIST-based fills of the registry
+///        require the histogram to exist, so the booking cannot be deferred to the first fill.
+///
+
+#ifndef COMMON_CORE_HISTOGRAMBOOKER_H_
+#define COMMON_CORE_HISTOGRAMBOOKER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Framework/HistogramRegistry.h"
+#include "Framework/HistogramSpec.h"
+#include "Framework/Logger.h"
+
+namespace o2::analysis
+{
+
+/// Estimated memory of the bin contents of a histogram in bytes, excluding the memory of the ROOT objects.
+/// Sparse histograms only allocate the filled bins, their estimate is 0.
+inline double estimateHistogramSize(o2::framework::HistogramConfigSpec const& spec, bool callSumw2 = false)
+{
+  using o2::framework::HistType;
+  double nCells = 1.;
+  for (const auto& axis : spec.axes) {
+    const int nBins = axis.nBins ? *axis.nBins : static_cast<int>(axis.binEdges.size()) - 1;
+    nCells *= nBins + 2; // with underflow and overflow
+  }
+  double bytesPerCell = 0.;
+  switch (spec.type) {
+    case HistType::kTH1C:
+    case HistType::kTH2C:
+    case HistType::kTH3C:
+    case HistType::kTHnC:
+      bytesPerCell = 1.;
+      break;
+    case HistType::kTH1S:
+    case HistType::kTH2S:
+    case HistType::kTH3S:
+    case HistType::kTHnS:
+      bytesPerCell = 2.;
+      break;
+    case HistType::kTH1I:
+    case HistType::kTH2I:
+    case HistType::kTH3I:
+    case HistType::kTHnI:
+    case HistType::kTH1F:
+    case HistType::kTH2F:
+    case HistType::kTH3F:
+    case HistType::kTHnF:
+    case HistType::kStepTHnF:
+      bytesPerCell = 4.;
+      break;
+    case HistType::kTH1D:
+    case HistType::kTH2D:
+    case HistType::kTH3D:
+    case HistType::kTHnD:
+    case HistType::kTHnL:
+    case HistType::kStepTHnD:
+      bytesPerCell = 8.;
+      break;
+    case HistType::kTProfile:
+    case HistType::kTProfile2D:
+    case HistType::kTProfile3D:
+      bytesPerCell = 3. * 8.; // contents, sum of squares and entries per bin
+      break;
+    default: // sparse histograms
+      return 0.;
+  }
+  if (callSumw2) {
+    bytesPerCell += 8.;
+  }
+  return nCells * bytesPerCell;
+}
+
+class HistogramBooker
+{
+ public:
+  explicit HistogramBooker(o2::framework::HistogramRegistry& registry) : mRegistry(registry) {}
+
+  /// Starts a group: the histograms added from now on are booked only if the group is enabled
+  void setGroup(std::string const& name, bool enabled)
+  {
+    mGroups.push_back({name, enabled, 0, 0.});
+  }
+
+  /// Adds a histogram to the current group, returns nullptr if the group is not booked
+  template <typename T = TH1>
+  std::shared_ptr<T> add(char const* name, char const* title, o2::framework::HistogramConfigSpec const& spec, bool callSumw2 = false)
+  {
+    if (mGroups.empty()) {
+      setGroup("default", true);
+    }
+    auto& group = mGroups.back();
+    group.nHistograms++;
+    group.size += estimateHistogramSize(spec, callSumw2);
+    if (!group.enabled) {
+      return nullptr;
+    }
+    return mRegistry.add<T>(name, title, spec, callSumw2);
+  }
+
+  /// Estimated memory of the booked histograms in bytes
+  double getBookedSize() const
+  {
+    double size = 0.;
+    for (const auto& group : mGroups) {
+      size += group.enabled ? group.size : 0.;
+    }
+    return size;
+  }
+
+  /// Prints the number of histograms and the estimated memory of each group
+  void print() const
+  {
+    double sizeBooked = 0., sizeSkipped = 0.;
+    for (const auto& group : mGroups) {
+      LOGF(info, "Histogram group %s: %d histograms, %.1f MB, %s", group.name, group.nHistograms, group.size / (1024. * 1024.), group.enabled ? "booked" : "not booked");
+      (group.enabled ? sizeBooked : sizeSkipped) += group.size;
+    }
+    LOGF(info, "Histogram groups: %.1f MB booked, %.1f MB not booked (sparse histograms not included)", sizeBooked / (1024. * 1024.), sizeSkipped / (1024. * 1024.));
+  }
+
+ private:
+  struct Group {
+    std::string name;
+    bool enabled;
+    int nHistograms;
+    double size; // estimated memory in bytes
+  };
+
+  o2::framework::HistogramRegistry& mRegistry;
+  std::vector<Group> mGroups;
+};
+
+} // namespace o2::analysis
+
+#endif // COMMON_CORE_HISTOGRAMBOOKER_H_
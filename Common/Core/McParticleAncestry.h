@@ -0,0 +1,212 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+//
+// Heavy-flavour ancestry of the MC particles of a data frame, computed once from the mother links.
+// For each particle it stores the closest charm- and beauty-hadron ancestors with their distance in the
+// decay tree, the charm-hadron origin and a hash of the decay chain up to the closest heavy-flavour hadron.
+// It is used by the fast-path variants of the RecoDecay MC matching functions to skip the mother-chain
+// walks of particles which do not descend from a heavy-flavour hadron.
+//
+
+#ifndef COMMON_CORE_MCPARTICLEANCESTRY_H_
+#define COMMON_CORE_MCPARTICLEANCESTRY_H_
+
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+
+class McParticleAncestry
+{
+ public:
+  /// Charm hadrons (and quarkonia) as selected in RecoDecay::getCharmHadronOrigin
+  static bool isCharmHadron(int pdg)
+  {
+    pdg = std::abs(pdg);
+    return pdg / 100 == 4 || pdg / 1000 == 4;
+  }
+  /// Beauty hadrons (and quarkonia) as selected in RecoDecay::getCharmHadronOrigin
+  static bool isBeautyHadron(int pdg)
+  {
+    pdg = std::abs(pdg);
+    return pdg / 100 == 5 || pdg / 1000 == 5;
+  }
+
+  void clear()
+  {
+    mOffset = 0;
+    mCharmAncestors.clear();
+    mBeautyAncestors.clear();
+    mCharmDepths.clear();
+    mBeautyDepths.clear();
+    mIsCharm.clear();
+    mChainHashes.clear();
+  }
+  size_t size() const { return mCharmAncestors.size(); }
+  bool empty() const { return mCharmAncestors.empty(); }
+
+  /// Computes the ancestry of all the particles of the table.
+  /// Each particle is processed once, after its mothers, so the cost is linear in the number of mother links.
+  /// \param particlesMC  table with MC particles
+  template <typename T>
+  void build(const T& particlesMC)
+  {
+    clear();
+    mOffset = particlesMC.offset();
+    const size_t nParticles = particlesMC.size();
+
+    // copy the columns used in the traversal
+    std::vector<int> pdgCodes(nParticles);
+    std::vector<int64_t> mothersFirst(nParticles, -1);
+    std::vector<int64_t> mothersLast(nParticles, -2);
+    for (const auto& particle : particlesMC) {
+      const auto row = particle.globalIndex() - mOffset;
+      pdgCodes[row] = particle.pdgCode();
+      if (particle.has_mothers()) {
+        mothersFirst[row] = particle.mothersIds().front() - mOffset;
+        mothersLast[row] = particle.mothersIds().back() - mOffset;
+      }
+    }
+
+    mCharmAncestors.assign(nParticles, -1);
+    mBeautyAncestors.assign(nParticles, -1);
+    mCharmDepths.assign(nParticles, 0);
+    mBeautyDepths.assign(nParticles, 0);
+    mIsCharm.assign(nParticles, false);
+    mChainHashes.assign(nParticles, 0);
+    for (size_t row = 0; row < nParticles; ++row) {
+      mIsCharm[row] = isCharmHadron(pdgCodes[row]);
+    }
+
+    // depth-first traversal of the mother links, with mothers completed before their daughters
+    enum : uint8_t { NotVisited = 0,
+                     InProgress,
+                     Done };
+    std::vector<uint8_t> states(nParticles, NotVisited);
+    std::vector<int64_t> stack;
+    auto isValid = [nParticles](int64_t row) { return row >= 0 && row < static_cast<int64_t>(nParticles); };
+    for (size_t start = 0; start < nParticles; ++start) {
+      if (states[start] != NotVisited) {
+        continue;
+      }
+      stack.push_back(start);
+      while (!stack.empty()) {
+        const auto row = stack.back();
+        if (states[row] == NotVisited) {
+          states[row] = InProgress;
+          for (auto iMother = mothersFirst[row]; iMother <= mothersLast[row]; ++iMother) {
+            if (isValid(iMother) && states[iMother] == NotVisited) {
+              stack.push_back(iMother);
+            }
+          }
+          continue;
+        }
+        stack.pop_back();
+        if (states[row] == Done) {
+          continue;
+        }
+        // all mothers are done, except those in a (malformed) loop, which are ignored
+        for (auto iMother = mothersFirst[row]; iMother <= mothersLast[row]; ++iMother) {
+          if (!isValid(iMother) || states[iMother] != Done) {
+            continue;
+          }
+          updateClosest(mCharmAncestors[row], mCharmDepths[row], iMother, isCharmHadron(pdgCodes[iMother]), mCharmAncestors[iMother], mCharmDepths[iMother]);
+          updateClosest(mBeautyAncestors[row], mBeautyDepths[row], iMother, isBeautyHadron(pdgCodes[iMother]), mBeautyAncestors[iMother], mBeautyDepths[iMother]);
+        }
+        // decay chain along the first mothers
+        const auto iFirstMother = mothersFirst[row];
+        if (isValid(iFirstMother) && states[iFirstMother] == Done) {
+          const bool isHf = isCharmHadron(pdgCodes[iFirstMother]) || isBeautyHadron(pdgCodes[iFirstMother]);
+          if (isHf || mChainHashes[iFirstMother] != 0) {
+            mChainHashes[row] = hashCombine(isHf ? HashSeed : mChainHashes[iFirstMother], std::abs(pdgCodes[iFirstMother]));
+          }
+        }
+        states[row] = Done;
+      }
+    }
+  }
+
+  /// Index of the closest charm-hadron ancestor, -1 if none
+  int64_t getCharmAncestor(int64_t globalIndex) const { return toGlobal(mCharmAncestors[globalIndex - mOffset]); }
+  /// Index of the closest beauty-hadron ancestor, -1 if none
+  int64_t getBeautyAncestor(int64_t globalIndex) const { return toGlobal(mBeautyAncestors[globalIndex - mOffset]); }
+  /// Number of generations to the closest charm-hadron ancestor, 0 if none
+  int getCharmDepth(int64_t globalIndex) const { return mCharmDepths[globalIndex - mOffset]; }
+  /// Number of generations to the closest beauty-hadron ancestor, 0 if none
+  int getBeautyDepth(int64_t globalIndex) const { return mBeautyDepths[globalIndex - mOffset]; }
+  /// Hash of the PDG codes of the first-mother chain up to the closest heavy-flavour hadron, 0 if the chain has none.
+  /// Daughters of the same decay chain share the hash.
+  uint64_t getDecayChainHash(int64_t globalIndex) const { return mChainHashes[globalIndex - mOffset]; }
+
+  /// Origin (0: none, 1: prompt, 2: nonprompt) as returned by RecoDecay::getCharmHadronOrigin without searching up to the quark
+  int getOrigin(int64_t globalIndex) const
+  {
+    const auto row = globalIndex - mOffset;
+    if (mBeautyDepths[row] > 0) {
+      return 2;
+    }
+    if (mIsCharm[row] || mCharmDepths[row] > 0) {
+      return 1;
+    }
+    return 0;
+  }
+
+  /// Whether a mother with the PDG code pdgMother can be found within depthMax generations (all if depthMax < 0).
+  /// It is false only when the answer is certain, i.e. for charm- or beauty-hadron mothers missing in the ancestry.
+  bool mayHaveMother(int64_t globalIndex, int pdgMother, int depthMax = -1) const
+  {
+    int depth;
+    if (isCharmHadron(pdgMother)) {
+      depth = mCharmDepths[globalIndex - mOffset];
+    } else if (isBeautyHadron(pdgMother)) {
+      depth = mBeautyDepths[globalIndex - mOffset];
+    } else {
+      return true;
+    }
+    return depth > 0 && (depthMax < 0 || depth <= depthMax);
+  }
+
+ private:
+  static constexpr uint64_t HashSeed = 14695981039346656037ULL; // FNV-1a offset basis
+  static constexpr uint64_t HashPrime = 1099511628211ULL;       // FNV-1a prime
+
+  static uint64_t hashCombine(uint64_t hash, int value)
+  {
+    return (hash ^ static_cast<uint64_t>(value)) * HashPrime;
+  }
+
+  int64_t toGlobal(int64_t row) const { return row < 0 ? -1 : row + mOffset; }
+
+  /// Keeps the closest ancestor; for equal distances, the one reached through the first mother is kept,
+  /// as in the breadth-first search of RecoDecay::getCharmHadronOrigin.
+  static void updateClosest(int64_t& ancestor, int& depth, int64_t iMother, bool isMotherSelected, int64_t ancestorMother, int depthMother)
+  {
+    if (isMotherSelected) {
+      if (depth != 1) {
+        ancestor = iMother;
+        depth = 1;
+      }
+    } else if (depthMother > 0 && (depth == 0 || depthMother + 1 < depth)) {
+      ancestor = ancestorMother;
+      depth = depthMother + 1;
+    }
+  }
+
+  int64_t mOffset = 0;                   // global index of the first particle
+  std::vector<int64_t> mCharmAncestors;  // row of the closest charm-hadron ancestor
+  std::vector<int64_t> mBeautyAncestors; // row of the closest beauty-hadron ancestor
+  std::vector<int> mCharmDepths;         // generations to the closest charm-hadron ancestor
+  std::vector<int> mBeautyDepths;        // generations to the closest beauty-hadron ancestor
+  std::vector<bool> mIsCharm;            // particle is itself a charm hadron
+  std::vector<uint64_t> mChainHashes;    // decay-chain hash
+};
+
+#endif // COMMON_CORE_MCPARTICLEANCESTRY_H_
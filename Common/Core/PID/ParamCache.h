@@ -0,0 +1,157 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   ParamCache.h
+/// \brief  Run-keyed cache of PID parametrization objects with validity intervals.
+///         Objects valid over a run are prefetched at its first timestamp and
+///         the following lookups are served from memory.
+///
+
+#ifndef COMMON_CORE_PID_PARAMCACHE_H_
+#define COMMON_CORE_PID_PARAMCACHE_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+
+// O2 includes
+#include "CCDB/CcdbApi.h"
+#include "Framework/Logger.h"
+
+namespace o2::pid
+{
+
+/// \brief Interval map of parametrization objects, keyed by the start of their validity
+template <typename T>
+class ParamCache
+{
+ public:
+  /// Function fetching the object valid for a timestamp, it returns the owned object and its validity [validFrom, validUntil)
+  using Fetcher = std::function<std::unique_ptr<T>(int64_t timestamp, int64_t& validFrom, int64_t& validUntil)>;
+
+  ParamCache() = default;
+  ~ParamCache() = default;
+
+  /// Instance shared by all the tasks of the device, one per key (e.g. CCDB path and pass)
+  static ParamCache& getShared(const std::string& key)
+  {
+    static std::map<std::string, ParamCache> caches;
+    return caches[key];
+  }
+
+  /// Fetcher retrieving the objects from CCDB, optionally falling back to the query without metadata
+  static Fetcher ccdbFetcher(o2::ccdb::CcdbApi& ccdbApi, const std::string& path, const std::map<std::string, std::string>& metadata, const bool fallbackWithoutMetadata = true)
+  {
+    return [&ccdbApi, path, metadata, fallbackWithoutMetadata](int64_t timestamp, int64_t& validFrom, int64_t& validUntil) {
+      std::map<std::string, std::string> headers;
+      T* object = ccdbApi.retrieveFromTFileAny<T>(path, metadata, timestamp, &headers);
+      if (!object && fallbackWithoutMetadata && !metadata.empty()) {
+        LOGP(warning, "Could not find object in {} for the requested metadata, falling back to latest uploaded object", path);
+        headers.clear();
+        object = ccdbApi.retrieveFromTFileAny<T>(path, std::map<std::string, std::string>{}, timestamp, &headers);
+      }
+      if (object) {
+        validFrom = std::strtoll(headers["Valid-From"].c_str(), nullptr, 0);
+        validUntil = std::strtoll(headers["Valid-Until"].c_str(), nullptr, 0);
+      }
+      return std::unique_ptr<T>(object);
+    };
+  }
+
+  void setFetcher(Fetcher fetcher) { mFetcher = std::move(fetcher); }
+  bool hasFetcher() const { return static_cast<bool>(mFetcher); }
+
+  /// Gets the object valid for a timestamp, fetching it only if no cached interval contains the timestamp
+  /// \return the object or nullptr if it could not be fetched
+  T* get(const int64_t timestamp)
+  {
+    if (mLast != mIntervals.end() && timestamp >= mLast->first && timestamp < mLast->second.first) {
+      return mLast->second.second.get();
+    }
+    auto it = mIntervals.upper_bound(timestamp);
+    if (it != mIntervals.begin() && timestamp < std::prev(it)->second.first) {
+      mLast = std::prev(it);
+      return mLast->second.second.get();
+    }
+    return fetch(timestamp);
+  }
+
+  /// Prefetches all the objects valid over a run, to be called at its first timestamp
+  /// \param runNumber is the run number, nothing is done if the run was already prefetched
+  /// \param runStart is the start of run timestamp
+  /// \param runEnd is the end of run timestamp
+  /// \param maxObjects is the maximum number of objects to fetch
+  void prefetchRun(const int runNumber, const int64_t runStart, const int64_t runEnd, const int maxObjects = 100)
+  {
+    if (runNumber == mRunNumber) {
+      return;
+    }
+    mRunNumber = runNumber;
+    int nObjects = 0;
+    for (int64_t timestamp = runStart; timestamp < runEnd && nObjects < maxObjects; nObjects++) {
+      if (!get(timestamp)) {
+        break;
+      }
+      timestamp = mLast->second.first;
+    }
+    LOGP(info, "Prefetched {} parametrization objects for run {} ({} in cache)", nObjects, runNumber, mIntervals.size());
+  }
+
+  std::size_t size() const { return mIntervals.size(); }
+  void clear()
+  {
+    mIntervals.clear();
+    mLast = mIntervals.end();
+    mRunNumber = -1;
+  }
+
+ private:
+  using Interval = std::pair<int64_t, std::unique_ptr<T>>;                 /// End of validity and object
+  std::map<int64_t, Interval> mIntervals;                                  /// Objects keyed by the start of their validity
+  typename std::map<int64_t, Interval>::iterator mLast = mIntervals.end(); /// Last interval used
+  Fetcher mFetcher;                                                        /// Function fetching objects missing in the cache
+  int mRunNumber = -1;                                                     /// Last prefetched run
+
+  T* fetch(const int64_t timestamp)
+  {
+    if (!mFetcher) {
+      LOG(fatal) << "No fetcher set for the parametrization cache";
+    }
+    int64_t validFrom = timestamp;
+    int64_t validUntil = timestamp + 1;
+    auto object = mFetcher(timestamp, validFrom, validUntil);
+    if (!object) {
+      return nullptr;
+    }
+    if (validFrom > timestamp || validUntil <= timestamp) { // inconsistent validity, cache only for this timestamp
+      validFrom = timestamp;
+      validUntil = timestamp + 1;
+    }
+    LOGP(debug, "Caching parametrization object valid in [{}, {})", validFrom, validUntil);
+    auto [it, inserted] = mIntervals.try_emplace(validFrom, validUntil, std::move(object));
+    if (!inserted) { // same start of validity, objects already handed out are kept alive
+      it->second.first = std::max(it->second.first, validUntil);
+    }
+    mLast = it;
+    return mLast->second.second.get();
+  }
+};
+
+} // namespace o2::pid
+
+#endif // COMMON_CORE_PID_PARAMCACHE_H_
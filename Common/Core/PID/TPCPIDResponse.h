@@ -18,6 +18,7 @@
 #define COMMON_CORE_PID_TPCPIDRESPONSE_H_
 
 #include <array>
+#include <cstddef>
 #include <vector>
 #include <cmath>
 #include "Framework/Logger.h"
@@ -85,6 +86,11 @@ class Response
   float GetSignalDelta(const TrackType& trk, const o2::track::PID::ID id) const;
   /// Gets relative dEdx resolution contribution due to relative pt resolution
   float GetRelativeResolutiondEdx(const float p, const float mass, const float charge, const float resol) const;
+  /// Bulk evaluation of expected signal, expected sigma and number of sigmas for all species
+  /// Inputs are SoA arrays of nTracks entries, outputs are filled per species: out[id * nTracks + iTrack]
+  void GetNumberOfSigmaBulk(const std::size_t nTracks, const bool* hasTPC, const float* tpcInnerParam, const float* tpcSignal, const float* tpcNClsFound,
+                            const float* tgl, const float* signed1Pt, const float* multTPC,
+                            float* expSignal, float* expSigma, float* nSigma) const;
 
   void PrintAll() const;
 
@@ -197,6 +203,56 @@ inline float Response::GetRelativeResolutiondEdx(const float p, const float mass
   return deltaRel;
 }
 
+/// Bulk evaluation over a whole dataframe, equivalent to calling GetExpectedSignal, GetExpectedSigma and GetNumberOfSigma per track and species.
+/// The loops over tracks run on contiguous arrays with the species constants hoisted and without early returns, so that they can be vectorised by the compiler.
+inline void Response::GetNumberOfSigmaBulk(const std::size_t nTracks, const bool* hasTPC, const float* tpcInnerParam, const float* tpcSignal, const float* tpcNClsFound,
+                                           const float* tgl, const float* signed1Pt, const float* multTPC,
+                                           float* expSignal, float* expSigma, float* nSigma) const
+{
+  const float kp1 = mBetheBlochParams[0], kp2 = mBetheBlochParams[1], kp3 = mBetheBlochParams[2], kp4 = mBetheBlochParams[3], kp5 = mBetheBlochParams[4];
+  for (int id = 0; id < o2::track::PID::NIDs; id++) {
+    const float mass = o2::track::pid_constants::sMasses[id];
+    const float invMass = 1.f / mass;
+    const float chargeFactor = std::pow(static_cast<float>(o2::track::pid_constants::sCharges[id]), mChargeFactor);
+    float* signalId = expSignal + id * nTracks;
+    float* sigmaId = expSigma + id * nTracks;
+    float* nSigmaId = nSigma + id * nTracks;
+
+    // expected signal
+    for (std::size_t i = 0; i < nTracks; i++) {
+      const float bethe = mMIP * o2::tpc::BetheBlochAleph(tpcInnerParam[i] * invMass, kp1, kp2, kp3, kp4, kp5) * chargeFactor;
+      signalId[i] = (hasTPC[i] && bethe >= 0.f) ? bethe : -999.f;
+    }
+
+    // expected resolution
+    if (mUseDefaultResolutionParam) {
+      for (std::size_t i = 0; i < nTracks; i++) {
+        const float reso = signalId[i] * mResolutionParamsDefault[0] * (tpcNClsFound[i] > 0 ? std::sqrt(1. + mResolutionParamsDefault[1] / tpcNClsFound[i]) : 1.f);
+        sigmaId[i] = (hasTPC[i] && reso >= 0.f) ? reso : -999.f;
+      }
+    } else {
+      for (std::size_t i = 0; i < nTracks; i++) {
+        const double ncl = nClNorm / tpcNClsFound[i];
+        const double p = tpcInnerParam[i];
+        const double dEdx = o2::tpc::BetheBlochAleph(static_cast<float>(p / mass), kp1, kp2, kp3, kp4, kp5) * chargeFactor;
+        const double relReso = GetRelativeResolutiondEdx(p, mass, o2::track::pid_constants::sCharges[id], mResolutionParams[3]);
+        const double invdEdx = 1.f / dEdx;
+        const double sqrtNcl = std::sqrt(ncl);
+        const double mult = multTPC[i] / mMultNormalization;
+        const double dEdxTgl = invdEdx / std::sqrt(1. + static_cast<double>(tgl[i]) * tgl[i]);
+        const float reso = std::sqrt(mResolutionParams[0] * mResolutionParams[0] * invdEdx + mResolutionParams[1] * mResolutionParams[1] * (sqrtNcl * mResolutionParams[5]) * std::pow(dEdxTgl, mResolutionParams[2]) + sqrtNcl * relReso * relReso + std::pow(mResolutionParams[4] * signed1Pt[i], 2) + std::pow(mult * mResolutionParams[6], 2) + std::pow(mult * dEdxTgl * mResolutionParams[7], 2)) * dEdx * mMIP;
+        sigmaId[i] = (hasTPC[i] && reso >= 0.f) ? reso : -999.f;
+      }
+    }
+
+    // number of sigmas
+    for (std::size_t i = 0; i < nTracks; i++) {
+      const bool valid = hasTPC[i] && signalId[i] >= 0.f && sigmaId[i] >= 0.f;
+      nSigmaId[i] = valid ? (tpcSignal[i] - signalId[i]) / sigmaId[i] : -999.f;
+    }
+  }
+}
+
 inline void Response::PrintAll() const
 {
   LOGP(info, "==== TPC PID response parameters: ====");
@@ -25,6 +25,7 @@
 
 #include "TMCProcess.h" // for VMC Particle Production Process
 #include "CommonConstants/MathConstants.h"
+#include "Common/Core/McParticleAncestry.h"
 
 /// Base class for calculating properties of reconstructed decays
 ///
@@ -439,6 +440,81 @@ struct RecoDecay {
     return std::sqrt(m2(args...));
   }
 
+  /// Calculates invariant mass squared from momenta of several particles (prongs) with masses known at compile time.
+  /// \note Same as m2(arrMom, arrMass) up to rounding, with the squared masses computed at compile time.
+  /// \param masses  masses of the prongs (in the same order as arrMom)
+  /// \param arrMom  array of 3-momentum arrays, one per mass
+  /// \return invariant mass squared
+  template <double... masses, typename T>
+  static double m2(const std::array<std::array<T, 3>, sizeof...(masses)>& arrMom)
+  {
+    constexpr std::array<double, sizeof...(masses)> arrMassSquared{(masses * masses)...};
+    std::array<double, 3> momTotal{0., 0., 0.}; // candidate momentum vector
+    double energyTot{0.};                        // candidate energy
+    for (std::size_t iProng = 0; iProng < sizeof...(masses); ++iProng) {
+      for (std::size_t iMom = 0; iMom < 3; ++iMom) {
+        momTotal[iMom] += arrMom[iProng][iMom];
+      } // loop over momentum components
+      energyTot += std::sqrt(p2(arrMom[iProng]) + arrMassSquared[iProng]);
+    } // loop over prongs
+    return energyTot * energyTot - p2(momTotal);
+  }
+
+  /// Calculates invariant mass from momenta of several particles (prongs) with masses known at compile time.
+  /// \param masses  masses of the prongs (in the same order as arrMom)
+  /// \param arrMom  array of 3-momentum arrays, one per mass
+  /// \return invariant mass
+  template <double... masses, typename T>
+  static double m(const std::array<std::array<T, 3>, sizeof...(masses)>& arrMom)
+  {
+    return std::sqrt(m2<masses...>(arrMom));
+  }
+
+  /// Calculates invariant masses squared of several particles (prongs) for several mass hypotheses.
+  /// The total momentum and the momenta of the prongs are computed once for all hypotheses.
+  /// \note Same as calling m2(arrMom, arrMass) for each hypothesis, up to rounding.
+  /// \param N  number of prongs
+  /// \param NHypotheses  number of mass hypotheses
+  /// \param arrMom  array of N 3-momentum arrays
+  /// \param arrMasses  array of mass hypotheses, each being an array of N masses (in the same order as arrMom)
+  /// \return array of invariant masses squared (in the same order as arrMasses)
+  template <std::size_t N, std::size_t NHypotheses, typename T, typename U>
+  static std::array<double, NHypotheses> m2Hypotheses(const std::array<std::array<T, 3>, N>& arrMom, const std::array<std::array<U, N>, NHypotheses>& arrMasses)
+  {
+    std::array<double, 3> momTotal{0., 0., 0.}; // candidate momentum vector
+    std::array<double, N> arrMomSquared{};       // momenta squared of the prongs
+    for (std::size_t iProng = 0; iProng < N; ++iProng) {
+      for (std::size_t iMom = 0; iMom < 3; ++iMom) {
+        momTotal[iMom] += arrMom[iProng][iMom];
+      } // loop over momentum components
+      arrMomSquared[iProng] = p2(arrMom[iProng]);
+    } // loop over prongs
+    const double momTotalSquared = p2(momTotal);
+    std::array<double, NHypotheses> arrM2{};
+    for (std::size_t iHypothesis = 0; iHypothesis < NHypotheses; ++iHypothesis) {
+      double energyTot{0.}; // candidate energy
+      for (std::size_t iProng = 0; iProng < N; ++iProng) {
+        energyTot += std::sqrt(arrMomSquared[iProng] + sq(arrMasses[iHypothesis][iProng]));
+      } // loop over prongs
+      arrM2[iHypothesis] = energyTot * energyTot - momTotalSquared;
+    } // loop over hypotheses
+    return arrM2;
+  }
+
+  /// Calculates invariant masses of several particles (prongs) for several mass hypotheses.
+  /// \param arrMom  array of N 3-momentum arrays
+  /// \param arrMasses  array of mass hypotheses, each being an array of N masses (in the same order as arrMom)
+  /// \return array of invariant masses (in the same order as arrMasses)
+  template <std::size_t N, std::size_t NHypotheses, typename T, typename U>
+  static std::array<double, NHypotheses> mHypotheses(const std::array<std::array<T, 3>, N>& arrMom, const std::array<std::array<U, N>, NHypotheses>& arrMasses)
+  {
+    auto arrM = m2Hypotheses(arrMom, arrMasses);
+    for (auto& mass : arrM) {
+      mass = std::sqrt(mass);
+    }
+    return arrM;
+  }
+
   // Calculation of topological quantities
 
   /// Calculates impact parameter in the bending plane of the particle w.r.t. a point
@@ -587,6 +663,27 @@ struct RecoDecay {
     return indexMother;
   }
 
+  /// Finds the mother of an MC particle, skipping the mother-chain walk when the precomputed ancestry excludes the expected mother.
+  /// \param ancestry  heavy-flavour ancestry of particlesMC
+  /// \note Same result as getMother without ancestry; the walk is skipped for charm- and beauty-hadron mothers absent from the ancestry.
+  template <bool acceptFlavourOscillation = false, typename T>
+  static int getMother(const T& particlesMC,
+                       const McParticleAncestry& ancestry,
+                       const typename T::iterator& particle,
+                       int PDGMother,
+                       bool acceptAntiParticles = false,
+                       int8_t* sign = nullptr,
+                       int8_t depthMax = -1)
+  {
+    if (!ancestry.mayHaveMother(particle.globalIndex(), PDGMother, depthMax)) {
+      if (sign) {
+        *sign = 0;
+      }
+      return -1;
+    }
+    return getMother<acceptFlavourOscillation>(particlesMC, particle, PDGMother, acceptAntiParticles, sign, depthMax);
+  }
+
   /// Gets the complete list of indices of final-state daughters of an MC particle.
   /// \param checkProcess  switch to accept only decay daughters by checking the production process of MC particles
   /// \param particle  MC particle
@@ -782,6 +879,34 @@ struct RecoDecay {
     return indexMother;
   }
 
+  /// Checks whether the reconstructed decay candidate is the expected decay, using the precomputed ancestry to reject
+  /// candidates whose first prong does not descend from the expected mother.
+  /// \param ancestry  heavy-flavour ancestry of particlesMC
+  /// \note Same result as getMatchedMCRec without ancestry.
+  template <bool acceptFlavourOscillation = false, bool checkProcess = false, std::size_t N, typename T, typename U>
+  static int getMatchedMCRec(const T& particlesMC,
+                             const McParticleAncestry& ancestry,
+                             const std::array<U, N>& arrDaughters,
+                             int PDGMother,
+                             std::array<int, N> arrPDGDaughters,
+                             bool acceptAntiParticles = false,
+                             int8_t* sign = nullptr,
+                             int depthMax = 1)
+  {
+    if (sign) {
+      *sign = 0;
+    }
+    for (std::size_t iProng = 0; iProng < N; ++iProng) {
+      if (!arrDaughters[iProng].has_mcParticle()) {
+        return -1;
+      }
+    }
+    if (!ancestry.mayHaveMother(arrDaughters[0].mcParticleId(), PDGMother, depthMax)) {
+      return -1;
+    }
+    return getMatchedMCRec<acceptFlavourOscillation, checkProcess>(particlesMC, arrDaughters, PDGMother, std::move(arrPDGDaughters), acceptAntiParticles, sign, depthMax);
+  }
+
   /// Checks whether the MC particle is the expected one.
   /// \param checkProcess  switch to accept only decay daughters by checking the production process of MC particles
   /// \param particlesMC  table with MC particles
@@ -992,6 +1117,24 @@ struct RecoDecay {
     }
     return OriginType::None;
   }
+
+  /// Finds the origin (from charm hadronisation or beauty-hadron decay) of charm hadrons from the precomputed ancestry,
+  /// without walking the mother chain. Equivalent to getCharmHadronOrigin with searchUpToQuark = false.
+  /// \param ancestry  heavy-flavour ancestry of the MC particle table
+  /// \param particle  MC particle
+  /// \param idxBhadMothers  optional vector where the index of the closest b-hadron ancestor is added
+  /// \return an integer corresponding to the origin (0: none, 1: prompt, 2: nonprompt) as in OriginType
+  template <typename T>
+  static int getCharmHadronOrigin(const McParticleAncestry& ancestry,
+                                  const T& particle,
+                                  std::vector<int>* idxBhadMothers = nullptr)
+  {
+    auto origin = ancestry.getOrigin(particle.globalIndex());
+    if (origin == OriginType::NonPrompt && idxBhadMothers) {
+      idxBhadMothers->push_back(ancestry.getBeautyAncestor(particle.globalIndex()));
+    }
+    return origin;
+  }
 };
 
 /// Calculations using (pT, η, φ) coordinates, aka (transverse momentum, pseudorapidity, azimuth)
@@ -18,6 +18,7 @@
 #include "Common/Core/TableHelper.h"
 
 #include <string>
+#include <vector>
 
 #include "Framework/InitContext.h"
 #include "Framework/RunningWorkflowInfo.h"
@@ -57,6 +58,16 @@ bool isTableRequiredInWorkflow(o2::framework::InitContext& initContext, const st
 /// @param initContext initContext of the init function
 /// @param table name of the table to check for
 /// @param flag bool value of flag to set, if the given value is true it will be kept, disregarding the table usage in the workflow.
+bool isTableRequiredInWorkflow(o2::framework::InitContext& initContext, const std::vector<std::string>& tables)
+{
+  for (auto const& table : tables) {
+    if (isTableRequiredInWorkflow(initContext, table)) {
+      return true;
+    }
+  }
+  return false;
+}
+
 void enableFlagIfTableRequired(o2::framework::InitContext& initContext, const std::string& table, bool& flag)
 {
   if (flag) {
@@ -75,14 +86,17 @@ void enableFlagIfTableRequired(o2::framework::InitContext& initContext, const st
 /// @param initContext initContext of the init function
 /// @param table name of the table to check for
 /// @param flag int value of flag to set, only if initially set to -1. Initial values of 0 or 1 will be kept disregarding the table usage in the workflow.
-void enableFlagIfTableRequired(o2::framework::InitContext& initContext, const std::string& table, int& flag)
+namespace
+{
+/// Sets an int flag from the requirement of a table (or set of tables) in the workflow, see enableFlagIfTableRequired
+void setFlagFromRequirement(bool tableNeeded, const std::string& table, int& flag)
 {
   if (flag > 0) {
     flag = 1;
     LOG(info) << "Table enabled: " + table;
     return;
   }
-  if (isTableRequiredInWorkflow(initContext, table)) {
+  if (tableNeeded) {
     if (flag < 0) {
       flag = 1;
       LOG(info) << "Auto-enabling table: " + table;
@@ -98,3 +112,18 @@ void enableFlagIfTableRequired(o2::framework::InitContext& initContext, const st
     LOG(info) << "Table disabled and not required: " + table;
   }
 }
+} // namespace
+
+void enableFlagIfTableRequired(o2::framework::InitContext& initContext, const std::string& table, int& flag)
+{
+  setFlagFromRequirement(flag > 0 || isTableRequiredInWorkflow(initContext, table), table, flag);
+}
+
+void enableFlagIfTableRequired(o2::framework::InitContext& initContext, const std::vector<std::string>& tables, int& flag)
+{
+  std::string names;
+  for (auto const& table : tables) {
+    names += names.empty() ? table : ", " + table;
+  }
+  setFlagFromRequirement(flag > 0 || isTableRequiredInWorkflow(initContext, tables), names, flag);
+}
@@ -19,6 +19,7 @@
 #define COMMON_CORE_TABLEHELPER_H_
 
 #include <string>
+#include <vector>
 
 #include "Framework/InitContext.h"
 #include "Framework/RunningWorkflowInfo.h"
@@ -32,6 +33,11 @@ void printTablesInWorkflow(o2::framework::InitContext& initContext);
 /// @param table name of the table to check for
 bool isTableRequiredInWorkflow(o2::framework::InitContext& initContext, const std::string& table);
 
+/// Function to check if any of several tables is required in a workflow, e.g. the tables filled by the same computation
+/// @param initContext initContext of the init function
+/// @param tables names of the tables to check for
+bool isTableRequiredInWorkflow(o2::framework::InitContext& initContext, const std::vector<std::string>& tables);
+
 /// Function to enable or disable a configurable flag, depending on the fact that a table is needed or not
 /// @param initContext initContext of the init function
 /// @param table name of the table to check for
@@ -44,6 +50,12 @@ void enableFlagIfTableRequired(o2::framework::InitContext& initContext, const st
 /// @param flag int value of flag to set, only if initially set to -1. Initial values of 0 or 1 will be kept disregarding the table usage in the workflow.
 void enableFlagIfTableRequired(o2::framework::InitContext& initContext, const std::string& table, int& flag);
 
+/// Function to enable or disable a configurable flag, depending on the fact that any of several tables is needed or not
+/// @param initContext initContext of the init function
+/// @param tables names of the tables to check for, e.g. the tables filled by the same computation
+/// @param flag int value of flag to set, only if initially set to -1. Initial values of 0 or 1 will be kept disregarding the table usage in the workflow.
+void enableFlagIfTableRequired(o2::framework::InitContext& initContext, const std::vector<std::string>& tables, int& flag);
+
 /// Function to enable or disable a configurable flag, depending on the fact that a table is needed or not
 /// @param initContext initContext of the init function
 /// @param table name of the table to check for
@@ -54,6 +66,16 @@ void enableFlagIfTableRequired(o2::framework::InitContext& initContext, const st
   enableFlagIfTableRequired(initContext, table, flag.value);
 }
 
+/// Function to enable or disable a configurable flag, depending on the fact that any of several tables is needed or not
+/// @param initContext initContext of the init function
+/// @param tables names of the tables to check for, e.g. the tables filled by the same computation
+/// @param flag configurable flag to set, only if initially set to -1. Initial values of 0 or 1 will be kept disregarding the table usage in the workflow.
+template <typename FlagType>
+void enableFlagIfTableRequired(o2::framework::InitContext& initContext, const std::vector<std::string>& tables, FlagType& flag)
+{
+  enableFlagIfTableRequired(initContext, tables, flag.value);
+}
+
 /// Function to check for a specific configurable from another task in the current workflow and fetch its value. Useful for tasks that need to know the value of a configurable in another task.
 /// @param initContext initContext of the init function
 /// @param taskName name of the task to check for
@@ -0,0 +1,235 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file  TaskProfiler.h
+/// \brief Time and memory monitoring of the process functions of a task, enabled with one configurable.
+///        Each call of a monitored process function (i.e. each dataframe) is timed with a scoped timer, and the
+///        wall time, CPU time and change of resident memory are filled in histograms of the TaskProfiler folder
+///        of the task registry. Tasks can also report the size of their caches and count processed items.
+///
+///        Usage:
+///          TaskProfiler profiler;                            // task member, configured as taskProfiler.enable etc.
+///          profiler.init(registry, {"processData", "processMc"}); // in init()
+///          auto scope = profiler.measure("processData");    // first line of processData
+///          scope.count(tracks.size());                      // optional: items processed in this call
+///          profiler.setCacheSize("trackCache", bytes);      // optional: memory held by a cache of the task
+///
+
+#ifndef COMMON_CORE_TASKPROFILER_H_
+#define COMMON_CORE_TASKPROFILER_H_
+
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <TSystem.h>
+
+#include "Framework/Configurable.h"
+#include "Framework/HistogramRegistry.h"
+#include "Framework/HistogramSpec.h"
+#include "Framework/Logger.h"
+
+namespace o2::analysis
+{
+
+struct TaskProfiler : o2::framework::ConfigurableGroup {
+  std::string prefix = "taskProfiler"; // JSON group name
+  o2::framework::Configurable<bool> enable{"enable", false, "Monitor the time and memory of the process functions"};
+  o2::framework::Configurable<int> logPeriod{"logPeriod", 0, "Print a summary line every logPeriod calls of a process function, 0 for none"};
+
+  static constexpr int MaxEntries = 32; // process functions and caches shown in the summary histograms
+
+  /// Measurement of one call of a process function, filled in the histograms when destroyed
+  class Scope
+  {
+   public:
+    Scope() = default;
+    Scope(TaskProfiler* profiler, int index) : mProfiler(profiler), mIndex(index)
+    {
+      mStartWall = std::chrono::steady_clock::now();
+      mStartCpu = std::clock();
+      mStartMemory = TaskProfiler::getResidentMemory();
+    }
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+    Scope(Scope&& other) noexcept { *this = std::move(other); }
+    Scope& operator=(Scope&& other) noexcept
+    {
+      mProfiler = other.mProfiler;
+      mIndex = other.mIndex;
+      mStartWall = other.mStartWall;
+      mStartCpu = other.mStartCpu;
+      mStartMemory = other.mStartMemory;
+      mCount = other.mCount;
+      other.mProfiler = nullptr;
+      return *this;
+    }
+    ~Scope()
+    {
+      if (!mProfiler) {
+        return;
+      }
+      const double wallTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - mStartWall).count();
+      const double cpuTime = 1000. * (std::clock() - mStartCpu) / CLOCKS_PER_SEC;
+      const double memory = TaskProfiler::getResidentMemory();
+      mProfiler->fill(mIndex, wallTime, cpuTime, memory, memory - mStartMemory, mCount);
+    }
+
+    /// Adds items (e.g. collisions, tracks or candidates) processed in this call
+    void count(double n) { mCount += n; }
+
+   private:
+    TaskProfiler* mProfiler = nullptr; // nullptr if the profiler is disabled
+    int mIndex = -1;
+    std::chrono::steady_clock::time_point mStartWall;
+    std::clock_t mStartCpu = 0;
+    double mStartMemory = 0.;
+    double mCount = 0.;
+  };
+
+  /// Adds the histograms of the process functions to be monitored, if enabled
+  /// \param registry  histogram registry of the task
+  /// \param processNames  names of the process functions, as given to measure
+  void init(o2::framework::HistogramRegistry& registry, std::vector<std::string> const& processNames)
+  {
+    mProcesses.clear();
+    mCacheNames.clear();
+    if (!enable) {
+      return;
+    }
+    if (static_cast<int>(processNames.size()) > MaxEntries) {
+      LOGF(fatal, "TaskProfiler: at most %d process functions can be monitored", MaxEntries);
+    }
+    const o2::framework::AxisSpec axisTime = {getLogBinning(60, 1.e-3, 1.e5), "time per call (ms)"};
+    const o2::framework::AxisSpec axisMemoryDelta = {400, -200., 200., "change of resident memory per call (MB)"};
+    const o2::framework::AxisSpec axisMemory = {500, 0., 10000., "resident memory (MB)"};
+    const o2::framework::AxisSpec axisCount = {getLogBinning(60, 1., 1.e9), "items per call"};
+    const o2::framework::AxisSpec axisEntries = {MaxEntries, -0.5, MaxEntries - 0.5, ""};
+    mSummaryWallTime = registry.add<TH1>("TaskProfiler/hWallTime", "total wall time;;time (s)", {o2::framework::HistType::kTH1D, {axisEntries}});
+    mSummaryCpuTime = registry.add<TH1>("TaskProfiler/hCpuTime", "total CPU time;;time (s)", {o2::framework::HistType::kTH1D, {axisEntries}});
+    mSummaryCalls = registry.add<TH1>("TaskProfiler/hCalls", "number of calls;;calls", {o2::framework::HistType::kTH1D, {axisEntries}});
+    mSummaryCacheSize = registry.add<TH1>("TaskProfiler/hCacheSize", "last reported size of the caches;;size (MB)", {o2::framework::HistType::kTH1D, {axisEntries}});
+    mResidentMemory = registry.add<TH1>("TaskProfiler/hResidentMemory", "resident memory at the end of the calls;resident memory (MB);calls", {o2::framework::HistType::kTH1D, {axisMemory}});
+    for (const auto& name : processNames) {
+      Process process;
+      process.name = name;
+      const std::string folder = "TaskProfiler/" + name + "/";
+      process.hWallTime = registry.add<TH1>((folder + "hWallTime").c_str(), (name + ";wall time per call (ms);calls").c_str(), {o2::framework::HistType::kTH1D, {axisTime}});
+      process.hCpuTime = registry.add<TH1>((folder + "hCpuTime").c_str(), (name + ";CPU time per call (ms);calls").c_str(), {o2::framework::HistType::kTH1D, {axisTime}});
+      process.hMemoryDelta = registry.add<TH1>((folder + "hMemoryDelta").c_str(), (name + ";change of resident memory per call (MB);calls").c_str(), {o2::framework::HistType::kTH1D, {axisMemoryDelta}});
+      process.hTimeVsCount = registry.add<TH2>((folder + "hWallTimeVsCount").c_str(), (name + ";items per call;wall time per call (ms)").c_str(), {o2::framework::HistType::kTH2D, {axisCount, axisTime}});
+      const int bin = static_cast<int>(mProcesses.size()) + 1;
+      mSummaryWallTime->GetXaxis()->SetBinLabel(bin, name.c_str());
+      mSummaryCpuTime->GetXaxis()->SetBinLabel(bin, name.c_str());
+      mSummaryCalls->GetXaxis()->SetBinLabel(bin, name.c_str());
+      mProcesses.push_back(std::move(process));
+    }
+    LOGF(info, "TaskProfiler: monitoring %d process functions", static_cast<int>(mProcesses.size()));
+  }
+
+  /// Starts the measurement of a call of a process function, ended when the returned scope is destroyed
+  /// \param processName  name of the process function, as given to init
+  Scope measure(std::string const& processName)
+  {
+    if (!enable) {
+      return {};
+    }
+    for (size_t i = 0; i < mProcesses.size(); i++) {
+      if (mProcesses[i].name == processName) {
+        return {this, static_cast<int>(i)};
+      }
+    }
+    LOGF(fatal, "TaskProfiler: process function %s not given to init", processName);
+    return {};
+  }
+
+  /// Reports the memory held by a cache of the task (e.g. vectors kept across dataframes)
+  /// \param cacheName  name of the cache, shown in the summary histogram
+  /// \param bytes  current size in bytes
+  void setCacheSize(std::string const& cacheName, double bytes)
+  {
+    if (!enable) {
+      return;
+    }
+    int index = 0;
+    while (index < static_cast<int>(mCacheNames.size()) && mCacheNames[index] != cacheName) {
+      index++;
+    }
+    if (index == static_cast<int>(mCacheNames.size())) {
+      if (index >= MaxEntries) {
+        return;
+      }
+      mCacheNames.push_back(cacheName);
+      mSummaryCacheSize->GetXaxis()->SetBinLabel(index + 1, cacheName.c_str());
+    }
+    mSummaryCacheSize->SetBinContent(index + 1, bytes / (1024. * 1024.));
+  }
+
+  /// Resident memory of the process in MB
+  static double getResidentMemory()
+  {
+    ProcInfo_t info;
+    gSystem->GetProcInfo(&info);
+    return info.fMemResident / 1024.;
+  }
+
+ private:
+  struct Process {
+    std::string name;
+    std::shared_ptr<TH1> hWallTime, hCpuTime, hMemoryDelta;
+    std::shared_ptr<TH2> hTimeVsCount;
+    long nCalls = 0;
+    double totalWallTime = 0.; // ms
+  };
+
+  void fill(int index, double wallTime, double cpuTime, double memory, double memoryDelta, double count)
+  {
+    auto& process = mProcesses[index];
+    process.hWallTime->Fill(wallTime);
+    process.hCpuTime->Fill(cpuTime);
+    process.hMemoryDelta->Fill(memoryDelta);
+    if (count > 0.) {
+      process.hTimeVsCount->Fill(count, wallTime);
+    }
+    mSummaryWallTime->Fill(index, wallTime / 1000.);
+    mSummaryCpuTime->Fill(index, cpuTime / 1000.);
+    mSummaryCalls->Fill(index);
+    mResidentMemory->Fill(memory);
+    process.nCalls++;
+    process.totalWallTime += wallTime;
+    if (logPeriod > 0 && process.nCalls % logPeriod == 0) {
+      LOGF(info, "TaskProfiler: %s: %ld calls, mean wall time %.3f ms, last call %.3f ms (CPU %.3f ms), resident memory %.1f MB (%+.1f MB in the last call)",
+           process.name, process.nCalls, process.totalWallTime / process.nCalls, wallTime, cpuTime, memory, memoryDelta);
+    }
+  }
+
+  static std::vector<double> getLogBinning(int nBins, double min, double max)
+  {
+    std::vector<double> edges;
+    for (int i = 0; i <= nBins; i++) {
+      edges.push_back(min * std::pow(max / min, static_cast<double>(i) / nBins));
+    }
+    return edges;
+  }
+
+  std::vector<Process> mProcesses;
+  std::vector<std::string> mCacheNames;
+  std::shared_ptr<TH1> mSummaryWallTime, mSummaryCpuTime, mSummaryCalls, mSummaryCacheSize, mResidentMemory;
+};
+
+} // namespace o2::analysis
+
+#endif // COMMON_CORE_TASKPROFILER_H_
@@ -13,6 +13,7 @@
 // Class for track selection
 //
 
+#include <algorithm>
 #include "Framework/Logger.h"
 #include "Common/Core/TrackSelection.h"
 
@@ -30,6 +31,65 @@ bool TrackSelection::FulfillsITSHitRequirements(uint8_t itsClusterMap) const
   return true;
 }
 
+void TrackSelection::fillSelectionMasks(TrackColumns const& columns, gsl::span<uint16_t> masks) const
+{
+  const size_t nTracks = columns.size();
+  if (masks.size() < nTracks) {
+    LOG(fatal) << "TrackSelection::fillSelectionMasks: " << masks.size() << " masks for " << nTracks << " tracks";
+  }
+  std::fill(masks.begin(), masks.begin() + nTracks, 0);
+
+  // sets the bit of a cut for the tracks passing it, in one loop over the columns without branches
+  auto setFlags = [&](TrackCuts cut, auto isSelected) {
+    const uint16_t bit = 1 << static_cast<int>(cut);
+    for (size_t i = 0; i < nTracks; i++) {
+      masks[i] |= isSelected(i) ? bit : 0;
+    }
+  };
+  auto isRun2 = [&](size_t i) { return columns.trackType[i] == o2::aod::track::Run2Track || columns.trackType[i] == o2::aod::track::Run2Tracklet; };
+
+  setFlags(TrackCuts::kTrackType, [&](size_t i) { return columns.trackType[i] == mTrackType; });
+  setFlags(TrackCuts::kPtRange, [&](size_t i) { return columns.pt[i] >= mMinPt && columns.pt[i] <= mMaxPt; });
+  setFlags(TrackCuts::kEtaRange, [&](size_t i) { return columns.eta[i] >= mMinEta && columns.eta[i] <= mMaxEta; });
+  setFlags(TrackCuts::kTPCNCls, [&](size_t i) { return columns.tpcNClsFound[i] >= mMinNClustersTPC; });
+  setFlags(TrackCuts::kTPCCrossedRows, [&](size_t i) { return columns.tpcNClsCrossedRows[i] >= mMinNCrossedRowsTPC; });
+  setFlags(TrackCuts::kTPCCrossedRowsOverNCls, [&](size_t i) { return columns.tpcCrossedRowsOverFindableCls[i] >= mMinNCrossedRowsOverFindableClustersTPC; });
+  setFlags(TrackCuts::kTPCChi2NDF, [&](size_t i) { return columns.tpcChi2NCl[i] <= mMaxChi2PerClusterTPC; });
+  if (mRequireTPCRefit) {
+    setFlags(TrackCuts::kTPCRefit, [&](size_t i) { return isRun2(i) ? (columns.flags[i] & o2::aod::track::TPCrefit) != 0 : columns.hasTPC[i] != 0; });
+  } else {
+    setFlags(TrackCuts::kTPCRefit, [](size_t) { return true; });
+  }
+  setFlags(TrackCuts::kITSNCls, [&](size_t i) { return columns.itsNCls[i] >= mMinNClustersITS; });
+  setFlags(TrackCuts::kITSChi2NDF, [&](size_t i) { return columns.itsChi2NCl[i] <= mMaxChi2PerClusterITS; });
+  if (mRequireITSRefit) {
+    setFlags(TrackCuts::kITSRefit, [&](size_t i) { return isRun2(i) ? (columns.flags[i] & o2::aod::track::ITSrefit) != 0 : columns.hasITS[i] != 0; });
+  } else {
+    setFlags(TrackCuts::kITSRefit, [](size_t) { return true; });
+  }
+  // the ITS hit requirements only depend on the 8-bit cluster map: tabulated once
+  bool itsHitsSelected[256];
+  for (int itsClusterMap = 0; itsClusterMap < 256; itsClusterMap++) {
+    itsHitsSelected[itsClusterMap] = FulfillsITSHitRequirements(itsClusterMap);
+  }
+  setFlags(TrackCuts::kITSHits, [&](size_t i) { return itsHitsSelected[columns.itsClusterMap[i]]; });
+  if (mRequireGoldenChi2) {
+    setFlags(TrackCuts::kGoldenChi2, [&](size_t i) { return isRun2(i) ? (columns.flags[i] & o2::aod::track::GoldenChi2) != 0 : true; });
+  } else {
+    setFlags(TrackCuts::kGoldenChi2, [](size_t) { return true; });
+  }
+  if (mMaxDcaXYPtDep && mIsMaxDcaXYPtDepParametric) {
+    // same expression as mMaxDcaXYPtDep, inlined instead of called through the std::function
+    const float p0 = mMaxDcaXYPtDepParams[0], p1 = mMaxDcaXYPtDepParams[1], exponent = mMaxDcaXYPtDepParams[2];
+    setFlags(TrackCuts::kDCAxy, [&](size_t i) { return std::abs(columns.dcaXY[i]) <= p0 + p1 / std::pow(columns.pt[i], exponent); });
+  } else if (mMaxDcaXYPtDep) {
+    setFlags(TrackCuts::kDCAxy, [&](size_t i) { return std::abs(columns.dcaXY[i]) <= mMaxDcaXYPtDep(columns.pt[i]); });
+  } else {
+    setFlags(TrackCuts::kDCAxy, [&](size_t i) { return std::abs(columns.dcaXY[i]) <= mMaxDcaXY; });
+  }
+  setFlags(TrackCuts::kDCAz, [&](size_t i) { return std::abs(columns.dcaZ[i]) <= mMaxDcaZ; });
+}
+
 const std::string TrackSelection::mCutNames[static_cast<int>(TrackSelection::TrackCuts::kNCuts)] = {"TrackType", "PtRange", "EtaRange", "TPCNCls", "TPCCrossedRows", "TPCCrossedRowsOverNCls", "TPCChi2NDF", "TPCRefit", "ITSNCls", "ITSChi2NDF", "ITSRefit", "ITSHits", "GoldenChi2", "DCAxy", "DCAz"};
 
 void TrackSelection::SetTrackType(o2::aod::track::TrackTypeEnum trackType)
@@ -108,8 +168,18 @@ void TrackSelection::SetMaxDcaZ(float maxDcaZ)
 void TrackSelection::SetMaxDcaXYPtDep(std::function<float(float)> ptDepCut)
 {
   mMaxDcaXYPtDep = ptDepCut;
+  mIsMaxDcaXYPtDepParametric = false;
   LOG(info) << "Track selection, set max DCA xy pt dep: " << mMaxDcaXYPtDep(1.0);
 }
+void TrackSelection::SetMaxDcaXYPtDep(float p0, float p1, float exponent)
+{
+  mMaxDcaXYPtDep = [p0, p1, exponent](float pt) { return p0 + p1 / std::pow(pt, exponent); };
+  mIsMaxDcaXYPtDepParametric = true;
+  mMaxDcaXYPtDepParams[0] = p0;
+  mMaxDcaXYPtDepParams[1] = p1;
+  mMaxDcaXYPtDepParams[2] = exponent;
+  LOG(info) << "Track selection, set max DCA xy pt dep: " << p0 << " + " << p1 << " / pt^" << exponent;
+}
 
 void TrackSelection::SetRequireHitsInITSLayers(int8_t minNRequiredHits, std::set<uint8_t> requiredLayers)
 {
@@ -16,10 +16,12 @@
 #ifndef COMMON_CORE_TRACKSELECTION_H_
 #define COMMON_CORE_TRACKSELECTION_H_
 
+#include <cmath>
 #include <set>
 #include <vector>
 #include <utility>
 #include <string>
+#include <gsl/span>
 #include "Framework/Logger.h"
 #include "Framework/DataTypes.h"
 #include "Rtypes.h"
@@ -64,6 +66,62 @@ class TrackSelection
   };
 
   static const std::string mCutNames[static_cast<int>(TrackCuts::kNCuts)];
+  static constexpr uint16_t kAllCutsMask = (1 << static_cast<int>(TrackCuts::kNCuts)) - 1; // mask of a track passing all the cuts
+
+  // Columns of the track variables used by the cuts, filled once per table and shared by the selections evaluated on it
+  struct TrackColumns {
+    std::vector<uint8_t> trackType;
+    std::vector<float> pt;
+    std::vector<float> eta;
+    std::vector<int16_t> tpcNClsFound;
+    std::vector<int16_t> tpcNClsCrossedRows;
+    std::vector<float> tpcCrossedRowsOverFindableCls;
+    std::vector<float> tpcChi2NCl;
+    std::vector<uint8_t> hasTPC;
+    std::vector<uint8_t> itsNCls;
+    std::vector<float> itsChi2NCl;
+    std::vector<uint8_t> hasITS;
+    std::vector<uint8_t> itsClusterMap;
+    std::vector<uint32_t> flags;
+    std::vector<float> dcaXY;
+    std::vector<float> dcaZ;
+
+    size_t size() const { return pt.size(); }
+
+    template <typename T>
+    void fill(T const& tracks)
+    {
+      const size_t nTracks = tracks.size();
+      for (auto* column : {&pt, &eta, &tpcCrossedRowsOverFindableCls, &tpcChi2NCl, &itsChi2NCl, &dcaXY, &dcaZ}) {
+        column->resize(nTracks);
+      }
+      for (auto* column : {&trackType, &hasTPC, &itsNCls, &hasITS, &itsClusterMap}) {
+        column->resize(nTracks);
+      }
+      tpcNClsFound.resize(nTracks);
+      tpcNClsCrossedRows.resize(nTracks);
+      flags.resize(nTracks);
+      size_t i = 0;
+      for (auto const& track : tracks) {
+        trackType[i] = track.trackType();
+        pt[i] = track.pt();
+        eta[i] = track.eta();
+        tpcNClsFound[i] = track.tpcNClsFound();
+        tpcNClsCrossedRows[i] = track.tpcNClsCrossedRows();
+        tpcCrossedRowsOverFindableCls[i] = track.tpcCrossedRowsOverFindableCls();
+        tpcChi2NCl[i] = track.tpcChi2NCl();
+        hasTPC[i] = track.hasTPC();
+        itsNCls[i] = track.itsNCls();
+        itsChi2NCl[i] = track.itsChi2NCl();
+        hasITS[i] = track.hasITS();
+        itsClusterMap[i] = track.itsClusterMap();
+        flags[i] = track.flags();
+        dcaXY[i] = track.dcaXY();
+        dcaZ[i] = track.dcaZ();
+        i++;
+      }
+    }
+  };
 
   // Temporary function to check if track passes selection criteria. To be replaced by framework filters.
   template <typename T>
@@ -148,6 +206,18 @@ class TrackSelection
     return flag;
   }
 
+  // Fills the masks of IsSelectedMask for all the tracks of the columns, one cut at a time over the columns
+  void fillSelectionMasks(TrackColumns const& columns, gsl::span<uint16_t> masks) const;
+
+  // Fills the masks of IsSelectedMask for all the tracks of a table
+  template <typename T>
+  void fillSelectionMasks(T const& tracks, gsl::span<uint16_t> masks) const
+  {
+    TrackColumns columns;
+    columns.fill(tracks);
+    fillSelectionMasks(columns, masks);
+  }
+
   // Temporary function to check if track passes a given selection criteria. To be replaced by framework filters.
   template <typename T>
   bool IsSelected(T const& track, const TrackCuts& cut) const
@@ -221,6 +291,7 @@ class TrackSelection
   void SetMaxDcaXY(float maxDcaXY);
   void SetMaxDcaZ(float maxDcaZ);
   void SetMaxDcaXYPtDep(std::function<float(float)> ptDepCut);
+  void SetMaxDcaXYPtDep(float p0, float p1, float exponent); // p0 + p1 / pT^exponent
   void SetRequireHitsInITSLayers(int8_t minNRequiredHits, std::set<uint8_t> requiredLayers);
   void SetRequireNoHitsInITSLayers(std::set<uint8_t> excludedLayers);
   /// @brief Reset ITS requirements
@@ -249,6 +320,8 @@ class TrackSelection
   float mMaxDcaXY{1e10f};                       // max dca in xy plane
   float mMaxDcaZ{1e10f};                        // max dca in z direction
   std::function<float(float)> mMaxDcaXYPtDep{}; // max dca in xy plane as function of pT
+  bool mIsMaxDcaXYPtDepParametric{false};       // mMaxDcaXYPtDep is p0 + p1 / pT^exponent with the parameters below
+  float mMaxDcaXYPtDepParams[3]{0.f, 0.f, 0.f}; // p0, p1, exponent
 
   bool mRequireITSRefit{false};   // require refit in ITS
   bool mRequireTPCRefit{false};   // require refit in TPC
@@ -257,7 +330,7 @@ class TrackSelection
   // vector of ITS requirements (minNRequiredHits in specific requiredLayers)
   std::vector<std::pair<int8_t, std::set<uint8_t>>> mRequiredITSHits{};
 
-  ClassDefNV(TrackSelection, 1);
+  ClassDefNV(TrackSelection, 2);
 };
 
 #endif // COMMON_CORE_TRACKSELECTION_H_
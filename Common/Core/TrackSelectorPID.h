@@ -19,6 +19,9 @@
 
 #include <TPDGCode.h>
 
+#include <cstdint>
+#include <vector>
+
 #include "Framework/Logger.h"
 #include "ReconstructionDataFormats/PID.h"
 
@@ -32,6 +35,13 @@ struct TrackSelectorPID {
     Conditional,
     Accepted
   };
+
+  /// Combination of detectors used in the selection
+  enum Detectors {
+    Tpc = 0,
+    TpcOrTof,
+    TpcAndTof
+  };
 };
 
 template <uint64_t pdg = kPiPlus>
@@ -441,6 +451,23 @@ class TrackSelectorPidBase
     return TrackSelectorPID::NotApplicable; // (NotApplicable for one detector) and (NotApplicable or Conditional for the other)
   }
 
+  /// Returns status of PID selection for a given track with a given combination of detectors.
+  /// \param track  track
+  /// \param detectors  combination of detectors (see TrackSelectorPID::Detectors)
+  /// \return PID selection status (see TrackSelectorPID::Status)
+  template <typename T>
+  TrackSelectorPID::Status status(const T& track, TrackSelectorPID::Detectors detectors)
+  {
+    switch (detectors) {
+      case TrackSelectorPID::Tpc:
+        return statusTpc(track);
+      case TrackSelectorPID::TpcAndTof:
+        return statusTpcAndTof(track);
+      default:
+        return statusTpcOrTof(track);
+    }
+  }
+
   /// Checks whether a track is identified as electron and rejected as pion by TOF or RICH.
   /// \param track  track
   /// \param useTof  switch to use TOF
@@ -641,6 +668,48 @@ class TrackSelectorPidBase
   }
 };
 
+/// PID selection statuses of all tracks of a table for up to four species, two bits per species in one byte per track.
+/// Filled once per table and looked up by track index, such that tracks shared by many candidates are not re-evaluated.
+class TrackSelectorPidStatuses
+{
+ public:
+  /// Computes the statuses of all tracks of a table.
+  /// \param tracks  track table, the tracks are indexed by their global index
+  /// \param detectors  combination of detectors (see TrackSelectorPID::Detectors)
+  /// \param selectors  selectors of the species, in the order of the species index of get
+  template <typename TTracks, typename... TSelectors>
+  void fill(TTracks const& tracks, TrackSelectorPID::Detectors detectors, TSelectors&... selectors)
+  {
+    static_assert(sizeof...(TSelectors) >= 1 && sizeof...(TSelectors) <= 4, "Between one and four species are supported");
+    mStatuses.clear();
+    for (const auto& track : tracks) {
+      const auto index = static_cast<size_t>(track.globalIndex());
+      if (index >= mStatuses.size()) {
+        mStatuses.resize(index + 1, 0); // NotApplicable for the tracks not in the table, e.g. filtered
+      }
+      uint8_t packed = 0;
+      int shift = 0;
+      ((packed |= static_cast<uint8_t>(selectors.status(track, detectors)) << shift, shift += 2), ...);
+      mStatuses[index] = packed;
+    }
+  }
+
+  /// Returns the status of a species for a given track.
+  /// \param trackIndex  global index of the track
+  /// \param species  index of the species in the selectors of fill
+  /// \return PID selection status (see TrackSelectorPID::Status)
+  TrackSelectorPID::Status get(int64_t trackIndex, int species) const
+  {
+    if (trackIndex < 0 || static_cast<size_t>(trackIndex) >= mStatuses.size()) {
+      return TrackSelectorPID::NotApplicable;
+    }
+    return static_cast<TrackSelectorPID::Status>((mStatuses[trackIndex] >> (2 * species)) & 0x3);
+  }
+
+ private:
+  std::vector<uint8_t> mStatuses{}; ///< packed statuses per track
+};
+
 // Predefined types
 using TrackSelectorEl = TrackSelectorPidBase<kElectron>;  // El
 using TrackSelectorMu = TrackSelectorPidBase<kMuonMinus>; // Mu
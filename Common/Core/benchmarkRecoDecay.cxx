@@ -0,0 +1,304 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+//
+// Benchmark of the RecoDecay kinematic and topological helpers on synthetic candidates.
+// The candidates are stored column-wise, as in the candidate tables, and the inputs of the helpers are built from
+// the columns as in the candidate creators. The overloads taking momentum components, std::array, C arrays and
+// std::vector are measured separately, as well as the MC matching on a synthetic particle table.
+// Usage: o2-analysis-benchmark-recodecay [minimal time per benchmark in seconds, default 0.5]
+//
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Common/Core/RecoDecay.h"
+
+namespace
+{
+constexpr int kNCandidates = 4096; // synthetic candidates, cycled over in the benchmark loops
+constexpr int kNProngs = 3;
+constexpr int kNParticlesPerCandidate = 5; // MC particles per candidate: mother of the hadron, hadron, three daughters
+constexpr double kMassPion = 0.13957;
+constexpr double kMassKaon = 0.49368;
+constexpr double kMassD0 = 1.86484;
+
+volatile double gSink = 0.; // keeps the results of the helpers alive
+
+//_________________________________________________________________________
+// Candidate columns: primary and secondary vertices, prong momenta
+struct SyntheticCandidates {
+  std::vector<float> fPosX, fPosY, fPosZ;                                                // primary vertex
+  std::vector<float> fXSecondaryVertex, fYSecondaryVertex, fZSecondaryVertex;            // secondary vertex
+  std::array<std::vector<float>, kNProngs> fPxProng, fPyProng, fPzProng;                 // prong momenta
+  std::vector<std::vector<float>> fPosPVVec, fPosSVVec;                                  // vertices as std::vector, for the container overloads
+  std::vector<std::array<float, 3>> fPosPVArr, fPosSVArr;                                // vertices as std::array
+
+  std::array<float, 3> pVecProng(int iProng, int i) const { return {fPxProng[iProng][i], fPyProng[iProng][i], fPzProng[iProng][i]}; }
+  std::array<float, 3> posPV(int i) const { return {fPosX[i], fPosY[i], fPosZ[i]}; }
+  std::array<float, 3> posSV(int i) const { return {fXSecondaryVertex[i], fYSecondaryVertex[i], fZSecondaryVertex[i]}; }
+};
+
+//_________________________________________________________________________
+// MC particle table with the getters used by RecoDecay::getMatchedMCRec and McParticleAncestry::build
+struct SyntheticMcParticles;
+
+struct SyntheticMcParticle {
+  using parent_t = SyntheticMcParticles;
+
+  const SyntheticMcParticles* fTable = nullptr;
+  int64_t fIndex = -1;
+
+  int64_t globalIndex() const { return fIndex; }
+  int pdgCode() const;
+  int getGenStatusCode() const { return 0; }
+  int getProcess() const { return TMCProcess::kPDecay; }
+  bool has_mothers() const;
+  std::array<int64_t, 2> mothersIds() const;
+  bool has_daughters() const;
+  std::array<int64_t, 2> daughtersIds() const;
+  template <typename T>
+  std::vector<SyntheticMcParticle> daughters_as() const;
+};
+
+struct SyntheticMcParticles {
+  using iterator = SyntheticMcParticle;
+
+  std::vector<int> fPdgCodes;
+  std::vector<int64_t> fMothersFirst, fMothersLast;     // -1 if no mothers
+  std::vector<int64_t> fDaughtersFirst, fDaughtersLast; // -1 if no daughters
+  std::vector<SyntheticMcParticle> fRows;
+
+  // Adds a particle and returns its index
+  int64_t Add(int pdgCode, int64_t motherFirst, int64_t motherLast)
+  {
+    fPdgCodes.push_back(pdgCode);
+    fMothersFirst.push_back(motherFirst);
+    fMothersLast.push_back(motherLast);
+    fDaughtersFirst.push_back(-1);
+    fDaughtersLast.push_back(-1);
+    return static_cast<int64_t>(fPdgCodes.size()) - 1;
+  }
+  void SetDaughters(int64_t index, int64_t first, int64_t last)
+  {
+    fDaughtersFirst[index] = first;
+    fDaughtersLast[index] = last;
+  }
+  void Finalize()
+  {
+    fRows.clear();
+    for (int64_t i = 0; i < static_cast<int64_t>(fPdgCodes.size()); ++i) {
+      fRows.push_back({this, i});
+    }
+  }
+
+  SyntheticMcParticle rawIteratorAt(int64_t i) const { return {this, i}; }
+  int64_t offset() const { return 0; }
+  size_t size() const { return fPdgCodes.size(); }
+  auto begin() const { return fRows.begin(); }
+  auto end() const { return fRows.end(); }
+};
+
+int SyntheticMcParticle::pdgCode() const { return fTable->fPdgCodes[fIndex]; }
+bool SyntheticMcParticle::has_mothers() const { return fTable->fMothersFirst[fIndex] >= 0; }
+std::array<int64_t, 2> SyntheticMcParticle::mothersIds() const { return {fTable->fMothersFirst[fIndex], fTable->fMothersLast[fIndex]}; }
+bool SyntheticMcParticle::has_daughters() const { return fTable->fDaughtersFirst[fIndex] >= 0; }
+std::array<int64_t, 2> SyntheticMcParticle::daughtersIds() const { return {fTable->fDaughtersFirst[fIndex], fTable->fDaughtersLast[fIndex]}; }
+template <typename T>
+std::vector<SyntheticMcParticle> SyntheticMcParticle::daughters_as() const
+{
+  std::vector<SyntheticMcParticle> daughters;
+  for (auto i = fTable->fDaughtersFirst[fIndex]; i >= 0 && i <= fTable->fDaughtersLast[fIndex]; ++i) {
+    daughters.push_back({fTable, i});
+  }
+  return daughters;
+}
+
+// Reconstructed track with its MC label
+struct SyntheticTrack {
+  const SyntheticMcParticles* fParticles = nullptr;
+  int64_t fMcParticleId = -1;
+
+  bool has_mcParticle() const { return fMcParticleId >= 0; }
+  int64_t mcParticleId() const { return fMcParticleId; }
+  SyntheticMcParticle mcParticle() const { return fParticles->rawIteratorAt(fMcParticleId); }
+};
+
+//_________________________________________________________________________
+class SyntheticGenerator
+{
+ public:
+  explicit SyntheticGenerator(unsigned int seed) : fEngine(seed) {}
+
+  float Pt(float ptMin, float slope) { return ptMin + std::exponential_distribution<float>(slope)(fEngine); }
+  float Uniform(float min, float max) { return std::uniform_real_distribution<float>(min, max)(fEngine); }
+  float Gaus(float mean, float sigma) { return std::normal_distribution<float>(mean, sigma)(fEngine); }
+
+  // Candidate with a secondary vertex displaced by a few hundred microns along the total momentum of its prongs
+  void Candidate(SyntheticCandidates& candidates)
+  {
+    float pvX = Gaus(0.0, 0.005), pvY = Gaus(0.0, 0.005), pvZ = Gaus(0.0, 5.0);
+    float ptTot = Pt(1.0, 0.3), etaTot = Uniform(-0.8, 0.8), phiTot = Uniform(0.0, 2.0 * M_PI);
+    auto pTot = RecoDecayPtEtaPhi::pVector(ptTot, etaTot, phiTot);
+    float decayLength = std::exponential_distribution<float>(1.0 / 0.03)(fEngine);
+    auto pTotMag = RecoDecay::p(pTot);
+    candidates.fPosX.push_back(pvX);
+    candidates.fPosY.push_back(pvY);
+    candidates.fPosZ.push_back(pvZ);
+    candidates.fXSecondaryVertex.push_back(pvX + decayLength * pTot[0] / pTotMag + Gaus(0.0, 0.005));
+    candidates.fYSecondaryVertex.push_back(pvY + decayLength * pTot[1] / pTotMag + Gaus(0.0, 0.005));
+    candidates.fZSecondaryVertex.push_back(pvZ + decayLength * pTot[2] / pTotMag + Gaus(0.0, 0.005));
+    for (int iProng = 0; iProng < kNProngs; ++iProng) {
+      float fraction = Uniform(0.2, 0.45);
+      candidates.fPxProng[iProng].push_back(fraction * pTot[0] + Gaus(0.0, 0.3));
+      candidates.fPyProng[iProng].push_back(fraction * pTot[1] + Gaus(0.0, 0.3));
+      candidates.fPzProng[iProng].push_back(fraction * pTot[2] + Gaus(0.0, 0.3));
+    }
+    candidates.fPosPVArr.push_back(candidates.posPV(candidates.fPosX.size() - 1));
+    candidates.fPosSVArr.push_back(candidates.posSV(candidates.fPosX.size() - 1));
+    candidates.fPosPVVec.emplace_back(candidates.fPosPVArr.back().begin(), candidates.fPosPVArr.back().end());
+    candidates.fPosSVVec.emplace_back(candidates.fPosSVArr.back().begin(), candidates.fPosSVArr.back().end());
+  }
+
+  // MC history of a two-prong candidate: D0 -> K- pi+ (signal) or rho0 -> pi+ pi- (background), with a third unrelated daughter.
+  // Returns the reconstructed prongs.
+  std::array<SyntheticTrack, 2> McCandidate(SyntheticMcParticles& particles)
+  {
+    bool isSignal = Uniform(0.0, 1.0) < 0.5;
+    int sign = Uniform(0.0, 1.0) < 0.5 ? 1 : -1;
+    auto iQuark = particles.Add(isSignal ? 4 * sign : 21, -1, -1);
+    auto iHadron = particles.Add(isSignal ? 421 * sign : 113, iQuark, iQuark);
+    auto iDaughter0 = particles.Add(isSignal ? -321 * sign : 211, iHadron, iHadron);
+    auto iDaughter1 = particles.Add(isSignal ? 211 * sign : -211, iHadron, iHadron);
+    particles.Add(22, iQuark, iQuark); // unrelated particle from the same quark
+    particles.SetDaughters(iQuark, iHadron, iHadron);
+    particles.SetDaughters(iHadron, iDaughter0, iDaughter1);
+    return {SyntheticTrack{&particles, iDaughter0}, SyntheticTrack{&particles, iDaughter1}};
+  }
+
+ private:
+  std::mt19937 fEngine;
+};
+
+//_________________________________________________________________________
+struct Benchmark {
+  std::string fName;
+  std::function<void(int)> fFunction; // processes the i-th candidate
+};
+
+// Run a benchmark for at least minTime seconds, doubling the number of passes over the candidates, and return the time per candidate in ns
+double Run(const Benchmark& benchmark, double minTime, long& nCalls)
+{
+  using clock = std::chrono::steady_clock;
+  for (int i = 0; i < kNCandidates; ++i) { // warm up
+    benchmark.fFunction(i);
+  }
+  long nPasses = 1;
+  while (true) {
+    auto start = clock::now();
+    for (long iPass = 0; iPass < nPasses; ++iPass) {
+      for (int i = 0; i < kNCandidates; ++i) {
+        benchmark.fFunction(i);
+      }
+    }
+    double elapsed = std::chrono::duration<double>(clock::now() - start).count();
+    nCalls = nPasses * kNCandidates;
+    if (elapsed >= minTime || nPasses > (1L << 30)) {
+      return elapsed * 1.0e9 / nCalls;
+    }
+    nPasses *= 2;
+  }
+}
+} // namespace
+
+//_________________________________________________________________________
+int main(int argc, char** argv)
+{
+  double minTime = (argc > 1 ? std::atof(argv[1]) : 0.5);
+
+  SyntheticGenerator generator(12345);
+  SyntheticCandidates candidates;
+  SyntheticMcParticles particles;
+  std::vector<std::array<SyntheticTrack, 2>> mcProngs;
+  particles.fPdgCodes.reserve(kNCandidates * kNParticlesPerCandidate);
+  for (int i = 0; i < kNCandidates; ++i) {
+    generator.Candidate(candidates);
+    mcProngs.push_back(generator.McCandidate(particles));
+  }
+  particles.Finalize();
+  McParticleAncestry ancestry;
+  ancestry.build(particles);
+
+  const auto& c = candidates;
+  const std::array<double, 2> arrMass2Prong{kMassPion, kMassKaon};
+  const std::array<double, 3> arrMass3Prong{kMassPion, kMassKaon, kMassPion};
+
+  std::vector<Benchmark> benchmarks = {
+    // momenta
+    {"pt(px, py)", [&](int i) { gSink = RecoDecay::pt(c.fPxProng[0][i] + c.fPxProng[1][i], c.fPyProng[0][i] + c.fPyProng[1][i]); }},
+    {"pt(std::array, std::array)", [&](int i) { gSink = RecoDecay::pt(c.pVecProng(0, i), c.pVecProng(1, i)); }},
+    {"p(px, py, pz)", [&](int i) { gSink = RecoDecay::p(c.fPxProng[0][i] + c.fPxProng[1][i], c.fPyProng[0][i] + c.fPyProng[1][i], c.fPzProng[0][i] + c.fPzProng[1][i]); }},
+    {"p(std::array, std::array)", [&](int i) { gSink = RecoDecay::p(c.pVecProng(0, i), c.pVecProng(1, i)); }},
+    // invariant masses
+    {"m(p, e)", [&](int i) {
+       auto pVec0 = c.pVecProng(0, i);
+       auto pVec1 = c.pVecProng(1, i);
+       gSink = RecoDecay::m(RecoDecay::p(pVec0, pVec1), RecoDecay::e(pVec0, kMassPion) + RecoDecay::e(pVec1, kMassKaon));
+     }},
+    {"m(std::array, e)", [&](int i) {
+       auto pVec0 = c.pVecProng(0, i);
+       auto pVec1 = c.pVecProng(1, i);
+       gSink = RecoDecay::m(RecoDecay::pVec(pVec0, pVec1), RecoDecay::e(pVec0, kMassPion) + RecoDecay::e(pVec1, kMassKaon));
+     }},
+    {"m(arrMom, arrMass)<2 prongs>", [&](int i) { gSink = RecoDecay::m(std::array{c.pVecProng(0, i), c.pVecProng(1, i)}, arrMass2Prong); }},
+    {"m(arrMom, arrMass)<3 prongs>", [&](int i) { gSink = RecoDecay::m(std::array{c.pVecProng(0, i), c.pVecProng(1, i), c.pVecProng(2, i)}, arrMass3Prong); }},
+    {"m(arrMom, arrMass)<2 prongs, 2 hypotheses>", [&](int i) {
+       auto arrMom = std::array{c.pVecProng(0, i), c.pVecProng(1, i)};
+       gSink = RecoDecay::m(arrMom, arrMass2Prong) + RecoDecay::m(arrMom, std::array{kMassKaon, kMassPion});
+     }},
+    {"m<masses>(arrMom)<2 prongs>", [&](int i) { gSink = RecoDecay::m<kMassPion, kMassKaon>(std::array{c.pVecProng(0, i), c.pVecProng(1, i)}); }},
+    {"m<masses>(arrMom)<3 prongs>", [&](int i) { gSink = RecoDecay::m<kMassPion, kMassKaon, kMassPion>(std::array{c.pVecProng(0, i), c.pVecProng(1, i), c.pVecProng(2, i)}); }},
+    {"mHypotheses<2 prongs, 2 hypotheses>", [&](int i) {
+       auto arrM = RecoDecay::mHypotheses(std::array{c.pVecProng(0, i), c.pVecProng(1, i)}, std::array{arrMass2Prong, std::array{kMassKaon, kMassPion}});
+       gSink = arrM[0] + arrM[1];
+     }},
+    // topology
+    {"cpa(std::array)", [&](int i) { gSink = RecoDecay::cpa(c.fPosPVArr[i], c.fPosSVArr[i], RecoDecay::pVec(c.pVecProng(0, i), c.pVecProng(1, i))); }},
+    {"cpa(std::vector)", [&](int i) { gSink = RecoDecay::cpa(c.fPosPVVec[i], c.fPosSVVec[i], RecoDecay::pVec(c.pVecProng(0, i), c.pVecProng(1, i))); }},
+    {"cpa(C array)", [&](int i) {
+       const float posPV[3] = {c.fPosX[i], c.fPosY[i], c.fPosZ[i]};
+       const float posSV[3] = {c.fXSecondaryVertex[i], c.fYSecondaryVertex[i], c.fZSecondaryVertex[i]};
+       gSink = RecoDecay::cpa(posPV, posSV, RecoDecay::pVec(c.pVecProng(0, i), c.pVecProng(1, i)));
+     }},
+    {"cpaXY(std::array)", [&](int i) { gSink = RecoDecay::cpaXY(c.fPosPVArr[i], c.fPosSVArr[i], RecoDecay::pVec(c.pVecProng(0, i), c.pVecProng(1, i))); }},
+    {"ct", [&](int i) { gSink = RecoDecay::ct(RecoDecay::pVec(c.pVecProng(0, i), c.pVecProng(1, i)), RecoDecay::distance(c.fPosPVArr[i], c.fPosSVArr[i]), kMassD0); }},
+    {"impParXY(std::array)", [&](int i) { gSink = RecoDecay::impParXY(c.fPosPVArr[i], c.fPosSVArr[i], RecoDecay::pVec(c.pVecProng(0, i), c.pVecProng(1, i))); }},
+    {"impParXY(std::vector)", [&](int i) { gSink = RecoDecay::impParXY(c.fPosPVVec[i], c.fPosSVVec[i], RecoDecay::pVec(c.pVecProng(0, i), c.pVecProng(1, i))); }},
+    {"cosThetaStar", [&](int i) { gSink = RecoDecay::cosThetaStar(std::array{c.pVecProng(0, i), c.pVecProng(1, i)}, arrMass2Prong, kMassD0, 1); }},
+    // MC matching
+    {"getMatchedMCRec<2 prongs>", [&](int i) { gSink = RecoDecay::getMatchedMCRec(particles, mcProngs[i], 421, std::array{-321, +211}, true); }},
+    {"getMatchedMCRec<2 prongs, ancestry>", [&](int i) { gSink = RecoDecay::getMatchedMCRec(particles, ancestry, mcProngs[i], 421, std::array{-321, +211}, true); }}};
+
+  printf("%-60s %15s %15s\n", "Benchmark", "Time (ns)", "Calls");
+  printf("%s\n", std::string(92, '-').c_str());
+  for (const auto& benchmark : benchmarks) {
+    long nCalls = 0;
+    double time = Run(benchmark, minTime, nCalls);
+    printf("%-60s %15.1f %15ld\n", benchmark.fName.c_str(), time, nCalls);
+  }
+  return 0;
+}
@@ -19,7 +19,10 @@
 #ifndef COMMON_DATAMODEL_PIDRESPONSE_H_
 #define COMMON_DATAMODEL_PIDRESPONSE_H_
 
+#include <algorithm>
+#include <cmath>
 #include <experimental/type_traits>
+#include <span>
 
 // O2 includes
 #include "Framework/ASoA.h"
@@ -53,6 +56,28 @@ float unPackInTable(const typename binningType::binned_t& valueToUnpack)
   return binningType::bin_width * static_cast<float>(valueToUnpack);
 }
 
+// Function to pack a span of floats into a preallocated span of binned values, same binning as packInTable
+// Branch-free: values are clamped to the binned range (NaN goes to the underflow bin) and rounded half away from zero
+template <typename binningType>
+void packInTable(std::span<const float> valuesToBin, std::span<typename binningType::binned_t> binnedValues)
+{
+  const std::size_t size = std::min(valuesToBin.size(), binnedValues.size());
+  for (std::size_t i = 0; i < size; i++) {
+    const float value = std::fmin(std::fmax(valuesToBin[i], binningType::binned_min), binningType::binned_max);
+    binnedValues[i] = static_cast<typename binningType::binned_t>((value / binningType::bin_width) + std::copysign(0.5f, value));
+  }
+}
+
+// Function to unpack a span of binned values into a preallocated span of floats
+template <typename binningType>
+void unPackInTable(std::span<const typename binningType::binned_t> valuesToUnpack, std::span<float> unpackedValues)
+{
+  const std::size_t size = std::min(valuesToUnpack.size(), unpackedValues.size());
+  for (std::size_t i = 0; i < size; i++) {
+    unpackedValues[i] = binningType::bin_width * static_cast<float>(valuesToUnpack[i]);
+  }
+}
+
 // Checkers for TOF PID hypothesis availability (runtime)
 template <class T>
 using hasTOFEl = decltype(std::declval<T&>().tofNSigmaEl());
@@ -138,6 +138,7 @@ DECLARE_SOA_COLUMN(PassedITSHitsFB2, passedITSHitsFB2, bool);
 // DECLARE_SOA_DYNAMIC_COLUMN(IsQualityTrack, isQualityTrack,
 //                          [](bool passedTrackType, bool passedTPCNCls, bool passedITSChi2NDF) -> bool { return (passedTrackType && passedTPCNCls && passedITSChi2NDF); }); //! Passed the combined track cut: kQualityTracks
 
+DECLARE_SOA_COLUMN(SelRequestMask, selRequestMask, uint32_t); //! Bit i set if the track passes the i-th distinct trackSelectionRequest of the workflow
 } // namespace track
 
 DECLARE_SOA_TABLE(TracksDCA, "AOD", "TRACKDCA", //! DCA information for the track
@@ -185,6 +186,9 @@ DECLARE_SOA_TABLE(TrackSelectionExtension, "AOD", "TRACKSELEXTRA", //! Informati
                   track::PassedITSHitsFB1,
                   track::PassedITSHitsFB2);
 
+DECLARE_SOA_TABLE(TrackSelRequests, "AOD", "TRACKSELREQ", //! Decisions of the trackSelectionRequests of the workflow, joinable with Tracks
+                  track::SelRequestMask);
+
 DECLARE_SOA_TABLE(FwdTracksDCA, "AOD", "FWDTRACKDCA", //! DCA information for the forward track
                   fwdtrack::FwdDcaX,
                   fwdtrack::FwdDcaY);
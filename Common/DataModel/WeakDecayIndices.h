@@ -0,0 +1,47 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file WeakDecayIndices.h
+/// \brief Reverse indices from the tracks to the V0s and cascades they belong to
+///
+/// For each track, the V0s (cascades) using it as a daughter are the rows [v0sOffset, v0sOffset + v0sCount)
+/// ([cascadesOffset, cascadesOffset + cascadesCount)) of the V0sOfTracks (CascadesOfTracks) table.
+/// A track belongs to a cascade as its bachelor or as a daughter of its V0.
+
+#ifndef COMMON_DATAMODEL_WEAKDECAYINDICES_H_
+#define COMMON_DATAMODEL_WEAKDECAYINDICES_H_
+
+#include "Framework/AnalysisDataModel.h"
+
+namespace o2::aod
+{
+namespace weakdecayindex
+{
+DECLARE_SOA_COLUMN(V0sOffset, v0sOffset, int32_t);           //! first row of the V0s of the track in V0sOfTracks
+DECLARE_SOA_COLUMN(V0sCount, v0sCount, int32_t);             //! number of V0s of the track
+DECLARE_SOA_COLUMN(CascadesOffset, cascadesOffset, int32_t); //! first row of the cascades of the track in CascadesOfTracks
+DECLARE_SOA_COLUMN(CascadesCount, cascadesCount, int32_t);   //! number of cascades of the track
+DECLARE_SOA_INDEX_COLUMN(V0, v0);                            //! V0 index
+DECLARE_SOA_INDEX_COLUMN(Cascade, cascade);                  //! Cascade index
+} // namespace weakdecayindex
+
+DECLARE_SOA_TABLE(TrackWeakDecays, "AOD", "TRACKWEAKDECAY", //! Per track offsets into V0sOfTracks and CascadesOfTracks, joinable with Tracks
+                  weakdecayindex::V0sOffset, weakdecayindex::V0sCount,
+                  weakdecayindex::CascadesOffset, weakdecayindex::CascadesCount);
+
+DECLARE_SOA_TABLE(V0sOfTracks, "AOD", "V0SOFTRACK", //! V0 indices grouped by daughter track
+                  weakdecayindex::V0Id);
+
+DECLARE_SOA_TABLE(CascadesOfTracks, "AOD", "CASCSOFTRACK", //! Cascade indices grouped by daughter track
+                  weakdecayindex::CascadeId);
+} // namespace o2::aod
+
+#endif // COMMON_DATAMODEL_WEAKDECAYINDICES_H_
@@ -19,6 +19,8 @@
 
 /// \author F.Mazzaschi <fmazzasc@cern.ch>
 
+#include <array>
+
 #include "Framework/runDataProcessing.h"
 #include "Framework/AnalysisTask.h"
 #include "Framework/AnalysisDataModel.h"
@@ -28,21 +30,30 @@ using namespace o2::framework;
 
 struct TracksExtraConverter {
   Produces<aod::StoredTracksExtra_001> tracksExtra_001;
-  void process(aod::TracksExtra_000 const& tracksExtra_000)
-  {
 
-    for (const auto& track0 : tracksExtra_000) {
+  // dummy ITSClusterSizes of each of the 128 ITS cluster maps, filled once instead of per track
+  std::array<uint32_t, 128> itsClusterSizesFromMap{};
 
+  void init(InitContext const&)
+  {
+    for (uint32_t map = 0; map < itsClusterSizesFromMap.size(); map++) {
       uint32_t itsClusterSizes = 0;
       for (int layer = 0; layer < 7; layer++) {
-        if (track0.itsClusterMap() & (1 << layer)) {
+        if (map & (1 << layer)) {
           itsClusterSizes |= (0xf << (layer * 4));
         }
       }
+      itsClusterSizesFromMap[map] = itsClusterSizes;
+    }
+  }
 
+  void process(aod::TracksExtra_000 const& tracksExtra_000)
+  {
+    tracksExtra_001.reserve(tracksExtra_000.size());
+    for (const auto& track0 : tracksExtra_000) {
       tracksExtra_001(track0.tpcInnerParam(),
                       track0.flags(),
-                      itsClusterSizes,
+                      itsClusterSizesFromMap[track0.itsClusterMap() & 0x7f],
                       track0.tpcNClsFindable(),
                       track0.tpcNClsFindableMinusFound(),
                       track0.tpcNClsFindableMinusCrossedRows(),
@@ -16,6 +16,15 @@
 ///         Only the tables for the mass hypotheses requested are filled, the others are sent empty.
 ///
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <TH2.h>
+
 // O2 includes
 #include "Framework/AnalysisTask.h"
 #include "Framework/HistogramRegistry.h"
@@ -91,6 +100,7 @@ struct bayesPid {
   Configurable<std::string> ccdbPathTOF{"ccdbPathTOF", "TOF/Calib", "Path of the TOF parametrization on the CCDB"};
   Configurable<std::string> ccdbPathTPC{"ccdbPathTPC", "Analysis/PID/TPC/Response", "Path of the TPC parametrization on the CCDB"};
   Configurable<int64_t> timestamp{"ccdb-timestamp", -1, "timestamp of the object"};
+  Configurable<std::string> ccdbPathPriors{"ccdbPathPriors", "", "Path of the priors on the CCDB, TH2 vs pT (x) and species in PID::ID order (y), flat priors if empty. Used in the nSigma mode"};
 
   // Configuration flags to include and exclude particle hypotheses
   // Configurable<LabeledArray<int>> pid{"pid",
@@ -109,6 +119,19 @@ struct bayesPid {
   std::array<std::array<float, PID::NIDs>, kNProb> Probability; /// Probabilities for all the cases defined in ProbType
   std::vector<PID::ID> enabledSpecies;                          /// Enabled species
 
+  // nSigma mode: the posteriors of a whole dataframe are computed species by species on flat arrays
+  static constexpr std::array<PID::ID, 5> nSigmaSpecies = {PID::Electron, PID::Muon, PID::Pion, PID::Kaon, PID::Proton}; /// Species of the pidTPCFull and pidTOFFull tables used
+  std::array<int, PID::NIDs> speciesSlot;                                                                                 /// Index of the species in enabledSpecies, -1 if disabled
+  std::vector<float> priorBinsPt;                                                                                         /// pT bin edges of the priors
+  std::vector<float> priors;                                                                                              /// Priors of the current run, (pT bin x PID::NIDs) flattened
+  int priorsRunNumber = -1;
+  std::vector<int> ptBin;          /// Prior pT bin of each track of the dataframe
+  std::vector<uint8_t> hasTOF;     /// TOF flag of each track of the dataframe
+  std::vector<float> nSigmaTPC;    /// TPC nSigma, (enabled species x tracks) flattened
+  std::vector<float> nSigmaTOF;    /// TOF nSigma, (enabled species x tracks) flattened
+  std::vector<float> posterior;    /// Posterior probabilities, (enabled species x tracks) flattened
+  std::vector<float> posteriorSum; /// Sum of the posteriors of each track
+
   /// Checker of the species that are enabled and initializer of the probabilities
   template <ProbType detIndex, o2::track::PID::ID pid>
   bool checkEnabled()
@@ -224,6 +247,21 @@ struct bayesPid {
     ccdb->setLocalObjectValidityChecking();
     // Not later than now objects
     ccdb->setCreatedNotAfter(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+    speciesSlot.fill(-1);
+    for (size_t i = 0; i < enabledSpecies.size(); i++) {
+      speciesSlot[enabledSpecies[i]] = i;
+    }
+    if (doprocessStandalone == doprocessNSigma) {
+      LOG(fatal) << "Enable exactly one of processStandalone and processNSigma";
+    }
+    if (doprocessNSigma) {
+      for (const auto enabledPid : enabledSpecies) {
+        if (std::find(nSigmaSpecies.begin(), nSigmaSpecies.end(), enabledPid) == nSigmaSpecies.end()) {
+          LOG(fatal) << "Species " << PID::getName(enabledPid) << " not available in the nSigma mode, only el, mu, pi, ka and pr are";
+        }
+      }
+      return; // the detector responses are those of the pidTPC and pidTOF tasks
+    }
     //
     const std::vector<float> p = {0.008, 0.008, 0.002, 40.0};
     Response[kTOF].SetParameters(DetectorResponse::kSigma, p);
@@ -433,18 +471,16 @@ struct bayesPid {
     }
   }
 
-  void process(Coll const& collisions, Trks const& tracks)
+  /// Prepares the memory of the enabled tables
+  void reserveTables(int64_t size)
   {
-
-    // Check and fill enabled tables
-    auto makeTable = [&tracks](const Configurable<int>& flag, auto& table) {
+    auto makeTable = [size](const Configurable<int>& flag, auto& table) {
       if (flag.value == 1) {
-        // Prepare memory for enabled tables
-        table.reserve(tracks.size());
+        table.reserve(size);
       }
     };
 
-    tableBayes.reserve(tracks.size());
+    tableBayes.reserve(size);
     makeTable(pidEl, tablePIDEl);
     makeTable(pidMu, tablePIDMu);
     makeTable(pidPi, tablePIDPi);
@@ -454,6 +490,11 @@ struct bayesPid {
     makeTable(pidTr, tablePIDTr);
     makeTable(pidHe, tablePIDHe);
     makeTable(pidAl, tablePIDAl);
+  }
+
+  void processStandalone(Coll const& collisions, Trks const& tracks)
+  {
+    reserveTables(tracks.size());
 
     for (auto const& trk : tracks) { // Loop on Tracks
 
@@ -513,6 +554,166 @@ struct bayesPid {
       tableBayes((*mostProbable) * 100.f, std::distance(Probability[kBayesian].begin(), mostProbable));
     }
   }
+  PROCESS_SWITCH(bayesPid, processStandalone, "Compute the detector responses in the task", true);
+
+  using TrksNSigma = soa::Join<aod::Tracks, aod::TracksExtra,
+                               aod::pidTPCFullEl, aod::pidTPCFullMu, aod::pidTPCFullPi, aod::pidTPCFullKa, aod::pidTPCFullPr,
+                               aod::pidTOFFullEl, aod::pidTOFFullMu, aod::pidTOFFullPi, aod::pidTOFFullKa, aod::pidTOFFullPr>;
+
+  template <PID::ID pid, typename T>
+  static float getNSigmaTPC(const T& track)
+  {
+    if constexpr (pid == PID::Electron) {
+      return track.tpcNSigmaEl();
+    } else if constexpr (pid == PID::Muon) {
+      return track.tpcNSigmaMu();
+    } else if constexpr (pid == PID::Pion) {
+      return track.tpcNSigmaPi();
+    } else if constexpr (pid == PID::Kaon) {
+      return track.tpcNSigmaKa();
+    } else {
+      return track.tpcNSigmaPr();
+    }
+  }
+
+  template <PID::ID pid, typename T>
+  static float getNSigmaTOF(const T& track)
+  {
+    if constexpr (pid == PID::Electron) {
+      return track.tofNSigmaEl();
+    } else if constexpr (pid == PID::Muon) {
+      return track.tofNSigmaMu();
+    } else if constexpr (pid == PID::Pion) {
+      return track.tofNSigmaPi();
+    } else if constexpr (pid == PID::Kaon) {
+      return track.tofNSigmaKa();
+    } else {
+      return track.tofNSigmaPr();
+    }
+  }
+
+  /// Loads the priors of a run into the flat (pT bin x species) array, flat priors if no CCDB path is given
+  void loadPriors(const aod::BCsWithTimestamps::iterator& bc)
+  {
+    if (bc.runNumber() == priorsRunNumber) {
+      return;
+    }
+    priorsRunNumber = bc.runNumber();
+    if (ccdbPathPriors.value.empty()) {
+      priorBinsPt = {0.f, std::numeric_limits<float>::max()};
+      priors.assign(PID::NIDs, 1.f);
+      return;
+    }
+    const auto* hPriors = ccdb->getForTimeStamp<TH2>(ccdbPathPriors.value, bc.timestamp());
+    if (hPriors == nullptr || hPriors->GetNbinsY() != PID::NIDs) {
+      LOG(fatal) << "Priors for run " << priorsRunNumber << " not found in " << ccdbPathPriors.value << " or not with " << static_cast<int>(PID::NIDs) << " species";
+    }
+    const int nBinsPt = hPriors->GetNbinsX();
+    priorBinsPt.resize(nBinsPt + 1);
+    priors.resize(nBinsPt * PID::NIDs);
+    for (int iPt = 0; iPt < nBinsPt; iPt++) {
+      priorBinsPt[iPt] = hPriors->GetXaxis()->GetBinLowEdge(iPt + 1);
+      for (int id = 0; id < PID::NIDs; id++) {
+        priors[iPt * PID::NIDs + id] = hPriors->GetBinContent(iPt + 1, id + 1);
+      }
+    }
+    priorBinsPt[nBinsPt] = hPriors->GetXaxis()->GetBinUpEdge(nBinsPt);
+    LOG(info) << "Loaded priors for run " << priorsRunNumber << " with " << nBinsPt << " pT bins from " << ccdbPathPriors.value;
+  }
+
+  /// Copies the nSigma of a species to the flat arrays
+  template <PID::ID pid>
+  void gatherNSigma(const TrksNSigma& tracks)
+  {
+    const int slot = speciesSlot[pid];
+    if (slot < 0) {
+      return;
+    }
+    float* tpc = nSigmaTPC.data() + slot * tracks.size();
+    float* tof = nSigmaTOF.data() + slot * tracks.size();
+    for (auto const& trk : tracks) {
+      *(tpc++) = getNSigmaTPC<pid>(trk);
+      *(tof++) = getNSigmaTOF<pid>(trk);
+    }
+  }
+
+  /// Bayesian probabilities from the nSigma of the pidTPC and pidTOF tasks, with the same likelihoods as the
+  /// standalone mode: Gaussian in the TPC (flat beyond fRange) and Gaussian with exponential tail in the TOF
+  void processNSigma(aod::Collisions const& collisions, TrksNSigma const& tracks, aod::BCsWithTimestamps const&)
+  {
+    const int64_t nTracks = tracks.size();
+    const int nSpecies = enabledSpecies.size();
+    reserveTables(nTracks);
+    if (nTracks == 0) {
+      return;
+    }
+    // the dataframe belongs to one run
+    loadPriors(collisions.begin().bc_as<aod::BCsWithTimestamps>());
+
+    ptBin.resize(nTracks);
+    hasTOF.resize(nTracks);
+    int64_t iTrack = 0;
+    for (auto const& trk : tracks) {
+      const int bin = std::upper_bound(priorBinsPt.begin(), priorBinsPt.end(), trk.pt()) - priorBinsPt.begin() - 1;
+      ptBin[iTrack] = std::clamp(bin, 0, static_cast<int>(priorBinsPt.size()) - 2) * PID::NIDs;
+      hasTOF[iTrack] = enabledDet[kTOF] && trk.hasTOF();
+      iTrack++;
+    }
+    nSigmaTPC.resize(nSpecies * nTracks);
+    nSigmaTOF.resize(nSpecies * nTracks);
+    gatherNSigma<PID::Electron>(tracks);
+    gatherNSigma<PID::Muon>(tracks);
+    gatherNSigma<PID::Pion>(tracks);
+    gatherNSigma<PID::Kaon>(tracks);
+    gatherNSigma<PID::Proton>(tracks);
+
+    // posterior = likelihood TPC x likelihood TOF x prior, species by species
+    const bool useTPC = enabledDet[kTPC];
+    const float tpcMismatch = 1.f / PID::NIDs;
+    posterior.resize(nSpecies * nTracks);
+    posteriorSum.assign(nTracks, 0.f);
+    for (int slot = 0; slot < nSpecies; slot++) {
+      const int id = enabledSpecies[slot];
+      const float* tpc = nSigmaTPC.data() + slot * nTracks;
+      const float* tof = nSigmaTOF.data() + slot * nTracks;
+      float* post = posterior.data() + slot * nTracks;
+      for (int64_t i = 0; i < nTracks; i++) {
+        const float nTPC = std::abs(tpc[i]);
+        const float likelihoodTPC = !useTPC ? 1.f : (nTPC > fRange ? tpcMismatch : std::exp(-0.5f * nTPC * nTPC));
+        const float nTOF = std::abs(tof[i]);
+        const float likelihoodTOF = !hasTOF[i] ? 1.f : (nTOF < fTOFtail ? std::exp(-0.5f * nTOF * nTOF) : std::exp(-(nTOF - fTOFtail * 0.5f) * fTOFtail));
+        post[i] = likelihoodTPC * likelihoodTOF * priors[ptBin[i] + id];
+        posteriorSum[i] += post[i];
+      }
+    }
+    for (int slot = 0; slot < nSpecies; slot++) {
+      float* post = posterior.data() + slot * nTracks;
+      for (int64_t i = 0; i < nTracks; i++) {
+        post[i] = posteriorSum[i] > 0.f ? post[i] / posteriorSum[i] : 1.f / nSpecies;
+      }
+    }
+
+    auto fillTable = [this, nTracks](const Configurable<int>& flag, PID::ID id, auto& table, int64_t i) {
+      if (flag.value == 1) {
+        table(posterior[speciesSlot[id] * nTracks + i] * 100.f);
+      }
+    };
+    for (int64_t i = 0; i < nTracks; i++) {
+      fillTable(pidEl, PID::Electron, tablePIDEl, i);
+      fillTable(pidMu, PID::Muon, tablePIDMu, i);
+      fillTable(pidPi, PID::Pion, tablePIDPi, i);
+      fillTable(pidKa, PID::Kaon, tablePIDKa, i);
+      fillTable(pidPr, PID::Proton, tablePIDPr, i);
+      int mostProbable = 0;
+      for (int slot = 1; slot < nSpecies; slot++) {
+        if (posterior[slot * nTracks + i] > posterior[mostProbable * nTracks + i]) {
+          mostProbable = slot;
+        }
+      }
+      tableBayes(posterior[mostProbable * nTracks + i] * 100.f, enabledSpecies[mostProbable]);
+    }
+  }
+  PROCESS_SWITCH(bayesPid, processNSigma, "Compute the Bayesian probabilities from the nSigma of the pidTPC and pidTOF tasks", false);
 };
 
 struct bayesPidQa {
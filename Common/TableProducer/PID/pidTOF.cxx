@@ -25,6 +25,7 @@
 // O2Physics includes
 #include "TableHelper.h"
 #include "pidTOFBase.h"
+#include "Common/Core/PID/ParamCache.h"
 
 using namespace o2;
 using namespace o2::framework;
@@ -67,6 +68,7 @@ struct tofPid {
   Configurable<bool> loadResponseFromCCDB{"loadResponseFromCCDB", false, "Flag to load the response from the CCDB"};
   Configurable<bool> enableTimeDependentResponse{"enableTimeDependentResponse", false, "Flag to use the collision timestamp to fetch the PID Response"};
   Configurable<bool> fatalOnPassNotAvailable{"fatalOnPassNotAvailable", true, "Flag to throw a fatal if the pass is not available in the retrieved CCDB object"};
+  Configurable<bool> prefetchParamsPerRun{"prefetchParamsPerRun", false, "Flag to prefetch at the first timestamp of each run the time dependent parametrizations valid over the run and serve the following lookups from memory"};
   // Configuration flags to include and exclude particle hypotheses
   Configurable<LabeledArray<int>> enableParticle{"enableParticle",
                                                  {defaultParameters[0], nSpecies, nParameters, particleNames, parameterNames},
@@ -75,6 +77,45 @@ struct tofPid {
   // Running variables
   std::vector<int> mEnabledParticles; // Vector of enabled PID hypotheses to loop on when making tables
   int mLastCollisionId = -1;          // Last collision ID analysed
+  int mLastRunNumber = -1;            // Last run number analysed
+  // Per-run cache of the time dependent parametrizations, shared in the device
+  o2::ccdb::CcdbApi ccdbApi;
+  o2::pid::ParamCache<o2::tof::ParameterCollection>* mParamCache = nullptr;
+  const o2::tof::ParameterCollection* mLastParamCollection = nullptr; // Parameter collection currently loaded in mRespParamsV2
+
+  /// Updates the time dependent parametrization for the timestamp of the BC
+  template <typename BCType>
+  void updateParametrization(const BCType& bc)
+  {
+    timestamp.value = bc.timestamp();
+    o2::tof::ParameterCollection* paramCollection = nullptr;
+    if (mParamCache) {
+      if (bc.runNumber() != mLastRunNumber) {
+        mLastRunNumber = bc.runNumber();
+        auto runDuration = ccdb->getRunDuration(mLastRunNumber);
+        mParamCache->prefetchRun(mLastRunNumber, runDuration.first, runDuration.second);
+      }
+      paramCollection = mParamCache->get(timestamp.value);
+      if (!paramCollection) {
+        LOGF(fatal, "Could not retrieve the TOF parametrization from path '%s' for timestamp %lld", parametrizationPath.value.data(), timestamp.value);
+      }
+      if (paramCollection == mLastParamCollection) { // Parameters already loaded
+        return;
+      }
+      mLastParamCollection = paramCollection;
+    } else {
+      paramCollection = ccdb->getForTimeStamp<o2::tof::ParameterCollection>(parametrizationPath.value, timestamp.value);
+    }
+    LOG(debug) << "Updating parametrization from path '" << parametrizationPath.value << "' and timestamp " << timestamp.value;
+    if (!paramCollection->retrieveParameters(mRespParamsV2, passName.value)) {
+      if (fatalOnPassNotAvailable) {
+        LOGF(fatal, "Pass '%s' not available in the retrieved CCDB object", passName.value.data());
+      } else {
+        LOGF(warning, "Pass '%s' not available in the retrieved CCDB object", passName.value.data());
+      }
+    }
+  }
+
   void init(o2::framework::InitContext& initContext)
   {
     if (inheritFromBaseTask.value) { // Inheriting from base task
@@ -179,6 +220,14 @@ struct tofPid {
       }
     }
     mRespParamsV2.print();
+    if (enableTimeDependentResponse && prefetchParamsPerRun) {
+      LOG(info) << "Time dependent parametrizations will be prefetched per run from " << parametrizationPath.value;
+      ccdbApi.init(url.value);
+      mParamCache = &o2::pid::ParamCache<o2::tof::ParameterCollection>::getShared(parametrizationPath.value);
+      if (!mParamCache->hasFetcher()) {
+        mParamCache->setFetcher(o2::pid::ParamCache<o2::tof::ParameterCollection>::ccdbFetcher(ccdbApi, parametrizationPath.value, {}));
+      }
+    }
     if (timeShiftCCDBPath.value != "") {
       if (timeShiftCCDBPath.value.find(".root") != std::string::npos) {
         mRespParamsV2.setTimeShiftParameters(timeShiftCCDBPath.value, "gmean_Pos", true);
@@ -311,14 +360,7 @@ struct tofPid {
       lastCollisionId = track.collisionId(); // Cache last collision ID
       timestamp.value = track.collision().bc_as<aod::BCsWithTimestamps>().timestamp();
       if (enableTimeDependentResponse) {
-        LOG(debug) << "Updating parametrization from path '" << parametrizationPath.value << "' and timestamp " << timestamp.value;
-        if (!ccdb->getForTimeStamp<o2::tof::ParameterCollection>(parametrizationPath.value, timestamp.value)->retrieveParameters(mRespParamsV2, passName.value)) {
-          if (fatalOnPassNotAvailable) {
-            LOGF(fatal, "Pass '%s' not available in the retrieved CCDB object", passName.value.data());
-          } else {
-            LOGF(warning, "Pass '%s' not available in the retrieved CCDB object", passName.value.data());
-          }
-        }
+        updateParametrization(track.collision().bc_as<aod::BCsWithTimestamps>());
       }
 
       const auto& tracksInCollision = tracks.sliceBy(perCollision, lastCollisionId);
@@ -400,15 +442,7 @@ struct tofPid {
 
       if (enableTimeDependentResponse && (track.collisionId() != mLastCollisionId)) { // Time dependent calib is enabled and this is a new collision
         mLastCollisionId = track.collisionId();                                       // Cache last collision ID
-        timestamp.value = track.collision().bc_as<aod::BCsWithTimestamps>().timestamp();
-        LOG(debug) << "Updating parametrization from path '" << parametrizationPath.value << "' and timestamp " << timestamp.value;
-        if (!ccdb->getForTimeStamp<o2::tof::ParameterCollection>(parametrizationPath.value, timestamp.value)->retrieveParameters(mRespParamsV2, passName.value)) {
-          if (fatalOnPassNotAvailable) {
-            LOGF(fatal, "Pass '%s' not available in the retrieved CCDB object", passName.value.data());
-          } else {
-            LOGF(warning, "Pass '%s' not available in the retrieved CCDB object", passName.value.data());
-          }
-        }
+        updateParametrization(track.collision().bc_as<aod::BCsWithTimestamps>());
       }
 
       for (auto const& pidId : mEnabledParticles) { // Loop on enabled particle hypotheses
@@ -16,6 +16,8 @@
 ///         Only the tables for the mass hypotheses requested are filled, the others are sent empty.
 ///
 
+#include <array>
+#include <cmath>
 #include <utility>
 #include <vector>
 #include <string>
@@ -180,6 +182,137 @@ o2::tof::eventTimeContainer evTimeMakerForTracks(const trackTypeContainer& track
   return o2::tof::evTimeMakerFromParam<trackTypeContainer, trackType, trackFilter, response, responseParametersType>(tracks, responseParameters, diamond);
 }
 
+/// Container of the TOF event time computed with the iterative estimator, same interface as o2::tof::eventTimeContainer
+struct evTimeIterativeContainer {
+  float mEventTime = 0.f;                    /// Value of the event time
+  float mEventTimeError = 0.f;               /// Uncertainty on the event time
+  unsigned short mEventTimeMultiplicity = 0; /// Track multiplicity used to compute the event time
+  float mSumOfWeights = 0.f;                 /// Sum of the weights, including the diamond
+  std::vector<float> mWeights;               /// Weight of each selected track (0 if not used), in the order of the tracks passing the filter
+  std::vector<float> mTrackTimes;            /// Event time measured by each selected track
+
+  /// Removes the contribution of a track to the event time, to be called in order on all the tracks of the collision
+  template <typename trackType, bool (*trackFilter)(const trackType&)>
+  void removeBias(const trackType& track, int& nTrackIndex, float& eventTimeValue, float& eventTimeError, const int& minimumMultiplicity = 2) const
+  {
+    eventTimeValue = mEventTime;
+    eventTimeError = mEventTimeError;
+    if (!trackFilter(track)) {
+      return;
+    }
+    const float weight = mWeights[nTrackIndex];
+    const float trackTime = mTrackTimes[nTrackIndex];
+    nTrackIndex++;
+    if (weight <= 0.f || mEventTimeMultiplicity <= minimumMultiplicity) {
+      return;
+    }
+    const float sumOfWeights = mSumOfWeights - weight;
+    eventTimeValue = (mEventTime * mSumOfWeights - weight * trackTime) / sumOfWeights;
+    eventTimeError = std::sqrt(1.f / sumOfWeights);
+  }
+};
+
+/// TOF event time with an iterative best-hypothesis reweighting, alternative to the combinatorial search of evTimeMakerFromParam.
+/// At each iteration every track takes the pi/K/p hypothesis closest to the current event time, tracks beyond maxNSigma are discarded
+/// and the event time is recomputed as the weighted mean together with the diamond constraint.
+/// The cost is bounded to O(maxNtracks x species x nIterations), only the first maxNtracks tracks passing the filter are used.
+template <typename trackType,
+          bool (*trackFilter)(const trackType&),
+          template <typename T, o2::track::PID::ID> typename response,
+          typename trackTypeContainer,
+          typename responseParametersType>
+evTimeIterativeContainer evTimeMakerIterative(const trackTypeContainer& tracks,
+                                              const responseParametersType& responseParameters,
+                                              const float& diamond,
+                                              const int& maxNtracks,
+                                              const int& nIterations,
+                                              const float& maxNSigma = 4.f)
+{
+  static constexpr int nSpecies = 3;
+  const float errDiamond = diamond * 33.356409f;
+  const float weightDiamond = 1.f / (errDiamond * errDiamond);
+
+  evTimeIterativeContainer evTime;
+  evTime.mEventTimeError = errDiamond;
+  evTime.mSumOfWeights = weightDiamond;
+
+  // Event time measured by each track for each hypothesis and its weight
+  std::vector<std::array<float, nSpecies>> trackTimes;
+  std::vector<std::array<float, nSpecies>> trackWeights;
+  for (auto const& track : tracks) {
+    if (!trackFilter(track)) {
+      continue;
+    }
+    evTime.mWeights.push_back(0.f);
+    evTime.mTrackTimes.push_back(0.f);
+    if (static_cast<int>(trackTimes.size()) >= maxNtracks) {
+      continue;
+    }
+    const float expTimes[nSpecies] = {response<trackType, o2::track::PID::Pion>::GetExpectedSignal(track),
+                                      response<trackType, o2::track::PID::Kaon>::GetExpectedSignal(track),
+                                      response<trackType, o2::track::PID::Proton>::GetExpectedSignal(track)};
+    const float expSigmas[nSpecies] = {response<trackType, o2::track::PID::Pion>::GetExpectedSigma(responseParameters, track, track.tofSignal(), 0.f),
+                                       response<trackType, o2::track::PID::Kaon>::GetExpectedSigma(responseParameters, track, track.tofSignal(), 0.f),
+                                       response<trackType, o2::track::PID::Proton>::GetExpectedSigma(responseParameters, track, track.tofSignal(), 0.f)};
+    auto& times = trackTimes.emplace_back();
+    auto& weights = trackWeights.emplace_back();
+    for (int iSpecies = 0; iSpecies < nSpecies; iSpecies++) {
+      times[iSpecies] = track.tofSignal() - expTimes[iSpecies];
+      weights[iSpecies] = expSigmas[iSpecies] > 0.f ? 1.f / (expSigmas[iSpecies] * expSigmas[iSpecies]) : 0.f;
+    }
+  }
+  const std::size_t nTracks = trackTimes.size();
+  if (nTracks == 0) {
+    return evTime;
+  }
+
+  std::vector<int> hypothesis(nTracks, -1);
+  for (int iteration = 0; iteration < nIterations; iteration++) {
+    const float eventTimeErr2 = evTime.mEventTimeError * evTime.mEventTimeError;
+    float sumOfTimes = 0.f;
+    float sumOfWeights = weightDiamond;
+    bool changed = false;
+    for (std::size_t iTrack = 0; iTrack < nTracks; iTrack++) {
+      int best = -1;
+      float bestChi2 = maxNSigma * maxNSigma;
+      for (int iSpecies = 0; iSpecies < nSpecies; iSpecies++) {
+        if (trackWeights[iTrack][iSpecies] <= 0.f) {
+          continue;
+        }
+        const float delta = trackTimes[iTrack][iSpecies] - evTime.mEventTime;
+        const float chi2 = delta * delta / (1.f / trackWeights[iTrack][iSpecies] + eventTimeErr2);
+        if (chi2 < bestChi2) {
+          bestChi2 = chi2;
+          best = iSpecies;
+        }
+      }
+      changed |= (best != hypothesis[iTrack]);
+      hypothesis[iTrack] = best;
+      if (best >= 0) {
+        sumOfTimes += trackTimes[iTrack][best] * trackWeights[iTrack][best];
+        sumOfWeights += trackWeights[iTrack][best];
+      }
+    }
+    evTime.mEventTime = sumOfTimes / sumOfWeights;
+    evTime.mEventTimeError = std::sqrt(1.f / sumOfWeights);
+    evTime.mSumOfWeights = sumOfWeights;
+    if (!changed && iteration > 0) {
+      break;
+    }
+  }
+
+  // Store the contribution of each track for the bias removal
+  for (std::size_t iTrack = 0; iTrack < nTracks; iTrack++) {
+    if (hypothesis[iTrack] < 0) {
+      continue;
+    }
+    evTime.mWeights[iTrack] = trackWeights[iTrack][hypothesis[iTrack]];
+    evTime.mTrackTimes[iTrack] = trackTimes[iTrack][hypothesis[iTrack]];
+    evTime.mEventTimeMultiplicity++;
+  }
+  return evTime;
+}
+
 /// Task to produce the TOF event time table
 struct tofEventTime {
   // Tables to produce
@@ -206,6 +339,9 @@ struct tofEventTime {
   Configurable<float> maxEvTimeTOF{"maxEvTimeTOF", 100000.0f, "Maximum value of the TOF event time"};
   Configurable<bool> sel8TOFEvTime{"sel8TOFEvTime", false, "Flag to compute the ev. time only for events that pass the sel8 ev. selection"};
   Configurable<int> maxNtracksInSet{"maxNtracksInSet", 10, "Size of the set to consider for the TOF ev. time computation"};
+  Configurable<bool> useIterativeEvTime{"useIterativeEvTime", false, "Flag to compute the TOF ev. time with the iterative estimator (linear cost) instead of the combinatorial one"};
+  Configurable<int> maxNtracksIterative{"maxNtracksIterative", 100, "Maximum number of tracks used by the iterative TOF ev. time estimator"};
+  Configurable<int> nIterationsEvTime{"nIterationsEvTime", 5, "Maximum number of iterations of the iterative TOF ev. time estimator"};
   // TOF Calib configuration
   Configurable<std::string> paramFileName{"paramFileName", "", "Path to the parametrization object. If empty the parametrization is not taken from file"};
   Configurable<std::string> parametrizationPath{"parametrizationPath", "TOF/Calib/Params", "Path of the TOF parametrization on the CCDB or in the file, if the paramFileName is not empty"};
@@ -323,6 +459,9 @@ struct tofEventTime {
     mRespParamsV3.print();
     o2::tof::eventTimeContainer::setMaxNtracksInSet(maxNtracksInSet.value);
     o2::tof::eventTimeContainer::printConfig();
+    if (useIterativeEvTime.value) {
+      LOG(info) << "Using the iterative TOF ev. time estimator with at most " << maxNtracksIterative.value << " tracks and " << nIterationsEvTime.value << " iterations";
+    }
   }
 
   ///
@@ -388,28 +527,35 @@ struct tofEventTime {
 
       const auto& tracksInCollision = tracks.sliceBy(perCollision, lastCollisionId);
 
-      // First make table for event time
-      const auto evTimeTOF = evTimeMakerForTracks<TrksEvTime::iterator, filterForTOFEventTime, o2::pid::tof::ExpTimes>(tracksInCollision, mRespParamsV3, diamond);
-      int nGoodTracksForTOF = 0;
-      float et = evTimeTOF.mEventTime;
-      float erret = evTimeTOF.mEventTimeError;
-
-      for (auto const& trk : tracksInCollision) { // Loop on Tracks
-        if constexpr (removeTOFEvTimeBias) {
-          evTimeTOF.removeBias<TrksEvTime::iterator, filterForTOFEventTime>(trk, nGoodTracksForTOF, et, erret, 2);
-        }
-        uint8_t flags = 0;
-        if (erret < errDiamond && (maxEvTimeTOF <= 0.f || abs(et) < maxEvTimeTOF)) {
-          flags |= o2::aod::pidflags::enums::PIDFlags::EvTimeTOF;
-        } else {
-          et = 0.f;
-          erret = errDiamond;
-        }
-        tableFlags(flags);
-        tableEvTime(et, erret);
-        if (enableTableTOFOnly) {
-          tableEvTimeTOFOnly((uint8_t)filterForTOFEventTime(trk), et, erret, evTimeTOF.mEventTimeMultiplicity);
+      auto fillTables = [&](const auto& evTimeTOF) {
+        int nGoodTracksForTOF = 0;
+        float et = evTimeTOF.mEventTime;
+        float erret = evTimeTOF.mEventTimeError;
+
+        for (auto const& trk : tracksInCollision) { // Loop on Tracks
+          if constexpr (removeTOFEvTimeBias) {
+            evTimeTOF.template removeBias<TrksEvTime::iterator, filterForTOFEventTime>(trk, nGoodTracksForTOF, et, erret, 2);
+          }
+          uint8_t flags = 0;
+          if (erret < errDiamond && (maxEvTimeTOF <= 0.f || abs(et) < maxEvTimeTOF)) {
+            flags |= o2::aod::pidflags::enums::PIDFlags::EvTimeTOF;
+          } else {
+            et = 0.f;
+            erret = errDiamond;
+          }
+          tableFlags(flags);
+          tableEvTime(et, erret);
+          if (enableTableTOFOnly) {
+            tableEvTimeTOFOnly((uint8_t)filterForTOFEventTime(trk), et, erret, evTimeTOF.mEventTimeMultiplicity);
+          }
         }
+      };
+
+      // First make table for event time
+      if (useIterativeEvTime.value) {
+        fillTables(evTimeMakerIterative<TrksEvTime::iterator, filterForTOFEventTime, o2::pid::tof::ExpTimes>(tracksInCollision, mRespParamsV3, diamond, maxNtracksIterative.value, nIterationsEvTime.value));
+      } else {
+        fillTables(evTimeMakerForTracks<TrksEvTime::iterator, filterForTOFEventTime, o2::pid::tof::ExpTimes>(tracksInCollision, mRespParamsV3, diamond));
       }
     }
   }
@@ -451,61 +597,67 @@ struct tofEventTime {
       const auto& tracksInCollision = tracks.sliceBy(perCollision, lastCollisionId);
       const auto& collision = t.collision_as<EvTimeCollisionsFT0>();
 
-      // Compute the TOF event time
-      const auto evTimeTOF = evTimeMakerForTracks<TrksEvTime::iterator, filterForTOFEventTime, o2::pid::tof::ExpTimes>(tracksInCollision, mRespParamsV3, diamond);
-
-      float t0AC[2] = {.0f, 999.f};                                                                                   // Value and error of T0A or T0C or T0AC
-      float t0TOF[2] = {static_cast<float_t>(evTimeTOF.mEventTime), static_cast<float_t>(evTimeTOF.mEventTimeError)}; // Value and error of TOF
-
-      uint8_t flags = 0;
-      int nGoodTracksForTOF = 0;
-      float eventTime = 0.f;
-      float sumOfWeights = 0.f;
-      float weight = 0.f;
-
-      for (auto const& trk : tracksInCollision) { // Loop on Tracks
-        // Reset the flag
-        flags = 0;
-        // Reset the event time
-        eventTime = 0.f;
-        sumOfWeights = 0.f;
-        weight = 0.f;
-        // Remove the bias on TOF ev. time
-        if constexpr (removeTOFEvTimeBias) {
-          evTimeTOF.removeBias<TrksEvTime::iterator, filterForTOFEventTime>(trk, nGoodTracksForTOF, t0TOF[0], t0TOF[1], 2);
-        }
-        if (t0TOF[1] < errDiamond && (maxEvTimeTOF <= 0 || abs(t0TOF[0]) < maxEvTimeTOF)) {
-          flags |= o2::aod::pidflags::enums::PIDFlags::EvTimeTOF;
+      auto fillTables = [&](const auto& evTimeTOF) {
+        float t0AC[2] = {.0f, 999.f};                                                                                   // Value and error of T0A or T0C or T0AC
+        float t0TOF[2] = {static_cast<float_t>(evTimeTOF.mEventTime), static_cast<float_t>(evTimeTOF.mEventTimeError)}; // Value and error of TOF
 
-          weight = 1.f / (t0TOF[1] * t0TOF[1]);
-          eventTime += t0TOF[0] * weight;
-          sumOfWeights += weight;
-        }
+        uint8_t flags = 0;
+        int nGoodTracksForTOF = 0;
+        float eventTime = 0.f;
+        float sumOfWeights = 0.f;
+        float weight = 0.f;
+
+        for (auto const& trk : tracksInCollision) { // Loop on Tracks
+          // Reset the flag
+          flags = 0;
+          // Reset the event time
+          eventTime = 0.f;
+          sumOfWeights = 0.f;
+          weight = 0.f;
+          // Remove the bias on TOF ev. time
+          if constexpr (removeTOFEvTimeBias) {
+            evTimeTOF.template removeBias<TrksEvTime::iterator, filterForTOFEventTime>(trk, nGoodTracksForTOF, t0TOF[0], t0TOF[1], 2);
+          }
+          if (t0TOF[1] < errDiamond && (maxEvTimeTOF <= 0 || abs(t0TOF[0]) < maxEvTimeTOF)) {
+            flags |= o2::aod::pidflags::enums::PIDFlags::EvTimeTOF;
 
-        if (collision.has_foundFT0()) { // T0 measurement is available
-          // const auto& ft0 = collision.foundFT0();
-          if (collision.t0ACValid()) {
-            t0AC[0] = collision.t0AC() * 1000.f;
-            t0AC[1] = collision.t0resolution() * 1000.f;
-            flags |= o2::aod::pidflags::enums::PIDFlags::EvTimeT0AC;
+            weight = 1.f / (t0TOF[1] * t0TOF[1]);
+            eventTime += t0TOF[0] * weight;
+            sumOfWeights += weight;
           }
 
-          weight = 1.f / (t0AC[1] * t0AC[1]);
-          eventTime += t0AC[0] * weight;
-          sumOfWeights += weight;
-        }
+          if (collision.has_foundFT0()) { // T0 measurement is available
+            // const auto& ft0 = collision.foundFT0();
+            if (collision.t0ACValid()) {
+              t0AC[0] = collision.t0AC() * 1000.f;
+              t0AC[1] = collision.t0resolution() * 1000.f;
+              flags |= o2::aod::pidflags::enums::PIDFlags::EvTimeT0AC;
+            }
+
+            weight = 1.f / (t0AC[1] * t0AC[1]);
+            eventTime += t0AC[0] * weight;
+            sumOfWeights += weight;
+          }
 
-        if (sumOfWeights < weightDiamond) { // avoiding sumOfWeights = 0 or worse that diamond
-          eventTime = 0;
-          sumOfWeights = weightDiamond;
-          tableFlags(0);
-        } else {
-          tableFlags(flags);
-        }
-        tableEvTime(eventTime / sumOfWeights, sqrt(1. / sumOfWeights));
-        if (enableTableTOFOnly) {
-          tableEvTimeTOFOnly((uint8_t)filterForTOFEventTime(trk), t0TOF[0], t0TOF[1], evTimeTOF.mEventTimeMultiplicity);
+          if (sumOfWeights < weightDiamond) { // avoiding sumOfWeights = 0 or worse that diamond
+            eventTime = 0;
+            sumOfWeights = weightDiamond;
+            tableFlags(0);
+          } else {
+            tableFlags(flags);
+          }
+          tableEvTime(eventTime / sumOfWeights, sqrt(1. / sumOfWeights));
+          if (enableTableTOFOnly) {
+            tableEvTimeTOFOnly((uint8_t)filterForTOFEventTime(trk), t0TOF[0], t0TOF[1], evTimeTOF.mEventTimeMultiplicity);
+          }
         }
+      };
+
+      // Compute the TOF event time
+      if (useIterativeEvTime.value) {
+        fillTables(evTimeMakerIterative<TrksEvTime::iterator, filterForTOFEventTime, o2::pid::tof::ExpTimes>(tracksInCollision, mRespParamsV3, diamond, maxNtracksIterative.value, nIterationsEvTime.value));
+      } else {
+        fillTables(evTimeMakerForTracks<TrksEvTime::iterator, filterForTOFEventTime, o2::pid::tof::ExpTimes>(tracksInCollision, mRespParamsV3, diamond));
       }
     }
   }
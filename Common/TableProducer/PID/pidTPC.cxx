@@ -31,6 +31,7 @@
 #include "CCDB/CcdbApi.h"
 #include "Common/DataModel/PIDResponse.h"
 #include "Common/Core/PID/TPCPIDResponse.h"
+#include "Common/Core/PID/ParamCache.h"
 #include "Framework/AnalysisDataModel.h"
 #include "Common/DataModel/Multiplicity.h"
 #include "TableHelper.h"
@@ -119,9 +120,51 @@ struct tpcPid {
   Configurable<int> useNetworkHe{"useNetworkHe", 1, {"Switch for applying neural network on the helium3 mass hypothesis (if network enabled) (set to 0 to disable)"}};
   Configurable<int> useNetworkAl{"useNetworkAl", 1, {"Switch for applying neural network on the alpha mass hypothesis (if network enabled) (set to 0 to disable)"}};
   Configurable<float> networkBetaGammaCutoff{"networkBetaGammaCutoff", 0.45, {"Lower value of beta-gamma to override the NN application"}};
+  Configurable<bool> prefetchResponsePerRun{"prefetchResponsePerRun", false, "Flag to prefetch at the first timestamp of each run all the TPC response objects valid over the run and serve the following lookups from memory"};
 
   // Parametrization configuration
   bool useCCDBParam = false;
+  o2::pid::ParamCache<o2::pid::tpc::Response>* responseCache = nullptr; // Per-run cache of the TPC response objects, shared in the device
+  int lastRunNumber = -1;
+
+  /// Updates the TPC response object for the timestamp of the BC
+  template <typename BCType>
+  void updateResponse(const BCType& bc)
+  {
+    if (responseCache) {
+      if (bc.runNumber() != lastRunNumber) {
+        lastRunNumber = bc.runNumber();
+        auto runDuration = ccdb->getRunDuration(lastRunNumber);
+        responseCache->prefetchRun(lastRunNumber, runDuration.first, runDuration.second);
+      }
+      auto* cachedResponse = responseCache->get(bc.timestamp());
+      if (!cachedResponse) {
+        LOGP(fatal, "Could not find ANY TPC response object for the timestamp {}!", bc.timestamp());
+      }
+      if (cachedResponse != response) {
+        response = cachedResponse;
+        response->PrintAll();
+      }
+      return;
+    }
+    if (ccdb->isCachedObjectValid(ccdbPath.value, bc.timestamp())) {
+      return;
+    }
+    if (recoPass.value == "") {
+      LOGP(info, "Retrieving latest TPC response object for timestamp {}:", bc.timestamp());
+    } else {
+      LOGP(info, "Retrieving TPC Response for timestamp {} and recoPass {}:", bc.timestamp(), recoPass.value);
+    }
+    response = ccdb->getSpecific<o2::pid::tpc::Response>(ccdbPath.value, bc.timestamp(), metadata);
+    if (!response) {
+      LOGP(warning, "!! Could not find a valid TPC response object for specific pass name {}! Falling back to latest uploaded object.", recoPass.value);
+      response = ccdb->getForTimeStamp<o2::pid::tpc::Response>(ccdbPath.value, bc.timestamp());
+      if (!response) {
+        LOGP(fatal, "Could not find ANY TPC response object for the timestamp {}!", bc.timestamp());
+      }
+    }
+    response->PrintAll();
+  }
 
   void init(o2::framework::InitContext& initContext)
   {
@@ -197,6 +240,13 @@ struct tpcPid {
           }
         }
         response->PrintAll();
+      } else if (prefetchResponsePerRun) {
+        LOGP(info, "TPC response objects will be prefetched per run from {}", path);
+        ccdbApi.init(url);
+        responseCache = &o2::pid::ParamCache<o2::pid::tpc::Response>::getShared(path + "/" + recoPass.value);
+        if (!responseCache->hasFetcher()) {
+          responseCache->setFetcher(o2::pid::ParamCache<o2::pid::tpc::Response>::ccdbFetcher(ccdbApi, path, metadata));
+        }
       }
     }
 
@@ -249,21 +299,8 @@ struct tpcPid {
     if (autofetchNetworks) {
       const auto& bc = bcs.begin();
       // Initialise correct TPC response object before NN setup (for NCl normalisation)
-      if (useCCDBParam && ccdbTimestamp.value == 0 && !ccdb->isCachedObjectValid(ccdbPath.value, bc.timestamp())) { // Updating parametrisation only if the initial timestamp is 0
-        if (recoPass.value == "") {
-          LOGP(info, "Retrieving latest TPC response object for timestamp {}:", bc.timestamp());
-        } else {
-          LOGP(info, "Retrieving TPC Response for timestamp {} and recoPass {}:", bc.timestamp(), recoPass.value);
-        }
-        response = ccdb->getSpecific<o2::pid::tpc::Response>(ccdbPath.value, bc.timestamp(), metadata);
-        if (!response) {
-          LOGP(warning, "!! Could not find a valid TPC response object for specific pass name {}! Falling back to latest uploaded object.", recoPass.value);
-          response = ccdb->getForTimeStamp<o2::pid::tpc::Response>(ccdbPath.value, bc.timestamp());
-          if (!response) {
-            LOGP(fatal, "Could not find ANY TPC response object for the timestamp {}!", bc.timestamp());
-          }
-        }
-        response->PrintAll();
+      if (useCCDBParam && ccdbTimestamp.value == 0) { // Updating parametrisation only if the initial timestamp is 0
+        updateResponse(bc);
       }
 
       if (bc.timestamp() < network.getValidityFrom() || bc.timestamp() > network.getValidityUntil()) { // fetches network only if the runnumbers change
@@ -373,21 +410,8 @@ struct tpcPid {
       // Loop on Tracks
 
       const auto& bc = trk.has_collision() ? collisions.iteratorAt(trk.collisionId()).bc_as<aod::BCsWithTimestamps>() : bcs.begin();
-      if (useCCDBParam && ccdbTimestamp.value == 0 && !ccdb->isCachedObjectValid(ccdbPath.value, bc.timestamp())) { // Updating parametrisation only if the initial timestamp is 0
-        if (recoPass.value == "") {
-          LOGP(info, "Retrieving latest TPC response object for timestamp {}:", bc.timestamp());
-        } else {
-          LOGP(info, "Retrieving TPC Response for timestamp {} and recoPass {}:", bc.timestamp(), recoPass.value);
-        }
-        response = ccdb->getSpecific<o2::pid::tpc::Response>(ccdbPath.value, bc.timestamp(), metadata);
-        if (!response) {
-          LOGP(warning, "!! Could not find a valid TPC response object for specific pass name {}! Falling back to latest uploaded object.", recoPass.value);
-          response = ccdb->getForTimeStamp<o2::pid::tpc::Response>(ccdbPath.value, bc.timestamp());
-          if (!response) {
-            LOGP(fatal, "Could not find ANY TPC response object for the timestamp {}!", bc.timestamp());
-          }
-        }
-        response->PrintAll();
+      if (useCCDBParam && ccdbTimestamp.value == 0) { // Updating parametrisation only if the initial timestamp is 0
+        updateResponse(bc);
       }
 
       // Check and fill enabled tables
@@ -491,21 +515,8 @@ struct tpcPid {
     for (auto const& trk : tracksMc) {
       // Loop on Tracks
       const auto& bc = trk.has_collision() ? collisionsMc.iteratorAt(trk.collisionId()).bc_as<aod::BCsWithTimestamps>() : bcs.begin();
-      if (useCCDBParam && ccdbTimestamp.value == 0 && !ccdb->isCachedObjectValid(ccdbPath.value, bc.timestamp())) { // Updating parametrisation only if the initial timestamp is 0
-        if (recoPass.value == "") {
-          LOGP(info, "Retrieving latest TPC response object for timestamp {}:", bc.timestamp());
-        } else {
-          LOGP(info, "Retrieving TPC Response for timestamp {} and recoPass {}:", bc.timestamp(), recoPass.value);
-        }
-        response = ccdb->getSpecific<o2::pid::tpc::Response>(ccdbPath.value, bc.timestamp(), metadata);
-        if (!response) {
-          LOGP(warning, "!! Could not find a valid TPC response object for specific pass name {}! Falling back to latest uploaded object.", recoPass.value);
-          response = ccdb->getForTimeStamp<o2::pid::tpc::Response>(ccdbPath.value, bc.timestamp());
-          if (!response) {
-            LOGP(fatal, "Could not find ANY TPC response object for the timestamp {}!", bc.timestamp());
-          }
-        }
-        response->PrintAll();
+      if (useCCDBParam && ccdbTimestamp.value == 0) { // Updating parametrisation only if the initial timestamp is 0
+        updateResponse(bc);
       }
 
       // Perform TuneOnData sampling for MC dE/dx
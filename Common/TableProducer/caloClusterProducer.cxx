@@ -9,6 +9,11 @@
 // granted to it by virtue of its status as an Intergovernmental Organization
 // or submit itself to any jurisdiction.
 
+#include <algorithm>
+#include <array>
+#include <utility>
+#include <vector>
+
 #include "Framework/ConfigParamSpec.h"
 #include "Framework/runDataProcessing.h"
 #include "Framework/AnalysisTask.h"
@@ -99,6 +104,17 @@ struct caloClusterProducerTask {
     int mEnd[kCpvCells];   // Z (theta) track coordinate in PHOS plane
   };
 
+  // CPV clusters and tracks hit in grid/cell in PHOS, with their ranges per BC.
+  // Kept by the task to reuse the memory across dataframes.
+  std::array<std::vector<std::pair<float, float>>, kCpvCells> cpvMatchPoints;
+  std::vector<trackTrigRec> cpvNMatchPoints; // sorted in BC
+  std::array<std::vector<trackMatch>, kCpvCells> trackMatchPoints;
+  std::vector<trackTrigRec> trackNMatchPoints; // sorted in BC
+  std::vector<int64_t> clusterBCs;             // sorted BCs with PHOS clusters
+  std::vector<int64_t> collisionBCs;           // global BC of each collision
+  std::vector<int> matchRegions;               // grid cells around a PHOS cluster
+  std::array<double, 5> mPHOSRadii{};          // radius of the center of each module (1-4), 0 if not yet computed
+
   void init(o2::framework::InitContext&)
   {
     ccdb->setURL(o2::base::NameConf::getCCDBServer());
@@ -214,9 +230,11 @@ struct caloClusterProducerTask {
                                   outputPHOSClusters, outputCluElements, outputPHOSClusterTrigRecs, dummyMC);
 
     // Find  CPV clusters corresponding to PHOS trigger records
-    std::vector<std::pair<float, float>> cpvMatchPoints[kCpvCells];
+    for (auto& points : cpvMatchPoints) {
+      points.clear();
+    }
     // Number of entries in each cell per TrigRecord
-    std::vector<trackTrigRec> cpvNMatchPoints;
+    cpvNMatchPoints.clear();
     cpvNMatchPoints.reserve(outputPHOSClusterTrigRecs.size());
     int64_t curBC = -1;
     if (cpvs.begin() != cpvs.end()) {
@@ -253,6 +271,7 @@ struct caloClusterProducerTask {
         cpvNMatchPoints.back().mEnd[i] = cpvMatchPoints[i].size();
       }
     }
+    sortMatchPoints(cpvNMatchPoints);
 
     // Fill output
     for (auto& cluTR : outputPHOSClusterTrigRecs) {
@@ -270,16 +289,9 @@ struct caloClusterProducerTask {
         colId = coliter->second;
       }
 
-      bool cpvExist = false;
       // find cpvTR for this BC
-      auto cpvPoints = cpvNMatchPoints.begin();
-      while (cpvPoints != cpvNMatchPoints.end()) {
-        if (cpvPoints->mTR == cluTR.getBCData().toLong()) {
-          cpvExist = true;
-          break;
-        }
-        cpvPoints++;
-      }
+      auto cpvPoints = findMatchPoints(cpvNMatchPoints, cluTR.getBCData().toLong());
+      bool cpvExist = cpvPoints != cpvNMatchPoints.end();
 
       for (int i = firstClusterInEvent; i < lastClusterInEvent; i++) {
         o2::phos::Cluster& clu = outputPHOSClusters[i];
@@ -317,7 +329,8 @@ struct caloClusterProducerTask {
 
         if (mod >= 2 && cpvExist) { // CPV exist in mods 2,3,4
           int phosIndex = CpvMatchIndex(mod, posX, posZ);
-          std::vector<int> regions;
+          std::vector<int>& regions = matchRegions;
+          regions.clear();
           regions.push_back(phosIndex);
           if (posX > -cpvMaxX + cellSizeX) {
             if (posZ > -cpvMaxZ + cellSizeZ) { // bottom left
@@ -530,9 +543,11 @@ struct caloClusterProducerTask {
                                   outputPHOSClusters, outputCluElements, outputPHOSClusterTrigRecs, outputTruthCont);
 
     // Find  CPV clusters corresponding to PHOS trigger records
-    std::vector<std::pair<float, float>> cpvMatchPoints[kCpvCells];
+    for (auto& points : cpvMatchPoints) {
+      points.clear();
+    }
     // Number of entries in each cell per TrigRecord
-    std::vector<trackTrigRec> cpvNMatchPoints;
+    cpvNMatchPoints.clear();
     cpvNMatchPoints.reserve(outputPHOSClusterTrigRecs.size());
     int64_t curBC = -1;
     if (cpvs.begin() != cpvs.end()) {
@@ -569,6 +584,7 @@ struct caloClusterProducerTask {
         cpvNMatchPoints.back().mEnd[i] = cpvMatchPoints[i].size();
       }
     }
+    sortMatchPoints(cpvNMatchPoints);
 
     // Fill output
     for (auto& cluTR : outputPHOSClusterTrigRecs) {
@@ -586,16 +602,9 @@ struct caloClusterProducerTask {
         colId = coliter->second;
       }
 
-      bool cpvExist = false;
       // find cpvTR for this BC
-      auto cpvPoints = cpvNMatchPoints.begin();
-      while (cpvPoints != cpvNMatchPoints.end()) {
-        if (cpvPoints->mTR == cluTR.getBCData().toLong()) {
-          cpvExist = true;
-          break;
-        }
-        cpvPoints++;
-      }
+      auto cpvPoints = findMatchPoints(cpvNMatchPoints, cluTR.getBCData().toLong());
+      bool cpvExist = cpvPoints != cpvNMatchPoints.end();
 
       for (int i = firstClusterInEvent; i < lastClusterInEvent; i++) {
         o2::phos::Cluster& clu = outputPHOSClusters[i];
@@ -633,7 +642,8 @@ struct caloClusterProducerTask {
 
         if (mod >= 2 && cpvExist) { // CPV exist in mods 2,3,4
           int phosIndex = CpvMatchIndex(mod, posX, posZ);
-          std::vector<int> regions;
+          std::vector<int>& regions = matchRegions;
+          regions.clear();
           regions.push_back(phosIndex);
           if (posX > -cpvMaxX + cellSizeX) {
             if (posZ > -cpvMaxZ + cellSizeZ) { // bottom left
@@ -850,9 +860,11 @@ struct caloClusterProducerTask {
                                   outputPHOSClusters, outputCluElements, outputPHOSClusterTrigRecs, dummyMC);
 
     // Find  CPV clusters corresponding to PHOS trigger records
-    std::vector<std::pair<float, float>> cpvMatchPoints[kCpvCells];
+    for (auto& points : cpvMatchPoints) {
+      points.clear();
+    }
     // Number of entries in each cell per TrigRecord
-    std::vector<trackTrigRec> cpvNMatchPoints;
+    cpvNMatchPoints.clear();
     cpvNMatchPoints.reserve(outputPHOSClusterTrigRecs.size());
 
     int64_t curBC = -1;
@@ -889,80 +901,9 @@ struct caloClusterProducerTask {
         cpvNMatchPoints.back().mEnd[i] = cpvMatchPoints[i].size();
       }
     }
+    sortMatchPoints(cpvNMatchPoints);
     // same for tracks
-    std::vector<trackMatch> trackMatchPoints[kCpvCells]; // tracks hit in grid/cell in PHOS
-    // Number of entries in each cell per TrigRecord
-    std::vector<trackTrigRec> trackNMatchPoints;
-    trackNMatchPoints.reserve(outputPHOSClusterTrigRecs.size());
-
-    curBC = 0;
-    for (const auto& track : tracks) {
-      if (track.has_collision()) { // ignore orphan tracks without collision
-        curBC = track.collision().bc_as<aod::BCsWithTimestamps>().globalBC();
-        break;
-      }
-    }
-    bool keepBC = false;
-    for (auto& cluTR : outputPHOSClusterTrigRecs) {
-      if (cluTR.getBCData().toLong() == curBC) {
-        keepBC = true;
-        break;
-      }
-    }
-    if (keepBC) {
-      trackNMatchPoints.emplace_back();
-      trackNMatchPoints.back().mTR = curBC;
-      for (int i = kCpvCells; i--;) {
-        trackNMatchPoints.back().mStart[i] = 0;
-      }
-    }
-    for (const auto& track : tracks) {
-      if (!track.has_collision()) {
-        continue;
-      }
-      if (static_cast<int64_t>(track.collision().bc_as<aod::BCsWithTimestamps>().globalBC()) != curBC) { // new BC
-        // close previous BC if exist
-        if (keepBC) {
-          // mark last entry in previous range
-          for (int i = kCpvCells; i--;) {
-            trackNMatchPoints.back().mEnd[i] = trackMatchPoints[i].size();
-          }
-          curBC = track.collision().bc_as<aod::BCsWithTimestamps>().globalBC();
-        }
-        keepBC = false;
-        for (auto& cluTR : outputPHOSClusterTrigRecs) {
-          if (cluTR.getBCData().toLong() == curBC) {
-            keepBC = true;
-            break;
-          }
-        }
-        if (!keepBC) {
-          continue;
-        }
-        trackNMatchPoints.emplace_back();
-        trackNMatchPoints.back().mTR = curBC;
-        for (int i = kCpvCells; i--;) {
-          trackNMatchPoints.back().mStart[i] = trackMatchPoints[i].size();
-        }
-      }
-      // if (!keepBC || !track.isGlobalTrack()) {  // only global tracks
-      if (!keepBC) {
-        continue;
-      }
-      // calculate coordinate in PHOS plane
-      int16_t module;
-      float trackX, trackZ;
-      auto trackPar = getTrackPar(track);
-      if (impactOnPHOS(trackPar, track.trackEtaEmcal(), track.trackPhiEmcal(), track.collision().posZ(), module, trackX, trackZ)) {
-        int index = CpvMatchIndex(module, trackX, trackZ);
-        trackMatchPoints[index].emplace_back(trackX, trackZ, track.globalIndex());
-      }
-    }
-    if (keepBC) {
-      for (int i = kCpvCells; i--;) {
-        trackNMatchPoints.back().mEnd[i] = trackMatchPoints[i].size();
-      }
-    }
+    fillTrackMatchPoints(colls, tracks);
 
     // Fill output tables
     for (auto& cluTR : outputPHOSClusterTrigRecs) {
@@ -980,25 +921,12 @@ struct caloClusterProducerTask {
         colId = coliter->second;
       }
 
-      bool cpvExist = false;
       // find cpvTR for this BC
-      auto cpvPoints = cpvNMatchPoints.begin();
-      while (cpvPoints != cpvNMatchPoints.end()) {
-        if (cpvPoints->mTR == cluTR.getBCData().toLong()) {
-          cpvExist = true;
-          break;
-        }
-        cpvPoints++;
-      }
+      auto cpvPoints = findMatchPoints(cpvNMatchPoints, cluTR.getBCData().toLong());
+      bool cpvExist = cpvPoints != cpvNMatchPoints.end();
 
-      // find cpvTR for this BC
-      auto trackPoints = trackNMatchPoints.begin();
-      while (trackPoints != trackNMatchPoints.end()) {
-        if (trackPoints->mTR == cluTR.getBCData().toLong()) {
-          break;
-        }
-        trackPoints++;
-      }
+      // find trackTR for this BC
+      auto trackPoints = findMatchPoints(trackNMatchPoints, cluTR.getBCData().toLong());
 
       for (int i = firstClusterInEvent; i < lastClusterInEvent; i++) {
         o2::phos::Cluster& clu = outputPHOSClusters[i];
@@ -1034,7 +962,8 @@ struct caloClusterProducerTask {
         const float cellSizeZ = 2 * cpvMaxZ / kCpvZ;
         // look 9 CPV regions around PHOS cluster
         int phosIndex = CpvMatchIndex(mod, posX, posZ);
-        std::vector<int> regions;
+        std::vector<int>& regions = matchRegions;
+        regions.clear();
         regions.push_back(phosIndex);
         if (posX > -cpvMaxX + cellSizeX) {
           if (posZ > -cpvMaxZ + cellSizeZ) { // bottom left
@@ -1281,9 +1210,11 @@ struct caloClusterProducerTask {
                                   outputPHOSClusters, outputCluElements, outputPHOSClusterTrigRecs, outputTruthCont);
 
     // Find  CPV clusters corresponding to PHOS trigger records
-    std::vector<std::pair<float, float>> cpvMatchPoints[kCpvCells];
+    for (auto& points : cpvMatchPoints) {
+      points.clear();
+    }
     // Number of entries in each cell per TrigRecord
-    std::vector<trackTrigRec> cpvNMatchPoints;
+    cpvNMatchPoints.clear();
     cpvNMatchPoints.reserve(outputPHOSClusterTrigRecs.size());
 
     int64_t curBC = -1;
@@ -1320,80 +1251,9 @@ struct caloClusterProducerTask {
         cpvNMatchPoints.back().mEnd[i] = cpvMatchPoints[i].size();
       }
     }
+    sortMatchPoints(cpvNMatchPoints);
     // same for tracks
-    std::vector<trackMatch> trackMatchPoints[kCpvCells]; // tracks hit in grid/cell in PHOS
-    // Number of entries in each cell per TrigRecord
-    std::vector<trackTrigRec> trackNMatchPoints;
-    trackNMatchPoints.reserve(outputPHOSClusterTrigRecs.size());
-
-    curBC = -1;
-    for (const auto& track : tracks) {
-      if (track.has_collision()) { // ignore orphan tracks without collision
-        curBC = track.collision().bc_as<aod::BCsWithTimestamps>().globalBC();
-        break;
-      }
-    }
-    bool keepBC = false;
-    for (auto& cluTR : outputPHOSClusterTrigRecs) {
-      if (cluTR.getBCData().toLong() == curBC) {
-        keepBC = true;
-        break;
-      }
-    }
-    if (keepBC) {
-      trackNMatchPoints.emplace_back();
-      trackNMatchPoints.back().mTR = curBC;
-      for (int i = kCpvCells; i--;) {
-        trackNMatchPoints.back().mStart[i] = 0;
-      }
-    }
-    for (const auto& track : tracks) {
-      if (!track.has_collision()) {
-        continue;
-      }
-      if (static_cast<int64_t>(track.collision().bc_as<aod::BCsWithTimestamps>().globalBC()) != curBC) { // new BC
-        // close previous BC if exist
-        if (keepBC) {
-          // mark last entry in previous range
-          for (int i = kCpvCells; i--;) {
-            trackNMatchPoints.back().mEnd[i] = trackMatchPoints[i].size();
-          }
-          curBC = track.collision().bc_as<aod::BCsWithTimestamps>().globalBC();
-        }
-        keepBC = false;
-        for (auto& cluTR : outputPHOSClusterTrigRecs) {
-          if (cluTR.getBCData().toLong() == curBC) {
-            keepBC = true;
-            break;
-          }
-        }
-        if (!keepBC) {
-          continue;
-        }
-        trackNMatchPoints.emplace_back();
-        trackNMatchPoints.back().mTR = curBC;
-        for (int i = kCpvCells; i--;) {
-          trackNMatchPoints.back().mStart[i] = trackMatchPoints[i].size();
-        }
-      }
-      // if (!keepBC || !track.isGlobalTrack()) {  // only global tracks
-      if (!keepBC) {
-        continue;
-      }
-      // calculate coordinate in PHOS plane
-      int16_t module;
-      float trackX, trackZ;
-      auto trackPar = getTrackPar(track);
-      if (impactOnPHOS(trackPar, track.trackEtaEmcal(), track.trackPhiEmcal(), track.collision().posZ(), module, trackX, trackZ)) {
-        int index = CpvMatchIndex(module, trackX, trackZ);
-        trackMatchPoints[index].emplace_back(trackX, trackZ, track.globalIndex());
-      }
-    }
-    if (keepBC) {
-      for (int i = kCpvCells; i--;) {
-        trackNMatchPoints.back().mEnd[i] = trackMatchPoints[i].size();
-      }
-    }
+    fillTrackMatchPoints(colls, tracks);
 
     // Fill output tables
     for (auto& cluTR : outputPHOSClusterTrigRecs) {
@@ -1411,24 +1271,11 @@ struct caloClusterProducerTask {
         colId = coliter->second;
       }
 
-      bool cpvExist = false;
-      // find cpvTR for this BC
-      auto cpvPoints = cpvNMatchPoints.begin();
-      while (cpvPoints != cpvNMatchPoints.end()) {
-        if (cpvPoints->mTR == cluTR.getBCData().toLong()) {
-          cpvExist = true;
-          break;
-        }
-        cpvPoints++;
-      }
       // find cpvTR for this BC
-      auto trackPoints = trackNMatchPoints.begin();
-      while (trackPoints != trackNMatchPoints.end()) {
-        if (trackPoints->mTR == cluTR.getBCData().toLong()) {
-          break;
-        }
-        trackPoints++;
-      }
+      auto cpvPoints = findMatchPoints(cpvNMatchPoints, cluTR.getBCData().toLong());
+      bool cpvExist = cpvPoints != cpvNMatchPoints.end();
+      // find trackTR for this BC
+      auto trackPoints = findMatchPoints(trackNMatchPoints, cluTR.getBCData().toLong());
 
       for (int i = firstClusterInEvent; i < lastClusterInEvent; i++) {
         o2::phos::Cluster& clu = outputPHOSClusters[i];
@@ -1463,7 +1310,8 @@ struct caloClusterProducerTask {
         const float cellSizeZ = 2 * cpvMaxZ / kCpvZ;
         // look 9 CPV regions around PHOS cluster
         int phosIndex = CpvMatchIndex(mod, posX, posZ);
-        std::vector<int> regions;
+        std::vector<int>& regions = matchRegions;
+        regions.clear();
         regions.push_back(phosIndex);
         if (posX > -cpvMaxX + cellSizeX) {
           if (posZ > -cpvMaxZ + cellSizeZ) { // bottom left
@@ -1583,6 +1431,102 @@ struct caloClusterProducerTask {
 
   PROCESS_SWITCH(caloClusterProducerTask, processFullMC, "Process MC with track matching", false);
 
+  // Fills the impact points in PHOS of the tracks of the BCs with PHOS clusters, per BC and grid cell.
+  // The tracks are expected to be grouped in BC, as their collisions.
+  template <typename Tracks>
+  void fillTrackMatchPoints(o2::aod::Collisions const& colls, Tracks const& tracks)
+  {
+    for (auto& points : trackMatchPoints) {
+      points.clear();
+    }
+    // Number of entries in each cell per TrigRecord
+    trackNMatchPoints.clear();
+    trackNMatchPoints.reserve(outputPHOSClusterTrigRecs.size());
+
+    clusterBCs.clear();
+    for (auto& cluTR : outputPHOSClusterTrigRecs) {
+      clusterBCs.push_back(cluTR.getBCData().toLong());
+    }
+    std::sort(clusterBCs.begin(), clusterBCs.end());
+    collisionBCs.clear();
+    collisionBCs.reserve(colls.size());
+    for (const auto& cl : colls) {
+      collisionBCs.push_back(cl.bc_as<aod::BCsWithTimestamps>().globalBC());
+    }
+
+    int64_t curBC = -1;
+    bool keepBC = false;
+    for (const auto& track : tracks) {
+      if (!track.has_collision()) { // ignore orphan tracks without collision
+        continue;
+      }
+      int64_t trackBC = collisionBCs[track.collisionId()];
+      if (trackBC != curBC) { // new BC
+        // close previous BC if exist
+        if (keepBC) {
+          // mark last entry in previous range
+          for (int i = kCpvCells; i--;) {
+            trackNMatchPoints.back().mEnd[i] = trackMatchPoints[i].size();
+          }
+        }
+        curBC = trackBC;
+        keepBC = std::binary_search(clusterBCs.begin(), clusterBCs.end(), curBC);
+        if (keepBC) {
+          trackNMatchPoints.emplace_back();
+          trackNMatchPoints.back().mTR = curBC;
+          for (int i = kCpvCells; i--;) {
+            trackNMatchPoints.back().mStart[i] = trackMatchPoints[i].size();
+          }
+        }
+      }
+      if (!keepBC) {
+        continue;
+      }
+      // calculate coordinate in PHOS plane
+      int16_t module;
+      float trackX, trackZ;
+      auto trackPar = getTrackPar(track);
+      if (impactOnPHOS(trackPar, track.trackEtaEmcal(), track.trackPhiEmcal(), track.collision().posZ(), module, trackX, trackZ)) {
+        int index = CpvMatchIndex(module, trackX, trackZ);
+        trackMatchPoints[index].emplace_back(trackX, trackZ, track.globalIndex());
+      }
+    }
+    if (keepBC) {
+      for (int i = kCpvCells; i--;) {
+        trackNMatchPoints.back().mEnd[i] = trackMatchPoints[i].size();
+      }
+    }
+    sortMatchPoints(trackNMatchPoints);
+  }
+
+  static void sortMatchPoints(std::vector<trackTrigRec>& nMatchPoints)
+  {
+    std::stable_sort(nMatchPoints.begin(), nMatchPoints.end(), [](const trackTrigRec& a, const trackTrigRec& b) { return a.mTR < b.mTR; });
+  }
+
+  // Ranges of the matching points of a BC, end() if there are none
+  static std::vector<trackTrigRec>::iterator findMatchPoints(std::vector<trackTrigRec>& nMatchPoints, int64_t bc)
+  {
+    auto points = std::lower_bound(nMatchPoints.begin(), nMatchPoints.end(), bc, [](const trackTrigRec& a, int64_t bc) { return a.mTR < bc; });
+    if (points != nMatchPoints.end() && points->mTR != bc) {
+      return nMatchPoints.end();
+    }
+    return points;
+  }
+
+  // Radius of the center of a PHOS module, computed once from the alignment matrix
+  double getPHOSRadius(int16_t module)
+  {
+    if (mPHOSRadii[module] == 0.) {
+      constexpr float shiftY = -1.26;    // Depth-optimized
+      double posL[3] = {0., 0., shiftY}; // local position at the center of module
+      double posG[3] = {0};
+      geomPHOS->getAlignmentMatrix(module)->LocalToMaster(posL, posG);
+      mPHOSRadii[module] = sqrt(posG[0] * posG[0] + posG[1] * posG[1]);
+    }
+    return mPHOSRadii[module];
+  }
+
   int CpvMatchIndex(int16_t module, float x, float z)
   {
     // calculate cell index in grid over PHOS detector
@@ -1632,11 +1576,9 @@ struct caloClusterProducerTask {
     }
 
     // get PHOS radius
-    constexpr float shiftY = -1.26;    // Depth-optimized
-    double posL[3] = {0., 0., shiftY}; // local position at the center of module
+    double posL[3] = {0};
     double posG[3] = {0};
-    geomPHOS->getAlignmentMatrix(module)->LocalToMaster(posL, posG);
-    double rPHOS = sqrt(posG[0] * posG[0] + posG[1] * posG[1]);
+    double rPHOS = getPHOSRadius(module);
     double alpha = (230. + 20. * module) * 0.017453293;
 
     // During main reconstruction track was propagated to radius 460 cm with accounting material
@@ -1683,11 +1625,7 @@ struct caloClusterProducerTask {
     }
     // repeat extrapolation for correct module
     alpha = (230. + 20. * module) * 0.017453293;
-    posL[0] = 0.;
-    posL[1] = 0.;
-    posL[2] = shiftY; // local position at the center of module
-    geomPHOS->getAlignmentMatrix(module)->LocalToMaster(posL, posG);
-    rPHOS = sqrt(posG[0] * posG[0] + posG[1] * posG[1]);
+    rPHOS = getPHOSRadius(module);
 
     if (!trackPar.rotate(alpha) ||
         !prop->PropagateToXBxByBz(trackPar, xtrg, 0.95, 10, o2::base::Propagator::MatCorrType::USEMatCorrNONE)) {
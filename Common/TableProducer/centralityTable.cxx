@@ -12,6 +12,8 @@
 /// \file centrality.cxx
 /// \brief Task to produce the centrality tables associated to each of the required centrality estimators
 
+#include <algorithm>
+#include <vector>
 #include <CCDB/BasicCCDBManager.h>
 #include <TH1F.h>
 #include <TFormula.h>
@@ -120,10 +122,50 @@ struct CentralityTable {
     TH1* mhVtxAmpCorr = nullptr;
     TH1* mhMultSelCalib = nullptr;
   } Run2CL1Info;
+  // Copy of the axis and contents of a calibration histogram for the lookup per collision:
+  // get(x) is h->GetBinContent(h->FindFixBin(x)) without the TH1/TAxis calls
+  struct percentileMap {
+    int nBins = 0;
+    double xMin = 0., xMax = 0.;
+    std::vector<double> edges;    // empty for uniform binning
+    std::vector<double> contents; // including underflow and overflow
+
+    void build(const TH1* h)
+    {
+      const TAxis* axis = h->GetXaxis();
+      nBins = axis->GetNbins();
+      xMin = axis->GetXmin();
+      xMax = axis->GetXmax();
+      edges.clear();
+      if (axis->GetXbins()->GetSize() > 0) {
+        edges.assign(axis->GetXbins()->GetArray(), axis->GetXbins()->GetArray() + nBins + 1);
+      }
+      contents.resize(nBins + 2);
+      for (int i = 0; i < nBins + 2; i++) {
+        contents[i] = h->GetBinContent(i);
+      }
+    }
+    int findBin(double x) const
+    {
+      // same as TAxis::FindFixBin
+      if (x < xMin) {
+        return 0;
+      }
+      if (!(x < xMax)) {
+        return nBins + 1;
+      }
+      if (edges.empty()) {
+        return 1 + static_cast<int>(nBins * (x - xMin) / (xMax - xMin));
+      }
+      return std::upper_bound(edges.begin(), edges.end(), x) - edges.begin();
+    }
+    double get(double x) const { return contents[findBin(x)]; }
+  };
   struct calibrationInfo {
     std::string name = "";
     bool mCalibrationStored = false;
     TH1* mhMultSelCalib = nullptr;
+    percentileMap mPercentiles; // lookup built from mhMultSelCalib
     float mMCScalePars[6] = {0.0};
     TFormula* mMCScale = nullptr;
     explicit calibrationInfo(std::string name)
@@ -484,6 +526,7 @@ struct CentralityTable {
                   LOGF(warning, "MC Scale information from %s for run %d not available", estimator.name.c_str(), bc.runNumber());
                 }
               }
+              estimator.mPercentiles.build(estimator.mhMultSelCalib);
               estimator.mCalibrationStored = true;
               estimator.isSane();
             } else {
@@ -548,7 +591,7 @@ struct CentralityTable {
             scaledMultiplicity = scaleMC(multiplicity, estimator.mMCScalePars);
             LOGF(debug, "Unscaled %s multiplicity: %f, scaled %s multiplicity: %f", estimator.name.c_str(), multiplicity, estimator.name.c_str(), scaledMultiplicity);
           }
-          percentile = estimator.mhMultSelCalib->GetBinContent(estimator.mhMultSelCalib->FindFixBin(scaledMultiplicity));
+          percentile = estimator.mPercentiles.get(scaledMultiplicity);
           if (assignOutOfRange)
             percentile = 100.5f;
         }
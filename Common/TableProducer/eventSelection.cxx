@@ -16,14 +16,18 @@
 #include "Common/DataModel/EventSelection.h"
 #include "Common/CCDB/EventSelectionParams.h"
 #include "Common/CCDB/TriggerAliases.h"
+#include "Common/CCDB/RunContextCache.h"
+#include "Common/Core/BCNeighbourIndex.h"
 #include "CCDB/BasicCCDBManager.h"
 #include "CommonConstants/LHCConstants.h"
 #include "Framework/HistogramRegistry.h"
 #include "DataFormatsFT0/Digit.h"
 #include "DataFormatsParameters/GRPLHCIFData.h"
-#include "DataFormatsParameters/GRPECSObject.h"
 #include "ITSMFTBase/DPLAlpideParam.h"
 
+#include <algorithm>
+#include <vector>
+
 #include "TH1D.h"
 
 using namespace o2;
@@ -45,8 +49,10 @@ struct BcSelectionTask {
   Configurable<int> confITSROFrameEndBorderMargin{"ITSROFrameEndBorderMargin", -1, "Number of bcs at the end of ITS RO Frame border. Take from CCDB if -1"};
   Configurable<int> confTimeFrameStartBorderMargin{"TimeFrameStartBorderMargin", -1, "Number of bcs to cut at the start of the Time Frame. Take from CCDB if -1"};
   Configurable<int> confTimeFrameEndBorderMargin{"TimeFrameEndBorderMargin", -1, "Number of bcs to cut at the end of the Time Frame. Take from CCDB if -1"};
+  Configurable<bool> confColumnarEvaluation{"columnarEvaluation", false, "Run3: read the detector columns once and compute the bc selection of the time frame in bulk, with the CCDB objects of its first bc"};
 
   int lastRunNumber = -1;
+  o2::RunContextCache runContexts;       // time-frame structure per run
   int64_t bcSOR = -1;                    // global bc of the start of the first orbit
   int64_t nBCsPerTF = -1;                // duration of TF in bcs, should be 128*3564 or 32*3564
   int mITSROFrameStartBorderMargin = 10; // default value
@@ -54,6 +60,47 @@ struct BcSelectionTask {
   int mTimeFrameStartBorderMargin = 300; // default value
   int mTimeFrameEndBorderMargin = 4000;  // default value
 
+  // trigger class masks of the aliases, rebuilt for each run or CCDB object
+  TriggerAliases* aliasesCompiled = nullptr;
+  int runAliasesCompiled = -1;
+  TriggerAliasMasks aliasMasks;
+  TriggerAliasMasks const& getAliasMasks(TriggerAliases* aliases, int run)
+  {
+    if (aliases != aliasesCompiled || run != runAliasesCompiled) {
+      aliasMasks = aliases->GetAliasMasks();
+      aliasesCompiled = aliases;
+      runAliasesCompiled = run;
+    }
+    return aliasMasks;
+  }
+
+  // detector information of the bcs of a time frame for the columnar evaluation, kept between the time frames
+  struct BcColumns {
+    std::vector<uint64_t> globalBC;
+    std::vector<uint64_t> triggerMask;
+    std::vector<uint64_t> selection;
+    std::vector<uint32_t> alias;
+    std::vector<uint8_t> triggerMaskFT0;
+    std::vector<float> timeZNA, timeZNC, timeV0A, timeT0A, timeT0C, timeFDA, timeFDC;
+    std::vector<float> timeV0ABG, timeT0ABG, timeT0CBG, timeFDABG, timeFDCBG;
+    std::vector<int32_t> foundFT0, foundFV0, foundFDD, foundZDC;
+
+    void resize(size_t n)
+    {
+      for (auto* column : {&globalBC, &triggerMask, &selection}) {
+        column->assign(n, 0);
+      }
+      alias.assign(n, 0);
+      triggerMaskFT0.assign(n, 0);
+      for (auto* column : {&timeZNA, &timeZNC, &timeV0A, &timeT0A, &timeT0C, &timeFDA, &timeFDC, &timeV0ABG, &timeT0ABG, &timeT0CBG, &timeFDABG, &timeFDCBG}) {
+        column->assign(n, -999.f);
+      }
+      for (auto* column : {&foundFT0, &foundFV0, &foundFDD, &foundZDC}) {
+        column->assign(n, -1);
+      }
+    }
+  } bcColumns;
+
   void init(InitContext&)
   {
     // ccdb->setURL("http://ccdb-test.cern.ch:8080");
@@ -93,19 +140,7 @@ struct BcSelectionTask {
       EventSelectionParams* par = ccdb->getForTimeStamp<EventSelectionParams>("EventSelection/EventSelectionParams", bc.timestamp());
       TriggerAliases* aliases = ccdb->getForTimeStamp<TriggerAliases>("EventSelection/TriggerAliases", bc.timestamp());
       // fill fired aliases
-      uint32_t alias{0};
-      uint64_t triggerMask = bc.triggerMask();
-      for (auto& al : aliases->GetAliasToTriggerMaskMap()) {
-        if (triggerMask & al.second) {
-          alias |= BIT(al.first);
-        }
-      }
-      uint64_t triggerMaskNext50 = bc.triggerMaskNext50();
-      for (auto& al : aliases->GetAliasToTriggerMaskNext50Map()) {
-        if (triggerMaskNext50 & al.second) {
-          alias |= BIT(al.first);
-        }
-      }
+      uint32_t alias = getAliasMasks(aliases, bc.runNumber()).getAliases(bc.triggerMask(), bc.triggerMaskNext50());
       alias |= BIT(kALL);
 
       // get timing info from ZDC, FV0, FT0 and FDD
@@ -220,11 +255,6 @@ struct BcSelectionTask {
     int64_t ts = bcs.iteratorAt(0).timestamp();
     auto alppar = ccdb->getForTimeStamp<o2::itsmft::DPLAlpideParam<0>>("ITS/Config/AlpideParam", ts);
 
-    // map from GlobalBC to BcId needed to find triggerBc
-    std::map<uint64_t, int32_t> mapGlobalBCtoBcId;
-    for (auto& bc : bcs) {
-      mapGlobalBCtoBcId[bc.globalBC()] = bc.globalIndex();
-    }
     int triggerBcShift = confTriggerBcShift;
     if (confTriggerBcShift == 999) {
       int run = bcs.iteratorAt(0).runNumber();
@@ -236,34 +266,29 @@ struct BcSelectionTask {
     if (run != lastRunNumber) {
       lastRunNumber = run; // do it only once
       if (run >= 500000) { // access CCDB for data or anchored MC only
-        int64_t ts = bcs.iteratorAt(0).timestamp();
-        // access orbitShift, ITSROF and TF border margins
-        EventSelectionParams* par = ccdb->getForTimeStamp<EventSelectionParams>("EventSelection/EventSelectionParams", ts);
+        // access orbitShift, ITSROF and TF border margins, orbit-reset timestamp, TF duration and start-of-run timestamp
+        const auto& runContext = runContexts.getTimeFrameInfo(ccdb.service, run, bcs.iteratorAt(0).timestamp());
+        EventSelectionParams* par = runContext.eventSelectionParams;
         mITSROFrameStartBorderMargin = confITSROFrameStartBorderMargin < 0 ? par->fITSROFrameStartBorderMargin : confITSROFrameStartBorderMargin;
         mITSROFrameEndBorderMargin = confITSROFrameEndBorderMargin < 0 ? par->fITSROFrameEndBorderMargin : confITSROFrameEndBorderMargin;
         mTimeFrameStartBorderMargin = confTimeFrameStartBorderMargin < 0 ? par->fTimeFrameStartBorderMargin : confTimeFrameStartBorderMargin;
         mTimeFrameEndBorderMargin = confTimeFrameEndBorderMargin < 0 ? par->fTimeFrameEndBorderMargin : confTimeFrameEndBorderMargin;
-        // access orbit-reset timestamp
-        auto ctpx = ccdb->getForTimeStamp<std::vector<Long64_t>>("CTP/Calib/OrbitReset", ts);
-        int64_t tsOrbitReset = (*ctpx)[0]; // us
-        // access TF duration, start-of-run and end-of-run timestamps from ECS GRP
-        std::map<std::string, std::string> metadata;
-        metadata["runNumber"] = Form("%d", run);
-        auto grpecs = ccdb->getSpecific<o2::parameters::GRPECSObject>("GLO/Config/GRPECS", ts, metadata);
-        uint32_t nOrbitsPerTF = grpecs->getNHBFPerTF(); // assuming 1 orbit = 1 HBF;  nOrbitsPerTF=128 in 2022, 32 in 2023
-        int64_t tsSOR = grpecs->getTimeStart();         // ms
-        // calculate SOR orbit
-        int64_t orbitSOR = (tsSOR * 1000 - tsOrbitReset) / o2::constants::lhc::LHCOrbitMUS;
-        // adjust to the nearest TF edge
-        orbitSOR = orbitSOR / nOrbitsPerTF * nOrbitsPerTF + par->fTimeFrameOrbitShift;
-        // first bc of the first orbit (should coincide with TF start)
-        bcSOR = orbitSOR * o2::constants::lhc::LHCMaxBunches;
-        // duration of TF in bcs
-        nBCsPerTF = nOrbitsPerTF * o2::constants::lhc::LHCMaxBunches;
-        LOGP(info, "tsOrbitReset={} us, SOR = {} ms, orbitSOR = {}, nBCsPerTF = {}", tsOrbitReset, tsSOR, orbitSOR, nBCsPerTF);
+        bcSOR = runContext.bcSOR;
+        nBCsPerTF = runContext.nBCsPerTF;
       }
     }
 
+    if (confColumnarEvaluation) {
+      processRun3Columnar(bcs, alppar, triggerBcShift, run);
+      return;
+    }
+
+    // map from GlobalBC to BcId needed to find triggerBc
+    std::map<uint64_t, int32_t> mapGlobalBCtoBcId;
+    for (auto& bc : bcs) {
+      mapGlobalBCtoBcId[bc.globalBC()] = bc.globalIndex();
+    }
+
     // bc loop
     for (auto bc : bcs) {
       EventSelectionParams* par = ccdb->getForTimeStamp<EventSelectionParams>("EventSelection/EventSelectionParams", bc.timestamp());
@@ -273,12 +298,7 @@ struct BcSelectionTask {
       int32_t triggerBcId = mapGlobalBCtoBcId[bc.globalBC() + triggerBcShift];
       if (triggerBcId) {
         auto triggerBc = bcs.iteratorAt(triggerBcId);
-        uint64_t triggerMask = triggerBc.triggerMask();
-        for (auto& al : aliases->GetAliasToTriggerMaskMap()) {
-          if (triggerMask & al.second) {
-            alias |= BIT(al.first);
-          }
-        }
+        alias = getAliasMasks(aliases, bc.runNumber()).getAliases(triggerBc.triggerMask());
       }
       alias |= BIT(kALL);
 
@@ -415,6 +435,179 @@ struct BcSelectionTask {
     }
   }
   PROCESS_SWITCH(BcSelectionTask, processRun3, "Process Run3 event selection", false);
+
+  /// Run 3 bc selection of a whole time frame: the detector columns are read once, the selection bits are then
+  /// computed in independent loops over plain arrays and the counters are filled once per time frame.
+  /// The bcs are sorted in global bc, such that the trigger and beam-gas bcs are found by binary search or by stepping back.
+  void processRun3Columnar(BCsWithRun3Matchings const& bcs, o2::itsmft::DPLAlpideParam<0> const* alppar, int triggerBcShift, int run)
+  {
+    const size_t nBCs = bcs.size();
+    int64_t ts = bcs.iteratorAt(0).timestamp();
+    EventSelectionParams* par = ccdb->getForTimeStamp<EventSelectionParams>("EventSelection/EventSelectionParams", ts);
+    TriggerAliases* aliases = ccdb->getForTimeStamp<TriggerAliases>("EventSelection/TriggerAliases", ts);
+    auto grplhcif = ccdb->getForTimeStamp<o2::parameters::GRPLHCIFData>("GLO/Config/GRPLHCIF", ts);
+
+    // read the detector columns
+    auto& c = bcColumns;
+    c.resize(nBCs);
+    size_t iBC = 0;
+    for (const auto& bc : bcs) {
+      c.globalBC[iBC] = bc.globalBC();
+      c.triggerMask[iBC] = bc.triggerMask();
+      if (bc.has_zdc()) {
+        auto zdc = bc.zdc();
+        c.timeZNA[iBC] = zdc.timeZNA();
+        c.timeZNC[iBC] = zdc.timeZNC();
+        c.foundZDC[iBC] = zdc.globalIndex();
+      }
+      if (bc.has_fv0a()) {
+        auto fv0a = bc.fv0a();
+        c.timeV0A[iBC] = fv0a.time();
+        c.foundFV0[iBC] = fv0a.globalIndex();
+      }
+      if (bc.has_ft0()) {
+        auto ft0 = bc.ft0();
+        c.timeT0A[iBC] = ft0.timeA();
+        c.timeT0C[iBC] = ft0.timeC();
+        c.triggerMaskFT0[iBC] = ft0.triggerMask();
+        c.foundFT0[iBC] = ft0.globalIndex();
+      }
+      if (bc.has_fdd()) {
+        auto fdd = bc.fdd();
+        c.timeFDA[iBC] = fdd.timeA();
+        c.timeFDC[iBC] = fdd.timeC();
+        c.foundFDD[iBC] = fdd.globalIndex();
+      }
+      iBC++;
+    }
+
+    // trigger aliases, from the bc shifted by triggerBcShift (workaround for pp2022), the first bc is not used as trigger bc as in the bc-by-bc evaluation
+    const auto& masks = getAliasMasks(aliases, run);
+    for (size_t i = 0; i < nBCs; ++i) {
+      c.alias[i] = BIT(kALL);
+      const uint64_t triggerGlobalBC = c.globalBC[i] + triggerBcShift;
+      auto triggerBc = std::upper_bound(c.globalBC.begin(), c.globalBC.end(), triggerGlobalBC);
+      if (triggerBc == c.globalBC.begin() || *(triggerBc - 1) != triggerGlobalBC || triggerBc - 1 == c.globalBC.begin()) {
+        continue;
+      }
+      c.alias[i] |= masks.getAliases(c.triggerMask[triggerBc - 1 - c.globalBC.begin()]);
+    }
+
+    // beam-gas timing from the previous bcs, up to 6 bcs back
+    for (size_t i = 1; i < nBCs; ++i) {
+      for (size_t j = i; j > 0 && c.globalBC[j - 1] + 6 >= c.globalBC[i]; --j) {
+        if (c.globalBC[j - 1] + 1 == c.globalBC[i]) {
+          c.timeV0ABG[i] = c.timeV0A[j - 1];
+          c.timeT0ABG[i] = c.timeT0A[j - 1];
+          c.timeT0CBG[i] = c.timeT0C[j - 1];
+        }
+        if (c.globalBC[j - 1] + 5 == c.globalBC[i]) {
+          c.timeFDABG[i] = c.timeFDA[j - 1];
+          c.timeFDCBG[i] = c.timeFDC[j - 1];
+        }
+      }
+    }
+
+    // time-based selection criteria, one pass per detector over the arrays
+    auto setBitInWindow = [&](std::vector<float> const& time, float lower, float upper, int bit, bool inside) {
+      for (size_t i = 0; i < nBCs; ++i) {
+        c.selection[i] |= ((time[i] > lower && time[i] < upper) == inside) ? BIT(bit) : 0;
+      }
+    };
+    setBitInWindow(c.timeV0A, par->fV0ABBlower, par->fV0ABBupper, kIsBBV0A, true);
+    setBitInWindow(c.timeFDA, par->fFDABBlower, par->fFDABBupper, kIsBBFDA, true);
+    setBitInWindow(c.timeFDC, par->fFDCBBlower, par->fFDCBBupper, kIsBBFDC, true);
+    setBitInWindow(c.timeV0ABG, par->fV0ABGlower, par->fV0ABGupper, kNoBGV0A, false);
+    setBitInWindow(c.timeFDABG, par->fFDABGlower, par->fFDABGupper, kNoBGFDA, false);
+    setBitInWindow(c.timeFDCBG, par->fFDCBGlower, par->fFDCBGupper, kNoBGFDC, false);
+    setBitInWindow(c.timeT0ABG, par->fT0ABGlower, par->fT0ABGupper, kNoBGT0A, false);
+    setBitInWindow(c.timeT0CBG, par->fT0CBGlower, par->fT0CBGupper, kNoBGT0C, false);
+    setBitInWindow(c.timeT0A, par->fT0ABBlower, par->fT0ABBupper, kIsBBT0A, true);
+    setBitInWindow(c.timeT0C, par->fT0CBBlower, par->fT0CBBupper, kIsBBT0C, true);
+    setBitInWindow(c.timeZNA, par->fZNABBlower, par->fZNABBupper, kIsBBZNA, true);
+    setBitInWindow(c.timeZNC, par->fZNCBBlower, par->fZNCBBupper, kIsBBZNC, true);
+    for (size_t i = 0; i < nBCs; ++i) {
+      const float timeZNA = c.timeZNA[i];
+      const float timeZNC = c.timeZNC[i];
+      uint64_t selection{0};
+      selection |= (pow((timeZNA + timeZNC - par->fZNSumMean) / par->fZNSumSigma, 2) + pow((timeZNA - timeZNC - par->fZNDifMean) / par->fZNDifSigma, 2) < 1) ? BIT(kIsBBZAC) : 0;
+      selection |= !(fabs(timeZNA) > par->fZNABGlower && fabs(timeZNA) < par->fZNABGupper) ? BIT(kNoBGZNA) : 0;
+      selection |= !(fabs(timeZNC) > par->fZNCBGlower && fabs(timeZNC) < par->fZNCBGupper) ? BIT(kNoBGZNC) : 0;
+      selection |= (c.triggerMaskFT0[i] & BIT(o2::ft0::Triggers::bitVertex)) > 0 ? BIT(kIsTriggerTVX) : 0;
+      // ITS RO Frame and Time Frame borders, see the bc-by-bc evaluation
+      uint16_t bcInITSROF = (c.globalBC[i] + 3564 - alppar->roFrameBiasInBC) % alppar->roFrameLengthInBC;
+      selection |= bcInITSROF > mITSROFrameStartBorderMargin && bcInITSROF < alppar->roFrameLengthInBC - mITSROFrameEndBorderMargin ? BIT(kNoITSROFrameBorder) : 0;
+      int64_t bcInTF = (c.globalBC[i] - bcSOR) % nBCsPerTF;
+      selection |= bcInTF > mTimeFrameStartBorderMargin && bcInTF < nBCsPerTF - mTimeFrameEndBorderMargin ? BIT(kNoTimeFrameBorder) : 0;
+      c.selection[i] |= selection;
+    }
+
+    // counters and lumi histograms, see the bc-by-bc evaluation for the cross sections
+    int beamZ1 = grplhcif->getBeamZ(o2::constants::lhc::BeamA);
+    int beamZ2 = grplhcif->getBeamZ(o2::constants::lhc::BeamC);
+    bool isPP = beamZ1 == 1 && beamZ2 == 1;
+    bool injectionEnergy = (run >= 500000 && run <= 520099) || (run >= 534133 && run <= 534468);
+    float csTVX = isPP ? (injectionEnergy ? 0.0355e6 : 0.0594e6) : -1.;
+    float csTCE = isPP ? -1. : 10.36e6;
+    float csZEM = isPP ? -1. : 415.2e6;
+    float csZNC = isPP ? -1. : 214.5e6;
+    if (run > 543437 && run < 543514) {
+      csTCE = 8.3e6;
+    }
+    if (run >= 543514) {
+      csTCE = 4.10e6;
+    }
+    int nTVX = 0, nTCE = 0, nZEM = 0, nZNC = 0;
+    int nTVXafterBCcuts = 0, nTCEafterBCcuts = 0, nZEMafterBCcuts = 0, nZNCafterBCcuts = 0;
+    for (size_t i = 0; i < nBCs; ++i) {
+      const uint64_t selection = c.selection[i];
+      const bool afterBCcuts = TESTBIT(selection, kNoITSROFrameBorder) && TESTBIT(selection, kNoTimeFrameBorder);
+      const bool isTVX = TESTBIT(selection, kIsTriggerTVX);
+      const bool isTCE = isTVX && TESTBIT(c.triggerMaskFT0[i], o2::ft0::Triggers::bitCen);
+      const bool isZEM = TESTBIT(selection, kIsBBZNA) || TESTBIT(selection, kIsBBZNC);
+      const bool isZNC = TESTBIT(selection, kIsBBZNC);
+      nTVX += isTVX;
+      nTCE += isTCE;
+      nZEM += isZEM;
+      nZNC += isZNC;
+      nTVXafterBCcuts += isTVX && afterBCcuts;
+      nTCEafterBCcuts += isTCE && afterBCcuts;
+      nZEMafterBCcuts += isZEM && afterBCcuts;
+      nZNCafterBCcuts += isZNC && afterBCcuts;
+    }
+    // the run label is looked up once, the fills of unit weight are kept such that the bin errors are unchanged
+    const char* srun = Form("%d", run);
+    auto fillCounter = [srun](std::shared_ptr<TH1> const& hist, int count, double weight) {
+      if (count == 0) {
+        return;
+      }
+      const double x = hist->GetXaxis()->GetBinCenter(hist->GetXaxis()->FindBin(srun));
+      for (int i = 0; i < count; ++i) {
+        hist->Fill(x, weight);
+      }
+    };
+    fillCounter(histos.get<TH1>(HIST("hCounterTVX")), nTVX, 1);
+    fillCounter(histos.get<TH1>(HIST("hLumiTVX")), nTVX, 1. / csTVX);
+    fillCounter(histos.get<TH1>(HIST("hCounterTVXafterBCcuts")), nTVXafterBCcuts, 1);
+    fillCounter(histos.get<TH1>(HIST("hLumiTVXafterBCcuts")), nTVXafterBCcuts, 1. / csTVX);
+    fillCounter(histos.get<TH1>(HIST("hCounterTCE")), nTCE, 1);
+    fillCounter(histos.get<TH1>(HIST("hLumiTCE")), nTCE, 1. / csTCE);
+    fillCounter(histos.get<TH1>(HIST("hCounterTCEafterBCcuts")), nTCEafterBCcuts, 1);
+    fillCounter(histos.get<TH1>(HIST("hLumiTCEafterBCcuts")), nTCEafterBCcuts, 1. / csTCE);
+    fillCounter(histos.get<TH1>(HIST("hCounterZEM")), nZEM, 1);
+    fillCounter(histos.get<TH1>(HIST("hLumiZEM")), nZEM, 1. / csZEM);
+    fillCounter(histos.get<TH1>(HIST("hCounterZEMafterBCcuts")), nZEMafterBCcuts, 1);
+    fillCounter(histos.get<TH1>(HIST("hLumiZEMafterBCcuts")), nZEMafterBCcuts, 1. / csZEM);
+    fillCounter(histos.get<TH1>(HIST("hCounterZNC")), nZNC, 1);
+    fillCounter(histos.get<TH1>(HIST("hLumiZNC")), nZNC, 1. / csZNC);
+    fillCounter(histos.get<TH1>(HIST("hCounterZNCafterBCcuts")), nZNCafterBCcuts, 1);
+    fillCounter(histos.get<TH1>(HIST("hLumiZNCafterBCcuts")), nZNCafterBCcuts, 1. / csZNC);
+
+    // fill bc selection columns
+    for (size_t i = 0; i < nBCs; ++i) {
+      bcsel(c.alias[i], c.selection[i], c.foundFT0[i], c.foundFV0[i], c.foundFDD[i], c.foundZDC[i]);
+    }
+  }
 };
 
 struct EventSelectionTask {
@@ -431,24 +624,15 @@ struct EventSelectionTask {
   HistogramRegistry histos{"Histos", {}, OutputObjHandlingPolicy::AnalysisObject};
 
   int lastRun = -1;                                          // last run number (needed to access ccdb only if run!=lastRun)
+  o2::RunContextCache runContexts;                           // time-frame structure per run
   std::bitset<o2::constants::lhc::LHCMaxBunches> bcPatternB; // bc pattern of colliding bunches
 
   int64_t bcSOR = -1;     // global bc of the start of the first orbit
   int64_t nBCsPerTF = -1; // duration of TF in bcs, should be 128*3564 or 32*3564
 
-  int32_t findClosest(int64_t globalBC, std::map<int64_t, int32_t>& bcs)
-  {
-    auto it = bcs.lower_bound(globalBC);
-    int64_t bc1 = it->first;
-    int32_t index1 = it->second;
-    if (it != bcs.begin())
-      --it;
-    int64_t bc2 = it->first;
-    int32_t index2 = it->second;
-    int64_t dbc1 = std::abs(bc1 - globalBC);
-    int64_t dbc2 = std::abs(bc2 - globalBC);
-    return (dbc1 <= dbc2) ? index1 : index2;
-  }
+  // TVX or FT0-OR fired bcs, to be used for closest TVX (FT0-OR) searches, kept between the time frames
+  BCNeighbourIndex bcsWithTVX;
+  BCNeighbourIndex bcsWithTOR;
 
   void init(InitContext&)
   {
@@ -471,13 +655,9 @@ struct EventSelectionTask {
   {
     auto bc = col.bc_as<BCsWithBcSelsRun2>();
     EventSelectionParams* par = ccdb->getForTimeStamp<EventSelectionParams>("EventSelection/EventSelectionParams", bc.timestamp());
-    bool* applySelection = par->GetSelection(muonSelection);
+    uint64_t applySelection = par->GetSelectionMask(muonSelection);
     if (isMC) {
-      applySelection[kIsBBZAC] = 0;
-      applySelection[kNoV0MOnVsOfPileup] = 0;
-      applySelection[kNoSPDOnVsOfPileup] = 0;
-      applySelection[kNoV0Casymmetry] = 0;
-      applySelection[kNoV0PFPileup] = 0;
+      applySelection &= ~(BIT(kIsBBZAC) | BIT(kNoV0MOnVsOfPileup) | BIT(kNoSPDOnVsOfPileup) | BIT(kNoV0Casymmetry) | BIT(kNoV0PFPileup));
     }
 
     int32_t foundBC = bc.globalIndex();
@@ -511,10 +691,7 @@ struct EventSelectionTask {
     selection |= !(nTkl < 6 && multV0C012 > par->fV0C012vsTklA + nTkl * par->fV0C012vsTklB) ? BIT(kNoV0C012vsTklBG) : 0;
 
     // apply int7-like selections
-    bool sel7 = 1;
-    for (int i = 0; i < kNsel; i++) {
-      sel7 = sel7 && (applySelection[i] ? TESTBIT(selection, i) : 1);
-    }
+    bool sel7 = (selection & applySelection) == applySelection;
 
     // TODO introduce array of sel[0]... sel[8] or similar?
     bool sel8 = bc.selection_bit(kIsBBT0A) && bc.selection_bit(kIsBBT0C); // TODO apply other cuts for sel8
@@ -550,31 +727,16 @@ struct EventSelectionTask {
       auto grplhcif = ccdb->getForTimeStamp<o2::parameters::GRPLHCIFData>("GLO/Config/GRPLHCIF", ts);
       bcPatternB = grplhcif->getBunchFilling().getBCPattern();
 
-      //
-      EventSelectionParams* par = ccdb->getForTimeStamp<EventSelectionParams>("EventSelection/EventSelectionParams", ts);
-      // access orbit-reset timestamp
-      auto ctpx = ccdb->getForTimeStamp<std::vector<Long64_t>>("CTP/Calib/OrbitReset", ts);
-      int64_t tsOrbitReset = (*ctpx)[0]; // us
-      // access TF duration, start-of-run timestamp from ECS GRP
-      std::map<std::string, std::string> metadata;
-      metadata["runNumber"] = Form("%d", run);
-      auto grpecs = ccdb->getSpecific<o2::parameters::GRPECSObject>("GLO/Config/GRPECS", ts, metadata);
-      uint32_t nOrbitsPerTF = grpecs->getNHBFPerTF(); // assuming 1 orbit = 1 HBF;  nOrbitsPerTF=128 in 2022, 32 in 2023
-      int64_t tsSOR = grpecs->getTimeStart();         // ms
-      // calculate SOR orbit
-      int64_t orbitSOR = (tsSOR * 1000 - tsOrbitReset) / o2::constants::lhc::LHCOrbitMUS;
-      // adjust to the nearest TF edge
-      orbitSOR = orbitSOR / nOrbitsPerTF * nOrbitsPerTF + par->fTimeFrameOrbitShift;
-      // first bc of the first orbit (should coincide with TF start)
-      bcSOR = orbitSOR * o2::constants::lhc::LHCMaxBunches;
-      // duration of TF in bcs
-      nBCsPerTF = nOrbitsPerTF * o2::constants::lhc::LHCMaxBunches;
+      // access orbit-reset timestamp, TF duration and start-of-run timestamp
+      const auto& runContext = runContexts.getTimeFrameInfo(ccdb.service, run, ts);
+      bcSOR = runContext.bcSOR;
+      nBCsPerTF = runContext.nBCsPerTF;
     }
 
-    // create maps from globalBC to bc index for TVX or FT0-OR fired bcs
+    // create sorted indices of the TVX or FT0-OR fired bcs
     // to be used for closest TVX (FT0-OR) searches
-    std::map<int64_t, int32_t> mapGlobalBcWithTVX;
-    std::map<int64_t, int32_t> mapGlobalBcWithTOR;
+    bcsWithTVX.clear();
+    bcsWithTOR.clear();
     for (auto& bc : bcs) {
       int64_t globalBC = bc.globalBC();
       // skip non-colliding bcs for data and anchored runs
@@ -582,15 +744,17 @@ struct EventSelectionTask {
         continue;
       }
       if (bc.selection_bit(kIsBBT0A) || bc.selection_bit(kIsBBT0C)) {
-        mapGlobalBcWithTOR[globalBC] = bc.globalIndex();
+        bcsWithTOR.add(globalBC, bc.globalIndex());
       }
       if (bc.selection_bit(kIsTriggerTVX)) {
-        mapGlobalBcWithTVX[globalBC] = bc.globalIndex();
+        bcsWithTVX.add(globalBC, bc.globalIndex());
       }
     }
+    bcsWithTOR.finalize();
+    bcsWithTVX.finalize();
 
     // protection against empty FT0 maps
-    if (mapGlobalBcWithTOR.size() == 0 || mapGlobalBcWithTVX.size() == 0) {
+    if (bcsWithTOR.empty() || bcsWithTVX.empty()) {
       LOGP(error, "FT0 table is empty or corrupted. Filling evsel table with dummy values");
       for (auto& col : cols) {
         auto bc = col.bc_as<BCsWithBcSelsRun3>();
@@ -666,12 +830,12 @@ struct EventSelectionTask {
       int64_t minBC = meanBC - deltaBC;
       int64_t maxBC = meanBC + deltaBC;
 
-      int32_t indexClosestTVX = findClosest(meanBC, mapGlobalBcWithTVX);
+      int32_t indexClosestTVX = bcsWithTVX.findClosest(meanBC);
       int64_t tvxBC = bcs.iteratorAt(indexClosestTVX).globalBC();
       if (tvxBC >= minBC && tvxBC <= maxBC) { // closest TVX within search region
         bc.setCursor(indexClosestTVX);
       } else { // no TVX within search region, searching for TOR = T0A | T0C
-        int32_t indexClosestTOR = findClosest(meanBC, mapGlobalBcWithTOR);
+        int32_t indexClosestTOR = bcsWithTOR.findClosest(meanBC);
         int64_t torBC = bcs.iteratorAt(indexClosestTOR).globalBC();
         if (torBC >= minBC && torBC <= maxBC) {
           bc.setCursor(indexClosestTOR);
@@ -693,15 +857,19 @@ struct EventSelectionTask {
       vIsFullInfoForOccupancy[colIndex] = ((bcInTF - 300) * bcNS > timeWinOccupancyCalcNS) && ((nBCsPerTF - 4000 - bcInTF) * bcNS > timeWinOccupancyCalcNS) ? true : false;
     }
 
-    // save indices of collisions in time range for occupancy calculation
-    std::vector<std::vector<int>> vCollsInTimeWin;
+    // cumulative number of ITS tracks over the collisions, such that the sum over the collisions in the time window is a difference
+    std::vector<int64_t> vCumulTracksITS567(cols.size() + 1, 0);
+    for (size_t iCol = 0; iCol < cols.size(); iCol++) {
+      vCumulTracksITS567[iCol + 1] = vCumulTracksITS567[iCol] + vTracksITS567perColl[iCol];
+    }
+
+    // perform the occupancy calculation in the pre-defined time window
+    std::vector<int> vNumTracksITS567inTimeWin(cols.size(), 0); // counter of tracks per found bc for occupancy studies
     for (auto& col : cols) {
       int32_t colIndex = col.globalIndex();
-      std::vector<int> vAssocToThisCol;
-
-      // protection against the TF borders
+      // protection against TF borders
       if (!vIsFullInfoForOccupancy[colIndex]) {
-        vCollsInTimeWin.push_back(vAssocToThisCol);
+        vNumTracksITS567inTimeWin[colIndex] = -1; // occupancy in undefined (too close to TF borders)
         continue;
       }
       int64_t foundGlobalBC = vFoundGlobalBC[colIndex];
@@ -719,7 +887,6 @@ struct EventSelectionTask {
         // check if we are within the chosen time range
         if ((foundGlobalBC - thisBC) * bcNS > timeWinOccupancyCalcNS)
           break;
-        vAssocToThisCol.push_back(minColIndex);
         minColIndex--;
       }
       // find all collisions in time window after the current one
@@ -731,28 +898,10 @@ struct EventSelectionTask {
           break;
         if ((thisBC - foundGlobalBC) * bcNS > timeWinOccupancyCalcNS)
           break;
-        vAssocToThisCol.push_back(maxColIndex);
         maxColIndex++;
       }
-      vCollsInTimeWin.push_back(vAssocToThisCol);
-    }
-
-    // perform the occupancy calculation in the pre-defined time window
-    std::vector<int> vNumTracksITS567inTimeWin(cols.size(), 0); // counter of tracks per found bc for occupancy studies
-    for (auto& col : cols) {
-      int32_t colIndex = col.globalIndex();
-      // protection against TF borders
-      if (!vIsFullInfoForOccupancy[colIndex]) {
-        vNumTracksITS567inTimeWin[colIndex] = -1; // occupancy in undefined (too close to TF borders)
-        continue;
-      }
-      std::vector<int> vAssocToThisCol = vCollsInTimeWin[colIndex];
-      int nITS567tracksInTimeWindow = 0;
-      for (int iCol = 0; iCol < vAssocToThisCol.size(); iCol++) {
-        int thisColIndex = vAssocToThisCol[iCol];
-        nITS567tracksInTimeWindow += vTracksITS567perColl[thisColIndex];
-      }
-      vNumTracksITS567inTimeWin[colIndex] = nITS567tracksInTimeWindow - vTracksITS567perColl[colIndex]; // current collision is subtracted
+      // collisions from minColIndex + 1 to maxColIndex - 1, the current collision is subtracted
+      vNumTracksITS567inTimeWin[colIndex] = vCumulTracksITS567[maxColIndex] - vCumulTracksITS567[minColIndex + 1] - vTracksITS567perColl[colIndex];
     }
 
     for (auto& col : cols) {
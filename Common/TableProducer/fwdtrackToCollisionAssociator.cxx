@@ -38,6 +38,8 @@ struct FwdTrackToCollisionAssociation {
   Configurable<bool> includeUnassigned{"includeUnassigned", false, "consider also tracks which are not assigned to any collision"};
   Configurable<bool> fillTableOfCollIdsPerTrack{"fillTableOfCollIdsPerTrack", false, "fill additional table with vector of collision ids per track"};
   Configurable<int> bcWindowForOneSigma{"bcWindowForOneSigma", 115, "BC window to be multiplied by the number of sigmas to define maximum window to be considered"};
+  Configurable<bool> useSweepAssociation{"useSweepAssociation", false, "find time-compatible tracks by binary search in the tracks sorted by time (same output, scales as (N+M) log M in the number of collisions and tracks)"};
+  Configurable<bool> useCompactReverseIndices{"useCompactReverseIndices", false, "store the collisions per track in flat arrays instead of one vector per track (only with fillTableOfCollIdsPerTrack)"};
 
   CollisionAssociation<false> collisionAssociator;
 
@@ -64,6 +66,8 @@ struct FwdTrackToCollisionAssociation {
     collisionAssociator.setUsePvAssociation(false);
     collisionAssociator.setIncludeUnassigned(includeUnassigned);
     collisionAssociator.setFillTableOfCollIdsPerTrack(fillTableOfCollIdsPerTrack);
+    collisionAssociator.setUseSweepAssociation(useSweepAssociation);
+    collisionAssociator.setUseCompactReverseIndices(useCompactReverseIndices);
   }
 
   void processFwdAssocWithTime(Collisions const& collisions,
@@ -13,6 +13,11 @@
 // Task performing forward track DCA computation
 //
 
+#include <algorithm>
+#include <array>
+#include <thread>
+#include <vector>
+
 #include "Framework/AnalysisDataModel.h"
 #include "Framework/AnalysisTask.h"
 #include "Framework/runDataProcessing.h"
@@ -31,33 +36,84 @@ using namespace o2;
 using namespace o2::framework;
 using namespace o2::framework::expressions;
 
-using SMatrix55 = ROOT::Math::SMatrix<double, 5, 5, ROOT::Math::MatRepSym<double, 5>>;
 using SMatrix5 = ROOT::Math::SVector<double, 5>;
 
 struct FwdTrackExtension {
   Produces<aod::FwdTracksDCA> extendedTrackQuantities;
 
-  void process(aod::FwdTracks const& tracks, aod::Collisions const&)
+  Configurable<int> nThreadsPropagation{"nThreadsPropagation", 1, "Number of threads for the propagation of the tracks of a dataframe, 1 to propagate them one by one"};
+  Configurable<int> minTracksPerThread{"minTracksPerThread", 5000, "Minimum number of tracks propagated per thread"};
+
+  std::vector<std::array<float, 3>> collisionPositions; // vertex of each collision of the dataframe
+  std::vector<float> dcaXs;
+  std::vector<float> dcaYs;
+
+  /// Linear extrapolation of the track to the z of its vertex, no field nor material is involved
+  template <typename TTrack>
+  void propagateToVertex(TTrack const& track, float& dcaX, float& dcaY)
   {
-    for (auto& track : tracks) {
-      float dcaX = -999;
-      float dcaY = -999;
-      if (track.has_collision()) {
-        if (track.trackType() == o2::aod::fwdtrack::ForwardTrackTypeEnum::GlobalMuonTrack || track.trackType() == o2::aod::fwdtrack::ForwardTrackTypeEnum::GlobalForwardTrack || track.trackType() == o2::aod::fwdtrack::ForwardTrackTypeEnum::MuonStandaloneTrack) {
+    dcaX = -999;
+    dcaY = -999;
+    if (!track.has_collision()) {
+      return;
+    }
+    if (track.trackType() == o2::aod::fwdtrack::ForwardTrackTypeEnum::GlobalMuonTrack || track.trackType() == o2::aod::fwdtrack::ForwardTrackTypeEnum::GlobalForwardTrack || track.trackType() == o2::aod::fwdtrack::ForwardTrackTypeEnum::MuonStandaloneTrack) {
+      auto const& vertex = collisionPositions[track.collisionId()];
+      SMatrix5 tpars(track.x(), track.y(), track.phi(), track.tgl(), track.signed1Pt());
+      o2::track::TrackParFwd pars1;
+      pars1.setParameters(tpars);
+      pars1.setZ(track.z());
+      pars1.propagateParamToZlinear(vertex[2]);
 
-          auto const& collision = track.collision();
-          double chi2 = track.chi2();
-          SMatrix5 tpars(track.x(), track.y(), track.phi(), track.tgl(), track.signed1Pt());
-          std::vector<double> v1;
-          SMatrix55 tcovs(v1.begin(), v1.end());
-          o2::track::TrackParCovFwd pars1{track.z(), tpars, tcovs, chi2};
-          pars1.propagateToZlinear(collision.posZ());
+      dcaX = (pars1.getX() - vertex[0]);
+      dcaY = (pars1.getY() - vertex[1]);
+    }
+  }
 
-          dcaX = (pars1.getX() - collision.posX());
-          dcaY = (pars1.getY() - collision.posY());
-        }
+  void process(aod::FwdTracks const& tracks, aod::Collisions const& collisions)
+  {
+    collisionPositions.resize(collisions.size());
+    for (auto const& collision : collisions) {
+      collisionPositions[collision.globalIndex()] = {collision.posX(), collision.posY(), collision.posZ()};
+    }
+    extendedTrackQuantities.reserve(tracks.size());
+
+    const int nTracks = tracks.size();
+    const int nThreads = std::clamp(nTracks / std::max(static_cast<int>(minTracksPerThread), 1), 1, std::max(static_cast<int>(nThreadsPropagation), 1));
+    if (nThreads == 1) {
+      float dcaX, dcaY;
+      for (auto const& track : tracks) {
+        propagateToVertex(track, dcaX, dcaY);
+        extendedTrackQuantities(dcaX, dcaY);
+      }
+      return;
+    }
+
+    // contiguous ranges of tracks, the first one in this thread, with the results in buffers sized to the number of tracks
+    dcaXs.resize(nTracks);
+    dcaYs.resize(nTracks);
+    const int nTracksPerThread = (nTracks + nThreads - 1) / nThreads;
+    auto propagateRange = [&](int iThread) {
+      const int first = iThread * nTracksPerThread;
+      const int last = std::min(nTracks, first + nTracksPerThread);
+      if (first >= last) {
+        return;
       }
-      extendedTrackQuantities(dcaX, dcaY);
+      auto track = tracks.rawIteratorAt(first);
+      for (int iTrack = first; iTrack < last; ++iTrack, ++track) {
+        propagateToVertex(track, dcaXs[iTrack], dcaYs[iTrack]);
+      }
+    };
+    std::vector<std::thread> threads;
+    for (int iThread = 1; iThread < nThreads; ++iThread) {
+      threads.emplace_back(propagateRange, iThread);
+    }
+    propagateRange(0);
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    for (int iTrack = 0; iTrack < nTracks; ++iTrack) {
+      extendedTrackQuantities(dcaXs[iTrack], dcaYs[iTrack]);
     }
   }
 };
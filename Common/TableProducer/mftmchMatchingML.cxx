@@ -15,8 +15,13 @@
 #else
 #include <onnxruntime_cxx_api.h>
 #endif
+#include <algorithm>
+#include <numeric>
 #include <string>
 #include <regex>
+#include <tuple>
+#include <utility>
+#include <vector>
 #include <TLorentzVector.h>
 #include "Common/DataModel/MftmchMatchingML.h"
 #include "Framework/AnalysisDataModel.h"
@@ -74,6 +79,7 @@ struct mftmchMatchingML {
   Configurable<float> cfgThrScore{"threshold-score", 0.5, "Threshold value for matching score"};
   Configurable<int> cfgColWindow{"collision-window", 1, "Search window (collision ID) for MFT track"};
   Configurable<float> cfgXYWindow{"XY-window", 3, "Search window (delta XY) for MFT track"};
+  Configurable<int> cfgBatchSize{"batch-size", 4096, "Maximum number of pairs scored in one inference"};
 
   Ort::Env env{ORT_LOGGING_LEVEL_WARNING, "model-explorer"};
   Ort::SessionOptions session_options;
@@ -84,140 +90,115 @@ struct mftmchMatchingML {
 #endif
   OnnxModel model;
 
-  template <typename F, typename M>
-  std::vector<float> getVariables(F const& fwdtrack, M const& mfttrack)
-  {
-
-    static constexpr Double_t MatchingPlaneZ = -77.5;
+  static constexpr int NVariables = 17; // inputs of the model per pair
 
-    // propagate muontrack to matching position
-    double muonchi2 = fwdtrack.chi2();
-    SMatrix5 muonpars(fwdtrack.x(), fwdtrack.y(), fwdtrack.phi(), fwdtrack.tgl(), fwdtrack.signed1Pt());
-    std::vector<double> muonv1;
-    SMatrix55 muoncovs(muonv1.begin(), muonv1.end());
-    o2::track::TrackParCovFwd muonpars1{fwdtrack.z(), muonpars, muoncovs, muonchi2};
-    muonpars1.propagateToZlinear(MatchingPlaneZ);
-
-    // propagate mfttrack to matching position
-    double mftchi2 = mfttrack.chi2();
-    SMatrix5 mftpars(mfttrack.x(), mfttrack.y(), mfttrack.phi(), mfttrack.tgl(), mfttrack.signed1Pt());
-    std::vector<double> mftv1;
-    SMatrix55 mftcovs(mftv1.begin(), mftv1.end());
-    o2::track::TrackParCovFwd mftpars1{mfttrack.z(), mftpars, mftcovs, mftchi2};
-    mftpars1.propagateToZlinear(MatchingPlaneZ);
+  // track parameters at the matching plane
+  struct TrackAtPlane {
+    float x, y, phi, tanl;
+    int collisionId;
+    int row; // position in the table
+  };
 
-    Float_t MFT_X = mftpars1.getX();
-    Float_t MFT_Y = mftpars1.getY();
-    Float_t MFT_Phi = mftpars1.getPhi();
-    Float_t MFT_Tanl = mftpars1.getTanl();
+  // MFT tracks at the matching plane sorted by collision and (x, y) cell of size cfgXYWindow
+  struct MFTCell {
+    int collisionId, ix, iy;
+    bool operator<(const MFTCell& other) const { return std::tie(collisionId, ix, iy) < std::tie(other.collisionId, other.ix, other.iy); }
+  };
 
-    Float_t MCH_X = muonpars1.getX();
-    Float_t MCH_Y = muonpars1.getY();
-    Float_t MCH_Phi = muonpars1.getPhi();
-    Float_t MCH_Tanl = muonpars1.getTanl();
+  std::vector<std::string> input_names;
+  std::vector<std::vector<int64_t>> input_shapes;
+  std::vector<std::string> output_names;
+  std::vector<std::vector<int64_t>> output_shapes;
 
-    Float_t Ratio_X = MFT_X / MCH_X;
-    Float_t Ratio_Y = MFT_Y / MCH_Y;
-    Float_t Ratio_Phi = MFT_Phi / MCH_Phi;
-    Float_t Ratio_Tanl = MFT_Tanl / MCH_Tanl;
+  std::vector<std::pair<MFTCell, TrackAtPlane>> mftAtPlane; // buffers kept across dataframes
+  std::vector<TrackAtPlane> muonsAtPlane;
+  std::vector<std::pair<int, int>> candidates; // (muon, MFT row) pairs within the windows
+  std::vector<float> inputValues;
+  std::vector<float> scores;
 
-    Float_t Delta_X = MFT_X - MCH_X;
-    Float_t Delta_Y = MFT_Y - MCH_Y;
-    Float_t Delta_Phi = MFT_Phi - MCH_Phi;
-    Float_t Delta_Tanl = MFT_Tanl - MCH_Tanl;
+  template <typename T>
+  TrackAtPlane propagateToMatchingPlane(T const& track, int row)
+  {
+    static constexpr Double_t MatchingPlaneZ = -77.5;
 
-    Float_t Delta_XY = sqrt(Delta_X * Delta_X + Delta_Y * Delta_Y);
+    double chi2 = track.chi2();
+    SMatrix5 pars(track.x(), track.y(), track.phi(), track.tgl(), track.signed1Pt());
+    std::vector<double> v1;
+    SMatrix55 covs(v1.begin(), v1.end());
+    o2::track::TrackParCovFwd pars1{track.z(), pars, covs, chi2};
+    pars1.propagateToZlinear(MatchingPlaneZ);
+    return {static_cast<float>(pars1.getX()), static_cast<float>(pars1.getY()), static_cast<float>(pars1.getPhi()), static_cast<float>(pars1.getTanl()), track.collisionId(), row};
+  }
 
-    std::vector<float> input_tensor_values{
-      MFT_X,
-      MFT_Y,
-      MFT_Phi,
-      MFT_Tanl,
-      MCH_X,
-      MCH_Y,
-      MCH_Phi,
-      MCH_Tanl,
-      Delta_XY,
-      Delta_X,
-      Delta_Y,
-      Delta_Phi,
-      Delta_Tanl,
-      Ratio_X,
-      Ratio_Y,
-      Ratio_Phi,
-      Ratio_Tanl,
-    };
-    return input_tensor_values;
+  MFTCell getCell(int collisionId, float x, float y) const
+  {
+    return {collisionId, static_cast<int>(std::floor(x / cfgXYWindow)), static_cast<int>(std::floor(y / cfgXYWindow))};
   }
 
-  template <typename F, typename M>
-  double matchONNX(F const& fwdtrack, M const& mfttrack)
+  static void fillVariables(TrackAtPlane const& muon, TrackAtPlane const& mft, float* values)
   {
-    std::vector<std::string> input_names;
-    std::vector<std::vector<int64_t>> input_shapes;
-    std::vector<std::string> output_names;
-    std::vector<std::vector<int64_t>> output_shapes;
+    Float_t Delta_X = mft.x - muon.x;
+    Float_t Delta_Y = mft.y - muon.y;
+
+    values[0] = mft.x;
+    values[1] = mft.y;
+    values[2] = mft.phi;
+    values[3] = mft.tanl;
+    values[4] = muon.x;
+    values[5] = muon.y;
+    values[6] = muon.phi;
+    values[7] = muon.tanl;
+    values[8] = sqrt(Delta_X * Delta_X + Delta_Y * Delta_Y);
+    values[9] = Delta_X;
+    values[10] = Delta_Y;
+    values[11] = mft.phi - muon.phi;
+    values[12] = mft.tanl - muon.tanl;
+    values[13] = mft.x / muon.x;
+    values[14] = mft.y / muon.y;
+    values[15] = mft.phi / muon.phi;
+    values[16] = mft.tanl / muon.tanl;
+  }
 
-#if __has_include(<onnxruntime/core/session/onnxruntime_cxx_api.h>)
-    input_names = onnx_session->GetInputNames();
-    input_shapes = onnx_session->GetInputShapes();
-    output_names = onnx_session->GetOutputNames();
-    output_shapes = onnx_session->GetOutputShapes();
-#else
-    Ort::AllocatorWithDefaultOptions tmpAllocator;
-    for (size_t i = 0; i < onnx_session->GetInputCount(); ++i) {
-      input_names.push_back(onnx_session->GetInputNameAllocated(i, tmpAllocator).get());
-    }
-    for (size_t i = 0; i < onnx_session->GetInputCount(); ++i) {
-      input_shapes.emplace_back(onnx_session->GetInputTypeInfo(i).GetTensorTypeAndShapeInfo().GetShape());
-    }
-    for (size_t i = 0; i < onnx_session->GetOutputCount(); ++i) {
-      output_names.push_back(onnx_session->GetOutputNameAllocated(i, tmpAllocator).get());
-    }
-    for (size_t i = 0; i < onnx_session->GetOutputCount(); ++i) {
-      output_shapes.emplace_back(onnx_session->GetOutputTypeInfo(i).GetTensorTypeAndShapeInfo().GetShape());
+  // scores of nPairs pairs whose variables are stored contiguously in values, in batches of up to cfgBatchSize pairs
+  void scoreBatch(const float* values, int nPairs, float* result)
+  {
+    int batchSize = std::max(1, cfgBatchSize.value);
+    if (input_shapes[0][0] > 0) { // fixed batch dimension of the model
+      batchSize = input_shapes[0][0];
     }
+#if !__has_include(<onnxruntime/core/session/onnxruntime_cxx_api.h>)
+    Ort::MemoryInfo mem_info =
+      Ort::MemoryInfo::CreateCpu(OrtAllocatorType::OrtArenaAllocator, OrtMemType::OrtMemTypeDefault);
+    Ort::RunOptions runOptions;
+    std::vector<const char*> inputNamesChar(input_names.size(), nullptr);
+    std::transform(std::begin(input_names), std::end(input_names), std::begin(inputNamesChar),
+                   [&](const std::string& str) { return str.c_str(); });
+
+    std::vector<const char*> outputNamesChar(output_names.size(), nullptr);
+    std::transform(std::begin(output_names), std::end(output_names), std::begin(outputNamesChar),
+                   [&](const std::string& str) { return str.c_str(); });
 #endif
-
-    auto input_shape = input_shapes[0];
-    input_shape[0] = 1;
-
-    std::vector<float> input_tensor_values;
-    input_tensor_values = getVariables(fwdtrack, mfttrack);
-
-    if (input_tensor_values[8] < cfgXYWindow) {
+    for (int first = 0; first < nPairs; first += batchSize) {
+      const int n = std::min(batchSize, nPairs - first);
+      auto input_shape = input_shapes[0];
+      input_shape[0] = n;
       std::vector<Ort::Value> input_tensors;
 #if __has_include(<onnxruntime/core/session/onnxruntime_cxx_api.h>)
-      input_tensors.push_back(Ort::Experimental::Value::CreateTensor<float>(input_tensor_values.data(), input_tensor_values.size(), input_shape));
+      input_tensors.push_back(Ort::Experimental::Value::CreateTensor<float>(const_cast<float*>(values) + first * NVariables, n * NVariables, input_shape));
 
       std::vector<Ort::Value> output_tensors = onnx_session->Run(input_names, input_tensors, output_names);
 #else
-      Ort::MemoryInfo mem_info =
-        Ort::MemoryInfo::CreateCpu(OrtAllocatorType::OrtArenaAllocator, OrtMemType::OrtMemTypeDefault);
-      input_tensors.push_back(Ort::Value::CreateTensor<float>(mem_info, input_tensor_values.data(), input_tensor_values.size(), input_shape.data(), input_shape.size()));
-
-      Ort::RunOptions runOptions;
-      std::vector<const char*> inputNamesChar(input_names.size(), nullptr);
-      std::transform(std::begin(input_names), std::end(input_names), std::begin(inputNamesChar),
-                     [&](const std::string& str) { return str.c_str(); });
-
-      std::vector<const char*> outputNamesChar(output_names.size(), nullptr);
-      std::transform(std::begin(output_names), std::end(output_names), std::begin(outputNamesChar),
-                     [&](const std::string& str) { return str.c_str(); });
+      input_tensors.push_back(Ort::Value::CreateTensor<float>(mem_info, const_cast<float*>(values) + first * NVariables, n * NVariables, input_shape.data(), input_shape.size()));
 
       std::vector<Ort::Value> output_tensors = onnx_session->Run(runOptions, inputNamesChar.data(), input_tensors.data(), input_tensors.size(), outputNamesChar.data(), outputNamesChar.size());
 #endif
-
       const float* output_value = output_tensors[0].GetTensorData<float>();
-
-      auto score = output_value[0];
-
-      return score;
-    } else {
-      auto score = 0;
-      return score;
+      const size_t stride = output_tensors[0].GetTensorTypeAndShapeInfo().GetElementCount() / n; // score is the first output of each pair
+      for (int i = 0; i < n; ++i) {
+        result[first + i] = output_value[i * stride];
+      }
     }
-  };
+  }
 
   void init(o2::framework::InitContext&)
   {
@@ -237,6 +218,26 @@ struct mftmchMatchingML {
                 << "/" << cfgModelName.value;
       model.initModel(cfgModelName, false, 1, strtoul(headers["Valid-From"].c_str(), NULL, 0), strtoul(headers["Valid-Until"].c_str(), NULL, 0));
       onnx_session = model.getSession();
+#if __has_include(<onnxruntime/core/session/onnxruntime_cxx_api.h>)
+      input_names = onnx_session->GetInputNames();
+      input_shapes = onnx_session->GetInputShapes();
+      output_names = onnx_session->GetOutputNames();
+      output_shapes = onnx_session->GetOutputShapes();
+#else
+      Ort::AllocatorWithDefaultOptions tmpAllocator;
+      for (size_t i = 0; i < onnx_session->GetInputCount(); ++i) {
+        input_names.push_back(onnx_session->GetInputNameAllocated(i, tmpAllocator).get());
+      }
+      for (size_t i = 0; i < onnx_session->GetInputCount(); ++i) {
+        input_shapes.emplace_back(onnx_session->GetInputTypeInfo(i).GetTensorTypeAndShapeInfo().GetShape());
+      }
+      for (size_t i = 0; i < onnx_session->GetOutputCount(); ++i) {
+        output_names.push_back(onnx_session->GetOutputNameAllocated(i, tmpAllocator).get());
+      }
+      for (size_t i = 0; i < onnx_session->GetOutputCount(); ++i) {
+        output_shapes.emplace_back(onnx_session->GetOutputTypeInfo(i).GetTensorTypeAndShapeInfo().GetShape());
+      }
+#endif
     } else {
       LOG(info) << "Failed to retrieve Network file";
     }
@@ -244,41 +245,102 @@ struct mftmchMatchingML {
 
   void process(aod::Collisions const&, soa::Filtered<aod::FwdTracks> const& fwdtracks, aod::MFTTracks const& mfttracks)
   {
+    // propagate the MFT tracks once and sort them by collision and (x, y) cell at the matching plane
+    mftAtPlane.clear();
+    int row = 0;
+    for (auto& mfttrack : mfttracks) {
+      if (mfttrack.has_collision()) {
+        auto mft = propagateToMatchingPlane(mfttrack, row);
+        mftAtPlane.emplace_back(getCell(mft.collisionId, mft.x, mft.y), mft);
+      }
+      row++;
+    }
+    std::sort(mftAtPlane.begin(), mftAtPlane.end(), [](auto const& a, auto const& b) { return a.first < b.first || (!(b.first < a.first) && a.second.row < b.second.row); });
+
+    // propagate the muons once and collect the MFT tracks within the collision and (x, y) windows:
+    // the pairs outside the (x, y) window get a score of 0 and are never matched
+    muonsAtPlane.clear();
+    candidates.clear();
+    inputValues.clear();
+    row = 0;
     for (auto& fwdtrack : fwdtracks) {
-      if (fwdtrack.trackType() == aod::fwdtrack::ForwardTrackTypeEnum::MuonStandaloneTrack) {
-        double bestscore = 0;
-        int bestmfttrackid = -1;
-        for (auto& mfttrack : mfttracks) {
-          if (fwdtrack.has_collision() && mfttrack.has_collision()) {
-            if (0 <= fwdtrack.collisionId() - mfttrack.collisionId() && fwdtrack.collisionId() - mfttrack.collisionId() < cfgColWindow) {
-              double result = matchONNX(fwdtrack, mfttrack);
-              if (result > cfgThrScore) {
-                bestscore = result;
-                bestmfttrackid = mfttrack.globalIndex();
+      if (fwdtrack.trackType() == aod::fwdtrack::ForwardTrackTypeEnum::MuonStandaloneTrack && fwdtrack.has_collision()) {
+        const int iMuon = muonsAtPlane.size();
+        muonsAtPlane.push_back(propagateToMatchingPlane(fwdtrack, row));
+        const auto& muon = muonsAtPlane.back();
+        const auto cell = getCell(muon.collisionId, muon.x, muon.y);
+        const size_t firstCandidate = candidates.size();
+        for (int dCol = 0; dCol < cfgColWindow; dCol++) {
+          for (int ix = cell.ix - 1; ix <= cell.ix + 1; ix++) {
+            for (int iy = cell.iy - 1; iy <= cell.iy + 1; iy++) {
+              const MFTCell key{muon.collisionId - dCol, ix, iy};
+              auto it = std::lower_bound(mftAtPlane.begin(), mftAtPlane.end(), key, [](auto const& a, MFTCell const& k) { return a.first < k; });
+              for (; it != mftAtPlane.end() && !(key < it->first); ++it) {
+                float dx = it->second.x - muon.x;
+                float dy = it->second.y - muon.y;
+                if (sqrt(dx * dx + dy * dy) < cfgXYWindow) {
+                  candidates.emplace_back(iMuon, it->second.row);
+                  inputValues.resize(inputValues.size() + NVariables);
+                  fillVariables(muon, it->second, inputValues.data() + inputValues.size() - NVariables);
+                }
               }
             }
           }
         }
-        if (bestmfttrackid != -1) {
-          for (auto& mfttrack : mfttracks) {
-            if (mfttrack.globalIndex() == bestmfttrackid) {
-              double mftchi2 = mfttrack.chi2();
-              SMatrix5 mftpars(mfttrack.x(), mfttrack.y(), mfttrack.phi(), mfttrack.tgl(), mfttrack.signed1Pt());
-              std::vector<double> mftv1;
-              SMatrix55 mftcovs(mftv1.begin(), mftv1.end());
-              o2::track::TrackParCovFwd mftpars1{mfttrack.z(), mftpars, mftcovs, mftchi2};
-              mftpars1.propagateToZlinear(mfttrack.collision().posZ());
-
-              float dcaX = (mftpars1.getX() - mfttrack.collision().posX());
-              float dcaY = (mftpars1.getY() - mfttrack.collision().posY());
-              double px = fwdtrack.p() * sin(M_PI / 2 - atan(mfttrack.tgl())) * cos(mfttrack.phi());
-              double py = fwdtrack.p() * sin(M_PI / 2 - atan(mfttrack.tgl())) * sin(mfttrack.phi());
-              double pz = fwdtrack.p() * cos(M_PI / 2 - atan(mfttrack.tgl()));
-              fwdtrackml(fwdtrack.collisionId(), 0, mfttrack.x(), mfttrack.y(), mfttrack.z(), mfttrack.phi(), mfttrack.tgl(), fwdtrack.sign() / std::sqrt(std::pow(px, 2) + std::pow(py, 2)), fwdtrack.nClusters(), fwdtrack.pDca(), fwdtrack.rAtAbsorberEnd(), 0, 0, 0, bestscore, mfttrack.globalIndex(), fwdtrack.globalIndex(), fwdtrack.mchBitMap(), fwdtrack.midBitMap(), fwdtrack.midBoards(), mfttrack.trackTime(), mfttrack.trackTimeRes(), mfttrack.eta(), std::sqrt(std::pow(px, 2) + std::pow(py, 2)), std::sqrt(std::pow(px, 2) + std::pow(py, 2) + std::pow(pz, 2)), dcaX, dcaY);
-            }
+        // same order as a loop over the MFT table, which decides between several pairs above the threshold
+        if (candidates.size() - firstCandidate > 1) {
+          std::vector<int> order(candidates.size() - firstCandidate);
+          std::iota(order.begin(), order.end(), firstCandidate);
+          std::sort(order.begin(), order.end(), [&](int a, int b) { return candidates[a].second < candidates[b].second; });
+          std::vector<std::pair<int, int>> sortedCandidates;
+          std::vector<float> sortedValues;
+          for (int i : order) {
+            sortedCandidates.push_back(candidates[i]);
+            sortedValues.insert(sortedValues.end(), inputValues.begin() + i * NVariables, inputValues.begin() + (i + 1) * NVariables);
           }
+          std::copy(sortedCandidates.begin(), sortedCandidates.end(), candidates.begin() + firstCandidate);
+          std::copy(sortedValues.begin(), sortedValues.end(), inputValues.begin() + firstCandidate * NVariables);
         }
       }
+      row++;
+    }
+
+    // score all the candidate pairs of the dataframe
+    scores.resize(candidates.size());
+    if (!candidates.empty()) {
+      scoreBatch(inputValues.data(), candidates.size(), scores.data());
+    }
+
+    for (size_t first = 0; first < candidates.size();) {
+      const int iMuon = candidates[first].first;
+      double bestscore = 0;
+      int bestmftrow = -1;
+      size_t last = first;
+      for (; last < candidates.size() && candidates[last].first == iMuon; last++) {
+        if (scores[last] > cfgThrScore) {
+          bestscore = scores[last];
+          bestmftrow = candidates[last].second;
+        }
+      }
+      first = last;
+      if (bestmftrow == -1) {
+        continue;
+      }
+      auto fwdtrack = fwdtracks.iteratorAt(muonsAtPlane[iMuon].row);
+      auto mfttrack = mfttracks.iteratorAt(bestmftrow);
+      double mftchi2 = mfttrack.chi2();
+      SMatrix5 mftpars(mfttrack.x(), mfttrack.y(), mfttrack.phi(), mfttrack.tgl(), mfttrack.signed1Pt());
+      std::vector<double> mftv1;
+      SMatrix55 mftcovs(mftv1.begin(), mftv1.end());
+      o2::track::TrackParCovFwd mftpars1{mfttrack.z(), mftpars, mftcovs, mftchi2};
+      mftpars1.propagateToZlinear(mfttrack.collision().posZ());
+
+      float dcaX = (mftpars1.getX() - mfttrack.collision().posX());
+      float dcaY = (mftpars1.getY() - mfttrack.collision().posY());
+      double px = fwdtrack.p() * sin(M_PI / 2 - atan(mfttrack.tgl())) * cos(mfttrack.phi());
+      double py = fwdtrack.p() * sin(M_PI / 2 - atan(mfttrack.tgl())) * sin(mfttrack.phi());
+      double pz = fwdtrack.p() * cos(M_PI / 2 - atan(mfttrack.tgl()));
+      fwdtrackml(fwdtrack.collisionId(), 0, mfttrack.x(), mfttrack.y(), mfttrack.z(), mfttrack.phi(), mfttrack.tgl(), fwdtrack.sign() / std::sqrt(std::pow(px, 2) + std::pow(py, 2)), fwdtrack.nClusters(), fwdtrack.pDca(), fwdtrack.rAtAbsorberEnd(), 0, 0, 0, bestscore, mfttrack.globalIndex(), fwdtrack.globalIndex(), fwdtrack.mchBitMap(), fwdtrack.midBitMap(), fwdtrack.midBoards(), mfttrack.trackTime(), mfttrack.trackTimeRes(), mfttrack.eta(), std::sqrt(std::pow(px, 2) + std::pow(py, 2)), std::sqrt(std::pow(px, 2) + std::pow(py, 2) + std::pow(pz, 2)), dcaX, dcaY);
     }
   }
 };
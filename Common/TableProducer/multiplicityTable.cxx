@@ -110,6 +110,7 @@ struct MultiplicityTable {
   Configurable<std::string> ccdbUrl{"ccdburl", "http://alice-ccdb.cern.ch", "The CCDB endpoint url address"};
   Configurable<std::string> ccdbPath{"ccdbpath", "Centrality/Calibration", "The CCDB path for centrality/multiplicity information"};
   Configurable<bool> produceHistograms{"produceHistograms", false, {"Option to produce debug histograms"}};
+  Configurable<bool> fusedEstimators{"fusedEstimators", false, "if true: compute the barrel track counts of all enabled tables in one pass over the tracks of each collision (Run 3)"};
 
   int mRunNumber;
   bool lCalibLoaded;
@@ -122,6 +123,26 @@ struct MultiplicityTable {
   TProfile* hVtxZNTracks;
   std::vector<int> mEnabledTables; // Vector of enabled tables
 
+  // Barrel track counts of a collision, filled in one pass over its tracks in the fused mode
+  // (nTPC and nAllTracks*: tracks with findable TPC clusters, the others: PV contributors)
+  struct BarrelCounts {
+    int nTPC = 0;
+    int nContribs = 0;
+    int nContribsEta1 = 0;
+    int nContribsEtaHalf = 0;
+    int nHasITS = 0;
+    int nHasTPC = 0;
+    int nHasTOF = 0;
+    int nHasTRD = 0;
+    int nITSonly = 0;
+    int nTPConly = 0;
+    int nITSTPC = 0;
+    int nAllTracksTPCOnly = 0;
+    int nAllTracksITSTPC = 0;
+  };
+  BarrelCounts barrelCounts;
+  bool mNeedBarrelCounts = false; // whether one of the enabled tables uses the barrel tracks
+
   // Debug output
   HistogramRegistry histos{"Histos", {}, OutputObjHandlingPolicy::QAObject};
   OutputObj<THashList> listCalib{"calib-list", OutputObjHandlingPolicy::QAObject};
@@ -167,6 +188,9 @@ struct MultiplicityTable {
       LOG(info) << "Cannot have the " << tableNames[kPVMultZeqs] << " table enabled and not the one on " << tableNames[kPVMults] << ". Enabling it.";
     }
     std::sort(mEnabledTables.begin(), mEnabledTables.end());
+    for (auto i : mEnabledTables) {
+      mNeedBarrelCounts = mNeedBarrelCounts || i == kTPCMults || i == kPVMults || i == kMultsExtra;
+    }
 
     mRunNumber = 0;
     lCalibLoaded = false;
@@ -255,13 +279,58 @@ struct MultiplicityTable {
   }
 
   using Run3Tracks = soa::Join<aod::TracksIU, aod::TracksExtra>;
+
+  // Same selections as the partitions below, evaluated in a single loop
+  template <typename TTracks>
+  void fillBarrelCounts(TTracks const& tracksThisCollision)
+  {
+    barrelCounts = BarrelCounts{};
+    for (const auto& track : tracksThisCollision) {
+      if (track.tpcNClsFindable() > 0) {
+        barrelCounts.nTPC++;
+        if (track.hasITS()) {
+          barrelCounts.nAllTracksITSTPC++;
+        } else {
+          barrelCounts.nAllTracksTPCOnly++;
+        }
+      }
+      if ((track.flags() & (uint32_t)o2::aod::track::PVContributor) != (uint32_t)o2::aod::track::PVContributor) {
+        continue;
+      }
+      const float absEta = std::abs(track.eta());
+      if (absEta < 1.0f) {
+        barrelCounts.nContribsEta1++;
+        if (absEta < 0.8)
+          barrelCounts.nContribs++;
+        if (absEta < 0.5)
+          barrelCounts.nContribsEtaHalf++;
+      }
+      if (track.hasITS()) {
+        barrelCounts.nHasITS++;
+        if (track.hasTPC())
+          barrelCounts.nITSTPC++;
+        if (!track.hasTPC() && !track.hasTOF() && !track.hasTRD())
+          barrelCounts.nITSonly++;
+      }
+      if (track.hasTPC()) {
+        barrelCounts.nHasTPC++;
+        if (!track.hasITS() && !track.hasTOF() && !track.hasTRD())
+          barrelCounts.nTPConly++;
+      }
+      if (track.hasTOF())
+        barrelCounts.nHasTOF++;
+      if (track.hasTRD())
+        barrelCounts.nHasTRD++;
+    }
+  }
+
   Partition<Run3Tracks> tracksIUWithTPC = (aod::track::tpcNClsFindable > (uint8_t)0);
   Partition<Run3Tracks> pvAllContribTracksIU = ((aod::track::flags & (uint32_t)o2::aod::track::PVContributor) == (uint32_t)o2::aod::track::PVContributor);
   Partition<Run3Tracks> pvContribTracksIU = (nabs(aod::track::eta) < 0.8f) && ((aod::track::flags & (uint32_t)o2::aod::track::PVContributor) == (uint32_t)o2::aod::track::PVContributor);
   Partition<Run3Tracks> pvContribTracksIUEta1 = (nabs(aod::track::eta) < 1.0f) && ((aod::track::flags & (uint32_t)o2::aod::track::PVContributor) == (uint32_t)o2::aod::track::PVContributor);
   Partition<Run3Tracks> pvContribTracksIUEtaHalf = (nabs(aod::track::eta) < 0.5f) && ((aod::track::flags & (uint32_t)o2::aod::track::PVContributor) == (uint32_t)o2::aod::track::PVContributor);
   void processRun3(soa::Join<aod::Collisions, aod::EvSels> const& collisions,
-                   Run3Tracks const&,
+                   Run3Tracks const& tracks,
                    BCsWithRun3Matchings const&,
                    aod::Zdcs const&,
                    aod::FV0As const&,
@@ -378,6 +447,10 @@ struct MultiplicityTable {
         }
       }
 
+      if (fusedEstimators && mNeedBarrelCounts) {
+        fillBarrelCounts(tracks.sliceBy(perColIU, collision.globalIndex()));
+      }
+
       for (auto i : mEnabledTables) {
         switch (i) {
           case kFV0Mults: // FV0
@@ -469,21 +542,32 @@ struct MultiplicityTable {
           } break;
           case kTPCMults: // TPC
           {
-            const auto& tracksGrouped = tracksIUWithTPC->sliceByCached(aod::track::collisionId, collision.globalIndex(), cache);
-            const int multTPC = tracksGrouped.size();
+            int multTPC = 0;
+            if (fusedEstimators) {
+              multTPC = barrelCounts.nTPC;
+            } else {
+              const auto& tracksGrouped = tracksIUWithTPC->sliceByCached(aod::track::collisionId, collision.globalIndex(), cache);
+              multTPC = tracksGrouped.size();
+            }
             tableTpc(multTPC);
             LOGF(debug, "multTPC=%i", multTPC);
           } break;
           case kPVMults: // PV multiplicity
           {
-            // use only one single grouping operation, then do loop
-            const auto& tracksThisCollision = pvContribTracksIUEta1.sliceByCached(aod::track::collisionId, collision.globalIndex(), cache);
-            multNContribsEta1 = tracksThisCollision.size();
-            for (auto track : tracksThisCollision) {
-              if (std::abs(track.eta()) < 0.8)
-                multNContribs++;
-              if (std::abs(track.eta()) < 0.5)
-                multNContribsEtaHalf++;
+            if (fusedEstimators) {
+              multNContribs = barrelCounts.nContribs;
+              multNContribsEta1 = barrelCounts.nContribsEta1;
+              multNContribsEtaHalf = barrelCounts.nContribsEtaHalf;
+            } else {
+              // use only one single grouping operation, then do loop
+              const auto& tracksThisCollision = pvContribTracksIUEta1.sliceByCached(aod::track::collisionId, collision.globalIndex(), cache);
+              multNContribsEta1 = tracksThisCollision.size();
+              for (auto track : tracksThisCollision) {
+                if (std::abs(track.eta()) < 0.8)
+                  multNContribs++;
+                if (std::abs(track.eta()) < 0.5)
+                  multNContribsEtaHalf++;
+              }
             }
             tablePv(multNContribs, multNContribsEta1, multNContribsEtaHalf);
             LOGF(debug, "multNContribs=%i, multNContribsEta1=%i, multNContribsEtaHalf=%i", multNContribs, multNContribsEta1, multNContribsEtaHalf);
@@ -492,35 +576,47 @@ struct MultiplicityTable {
           {
             int nHasITS = 0, nHasTPC = 0, nHasTOF = 0, nHasTRD = 0;
             int nITSonly = 0, nTPConly = 0, nITSTPC = 0;
-            const auto& pvAllContribsGrouped = pvAllContribTracksIU->sliceByCached(aod::track::collisionId, collision.globalIndex(), cache);
-            const auto& tpcTracksGrouped = tracksIUWithTPC->sliceByCached(aod::track::collisionId, collision.globalIndex(), cache);
-
-            for (auto track : pvAllContribsGrouped) {
-              if (track.hasITS()) {
-                nHasITS++;
-                if (track.hasTPC())
-                  nITSTPC++;
-                if (!track.hasTPC() && !track.hasTOF() && !track.hasTRD())
-                  nITSonly++;
-              }
-              if (track.hasTPC()) {
-                nHasTPC++;
-                if (!track.hasITS() && !track.hasTOF() && !track.hasTRD())
-                  nTPConly++;
-              }
-              if (track.hasTOF())
-                nHasTOF++;
-              if (track.hasTRD())
-                nHasTRD++;
-            }
-
             int nAllTracksTPCOnly = 0;
             int nAllTracksITSTPC = 0;
-            for (auto track : tpcTracksGrouped) {
-              if (track.hasITS()) {
-                nAllTracksITSTPC++;
-              } else {
-                nAllTracksTPCOnly++;
+            if (fusedEstimators) {
+              nHasITS = barrelCounts.nHasITS;
+              nHasTPC = barrelCounts.nHasTPC;
+              nHasTOF = barrelCounts.nHasTOF;
+              nHasTRD = barrelCounts.nHasTRD;
+              nITSonly = barrelCounts.nITSonly;
+              nTPConly = barrelCounts.nTPConly;
+              nITSTPC = barrelCounts.nITSTPC;
+              nAllTracksTPCOnly = barrelCounts.nAllTracksTPCOnly;
+              nAllTracksITSTPC = barrelCounts.nAllTracksITSTPC;
+            } else {
+              const auto& pvAllContribsGrouped = pvAllContribTracksIU->sliceByCached(aod::track::collisionId, collision.globalIndex(), cache);
+              const auto& tpcTracksGrouped = tracksIUWithTPC->sliceByCached(aod::track::collisionId, collision.globalIndex(), cache);
+
+              for (auto track : pvAllContribsGrouped) {
+                if (track.hasITS()) {
+                  nHasITS++;
+                  if (track.hasTPC())
+                    nITSTPC++;
+                  if (!track.hasTPC() && !track.hasTOF() && !track.hasTRD())
+                    nITSonly++;
+                }
+                if (track.hasTPC()) {
+                  nHasTPC++;
+                  if (!track.hasITS() && !track.hasTOF() && !track.hasTRD())
+                    nTPConly++;
+                }
+                if (track.hasTOF())
+                  nHasTOF++;
+                if (track.hasTRD())
+                  nHasTRD++;
+              }
+
+              for (auto track : tpcTracksGrouped) {
+                if (track.hasITS()) {
+                  nAllTracksITSTPC++;
+                } else {
+                  nAllTracksTPCOnly++;
+                }
               }
             }
 
@@ -24,6 +24,7 @@
 #include <vector>
 #include <TComplex.h>
 #include <TH3F.h>
+#include <TMath.h>
 
 // o2Physics includes.
 #include "Framework/AnalysisDataModel.h"
@@ -104,6 +105,12 @@ struct qVectorsTable {
   std::vector<float> FT0RelGainConst{};
   std::vector<float> FV0RelGainConst{};
 
+  // Q-vector calibration constants of objQvec, cached as [centrality bin][constant][detector].
+  std::vector<float> QvecCorrConst{};
+  int nCorrCentBins = 0;
+  int nCorrConst = 0;
+  int nCorrDet = 0;
+
   // Enable access to the CCDB for the offset and correction constants and save them
   // in dedicated variables.
   Service<o2::ccdb::BasicCCDBManager> ccdb;
@@ -209,6 +216,7 @@ struct qVectorsTable {
     fullPath += "/v";
     fullPath += std::to_string(harmonics);
     objQvec = ccdb->getForTimeStamp<TH3F>(fullPath, timestamp);
+    cacheCorrConst();
 
     fullPath = cfgGainEqPath;
     fullPath += "/FT0";
@@ -231,6 +239,45 @@ struct qVectorsTable {
     } else {
       FV0RelGainConst = *(objfv0Gain);
     }
+
+    // Azimuthal angles and gain factors of the FIT channels, used for all the collisions of the run.
+    helperEP.FillChannelTable(ft0geom, fv0geom, harmonics, FT0RelGainConst, FV0RelGainConst);
+  }
+
+  /// Copy the bin contents of objQvec to QvecCorrConst, to avoid the histogram
+  /// lookups in the event loop. Without calibration object, all the constants are
+  /// zero and the corrections leave the Q-vectors unchanged.
+  void cacheCorrConst()
+  {
+    QvecCorrConst.clear();
+    nCorrCentBins = 0;
+    nCorrConst = 0;
+    nCorrDet = 0;
+    if (objQvec == nullptr) {
+      LOGF(warning, "Could not get the Q-vector calibration constants, no correction applied.");
+      return;
+    }
+    nCorrCentBins = objQvec->GetNbinsX();
+    nCorrConst = objQvec->GetNbinsY();
+    nCorrDet = objQvec->GetNbinsZ();
+    QvecCorrConst.resize(nCorrCentBins * nCorrConst * nCorrDet);
+    for (int iCent = 0; iCent < nCorrCentBins; iCent++) {
+      for (int iConst = 0; iConst < nCorrConst; iConst++) {
+        for (int iDet = 0; iDet < nCorrDet; iDet++) {
+          QvecCorrConst[(iCent * nCorrConst + iConst) * nCorrDet + iDet] = objQvec->GetBinContent(iCent + 1, iConst + 1, iDet + 1);
+        }
+      }
+    }
+  }
+
+  /// Calibration constant iConst (1 = <X>, 2 = <Y>, 3 = lambda+, 4 = lambda-, 5 = a+, 6 = a-)
+  /// of the detector iDet for the given centrality bin, following the binning of objQvec.
+  float getCorrConst(int centBin, int iConst, int iDet) const
+  {
+    if (centBin < 0 || centBin >= nCorrCentBins || iConst < 1 || iConst > nCorrConst || iDet < 0 || iDet >= nCorrDet) {
+      return 0.;
+    }
+    return QvecCorrConst[(centBin * nCorrConst + iConst - 1) * nCorrDet + iDet];
   }
 
   template <typename TrackType>
@@ -296,87 +343,95 @@ struct qVectorsTable {
     float qVectBPos[2] = {0.};
     float qVectBNeg[2] = {0.};
 
-    TComplex QvecDet(0); // Complex value of the Q-vector for any detector.
+    TComplex QvecFT0A(0); // Complex value of the Q-vector for each detector.
+    TComplex QvecFT0C(0);
     TComplex QvecFT0M(0);
+    TComplex QvecFV0A(0);
     float sumAmplFT0A = 0.; // Sum of the amplitudes of all non-dead channels in any detector.
     float sumAmplFT0C = 0.;
     float sumAmplFT0M = 0.;
     float sumAmplFV0A = 0.;
 
+    const int nMod = cfgnMod;
+
+    // Look up the detectors in use once per collision instead of once per channel.
+    const bool useFT0A = useDetector["QvectorFT0As"];
+    const bool useFT0C = useDetector["QvectorFT0Cs"];
+    const bool useFT0M = useDetector["QvectorFT0Ms"];
+    const bool useFV0A = useDetector["QvectorFV0As"];
+    const bool useBPos = useDetector["QvectorBPoss"];
+    const bool useBNeg = useDetector["QvectorBNegs"];
+
+    // Normalise the Q-vector with the sum of amplitudes if it is non-zero.
+    // Otherwise, set it to a dummy 999.
+    auto normaliseQvec = [](TComplex& Qvec, float sumAmpl, float* qVect) {
+      if (sumAmpl > 1e-8) {
+        Qvec /= sumAmpl;
+        qVect[0] = Qvec.Re();
+        qVect[1] = Qvec.Im();
+      } else {
+        qVect[0] = 999.;
+        qVect[1] = 999.;
+      }
+    };
+
     /// First check if the collision has a found FT0. If yes, calculate the
-    /// Q-vectors for FT0A and FT0C (both real and imaginary parts). If no,
-    /// attribute dummy values to the corresponding qVect.
-    if (coll.has_foundFT0() && (useDetector["QvectorFT0As"] || useDetector["QvectorFT0Cs"] || useDetector["QvectorFT0Ms"])) {
+    /// Q-vectors for FT0A, FT0C and FT0M (both real and imaginary parts) in a single
+    /// pass over the channels, using the cached cos(n*phi) and sin(n*phi) of each
+    /// channel. If no, attribute dummy values to the corresponding qVect.
+    if (coll.has_foundFT0() && (useFT0A || useFT0C || useFT0M)) {
       auto ft0 = coll.foundFT0();
 
-      // Check whether FT0-A is being used.
-      if (useDetector["QvectorFT0As"]) {
-        // Iterate over the non-dead channels for FT0-A to get the total Q-vector
-        // and sum of amplitudes.
+      // FT0-M sums the channels of the FT0 sides in use.
+      if (useFT0A) {
         for (std::size_t iChA = 0; iChA < ft0.channelA().size(); iChA++) {
-          // Get first the corresponding amplitude.
           float ampl = ft0.amplitudeA()[iChA];
           int FT0AchId = ft0.channelA()[iChA];
+          float amplCor = ampl / helperEP.GetGainTable(0, FT0AchId);
 
           histosQA.fill(HIST("FT0Amp"), ampl, FT0AchId);
-          histosQA.fill(HIST("FT0AmpCor"), ampl / FT0RelGainConst[FT0AchId], FT0AchId);
-          // Update the Q-vector and sum of amplitudes using the helper function.
-          // LOKI: Note this assumes nHarmo = 2!! Likely generalise in the future.
-          helperEP.SumQvectors(0, FT0AchId, ampl / FT0RelGainConst[FT0AchId], cfgnMod, QvecDet, sumAmplFT0A, ft0geom, fv0geom);
-          helperEP.SumQvectors(0, FT0AchId, ampl / FT0RelGainConst[FT0AchId], cfgnMod, QvecFT0M, sumAmplFT0M, ft0geom, fv0geom);
-        } // Go to the next channel iChA.
-
-        // Set the Qvectors for FT0A with the normalised Q-vector values if the sum of
-        // amplitudes is non-zero. Otherwise, set it to a dummy 999.
-        if (sumAmplFT0A > 1e-8) {
-          QvecDet /= sumAmplFT0A;
-          qVectFT0A[0] = QvecDet.Re();
-          qVectFT0A[1] = QvecDet.Im();
-          // printf("qVectFT0A[0] = %.2f ; qVectFT0A[1] = %.2f \n", qVectFT0A[0], qVectFT0A[1]); // Debug printing.
-        } else {
-          qVectFT0A[0] = 999.;
-          qVectFT0A[1] = 999.;
+          histosQA.fill(HIST("FT0AmpCor"), amplCor, FT0AchId);
+
+          TComplex QvecCh(amplCor * helperEP.GetCosTable(0, FT0AchId, nMod), amplCor * helperEP.GetSinTable(0, FT0AchId, nMod));
+          QvecFT0A += QvecCh;
+          QvecFT0M += QvecCh;
+          sumAmplFT0A += amplCor;
+          sumAmplFT0M += amplCor;
         }
-      } else {
-        qVectFT0A[0] = -999.;
-        qVectFT0A[1] = -999.;
       }
-
-      if (useDetector["QvectorFT0Cs"]) {
-        // Repeat the procedure with FT0-C for the found FT0.
-        // Start by resetting to zero the intermediate quantities.
-        QvecDet = TComplex(0., 0.);
+      if (useFT0C) {
         for (std::size_t iChC = 0; iChC < ft0.channelC().size(); iChC++) {
           // iChC ranging from 0 to max 112. We need to add 96 (= max channels in FT0-A)
           // to ensure a proper channel number in FT0 as a whole.
           float ampl = ft0.amplitudeC()[iChC];
           int FT0CchId = ft0.channelC()[iChC] + 96;
+          float amplCor = ampl / helperEP.GetGainTable(0, FT0CchId);
 
           histosQA.fill(HIST("FT0Amp"), ampl, FT0CchId);
-          histosQA.fill(HIST("FT0AmpCor"), ampl / FT0RelGainConst[FT0CchId], FT0CchId);
+          histosQA.fill(HIST("FT0AmpCor"), amplCor, FT0CchId);
 
-          helperEP.SumQvectors(0, FT0CchId, ampl / FT0RelGainConst[FT0CchId], cfgnMod, QvecDet, sumAmplFT0C, ft0geom, fv0geom);
-          helperEP.SumQvectors(0, FT0CchId, ampl / FT0RelGainConst[FT0CchId], cfgnMod, QvecFT0M, sumAmplFT0M, ft0geom, fv0geom);
+          TComplex QvecCh(amplCor * helperEP.GetCosTable(0, FT0CchId, nMod), amplCor * helperEP.GetSinTable(0, FT0CchId, nMod));
+          QvecFT0C += QvecCh;
+          QvecFT0M += QvecCh;
+          sumAmplFT0C += amplCor;
+          sumAmplFT0M += amplCor;
         }
+      }
 
-        if (sumAmplFT0C > 1e-8) {
-          QvecDet /= sumAmplFT0C;
-          qVectFT0C[0] = QvecDet.Re();
-          qVectFT0C[1] = QvecDet.Im();
-          // printf("qVectFT0C[0] = %.2f ; qVectFT0C[1] = %.2f \n", qVectFT0C[0], qVectFT0C[1]); // Debug printing.
-        } else {
-          qVectFT0C[0] = 999.;
-          qVectFT0C[1] = 999.;
-        }
+      if (useFT0A) {
+        normaliseQvec(QvecFT0A, sumAmplFT0A, qVectFT0A);
+      } else {
+        qVectFT0A[0] = -999.;
+        qVectFT0A[1] = -999.;
+      }
+      if (useFT0C) {
+        normaliseQvec(QvecFT0C, sumAmplFT0C, qVectFT0C);
       } else {
         qVectFT0C[0] = -999.;
         qVectFT0C[1] = -999.;
       }
-
-      if (sumAmplFT0M > 1e-8 && useDetector["QvectorFT0Ms"]) {
-        QvecFT0M /= sumAmplFT0M;
-        qVectFT0M[0] = QvecFT0M.Re();
-        qVectFT0M[1] = QvecFT0M.Im();
+      if (useFT0M) {
+        normaliseQvec(QvecFT0M, sumAmplFT0M, qVectFT0M);
       } else {
         qVectFT0M[0] = 999.;
         qVectFT0M[1] = 999.;
@@ -390,29 +445,21 @@ struct qVectorsTable {
       qVectFT0M[1] = -999.;
     }
 
-    QvecDet = TComplex(0., 0.);
-    sumAmplFV0A = 0;
-    if (coll.has_foundFV0() && useDetector["QvectorFV0As"]) {
+    if (coll.has_foundFV0() && useFV0A) {
       auto fv0 = coll.foundFV0();
 
       for (std::size_t iCh = 0; iCh < fv0.channel().size(); iCh++) {
         float ampl = fv0.amplitude()[iCh];
         int FV0AchId = fv0.channel()[iCh];
+        float amplCor = ampl / helperEP.GetGainTable(1, FV0AchId);
+
         histosQA.fill(HIST("FV0Amp"), ampl, FV0AchId);
-        histosQA.fill(HIST("FV0AmpCor"), ampl / FV0RelGainConst[FV0AchId], FV0AchId);
+        histosQA.fill(HIST("FV0AmpCor"), amplCor, FV0AchId);
 
-        helperEP.SumQvectors(1, FV0AchId, ampl / FV0RelGainConst[FV0AchId], cfgnMod, QvecDet, sumAmplFV0A, ft0geom, fv0geom);
+        helperEP.SumQvectorsTable(1, FV0AchId, amplCor, nMod, QvecFV0A, sumAmplFV0A);
       }
 
-      if (sumAmplFV0A > 1e-8) {
-        QvecDet /= sumAmplFV0A;
-        qVectFV0A[0] = QvecDet.Re();
-        qVectFV0A[1] = QvecDet.Im();
-        // printf("qVectFV0[0] = %.2f ; qVectFV0[1] = %.2f \n", qVectFV0[0], qVectFV0[1]); // Debug printing.
-      } else {
-        qVectFV0A[0] = 999.;
-        qVectFV0A[1] = 999.;
-      }
+      normaliseQvec(QvecFV0A, sumAmplFV0A, qVectFV0A);
     } else {
       qVectFV0A[0] = -999.;
       qVectFV0A[1] = -999.;
@@ -429,12 +476,12 @@ struct qVectorsTable {
       if (std::abs(trk.eta()) < 0.1 || std::abs(trk.eta()) > 0.8) {
         continue;
       }
-      if (trk.eta() > 0 && useDetector["QvectorBPoss"]) {
+      if (trk.eta() > 0 && useBPos) {
         qVectBPos[0] += trk.pt() * std::cos(trk.phi() * cfgnMod);
         qVectBPos[1] += trk.pt() * std::sin(trk.phi() * cfgnMod);
         TrkBPosLabel.push_back(trk.globalIndex());
         nTrkBPos++;
-      } else if (trk.eta() < 0 && useDetector["QvectorBNegs"]) {
+      } else if (trk.eta() < 0 && useBNeg) {
         qVectBNeg[0] += trk.pt() * std::cos(trk.phi() * cfgnMod);
         qVectBNeg[1] += trk.pt() * std::sin(trk.phi() * cfgnMod);
         TrkBNegLabel.push_back(trk.globalIndex());
@@ -491,6 +538,7 @@ struct qVectorsTable {
     qvecAmp.push_back(static_cast<float>(nTrkBNeg));
 
     if (cent < 80) {
+      int centBin = static_cast<int>(cent);
       int i = 0;
       for (auto det : useDetector) {
         // Check whether Q-vectors are found for a detector
@@ -500,19 +548,19 @@ struct qVectorsTable {
         }
 
         helperEP.DoRecenter(qvecRe[i * 4 + 1], qvecIm[i * 4 + 1],
-                            objQvec->GetBinContent(static_cast<int>(cent) + 1, 1, i + 1), objQvec->GetBinContent(static_cast<int>(cent) + 1, 2, i + 1));
+                            getCorrConst(centBin, 1, i), getCorrConst(centBin, 2, i));
 
         helperEP.DoRecenter(qvecRe[i * 4 + 2], qvecIm[i * 4 + 2],
-                            objQvec->GetBinContent(static_cast<int>(cent) + 1, 1, i + 1), objQvec->GetBinContent(static_cast<int>(cent) + 1, 2, i + 1));
+                            getCorrConst(centBin, 1, i), getCorrConst(centBin, 2, i));
         helperEP.DoTwist(qvecRe[i * 4 + 2], qvecIm[i * 4 + 2],
-                         objQvec->GetBinContent(static_cast<int>(cent) + 1, 3, i + 1), objQvec->GetBinContent(static_cast<int>(cent) + 1, 4, i + 1));
+                         getCorrConst(centBin, 3, i), getCorrConst(centBin, 4, i));
 
         helperEP.DoRecenter(qvecRe[i * 4 + 3], qvecIm[i * 4 + 3],
-                            objQvec->GetBinContent(static_cast<int>(cent) + 1, 1, i + 1), objQvec->GetBinContent(static_cast<int>(cent) + 1, 2, i + 1));
+                            getCorrConst(centBin, 1, i), getCorrConst(centBin, 2, i));
         helperEP.DoTwist(qvecRe[i * 4 + 3], qvecIm[i * 4 + 3],
-                         objQvec->GetBinContent(static_cast<int>(cent) + 1, 3, i + 1), objQvec->GetBinContent(static_cast<int>(cent) + 1, 4, i + 1));
+                         getCorrConst(centBin, 3, i), getCorrConst(centBin, 4, i));
         helperEP.DoRescale(qvecRe[i * 4 + 3], qvecIm[i * 4 + 3],
-                           objQvec->GetBinContent(static_cast<int>(cent) + 1, 5, i + 1), objQvec->GetBinContent(static_cast<int>(cent) + 1, 6, i + 1));
+                           getCorrConst(centBin, 5, i), getCorrConst(centBin, 6, i));
         i++;
       }
     }
@@ -520,17 +568,17 @@ struct qVectorsTable {
     // Fill the columns of the Qvectors table if they are found for a detector.
     int CorrLevel = cfgCorrLevel == 0 ? 0 : cfgCorrLevel - 1;
     qVector(cent, IsCalibrated, qvecRe, qvecIm, qvecAmp);
-    if (useDetector["QvectorFT0Cs"])
+    if (useFT0C)
       qVectorFT0C(IsCalibrated, qvecRe[kFT0C * 4 + CorrLevel], qvecIm[kFT0C * 4 + CorrLevel], sumAmplFT0C);
-    if (useDetector["QvectorFT0As"])
+    if (useFT0A)
       qVectorFT0A(IsCalibrated, qvecRe[kFT0A * 4 + CorrLevel], qvecIm[kFT0A * 4 + CorrLevel], sumAmplFT0A);
-    if (useDetector["QvectorFT0Ms"])
+    if (useFT0M)
       qVectorFT0M(IsCalibrated, qvecRe[kFT0M * 4 + CorrLevel], qvecIm[kFT0M * 4 + CorrLevel], sumAmplFT0M);
-    if (useDetector["QvectorFV0As"])
+    if (useFV0A)
       qVectorFV0A(IsCalibrated, qvecRe[kFV0A * 4 + CorrLevel], qvecIm[kFV0A * 4 + CorrLevel], sumAmplFV0A);
-    if (useDetector["QvectorBPoss"])
+    if (useBPos)
       qVectorBPos(IsCalibrated, qvecRe[kBPos * 4 + CorrLevel], qvecIm[kBPos * 4 + CorrLevel], nTrkBPos, TrkBPosLabel);
-    if (useDetector["QvectorBNegs"])
+    if (useBNeg)
       qVectorBNeg(IsCalibrated, qvecRe[kBNeg * 4 + CorrLevel], qvecIm[kBNeg * 4 + CorrLevel], nTrkBNeg, TrkBNegLabel);
 
   } // End process.
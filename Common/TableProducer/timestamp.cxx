@@ -17,12 +17,12 @@
 ///         Uses headers from CCDB
 ///
 #include <vector>
-#include <map>
 #include "Framework/runDataProcessing.h"
 #include "Framework/AnalysisTask.h"
 #include "CCDB/BasicCCDBManager.h"
 #include "CommonDataFormat/InteractionRecord.h"
 #include "DetectorsRaw/HBFUtils.h"
+#include "Common/CCDB/RunContextCache.h"
 
 using namespace o2::framework;
 using namespace o2::header;
@@ -32,8 +32,7 @@ struct TimestampTask {
   Produces<aod::Timestamps> timestampTable;  /// Table with SOR timestamps produced by the task
   Service<o2::ccdb::BasicCCDBManager> ccdb;  /// CCDB manager to access orbit-reset timestamp
   o2::ccdb::CcdbApi ccdb_api;                /// API to access CCDB headers
-  std::map<int, int64_t> mapRunToOrbitReset; /// Cache of orbit reset timestamps
-  int lastRunNumber = 0;                     /// Last run number processed
+  o2::RunContextCache runContexts;           /// Cache of the orbit-reset timestamps per run
   int64_t orbitResetTimestamp = 0;           /// Orbit-reset timestamp in us
 
   // Configurables
@@ -59,51 +58,7 @@ struct TimestampTask {
     // We need to set the orbit-reset timestamp for the run number.
     // This is done with caching if the run number was already processed before.
     // If not the orbit-reset timestamp for the run number is queried from CCDB and added to the cache
-    if (runNumber == lastRunNumber) { // The run number coincides to the last run processed
-      LOGF(debug, "Using orbit-reset timestamp from last call");
-    } else if (mapRunToOrbitReset.count(runNumber)) { // The run number was already requested before: getting it from cache!
-      LOGF(debug, "Getting orbit-reset timestamp from cache");
-      orbitResetTimestamp = mapRunToOrbitReset[runNumber];
-    } else { // The run was not requested before: need to acccess CCDB!
-      LOGF(debug, "Getting start-of-run and end-of-run timestamps from CCDB");
-      std::map<std::string, std::string> metadata, headers;
-      const std::string run_path = Form("%s/%i", rct_path.value.data(), runNumber);
-      headers = ccdb_api.retrieveHeaders(run_path, metadata, -1);
-      if (headers.count("SOR") == 0) {
-        LOGF(fatal, "Cannot find start-of-run timestamp for run number in path '%s'.", run_path.data());
-      }
-      if (headers.count("EOR") == 0) {
-        LOGF(fatal, "Cannot find end-of-run timestamp for run number in path '%s'.", run_path.data());
-      }
-
-      int64_t sorTimestamp = atol(headers["SOR"].c_str()); // timestamp of the SOR in ms
-      int64_t eorTimestamp = atol(headers["EOR"].c_str()); // timestamp of the EOR in ms
-
-      bool isUnanchoredRun3MC = runNumber >= 300000 && runNumber < 500000;
-      if (isRun2MC || isUnanchoredRun3MC) {
-        // isRun2MC: bc/orbit distributions are not simulated in Run2 MC. All bcs are set to 0.
-        // isUnanchoredRun3MC: assuming orbit-reset is done in the beginning of each run
-        // Setting orbit-reset timestamp to start-of-run timestamp
-        orbitResetTimestamp = sorTimestamp * 1000; // from ms to us
-      } else if (runNumber < 300000) {             // Run 2
-        LOGF(debug, "Getting orbit-reset timestamp using start-of-run timestamp from CCDB");
-        auto ctp = ccdb->getForTimeStamp<std::vector<Long64_t>>(orbit_reset_path.value.data(), sorTimestamp);
-        orbitResetTimestamp = (*ctp)[0];
-      } else {
-        // sometimes orbit is reset after SOR. Using EOR timestamps for orbitReset query is more reliable
-        LOGF(debug, "Getting orbit-reset timestamp using end-of-run timestamp from CCDB");
-        auto ctp = ccdb->getForTimeStamp<std::vector<Long64_t>>(orbit_reset_path.value.data(), eorTimestamp);
-        orbitResetTimestamp = (*ctp)[0];
-      }
-
-      // Adding the timestamp to the cache map
-      std::pair<std::map<int, int64_t>::iterator, bool> check;
-      check = mapRunToOrbitReset.insert(std::pair<int, int64_t>(runNumber, orbitResetTimestamp));
-      if (!check.second) {
-        LOGF(fatal, "Run number %i already existed with a orbit-reset timestamp of %llu", runNumber, check.first->second);
-      }
-      LOGF(info, "Add new run number %i with orbit-reset timestamp %llu to cache", runNumber, orbitResetTimestamp);
-    }
+    orbitResetTimestamp = runContexts.getRunInformation(ccdb_api, ccdb.service, runNumber, rct_path.value, orbit_reset_path.value, isRun2MC).orbitResetTimestamp;
 
     if (verbose.value) {
       LOGF(info, "Orbit-reset timestamp for run number %i found: %llu us", runNumber, orbitResetTimestamp);
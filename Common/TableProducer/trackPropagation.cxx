@@ -13,7 +13,14 @@
 // Task to add a table of track parameters propagated to the primary vertex
 //
 
+#include <algorithm>
+#include <array>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
 #include "TableHelper.h"
+#include "Common/CCDB/CcdbPrefetcher.h"
 #include "Common/Tools/TrackTuner.h"
 
 // The Run 3 AO2D stores the tracks at the point of innermost update. For a track with ITS this is the innermost (or second innermost)
@@ -28,6 +35,14 @@ using namespace o2;
 using namespace o2::framework;
 // using namespace o2::framework::expressions;
 
+// Categories of the tracks for the propagation, the fast paths (helix DCA, skipped tracks) are enabled with fastPropagationMask
+enum PropagationCategory { kNotPropagated = 0,   // not at the IU or beyond minPropagationDistance, as without fast paths
+                           kFullPropagation,    // propagation in the full field with material corrections
+                           kHelixDCA,           // helix in the nominal Bz without material corrections (bit 0 of the mask)
+                           kSkippedLargeX,      // not propagated because of the large reference X, e.g. TPC-only tracks (bit 1 of the mask)
+                           kSkippedNoCollision, // not propagated because the track has no collision (bit 2 of the mask)
+                           kNPropagationCategories };
+
 struct TrackPropagation {
   Produces<aod::StoredTracks> tracksParPropagated;
   Produces<aod::TracksExtension> tracksParExtensionPropagated;
@@ -41,6 +56,7 @@ struct TrackPropagation {
   Produces<aod::TrackTunerTable> tunertable;
 
   Service<o2::ccdb::BasicCCDBManager> ccdb;
+  o2::CcdbPrefetcher ccdbPrefetcher; // objects of the current run, retrieved together at the run change
 
   bool fillTracksDCA = false;
   bool fillTracksDCACov = false;
@@ -59,6 +75,12 @@ struct TrackPropagation {
   Configurable<std::string> grpmagPath{"grpmagPath", "GLO/Config/GRPMagField", "CCDB path of the GRPMagField object"};
   Configurable<std::string> mVtxPath{"mVtxPath", "GLO/Calib/MeanVertex", "Path of the mean vertex file"};
   Configurable<float> minPropagationRadius{"minPropagationDistance", o2::constants::geom::XTPCInnerRef + 0.1, "Only tracks which are at a smaller radius will be propagated, defaults to TPC inner wall"};
+  Configurable<int> nThreadsPropagation{"nThreadsPropagation", 1, "Number of threads for the propagation of the tracks of a dataframe, 1 to propagate them one by one (not applied on MC)"};
+  Configurable<int> minTracksPerThread{"minTracksPerThread", 1000, "Minimum number of tracks propagated per thread"};
+  Configurable<int> fastPropagationMask{"fastPropagationMask", 0, "Bit mask of the fast paths: 1 helix DCA without material for reference X < maxXHelixDCA, 2 no propagation for reference X > minXSkipPropagation, 4 no propagation of the tracks without collision"};
+  Configurable<float> maxXHelixDCA{"maxXHelixDCA", 4.f, "Maximum reference X of the tracks propagated as helices in the nominal Bz without material corrections (fast path)"};
+  Configurable<int> fillCovariance{"fillCovariance", -1, "Propagate the covariance matrices in the covariance process functions: -1 auto (only if the covariance or DCA covariance tables are required in the workflow), 0 no, 1 yes"};
+  Configurable<float> minXSkipPropagation{"minXSkipPropagation", 40.f, "Minimum reference X of the tracks which are not propagated (fast path)"};
   // for TrackTuner only (MC smearing)
   Configurable<bool> useTrackTuner{"useTrackTuner", false, "Apply track tuner corrections to MC"};
   Configurable<bool> fillTrackTunerTable{"fillTrackTunerTable", false, "flag to fill track tuner table"};
@@ -101,13 +123,27 @@ struct TrackPropagation {
     if (nEnabledProcesses != 1) {
       LOG(fatal) << "Exactly one process flag must be set to true. Please choose one.";
     }
+    if (nThreadsPropagation > 1) {
+      LOG(info) << "Propagating the tracks with up to " << nThreadsPropagation << " threads";
+      if (doprocessCovarianceMc) {
+        LOG(info) << "The tracks are propagated one by one on MC";
+      }
+    }
     // Checking if the tables are requested in the workflow and enabling them
     fillTracksDCA = isTableRequiredInWorkflow(initContext, "TracksDCA");
     fillTracksDCACov = isTableRequiredInWorkflow(initContext, "TracksDCACov");
+    if (doprocessCovariance || doprocessCovarianceMc || doprocessCovarianceWithPID) {
+      if (useTrackTuner && fillCovariance < 0) {
+        fillCovariance.value = 1; // the track tuner updates the covariance matrices
+      }
+      // without covariance consumers the tracks are propagated as in processStandard
+      enableFlagIfTableRequired(initContext, {"TracksCov", "StoredTracksCov", "TracksCovExtension", "TracksDCACov"}, fillCovariance);
+    }
 
     ccdb->setURL(ccdburl);
     ccdb->setCaching(true);
     ccdb->setLocalObjectValidityChecking();
+    ccdbPrefetcher.setURL(ccdburl);
 
     lut = o2::base::MatLayerCylSet::rectifyPtrFromFile(ccdb->get<o2::base::MatLayerCylSet>(lutPath));
     // Histograms for track tuner
@@ -116,6 +152,14 @@ struct TrackPropagation {
     registry.add("hDCAxyVsPtMC", "hDCAxyVsPtMC", kTH2F, {axisBinsDCA, axisPtQA});
     registry.add("hDCAzVsPtRec", "hDCAzVsPtRec", kTH2F, {axisBinsDCA, axisPtQA});
     registry.add("hDCAzVsPtMC", "hDCAzVsPtMC", kTH2F, {axisBinsDCA, axisPtQA});
+    // Counter of the tracks per propagation category
+    registry.add("hPropagationCategory", "Propagation of the tracks;;tracks", kTH1D, {{kNPropagationCategories, -0.5f, kNPropagationCategories - 0.5f}});
+    auto hPropagationCategory = registry.get<TH1>(HIST("hPropagationCategory"));
+    hPropagationCategory->GetXaxis()->SetBinLabel(kNotPropagated + 1, "not propagated");
+    hPropagationCategory->GetXaxis()->SetBinLabel(kFullPropagation + 1, "full propagation");
+    hPropagationCategory->GetXaxis()->SetBinLabel(kHelixDCA + 1, "helix DCA");
+    hPropagationCategory->GetXaxis()->SetBinLabel(kSkippedLargeX + 1, "skipped (large X)");
+    hPropagationCategory->GetXaxis()->SetBinLabel(kSkippedNoCollision + 1, "skipped (no collision)");
 
     /// TrackTuner initialization
     if (useTrackTuner) {
@@ -134,14 +178,20 @@ struct TrackPropagation {
     if (runNumber == bc.runNumber()) {
       return;
     }
-    grpmag = ccdb->getForTimeStamp<o2::parameters::GRPMagField>(grpmagPath, bc.timestamp());
+    // the objects of the previous run are no longer used from here on
+    ccdbPrefetcher.clear();
+    ccdbPrefetcher.add<o2::parameters::GRPMagField>(grpmagPath, bc.timestamp());
+    ccdbPrefetcher.add<o2::dataformats::MeanVertexObject>(mVtxPath, bc.timestamp());
+    grpmag = ccdbPrefetcher.get<o2::parameters::GRPMagField>(ccdb.service, grpmagPath, bc.timestamp());
     LOG(info) << "Setting magnetic field to current " << grpmag->getL3Current() << " A for run " << bc.runNumber() << " from its GRPMagField CCDB object";
     o2::base::Propagator::initFieldFromGRP(grpmag);
     o2::base::Propagator::Instance()->setMatLUT(lut);
-    mMeanVtx = ccdb->getForTimeStamp<o2::dataformats::MeanVertexObject>(mVtxPath, bc.timestamp());
+    mMeanVtx = ccdbPrefetcher.get<o2::dataformats::MeanVertexObject>(ccdb.service, mVtxPath, bc.timestamp());
     runNumber = bc.runNumber();
   }
 
+  std::array<double, kNPropagationCategories> propagationCategoryCounts{}; // number of tracks per category in the current dataframe
+
   // Running variables
   gpu::gpustd::array<float, 2> mDcaInfo;
   o2::dataformats::DCA mDcaInfoCov;
@@ -174,6 +224,16 @@ struct TrackPropagation {
       }
     }
 
+    propagationCategoryCounts.fill(0.);
+    if constexpr (!isMc) {
+      const int nThreads = std::clamp(static_cast<int>(tracks.size()) / std::max(static_cast<int>(minTracksPerThread), 1), 1, std::max(static_cast<int>(nThreadsPropagation), 1));
+      if (nThreads > 1) {
+        propagateTracksInParallel<fillCovMat, useTrkPid>(tracks, nThreads);
+        fillPropagationCategories();
+        return;
+      }
+    }
+
     for (auto& track : tracks) {
       if constexpr (fillCovMat) {
         if (fillTracksDCA || fillTracksDCACov) {
@@ -199,7 +259,9 @@ struct TrackPropagation {
       // std::array<float, 3> trackPxPyPzTuned = {0.0, 0.0, 0.0};
       double q2OverPtNew = -9999.;
       // Only propagate tracks which have passed the innermost wall of the TPC (e.g. skipping loopers etc). Others fill unpropagated.
-      if (track.trackType() == aod::track::TrackIU && track.x() < minPropagationRadius) {
+      const int category = getPropagationCategory(track);
+      propagationCategoryCounts[category]++;
+      if (category != kNotPropagated) {
         if constexpr (isMc && fillCovMat) { // checking MC and fillCovMat block begins
           // bool hasMcParticle = track.has_mcParticle();
           if (useTrackTuner) {
@@ -212,24 +274,12 @@ struct TrackPropagation {
             }
           }
         } // MC and fillCovMat block ends
-        bool isPropagationOK = true;
-
-        if (track.has_collision()) {
-          auto const& collision = track.collision();
-          if constexpr (fillCovMat) {
-            mVtx.setPos({collision.posX(), collision.posY(), collision.posZ()});
-            mVtx.setCov(collision.covXX(), collision.covXY(), collision.covYY(), collision.covXZ(), collision.covYZ(), collision.covZZ());
-            isPropagationOK = o2::base::Propagator::Instance()->propagateToDCABxByBz(mVtx, mTrackParCov, 2.f, matCorr, &mDcaInfoCov);
-          } else {
-            isPropagationOK = o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, mTrackPar, 2.f, matCorr, &mDcaInfo);
-          }
-        } else {
+        bool isPropagationOK = false;
+        if (category == kFullPropagation || category == kHelixDCA) {
           if constexpr (fillCovMat) {
-            mVtx.setPos({mMeanVtx->getX(), mMeanVtx->getY(), mMeanVtx->getZ()});
-            mVtx.setCov(mMeanVtx->getSigmaX() * mMeanVtx->getSigmaX(), 0.0f, mMeanVtx->getSigmaY() * mMeanVtx->getSigmaY(), 0.0f, 0.0f, mMeanVtx->getSigmaZ() * mMeanVtx->getSigmaZ());
-            isPropagationOK = o2::base::Propagator::Instance()->propagateToDCABxByBz(mVtx, mTrackParCov, 2.f, matCorr, &mDcaInfoCov);
+            isPropagationOK = propagateToVertex(track, mTrackParCov, mDcaInfoCov, mVtx, category == kHelixDCA);
           } else {
-            isPropagationOK = o2::base::Propagator::Instance()->propagateToDCABxByBz({mMeanVtx->getX(), mMeanVtx->getY(), mMeanVtx->getZ()}, mTrackPar, 2.f, matCorr, &mDcaInfo);
+            isPropagationOK = propagateToVertex(track, mTrackPar, mDcaInfo, mVtx, category == kHelixDCA);
           }
         }
         if (isPropagationOK) {
@@ -255,28 +305,166 @@ struct TrackPropagation {
       }
       // LOG(info) <<  " trackPropagation (this value filled in tuner table)--> "  << q2OverPtNew;
       if constexpr (fillCovMat) {
-        tracksParPropagated(track.collisionId(), trackType, mTrackParCov.getX(), mTrackParCov.getAlpha(), mTrackParCov.getY(), mTrackParCov.getZ(), mTrackParCov.getSnp(), mTrackParCov.getTgl(), mTrackParCov.getQ2Pt());
-        tracksParExtensionPropagated(mTrackParCov.getPt(), mTrackParCov.getP(), mTrackParCov.getEta(), mTrackParCov.getPhi());
-        // TODO do we keep the rho as 0? Also the sigma's are duplicated information
-        tracksParCovPropagated(std::sqrt(mTrackParCov.getSigmaY2()), std::sqrt(mTrackParCov.getSigmaZ2()), std::sqrt(mTrackParCov.getSigmaSnp2()),
-                               std::sqrt(mTrackParCov.getSigmaTgl2()), std::sqrt(mTrackParCov.getSigma1Pt2()), 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
-        tracksParCovExtensionPropagated(mTrackParCov.getSigmaY2(), mTrackParCov.getSigmaZY(), mTrackParCov.getSigmaZ2(), mTrackParCov.getSigmaSnpY(),
-                                        mTrackParCov.getSigmaSnpZ(), mTrackParCov.getSigmaSnp2(), mTrackParCov.getSigmaTglY(), mTrackParCov.getSigmaTglZ(), mTrackParCov.getSigmaTglSnp(),
-                                        mTrackParCov.getSigmaTgl2(), mTrackParCov.getSigma1PtY(), mTrackParCov.getSigma1PtZ(), mTrackParCov.getSigma1PtSnp(), mTrackParCov.getSigma1PtTgl(),
-                                        mTrackParCov.getSigma1Pt2());
-        if (fillTracksDCA) {
-          tracksDCA(mDcaInfoCov.getY(), mDcaInfoCov.getZ());
+        fillTrackRow<fillCovMat>(track.collisionId(), trackType, mTrackParCov, mDcaInfoCov);
+      } else {
+        fillTrackRow<fillCovMat>(track.collisionId(), trackType, mTrackPar, mDcaInfo);
+      }
+    }
+    fillPropagationCategories();
+  }
+
+  /// Category of a track for the propagation, see PropagationCategory
+  template <typename TTrack>
+  int getPropagationCategory(TTrack const& track) const
+  {
+    if (track.trackType() != aod::track::TrackIU || track.x() >= minPropagationRadius) {
+      return kNotPropagated;
+    }
+    if (TESTBIT(fastPropagationMask, 2) && !track.has_collision()) {
+      return kSkippedNoCollision;
+    }
+    if (TESTBIT(fastPropagationMask, 1) && track.x() > minXSkipPropagation) {
+      return kSkippedLargeX;
+    }
+    if (TESTBIT(fastPropagationMask, 0) && track.x() < maxXHelixDCA) {
+      return kHelixDCA;
+    }
+    return kFullPropagation;
+  }
+
+  void fillPropagationCategories()
+  {
+    for (int category = 0; category < kNPropagationCategories; category++) {
+      if (propagationCategoryCounts[category] > 0) {
+        registry.fill(HIST("hPropagationCategory"), category, propagationCategoryCounts[category]);
+      }
+    }
+  }
+
+  /// Propagates a track to the DCA to its collision, or to the mean vertex if it has none
+  /// \param vtx is the vertex used for the propagation with covariance matrix
+  /// \param helix propagates the track as a helix in the nominal Bz, without material corrections
+  /// \return whether the propagation succeeded
+  template <typename TTrack, typename TTrackPar, typename TDca>
+  bool propagateToVertex(TTrack const& track, TTrackPar& trackPar, TDca& dcaInfo, o2::dataformats::VertexBase& vtx, bool helix = false) const
+  {
+    constexpr bool fillCovMat = std::is_same_v<TTrackPar, o2::track::TrackParametrizationWithError<float>>;
+    if (track.has_collision()) {
+      auto const& collision = track.collision();
+      vtx.setPos({collision.posX(), collision.posY(), collision.posZ()});
+      vtx.setCov(collision.covXX(), collision.covXY(), collision.covYY(), collision.covXZ(), collision.covYZ(), collision.covZZ());
+    } else {
+      vtx.setPos({mMeanVtx->getX(), mMeanVtx->getY(), mMeanVtx->getZ()});
+      vtx.setCov(mMeanVtx->getSigmaX() * mMeanVtx->getSigmaX(), 0.0f, mMeanVtx->getSigmaY() * mMeanVtx->getSigmaY(), 0.0f, 0.0f, mMeanVtx->getSigmaZ() * mMeanVtx->getSigmaZ());
+    }
+    auto propagator = o2::base::Propagator::Instance();
+    if (helix) {
+      if constexpr (fillCovMat) {
+        return propagator->propagateToDCA(vtx, trackPar, propagator->getNominalBz(), 2.f, o2::base::Propagator::MatCorrType::USEMatCorrNONE, &dcaInfo);
+      } else {
+        return propagator->propagateToDCA(vtx.getXYZ(), trackPar, propagator->getNominalBz(), 2.f, o2::base::Propagator::MatCorrType::USEMatCorrNONE, &dcaInfo);
+      }
+    }
+    if constexpr (fillCovMat) {
+      return propagator->propagateToDCABxByBz(vtx, trackPar, 2.f, matCorr, &dcaInfo);
+    } else {
+      return propagator->propagateToDCABxByBz(vtx.getXYZ(), trackPar, 2.f, matCorr, &dcaInfo);
+    }
+  }
+
+  /// Fills the row of a track in the output tables
+  template <bool fillCovMat, typename TTrackPar, typename TDca>
+  void fillTrackRow(int collisionId, aod::track::TrackTypeEnum trackType, TTrackPar const& trackPar, TDca const& dcaInfo)
+  {
+    if constexpr (fillCovMat) {
+      tracksParPropagated(collisionId, trackType, trackPar.getX(), trackPar.getAlpha(), trackPar.getY(), trackPar.getZ(), trackPar.getSnp(), trackPar.getTgl(), trackPar.getQ2Pt());
+      tracksParExtensionPropagated(trackPar.getPt(), trackPar.getP(), trackPar.getEta(), trackPar.getPhi());
+      // TODO do we keep the rho as 0? Also the sigma's are duplicated information
+      tracksParCovPropagated(std::sqrt(trackPar.getSigmaY2()), std::sqrt(trackPar.getSigmaZ2()), std::sqrt(trackPar.getSigmaSnp2()),
+                             std::sqrt(trackPar.getSigmaTgl2()), std::sqrt(trackPar.getSigma1Pt2()), 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+      tracksParCovExtensionPropagated(trackPar.getSigmaY2(), trackPar.getSigmaZY(), trackPar.getSigmaZ2(), trackPar.getSigmaSnpY(),
+                                      trackPar.getSigmaSnpZ(), trackPar.getSigmaSnp2(), trackPar.getSigmaTglY(), trackPar.getSigmaTglZ(), trackPar.getSigmaTglSnp(),
+                                      trackPar.getSigmaTgl2(), trackPar.getSigma1PtY(), trackPar.getSigma1PtZ(), trackPar.getSigma1PtSnp(), trackPar.getSigma1PtTgl(),
+                                      trackPar.getSigma1Pt2());
+      if (fillTracksDCA) {
+        tracksDCA(dcaInfo.getY(), dcaInfo.getZ());
+      }
+      if (fillTracksDCACov) {
+        tracksDCACov(dcaInfo.getSigmaY2(), dcaInfo.getSigmaZ2());
+      }
+    } else {
+      tracksParPropagated(collisionId, trackType, trackPar.getX(), trackPar.getAlpha(), trackPar.getY(), trackPar.getZ(), trackPar.getSnp(), trackPar.getTgl(), trackPar.getQ2Pt());
+      tracksParExtensionPropagated(trackPar.getPt(), trackPar.getP(), trackPar.getEta(), trackPar.getPhi());
+      if (fillTracksDCA) {
+        tracksDCA(dcaInfo[0], dcaInfo[1]);
+      }
+    }
+  }
+
+  /// Propagates the tracks in contiguous ranges, the first one in this thread, and then fills the tables in the order of the tracks
+  /// The threads share the propagator, whose propagation methods are const, and its material LUT, which is only read.
+  /// Each thread has its own track parametrizations and vertex, the results are stored in buffers sized to the number of tracks.
+  template <bool fillCovMat, bool useTrkPid, typename TTrack>
+  void propagateTracksInParallel(TTrack const& tracks, int nThreads)
+  {
+    using TTrackPar = std::conditional_t<fillCovMat, o2::track::TrackParametrizationWithError<float>, o2::track::TrackParametrization<float>>;
+    using TDca = std::conditional_t<fillCovMat, o2::dataformats::DCA, gpu::gpustd::array<float, 2>>;
+    const int nTracks = tracks.size();
+    std::vector<TTrackPar> trackPars(nTracks);
+    std::vector<TDca> dcaInfos(nTracks);
+    std::vector<aod::track::TrackTypeEnum> trackTypes(nTracks);
+    std::vector<std::array<int, kNPropagationCategories>> categoryCounts(nThreads); // per thread
+    const int nTracksPerThread = (nTracks + nThreads - 1) / nThreads;
+    auto propagateRange = [&](int iThread) {
+      const int first = iThread * nTracksPerThread;
+      const int last = std::min(nTracks, first + nTracksPerThread);
+      if (first >= last) {
+        return;
+      }
+      o2::dataformats::VertexBase vtx;
+      auto track = tracks.rawIteratorAt(first);
+      for (int iTrack = first; iTrack < last; ++iTrack, ++track) {
+        auto& trackPar = trackPars[iTrack];
+        auto& dcaInfo = dcaInfos[iTrack];
+        if constexpr (fillCovMat) {
+          dcaInfo.set(999, 999, 999, 999, 999);
+          setTrackParCov(track, trackPar);
+        } else {
+          dcaInfo[0] = 999;
+          dcaInfo[1] = 999;
+          setTrackPar(track, trackPar);
         }
-        if (fillTracksDCACov) {
-          tracksDCACov(mDcaInfoCov.getSigmaY2(), mDcaInfoCov.getSigmaZ2());
+        if constexpr (useTrkPid) {
+          trackPar.setPID(track.pidForTracking());
         }
-      } else {
-        tracksParPropagated(track.collisionId(), trackType, mTrackPar.getX(), mTrackPar.getAlpha(), mTrackPar.getY(), mTrackPar.getZ(), mTrackPar.getSnp(), mTrackPar.getTgl(), mTrackPar.getQ2Pt());
-        tracksParExtensionPropagated(mTrackPar.getPt(), mTrackPar.getP(), mTrackPar.getEta(), mTrackPar.getPhi());
-        if (fillTracksDCA) {
-          tracksDCA(mDcaInfo[0], mDcaInfo[1]);
+        trackTypes[iTrack] = (aod::track::TrackTypeEnum)track.trackType();
+        const int category = getPropagationCategory(track);
+        categoryCounts[iThread][category]++;
+        if ((category == kFullPropagation || category == kHelixDCA) && propagateToVertex(track, trackPar, dcaInfo, vtx, category == kHelixDCA)) {
+          trackTypes[iTrack] = aod::track::Track;
         }
       }
+    };
+    std::vector<std::thread> threads;
+    for (int iThread = 1; iThread < nThreads; ++iThread) {
+      threads.emplace_back(propagateRange, iThread);
+    }
+    propagateRange(0);
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    for (auto const& counts : categoryCounts) {
+      for (int category = 0; category < kNPropagationCategories; category++) {
+        propagationCategoryCounts[category] += counts[category];
+      }
+    }
+
+    auto track = tracks.begin();
+    for (int iTrack = 0; iTrack < nTracks; ++iTrack, ++track) {
+      if (useTrackTuner && fillTrackTunerTable) {
+        tunertable(-9999.);
+      }
+      fillTrackRow<fillCovMat>(track.collisionId(), trackTypes[iTrack], trackPars[iTrack], dcaInfos[iTrack]);
     }
   }
 
@@ -296,20 +484,32 @@ struct TrackPropagation {
   void processCovarianceMc(TracksIUWithMc const& tracks, aod::McParticles const& mcParticles, aod::Collisions const& collisions, aod::BCsWithTimestamps const& bcs)
   {
     // auto table_extension = soa::Extend<TracksIUWithMc, aod::extension::MomX>(tracks);
-    fillTrackTables</*TTrack*/ TracksIUWithMc, /*Particle*/ aod::McParticles, /*isMc = */ true, /*fillCovMat =*/true, /*useTrkPid =*/false>(tracks, mcParticles, collisions, bcs);
+    if (fillCovariance) {
+      fillTrackTables</*TTrack*/ TracksIUWithMc, /*Particle*/ aod::McParticles, /*isMc = */ true, /*fillCovMat =*/true, /*useTrkPid =*/false>(tracks, mcParticles, collisions, bcs);
+    } else {
+      fillTrackTables</*TTrack*/ TracksIUWithMc, /*Particle*/ aod::McParticles, /*isMc = */ true, /*fillCovMat =*/false, /*useTrkPid =*/false>(tracks, mcParticles, collisions, bcs);
+    }
   }
   PROCESS_SWITCH(TrackPropagation, processCovarianceMc, "Process with covariance on MC", false);
 
   void processCovariance(soa::Join<aod::StoredTracksIU, aod::TracksCovIU> const& tracks, aod::Collisions const& collisions, aod::BCsWithTimestamps const& bcs)
   {
-    fillTrackTables</*TTrack*/ soa::Join<aod::StoredTracksIU, aod::TracksCovIU>, /*Particle*/ soa::Join<aod::StoredTracksIU, aod::TracksCovIU>, /*isMc = */ false, /*fillCovMat =*/true, /*useTrkPid =*/false>(tracks, tracks, collisions, bcs);
+    if (fillCovariance) {
+      fillTrackTables</*TTrack*/ soa::Join<aod::StoredTracksIU, aod::TracksCovIU>, /*Particle*/ soa::Join<aod::StoredTracksIU, aod::TracksCovIU>, /*isMc = */ false, /*fillCovMat =*/true, /*useTrkPid =*/false>(tracks, tracks, collisions, bcs);
+    } else {
+      fillTrackTables</*TTrack*/ soa::Join<aod::StoredTracksIU, aod::TracksCovIU>, /*Particle*/ soa::Join<aod::StoredTracksIU, aod::TracksCovIU>, /*isMc = */ false, /*fillCovMat =*/false, /*useTrkPid =*/false>(tracks, tracks, collisions, bcs);
+    }
   }
   PROCESS_SWITCH(TrackPropagation, processCovariance, "Process with covariance", false);
   // ------------------------
 
   void processCovarianceWithPID(soa::Join<aod::StoredTracksIU, aod::TracksCovIU, aod::TracksExtra> const& tracks, aod::Collisions const& collisions, aod::BCsWithTimestamps const& bcs)
   {
-    fillTrackTables</*TTrack*/ soa::Join<aod::StoredTracksIU, aod::TracksCovIU, aod::TracksExtra>, /*Particle*/ soa::Join<aod::StoredTracksIU, aod::TracksCovIU, aod::TracksExtra>, /*isMc = */ false, /*fillCovMat =*/true, /*useTrkPid =*/false>(tracks, tracks, collisions, bcs);
+    if (fillCovariance) {
+      fillTrackTables</*TTrack*/ soa::Join<aod::StoredTracksIU, aod::TracksCovIU, aod::TracksExtra>, /*Particle*/ soa::Join<aod::StoredTracksIU, aod::TracksCovIU, aod::TracksExtra>, /*isMc = */ false, /*fillCovMat =*/true, /*useTrkPid =*/false>(tracks, tracks, collisions, bcs);
+    } else {
+      fillTrackTables</*TTrack*/ soa::Join<aod::StoredTracksIU, aod::TracksCovIU, aod::TracksExtra>, /*Particle*/ soa::Join<aod::StoredTracksIU, aod::TracksCovIU, aod::TracksExtra>, /*isMc = */ false, /*fillCovMat =*/false, /*useTrkPid =*/false>(tracks, tracks, collisions, bcs);
+    }
   }
   PROCESS_SWITCH(TrackPropagation, processCovarianceWithPID, "Process with covariance and with PID in tracking", false);
 };
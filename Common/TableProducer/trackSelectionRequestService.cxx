@@ -0,0 +1,157 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+//
+// Service task evaluating the trackSelectionRequests of all the tasks of the workflow once per track
+//
+// The requests are collected at init from the options of the devices, grouped by configurable group: each group
+// holding at least one of the track-quality options of trackSelectionRequest (requireTPC, minTPCclusters, ...)
+// is a request. Identical requests of several tasks are merged, and each distinct request gets one bit of the
+// TrackSelRequests table, in the order of their first appearance in the workflow (printed at init).
+// The logical OR of all the requests is evaluated first, such that the tracks failing all of them are rejected
+// with a single check.
+//
+
+#include <string>
+#include <vector>
+
+#include "Framework/AnalysisDataModel.h"
+#include "Framework/AnalysisTask.h"
+#include "Framework/runDataProcessing.h"
+#include "Framework/RunningWorkflowInfo.h"
+#include "Common/DataModel/TrackSelectionTables.h"
+#include "trackSelectionRequest.h"
+
+using namespace o2;
+using namespace o2::framework;
+
+struct TrackSelectionRequestService {
+  Produces<aod::TrackSelRequests> trackSelRequests;
+
+  std::vector<trackSelectionRequest> requests; // distinct requests, at their bit index
+  trackSelectionRequest requestUnion;          // logical OR of all the requests
+
+  // Applies a device option to the request of its group, returns true for the track-quality options
+  bool setOption(trackSelectionRequest& request, ConfigParamSpec const& option, std::string const& field)
+  {
+    if (field == "requireTPC") {
+      request.setRequireTPC(option.defaultValue.get<bool>());
+    } else if (field == "minTPCclusters") {
+      request.setMinTPCClusters(option.defaultValue.get<int>());
+    } else if (field == "minTPCcrossedrows") {
+      request.setMinTPCCrossedRows(option.defaultValue.get<int>());
+    } else if (field == "minTPCcrossedrowsoverfindable") {
+      request.setMinTPCCrossedRowsOverFindable(option.defaultValue.get<float>());
+    } else if (field == "requireITS") {
+      request.setRequireITS(option.defaultValue.get<bool>());
+    } else if (field == "minITSclusters") {
+      request.setMinITSClusters(option.defaultValue.get<int>());
+    } else if (field == "maxITSChi2percluster") {
+      request.setMaxITSChi2PerCluster(option.defaultValue.get<float>());
+    } else if (field == "minPt") {
+      request.setMinPt(option.defaultValue.get<float>());
+      return false;
+    } else if (field == "maxPt") {
+      request.setMaxPt(option.defaultValue.get<float>());
+      return false;
+    } else if (field == "minEta") {
+      request.setMinEta(option.defaultValue.get<float>());
+      return false;
+    } else if (field == "maxEta") {
+      request.setMaxEta(option.defaultValue.get<float>());
+      return false;
+    } else if (field == "maxDCAz") {
+      request.setMaxDCAz(option.defaultValue.get<float>());
+      return false;
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+  void init(InitContext& initContext)
+  {
+    auto& workflows = initContext.services().get<RunningWorkflowInfo const>();
+    for (DeviceSpec const& device : workflows.devices) {
+      // requests of the device, per configurable group
+      std::vector<std::string> prefixes;
+      std::vector<trackSelectionRequest> deviceRequests;
+      std::vector<bool> isRequest;
+      for (auto const& option : device.options) {
+        auto pos = option.name.rfind('.');
+        if (pos == std::string::npos) {
+          continue;
+        }
+        auto prefix = option.name.substr(0, pos);
+        size_t iGroup = 0;
+        while (iGroup < prefixes.size() && prefixes[iGroup] != prefix) {
+          iGroup++;
+        }
+        if (iGroup == prefixes.size()) {
+          prefixes.push_back(prefix);
+          deviceRequests.emplace_back();
+          isRequest.push_back(false);
+        }
+        if (setOption(deviceRequests[iGroup], option, option.name.substr(pos + 1))) {
+          isRequest[iGroup] = true;
+        }
+      }
+      for (size_t iGroup = 0; iGroup < prefixes.size(); iGroup++) {
+        if (!isRequest[iGroup]) {
+          continue;
+        }
+        size_t bit = 0;
+        while (bit < requests.size() && !(requests[bit] == deviceRequests[iGroup])) {
+          bit++;
+        }
+        if (bit == requests.size()) {
+          requests.push_back(deviceRequests[iGroup]);
+          LOGF(info, "Track selection request %d, from device %s, group %s:", static_cast<int>(bit), device.name, prefixes[iGroup]);
+          requests.back().PrintSelections();
+        } else {
+          LOGF(info, "Device %s, group %s: same selections as request %d", device.name, prefixes[iGroup], static_cast<int>(bit));
+        }
+      }
+    }
+    if (requests.size() > 32) {
+      LOGF(fatal, "%d distinct track selection requests in the workflow, at most 32 are supported", static_cast<int>(requests.size()));
+    }
+    if (requests.empty()) {
+      LOGF(warning, "No track selection request found in the workflow, all the tracks will have an empty mask");
+    }
+
+    requestUnion.SetTightSelections(); // only loosen from this point forward
+    for (auto const& request : requests) {
+      requestUnion.CombineWithLogicalOR(request);
+    }
+  }
+
+  void process(soa::Join<aod::Tracks, aod::TracksExtra, aod::TracksDCA> const& tracks)
+  {
+    trackSelRequests.reserve(tracks.size());
+    for (auto const& track : tracks) {
+      uint32_t mask = 0;
+      if (!requests.empty() && requestUnion.IsTrackSelected(track)) {
+        for (size_t bit = 0; bit < requests.size(); bit++) {
+          if (requests[bit].IsTrackSelected(track)) {
+            mask |= 1u << bit;
+          }
+        }
+      }
+      trackSelRequests(mask);
+    }
+  }
+};
+
+WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
+{
+  return WorkflowSpec{adaptAnalysisTask<TrackSelectionRequestService>(cfgc)};
+}
@@ -39,6 +39,8 @@ struct TrackToCollisionAssociation {
   Configurable<bool> includeUnassigned{"includeUnassigned", false, "consider also tracks which are not assigned to any collision"};
   Configurable<bool> fillTableOfCollIdsPerTrack{"fillTableOfCollIdsPerTrack", false, "fill additional table with vector of collision ids per track"};
   Configurable<int> bcWindowForOneSigma{"bcWindowForOneSigma", 60, "BC window to be multiplied by the number of sigmas to define maximum window to be considered"};
+  Configurable<bool> useSweepAssociation{"useSweepAssociation", false, "find time-compatible tracks by binary search in the tracks sorted by time (same output, scales as (N+M) log M in the number of collisions and tracks)"};
+  Configurable<bool> useCompactReverseIndices{"useCompactReverseIndices", false, "store the collisions per track in flat arrays instead of one vector per track (only with fillTableOfCollIdsPerTrack)"};
 
   CollisionAssociation<true> collisionAssociator;
 
@@ -63,6 +65,8 @@ struct TrackToCollisionAssociation {
     collisionAssociator.setIncludeUnassigned(includeUnassigned);
     collisionAssociator.setFillTableOfCollIdsPerTrack(fillTableOfCollIdsPerTrack);
     collisionAssociator.setBcWindow(bcWindowForOneSigma);
+    collisionAssociator.setUseSweepAssociation(useSweepAssociation);
+    collisionAssociator.setUseCompactReverseIndices(useCompactReverseIndices);
   }
 
   void processAssocWithTime(Collisions const& collisions, TracksWithSel const& tracksUnfiltered, TracksWithSelFilter const& tracks, AmbiguousTracks const& ambiguousTracks, BCs const& bcs)
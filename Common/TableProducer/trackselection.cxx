@@ -47,6 +47,7 @@ struct TrackSelectionTask {
   Configurable<float> ptMax{"ptMax", 1e10f, "Upper cut on pt for the track selected"};
   Configurable<float> etaMin{"etaMin", -0.8, "Lower cut on eta for the track selected"};
   Configurable<float> etaMax{"etaMax", 0.8, "Upper cut on eta for the track selected"};
+  Configurable<bool> columnarSelection{"columnarSelection", false, "evaluate the selections cut by cut over the columns of the track variables, filled once per table"};
 
   Produces<aod::TrackSelection> filterTable;
   Produces<aod::TrackSelectionExtension> filterTableDetail;
@@ -58,6 +59,10 @@ struct TrackSelectionTask {
   TrackSelection filtBit4;
   TrackSelection filtBit5;
 
+  // buffers of the columnar selection
+  TrackSelection::TrackColumns trackColumns;
+  std::vector<uint16_t> masksGlob, masksSDD, masksFB1, masksFB2, masksFB3, masksFB4, masksFB5;
+
   void init(InitContext& initContext)
   {
     // Check which tables are used
@@ -137,6 +142,74 @@ struct TrackSelectionTask {
     filtBit5 = getJEGlobalTrackSelectionRun2(); // Jet validation requires reduced set of cuts
   }
 
+  void fillTableDetail(o2::aod::track::TrackSelectionFlags::flagtype trackflagGlob, bool passedITSHitsFB1, bool passedITSHitsFB2)
+  {
+    filterTableDetail(o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kTrackType),
+                      o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kPtRange),
+                      o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kEtaRange),
+                      o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kTPCNCls),
+                      o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kTPCCrossedRows),
+                      o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kTPCCrossedRowsOverNCls),
+                      o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kTPCChi2NDF),
+                      o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kTPCRefit),
+                      o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kITSNCls),
+                      o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kITSChi2NDF),
+                      o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kITSRefit),
+                      o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kITSHits),
+                      o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kGoldenChi2),
+                      o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kDCAxy),
+                      o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kDCAz),
+                      passedITSHitsFB1,
+                      passedITSHitsFB2);
+  }
+
+  /// Same tables as the loop over the tracks in process, with the selections evaluated cut by cut over the columns of the track variables
+  template <typename TTracks>
+  void fillTablesColumnar(TTracks const& tracks)
+  {
+    const size_t nTracks = tracks.size();
+    trackColumns.fill(tracks);
+    auto fillMasks = [&](TrackSelection const& selection, std::vector<uint16_t>& masks) {
+      masks.resize(nTracks);
+      selection.fillSelectionMasks(trackColumns, masks);
+    };
+    auto isSelected = [](uint16_t mask) { return mask == TrackSelection::kAllCutsMask; };
+    fillMasks(globalTracks, masksGlob);
+    if (produceTable == 1) {
+      if (!isRun3) {
+        fillMasks(globalTracksSDD, masksSDD);
+      }
+      fillMasks(filtBit3, masksFB3);
+      fillMasks(filtBit4, masksFB4);
+      fillMasks(filtBit5, masksFB5);
+    }
+    if (produceTable == 1 || (isRun3 && produceFBextendedTable == 1)) {
+      fillMasks(filtBit1, masksFB1);
+      fillMasks(filtBit2, masksFB2);
+    }
+
+    for (size_t i = 0; i < nTracks; i++) {
+      if (produceTable == 1) {
+        filterTable(isRun3 ? (uint8_t)0 : (uint8_t)isSelected(masksSDD[i]),
+                    masksGlob[i],
+                    isSelected(masksFB1[i]),
+                    isSelected(masksFB2[i]),
+                    isSelected(masksFB3[i]),
+                    isSelected(masksFB4[i]),
+                    isSelected(masksFB5[i]));
+      }
+      if (produceFBextendedTable == 1) {
+        if (isRun3) {
+          fillTableDetail(masksGlob[i],
+                          o2::aod::track::TrackSelectionFlags::checkFlag(masksFB1[i], o2::aod::track::TrackSelectionFlags::kITSHits),
+                          o2::aod::track::TrackSelectionFlags::checkFlag(masksFB2[i], o2::aod::track::TrackSelectionFlags::kITSHits));
+        } else {
+          fillTableDetail(masksGlob[i], 0, 0);
+        }
+      }
+    }
+  }
+
   void process(soa::Join<aod::FullTracks, aod::TracksDCA> const& tracks)
   {
     if (produceTable == 1) {
@@ -148,6 +221,10 @@ struct TrackSelectionTask {
     if (produceTable == 0 && produceFBextendedTable == 0) {
       return;
     }
+    if (columnarSelection) {
+      fillTablesColumnar(tracks);
+      return;
+    }
     if (isRun3) {
       for (auto& track : tracks) {
 
@@ -168,23 +245,9 @@ struct TrackSelectionTask {
           // o2::aod::track::TrackSelectionFlags::flagtype trackflagFB4 = filtBit4.IsSelectedMask(track);
           // o2::aod::track::TrackSelectionFlags::flagtype trackflagFB5 = filtBit5.IsSelectedMask(track);
 
-          filterTableDetail(o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kTrackType),
-                            o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kPtRange),
-                            o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kEtaRange),
-                            o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kTPCNCls),
-                            o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kTPCCrossedRows),
-                            o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kTPCCrossedRowsOverNCls),
-                            o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kTPCChi2NDF),
-                            o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kTPCRefit),
-                            o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kITSNCls),
-                            o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kITSChi2NDF),
-                            o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kITSRefit),
-                            o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kITSHits),
-                            o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kGoldenChi2),
-                            o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kDCAxy),
-                            o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kDCAz),
-                            o2::aod::track::TrackSelectionFlags::checkFlag(trackflagFB1, o2::aod::track::TrackSelectionFlags::kITSHits),
-                            o2::aod::track::TrackSelectionFlags::checkFlag(trackflagFB2, o2::aod::track::TrackSelectionFlags::kITSHits));
+          fillTableDetail(trackflagGlob,
+                          o2::aod::track::TrackSelectionFlags::checkFlag(trackflagFB1, o2::aod::track::TrackSelectionFlags::kITSHits),
+                          o2::aod::track::TrackSelectionFlags::checkFlag(trackflagFB2, o2::aod::track::TrackSelectionFlags::kITSHits));
         }
       }
       return;
@@ -202,23 +265,7 @@ struct TrackSelectionTask {
                     filtBit5.IsSelected(track));
       }
       if (produceFBextendedTable == 1) {
-        filterTableDetail(o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kTrackType),
-                          o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kPtRange),
-                          o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kEtaRange),
-                          o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kTPCNCls),
-                          o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kTPCCrossedRows),
-                          o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kTPCCrossedRowsOverNCls),
-                          o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kTPCChi2NDF),
-                          o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kTPCRefit),
-                          o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kITSNCls),
-                          o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kITSChi2NDF),
-                          o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kITSRefit),
-                          o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kITSHits),
-                          o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kGoldenChi2),
-                          o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kDCAxy),
-                          o2::aod::track::TrackSelectionFlags::checkFlag(trackflagGlob, o2::aod::track::TrackSelectionFlags::kDCAz),
-                          0,
-                          0);
+        fillTableDetail(trackflagGlob, 0, 0);
       }
     }
   }
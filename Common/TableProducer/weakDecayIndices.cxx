@@ -11,12 +11,16 @@
 #include "Framework/runDataProcessing.h"
 #include "Framework/AnalysisTask.h"
 #include "Framework/AnalysisDataModel.h"
+#include "Common/DataModel/WeakDecayIndices.h"
+
+#include <vector>
 
 using namespace o2;
 using namespace o2::framework;
 
 // Converts V0 and cascade version 000 to 001
 // Build indices to group V0s and cascades to collisions
+// Optionally builds the reverse indices from the tracks to the V0s and cascades they belong to
 
 struct WeakDecayIndicesV0 {
   Produces<aod::V0s_001> v0s_001;
@@ -48,10 +52,74 @@ struct WeakDecayIndicesCascades {
   }
 };
 
+// Reverse indices in compressed sparse row form, filled with a counting sort
+// Replaces the searches over all the V0s (cascades) for those sharing a given daughter track.
+struct WeakDecayIndicesTracks {
+  Produces<aod::TrackWeakDecays> trackWeakDecays;
+  Produces<aod::V0sOfTracks> v0sOfTracks;
+  Produces<aod::CascadesOfTracks> cascadesOfTracks;
+
+  std::vector<int> offsets;
+  std::vector<int> cursors;
+  std::vector<int> entries;
+
+  // Counts the entries per track, turns the counts into offsets and places the entries at the offsets of their tracks
+  // getTracks(element, addTrack) calls addTrack(trackId) for each track of the element
+  template <typename TElements, typename TGetTracks>
+  void buildIndex(int nTracks, TElements const& elements, TGetTracks const& getTracks)
+  {
+    offsets.assign(nTracks + 1, 0);
+    for (auto const& element : elements) {
+      getTracks(element, [&](int trackId) { offsets[trackId + 1]++; });
+    }
+    for (int iTrack = 0; iTrack < nTracks; iTrack++) {
+      offsets[iTrack + 1] += offsets[iTrack];
+    }
+    cursors.assign(offsets.begin(), offsets.end() - 1);
+    entries.resize(offsets[nTracks]);
+    for (auto const& element : elements) {
+      const int elementId = element.globalIndex();
+      getTracks(element, [&](int trackId) { entries[cursors[trackId]++] = elementId; });
+    }
+  }
+
+  void processTrackIndices(aod::Tracks const& tracks, aod::V0s const& v0s, aod::Cascades const& cascades)
+  {
+    const int nTracks = tracks.size();
+
+    buildIndex(nTracks, v0s, [](auto const& v0, auto const& addTrack) {
+      addTrack(v0.posTrackId());
+      addTrack(v0.negTrackId());
+    });
+    std::vector<int> offsetsV0s = offsets;
+    v0sOfTracks.reserve(entries.size());
+    for (const auto& v0Id : entries) {
+      v0sOfTracks(v0Id);
+    }
+
+    buildIndex(nTracks, cascades, [](auto const& cascade, auto const& addTrack) {
+      addTrack(cascade.bachelorId());
+      addTrack(cascade.v0().posTrackId());
+      addTrack(cascade.v0().negTrackId());
+    });
+    cascadesOfTracks.reserve(entries.size());
+    for (const auto& cascadeId : entries) {
+      cascadesOfTracks(cascadeId);
+    }
+
+    trackWeakDecays.reserve(nTracks);
+    for (int iTrack = 0; iTrack < nTracks; iTrack++) {
+      trackWeakDecays(offsetsV0s[iTrack], offsetsV0s[iTrack + 1] - offsetsV0s[iTrack], offsets[iTrack], offsets[iTrack + 1] - offsets[iTrack]);
+    }
+  }
+  PROCESS_SWITCH(WeakDecayIndicesTracks, processTrackIndices, "Build the reverse indices from the tracks to the V0s and cascades", false);
+};
+
 WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
 {
   return WorkflowSpec{
     adaptAnalysisTask<WeakDecayIndicesV0>(cfgc),
     adaptAnalysisTask<WeakDecayIndicesCascades>(cfgc),
+    adaptAnalysisTask<WeakDecayIndicesTracks>(cfgc),
   };
 }
@@ -25,6 +25,8 @@
  *
  **********************************************/
 
+#include <algorithm>
+#include <thread>
 #include "multGlauberNBDFitter.h"
 #include "TList.h"
 #include "TFile.h"
@@ -56,7 +58,14 @@ multGlauberNBDFitter::multGlauberNBDFitter() : TNamed(),
                                                ff(0.8),
                                                fnorm(100),
                                                fFitOptions("R0"),
-                                               fFitNpx(5000)
+                                               fFitNpx(5000),
+                                               fCachedMu(0),
+                                               fCachedk(0),
+                                               fCacheddMu(0),
+                                               fUseBinCache(kTRUE),
+                                               fNThreads(1),
+                                               fBinCacheValid(kFALSE),
+                                               fBinCacheFirst(0)
 {
   // Constructor
   fNpart = new Double_t[fMaxNpNcPairs];
@@ -103,7 +112,14 @@ multGlauberNBDFitter::multGlauberNBDFitter(const char* name, const char* title)
                                                                                   ff(0.8),
                                                                                   fnorm(100),
                                                                                   fFitOptions("R0"),
-                                                                                  fFitNpx(5000)
+                                                                                  fFitNpx(5000),
+                                                                                  fCachedMu(0),
+                                                                                  fCachedk(0),
+                                                                                  fCacheddMu(0),
+                                                                                  fUseBinCache(kTRUE),
+                                                                                  fNThreads(1),
+                                                                                  fBinCacheValid(kFALSE),
+                                                                                  fBinCacheFirst(0)
 {
   //Named constructor
   fNpart = new Double_t[fMaxNpNcPairs];
@@ -161,57 +177,162 @@ Double_t multGlauberNBDFitter::ProbDistrib(Double_t* x, Double_t* par)
 {
   Double_t lMultValue = x[0];
   Double_t lProbability = 0.0;
+
+  //______________________________________________________
+  //Recalculate the ancestor distribution in case f changed
+  if (!UpdateAncestorDistribution(par[2]))
+    return 0;
+
+  //______________________________________________________
+  //Actually evaluate function
+  if (fAncestorMode != 2) {
+    for (size_t iNanc = 0; iNanc < fAncValue.size(); iNanc++) {
+      Double_t lNancestors = fAncValue[iNanc];
+      // allow for variable mu in case requested
+      Double_t lThisMu = lNancestors * (par[0] + par[4] * lNancestors);
+      Double_t lThisk = lNancestors * par[1];
+      Double_t lpval = TMath::Power(1.0 + lThisMu / lThisk, -1);
+      fNBD->SetParameter(1, lThisk);
+      fNBD->SetParameter(0, lpval);
+      Double_t lMult = 0.0;
+      if (lMultValue > 1e-6)
+        lMult = fNBD->Eval(lMultValue);
+      lProbability += fAncWeight[iNanc] * lMult;
+    }
+    return par[3] * lProbability;
+  }
+
+  //Analytical continuation: the fit evaluates all bins with the same parameters,
+  //so they are evaluated at once when the parameters change
+  if (UpdateNBDTerms(par))
+    fBinCacheValid = kFALSE;
+  if (fUseBinCache && fhV0M) {
+    if (!fBinCacheValid)
+      EvaluateAtBinCenters();
+    Int_t lBin = fhV0M->FindBin(lMultValue);
+    Int_t lIndex = lBin - fBinCacheFirst;
+    if (lIndex >= 0 && lIndex < static_cast<Int_t>(fBinCache.size()) && lMultValue == fhV0M->GetBinCenter(lBin))
+      return par[3] * fBinCache[lIndex];
+  }
+  return par[3] * EvaluateNBDSum(lMultValue);
+}
+
+//______________________________________________________
+Bool_t multGlauberNBDFitter::UpdateAncestorDistribution(Double_t lf)
+{
   ffChanged = kTRUE;
   const Double_t lAlmost0 = 1.e-13;
   //Comment this line in order to make the code evaluate Nancestor all the time
-  if (TMath::Abs(fCurrentf - par[2]) < lAlmost0)
+  if (TMath::Abs(fCurrentf - lf) < lAlmost0)
     ffChanged = kFALSE;
+  if (!ffChanged)
+    return !fAncValue.empty();
 
-  //______________________________________________________
-  //Recalculate the ancestor distribution in case f changed
-  if (ffChanged) {
-    fCurrentf = par[2];
-    fhNanc->Reset();
-
-    for (int ibin = 0; ibin < fNNpNcPairs; ibin++) {
-      Double_t lOption0 = (Int_t)(fNpart[ibin] * par[2] + fNcoll[ibin] * (1.0 - par[2]));
-      Double_t lOption1 = TMath::Floor(fNpart[ibin] * par[2] + fNcoll[ibin] * (1.0 - par[2]) + 0.5);
-      Double_t lOption2 = (fNpart[ibin] * par[2] + fNcoll[ibin] * (1.0 - par[2]));
-      if (fAncestorMode == 0)
-        fhNanc->Fill(lOption0, fContent[ibin]);
-      if (fAncestorMode == 1)
-        fhNanc->Fill(lOption1, fContent[ibin]);
-      if (fAncestorMode == 2)
-        fhNanc->Fill(lOption2, fContent[ibin]);
-    }
-    if (fhNanc->Integral() < 1) {
-      cout << "ERROR: ANCESTOR HISTOGRAM EMPTY" << endl;
-      cout << "Will not do anything. Call InitializeNpNc if you want to plot without fitting" << endl;
-      return 0;
-    }
-    fhNanc->Scale(1. / fhNanc->Integral());
+  fCurrentf = lf;
+  fhNanc->Reset();
+  fAncValue.clear();
+  fAncWeight.clear();
+  fAncLnGammak.clear(); //NBD terms to be recalculated
+  fBinCacheValid = kFALSE;
+
+  for (int ibin = 0; ibin < fNNpNcPairs; ibin++) {
+    Double_t lOption0 = (Int_t)(fNpart[ibin] * lf + fNcoll[ibin] * (1.0 - lf));
+    Double_t lOption1 = TMath::Floor(fNpart[ibin] * lf + fNcoll[ibin] * (1.0 - lf) + 0.5);
+    Double_t lOption2 = (fNpart[ibin] * lf + fNcoll[ibin] * (1.0 - lf));
+    if (fAncestorMode == 0)
+      fhNanc->Fill(lOption0, fContent[ibin]);
+    if (fAncestorMode == 1)
+      fhNanc->Fill(lOption1, fContent[ibin]);
+    if (fAncestorMode == 2)
+      fhNanc->Fill(lOption2, fContent[ibin]);
   }
-  //______________________________________________________
-  //Actually evaluate function
+  if (fhNanc->Integral() < 1) {
+    cout << "ERROR: ANCESTOR HISTOGRAM EMPTY" << endl;
+    cout << "Will not do anything. Call InitializeNpNc if you want to plot without fitting" << endl;
+    return kFALSE;
+  }
+  fhNanc->Scale(1. / fhNanc->Integral());
+
+  //Keep the non-empty bins with a positive number of ancestors
   Int_t lStartBin = fhNanc->FindBin(0.0) + 1;
   for (Long_t iNanc = lStartBin; iNanc < fhNanc->GetNbinsX() + 1; iNanc++) {
-    Double_t lNancestors = fhNanc->GetBinCenter(iNanc);
     Double_t lNancestorCount = fhNanc->GetBinContent(iNanc);
-    //if(lNancestorCount<1e-12&&lNancestors>10) break;
+    if (lNancestorCount == 0)
+      continue;
+    fAncValue.push_back(fhNanc->GetBinCenter(iNanc));
+    fAncWeight.push_back(lNancestorCount);
+  }
+  return kTRUE;
+}
 
+//______________________________________________________
+Bool_t multGlauberNBDFitter::UpdateNBDTerms(const Double_t* par)
+{
+  if (fAncLnGammak.size() == fAncValue.size() && par[0] == fCachedMu && par[1] == fCachedk && par[4] == fCacheddMu)
+    return kFALSE;
+  fCachedMu = par[0];
+  fCachedk = par[1];
+  fCacheddMu = par[4];
+
+  const size_t lNAnc = fAncValue.size();
+  fAnck.resize(lNAnc);
+  fAncLnGammak.resize(lNAnc);
+  fAncLogRatio.resize(lNAnc);
+  fAncLog1pRatio.resize(lNAnc);
+  for (size_t iNanc = 0; iNanc < lNAnc; iNanc++) {
+    Double_t lNancestors = fAncValue[iNanc];
     // allow for variable mu in case requested
-    Double_t lThisMu = (((Double_t)lNancestors)) * (par[0] + par[4] * lNancestors);
-    Double_t lThisk = (((Double_t)lNancestors)) * par[1];
-    Double_t lpval = TMath::Power(1.0 + lThisMu / lThisk, -1);
-    fNBD->SetParameter(1, lThisk);
-    fNBD->SetParameter(0, lpval);
-    Double_t lMult = 0.0;
-    if (lMultValue > 1e-6)
-      lMult = fAncestorMode != 2 ? fNBD->Eval(lMultValue) : ContinuousNBD(lMultValue, lThisMu, lThisk);
-    lProbability += lNancestorCount * lMult;
+    Double_t lThisMu = lNancestors * (par[0] + par[4] * lNancestors);
+    Double_t lThisk = lNancestors * par[1];
+    fAnck[iNanc] = lThisk;
+    fAncLnGammak[iNanc] = TMath::LnGamma(lThisk);
+    fAncLogRatio[iNanc] = TMath::Log(lThisMu / lThisk);
+    fAncLog1pRatio[iNanc] = TMath::Log(1.0 + lThisMu / lThisk);
   }
-  //______________________________________________________
-  return par[3] * lProbability;
+  return kTRUE;
+}
+
+//______________________________________________________
+Double_t multGlauberNBDFitter::EvaluateNBDSum(Double_t lMultValue) const
+{
+  //Sum over ancestors of ContinuousNBD(n, mu, k), always with the log method:
+  //only lgamma(n+k) depends on both n and the ancestor bin
+  if (lMultValue <= 1e-6)
+    return 0.0;
+  const Double_t lLnGamman1 = TMath::LnGamma(lMultValue + 1.);
+  Double_t lProbability = 0.0;
+  for (size_t iNanc = 0; iNanc < fAncValue.size(); iNanc++) {
+    const Double_t lThisk = fAnck[iNanc];
+    Double_t lLogNBD = TMath::LnGamma(lMultValue + lThisk) - lLnGamman1 - fAncLnGammak[iNanc];
+    lLogNBD += lMultValue * fAncLogRatio[iNanc] - (lMultValue + lThisk) * fAncLog1pRatio[iNanc];
+    lProbability += fAncWeight[iNanc] * TMath::Exp(lLogNBD);
+  }
+  return lProbability;
+}
+
+//______________________________________________________
+void multGlauberNBDFitter::EvaluateAtBinCenters()
+{
+  //All bins of the input histogram in the fit range, split in contiguous chunks across threads
+  Double_t lLoRange, lHiRange;
+  fGlauberNBD->GetRange(lLoRange, lHiRange);
+  fBinCacheFirst = std::max(fhV0M->FindBin(lLoRange), 1);
+  Int_t lLastBin = std::min(fhV0M->FindBin(lHiRange), fhV0M->GetNbinsX());
+  const Int_t lNBins = std::max(lLastBin - fBinCacheFirst + 1, 0);
+  fBinCache.assign(lNBins, 0.0);
+
+  const Int_t lNThreads = std::max(1, std::min(fNThreads, lNBins));
+  auto lEvaluate = [this, lNBins, lNThreads](Int_t iThread) {
+    for (Int_t iBin = iThread * lNBins / lNThreads; iBin < (iThread + 1) * lNBins / lNThreads; iBin++)
+      fBinCache[iBin] = EvaluateNBDSum(fhV0M->GetBinCenter(fBinCacheFirst + iBin));
+  };
+  std::vector<std::thread> lThreads;
+  for (Int_t iThread = 1; iThread < lNThreads; iThread++)
+    lThreads.emplace_back(lEvaluate, iThread);
+  lEvaluate(0);
+  for (auto& lThread : lThreads)
+    lThread.join();
+  fBinCacheValid = kTRUE;
 }
 
 //________________________________________________________________
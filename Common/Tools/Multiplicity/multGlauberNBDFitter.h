@@ -13,6 +13,7 @@
 #define MULTGLAUBERNBDFITTER_H
 
 #include <iostream>
+#include <vector>
 #include "TNamed.h"
 #include "TF1.h"
 #include "TH1.h"
@@ -71,6 +72,12 @@ class multGlauberNBDFitter : public TNamed
   void SetFitOptions(TString lOpt);
   void SetFitNpx(Long_t lNpx);
 
+  //Evaluation of the fit function at all bin centers of the input histogram at once
+  //when the parameters change, optionally split across threads
+  void SetUseBinCache(Bool_t lUseBinCache = kTRUE) { fUseBinCache = lUseBinCache; }
+  void SetNThreads(Int_t lNThreads) { fNThreads = lNThreads; }
+  Int_t GetNThreads() { return fNThreads; }
+
   //For ancestor mode 2
   Double_t ContinuousNBD(Double_t n, Double_t mu, Double_t k);
 
@@ -80,6 +87,12 @@ class multGlauberNBDFitter : public TNamed
   //void    Print(Option_t *option="") const;
 
  private:
+  //Helpers for the evaluation of the fit function
+  Bool_t UpdateAncestorDistribution(Double_t lf);
+  Bool_t UpdateNBDTerms(const Double_t* par);
+  Double_t EvaluateNBDSum(Double_t lMultValue) const;
+  void EvaluateAtBinCenters();
+
   //This function serves as the (analytical) NBD
   TF1* fNBD;
 
@@ -115,6 +128,25 @@ class multGlauberNBDFitter : public TNamed
   TString fFitOptions;
   Long_t fFitNpx;
 
-  ClassDef(multGlauberNBDFitter, 1);
+  //Non-empty bins of the ancestor distribution and their NBD terms
+  //for the current parameters: lgamma(k), log(mu/k), log(1+mu/k)
+  std::vector<Double_t> fAncValue;      //!
+  std::vector<Double_t> fAncWeight;     //!
+  std::vector<Double_t> fAnck;          //!
+  std::vector<Double_t> fAncLnGammak;   //!
+  std::vector<Double_t> fAncLogRatio;   //!
+  std::vector<Double_t> fAncLog1pRatio; //!
+  Double_t fCachedMu;                   //!
+  Double_t fCachedk;                    //!
+  Double_t fCacheddMu;                  //!
+
+  //Fit function at the bin centers of the input histogram within the fit range
+  Bool_t fUseBinCache;
+  Int_t fNThreads;
+  Bool_t fBinCacheValid;           //!
+  Int_t fBinCacheFirst;            //!
+  std::vector<Double_t> fBinCache; //!
+
+  ClassDef(multGlauberNBDFitter, 2);
 };
 #endif
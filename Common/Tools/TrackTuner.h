@@ -55,6 +55,65 @@ DECLARE_SOA_TABLE(TrackTunerTable, "AOD", "TRACKTUNERTABLE", //!
                   track_tuner::TunedQOverPt);
 } // namespace o2::aod
 
+/// Linear interpolation of a graph giving the same result as TGraph::Eval,
+/// with the points sorted once and found with a binary search instead of a loop over all the points per call
+struct GraphInterpolator {
+  std::vector<double> xs; // sorted abscissas
+  std::vector<double> ys;
+  double xFirst = 0.; // abscissas of the first and last points of the graph, limiting the evaluation as in TrackTuner::evalGraph
+  double xLast = 0.;
+
+  void build(const TGraph* graph)
+  {
+    xs.clear();
+    ys.clear();
+    if (!graph || graph->GetN() == 0) {
+      return;
+    }
+    const int nPoints = graph->GetN();
+    xFirst = graph->GetX()[0];
+    xLast = graph->GetX()[nPoints - 1];
+    std::vector<int> order(nPoints);
+    for (int i = 0; i < nPoints; i++) {
+      order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [graph](int a, int b) { return graph->GetX()[a] < graph->GetX()[b]; });
+    for (const auto i : order) {
+      xs.push_back(graph->GetX()[i]);
+      ys.push_back(graph->GetY()[i]);
+    }
+  }
+
+  /// Value at x, limited to the range of the graph
+  double eval(double x) const
+  {
+    if (xs.empty()) {
+      return 0.;
+    }
+    if (xs.size() == 1) {
+      return ys[0];
+    }
+    x = std::clamp(x, std::min(xFirst, xLast), std::max(xFirst, xLast));
+    size_t iUp = std::lower_bound(xs.begin(), xs.end(), x) - xs.begin();
+    if (iUp < xs.size() && xs[iUp] == x) {
+      return ys[iUp]; // no interpolation needed
+    }
+    size_t iLow = 0;
+    if (iUp == 0) {
+      iUp = 1;
+    } else if (iUp == xs.size()) {
+      iUp = xs.size() - 1;
+      iLow = iUp - 1;
+    } else {
+      iLow = std::lower_bound(xs.begin(), xs.end(), xs[iUp - 1]) - xs.begin(); // first of equal abscissas, as TGraph::Eval
+    }
+    if (xs[iLow] == xs[iUp]) {
+      return ys[iLow];
+    }
+    return ys[iUp] + (x - xs[iUp]) * (ys[iLow] - ys[iUp]) / (xs[iLow] - xs[iUp]);
+  }
+};
+
 struct TrackTuner {
   ///////////////////////////////
   /// parameters to be configured
@@ -98,6 +157,20 @@ struct TrackTuner {
   std::unique_ptr<TGraphErrors> grDcaZPullVsPtPionMC;
   std::unique_ptr<TGraphErrors> grDcaZPullVsPtPionData;
 
+  // interpolations of the graphs above, used per track
+  GraphInterpolator interpDcaXYResVsPtPionMC;
+  GraphInterpolator interpDcaXYResVsPtPionData;
+  GraphInterpolator interpDcaZResVsPtPionMC;
+  GraphInterpolator interpDcaZResVsPtPionData;
+  GraphInterpolator interpDcaXYMeanVsPtPionMC;
+  GraphInterpolator interpDcaXYMeanVsPtPionData;
+  GraphInterpolator interpOneOverPtPionMC;
+  GraphInterpolator interpOneOverPtPionData;
+  GraphInterpolator interpDcaXYPullVsPtPionMC;
+  GraphInterpolator interpDcaXYPullVsPtPionData;
+  GraphInterpolator interpDcaZPullVsPtPionMC;
+  GraphInterpolator interpDcaZPullVsPtPionData;
+
   /// @brief Function to configure the TrackTuner parameters
   /// @param inputString Input string with all parameter configuration. Format: <name>=<value>|<name>=<value>
   /// @return String with the values of all parameters after configurations are listed, to cross check that everything worked well
@@ -391,6 +464,19 @@ struct TrackTuner {
       grOneOverPtPionMC.reset(dynamic_cast<TGraphErrors*>(inputFileQoverPt->Get(grOneOverPtPionNameMC.c_str())));
       grOneOverPtPionData.reset(dynamic_cast<TGraphErrors*>(inputFileQoverPt->Get(grOneOverPtPionNameData.c_str())));
     }
+
+    interpDcaXYResVsPtPionMC.build(grDcaXYResVsPtPionMC.get());
+    interpDcaXYResVsPtPionData.build(grDcaXYResVsPtPionData.get());
+    interpDcaZResVsPtPionMC.build(grDcaZResVsPtPionMC.get());
+    interpDcaZResVsPtPionData.build(grDcaZResVsPtPionData.get());
+    interpDcaXYMeanVsPtPionMC.build(grDcaXYMeanVsPtPionMC.get());
+    interpDcaXYMeanVsPtPionData.build(grDcaXYMeanVsPtPionData.get());
+    interpOneOverPtPionMC.build(grOneOverPtPionMC.get());
+    interpOneOverPtPionData.build(grOneOverPtPionData.get());
+    interpDcaXYPullVsPtPionMC.build(grDcaXYPullVsPtPionMC.get());
+    interpDcaXYPullVsPtPionData.build(grDcaXYPullVsPtPionData.get());
+    interpDcaZPullVsPtPionMC.build(grDcaZPullVsPtPionMC.get());
+    interpDcaZPullVsPtPionData.build(grDcaZPullVsPtPionData.get());
   } // getDcaGraphs() ends here
 
   template <typename T1, typename T2, typename T3, typename T4, typename H>
@@ -412,11 +498,11 @@ struct TrackTuner {
     double dcaZPullMC = 1.0;
     double dcaZPullData = 1.0;
 
-    dcaXYResMC = evalGraph(ptMC, grDcaXYResVsPtPionMC.get());
-    dcaXYResData = evalGraph(ptMC, grDcaXYResVsPtPionData.get());
+    dcaXYResMC = interpDcaXYResVsPtPionMC.eval(ptMC);
+    dcaXYResData = interpDcaXYResVsPtPionData.eval(ptMC);
 
-    dcaZResMC = evalGraph(ptMC, grDcaZResVsPtPionMC.get());
-    dcaZResData = evalGraph(ptMC, grDcaZResVsPtPionData.get());
+    dcaZResMC = interpDcaZResVsPtPionMC.eval(ptMC);
+    dcaZResData = interpDcaZResVsPtPionData.eval(ptMC);
 
     // For Q/Pt corrections, files on CCDB will be used if both qOverPtMC and qOverPtData are null
     if (updateCurvature || updateCurvatureIU) {
@@ -428,20 +514,20 @@ struct TrackTuner {
         if (!grOneOverPtPionData.get() || !grOneOverPtPionMC.get()) {
           LOG(fatal) << "### q/pt smearing: input graphs not correctly retrieved. Aborting.";
         }
-        qOverPtMC = std::max(0.0, evalGraph(ptMC, grOneOverPtPionMC.get()));
-        qOverPtData = std::max(0.0, evalGraph(ptMC, grOneOverPtPionData.get()));
+        qOverPtMC = std::max(0.0, interpOneOverPtPionMC.eval(ptMC));
+        qOverPtData = std::max(0.0, interpOneOverPtPionData.eval(ptMC));
       } // qOverPtMC, qOverPtData block ends here
     }   // updateCurvature, updateCurvatureIU block ends here
 
     if (updateTrackDCAs) {
-      dcaXYMeanMC = evalGraph(ptMC, grDcaXYMeanVsPtPionMC.get());
-      dcaXYMeanData = evalGraph(ptMC, grDcaXYMeanVsPtPionData.get());
+      dcaXYMeanMC = interpDcaXYMeanVsPtPionMC.eval(ptMC);
+      dcaXYMeanData = interpDcaXYMeanVsPtPionData.eval(ptMC);
 
-      dcaXYPullMC = evalGraph(ptMC, grDcaXYPullVsPtPionMC.get());
-      dcaXYPullData = evalGraph(ptMC, grDcaXYPullVsPtPionData.get());
+      dcaXYPullMC = interpDcaXYPullVsPtPionMC.eval(ptMC);
+      dcaXYPullData = interpDcaXYPullVsPtPionData.eval(ptMC);
 
-      dcaZPullMC = evalGraph(ptMC, grDcaZPullVsPtPionMC.get());
-      dcaZPullData = evalGraph(ptMC, grDcaZPullVsPtPionData.get());
+      dcaZPullMC = interpDcaZPullVsPtPionMC.eval(ptMC);
+      dcaZPullData = interpDcaZPullVsPtPionData.eval(ptMC);
     }
     //  Unit conversion, is it required ??
     dcaXYResMC *= 1.e-4;
@@ -0,0 +1,414 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+//
+// Throughput benchmark of the per-track and per-collision work of the always-on Common producers on synthetic dataframes.
+// A dataframe of pp or Pb-Pb collisions is generated in memory, with realistic multiplicities and track properties,
+// and the helpers called by the producers (track propagation to the vertex, track selection, TPC and TOF PID,
+// multiplicity counters and centrality calibration) are run over it as in the process functions of the tasks.
+// The throughput (collisions/s, tracks/s) and the number of heap allocations per collision are reported per producer.
+// The propagation is the helix DCA in the nominal field (fast path of trackPropagation): the propagation with material
+// corrections needs the geometry and the material LUT from the CCDB. The event selection is not covered, its
+// per-BC logic lives in the task and depends on the CCDB parameters of the run.
+// Usage: o2-benchmark-common-producers [minimal time per benchmark in seconds, default 0.5]
+//
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "TH1F.h"
+
+#include "ReconstructionDataFormats/DCA.h"
+#include "ReconstructionDataFormats/Track.h"
+#include "ReconstructionDataFormats/Vertex.h"
+
+#include "Common/Core/PID/PIDTOF.h"
+#include "Common/Core/PID/TPCPIDResponse.h"
+#include "Common/Core/TrackSelection.h"
+#include "Common/Core/TrackSelectionDefaults.h"
+
+namespace
+{
+constexpr float kBz = 5.f;          // nominal field (kG)
+constexpr float kXInnermost = 2.3f; // reference X of the tracks at the innermost update (cm)
+constexpr int kNChannelsFT0A = 96;
+constexpr int kNChannelsFT0C = 112;
+
+volatile double gSink = 0.;         // keeps the results of the helpers alive
+std::atomic<long> gNAllocations{0}; // heap allocations, counted by the replaced operator new
+} // namespace
+
+void* operator new(std::size_t size)
+{
+  ++gNAllocations;
+  if (void* pointer = std::malloc(size > 0 ? size : 1)) {
+    return pointer;
+  }
+  throw std::bad_alloc();
+}
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { std::free(pointer); }
+
+namespace
+{
+//_________________________________________________________________________
+// Track with the getters of the joined track tables used by the helpers
+struct SyntheticTrack {
+  float fX, fAlpha, fY, fZ, fSnp, fTgl, fSigned1Pt; // parameters at the innermost update
+  uint8_t fTrackType = o2::aod::track::Track;
+  uint32_t fFlags = 0;
+  bool fHasITS = false, fHasTPC = false, fHasTOF = false;
+  uint8_t fItsClusterMap = 0;
+  float fItsChi2NCl = 0.f;
+  int16_t fTpcNClsFound = 0, fTpcNClsCrossedRows = 0;
+  float fTpcCrossedRowsOverFindableCls = 0.f, fTpcChi2NCl = 0.f;
+  float fTpcInnerParam = 0.f, fTpcSignal = 0.f;
+  float fLength = 0.f, fTofExpMom = 0.f, fTofSignal = 0.f, fTofEvTime = 0.f, fTofEvTimeErr = 0.f;
+  float fDcaXY = 0.f, fDcaZ = 0.f;
+
+  uint8_t trackType() const { return fTrackType; }
+  uint32_t flags() const { return fFlags; }
+  float pt() const { return std::abs(1.f / fSigned1Pt); }
+  float p() const { return pt() * std::sqrt(1.f + fTgl * fTgl); }
+  float eta() const { return std::asinh(fTgl); }
+  float tgl() const { return fTgl; }
+  float signed1Pt() const { return fSigned1Pt; }
+  int16_t sign() const { return fSigned1Pt > 0 ? 1 : -1; }
+  bool hasITS() const { return fHasITS; }
+  bool hasTPC() const { return fHasTPC; }
+  bool hasTOF() const { return fHasTOF; }
+  bool hasTRD() const { return false; }
+  uint8_t itsClusterMap() const { return fItsClusterMap; }
+  uint8_t itsNCls() const { return __builtin_popcount(fItsClusterMap); }
+  float itsChi2NCl() const { return fItsChi2NCl; }
+  int16_t tpcNClsFound() const { return fTpcNClsFound; }
+  int16_t tpcNClsCrossedRows() const { return fTpcNClsCrossedRows; }
+  float tpcCrossedRowsOverFindableCls() const { return fTpcCrossedRowsOverFindableCls; }
+  float tpcChi2NCl() const { return fTpcChi2NCl; }
+  float tpcInnerParam() const { return fTpcInnerParam; }
+  float tpcSignal() const { return fTpcSignal; }
+  float length() const { return fLength; }
+  float tofExpMom() const { return fTofExpMom; }
+  float tofSignal() const { return fTofSignal; }
+  float tofEvTime() const { return fTofEvTime; }
+  float tofEvTimeErr() const { return fTofEvTimeErr; }
+  float dcaXY() const { return fDcaXY; }
+  float dcaZ() const { return fDcaZ; }
+
+  o2::track::TrackPar getTrackPar() const { return {fX, fAlpha, {fY, fZ, fSnp, fTgl, fSigned1Pt}}; }
+  o2::track::TrackParCov getTrackParCov() const
+  {
+    return {fX, fAlpha, {fY, fZ, fSnp, fTgl, fSigned1Pt}, {1.e-5f, 0.f, 1.e-5f, 0.f, 0.f, 1.e-6f, 0.f, 0.f, 0.f, 1.e-6f, 0.f, 0.f, 0.f, 0.f, 1.e-4f}};
+  }
+};
+
+// Collision with its tracks and FT0 amplitudes
+struct SyntheticCollision {
+  float fPosX, fPosY, fPosZ;
+  int fFirstTrack, fNTracks;
+  std::vector<float> fAmplitudeA, fAmplitudeC;
+
+  float posX() const { return fPosX; }
+  float posY() const { return fPosY; }
+  float posZ() const { return fPosZ; }
+  float multTPC() const { return fNTracks; }
+};
+
+struct SyntheticDataframe {
+  std::vector<SyntheticCollision> fCollisions;
+  std::vector<SyntheticTrack> fTracks;
+};
+
+//_________________________________________________________________________
+class SyntheticGenerator
+{
+ public:
+  explicit SyntheticGenerator(unsigned int seed) : fEngine(seed) {}
+
+  float Uniform(float min, float max) { return std::uniform_real_distribution<float>(min, max)(fEngine); }
+  float Gaus(float mean, float sigma) { return std::normal_distribution<float>(mean, sigma)(fEngine); }
+
+  // Dataframe of collisions, with the charged-particle multiplicities of minimum-bias pp (negative binomial-like)
+  // or Pb-Pb (uniform impact parameter squared) collisions
+  SyntheticDataframe Dataframe(int nCollisions, bool isPbPb)
+  {
+    SyntheticDataframe dataframe;
+    for (int iCollision = 0; iCollision < nCollisions; ++iCollision) {
+      int nTracks = isPbPb ? static_cast<int>(4000.f * std::pow(1.f - Uniform(0.f, 1.f), 2.f)) + 2 : static_cast<int>(std::gamma_distribution<float>(1.2f, 15.f)(fEngine)) + 2;
+      SyntheticCollision collision{Gaus(0.f, 0.005f), Gaus(0.f, 0.005f), Gaus(0.f, 5.f), static_cast<int>(dataframe.fTracks.size()), nTracks, {}, {}};
+      for (int iChannel = 0; iChannel < kNChannelsFT0A; ++iChannel) {
+        collision.fAmplitudeA.push_back(std::exponential_distribution<float>(1.f)(fEngine) * nTracks / 20.f);
+      }
+      for (int iChannel = 0; iChannel < kNChannelsFT0C; ++iChannel) {
+        collision.fAmplitudeC.push_back(std::exponential_distribution<float>(1.f)(fEngine) * nTracks / 20.f);
+      }
+      const float evTimeErr = isPbPb ? 5.f : 30.f;
+      const float evTime = Gaus(0.f, evTimeErr);
+      for (int iTrack = 0; iTrack < nTracks; ++iTrack) {
+        dataframe.fTracks.push_back(Track(collision, evTime, evTimeErr));
+      }
+      dataframe.fCollisions.push_back(std::move(collision));
+    }
+    return dataframe;
+  }
+
+ private:
+  // Track from the vertex of the collision, with a pion/kaon/proton mixture and the PID signals of its species
+  SyntheticTrack Track(const SyntheticCollision& collision, float evTime, float evTimeErr)
+  {
+    SyntheticTrack track;
+    const float species = Uniform(0.f, 1.f);
+    const auto id = species < 0.8f ? o2::track::PID::Pion : (species < 0.92f ? o2::track::PID::Kaon : o2::track::PID::Proton);
+    const float mass = o2::track::pid_constants::sMasses[id];
+    const float pt = 0.1f + std::exponential_distribution<float>(2.f)(fEngine);
+    track.fX = kXInnermost;
+    track.fAlpha = Uniform(-M_PI, M_PI);
+    track.fY = Gaus(0.f, 0.01f);
+    track.fTgl = std::sinh(Uniform(-0.9f, 0.9f));
+    track.fZ = collision.fPosZ + kXInnermost * track.fTgl + Gaus(0.f, 0.01f);
+    track.fSnp = Gaus(0.f, 0.01f);
+    track.fSigned1Pt = (Uniform(0.f, 1.f) < 0.5f ? 1.f : -1.f) / pt;
+
+    track.fHasITS = Uniform(0.f, 1.f) < 0.9f;
+    track.fHasTPC = Uniform(0.f, 1.f) < 0.95f;
+    if (track.fHasITS) {
+      track.fItsClusterMap = Uniform(0.f, 1.f) < 0.8f ? 0x7F : static_cast<uint8_t>(0x7F & ~(1 << static_cast<int>(Uniform(0.f, 7.f))));
+      track.fItsChi2NCl = std::exponential_distribution<float>(1.f)(fEngine);
+      if (Uniform(0.f, 1.f) < 0.9f) {
+        track.fFlags |= o2::aod::track::PVContributor;
+      }
+    }
+    if (track.fHasTPC) {
+      track.fTpcNClsFound = static_cast<int16_t>(Uniform(60.f, 159.f));
+      track.fTpcNClsCrossedRows = std::min<int16_t>(159, track.fTpcNClsFound + static_cast<int16_t>(Uniform(0.f, 10.f)));
+      track.fTpcCrossedRowsOverFindableCls = Uniform(0.8f, 1.1f);
+      track.fTpcChi2NCl = Uniform(0.5f, 3.f);
+      track.fTpcInnerParam = track.p() * 0.98f;
+      track.fTpcSignal = 50.f * o2::tpc::BetheBlochAleph(track.fTpcInnerParam / mass, 0.0321f, 19.98f, 2.53e-16f, 2.72f, 6.08f) * (1.f + Gaus(0.f, 0.07f));
+    }
+    track.fDcaXY = Gaus(0.f, 0.002f + 0.005f / pt);
+    track.fDcaZ = Gaus(0.f, 0.002f + 0.005f / pt);
+
+    track.fHasTOF = track.fHasTPC && track.p() > 0.3f && Uniform(0.f, 1.f) < 0.6f;
+    track.fTofEvTime = evTime;
+    track.fTofEvTimeErr = evTimeErr;
+    if (track.fHasTOF) {
+      const float p = track.p();
+      track.fLength = 380.f * std::sqrt(1.f + track.fTgl * track.fTgl);
+      track.fTofExpMom = p;
+      track.fTofSignal = track.fLength * std::sqrt(mass * mass + p * p) / (o2::pid::tof::kCSPEED * p) + evTime + Gaus(0.f, 80.f);
+    }
+    return track;
+  }
+
+  std::mt19937 fEngine;
+};
+
+//_________________________________________________________________________
+// Sum of the TOF separations of a track for a set of hypotheses, as computed by the TOF PID tables
+template <o2::track::PID::ID... ids>
+float TofSeparations(const o2::pid::tof::TOFResoParamsV3& parameters, const SyntheticTrack& track)
+{
+  return (o2::pid::tof::ExpTimes<SyntheticTrack, ids>::GetSeparation(parameters, track) + ...);
+}
+
+struct Benchmark {
+  std::string fName;
+  std::function<void(const SyntheticDataframe&)> fFunction; // processes a whole dataframe
+};
+
+// Runs a benchmark for at least minTime seconds, doubling the number of passes over the dataframe, and returns the
+// time per pass in s and the heap allocations per pass
+double Run(const Benchmark& benchmark, const SyntheticDataframe& dataframe, double minTime, double& nAllocationsPerPass)
+{
+  using clock = std::chrono::steady_clock;
+  benchmark.fFunction(dataframe); // warm up
+  long nPasses = 1;
+  while (true) {
+    const long nAllocationsStart = gNAllocations;
+    auto start = clock::now();
+    for (long iPass = 0; iPass < nPasses; ++iPass) {
+      benchmark.fFunction(dataframe);
+    }
+    double elapsed = std::chrono::duration<double>(clock::now() - start).count();
+    nAllocationsPerPass = static_cast<double>(gNAllocations - nAllocationsStart) / nPasses;
+    if (elapsed >= minTime || nPasses > (1L << 20)) {
+      return elapsed / nPasses;
+    }
+    nPasses *= 2;
+  }
+}
+} // namespace
+
+//_________________________________________________________________________
+int main(int argc, char** argv)
+{
+  double minTime = (argc > 1 ? std::atof(argv[1]) : 0.5);
+
+  // producer configurations
+  TrackSelection globalTracks = getGlobalTrackSelectionRun3ITSMatch(TrackSelection::GlobalTrackRun3ITSMatching::Run3ITSibAny);
+  o2::pid::tpc::Response responseTPC;
+  responseTPC.SetUseDefaultResolutionParam(false);
+  o2::pid::tof::TOFResoParamsV3 parametersTOF;
+  TH1F hCalibFT0M("hCalibFT0M", "FT0M calibration", 2000, 0., 40000.);
+  for (int iBin = 1; iBin <= hCalibFT0M.GetNbinsX(); ++iBin) {
+    hCalibFT0M.SetBinContent(iBin, 100.f * std::exp(-iBin / 300.f));
+  }
+
+  // buffers reused across the dataframes, as the members of the tasks
+  TrackSelection::TrackColumns trackColumns;
+  std::vector<uint16_t> masks;
+  std::unique_ptr<bool[]> hasTPC;
+  std::size_t hasTPCSize = 0;
+  std::vector<float> tpcInnerParam, tpcSignal, tpcNClsFound, tgl, signed1Pt, multTPC, expSignal, expSigma, nSigma;
+
+  std::vector<Benchmark> benchmarks = {
+    {"trackPropagation: helix DCA, TrackPar", [&](const SyntheticDataframe& df) {
+       for (const auto& collision : df.fCollisions) {
+         const o2::math_utils::Point3D<float> vertex{collision.fPosX, collision.fPosY, collision.fPosZ};
+         std::array<float, 2> dca{};
+         for (int i = collision.fFirstTrack; i < collision.fFirstTrack + collision.fNTracks; ++i) {
+           auto trackPar = df.fTracks[i].getTrackPar();
+           gSink = trackPar.propagateParamToDCA(vertex, kBz, &dca, 2.f) ? dca[0] : 0.f;
+         }
+       }
+     }},
+    {"trackPropagation: helix DCA, TrackParCov", [&](const SyntheticDataframe& df) {
+       for (const auto& collision : df.fCollisions) {
+         o2::dataformats::VertexBase vertex;
+         vertex.setPos({collision.fPosX, collision.fPosY, collision.fPosZ});
+         vertex.setCov(2.5e-5f, 0.f, 2.5e-5f, 0.f, 0.f, 1.e-4f);
+         o2::dataformats::DCA dca;
+         for (int i = collision.fFirstTrack; i < collision.fFirstTrack + collision.fNTracks; ++i) {
+           auto trackParCov = df.fTracks[i].getTrackParCov();
+           gSink = trackParCov.propagateToDCA(vertex, kBz, &dca, 2.f) ? dca.getY() : 0.f;
+         }
+       }
+     }},
+    {"trackselection: IsSelectedMask per track", [&](const SyntheticDataframe& df) {
+       for (const auto& track : df.fTracks) {
+         gSink = globalTracks.IsSelectedMask(track);
+       }
+     }},
+    {"trackselection: fillSelectionMasks on columns", [&](const SyntheticDataframe& df) {
+       masks.resize(df.fTracks.size());
+       trackColumns.fill(df.fTracks);
+       globalTracks.fillSelectionMasks(trackColumns, masks);
+       gSink = masks.back();
+     }},
+    {"pidTPC: GetNumberOfSigma per track, 9 species", [&](const SyntheticDataframe& df) {
+       for (const auto& collision : df.fCollisions) {
+         for (int i = collision.fFirstTrack; i < collision.fFirstTrack + collision.fNTracks; ++i) {
+           for (int id = 0; id < o2::track::PID::NIDs; ++id) {
+             gSink = responseTPC.GetNumberOfSigma(collision, df.fTracks[i], id);
+           }
+         }
+       }
+     }},
+    {"pidTPC: GetNumberOfSigmaBulk, 9 species", [&](const SyntheticDataframe& df) {
+       const std::size_t nTracks = df.fTracks.size();
+       for (auto* column : {&tpcInnerParam, &tpcSignal, &tpcNClsFound, &tgl, &signed1Pt, &multTPC}) {
+         column->resize(nTracks);
+       }
+       for (auto* output : {&expSignal, &expSigma, &nSigma}) {
+         output->resize(nTracks * o2::track::PID::NIDs);
+       }
+       if (hasTPCSize < nTracks) {
+         hasTPC.reset(new bool[nTracks]);
+         hasTPCSize = nTracks;
+       }
+       for (const auto& collision : df.fCollisions) {
+         for (int i = collision.fFirstTrack; i < collision.fFirstTrack + collision.fNTracks; ++i) {
+           const auto& track = df.fTracks[i];
+           hasTPC[i] = track.hasTPC();
+           tpcInnerParam[i] = track.tpcInnerParam();
+           tpcSignal[i] = track.tpcSignal();
+           tpcNClsFound[i] = track.tpcNClsFound();
+           tgl[i] = track.tgl();
+           signed1Pt[i] = track.signed1Pt();
+           multTPC[i] = collision.multTPC();
+         }
+       }
+       responseTPC.GetNumberOfSigmaBulk(nTracks, hasTPC.get(), tpcInnerParam.data(), tpcSignal.data(), tpcNClsFound.data(), tgl.data(), signed1Pt.data(), multTPC.data(),
+                                        expSignal.data(), expSigma.data(), nSigma.data());
+       gSink = nSigma.back();
+     }},
+    {"pidTOFMerge: GetSeparation per track, 9 species", [&](const SyntheticDataframe& df) {
+       using o2::track::PID;
+       for (const auto& track : df.fTracks) {
+         gSink = TofSeparations<PID::Electron, PID::Muon, PID::Pion, PID::Kaon, PID::Proton, PID::Deuteron, PID::Triton, PID::Helium3, PID::Alpha>(parametersTOF, track);
+       }
+     }},
+    {"multiplicityTable: PV contributors, FT0 amplitudes", [&](const SyntheticDataframe& df) {
+       for (const auto& collision : df.fCollisions) {
+         int nContribs = 0, nContribsEta1 = 0, nContribsEtaHalf = 0, nHasITS = 0, nHasTPC = 0, nHasTOF = 0;
+         for (int i = collision.fFirstTrack; i < collision.fFirstTrack + collision.fNTracks; ++i) {
+           const auto& track = df.fTracks[i];
+           if ((track.flags() & o2::aod::track::PVContributor) != o2::aod::track::PVContributor) {
+             continue;
+           }
+           const float absEta = std::abs(track.eta());
+           if (absEta < 1.f) {
+             nContribsEta1++;
+             nContribs += absEta < 0.8f;
+             nContribsEtaHalf += absEta < 0.5f;
+           }
+           nHasITS += track.hasITS();
+           nHasTPC += track.hasTPC();
+           nHasTOF += track.hasTOF();
+         }
+         float multFT0A = 0.f, multFT0C = 0.f;
+         for (auto amplitude : collision.fAmplitudeA) {
+           multFT0A += amplitude;
+         }
+         for (auto amplitude : collision.fAmplitudeC) {
+           multFT0C += amplitude;
+         }
+         gSink = nContribs + nContribsEta1 + nContribsEtaHalf + nHasITS + nHasTPC + nHasTOF + multFT0A + multFT0C;
+       }
+     }},
+    {"centralityTable: FT0M calibration lookup", [&](const SyntheticDataframe& df) {
+       for (const auto& collision : df.fCollisions) {
+         float multFT0M = 0.f;
+         for (auto amplitude : collision.fAmplitudeA) {
+           multFT0M += amplitude;
+         }
+         for (auto amplitude : collision.fAmplitudeC) {
+           multFT0M += amplitude;
+         }
+         gSink = hCalibFT0M.GetBinContent(hCalibFT0M.FindFixBin(multFT0M));
+       }
+     }}};
+
+  SyntheticGenerator generator(12345);
+  for (const bool isPbPb : {false, true}) {
+    const auto dataframe = generator.Dataframe(isPbPb ? 100 : 5000, isPbPb);
+    printf("\n%s: %d collisions, %d tracks per dataframe\n", isPbPb ? "Pb-Pb" : "pp", static_cast<int>(dataframe.fCollisions.size()), static_cast<int>(dataframe.fTracks.size()));
+    printf("%-55s %15s %15s %15s\n", "Producer", "Collisions/s", "Tracks/s", "Allocs/coll.");
+    printf("%s\n", std::string(103, '-').c_str());
+    for (const auto& benchmark : benchmarks) {
+      double nAllocationsPerPass = 0.;
+      double time = Run(benchmark, dataframe, minTime, nAllocationsPerPass);
+      printf("%-55s %15.4g %15.4g %15.2f\n", benchmark.fName.c_str(), dataframe.fCollisions.size() / time, dataframe.fTracks.size() / time, nAllocationsPerPass / dataframe.fCollisions.size());
+    }
+  }
+  return 0;
+}
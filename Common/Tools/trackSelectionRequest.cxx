@@ -32,7 +32,7 @@ void trackSelectionRequest::setMinPt(float minPt_)
 {
   minPt = minPt_;
 }
-int trackSelectionRequest::getMinPt() const
+float trackSelectionRequest::getMinPt() const
 {
   return minPt;
 }
@@ -40,7 +40,7 @@ void trackSelectionRequest::setMaxPt(float maxPt_)
 {
   maxPt = maxPt_;
 }
-int trackSelectionRequest::getMaxPt() const
+float trackSelectionRequest::getMaxPt() const
 {
   return maxPt;
 }
@@ -48,7 +48,7 @@ void trackSelectionRequest::setMinEta(float minEta_)
 {
   minEta = minEta_;
 }
-int trackSelectionRequest::getMinEta() const
+float trackSelectionRequest::getMinEta() const
 {
   return minEta;
 }
@@ -56,7 +56,7 @@ void trackSelectionRequest::setMaxEta(float maxEta_)
 {
   maxEta = maxEta_;
 }
-int trackSelectionRequest::getMaxEta() const
+float trackSelectionRequest::getMaxEta() const
 {
   return maxEta;
 }
@@ -64,7 +64,7 @@ void trackSelectionRequest::setMaxDCAz(float maxDCAz_)
 {
   maxDCAz = maxDCAz_;
 }
-int trackSelectionRequest::getMaxDCAz() const
+float trackSelectionRequest::getMaxDCAz() const
 {
   return maxDCAz;
 }
@@ -72,7 +72,7 @@ void trackSelectionRequest::setMaxDCAxyPtDep(float maxDCAxyPtDep_)
 {
   maxDCAxyPtDep = maxDCAxyPtDep_;
 }
-int trackSelectionRequest::getMaxDCAxyPtDep() const
+float trackSelectionRequest::getMaxDCAxyPtDep() const
 {
   return maxDCAxyPtDep;
 }
@@ -104,7 +104,7 @@ void trackSelectionRequest::setMinTPCCrossedRowsOverFindable(float minTPCcrossed
 {
   minTPCcrossedrowsoverfindable = minTPCcrossedrowsoverfindable_;
 }
-int trackSelectionRequest::getMinTPCCrossedRowsOverFindable() const
+float trackSelectionRequest::getMinTPCCrossedRowsOverFindable() const
 {
   return minTPCcrossedrowsoverfindable;
 }
@@ -128,7 +128,7 @@ void trackSelectionRequest::setMaxITSChi2PerCluster(float maxITSChi2percluster_)
 {
   maxITSChi2percluster = maxITSChi2percluster_;
 }
-int trackSelectionRequest::getMaxITSChi2PerCluster() const
+float trackSelectionRequest::getMaxITSChi2PerCluster() const
 {
   return maxITSChi2percluster;
 }
@@ -169,6 +169,16 @@ void trackSelectionRequest::CombineWithLogicalOR(trackSelectionRequest const& lT
   return;
 }
 
+bool trackSelectionRequest::operator==(trackSelectionRequest const& other) const
+{
+  return trackPhysicsType == other.trackPhysicsType &&
+         minPt == other.minPt && maxPt == other.maxPt && minEta == other.minEta && maxEta == other.maxEta &&
+         maxDCAz == other.maxDCAz && maxDCAxyPtDep == other.maxDCAxyPtDep &&
+         requireTPC == other.requireTPC && minTPCclusters == other.minTPCclusters && minTPCcrossedrows == other.minTPCcrossedrows &&
+         minTPCcrossedrowsoverfindable == other.minTPCcrossedrowsoverfindable &&
+         requireITS == other.requireITS && minITSclusters == other.minITSclusters && maxITSChi2percluster == other.maxITSChi2percluster;
+}
+
 void trackSelectionRequest::SetTightSelections()
 {
   // Phase space (Tracks or TracksIU)
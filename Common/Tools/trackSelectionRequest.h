@@ -39,18 +39,18 @@ class trackSelectionRequest
   void setTrackPhysicsType(int trackPhysicsType_);
   int getTrackPhysicsType() const;
   void setMinPt(float minPt_);
-  int getMinPt() const;
+  float getMinPt() const;
   void setMaxPt(float maxPt_);
-  int getMaxPt() const;
+  float getMaxPt() const;
   void setMinEta(float minEta_);
-  int getMinEta() const;
+  float getMinEta() const;
   void setMaxEta(float maxEta_);
-  int getMaxEta() const;
+  float getMaxEta() const;
 
   void setMaxDCAz(float maxDCAz_);
-  int getMaxDCAz() const;
+  float getMaxDCAz() const;
   void setMaxDCAxyPtDep(float maxDCAxyPtDep_);
-  int getMaxDCAxyPtDep() const;
+  float getMaxDCAxyPtDep() const;
 
   void setRequireTPC(bool requireTPC_);
   bool getRequireTPC() const;
@@ -59,18 +59,21 @@ class trackSelectionRequest
   void setMinTPCCrossedRows(int minTPCCrossedRows_);
   int getMinTPCCrossedRows() const;
   void setMinTPCCrossedRowsOverFindable(float minTPCCrossedRowsOverFindable_);
-  int getMinTPCCrossedRowsOverFindable() const;
+  float getMinTPCCrossedRowsOverFindable() const;
 
   void setRequireITS(bool requireITS_);
   bool getRequireITS() const;
   void setMinITSClusters(int minITSclusters_);
   int getMinITSClusters() const;
   void setMaxITSChi2PerCluster(float maxITSChi2percluster_);
-  int getMaxITSChi2PerCluster() const;
+  float getMaxITSChi2PerCluster() const;
 
   // Calculate logical OR of selection criteria conveniently
   void CombineWithLogicalOR(trackSelectionRequest const& lTraSelRe);
 
+  // Check whether two requests apply the same selections
+  bool operator==(trackSelectionRequest const& other) const;
+
   // Apply track selection checks (to be used in core services)
   template <typename TTrack>
   bool IsTrackSelected(TTrack const& lTrack)
@@ -86,7 +89,7 @@ class trackSelectionRequest
     if (lTrack.eta() > maxEta)
       return false;
     // DCA to PV
-    if (fabs(lTrack.dcaXY()) < maxDCAz)
+    if (fabs(lTrack.dcaZ()) > maxDCAz)
       return false;
     // TracksExtra-based
     if (lTrack.hasTPC() == false && requireTPC)
@@ -101,8 +104,8 @@ class trackSelectionRequest
       return false;
     if (lTrack.itsNCls() < minITSclusters)
       return false;
-    if (lTrack.itsChi2NCl() < maxITSChi2percluster)
-      return false; // FIXME this is a LO approximation
+    if (lTrack.itsChi2NCl() > maxITSChi2percluster)
+      return false;
     return true;
   }
   template <typename TTrack>
@@ -121,8 +124,8 @@ class trackSelectionRequest
       return false;
     if (lTrack.itsNCls() < minITSclusters)
       return false;
-    if (lTrack.itsChi2NCl() < maxITSChi2percluster)
-      return false; // FIXME this is a LO approximation
+    if (lTrack.itsChi2NCl() > maxITSChi2percluster)
+      return false;
     return true;
   }
 
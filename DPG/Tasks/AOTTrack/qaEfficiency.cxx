@@ -66,6 +66,11 @@ static constexpr int nSpecies = o2::track::PID::NIDs; // One per PDG
 static constexpr const char* particleTitle[nSpecies] = {"e", "#mu", "#pi", "K", "p", "d", "t", "^{3}He", "#alpha"};
 static constexpr int PDGs[nSpecies] = {kElectron, kMuonMinus, kPiPlus, kKPlus, kProton, 1000010020, 1000010030, 1000020030, 1000020040};
 
+// Global track selections
+static constexpr int nGlobalTrackSelections = 7;
+static constexpr const char* globalTrackSelectionNames[nGlobalTrackSelections] = {"No extra selection", "isGlobalTrack", "isGlobalTrackWoPtEta", "isGlobalTrackWoDCA", "isQualityTrack", "isInAcceptanceTrack", "customTrackSelection"};
+static constexpr size_t maxGlobalTrackSelectionVariations = 32;
+
 // Histograms
 static constexpr int nHistograms = nSpecies * 2;
 
@@ -435,6 +440,7 @@ struct QaEfficiency {
   // Track only selection, options to select only specific tracks
   Configurable<bool> trackSelection{"trackSelection", true, "Local track selection"};
   Configurable<int> globalTrackSelection{"globalTrackSelection", 0, "Global track selection: 0 -> No Cut, 1 -> kGlobalTrack, 2 -> kGlobalTrackWoPtEta, 3 -> kGlobalTrackWoDCA, 4 -> kQualityTracks, 5 -> kInAcceptanceTracks, 6 -> custom track cuts via Configurable"};
+  Configurable<std::vector<int>> globalTrackSelectionVariations{"globalTrackSelectionVariations", std::vector<int>{}, "Other global track selections (same codes as globalTrackSelection) evaluated in the same pass in MC, each with its own set of ITS-TPC histograms"};
   // Event selection
   Configurable<int> nMinNumberOfContributors{"nMinNumberOfContributors", 2, "Minimum required number of contributors to the primary vertex"};
   Configurable<float> vertexZMin{"vertex-z-min", -10.f, "Minimum position of the primary vertez in Z (cm)"};
@@ -482,6 +488,16 @@ struct QaEfficiency {
   HistogramRegistry histosPosPdg{"HistosPosPdg", {}, OutputObjHandlingPolicy::AnalysisObject};
   HistogramRegistry histosNegPdg{"HistosNegPdg", {}, OutputObjHandlingPolicy::AnalysisObject};
 
+  // Histograms of a global track selection variation, per PDG code
+  struct SelectionVariationHistograms {
+    std::array<std::shared_ptr<TH1>, nHistograms> ptItsTpc;
+    std::array<std::shared_ptr<TH1>, nHistograms> ptItsTpcTof;
+    std::array<std::shared_ptr<TH1>, nHistograms> ptItsTpcPrm;
+    std::array<std::shared_ptr<TH1>, nHistograms> etaItsTpc;
+    std::array<std::shared_ptr<TH1>, nHistograms> phiItsTpc;
+  };
+  std::vector<SelectionVariationHistograms> selectionVariationHistograms;
+
   static const char* particleName(int pdgSign, o2::track::PID::ID id)
   {
     return Form("%s %s", pdgSign == 0 ? "Positive PDG" : "Negative PDG", o2::track::PID::getName(id));
@@ -620,6 +636,18 @@ struct QaEfficiency {
       registry->add(hPtEtaGenerated[histogramIndex].data(), "Generated " + tagPtEta, kTH2D, {axisPt, axisEta});
     }
 
+    // Numerators for the global track selection variations, the denominators are the same as for the main selection
+    for (size_t iVariation = 0; iVariation < selectionVariationHistograms.size(); iVariation++) {
+      const char* selectionName = globalTrackSelectionNames[globalTrackSelectionVariations.value[iVariation]];
+      auto variationName = [&](const std::string_view& name) { return std::string(Form("MC/selVariation%zu/", iVariation)).append(name.substr(3)); }; // e.g. MC/selVariation0/el/pos_pdg/pt/its_tpc
+      auto& variation = selectionVariationHistograms[iVariation];
+      variation.ptItsTpc[histogramIndex] = registry->add<TH1>(variationName(hPtItsTpc[histogramIndex]).c_str(), Form("ITS-TPC tracks (%s) ", selectionName) + tagPt, kTH1D, {axisPt});
+      variation.ptItsTpcTof[histogramIndex] = registry->add<TH1>(variationName(hPtItsTpcTof[histogramIndex]).c_str(), Form("ITS-TPC-TOF tracks (%s) ", selectionName) + tagPt, kTH1D, {axisPt});
+      variation.ptItsTpcPrm[histogramIndex] = registry->add<TH1>(variationName(hPtItsTpcPrm[histogramIndex]).c_str(), Form("ITS-TPC tracks (primaries, %s) ", selectionName) + tagPt, kTH1D, {axisPt});
+      variation.etaItsTpc[histogramIndex] = registry->add<TH1>(variationName(hEtaItsTpc[histogramIndex]).c_str(), Form("ITS-TPC tracks (%s) ", selectionName) + tagEta, kTH1D, {axisEta});
+      variation.phiItsTpc[histogramIndex] = registry->add<TH1>(variationName(hPhiItsTpc[histogramIndex]).c_str(), Form("ITS-TPC tracks (%s) ", selectionName) + tagPhi, kTH1D, {axisPhi});
+    }
+
     LOG(info) << "Done with making histograms for particle: " << partName;
   }
 
@@ -802,6 +830,16 @@ struct QaEfficiency {
     for (int i = 0; i < nSpecies; i++) {
       h->GetXaxis()->SetBinLabel(trkCutIdxN + i, Form("Passed PDG %i %s", PDGs[i], particleTitle[i]));
     }
+    if (globalTrackSelectionVariations.value.size() > maxGlobalTrackSelectionVariations) {
+      LOG(fatal) << "At most " << maxGlobalTrackSelectionVariations << " global track selection variations can be evaluated, " << globalTrackSelectionVariations.value.size() << " are asked";
+    }
+    for (const auto& selection : globalTrackSelectionVariations.value) {
+      if (selection < 0 || selection >= nGlobalTrackSelections) {
+        LOG(fatal) << "Can't interpret track asked selection variation " << selection;
+      }
+      LOG(info) << "Evaluating the global track selection variation " << globalTrackSelectionNames[selection];
+    }
+    selectionVariationHistograms.resize(globalTrackSelectionVariations.value.size());
     histos.add("MC/fakeTrackNoiseHits", "Fake tracks from noise hits", kTH1D, {{1, 0, 1}});
 
     h = histos.add<TH1>("MC/particleSelection", "Particle Selection", kTH1D, {axisSel});
@@ -1300,6 +1338,46 @@ struct QaEfficiency {
     }
   }
 
+  // Fills the histograms of the global track selection variations passed by the track, as set by isTrackSelected
+  template <typename trackType>
+  void fillMCTrackSelectionVariations(const trackType& track)
+  {
+    if (passedSelectionVariations == 0 || !(passedITS && passedTPC)) {
+      return;
+    }
+    const auto& mcParticle = track.mcParticle();
+    int histogramIndex = -1;
+    for (int id = 0; id < nSpecies; id++) {
+      if (mcParticle.pdgCode() == PDGs[id]) {
+        histogramIndex = id;
+        break;
+      }
+      if (mcParticle.pdgCode() == -PDGs[id]) {
+        histogramIndex = id + nSpecies;
+        break;
+      }
+    }
+    if (histogramIndex < 0) {
+      return;
+    }
+    const bool isPrimary = isPhysicalPrimary(mcParticle);
+    for (size_t iVariation = 0; iVariation < selectionVariationHistograms.size(); iVariation++) {
+      const auto& variation = selectionVariationHistograms[iVariation];
+      if (!((passedSelectionVariations >> iVariation) & 1) || !variation.ptItsTpc[histogramIndex]) { // not passed or species not enabled
+        continue;
+      }
+      variation.ptItsTpc[histogramIndex]->Fill(mcParticle.pt());
+      variation.etaItsTpc[histogramIndex]->Fill(mcParticle.eta());
+      variation.phiItsTpc[histogramIndex]->Fill(mcParticle.phi());
+      if (passedTOF) {
+        variation.ptItsTpcTof[histogramIndex]->Fill(mcParticle.pt());
+      }
+      if (isPrimary) {
+        variation.ptItsTpcPrm[histogramIndex]->Fill(mcParticle.pt());
+      }
+    }
+  }
+
   template <int pdgSign, o2::track::PID::ID id, bool recoEv = false>
   void fillMCParticleHistograms(const o2::aod::McParticles::iterator& mcParticle, const bool doMakeHistograms)
   {
@@ -1571,6 +1649,32 @@ struct QaEfficiency {
   bool passedTPC = false;
   bool passedTRD = false;
   bool passedTOF = false;
+  uint32_t passedSelectionVariations = 0; // bit i is set if the track passes globalTrackSelectionVariations[i]
+
+  template <typename trackType>
+  bool passedGlobalTrackSelection(trackType& track, const int selection)
+  {
+    switch (selection) {
+      case 0:
+        return true;
+      case 1:
+        return track.isGlobalTrack();
+      case 2:
+        return track.isGlobalTrackWoPtEta();
+      case 3:
+        return track.isGlobalTrackWoDCA();
+      case 4:
+        return track.isQualityTrack();
+      case 5:
+        return track.isInAcceptanceTrack();
+      case 6:
+        return customTrackCuts.IsSelected(track);
+      default:
+        LOG(fatal) << "Can't interpret track asked selection " << selection;
+    }
+    return false;
+  }
+
   template <bool isMC = true, bool doFillHisto = true, typename trackType, typename histoType = int>
   bool isTrackSelected(trackType& track, const histoType& countingHisto = 0)
   {
@@ -1579,6 +1683,7 @@ struct QaEfficiency {
     passedTPC = false;
     passedTRD = false;
     passedTOF = false;
+    passedSelectionVariations = 0;
 
     if constexpr (doFillHisto) {
       histos.fill(countingHisto, trkCutIdxTrkRead); // Read tracks
@@ -1721,32 +1826,14 @@ struct QaEfficiency {
         histos.fill(countingHisto, trkCutIdxPassedTOFPartial);
       }
     }
-    bool isTrackSelectedAfteAll = false;
-    switch (globalTrackSelection) {
-      case 0:
-        isTrackSelectedAfteAll = true;
-        break;
-      case 1:
-        isTrackSelectedAfteAll = track.isGlobalTrack();
-        break;
-      case 2:
-        isTrackSelectedAfteAll = track.isGlobalTrackWoPtEta();
-        break;
-      case 3:
-        isTrackSelectedAfteAll = track.isGlobalTrackWoDCA();
-        break;
-      case 4:
-        isTrackSelectedAfteAll = track.isQualityTrack();
-        break;
-      case 5:
-        isTrackSelectedAfteAll = track.isInAcceptanceTrack();
-        break;
-      case 6:
-        isTrackSelectedAfteAll = customTrackCuts.IsSelected(track);
-        break;
-      default:
-        LOG(fatal) << "Can't interpret track asked selection " << globalTrackSelection;
+    if constexpr (isMC) {
+      for (size_t iVariation = 0; iVariation < globalTrackSelectionVariations.value.size(); iVariation++) {
+        if (passedGlobalTrackSelection(track, globalTrackSelectionVariations.value[iVariation])) {
+          passedSelectionVariations |= 1u << iVariation;
+        }
+      }
     }
+    const bool isTrackSelectedAfteAll = passedGlobalTrackSelection(track, globalTrackSelection);
     if (!isTrackSelectedAfteAll) {
       return false;
     }
@@ -1813,7 +1900,8 @@ struct QaEfficiency {
 
         // Track loop
         for (const auto& track : groupedTracks) {
-          if (!isTrackSelected(track, HIST("MC/trackSelection"))) {
+          const bool passedSelection = isTrackSelected(track, HIST("MC/trackSelection"));
+          if (!passedSelection && passedSelectionVariations == 0) {
             continue;
           }
 
@@ -1823,6 +1911,10 @@ struct QaEfficiency {
           if (keepOnlyHfParticles && !RecoDecay::getCharmHadronOrigin(mcParticles, particle, /*searchUpToQuark*/ true)) {
             continue;
           }
+          fillMCTrackSelectionVariations(track);
+          if (!passedSelection) {
+            continue;
+          }
 
           // Filling variable histograms
           histos.fill(HIST("MC/trackLength"), track.length());
@@ -1945,7 +2037,8 @@ struct QaEfficiency {
   {
     // Track loop
     for (const auto& track : tracks) {
-      if (!isTrackSelected(track, HIST("MC/trackSelection"))) {
+      const bool passedSelection = isTrackSelected(track, HIST("MC/trackSelection"));
+      if (!passedSelection && passedSelectionVariations == 0) {
         continue;
       }
 
@@ -1964,6 +2057,10 @@ struct QaEfficiency {
       if (keepOnlyHfParticles && !RecoDecay::getCharmHadronOrigin(mcParticles, particle, /*searchUpToQuark*/ true)) {
         continue;
       }
+      fillMCTrackSelectionVariations(track);
+      if (!passedSelection) {
+        continue;
+      }
 
       // Filling variable histograms
       histos.fill(HIST("MC/trackLength"), track.length());
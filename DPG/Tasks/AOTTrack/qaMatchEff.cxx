@@ -66,6 +66,8 @@ using CollisionsMCEvSelFT0C = soa::Filtered<soa::Join<aod::Collisions, aod::McCo
 
 using TracksPID = soa::Join<aod::Tracks, aod::TracksExtra, aod::TracksDCA, aod::pidTPCFullPi, aod::pidTPCFullKa, aod::pidTPCFullPr, aod::pidTOFFullPi, aod::pidTOFFullKa, aod::pidTOFFullPr>;
 using TracksIUPID = soa::Join<aod::TracksIU, aod::TracksExtra, aod::TracksDCA, aod::pidTPCFullPi, aod::pidTPCFullKa, aod::pidTPCFullPr, aod::pidTOFFullPi, aod::pidTOFFullKa, aod::pidTOFFullPr>;
+using TracksNoPID = soa::Join<aod::Tracks, aod::TracksExtra, aod::TracksDCA>;
+using TracksIUNoPID = soa::Join<aod::TracksIU, aod::TracksExtra, aod::TracksDCA>;
 using MCTracks = soa::Join<aod::Tracks, aod::TracksExtra, aod::TracksDCA, aod::McTrackLabels>;
 using MCTracksIU = soa::Join<aod::TracksIU, aod::TracksExtra, aod::TracksDCA, aod::McTrackLabels>;
 
@@ -242,6 +244,13 @@ struct qaMatchEff {
     if (doprocessTrkIUData && makethn) {
       LOGF(fatal, "No DCA for IU tracks. Put makethn = false.");
     }
+    if ((doprocessDataNoPID || doprocessTrkIUDataNoPID) && (isPIDPionRequired || isPIDKaonRequired || isPIDProtonRequired))
+      LOGF(fatal, "PID required but the process function without PID tables is flagged! Fix the configuration.");
+    if (isitMC && (doprocessDataNoPID || doprocessTrkIUDataNoPID))
+      LOGF(fatal, "The process functions without PID tables fill the reconstructed level histograms only, they need isitMC = false (also on MC files). Fix the configuration.");
+    if (doprocessTrkIUDataNoPID && makethn) {
+      LOGF(fatal, "No DCA for IU tracks. Put makethn = false.");
+    }
     //
     /// initialize the track selections
     if (isUseTrackSelections) {
@@ -1514,7 +1523,7 @@ struct qaMatchEff {
       Int_t signOfTrack = track.signed1Pt() > 0 ? 1 : -1;
       //
       // PID sigmas
-      if constexpr (!IS_MC) {
+      if constexpr (!IS_MC && requires { track.tpcNSigmaPi(); }) {
         tpcNSigmaPion = track.tpcNSigmaPi();
         tpcNSigmaKaon = track.tpcNSigmaKa();
         tpcNSigmaProton = track.tpcNSigmaPr();
@@ -3342,6 +3351,41 @@ struct qaMatchEff {
     fillHistograms<false>(tracks, tracks, bcs); // 2nd argument not used in this case
   }
   PROCESS_SWITCH(qaMatchEff, processDataNoColl, "process data - no collision grouping", false);
+
+  ////////////////////////////////////////////////////////////////////////
+  ///   Process data with collision grouping, without the PID tables   ///
+  ////////////////////////////////////////////////////////////////////////
+  /// reads only the track, extra and DCA tables, also usable on MC files for the
+  /// reconstructed level efficiencies without reading the MC labels and particles
+  void processDataNoPID(CollisionsEvSel::iterator const& collision, TracksNoPID const& tracks, BCsWithTimeStamp const& bcs)
+  {
+    if (enableMonitorVsTime) {
+      setUpTimeMonitoring(bcs);
+    }
+    if (isEnableEventSelection && !collision.sel8()) {
+      if (doDebug)
+        LOGF(info, "Event selection not passed, skipping...");
+      return;
+    }
+    fillHistograms<false>(tracks, tracks, bcs); // 2nd argument not used in this case
+    fillGeneralHistos<false>(collision);
+  }
+  PROCESS_SWITCH(qaMatchEff, processDataNoPID, "process data (or MC at reconstructed level) without PID tables", false);
+
+  //////////////////////////////////////////////////////////////////////////////////
+  ///   Process data with collision grouping and IU tracks, without PID tables   ///
+  //////////////////////////////////////////////////////////////////////////////////
+  void processTrkIUDataNoPID(CollisionsEvSel::iterator const& collision, TracksIUNoPID const& tracks)
+  {
+    if (isEnableEventSelection && !collision.sel8()) {
+      if (doDebug)
+        LOGF(info, "Event selection not passed, skipping...");
+      return;
+    }
+    fillHistograms<false>(tracks, tracks, tracks); // 2nd and 3rd arguments not used in this case
+    fillGeneralHistos<false>(collision);
+  }
+  PROCESS_SWITCH(qaMatchEff, processTrkIUDataNoPID, "process data (or MC at reconstructed level) for IU tracks without PID tables", false);
 }; // end of structure
 
 WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
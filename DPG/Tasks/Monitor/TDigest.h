@@ -0,0 +1,143 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   TDigest.h
+/// \brief  Merging t-digest (T. Dunning) for the approximate quantiles of a stream of values in a bounded memory.
+///         The values are buffered and merged into centroids whose weight is limited by 4 N q (1 - q) / compression,
+///         hence the quantiles are the most accurate in the tails. Digests of different streams can be merged.
+///
+
+#ifndef DPG_TASKS_MONITOR_TDIGEST_H_
+#define DPG_TASKS_MONITOR_TDIGEST_H_
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace o2::dpg
+{
+
+class TDigest
+{
+ public:
+  explicit TDigest(double compression = 100.) : mCompression(compression) {}
+
+  void add(double value, double weight = 1.)
+  {
+    if (!std::isfinite(value)) {
+      return;
+    }
+    mBuffer.push_back({value, weight});
+    mTotalWeight += weight;
+    mMin = std::min(mMin, value);
+    mMax = std::max(mMax, value);
+    if (mBuffer.size() >= kBufferFactor * mCompression) {
+      compress();
+    }
+  }
+
+  void merge(TDigest const& other)
+  {
+    mBuffer.insert(mBuffer.end(), other.mCentroids.begin(), other.mCentroids.end());
+    mBuffer.insert(mBuffer.end(), other.mBuffer.begin(), other.mBuffer.end());
+    mTotalWeight += other.mTotalWeight;
+    mMin = std::min(mMin, other.mMin);
+    mMax = std::max(mMax, other.mMax);
+    compress();
+  }
+
+  /// Approximate q-quantile, NaN for an empty digest
+  double quantile(double q)
+  {
+    compress();
+    if (mCentroids.empty()) {
+      return std::numeric_limits<double>::quiet_NaN();
+    }
+    if (mCentroids.size() == 1) {
+      return mCentroids[0].mean;
+    }
+    const double target = std::clamp(q, 0., 1.) * mTotalWeight;
+    double cumulative = 0.;
+    double previousCenter = 0.;
+    double previousMean = mMin;
+    for (const auto& centroid : mCentroids) {
+      const double center = cumulative + 0.5 * centroid.weight;
+      if (target <= center) {
+        const double fraction = center > previousCenter ? (target - previousCenter) / (center - previousCenter) : 1.;
+        return previousMean + fraction * (centroid.mean - previousMean);
+      }
+      cumulative += centroid.weight;
+      previousCenter = center;
+      previousMean = centroid.mean;
+    }
+    const double fraction = mTotalWeight > previousCenter ? (target - previousCenter) / (mTotalWeight - previousCenter) : 1.;
+    return previousMean + fraction * (mMax - previousMean);
+  }
+
+  double totalWeight() const { return mTotalWeight; }
+  size_t nCentroids() const { return mCentroids.size() + mBuffer.size(); }
+
+  void clear()
+  {
+    mCentroids.clear();
+    mBuffer.clear();
+    mTotalWeight = 0.;
+    mMin = std::numeric_limits<double>::infinity();
+    mMax = -std::numeric_limits<double>::infinity();
+  }
+
+ private:
+  struct Centroid {
+    double mean;
+    double weight;
+  };
+  static constexpr double kBufferFactor = 5.;
+
+  double mCompression;
+  double mTotalWeight = 0.;
+  double mMin = std::numeric_limits<double>::infinity();
+  double mMax = -std::numeric_limits<double>::infinity();
+  std::vector<Centroid> mCentroids; // merged centroids, sorted by mean
+  std::vector<Centroid> mBuffer;    // values not merged yet
+
+  void compress()
+  {
+    if (mBuffer.empty()) {
+      return;
+    }
+    mBuffer.insert(mBuffer.end(), mCentroids.begin(), mCentroids.end());
+    std::sort(mBuffer.begin(), mBuffer.end(), [](Centroid const& a, Centroid const& b) { return a.mean < b.mean; });
+    mCentroids.clear();
+    double cumulative = 0.;
+    Centroid current = mBuffer[0];
+    for (size_t i = 1; i < mBuffer.size(); ++i) {
+      const auto& next = mBuffer[i];
+      const double proposedWeight = current.weight + next.weight;
+      const double q = (cumulative + 0.5 * proposedWeight) / mTotalWeight;
+      if (proposedWeight <= 4. * mTotalWeight * q * (1. - q) / mCompression) {
+        current.mean += (next.mean - current.mean) * next.weight / proposedWeight;
+        current.weight = proposedWeight;
+      } else {
+        cumulative += current.weight;
+        mCentroids.push_back(current);
+        current = next;
+      }
+    }
+    mCentroids.push_back(current);
+    mBuffer.clear();
+  }
+};
+
+} // namespace o2::dpg
+
+#endif // DPG_TASKS_MONITOR_TDIGEST_H_
@@ -0,0 +1,141 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+///
+/// \file   qaTimeSliceSummary.cxx
+/// \brief  Streaming summary of the event QA in time slices, for the run quality monitoring while the jobs run.
+///         For each data frame, the statistics of its collisions are written per time slice in a compact table
+///         (counters, mean and RMS, quantiles from a t-digest) instead of histograms merged at the end of the train.
+///         A time slice spanning several data frames gives one row per data frame: the counters and the sums add up,
+///         the quantiles are those of the part of the slice in the data frame.
+///
+
+#include <cmath>
+#include <map>
+
+#include "Framework/AnalysisDataModel.h"
+#include "Framework/AnalysisTask.h"
+#include "Framework/runDataProcessing.h"
+#include "Common/DataModel/EventSelection.h"
+#include "TDigest.h"
+
+using namespace o2;
+using namespace o2::framework;
+
+namespace o2::aod
+{
+namespace dpgtimeslice
+{
+DECLARE_SOA_COLUMN(RunNumber, runNumber, int);          //! Run number
+DECLARE_SOA_COLUMN(SliceStart, sliceStart, uint64_t);   //! Start of the time slice (ms)
+DECLARE_SOA_COLUMN(SliceLength, sliceLength, uint32_t); //! Length of the time slice (ms)
+DECLARE_SOA_COLUMN(NBCs, nBCs, uint32_t);               //! Number of BCs in the AOD
+DECLARE_SOA_COLUMN(NCollisions, nCollisions, uint32_t); //! Number of collisions
+DECLARE_SOA_COLUMN(NSel8, nSel8, uint32_t);             //! Number of collisions passing sel8, the statistics below are for these
+DECLARE_SOA_COLUMN(SumPosZ, sumPosZ, float);            //! Sum of the z of the vertices (cm)
+DECLARE_SOA_COLUMN(SumPosZ2, sumPosZ2, float);          //! Sum of the squared z of the vertices (cm^2)
+DECLARE_SOA_COLUMN(SumNContrib, sumNContrib, float);    //! Sum of the numbers of vertex contributors
+DECLARE_SOA_COLUMN(NContribQ10, nContribQ10, float);    //! 10% quantile of the number of vertex contributors
+DECLARE_SOA_COLUMN(NContribQ50, nContribQ50, float);    //! Median of the number of vertex contributors
+DECLARE_SOA_COLUMN(NContribQ90, nContribQ90, float);    //! 90% quantile of the number of vertex contributors
+DECLARE_SOA_DYNAMIC_COLUMN(MeanPosZ, meanPosZ, //! Mean z of the vertices (cm)
+                           [](uint32_t n, float sum) -> float { return n > 0 ? sum / n : 0.f; });
+DECLARE_SOA_DYNAMIC_COLUMN(MeanNContrib, meanNContrib, //! Mean number of vertex contributors
+                           [](uint32_t n, float sum) -> float { return n > 0 ? sum / n : 0.f; });
+} // namespace dpgtimeslice
+
+DECLARE_SOA_TABLE(DPGTimeSlices, "AOD", "DPGTIMESLICE", //! Event QA summary per time slice
+                  dpgtimeslice::RunNumber, dpgtimeslice::SliceStart, dpgtimeslice::SliceLength,
+                  dpgtimeslice::NBCs, dpgtimeslice::NCollisions, dpgtimeslice::NSel8,
+                  dpgtimeslice::SumPosZ, dpgtimeslice::SumPosZ2, dpgtimeslice::SumNContrib,
+                  dpgtimeslice::NContribQ10, dpgtimeslice::NContribQ50, dpgtimeslice::NContribQ90,
+                  dpgtimeslice::MeanPosZ<dpgtimeslice::NSel8, dpgtimeslice::SumPosZ>,
+                  dpgtimeslice::MeanNContrib<dpgtimeslice::NSel8, dpgtimeslice::SumNContrib>);
+} // namespace o2::aod
+
+struct QaTimeSliceSummary {
+  Produces<aod::DPGTimeSlices> timeSlices;
+
+  Configurable<int> sliceLength{"sliceLength", 60, "Length of the time slices (s)"};
+  Configurable<float> compression{"compression", 100.f, "Compression of the t-digests of the quantiles, the accuracy increases with it"};
+  Configurable<bool> logSummaries{"logSummaries", false, "Print the summary of each time slice"};
+
+  using BCsWithTimestamps = soa::Join<aod::BCs, aod::Timestamps>;
+  using CollisionsEvSel = soa::Join<aod::Collisions, aod::EvSels>;
+
+  struct SliceStatistics {
+    explicit SliceStatistics(double compression) : nContrib(compression) {}
+    int runNumber = 0;
+    uint32_t nBCs = 0;
+    uint32_t nCollisions = 0;
+    uint32_t nSel8 = 0;
+    double sumPosZ = 0.;
+    double sumPosZ2 = 0.;
+    double sumNContrib = 0.;
+    o2::dpg::TDigest nContrib;
+  };
+  std::map<uint64_t, SliceStatistics> slices; // statistics of the data frame, by start of the time slice
+
+  uint64_t sliceLengthMs = 0;
+
+  void init(InitContext&)
+  {
+    if (sliceLength <= 0) {
+      LOGF(fatal, "The length of the time slices must be positive, %d s is configured", sliceLength.value);
+    }
+    sliceLengthMs = static_cast<uint64_t>(sliceLength) * 1000;
+  }
+
+  SliceStatistics& getSlice(BCsWithTimestamps::iterator const& bc)
+  {
+    const uint64_t start = bc.timestamp() / sliceLengthMs * sliceLengthMs;
+    auto slice = slices.try_emplace(start, compression).first;
+    slice->second.runNumber = bc.runNumber();
+    return slice->second;
+  }
+
+  void process(BCsWithTimestamps const& bcs, CollisionsEvSel const& collisions)
+  {
+    for (const auto& bc : bcs) {
+      getSlice(bc).nBCs++;
+    }
+    for (const auto& collision : collisions) {
+      auto& slice = getSlice(collision.bc_as<BCsWithTimestamps>());
+      slice.nCollisions++;
+      if (!collision.sel8()) {
+        continue;
+      }
+      slice.nSel8++;
+      slice.sumPosZ += collision.posZ();
+      slice.sumPosZ2 += collision.posZ() * collision.posZ();
+      slice.sumNContrib += collision.numContrib();
+      slice.nContrib.add(collision.numContrib());
+    }
+
+    for (auto& [start, slice] : slices) {
+      const float q10 = slice.nContrib.quantile(0.1);
+      const float q50 = slice.nContrib.quantile(0.5);
+      const float q90 = slice.nContrib.quantile(0.9);
+      timeSlices(slice.runNumber, start, sliceLengthMs, slice.nBCs, slice.nCollisions, slice.nSel8,
+                 slice.sumPosZ, slice.sumPosZ2, slice.sumNContrib, q10, q50, q90);
+      if (logSummaries) {
+        LOGF(info, "Run %d, time slice %llu ms: %u BCs, %u collisions, %u sel8, <z> = %.3f cm, <N contrib> = %.1f, N contrib quantiles (10%%, 50%%, 90%%) = (%.1f, %.1f, %.1f)",
+             slice.runNumber, start, slice.nBCs, slice.nCollisions, slice.nSel8,
+             slice.nSel8 > 0 ? slice.sumPosZ / slice.nSel8 : 0., slice.nSel8 > 0 ? slice.sumNContrib / slice.nSel8 : 0., q10, q50, q90);
+      }
+    }
+    slices.clear();
+  }
+};
+
+WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
+{
+  return WorkflowSpec{adaptAnalysisTask<QaTimeSliceSummary>(cfgc)};
+}
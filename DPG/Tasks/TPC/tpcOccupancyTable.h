@@ -0,0 +1,33 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file tpcOccupancyTable.h
+/// \brief Table with the TPC occupancy around each collision, joinable with the collisions
+
+#ifndef DPG_TASKS_TPC_TPCOCCUPANCYTABLE_H_
+#define DPG_TASKS_TPC_TPCOCCUPANCYTABLE_H_
+
+#include "Framework/AnalysisDataModel.h"
+
+namespace o2::aod
+{
+namespace tpcoccupancy
+{
+DECLARE_SOA_COLUMN(NTPCTracksInTimeWindow, nTPCTracksInTimeWindow, int);   //! Number of TPC tracks of the other collisions within the time window around the collision
+DECLARE_SOA_COLUMN(NCollisionsInTimeWindow, nCollisionsInTimeWindow, int); //! Number of other collisions within the time window around the collision
+} // namespace tpcoccupancy
+
+DECLARE_SOA_TABLE(TPCOccupancies, "AOD", "TPCOCCUPANCY", //! Joinable with Collisions
+                  tpcoccupancy::NTPCTracksInTimeWindow,
+                  tpcoccupancy::NCollisionsInTimeWindow);
+} // namespace o2::aod
+
+#endif // DPG_TASKS_TPC_TPCOCCUPANCYTABLE_H_
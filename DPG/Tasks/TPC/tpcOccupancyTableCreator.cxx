@@ -0,0 +1,86 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file tpcOccupancyTableCreator.cxx
+/// \brief Task to produce the TPC occupancy around each collision, once per data frame for all the TPC and PID tasks.
+///        The collisions are sorted in time and the number of TPC tracks associated to them is summed in a prefix sum,
+///        such that the occupancy in the time window of a collision is a difference between the two window edges,
+///        which are found by binary search.
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+#include "tpcOccupancyTable.h"
+/// O2
+#include "CommonConstants/LHCConstants.h"
+#include "Framework/AnalysisTask.h"
+#include "Framework/runDataProcessing.h"
+
+using namespace o2;
+using namespace o2::framework;
+
+struct TpcOccupancyTableCreator {
+  Produces<aod::TPCOccupancies> tpcOccupancies;
+
+  Configurable<float> timeWindow{"timeWindow", 100.f, "Half width of the time window around the collision (us), the typical TPC drift time"};
+  Configurable<bool> requireMinCrossedRows{"requireMinCrossedRows", false, "Count only the TPC tracks with at least minCrossedRows crossed rows"};
+  Configurable<int> minCrossedRows{"minCrossedRows", 50, "Minimum number of crossed rows of the counted TPC tracks"};
+
+  using Trks = soa::Join<aod::Tracks, aod::TracksExtra>;
+
+  void process(aod::Collisions const& collisions, Trks const& tracks, aod::BCs const&)
+  {
+    const double bcNS = o2::constants::lhc::LHCBunchSpacingNS;
+    const double timeWindowNS = timeWindow * 1e3;
+
+    // TPC tracks per collision
+    std::vector<int> nTPCTracks(collisions.size(), 0);
+    for (const auto& track : tracks) {
+      if (!track.has_collision() || !track.hasTPC()) {
+        continue;
+      }
+      if (requireMinCrossedRows && track.tpcNClsCrossedRows() < minCrossedRows) {
+        continue;
+      }
+      nTPCTracks[track.collisionId()]++;
+    }
+
+    // collision times and time order
+    std::vector<double> times(collisions.size());
+    for (const auto& collision : collisions) {
+      times[collision.globalIndex()] = collision.bc().globalBC() * bcNS + collision.collisionTime();
+    }
+    std::vector<int> order(collisions.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return times[a] < times[b]; });
+    std::vector<double> sortedTimes(collisions.size());
+    std::vector<int64_t> cumulTPCTracks(collisions.size() + 1, 0);
+    for (size_t i = 0; i < order.size(); i++) {
+      sortedTimes[i] = times[order[i]];
+      cumulTPCTracks[i + 1] = cumulTPCTracks[i] + nTPCTracks[order[i]];
+    }
+
+    tpcOccupancies.reserve(collisions.size());
+    for (const auto& collision : collisions) {
+      const int iCol = collision.globalIndex();
+      const auto first = std::lower_bound(sortedTimes.begin(), sortedTimes.end(), times[iCol] - timeWindowNS) - sortedTimes.begin();
+      const auto last = std::upper_bound(sortedTimes.begin(), sortedTimes.end(), times[iCol] + timeWindowNS) - sortedTimes.begin();
+      // the collision itself is in the window and is subtracted
+      tpcOccupancies(cumulTPCTracks[last] - cumulTPCTracks[first] - nTPCTracks[iCol], last - first - 1);
+    }
+  }
+};
+
+WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
+{
+  return WorkflowSpec{adaptAnalysisTask<TpcOccupancyTableCreator>(cfgc)};
+}
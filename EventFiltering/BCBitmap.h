@@ -0,0 +1,284 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+//
+// Compressed set of selected global BCs, in the spirit of roaring bitmaps:
+// the BCs are split in chunks of 2^16 by their upper bits, and each chunk is stored either as a plain bitmap
+// or as a sorted list of runs of consecutive BCs, whichever is smaller. The chunks are sorted by key, such that
+// a membership test is a binary search on the chunks followed by a bit test or a binary search on the runs.
+
+#ifndef EVENTFILTERING_BCBITMAP_H_
+#define EVENTFILTERING_BCBITMAP_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+class BCBitmap
+{
+ public:
+  void clear() { mChunks.clear(); }
+  bool empty() const { return mChunks.empty(); }
+  size_t getNChunks() const { return mChunks.size(); }
+
+  // Adds the BCs from first to last (included)
+  void addRange(uint64_t first, uint64_t last)
+  {
+    while (first <= last) {
+      const uint64_t key = first >> kChunkBits;
+      const uint64_t chunkLast = std::min(last, (key << kChunkBits) | kChunkMask);
+      setBits(getBitmapChunk(key), first & kChunkMask, chunkLast & kChunkMask);
+      if (chunkLast == UINT64_MAX) {
+        break;
+      }
+      first = chunkLast + 1;
+    }
+  }
+  void add(uint64_t bc) { addRange(bc, bc); }
+
+  bool contains(uint64_t bc) const
+  {
+    const uint64_t key = bc >> kChunkBits;
+    auto chunk = std::lower_bound(mChunks.begin(), mChunks.end(), key, [](const Chunk& c, uint64_t k) { return c.key < k; });
+    if (chunk == mChunks.end() || chunk->key != key) {
+      return false;
+    }
+    const uint16_t low = bc & kChunkMask;
+    if (chunk->isBitmap) {
+      return (chunk->words[low >> 6] >> (low & 63)) & 1;
+    }
+    // runs are stored as (start, last) pairs sorted by start
+    const size_t nRuns = chunk->nValues / 2;
+    size_t lo = 0, hi = nRuns;
+    while (lo < hi) {
+      const size_t mid = (lo + hi) / 2;
+      if (getRunStart(*chunk, mid) <= low) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    return lo > 0 && getRunLast(*chunk, lo - 1) >= low;
+  }
+
+  // Calls rangeFunction(first, last) for the maximal ranges of consecutive BCs, in increasing order
+  template <typename RangeFunction>
+  void forEachRange(RangeFunction&& rangeFunction) const
+  {
+    bool open = false;
+    uint64_t rangeFirst = 0, rangeLast = 0;
+    auto addRun = [&](uint64_t first, uint64_t last) {
+      if (open && first == rangeLast + 1) {
+        rangeLast = last;
+        return;
+      }
+      if (open) {
+        rangeFunction(rangeFirst, rangeLast);
+      }
+      open = true;
+      rangeFirst = first;
+      rangeLast = last;
+    };
+    for (const auto& chunk : mChunks) {
+      const uint64_t base = chunk.key << kChunkBits;
+      if (chunk.isBitmap) {
+        forEachRun(chunk, [&](uint32_t first, uint32_t last) { addRun(base | first, base | last); });
+      } else {
+        for (size_t iRun = 0; iRun < chunk.nValues / 2; ++iRun) {
+          addRun(base | getRunStart(chunk, iRun), base | getRunLast(chunk, iRun));
+        }
+      }
+    }
+    if (open) {
+      rangeFunction(rangeFirst, rangeLast);
+    }
+  }
+
+  // Stores each chunk in its smallest representation, to be called once all the BCs are added
+  void optimize()
+  {
+    for (auto& chunk : mChunks) {
+      if (!chunk.isBitmap) {
+        continue;
+      }
+      uint32_t nRuns = 0;
+      forEachRun(chunk, [&](uint32_t, uint32_t) { nRuns++; });
+      if (nRuns * 2 * sizeof(uint16_t) >= kBitmapWords * sizeof(uint64_t)) {
+        continue;
+      }
+      // pack the (start, last) pairs of uint16 into the 64 bit words, 4 values per word
+      std::vector<uint64_t> packed((nRuns * 2 + 3) / 4, 0);
+      uint32_t iValue = 0;
+      forEachRun(chunk, [&](uint32_t first, uint32_t last) {
+        packed[iValue / 4] |= static_cast<uint64_t>(first) << (16 * (iValue % 4));
+        iValue++;
+        packed[iValue / 4] |= static_cast<uint64_t>(last) << (16 * (iValue % 4));
+        iValue++;
+      });
+      chunk.words.swap(packed);
+      chunk.nValues = nRuns * 2;
+      chunk.isBitmap = false;
+    }
+  }
+
+  // Serialised layout: magic, number of chunks, then per chunk key, type, number of 64 bit words, number of values and words
+  void serialize(std::vector<uint8_t>& buffer) const
+  {
+    buffer.clear();
+    auto write = [&buffer](const void* data, size_t size) {
+      const auto* bytes = static_cast<const uint8_t*>(data);
+      buffer.insert(buffer.end(), bytes, bytes + size);
+    };
+    const uint64_t nChunks = mChunks.size();
+    write(kMagic, sizeof(kMagic));
+    write(&nChunks, sizeof(nChunks));
+    for (const auto& chunk : mChunks) {
+      const uint64_t isBitmap = chunk.isBitmap;
+      const uint64_t nWords = chunk.words.size();
+      const uint64_t nValues = chunk.nValues;
+      write(&chunk.key, sizeof(chunk.key));
+      write(&isBitmap, sizeof(isBitmap));
+      write(&nWords, sizeof(nWords));
+      write(&nValues, sizeof(nValues));
+      write(chunk.words.data(), nWords * sizeof(uint64_t));
+    }
+  }
+
+  // Returns false, and leaves the bitmap empty, if the buffer is not a valid serialised bitmap
+  bool deserialize(const uint8_t* data, size_t size)
+  {
+    clear();
+    size_t position = 0;
+    auto read = [&](void* target, size_t length) {
+      if (position + length > size) {
+        return false;
+      }
+      std::memcpy(target, data + position, length);
+      position += length;
+      return true;
+    };
+    char magic[sizeof(kMagic)];
+    uint64_t nChunks = 0;
+    if (!read(magic, sizeof(magic)) || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0 || !read(&nChunks, sizeof(nChunks)) || nChunks > size / (4 * sizeof(uint64_t))) {
+      return false;
+    }
+    mChunks.resize(nChunks);
+    for (auto& chunk : mChunks) {
+      uint64_t isBitmap = 0, nWords = 0, nValues = 0;
+      if (!read(&chunk.key, sizeof(chunk.key)) || !read(&isBitmap, sizeof(isBitmap)) || !read(&nWords, sizeof(nWords)) || !read(&nValues, sizeof(nValues)) ||
+          nWords > kBitmapWords || (isBitmap && nWords != kBitmapWords) || (!isBitmap && nValues > nWords * 4)) {
+        clear();
+        return false;
+      }
+      if (&chunk != &mChunks.front() && (&chunk - 1)->key >= chunk.key) {
+        clear();
+        return false;
+      }
+      chunk.isBitmap = isBitmap;
+      chunk.nValues = nValues;
+      chunk.words.resize(nWords);
+      if (!read(chunk.words.data(), nWords * sizeof(uint64_t))) {
+        clear();
+        return false;
+      }
+    }
+    return true;
+  }
+  bool deserialize(const std::vector<uint8_t>& buffer) { return deserialize(buffer.data(), buffer.size()); }
+
+ private:
+  static constexpr int kChunkBits = 16;
+  static constexpr uint64_t kChunkMask = (1ull << kChunkBits) - 1;
+  static constexpr uint32_t kBitmapWords = (1u << kChunkBits) / 64;
+  static constexpr char kMagic[8] = {'B', 'C', 'B', 'I', 'T', 'M', 'A', 'P'};
+
+  struct Chunk {
+    uint64_t key = 0;         // upper bits of the BCs of the chunk
+    bool isBitmap = true;     // plain bitmap or list of runs
+    uint32_t nValues = 0;     // number of uint16 values packed in words for a list of runs
+    std::vector<uint64_t> words;
+  };
+  std::vector<Chunk> mChunks; // sorted by key
+
+  static uint16_t getValue(const Chunk& chunk, size_t iValue) { return chunk.words[iValue / 4] >> (16 * (iValue % 4)); }
+  static uint16_t getRunStart(const Chunk& chunk, size_t iRun) { return getValue(chunk, 2 * iRun); }
+  static uint16_t getRunLast(const Chunk& chunk, size_t iRun) { return getValue(chunk, 2 * iRun + 1); }
+
+  // Chunk of the given key as a bitmap, the BCs are added in time order most of the time such that the chunk is usually the last one
+  Chunk& getBitmapChunk(uint64_t key)
+  {
+    auto chunk = (!mChunks.empty() && mChunks.back().key < key) ? mChunks.end() : std::lower_bound(mChunks.begin(), mChunks.end(), key, [](const Chunk& c, uint64_t k) { return c.key < k; });
+    if (chunk == mChunks.end() || chunk->key != key) {
+      chunk = mChunks.insert(chunk, Chunk{});
+      chunk->key = key;
+      chunk->words.assign(kBitmapWords, 0);
+      return *chunk;
+    }
+    if (!chunk->isBitmap) {
+      std::vector<uint64_t> bits(kBitmapWords, 0);
+      for (size_t iRun = 0; iRun < chunk->nValues / 2; ++iRun) {
+        setBits(bits, getRunStart(*chunk, iRun), getRunLast(*chunk, iRun));
+      }
+      chunk->words.swap(bits);
+      chunk->isBitmap = true;
+      chunk->nValues = 0;
+    }
+    return *chunk;
+  }
+
+  static void setBits(std::vector<uint64_t>& words, uint32_t first, uint32_t last)
+  {
+    const uint32_t firstWord = first >> 6, lastWord = last >> 6;
+    const uint64_t firstMask = ~0ull << (first & 63);
+    const uint64_t lastMask = ~0ull >> (63 - (last & 63));
+    if (firstWord == lastWord) {
+      words[firstWord] |= firstMask & lastMask;
+      return;
+    }
+    words[firstWord] |= firstMask;
+    for (uint32_t iWord = firstWord + 1; iWord < lastWord; ++iWord) {
+      words[iWord] = ~0ull;
+    }
+    words[lastWord] |= lastMask;
+  }
+  static void setBits(Chunk& chunk, uint32_t first, uint32_t last) { setBits(chunk.words, first, last); }
+
+  // Calls runFunction(first, last) for the runs of set bits of a bitmap chunk, in increasing order
+  template <typename RunFunction>
+  static void forEachRun(const Chunk& chunk, RunFunction&& runFunction)
+  {
+    bool open = false;
+    uint32_t runFirst = 0;
+    for (uint32_t iWord = 0; iWord < kBitmapWords; ++iWord) {
+      const uint64_t word = chunk.words[iWord];
+      uint32_t bit = 0;
+      while (bit < 64) {
+        // next set bit if no run is open, next unset bit otherwise
+        const uint64_t candidates = (open ? ~word : word) & (~0ull << bit);
+        if (candidates == 0) {
+          break;
+        }
+        bit = __builtin_ctzll(candidates);
+        if (open) {
+          runFunction(runFirst, iWord * 64 + bit - 1);
+        } else {
+          runFirst = iWord * 64 + bit;
+        }
+        open = !open;
+      }
+    }
+    if (open) {
+      runFunction(runFirst, kBitmapWords * 64 - 1);
+    }
+  }
+};
+
+#endif // EVENTFILTERING_BCBITMAP_H_
@@ -25,6 +25,7 @@
 #include <string>
 
 #include "../filterTables.h"
+#include "CFFilterCore.h"
 
 #include "Framework/ASoAHelpers.h"
 #include "Framework/AnalysisDataModel.h"
@@ -45,6 +46,7 @@
 using namespace o2;
 using namespace o2::framework;
 using namespace o2::framework::expressions;
+using namespace o2::analysis::cffilter;
 
 namespace CFTrigger
 {
@@ -177,6 +179,7 @@ struct CFFilter {
 
   Configurable<int> ConfRngSeed{"ConfRngSeed", 69, "Seed for downsampling"};
   TRandom3* rng;
+  CFPrunedTriplets prunedTriplets; // keeps the buffers of the pruned triplet search between the events
 
   // Configs for events
   Configurable<bool> ConfIsRun3{
@@ -203,6 +206,14 @@ struct CFFilter {
     "ConfAutocorRejection",
     true,
     "Rejection autocorrelation pL pairs"};
+  Configurable<bool> ConfStopAtFirstCandidate{
+    "ConfStopAtFirstCandidate",
+    false,
+    "Stop the combinations of a trigger at its first candidate (the SE distributions are then incomplete)"};
+  Configurable<bool> ConfPrunedTripletSearch{
+    "ConfPrunedTripletSearch",
+    false,
+    "Only form the triplets whose pairs are all compatible with the Q3 limit (the SE distributions are then incomplete above it)"};
 
   // Configs for tracks
   Configurable<bool> ConfDeuteronThPVMom{
@@ -1179,47 +1190,6 @@ struct CFFilter {
     return true;
   }
 
-  float getkstar(const ROOT::Math::PtEtaPhiMVector part1,
-                 const ROOT::Math::PtEtaPhiMVector part2)
-  {
-    const ROOT::Math::PtEtaPhiMVector trackSum = part1 + part2;
-    const float beta = trackSum.Beta();
-    const float betax =
-      beta * std::cos(trackSum.Phi()) * std::sin(trackSum.Theta());
-    const float betay =
-      beta * std::sin(trackSum.Phi()) * std::sin(trackSum.Theta());
-    const float betaz = beta * std::cos(trackSum.Theta());
-    ROOT::Math::PxPyPzMVector PartOneCMS(part1);
-    ROOT::Math::PxPyPzMVector PartTwoCMS(part2);
-    const ROOT::Math::Boost boostPRF =
-      ROOT::Math::Boost(-betax, -betay, -betaz);
-    PartOneCMS = boostPRF(PartOneCMS);
-    PartTwoCMS = boostPRF(PartTwoCMS);
-    const ROOT::Math::PxPyPzMVector trackRelK = PartOneCMS - PartTwoCMS;
-    return 0.5 * trackRelK.P();
-  }
-
-  ROOT::Math::PxPyPzEVector getqij(const ROOT::Math::PtEtaPhiMVector parti,
-                                   const ROOT::Math::PtEtaPhiMVector partj)
-  {
-    ROOT::Math::PxPyPzEVector vecparti(parti);
-    ROOT::Math::PxPyPzEVector vecpartj(partj);
-    ROOT::Math::PxPyPzEVector trackSum = vecparti + vecpartj;
-    ROOT::Math::PxPyPzEVector trackDifference = vecparti - vecpartj;
-    float scaling = trackDifference.Dot(trackSum) / trackSum.Dot(trackSum);
-    return trackDifference - scaling * trackSum;
-  }
-  float getQ3(const ROOT::Math::PtEtaPhiMVector part1,
-              const ROOT::Math::PtEtaPhiMVector part2,
-              const ROOT::Math::PtEtaPhiMVector part3)
-  {
-    ROOT::Math::PxPyPzEVector q12 = getqij(part1, part2);
-    ROOT::Math::PxPyPzEVector q23 = getqij(part2, part3);
-    ROOT::Math::PxPyPzEVector q31 = getqij(part3, part1);
-    float Q32 = q12.M2() + q23.M2() + q31.M2();
-    return sqrt(-Q32);
-  }
-
   std::vector<double> setValuesBB(aod::BCsWithTimestamps::iterator const& bunchCrossing, const std::string ccdbPath)
   {
     map<string, string> metadata;
@@ -1330,12 +1300,8 @@ struct CFFilter {
       registry.fill(HIST("EventCuts/fMultiplicityAfter"), col.multNTracksPV());
       registry.fill(HIST("EventCuts/fZvtxAfter"), col.posZ());
 
-      // keep track of proton indices
-      std::vector<int> ProtonIndex = {};
-      std::vector<int> AntiProtonIndex = {};
-
-      // Prepare vectors for different species
-      std::vector<ROOT::Math::PtEtaPhiMVector> protons, antiprotons, deuterons, antideuterons, lambdas, antilambdas;
+      // Prepare vectors for different species, with the indices of their tracks to avoid selfcorrelations
+      CFParticles protons, antiprotons, deuterons, antideuterons, lambdas, antilambdas;
 
       // create deuteron and proton vectors (and corresponding antiparticles) for pair and triplet creation
       for (auto& track : tracks) {
@@ -1404,8 +1370,7 @@ struct CFFilter {
         if (isSelectedTrack(track, CFTrigger::kProton)) {
           ROOT::Math::PtEtaPhiMVector temp(track.pt(), track.eta(), track.phi(), mMassProton);
           if (track.sign() > 0 && isSelectedTrackPID(track, CFTrigger::kProton, false, nTPCSigmaP, 1)) {
-            protons.push_back(temp);
-            ProtonIndex.push_back(track.globalIndex());
+            protons.push_back({temp, {static_cast<int>(track.globalIndex()), -1}});
 
             registry.fill(HIST("TrackCuts/TracksBefore/fMomCorrelationAfterCutsProton"), track.p(), track.tpcInnerParam());
 
@@ -1433,8 +1398,7 @@ struct CFFilter {
             registry.fill(HIST("TrackCuts/Proton/fTPCnclsProton"), track.tpcNClsFound());
           }
           if (track.sign() < 0 && isSelectedTrackPID(track, CFTrigger::kProton, false, nTPCSigmaN, -1)) {
-            antiprotons.push_back(temp);
-            AntiProtonIndex.push_back(track.globalIndex());
+            antiprotons.push_back({temp, {static_cast<int>(track.globalIndex()), -1}});
 
             registry.fill(HIST("TrackCuts/TracksBefore/fMomCorrelationAfterCutsAntiProton"), track.p(), track.tpcInnerParam());
 
@@ -1464,7 +1428,7 @@ struct CFFilter {
         if (isSelectedTrack(track, CFTrigger::kDeuteron)) {
           ROOT::Math::PtEtaPhiMVector temp(track.pt(), track.eta(), track.phi(), mMassDeuteron);
           if (track.sign() > 0 && isSelectedTrackPID(track, CFTrigger::kDeuteron, ConfRejectNOTDeuteron.value, nTPCSigmaP, 1)) {
-            deuterons.push_back(temp);
+            deuterons.push_back({temp, {static_cast<int>(track.globalIndex()), -1}});
 
             registry.fill(HIST("TrackCuts/TracksBefore/fMomCorrelationAfterCutsDeuteron"), track.p(), track.tpcInnerParam());
 
@@ -1490,7 +1454,7 @@ struct CFFilter {
             registry.fill(HIST("TrackCuts/Deuteron/fTPCnclsDeuteron"), track.tpcNClsFound());
           }
           if (track.sign() < 0 && isSelectedTrackPID(track, CFTrigger::kDeuteron, ConfRejectNOTDeuteron.value, nTPCSigmaN, -1)) {
-            antideuterons.push_back(temp);
+            antideuterons.push_back({temp, {static_cast<int>(track.globalIndex()), -1}});
 
             registry.fill(HIST("TrackCuts/TracksBefore/fMomCorrelationAfterCutsAntiDeuteron"), track.p(), track.tpcInnerParam());
 
@@ -1518,12 +1482,6 @@ struct CFFilter {
         }
       }
 
-      // keep track of daugher indices to avoid selfcorrelations
-      std::vector<int> LambdaPosDaughIndex = {};
-      std::vector<int> LambdaNegDaughIndex = {};
-      std::vector<int> AntiLambdaPosDaughIndex = {};
-      std::vector<int> AntiLambdaNegDaughIndex = {};
-
       for (auto& v0 : fullV0s) {
 
         auto postrack = v0.template posTrack_as<aod::FemtoFullTracks>();
@@ -1575,9 +1533,7 @@ struct CFFilter {
 
         if (isSelectedMinimalV0(col, v0, postrack, negtrack, 1, nTPCSigmaPos, nTPCSigmaNeg)) {
           ROOT::Math::PtEtaPhiMVector temp(v0.pt(), v0.eta(), v0.phi(), mMassLambda);
-          lambdas.push_back(temp);
-          LambdaPosDaughIndex.push_back(postrack.globalIndex());
-          LambdaNegDaughIndex.push_back(negtrack.globalIndex());
+          lambdas.push_back({temp, {static_cast<int>(postrack.globalIndex()), static_cast<int>(negtrack.globalIndex())}});
           registry.fill(HIST("TrackCuts/TPCSignal/fTPCSignalProtonPlusV0Daughter"), postrack.tpcInnerParam(), postrack.tpcSignal());
           registry.fill(HIST("TrackCuts/TPCSignal/fTPCSignalPionMinusV0Daughter"), negtrack.tpcInnerParam(), negtrack.tpcSignal());
           registry.fill(HIST("TrackCuts/Lambda/fPtLambda"), v0.pt());
@@ -1601,9 +1557,7 @@ struct CFFilter {
         }
         if (isSelectedMinimalV0(col, v0, postrack, negtrack, -1, nTPCSigmaPos, nTPCSigmaNeg)) {
           ROOT::Math::PtEtaPhiMVector temp(v0.pt(), v0.eta(), v0.phi(), mMassLambda);
-          antilambdas.push_back(temp);
-          AntiLambdaPosDaughIndex.push_back(postrack.globalIndex());
-          AntiLambdaNegDaughIndex.push_back(negtrack.globalIndex());
+          antilambdas.push_back({temp, {static_cast<int>(postrack.globalIndex()), static_cast<int>(negtrack.globalIndex())}});
           registry.fill(HIST("TrackCuts/TPCSignal/fTPCSignalPionPlusV0Daughter"), postrack.tpcInnerParam(), postrack.tpcSignal());
           registry.fill(HIST("TrackCuts/TPCSignal/fTPCSignalProtonMinusV0Daughter"), negtrack.tpcInnerParam(), negtrack.tpcSignal());
           registry.fill(HIST("TrackCuts/AntiLambda/fPtAntiLambda"), v0.pt());
@@ -1627,349 +1581,252 @@ struct CFFilter {
         }
       }
 
-      float Q3 = 999.f, kstar = 999.f;
+      // the loops over the combinations of a trigger stop at its first candidate if requested
+      auto isFired3N = [&](int trigger) { return ConfStopAtFirstCandidate.value && lowQ3Triplets[trigger] > 0; };
+      auto isFired2N = [&](int trigger) { return ConfStopAtFirstCandidate.value && lowKstarPairs[trigger] > 0; };
+      // the triplets which cannot reach the Q3 limit are not formed if requested
+      auto loopTripletsQ3 = [&](const CFParticles& parts1, const CFParticles& parts2, const CFParticles& parts3, bool rejectSharedTracks, float Q3Limit, auto&& tripletFunction) {
+        if (ConfPrunedTripletSearch.value) {
+          return prunedTriplets.loop(parts1, parts2, parts3, rejectSharedTracks, Q3Limit, tripletFunction);
+        }
+        return loopTriplets(parts1, parts2, parts3, rejectSharedTracks, tripletFunction);
+      };
+
       if (ConfTriggerSwitches->get("Switch", "ppp") > 0.) {
         // ppp trigger
-        for (auto iProton1 = protons.begin(); iProton1 != protons.end(); ++iProton1) {
-          auto iProton2 = iProton1 + 1;
-          for (; iProton2 != protons.end(); ++iProton2) {
-            auto iProton3 = iProton2 + 1;
-            for (; iProton3 != protons.end(); ++iProton3) {
-              Q3 = getQ3(*iProton1, *iProton2, *iProton3);
-              registry.fill(HIST("ppp/fSE_particle"), Q3);
-              registry.fill(HIST("ppp/fProtonPtVsQ3"), Q3, (*iProton1).Pt());
-              registry.fill(HIST("ppp/fProtonPtVsQ3"), Q3, (*iProton2).Pt());
-              registry.fill(HIST("ppp/fProtonPtVsQ3"), Q3, (*iProton3).Pt());
-              if (Q3 < ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kPPP)) {
-                if (ConfDownsample->get("Switch", "PPP") > 0) {
-                  if (rng->Uniform(0., 1.) < ConfDownsample->get("Factor", "PPP")) {
-                    registry.fill(HIST("ppp/fSE_particle_downsample"), Q3);
-                    lowQ3Triplets[CFTrigger::kPPP] += 1;
-                  }
-                } else {
-                  lowQ3Triplets[CFTrigger::kPPP] += 1;
-                }
+        const float Q3Limit = ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kPPP);
+        loopTripletsQ3(protons, protons, protons, false, Q3Limit, [&](const CFParticle& proton1, const CFParticle& proton2, const CFParticle& proton3) {
+          const float Q3 = getQ3(proton1.momentum, proton2.momentum, proton3.momentum);
+          registry.fill(HIST("ppp/fSE_particle"), Q3);
+          registry.fill(HIST("ppp/fProtonPtVsQ3"), Q3, proton1.momentum.Pt());
+          registry.fill(HIST("ppp/fProtonPtVsQ3"), Q3, proton2.momentum.Pt());
+          registry.fill(HIST("ppp/fProtonPtVsQ3"), Q3, proton3.momentum.Pt());
+          if (Q3 < Q3Limit) {
+            if (ConfDownsample->get("Switch", "PPP") > 0) {
+              if (rng->Uniform(0., 1.) < ConfDownsample->get("Factor", "PPP")) {
+                registry.fill(HIST("ppp/fSE_particle_downsample"), Q3);
+                lowQ3Triplets[CFTrigger::kPPP] += 1;
               }
+            } else {
+              lowQ3Triplets[CFTrigger::kPPP] += 1;
             }
           }
-        }
-        for (auto iAntiProton1 = antiprotons.begin(); iAntiProton1 != antiprotons.end(); ++iAntiProton1) {
-          auto iAntiProton2 = iAntiProton1 + 1;
-          for (; iAntiProton2 != antiprotons.end(); ++iAntiProton2) {
-            auto iAntiProton3 = iAntiProton2 + 1;
-            for (; iAntiProton3 != antiprotons.end(); ++iAntiProton3) {
-              Q3 = getQ3(*iAntiProton1, *iAntiProton2, *iAntiProton3);
-              registry.fill(HIST("ppp/fSE_antiparticle"), Q3);
-              registry.fill(HIST("ppp/fAntiProtonPtVsQ3"), Q3, (*iAntiProton1).Pt());
-              registry.fill(HIST("ppp/fAntiProtonPtVsQ3"), Q3, (*iAntiProton2).Pt());
-              registry.fill(HIST("ppp/fAntiProtonPtVsQ3"), Q3, (*iAntiProton3).Pt());
-              if (Q3 < ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kPPP)) {
-                if (ConfDownsample->get("Switch", "aPaPaP") > 0) {
-                  if (rng->Uniform(0., 1.) < ConfDownsample->get("Factor", "aPaPaP")) {
-                    registry.fill(HIST("ppp/fSE_antiparticle_downsample"), Q3);
-                    lowQ3Triplets[CFTrigger::kPPP] += 1;
-                  }
-                } else {
-                  lowQ3Triplets[CFTrigger::kPPP] += 1;
-                }
+          return isFired3N(CFTrigger::kPPP);
+        });
+        loopTripletsQ3(antiprotons, antiprotons, antiprotons, false, Q3Limit, [&](const CFParticle& antiproton1, const CFParticle& antiproton2, const CFParticle& antiproton3) {
+          const float Q3 = getQ3(antiproton1.momentum, antiproton2.momentum, antiproton3.momentum);
+          registry.fill(HIST("ppp/fSE_antiparticle"), Q3);
+          registry.fill(HIST("ppp/fAntiProtonPtVsQ3"), Q3, antiproton1.momentum.Pt());
+          registry.fill(HIST("ppp/fAntiProtonPtVsQ3"), Q3, antiproton2.momentum.Pt());
+          registry.fill(HIST("ppp/fAntiProtonPtVsQ3"), Q3, antiproton3.momentum.Pt());
+          if (Q3 < Q3Limit) {
+            if (ConfDownsample->get("Switch", "aPaPaP") > 0) {
+              if (rng->Uniform(0., 1.) < ConfDownsample->get("Factor", "aPaPaP")) {
+                registry.fill(HIST("ppp/fSE_antiparticle_downsample"), Q3);
+                lowQ3Triplets[CFTrigger::kPPP] += 1;
               }
+            } else {
+              lowQ3Triplets[CFTrigger::kPPP] += 1;
             }
           }
-        }
+          return isFired3N(CFTrigger::kPPP);
+        });
       }
       if (ConfTriggerSwitches->get("Switch", "ppL") > 0.) {
         // ppl trigger
-        for (auto iProton1 = protons.begin(); iProton1 != protons.end(); ++iProton1) {
-          auto iProton2 = iProton1 + 1;
-          auto i1 = std::distance(protons.begin(), iProton1);
-          for (; iProton2 != protons.end(); ++iProton2) {
-            auto i2 = std::distance(protons.begin(), iProton2);
-            for (auto iLambda1 = lambdas.begin(); iLambda1 != lambdas.end(); ++iLambda1) {
-              auto i3 = std::distance(lambdas.begin(), iLambda1);
-              if (ConfAutocorRejection.value &&
-                  (ProtonIndex.at(i1) == LambdaPosDaughIndex.at(i3) ||
-                   ProtonIndex.at(i2) == LambdaPosDaughIndex.at(i3))) {
-                continue;
-              }
-              Q3 = getQ3(*iProton1, *iProton2, *iLambda1);
-              registry.fill(HIST("ppl/fSE_particle"), Q3);
-              registry.fill(HIST("ppl/fProtonPtVsQ3"), Q3, (*iProton1).Pt());
-              registry.fill(HIST("ppl/fProtonPtVsQ3"), Q3, (*iProton2).Pt());
-              registry.fill(HIST("ppl/fLambdaPtVsQ3"), Q3, (*iLambda1).Pt());
-              if (Q3 < ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kPPL)) {
-                if (ConfDownsample->get("Switch", "PPL") > 0) {
-                  if (rng->Uniform(0., 1.) < ConfDownsample->get("Factor", "PPL")) {
-                    registry.fill(HIST("ppl/fSE_particle_downsample"), Q3);
-                    lowQ3Triplets[CFTrigger::kPPL] += 1;
-                  }
-                } else {
-                  lowQ3Triplets[CFTrigger::kPPL] += 1;
-                }
+        const float Q3Limit = ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kPPL);
+        loopTripletsQ3(protons, protons, lambdas, ConfAutocorRejection.value, Q3Limit, [&](const CFParticle& proton1, const CFParticle& proton2, const CFParticle& lambda) {
+          const float Q3 = getQ3(proton1.momentum, proton2.momentum, lambda.momentum);
+          registry.fill(HIST("ppl/fSE_particle"), Q3);
+          registry.fill(HIST("ppl/fProtonPtVsQ3"), Q3, proton1.momentum.Pt());
+          registry.fill(HIST("ppl/fProtonPtVsQ3"), Q3, proton2.momentum.Pt());
+          registry.fill(HIST("ppl/fLambdaPtVsQ3"), Q3, lambda.momentum.Pt());
+          if (Q3 < Q3Limit) {
+            if (ConfDownsample->get("Switch", "PPL") > 0) {
+              if (rng->Uniform(0., 1.) < ConfDownsample->get("Factor", "PPL")) {
+                registry.fill(HIST("ppl/fSE_particle_downsample"), Q3);
+                lowQ3Triplets[CFTrigger::kPPL] += 1;
               }
+            } else {
+              lowQ3Triplets[CFTrigger::kPPL] += 1;
             }
           }
-        }
-        for (auto iAntiProton1 = antiprotons.begin(); iAntiProton1 != antiprotons.end(); ++iAntiProton1) {
-          auto iAntiProton2 = iAntiProton1 + 1;
-          auto i1 = std::distance(antiprotons.begin(), iAntiProton1);
-          for (; iAntiProton2 != antiprotons.end(); ++iAntiProton2) {
-            auto i2 = std::distance(antiprotons.begin(), iAntiProton2);
-            for (auto iAntiLambda1 = antilambdas.begin(); iAntiLambda1 != antilambdas.end(); ++iAntiLambda1) {
-              auto i3 = std::distance(antilambdas.begin(), iAntiLambda1);
-              if (ConfAutocorRejection.value &&
-                  (AntiProtonIndex.at(i1) == AntiLambdaNegDaughIndex.at(i3) ||
-                   AntiProtonIndex.at(i2) == AntiLambdaNegDaughIndex.at(i3))) {
-                continue;
-              }
-              Q3 = getQ3(*iAntiProton1, *iAntiProton2, *iAntiLambda1);
-              registry.fill(HIST("ppl/fSE_antiparticle"), Q3);
-              registry.fill(HIST("ppl/fAntiProtonPtVsQ3"), Q3, (*iAntiProton1).Pt());
-              registry.fill(HIST("ppl/fAntiProtonPtVsQ3"), Q3, (*iAntiProton2).Pt());
-              registry.fill(HIST("ppl/fAntiLambdaPtVsQ3"), Q3, (*iAntiLambda1).Pt());
-              if (Q3 < ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kPPL)) {
-                if (ConfDownsample->get("Switch", "aPaPaL") > 0) {
-                  if (rng->Uniform(0., 1.) < ConfDownsample->get("Factor", "aPaPaL")) {
-                    registry.fill(HIST("ppl/fSE_antiparticle_downsample"), Q3);
-                    lowQ3Triplets[CFTrigger::kPPL] += 1;
-                  }
-                } else {
-                  lowQ3Triplets[CFTrigger::kPPL] += 1;
-                }
+          return isFired3N(CFTrigger::kPPL);
+        });
+        loopTripletsQ3(antiprotons, antiprotons, antilambdas, ConfAutocorRejection.value, Q3Limit, [&](const CFParticle& antiproton1, const CFParticle& antiproton2, const CFParticle& antilambda) {
+          const float Q3 = getQ3(antiproton1.momentum, antiproton2.momentum, antilambda.momentum);
+          registry.fill(HIST("ppl/fSE_antiparticle"), Q3);
+          registry.fill(HIST("ppl/fAntiProtonPtVsQ3"), Q3, antiproton1.momentum.Pt());
+          registry.fill(HIST("ppl/fAntiProtonPtVsQ3"), Q3, antiproton2.momentum.Pt());
+          registry.fill(HIST("ppl/fAntiLambdaPtVsQ3"), Q3, antilambda.momentum.Pt());
+          if (Q3 < Q3Limit) {
+            if (ConfDownsample->get("Switch", "aPaPaL") > 0) {
+              if (rng->Uniform(0., 1.) < ConfDownsample->get("Factor", "aPaPaL")) {
+                registry.fill(HIST("ppl/fSE_antiparticle_downsample"), Q3);
+                lowQ3Triplets[CFTrigger::kPPL] += 1;
               }
+            } else {
+              lowQ3Triplets[CFTrigger::kPPL] += 1;
             }
           }
-        }
+          return isFired3N(CFTrigger::kPPL);
+        });
       }
       if (ConfTriggerSwitches->get("Switch", "pLL") > 0.) {
         // pll trigger
-        for (auto iLambda1 = lambdas.begin(); iLambda1 != lambdas.end(); ++iLambda1) {
-          auto iLambda2 = iLambda1 + 1;
-          auto i1 = std::distance(lambdas.begin(), iLambda1);
-          for (; iLambda2 != lambdas.end(); ++iLambda2) {
-            auto i2 = std::distance(lambdas.begin(), iLambda2);
-            if (ConfAutocorRejection.value &&
-                (LambdaPosDaughIndex.at(i1) == LambdaPosDaughIndex.at(i2) ||
-                 LambdaNegDaughIndex.at(i1) == LambdaNegDaughIndex.at(i2))) {
-              continue;
-            }
-            for (auto iProton1 = protons.begin(); iProton1 != protons.end(); ++iProton1) {
-              auto i3 = std::distance(protons.begin(), iProton1);
-              if (ConfAutocorRejection.value &&
-                  (LambdaPosDaughIndex.at(i1) == ProtonIndex.at(i3) ||
-                   LambdaPosDaughIndex.at(i2) == ProtonIndex.at(i3))) {
-                continue;
-              }
-              Q3 = getQ3(*iLambda1, *iLambda2, *iProton1);
-              registry.fill(HIST("pll/fSE_particle"), Q3);
-              registry.fill(HIST("pll/fProtonPtVsQ3"), Q3, (*iProton1).Pt());
-              registry.fill(HIST("pll/fLambdaPtVsQ3"), Q3, (*iLambda1).Pt());
-              registry.fill(HIST("pll/fLambdaPtVsQ3"), Q3, (*iLambda2).Pt());
-              if (Q3 < ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kPLL)) {
-                if (ConfDownsample->get("Switch", "PLL") > 0) {
-                  if (rng->Uniform(0., 1.) < ConfDownsample->get("Factor", "PLL")) {
-                    registry.fill(HIST("pll/fSE_particle_downsample"), Q3);
-                    lowQ3Triplets[CFTrigger::kPLL] += 1;
-                  }
-                } else {
-                  lowQ3Triplets[CFTrigger::kPLL] += 1;
-                }
+        const float Q3Limit = ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kPLL);
+        loopTripletsQ3(lambdas, lambdas, protons, ConfAutocorRejection.value, Q3Limit, [&](const CFParticle& lambda1, const CFParticle& lambda2, const CFParticle& proton) {
+          const float Q3 = getQ3(lambda1.momentum, lambda2.momentum, proton.momentum);
+          registry.fill(HIST("pll/fSE_particle"), Q3);
+          registry.fill(HIST("pll/fProtonPtVsQ3"), Q3, proton.momentum.Pt());
+          registry.fill(HIST("pll/fLambdaPtVsQ3"), Q3, lambda1.momentum.Pt());
+          registry.fill(HIST("pll/fLambdaPtVsQ3"), Q3, lambda2.momentum.Pt());
+          if (Q3 < Q3Limit) {
+            if (ConfDownsample->get("Switch", "PLL") > 0) {
+              if (rng->Uniform(0., 1.) < ConfDownsample->get("Factor", "PLL")) {
+                registry.fill(HIST("pll/fSE_particle_downsample"), Q3);
+                lowQ3Triplets[CFTrigger::kPLL] += 1;
               }
+            } else {
+              lowQ3Triplets[CFTrigger::kPLL] += 1;
             }
           }
-        }
-        for (auto iAntiLambda1 = antilambdas.begin(); iAntiLambda1 != antilambdas.end(); ++iAntiLambda1) {
-          auto iAntiLambda2 = iAntiLambda1 + 1;
-          auto i1 = std::distance(antilambdas.begin(), iAntiLambda1);
-          for (; iAntiLambda2 != antilambdas.end(); ++iAntiLambda2) {
-            auto i2 = std::distance(antilambdas.begin(), iAntiLambda2);
-            if (ConfAutocorRejection.value &&
-                (AntiLambdaPosDaughIndex.at(i1) == AntiLambdaPosDaughIndex.at(i2) ||
-                 AntiLambdaNegDaughIndex.at(i1) == AntiLambdaNegDaughIndex.at(i2))) {
-              continue;
-            }
-            for (auto iAntiProton1 = antiprotons.begin(); iAntiProton1 != antiprotons.end(); ++iAntiProton1) {
-              auto i3 = std::distance(antiprotons.begin(), iAntiProton1);
-              if (ConfAutocorRejection.value &&
-                  (AntiLambdaNegDaughIndex.at(i1) == AntiProtonIndex.at(i3) ||
-                   AntiLambdaNegDaughIndex.at(i2) == AntiProtonIndex.at(i3))) {
-                continue;
-              }
-              Q3 = getQ3(*iAntiLambda1, *iAntiLambda2, *iAntiProton1);
-              registry.fill(HIST("pll/fSE_antiparticle"), Q3);
-              registry.fill(HIST("pll/fAntiProtonPtVsQ3"), Q3, (*iAntiProton1).Pt());
-              registry.fill(HIST("pll/fAntiLambdaPtVsQ3"), Q3, (*iAntiLambda1).Pt());
-              registry.fill(HIST("pll/fAntiLambdaPtVsQ3"), Q3, (*iAntiLambda2).Pt());
-              if (Q3 < ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kPLL)) {
-                if (ConfDownsample->get("Switch", "aPaLaL") > 0) {
-                  if (rng->Uniform(0., 1.) < ConfDownsample->get("Factor", "aPaLaL")) {
-                    registry.fill(HIST("pll/fSE_antiparticle_downsample"), Q3);
-                    lowQ3Triplets[CFTrigger::kPLL] += 1;
-                  }
-                } else {
-                  lowQ3Triplets[CFTrigger::kPLL] += 1;
-                }
+          return isFired3N(CFTrigger::kPLL);
+        });
+        loopTripletsQ3(antilambdas, antilambdas, antiprotons, ConfAutocorRejection.value, Q3Limit, [&](const CFParticle& antilambda1, const CFParticle& antilambda2, const CFParticle& antiproton) {
+          const float Q3 = getQ3(antilambda1.momentum, antilambda2.momentum, antiproton.momentum);
+          registry.fill(HIST("pll/fSE_antiparticle"), Q3);
+          registry.fill(HIST("pll/fAntiProtonPtVsQ3"), Q3, antiproton.momentum.Pt());
+          registry.fill(HIST("pll/fAntiLambdaPtVsQ3"), Q3, antilambda1.momentum.Pt());
+          registry.fill(HIST("pll/fAntiLambdaPtVsQ3"), Q3, antilambda2.momentum.Pt());
+          if (Q3 < Q3Limit) {
+            if (ConfDownsample->get("Switch", "aPaLaL") > 0) {
+              if (rng->Uniform(0., 1.) < ConfDownsample->get("Factor", "aPaLaL")) {
+                registry.fill(HIST("pll/fSE_antiparticle_downsample"), Q3);
+                lowQ3Triplets[CFTrigger::kPLL] += 1;
               }
+            } else {
+              lowQ3Triplets[CFTrigger::kPLL] += 1;
             }
           }
-        }
+          return isFired3N(CFTrigger::kPLL);
+        });
       }
       if (ConfTriggerSwitches->get("Switch", "LLL") > 0.) {
         // lll trigger
-        for (auto iLambda1 = lambdas.begin(); iLambda1 != lambdas.end(); ++iLambda1) {
-          auto iLambda2 = iLambda1 + 1;
-          auto i1 = std::distance(lambdas.begin(), iLambda1);
-          for (; iLambda2 != lambdas.end(); ++iLambda2) {
-            auto i2 = std::distance(lambdas.begin(), iLambda2);
-            if (ConfAutocorRejection.value &&
-                (LambdaPosDaughIndex.at(i1) == LambdaPosDaughIndex.at(i2) ||
-                 LambdaNegDaughIndex.at(i1) == LambdaNegDaughIndex.at(i2))) {
-              continue;
-            }
-            auto iLambda3 = iLambda2 + 1;
-            for (; iLambda3 != lambdas.end(); ++iLambda3) {
-              auto i3 = std::distance(lambdas.begin(), iLambda3);
-              if (ConfAutocorRejection.value &&
-                  (LambdaPosDaughIndex.at(i1) == LambdaPosDaughIndex.at(i3) ||
-                   LambdaNegDaughIndex.at(i1) == LambdaNegDaughIndex.at(i3) ||
-                   LambdaPosDaughIndex.at(i2) == LambdaPosDaughIndex.at(i3) ||
-                   LambdaNegDaughIndex.at(i2) == LambdaNegDaughIndex.at(i3))) {
-                continue;
-              }
-              Q3 = getQ3(*iLambda1, *iLambda2, *iLambda3);
-              registry.fill(HIST("lll/fSE_particle"), Q3);
-              registry.fill(HIST("lll/fLambdaPtVsQ3"), Q3, (*iLambda1).Pt());
-              registry.fill(HIST("lll/fLambdaPtVsQ3"), Q3, (*iLambda2).Pt());
-              registry.fill(HIST("lll/fLambdaPtVsQ3"), Q3, (*iLambda3).Pt());
-              if (Q3 < ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kLLL)) {
-                if (ConfDownsample->get("Switch", "LLL") > 0) {
-                  if (rng->Uniform(0., 1.) < ConfDownsample->get("Factor", "LLL")) {
-                    registry.fill(HIST("lll/fSE_particle_downsample"), Q3);
-                    lowQ3Triplets[CFTrigger::kLLL] += 1;
-                  }
-                } else {
-                  lowQ3Triplets[CFTrigger::kLLL] += 1;
-                }
+        const float Q3Limit = ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kLLL);
+        loopTripletsQ3(lambdas, lambdas, lambdas, ConfAutocorRejection.value, Q3Limit, [&](const CFParticle& lambda1, const CFParticle& lambda2, const CFParticle& lambda3) {
+          const float Q3 = getQ3(lambda1.momentum, lambda2.momentum, lambda3.momentum);
+          registry.fill(HIST("lll/fSE_particle"), Q3);
+          registry.fill(HIST("lll/fLambdaPtVsQ3"), Q3, lambda1.momentum.Pt());
+          registry.fill(HIST("lll/fLambdaPtVsQ3"), Q3, lambda2.momentum.Pt());
+          registry.fill(HIST("lll/fLambdaPtVsQ3"), Q3, lambda3.momentum.Pt());
+          if (Q3 < Q3Limit) {
+            if (ConfDownsample->get("Switch", "LLL") > 0) {
+              if (rng->Uniform(0., 1.) < ConfDownsample->get("Factor", "LLL")) {
+                registry.fill(HIST("lll/fSE_particle_downsample"), Q3);
+                lowQ3Triplets[CFTrigger::kLLL] += 1;
               }
+            } else {
+              lowQ3Triplets[CFTrigger::kLLL] += 1;
             }
           }
-        }
-        for (auto iAntiLambda1 = antilambdas.begin(); iAntiLambda1 != antilambdas.end(); ++iAntiLambda1) {
-          auto iAntiLambda2 = iAntiLambda1 + 1;
-          auto i1 = std::distance(antilambdas.begin(), iAntiLambda1);
-          for (; iAntiLambda2 != antilambdas.end(); ++iAntiLambda2) {
-            auto i2 = std::distance(antilambdas.begin(), iAntiLambda2);
-            if (ConfAutocorRejection.value &&
-                (AntiLambdaPosDaughIndex.at(i1) == AntiLambdaPosDaughIndex.at(i2) ||
-                 AntiLambdaNegDaughIndex.at(i1) == AntiLambdaNegDaughIndex.at(i2))) {
-              continue;
-            }
-            auto iAntiLambda3 = iAntiLambda2 + 1;
-            for (; iAntiLambda3 != antilambdas.end(); ++iAntiLambda3) {
-              auto i3 = std::distance(antilambdas.begin(), iAntiLambda3);
-              if (ConfAutocorRejection.value &&
-                  (AntiLambdaPosDaughIndex.at(i1) == AntiLambdaPosDaughIndex.at(i3) ||
-                   AntiLambdaNegDaughIndex.at(i1) == AntiLambdaNegDaughIndex.at(i3) ||
-                   AntiLambdaPosDaughIndex.at(i2) == AntiLambdaPosDaughIndex.at(i3) ||
-                   AntiLambdaNegDaughIndex.at(i2) == AntiLambdaNegDaughIndex.at(i3))) {
-                continue;
-              }
-              Q3 = getQ3(*iAntiLambda1, *iAntiLambda2, *iAntiLambda3);
-              registry.fill(HIST("lll/fSE_antiparticle"), Q3);
-              registry.fill(HIST("lll/fAntiLambdaPtVsQ3"), Q3, (*iAntiLambda1).Pt());
-              registry.fill(HIST("lll/fAntiLambdaPtVsQ3"), Q3, (*iAntiLambda2).Pt());
-              registry.fill(HIST("lll/fAntiLambdaPtVsQ3"), Q3, (*iAntiLambda3).Pt());
-              if (Q3 < ConfQ3Limits->get(static_cast<uint>(0), CFTrigger::kLLL)) {
-                if (ConfDownsample->get("Switch", "aLaLaL") > 0) {
-                  if (rng->Uniform(0., 1.) < ConfDownsample->get("Factor", "aLaLaL")) {
-                    registry.fill(HIST("lll/fSE_antiparticle_downsample"), Q3);
-                    lowQ3Triplets[CFTrigger::kLLL] += 1;
-                  }
-                } else {
-                  lowQ3Triplets[CFTrigger::kLLL] += 1;
-                }
+          return isFired3N(CFTrigger::kLLL);
+        });
+        loopTripletsQ3(antilambdas, antilambdas, antilambdas, ConfAutocorRejection.value, Q3Limit, [&](const CFParticle& antilambda1, const CFParticle& antilambda2, const CFParticle& antilambda3) {
+          const float Q3 = getQ3(antilambda1.momentum, antilambda2.momentum, antilambda3.momentum);
+          registry.fill(HIST("lll/fSE_antiparticle"), Q3);
+          registry.fill(HIST("lll/fAntiLambdaPtVsQ3"), Q3, antilambda1.momentum.Pt());
+          registry.fill(HIST("lll/fAntiLambdaPtVsQ3"), Q3, antilambda2.momentum.Pt());
+          registry.fill(HIST("lll/fAntiLambdaPtVsQ3"), Q3, antilambda3.momentum.Pt());
+          if (Q3 < Q3Limit) {
+            if (ConfDownsample->get("Switch", "aLaLaL") > 0) {
+              if (rng->Uniform(0., 1.) < ConfDownsample->get("Factor", "aLaLaL")) {
+                registry.fill(HIST("lll/fSE_antiparticle_downsample"), Q3);
+                lowQ3Triplets[CFTrigger::kLLL] += 1;
               }
+            } else {
+              lowQ3Triplets[CFTrigger::kLLL] += 1;
             }
           }
-        }
+          return isFired3N(CFTrigger::kLLL);
+        });
       }
       if (ConfTriggerSwitches->get("Switch", "pd") > 0.) {
         // pd trigger
-        for (auto iProton = protons.begin(); iProton != protons.end(); ++iProton) {
-          for (auto iDeuteron = deuterons.begin(); iDeuteron != deuterons.end(); ++iDeuteron) {
-            kstar = getkstar(*iProton, *iDeuteron);
-            registry.fill(HIST("pd/fSE_particle"), kstar);
-            registry.fill(HIST("pd/fProtonPtVskstar"), kstar, (*iProton).Pt());
-            registry.fill(HIST("pd/fDeuteronPtVskstar"), kstar, (*iDeuteron).Pt());
-            if (kstar < ConfKstarLimits->get(static_cast<uint>(0), CFTrigger::kPD)) {
-              if (ConfDownsample->get("Switch", "PD") > 0) {
-                if (rng->Uniform(0., 1.) < ConfDownsample->get("Factor", "PD")) {
-                  registry.fill(HIST("pd/fSE_particle_downsample"), kstar);
-                  lowKstarPairs[CFTrigger::kPD] += 1;
-                }
-              } else {
+        const float kstarLimit = ConfKstarLimits->get(static_cast<uint>(0), CFTrigger::kPD);
+        loopPairs(protons, deuterons, false, [&](const CFParticle& proton, const CFParticle& deuteron) {
+          const float kstar = getkstar(proton.momentum, deuteron.momentum);
+          registry.fill(HIST("pd/fSE_particle"), kstar);
+          registry.fill(HIST("pd/fProtonPtVskstar"), kstar, proton.momentum.Pt());
+          registry.fill(HIST("pd/fDeuteronPtVskstar"), kstar, deuteron.momentum.Pt());
+          if (kstar < kstarLimit) {
+            if (ConfDownsample->get("Switch", "PD") > 0) {
+              if (rng->Uniform(0., 1.) < ConfDownsample->get("Factor", "PD")) {
+                registry.fill(HIST("pd/fSE_particle_downsample"), kstar);
                 lowKstarPairs[CFTrigger::kPD] += 1;
               }
+            } else {
+              lowKstarPairs[CFTrigger::kPD] += 1;
             }
           }
-        }
-
-        for (auto iAntiProton = antiprotons.begin(); iAntiProton != antiprotons.end(); ++iAntiProton) {
-          for (auto iAntiDeuteron = antideuterons.begin(); iAntiDeuteron != antideuterons.end(); ++iAntiDeuteron) {
-            kstar = getkstar(*iAntiProton, *iAntiDeuteron);
-            registry.fill(HIST("pd/fSE_antiparticle"), kstar);
-            registry.fill(HIST("pd/fAntiProtonPtVskstar"), kstar, (*iAntiProton).Pt());
-            registry.fill(HIST("pd/fAntiDeuteronPtVskstar"), kstar, (*iAntiDeuteron).Pt());
-            if (kstar < ConfKstarLimits->get(static_cast<uint>(0), CFTrigger::kPD)) {
-              if (ConfDownsample->get("Switch", "aPaD") > 0) {
-                if (rng->Uniform(0., 1.) < ConfDownsample->get("Factor", "aPaD")) {
-                  registry.fill(HIST("pd/fSE_antiparticle_downsample"), kstar);
-                  lowKstarPairs[CFTrigger::kPD] += 1;
-                }
-              } else {
+          return isFired2N(CFTrigger::kPD);
+        });
+        loopPairs(antiprotons, antideuterons, false, [&](const CFParticle& antiproton, const CFParticle& antideuteron) {
+          const float kstar = getkstar(antiproton.momentum, antideuteron.momentum);
+          registry.fill(HIST("pd/fSE_antiparticle"), kstar);
+          registry.fill(HIST("pd/fAntiProtonPtVskstar"), kstar, antiproton.momentum.Pt());
+          registry.fill(HIST("pd/fAntiDeuteronPtVskstar"), kstar, antideuteron.momentum.Pt());
+          if (kstar < kstarLimit) {
+            if (ConfDownsample->get("Switch", "aPaD") > 0) {
+              if (rng->Uniform(0., 1.) < ConfDownsample->get("Factor", "aPaD")) {
+                registry.fill(HIST("pd/fSE_antiparticle_downsample"), kstar);
                 lowKstarPairs[CFTrigger::kPD] += 1;
               }
+            } else {
+              lowKstarPairs[CFTrigger::kPD] += 1;
             }
           }
-        }
+          return isFired2N(CFTrigger::kPD);
+        });
       }
       if (ConfTriggerSwitches->get("Switch", "Ld") > 0.) {
         // ld trigger
-        for (auto iDeuteron = deuterons.begin(); iDeuteron != deuterons.end(); ++iDeuteron) {
-          for (auto iLambda = lambdas.begin(); iLambda != lambdas.end(); ++iLambda) {
-            kstar = getkstar(*iDeuteron, *iLambda);
-            registry.fill(HIST("ld/fSE_particle"), kstar);
-            registry.fill(HIST("ld/fDeuteronPtVskstar"), kstar, (*iDeuteron).Pt());
-            registry.fill(HIST("ld/fLambdaPtVskstar"), kstar, (*iLambda).Pt());
-            if (kstar < ConfKstarLimits->get(static_cast<uint>(0), CFTrigger::kLD)) {
-              if (ConfDownsample->get("Switch", "LD") > 0) {
-                if (rng->Uniform(0., 1.) < ConfDownsample->get("Factor", "LD")) {
-                  registry.fill(HIST("ld/fSE_particle_downsample"), kstar);
-                  lowKstarPairs[CFTrigger::kLD] += 1;
-                }
-              } else {
+        const float kstarLimit = ConfKstarLimits->get(static_cast<uint>(0), CFTrigger::kLD);
+        loopPairs(deuterons, lambdas, false, [&](const CFParticle& deuteron, const CFParticle& lambda) {
+          const float kstar = getkstar(deuteron.momentum, lambda.momentum);
+          registry.fill(HIST("ld/fSE_particle"), kstar);
+          registry.fill(HIST("ld/fDeuteronPtVskstar"), kstar, deuteron.momentum.Pt());
+          registry.fill(HIST("ld/fLambdaPtVskstar"), kstar, lambda.momentum.Pt());
+          if (kstar < kstarLimit) {
+            if (ConfDownsample->get("Switch", "LD") > 0) {
+              if (rng->Uniform(0., 1.) < ConfDownsample->get("Factor", "LD")) {
+                registry.fill(HIST("ld/fSE_particle_downsample"), kstar);
                 lowKstarPairs[CFTrigger::kLD] += 1;
               }
+            } else {
+              lowKstarPairs[CFTrigger::kLD] += 1;
             }
           }
-        }
-        for (auto iAntiDeuteron = antideuterons.begin(); iAntiDeuteron != antideuterons.end(); ++iAntiDeuteron) {
-          for (auto iAntiLambda = antilambdas.begin(); iAntiLambda != antilambdas.end(); ++iAntiLambda) {
-            kstar = getkstar(*iAntiDeuteron, *iAntiLambda);
-            registry.fill(HIST("ld/fSE_antiparticle"), kstar);
-            registry.fill(HIST("ld/fAntiDeuteronPtVskstar"), kstar, (*iAntiDeuteron).Pt());
-            registry.fill(HIST("ld/fAntiLambdaPtVskstar"), kstar, (*iAntiLambda).Pt());
-            if (kstar < ConfKstarLimits->get(static_cast<uint>(0), CFTrigger::kLD)) {
-              if (ConfDownsample->get("Switch", "aLaD") > 0) {
-                if (rng->Uniform(0., 1.) < ConfDownsample->get("Factor", "aLaD")) {
-                  registry.fill(HIST("ld/fSE_antiparticle_downsample"), kstar);
-                  lowKstarPairs[CFTrigger::kLD] += 1;
-                }
-              } else {
+          return isFired2N(CFTrigger::kLD);
+        });
+        loopPairs(antideuterons, antilambdas, false, [&](const CFParticle& antideuteron, const CFParticle& antilambda) {
+          const float kstar = getkstar(antideuteron.momentum, antilambda.momentum);
+          registry.fill(HIST("ld/fSE_antiparticle"), kstar);
+          registry.fill(HIST("ld/fAntiDeuteronPtVskstar"), kstar, antideuteron.momentum.Pt());
+          registry.fill(HIST("ld/fAntiLambdaPtVskstar"), kstar, antilambda.momentum.Pt());
+          if (kstar < kstarLimit) {
+            if (ConfDownsample->get("Switch", "aLaD") > 0) {
+              if (rng->Uniform(0., 1.) < ConfDownsample->get("Factor", "aLaD")) {
+                registry.fill(HIST("ld/fSE_antiparticle_downsample"), kstar);
                 lowKstarPairs[CFTrigger::kLD] += 1;
               }
+            } else {
+              lowKstarPairs[CFTrigger::kLD] += 1;
             }
           }
-        }
+          return isFired2N(CFTrigger::kLD);
+        });
       }
     } // if(isSelectedEvent)
 
@@ -0,0 +1,233 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file CFFilterCore.h
+/// \brief Common kinematics and pair/triplet loops of the CF femto triggers
+///
+/// The particles of a collision are selected once per species into a CFParticles array, which keeps the momentum
+/// together with the global indices of the tracks it is built from (the track itself or the V0 daughters).
+/// The triggers then only declare the species they combine and their limit on k* or Q3, and run the loops below.
+
+#ifndef EVENTFILTERING_PWGCF_CFFILTERCORE_H_
+#define EVENTFILTERING_PWGCF_CFFILTERCORE_H_
+
+#include <Math/GenVector/Boost.h>
+#include <Math/Vector4D.h>
+
+#include <array>
+#include <cmath>
+#include <vector>
+
+namespace o2::analysis::cffilter
+{
+
+/// Selected particle: momentum and global indices of its tracks, -1 if unused
+struct CFParticle {
+  ROOT::Math::PtEtaPhiMVector momentum;
+  std::array<int, 2> tracks = {-1, -1};
+};
+
+using CFParticles = std::vector<CFParticle>;
+
+/// k* of a pair, in the pair rest frame
+inline float getkstar(const ROOT::Math::PtEtaPhiMVector part1,
+                      const ROOT::Math::PtEtaPhiMVector part2)
+{
+  const ROOT::Math::PtEtaPhiMVector trackSum = part1 + part2;
+  const float beta = trackSum.Beta();
+  const float betax =
+    beta * std::cos(trackSum.Phi()) * std::sin(trackSum.Theta());
+  const float betay =
+    beta * std::sin(trackSum.Phi()) * std::sin(trackSum.Theta());
+  const float betaz = beta * std::cos(trackSum.Theta());
+  ROOT::Math::PxPyPzMVector PartOneCMS(part1);
+  ROOT::Math::PxPyPzMVector PartTwoCMS(part2);
+  const ROOT::Math::Boost boostPRF =
+    ROOT::Math::Boost(-betax, -betay, -betaz);
+  PartOneCMS = boostPRF(PartOneCMS);
+  PartTwoCMS = boostPRF(PartTwoCMS);
+  const ROOT::Math::PxPyPzMVector trackRelK = PartOneCMS - PartTwoCMS;
+  return 0.5 * trackRelK.P();
+}
+
+/// Relative four-momentum of a pair, orthogonal to the pair four-momentum
+inline ROOT::Math::PxPyPzEVector getqij(const ROOT::Math::PtEtaPhiMVector parti,
+                                        const ROOT::Math::PtEtaPhiMVector partj)
+{
+  ROOT::Math::PxPyPzEVector vecparti(parti);
+  ROOT::Math::PxPyPzEVector vecpartj(partj);
+  ROOT::Math::PxPyPzEVector trackSum = vecparti + vecpartj;
+  ROOT::Math::PxPyPzEVector trackDifference = vecparti - vecpartj;
+  float scaling = trackDifference.Dot(trackSum) / trackSum.Dot(trackSum);
+  return trackDifference - scaling * trackSum;
+}
+
+/// Q3 of a triplet, sqrt(-(q12^2 + q23^2 + q31^2))
+inline float getQ3(const ROOT::Math::PtEtaPhiMVector part1,
+                   const ROOT::Math::PtEtaPhiMVector part2,
+                   const ROOT::Math::PtEtaPhiMVector part3)
+{
+  ROOT::Math::PxPyPzEVector q12 = getqij(part1, part2);
+  ROOT::Math::PxPyPzEVector q23 = getqij(part2, part3);
+  ROOT::Math::PxPyPzEVector q31 = getqij(part3, part1);
+  float Q32 = q12.M2() + q23.M2() + q31.M2();
+  return sqrt(-Q32);
+}
+
+/// Whether two particles are built from a common track
+inline bool shareTrack(const CFParticle& part1, const CFParticle& part2)
+{
+  for (const auto track1 : part1.tracks) {
+    if (track1 < 0) {
+      continue;
+    }
+    for (const auto track2 : part2.tracks) {
+      if (track1 == track2) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+/// Loop over the pairs of particles from parts1 and parts2
+/// The pairs of a species with itself are taken once, when parts1 and parts2 are the same array.
+/// \param rejectSharedTracks skip the pairs of particles sharing a track
+/// \param pairFunction called with (particle 1, particle 2), the loop stops when it returns true
+/// \return whether the loop was stopped by pairFunction
+template <typename PairFunction>
+bool loopPairs(const CFParticles& parts1, const CFParticles& parts2, bool rejectSharedTracks, PairFunction&& pairFunction)
+{
+  const bool sameSpecies = &parts1 == &parts2;
+  for (size_t i1 = 0; i1 < parts1.size(); ++i1) {
+    for (size_t i2 = sameSpecies ? i1 + 1 : 0; i2 < parts2.size(); ++i2) {
+      if (rejectSharedTracks && shareTrack(parts1[i1], parts2[i2])) {
+        continue;
+      }
+      if (pairFunction(parts1[i1], parts2[i2])) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+/// Loop over the triplets of particles from parts1, parts2 and parts3
+/// Identical species have to be passed as the same array in consecutive positions (e.g. p, p, Lambda),
+/// their combinations are then taken once. Pairs sharing a track are skipped before the loop over the third particle.
+/// \param rejectSharedTracks skip the triplets with particles sharing a track
+/// \param tripletFunction called with (particle 1, particle 2, particle 3), the loop stops when it returns true
+/// \return whether the loop was stopped by tripletFunction
+template <typename TripletFunction>
+bool loopTriplets(const CFParticles& parts1, const CFParticles& parts2, const CFParticles& parts3, bool rejectSharedTracks, TripletFunction&& tripletFunction)
+{
+  const bool sameSpecies12 = &parts1 == &parts2;
+  const bool sameSpecies23 = &parts2 == &parts3;
+  for (size_t i1 = 0; i1 < parts1.size(); ++i1) {
+    for (size_t i2 = sameSpecies12 ? i1 + 1 : 0; i2 < parts2.size(); ++i2) {
+      if (rejectSharedTracks && shareTrack(parts1[i1], parts2[i2])) {
+        continue;
+      }
+      for (size_t i3 = sameSpecies23 ? i2 + 1 : 0; i3 < parts3.size(); ++i3) {
+        if (rejectSharedTracks && (shareTrack(parts1[i1], parts3[i3]) || shareTrack(parts2[i2], parts3[i3]))) {
+          continue;
+        }
+        if (tripletFunction(parts1[i1], parts2[i2], parts3[i3])) {
+          return true;
+        }
+      }
+    }
+  }
+  return false;
+}
+
+/// \class CFPrunedTriplets
+/// \brief Loop over the triplets which can fulfil Q3 < Q3Max
+/// Q3^2 = -(q12^2 + q23^2 + q31^2) with all -qij^2 >= 0 (qij is orthogonal to the time-like pair momentum),
+/// hence Q3 >= sqrt(-qij^2) for each pair of the triplet. The pairs with -qij^2 >= Q3Max^2 are computed once,
+/// and the third particle is only searched in the intersection of the sorted partner lists of the first two.
+/// A triplet with Q3 < Q3Max is never pruned, and the triplets are visited in the same order as by loopTriplets.
+class CFPrunedTriplets
+{
+ public:
+  /// Same as loopTriplets, for the triplets whose pairs are all compatible with Q3 < Q3Max
+  template <typename TripletFunction>
+  bool loop(const CFParticles& parts1, const CFParticles& parts2, const CFParticles& parts3, bool rejectSharedTracks, float Q3Max, TripletFunction&& tripletFunction)
+  {
+    const bool sameSpecies12 = &parts1 == &parts2;
+    const bool sameSpecies23 = &parts2 == &parts3;
+    fillPartners(parts1, parts2, sameSpecies12, Q3Max, mPartners12);
+    // the partner lists of particles 1 and 2 in parts3 are the same when 1 and 2 are of the same species
+    fillPartners(parts2, parts3, sameSpecies23, Q3Max, mPartners23);
+    const auto& partners13 = sameSpecies12 ? mPartners23 : fillPartners(parts1, parts3, false, Q3Max, mPartners13);
+    for (size_t i1 = 0; i1 < parts1.size(); ++i1) {
+      const auto& candidates1 = partners13[i1];
+      for (const auto i2 : mPartners12[i1]) {
+        if (rejectSharedTracks && shareTrack(parts1[i1], parts2[i2])) {
+          continue;
+        }
+        const auto& candidates2 = mPartners23[i2];
+        auto it1 = candidates1.begin();
+        auto it2 = candidates2.begin();
+        while (it1 != candidates1.end() && it2 != candidates2.end()) {
+          if (*it1 < *it2) {
+            ++it1;
+          } else if (*it2 < *it1) {
+            ++it2;
+          } else {
+            const auto i3 = *it1;
+            ++it1;
+            ++it2;
+            if (rejectSharedTracks && (shareTrack(parts1[i1], parts3[i3]) || shareTrack(parts2[i2], parts3[i3]))) {
+              continue;
+            }
+            if (tripletFunction(parts1[i1], parts2[i2], parts3[i3])) {
+              return true;
+            }
+          }
+        }
+      }
+    }
+    return false;
+  }
+
+ private:
+  std::vector<std::vector<int>> mPartners12; // partners in parts2 of each particle of parts1
+  std::vector<std::vector<int>> mPartners13; // partners in parts3 of each particle of parts1
+  std::vector<std::vector<int>> mPartners23; // partners in parts3 of each particle of parts2
+
+  /// Sorted lists of the partners in partsB of each particle of partsA, with -qij^2 < Q3Max^2
+  /// For the same species only the partners with a higher index are kept.
+  static const std::vector<std::vector<int>>& fillPartners(const CFParticles& partsA, const CFParticles& partsB, bool sameSpecies, float Q3Max, std::vector<std::vector<int>>& partners)
+  {
+    // margin for the rounding of Q3, which is computed in single precision
+    const double maxQ2 = 1.001 * Q3Max * Q3Max;
+    partners.resize(partsA.size());
+    for (auto& list : partners) {
+      list.clear();
+    }
+    if (Q3Max <= 0.f) {
+      return partners;
+    }
+    for (size_t iA = 0; iA < partsA.size(); ++iA) {
+      for (size_t iB = sameSpecies ? iA + 1 : 0; iB < partsB.size(); ++iB) {
+        if (-getqij(partsA[iA].momentum, partsB[iB].momentum).M2() < maxQ2) {
+          partners[iA].push_back(iB);
+        }
+      }
+    }
+    return partners;
+  }
+};
+
+} // namespace o2::analysis::cffilter
+
+#endif // EVENTFILTERING_PWGCF_CFFILTERCORE_H_
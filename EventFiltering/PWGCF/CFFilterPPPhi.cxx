@@ -22,6 +22,7 @@
 #include <string>
 
 #include "../filterTables.h"
+#include "CFFilterCore.h"
 
 #include "Framework/Configurable.h"
 #include "Framework/ASoAHelpers.h"
@@ -41,6 +42,7 @@
 using namespace o2;
 using namespace o2::framework;
 using namespace o2::framework::expressions;
+using namespace o2::analysis::cffilter;
 
 namespace o2::aod
 {
@@ -296,47 +298,6 @@ struct CFFillterPPPhi {
     return invMass;
   }
 
-  float getkstar(const ROOT::Math::PtEtaPhiMVector part1,
-                 const ROOT::Math::PtEtaPhiMVector part2)
-  {
-    const ROOT::Math::PtEtaPhiMVector trackSum = part1 + part2;
-    const float beta = trackSum.Beta();
-    const float betax =
-      beta * std::cos(trackSum.Phi()) * std::sin(trackSum.Theta());
-    const float betay =
-      beta * std::sin(trackSum.Phi()) * std::sin(trackSum.Theta());
-    const float betaz = beta * std::cos(trackSum.Theta());
-    ROOT::Math::PxPyPzMVector PartOneCMS(part1);
-    ROOT::Math::PxPyPzMVector PartTwoCMS(part2);
-    const ROOT::Math::Boost boostPRF =
-      ROOT::Math::Boost(-betax, -betay, -betaz);
-    PartOneCMS = boostPRF(PartOneCMS);
-    PartTwoCMS = boostPRF(PartTwoCMS);
-    const ROOT::Math::PxPyPzMVector trackRelK = PartOneCMS - PartTwoCMS;
-    return 0.5 * trackRelK.P();
-  }
-
-  ROOT::Math::PxPyPzEVector getqij(const ROOT::Math::PtEtaPhiMVector parti,
-                                   const ROOT::Math::PtEtaPhiMVector partj)
-  {
-    ROOT::Math::PxPyPzEVector vecparti(parti);
-    ROOT::Math::PxPyPzEVector vecpartj(partj);
-    ROOT::Math::PxPyPzEVector trackSum = vecparti + vecpartj;
-    ROOT::Math::PxPyPzEVector trackDifference = vecparti - vecpartj;
-    float scaling = trackDifference.Dot(trackSum) / trackSum.Dot(trackSum);
-    return trackDifference - scaling * trackSum;
-  }
-  float getQ3(const ROOT::Math::PtEtaPhiMVector part1,
-              const ROOT::Math::PtEtaPhiMVector part2,
-              const ROOT::Math::PtEtaPhiMVector part3)
-  {
-    ROOT::Math::PxPyPzEVector q12 = getqij(part1, part2);
-    ROOT::Math::PxPyPzEVector q23 = getqij(part2, part3);
-    ROOT::Math::PxPyPzEVector q31 = getqij(part3, part1);
-    float Q32 = q12.M2() + q23.M2() + q31.M2();
-    return sqrt(-Q32);
-  }
-
   void process(aod::FemtoFullCollision const& col, aod::BCsWithTimestamps const&, aod::FemtoFullTracks const& tracks)
   {
     registry.fill(HIST("fProcessedEvents"), 0);
@@ -126,6 +126,9 @@ struct HfFilter { // Main struct for HF triggers
   // parameter for Optimisation Tree
   Configurable<bool> applyOptimisation{"applyOptimisation", false, "Flag to enable or disable optimisation"};
 
+  // parameter for the staged evaluation of the triggers
+  Configurable<bool> applyStagedEvaluation{"applyStagedEvaluation", false, "Flag to evaluate the BDT tags before the daughter propagation and to skip the loops that cannot fire any pending trigger (trigger decisions unchanged)"};
+
   // array of BDT thresholds
   std::array<LabeledArray<double>, kNCharmParticles> thresholdBDTScores;
 
@@ -274,6 +277,21 @@ struct HfFilter { // Main struct for HF triggers
   Preslice<aod::CascDatas> cascPerCollision = aod::cascdata::collisionId;
   Preslice<aod::V0PhotonsKF> photonsPerCollision = aod::v0photonkf::collisionId;
 
+  /// BDT tag of a charm-hadron candidate from its ML scores, as evaluated in process
+  /// \param mlScores ML scores of the candidate from the skim
+  /// \param iCharmPart index of the charm-hadron species
+  /// \return true if the candidate is tagged as signal
+  template <typename TScores>
+  bool isSignalTaggedBDT(const TScores& mlScores, int iCharmPart)
+  {
+    std::vector<float> scores{mlScores.begin(), mlScores.end()};
+    if (scores.size() != 3) {
+      scores = {2., -1., -1.};
+    }
+    auto tagBDT = helper.isBDTSelected(scores, thresholdBDTScores[iCharmPart]);
+    return acceptBdtBkgOnly ? TESTBIT(tagBDT, RecoDecay::OriginType::None) : (TESTBIT(tagBDT, RecoDecay::OriginType::Prompt) || TESTBIT(tagBDT, RecoDecay::OriginType::NonPrompt));
+  }
+
   void process(CollsWithEvSel const& collisions,
                aod::BCsWithTimestamps const&,
                aod::V0Datas const& v0s,
@@ -321,6 +339,23 @@ struct HfFilter { // Main struct for HF triggers
 
       hProcessedEvents->Fill(0);
 
+      // in the staged evaluation without QA and optimisation trees, the candidate loops stop once all the triggers they can fire are fired
+      bool stopWhenFired = applyStagedEvaluation && !activateQA && !applyOptimisation;
+      bool hasDoubleCharm2Prong{false}, hasDoubleCharm3Prong{false}; // at least two independent 2-prong (3-prong) candidates found
+      bool isFemto3PEnabled{false};
+      for (int iHypo{1}; iHypo < kNCharmParticles; ++iHypo) {
+        isFemto3PEnabled = isFemto3PEnabled || enableFemtoChannels->get(0u, iHypo);
+      }
+      auto isDoubleCharmMixDone = [&]() { return !enableDoubleCharmChannels->get(0u, 2u) || hasDoubleCharm2Prong || hasDoubleCharm3Prong; };
+      auto are2ProngTriggersFired = [&]() {
+        return keepEvent[kHighPt2P] && keepEvent[kBeauty3P] && (keepEvent[kFemto2P] || !enableFemtoChannels->get(0u, 0u)) && keepEvent[kPhotonCharm2P] && keepEvent[kV0Charm2P] &&
+               (!enableDoubleCharmChannels->get(0u, 0u) || hasDoubleCharm2Prong) && isDoubleCharmMixDone();
+      };
+      auto are3ProngTriggersFired = [&]() {
+        return keepEvent[kHighPt3P] && keepEvent[kBeauty4P] && (keepEvent[kFemto3P] || !isFemto3PEnabled) && keepEvent[kSigmaCPPK] && keepEvent[kPhotonCharm3P] && keepEvent[kV0Charm3P] && keepEvent[kSigmaC0K0] &&
+               (!enableDoubleCharmChannels->get(0u, 1u) || hasDoubleCharm3Prong) && isDoubleCharmMixDone();
+      };
+
       std::vector<std::vector<int64_t>> indicesDau2Prong{};
 
       auto cand2ProngsThisColl = cand2Prongs.sliceBy(hf2ProngPerCollision, thisCollId);
@@ -328,6 +363,13 @@ struct HfFilter { // Main struct for HF triggers
         if (!TESTBIT(cand2Prong.hfflag(), o2::aod::hf_cand_2prong::DecayType::D0ToPiK)) { // check if it's a D0
           continue;
         }
+        if (stopWhenFired && are2ProngTriggersFired()) {
+          break;
+        }
+        // cheap selection first: the BDT tag does not depend on the daughter propagation
+        if (applyStagedEvaluation && activateQA < 2 && !isSignalTaggedBDT(cand2Prong.mlProbSkimD0ToKPi(), kD0)) {
+          continue;
+        }
 
         auto trackPos = cand2Prong.prong0_as<BigTracksPID>(); // positive daughter
         auto trackNeg = cand2Prong.prong1_as<BigTracksPID>(); // negative daughter
@@ -394,14 +436,25 @@ struct HfFilter { // Main struct for HF triggers
 
         if (isCharmTagged) {
           indicesDau2Prong.push_back(std::vector<int64_t>{trackPos.globalIndex(), trackNeg.globalIndex()});
+          if (stopWhenFired && !hasDoubleCharm2Prong) {
+            hasDoubleCharm2Prong = helper.computeNumberOfCandidates(indicesDau2Prong) > 1;
+          }
         } // end multi-charm selection
 
         // compute masses already here, needed both for B0 --> D* (--> D0 Pi) Pi and Ds1 --> D* (--> D0 Pi) K0S
         auto massD0Cand = RecoDecay::m(std::array{pVecPos, pVecNeg}, std::array{massPi, massKa});
         auto massD0BarCand = RecoDecay::m(std::array{pVecPos, pVecNeg}, std::array{massKa, massPi});
 
+        // the loop over tracks only serves the beauty and femto triggers
+        auto canFireWithTrack2Prong = [&]() {
+          return (!keepEvent[kBeauty3P] && isBeautyTagged) || (!keepEvent[kFemto2P] && enableFemtoChannels->get(0u, 0u) && isCharmTagged && (TESTBIT(selD0, 0) || TESTBIT(selD0, 1) || !requireCharmMassForFemto));
+        };
+
         auto trackIdsThisCollision = trackIndices.sliceBy(trackIndicesPerCollision, thisCollId);
         for (const auto& trackId : trackIdsThisCollision) { // start loop over tracks
+          if (applyStagedEvaluation && !canFireWithTrack2Prong()) {
+            break;
+          }
           auto track = trackId.track_as<BigTracksPID>();
 
           if (track.globalIndex() == trackPos.globalIndex() || track.globalIndex() == trackNeg.globalIndex()) {
@@ -687,6 +740,15 @@ struct HfFilter { // Main struct for HF triggers
         if (!std::accumulate(is3Prong.begin(), is3Prong.end(), 0)) { // check if it's a D+, Ds+, Lc+ or Xic+
           continue;
         }
+        if (stopWhenFired && are3ProngTriggersFired()) {
+          break;
+        }
+        // cheap selection first: the BDT tags do not depend on the daughter propagation
+        if (applyStagedEvaluation && activateQA < 2 &&
+            !((is3Prong[0] && isSignalTaggedBDT(cand3Prong.mlProbSkimDplusToPiKPi(), kDplus)) || (is3Prong[1] && isSignalTaggedBDT(cand3Prong.mlProbSkimDsToKKPi(), kDs)) ||
+              (is3Prong[2] && isSignalTaggedBDT(cand3Prong.mlProbSkimLcToPKPi(), kLc)) || (is3Prong[3] && isSignalTaggedBDT(cand3Prong.mlProbSkimXicToPKPi(), kXic)))) {
+          continue;
+        }
 
         auto trackFirst = cand3Prong.prong0_as<BigTracksPID>();
         auto trackSecond = cand3Prong.prong1_as<BigTracksPID>();
@@ -770,6 +832,9 @@ struct HfFilter { // Main struct for HF triggers
 
         if ((!keepOnlyDplusForDouble3Prongs && std::accumulate(isCharmTagged.begin(), isCharmTagged.end(), 0)) || (keepOnlyDplusForDouble3Prongs && isCharmTagged[kDplus - 1])) {
           indicesDau3Prong.push_back(std::vector<int64_t>{trackFirst.globalIndex(), trackSecond.globalIndex(), trackThird.globalIndex()});
+          if (stopWhenFired && !hasDoubleCharm3Prong) {
+            hasDoubleCharm3Prong = helper.computeNumberOfCandidates(indicesDau3Prong) > 1;
+          }
         } // end multiple 3-prong selection
 
         auto pVec3Prong = RecoDecay::pVec(pVecFirst, pVecSecond, pVecThird);
@@ -813,9 +878,23 @@ struct HfFilter { // Main struct for HF triggers
           }
         } // end high-pT selection
 
+        // the loop over tracks only serves the beauty, femto and SigmaC++ K- triggers
+        // (not skipped with QA, since the proton selection fills QA histograms for all the tracks)
+        auto canFireWithTrack3Prong = [&]() {
+          bool canFire = !keepEvent[kSigmaCPPK] && is3Prong[2] > 0 && is3ProngInMass[2] > 0 && isSignalTagged[2] > 0;
+          for (int iHypo{0}; iHypo < kNCharmParticles - 1 && !canFire; ++iHypo) {
+            bool isInMass = TESTBIT(is3ProngInMass[iHypo], 0) || TESTBIT(is3ProngInMass[iHypo], 1);
+            canFire = (!keepEvent[kBeauty4P] && isBeautyTagged[iHypo] && isInMass) || (!keepEvent[kFemto3P] && isCharmTagged[iHypo] && enableFemtoChannels->get(0u, iHypo + 1) && (isInMass || !requireCharmMassForFemto));
+          }
+          return canFire;
+        };
+
         auto trackIdsThisCollision = trackIndices.sliceBy(trackIndicesPerCollision, thisCollId);
 
         for (const auto& trackId : trackIdsThisCollision) { // start loop over track indices as associated to this collision in HF code
+          if (applyStagedEvaluation && !activateQA && !canFireWithTrack3Prong()) {
+            break;
+          }
           auto track = trackId.track_as<BigTracksPID>();
           if (track.globalIndex() == trackFirst.globalIndex() || track.globalIndex() == trackSecond.globalIndex() || track.globalIndex() == trackThird.globalIndex()) {
             continue;
@@ -12,15 +12,137 @@
 
 #include "Zorro.h"
 
+#include <algorithm>
 #include <map>
+#include <numeric>
 
+#include <unistd.h>
+
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <memory>
+
+#include "TFile.h"
 #include "TH1D.h"
 
 #include "CCDB/BasicCCDBManager.h"
 #include "CommonDataFormat/InteractionRecord.h"
+#include "Framework/Logger.h"
 
 using o2::InteractionRecord;
 
+namespace
+{
+// Layout of the binary local cache: header, then nRanges BC ranges, filter bit masks and
+// selection bit masks, each of them as two uint64_t. The arrays are contiguous and 8-byte
+// aligned, such that the file can also be memory mapped.
+constexpr char CacheMagic[8] = {'Z', 'O', 'R', 'R', 'O', 'B', 'C', '1'};
+struct CacheHeader {
+  char magic[8];
+  int64_t runNumber;
+  uint64_t pathHash;
+  uint64_t nRanges;
+};
+} // namespace
+
+std::string Zorro::getLocalCacheName(int runNumber) const
+{
+  return mLocalCachePath + "/zorro_" + std::to_string(runNumber) + "_" + std::to_string(std::hash<std::string>{}(mBaseCCDBPath));
+}
+
+bool Zorro::readLocalCache(int runNumber)
+{
+  if (mLocalCachePath.empty()) {
+    return false;
+  }
+  std::string name = getLocalCacheName(runNumber);
+  std::ifstream bin(name + ".bin", std::ios::binary);
+  if (!bin) {
+    return false;
+  }
+  CacheHeader header;
+  if (!bin.read(reinterpret_cast<char*>(&header), sizeof(header)) || !std::equal(std::begin(CacheMagic), std::end(CacheMagic), header.magic) ||
+      header.runNumber != runNumber || header.pathHash != std::hash<std::string>{}(mBaseCCDBPath)) {
+    LOGP(warning, "Zorro: ignoring the invalid local cache {}.bin", name);
+    return false;
+  }
+  for (auto* array : {&mCachedSelectedBCs, &mCachedFilterBitMask, &mCachedSelectionBitMask}) {
+    array->resize(header.nRanges);
+    if (!bin.read(reinterpret_cast<char*>(array->data()), header.nRanges * sizeof(std::array<uint64_t, 2>))) {
+      LOGP(warning, "Zorro: ignoring the truncated local cache {}.bin", name);
+      return false;
+    }
+  }
+
+  std::unique_ptr<TFile> file{TFile::Open((name + ".root").data(), "READ")};
+  if (!file || file->IsZombie()) {
+    return false;
+  }
+  std::shared_ptr<TH1D>* cachedHistos[3] = {&mCachedScalers, &mCachedSelections, &mCachedInspectedTVX};
+  const char* histoNames[3] = {"FilterCounters", "SelectionCounters", "InspectedTVX"};
+  for (int iHisto{0}; iHisto < 3; ++iHisto) {
+    auto histo = file->Get<TH1D>(histoNames[iHisto]);
+    if (!histo) {
+      return false;
+    }
+    histo->SetDirectory(nullptr);
+    cachedHistos[iHisto]->reset(histo);
+  }
+  mScalers = mCachedScalers.get();
+  mSelections = mCachedSelections.get();
+  mInspectedTVX = mCachedInspectedTVX.get();
+  mFilterBitMask = &mCachedFilterBitMask;
+  mSelectionBitMask = &mCachedSelectionBitMask;
+  return true;
+}
+
+void Zorro::writeLocalCache(int runNumber, const std::vector<std::array<uint64_t, 2>>* selectedBCs) const
+{
+  if (mLocalCachePath.empty() || !selectedBCs || !mFilterBitMask || !mSelectionBitMask || !mScalers || !mSelections || !mInspectedTVX) {
+    return;
+  }
+  uint64_t nRanges = selectedBCs->size();
+  if (mFilterBitMask->size() != nRanges || mSelectionBitMask->size() != nRanges) {
+    LOGP(warning, "Zorro: inconsistent sizes of the BC ranges and bit masks of run {}, not cached", runNumber);
+    return;
+  }
+  // Write to process-specific temporary files first, the renaming makes the cache visible
+  // to the other devices and jobs only once it is complete. The binary file is renamed last.
+  std::string name = getLocalCacheName(runNumber);
+  std::string suffix = ".tmp" + std::to_string(getpid());
+  {
+    std::unique_ptr<TFile> file{TFile::Open((name + ".root" + suffix).data(), "RECREATE")};
+    if (!file || file->IsZombie()) {
+      LOGP(warning, "Zorro: cannot write the local cache in {}", mLocalCachePath);
+      return;
+    }
+    file->WriteObject(mScalers, "FilterCounters");
+    file->WriteObject(mSelections, "SelectionCounters");
+    file->WriteObject(mInspectedTVX, "InspectedTVX");
+  }
+  {
+    std::ofstream bin(name + ".bin" + suffix, std::ios::binary);
+    CacheHeader header{{}, runNumber, std::hash<std::string>{}(mBaseCCDBPath), nRanges};
+    std::copy(std::begin(CacheMagic), std::end(CacheMagic), header.magic);
+    bin.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    auto writeArray = [&](const std::vector<std::array<uint64_t, 2>>& array) {
+      bin.write(reinterpret_cast<const char*>(array.data()), nRanges * sizeof(std::array<uint64_t, 2>));
+    };
+    writeArray(*selectedBCs);
+    writeArray(*mFilterBitMask);
+    writeArray(*mSelectionBitMask);
+    if (!bin) {
+      LOGP(warning, "Zorro: cannot write the local cache in {}", mLocalCachePath);
+      std::remove((name + ".bin" + suffix).data());
+      std::remove((name + ".root" + suffix).data());
+      return;
+    }
+  }
+  std::rename((name + ".root" + suffix).data(), (name + ".root").data());
+  std::rename((name + ".bin" + suffix).data(), (name + ".bin").data());
+}
+
 std::vector<int> Zorro::initCCDB(o2::ccdb::BasicCCDBManager* ccdb, int runNumber, uint64_t timestamp, std::string tois, int bcRange)
 {
   if (mRunNumber == runNumber) {
@@ -31,18 +153,34 @@ std::vector<int> Zorro::initCCDB(o2::ccdb::BasicCCDBManager* ccdb, int runNumber
   mBCtolerance = bcRange;
   std::map<std::string, std::string> metadata;
   metadata["runNumber"] = std::to_string(runNumber);
-  mScalers = mCCDB->getSpecific<TH1D>(mBaseCCDBPath + "FilterCounters", timestamp, metadata);
-  mSelections = mCCDB->getSpecific<TH1D>(mBaseCCDBPath + "SelectionCounters", timestamp, metadata);
-  mInspectedTVX = mCCDB->getSpecific<TH1D>(mBaseCCDBPath + "InspectedTVX", timestamp, metadata);
-  auto selectedBCs = mCCDB->getSpecific<std::vector<std::array<uint64_t, 2>>>(mBaseCCDBPath + "SelectedBCs", timestamp, metadata);
-  mBCranges.clear();
-  for (auto bc : *selectedBCs) {
-    mBCranges.emplace_back(InteractionRecord::long2IR(std::min(bc[0], bc[1])), InteractionRecord::long2IR(std::max(bc[0], bc[1])));
+  std::vector<std::array<uint64_t, 2>>* selectedBCs = nullptr;
+  if (readLocalCache(runNumber)) {
+    LOGP(info, "Zorro: BC ranges and counters of run {} read from the local cache {}", runNumber, mLocalCachePath);
+    selectedBCs = &mCachedSelectedBCs;
+  } else {
+    mScalers = mCCDB->getSpecific<TH1D>(mBaseCCDBPath + "FilterCounters", timestamp, metadata);
+    mSelections = mCCDB->getSpecific<TH1D>(mBaseCCDBPath + "SelectionCounters", timestamp, metadata);
+    mInspectedTVX = mCCDB->getSpecific<TH1D>(mBaseCCDBPath + "InspectedTVX", timestamp, metadata);
+    selectedBCs = mCCDB->getSpecific<std::vector<std::array<uint64_t, 2>>>(mBaseCCDBPath + "SelectedBCs", timestamp, metadata);
+    mSelectionBitMask = mCCDB->getSpecific<std::vector<std::array<uint64_t, 2>>>(mBaseCCDBPath + "SelectionBitMask", timestamp, metadata);
+    mFilterBitMask = mCCDB->getSpecific<std::vector<std::array<uint64_t, 2>>>(mBaseCCDBPath + "FilterBitMask", timestamp, metadata);
+    writeLocalCache(runNumber, selectedBCs);
   }
-  std::sort(mBCranges.begin(), mBCranges.end(), [](const auto& a, const auto& b) { return a.getMin() < b.getMin(); });
 
-  mSelectionBitMask = mCCDB->getSpecific<std::vector<std::array<uint64_t, 2>>>(mBaseCCDBPath + "SelectionBitMask", timestamp, metadata);
-  mFilterBitMask = mCCDB->getSpecific<std::vector<std::array<uint64_t, 2>>>(mBaseCCDBPath + "FilterBitMask", timestamp, metadata);
+  // Sort the BC ranges by their lower edge, keeping the filter bit masks aligned with them
+  std::vector<size_t> order(selectedBCs->size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return std::min((*selectedBCs)[a][0], (*selectedBCs)[a][1]) < std::min((*selectedBCs)[b][0], (*selectedBCs)[b][1]); });
+  mBCranges.clear();
+  mBCrangesMask.clear();
+  mBCrangesMaxPrefix.clear();
+  for (auto idx : order) {
+    auto& bc = (*selectedBCs)[idx];
+    uint64_t bcMax = std::max(bc[0], bc[1]);
+    mBCranges.emplace_back(InteractionRecord::long2IR(std::min(bc[0], bc[1])), InteractionRecord::long2IR(bcMax));
+    mBCrangesMask.push_back(mFilterBitMask->at(idx));
+    mBCrangesMaxPrefix.push_back(mBCrangesMaxPrefix.empty() ? bcMax : std::max(bcMax, mBCrangesMaxPrefix.back()));
+  }
 
   mLastBCglobalId = 0;
   mLastSelectedIdx = 0;
@@ -67,16 +205,21 @@ std::bitset<128> Zorro::fetch(uint64_t bcGlobalId, uint64_t tolerance)
 {
   std::bitset<128> result;
   o2::dataformats::IRFrame bcFrame{InteractionRecord::long2IR(bcGlobalId) - tolerance, InteractionRecord::long2IR(bcGlobalId) + tolerance};
-  if (bcGlobalId < mLastBCglobalId) {
-    mLastSelectedIdx = 0;
+  uint64_t bcFrameMin = bcFrame.getMin().toLong();
+  uint64_t bcFrameMax = bcFrame.getMax().toLong();
+
+  // The ranges before the first one with an upper edge (running maximum) above the frame cannot overlap with it.
+  // Start from the last selected range if it is still the first candidate, otherwise do a binary search.
+  size_t first = mLastSelectedIdx;
+  if (first >= mBCranges.size() || mBCrangesMaxPrefix[first] < bcFrameMin || (first > 0 && mBCrangesMaxPrefix[first - 1] >= bcFrameMin)) {
+    first = std::lower_bound(mBCrangesMaxPrefix.begin(), mBCrangesMaxPrefix.end(), bcFrameMin) - mBCrangesMaxPrefix.begin();
   }
-  for (size_t i = mLastSelectedIdx; i < mBCranges.size(); i++) {
+  for (size_t i = first; i < mBCranges.size() && mBCranges[i].getMin().toLong() <= bcFrameMax; i++) {
     if (!bcFrame.getOverlap(mBCranges[i]).isZeroLength()) {
-      for (int iMask{0}; iMask < 2; ++iMask) {
-        for (int iTOI{0}; iTOI < 64; ++iTOI) {
-          result.set(iMask * 64 + iTOI, mFilterBitMask->at(i)[iMask] & (1ull << iTOI));
-        }
-      }
+      result = std::bitset<128>(mBCrangesMask[i][1]);
+      result <<= 64;
+      result |= std::bitset<128>(mBCrangesMask[i][0]);
+      mLastBCglobalId = bcGlobalId;
       mLastSelectedIdx = i;
       return result;
     }
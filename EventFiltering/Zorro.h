@@ -14,7 +14,9 @@
 #ifndef EVENTFILTERING_ZORRO_H_
 #define EVENTFILTERING_ZORRO_H_
 
+#include <array>
 #include <bitset>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -42,8 +44,15 @@ class Zorro
   void setCCDBpath(std::string path) { mBaseCCDBPath = path; }
   void setBaseCCDBPath(std::string path) { mBaseCCDBPath = path; }
   void setBCtolerance(int tolerance) { mBCtolerance = tolerance; }
+  /// Directory of the local cache of the BC ranges, bit masks and counters, shared by the devices and
+  /// jobs running on the same node. The cache is keyed by run number and CCDB path, disabled if empty.
+  void setLocalCachePath(std::string path) { mLocalCachePath = path; }
 
  private:
+  std::string getLocalCacheName(int runNumber) const;
+  bool readLocalCache(int runNumber);
+  void writeLocalCache(int runNumber, const std::vector<std::array<uint64_t, 2>>* selectedBCs) const;
+
   std::string mBaseCCDBPath = "Users/m/mpuccio/EventFiltering/OTS/";
   int mRunNumber = 0;
   int mBCtolerance = 100;
@@ -52,13 +61,23 @@ class Zorro
   TH1D* mScalers = nullptr;
   TH1D* mSelections = nullptr;
   TH1D* mInspectedTVX = nullptr;
-  std::vector<o2::dataformats::IRFrame> mBCranges;
+  std::vector<o2::dataformats::IRFrame> mBCranges;    // sorted by lower edge
+  std::vector<std::array<uint64_t, 2>> mBCrangesMask; // filter bit masks of mBCranges
+  std::vector<uint64_t> mBCrangesMaxPrefix;           // running maximum of the upper edges of mBCranges
   std::vector<std::array<uint64_t, 2>>* mFilterBitMask = nullptr;
   std::vector<std::array<uint64_t, 2>>* mSelectionBitMask = nullptr;
   std::vector<std::string> mTOIs;
   std::vector<int> mTOIidx;
   std::vector<int> mTOIcounts;
   o2::ccdb::BasicCCDBManager* mCCDB = nullptr;
+
+  std::string mLocalCachePath = "";
+  std::vector<std::array<uint64_t, 2>> mCachedSelectedBCs;
+  std::vector<std::array<uint64_t, 2>> mCachedFilterBitMask;
+  std::vector<std::array<uint64_t, 2>> mCachedSelectionBitMask;
+  std::shared_ptr<TH1D> mCachedScalers;
+  std::shared_ptr<TH1D> mCachedSelections;
+  std::shared_ptr<TH1D> mCachedInspectedTVX;
 };
 
 #endif // EVENTFILTERING_ZORRO_H_
\ No newline at end of file
@@ -225,6 +225,9 @@ struct centralEventFilterTask {
   FILTER_CONFIGURABLE(FullJetFilters);
   FILTER_CONFIGURABLE(PhotonFilters);
 
+  Configurable<bool> cfgColumnarDecision{"cfgColumnarDecision", false, "Evaluate the filter columns on the Arrow bitmaps, with counter-based random numbers for the downscaling"};
+  Configurable<int64_t> cfgDownscalingSeed{"cfgDownscalingSeed", 0, "Seed of the counter-based random numbers of the columnar decision"};
+
   void init(o2::framework::InitContext& initc)
   {
     LOG(debug) << "Start init";
@@ -263,6 +266,73 @@ struct centralEventFilterTask {
     }
   }
 
+  /// Columnar evaluation of a filter column: the boolean bitmap is read 64 rows at a time and only the
+  /// fired rows are visited. The downscaling uses a counter-based random number of (seed, global BC, row,
+  /// trigger bit), such that the decisions are reproducible and do not depend on the processing order.
+  void fillDecisionColumnar(arrow::ChunkedArray const& column, uint64_t decisionBin, uint64_t triggerBit, double downscaling, double binCenter,
+                            arrow::NumericArray<arrow::Int32Type> const& collBCIdArray, arrow::NumericArray<arrow::UInt64Type> const& gloBCArray,
+                            std::vector<std::array<uint64_t, 2>>& outTrigger, std::vector<std::array<uint64_t, 2>>& outDecision)
+  {
+    auto mScalers{scalers.get<TH1>(HIST("mScalers"))};
+    auto mFiltered{scalers.get<TH1>(HIST("mFiltered"))};
+    uint64_t triggerIndex = decisionBin * 64 + __builtin_ctzll(triggerBit);
+    int64_t nFired{0}, nAccepted{0};
+    int64_t entry{0};
+    for (int64_t iC{0}; iC < column.num_chunks(); ++iC) {
+      auto boolArray = std::static_pointer_cast<arrow::BooleanArray>(column.chunk(iC));
+      const uint8_t* bitmap = boolArray->values()->data();
+      int64_t bitOffset = boolArray->offset();
+      int64_t length = boolArray->length();
+      for (int64_t iW{0}; iW < length; iW += 64) {
+        uint64_t word = getBitmapWord(bitmap, bitOffset + iW, std::min<int64_t>(64, length - iW));
+        while (word) {
+          int64_t row = entry + iW + __builtin_ctzll(word);
+          word &= word - 1;
+          nFired++;
+          outTrigger[row][decisionBin] |= triggerBit;
+          if (downscaling >= 1. || (downscaling > 0. && getCounterUniform(gloBCArray.Value(collBCIdArray.Value(row)), row, triggerIndex) < downscaling)) {
+            nAccepted++;
+            outDecision[row][decisionBin] |= triggerBit;
+          }
+        }
+      }
+      entry += length;
+    }
+    if (nFired) {
+      mScalers->Fill(binCenter, nFired);
+    }
+    if (nAccepted) {
+      mFiltered->Fill(binCenter, nAccepted);
+    }
+  }
+
+  /// Up to 64 bits of an Arrow bitmap starting at bitOffset, in the lowest bits of the result
+  static uint64_t getBitmapWord(const uint8_t* bitmap, int64_t bitOffset, int64_t nBits)
+  {
+    const uint8_t* bytes = bitmap + (bitOffset >> 3);
+    int shift = bitOffset & 7;
+    int nBytes = (shift + nBits + 7) >> 3;
+    uint64_t low{0}, high{0};
+    for (int iB{0}; iB < std::min(nBytes, 8); ++iB) {
+      low |= static_cast<uint64_t>(bytes[iB]) << (8 * iB);
+    }
+    if (nBytes > 8) {
+      high = bytes[8];
+    }
+    uint64_t word = (low >> shift) | (shift ? high << (64 - shift) : 0ull);
+    return nBits < 64 ? word & (BIT(nBits) - 1) : word;
+  }
+
+  /// Uniform number in [0, 1) from the splitmix64 finaliser of the seed and of the counters
+  double getCounterUniform(uint64_t globalBC, int64_t row, uint64_t triggerIndex) const
+  {
+    uint64_t z = static_cast<uint64_t>(cfgDownscalingSeed.value) ^ (globalBC * 0x9e3779b97f4a7c15ull) ^ (static_cast<uint64_t>(row) << 8) ^ triggerIndex;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    z = z ^ (z >> 31);
+    return (z >> 11) * 0x1.0p-53;
+  }
+
   void run(ProcessingContext& pc)
   {
 
@@ -328,7 +398,9 @@ struct centralEventFilterTask {
         uint64_t triggerBit{BIT((bin - 2) % 64)};
         auto column{tablePtr->GetColumnByName(colName.first)};
         double downscaling{colName.second};
-        if (column) {
+        if (column && cfgColumnarDecision) {
+          fillDecisionColumnar(*column, decisionBin, triggerBit, downscaling, binCenter, *CollBCIdArray, *GloBCArray, outTrigger, outDecision);
+        } else if (column) {
           int entry = 0;
           for (int64_t iC{0}; iC < column->num_chunks(); ++iC) {
             auto chunk{column->chunk(iC)};
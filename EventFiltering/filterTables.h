@@ -155,6 +155,13 @@ DECLARE_SOA_COLUMN(BCend, hasBCend, uint64_t);     //! CEFP bcrange
 
 } // namespace bcrange
 
+namespace bcbitmap
+{
+DECLARE_SOA_COLUMN(RunNumber, runNumber, int);            //! Run number of the selected BCs
+DECLARE_SOA_COLUMN(Bitmap, bitmap, std::vector<uint8_t>); //! Serialised BCBitmap of the selected BCs
+
+} // namespace bcbitmap
+
 // nuclei
 DECLARE_SOA_TABLE(NucleiFilters, "AOD", "NucleiFilters", //!
                   filtering::He, filtering::H3L3Body);
@@ -239,6 +246,11 @@ DECLARE_SOA_TABLE(BCRanges, "AOD", "BCRanges", //!
                   bcrange::BCstart, bcrange::BCend);
 using BCRange = BCRanges::iterator;
 
+// selected BCs as a compressed bitmap
+DECLARE_SOA_TABLE(BCBitmaps, "AOD", "BCBitmaps", //!
+                  bcbitmap::RunNumber, bcbitmap::Bitmap);
+using BCBitmapRow = BCBitmaps::iterator;
+
 /// List of the available filters, the description of their tables and the name of the tasks
 constexpr int NumberOfFilters{12};
 constexpr std::array<char[32], NumberOfFilters> AvailableFilters{"NucleiFilters", "DiffractionFilters", "DqFilters", "HfFilters", "CFFilters", "JetFilters", "JetHFFilters", "FullJetFilters", "StrangenessFilters", "MultFilters", "PhotonFilters", "F1ProtonFilters"};
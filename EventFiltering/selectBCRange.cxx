@@ -17,6 +17,7 @@
 #include "Framework/Logger.h"
 #include "Framework/runDataProcessing.h"
 
+#include "BCBitmap.h"
 #include "filterTables.h"
 
 using namespace o2;
@@ -28,11 +29,17 @@ struct BCRangeSelector {
   Configurable<int> nTimeRes{"nTimeRes", 4, "Range to consider for search of compatible BCs in units of vertex-time-resolution."};
   Configurable<int> nMinBCs{"nMinBCs", 7, "Minimum width of time window to consider for search of compatible BCs in units of 2*BunchSpacing."};
   Configurable<double> fillFac{"fillFactor", 0.0, "Factor of MB events to add"};
+  Configurable<int> outputMode{"outputMode", 0, "0: merged BC ranges, 1: BC ranges and compressed bitmap of the selected BCs, 2: bitmap only"};
 
   using CCs = soa::Join<aod::Collisions, aod::EvSels>;
 
   // buffer for task output
   Produces<aod::BCRanges> tags;
+  Produces<aod::BCBitmaps> bitmaps;
+
+  // selected BCs of the streaming modes, the buffers are reused between the time frames
+  BCBitmap selectedBCs;
+  std::vector<uint8_t> bitmapBuffer;
 
   template <typename T>
   IRFrame getIRFrame(T& collision)
@@ -71,6 +78,10 @@ struct BCRangeSelector {
       return;
     }
 
+    // in the streaming modes only the first range is kept, for the MB filling, the others go directly to the bitmap
+    const bool streaming{outputMode.value > 0};
+    selectedBCs.clear();
+
     auto filt = decisions.begin();
     int firstSelectedCollision{-1};
     std::vector<IRFrame> bcRanges;
@@ -80,7 +91,12 @@ struct BCRangeSelector {
         if (firstSelectedCollision < 0) {
           firstSelectedCollision = nColl;
         }
-        bcRanges.push_back(getIRFrame(collision));
+        IRFrame bcRange{getIRFrame(collision)};
+        if (streaming && !bcRanges.empty()) {
+          selectedBCs.addRange(bcRange.getMin().toLong(), bcRange.getMax().toLong());
+        } else {
+          bcRanges.push_back(bcRange);
+        }
         nSelected++;
       }
       nColl++;
@@ -106,6 +122,19 @@ struct BCRangeSelector {
       bcRanges[0].getMax() = std::max(bcRanges[0].getMax(), maxFrame.getMax());
     }
 
+    if (streaming) {
+      // the bitmap merges the overlapping and adjacent ranges by itself, no sorting is needed
+      selectedBCs.addRange(bcRanges[0].getMin().toLong(), bcRanges[0].getMax().toLong());
+      selectedBCs.optimize();
+      if (outputMode.value == 1) {
+        selectedBCs.forEachRange([&](uint64_t first, uint64_t last) { tags(first, last); });
+      }
+      selectedBCs.serialize(bitmapBuffer);
+      bitmaps(bcs.begin().runNumber(), bitmapBuffer);
+      LOGF(info, "Selected BCs stored in %zu chunks (%zu bytes)", selectedBCs.getNChunks(), bitmapBuffer.size());
+      return;
+    }
+
     /// We cannot merge the ranges in the previous loop because while collisions are sorted by time, the corresponding minBCs can be unsorted as the collision time resolution is not constant
     std::sort(bcRanges.begin(), bcRanges.end(), [](const IRFrame& a, const IRFrame& b) {
       return a.getMin() < b.getMin();
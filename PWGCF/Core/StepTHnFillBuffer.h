@@ -0,0 +1,102 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#ifndef O2_ANALYSIS_STEPTHNFILLBUFFER_H
+#define O2_ANALYSIS_STEPTHNFILLBUFFER_H
+
+#include <utility>
+#include <vector>
+
+#include "Framework/StepTHn.h"
+
+// Per-thread buffers of StepTHn fills
+//
+// StepTHn::Fill is not thread safe. Each thread records its fills in its own buffer, without locks,
+// and the owner of the StepTHn replays them with flush() once the threads are joined.
+// Every fill keeps its own weight, such that the bin contents and the sums of squared weights are those of direct filling.
+// The buffers keep their capacity between flushes.
+
+class StepTHnFillBuffer
+{
+ public:
+  static constexpr int kMaxValues = 8;
+
+  void setNThreads(int nThreads) { mBuffers.resize(nThreads); }
+  int getNThreads() const { return mBuffers.size(); }
+
+  template <typename... Ts>
+  void fill(int thread, int step, const Ts&... valuesAndWeight)
+  {
+    static_assert(sizeof...(Ts) >= 2 && sizeof...(Ts) <= kMaxValues + 1, "StepTHnFillBuffer supports 1 to kMaxValues values plus the weight");
+    const float valuesAndWeightArray[] = {static_cast<float>(valuesAndWeight)...};
+    Entry& entry = mBuffers[thread].emplace_back();
+    entry.step = step;
+    entry.nValues = sizeof...(Ts) - 1;
+    for (int i = 0; i < entry.nValues; i++) {
+      entry.values[i] = valuesAndWeightArray[i];
+    }
+    entry.weight = valuesAndWeightArray[entry.nValues];
+  }
+
+  // Replays the fills of all threads, in thread order, and empties the buffers
+  void flush(StepTHn* target)
+  {
+    for (auto& buffer : mBuffers) {
+      for (auto const& entry : buffer) {
+        switch (entry.nValues) {
+          case 1:
+            replay(target, entry, std::make_index_sequence<1>{});
+            break;
+          case 2:
+            replay(target, entry, std::make_index_sequence<2>{});
+            break;
+          case 3:
+            replay(target, entry, std::make_index_sequence<3>{});
+            break;
+          case 4:
+            replay(target, entry, std::make_index_sequence<4>{});
+            break;
+          case 5:
+            replay(target, entry, std::make_index_sequence<5>{});
+            break;
+          case 6:
+            replay(target, entry, std::make_index_sequence<6>{});
+            break;
+          case 7:
+            replay(target, entry, std::make_index_sequence<7>{});
+            break;
+          case 8:
+            replay(target, entry, std::make_index_sequence<8>{});
+            break;
+        }
+      }
+      buffer.clear();
+    }
+  }
+
+ private:
+  struct Entry {
+    int step;
+    int nValues;
+    float values[kMaxValues];
+    float weight;
+  };
+
+  template <std::size_t... I>
+  static void replay(StepTHn* target, Entry const& entry, std::index_sequence<I...>)
+  {
+    target->Fill(entry.step, entry.values[I]..., entry.weight);
+  }
+
+  std::vector<std::vector<Entry>> mBuffers;
+};
+
+#endif
@@ -0,0 +1,229 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file  MomentsAccumulator.h
+/// \brief Streaming accumulator of the moments of event-by-event quantities (e.g. multiplicities, mean pT).
+///        Each event class (e.g. a centrality or multiplicity bin) keeps, for all its events and for each of its
+///        subsamples, the sum of weights, the mean and the central moments up to the fourth order, updated one
+///        event at a time with the Welford/Pebay formulas, and the sums of the factorial moments
+///        x(x-1)...(x-k+1) up to the order NFactorial. The state of a class is a few doubles, instead of one
+///        histogram bin per value of the quantity, and two accumulators are merged exactly.
+///
+///        The events are assigned to the subsamples from a key (e.g. the global index of the collision), such
+///        that the assignment is reproducible and independent of the order of the dataframes. The spread of the
+///        observables between the subsamples gives their statistical uncertainty.
+///
+///        Usage:
+///          MomentsAccumulator<4> nch;                      // task member
+///          nch.init(nCentBins, 30);                        // in init()
+///          nch.fill(iCent, nCh, collision.globalIndex());  // once per event
+///          nch.exportTo(hMoments);                         // e.g. at the end of each dataframe
+///
+///        The exported histogram holds power sums, which are additive, such that the outputs of the jobs are
+///        merged with the usual histogram merging and the moments are recovered with importFrom.
+///
+
+#ifndef PWGCF_EBYEFLUCTUATIONS_CORE_MOMENTSACCUMULATOR_H_
+#define PWGCF_EBYEFLUCTUATIONS_CORE_MOMENTSACCUMULATOR_H_
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include <TH2.h>
+
+#include "Framework/Logger.h"
+
+namespace o2::analysis::ebyefluctuations
+{
+
+/// \tparam NFactorial  highest order of the factorial moments
+template <int NFactorial = 4>
+class MomentsAccumulator
+{
+ public:
+  /// Moments of one event class or subsample
+  struct Moments {
+    double sumw = 0.;                          // sum of the weights
+    double mean = 0.;                          // weighted mean
+    double m2 = 0., m3 = 0., m4 = 0.;          // weighted sums of (x - mean)^k
+    std::array<double, NFactorial> factorial{}; // weighted sums of x(x-1)...(x-k+1), k = 1..NFactorial
+
+    double variance() const { return sumw > 0. ? m2 / sumw : 0.; }
+    double skewness() const { return m2 > 0. ? m3 / sumw / std::pow(m2 / sumw, 1.5) : 0.; }
+    double kurtosis() const { return m2 > 0. ? m4 * sumw / (m2 * m2) - 3. : 0.; } // excess kurtosis
+    /// Normalized factorial moment <x(x-1)...(x-k+1)>, k = 1..NFactorial
+    double factorialMoment(int k) const { return sumw > 0. ? factorial[k - 1] / sumw : 0.; }
+
+    /// Adds one value
+    void add(double x, double w = 1.)
+    {
+      merge(w, x, 0., 0., 0.);
+      double term = w;
+      for (int k = 0; k < NFactorial; k++) {
+        term *= x - k;
+        factorial[k] += term;
+      }
+    }
+
+    /// Adds the moments of a disjoint set of values
+    void merge(Moments const& other)
+    {
+      merge(other.sumw, other.mean, other.m2, other.m3, other.m4);
+      for (int k = 0; k < NFactorial; k++) {
+        factorial[k] += other.factorial[k];
+      }
+    }
+
+   private:
+    // Pebay's combination of the central moments of two sets
+    void merge(double wb, double meanb, double m2b, double m3b, double m4b)
+    {
+      if (wb == 0.) {
+        return;
+      }
+      const double wa = sumw;
+      const double w = wa + wb;
+      const double delta = meanb - mean;
+      const double deltaW = delta / w;
+      const double deltaW2 = deltaW * deltaW;
+      const double wab = wa * wb;
+      m4 += m4b + deltaW2 * deltaW2 * wab * (wa * wa - wab + wb * wb) * w + 6. * deltaW2 * (wa * wa * m2b + wb * wb * m2) + 4. * deltaW * (wa * m3b - wb * m3);
+      m3 += m3b + deltaW2 * deltaW * wab * (wa - wb) * w + 3. * deltaW * (wa * m2b - wb * m2);
+      m2 += m2b + deltaW * delta * wab;
+      mean += deltaW * wb;
+      sumw = w;
+    }
+  };
+
+  static constexpr int NQuantities = 5 + NFactorial; // exported per class and subsample: sumw, sums of x^1..x^4, factorial sums
+
+  /// Sets the number of event classes and of subsamples and empties the accumulator
+  void init(int nClasses, int nSubsamples)
+  {
+    if (nClasses < 1 || nSubsamples < 0) {
+      LOGF(fatal, "MomentsAccumulator: %d classes and %d subsamples, please configure properly!!", nClasses, nSubsamples);
+    }
+    mNClasses = nClasses;
+    mNSubsamples = nSubsamples;
+    mMoments.assign(static_cast<size_t>(nClasses) * (nSubsamples + 1), {});
+  }
+
+  /// Adds the value of an event to its class and to the subsample drawn from the key
+  /// \param key  key of the event, e.g. its global index
+  void fill(int iClass, double x, uint64_t key, double w = 1.)
+  {
+    if (iClass < 0 || iClass >= mNClasses) {
+      return;
+    }
+    get(iClass).add(x, w);
+    if (mNSubsamples > 0) {
+      get(iClass, getSubsample(key)).add(x, w);
+    }
+  }
+
+  /// Adds the content of an accumulator with the same classes and subsamples, e.g. the one of another thread
+  void merge(MomentsAccumulator const& other)
+  {
+    if (other.mNClasses != mNClasses || other.mNSubsamples != mNSubsamples) {
+      LOGF(fatal, "MomentsAccumulator: cannot merge %d x %d with %d x %d classes x subsamples", mNClasses, mNSubsamples, other.mNClasses, other.mNSubsamples);
+    }
+    for (size_t i = 0; i < mMoments.size(); i++) {
+      mMoments[i].merge(other.mMoments[i]);
+    }
+  }
+
+  void reset() { mMoments.assign(mMoments.size(), {}); }
+
+  /// Moments of all the events of a class
+  Moments const& get(int iClass) const { return mMoments[index(iClass, -1)]; }
+  Moments& get(int iClass) { return mMoments[index(iClass, -1)]; }
+  /// Moments of a subsample of a class
+  Moments const& get(int iClass, int iSubsample) const { return mMoments[index(iClass, iSubsample)]; }
+  Moments& get(int iClass, int iSubsample) { return mMoments[index(iClass, iSubsample)]; }
+
+  int getNClasses() const { return mNClasses; }
+  int getNSubsamples() const { return mNSubsamples; }
+  int getSubsample(uint64_t key) const { return mNSubsamples > 0 ? static_cast<int>(splitMix64(key) % static_cast<uint64_t>(mNSubsamples)) : -1; }
+
+  /// Writes the power sums into a histogram with nClasses * (nSubsamples + 1) bins in x and NQuantities bins in y.
+  /// The x bin of class c and subsample s is c * (nSubsamples + 1) + s + 2, the one of all the events of c is
+  /// c * (nSubsamples + 1) + 1. The contents are overwritten, such that the export can be repeated at will.
+  void exportTo(TH2* hist) const
+  {
+    if (hist->GetNbinsX() != static_cast<int>(mMoments.size()) || hist->GetNbinsY() != NQuantities) {
+      LOGF(fatal, "MomentsAccumulator: histogram %s has %d x %d bins, %d x %d expected", hist->GetName(), hist->GetNbinsX(), hist->GetNbinsY(), static_cast<int>(mMoments.size()), NQuantities);
+    }
+    for (size_t i = 0; i < mMoments.size(); i++) {
+      const auto& m = mMoments[i];
+      const double mean2 = m.mean * m.mean;
+      const double sums[5] = {m.sumw,
+                              m.sumw * m.mean,
+                              m.m2 + m.sumw * mean2,
+                              m.m3 + 3. * m.mean * m.m2 + m.sumw * mean2 * m.mean,
+                              m.m4 + 4. * m.mean * m.m3 + 6. * mean2 * m.m2 + m.sumw * mean2 * mean2};
+      for (int q = 0; q < 5; q++) {
+        hist->SetBinContent(i + 1, q + 1, sums[q]);
+      }
+      for (int k = 0; k < NFactorial; k++) {
+        hist->SetBinContent(i + 1, k + 6, m.factorial[k]);
+      }
+    }
+  }
+
+  /// Recovers the moments from a histogram written by exportTo, e.g. after the merging of the outputs.
+  /// The accumulator has to be initialized with the classes and subsamples of the export.
+  void importFrom(TH2 const* hist)
+  {
+    if (hist->GetNbinsX() != static_cast<int>(mMoments.size()) || hist->GetNbinsY() != NQuantities) {
+      LOGF(fatal, "MomentsAccumulator: histogram %s has %d x %d bins, %d x %d expected", hist->GetName(), hist->GetNbinsX(), hist->GetNbinsY(), static_cast<int>(mMoments.size()), NQuantities);
+    }
+    for (size_t i = 0; i < mMoments.size(); i++) {
+      auto& m = mMoments[i];
+      m = {};
+      m.sumw = hist->GetBinContent(i + 1, 1);
+      for (int k = 0; k < NFactorial; k++) {
+        m.factorial[k] = hist->GetBinContent(i + 1, k + 6);
+      }
+      if (m.sumw == 0.) {
+        continue;
+      }
+      m.mean = hist->GetBinContent(i + 1, 2) / m.sumw;
+      const double mean2 = m.mean * m.mean;
+      const double s2 = hist->GetBinContent(i + 1, 3) / m.sumw;
+      const double s3 = hist->GetBinContent(i + 1, 4) / m.sumw;
+      const double s4 = hist->GetBinContent(i + 1, 5) / m.sumw;
+      m.m2 = m.sumw * (s2 - mean2);
+      m.m3 = m.sumw * (s3 - 3. * m.mean * s2 + 2. * mean2 * m.mean);
+      m.m4 = m.sumw * (s4 - 4. * m.mean * s3 + 6. * mean2 * s2 - 3. * mean2 * mean2);
+    }
+  }
+
+ private:
+  size_t index(int iClass, int iSubsample) const { return static_cast<size_t>(iClass) * (mNSubsamples + 1) + iSubsample + 1; }
+  static uint64_t splitMix64(uint64_t state)
+  {
+    uint64_t z = state + 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  }
+
+  int mNClasses = 0;
+  int mNSubsamples = 0;
+  std::vector<Moments> mMoments; // per class: all the events, then the subsamples
+};
+
+} // namespace o2::analysis::ebyefluctuations
+
+#endif // PWGCF_EBYEFLUCTUATIONS_CORE_MOMENTSACCUMULATOR_H_
@@ -23,6 +23,8 @@
 // #include "Framework/Logger.h"
 // #include "Common/DataModel/Multiplicity.h"
 
+#include <algorithm>
+#include <cmath>
 #include <vector>
 #include <memory>
 #include "TLorentzVector.h"
@@ -133,6 +135,61 @@ TVector3 GetQLCMSFrom4vectors(TLorentzVector& first4momentum, TLorentzVector& se
 
 //====================================================================================
 
+// four-momentum of a particle: calculated once per selected track and reused for all its pairs (SE and ME)
+struct FemtoMomentum {
+  float px = 0.0, py = 0.0, pz = 0.0, e = 0.0;
+};
+
+inline FemtoMomentum GetFemtoMomentum(const float& pt, const float& eta, const float& phi, const float& mass)
+{
+  FemtoMomentum momentum;
+  momentum.px = pt * std::cos(phi);
+  momentum.py = pt * std::sin(phi);
+  momentum.pz = pt * std::sinh(eta);
+  momentum.e = std::sqrt(pt * pt + momentum.pz * momentum.pz + mass * mass);
+  return momentum;
+}
+
+//====================================================================================
+
+// pair observables, all derived in one pass from the four-momenta (same definitions as GetKstarFrom4vectors and GetQLCMSFrom4vectors)
+struct FemtoPairKinematics {
+  float kstar = -1000, qout = -1000, qside = -1000, qlong = -1000, kt = -1000, mt = -1000;
+};
+
+inline FemtoPairKinematics GetPairKinematics(const FemtoMomentum& first, const FemtoMomentum& second, const bool& isIdentical)
+{
+  FemtoPairKinematics kinematics;
+
+  const float sumPx = first.px + second.px, sumPy = first.py + second.py, sumPz = first.pz + second.pz, sumE = first.e + second.e;
+  const float difPx = first.px - second.px, difPy = first.py - second.py, difPz = first.pz - second.pz, difE = first.e - second.e;
+  const float sumPt = std::sqrt(sumPx * sumPx + sumPy * sumPy);
+  const float sumMt = std::sqrt(std::abs(sumE * sumE - sumPz * sumPz));
+
+  kinematics.kt = 0.5 * sumPt;
+  kinematics.mt = 0.5 * sumMt;
+
+  const float difMag2 = difE * difE - difPx * difPx - difPy * difPy - difPz * difPz;
+  if (isIdentical) {
+    kinematics.kstar = 0.5 * std::sqrt(std::abs(difMag2));
+  } else { // relative momentum in the pair rest frame: |q*|^2 = (q.P)^2/P^2 - q^2
+    const float sumMag2 = sumE * sumE - sumPx * sumPx - sumPy * sumPy - sumPz * sumPz;
+    const float difDotSum = difE * sumE - difPx * sumPx - difPy * sumPy - difPz * sumPz;
+    kinematics.kstar = 0.5 * std::sqrt(std::max(difDotSum * difDotSum / sumMag2 - difMag2, 0.0f));
+  }
+
+  // boost to LCMS along Z, then rotate so the X axis is along pair's kT
+  const float cosPhi = sumPt > 0 ? sumPx / sumPt : 1.0;
+  const float sinPhi = sumPt > 0 ? sumPy / sumPt : 0.0;
+  kinematics.qout = difPx * cosPhi + difPy * sinPhi;
+  kinematics.qside = -difPx * sinPhi + difPy * cosPhi;
+  kinematics.qlong = (sumE * difPz - sumPz * difE) / sumMt;
+
+  return kinematics;
+}
+
+//====================================================================================
+
 template <typename TrackType>
 class FemtoPair
 {
@@ -174,14 +231,50 @@ class FemtoPair
   {
     _first = first;
     _second = second;
+    _hasMomenta = false;
+    _isKinematicsSet = false;
+  }
+  // the four-momenta are those of the tracks computed with GetFemtoMomentum for the masses of PDG1 and PDG2
+  void SetPair(TrackType const& first, TrackType const& second, FemtoMomentum const& firstMomentum, FemtoMomentum const& secondMomentum)
+  {
+    _first = first;
+    _second = second;
+    _firstMomentum = firstMomentum;
+    _secondMomentum = secondMomentum;
+    _hasMomenta = true;
+    _isKinematicsSet = false;
+  }
+  void SetFirstParticle(TrackType const& first)
+  {
+    _first = first;
+    _hasMomenta = false;
+    _isKinematicsSet = false;
+  }
+  void SetSecondParticle(TrackType const& second)
+  {
+    _second = second;
+    _hasMomenta = false;
+    _isKinematicsSet = false;
+  }
+  void SetIdentical(const bool& isidentical)
+  {
+    _isidentical = isidentical;
+    _isKinematicsSet = false;
   }
-  void SetFirstParticle(TrackType const& first) { _first = first; }
-  void SetSecondParticle(TrackType const& second) { _second = second; }
-  void SetIdentical(const bool& isidentical) { _isidentical = isidentical; }
   void SetMagField1(const float& magfield1) { _magfield1 = magfield1; }
   void SetMagField2(const float& magfield2) { _magfield2 = magfield2; }
-  void SetPDG1(const int& PDG1) { _PDG1 = PDG1; }
-  void SetPDG2(const int& PDG2) { _PDG2 = PDG2; }
+  void SetPDG1(const int& PDG1)
+  {
+    _PDG1 = PDG1;
+    _mass1 = PDG1 != 0 ? particle_mass(PDG1) : 0.0;
+    _isKinematicsSet = false;
+  }
+  void SetPDG2(const int& PDG2)
+  {
+    _PDG2 = PDG2;
+    _mass2 = PDG2 != 0 ? particle_mass(PDG2) : 0.0;
+    _isKinematicsSet = false;
+  }
   int GetPDG1() { return _PDG1; }
   int GetPDG2() { return _PDG2; }
   void ResetPair();
@@ -216,7 +309,15 @@ class FemtoPair
   TrackType _second = NULL;
   float _magfield1 = 0.0, _magfield2 = 0.0;
   int _PDG1 = 0, _PDG2 = 0;
+  float _mass1 = 0.0, _mass2 = 0.0;
   bool _isidentical = true;
+
+  FemtoMomentum _firstMomentum, _secondMomentum;
+  bool _hasMomenta = false;
+  mutable FemtoPairKinematics _kinematics; // calculated on the first request for the current pair
+  mutable bool _isKinematicsSet = false;
+
+  const FemtoPairKinematics& GetKinematics() const;
 };
 
 template <typename TrackType>
@@ -224,6 +325,8 @@ void FemtoPair<TrackType>::ResetPair()
 {
   _first = NULL;
   _second = NULL;
+  _hasMomenta = false;
+  _isKinematicsSet = false;
 }
 
 template <typename TrackType>
@@ -235,7 +338,26 @@ void FemtoPair<TrackType>::ResetAll()
   _magfield2 = 0.0;
   _PDG1 = 0;
   _PDG2 = 0;
+  _mass1 = 0.0;
+  _mass2 = 0.0;
   _isidentical = true;
+  _hasMomenta = false;
+  _isKinematicsSet = false;
+}
+
+template <typename TrackType>
+const FemtoPairKinematics& FemtoPair<TrackType>::GetKinematics() const
+{
+  if (!_isKinematicsSet) {
+    if (_hasMomenta) {
+      _kinematics = GetPairKinematics(_firstMomentum, _secondMomentum, _isidentical);
+    } else {
+      _kinematics = GetPairKinematics(GetFemtoMomentum(_first->pt(), _first->eta(), _first->phi(), _mass1),
+                                      GetFemtoMomentum(_second->pt(), _second->eta(), _second->phi(), _mass2), _isidentical);
+    }
+    _isKinematicsSet = true;
+  }
+  return _kinematics;
 }
 
 template <typename TrackType>
@@ -263,12 +385,7 @@ float FemtoPair<TrackType>::GetKstar() const
   if (_PDG1 * _PDG2 == 0)
     return -1000;
 
-  TLorentzVector first4momentum;
-  first4momentum.SetPtEtaPhiM(_first->pt(), _first->eta(), _first->phi(), particle_mass(_PDG1));
-  TLorentzVector second4momentum;
-  second4momentum.SetPtEtaPhiM(_second->pt(), _second->eta(), _second->phi(), particle_mass(_PDG2));
-
-  return GetKstarFrom4vectors(first4momentum, second4momentum, _isidentical);
+  return GetKinematics().kstar;
 }
 
 template <typename TrackType>
@@ -281,12 +398,8 @@ TVector3 FemtoPair<TrackType>::GetQLCMS() const
   if (_PDG1 * _PDG2 == 0)
     return TVector3(-1000, -1000, -1000);
 
-  TLorentzVector first4momentum;
-  first4momentum.SetPtEtaPhiM(_first->pt(), _first->eta(), _first->phi(), particle_mass(_PDG1));
-  TLorentzVector second4momentum;
-  second4momentum.SetPtEtaPhiM(_second->pt(), _second->eta(), _second->phi(), particle_mass(_PDG2));
-
-  return GetQLCMSFrom4vectors(first4momentum, second4momentum);
+  const FemtoPairKinematics& kinematics = GetKinematics();
+  return TVector3(kinematics.qout, kinematics.qside, kinematics.qlong);
 }
 
 template <typename TrackType>
@@ -299,7 +412,7 @@ float FemtoPair<TrackType>::GetKt() const
   if (_PDG1 * _PDG2 == 0)
     return -1000;
 
-  return 0.5 * std::sqrt(std::pow(_first->px() + _second->px(), 2) + std::pow(_first->py() + _second->py(), 2));
+  return GetKinematics().kt;
 }
 
 template <typename TrackType>
@@ -312,14 +425,7 @@ float FemtoPair<TrackType>::GetMt() const
   if (_PDG1 * _PDG2 == 0)
     return -1000;
 
-  TLorentzVector first4momentum;
-  first4momentum.SetPtEtaPhiM(_first->pt(), _first->eta(), _first->phi(), particle_mass(_PDG1));
-  TLorentzVector second4momentum;
-  second4momentum.SetPtEtaPhiM(_second->pt(), _second->eta(), _second->phi(), particle_mass(_PDG2));
-
-  TLorentzVector fourmomentasum = first4momentum + second4momentum;
-
-  return 0.5 * fourmomentasum.Mt();
+  return GetKinematics().mt;
 }
 } // namespace o2::aod::singletrackselector
 
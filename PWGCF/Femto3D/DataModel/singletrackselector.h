@@ -25,6 +25,7 @@
 #include "Common/DataModel/PIDResponse.h"
 #include "Framework/Logger.h"
 #include "Common/DataModel/Multiplicity.h"
+#include "CommonConstants/MathConstants.h"
 
 namespace o2::aod
 {
@@ -84,6 +85,9 @@ using dca_v1 = binningParent<std::pair<float, float>(-1.f, 1.f), int16_t>;
 using dca = dca_v1;
 using chi2 = binningParent<std::pair<float, float>(0.f, 10.f)>;
 using rowsOverFindable = binningParent<std::pair<float, float>(0.f, 3.f)>;
+using pt = binningParent<std::pair<float, float>(0.f, 20.f), int16_t>;
+using eta = binningParent<std::pair<float, float>(-2.f, 2.f), int16_t>;
+using phi = binningParent<std::pair<float, float>(0.f, o2::constants::math::TwoPI), int16_t>;
 
 } // namespace binning
 
@@ -332,6 +336,82 @@ DECLARE_SOA_TABLE(SingleTrkExtras, "AOD", "SINGLETRKEXTRA",
                   singletrackselector::TPCSignal,
                   singletrackselector::Beta);
 
+namespace singletrackselector
+{
+// Minimal track schema for the pair tasks: packed kinematics, charge and a bitmask of the species the track is
+// selected as (the track quality and PID selections are applied when the table is produced). The magnetic field
+// is taken from the collision.
+enum Species : uint8_t {
+  kPion = 0,
+  kKaon,
+  kProton,
+  kDeuteron,
+  kHelium3,
+  kNSpecies
+};
+
+inline int getSpecies(int PDG)
+{
+  switch (std::abs(PDG)) {
+    case 211:
+      return kPion;
+    case 321:
+      return kKaon;
+    case 2212:
+      return kProton;
+    case 1000010020:
+      return kDeuteron;
+    case 1000020030:
+      return kHelium3;
+    default:
+      return -1;
+  }
+}
+
+DECLARE_SOA_COLUMN(StoredPt, storedPt, binning::pt::binned_t);
+DECLARE_SOA_COLUMN(StoredEta, storedEta, binning::eta::binned_t);
+DECLARE_SOA_COLUMN(StoredPhi, storedPhi, binning::phi::binned_t);
+DECLARE_SOA_COLUMN(SpeciesMask, speciesMask, uint8_t); // bit i set if the track is selected as species i
+
+DECLARE_SOA_DYNAMIC_COLUMN(Pt_Min, pt,
+                           [](binning::pt::binned_t pt_binned) -> float { return singletrackselector::unPack<binning::pt>(pt_binned); });
+DECLARE_SOA_DYNAMIC_COLUMN(Eta_Min, eta,
+                           [](binning::eta::binned_t eta_binned) -> float { return singletrackselector::unPack<binning::eta>(eta_binned); });
+DECLARE_SOA_DYNAMIC_COLUMN(Phi_Min, phi,
+                           [](binning::phi::binned_t phi_binned) -> float { return singletrackselector::unPack<binning::phi>(phi_binned); });
+DECLARE_SOA_DYNAMIC_COLUMN(P_Min, p,
+                           [](binning::pt::binned_t pt_binned, binning::eta::binned_t eta_binned) -> float { return singletrackselector::unPack<binning::pt>(pt_binned) * std::cosh(singletrackselector::unPack<binning::eta>(eta_binned)); });
+DECLARE_SOA_DYNAMIC_COLUMN(PhiStar_Min, phiStar,
+                           [](binning::pt::binned_t pt_binned, int8_t sign, binning::phi::binned_t phi_binned, float magfield = 0.0, float radius = 1.6) -> float {
+                             if (magfield == 0.0) {
+                               return -1000.0;
+                             } else {
+                               return singletrackselector::unPack<binning::phi>(phi_binned) + std::asin(-0.3 * magfield * sign * radius / (2.0 * singletrackselector::unPack<binning::pt>(pt_binned)));
+                             }
+                           });
+DECLARE_SOA_DYNAMIC_COLUMN(IsSpecies, isSpecies, [](uint8_t speciesMask, int PDG) -> bool {
+  const int species = singletrackselector::getSpecies(PDG);
+  return species >= 0 && (speciesMask & (1 << species));
+});
+
+} // namespace singletrackselector
+
+DECLARE_SOA_TABLE(SingleTrackMins, "AOD", "SINGLETRACKMIN", // Minimal table of the selected tracks for the pair tasks
+                  o2::soa::Index<>,
+                  singletrackselector::SingleCollSelId,
+                  singletrackselector::StoredPt,
+                  singletrackselector::StoredEta,
+                  singletrackselector::StoredPhi,
+                  singletrackselector::Sign,
+                  singletrackselector::SpeciesMask,
+
+                  singletrackselector::Pt_Min<singletrackselector::StoredPt>,
+                  singletrackselector::Eta_Min<singletrackselector::StoredEta>,
+                  singletrackselector::Phi_Min<singletrackselector::StoredPhi>,
+                  singletrackselector::P_Min<singletrackselector::StoredPt, singletrackselector::StoredEta>,
+                  singletrackselector::PhiStar_Min<singletrackselector::StoredPt, singletrackselector::Sign, singletrackselector::StoredPhi>,
+                  singletrackselector::IsSpecies<singletrackselector::SpeciesMask>);
+
 namespace singletrackselector
 {
 DECLARE_SOA_COLUMN(PdgCode, pdgCode, int);
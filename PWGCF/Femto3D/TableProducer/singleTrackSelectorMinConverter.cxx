@@ -0,0 +1,114 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+//
+/// \brief Converter of the singletrackselector tables to the minimal track table used by the pair tasks:
+///        the track quality and PID selections are applied here and only the packed kinematics, the charge and
+///        the bitmask of the selected species are kept
+/// \since 15 October 2026
+
+#include <vector>
+
+#include <fairlogger/Logger.h>
+#include "PWGCF/Femto3D/DataModel/singletrackselector.h"
+#include "Framework/AnalysisTask.h"
+#include "Framework/runDataProcessing.h"
+
+using namespace o2;
+using namespace o2::framework;
+using namespace o2::framework::expressions;
+using namespace o2::aod;
+
+struct singleTrackSelectorMinConverter {
+  Produces<o2::aod::SingleTrackMins> tableRow;
+
+  Configurable<float> _min_P{"min_P", 0.0, "lower mometum limit"};
+  Configurable<float> _max_P{"max_P", 100.0, "upper mometum limit"};
+  Configurable<float> _eta{"eta", 100.0, "abs eta value limit"};
+  Configurable<std::vector<float>> _dcaXY{"dcaXY", std::vector<float>{0.3f, 0.0f, 0.0f}, "abs dcaXY value limit; formula: [0] + [1]*pT^[2]"};
+  Configurable<std::vector<float>> _dcaZ{"dcaZ", std::vector<float>{0.3f, 0.0f, 0.0f}, "abs dcaZ value limit; formula: [0] + [1]*pT^[2]"};
+  Configurable<int16_t> _tpcNClsFound{"minTpcNClsFound", 0, "minimum allowed number of TPC clasters"};
+  Configurable<float> _tpcChi2NCl{"tpcChi2NCl", 100.0, "upper limit for chi2 value of a fit over TPC clasters"};
+  Configurable<float> _tpcCrossedRowsOverFindableCls{"tpcCrossedRowsOverFindableCls", 0, "lower limit of TPC CrossedRows/FindableCls value"};
+  Configurable<float> _tpcFractionSharedCls{"maxTpcFractionSharedCls", 0.4, "maximum fraction of TPC shared clasters"};
+  Configurable<int> _itsNCls{"minItsNCls", 0, "minimum allowed number of ITS clasters"};
+  Configurable<float> _itsChi2NCl{"itsChi2NCl", 100.0, "upper limit for chi2 value of a fit over ITS clasters"};
+
+  Configurable<std::vector<int>> _particlesToSelect{"particlesToSelectPDGs", std::vector<int>{2212, 1000010020}, "PDG codes of the species stored in the bitmask (pion, kaon, proton, deuteron and helium3 are supported)"};
+  Configurable<std::vector<float>> _PIDtrshld{"PIDtrshld", std::vector<float>{10.0f, 10.0f}, "per species in particlesToSelectPDGs: value of momentum from which the PID is done with TOF (before that only TPC is used)"};
+  Configurable<std::vector<float>> _tpcNSigma{"tpcNSigma", std::vector<float>{-3.0f, 3.0f}, "Nsigma range in TPC before the TOF is used"};
+  Configurable<std::vector<float>> _tofNSigma{"tofNSigma", std::vector<float>{-3.0f, 3.0f}, "Nsigma range in TOF"};
+  Configurable<std::vector<float>> _tpcNSigmaResidual{"tpcNSigmaResidual", std::vector<float>{-5.0f, 5.0f}, "residual TPC Nsigma cut to use with the TOF"};
+
+  std::vector<std::pair<int, std::vector<float>>> TPCcuts;
+  std::vector<std::pair<int, std::vector<float>>> TOFcuts;
+  std::vector<uint8_t> speciesBits;
+
+  Filter pFilter = o2::aod::singletrackselector::p > _min_P&& o2::aod::singletrackselector::p < _max_P;
+  Filter etaFilter = nabs(o2::aod::singletrackselector::eta) < _eta;
+
+  Filter tpcTrkFilter = o2::aod::singletrackselector::tpcNClsFound >= _tpcNClsFound &&
+                        o2::aod::singletrackselector::unPack<singletrackselector::binning::chi2>(o2::aod::singletrackselector::storedTpcChi2NCl) < _tpcChi2NCl &&
+                        o2::aod::singletrackselector::unPack<singletrackselector::binning::rowsOverFindable>(o2::aod::singletrackselector::storedTpcCrossedRowsOverFindableCls) > _tpcCrossedRowsOverFindableCls;
+
+  Filter itsTrkFilter = o2::aod::singletrackselector::unPack<singletrackselector::binning::chi2>(o2::aod::singletrackselector::storedItsChi2NCl) < _itsChi2NCl;
+
+  void init(InitContext&)
+  {
+    if (_PIDtrshld.value.size() != _particlesToSelect.value.size())
+      LOGF(fatal, "PIDtrshld has %d values for %d species in particlesToSelectPDGs, please configure properly!!", static_cast<int>(_PIDtrshld.value.size()), static_cast<int>(_particlesToSelect.value.size()));
+
+    for (auto const& PDG : _particlesToSelect.value) {
+      const int species = singletrackselector::getSpecies(PDG);
+      if (species < 0)
+        LOGF(fatal, "Cannot interpret PDG %d for the species bitmask, please configure properly!!", PDG);
+      TPCcuts.push_back(std::make_pair(PDG, _tpcNSigma.value));
+      TOFcuts.push_back(std::make_pair(PDG, _tofNSigma.value));
+      speciesBits.push_back(1 << species);
+    }
+
+    singletrackselector::binning::pt::print();
+    singletrackselector::binning::eta::print();
+    singletrackselector::binning::phi::print();
+  }
+
+  void process(soa::Filtered<o2::aod::SingleTrackSels> const& tracks)
+  {
+    tableRow.reserve(tracks.size());
+    for (auto const& track : tracks) {
+      if (track.tpcFractionSharedCls() > _tpcFractionSharedCls || track.itsNCls() < _itsNCls)
+        continue;
+      if (abs(track.dcaXY()) > _dcaXY.value[0] + _dcaXY.value[1] * std::pow(track.pt(), _dcaXY.value[2]) || abs(track.dcaZ()) > _dcaZ.value[0] + _dcaZ.value[1] * std::pow(track.pt(), _dcaZ.value[2]))
+        continue;
+      if (track.pt() >= singletrackselector::binning::pt::binned_max || abs(track.eta()) >= singletrackselector::binning::eta::binned_max) // would be stored in the overflow bins
+        continue;
+
+      uint8_t speciesMask = 0;
+      for (size_t i = 0; i < speciesBits.size(); i++) {
+        if (track.p() < _PIDtrshld.value[i] ? singletrackselector::TPCselection(track, TPCcuts[i]) : singletrackselector::TOFselection(track, TOFcuts[i], _tpcNSigmaResidual.value))
+          speciesMask |= speciesBits[i];
+      }
+      if (speciesMask == 0)
+        continue;
+
+      tableRow(track.singleCollSelId(),
+               singletrackselector::packInTable<singletrackselector::binning::pt>(track.pt()),
+               singletrackselector::packInTable<singletrackselector::binning::eta>(track.eta()),
+               singletrackselector::packInTable<singletrackselector::binning::phi>(track.phi()),
+               track.sign(),
+               speciesMask);
+    }
+  }
+};
+
+WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
+{
+  return WorkflowSpec{adaptAnalysisTask<singleTrackSelectorMinConverter>(cfgc)};
+}
@@ -115,14 +115,22 @@ struct FemtoCorrelations {
   using FilteredCollisions = soa::Join<aod::SingleCollSels, aod::SingleCollExtras>;
   using FilteredTracks = aod::SingleTrackSels;
 
+  using MinimalTracks = aod::SingleTrackMins;
+
   typedef std::shared_ptr<soa::Filtered<FilteredTracks>::iterator> trkType;
+  typedef std::shared_ptr<MinimalTracks::iterator> trkMinType;
   typedef std::shared_ptr<soa::Filtered<FilteredCollisions>::iterator> colType;
 
   std::map<int64_t, std::vector<trkType>> selectedtracks_1;
   std::map<int64_t, std::vector<trkType>> selectedtracks_2;
+  std::map<int64_t, std::vector<trkMinType>> selectedtracksMin_1; // same as selectedtracks_1/2 for the minimal table
+  std::map<int64_t, std::vector<trkMinType>> selectedtracksMin_2;
+  std::map<int64_t, std::vector<o2::aod::singletrackselector::FemtoMomentum>> selectedmomenta_1; // four-momenta of selectedtracks_1, calculated once per track for SE and ME
+  std::map<int64_t, std::vector<o2::aod::singletrackselector::FemtoMomentum>> selectedmomenta_2;
   std::map<std::pair<int, float>, std::vector<colType>> mixbins;
 
   std::unique_ptr<o2::aod::singletrackselector::FemtoPair<trkType>> Pair = std::make_unique<o2::aod::singletrackselector::FemtoPair<trkType>>();
+  std::unique_ptr<o2::aod::singletrackselector::FemtoPair<trkMinType>> PairMin = std::make_unique<o2::aod::singletrackselector::FemtoPair<trkMinType>>();
 
   Filter pFilter = o2::aod::singletrackselector::p > _min_P&& o2::aod::singletrackselector::p < _max_P;
   Filter etaFilter = nabs(o2::aod::singletrackselector::eta) < _eta;
@@ -163,9 +171,15 @@ struct FemtoCorrelations {
 
     IsIdentical = (_sign_1 * _particlePDG_1 == _sign_2 * _particlePDG_2);
 
+    if (doprocessFull && doprocessMinimal)
+      LOGF(fatal, "Enable only one of processFull and processMinimal!!!");
+
     Pair->SetIdentical(IsIdentical);
     Pair->SetPDG1(_particlePDG_1);
     Pair->SetPDG2(_particlePDG_2);
+    PairMin->SetIdentical(IsIdentical);
+    PairMin->SetPDG1(_particlePDG_1);
+    PairMin->SetPDG2(_particlePDG_2);
 
     TPCcuts_1 = std::make_pair(_particlePDG_1, _tpcNSigma_1);
     TOFcuts_1 = std::make_pair(_particlePDG_1, _tofNSigma_1);
@@ -255,8 +269,8 @@ struct FemtoCorrelations {
     }
   }
 
-  template <typename Type>
-  void mixTracks(Type const& tracks, unsigned int multBin)
+  template <typename PairType, typename Type, typename MomentaType>
+  void mixTracks(PairType& pair, Type const& tracks, MomentaType const& momenta, unsigned int multBin)
   { // template for identical particles from the same collision
     if (multBin > SEhistos_1D.size())
       LOGF(fatal, "multBin value passed to the mixTracks function exceeds the configured number of Cent. bins (1D)");
@@ -266,8 +280,8 @@ struct FemtoCorrelations {
     for (unsigned int ii = 0; ii < tracks.size(); ii++) { // nested loop for all the combinations
       for (unsigned int iii = ii + 1; iii < tracks.size(); iii++) {
 
-        Pair->SetPair(tracks[ii], tracks[iii]);
-        float pair_kT = Pair->GetKt();
+        pair->SetPair(tracks[ii], tracks[iii], momenta[ii], momenta[iii]);
+        float pair_kT = pair->GetKt();
 
         if (pair_kT < *_kTbins.value.begin() || pair_kT >= *(_kTbins.value.end() - 1))
           continue;
@@ -279,41 +293,41 @@ struct FemtoCorrelations {
           LOGF(fatal, "kTbin value obtained for a pair exceeds the configured number of kT bins (3D)");
 
         if (_fillDetaDphi % 2 == 0)
-          DoubleTrack_SE_histos_BC[multBin][kTbin]->Fill(Pair->GetPhiStarDiff(_radiusTPC), Pair->GetEtaDiff());
+          DoubleTrack_SE_histos_BC[multBin][kTbin]->Fill(pair->GetPhiStarDiff(_radiusTPC), pair->GetEtaDiff());
 
-        if (Pair->IsClosePair(_deta, _dphi, _radiusTPC))
+        if (pair->IsClosePair(_deta, _dphi, _radiusTPC))
           continue;
 
         if (_fillDetaDphi > 0)
-          DoubleTrack_SE_histos_AC[multBin][kTbin]->Fill(Pair->GetPhiStarDiff(_radiusTPC), Pair->GetEtaDiff());
+          DoubleTrack_SE_histos_AC[multBin][kTbin]->Fill(pair->GetPhiStarDiff(_radiusTPC), pair->GetEtaDiff());
 
         kThistos[multBin][kTbin]->Fill(pair_kT);
-        mThistos[multBin][kTbin]->Fill(Pair->GetMt());       // test
-        SEhistos_1D[multBin][kTbin]->Fill(Pair->GetKstar()); // close pair rejection and fillig the SE histo
+        mThistos[multBin][kTbin]->Fill(pair->GetMt());       // test
+        SEhistos_1D[multBin][kTbin]->Fill(pair->GetKstar()); // close pair rejection and fillig the SE histo
 
         if (_fill3dCF) {
           std::mt19937 mt(std::chrono::steady_clock::now().time_since_epoch().count());
-          TVector3 qLCMS = std::pow(-1, (mt() % 2)) * Pair->GetQLCMS(); // introducing randomness to the pair order ([first, second]); important only for 3D because if there are any sudden order/correlation in the tables, it could couse unwanted asymmetries in the final 3d rel. momentum distributions; irrelevant in 1D case because the absolute value of the rel.momentum is taken
+          TVector3 qLCMS = std::pow(-1, (mt() % 2)) * pair->GetQLCMS(); // introducing randomness to the pair order ([first, second]); important only for 3D because if there are any sudden order/correlation in the tables, it could couse unwanted asymmetries in the final 3d rel. momentum distributions; irrelevant in 1D case because the absolute value of the rel.momentum is taken
           SEhistos_3D[multBin][kTbin]->Fill(qLCMS.X(), qLCMS.Y(), qLCMS.Z());
         }
-        Pair->ResetPair();
+        pair->ResetPair();
       }
     }
   }
 
-  template <int SE_or_ME, typename Type>
-  void mixTracks(Type const& tracks1, Type const& tracks2, unsigned int multBin)
+  template <int SE_or_ME, typename PairType, typename Type, typename MomentaType>
+  void mixTracks(PairType& pair, Type const& tracks1, MomentaType const& momenta1, Type const& tracks2, MomentaType const& momenta2, unsigned int multBin)
   { // last value: 0 -- SE; 1 -- ME
     if (multBin > SEhistos_1D.size())
       LOGF(fatal, "multBin value passed to the mixTracks function exceeds the configured number of Cent. bins (1D)");
     if (_fill3dCF && multBin > SEhistos_3D.size())
       LOGF(fatal, "multBin value passed to the mixTracks function exceeds the configured number of Cent. bins (3D)");
 
-    for (auto ii : tracks1) {
-      for (auto iii : tracks2) {
+    for (unsigned int ii = 0; ii < tracks1.size(); ii++) {
+      for (unsigned int iii = 0; iii < tracks2.size(); iii++) {
 
-        Pair->SetPair(ii, iii);
-        float pair_kT = Pair->GetKt();
+        pair->SetPair(tracks1[ii], tracks2[iii], momenta1[ii], momenta2[iii]);
+        float pair_kT = pair->GetKt();
 
         if (pair_kT < *_kTbins.value.begin() || pair_kT >= *(_kTbins.value.end() - 1))
           continue;
@@ -326,116 +340,49 @@ struct FemtoCorrelations {
 
         if (_fillDetaDphi % 2 == 0) {
           if (!SE_or_ME)
-            DoubleTrack_SE_histos_BC[multBin][kTbin]->Fill(Pair->GetPhiStarDiff(_radiusTPC), Pair->GetEtaDiff());
+            DoubleTrack_SE_histos_BC[multBin][kTbin]->Fill(pair->GetPhiStarDiff(_radiusTPC), pair->GetEtaDiff());
           else
-            DoubleTrack_ME_histos_BC[multBin][kTbin]->Fill(Pair->GetPhiStarDiff(_radiusTPC), Pair->GetEtaDiff());
+            DoubleTrack_ME_histos_BC[multBin][kTbin]->Fill(pair->GetPhiStarDiff(_radiusTPC), pair->GetEtaDiff());
         }
 
-        if (Pair->IsClosePair(_deta, _dphi, _radiusTPC))
+        if (pair->IsClosePair(_deta, _dphi, _radiusTPC))
           continue;
 
         if (_fillDetaDphi > 0) {
           if (!SE_or_ME)
-            DoubleTrack_SE_histos_AC[multBin][kTbin]->Fill(Pair->GetPhiStarDiff(_radiusTPC), Pair->GetEtaDiff());
+            DoubleTrack_SE_histos_AC[multBin][kTbin]->Fill(pair->GetPhiStarDiff(_radiusTPC), pair->GetEtaDiff());
           else
-            DoubleTrack_ME_histos_AC[multBin][kTbin]->Fill(Pair->GetPhiStarDiff(_radiusTPC), Pair->GetEtaDiff());
+            DoubleTrack_ME_histos_AC[multBin][kTbin]->Fill(pair->GetPhiStarDiff(_radiusTPC), pair->GetEtaDiff());
         }
 
         if (!SE_or_ME) {
-          SEhistos_1D[multBin][kTbin]->Fill(Pair->GetKstar());
+          SEhistos_1D[multBin][kTbin]->Fill(pair->GetKstar());
           kThistos[multBin][kTbin]->Fill(pair_kT);
-          mThistos[multBin][kTbin]->Fill(Pair->GetMt()); // test
+          mThistos[multBin][kTbin]->Fill(pair->GetMt()); // test
 
           if (_fill3dCF) {
             std::mt19937 mt(std::chrono::steady_clock::now().time_since_epoch().count());
-            TVector3 qLCMS = std::pow(-1, (mt() % 2)) * Pair->GetQLCMS(); // introducing randomness to the pair order ([first, second]); important only for 3D because if there are any sudden order/correlation in the tables, it could couse unwanted asymmetries in the final 3d rel. momentum distributions; irrelevant in 1D case because the absolute value of the rel.momentum is taken
+            TVector3 qLCMS = std::pow(-1, (mt() % 2)) * pair->GetQLCMS(); // introducing randomness to the pair order ([first, second]); important only for 3D because if there are any sudden order/correlation in the tables, it could couse unwanted asymmetries in the final 3d rel. momentum distributions; irrelevant in 1D case because the absolute value of the rel.momentum is taken
             SEhistos_3D[multBin][kTbin]->Fill(qLCMS.X(), qLCMS.Y(), qLCMS.Z());
           }
         } else {
-          MEhistos_1D[multBin][kTbin]->Fill(Pair->GetKstar());
+          MEhistos_1D[multBin][kTbin]->Fill(pair->GetKstar());
 
           if (_fill3dCF) {
             std::mt19937 mt(std::chrono::steady_clock::now().time_since_epoch().count());
-            TVector3 qLCMS = std::pow(-1, (mt() % 2)) * Pair->GetQLCMS(); // introducing randomness to the pair order ([first, second]); important only for 3D because if there are any sudden order/correlation in the tables, it could couse unwanted asymmetries in the final 3d rel. momentum distributions; irrelevant in 1D case because the absolute value of the rel.momentum is taken
+            TVector3 qLCMS = std::pow(-1, (mt() % 2)) * pair->GetQLCMS(); // introducing randomness to the pair order ([first, second]); important only for 3D because if there are any sudden order/correlation in the tables, it could couse unwanted asymmetries in the final 3d rel. momentum distributions; irrelevant in 1D case because the absolute value of the rel.momentum is taken
             MEhistos_3D[multBin][kTbin]->Fill(qLCMS.X(), qLCMS.Y(), qLCMS.Z());
-            qLCMSvskStar[multBin][kTbin]->Fill(qLCMS.X(), qLCMS.Y(), qLCMS.Z(), Pair->GetKstar());
+            qLCMSvskStar[multBin][kTbin]->Fill(qLCMS.X(), qLCMS.Y(), qLCMS.Z(), pair->GetKstar());
           }
         }
-        Pair->ResetPair();
+        pair->ResetPair();
       }
     }
   }
 
-  void process(soa::Filtered<FilteredCollisions> const& collisions, soa::Filtered<FilteredTracks> const& tracks)
-  {
-    if (_particlePDG_1 == 0 || _particlePDG_2 == 0)
-      LOGF(fatal, "One of passed PDG is 0!!!");
-
-    for (auto track : tracks) {
-      if (abs(track.template singleCollSel_as<soa::Filtered<FilteredCollisions>>().posZ()) > _vertexZ)
-        continue;
-      if (_removeSameBunchPileup && !track.template singleCollSel_as<soa::Filtered<FilteredCollisions>>().isNoSameBunchPileup())
-        continue;
-      if (_requestGoodZvtxFT0vsPV && !track.template singleCollSel_as<soa::Filtered<FilteredCollisions>>().isGoodZvtxFT0vsPV())
-        continue;
-      if (_requestVertexITSTPC && !track.template singleCollSel_as<soa::Filtered<FilteredCollisions>>().isVertexITSTPC())
-        continue;
-      if (track.tpcFractionSharedCls() > _tpcFractionSharedCls || track.itsNCls() < _itsNCls)
-        continue;
-      if (track.template singleCollSel_as<soa::Filtered<FilteredCollisions>>().multPerc() < *_centBins.value.begin() || track.template singleCollSel_as<soa::Filtered<FilteredCollisions>>().multPerc() >= *(_centBins.value.end() - 1))
-        continue;
-      if (track.template singleCollSel_as<soa::Filtered<FilteredCollisions>>().hadronicRate() < _IRcut.value.first || track.template singleCollSel_as<soa::Filtered<FilteredCollisions>>().hadronicRate() >= _IRcut.value.second)
-        continue;
-      if (abs(track.dcaXY()) > _dcaXY.value[0] + _dcaXY.value[1] * std::pow(track.pt(), _dcaXY.value[2]) || abs(track.dcaZ()) > _dcaZ.value[0] + _dcaZ.value[1] * std::pow(track.pt(), _dcaZ.value[2]))
-        continue;
-
-      if (track.sign() == _sign_1 && (track.p() < _PIDtrshld_1 ? o2::aod::singletrackselector::TPCselection(track, TPCcuts_1) : o2::aod::singletrackselector::TOFselection(track, TOFcuts_1, _tpcNSigmaResidual_1.value))) { // filling the map: eventID <-> selected particles1
-        selectedtracks_1[track.singleCollSelId()].push_back(std::make_shared<decltype(track)>(track));
-
-        registry.fill(HIST("p_first"), track.p());
-        if (_particlePDG_1 == 211) {
-          registry.fill(HIST("nsigmaTOF_first"), track.p(), track.tofNSigmaPi());
-          registry.fill(HIST("nsigmaTPC_first"), track.p(), track.tpcNSigmaPi());
-        }
-        if (_particlePDG_1 == 321) {
-          registry.fill(HIST("nsigmaTOF_first"), track.p(), track.tofNSigmaKa());
-          registry.fill(HIST("nsigmaTPC_first"), track.p(), track.tpcNSigmaKa());
-        }
-        if (_particlePDG_1 == 2212) {
-          registry.fill(HIST("nsigmaTOF_first"), track.p(), track.tofNSigmaPr());
-          registry.fill(HIST("nsigmaTPC_first"), track.p(), track.tpcNSigmaPr());
-        }
-        if (_particlePDG_1 == 1000010020) {
-          registry.fill(HIST("nsigmaTOF_first"), track.p(), track.tofNSigmaDe());
-          registry.fill(HIST("nsigmaTPC_first"), track.p(), track.tpcNSigmaDe());
-        }
-      }
-
-      if (IsIdentical) {
-        continue;
-      } else if (track.sign() != _sign_2 && !TOFselection(track, std::make_pair(_particlePDGtoReject, _rejectWithinNsigmaTOF)) && (track.p() < _PIDtrshld_2 ? o2::aod::singletrackselector::TPCselection(track, TPCcuts_2) : o2::aod::singletrackselector::TOFselection(track, TOFcuts_2, _tpcNSigmaResidual_2.value))) { // filling the map: eventID <-> selected particles2 if (see condition above ^)
-        selectedtracks_2[track.singleCollSelId()].push_back(std::make_shared<decltype(track)>(track));
-
-        registry.fill(HIST("p_second"), track.p());
-        if (_particlePDG_2 == 211) {
-          registry.fill(HIST("nsigmaTOF_second"), track.p(), track.tofNSigmaPi());
-          registry.fill(HIST("nsigmaTPC_second"), track.p(), track.tpcNSigmaPi());
-        }
-        if (_particlePDG_2 == 321) {
-          registry.fill(HIST("nsigmaTOF_second"), track.p(), track.tofNSigmaKa());
-          registry.fill(HIST("nsigmaTPC_second"), track.p(), track.tpcNSigmaKa());
-        }
-        if (_particlePDG_2 == 2212) {
-          registry.fill(HIST("nsigmaTOF_second"), track.p(), track.tofNSigmaPr());
-          registry.fill(HIST("nsigmaTPC_second"), track.p(), track.tpcNSigmaPr());
-        }
-        if (_particlePDG_2 == 1000010020) {
-          registry.fill(HIST("nsigmaTOF_second"), track.p(), track.tofNSigmaDe());
-          registry.fill(HIST("nsigmaTPC_second"), track.p(), track.tpcNSigmaDe());
-        }
-      }
-    }
-
+  template <typename PairType, typename TracksMap>
+  void mixCollisions(soa::Filtered<FilteredCollisions> const& collisions, PairType& pair, TracksMap& tracks_1, TracksMap& tracks_2)
+  { // classifies the collisions with selected tracks in the vertex&mult bins, mixes the tracks and clears the maps of the selected tracks
     for (auto collision : collisions) {
       if (collision.multPerc() < *_centBins.value.begin() || collision.multPerc() >= *(_centBins.value.end() - 1))
         continue;
@@ -449,10 +396,10 @@ struct FemtoCorrelations {
       if (_requestVertexITSTPC && !collision.isVertexITSTPC())
         continue;
 
-      if (selectedtracks_1.find(collision.globalIndex()) == selectedtracks_1.end()) {
+      if (tracks_1.find(collision.globalIndex()) == tracks_1.end()) {
         if (IsIdentical)
           continue;
-        else if (selectedtracks_2.find(collision.globalIndex()) == selectedtracks_2.end())
+        else if (tracks_2.find(collision.globalIndex()) == tracks_2.end())
           continue;
       }
       int vertexBinToMix = std::floor((collision.posZ() + _vertexZ) / (2 * _vertexZ / _vertexNbinsToMix));
@@ -472,13 +419,13 @@ struct FemtoCorrelations {
 
           auto col1 = (i->second)[indx1];
 
-          Pair->SetMagField1(col1->magField());
-          Pair->SetMagField2(col1->magField());
+          pair->SetMagField1(col1->magField());
+          pair->SetMagField2(col1->magField());
 
           unsigned int centBin = std::floor((i->first).second);
           MultHistos[centBin]->Fill(col1->mult());
 
-          mixTracks(selectedtracks_1[col1->index()], centBin); // mixing SE identical
+          mixTracks(pair, tracks_1[col1->index()], selectedmomenta_1[col1->index()], centBin); // mixing SE identical
 
           for (unsigned int indx2 = indx1 + 1; indx2 < EvPerBin; indx2++) { // nested loop for all the combinations of collisions in a chosen mult/vertex bin
             if (_MEreductionFactor.value > 1) {
@@ -489,8 +436,8 @@ struct FemtoCorrelations {
 
             auto col2 = (i->second)[indx2];
 
-            Pair->SetMagField2(col2->magField());
-            mixTracks<1>(selectedtracks_1[col1->index()], selectedtracks_1[col2->index()], centBin); // mixing ME identical, in <> brackets: 0 -- SE; 1 -- ME
+            pair->SetMagField2(col2->magField());
+            mixTracks<1>(pair, tracks_1[col1->index()], selectedmomenta_1[col1->index()], tracks_1[col2->index()], selectedmomenta_1[col2->index()], centBin); // mixing ME identical, in <> brackets: 0 -- SE; 1 -- ME
           }
         }
       }
@@ -504,13 +451,13 @@ struct FemtoCorrelations {
 
           auto col1 = (i->second)[indx1];
 
-          Pair->SetMagField1(col1->magField());
-          Pair->SetMagField2(col1->magField());
+          pair->SetMagField1(col1->magField());
+          pair->SetMagField2(col1->magField());
 
           unsigned int centBin = std::floor((i->first).second);
           MultHistos[centBin]->Fill(col1->mult());
 
-          mixTracks<0>(selectedtracks_1[col1->index()], selectedtracks_2[col1->index()], centBin); // mixing SE non-identical, in <> brackets: 0 -- SE; 1 -- ME
+          mixTracks<0>(pair, tracks_1[col1->index()], selectedmomenta_1[col1->index()], tracks_2[col1->index()], selectedmomenta_2[col1->index()], centBin); // mixing SE non-identical, in <> brackets: 0 -- SE; 1 -- ME
 
           for (unsigned int indx2 = indx1 + 1; indx2 < EvPerBin; indx2++) { // nested loop for all the combinations of collisions in a chosen mult/vertex bin
             if (_MEreductionFactor.value > 1) {
@@ -521,8 +468,8 @@ struct FemtoCorrelations {
 
             auto col2 = (i->second)[indx2];
 
-            Pair->SetMagField2(col2->magField());
-            mixTracks<1>(selectedtracks_1[col1->index()], selectedtracks_2[col2->index()], centBin); // mixing ME non-identical, in <> brackets: 0 -- SE; 1 -- ME
+            pair->SetMagField2(col2->magField());
+            mixTracks<1>(pair, tracks_1[col1->index()], selectedmomenta_1[col1->index()], tracks_2[col2->index()], selectedmomenta_2[col2->index()], centBin); // mixing ME non-identical, in <> brackets: 0 -- SE; 1 -- ME
           }
         }
       }
@@ -530,20 +477,145 @@ struct FemtoCorrelations {
     } //====================================== end of mixing non-identical ======================================
 
     // clearing up
-    for (auto i = selectedtracks_1.begin(); i != selectedtracks_1.end(); i++)
+    for (auto i = tracks_1.begin(); i != tracks_1.end(); i++)
       (i->second).clear();
-    selectedtracks_1.clear();
+    tracks_1.clear();
+    selectedmomenta_1.clear();
 
     if (!IsIdentical) {
-      for (auto i = selectedtracks_2.begin(); i != selectedtracks_2.end(); i++)
+      for (auto i = tracks_2.begin(); i != tracks_2.end(); i++)
         (i->second).clear();
-      selectedtracks_2.clear();
+      tracks_2.clear();
+      selectedmomenta_2.clear();
     }
 
     for (auto i = mixbins.begin(); i != mixbins.end(); i++)
       (i->second).clear();
     mixbins.clear();
   }
+
+  void processFull(soa::Filtered<FilteredCollisions> const& collisions, soa::Filtered<FilteredTracks> const& tracks)
+  {
+    if (_particlePDG_1 == 0 || _particlePDG_2 == 0)
+      LOGF(fatal, "One of passed PDG is 0!!!");
+
+    const float mass_1 = particle_mass(_particlePDG_1);
+    const float mass_2 = particle_mass(_particlePDG_2);
+
+    for (auto track : tracks) {
+      if (abs(track.template singleCollSel_as<soa::Filtered<FilteredCollisions>>().posZ()) > _vertexZ)
+        continue;
+      if (_removeSameBunchPileup && !track.template singleCollSel_as<soa::Filtered<FilteredCollisions>>().isNoSameBunchPileup())
+        continue;
+      if (_requestGoodZvtxFT0vsPV && !track.template singleCollSel_as<soa::Filtered<FilteredCollisions>>().isGoodZvtxFT0vsPV())
+        continue;
+      if (_requestVertexITSTPC && !track.template singleCollSel_as<soa::Filtered<FilteredCollisions>>().isVertexITSTPC())
+        continue;
+      if (track.tpcFractionSharedCls() > _tpcFractionSharedCls || track.itsNCls() < _itsNCls)
+        continue;
+      if (track.template singleCollSel_as<soa::Filtered<FilteredCollisions>>().multPerc() < *_centBins.value.begin() || track.template singleCollSel_as<soa::Filtered<FilteredCollisions>>().multPerc() >= *(_centBins.value.end() - 1))
+        continue;
+      if (track.template singleCollSel_as<soa::Filtered<FilteredCollisions>>().hadronicRate() < _IRcut.value.first || track.template singleCollSel_as<soa::Filtered<FilteredCollisions>>().hadronicRate() >= _IRcut.value.second)
+        continue;
+      if (abs(track.dcaXY()) > _dcaXY.value[0] + _dcaXY.value[1] * std::pow(track.pt(), _dcaXY.value[2]) || abs(track.dcaZ()) > _dcaZ.value[0] + _dcaZ.value[1] * std::pow(track.pt(), _dcaZ.value[2]))
+        continue;
+
+      if (track.sign() == _sign_1 && (track.p() < _PIDtrshld_1 ? o2::aod::singletrackselector::TPCselection(track, TPCcuts_1) : o2::aod::singletrackselector::TOFselection(track, TOFcuts_1, _tpcNSigmaResidual_1.value))) { // filling the map: eventID <-> selected particles1
+        selectedtracks_1[track.singleCollSelId()].push_back(std::make_shared<decltype(track)>(track));
+        selectedmomenta_1[track.singleCollSelId()].push_back(o2::aod::singletrackselector::GetFemtoMomentum(track.pt(), track.eta(), track.phi(), mass_1));
+
+        registry.fill(HIST("p_first"), track.p());
+        if (_particlePDG_1 == 211) {
+          registry.fill(HIST("nsigmaTOF_first"), track.p(), track.tofNSigmaPi());
+          registry.fill(HIST("nsigmaTPC_first"), track.p(), track.tpcNSigmaPi());
+        }
+        if (_particlePDG_1 == 321) {
+          registry.fill(HIST("nsigmaTOF_first"), track.p(), track.tofNSigmaKa());
+          registry.fill(HIST("nsigmaTPC_first"), track.p(), track.tpcNSigmaKa());
+        }
+        if (_particlePDG_1 == 2212) {
+          registry.fill(HIST("nsigmaTOF_first"), track.p(), track.tofNSigmaPr());
+          registry.fill(HIST("nsigmaTPC_first"), track.p(), track.tpcNSigmaPr());
+        }
+        if (_particlePDG_1 == 1000010020) {
+          registry.fill(HIST("nsigmaTOF_first"), track.p(), track.tofNSigmaDe());
+          registry.fill(HIST("nsigmaTPC_first"), track.p(), track.tpcNSigmaDe());
+        }
+      }
+
+      if (IsIdentical) {
+        continue;
+      } else if (track.sign() != _sign_2 && !TOFselection(track, std::make_pair(_particlePDGtoReject, _rejectWithinNsigmaTOF)) && (track.p() < _PIDtrshld_2 ? o2::aod::singletrackselector::TPCselection(track, TPCcuts_2) : o2::aod::singletrackselector::TOFselection(track, TOFcuts_2, _tpcNSigmaResidual_2.value))) { // filling the map: eventID <-> selected particles2 if (see condition above ^)
+        selectedtracks_2[track.singleCollSelId()].push_back(std::make_shared<decltype(track)>(track));
+        selectedmomenta_2[track.singleCollSelId()].push_back(o2::aod::singletrackselector::GetFemtoMomentum(track.pt(), track.eta(), track.phi(), mass_2));
+
+        registry.fill(HIST("p_second"), track.p());
+        if (_particlePDG_2 == 211) {
+          registry.fill(HIST("nsigmaTOF_second"), track.p(), track.tofNSigmaPi());
+          registry.fill(HIST("nsigmaTPC_second"), track.p(), track.tpcNSigmaPi());
+        }
+        if (_particlePDG_2 == 321) {
+          registry.fill(HIST("nsigmaTOF_second"), track.p(), track.tofNSigmaKa());
+          registry.fill(HIST("nsigmaTPC_second"), track.p(), track.tpcNSigmaKa());
+        }
+        if (_particlePDG_2 == 2212) {
+          registry.fill(HIST("nsigmaTOF_second"), track.p(), track.tofNSigmaPr());
+          registry.fill(HIST("nsigmaTPC_second"), track.p(), track.tpcNSigmaPr());
+        }
+        if (_particlePDG_2 == 1000010020) {
+          registry.fill(HIST("nsigmaTOF_second"), track.p(), track.tofNSigmaDe());
+          registry.fill(HIST("nsigmaTPC_second"), track.p(), track.tpcNSigmaDe());
+        }
+      }
+    }
+
+    mixCollisions(collisions, Pair, selectedtracks_1, selectedtracks_2);
+  }
+  PROCESS_SWITCH(FemtoCorrelations, processFull, "process the full single-track tables", true);
+
+  void processMinimal(soa::Filtered<FilteredCollisions> const& collisions, MinimalTracks const& tracks)
+  { // the track quality and PID selections are those applied by single-track-selector-min-converter
+    if (_particlePDG_1 == 0 || _particlePDG_2 == 0)
+      LOGF(fatal, "One of passed PDG is 0!!!");
+
+    const float mass_1 = particle_mass(_particlePDG_1);
+    const float mass_2 = particle_mass(_particlePDG_2);
+
+    for (auto track : tracks) {
+      auto const& collision = track.template singleCollSel_as<soa::Filtered<FilteredCollisions>>();
+      if (abs(collision.posZ()) > _vertexZ)
+        continue;
+      if (_removeSameBunchPileup && !collision.isNoSameBunchPileup())
+        continue;
+      if (_requestGoodZvtxFT0vsPV && !collision.isGoodZvtxFT0vsPV())
+        continue;
+      if (_requestVertexITSTPC && !collision.isVertexITSTPC())
+        continue;
+      if (collision.multPerc() < *_centBins.value.begin() || collision.multPerc() >= *(_centBins.value.end() - 1))
+        continue;
+      if (collision.hadronicRate() < _IRcut.value.first || collision.hadronicRate() >= _IRcut.value.second)
+        continue;
+      if (track.p() < _min_P || track.p() > _max_P || abs(track.eta()) > _eta)
+        continue;
+
+      if (track.sign() == _sign_1 && track.isSpecies(_particlePDG_1)) { // filling the map: eventID <-> selected particles1
+        selectedtracksMin_1[track.singleCollSelId()].push_back(std::make_shared<decltype(track)>(track));
+        selectedmomenta_1[track.singleCollSelId()].push_back(o2::aod::singletrackselector::GetFemtoMomentum(track.pt(), track.eta(), track.phi(), mass_1));
+        registry.fill(HIST("p_first"), track.p());
+      }
+
+      if (IsIdentical) {
+        continue;
+      } else if (track.sign() != _sign_2 && !track.isSpecies(_particlePDGtoReject) && track.isSpecies(_particlePDG_2)) { // the rejection uses the species selected by the converter, not rejectWithinNsigmaTOF
+        selectedtracksMin_2[track.singleCollSelId()].push_back(std::make_shared<decltype(track)>(track));
+        selectedmomenta_2[track.singleCollSelId()].push_back(o2::aod::singletrackselector::GetFemtoMomentum(track.pt(), track.eta(), track.phi(), mass_2));
+        registry.fill(HIST("p_second"), track.p());
+      }
+    }
+
+    mixCollisions(collisions, PairMin, selectedtracksMin_1, selectedtracksMin_2);
+  }
+  PROCESS_SWITCH(FemtoCorrelations, processMinimal, "process the minimal single-track table (SingleTrackMins)", false);
 };
 
 WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
@@ -16,11 +16,14 @@
 #ifndef PWGCF_FEMTODREAM_CORE_FEMTODREAMDETADPHISTAR_H_
 #define PWGCF_FEMTODREAM_CORE_FEMTODREAMDETADPHISTAR_H_
 
+#include <array>
+#include <cmath>
 #include <memory>
 #include <string>
 #include <vector>
 #include "PWGCF/DataModel/FemtoDerived.h"
 #include "Framework/HistogramRegistry.h"
+#include "TMath.h"
 
 using namespace o2;
 using namespace o2::framework;
@@ -298,10 +301,23 @@ class FemtoDreamDetaDphiStar
   std::array<std::shared_ptr<THnSparse>, 2> histdetadpi_eta{};
   std::array<std::shared_ptr<THnSparse>, 2> histdetadpi_phi{};
 
+  /// phi* of a particle at the radii stored in tmpRadiiTPC, 999 where the track does not reach the radius
+  struct PhiStarAtRadii {
+    int64_t globalIndex = -1; ///< key of the particle, with the inputs of the computation below
+    float phi = 0.f;
+    float pt = 0.f;
+    int charge = 0;
+    float magfield = 0.f;
+    std::array<float, 9> phiStar{};
+  };
+  static constexpr int kPhiStarCacheSize = 1 << 14; ///< rows of the direct-mapped cache of phi*, indexed by the global index of the particles
+  std::vector<PhiStarAtRadii> mPhiStarCache;          ///< phi* of the last particles, see PhiAtRadiiTPC
+
   ///  Calculate phi at all required radii stored in tmpRadiiTPC
   /// Magnetic field to be provided in Tesla
+  /// The values are computed once per particle and kept in a cache, such that the pairs only compare them
   template <typename T>
-  int PhiAtRadiiTPC(const T& part, std::vector<float>& tmpVec)
+  const PhiStarAtRadii& PhiAtRadiiTPC(const T& part)
   {
 
     float phi0 = part.phi();
@@ -318,21 +334,34 @@ class FemtoDreamDetaDphiStar
     }
     // End: Get the charge from cutcontainer using masks
     float pt = part.pt();
+    const int64_t globalIndex = part.globalIndex();
+    if (mPhiStarCache.empty()) {
+      mPhiStarCache.resize(kPhiStarCacheSize);
+    }
+    auto& row = mPhiStarCache[globalIndex & (kPhiStarCacheSize - 1)];
+    if (row.globalIndex == globalIndex && row.phi == phi0 && row.pt == pt && row.charge == charge && row.magfield == magfield) {
+      return row;
+    }
+    row.globalIndex = globalIndex;
+    row.phi = phi0;
+    row.pt = pt;
+    row.charge = charge;
+    row.magfield = magfield;
     for (size_t i = 0; i < 9; i++) {
       if (runOldVersion) {
-        tmpVec.push_back(phi0 - std::asin(0.3 * charge * 0.1 * magfield * tmpRadiiTPC[i] * 0.01 / (2. * pt)));
+        row.phiStar[i] = phi0 - std::asin(0.3 * charge * 0.1 * magfield * tmpRadiiTPC[i] * 0.01 / (2. * pt));
       }
       if (!runOldVersion) {
         auto arg = 0.3 * charge * magfield * tmpRadiiTPC[i] * 0.01 / (2. * pt);
         // for very low pT particles, this value goes outside of range -1 to 1 at at large tpc radius; asin fails
         if (abs(arg) < 1) {
-          tmpVec.push_back(phi0 - std::asin(0.3 * charge * magfield * tmpRadiiTPC[i] * 0.01 / (2. * pt)));
+          row.phiStar[i] = phi0 - std::asin(arg);
         } else {
-          tmpVec.push_back(999);
+          row.phiStar[i] = 999;
         }
       }
     }
-    return charge;
+    return row;
   }
 
   ///  Calculate phi at specific radii
@@ -376,28 +405,24 @@ class FemtoDreamDetaDphiStar
   template <typename T1, typename T2>
   float AveragePhiStar(const T1& part1, const T2& part2, int iHist, bool* sameCharge)
   {
-    std::vector<float> tmpVec1;
-    std::vector<float> tmpVec2;
-    auto charge1 = PhiAtRadiiTPC(part1, tmpVec1);
-    auto charge2 = PhiAtRadiiTPC(part2, tmpVec2);
-    if (charge1 == charge2) {
+    const auto& phiStar1 = PhiAtRadiiTPC(part1);
+    const auto& phiStar2 = PhiAtRadiiTPC(part2);
+    if (phiStar1.charge == phiStar2.charge) {
       *sameCharge = true;
     }
-    int num = tmpVec1.size();
-    int meaningfulEntries = num;
+    std::array<float, 9> dphi;
     float dPhiAvg = 0;
-    float dphi;
-    for (int i = 0; i < num; i++) {
-      if (tmpVec1.at(i) != 999 && tmpVec2.at(i) != 999) {
-        dphi = tmpVec1.at(i) - tmpVec2.at(i);
-      } else {
-        dphi = 0;
-        meaningfulEntries = meaningfulEntries - 1;
-      }
-      dphi = TVector2::Phi_mpi_pi(dphi);
-      dPhiAvg += dphi;
-      if (plotForEveryRadii) {
-        histdetadpiRadii[iHist][i]->Fill(part1.eta() - part2.eta(), dphi);
+    int meaningfulEntries = 0;
+    for (int i = 0; i < 9; i++) {
+      const bool valid = phiStar1.phiStar[i] != 999 && phiStar2.phiStar[i] != 999;
+      const float d = valid ? phiStar1.phiStar[i] - phiStar2.phiStar[i] : 0.f;
+      dphi[i] = d - TMath::TwoPi() * std::round(d / TMath::TwoPi()); // to [-pi, pi]
+      dPhiAvg += dphi[i];
+      meaningfulEntries += valid;
+    }
+    if (plotForEveryRadii) {
+      for (int i = 0; i < 9; i++) {
+        histdetadpiRadii[iHist][i]->Fill(part1.eta() - part2.eta(), dphi[i]);
       }
     }
     return dPhiAvg / static_cast<float>(meaningfulEntries);
@@ -100,6 +100,7 @@ class FemtoDreamObjectSelection
     for (auto& sel : sels) {
       mSelections.push_back(sel);
     }
+    mFlatSelectionsSet = false;
   }
 
   /// Retrieve the most open selection of a given selection variable
@@ -187,9 +188,52 @@ class FemtoDreamObjectSelection
   }
 
  protected:
+  /// Copies the selections into flat arrays of thresholds, types and positions of the observables, evaluated at once by setSelectionBits
+  /// \tparam F Type of the function giving the positions of the observables of a selection variable
+  /// \param getSlots Function returning the positions in the array of observables of the values checked by a selection variable, one bit per position. The variables handled separately (e.g. PID) have no position
+  template <typename F>
+  void buildFlatSelections(F getSlots)
+  {
+    mFlatValues.clear();
+    mFlatTypes.clear();
+    mFlatSlots.clear();
+    for (auto& sel : mSelections) {
+      for (const int slot : getSlots(sel.getSelectionVariable())) {
+        mFlatValues.push_back(sel.getSelectionValue());
+        mFlatTypes.push_back(sel.getSelectionType());
+        mFlatSlots.push_back(slot);
+      }
+    }
+    mFlatSelectionsSet = true;
+  }
+
+  /// Evaluates all the flat selections and sets their bits, in the order of the selections, as checkSelectionSetBit would
+  /// \tparam T Data type of the bit-wise container for the systematic variations
+  /// \param observables Values of the observables, at the positions given to buildFlatSelections
+  /// \param cutContainer Bit-wise container for the systematic variations
+  /// \param counter Position in the bit-wise container of the first selection, moved after the last one
+  template <typename T>
+  void setSelectionBits(const selValDataType* observables, T& cutContainer, size_t& counter, HistogramRegistry* registry)
+  {
+    for (size_t i = 0; i < mFlatValues.size(); ++i, ++counter) {
+      if (FemtoDreamSelection<selValDataType, selVariable>::isSelected(observables[mFlatSlots[i]], mFlatValues[i], mFlatTypes[i])) {
+        cutContainer |= 1UL << counter;
+        if (registry) {
+          registry->fill(HIST("AnalysisQA/CutCounter"), 8 * sizeof(o2::aod::femtodreamparticle::cutContainerType));
+        }
+      } else if (registry) {
+        registry->fill(HIST("AnalysisQA/CutCounter"), counter);
+      }
+    }
+  }
+
   HistogramRegistry* mHistogramRegistry;                                     ///< For Analysis QA output
   HistogramRegistry* mQAHistogramRegistry;                                   ///< For QA output
   std::vector<FemtoDreamSelection<selValDataType, selVariable>> mSelections; ///< Vector containing all selections
+  std::vector<selValDataType> mFlatValues;                                   ///< Thresholds of the flat selections
+  std::vector<femtoDreamSelection::SelectionType> mFlatTypes;                ///< Types of the flat selections
+  std::vector<int> mFlatSlots;                                               ///< Positions of the observables of the flat selections
+  bool mFlatSelectionsSet = false;                                           ///< Whether the flat selections are up to date
 };
 
 } // namespace femtoDream
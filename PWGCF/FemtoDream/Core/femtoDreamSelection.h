@@ -80,20 +80,30 @@ class FemtoDreamSelection
   /// \return Whether the selection is fulfilled or not
   bool isSelected(selValDataType observable)
   {
-    switch (mSelType) {
+    return isSelected(observable, mSelVal, mSelType);
+  }
+
+  /// Check whether a value fulfills a selection given by its threshold and type
+  /// \param observable Value of the variable to be checked
+  /// \param selVal Value used for the selection
+  /// \param selType Type of selection to be employed
+  /// \return Whether the selection is fulfilled or not
+  static bool isSelected(selValDataType observable, selValDataType selVal, femtoDreamSelection::SelectionType selType)
+  {
+    switch (selType) {
       case (femtoDreamSelection::SelectionType::kUpperLimit):
-        return (observable <= mSelVal);
+        return (observable <= selVal);
       case (femtoDreamSelection::SelectionType::kAbsUpperLimit):
-        return (std::abs(observable) <= mSelVal);
+        return (std::abs(observable) <= selVal);
         break;
       case (femtoDreamSelection::SelectionType::kLowerLimit):
-        return (observable >= mSelVal);
+        return (observable >= selVal);
       case (femtoDreamSelection::SelectionType::kAbsLowerLimit):
-        return (std::abs(observable) >= mSelVal);
+        return (std::abs(observable) >= selVal);
         break;
       case (femtoDreamSelection::SelectionType::kEqual):
         /// \todo can the comparison be done a bit nicer?
-        return (std::abs(observable - mSelVal) < std::abs(mSelVal * 1e-6));
+        return (std::abs(observable - selVal) < std::abs(selVal * 1e-6));
         break;
     }
     return false;
@@ -0,0 +1,125 @@
+// Copyright 2019-2022 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file femtoDreamSortedPairs.h
+/// \brief FemtoDreamSortedPairs - Pair loop over particles sorted in rapidity, pruned by an upper limit on k*
+
+#ifndef PWGCF_FEMTODREAM_CORE_FEMTODREAMSORTEDPAIRS_H_
+#define PWGCF_FEMTODREAM_CORE_FEMTODREAMSORTEDPAIRS_H_
+
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+#include <vector>
+
+namespace o2::analysis::femtoDream
+{
+
+/// \class FemtoDreamSortedPairs
+/// \brief Pair loop over the particles of an event (or of two events for the mixing) sorted in rapidity
+/// A pair with k* < k*_max has an invariant mass below E*_1 + E*_2, with E*_i = sqrt(m_i^2 + k*_max^2), hence
+///   mT1 mT2 cosh(dy) - pT1 pT2 <= A = k*_max^2 + E*_1 E*_2
+/// The maximum of (A + pT1 pT2) / (mT1 mT2) over pT2 gives a window in rapidity which depends on particle 1 only,
+///   cosh(dy) <= sqrt(A^2 + pT1^2 m2^2) / (m2 mT1)
+/// such that the inner loop only runs over the particles of this window. The pairs outside of it have k* > k*_max,
+/// i.e. they are rejected by FemtoDreamContainer::setPair anyway when the same limit is used there.
+class FemtoDreamSortedPairs
+{
+ public:
+  /// Initialization of the masses and of the k* limit
+  /// \param mass1 Mass of particle 1
+  /// \param mass2 Mass of particle 2
+  /// \param kstarMax Upper limit on k*, the window is not restricted if it is not positive
+  void init(float mass1, float mass2, float kstarMax)
+  {
+    mMassOne = mass1;
+    mMassTwo = mass2;
+    mRestricted = kstarMax > 0.f && mass1 > 0.f && mass2 > 0.f;
+    mA = kstarMax * kstarMax + std::sqrt(mass1 * mass1 + kstarMax * kstarMax) * std::sqrt(mass2 * mass2 + kstarMax * kstarMax);
+  }
+
+  /// Loop over all pairs of particle 1 from slice1 and particle 2 from slice2, as CombinationsFullIndexPolicy
+  /// \param pairFunction called for each pair in the rapidity window with (particle 1, particle 2)
+  template <typename SliceType, typename PairFunction>
+  void loopFull(SliceType& slice1, SliceType& slice2, PairFunction&& pairFunction)
+  {
+    auto parts1 = sortInRapidity(slice1, mMassOne, mMassTwo, mSortedOne);
+    auto parts2 = sortInRapidity(slice2, mMassTwo, mMassOne, mSortedTwo);
+    for (auto const& entry1 : mSortedOne) {
+      auto entry2 = std::lower_bound(mSortedTwo.begin(), mSortedTwo.end(), entry1.y - entry1.dy, [](Entry const& entry, float y) { return entry.y < y; });
+      for (; entry2 != mSortedTwo.end() && entry2->y <= entry1.y + entry1.dy; ++entry2) {
+        pairFunction(parts1[entry1.position], parts2[entry2->position]);
+      }
+    }
+  }
+
+  /// Loop over all pairs of particles from the same slice, as CombinationsStrictlyUpperIndexPolicy
+  /// \param pairFunction called for each pair in the rapidity window, the particle with the lower index first
+  template <typename SliceType, typename PairFunction>
+  void loopStrictlyUpper(SliceType& slice, PairFunction&& pairFunction)
+  {
+    auto parts = sortInRapidity(slice, mMassOne, mMassTwo, mSortedOne);
+    for (auto entry1 = mSortedOne.begin(); entry1 != mSortedOne.end(); ++entry1) {
+      for (auto entry2 = entry1 + 1; entry2 != mSortedOne.end() && entry2->y <= entry1->y + entry1->dy; ++entry2) {
+        auto& part1 = parts[entry1->position];
+        auto& part2 = parts[entry2->position];
+        if (part1.globalIndex() < part2.globalIndex()) {
+          pairFunction(part1, part2);
+        } else {
+          pairFunction(part2, part1);
+        }
+      }
+    }
+  }
+
+ private:
+  struct Entry {
+    float y;      ///< Rapidity
+    float dy;     ///< Half width of the rapidity window of the partners
+    int position; ///< Position of the particle in the slice
+  };
+
+  float mMassOne = 0.f;     ///< Mass of particle 1
+  float mMassTwo = 0.f;     ///< Mass of particle 2
+  float mA = 0.f;           ///< k*_max^2 + E*_1 E*_2
+  bool mRestricted = false; ///< Whether the rapidity window is restricted
+  std::vector<Entry> mSortedOne;
+  std::vector<Entry> mSortedTwo;
+
+  /// Half width of the rapidity window of the partners of mass massPartner of a particle
+  float getWindow(float pt, float mT, float massPartner) const
+  {
+    if (!mRestricted) {
+      return INFINITY;
+    }
+    const float coshMax = std::sqrt(mA * mA + pt * pt * massPartner * massPartner) / (massPartner * mT);
+    return std::acosh(std::max(coshMax, 1.f)) + 1.e-4f; // margin for the rounding of the particle kinematics
+  }
+
+  template <typename SliceType>
+  auto sortInRapidity(SliceType& slice, float mass, float massPartner, std::vector<Entry>& sorted)
+  {
+    std::vector<std::decay_t<decltype(slice.begin())>> parts;
+    sorted.clear();
+    for (auto part = slice.begin(); part != slice.end(); ++part) {
+      const float mT = std::sqrt(mass * mass + part.pt() * part.pt());
+      const float y = std::asinh(part.pt() * std::sinh(part.eta()) / mT);
+      sorted.push_back({y, getWindow(part.pt(), mT, massPartner), static_cast<int>(parts.size())});
+      parts.push_back(part);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](Entry const& a, Entry const& b) { return a.y < b.y; });
+    return parts;
+  }
+};
+
+} // namespace o2::analysis::femtoDream
+
+#endif // PWGCF_FEMTODREAM_CORE_FEMTODREAMSORTEDPAIRS_H_
@@ -18,6 +18,7 @@
 #ifndef PWGCF_FEMTODREAM_CORE_FEMTODREAMV0SELECTION_H_
 #define PWGCF_FEMTODREAM_CORE_FEMTODREAMV0SELECTION_H_
 
+#include <array>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -581,53 +582,27 @@ std::array<cutContainerType, 5>
     }
   }
 
-  const auto pT = v0.pt();
-  const auto eta = v0.eta();
-  const auto tranRad = v0.v0radius();
-  const auto dcaDaughv0 = v0.dcaV0daughters();
-  const auto cpav0 = v0.v0cosPA();
-  const std::vector<float> decVtx = {v0.x(), v0.y(), v0.z()};
+  /// all the selections are evaluated at once on the observables of the V0, indexed by selection variable,
+  /// the decay vertex selections check the three coordinates, the y and z ones being stored after the variables
+  if (!mFlatSelectionsSet) {
+    buildFlatSelections([](femtoDreamV0Selection::V0Sel selVar) {
+      return selVar == femtoDreamV0Selection::kV0DecVtxMax ? std::vector<int>{selVar, kNv0Selection, kNv0Selection + 1} : std::vector<int>{selVar};
+    });
+  }
+  std::array<float, kNv0Selection + 2> observables{};
+  observables[femtoDreamV0Selection::kV0Sign] = sign;
+  observables[femtoDreamV0Selection::kV0pTMin] = v0.pt();
+  observables[femtoDreamV0Selection::kV0pTMax] = v0.pt();
+  observables[femtoDreamV0Selection::kV0etaMax] = v0.eta();
+  observables[femtoDreamV0Selection::kV0DCADaughMax] = v0.dcaV0daughters();
+  observables[femtoDreamV0Selection::kV0CPAMin] = v0.v0cosPA();
+  observables[femtoDreamV0Selection::kV0TranRadMin] = v0.v0radius();
+  observables[femtoDreamV0Selection::kV0TranRadMax] = v0.v0radius();
+  observables[femtoDreamV0Selection::kV0DecVtxMax] = v0.x();
+  observables[kNv0Selection] = v0.y();
+  observables[kNv0Selection + 1] = v0.z();
+  setSelectionBits(observables.data(), output, counter, nullptr);
 
-  float observable = 0.;
-  for (auto& sel : mSelections) {
-    const auto selVariable = sel.getSelectionVariable();
-    if (selVariable == femtoDreamV0Selection::kV0DecVtxMax) {
-      for (size_t i = 0; i < decVtx.size(); ++i) {
-        auto decVtxValue = decVtx.at(i);
-        sel.checkSelectionSetBit(decVtxValue, output, counter, nullptr);
-      }
-    } else {
-      switch (selVariable) {
-        case (femtoDreamV0Selection::kV0Sign):
-          observable = sign;
-          break;
-        case (femtoDreamV0Selection::kV0pTMin):
-          observable = pT;
-          break;
-        case (femtoDreamV0Selection::kV0pTMax):
-          observable = pT;
-          break;
-        case (femtoDreamV0Selection::kV0etaMax):
-          observable = eta;
-          break;
-        case (femtoDreamV0Selection::kV0DCADaughMax):
-          observable = dcaDaughv0;
-          break;
-        case (femtoDreamV0Selection::kV0CPAMin):
-          observable = cpav0;
-          break;
-        case (femtoDreamV0Selection::kV0TranRadMin):
-          observable = tranRad;
-          break;
-        case (femtoDreamV0Selection::kV0TranRadMax):
-          observable = tranRad;
-          break;
-        case (femtoDreamV0Selection::kV0DecVtxMax):
-          break;
-      }
-      sel.checkSelectionSetBit(observable, output, counter, nullptr);
-    }
-  }
   return {
     output,
     outputPosTrack.at(femtoDreamTrackSelection::TrackContainerPosition::kCuts),
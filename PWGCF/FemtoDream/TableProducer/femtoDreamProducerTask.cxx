@@ -13,6 +13,7 @@
 /// \brief Tasks that produces the track tables used for the pairing
 /// \author Laura Serksnyte, TU München, laura.serksnyte@tum.de
 
+#include <algorithm>
 #include <CCDB/BasicCCDBManager.h>
 #include "Common/Core/trackUtilities.h"
 #include "Common/DataModel/EventSelection.h"
@@ -57,17 +58,16 @@ using FemtoFullTracks =
             aod::pidTOFFullEl, aod::pidTOFFullPi, aod::pidTOFFullKa, aod::pidTOFFullPr, aod::pidTOFFullDe>;
 } // namespace o2::aod
 
+/// Row of a V0 daughter among the primary tracks stored for the collision, -1 if it is not stored
+/// The global indices of the stored tracks are sorted, since the tracks are filled in the order of the track table
 template <typename T>
 int getRowDaughters(int daughID, T const& vecID)
 {
-  int rowInPrimaryTrackTableDaugh = -1;
-  for (size_t i = 0; i < vecID.size(); i++) {
-    if (vecID.at(i) == daughID) {
-      rowInPrimaryTrackTableDaugh = i;
-      break;
-    }
+  auto it = std::lower_bound(vecID.begin(), vecID.end(), daughID);
+  if (it == vecID.end() || *it != daughID) {
+    return -1;
   }
-  return rowInPrimaryTrackTableDaugh;
+  return it - vecID.begin();
 }
 
 struct femtoDreamProducerTask {
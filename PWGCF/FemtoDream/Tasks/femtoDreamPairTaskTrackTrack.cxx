@@ -35,6 +35,7 @@
 #include "PWGCF/FemtoDream/Core/femtoDreamPairCleaner.h"
 #include "PWGCF/FemtoDream/Core/femtoDreamContainer.h"
 #include "PWGCF/FemtoDream/Core/femtoDreamDetaDphiStar.h"
+#include "PWGCF/FemtoDream/Core/femtoDreamSortedPairs.h"
 #include "PWGCF/FemtoDream/Core/femtoDreamUtils.h"
 
 using namespace o2::aod;
@@ -53,6 +54,7 @@ struct femtoDreamPairTaskTrackTrack {
     Configurable<bool> Use4D{"Option.Use4D", false, "Enable four dimensional histogramms (to be used only for analysis with high statistics): k* vs multiplicity vs multiplicity percentil vs mT"};
     Configurable<bool> ExtendedPlots{"Option.ExtendedPlots", false, "Enable additional three dimensional histogramms. High memory consumption. Use for debugging"};
     Configurable<float> HighkstarCut{"Option.HighkstarCut", -1., "Set a cut for high k*, above which the pairs are rejected. Set it to -1 to deactivate it"};
+    Configurable<bool> SortedPairLoop{"Option.SortedPairLoop", false, "Sort the particles in rapidity and only build the pairs in the rapidity window allowed by Option.HighkstarCut (must be set). CPR and pair cleaner QA are not filled for the pairs outside of it"};
     Configurable<bool> SameSpecies{"Option.SameSpecies", false, "Set to true if particle 1 and particle 2 are the same species"};
     Configurable<bool> MixEventWithPairs{"Option.MixEventWithPairs", false, "Only use events that contain particle 1 and partile 2 for the event mixing"};
     Configurable<bool> RandomizePair{"Option.RandomizePair", true, "Randomly mix particle 1 and particle 2 in case both are identical"};
@@ -220,6 +222,7 @@ struct femtoDreamPairTaskTrackTrack {
   FemtoDreamPairCleaner<aod::femtodreamparticle::ParticleType::kTrack, aod::femtodreamparticle::ParticleType::kTrack> pairCleaner;
   FemtoDreamDetaDphiStar<aod::femtodreamparticle::ParticleType::kTrack, aod::femtodreamparticle::ParticleType::kTrack> pairCloseRejectionSE;
   FemtoDreamDetaDphiStar<aod::femtodreamparticle::ParticleType::kTrack, aod::femtodreamparticle::ParticleType::kTrack> pairCloseRejectionME;
+  FemtoDreamSortedPairs sortedPairs;
   /// Histogram output
   HistogramRegistry qaRegistry{"TrackQA", {}, OutputObjHandlingPolicy::AnalysisObject};
   HistogramRegistry resultRegistry{"Correlations", {}, OutputObjHandlingPolicy::AnalysisObject};
@@ -252,6 +255,12 @@ struct femtoDreamPairTaskTrackTrack {
     sameEventCont.setPDGCodes(Track1.PDGCode, Track2.PDGCode);
     mixedEventCont.setPDGCodes(Track1.PDGCode, Track2.PDGCode);
     pairCleaner.init(&qaRegistry);
+    if (Option.SortedPairLoop.value) {
+      if (Option.HighkstarCut.value <= 0) {
+        LOG(fatal) << "Option.SortedPairLoop requires Option.HighkstarCut to be set!";
+      }
+      sortedPairs.init(getMass(Track1.PDGCode), getMass(Track2.PDGCode), Option.HighkstarCut.value);
+    }
     if (Option.CPROn.value) {
       pairCloseRejectionSE.init(&resultRegistry, &qaRegistry, Option.CPRdeltaPhiMax.value, Option.CPRdeltaEtaMax.value, Option.CPRPlotPerRadii.value, 1, Option.CPROld.value);
       pairCloseRejectionME.init(&resultRegistry, &qaRegistry, Option.CPRdeltaPhiMax.value, Option.CPRdeltaEtaMax.value, Option.CPRPlotPerRadii.value, 2, Option.CPROld.value);
@@ -334,38 +343,61 @@ struct femtoDreamPairTaskTrackTrack {
 
     /// Now build the combinations
     float rand = 0.;
-    if (Option.SameSpecies.value) {
-      for (auto& [p1, p2] : combinations(CombinationsStrictlyUpperIndexPolicy(SliceTrk1, SliceTrk2))) {
-        if (Option.CPROn.value) {
-          if (pairCloseRejectionSE.isClosePair(p1, p2, parts, col.magField())) {
-            continue;
-          }
+    auto processPair = [&](auto const& p1, auto const& p2) {
+      if (Option.CPROn.value) {
+        if (pairCloseRejectionSE.isClosePair(p1, p2, parts, col.magField())) {
+          return;
         }
-        // track cleaning
-        if (!pairCleaner.isCleanPair(p1, p2, parts)) {
-          continue;
+      }
+      // track cleaning
+      if (!pairCleaner.isCleanPair(p1, p2, parts)) {
+        return;
+      }
+      if (Option.SameSpecies.value && Option.RandomizePair.value) {
+        rand = random->Rndm();
+      }
+      if (rand <= 0.5) {
+        sameEventCont.setPair<isMC>(p1, p2, col.multNtr(), col.multV0M(), Option.Use4D, Option.ExtendedPlots, Option.SmearingByOrigin);
+      } else {
+        sameEventCont.setPair<isMC>(p2, p1, col.multNtr(), col.multV0M(), Option.Use4D, Option.ExtendedPlots, Option.SmearingByOrigin);
+      }
+    };
+    if (Option.SameSpecies.value) {
+      if (Option.SortedPairLoop.value) {
+        sortedPairs.loopStrictlyUpper(SliceTrk1, processPair);
+      } else {
+        for (auto& [p1, p2] : combinations(CombinationsStrictlyUpperIndexPolicy(SliceTrk1, SliceTrk2))) {
+          processPair(p1, p2);
         }
-        if (Option.RandomizePair.value) {
-          rand = random->Rndm();
+      }
+    } else {
+      if (Option.SortedPairLoop.value) {
+        sortedPairs.loopFull(SliceTrk1, SliceTrk2, processPair);
+      } else {
+        for (auto& [p1, p2] : combinations(CombinationsFullIndexPolicy(SliceTrk1, SliceTrk2))) {
+          processPair(p1, p2);
         }
-        if (rand <= 0.5) {
-          sameEventCont.setPair<isMC>(p1, p2, col.multNtr(), col.multV0M(), Option.Use4D, Option.ExtendedPlots, Option.SmearingByOrigin);
-        } else {
-          sameEventCont.setPair<isMC>(p2, p1, col.multNtr(), col.multV0M(), Option.Use4D, Option.ExtendedPlots, Option.SmearingByOrigin);
+      }
+    }
+  }
+
+  /// Loop over the pairs of particle 1 and particle 2 of two mixed events, see Option.SortedPairLoop
+  template <bool isMC, typename SliceType, typename PartType, typename CollisionType>
+  void mixPairs(SliceType& SliceTrk1, SliceType& SliceTrk2, PartType const& parts, CollisionType const& collision1)
+  {
+    auto processPair = [&](auto const& p1, auto const& p2) {
+      if (Option.CPROn.value) {
+        if (pairCloseRejectionME.isClosePair(p1, p2, parts, collision1.magField())) {
+          return;
         }
       }
+      mixedEventCont.setPair<isMC>(p1, p2, collision1.multNtr(), collision1.multV0M(), Option.Use4D, Option.ExtendedPlots, Option.SmearingByOrigin);
+    };
+    if (Option.SortedPairLoop.value) {
+      sortedPairs.loopFull(SliceTrk1, SliceTrk2, processPair);
     } else {
       for (auto& [p1, p2] : combinations(CombinationsFullIndexPolicy(SliceTrk1, SliceTrk2))) {
-        if (Option.CPROn.value) {
-          if (pairCloseRejectionSE.isClosePair(p1, p2, parts, col.magField())) {
-            continue;
-          }
-        }
-        // track cleaning
-        if (!pairCleaner.isCleanPair(p1, p2, parts)) {
-          continue;
-        }
-        sameEventCont.setPair<isMC>(p1, p2, col.multNtr(), col.multV0M(), Option.Use4D, Option.ExtendedPlots, Option.SmearingByOrigin);
+        processPair(p1, p2);
       }
     }
   }
@@ -450,14 +482,7 @@ struct femtoDreamPairTaskTrackTrack {
       if (SliceTrk1.size() == 0 || SliceTrk2.size() == 0) {
         continue;
       }
-      for (auto& [p1, p2] : combinations(CombinationsFullIndexPolicy(SliceTrk1, SliceTrk2))) {
-        if (Option.CPROn.value) {
-          if (pairCloseRejectionME.isClosePair(p1, p2, parts, collision1.magField())) {
-            continue;
-          }
-        }
-        mixedEventCont.setPair<isMC>(p1, p2, collision1.multNtr(), collision1.multV0M(), Option.Use4D, Option.ExtendedPlots, Option.SmearingByOrigin);
-      }
+      mixPairs<isMC>(SliceTrk1, SliceTrk2, parts, collision1);
     }
   }
 
@@ -482,14 +507,7 @@ struct femtoDreamPairTaskTrackTrack {
         auto SliceTrk1 = part1->sliceByCached(aod::femtodreamparticle::fdCollisionId, collision1.globalIndex(), cache);
         auto SliceTrk2 = part2->sliceByCached(aod::femtodreamparticle::fdCollisionId, collision2.globalIndex(), cache);
 
-        for (auto& [p1, p2] : combinations(CombinationsFullIndexPolicy(SliceTrk1, SliceTrk2))) {
-          if (Option.CPROn.value) {
-            if (pairCloseRejectionME.isClosePair(p1, p2, parts, collision1.magField())) {
-              continue;
-            }
-          }
-          mixedEventCont.setPair<isMC>(p1, p2, collision1.multNtr(), collision1.multV0M(), Option.Use4D, Option.ExtendedPlots, Option.SmearingByOrigin);
-        }
+        mixPairs<isMC>(SliceTrk1, SliceTrk2, parts, collision1);
       }
     } else {
       // In the other case where the two particles are not the same species and we do not mix event with pairs,  we only need to define one partition of collisions and make self combinations
@@ -499,14 +517,7 @@ struct femtoDreamPairTaskTrackTrack {
         for (auto const& [collision1, collision2] : selfCombinations(policy, Mixing.Depth.value, -1, *partition.mFiltered, *partition.mFiltered)) {
           auto SliceTrk1 = part1->sliceByCached(aod::femtodreamparticle::fdCollisionId, collision1.globalIndex(), cache);
           auto SliceTrk2 = part2->sliceByCached(aod::femtodreamparticle::fdCollisionId, collision2.globalIndex(), cache);
-          for (auto& [p1, p2] : combinations(CombinationsFullIndexPolicy(SliceTrk1, SliceTrk2))) {
-            if (Option.CPROn.value) {
-              if (pairCloseRejectionME.isClosePair(p1, p2, parts, collision1.magField())) {
-                continue;
-              }
-            }
-            mixedEventCont.setPair<isMC>(p1, p2, collision1.multNtr(), collision1.multV0M(), Option.Use4D.value, Option.ExtendedPlots.value, Option.SmearingByOrigin.value);
-          }
+          mixPairs<isMC>(SliceTrk1, SliceTrk2, parts, collision1);
         }
       };
       if (Option.SameSpecies.value && Option.MixEventWithPairs.value) {
@@ -18,6 +18,8 @@
 #ifndef PWGCF_FEMTOUNIVERSE_CORE_FEMTOUNIVERSEDETADPHISTAR_H_
 #define PWGCF_FEMTOUNIVERSE_CORE_FEMTOUNIVERSEDETADPHISTAR_H_
 
+#include <array>
+#include <cmath>
 #include <memory>
 #include <string>
 #include <vector>
@@ -394,59 +396,72 @@ class FemtoUniverseDetaDphiStar
   std::array<std::array<std::shared_ptr<TH2>, 2>, 2> histdetadpimixed{};
   std::array<std::array<std::shared_ptr<TH2>, 9>, 2> histdetadpiRadii{};
 
+  /// phi* of a particle at the radii stored in tmpRadiiTPC, 999 where the track does not reach the radius
+  struct PhiStarAtRadii {
+    int64_t globalIndex = -1; ///< key of the particle, with the inputs of the computation below
+    float phi = 0.f;
+    float pt = 0.f;
+    float charge = 0.f;
+    float magfield = 0.f;
+    std::array<float, 9> phiStar{};
+  };
+  static constexpr int kPhiStarCacheSize = 1 << 14; ///< rows of the direct-mapped cache of phi*, indexed by the global index of the particles
+  std::vector<PhiStarAtRadii> mPhiStarCache;          ///< phi* of the last particles, see PhiAtRadiiTPC
+
   ///  Calculate phi at all required radii stored in tmpRadiiTPC
   /// Magnetic field to be provided in Tesla
+  /// The values are computed once per particle and kept in a cache, such that the pairs only compare them
   template <typename T>
-  void PhiAtRadiiTPC(const T& part, std::vector<float>& tmpVec)
+  const std::array<float, 9>& PhiAtRadiiTPC(const T& part)
   {
-
-    float phi0 = part.phi();
     // Start: Get the charge from cutcontainer using masks
-    float charge = 0.;
-    if ((part.cut() & kSignMinusMask) == kValue0 && (part.cut() & kSignPlusMask) == kValue0) {
-      charge = 0;
-    } else if ((part.cut() & kSignPlusMask) == kSignPlusMask) {
-      charge = 1;
-    } else if ((part.cut() & kSignMinusMask) == kSignMinusMask) {
-      charge = -1;
-    } else {
-      LOG(fatal) << "FemtoUniverseDetaDphiStar: Charge bits are set wrong!";
-    }
+    const float charge = GetCharge(part);
     // End: Get the charge from cutcontainer using masks
-    float pt = part.pt();
+    const int64_t globalIndex = part.globalIndex();
+    const float phi0 = part.phi();
+    const float pt = part.pt();
+    if (mPhiStarCache.empty()) {
+      mPhiStarCache.resize(kPhiStarCacheSize);
+    }
+    auto& row = mPhiStarCache[globalIndex & (kPhiStarCacheSize - 1)];
+    if (row.globalIndex == globalIndex && row.phi == phi0 && row.pt == pt && row.charge == charge && row.magfield == magfield) {
+      return row.phiStar;
+    }
+    row.globalIndex = globalIndex;
+    row.phi = phi0;
+    row.pt = pt;
+    row.charge = charge;
+    row.magfield = magfield;
     for (size_t i = 0; i < 9; i++) {
       double arg = 0.3 * charge * magfield * tmpRadiiTPC[i] * 0.01 / (2. * pt);
       if (abs(arg) < 1.0) {
-        tmpVec.push_back(phi0 - std::asin(arg));
+        row.phiStar[i] = phi0 - std::asin(arg);
       } else {
-        tmpVec.push_back(999.0);
+        row.phiStar[i] = 999.0;
       }
     }
+    return row.phiStar;
   }
 
   ///  Calculate average phi
   template <typename T1, typename T2>
   float AveragePhiStar(const T1& part1, const T2& part2, int iHist)
   {
-    std::vector<float> tmpVec1;
-    std::vector<float> tmpVec2;
-    PhiAtRadiiTPC(part1, tmpVec1);
-    PhiAtRadiiTPC(part2, tmpVec2);
-    int num = tmpVec1.size();
+    const auto& phiStar1 = PhiAtRadiiTPC(part1);
+    const auto& phiStar2 = PhiAtRadiiTPC(part2);
+    std::array<float, 9> dphi;
     float dPhiAvg = 0;
-    float dphi = 0;
     int entries = 0;
-    for (int i = 0; i < num; i++) {
-      if (tmpVec1.at(i) != 999 && tmpVec2.at(i) != 999) {
-        dphi = tmpVec1.at(i) - tmpVec2.at(i);
-        entries++;
-      } else {
-        dphi = 0;
-      }
-      dphi = TVector2::Phi_mpi_pi(dphi);
-      dPhiAvg += dphi;
-      if (plotForEveryRadii) {
-        histdetadpiRadii[iHist][i]->Fill(part1.eta() - part2.eta(), dphi);
+    for (int i = 0; i < 9; i++) {
+      const bool valid = phiStar1[i] != 999 && phiStar2[i] != 999;
+      const float d = valid ? phiStar1[i] - phiStar2[i] : 0.f;
+      dphi[i] = d - TMath::TwoPi() * std::round(d / TMath::TwoPi()); // to [-pi, pi]
+      dPhiAvg += dphi[i];
+      entries += valid;
+    }
+    if (plotForEveryRadii) {
+      for (int i = 0; i < 9; i++) {
+        histdetadpiRadii[iHist][i]->Fill(part1.eta() - part2.eta(), dphi[i]);
       }
     }
     return dPhiAvg / static_cast<float>(entries);
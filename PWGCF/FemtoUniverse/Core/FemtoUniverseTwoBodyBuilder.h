@@ -0,0 +1,165 @@
+// Copyright 2019-2022 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file FemtoUniverseTwoBodyBuilder.h
+/// \brief FemtoUniverseTwoBodyBuilder - Combinatorics of two-body resonance candidates (e.g. phi -> K+ K-)
+
+#ifndef PWGCF_FEMTOUNIVERSE_CORE_FEMTOUNIVERSETWOBODYBUILDER_H_
+#define PWGCF_FEMTOUNIVERSE_CORE_FEMTOUNIVERSETWOBODYBUILDER_H_
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "CommonConstants/MathConstants.h"
+
+namespace o2::analysis::femtoUniverse
+{
+
+/// \class FemtoUniverseTwoBodyBuilder
+/// \brief Builds the two-body candidates of a collision from two sets of already selected daughters
+/// The daughters are sorted by chi = asinh(p/m), the rapidity along their momentum. Since the relative Lorentz factor of
+/// two particles is at least cosh(chi1 - chi2), a pair can only have an invariant mass below the upper mass limit if
+/// |chi1 - chi2| is below a limit set by the masses, and only these pairs are combined. The kinematics is computed with floats.
+class FemtoUniverseTwoBodyBuilder
+{
+ public:
+  /// Two-body candidate
+  struct Candidate {
+    int indexOne; ///< index of the first daughter, as given to addDaughter
+    int indexTwo; ///< index of the second daughter, as given to addDaughter
+    float pt;
+    float eta;
+    float phi; ///< in [0, 2pi)
+    float mass;
+  };
+
+  /// Initialization of the daughter masses and of the candidate selection
+  /// \param massOne Mass of the first daughter
+  /// \param massTwo Mass of the second daughter
+  /// \param massMin Lower limit of the invariant mass
+  /// \param massMax Upper limit of the invariant mass
+  /// \param ptMin Lower limit of the candidate pT
+  /// \param ptMax Upper limit of the candidate pT
+  /// \param etaMax Upper limit of the candidate |eta|
+  void init(float massOne, float massTwo, float massMin, float massMax, float ptMin, float ptMax, float etaMax)
+  {
+    mMassOne = massOne;
+    mMassTwo = massTwo;
+    mMassMin = massMin;
+    mMassMax = massMax;
+    mPtMin = ptMin;
+    mPtMax = ptMax;
+    mEtaMax = etaMax;
+    const float gammaMax = (massMax * massMax - massOne * massOne - massTwo * massTwo) / (2.f * massOne * massTwo);
+    mDeltaChiMax = gammaMax < 1.f ? -1.f : std::acosh(gammaMax) + 1.e-4f; // margin for the float rounding
+  }
+
+  /// Removes the daughters and candidates of the previous collision
+  void clear()
+  {
+    mDaughters[0].clear();
+    mDaughters[1].clear();
+    mCandidates.clear();
+  }
+
+  /// Adds a daughter
+  /// \param isSecond Whether the daughter is a candidate for the second daughter (false for the first one)
+  /// \param index Index of the daughter, returned in the candidates
+  void addDaughter(bool isSecond, int index, float pt, float eta, float phi)
+  {
+    const float mass = isSecond ? mMassTwo : mMassOne;
+    Daughter daughter;
+    daughter.index = index;
+    daughter.px = pt * std::cos(phi);
+    daughter.py = pt * std::sin(phi);
+    daughter.pz = pt * std::sinh(eta);
+    const float p = pt * std::cosh(eta);
+    daughter.e = std::sqrt(p * p + mass * mass);
+    daughter.chi = std::asinh(p / mass);
+    mDaughters[isSecond ? 1 : 0].push_back(daughter);
+  }
+
+  /// Combines the daughters and selects the candidates
+  /// \return Candidates, ordered by index of the first and then of the second daughter
+  std::vector<Candidate> const& build()
+  {
+    mCandidates.clear();
+    if (mDeltaChiMax < 0.f) {
+      return mCandidates;
+    }
+    auto& daughtersTwo = mDaughters[1];
+    const auto byChi = [](Daughter const& a, Daughter const& b) { return a.chi < b.chi; };
+    std::sort(daughtersTwo.begin(), daughtersTwo.end(), byChi);
+    const float massMin2 = mMassMin * mMassMin;
+    const float massMax2 = mMassMax * mMassMax;
+    const float sumMass2 = mMassOne * mMassOne + mMassTwo * mMassTwo;
+    for (auto const& one : mDaughters[0]) {
+      Daughter bound;
+      bound.chi = one.chi - mDeltaChiMax;
+      auto two = std::lower_bound(daughtersTwo.begin(), daughtersTwo.end(), bound, byChi);
+      for (; two != daughtersTwo.end() && two->chi <= one.chi + mDeltaChiMax; ++two) {
+        if (two->index == one.index) {
+          continue;
+        }
+        const float mass2 = sumMass2 + 2.f * (one.e * two->e - one.px * two->px - one.py * two->py - one.pz * two->pz);
+        if (mass2 < massMin2 || mass2 > massMax2) {
+          continue;
+        }
+        const float px = one.px + two->px;
+        const float py = one.py + two->py;
+        const float pz = one.pz + two->pz;
+        const float pt = std::hypot(px, py);
+        if (pt < mPtMin || pt > mPtMax) {
+          continue;
+        }
+        const float eta = std::asinh(pz / pt);
+        if (std::abs(eta) > mEtaMax) {
+          continue;
+        }
+        float phi = std::atan2(py, px);
+        if (phi < 0.f) {
+          phi += o2::constants::math::TwoPI;
+        }
+        mCandidates.push_back({one.index, two->index, pt, eta, phi, std::sqrt(mass2)});
+      }
+    }
+    std::sort(mCandidates.begin(), mCandidates.end(), [](Candidate const& a, Candidate const& b) {
+      return a.indexOne < b.indexOne || (a.indexOne == b.indexOne && a.indexTwo < b.indexTwo);
+    });
+    return mCandidates;
+  }
+
+ private:
+  struct Daughter {
+    float chi; // rapidity along the momentum, asinh(p/m)
+    float px;
+    float py;
+    float pz;
+    float e;
+    int index;
+  };
+
+  float mMassOne = 0.f;
+  float mMassTwo = 0.f;
+  float mMassMin = 0.f;
+  float mMassMax = 0.f;
+  float mPtMin = 0.f;
+  float mPtMax = 0.f;
+  float mEtaMax = 0.f;
+  float mDeltaChiMax = -1.f;           // upper limit of |chi1 - chi2| for a mass below mMassMax
+  std::vector<Daughter> mDaughters[2]; // first and second daughters
+  std::vector<Candidate> mCandidates;  // selected candidates
+};
+
+} // namespace o2::analysis::femtoUniverse
+
+#endif // PWGCF_FEMTOUNIVERSE_CORE_FEMTOUNIVERSETWOBODYBUILDER_H_
@@ -30,6 +30,7 @@
 #include "PWGCF/FemtoUniverse/Core/FemtoUniverseTrackSelection.h"
 #include "PWGCF/FemtoUniverse/Core/FemtoUniverseV0Selection.h"
 #include "PWGCF/FemtoUniverse/Core/FemtoUniversePhiSelection.h"
+#include "PWGCF/FemtoUniverse/Core/FemtoUniverseTwoBodyBuilder.h"
 #include "PWGCF/FemtoUniverse/Core/FemtoUtils.h"
 #include "PWGHF/DataModel/CandidateReconstructionTables.h"
 #include "PWGHF/DataModel/CandidateSelectionTables.h"
@@ -205,6 +206,7 @@ struct femtoUniverseProducerTask {
 
   // PHI
   FemtoUniversePhiSelection phiCuts;
+  FemtoUniverseTwoBodyBuilder phiBuilder;
   struct : o2::framework::ConfigurableGroup {
     Configurable<std::vector<float>> ConfPhiSign{FemtoUniversePhiSelection::getSelectionName(femtoUniversePhiSelection::kPhiSign, "ConfPhi"), std::vector<float>{-1, 1}, FemtoUniversePhiSelection::getSelectionHelper(femtoUniversePhiSelection::kPhiSign, "Phi selection: ")};
     Configurable<std::vector<float>> ConfPhiPtMin{FemtoUniversePhiSelection::getSelectionName(femtoUniversePhiSelection::kPhipTMin, "ConfPhi"), std::vector<float>{0.3f, 0.4f, 0.5f}, FemtoUniversePhiSelection::getSelectionHelper(femtoUniversePhiSelection::kPhipTMin, "Phi selection: ")};
@@ -391,6 +393,9 @@ struct femtoUniverseProducerTask {
     if (ConfIsActivatePhi) {
       // initializing for Phi meson
       phiCuts.init<aod::femtouniverseparticle::ParticleType::kPhi, aod::femtouniverseparticle::ParticleType::kPhiChild, aod::femtouniverseparticle::cutContainerType>(&qaRegistry);
+      float mMassOne = TDatabasePDG::Instance()->GetParticle(ConfPhiChildOne.ConfPDGCodePartOne)->Mass(); // FIXME: Get from the PDG service of the common header
+      float mMassTwo = TDatabasePDG::Instance()->GetParticle(ConfPhiChildTwo.ConfPDGCodePartTwo)->Mass(); // FIXME: Get from the PDG service of the common header
+      phiBuilder.init(mMassOne, mMassTwo, ConfPhiCommon.ConfInvMassLowLimitPhi, ConfPhiCommon.ConfInvMassUpLimitPhi, 0.14, 10.0, 0.8);
     }
 
     mRunNumber = 0;
@@ -884,51 +889,28 @@ struct femtoUniverseProducerTask {
   {
     std::vector<int> childIDs = {0, 0}; // these IDs are necessary to keep track of the children
     std::vector<int> tmpIDtrack;        // this vector keeps track of the matching of the primary track table row <-> aod::track table global index
-    // lorentz vectors and filling the tables
-    for (auto& [p1, p2] : combinations(soa::CombinationsStrictlyUpperIndexPolicy(tracks, tracks))) {
-      // implementing PID cuts for phi children
-      if (!(IsKaonNSigma(p1.pt(), trackCuts.getNsigmaTPC(p1, o2::track::PID::Kaon), trackCuts.getNsigmaTOF(p1, o2::track::PID::Kaon)))) {
-        continue;
-      }
-      if (!(IsKaonNSigma(p2.pt(), trackCuts.getNsigmaTPC(p2, o2::track::PID::Kaon), trackCuts.getNsigmaTOF(p2, o2::track::PID::Kaon)))) {
-        continue;
-      } else if ((!(p1.sign() == 1)) || (!(p2.sign() == -1))) {
-        continue;
-      }
-
-      TLorentzVector part1Vec;
-      TLorentzVector part2Vec;
-
-      float mMassOne = TDatabasePDG::Instance()->GetParticle(ConfPhiChildOne.ConfPDGCodePartOne)->Mass(); // FIXME: Get from the PDG service of the common header
-      float mMassTwo = TDatabasePDG::Instance()->GetParticle(ConfPhiChildTwo.ConfPDGCodePartTwo)->Mass(); // FIXME: Get from the PDG service of the common header
-
-      part1Vec.SetPtEtaPhiM(p1.pt(), p1.eta(), p1.phi(), mMassOne);
-      part2Vec.SetPtEtaPhiM(p2.pt(), p2.eta(), p2.phi(), mMassTwo);
-
-      TLorentzVector sumVec(part1Vec);
-      sumVec += part2Vec;
-
-      float phiEta = sumVec.Eta();
-      if (TMath::Abs(phiEta) > 0.8) {
-        continue;
-      }
-
-      float phiPt = sumVec.Pt();
-      if ((phiPt < 0.14) || (phiPt > 10.0)) {
-        continue;
-      }
-
-      float phiPhi = sumVec.Phi();
-      if (sumVec.Phi() < 0) {
-        phiPhi = sumVec.Phi() + 2 * o2::constants::math::PI;
-      } else if (sumVec.Phi() >= 0) {
-        phiPhi = sumVec.Phi();
+    // the kaon candidates are selected once per track, K+ as first and K- as second daughters, and combined by the two-body builder
+    phiBuilder.clear();
+    int iTrack = 0;
+    for (auto const& track : tracks) {
+      if (IsKaonNSigma(track.pt(), trackCuts.getNsigmaTPC(track, o2::track::PID::Kaon), trackCuts.getNsigmaTOF(track, o2::track::PID::Kaon))) {
+        if (track.sign() == 1) {
+          phiBuilder.addDaughter(false, iTrack, track.pt(), track.eta(), track.phi());
+        } else if (track.sign() == -1) {
+          phiBuilder.addDaughter(true, iTrack, track.pt(), track.eta(), track.phi());
+        }
       }
-      float phiM = sumVec.M();
+      iTrack++;
+    }
 
-      if (((phiM < ConfPhiCommon.ConfInvMassLowLimitPhi) || (phiM > ConfPhiCommon.ConfInvMassUpLimitPhi))) {
-        continue;
-      }
+    // filling the tables
+    for (auto const& phiCandidate : phiBuilder.build()) {
+      auto p1 = tracks.iteratorAt(phiCandidate.indexOne);
+      auto p2 = tracks.iteratorAt(phiCandidate.indexTwo);
+      float phiPt = phiCandidate.pt;
+      float phiEta = phiCandidate.eta;
+      float phiPhi = phiCandidate.phi;
+      float phiM = phiCandidate.mass;
 
       phiCuts.fillQA<aod::femtouniverseparticle::ParticleType::kPhi, aod::femtouniverseparticle::ParticleType::kPhiChild>(col, p1, p1, p2, ConfPhiChildOne.ConfPDGCodePartOne, ConfPhiChildTwo.ConfPDGCodePartTwo); ///\todo fill QA also for daughters
 
@@ -10,13 +10,16 @@
 // or submit itself to any jurisdiction.
 
 #include "BootstrapProfile.h"
+
+#include <algorithm>
 BootstrapProfile::BootstrapProfile() : TProfile(),
                                        fListOfEntries(0),
                                        fProfInitialized(kFALSE),
                                        fNSubs(0),
                                        fMultiRebin(0),
                                        fMultiRebinEdges(0),
-                                       fPresetWeights(0) {}
+                                       fPresetWeights(0),
+                                       fSparseSubsamples(kFALSE) {}
 BootstrapProfile::~BootstrapProfile()
 {
   delete fListOfEntries;
@@ -27,15 +30,17 @@ BootstrapProfile::BootstrapProfile(const char* name, const char* title, Int_t nb
                                                                                                                fNSubs(0),
                                                                                                                fMultiRebin(0),
                                                                                                                fMultiRebinEdges(0),
-                                                                                                               fPresetWeights(0) {}
+                                                                                                               fPresetWeights(0),
+                                                                                                               fSparseSubsamples(kFALSE) {}
 BootstrapProfile::BootstrapProfile(const char* name, const char* title, Int_t nbinsx, Double_t xlow, Double_t xup) : TProfile(name, title, nbinsx, xlow, xup),
                                                                                                                      fListOfEntries(0),
                                                                                                                      fProfInitialized(kFALSE),
                                                                                                                      fNSubs(0),
                                                                                                                      fMultiRebin(0),
                                                                                                                      fMultiRebinEdges(0),
-                                                                                                                     fPresetWeights(0) {}
-void BootstrapProfile::InitializeSubsamples(Int_t nSub)
+                                                                                                                     fPresetWeights(0),
+                                                                                                                     fSparseSubsamples(kFALSE) {}
+void BootstrapProfile::InitializeSubsamples(Int_t nSub, Bool_t sparse)
 {
   if (nSub < 1) {
     printf("Number of subprofiles has to be > 0!\n");
@@ -43,6 +48,15 @@ void BootstrapProfile::InitializeSubsamples(Int_t nSub)
   }
   if (fListOfEntries)
     delete fListOfEntries;
+  fListOfEntries = 0;
+  fSparseSubsamples = sparse;
+  if (fSparseSubsamples) {
+    fSparseBins.assign(nSub, std::vector<Int_t>());
+    fSparseSums.assign(nSub, std::vector<Double_t>());
+    fSparseStats.assign(nSub * kSparseNStats, 0.);
+    fNSubs = nSub;
+    return;
+  }
   fListOfEntries = new TList();
   fListOfEntries->SetOwner(kTRUE);
   TProfile* dummyPF = reinterpret_cast<TProfile*>(this);
@@ -60,7 +74,134 @@ void BootstrapProfile::FillProfile(const Double_t& xv, const Double_t& yv, const
   Int_t targetInd = rn * fNSubs;
   if (targetInd >= fNSubs)
     targetInd = 0;
-  reinterpret_cast<TProfile*>(fListOfEntries->At(targetInd))->Fill(xv, yv, w);
+  if (fSparseSubsamples)
+    FillSparse(targetInd, xv, yv, w);
+  else
+    reinterpret_cast<TProfile*>(fListOfEntries->At(targetInd))->Fill(xv, yv, w);
+}
+void BootstrapProfile::FillSparse(Int_t isub, Double_t xv, Double_t yv, Double_t w)
+{
+  // Same sums as TProfile::Fill(x, y, w) with Sumw2 enabled
+  if (fYmin != fYmax && (yv < fYmin || yv > fYmax || TMath::IsNaN(yv)))
+    return;
+  Int_t bin = fXaxis.FindFixBin(xv);
+  std::vector<Int_t>& bins = fSparseBins[isub];
+  std::vector<Double_t>& sums = fSparseSums[isub];
+  auto it = std::lower_bound(bins.begin(), bins.end(), bin);
+  size_t slot = it - bins.begin();
+  if (it == bins.end() || *it != bin) {
+    bins.insert(it, bin);
+    sums.insert(sums.begin() + slot * kSparseNSums, kSparseNSums, 0.);
+  }
+  Double_t* binSums = &sums[slot * kSparseNSums];
+  binSums[0] += w;
+  binSums[1] += w * w;
+  binSums[2] += w * yv;
+  binSums[3] += w * yv * yv;
+  Double_t* stats = &fSparseStats[isub * kSparseNStats];
+  stats[kSparseNStats - 1] += 1;
+  if ((bin == 0 || bin > fXaxis.GetNbins()) && !GetStatOverflowsBehaviour())
+    return;
+  stats[0] += w;
+  stats[1] += w * w;
+  stats[2] += w * xv;
+  stats[3] += w * xv * xv;
+  stats[4] += w * yv;
+  stats[5] += w * yv * yv;
+}
+void BootstrapProfile::MaterializeSubsamples()
+{
+  if (!fSparseSubsamples)
+    return;
+  fSparseSubsamples = kFALSE;
+  if (fListOfEntries)
+    delete fListOfEntries;
+  fListOfEntries = new TList();
+  fListOfEntries->SetOwner(kTRUE);
+  TProfile* dummyPF = reinterpret_cast<TProfile*>(this);
+  for (Int_t i = 0; i < fNSubs; i++) {
+    TProfile* subpf = reinterpret_cast<TProfile*>(dummyPF->Clone(Form("%s_Subpf%i", dummyPF->GetName(), i)));
+    subpf->Reset();
+    if (!subpf->GetBinSumw2()->fN)
+      subpf->Sumw2();
+    Double_t* sumwy = subpf->fArray;
+    Double_t* sumwy2 = subpf->GetSumw2()->fArray;
+    Double_t* sumw2 = subpf->GetBinSumw2()->fArray;
+    for (size_t slot = 0; slot < fSparseBins[i].size(); slot++) {
+      Int_t bin = fSparseBins[i][slot];
+      const Double_t* binSums = &fSparseSums[i][slot * kSparseNSums];
+      subpf->SetBinEntries(bin, binSums[0]);
+      sumw2[bin] = binSums[1];
+      sumwy[bin] = binSums[2];
+      sumwy2[bin] = binSums[3];
+    }
+    subpf->PutStats(&fSparseStats[i * kSparseNStats]);
+    subpf->SetEntries(fSparseStats[i * kSparseNStats + kSparseNStats - 1]);
+    fListOfEntries->Add(subpf);
+  }
+  std::vector<std::vector<Int_t>>().swap(fSparseBins);
+  std::vector<std::vector<Double_t>>().swap(fSparseSums);
+  std::vector<Double_t>().swap(fSparseStats);
+}
+void BootstrapProfile::MergeSubsamples(BootstrapProfile* target)
+{
+  if (fSparseSubsamples && target->fSparseSubsamples) {
+    if (target->fNSubs != fNSubs) {
+      printf("Number of subprofiles of %s does not match (%i vs %i), not merging them\n", target->GetName(), target->fNSubs, fNSubs);
+      return;
+    }
+    // streaming merge of the sorted bin lists
+    std::vector<Int_t> bins;
+    std::vector<Double_t> sums;
+    for (Int_t i = 0; i < fNSubs; i++) {
+      const std::vector<Int_t>& bins1 = fSparseBins[i];
+      const std::vector<Int_t>& bins2 = target->fSparseBins[i];
+      const std::vector<Double_t>& sums1 = fSparseSums[i];
+      const std::vector<Double_t>& sums2 = target->fSparseSums[i];
+      for (Int_t j = 0; j < kSparseNStats; j++)
+        fSparseStats[i * kSparseNStats + j] += target->fSparseStats[i * kSparseNStats + j];
+      if (bins1 == bins2) { // usual case, same bins filled
+        for (size_t j = 0; j < sums1.size(); j++)
+          fSparseSums[i][j] += sums2[j];
+        continue;
+      }
+      bins.clear();
+      sums.clear();
+      size_t i1 = 0, i2 = 0;
+      while (i1 < bins1.size() || i2 < bins2.size()) {
+        if (i2 == bins2.size() || (i1 < bins1.size() && bins1[i1] < bins2[i2])) {
+          bins.push_back(bins1[i1]);
+          sums.insert(sums.end(), sums1.begin() + i1 * kSparseNSums, sums1.begin() + (i1 + 1) * kSparseNSums);
+          i1++;
+        } else if (i1 == bins1.size() || bins2[i2] < bins1[i1]) {
+          bins.push_back(bins2[i2]);
+          sums.insert(sums.end(), sums2.begin() + i2 * kSparseNSums, sums2.begin() + (i2 + 1) * kSparseNSums);
+          i2++;
+        } else {
+          bins.push_back(bins1[i1]);
+          for (Int_t j = 0; j < kSparseNSums; j++)
+            sums.push_back(sums1[i1 * kSparseNSums + j] + sums2[i2 * kSparseNSums + j]);
+          i1++;
+          i2++;
+        }
+      }
+      fSparseBins[i].swap(bins);
+      fSparseSums[i].swap(sums);
+    }
+    return;
+  }
+  target->MaterializeSubsamples();
+  TList* tarL = target->fListOfEntries;
+  if (!tarL)
+    return;
+  MaterializeSubsamples();
+  if (!fListOfEntries) {
+    fListOfEntries = reinterpret_cast<TList*>(tarL->Clone());
+    fNSubs = fListOfEntries->GetEntries();
+    return;
+  }
+  for (Int_t i = 0; i < fListOfEntries->GetEntries(); i++)
+    reinterpret_cast<TProfile*>(fListOfEntries->At(i))->Add(reinterpret_cast<TProfile*>(tarL->At(i)));
 }
 void BootstrapProfile::FillProfile(const Double_t& xv, const Double_t& yv, const Double_t& w)
 {
@@ -68,6 +209,7 @@ void BootstrapProfile::FillProfile(const Double_t& xv, const Double_t& yv, const
 }
 void BootstrapProfile::RebinMulti(Int_t nbins)
 {
+  MaterializeSubsamples();
   this->RebinX(nbins);
   if (!fListOfEntries)
     return;
@@ -76,6 +218,7 @@ void BootstrapProfile::RebinMulti(Int_t nbins)
 }
 TH1* BootstrapProfile::getHist(Int_t ind)
 {
+  MaterializeSubsamples();
   if (fPresetWeights && fMultiRebin > 0)
     return getWeightBasedRebin(ind);
   if (ind < 0) {
@@ -96,6 +239,7 @@ TH1* BootstrapProfile::getHist(Int_t ind)
 }
 TProfile* BootstrapProfile::getProfile(Int_t ind)
 {
+  MaterializeSubsamples();
   if (ind < 0) {
     return reinterpret_cast<TProfile*>(this);
   } else {
@@ -113,22 +257,11 @@ TProfile* BootstrapProfile::getProfile(Int_t ind)
 }
 Long64_t BootstrapProfile::Merge(TCollection* collist)
 {
-  Long64_t nmergedpf = TProfile::Merge(collist);
+  Long64_t nmergedpf = TProfile::Merge(collist); // main profiles, the subprofiles are merged below
   BootstrapProfile* l_PBS = 0;
   TIter all_PBS(collist);
-  while ((l_PBS = reinterpret_cast<BootstrapProfile*>(all_PBS()))) {
-    reinterpret_cast<TProfile*>(this)->Add(reinterpret_cast<TProfile*>(l_PBS));
-    TList* tarL = l_PBS->fListOfEntries;
-    if (!tarL)
-      continue;
-    if (!fListOfEntries) {
-      fListOfEntries = reinterpret_cast<TList*>(tarL->Clone());
-      for (Int_t i = 0; i < fListOfEntries->GetEntries(); i++)
-        reinterpret_cast<TProfile*>(fListOfEntries->At(i))->Reset();
-    }
-    for (Int_t i = 0; i < fListOfEntries->GetEntries(); i++)
-      reinterpret_cast<TProfile*>(fListOfEntries->At(i))->Add(reinterpret_cast<TProfile*>(tarL->At(i)));
-  }
+  while ((l_PBS = reinterpret_cast<BootstrapProfile*>(all_PBS())))
+    MergeSubsamples(l_PBS);
   return nmergedpf;
 };
 void BootstrapProfile::RebinMulti(Int_t nbins, Double_t* binedges)
@@ -195,19 +328,11 @@ TH1* BootstrapProfile::getWeightBasedRebin(Int_t ind)
 void BootstrapProfile::MergeBS(BootstrapProfile* target)
 {
   this->Add(target);
-  TList* tarL = target->fListOfEntries;
-  if (!fListOfEntries) {
-    if (!target->fListOfEntries)
-      return;
-    fListOfEntries = reinterpret_cast<TList*>(tarL->Clone());
-    for (Int_t i = 0; i < fListOfEntries->GetEntries(); i++)
-      reinterpret_cast<TProfile*>(fListOfEntries->At(i))->Reset();
-  }
-  for (Int_t i = 0; i < fListOfEntries->GetEntries(); i++)
-    reinterpret_cast<TProfile*>(fListOfEntries->At(i))->Add(reinterpret_cast<TProfile*>(tarL->At(i)));
+  MergeSubsamples(target);
 }
 TProfile* BootstrapProfile::getSummedProfiles()
 {
+  MaterializeSubsamples();
   if (!fListOfEntries || !fListOfEntries->GetEntries()) {
     printf("No subprofiles initialized for the BootstrapProfile.\n");
     return 0;
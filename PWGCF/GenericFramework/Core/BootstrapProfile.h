@@ -12,6 +12,7 @@
 #ifndef PWGCF_GENERICFRAMEWORK_CORE_BOOTSTRAPPROFILE_H_
 #define PWGCF_GENERICFRAMEWORK_CORE_BOOTSTRAPPROFILE_H_
 
+#include <vector>
 #include "TProfile.h"
 #include "TList.h"
 #include "TString.h"
@@ -27,7 +28,7 @@ class BootstrapProfile : public TProfile
   BootstrapProfile(const char* name, const char* title, Int_t nbinsx, Double_t xlow, Double_t xup);
   TList* fListOfEntries;
   void MergeBS(BootstrapProfile* target);
-  void InitializeSubsamples(Int_t nSub);
+  void InitializeSubsamples(Int_t nSub, Bool_t sparse = kFALSE);
   void FillProfile(const Double_t& xv, const Double_t& yv, const Double_t& w, const Double_t& rn);
   void FillProfile(const Double_t& xv, const Double_t& yv, const Double_t& w);
   Long64_t Merge(TCollection* collist);
@@ -37,15 +38,20 @@ class BootstrapProfile : public TProfile
   TProfile* getProfile(Int_t ind = -1);
   TProfile* getSummedProfiles();
   void OverrideMainWithSub();
-  Int_t getNSubs() { return fListOfEntries->GetEntries(); }
+  Int_t getNSubs()
+  {
+    MaterializeSubsamples();
+    return fListOfEntries->GetEntries();
+  }
   void PresetWeights(BootstrapProfile* targetBS) { fPresetWeights = targetBS; }
   void ResetBin(Int_t nbin)
   {
+    MaterializeSubsamples();
     ResetBin(reinterpret_cast<TProfile*>(this), nbin);
     for (Int_t i = 0; i < fListOfEntries->GetEntries(); i++)
       ResetBin(reinterpret_cast<TProfile*>(fListOfEntries->At(i)), nbin);
   };
-  ClassDef(BootstrapProfile, 2);
+  ClassDef(BootstrapProfile, 3);
 
  protected:
   TH1* getHistRebinned(TProfile* inpf); // Performs rebinning, if required, and returns a projection of profile
@@ -55,6 +61,17 @@ class BootstrapProfile : public TProfile
   Int_t fMultiRebin;                //! externaly set runtime, no need to store
   Double_t* fMultiRebinEdges;       //! externaly set runtime, no need to store
   BootstrapProfile* fPresetWeights; //! BootstrapProfile whose weights we should copy
+  // Sparse subsamples: per subsample, only the filled bins are stored, sorted, and the subprofiles
+  // are created from them when they are first requested (getProfile, getHist, ...)
+  static constexpr Int_t kSparseNSums = 4;  // sum of w, w^2, w*y and w*y^2 of a bin, as in TProfile
+  static constexpr Int_t kSparseNStats = 7; // TProfile statistics (see TProfile::GetStats) and number of entries
+  Bool_t fSparseSubsamples;
+  std::vector<std::vector<Int_t>> fSparseBins;    // [subsample][bin slot] sorted bin numbers
+  std::vector<std::vector<Double_t>> fSparseSums; // [subsample][bin slot * kSparseNSums]
+  std::vector<Double_t> fSparseStats;             // [subsample * kSparseNStats]
+  void FillSparse(Int_t isub, Double_t xv, Double_t yv, Double_t w);
+  void MergeSubsamples(BootstrapProfile* target);
+  void MaterializeSubsamples();
   void ResetBin(TProfile* tpf, Int_t nbin)
   {
     tpf->SetBinEntries(nbin, 0);
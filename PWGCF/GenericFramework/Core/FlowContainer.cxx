@@ -25,7 +25,8 @@ FlowContainer::FlowContainer() : TNamed("", ""),
                                  fXAxis(0),
                                  fNbinsPt(0),
                                  fbinsPt(0),
-                                 fPropagateErrors(kFALSE) {}
+                                 fPropagateErrors(kFALSE),
+                                 fSparseSubsamples(kFALSE) {}
 FlowContainer::FlowContainer(const char* name) : TNamed(name, name),
                                                  fProf(0),
                                                  fProfRand(0),
@@ -38,7 +39,8 @@ FlowContainer::FlowContainer(const char* name) : TNamed(name, name),
                                                  fXAxis(0),
                                                  fNbinsPt(0),
                                                  fbinsPt(0),
-                                                 fPropagateErrors(kFALSE) {}
+                                                 fPropagateErrors(kFALSE),
+                                                 fSparseSubsamples(kFALSE) {}
 FlowContainer::~FlowContainer()
 {
   delete fProf;
@@ -66,7 +68,13 @@ void FlowContainer::Initialize(TObjArray* inputList, const o2::framework::AxisSp
   for (int i = 0; i < inputList->GetEntries(); i++)
     fProf->GetYaxis()->SetBinLabel(i + 1, inputList->At(i)->GetName());
   fProf->Sumw2();
-  if (nRandom) {
+  if (nRandom && fSparseSubsamples) {
+    fNRandom = nRandom;
+    fSparseBins.clear();
+    fSparseSums.clear();
+    fSparseSlot.clear();
+    fSparseStats.assign(nRandom * kSparseNStats, 0.);
+  } else if (nRandom) {
     fNRandom = nRandom;
     fProfRand = new TObjArray();
     fProfRand->SetOwner(kTRUE);
@@ -91,7 +99,13 @@ void FlowContainer::Initialize(TObjArray* inputList, int nMultiBins, double Mult
   fProf->Sumw2();
   for (int i = 0; i < inputList->GetEntries(); i++)
     fProf->GetYaxis()->SetBinLabel(i + 1, inputList->At(i)->GetName());
-  if (nRandom) {
+  if (nRandom && fSparseSubsamples) {
+    fNRandom = nRandom;
+    fSparseBins.clear();
+    fSparseSums.clear();
+    fSparseSlot.clear();
+    fSparseStats.assign(nRandom * kSparseNStats, 0.);
+  } else if (nRandom) {
     fNRandom = nRandom;
     fProfRand = new TObjArray();
     fProfRand->SetOwner(kTRUE);
@@ -145,7 +159,10 @@ int FlowContainer::FillProfile(const char* hname, double multi, double corr, dou
   fProf->Fill(multi, yin, corr, w);
   if (fNRandom) {
     double rnind = rn * fNRandom;
-    dynamic_cast<TProfile2D*>(fProfRand->At(static_cast<int>(rnind)))->Fill(multi, yin, corr, w);
+    if (fSparseSubsamples)
+      FillSparse(static_cast<int>(rnind), multi, yin, corr, w);
+    else
+      dynamic_cast<TProfile2D*>(fProfRand->At(static_cast<int>(rnind)))->Fill(multi, yin, corr, w);
   }
   return 0;
 };
@@ -201,21 +218,7 @@ Long64_t FlowContainer::Merge(TCollection* collist)
       tpro->Add(spro);
     }
     nmerged++;
-    TObjArray* tarr = l_FC->GetSubProfiles();
-    if (!tarr)
-      continue;
-    if (!fProfRand) {
-      fProfRand = new TObjArray();
-      fProfRand->SetOwner(kTRUE);
-    }
-    for (int i = 0; i < tarr->GetEntries(); i++) {
-      if (!(fProfRand->FindObject(tarr->At(i)->GetName()))) {
-        fProfRand->Add(dynamic_cast<TProfile2D*>(tarr->At(i)->Clone(tarr->At(i)->GetName())));
-        dynamic_cast<TProfile2D*>(fProfRand->At(fProfRand->GetEntries() - 1))->SetDirectory(0);
-      } else {
-        dynamic_cast<TProfile2D*>(fProfRand->FindObject(tarr->At(i)->GetName()))->Add(dynamic_cast<TProfile2D*>(tarr->At(i)));
-      }
-    }
+    MergeSubProfiles(l_FC);
   }
   return nmerged;
 }
@@ -260,10 +263,35 @@ void FlowContainer::PickAndMerge(TFile* tfi)
   } else {
     tpro->Add(spro);
   }
+  MergeSubProfiles(lfc);
+}
+void FlowContainer::MergeSubProfiles(FlowContainer* lfc)
+{
+  if (fSparseSubsamples && lfc->fSparseSubsamples) { // both sparse: sums of the bins, no profile is created
+    if (!fNRandom && fSparseBins.empty()) {
+      fNRandom = lfc->fNRandom;
+      fSparseStats.assign(fNRandom * kSparseNStats, 0.);
+    }
+    if (lfc->fNRandom != fNRandom || lfc->fProf->GetNcells() != fProf->GetNcells()) {
+      printf("Subsamples of %s do not match, not merging them\n", lfc->GetName());
+      return;
+    }
+    for (size_t i = 0; i < lfc->fSparseBins.size(); i++) {
+      int slot = GetSparseSlot(lfc->fSparseBins[i]);
+      double* sums = &fSparseSums[slot * fNRandom * kSparseNSums];
+      const double* lsums = &lfc->fSparseSums[i * fNRandom * kSparseNSums];
+      for (int j = 0; j < fNRandom * kSparseNSums; j++)
+        sums[j] += lsums[j];
+    }
+    for (size_t i = 0; i < fSparseStats.size(); i++)
+      fSparseStats[i] += lfc->fSparseStats[i];
+    return;
+  }
   TObjArray* tarr = lfc->GetSubProfiles();
   if (!tarr) {
     return;
   }
+  MaterializeSubProfiles();
   if (!fProfRand) {
     fProfRand = new TObjArray();
     fProfRand->SetOwner(kTRUE);
@@ -277,6 +305,78 @@ void FlowContainer::PickAndMerge(TFile* tfi)
     }
   }
 }
+int FlowContainer::GetSparseSlot(int bin)
+{
+  if (static_cast<int>(fSparseSlot.size()) != fProf->GetNcells()) { // not streamed, rebuilt from the filled bins
+    fSparseSlot.assign(fProf->GetNcells(), -1);
+    for (size_t i = 0; i < fSparseBins.size(); i++)
+      fSparseSlot[fSparseBins[i]] = i;
+  }
+  if (fSparseSlot[bin] < 0) {
+    fSparseSlot[bin] = fSparseBins.size();
+    fSparseBins.push_back(bin);
+    fSparseSums.resize(fSparseSums.size() + fNRandom * kSparseNSums, 0.);
+  }
+  return fSparseSlot[bin];
+}
+void FlowContainer::FillSparse(int isample, double x, double y, double z, double w)
+{
+  // Same sums as TProfile2D::Fill(x, y, z, w) with Sumw2 enabled
+  int binx = fProf->GetXaxis()->FindFixBin(x);
+  int biny = fProf->GetYaxis()->FindFixBin(y);
+  int slot = GetSparseSlot(fProf->GetBin(binx, biny));
+  double* sums = &fSparseSums[(slot * fNRandom + isample) * kSparseNSums];
+  sums[0] += w;
+  sums[1] += w * w;
+  sums[2] += w * z;
+  sums[3] += w * z * z;
+  double* stats = &fSparseStats[isample * kSparseNStats];
+  stats[kSparseNStats - 1] += 1;
+  if ((binx == 0 || binx > fProf->GetNbinsX() || biny == 0 || biny > fProf->GetNbinsY()) && !fProf->GetStatOverflowsBehaviour())
+    return;
+  stats[0] += w;
+  stats[1] += w * w;
+  stats[2] += w * x;
+  stats[3] += w * x * x;
+  stats[4] += w * y;
+  stats[5] += w * y * y;
+  stats[6] += w * x * y;
+  stats[7] += w * z;
+  stats[8] += w * z * z;
+}
+void FlowContainer::MaterializeSubProfiles()
+{
+  if (!fSparseSubsamples)
+    return;
+  fSparseSubsamples = kFALSE;
+  if (fProf && fNRandom) {
+    fProfRand = new TObjArray();
+    fProfRand->SetOwner(kTRUE);
+    for (int i = 0; i < fNRandom; i++) {
+      TProfile2D* prof = dynamic_cast<TProfile2D*>(fProf->Clone(Form("%s_Rand_%i", fProf->GetName(), i)));
+      prof->SetDirectory(0);
+      prof->Reset();
+      double* sumwy = prof->fArray;
+      double* sumwy2 = prof->GetSumw2()->fArray;
+      double* sumw2 = prof->GetBinSumw2()->fArray;
+      for (size_t slot = 0; slot < fSparseBins.size(); slot++) {
+        int bin = fSparseBins[slot];
+        const double* sums = &fSparseSums[(slot * fNRandom + i) * kSparseNSums];
+        prof->SetBinEntries(bin, sums[0]);
+        sumw2[bin] = sums[1];
+        sumwy[bin] = sums[2];
+        sumwy2[bin] = sums[3];
+      }
+      prof->PutStats(&fSparseStats[i * kSparseNStats]);
+      prof->SetEntries(fSparseStats[i * kSparseNStats + kSparseNStats - 1]);
+      fProfRand->Add(prof);
+    }
+  }
+  std::vector<int>().swap(fSparseBins);
+  std::vector<double>().swap(fSparseSums);
+  std::vector<double>().swap(fSparseStats);
+  std::vector<int>().swap(fSparseSlot);
+}
 bool FlowContainer::OverrideBinsWithZero(int xb1, int yb1, int xb2, int yb2)
 {
   ProfileSubset* t_apf = new ProfileSubset(*fProf);
@@ -290,6 +390,7 @@ bool FlowContainer::OverrideBinsWithZero(int xb1, int yb1, int xb2, int yb2)
 }
 bool FlowContainer::OverrideMainWithSub(int ind, bool ExcludeChosen)
 {
+  MaterializeSubProfiles();
   if (!fProfRand) {
     printf("Cannot override main profile with a randomized one. Random profile array does not exist.\n");
     return kFALSE;
@@ -322,6 +423,7 @@ bool FlowContainer::OverrideMainWithSub(int ind, bool ExcludeChosen)
 }
 bool FlowContainer::RandomizeProfile(int nSubsets)
 {
+  MaterializeSubProfiles();
   if (!fProfRand) {
     printf("Cannot randomize profile, random array does not exist.\n");
     return kFALSE;
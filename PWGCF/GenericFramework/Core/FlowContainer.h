@@ -45,6 +45,7 @@ class FlowContainer : public TNamed
   void SetXAxis();
   void RebinMulti(int rN)
   {
+    MaterializeSubProfiles();
     if (fProf)
       fProf->RebinX(rN);
   };
@@ -59,7 +60,13 @@ class FlowContainer : public TNamed
   bool OverrideMainWithSub(int subind, bool ExcludeChosen);
   bool RandomizeProfile(int nSubsets = 0);
   bool CreateStatisticsProfile(StatisticsType StatType, int arg);
-  TObjArray* GetSubProfiles() { return fProfRand; }
+  TObjArray* GetSubProfiles()
+  {
+    MaterializeSubProfiles();
+    return fProfRand;
+  }
+  void SetSparseSubsamples(bool newval) { fSparseSubsamples = newval; } // to be called before Initialize
+  bool GetSparseSubsamples() { return fSparseSubsamples; }
   Long64_t Merge(TCollection* collist);
   void SetIDName(TString newname); //! do not store
   void SetPtRebin(int newval) { fPtRebin = newval; }
@@ -162,8 +169,21 @@ class FlowContainer : public TNamed
   int fNbinsPt;          //! Do not store; stored in the fXAxis
   double* fbinsPt;       //! Do not store; stored in fXAxis
   bool fPropagateErrors; //! do not store
+  // Sparse subsamples: only the bins filled at least once are allocated, for all the subsamples at once,
+  // and the subsample profiles are created from them when they are first requested (GetSubProfiles)
+  static constexpr int kSparseNSums = 4;   // sum of w, w^2, w*y and w*y^2 of a bin, as in TProfile2D
+  static constexpr int kSparseNStats = 10; // TProfile2D statistics (see TProfile2D::GetStats) and number of entries
+  bool fSparseSubsamples;
+  std::vector<int> fSparseBins;     // global bins of fProf, in order of first fill
+  std::vector<double> fSparseSums;  // [bin slot][subsample][kSparseNSums]
+  std::vector<double> fSparseStats; // [subsample][kSparseNStats]
+  std::vector<int> fSparseSlot;     //! global bin -> slot in fSparseBins, rebuilt on demand
+  int GetSparseSlot(int bin);
+  void FillSparse(int isample, double x, double y, double z, double w);
+  void MaterializeSubProfiles();
+  void MergeSubProfiles(FlowContainer* lfc);
   TProfile* GetRefFlowProfile(const char* order, double m1 = -1, double m2 = -1);
-  ClassDef(FlowContainer, 2);
+  ClassDef(FlowContainer, 3);
 };
 
 #endif // PWGCF_GENERICFRAMEWORK_CORE_FLOWCONTAINER_H_
@@ -21,7 +21,8 @@ FlowPtContainer::FlowPtContainer() : TNamed("name", "name"),
                                      fillCounter(0),
                                      fEventWeight(kEventWeight::kUnity),
                                      corrNum(),
-                                     corrDen() {}
+                                     corrDen(),
+                                     fSparseSubsamples(false) {}
 FlowPtContainer::~FlowPtContainer()
 {
   delete fCMTermList;
@@ -37,7 +38,8 @@ FlowPtContainer::FlowPtContainer(const char* name) : TNamed(name, name),
                                                      fillCounter(0),
                                                      fEventWeight(kEventWeight::kUnity),
                                                      corrNum(),
-                                                     corrDen() {}
+                                                     corrDen(),
+                                                     fSparseSubsamples(false) {}
 FlowPtContainer::FlowPtContainer(const char* name, const char* title, int nbinsx, double* xbins, const int& m, const GFWCorrConfigs& configs) : TNamed(name, title),
                                                                                                                                                 fCMTermList(0),
                                                                                                                                                 fCorrList(0),
@@ -48,7 +50,8 @@ FlowPtContainer::FlowPtContainer(const char* name, const char* title, int nbinsx
                                                                                                                                                 fillCounter(0),
                                                                                                                                                 fEventWeight(kEventWeight::kUnity),
                                                                                                                                                 corrNum(),
-                                                                                                                                                corrDen()
+                                                                                                                                                corrDen(),
+                                                                                                                                                fSparseSubsamples(false)
 {
   Initialise(nbinsx, xbins, m, configs);
 };
@@ -62,7 +65,8 @@ FlowPtContainer::FlowPtContainer(const char* name, const char* title, int nbinsx
                                                                                                                                                             fillCounter(0),
                                                                                                                                                             fEventWeight(kEventWeight::kUnity),
                                                                                                                                                             corrNum(),
-                                                                                                                                                            corrDen()
+                                                                                                                                                            corrDen(),
+                                                                                                                                                            fSparseSubsamples(false)
 {
   Initialise(nbinsx, xlow, xhigh, m, configs);
 };
@@ -105,11 +109,11 @@ void FlowPtContainer::Initialise(const o2::framework::AxisSpec axis, const int&
   }
   if (nsub) {
     for (int i = 0; i < fCorrList->GetEntries(); ++i)
-      dynamic_cast<BootstrapProfile*>(fCorrList->At(i))->InitializeSubsamples(nsub);
+      dynamic_cast<BootstrapProfile*>(fCorrList->At(i))->InitializeSubsamples(nsub, fSparseSubsamples);
     for (int i = 0; i < fCMTermList->GetEntries(); ++i)
-      dynamic_cast<BootstrapProfile*>(fCMTermList->At(i))->InitializeSubsamples(nsub);
+      dynamic_cast<BootstrapProfile*>(fCMTermList->At(i))->InitializeSubsamples(nsub, fSparseSubsamples);
     for (int i = 0; i < fCovList->GetEntries(); ++i)
-      dynamic_cast<BootstrapProfile*>(fCovList->At(i))->InitializeSubsamples(nsub);
+      dynamic_cast<BootstrapProfile*>(fCovList->At(i))->InitializeSubsamples(nsub, fSparseSubsamples);
   }
   printf("Container %s initialized with m = %i\n and %i subsamples", this->GetName(), mpar, nsub);
   return;
@@ -141,11 +145,11 @@ void FlowPtContainer::Initialise(int nbinsx, double* xbins, const int& m, const
   }
   if (nsub) {
     for (int i = 0; i < fCorrList->GetEntries(); ++i)
-      dynamic_cast<BootstrapProfile*>(fCorrList->At(i))->InitializeSubsamples(nsub);
+      dynamic_cast<BootstrapProfile*>(fCorrList->At(i))->InitializeSubsamples(nsub, fSparseSubsamples);
     for (int i = 0; i < fCMTermList->GetEntries(); ++i)
-      dynamic_cast<BootstrapProfile*>(fCMTermList->At(i))->InitializeSubsamples(nsub);
+      dynamic_cast<BootstrapProfile*>(fCMTermList->At(i))->InitializeSubsamples(nsub, fSparseSubsamples);
     for (int i = 0; i < fCovList->GetEntries(); ++i)
-      dynamic_cast<BootstrapProfile*>(fCovList->At(i))->InitializeSubsamples(nsub);
+      dynamic_cast<BootstrapProfile*>(fCovList->At(i))->InitializeSubsamples(nsub, fSparseSubsamples);
   }
   printf("Container %s initialized with m = %i\n", this->GetName(), mpar);
 };
@@ -176,11 +180,11 @@ void FlowPtContainer::Initialise(int nbinsx, double xlow, double xhigh, const in
   }
   if (nsub) {
     for (int i = 0; i < fCorrList->GetEntries(); ++i)
-      dynamic_cast<BootstrapProfile*>(fCorrList->At(i))->InitializeSubsamples(nsub);
+      dynamic_cast<BootstrapProfile*>(fCorrList->At(i))->InitializeSubsamples(nsub, fSparseSubsamples);
     for (int i = 0; i < fCMTermList->GetEntries(); ++i)
-      dynamic_cast<BootstrapProfile*>(fCMTermList->At(i))->InitializeSubsamples(nsub);
+      dynamic_cast<BootstrapProfile*>(fCMTermList->At(i))->InitializeSubsamples(nsub, fSparseSubsamples);
     for (int i = 0; i < fCovList->GetEntries(); ++i)
-      dynamic_cast<BootstrapProfile*>(fCovList->At(i))->InitializeSubsamples(nsub);
+      dynamic_cast<BootstrapProfile*>(fCovList->At(i))->InitializeSubsamples(nsub, fSparseSubsamples);
   }
   printf("Container %s initialized with m = %i\n", this->GetName(), mpar);
 };
@@ -54,6 +54,7 @@ class FlowPtContainer : public TNamed
   TList* GetCorrList() { return fCorrList; }
   TList* GetCMTermList() { return fCMTermList; }
   void SetEventWeight(const unsigned int& lWeight) { fEventWeight = lWeight; }
+  void SetSparseSubsamples(bool newval) { fSparseSubsamples = newval; } // to be called before Initialise
   void RebinMulti(Int_t nbins);
   void RebinMulti(Int_t nbins, double* binedges);
   TH1* getCentralMomentHist(int ind, int m);
@@ -87,6 +88,7 @@ class FlowPtContainer : public TNamed
   std::vector<double> sumP;    //!
   std::vector<double> corrNum; //!
   std::vector<double> corrDen; //!
+  bool fSparseSubsamples;      //! only used in Initialise
 
   static constexpr float fFactorial[9] = {1., 1., 2., 6., 24., 120., 720., 5040., 40320.};
   static constexpr int fSign[9] = {1, -1, 1, -1, 1, -1, 1, -1, 1};
@@ -94,16 +94,42 @@ int GFW::CreateRegions()
     fCumulants.push_back(*lCumulant);
     ++nRegions;
   }
+  fBatches.assign(fCumulants.size(), FillBatch());
   if (nRegions)
     fInitialized = true;
+  ++fGeneration;
   return nRegions;
 };
 void GFW::Fill(double eta, int ptin, double phi, double weight, int mask, double SecondWeight)
 {
   // if(!fInitialized) return;
   for (int i = 0; i < static_cast<int>(fRegions.size()); ++i) {
-    if (fRegions.at(i).EtaMin < eta && fRegions.at(i).EtaMax > eta && (fRegions.at(i).BitMask & mask))
-      fCumulants.at(i).FillArray(ptin, phi, weight, SecondWeight);
+    if (fRegions.at(i).EtaMin < eta && fRegions.at(i).EtaMax > eta && (fRegions.at(i).BitMask & mask)) {
+      if (fBatchFill) {
+        FillBatch& batch = fBatches.at(i);
+        batch.ptin.push_back(ptin);
+        batch.phi.push_back(phi);
+        batch.weight.push_back(weight);
+        batch.secondWeight.push_back(SecondWeight);
+      } else {
+        fCumulants.at(i).FillArray(ptin, phi, weight, SecondWeight);
+        ++fGeneration;
+      }
+    }
+  }
+};
+void GFW::FlushBatches()
+{
+  for (int i = 0; i < static_cast<int>(fBatches.size()); ++i) {
+    FillBatch& batch = fBatches[i];
+    if (batch.phi.empty())
+      continue;
+    fCumulants.at(i).FillArrays(batch.phi.size(), batch.ptin.data(), batch.phi.data(), batch.weight.data(), batch.secondWeight.data());
+    ++fGeneration;
+    batch.ptin.clear();
+    batch.phi.clear();
+    batch.weight.clear();
+    batch.secondWeight.clear();
   }
 };
 complex<double> GFW::TwoRec(int n1, int n2, int p1, int p2, int ptbin, GFWCumulant* r1, GFWCumulant* r2, GFWCumulant* r3)
@@ -168,6 +194,13 @@ void GFW::Clear()
     CreateRegions();
   for (auto ptr = fCumulants.begin(); ptr != fCumulants.end(); ++ptr)
     ptr->ResetQs();
+  ++fGeneration;
+  for (auto& batch : fBatches) {
+    batch.ptin.clear();
+    batch.phi.clear();
+    batch.weight.clear();
+    batch.secondWeight.clear();
+  }
 };
 GFW::CorrConfig GFW::GetCorrelatorConfig(string config, string head, bool ptdif)
 {
@@ -249,6 +282,7 @@ GFW::CorrConfig GFW::GetCorrelatorConfig(string config, string head, bool ptdif)
   ReturnConfig.Head = head;
   ReturnConfig.pTDif = ptdif;
   // ReturnConfig.pTbin = ptbin;
+  CompilePlans(ReturnConfig);
   fListOfCFGs.push_back(ReturnConfig);
   return ReturnConfig;
 };
@@ -260,9 +294,10 @@ complex<double> GFW::Calculate(int poi, int ref, vector<int> hars, int ptbin)
   GFWCumulant* qovl = qpoi;
   return RecursiveCorr(qpoi, qref, qovl, ptbin, hars);
 };
-complex<double> GFW::Calculate(CorrConfig corconf, int ptbin, bool SetHarmsToZero)
+complex<double> GFW::Calculate(const CorrConfig& corconf, int ptbin, bool SetHarmsToZero)
 {
   // if(!fInitialized) return complex<double>(0,0); //First check if initialised, if not -- initialize, and if it fails, return
+  FlushBatches();
   if (corconf.Regs.size() == 0)
     return complex<double>(0, 0); // Check if we have any regions at all
   complex<double> retval(1, 0);
@@ -296,15 +331,172 @@ complex<double> GFW::Calculate(CorrConfig corconf, int ptbin, bool SetHarmsToZer
       qovl = &fCumulants.at(ovl);
     else if (ref == poi)
       qovl = qref; // If ref and poi are the same, then the same is for overlap. Only, when OL not explicitly defined
+    if (corconf.Plans.size() == 2 * corconf.Regs.size()) {
+      retval *= EvaluatePlan(corconf.Plans.at(2 * i + (SetHarmsToZero ? 1 : 0)), ptInd);
+      continue;
+    }
+    vector<int> hars = corconf.Hars.at(i);
     if (SetHarmsToZero) {
-      for (int j = 0; j < static_cast<int>(corconf.Hars.at(i).size()); j++) {
-        corconf.Hars.at(i).at(j) = 0;
+      for (int j = 0; j < static_cast<int>(hars.size()); j++) {
+        hars.at(j) = 0;
       }
     }
-    retval *= RecursiveCorr(qpoi, qref, qovl, ptInd, corconf.Hars.at(i));
+    retval *= RecursiveCorr(qpoi, qref, qovl, ptInd, hars);
   }
   return retval;
 };
+int GFW::PlanLeaf(int cumulant, int har, int pow, bool ptDif)
+{
+  vector<int> key = {0, cumulant, har, pow, ptDif};
+  auto itr = fPlanNodeIndex.find(key);
+  if (itr != fPlanNodeIndex.end())
+    return itr->second;
+  PlanNode node;
+  node.cumulant = cumulant;
+  node.har = har;
+  node.pow = pow;
+  node.ptDif = ptDif;
+  fPlanNodes.push_back(node);
+  fPlanNodeIndex[key] = static_cast<int>(fPlanNodes.size()) - 1;
+  return static_cast<int>(fPlanNodes.size()) - 1;
+};
+int GFW::CompileCorr(int poi, int ref, int ovl, vector<int>& hars, vector<int>& pows)
+{
+  // Same recursion as RecursiveCorr, building the nodes instead of evaluating them
+  if ((pows.at(0) != 1) && ovl > -1)
+    poi = ovl;
+  vector<int> key = {1, poi, ref, ovl};
+  key.insert(key.end(), hars.begin(), hars.end());
+  key.insert(key.end(), pows.begin(), pows.end());
+  auto itr = fPlanNodeIndex.find(key);
+  if (itr != fPlanNodeIndex.end())
+    return itr->second;
+  if (hars.size() < 2) {
+    int leaf = PlanLeaf(poi, hars.at(0), pows.at(0), true);
+    fPlanNodeIndex[key] = leaf;
+    return leaf;
+  }
+  PlanNode node;
+  vector<pair<int, int>> subs;
+  if (hars.size() < 3) { // TwoRec
+    node.factor1 = PlanLeaf(poi, hars.at(0), pows.at(0), true);
+    node.factor2 = PlanLeaf(ref, hars.at(1), pows.at(1), true);
+    if (ovl > -1)
+      subs.push_back({PlanLeaf(ovl, hars.at(0) + hars.at(1), pows.at(0) + pows.at(1), true), 1});
+  } else {
+    int harlast = hars.at(hars.size() - 1);
+    int powlast = pows.at(pows.size() - 1);
+    hars.erase(hars.end() - 1);
+    pows.erase(pows.end() - 1);
+    node.factor1 = CompileCorr(poi, ref, ovl, hars, pows);
+    node.factor2 = PlanLeaf(ref, harlast, powlast, false);
+    int lDegeneracy = 1;
+    int harSize = static_cast<int>(hars.size());
+    for (int i = harSize - 1; i >= 0; i--) {
+      if (i > 2) {
+        if (hars.at(i) == hars.at(i - 1) && pows.at(i) == pows.at(i - 1)) {
+          lDegeneracy++;
+          continue;
+        }
+      }
+      hars.at(i) += harlast;
+      pows.at(i) += powlast;
+      subs.push_back({CompileCorr(poi, ref, ovl, hars, pows), lDegeneracy});
+      lDegeneracy = 1;
+      hars.at(i) -= harlast;
+      pows.at(i) -= powlast;
+    }
+    hars.push_back(harlast);
+    pows.push_back(powlast);
+  }
+  node.ptDif = fPlanNodes.at(node.factor1).ptDif || fPlanNodes.at(node.factor2).ptDif;
+  node.firstSub = static_cast<int>(fPlanSubs.size());
+  node.nSubs = static_cast<int>(subs.size());
+  for (auto& sub : subs) {
+    node.ptDif = node.ptDif || fPlanNodes.at(sub.first).ptDif;
+    fPlanSubs.push_back(sub);
+  }
+  fPlanNodes.push_back(node);
+  fPlanNodeIndex[key] = static_cast<int>(fPlanNodes.size()) - 1;
+  return static_cast<int>(fPlanNodes.size()) - 1;
+};
+int GFW::CompilePlan(int poi, int ref, int ovl, vector<int> hars)
+{
+  vector<int> pows(hars.size(), 1);
+  int root = CompileCorr(poi, ref, ovl, hars, pows);
+  // Evaluation order: depth-first post-order of the nodes needed by the root
+  vector<int> order;
+  vector<bool> visited(fPlanNodes.size(), false);
+  vector<pair<int, bool>> stack = {{root, false}};
+  while (!stack.empty()) {
+    auto [index, expanded] = stack.back();
+    stack.pop_back();
+    if (expanded) {
+      order.push_back(index);
+      continue;
+    }
+    if (visited[index])
+      continue;
+    visited[index] = true;
+    stack.push_back({index, true});
+    const PlanNode& node = fPlanNodes.at(index);
+    if (node.cumulant > -1)
+      continue;
+    stack.push_back({node.factor1, false});
+    stack.push_back({node.factor2, false});
+    for (int j = 0; j < node.nSubs; j++)
+      stack.push_back({fPlanSubs.at(node.firstSub + j).first, false});
+  }
+  fPlans.push_back(order);
+  fPlanValues.resize(fPlanNodes.size());
+  fPlanStamps.resize(fPlanNodes.size(), 0);
+  fPlanPtBins.resize(fPlanNodes.size(), -1);
+  return static_cast<int>(fPlans.size()) - 1;
+};
+void GFW::CompilePlans(CorrConfig& corconf)
+{
+  corconf.Plans.clear();
+  for (int i = 0; i < static_cast<int>(corconf.Regs.size()); i++) {
+    if (corconf.Regs.at(i).size() == 0 || corconf.Hars.at(i).size() == 0) {
+      corconf.Plans.clear();
+      return; // not evaluated anyway, keep the recursive path
+    }
+    // same choice of regions as in Calculate
+    int poi = corconf.Regs.at(i).at(0);
+    int ref = (corconf.Regs.at(i).size() > 1) ? corconf.Regs.at(i).at(1) : corconf.Regs.at(i).at(0);
+    int ovl = corconf.Overlap.at(i);
+    if (ovl < 0 && ref == poi)
+      ovl = ref;
+    corconf.Plans.push_back(CompilePlan(poi, ref, ovl, corconf.Hars.at(i)));
+    corconf.Plans.push_back(CompilePlan(poi, ref, ovl, vector<int>(corconf.Hars.at(i).size(), 0)));
+  }
+};
+complex<double> GFW::EvaluatePlan(int plan, int ptbin)
+{
+  const vector<int>& order = fPlans.at(plan);
+  for (int index : order) {
+    const PlanNode& node = fPlanNodes[index];
+    if (fPlanStamps[index] == fGeneration && (!node.ptDif || fPlanPtBins[index] == ptbin))
+      continue;
+    complex<double> value;
+    if (node.cumulant > -1) {
+      value = fCumulants[node.cumulant].Vec(node.har, node.pow, node.ptDif ? ptbin : 0);
+    } else {
+      value = fPlanValues[node.factor1] * fPlanValues[node.factor2];
+      for (int j = 0; j < node.nSubs; j++) {
+        const pair<int, int>& sub = fPlanSubs[node.firstSub + j];
+        if (sub.second > 1)
+          value -= fPlanValues[sub.first] * static_cast<double>(sub.second);
+        else
+          value -= fPlanValues[sub.first];
+      }
+    }
+    fPlanValues[index] = value;
+    fPlanStamps[index] = fGeneration;
+    fPlanPtBins[index] = ptbin;
+  }
+  return fPlanValues[order.back()];
+};
 vector<pair<int, vector<int>>> GFW::GetHarmonicsSingleConfig(const CorrConfig& incfg)
 {
   vector<pair<int, vector<int>>> retPair;
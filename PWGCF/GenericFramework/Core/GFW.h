@@ -26,6 +26,8 @@ If used, modified, or distributed, please aknowledge the author of this code.
 #include <utility>
 #include <algorithm>
 #include <complex>
+#include <map>
+#include <cstdint>
 
 class GFW
 {
@@ -51,6 +53,7 @@ class GFW
     std::vector<int> ptInd;
     bool pTDif = false;
     std::string Head = "";
+    std::vector<int> Plans; // Compiled evaluation plans of the subevents, [2 * subevent + SetHarmsToZero]. Empty: recursive evaluation
   };
   GFW();
   ~GFW();
@@ -62,14 +65,53 @@ class GFW
   void AddRegion(std::string refName, int lNhar, int* lNparVec, double lEtaMin, double lEtaMax, int lNpT, int BitMask);  // Legacy support, array instead of a vector
   int CreateRegions();
   void Fill(double eta, int ptin, double phi, double weight, int mask, double secondWeight = -1);
+  void SetBatchFill(bool flag = true) { fBatchFill = flag; } // Fill only stores the particles; the Q-vectors are filled at once before the first Calculate
+  void FlushBatches();
   void Clear();
-  GFWCumulant GetCumulant(int index) { return fCumulants.at(index); }
+  GFWCumulant GetCumulant(int index)
+  {
+    FlushBatches();
+    return fCumulants.at(index);
+  }
   CorrConfig GetCorrelatorConfig(std::string config, std::string head = "", bool ptdif = false);
-  std::complex<double> Calculate(CorrConfig corconf, int ptbin, bool SetHarmsToZero);
+  std::complex<double> Calculate(const CorrConfig& corconf, int ptbin, bool SetHarmsToZero);
   void InitializePowerArrays();
 
  protected:
   bool fInitialized;
+  struct FillBatch {
+    std::vector<int> ptin;
+    std::vector<double> phi;
+    std::vector<double> weight;
+    std::vector<double> secondWeight;
+  };
+  bool fBatchFill = false;
+  std::vector<FillBatch> fBatches; //! Particles stored per region in the batch fill mode
+  // Evaluation plans: the recursion of RecursiveCorr unrolled once into a graph of products of Q-vectors,
+  // with the sub-terms shared between all the correlators and cached per event and pT bin
+  struct PlanNode {
+    int cumulant = -1;  // leaf: Vec(har, pow) of this cumulant, at the pT bin if ptDif and at bin 0 otherwise
+    int har = 0;
+    int pow = 0;
+    bool ptDif = false; // the value depends on the pT bin
+    int factor1 = -1;   // otherwise: factor1 * factor2 - sum of coefficient * node over the subtractions
+    int factor2 = -1;
+    int firstSub = 0;
+    int nSubs = 0;
+  };
+  std::vector<PlanNode> fPlanNodes;                //!
+  std::vector<std::pair<int, int>> fPlanSubs;      //! Subtractions of the nodes: (node, coefficient)
+  std::vector<std::vector<int>> fPlans;            //! Nodes of each plan in evaluation order, the last one is the result
+  std::map<std::vector<int>, int> fPlanNodeIndex;  //! Memoisation of the nodes
+  std::vector<std::complex<double>> fPlanValues;   //!
+  std::vector<uint64_t> fPlanStamps;               //! Generation at which the node value was computed
+  std::vector<int> fPlanPtBins;                    //! pT bin at which the node value was computed
+  uint64_t fGeneration = 1;                        //! Incremented whenever the Q-vectors change
+  int PlanLeaf(int cumulant, int har, int pow, bool ptDif);
+  int CompileCorr(int poi, int ref, int ovl, std::vector<int>& hars, std::vector<int>& pows);
+  int CompilePlan(int poi, int ref, int ovl, std::vector<int> hars);
+  void CompilePlans(CorrConfig& corconf);
+  std::complex<double> EvaluatePlan(int plan, int ptbin);
   std::vector<CorrConfig> fListOfCFGs;
   std::complex<double> TwoRec(int n1, int n2, int p1, int p2, int ptbin, GFWCumulant*, GFWCumulant*, GFWCumulant*);
   std::complex<double> RecursiveCorr(GFWCumulant* qpoi, GFWCumulant* qref, GFWCumulant* qol, int ptbin, std::vector<int>& hars, std::vector<int>& pows); // POI, Ref. flow, overlapping region
@@ -18,6 +18,7 @@ If used, modified, or distributed, please aknowledge the author of this code.
 */
 
 #include "GFWCumulant.h"
+#include <algorithm>
 
 using std::complex;
 using std::vector;
@@ -41,25 +42,102 @@ void GFWCumulant::FillArray(int ptin, double phi, double weight, double SecondWe
   else if (ptin < 0 || ptin >= fPt)
     return;
   fFilledPts[ptin] = true;
+  // Weight powers are computed once, and cos/sin(n*phi) by Chebyshev recursion from cos/sin(phi)
+  ComputePrefactors(weight, SecondWeight, fPrefactors.data());
+  double lCos1 = cos(phi);
+  double lCosPrev = lCos1, lSinPrev = -sin(phi); // n = -1
+  double lCos = 1, lSin = 0;                     // n = 0
   for (int lN = 0; lN < fN; lN++) {
-    double lSin = sin(lN * phi); // No need to recalculate for each power
-    double lCos = cos(lN * phi); // No need to recalculate for each power
     for (int lPow = 0; lPow < PW(lN); lPow++) {
-      double lPrefactor = 0;
-      // Dont calculate it twice; multiplication is cheaper that power
-      // Also, if second weight is specified, then keep the first weight with power no more than 1, and us the other weight otherwise
-      // this is important when POIs are a subset of REFs and have different weights than REFs
-      if (SecondWeight > 0 && lPow > 1)
-        lPrefactor = pow(SecondWeight, lPow - 1) * weight;
-      else
-        lPrefactor = pow(weight, lPow);
-      double qsin = lPrefactor * lSin;
-      double qcos = lPrefactor * lCos;
-      fQvector[ptin][lN][lPow] += complex<double>(qcos, qsin);
+      fQvector[ptin][lN][lPow] += complex<double>(fPrefactors[lPow] * lCos, fPrefactors[lPow] * lSin);
     }
+    double lCosNext = 2 * lCos1 * lCos - lCosPrev;
+    double lSinNext = 2 * lCos1 * lSin - lSinPrev;
+    lCosPrev = lCos;
+    lSinPrev = lSin;
+    lCos = lCosNext;
+    lSin = lSinNext;
   }
   Inc();
 };
+void GFWCumulant::ComputePrefactors(double weight, double SecondWeight, double* prefactors, int stride)
+{
+  // If second weight is specified, then keep the first weight with power no more than 1, and us the other weight otherwise
+  // this is important when POIs are a subset of REFs and have different weights than REFs
+  double lPrefactor = 1;
+  for (int lPow = 0; lPow < fMaxPow; lPow++) {
+    prefactors[lPow * stride] = lPrefactor;
+    lPrefactor *= (SecondWeight > 0 && lPow > 0) ? SecondWeight : weight;
+  }
+};
+void GFWCumulant::FillArrays(int nParticles, const int* ptin, const double* phi, const double* weight, const double* SecondWeight)
+{
+  if (!fInitialized)
+    CreateComplexVectorArray(1, 1, 1);
+  // Order the particles by pT bin, such that each bin is accumulated over contiguous arrays
+  fBatchOffsets.assign(fPt + 1, 0);
+  for (int i = 0; i < nParticles; i++) {
+    int lPt = (fPt == 1) ? 0 : ptin[i];
+    if (lPt >= 0 && lPt < fPt)
+      fBatchOffsets[lPt + 1]++;
+  }
+  for (int i = 0; i < fPt; i++)
+    fBatchOffsets[i + 1] += fBatchOffsets[i];
+  fBatchIndex.resize(fBatchOffsets[fPt]);
+  vector<int> lFill(fBatchOffsets.begin(), fBatchOffsets.end() - 1);
+  for (int i = 0; i < nParticles; i++) {
+    int lPt = (fPt == 1) ? 0 : ptin[i];
+    if (lPt >= 0 && lPt < fPt)
+      fBatchIndex[lFill[lPt]++] = i;
+  }
+  for (int lPt = 0; lPt < fPt; lPt++) {
+    const int lN1 = fBatchOffsets[lPt + 1] - fBatchOffsets[lPt];
+    if (lN1 == 0)
+      continue;
+    fFilledPts[lPt] = true;
+    const int* lIndex = &fBatchIndex[fBatchOffsets[lPt]];
+    fBatchCos1.resize(lN1);
+    fBatchPrefactors.resize(lN1 * fMaxPow);
+    for (int j = 0; j < 2; j++) {
+      fBatchCos[j].resize(lN1);
+      fBatchSin[j].resize(lN1);
+    }
+    double* lCos1 = fBatchCos1.data();
+    double* lCos = fBatchCos[0].data();
+    double* lSin = fBatchSin[0].data();
+    double* lCosPrev = fBatchCos[1].data();
+    double* lSinPrev = fBatchSin[1].data();
+    double* lPrefactors = fBatchPrefactors.data();
+    for (int j = 0; j < lN1; j++) {
+      const int i = lIndex[j];
+      lCos1[j] = cos(phi[i]);
+      lCosPrev[j] = lCos1[j]; // n = -1
+      lSinPrev[j] = -sin(phi[i]);
+      lCos[j] = 1; // n = 0
+      lSin[j] = 0;
+      ComputePrefactors(weight[i], SecondWeight ? SecondWeight[i] : -1, lPrefactors + j, lN1);
+    }
+    for (int lN = 0; lN < fN; lN++) {
+      for (int lPow = 0; lPow < PW(lN); lPow++) {
+        const double* lPref = lPrefactors + lPow * lN1;
+        double lSumCos = 0, lSumSin = 0;
+        for (int j = 0; j < lN1; j++) {
+          lSumCos += lPref[j] * lCos[j];
+          lSumSin += lPref[j] * lSin[j];
+        }
+        fQvector[lPt][lN][lPow] += complex<double>(lSumCos, lSumSin);
+      }
+      // Chebyshev recursion to the next harmonic, the (n-1) arrays receive the (n+1) values
+      for (int j = 0; j < lN1; j++) {
+        lCosPrev[j] = 2 * lCos1[j] * lCos[j] - lCosPrev[j];
+        lSinPrev[j] = 2 * lCos1[j] * lSin[j] - lSinPrev[j];
+      }
+      std::swap(lCos, lCosPrev);
+      std::swap(lSin, lSinPrev);
+    }
+  }
+  fNEntries += fBatchOffsets[fPt];
+};
 void GFWCumulant::ResetQs()
 {
   if (!fNEntries)
@@ -108,6 +186,10 @@ void GFWCumulant::CreateComplexVectorArrayVarPower(int N, vector<int> PowVec, in
   fPt = Pt;
   fFilledPts = new bool[Pt];
   fPowVec = PowVec;
+  fMaxPow = 1;
+  for (int l_n = 0; l_n < fN; l_n++)
+    fMaxPow = std::max(fMaxPow, PW(l_n));
+  fPrefactors.resize(fMaxPow);
   fQvector = new complex<double>**[fPt];
   for (int i = 0; i < fPt; i++) {
     fQvector[i] = new complex<double>*[fN];
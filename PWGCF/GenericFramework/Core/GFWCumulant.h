@@ -30,6 +30,7 @@ class GFWCumulant
   ~GFWCumulant();
   void ResetQs();
   void FillArray(int ptin, double phi, double weight = 1, double SecondWeight = -1);
+  void FillArrays(int nParticles, const int* ptin, const double* phi, const double* weight, const double* SecondWeight = nullptr); // Batch fill from SoA arrays, SecondWeight can be null
   enum UsedFlags_t { kBlank = 0,
                      kFull = 1,
                      kPt = 2 };
@@ -58,6 +59,15 @@ class GFWCumulant
   bool* fFilledPts;
   bool fInitialized; // Arrays are initialized
   std::complex<double> fNullQ = 0;
+  int fMaxPow = 1;                      //! Highest power over the harmonics
+  std::vector<double> fPrefactors;      //! Weight powers of one particle
+  std::vector<int> fBatchOffsets;       //! Batch fill: first particle of each pT bin
+  std::vector<int> fBatchIndex;         //! Batch fill: particles ordered by pT bin
+  std::vector<double> fBatchCos1;       //! Batch fill: cos(phi) of the particles of one pT bin
+  std::vector<double> fBatchCos[2];     //! Batch fill: cos(n*phi) and cos((n-1)*phi)
+  std::vector<double> fBatchSin[2];     //! Batch fill: sin(n*phi) and sin((n-1)*phi)
+  std::vector<double> fBatchPrefactors; //! Batch fill: weight powers, [power][particle]
+  void ComputePrefactors(double weight, double SecondWeight, double* prefactors, int stride = 1);
 };
 
 #endif // PWGCF_GENERICFRAMEWORK_CORE_GFWCUMULANT_H_
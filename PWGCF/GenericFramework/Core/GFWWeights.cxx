@@ -145,25 +145,39 @@ double GFWWeights::GetNUA(double phi, double eta, double vz)
 {
   if (!fAccInt)
     CreateNUA();
-  int xind = fAccInt->GetXaxis()->FindBin(phi);
-  int etaind = fAccInt->GetYaxis()->FindBin(eta);
-  int vzind = fAccInt->GetZaxis()->FindBin(vz);
-  double weight = fAccInt->GetBinContent(xind, etaind, vzind);
-  if (weight != 0)
-    return 1. / weight;
-  return 1;
+  if (!fAccGrid.IsBuilt())
+    return 1;
+  return fAccGrid.Get(phi, eta, vz);
 }
 double GFWWeights::GetNUE(double pt, double eta, double vz)
 {
   if (!fEffInt)
     CreateNUE();
-  int xind = fEffInt->GetXaxis()->FindBin(pt);
-  int etaind = fEffInt->GetYaxis()->FindBin(eta);
-  int vzind = fEffInt->GetZaxis()->FindBin(vz);
-  double weight = fEffInt->GetBinContent(xind, etaind, vzind);
-  if (weight != 0)
-    return 1. / weight;
-  return 1;
+  if (!fEffGrid.IsBuilt())
+    return 1;
+  return fEffGrid.Get(pt, eta, vz);
+}
+void GFWWeights::GetNUA(int n, const float* phi, const float* eta, float vz, float* weights)
+{
+  if (!fAccInt)
+    CreateNUA();
+  if (!fAccGrid.IsBuilt()) {
+    std::fill(weights, weights + n, 1.f);
+    return;
+  }
+  for (int i = 0; i < n; ++i)
+    weights[i] = fAccGrid.Get(phi[i], eta[i], vz);
+}
+void GFWWeights::GetNUE(int n, const float* pt, const float* eta, float vz, float* weights)
+{
+  if (!fEffInt)
+    CreateNUE();
+  if (!fEffGrid.IsBuilt()) {
+    std::fill(weights, weights + n, 1.f);
+    return;
+  }
+  for (int i = 0; i < n; ++i)
+    weights[i] = fEffGrid.Get(pt[i], eta[i], vz);
 }
 double GFWWeights::FindMax(TH3D* inh, int& ix, int& iy, int& iz)
 {
@@ -237,6 +251,7 @@ void GFWWeights::CreateNUA(bool IntegrateOverCentAndPt)
       fAccInt->GetZaxis()->SetRange(1, fAccInt->GetNbinsZ());
     }
     fAccInt->GetYaxis()->SetRange(1, fAccInt->GetNbinsY());
+    fAccGrid.Build(fAccInt, kTRUE);
     return;
   }
 };
@@ -278,6 +293,7 @@ void GFWWeights::CreateNUE(bool IntegrateOverCentrality)
     den->RebinZ(5);
     fEffInt = reinterpret_cast<TH3D*>(num->Clone("Efficiency_Integrated"));
     fEffInt->Divide(den);
+    fEffGrid.Build(fEffInt, kTRUE);
     return;
   }
 };
@@ -362,6 +378,32 @@ void GFWWeights::OverwriteNUA()
   delete trash;
   fW_data->Add(reinterpret_cast<TH3D*>(fAccInt->Clone(ts.Data())));
   delete fAccInt;
+  fAccInt = 0;
+  fAccGrid.Clear();
+}
+void GFWWeights::WeightGrid::Axis::Set(const TAxis* axis)
+{
+  fNbins = axis->GetNbins();
+  fNcells = fNbins + 2;
+  fMin = axis->GetXmin();
+  fMax = axis->GetXmax();
+  fEdges.clear();
+  if (axis->GetXbins()->GetSize() > 0)
+    fEdges.assign(axis->GetXbins()->GetArray(), axis->GetXbins()->GetArray() + axis->GetXbins()->GetSize());
+}
+void GFWWeights::WeightGrid::Build(const TH1* h, bool invert)
+{
+  fDim = h->GetDimension();
+  fAxes[0].Set(h->GetXaxis());
+  fAxes[1].Set(h->GetYaxis());
+  fAxes[2].Set(h->GetZaxis());
+  fValues.resize(h->GetNcells());
+  for (int bin = 0; bin < h->GetNcells(); ++bin) {
+    double value = h->GetBinContent(bin);
+    if (invert)
+      value = (value != 0) ? 1. / value : 1.;
+    fValues[bin] = value;
+  }
 }
 Long64_t GFWWeights::Merge(TCollection* collist)
 {
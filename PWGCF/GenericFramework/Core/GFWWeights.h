@@ -19,10 +19,55 @@
 #include "TFile.h"
 #include "TCollection.h"
 #include "TString.h"
+#include <algorithm>
+#include <vector>
 
 class GFWWeights : public TNamed
 {
  public:
+  // Bin contents of a TH1/TH2/TH3 copied to a flat array, under- and overflow included, with the bin of uniform axes
+  // computed arithmetically instead of with TAxis::FindBin. Get returns the same value as
+  // h->GetBinContent(h->FindBin(x, y, z)), or its inverse (1 for empty bins) if built with invert
+  class WeightGrid
+  {
+   public:
+    void Build(const TH1* h, bool invert);
+    void Clear() { fValues.clear(); }
+    bool IsBuilt() const { return !fValues.empty(); }
+    double Get(double x, double y = 0., double z = 0.) const
+    {
+      int bin = fAxes[0].FindBin(x);
+      if (fDim > 1)
+        bin += fAxes[0].fNcells * fAxes[1].FindBin(y);
+      if (fDim > 2)
+        bin += fAxes[0].fNcells * fAxes[1].fNcells * fAxes[2].FindBin(z);
+      return fValues[bin];
+    }
+
+   private:
+    struct Axis {
+      int fNbins = 1;
+      int fNcells = 3; // fNbins + under- and overflow
+      double fMin = 0.;
+      double fMax = 1.;
+      std::vector<double> fEdges; // empty for uniform bins
+      void Set(const TAxis* axis);
+      int FindBin(double x) const // same as TAxis::FindBin for a non-extendable axis
+      {
+        if (x < fMin)
+          return 0;
+        if (!(x < fMax))
+          return fNbins + 1;
+        if (fEdges.empty())
+          return 1 + static_cast<int>(fNbins * (x - fMin) / (fMax - fMin));
+        return std::upper_bound(fEdges.begin(), fEdges.end(), x) - fEdges.begin();
+      }
+    };
+    int fDim = 0;
+    Axis fAxes[3];
+    std::vector<double> fValues;
+  };
+
   GFWWeights();
   explicit GFWWeights(const char* name);
   ~GFWWeights();
@@ -31,6 +76,8 @@ class GFWWeights : public TNamed
   double GetWeight(double phi, double eta, double vz, double pt, double cent, int htype);             // htype: 0 for data, 1 for mc rec, 2 for mc gen
   double GetNUA(double phi, double eta, double vz);                                                   // This just fetches correction from integrated NUA, should speed up
   double GetNUE(double pt, double eta, double vz);                                                    // fetches weight from fEffInt
+  void GetNUA(int n, const float* phi, const float* eta, float vz, float* weights); // NUA weights of n tracks of an event
+  void GetNUE(int n, const float* pt, const float* eta, float vz, float* weights);  // NUE weights of n tracks of an event
   bool IsDataFilled() { return fDataFilled; }
   bool IsMCFilled() { return fMCFilled; }
   double FindMax(TH3D* inh, int& ix, int& iy, int& iz);
@@ -64,6 +111,8 @@ class GFWWeights : public TNamed
   TH3D* fAccInt;   //!
   int fNbinsPt;    //! do not store
   double* fbinsPt; //! do not store
+  WeightGrid fAccGrid; //! inverse of fAccInt, built with it
+  WeightGrid fEffGrid; //! inverse of fEffInt, built with it
   void AddArray(TObjArray* targ, TObjArray* sour);
   const char* GetBinName(double /*ptv*/, double /*v0mv*/, const char* pf = "")
   {
@@ -0,0 +1,58 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file  GFWQvectors.h
+/// \brief Barrel Q-vectors Q(n,p) = sum_tracks w^p exp(i n phi) of each collision, per eta subevent and pT bin,
+///        produced by gfw-qvector-producer such that the flow tasks of a train share the loop over the tracks.
+///        The harmonics run from 0 to nHarmonics-1 and the powers from 0 to nPowers-1, such that Q(0,p) are the
+///        sums of the weights to the power p (Q(0,0) the number of tracks). Integrated Q-vectors are the sums over
+///        the pT bins. The table has one row per collision and is joinable with aod::Collisions.
+///
+
+#ifndef PWGCF_GENERICFRAMEWORK_DATAMODEL_GFWQVECTORS_H_
+#define PWGCF_GENERICFRAMEWORK_DATAMODEL_GFWQVECTORS_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "Framework/AnalysisDataModel.h"
+
+namespace o2::aod
+{
+namespace gfwqvec
+{
+/// Layout of the flattened Q-vectors, packed in one column with 8 bits per dimension
+struct Layout {
+  int nSubevents = 0;
+  int nPtBins = 0;
+  int nHarmonics = 0;
+  int nPowers = 0;
+
+  uint32_t pack() const { return nSubevents | (nPtBins << 8) | (nHarmonics << 16) | (static_cast<uint32_t>(nPowers) << 24); }
+  static Layout unpack(uint32_t packed) { return {static_cast<int>(packed & 0xff), static_cast<int>((packed >> 8) & 0xff), static_cast<int>((packed >> 16) & 0xff), static_cast<int>(packed >> 24)}; }
+  int size() const { return nSubevents * nPtBins * nHarmonics * nPowers; }
+  int index(int subevent, int ptBin, int harmonic, int power) const { return ((subevent * nPtBins + ptBin) * nHarmonics + harmonic) * nPowers + power; }
+};
+
+DECLARE_SOA_COLUMN(PackedLayout, packedLayout, uint32_t); //! Layout::pack() of the Q-vectors
+DECLARE_SOA_COLUMN(QvecRe, qvecRe, std::vector<float>);   //! Real parts of the Q-vectors, at Layout::index
+DECLARE_SOA_COLUMN(QvecIm, qvecIm, std::vector<float>);   //! Imaginary parts of the Q-vectors, at Layout::index
+} // namespace gfwqvec
+
+DECLARE_SOA_TABLE(GFWQvectors, "AOD", "GFWQVECTOR", //! Barrel Q-vectors per subevent and pT bin, joinable with Collisions
+                  gfwqvec::PackedLayout,
+                  gfwqvec::QvecRe,
+                  gfwqvec::QvecIm);
+using GFWQvector = GFWQvectors::iterator;
+} // namespace o2::aod
+
+#endif // PWGCF_GENERICFRAMEWORK_DATAMODEL_GFWQVECTORS_H_
@@ -0,0 +1,174 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file  gfwQvectorProducer.cxx
+/// \brief Producer of the barrel Q-vectors Q(n,p) of each collision in eta subevents and pT bins, with the NUA and
+///        NUE weights applied, for the flow tasks of a train (see GFWQvectors.h). The track selection is the one of
+///        flow-generic-framework; no event selection is applied, the consumers apply their own.
+///
+
+#include <CCDB/BasicCCDBManager.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <string>
+#include <vector>
+
+#include "Framework/runDataProcessing.h"
+#include "Framework/AnalysisTask.h"
+
+#include "Common/DataModel/TrackSelectionTables.h"
+
+#include "GFWWeights.h"
+#include "PWGCF/GenericFramework/DataModel/GFWQvectors.h"
+
+using namespace o2;
+using namespace o2::framework;
+using namespace o2::framework::expressions;
+
+#define O2_DEFINE_CONFIGURABLE(NAME, TYPE, DEFAULT, HELP) Configurable<TYPE> NAME{#NAME, DEFAULT, HELP};
+
+struct GFWQvectorProducer {
+  O2_DEFINE_CONFIGURABLE(cfgEfficiency, std::string, "", "CCDB path to efficiency object")
+  O2_DEFINE_CONFIGURABLE(cfgAcceptance, std::string, "", "CCDB path to acceptance object")
+  O2_DEFINE_CONFIGURABLE(cfgDCAxy, float, 0.2, "Cut on DCA in the transverse direction (cm)");
+  O2_DEFINE_CONFIGURABLE(cfgDCAz, float, 2, "Cut on DCA in the longitudinal direction (cm)");
+  O2_DEFINE_CONFIGURABLE(cfgNcls, float, 70, "Cut on number of TPC clusters found");
+  O2_DEFINE_CONFIGURABLE(cfgPtmin, float, 0.2, "minimum pt (GeV/c)");
+  O2_DEFINE_CONFIGURABLE(cfgPtmax, float, 10, "maximum pt (GeV/c)");
+  O2_DEFINE_CONFIGURABLE(cfgEta, float, 0.8, "eta cut");
+  O2_DEFINE_CONFIGURABLE(cfgSubeventEtaMin, std::vector<float>, (std::vector<float>{-0.8, 0.4, -0.8}), "Lower eta limits of the subevents");
+  O2_DEFINE_CONFIGURABLE(cfgSubeventEtaMax, std::vector<float>, (std::vector<float>{-0.4, 0.8, 0.8}), "Upper eta limits of the subevents");
+  O2_DEFINE_CONFIGURABLE(cfgPtBins, std::vector<double>, (std::vector<double>{0.2, 10.}), "pT bin edges of the Q-vectors");
+  O2_DEFINE_CONFIGURABLE(cfgNHarmonics, int, 7, "Number of harmonics, n = 0 ... cfgNHarmonics-1");
+  O2_DEFINE_CONFIGURABLE(cfgNPowers, int, 5, "Number of powers of the weights, p = 0 ... cfgNPowers-1");
+
+  Service<ccdb::BasicCCDBManager> ccdb;
+  Produces<aod::GFWQvectors> qvectors;
+
+  struct Config {
+    GFWWeights::WeightGrid mEfficiencyGrid; // bin contents of the efficiency histogram
+    GFWWeights* mAcceptance = nullptr;
+    bool correctionsLoaded = false;
+  } cfg;
+
+  aod::gfwqvec::Layout layout;
+  uint32_t packedLayout = 0;
+  std::vector<std::complex<double>> qvec; // Q-vectors of the current collision, at layout.index
+  std::vector<float> qvecRe;
+  std::vector<float> qvecIm;
+  std::vector<std::complex<double>> harmonics; // exp(i n phi) of the current track
+  std::vector<double> weightPowers;            // w^p of the current track
+
+  void init(InitContext const&)
+  {
+    if (cfgSubeventEtaMin->size() != cfgSubeventEtaMax->size() || cfgSubeventEtaMin->empty())
+      LOGF(fatal, "cfgSubeventEtaMin and cfgSubeventEtaMax have %d and %d values, please configure properly!!", static_cast<int>(cfgSubeventEtaMin->size()), static_cast<int>(cfgSubeventEtaMax->size()));
+    if (cfgPtBins->size() < 2)
+      LOGF(fatal, "cfgPtBins needs at least 2 edges, please configure properly!!");
+    layout = {static_cast<int>(cfgSubeventEtaMin->size()), static_cast<int>(cfgPtBins->size()) - 1, cfgNHarmonics, cfgNPowers};
+    if (layout.nSubevents > 255 || layout.nPtBins > 255 || layout.nHarmonics < 1 || layout.nHarmonics > 255 || layout.nPowers < 1 || layout.nPowers > 255)
+      LOGF(fatal, "Q-vector layout %d subevents x %d pT bins x %d harmonics x %d powers out of range, please configure properly!!", layout.nSubevents, layout.nPtBins, layout.nHarmonics, layout.nPowers);
+    packedLayout = layout.pack();
+    qvec.resize(layout.size());
+    qvecRe.resize(layout.size());
+    qvecIm.resize(layout.size());
+    harmonics.resize(layout.nHarmonics);
+    weightPowers.resize(layout.nPowers);
+    LOGF(info, "Q-vectors: %d subevents x %d pT bins x %d harmonics x %d powers = %d values per collision", layout.nSubevents, layout.nPtBins, layout.nHarmonics, layout.nPowers, layout.size());
+
+    ccdb->setURL("http://alice-ccdb.cern.ch");
+    ccdb->setCaching(true);
+    ccdb->setLocalObjectValidityChecking();
+    int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    ccdb->setCreatedNotAfter(now);
+  }
+
+  void loadCorrections(uint64_t timestamp)
+  {
+    if (cfg.correctionsLoaded)
+      return;
+    if (cfgAcceptance.value.empty() == false) {
+      cfg.mAcceptance = ccdb->getForTimeStamp<GFWWeights>(cfgAcceptance, timestamp);
+      if (cfg.mAcceptance)
+        LOGF(info, "Loaded acceptance weights from %s (%p)", cfgAcceptance.value.c_str(), (void*)cfg.mAcceptance);
+      else
+        LOGF(warning, "Could not load acceptance weights from %s (%p)", cfgAcceptance.value.c_str(), (void*)cfg.mAcceptance);
+    }
+    if (cfgEfficiency.value.empty() == false) {
+      auto efficiency = ccdb->getForTimeStamp<TH1D>(cfgEfficiency, timestamp);
+      if (efficiency == nullptr) {
+        LOGF(fatal, "Could not load efficiency histogram from %s", cfgEfficiency.value.c_str());
+      }
+      LOGF(info, "Loaded efficiency histogram from %s (%p)", cfgEfficiency.value.c_str(), (void*)efficiency);
+      cfg.mEfficiencyGrid.Build(efficiency, false);
+    }
+    cfg.correctionsLoaded = true;
+  }
+
+  Filter trackFilter = nabs(aod::track::eta) < cfgEta && aod::track::pt > cfgPtmin&& aod::track::pt < cfgPtmax && ((requireGlobalTrackInFilter()) || (aod::track::isGlobalTrackSDD == (uint8_t) true)) && nabs(aod::track::dcaXY) < cfgDCAxy&& nabs(aod::track::dcaZ) < cfgDCAz;
+  using myTracks = soa::Filtered<soa::Join<aod::Tracks, aod::TracksExtra, aod::TrackSelection, aod::TracksDCA>>;
+
+  void process(aod::Collision const& collision, aod::BCsWithTimestamps const&, myTracks const& tracks)
+  {
+    loadCorrections(collision.bc_as<aod::BCsWithTimestamps>().timestamp());
+    std::fill(qvec.begin(), qvec.end(), std::complex<double>(0., 0.));
+    const float vtxz = collision.posZ();
+    const auto& etaMin = cfgSubeventEtaMin.value;
+    const auto& etaMax = cfgSubeventEtaMax.value;
+    const auto& ptBins = cfgPtBins.value;
+    for (const auto& track : tracks) {
+      if (track.tpcNClsFound() < cfgNcls)
+        continue;
+      if (track.pt() < ptBins.front() || track.pt() >= ptBins.back())
+        continue;
+      const int ptBin = std::upper_bound(ptBins.begin(), ptBins.end(), track.pt()) - ptBins.begin() - 1;
+      double weight = 1.;
+      if (cfg.mEfficiencyGrid.IsBuilt()) {
+        const double eff = cfg.mEfficiencyGrid.Get(track.pt());
+        if (eff == 0)
+          continue;
+        weight /= eff;
+      }
+      if (cfg.mAcceptance)
+        weight *= cfg.mAcceptance->GetNUA(track.phi(), track.eta(), vtxz);
+
+      // exp(i n phi) by recurrence and w^p by products, computed once for all the subevents of the track
+      const std::complex<double> unit(std::cos(track.phi()), std::sin(track.phi()));
+      harmonics[0] = 1.;
+      for (int n = 1; n < layout.nHarmonics; ++n)
+        harmonics[n] = harmonics[n - 1] * unit;
+      weightPowers[0] = 1.;
+      for (int p = 1; p < layout.nPowers; ++p)
+        weightPowers[p] = weightPowers[p - 1] * weight;
+      for (int sub = 0; sub < layout.nSubevents; ++sub) {
+        if (track.eta() <= etaMin[sub] || track.eta() >= etaMax[sub])
+          continue;
+        std::complex<double>* q = &qvec[layout.index(sub, ptBin, 0, 0)];
+        for (int n = 0; n < layout.nHarmonics; ++n)
+          for (int p = 0; p < layout.nPowers; ++p)
+            *(q++) += weightPowers[p] * harmonics[n];
+      }
+    }
+    for (int i = 0; i < layout.size(); ++i) {
+      qvecRe[i] = qvec[i].real();
+      qvecIm[i] = qvec[i].imag();
+    }
+    qvectors(packedLayout, qvecRe, qvecIm);
+  }
+};
+
+WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
+{
+  return WorkflowSpec{adaptAnalysisTask<GFWQvectorProducer>(cfgc)};
+}
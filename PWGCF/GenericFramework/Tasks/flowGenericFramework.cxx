@@ -93,6 +93,8 @@ struct GenericFramework {
   O2_DEFINE_CONFIGURABLE(cfgEta, float, 0.8, "eta cut");
   O2_DEFINE_CONFIGURABLE(cfgVtxZ, float, 10, "vertex cut (cm)");
   O2_DEFINE_CONFIGURABLE(cfgMagField, float, 99999, "Configurable magnetic field; default CCDB will be queried");
+  O2_DEFINE_CONFIGURABLE(cfgGFWBatchFill, bool, false, "Fill the GFW Q-vectors once per event from the stored tracks instead of track by track");
+  O2_DEFINE_CONFIGURABLE(cfgFCSparseSubsamples, bool, false, "Store the FlowContainer and FlowPtContainer subsamples only for the filled bins, the subsample profiles are created when reading the output");
 
   Configurable<GFWBinningCuts> cfgGFWBinning{"cfgGFWBinning", {40, 16, 72, 300, 0, 3000, 0.2, 10.0, 0.2, 3.0, {0.2, 0.25, 0.3, 0.35, 0.4, 0.45, 0.5, 0.55, 0.6, 0.65, 0.7, 0.75, 0.8, 0.85, 0.9, 0.95, 1, 1.1, 1.2, 1.3, 1.4, 1.5, 1.6, 1.7, 1.8, 1.9, 2, 2.2, 2.4, 2.6, 2.8, 3, 3.5, 4, 5, 6, 8, 10}, {0, 5, 10, 20, 30, 40, 50, 60, 70, 80, 90}}, "Configuration for binning"};
   Configurable<GFWRegions> cfgRegions{"cfgRegions", {{"refN", "refP", "refFull"}, {-0.8, 0.4, -0.8}, {-0.4, 0.8, 0.8}, {0, 0, 0}, {1, 1, 1}}, "Configurations for GFW regions"};
@@ -105,6 +107,7 @@ struct GenericFramework {
 
   struct Config {
     TH1D* mEfficiency = nullptr;
+    GFWWeights::WeightGrid mEfficiencyGrid; // bin contents of mEfficiency
     GFWWeights* mAcceptance = nullptr;
     bool correctionsLoaded = false;
   } cfg;
@@ -226,19 +229,23 @@ struct GenericFramework {
     if (corrconfigs.empty())
       LOGF(error, "Configuration contains vectors of different size - check the GFWCorrConfig configurable");
     fGFW->CreateRegions();
+    fGFW->SetBatchFill(cfgGFWBatchFill);
     TObjArray* oba = new TObjArray();
     AddConfigObjectsToObjArray(oba, corrconfigs);
     if (doprocessData || doprocessRun2 || doprocessMCReco) {
       fFC->SetName("FlowContainer");
       fFC->SetXAxis(fPtAxis);
+      fFC->SetSparseSubsamples(cfgFCSparseSubsamples);
       fFC->Initialize(oba, multAxis, cfgNbootstrap);
     }
     if (doprocessMCGen) {
       fFC_gen->SetName("FlowContainer_gen");
       fFC_gen->SetXAxis(fPtAxis);
+      fFC_gen->SetSparseSubsamples(cfgFCSparseSubsamples);
       fFC_gen->Initialize(oba, multAxis, cfgNbootstrap);
     }
     delete oba;
+    fFCpt->SetSparseSubsamples(cfgFCSparseSubsamples);
     fFCpt->Initialise(multAxis, cfgMpar, configs, cfgNbootstrap);
     // Event selection - Alex
     if (cfgUseAdditionalEventCut) {
@@ -322,6 +329,7 @@ struct GenericFramework {
         LOGF(fatal, "Could not load efficiency histogram for trigger particles from %s", cfgEfficiency.value.c_str());
       }
       LOGF(info, "Loaded efficiency histogram from %s (%p)", cfgEfficiency.value.c_str(), (void*)cfg.mEfficiency);
+      cfg.mEfficiencyGrid.Build(cfg.mEfficiency, false);
     }
     cfg.correctionsLoaded = true;
   }
@@ -330,7 +338,7 @@ struct GenericFramework {
   {
     float eff = 1.;
     if (cfg.mEfficiency)
-      eff = cfg.mEfficiency->GetBinContent(cfg.mEfficiency->FindBin(pt));
+      eff = cfg.mEfficiencyGrid.Get(pt);
     else
       eff = 1.0;
     if (eff == 0)
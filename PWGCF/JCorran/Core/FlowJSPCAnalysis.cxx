@@ -10,6 +10,8 @@
 // or submit itself to any jurisdiction.
 
 // Header files.
+#include <algorithm>
+#include <complex>
 
 // O2 headers.
 
@@ -71,18 +73,108 @@ TComplex FlowJSPCAnalysis::Recursion(int n, int* harmonic, int mult = 1, int ski
   return c - Double_t(mult) * c2;
 } // End of recursion
 
+/// \brief Calculate multi-particle correlators iteratively from the Q-vectors of the event.
+/// \param n Number of particles in the correlator.
+/// \param harmonic Array of length n of harmonics.
+/// \return Complex value of the multiparticle correlator, identical to the one of Recursion.
+/// \note The correlator of each subset S of the particles is the sum over the subsets T of
+/// S without its last particle m of (-1)^|T| |T|! Q(h_m + h_T, |T| + 1) times the correlator
+/// of S without m and T. The subsets are evaluated in increasing order in preallocated buffers,
+/// and the Q-vectors are read from the table filled once per event by FillQTable.
+std::complex<double> FlowJSPCAnalysis::Correlator(const Int_t n, const Int_t* harmonic)
+{
+  static constexpr Double_t factorial[15] = {1., 1., 2., 6., 24., 120., 720., 5040., 40320., 362880., 3628800., 39916800., 479001600., 6227020800., 87178291200.};
+  const UInt_t nSubsets = 1u << n;
+  const Int_t nPowers = fMaxPower + 1;
+
+  fSubsetHarmo[0] = 0;
+  for (UInt_t s = 1; s < nSubsets; s++) {
+    fSubsetHarmo[s] = fSubsetHarmo[s & (s - 1)] + harmonic[__builtin_ctz(s)];
+  }
+  fSubsetCorrel[0] = 1.;
+  for (UInt_t s = 1; s < nSubsets; s++) {
+    const Int_t last = 31 - __builtin_clz(s);
+    const UInt_t rest = s & ~(1u << last);
+    std::complex<double> c = 0.;
+    for (UInt_t t = rest;; t = (t - 1) & rest) { // all the subsets of rest
+      const Int_t k = __builtin_popcount(t);
+      const std::complex<double> term = fQTable[(harmonic[last] + fSubsetHarmo[t] + fMaxHarmo) * nPowers + k + 1] * fSubsetCorrel[rest & ~t];
+      c += ((k & 1) ? -factorial[k] : factorial[k]) * term;
+      if (t == 0) {
+        break;
+      }
+    }
+    fSubsetCorrel[s] = c;
+  }
+  return fSubsetCorrel[nSubsets - 1];
+} // End of Correlator
+
+std::complex<double> FlowJSPCAnalysis::Evaluate(const Int_t n, const Int_t* harmonic)
+{
+  if (!fUseRecursion) {
+    return Correlator(n, harmonic);
+  }
+  Int_t harmonicCopy[14];
+  std::copy(harmonic, harmonic + n, harmonicCopy);
+  TComplex c = Recursion(n, harmonicCopy);
+  return {c.Re(), c.Im()};
+}
+
+void FlowJSPCAnalysis::UpdateQBounds()
+{
+  // Q(n,p) is needed up to the sum of the |harmonics| of a numerator and up to the number of
+  // particles of the denominator, which has twice as many particles as the numerator.
+  Int_t maxNPart = 0;
+  fMaxHarmo = 0;
+  for (Int_t j = 0; j < 12; j++) {
+    const Int_t nPart = fHarmosArray[j][0];
+    if (nPart <= 0 || nPart > 7) {
+      continue;
+    }
+    Int_t sumHarmo = 0;
+    for (Int_t iH = 0; iH < nPart; iH++) {
+      sumHarmo += std::abs(fHarmosArray[j][iH + 1]);
+    }
+    fMaxHarmo = std::max(fMaxHarmo, sumHarmo);
+    maxNPart = std::max(maxNPart, 2 * nPart);
+  }
+  if (fMaxHarmo >= mNqHarmos || maxNPart >= mNqPowers) {
+    LOGF(fatal, "Correlator set needs Q(n,p) up to n = %d and p = %d, beyond the Q-vectors of the analysis.", fMaxHarmo, maxNPart);
+  }
+  fMaxPower = maxNPart;
+  fQTable.assign((2 * fMaxHarmo + 1) * (fMaxPower + 1), 0.);
+  fSubsetCorrel.assign(1u << maxNPart, 0.);
+  fSubsetHarmo.assign(1u << maxNPart, 0);
+}
+
+void FlowJSPCAnalysis::FillQTable()
+{
+  const Int_t nPowers = fMaxPower + 1;
+  for (Int_t n = 0; n <= fMaxHarmo; n++) {
+    for (Int_t p = 0; p < nPowers; p++) {
+      const TComplex& q = qvecs->QvectorQC[n][p];
+      fQTable[(fMaxHarmo + n) * nPowers + p] = {q.Re(), q.Im()};
+      fQTable[(fMaxHarmo - n) * nPowers + p] = {q.Re(), -q.Im()}; // Q(-n,p) = Q(n,p)*
+    }
+  }
+}
+
 void FlowJSPCAnalysis::CalculateCorrelators(const Int_t fCentBin)
 {
   // Loop over the combinations of harmonics and calculate the corresponding SPC num and den.
 
   // Declare the arrays to later fill all the needed bins for the correlators
   // and the error terms.
-  Double_t* dataCorrelation = new Double_t[3]; // cosine, weight, sine.
+  Double_t dataCorrelation[3]; // cosine, weight, sine.
   Double_t correlationNum;
   Double_t weightCorrelationNum;
   Double_t correlationDenom;
   Double_t weightCorrelationDenom;
 
+  if (!fUseRecursion) {
+    FillQTable();
+  }
+
   for (Int_t j = 0; j < 12; j++) {
     if (fHarmosArray[j][0] == 0) {
       continue;
@@ -205,167 +297,25 @@ void FlowJSPCAnalysis::Correlation(Int_t c_nPart, Int_t c_nHarmo, Int_t* harmo,
     return;
   }
 
-  switch (c_nPart) {
-    case 2: {
-      Int_t harmonicsTwoNum[2] = {harmo[0], harmo[1]};
-      Int_t harmonicsTwoDen[2] = {0, 0};
-
-      if (!fCorrelDenoms[1]) {
-        fCorrelDenoms[1] = Recursion(2, harmonicsTwoDen).Re();
-      }
-
-      TComplex twoRecursion = Recursion(2, harmonicsTwoNum) / fCorrelDenoms[1];
-
-      correlData[0] = twoRecursion.Re(); // <cos(h1*phi1+h2*phi2)>
-      correlData[1] = fCorrelDenoms[1];  // weight
-      correlData[2] = twoRecursion.Im(); // <sin(h1*phi1+h2*phi2)>
-    } break;
-    case 3: {
-      Int_t harmonicsThreeNum[3] = {harmo[0], harmo[1], harmo[2]};
-      Int_t harmonicsThreeDen[3] = {0, 0, 0};
-
-      if (!fCorrelDenoms[2]) {
-        fCorrelDenoms[2] = Recursion(3, harmonicsThreeDen).Re();
-      }
-
-      TComplex threeRecursion = Recursion(3, harmonicsThreeNum) / fCorrelDenoms[2];
-
-      correlData[0] = threeRecursion.Re(); // <cos(h1*phi1+h2*phi2+h3*phi3)>
-      correlData[1] = fCorrelDenoms[2];    // weight
-      correlData[2] = threeRecursion.Im(); // <sin(h1*phi1+h2*phi2+h3*phi3)>
-    } break;
-    case 4: {
-      Int_t harmonicsFourNum[4] = {harmo[0], harmo[1], harmo[2], harmo[3]};
-      Int_t harmonicsFourDen[4] = {0, 0, 0, 0};
-
-      if (!fCorrelDenoms[3]) {
-        fCorrelDenoms[3] = Recursion(4, harmonicsFourDen).Re();
-      }
-
-      TComplex fourRecursion = Recursion(4, harmonicsFourNum) / fCorrelDenoms[3];
-
-      correlData[0] = fourRecursion.Re(); // <cos(h1*phi1+h2*phi2+h3*phi3+h4*phi4)>
-      correlData[1] = fCorrelDenoms[3];   // weight
-      correlData[2] = fourRecursion.Im(); // <sin(h1*phi1+h2*phi2+h3*phi3+h4*phi4)>
-    } break;
-    case 5: {
-      Int_t harmonicsFiveNum[5] = {harmo[0], harmo[1], harmo[2], harmo[3], harmo[4]};
-      Int_t harmonicsFiveDen[5] = {0, 0, 0, 0, 0};
-
-      if (!fCorrelDenoms[4]) {
-        fCorrelDenoms[4] = Recursion(5, harmonicsFiveDen).Re();
-      }
-
-      TComplex fiveRecursion = Recursion(5, harmonicsFiveNum) / fCorrelDenoms[4];
-
-      correlData[0] = fiveRecursion.Re(); // <cos(h1*phi1+h2*phi2+h3*phi3+h4*phi4+h5*phi5)>
-      correlData[1] = fCorrelDenoms[4];   // weight
-      correlData[2] = fiveRecursion.Im(); // <sin(h1*phi1+h2*phi2+h3*phi3+h4*phi4+h5*phi5)>
-    } break;
-    case 6: {
-      Int_t harmonicsSixNum[6] = {harmo[0], harmo[1], harmo[2], harmo[3], harmo[4], harmo[5]};
-      Int_t harmonicsSixDen[6] = {0, 0, 0, 0, 0, 0};
-
-      if (!fCorrelDenoms[5]) {
-        fCorrelDenoms[5] = Recursion(6, harmonicsSixDen).Re();
-      }
-
-      TComplex sixRecursion = Recursion(6, harmonicsSixNum) / fCorrelDenoms[5];
-
-      correlData[0] = sixRecursion.Re(); // <cos(h1*phi1+h2*phi2+h3*phi3+h4*phi4+h5*phi5+h6*phi6)>
-      correlData[1] = fCorrelDenoms[5];  // weight
-      correlData[2] = sixRecursion.Im(); // <sin(h1*phi1+h2*phi2+h3*phi3+h4*phi4+h5*phi5+h6*phi6)>
-    } break;
-    case 7: {
-      Int_t harmonicsSevenNum[7] = {harmo[0], harmo[1], harmo[2], harmo[3], harmo[4], harmo[5], harmo[6]};
-      Int_t harmonicsSevenDen[7] = {0, 0, 0, 0, 0, 0, 0};
-
-      if (!fCorrelDenoms[6]) {
-        fCorrelDenoms[6] = Recursion(7, harmonicsSevenDen).Re();
-      }
-
-      TComplex sevenRecursion = Recursion(7, harmonicsSevenNum) / fCorrelDenoms[6];
-
-      correlData[0] = sevenRecursion.Re(); // <cos(h1*phi1+h2*phi2+h3*phi3+h4*phi4+h5*phi5+h6*phi6+h7*phi7)>
-      correlData[1] = fCorrelDenoms[6];    // weight
-      correlData[2] = sevenRecursion.Im(); // <sin(h1*phi1+h2*phi2+h3*phi3+h4*phi4+h5*phi5+h6*phi6+h7*phi7)>
-    } break;
-    case 8: {
-      Int_t harmonicsEightNum[8] = {harmo[0], harmo[1], harmo[2], harmo[3],
-                                    harmo[4], harmo[5], harmo[6], harmo[7]};
-      Int_t harmonicsEightDen[8] = {0, 0, 0, 0, 0, 0, 0, 0};
-
-      if (!fCorrelDenoms[7]) {
-        fCorrelDenoms[7] = Recursion(8, harmonicsEightDen).Re();
-      }
-
-      TComplex eightRecursion = Recursion(8, harmonicsEightNum) / fCorrelDenoms[7];
-
-      correlData[0] = eightRecursion.Re(); // <cos(h1*phi1+h2*phi2+h3*phi3+h4*phi4+h5*phi5+h6*phi6+h7*phi7+h8*phi8)>
-      correlData[1] = fCorrelDenoms[7];    // weight
-      correlData[2] = eightRecursion.Im(); // <sin(h1*phi1+h2*phi2+h3*phi3+h4*phi4+h5*phi5+h6*phi6+h7*phi7+h8*phi8)>
-    } break;
-    case 9: {
-      Int_t harmonicsNineNum[9] = {harmo[0], harmo[1], harmo[2], harmo[3], harmo[4],
-                                   harmo[5], harmo[6], harmo[7], harmo[8]};
-      Int_t harmonicsNineDen[9] = {0, 0, 0, 0, 0, 0, 0, 0, 0};
-
-      if (!fCorrelDenoms[8]) {
-        fCorrelDenoms[8] = Recursion(9, harmonicsNineDen).Re();
-      }
-
-      TComplex nineRecursion = Recursion(9, harmonicsNineNum) / fCorrelDenoms[8];
-
-      correlData[0] = nineRecursion.Re();
-      correlData[1] = fCorrelDenoms[8];
-      correlData[2] = nineRecursion.Im();
-    } break;
-    case 10: {
-      Int_t harmonicsTenNum[10] = {harmo[0], harmo[1], harmo[2], harmo[3], harmo[4],
-                                   harmo[5], harmo[6], harmo[7], harmo[8], harmo[9]};
-      Int_t harmonicsTenDen[10] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
-
-      if (!fCorrelDenoms[9]) {
-        fCorrelDenoms[9] = Recursion(10, harmonicsTenDen).Re();
-      }
-
-      TComplex tenRecursion = Recursion(10, harmonicsTenNum) / fCorrelDenoms[9];
-
-      correlData[0] = tenRecursion.Re();
-      correlData[1] = fCorrelDenoms[9];
-      correlData[2] = tenRecursion.Im();
-    } break;
-    case 12: {
-      Int_t harmonicsTwelveNum[12] = {harmo[0], harmo[1], harmo[2], harmo[3], harmo[4], harmo[5],
-                                      harmo[6], harmo[7], harmo[8], harmo[9], harmo[10], harmo[11]};
-      Int_t harmonicsTwelveDen[12] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
-
-      if (!fCorrelDenoms[11]) {
-        fCorrelDenoms[11] = Recursion(12, harmonicsTwelveDen).Re();
-      }
-
-      TComplex twelveRecursion = Recursion(12, harmonicsTwelveNum) / fCorrelDenoms[11];
+  if (c_nPart < 2 || c_nPart > 14 || c_nPart == 11 || c_nPart == 13) {
+    return;
+  }
 
-      correlData[0] = twelveRecursion.Re();
-      correlData[1] = fCorrelDenoms[11];
-      correlData[2] = twelveRecursion.Im();
-    } break;
-    case 14: {
-      Int_t harmonicsFourteenNum[14] = {harmo[0], harmo[1], harmo[2], harmo[3], harmo[4], harmo[5], harmo[6],
-                                        harmo[7], harmo[8], harmo[9], harmo[10], harmo[11], harmo[12], harmo[13]};
-      Int_t harmonicsFourteenDen[14] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+  Int_t harmonicsNum[14] = {0};
+  Int_t harmonicsDen[14] = {0};
+  for (Int_t i = 0; i < c_nPart; i++) {
+    harmonicsNum[i] = harmo[i];
+  }
 
-      if (!fCorrelDenoms[13]) {
-        fCorrelDenoms[13] = Recursion(14, harmonicsFourteenDen).Re();
-      }
+  if (!fCorrelDenoms[c_nPart - 1]) {
+    fCorrelDenoms[c_nPart - 1] = Evaluate(c_nPart, harmonicsDen).real();
+  }
 
-      TComplex fourteenRecursion = Recursion(14, harmonicsFourteenNum) / fCorrelDenoms[13];
+  std::complex<double> correlation = Evaluate(c_nPart, harmonicsNum) / fCorrelDenoms[c_nPart - 1];
 
-      correlData[0] = fourteenRecursion.Re();
-      correlData[1] = fCorrelDenoms[13];
-      correlData[2] = fourteenRecursion.Im();
-    } break;
-  }
+  correlData[0] = correlation.real();         // <cos(h1*phi1+...+hn*phin)>
+  correlData[1] = fCorrelDenoms[c_nPart - 1]; // weight
+  correlData[2] = correlation.imag();         // <sin(h1*phi1+...+hn*phin)>
 }
 int FlowJSPCAnalysis::GetCentBin(float cValue)
 {
@@ -18,6 +18,7 @@
 /* Header files. */
 #include <iostream>
 #include <array>
+#include <complex>
 #include <vector>
 #include <TComplex.h>
 #include <TProfile.h>
@@ -45,6 +46,14 @@ class FlowJSPCAnalysis
   void FillHistograms(const Int_t fCentBin, Int_t ind, Double_t cNum, Double_t cDenom, Double_t wNum, Double_t wDenom);
   TComplex Recursion(int n, int* harmonic, int mult, int skip);
   TComplex Q(const Int_t harmN, const Int_t p);
+  std::complex<double> Correlator(const Int_t n, const Int_t* harmonic);
+  std::complex<double> Evaluate(const Int_t n, const Int_t* harmonic);
+
+  /// Evaluate the correlators with the original recursion instead of the iterative algorithm (cross-check).
+  void SetRecursiveEvaluation(bool recursive) { fUseRecursion = recursive; }
+  /// Highest harmonic and power of Q(n,p) needed by the correlator set, e.g. to bound JQVectors::Calculate.
+  Int_t GetMaxHarmonic() const { return fMaxHarmo; }
+  Int_t GetMaxPower() const { return fMaxPower; }
 
   void CreateHistos()
   {
@@ -66,10 +75,12 @@ class FlowJSPCAnalysis
     for (int i = 0; i < 8; i++) {
       fHarmosArray[obsInd][i] = harmo[i];
     }
+    UpdateQBounds();
   }
   void SetFullCorrSet(Int_t harmo[12][8])
   {
     memcpy(fHarmosArray, harmo, sizeof(Int_t) * 12 * 8);
+    UpdateQBounds();
   }
 
  private:
@@ -77,6 +88,16 @@ class FlowJSPCAnalysis
   const Int_t mNqPowers = 15;  ///< Max power for Q(n,p): 14part+1.
   const JQVectorsT* qvecs;
 
+  void UpdateQBounds();
+  void FillQTable();
+
+  bool fUseRecursion = false;
+  Int_t fMaxHarmo = 0; ///< Highest |harmonic| of Q(n,p) for the correlator set.
+  Int_t fMaxPower = 0; ///< Highest power of Q(n,p) for the correlator set.
+  std::vector<std::complex<double>> fQTable; //! Q(n,p) of the event for -fMaxHarmo <= n <= fMaxHarmo.
+  std::vector<std::complex<double>> fSubsetCorrel; //! Correlators of the subsets of the harmonics.
+  std::vector<Int_t> fSubsetHarmo;                 //! Sum of the harmonics of each subset.
+
   HistogramRegistry* mHistRegistry = nullptr;
 
   Int_t fHarmosArray[12][8];
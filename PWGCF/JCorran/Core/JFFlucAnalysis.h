@@ -15,9 +15,10 @@
 #ifndef PWGCF_JCORRAN_CORE_JFFLUCANALYSIS_H_
 #define PWGCF_JCORRAN_CORE_JFFLUCANALYSIS_H_
 
+#include <complex>
 #include <experimental/type_traits>
 #include "JQVectors.h"
-#include <TComplex.h>
+#include "JQGapCorrelators.h"
 #include <TNamed.h>
 #include <TH1.h>
 #include <THn.h>
@@ -34,9 +35,9 @@ class JFFlucAnalysis : public TNamed
   ~JFFlucAnalysis();
   void UserCreateOutputObjects();
   void Init();
-  TComplex Q(int n, int p);
-  TComplex Two(int n1, int n2);
-  TComplex Four(int n1, int n2, int n3, int n4);
+  std::complex<double> Q(int n, int p);
+  std::complex<double> Two(int n1, int n2);
+  std::complex<double> Four(int n1, int n2, int n3, int n4);
   void UserExec(Option_t* option);
   void Terminate(Option_t*);
 
@@ -122,7 +123,7 @@ class JFFlucAnalysis : public TNamed
          kK3,
          kK4,
          nKL }; // order
-  using JQVectorsT = JQVectors<TComplex, kNH, nKL, true>;
+  using JQVectorsT = JQVectors<std::complex<double>, kNH, nKL, true>;
   inline void SetJQVectors(const JQVectorsT* _pqvecs)
   {
     pqvecs = _pqvecs;
@@ -175,6 +176,8 @@ class JFFlucAnalysis : public TNamed
   const JQVectorsT* pqvecs;    //!
   const JQVectorsT* pqvecsRef; //!
 
+  JQGapCorrelators<std::complex<double>, kNH, nKL> gapCorrelators; //! memoised subevent terms of the current event
+
   TH1* ph1[HIST_TH1_COUNT];              //!
   THn* pht[HIST_THN_COUNT];              //!
   THnSparse* phs[HIST_THN_SPARSE_COUNT]; //!
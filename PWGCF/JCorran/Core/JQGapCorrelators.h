@@ -0,0 +1,114 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#ifndef PWGCF_JCORRAN_CORE_JQGAPCORRELATORS_H_
+#define PWGCF_JCORRAN_CORE_JQGAPCORRELATORS_H_
+
+#include <complex>
+#include <utility>
+#include <TMath.h>
+
+// Multi-particle correlators between two subevents A and B, built from the Q-vectors of the subevents.
+// A correlator with m particles from A and l particles from B factorizes into the m-particle term of A
+// (self-correlations removed) times the complex conjugate of the l-particle term of B. The one-side
+// terms are memoised for the current pair of subevents, such that the terms shared by several
+// observables (e.g. the reference terms of B) are evaluated once per event.
+template <class Q, UInt_t nh, UInt_t nk>
+class JQGapCorrelators
+{
+ public:
+  using QArray = Q[nh][nk];
+
+  // Sets the subevents of the next correlators and invalidates the memoised terms
+  inline void SetQvectors(const QArray& _qa, const QArray& _qb)
+  {
+    pq[0] = &_qa;
+    pq[1] = &_qb;
+    if (++stamp == 0) { // wrapped around: forget all the terms
+      for (auto& side : terms2)
+        for (auto& row : side)
+          for (auto& term : row)
+            term.stamp = 0;
+      for (auto& side : terms3)
+        for (auto& plane : side)
+          for (auto& row : plane)
+            for (auto& term : row)
+              term.stamp = 0;
+      stamp = 1;
+    }
+  }
+
+  inline Q Two(UInt_t a, UInt_t b) const
+  {
+    return Qv(0, a, 1) * std::conj(Qv(1, b, 1));
+  }
+  inline Q Three(UInt_t a, UInt_t b, UInt_t c)
+  {
+    return Qv(0, a, 1) * std::conj(Side2(1, b, c));
+  }
+  inline Q Four22(UInt_t a, UInt_t b, UInt_t c, UInt_t d)
+  {
+    return Side2(0, a, b) * std::conj(Side2(1, c, d));
+  }
+  inline Q Four13(UInt_t a, UInt_t b, UInt_t c, UInt_t d)
+  {
+    return Qv(0, a, 1) * std::conj(Side3(1, b, c, d));
+  }
+  inline Q Six33(UInt_t n1, UInt_t n2, UInt_t n3, UInt_t n4, UInt_t n5, UInt_t n6)
+  {
+    return Side3(0, n1, n2, n3) * std::conj(Side3(1, n4, n5, n6));
+  }
+
+ private:
+  struct Term {
+    Q value;
+    UInt_t stamp = 0;
+  };
+
+  inline const Q& Qv(UInt_t side, UInt_t n, UInt_t k) const { return (*pq[side])[n][k]; }
+
+  // two-particle term <exp[i(a*phi1 + b*phi2)]> of one side, symmetric in the harmonics
+  inline const Q& Side2(UInt_t side, UInt_t a, UInt_t b)
+  {
+    if (a > b)
+      std::swap(a, b);
+    Term& term = terms2[side][a][b];
+    if (term.stamp != stamp) {
+      term.value = Qv(side, a, 1) * Qv(side, b, 1) - Qv(side, a + b, 2);
+      term.stamp = stamp;
+    }
+    return term.value;
+  }
+
+  // three-particle term <exp[i(a*phi1 + b*phi2 + c*phi3)]> of one side, symmetric in the harmonics
+  inline const Q& Side3(UInt_t side, UInt_t a, UInt_t b, UInt_t c)
+  {
+    if (a > b)
+      std::swap(a, b);
+    if (b > c)
+      std::swap(b, c);
+    if (a > b)
+      std::swap(a, b);
+    Term& term = terms3[side][a][b][c];
+    if (term.stamp != stamp) {
+      term.value = Qv(side, a, 1) * Qv(side, b, 1) * Qv(side, c, 1) - Qv(side, a + b, 2) * Qv(side, c, 1) - Qv(side, a + c, 2) * Qv(side, b, 1) - Qv(side, b + c, 2) * Qv(side, a, 1) + 2.0 * Qv(side, a + b + c, 3);
+      term.stamp = stamp;
+    }
+    return term.value;
+  }
+
+  const QArray* pq[2] = {nullptr, nullptr};
+  UInt_t stamp = 0;
+  Term terms2[2][nh][nh];
+  Term terms3[2][nh][nh][nh];
+};
+
+#endif // PWGCF_JCORRAN_CORE_JQGAPCORRELATORS_H_
@@ -15,6 +15,7 @@
 #ifndef PWGCF_JCORRAN_CORE_JQVECTORS_H_
 #define PWGCF_JCORRAN_CORE_JQVECTORS_H_
 
+#include <algorithm>
 #include <experimental/type_traits>
 #include <TMath.h>
 
@@ -45,9 +46,12 @@ class JQVectors : public std::conditional_t<gap, JQVectorsGapBase<Q, nh, nk>, JQ
   template <class T>
   using hasWeightEff = decltype(std::declval<T&>().weightEff());
 
+  // nhUsed and nkUsed bound the harmonics and powers filled, the others are left at zero
   template <class JInputClass>
-  inline void Calculate(JInputClass& inputInst, float etamin, float etamax)
+  inline void Calculate(JInputClass& inputInst, float etamin, float etamax, UInt_t nhUsed = nh, UInt_t nkUsed = nk)
   {
+    nhUsed = std::min(nhUsed, nh);
+    nkUsed = std::min(nkUsed, nk);
     // calculate Q-vector for QC method ( no subgroup )
     for (UInt_t ih = 0; ih < nh; ++ih) {
       for (UInt_t ik = 0; ik < nk; ++ik) {
@@ -63,10 +67,12 @@ class JQVectors : public std::conditional_t<gap, JQVectorsGapBase<Q, nh, nk>, JQ
         continue;
 
       UInt_t isub = (UInt_t)(track.eta() > 0.0);
-      for (UInt_t ih = 0; ih < nh; ++ih) {
+      for (UInt_t ih = 0; ih < nhUsed; ++ih) {
         Double_t tf = 1.0;
-        for (UInt_t ik = 0; ik < nk; ++ik) {
-          Q q(tf * TMath::Cos(ih * track.phi()), tf * TMath::Sin(ih * track.phi()));
+        const Double_t c = TMath::Cos(ih * track.phi());
+        const Double_t s = TMath::Sin(ih * track.phi());
+        for (UInt_t ik = 0; ik < nkUsed; ++ik) {
+          Q q(tf * c, tf * s);
           QvectorQC[ih][ik] += q;
 
           if constexpr (gap) {
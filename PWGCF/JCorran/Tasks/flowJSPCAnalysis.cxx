@@ -68,6 +68,7 @@ struct flowJSPCAnalysis {
   Configurable<bool> cfgFillQA{"cfgFillQA", true, "Fill QA plots"};
 
   Configurable<Int_t> cfgWhichSPC{"cfgWhichSPC", 0, "Which SPC observables to compute."};
+  Configurable<bool> cfgUseRecursion{"cfgUseRecursion", false, "Evaluate the correlators with the recursion instead of the iterative algorithm"};
 
   struct : ConfigurableGroup {
     Configurable<float> cfgPtMin{"cfgPtMin", 0.2f, "Minimum pT used for track selection."};
@@ -112,6 +113,7 @@ struct flowJSPCAnalysis {
 
     SPCobservables.SetSPCObservables(cfgWhichSPC);
     spcAnalysis.SetFullCorrSet(SPCobservables.harmonicArray);
+    spcAnalysis.SetRecursiveEvaluation(cfgUseRecursion);
 
     histManager.SetHistRegistryQA(&qaHistRegistry);
     histManager.SetDebugLog(false);
@@ -170,7 +172,7 @@ struct flowJSPCAnalysis {
     if (cfgFillQA)
       histManager.FillEventQA<1>(coll, cBin, cent, nTracks);
 
-    jqvecs.Calculate(tracks, 0.0, cfgTrackCuts.cfgEtaMax);
+    jqvecs.Calculate(tracks, 0.0, cfgTrackCuts.cfgEtaMax, spcAnalysis.GetMaxHarmonic() + 1, spcAnalysis.GetMaxPower() + 1);
     spcAnalysis.SetQvectors(&jqvecs);
     spcAnalysis.CalculateCorrelators(cBin);
 
@@ -126,6 +126,8 @@ struct : ConfigurableGroup {
 // *) Multiparticle correlations:
 struct : ConfigurableGroup {
   Configurable<bool> cfCalculateCorrelations{"cfCalculateCorrelations", false, "calculate or not multiparticle correlations"};
+  Configurable<bool> cfUseGenericEngine{"cfUseGenericEngine", false, "calculate 5-p and higher correlators with the memoised generic engine, instead of standard expressions and Recursion()"};
+  Configurable<bool> cfBenchmarkGenericEngine{"cfBenchmarkGenericEngine", false, "per event, time and cross-check generic engine vs. standard expressions vs. custom nested loops (use only locally)"};
 } cf_mupa;
 
 // *) Test0:
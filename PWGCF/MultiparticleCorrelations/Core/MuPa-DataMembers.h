@@ -167,6 +167,13 @@ struct MultiparticleCorrelations {
   TList* fCorrelationsList = NULL;                                           // list to hold all correlations objects
   TProfile* fCorrelationsFlagsPro = NULL;                                    // profile to hold all flags for correlations
   Bool_t fCalculateCorrelations = kTRUE;                                     // calculate and store integrated correlations
+  Bool_t fUseGenericEngine = kFALSE;                                         // calculate 5-p and higher correlators with the generic engine, see CorrelatorTable()
+  Bool_t fBenchmarkGenericEngine = kFALSE;                                   // time and cross-check generic engine vs. standard expressions vs. nested loops
+  TComplex fEngineQ[1 << gMaxCorrelator];                                    //! (-1)^{|B|-1} (|B|-1)! Q(n_B,|B|) for each subset B of the correlator indices
+  TComplex fEngineC[1 << gMaxCorrelator];                                    //! unnormalised correlator for each subset of the correlator indices
+  Int_t fEngineHarmonic[1 << gMaxCorrelator] = {0};                          //! sum of harmonics n_B for each subset B
+  TComplex fEngineWeights[gMaxCorrelator + 1];                               //! memoised weights, i.e. correlators with all harmonics 0, up to fEngineWeightsOrder
+  Int_t fEngineWeightsOrder = 0;                                             //! highest order in fEngineWeights valid for the current Q-vectors
   TProfile* fCorrelationsPro[4][gMaxHarmonic][eAsFunctionOf_N] = {{{NULL}}}; //! multiparticle correlations
                                                                              //! [2p=0,4p=1,6p=2,8p=3][n=1,n=2,...,n=gMaxHarmonic][0=integrated,1=vs.
                                                                              //! multiplicity,2=vs. centrality,3=pT,4=eta]
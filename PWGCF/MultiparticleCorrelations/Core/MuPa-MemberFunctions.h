@@ -315,6 +315,8 @@ void DefaultConfiguration()
 
   // *) Multiparticle correlations:
   mupa.fCalculateCorrelations = cf_mupa.cfCalculateCorrelations;
+  mupa.fUseGenericEngine = cf_mupa.cfUseGenericEngine;
+  mupa.fBenchmarkGenericEngine = cf_mupa.cfBenchmarkGenericEngine;
 
   // *) Test0:
   // TBI 20250506 Implemented this way, I miss possibility to switch off all Test0 flags in one go. Re-think if i really need that.
@@ -1232,6 +1234,11 @@ void InsanityChecks()
     LOGF(fatal, "\033[1;31m%s at line %d : Cannot calculate multiparticle correlations, in case Q-vectors are not filled \033[0m", __FUNCTION__, __LINE__);
   }
 
+  // *) Cannot benchmark the generic engine, in case Q-vectors or nested loops containers are not filled:
+  if (mupa.fBenchmarkGenericEngine && !(qv.fCalculateQvectors && nl.fCalculateCustomNestedLoops)) {
+    LOGF(fatal, "\033[1;31m%s at line %d : Cannot benchmark the generic engine, in case Q-vectors or nested loops containers are not filled (set cfCalculateQvectors and cfCalculateCustomNestedLoops) \033[0m", __FUNCTION__, __LINE__);
+  }
+
   // *) Cannot calculate Test0, in case Q-vectors are not filled:
   if (t0.fCalculateTest0 && !qv.fCalculateQvectors) {
     LOGF(fatal, "\033[1;31m%s at line %d : Cannot calculate Test0, in case Q-vectors are not filled \033[0m", __FUNCTION__, __LINE__);
@@ -2118,13 +2125,17 @@ void BookCorrelationsHistograms()
 
   // a) Book the profile holding flags:
   mupa.fCorrelationsFlagsPro = new TProfile("fCorrelationsFlagsPro",
-                                            "flags for correlations", 1, 0., 31);
+                                            "flags for correlations", 3, 0., 3.);
   mupa.fCorrelationsFlagsPro->SetStats(kFALSE);
   mupa.fCorrelationsFlagsPro->SetLineColor(eColor);
   mupa.fCorrelationsFlagsPro->SetFillColor(eFillColor);
   mupa.fCorrelationsFlagsPro->GetXaxis()->SetLabelSize(0.05);
   mupa.fCorrelationsFlagsPro->GetXaxis()->SetBinLabel(1, "fCalculateCorrelations");
   mupa.fCorrelationsFlagsPro->Fill(0.5, mupa.fCalculateCorrelations);
+  mupa.fCorrelationsFlagsPro->GetXaxis()->SetBinLabel(2, "fUseGenericEngine");
+  mupa.fCorrelationsFlagsPro->Fill(1.5, mupa.fUseGenericEngine);
+  mupa.fCorrelationsFlagsPro->GetXaxis()->SetBinLabel(3, "fBenchmarkGenericEngine");
+  mupa.fCorrelationsFlagsPro->Fill(2.5, mupa.fBenchmarkGenericEngine);
   // ...
   mupa.fCorrelationsList->Add(mupa.fCorrelationsFlagsPro);
 
@@ -5678,6 +5689,7 @@ void CalculateKineTest0(eAsFunctionOf AFO_variable)
         qv.fQ[h][wp] = qv.fqvector[qvKine][b][h][wp];
       }
     }
+    mupa.fEngineWeightsOrder = 0; // memoised weights of the generic engine are not valid for this bin
 
     // *) Okay, let's do the differential calculus:
     Double_t correlation = 0.;
@@ -6274,6 +6286,11 @@ TComplex Five(Int_t n1, Int_t n2, Int_t n3, Int_t n4, Int_t n5)
 {
   // Generic five-particle correlation <exp[i(n1*phi1+n2*phi2+n3*phi3+n4*phi4+n5*phi5)]>.
 
+  if (mupa.fUseGenericEngine) {
+    Int_t harmonic[5] = {n1, n2, n3, n4, n5};
+    return Correlator(5, harmonic);
+  }
+
   TComplex five = Q(n1, 1) * Q(n2, 1) * Q(n3, 1) * Q(n4, 1) * Q(n5, 1) - Q(n1 + n2, 2) * Q(n3, 1) * Q(n4, 1) * Q(n5, 1) - Q(n2, 1) * Q(n1 + n3, 2) * Q(n4, 1) * Q(n5, 1) - Q(n1, 1) * Q(n2 + n3, 2) * Q(n4, 1) * Q(n5, 1) + 2. * Q(n1 + n2 + n3, 3) * Q(n4, 1) * Q(n5, 1) - Q(n2, 1) * Q(n3, 1) * Q(n1 + n4, 2) * Q(n5, 1) + Q(n2 + n3, 2) * Q(n1 + n4, 2) * Q(n5, 1) - Q(n1, 1) * Q(n3, 1) * Q(n2 + n4, 2) * Q(n5, 1) + Q(n1 + n3, 2) * Q(n2 + n4, 2) * Q(n5, 1) + 2. * Q(n3, 1) * Q(n1 + n2 + n4, 3) * Q(n5, 1) - Q(n1, 1) * Q(n2, 1) * Q(n3 + n4, 2) * Q(n5, 1) + Q(n1 + n2, 2) * Q(n3 + n4, 2) * Q(n5, 1) + 2. * Q(n2, 1) * Q(n1 + n3 + n4, 3) * Q(n5, 1) + 2. * Q(n1, 1) * Q(n2 + n3 + n4, 3) * Q(n5, 1) - 6. * Q(n1 + n2 + n3 + n4, 4) * Q(n5, 1) - Q(n2, 1) * Q(n3, 1) * Q(n4, 1) * Q(n1 + n5, 2) + Q(n2 + n3, 2) * Q(n4, 1) * Q(n1 + n5, 2) + Q(n3, 1) * Q(n2 + n4, 2) * Q(n1 + n5, 2) + Q(n2, 1) * Q(n3 + n4, 2) * Q(n1 + n5, 2) - 2. * Q(n2 + n3 + n4, 3) * Q(n1 + n5, 2) - Q(n1, 1) * Q(n3, 1) * Q(n4, 1) * Q(n2 + n5, 2) + Q(n1 + n3, 2) * Q(n4, 1) * Q(n2 + n5, 2) + Q(n3, 1) * Q(n1 + n4, 2) * Q(n2 + n5, 2) + Q(n1, 1) * Q(n3 + n4, 2) * Q(n2 + n5, 2) - 2. * Q(n1 + n3 + n4, 3) * Q(n2 + n5, 2) + 2. * Q(n3, 1) * Q(n4, 1) * Q(n1 + n2 + n5, 3) - 2. * Q(n3 + n4, 2) * Q(n1 + n2 + n5, 3) - Q(n1, 1) * Q(n2, 1) * Q(n4, 1) * Q(n3 + n5, 2) + Q(n1 + n2, 2) * Q(n4, 1) * Q(n3 + n5, 2) + Q(n2, 1) * Q(n1 + n4, 2) * Q(n3 + n5, 2) + Q(n1, 1) * Q(n2 + n4, 2) * Q(n3 + n5, 2) - 2. * Q(n1 + n2 + n4, 3) * Q(n3 + n5, 2) + 2. * Q(n2, 1) * Q(n4, 1) * Q(n1 + n3 + n5, 3) - 2. * Q(n2 + n4, 2) * Q(n1 + n3 + n5, 3) + 2. * Q(n1, 1) * Q(n4, 1) * Q(n2 + n3 + n5, 3) - 2. * Q(n1 + n4, 2) * Q(n2 + n3 + n5, 3) - 6. * Q(n4, 1) * Q(n1 + n2 + n3 + n5, 4) - Q(n1, 1) * Q(n2, 1) * Q(n3, 1) * Q(n4 + n5, 2) + Q(n1 + n2, 2) * Q(n3, 1) * Q(n4 + n5, 2) + Q(n2, 1) * Q(n1 + n3, 2) * Q(n4 + n5, 2) + Q(n1, 1) * Q(n2 + n3, 2) * Q(n4 + n5, 2) - 2. * Q(n1 + n2 + n3, 3) * Q(n4 + n5, 2) + 2. * Q(n2, 1) * Q(n3, 1) * Q(n1 + n4 + n5, 3) - 2. * Q(n2 + n3, 2) * Q(n1 + n4 + n5, 3) + 2. * Q(n1, 1) * Q(n3, 1) * Q(n2 + n4 + n5, 3) - 2. * Q(n1 + n3, 2) * Q(n2 + n4 + n5, 3) - 6. * Q(n3, 1) * Q(n1 + n2 + n4 + n5, 4) + 2. * Q(n1, 1) * Q(n2, 1) * Q(n3 + n4 + n5, 3) - 2. * Q(n1 + n2, 2) * Q(n3 + n4 + n5, 3) - 6. * Q(n2, 1) * Q(n1 + n3 + n4 + n5, 4) - 6. * Q(n1, 1) * Q(n2 + n3 + n4 + n5, 4) + 24. * Q(n1 + n2 + n3 + n4 + n5, 5);
 
   return five;
@@ -6286,6 +6303,11 @@ TComplex Six(Int_t n1, Int_t n2, Int_t n3, Int_t n4, Int_t n5, Int_t n6)
 {
   // Generic six-particle correlation <exp[i(n1*phi1+n2*phi2+n3*phi3+n4*phi4+n5*phi5+n6*phi6)]>.
 
+  if (mupa.fUseGenericEngine) {
+    Int_t harmonic[6] = {n1, n2, n3, n4, n5, n6};
+    return Correlator(6, harmonic);
+  }
+
   TComplex six = Q(n1, 1) * Q(n2, 1) * Q(n3, 1) * Q(n4, 1) * Q(n5, 1) * Q(n6, 1) - Q(n1 + n2, 2) * Q(n3, 1) * Q(n4, 1) * Q(n5, 1) * Q(n6, 1) - Q(n2, 1) * Q(n1 + n3, 2) * Q(n4, 1) * Q(n5, 1) * Q(n6, 1) - Q(n1, 1) * Q(n2 + n3, 2) * Q(n4, 1) * Q(n5, 1) * Q(n6, 1) + 2. * Q(n1 + n2 + n3, 3) * Q(n4, 1) * Q(n5, 1) * Q(n6, 1) - Q(n2, 1) * Q(n3, 1) * Q(n1 + n4, 2) * Q(n5, 1) * Q(n6, 1) + Q(n2 + n3, 2) * Q(n1 + n4, 2) * Q(n5, 1) * Q(n6, 1) - Q(n1, 1) * Q(n3, 1) * Q(n2 + n4, 2) * Q(n5, 1) * Q(n6, 1) + Q(n1 + n3, 2) * Q(n2 + n4, 2) * Q(n5, 1) * Q(n6, 1) + 2. * Q(n3, 1) * Q(n1 + n2 + n4, 3) * Q(n5, 1) * Q(n6, 1) - Q(n1, 1) * Q(n2, 1) * Q(n3 + n4, 2) * Q(n5, 1) * Q(n6, 1) + Q(n1 + n2, 2) * Q(n3 + n4, 2) * Q(n5, 1) * Q(n6, 1) + 2. * Q(n2, 1) * Q(n1 + n3 + n4, 3) * Q(n5, 1) * Q(n6, 1) + 2. * Q(n1, 1) * Q(n2 + n3 + n4, 3) * Q(n5, 1) * Q(n6, 1) - 6. * Q(n1 + n2 + n3 + n4, 4) * Q(n5, 1) * Q(n6, 1) - Q(n2, 1) * Q(n3, 1) * Q(n4, 1) * Q(n1 + n5, 2) * Q(n6, 1) + Q(n2 + n3, 2) * Q(n4, 1) * Q(n1 + n5, 2) * Q(n6, 1) + Q(n3, 1) * Q(n2 + n4, 2) * Q(n1 + n5, 2) * Q(n6, 1) + Q(n2, 1) * Q(n3 + n4, 2) * Q(n1 + n5, 2) * Q(n6, 1) - 2. * Q(n2 + n3 + n4, 3) * Q(n1 + n5, 2) * Q(n6, 1) - Q(n1, 1) * Q(n3, 1) * Q(n4, 1) * Q(n2 + n5, 2) * Q(n6, 1) + Q(n1 + n3, 2) * Q(n4, 1) * Q(n2 + n5, 2) * Q(n6, 1) + Q(n3, 1) * Q(n1 + n4, 2) * Q(n2 + n5, 2) * Q(n6, 1) + Q(n1, 1) * Q(n3 + n4, 2) * Q(n2 + n5, 2) * Q(n6, 1) - 2. * Q(n1 + n3 + n4, 3) * Q(n2 + n5, 2) * Q(n6, 1) + 2. * Q(n3, 1) * Q(n4, 1) * Q(n1 + n2 + n5, 3) * Q(n6, 1) - 2. * Q(n3 + n4, 2) * Q(n1 + n2 + n5, 3) * Q(n6, 1) - Q(n1, 1) * Q(n2, 1) * Q(n4, 1) * Q(n3 + n5, 2) * Q(n6, 1) + Q(n1 + n2, 2) * Q(n4, 1) * Q(n3 + n5, 2) * Q(n6, 1) + Q(n2, 1) * Q(n1 + n4, 2) * Q(n3 + n5, 2) * Q(n6, 1) + Q(n1, 1) * Q(n2 + n4, 2) * Q(n3 + n5, 2) * Q(n6, 1) - 2. * Q(n1 + n2 + n4, 3) * Q(n3 + n5, 2) * Q(n6, 1) + 2. * Q(n2, 1) * Q(n4, 1) * Q(n1 + n3 + n5, 3) * Q(n6, 1) - 2. * Q(n2 + n4, 2) * Q(n1 + n3 + n5, 3) * Q(n6, 1) + 2. * Q(n1, 1) * Q(n4, 1) * Q(n2 + n3 + n5, 3) * Q(n6, 1) - 2. * Q(n1 + n4, 2) * Q(n2 + n3 + n5, 3) * Q(n6, 1) - 6. * Q(n4, 1) * Q(n1 + n2 + n3 + n5, 4) * Q(n6, 1) - Q(n1, 1) * Q(n2, 1) * Q(n3, 1) * Q(n4 + n5, 2) * Q(n6, 1) + Q(n1 + n2, 2) * Q(n3, 1) * Q(n4 + n5, 2) * Q(n6, 1) + Q(n2, 1) * Q(n1 + n3, 2) * Q(n4 + n5, 2) * Q(n6, 1) + Q(n1, 1) * Q(n2 + n3, 2) * Q(n4 + n5, 2) * Q(n6, 1) - 2. * Q(n1 + n2 + n3, 3) * Q(n4 + n5, 2) * Q(n6, 1) + 2. * Q(n2, 1) * Q(n3, 1) * Q(n1 + n4 + n5, 3) * Q(n6, 1) - 2. * Q(n2 + n3, 2) * Q(n1 + n4 + n5, 3) * Q(n6, 1) + 2. * Q(n1, 1) * Q(n3, 1) * Q(n2 + n4 + n5, 3) * Q(n6, 1) - 2. * Q(n1 + n3, 2) * Q(n2 + n4 + n5, 3) * Q(n6, 1) - 6. * Q(n3, 1) * Q(n1 + n2 + n4 + n5, 4) * Q(n6, 1) + 2. * Q(n1, 1) * Q(n2, 1) * Q(n3 + n4 + n5, 3) * Q(n6, 1) - 2. * Q(n1 + n2, 2) * Q(n3 + n4 + n5, 3) * Q(n6, 1) - 6. * Q(n2, 1) * Q(n1 + n3 + n4 + n5, 4) * Q(n6, 1) - 6. * Q(n1, 1) * Q(n2 + n3 + n4 + n5, 4) * Q(n6, 1) + 24. * Q(n1 + n2 + n3 + n4 + n5, 5) * Q(n6, 1) - Q(n2, 1) * Q(n3, 1) * Q(n4, 1) * Q(n5, 1) * Q(n1 + n6, 2) + Q(n2 + n3, 2) * Q(n4, 1) * Q(n5, 1) * Q(n1 + n6, 2) + Q(n3, 1) * Q(n2 + n4, 2) * Q(n5, 1) * Q(n1 + n6, 2) + Q(n2, 1) * Q(n3 + n4, 2) * Q(n5, 1) * Q(n1 + n6, 2) - 2. * Q(n2 + n3 + n4, 3) * Q(n5, 1) * Q(n1 + n6, 2) + Q(n3, 1) * Q(n4, 1) * Q(n2 + n5, 2) * Q(n1 + n6, 2) - Q(n3 + n4, 2) * Q(n2 + n5, 2) * Q(n1 + n6, 2) + Q(n2, 1) * Q(n4, 1) * Q(n3 + n5, 2) * Q(n1 + n6, 2) - Q(n2 + n4, 2) * Q(n3 + n5, 2) * Q(n1 + n6, 2) - 2. * Q(n4, 1) * Q(n2 + n3 + n5, 3) * Q(n1 + n6, 2) + Q(n2, 1) * Q(n3, 1) * Q(n4 + n5, 2) * Q(n1 + n6, 2) - Q(n2 + n3, 2) * Q(n4 + n5, 2) * Q(n1 + n6, 2) - 2. * Q(n3, 1) * Q(n2 + n4 + n5, 3) * Q(n1 + n6, 2) - 2. * Q(n2, 1) * Q(n3 + n4 + n5, 3) * Q(n1 + n6, 2) + 6. * Q(n2 + n3 + n4 + n5, 4) * Q(n1 + n6, 2) - Q(n1, 1) * Q(n3, 1) * Q(n4, 1) * Q(n5, 1) * Q(n2 + n6, 2) + Q(n1 + n3, 2) * Q(n4, 1) * Q(n5, 1) * Q(n2 + n6, 2) + Q(n3, 1) * Q(n1 + n4, 2) * Q(n5, 1) * Q(n2 + n6, 2) + Q(n1, 1) * Q(n3 + n4, 2) * Q(n5, 1) * Q(n2 + n6, 2) - 2. * Q(n1 + n3 + n4, 3) * Q(n5, 1) * Q(n2 + n6, 2) + Q(n3, 1) * Q(n4, 1) * Q(n1 + n5, 2) * Q(n2 + n6, 2) - Q(n3 + n4, 2) * Q(n1 + n5, 2) * Q(n2 + n6, 2) + Q(n1, 1) * Q(n4, 1) * Q(n3 + n5, 2) * Q(n2 + n6, 2) - Q(n1 + n4, 2) * Q(n3 + n5, 2) * Q(n2 + n6, 2) - 2. * Q(n4, 1) * Q(n1 + n3 + n5, 3) * Q(n2 + n6, 2) + Q(n1, 1) * Q(n3, 1) * Q(n4 + n5, 2) * Q(n2 + n6, 2) - Q(n1 + n3, 2) * Q(n4 + n5, 2) * Q(n2 + n6, 2) - 2. * Q(n3, 1) * Q(n1 + n4 + n5, 3) * Q(n2 + n6, 2) - 2. * Q(n1, 1) * Q(n3 + n4 + n5, 3) * Q(n2 + n6, 2) + 6. * Q(n1 + n3 + n4 + n5, 4) * Q(n2 + n6, 2) + 2. * Q(n3, 1) * Q(n4, 1) * Q(n5, 1) * Q(n1 + n2 + n6, 3) - 2. * Q(n3 + n4, 2) * Q(n5, 1) * Q(n1 + n2 + n6, 3) - 2. * Q(n4, 1) * Q(n3 + n5, 2) * Q(n1 + n2 + n6, 3) - 2. * Q(n3, 1) * Q(n4 + n5, 2) * Q(n1 + n2 + n6, 3) + 4. * Q(n3 + n4 + n5, 3) * Q(n1 + n2 + n6, 3) - Q(n1, 1) * Q(n2, 1) * Q(n4, 1) * Q(n5, 1) * Q(n3 + n6, 2) + Q(n1 + n2, 2) * Q(n4, 1) * Q(n5, 1) * Q(n3 + n6, 2) + Q(n2, 1) * Q(n1 + n4, 2) * Q(n5, 1) * Q(n3 + n6, 2) + Q(n1, 1) * Q(n2 + n4, 2) * Q(n5, 1) * Q(n3 + n6, 2) - 2. * Q(n1 + n2 + n4, 3) * Q(n5, 1) * Q(n3 + n6, 2) + Q(n2, 1) * Q(n4, 1) * Q(n1 + n5, 2) * Q(n3 + n6, 2) - Q(n2 + n4, 2) * Q(n1 + n5, 2) * Q(n3 + n6, 2) + Q(n1, 1) * Q(n4, 1) * Q(n2 + n5, 2) * Q(n3 + n6, 2) - Q(n1 + n4, 2) * Q(n2 + n5, 2) * Q(n3 + n6, 2) - 2. * Q(n4, 1) * Q(n1 + n2 + n5, 3) * Q(n3 + n6, 2) + Q(n1, 1) * Q(n2, 1) * Q(n4 + n5, 2) * Q(n3 + n6, 2) - Q(n1 + n2, 2) * Q(n4 + n5, 2) * Q(n3 + n6, 2) - 2. * Q(n2, 1) * Q(n1 + n4 + n5, 3) * Q(n3 + n6, 2) - 2. * Q(n1, 1) * Q(n2 + n4 + n5, 3) * Q(n3 + n6, 2) + 6. * Q(n1 + n2 + n4 + n5, 4) * Q(n3 + n6, 2) + 2. * Q(n2, 1) * Q(n4, 1) * Q(n5, 1) * Q(n1 + n3 + n6, 3) - 2. * Q(n2 + n4, 2) * Q(n5, 1) * Q(n1 + n3 + n6, 3) - 2. * Q(n4, 1) * Q(n2 + n5, 2) * Q(n1 + n3 + n6, 3) - 2. * Q(n2, 1) * Q(n4 + n5, 2) * Q(n1 + n3 + n6, 3) + 4. * Q(n2 + n4 + n5, 3) * Q(n1 + n3 + n6, 3) + 2. * Q(n1, 1) * Q(n4, 1) * Q(n5, 1) * Q(n2 + n3 + n6, 3) - 2. * Q(n1 + n4, 2) * Q(n5, 1) * Q(n2 + n3 + n6, 3) - 2. * Q(n4, 1) * Q(n1 + n5, 2) * Q(n2 + n3 + n6, 3) - 2. * Q(n1, 1) * Q(n4 + n5, 2) * Q(n2 + n3 + n6, 3) + 4. * Q(n1 + n4 + n5, 3) * Q(n2 + n3 + n6, 3) - 6. * Q(n4, 1) * Q(n5, 1) * Q(n1 + n2 + n3 + n6, 4) + 6. * Q(n4 + n5, 2) * Q(n1 + n2 + n3 + n6, 4) - Q(n1, 1) * Q(n2, 1) * Q(n3, 1) * Q(n5, 1) * Q(n4 + n6, 2) + Q(n1 + n2, 2) * Q(n3, 1) * Q(n5, 1) * Q(n4 + n6, 2) + Q(n2, 1) * Q(n1 + n3, 2) * Q(n5, 1) * Q(n4 + n6, 2) + Q(n1, 1) * Q(n2 + n3, 2) * Q(n5, 1) * Q(n4 + n6, 2) - 2. * Q(n1 + n2 + n3, 3) * Q(n5, 1) * Q(n4 + n6, 2) + Q(n2, 1) * Q(n3, 1) * Q(n1 + n5, 2) * Q(n4 + n6, 2) - Q(n2 + n3, 2) * Q(n1 + n5, 2) * Q(n4 + n6, 2) + Q(n1, 1) * Q(n3, 1) * Q(n2 + n5, 2) * Q(n4 + n6, 2) - Q(n1 + n3, 2) * Q(n2 + n5, 2) * Q(n4 + n6, 2) - 2. * Q(n3, 1) * Q(n1 + n2 + n5, 3) * Q(n4 + n6, 2) + Q(n1, 1) * Q(n2, 1) * Q(n3 + n5, 2) * Q(n4 + n6, 2) - Q(n1 + n2, 2) * Q(n3 + n5, 2) * Q(n4 + n6, 2) - 2. * Q(n2, 1) * Q(n1 + n3 + n5, 3) * Q(n4 + n6, 2) - 2. * Q(n1, 1) * Q(n2 + n3 + n5, 3) * Q(n4 + n6, 2) + 6. * Q(n1 + n2 + n3 + n5, 4) * Q(n4 + n6, 2) + 2. * Q(n2, 1) * Q(n3, 1) * Q(n5, 1) * Q(n1 + n4 + n6, 3) - 2. * Q(n2 + n3, 2) * Q(n5, 1) * Q(n1 + n4 + n6, 3) - 2. * Q(n3, 1) * Q(n2 + n5, 2) * Q(n1 + n4 + n6, 3) - 2. * Q(n2, 1) * Q(n3 + n5, 2) * Q(n1 + n4 + n6, 3) + 4. * Q(n2 + n3 + n5, 3) * Q(n1 + n4 + n6, 3) + 2. * Q(n1, 1) * Q(n3, 1) * Q(n5, 1) * Q(n2 + n4 + n6, 3) - 2. * Q(n1 + n3, 2) * Q(n5, 1) * Q(n2 + n4 + n6, 3) - 2. * Q(n3, 1) * Q(n1 + n5, 2) * Q(n2 + n4 + n6, 3) - 2. * Q(n1, 1) * Q(n3 + n5, 2) * Q(n2 + n4 + n6, 3) + 4. * Q(n1 + n3 + n5, 3) * Q(n2 + n4 + n6, 3) - 6. * Q(n3, 1) * Q(n5, 1) * Q(n1 + n2 + n4 + n6, 4) + 6. * Q(n3 + n5, 2) * Q(n1 + n2 + n4 + n6, 4) + 2. * Q(n1, 1) * Q(n2, 1) * Q(n5, 1) * Q(n3 + n4 + n6, 3) - 2. * Q(n1 + n2, 2) * Q(n5, 1) * Q(n3 + n4 + n6, 3) - 2. * Q(n2, 1) * Q(n1 + n5, 2) * Q(n3 + n4 + n6, 3) - 2. * Q(n1, 1) * Q(n2 + n5, 2) * Q(n3 + n4 + n6, 3) + 4. * Q(n1 + n2 + n5, 3) * Q(n3 + n4 + n6, 3) - 6. * Q(n2, 1) * Q(n5, 1) * Q(n1 + n3 + n4 + n6, 4) + 6. * Q(n2 + n5, 2) * Q(n1 + n3 + n4 + n6, 4) - 6. * Q(n1, 1) * Q(n5, 1) * Q(n2 + n3 + n4 + n6, 4) + 6. * Q(n1 + n5, 2) * Q(n2 + n3 + n4 + n6, 4) + 24. * Q(n5, 1) * Q(n1 + n2 + n3 + n4 + n6, 5) - Q(n1, 1) * Q(n2, 1) * Q(n3, 1) * Q(n4, 1) * Q(n5 + n6, 2) + Q(n1 + n2, 2) * Q(n3, 1) * Q(n4, 1) * Q(n5 + n6, 2) + Q(n2, 1) * Q(n1 + n3, 2) * Q(n4, 1) * Q(n5 + n6, 2) + Q(n1, 1) * Q(n2 + n3, 2) * Q(n4, 1) * Q(n5 + n6, 2) - 2. * Q(n1 + n2 + n3, 3) * Q(n4, 1) * Q(n5 + n6, 2) + Q(n2, 1) * Q(n3, 1) * Q(n1 + n4, 2) * Q(n5 + n6, 2) - Q(n2 + n3, 2) * Q(n1 + n4, 2) * Q(n5 + n6, 2) + Q(n1, 1) * Q(n3, 1) * Q(n2 + n4, 2) * Q(n5 + n6, 2) - Q(n1 + n3, 2) * Q(n2 + n4, 2) * Q(n5 + n6, 2) - 2. * Q(n3, 1) * Q(n1 + n2 + n4, 3) * Q(n5 + n6, 2) + Q(n1, 1) * Q(n2, 1) * Q(n3 + n4, 2) * Q(n5 + n6, 2) - Q(n1 + n2, 2) * Q(n3 + n4, 2) * Q(n5 + n6, 2) - 2. * Q(n2, 1) * Q(n1 + n3 + n4, 3) * Q(n5 + n6, 2) - 2. * Q(n1, 1) * Q(n2 + n3 + n4, 3) * Q(n5 + n6, 2) + 6. * Q(n1 + n2 + n3 + n4, 4) * Q(n5 + n6, 2) + 2. * Q(n2, 1) * Q(n3, 1) * Q(n4, 1) * Q(n1 + n5 + n6, 3) - 2. * Q(n2 + n3, 2) * Q(n4, 1) * Q(n1 + n5 + n6, 3) - 2. * Q(n3, 1) * Q(n2 + n4, 2) * Q(n1 + n5 + n6, 3) - 2. * Q(n2, 1) * Q(n3 + n4, 2) * Q(n1 + n5 + n6, 3) + 4. * Q(n2 + n3 + n4, 3) * Q(n1 + n5 + n6, 3) + 2. * Q(n1, 1) * Q(n3, 1) * Q(n4, 1) * Q(n2 + n5 + n6, 3) - 2. * Q(n1 + n3, 2) * Q(n4, 1) * Q(n2 + n5 + n6, 3) - 2. * Q(n3, 1) * Q(n1 + n4, 2) * Q(n2 + n5 + n6, 3) - 2. * Q(n1, 1) * Q(n3 + n4, 2) * Q(n2 + n5 + n6, 3) + 4. * Q(n1 + n3 + n4, 3) * Q(n2 + n5 + n6, 3) - 6. * Q(n3, 1) * Q(n4, 1) * Q(n1 + n2 + n5 + n6, 4) + 6. * Q(n3 + n4, 2) * Q(n1 + n2 + n5 + n6, 4) + 2. * Q(n1, 1) * Q(n2, 1) * Q(n4, 1) * Q(n3 + n5 + n6, 3) - 2. * Q(n1 + n2, 2) * Q(n4, 1) * Q(n3 + n5 + n6, 3) - 2. * Q(n2, 1) * Q(n1 + n4, 2) * Q(n3 + n5 + n6, 3) - 2. * Q(n1, 1) * Q(n2 + n4, 2) * Q(n3 + n5 + n6, 3) + 4. * Q(n1 + n2 + n4, 3) * Q(n3 + n5 + n6, 3) - 6. * Q(n2, 1) * Q(n4, 1) * Q(n1 + n3 + n5 + n6, 4) + 6. * Q(n2 + n4, 2) * Q(n1 + n3 + n5 + n6, 4) - 6. * Q(n1, 1) * Q(n4, 1) * Q(n2 + n3 + n5 + n6, 4) + 6. * Q(n1 + n4, 2) * Q(n2 + n3 + n5 + n6, 4) + 24. * Q(n4, 1) * Q(n1 + n2 + n3 + n5 + n6, 5) + 2. * Q(n1, 1) * Q(n2, 1) * Q(n3, 1) * Q(n4 + n5 + n6, 3) - 2. * Q(n1 + n2, 2) * Q(n3, 1) * Q(n4 + n5 + n6, 3) - 2. * Q(n2, 1) * Q(n1 + n3, 2) * Q(n4 + n5 + n6, 3) - 2. * Q(n1, 1) * Q(n2 + n3, 2) * Q(n4 + n5 + n6, 3) + 4. * Q(n1 + n2 + n3, 3) * Q(n4 + n5 + n6, 3) - 6. * Q(n2, 1) * Q(n3, 1) * Q(n1 + n4 + n5 + n6, 4) + 6. * Q(n2 + n3, 2) * Q(n1 + n4 + n5 + n6, 4) - 6. * Q(n1, 1) * Q(n3, 1) * Q(n2 + n4 + n5 + n6, 4) + 6. * Q(n1 + n3, 2) * Q(n2 + n4 + n5 + n6, 4) + 24. * Q(n3, 1) * Q(n1 + n2 + n4 + n5 + n6, 5) - 6. * Q(n1, 1) * Q(n2, 1) * Q(n3 + n4 + n5 + n6, 4) + 6. * Q(n1 + n2, 2) * Q(n3 + n4 + n5 + n6, 4) + 24. * Q(n2, 1) * Q(n1 + n3 + n4 + n5 + n6, 5) + 24. * Q(n1, 1) * Q(n2 + n3 + n4 + n5 + n6, 5) - 120. * Q(n1 + n2 + n3 + n4 + n5 + n6, 6);
 
   return six;
@@ -6300,7 +6322,7 @@ TComplex Seven(Int_t n1, Int_t n2, Int_t n3, Int_t n4, Int_t n5, Int_t n6, Int_t
 
   Int_t harmonic[7] = {n1, n2, n3, n4, n5, n6, n7};
 
-  TComplex seven = Recursion(7, harmonic);
+  TComplex seven = mupa.fUseGenericEngine ? Correlator(7, harmonic) : Recursion(7, harmonic);
 
   return seven;
 
@@ -6314,7 +6336,7 @@ TComplex Eight(Int_t n1, Int_t n2, Int_t n3, Int_t n4, Int_t n5, Int_t n6, Int_t
 
   Int_t harmonic[8] = {n1, n2, n3, n4, n5, n6, n7, n8};
 
-  TComplex eight = Recursion(8, harmonic);
+  TComplex eight = mupa.fUseGenericEngine ? Correlator(8, harmonic) : Recursion(8, harmonic);
 
   return eight;
 
@@ -6328,7 +6350,7 @@ TComplex Nine(Int_t n1, Int_t n2, Int_t n3, Int_t n4, Int_t n5, Int_t n6, Int_t
 
   Int_t harmonic[9] = {n1, n2, n3, n4, n5, n6, n7, n8, n9};
 
-  TComplex nine = Recursion(9, harmonic);
+  TComplex nine = mupa.fUseGenericEngine ? Correlator(9, harmonic) : Recursion(9, harmonic);
 
   return nine;
 
@@ -6342,7 +6364,7 @@ TComplex Ten(Int_t n1, Int_t n2, Int_t n3, Int_t n4, Int_t n5, Int_t n6, Int_t n
 
   Int_t harmonic[10] = {n1, n2, n3, n4, n5, n6, n7, n8, n9, n10};
 
-  TComplex ten = Recursion(10, harmonic);
+  TComplex ten = mupa.fUseGenericEngine ? Correlator(10, harmonic) : Recursion(10, harmonic);
 
   return ten;
 
@@ -6356,7 +6378,7 @@ TComplex Eleven(Int_t n1, Int_t n2, Int_t n3, Int_t n4, Int_t n5, Int_t n6, Int_
 
   Int_t harmonic[11] = {n1, n2, n3, n4, n5, n6, n7, n8, n9, n10, n11};
 
-  TComplex eleven = Recursion(11, harmonic);
+  TComplex eleven = mupa.fUseGenericEngine ? Correlator(11, harmonic) : Recursion(11, harmonic);
 
   return eleven;
 
@@ -6370,7 +6392,7 @@ TComplex Twelve(Int_t n1, Int_t n2, Int_t n3, Int_t n4, Int_t n5, Int_t n6, Int_
 
   Int_t harmonic[12] = {n1, n2, n3, n4, n5, n6, n7, n8, n9, n10, n11, n12};
 
-  TComplex twelve = Recursion(12, harmonic);
+  TComplex twelve = mupa.fUseGenericEngine ? Correlator(12, harmonic) : Recursion(12, harmonic);
 
   return twelve;
 
@@ -6420,6 +6442,90 @@ TComplex Recursion(Int_t n, Int_t* harmonic, Int_t mult = 1, Int_t skip = 0)
 
 //============================================================
 
+void CorrelatorTable(Int_t n, Int_t* harmonic)
+{
+  // Fill the tables of the generic engine for the correlator with harmonics harmonic[0], ..., harmonic[n-1].
+  // Each subset B of the correlator indices enters via the precomputed term fEngineQ[B] = (-1)^{|B|-1} (|B|-1)! Q(n_B,|B|),
+  // where n_B is the sum of harmonics in B. The unnormalised correlator of each subset S is then memoised as
+  //   fEngineC[S] = sum over B in S, containing the lowest index in S, of fEngineQ[B] * fEngineC[S\B], with fEngineC[0] = 1.
+  // This is the same set partition expansion which is hardwired in Two(), ..., Six(), and unrolled in Recursion(),
+  // but each sub-correlator is evaluated only once, at a cost of 3^n/2 complex multiplications.
+  // The n-particle correlator is fEngineC[(1<<n)-1], and fEngineC[(1<<k)-1] is the one of the first k harmonics.
+
+  if (n < 1 || n > gMaxCorrelator) {
+    LOGF(fatal, "\033[1;31m%s at line %d : n = %d\033[0m", __FUNCTION__, __LINE__, n);
+  }
+
+  // a) Precompute the Q-vector terms for all subsets:
+  Double_t coefficient[gMaxCorrelator + 1] = {0., 1.}; // (-1)^{k-1} (k-1)!
+  for (Int_t k = 2; k <= n; k++) {
+    coefficient[k] = -(k - 1) * coefficient[k - 1];
+  }
+  const Int_t nSubsets = 1 << n;
+  Int_t size[1 << gMaxCorrelator] = {0}; // number of indices in each subset
+  mupa.fEngineHarmonic[0] = 0;
+  for (Int_t s = 1; s < nSubsets; s++) {
+    Int_t lowest = 0;
+    while (!((s >> lowest) & 1)) {
+      lowest++;
+    }
+    Int_t rest = s & (s - 1); // s without its lowest index
+    mupa.fEngineHarmonic[s] = mupa.fEngineHarmonic[rest] + harmonic[lowest];
+    size[s] = size[rest] + 1;
+    mupa.fEngineQ[s] = coefficient[size[s]] * Q(mupa.fEngineHarmonic[s], size[s]);
+  }
+
+  // b) Memoised expansion, subsets are processed in increasing order, so fEngineC[S\B] is always available:
+  mupa.fEngineC[0] = TComplex(1., 0.);
+  for (Int_t s = 1; s < nSubsets; s++) {
+    Int_t lowest = s & -s;
+    Int_t others = s ^ lowest;
+    TComplex c(0., 0.);
+    for (Int_t r = others;; r = (r - 1) & others) { // all subsets r of others, i.e. all B = r + lowest
+      c += mupa.fEngineQ[r | lowest] * mupa.fEngineC[others ^ r];
+      if (0 == r) {
+        break;
+      }
+    }
+    mupa.fEngineC[s] = c;
+  }
+
+} // void CorrelatorTable(Int_t n, Int_t* harmonic)
+
+//============================================================
+
+TComplex Correlator(Int_t n, Int_t* harmonic)
+{
+  // Generic n-particle correlator <exp[i(n1*phi1+...+nn*phin)]>, unnormalised, from the generic engine, see CorrelatorTable().
+  // Weights, i.e. correlators with all harmonics 0, are requested for each correlator of the same order, therefore they are
+  // memoised for the current Q-vectors. The memoised weights are invalidated in ResetQ(), and whenever qv.fQ is re-filled.
+
+  Bool_t isWeight = kTRUE;
+  for (Int_t i = 0; i < n; i++) {
+    if (0 != harmonic[i]) {
+      isWeight = kFALSE;
+      break;
+    }
+  }
+
+  if (isWeight) {
+    if (n > mupa.fEngineWeightsOrder) {
+      CorrelatorTable(n, harmonic);
+      for (Int_t k = 1; k <= n; k++) {
+        mupa.fEngineWeights[k] = mupa.fEngineC[(1 << k) - 1];
+      }
+      mupa.fEngineWeightsOrder = n;
+    }
+    return mupa.fEngineWeights[n];
+  }
+
+  CorrelatorTable(n, harmonic);
+  return mupa.fEngineC[(1 << n) - 1];
+
+} // TComplex Correlator(Int_t n, Int_t* harmonic)
+
+//============================================================
+
 void ResetQ()
 {
   // Reset the components of generic Q-vectors. Use it whenever you call the
@@ -6435,6 +6541,7 @@ void ResetQ()
       qv.fQ[h][wp] = TComplex(0., 0.);
     }
   }
+  mupa.fEngineWeightsOrder = 0; // memoised weights of the generic engine are not valid anymore
 
 } // void ResetQ()
 
@@ -7757,6 +7864,104 @@ Double_t CalculateCustomNestedLoops(TArrayI* harmonics)
 
 //============================================================
 
+void BenchmarkGenericEngine()
+{
+  // For the current event, time the isotropic 2-p, 4-p, 6-p and 8-p correlators of the 2nd harmonic with the generic engine,
+  // with the standard expressions (and Recursion() for 7-p and beyond), and with custom nested loops, and cross-check them.
+  // Analytic calculations are repeated, to get timings well above the resolution of TStopwatch. Use only locally.
+
+  // a) Flush 'n' fill the generic Q-vectors;
+  // b) Time and cross-check;
+  // c) Flush the generic Q-vectors.
+
+  if (tc.fVerbose) {
+    LOGF(info, "\033[1;32m%s\033[0m", __FUNCTION__);
+  }
+
+  // a) Flush 'n' fill the generic Q-vectors:
+  ResetQ();
+  for (Int_t h = 0; h < gMaxHarmonic * gMaxCorrelator + 1; h++) {
+    for (Int_t wp = 0; wp < gMaxCorrelator + 1; wp++) // weight power
+    {
+      qv.fQ[h][wp] = qv.fQvector[h][wp];
+    }
+  }
+
+  // b) Time and cross-check:
+  const Int_t nRepetitions = 1000;
+  const Bool_t useGenericEngine = mupa.fUseGenericEngine; // restored below
+  TStopwatch watch;
+  Int_t harmonic[gMaxCorrelator] = {0};
+  for (Int_t order = 2; order <= 8; order += 2) {
+    if (ebye.fSelectedTracks < order) {
+      break;
+    }
+    TArrayI* harmonics = new TArrayI(order);
+    for (Int_t i = 0; i < order; i++) {
+      harmonic[i] = (i < order / 2) ? 2 : -2;
+      harmonics->SetAt(harmonic[i], i);
+    }
+
+    // Generic engine (weights are not memoised here, to time the complete calculation):
+    TComplex engine;
+    watch.Start(kTRUE);
+    for (Int_t r = 0; r < nRepetitions; r++) {
+      CorrelatorTable(order, harmonic);
+      engine = mupa.fEngineC[(1 << order) - 1];
+    }
+    watch.Stop();
+    Double_t timeEngine = 1.e6 * watch.RealTime() / nRepetitions;
+
+    // Standard expressions:
+    mupa.fUseGenericEngine = kFALSE;
+    TComplex standard;
+    watch.Start(kTRUE);
+    for (Int_t r = 0; r < nRepetitions; r++) {
+      switch (order) {
+        case 2:
+          standard = Two(harmonic[0], harmonic[1]);
+          break;
+        case 4:
+          standard = Four(harmonic[0], harmonic[1], harmonic[2], harmonic[3]);
+          break;
+        case 6:
+          standard = Six(harmonic[0], harmonic[1], harmonic[2], harmonic[3], harmonic[4], harmonic[5]);
+          break;
+        case 8:
+          standard = Eight(harmonic[0], harmonic[1], harmonic[2], harmonic[3], harmonic[4], harmonic[5], harmonic[6], harmonic[7]);
+          break;
+      }
+    }
+    watch.Stop();
+    Double_t timeStandard = 1.e6 * watch.RealTime() / nRepetitions;
+    mupa.fUseGenericEngine = useGenericEngine;
+
+    // Custom nested loops (they return the average correlation, and 0 beyond nl.fMaxNestedLoop):
+    watch.Start(kTRUE);
+    Double_t nestedLoops = CalculateCustomNestedLoops(harmonics);
+    watch.Stop();
+    Double_t timeNestedLoops = 1.e6 * watch.RealTime();
+    delete harmonics;
+
+    // Cross-check, the weight is the correlator with all harmonics 0:
+    for (Int_t i = 0; i < order; i++) {
+      harmonic[i] = 0;
+    }
+    CorrelatorTable(order, harmonic);
+    Double_t weight = mupa.fEngineC[(1 << order) - 1].Re();
+    if (TMath::Abs(engine.Re() - standard.Re()) > 1.e-8 * TMath::Max(1., TMath::Abs(standard.Re()))) {
+      LOGF(fatal, "\033[1;31m%s at line %d : %d-p generic engine = %f, standard = %f\033[0m", __FUNCTION__, __LINE__, order, engine.Re(), standard.Re());
+    }
+    LOGF(info, "  %d-p: generic engine %.3f us, standard %.3f us, nested loops %.3f us, <cos> = %f (Q-vectors) vs. %f (nested loops)", order, timeEngine, timeStandard, timeNestedLoops, weight > 0. ? engine.Re() / weight : 0., nestedLoops);
+  }
+
+  // c) Flush the generic Q-vectors:
+  ResetQ();
+
+} // void BenchmarkGenericEngine()
+
+//============================================================
+
 Double_t CalculateKineCustomNestedLoops(TArrayI* harmonics, eAsFunctionOf AFO_variable, Int_t bin)
 {
   // For the specified harmonics, kine variable, and bin, get the correlation from nested loops.
@@ -8511,6 +8716,11 @@ void CalculateEverything()
     this->CalculateKineTest0(AFO_ETA);
   }
 
+  // *) Benchmark the generic engine for multiparticle correlations:
+  if (mupa.fBenchmarkGenericEngine) {
+    this->BenchmarkGenericEngine();
+  }
+
   // *) Calculate nested loops:
   if (nl.fCalculateNestedLoops) {
     this->CalculateNestedLoops();
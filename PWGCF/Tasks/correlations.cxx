@@ -12,6 +12,9 @@
 
 #include <TH1F.h>
 #include <cmath>
+#include <algorithm>
+#include <thread>
+#include <vector>
 #include <TDirectory.h>
 #include <THn.h>
 #include <TFile.h>
@@ -32,6 +35,7 @@
 #include "PWGCF/DataModel/CorrelationsDerived.h"
 #include "PWGCF/Core/CorrelationContainer.h"
 #include "PWGCF/Core/PairCuts.h"
+#include "PWGCF/Core/StepTHnFillBuffer.h"
 #include "DataFormatsParameters/GRPObject.h"
 #include "DataFormatsParameters/GRPMagField.h"
 
@@ -85,6 +89,9 @@ struct CorrelationTask {
 
   O2_DEFINE_CONFIGURABLE(cfgDecayParticleMask, int, 0, "Selection bitmask for the decay particles: 0 = no selection")
   O2_DEFINE_CONFIGURABLE(cfgMassAxis, int, 0, "Use invariant mass axis (0 = OFF, 1 = ON)")
+  O2_DEFINE_CONFIGURABLE(cfgNThreads, int, 1, "Number of threads for the pair loop (1 = no threads). The pair cut control histograms are not filled with more than one thread")
+  O2_DEFINE_CONFIGURABLE(cfgMinTriggersPerThread, int, 50, "Minimal number of trigger particles per thread")
+  O2_DEFINE_CONFIGURABLE(cfgBinnedPairFill, int, 0, "Fill the pairs from per-event (pT, eta, phi) track maps instead of the pair loop (0 = OFF, 1 = ON). Needs fixed-width delta eta and delta phi axes, no pair cuts and no mass axis")
 
   ConfigurableAxis axisVertex{"axisVertex", {7, -7, 7}, "vertex axis for histograms"};
   ConfigurableAxis axisDeltaPhi{"axisDeltaPhi", {72, -PIHalf, PIHalf * 3}, "delta phi axis for histograms"};
@@ -122,6 +129,78 @@ struct CorrelationTask {
 
   std::vector<float> efficiencyAssociatedCache;
 
+  // Per-event track maps for the binned pair filling (cfgBinnedPairFill)
+  // The trigger and associated maps have the bin width of the delta eta and delta phi axes and are shifted by half a bin
+  // with respect to each other, such that the difference of two cell centers is the center of a delta eta, delta phi bin.
+  struct BinnedTrack {
+    int ptBin;
+    int etaBin;
+    int phiBin;
+    int sign; // 0 = negative or no charge, 1 = positive
+    float pt;
+    float weight;
+    int64_t globalIndex;
+  };
+  struct BinnedSelfPair {
+    int ptTriggerBin;
+    int ptAssocBin;
+    int deltaEtaBin;
+    int deltaPhiBin;
+    double weight;
+  };
+  struct BinnedMaps {
+    std::vector<double> ptTriggerEdges;
+    std::vector<double> ptAssocEdges;
+    int nPhi = 0;
+    float phiLow = 0.f;
+    float phiWidth = 0.f;
+    float etaLow = 0.f;
+    float etaWidth = 0.f;
+    int etaTriggerMin = 0;
+    int nEtaTrigger = 0;
+    int etaAssocMin = 0;
+    int nEtaAssoc = 0;
+    int deltaEtaMin = 0;
+    int nDeltaEta = 0;
+    std::vector<double> triggerMap;          // [pT bin][sign][eta][phi]
+    std::vector<double> assocMap;            // [pT bin][sign][eta][phi]
+    std::vector<BinnedTrack> triggers;
+    std::vector<BinnedTrack> associated;
+    std::vector<int> triggerOffsets;         // first trigger of each pT bin, for the pT ordering
+    std::vector<int> assocOffsets;           // first associated track of each pT bin, for the pT ordering
+    std::vector<char> assocRowFilled;        // [pT bin][sign][eta] of the associated map
+    std::vector<BinnedSelfPair> selfPairs;   // same-event tracks which are both trigger and associated particles
+    std::vector<double> pairs;               // [delta eta][delta phi] of one (pT trigger, pT associated) bin
+  } binned;
+
+  // Compact track of the mixing pool, with the accessors used by fillCorrelations and PairCuts
+  struct PoolTrack {
+    float mPt;
+    float mEta;
+    float mPhi;
+    int8_t mSign;
+    int mFilteredIndex;     // position in the event, for the efficiency cache
+    uint64_t mGlobalIndex;  // unique over the pool, also across dataframes
+    float pt() const { return mPt; }
+    float eta() const { return mEta; }
+    float phi() const { return mPhi; }
+    int8_t sign() const { return mSign; }
+    int filteredIndex() const { return mFilteredIndex; }
+    uint64_t globalIndex() const { return mGlobalIndex; }
+  };
+  // iterator names the row type, as for the soa tables
+  struct PoolTracks : std::vector<PoolTrack> {
+    using iterator = PoolTrack;
+  };
+  struct MixingPool {
+    std::vector<PoolTracks> events; // at most cfgNoMixedEvents events, the oldest one is overwritten
+    int oldest = 0;
+  };
+  std::vector<MixingPool> mixingPools; // per (z-vtx, multiplicity) bin, kept across dataframes
+  PoolTracks poolCurrentEvent;
+  uint64_t poolTrackCounter = 0;
+  int poolRunNumber = -1;
+
   struct Config {
     bool mPairCuts = false;
     THn* mEfficiencyTrigger = nullptr;
@@ -132,6 +211,12 @@ struct CorrelationTask {
   HistogramRegistry registry{"registry"};
   PairCuts mPairCuts;
 
+  // Threaded pair loop (cfgNThreads)
+  static constexpr int kMaxBufferedPairsPerThread = 1 << 18;
+  std::vector<PairCuts> pairCutsWorkers; // copies of mPairCuts without control histograms, one per thread
+  StepTHnFillBuffer triggerFillBuffer;
+  StepTHnFillBuffer pairFillBuffer;
+
   Service<o2::ccdb::BasicCCDBManager> ccdb;
 
   using aodCollisions = soa::Filtered<soa::Join<aod::Collisions, aod::EvSels, aod::CentRun2V0Ms>>;
@@ -153,6 +238,9 @@ struct CorrelationTask {
     const int maxMixBin = AxisSpec(axisMultiplicity).getNbins() * AxisSpec(axisVertex).getNbins();
     registry.add("eventcount_same", "bin", {HistType::kTH1F, {{maxMixBin + 2, -2.5, -0.5 + maxMixBin, "bin"}}});
     registry.add("eventcount_mixed", "bin", {HistType::kTH1F, {{maxMixBin + 2, -2.5, -0.5 + maxMixBin, "bin"}}});
+    if (doprocessMixedDerivedPool) {
+      mixingPools.resize(maxMixBin);
+    }
 
     mPairCuts.SetHistogramRegistry(&registry);
 
@@ -169,6 +257,15 @@ struct CorrelationTask {
       mPairCuts.SetTwoTrackCuts(cfgTwoTrackCut, cfgTwoTrackCutMinRadius);
     }
 
+    if (cfgNThreads > 1) {
+      pairCutsWorkers.assign(cfgNThreads, mPairCuts);
+      for (auto& pairCuts : pairCutsWorkers) {
+        pairCuts.SetHistogramRegistry(nullptr);
+      }
+      triggerFillBuffer.setNThreads(cfgNThreads);
+      pairFillBuffer.setNThreads(cfgNThreads);
+    }
+
     // --- OBJECT INIT ---
 
     std::vector<AxisSpec> corrAxis = {{axisDeltaEta, "#Delta#eta"},
@@ -189,6 +286,10 @@ struct CorrelationTask {
     same->setTrackEtaCut(cfgCutEta);
     mixed->setTrackEtaCut(cfgCutEta);
 
+    if (cfgBinnedPairFill) {
+      initBinnedPairFill();
+    }
+
     efficiencyAssociatedCache.reserve(512);
 
     // o2-ccdb-upload -p Users/jgrosseo/correlations/LHC15o -f /tmp/correction_2011_global.root -k correction
@@ -287,6 +388,13 @@ struct CorrelationTask {
   template <CorrelationContainer::CFStep step, typename TTarget, typename TTracks1, typename TTracks2>
   void fillCorrelations(TTarget target, TTracks1& tracks1, TTracks2& tracks2, float multiplicity, float posZ, int magField, float eventWeight)
   {
+    if constexpr (std::is_same<TTracks1, TTracks2>::value) {
+      if (cfgBinnedPairFill) {
+        fillCorrelationsBinned<step>(target, tracks1, tracks2, multiplicity, posZ, eventWeight);
+        return;
+      }
+    }
+
     // Cache efficiency for particles (too many FindBin lookups)
     if constexpr (step == CorrelationContainer::kCFStepCorrected) {
       if (cfg.mEfficiencyAssociated) {
@@ -298,24 +406,279 @@ struct CorrelationTask {
       }
     }
 
-    for (auto& track1 : tracks1) {
-      // LOGF(info, "Track %f | %f | %f  %d %d", track1.eta(), track1.phi(), track1.pt(), track1.isGlobalTrack(), track1.isGlobalTrackSDD());
-
-      if constexpr (step <= CorrelationContainer::kCFStepTracked) {
-        if (!checkObject<step>(track1)) {
+    // Trigger loop: the thread takes every nThreads-th trigger in [firstTrigger, lastTrigger)
+    bool buffered = false;
+    auto fillTrigger = [&](int thread, auto... valuesAndWeight) {
+      if (buffered) {
+        triggerFillBuffer.fill(thread, step, valuesAndWeight...);
+      } else {
+        target->getTriggerHist()->Fill(step, valuesAndWeight...);
+      }
+    };
+    auto fillPair = [&](int thread, auto... valuesAndWeight) {
+      if (buffered) {
+        pairFillBuffer.fill(thread, step, valuesAndWeight...);
+      } else {
+        target->getPairHist()->Fill(step, valuesAndWeight...);
+      }
+    };
+    auto fillTriggers = [&](int thread, int nThreads, int firstTrigger, int lastTrigger, PairCuts& pairCuts) {
+      int iTrigger = -1;
+      for (auto& track1 : tracks1) {
+        iTrigger++;
+        if (iTrigger >= lastTrigger) {
+          break;
+        }
+        if (iTrigger < firstTrigger || iTrigger % nThreads != thread) {
           continue;
         }
+        // LOGF(info, "Track %f | %f | %f  %d %d", track1.eta(), track1.phi(), track1.pt(), track1.isGlobalTrack(), track1.isGlobalTrackSDD());
+
+        if constexpr (step <= CorrelationContainer::kCFStepTracked) {
+          if (!checkObject<step>(track1)) {
+            continue;
+          }
+        }
+
+        if constexpr (std::experimental::is_detected<hasDecay, typename TTracks1::iterator>::value) {
+          if (cfgDecayParticleMask != 0 && (cfgDecayParticleMask & (1u << (uint32_t)track1.decay())) == 0u)
+            continue;
+        }
+
+        if constexpr (std::experimental::is_detected<hasSign, typename TTracks1::iterator>::value) {
+          if (cfgTriggerCharge != 0 && cfgTriggerCharge * track1.sign() < 0) {
+            continue;
+          }
+        }
+
+        float triggerWeight = eventWeight;
+        if constexpr (step == CorrelationContainer::kCFStepCorrected) {
+          if (cfg.mEfficiencyTrigger) {
+            triggerWeight *= getEfficiencyCorrection(cfg.mEfficiencyTrigger, track1.eta(), track1.pt(), multiplicity, posZ);
+          }
+        }
+
+        if (cfgMassAxis) {
+          if constexpr (std::experimental::is_detected<hasInvMass, typename TTracks1::iterator>::value)
+            fillTrigger(thread, track1.pt(), multiplicity, posZ, track1.invMass(), triggerWeight);
+          else
+            LOGF(fatal, "Can not fill mass axis without invMass column. Disable cfgMassAxis.");
+        } else {
+          fillTrigger(thread, track1.pt(), multiplicity, posZ, triggerWeight);
+        }
+
+        for (auto& track2 : tracks2) {
+          if constexpr (std::is_same<TTracks1, TTracks2>::value) {
+            if (track1.globalIndex() == track2.globalIndex()) {
+              // LOGF(info, "Track identical: %f | %f | %f || %f | %f | %f", track1.eta(), track1.phi(), track1.pt(),  track2.eta(), track2.phi(), track2.pt());
+              continue;
+            }
+          }
+          if constexpr (std::experimental::is_detected<hasProng0Id, typename TTracks1::iterator>::value) {
+            if (track2.globalIndex() == track1.cfTrackProng0Id()) // do not correlate daughter tracks of the same event
+              continue;
+          }
+          if constexpr (std::experimental::is_detected<hasProng1Id, typename TTracks1::iterator>::value) {
+            if (track2.globalIndex() == track1.cfTrackProng1Id()) // do not correlate daughter tracks of the same event
+              continue;
+          }
+
+          if constexpr (step <= CorrelationContainer::kCFStepTracked) {
+            if (!checkObject<step>(track2)) {
+              continue;
+            }
+          }
+
+          if (cfgPtOrder != 0 && track2.pt() >= track1.pt()) {
+            continue;
+          }
+
+          if (cfgAssociatedCharge != 0 && cfgAssociatedCharge * track2.sign() < 0) {
+            continue;
+          }
+
+          if constexpr (std::experimental::is_detected<hasSign, typename TTracks1::iterator>::value) {
+            if (cfgPairCharge != 0 && cfgPairCharge * track1.sign() * track2.sign() < 0) {
+              continue;
+            }
+          }
+
+          if constexpr (std::is_same<TTracks1, TTracks2>::value) {
+            if constexpr (step >= CorrelationContainer::kCFStepReconstructed) {
+              if (cfg.mPairCuts && pairCuts.conversionCuts(track1, track2)) {
+                continue;
+              }
+
+              if (cfgTwoTrackCut > 0 && pairCuts.twoTrackCut(track1, track2, magField)) {
+                continue;
+              }
+            }
+          }
+
+          float associatedWeight = triggerWeight;
+          if constexpr (step == CorrelationContainer::kCFStepCorrected) {
+            if (cfg.mEfficiencyAssociated) {
+              associatedWeight *= efficiencyAssociatedCache[track2.filteredIndex()];
+            }
+          }
+
+          float deltaPhi = track1.phi() - track2.phi();
+          if (deltaPhi > 1.5f * PI) {
+            deltaPhi -= TwoPI;
+          }
+          if (deltaPhi < -PIHalf) {
+            deltaPhi += TwoPI;
+          }
+
+          // last param is the weight
+          if (cfgMassAxis) {
+            if constexpr (std::experimental::is_detected<hasInvMass, typename TTracks1::iterator>::value)
+              fillPair(thread, track1.eta() - track2.eta(), track2.pt(), track1.pt(), multiplicity, deltaPhi, posZ, track1.invMass(), associatedWeight);
+            else
+              LOGF(fatal, "Can not fill mass axis without invMass column. Disable cfgMassAxis.");
+          } else {
+            fillPair(thread, track1.eta() - track2.eta(), track2.pt(), track1.pt(), multiplicity, deltaPhi, posZ, associatedWeight);
+          }
+        }
+      }
+    };
+
+    const int nTriggers = tracks1.size();
+    const int nThreads = std::clamp(nTriggers / std::max(cfgMinTriggersPerThread.value, 1), 1, std::max(cfgNThreads.value, 1));
+    if (nThreads == 1) {
+      fillTriggers(0, 1, 0, nTriggers, mPairCuts);
+      return;
+    }
+
+    // The fills are buffered per thread and replayed by this thread after each round, which bounds the buffer size
+    buffered = true;
+    const int triggersPerRound = nThreads * std::max(1, kMaxBufferedPairsPerThread / std::max(static_cast<int>(tracks2.size()), 1));
+    for (int firstTrigger = 0; firstTrigger < nTriggers; firstTrigger += triggersPerRound) {
+      const int lastTrigger = std::min(firstTrigger + triggersPerRound, nTriggers);
+      std::vector<std::thread> threads;
+      for (int thread = 1; thread < nThreads; thread++) {
+        threads.emplace_back([&, thread]() { fillTriggers(thread, nThreads, firstTrigger, lastTrigger, pairCutsWorkers[thread]); });
       }
+      fillTriggers(0, nThreads, firstTrigger, lastTrigger, pairCutsWorkers[0]);
+      for (auto& thread : threads) {
+        thread.join();
+      }
+      triggerFillBuffer.flush(target->getTriggerHist());
+      pairFillBuffer.flush(target->getPairHist());
+    }
+  }
 
-      if constexpr (std::experimental::is_detected<hasDecay, typename TTracks1::iterator>::value) {
-        if (cfgDecayParticleMask != 0 && (cfgDecayParticleMask & (1u << (uint32_t)track1.decay())) == 0u)
+  void initBinnedPairFill()
+  {
+    if (cfg.mPairCuts || cfgTwoTrackCut > 0 || cfgMassAxis != 0) {
+      LOGF(fatal, "The binned pair filling can not apply pair cuts, two-track cuts or the mass axis. Disable cfgBinnedPairFill.");
+    }
+    AxisSpec deltaEtaSpec(axisDeltaEta);
+    AxisSpec deltaPhiSpec(axisDeltaPhi);
+    if (!deltaEtaSpec.nBins.has_value() || !deltaPhiSpec.nBins.has_value()) {
+      LOGF(fatal, "The binned pair filling needs fixed-width delta eta and delta phi axes");
+    }
+    binned.etaLow = deltaEtaSpec.binEdges[0];
+    binned.etaWidth = (deltaEtaSpec.binEdges[1] - deltaEtaSpec.binEdges[0]) / deltaEtaSpec.nBins.value();
+    binned.phiLow = deltaPhiSpec.binEdges[0];
+    binned.nPhi = deltaPhiSpec.nBins.value();
+    binned.phiWidth = (deltaPhiSpec.binEdges[1] - deltaPhiSpec.binEdges[0]) / binned.nPhi;
+    if (std::abs(binned.nPhi * binned.phiWidth - TwoPI) > 1e-4) {
+      LOGF(fatal, "The binned pair filling needs a delta phi axis covering 2 pi");
+    }
+
+    // trigger cells start at (etaLow, phiLow) + half a bin, associated cells at 0
+    const float etaOriginTrigger = binned.etaLow + 0.5f * binned.etaWidth;
+    binned.etaTriggerMin = (int)std::floor((-cfgCutEta - etaOriginTrigger) / binned.etaWidth);
+    binned.nEtaTrigger = (int)std::floor((cfgCutEta - etaOriginTrigger) / binned.etaWidth) - binned.etaTriggerMin + 1;
+    binned.etaAssocMin = (int)std::floor(-cfgCutEta / binned.etaWidth);
+    binned.nEtaAssoc = (int)std::floor(cfgCutEta / binned.etaWidth) - binned.etaAssocMin + 1;
+    binned.deltaEtaMin = binned.etaTriggerMin - (binned.etaAssocMin + binned.nEtaAssoc - 1);
+    binned.nDeltaEta = binned.nEtaTrigger + binned.nEtaAssoc - 1;
+
+    auto getBinEdges = [](AxisSpec const& spec) {
+      if (!spec.nBins.has_value()) {
+        return spec.binEdges;
+      }
+      std::vector<double> edges;
+      for (int i = 0; i <= spec.nBins.value(); i++) {
+        edges.push_back(spec.binEdges[0] + i * (spec.binEdges[1] - spec.binEdges[0]) / spec.nBins.value());
+      }
+      return edges;
+    };
+    binned.ptTriggerEdges = getBinEdges(AxisSpec(axisPtTrigger));
+    binned.ptAssocEdges = getBinEdges(AxisSpec(axisPtAssoc));
+
+    const int nPtTrigger = binned.ptTriggerEdges.size() - 1;
+    const int nPtAssoc = binned.ptAssocEdges.size() - 1;
+    binned.triggerMap.resize(nPtTrigger * 2 * binned.nEtaTrigger * binned.nPhi);
+    binned.assocMap.resize(nPtAssoc * 2 * binned.nEtaAssoc * binned.nPhi);
+    binned.assocRowFilled.resize(nPtAssoc * 2 * binned.nEtaAssoc);
+    binned.triggerOffsets.resize(nPtTrigger + 1);
+    binned.assocOffsets.resize(nPtAssoc + 1);
+    binned.pairs.resize(binned.nDeltaEta * binned.nPhi);
+    binned.triggers.reserve(512);
+    binned.associated.reserve(512);
+
+    LOGF(info, "Binned pair filling with %d x %d trigger and %d x %d associated eta x phi cells", binned.nEtaTrigger, binned.nPhi, binned.nEtaAssoc, binned.nPhi);
+  }
+
+  // Pair filling from per-event (pT, eta, phi) track maps: the delta eta-delta phi distribution of each (pT trigger, pT associated) bin
+  // is the convolution of the trigger map with the associated map, which costs cells^2 instead of pairs.
+  // The pair delta eta and delta phi are those of the cell centers, i.e. they are smeared by up to one bin.
+  // Bins where the pT ordering can not be decided from the bin edges are filled pair by pair, with the same cell granularity.
+  // The pair histogram receives one entry per cell pair, such that its sum of squared weights is not the per-pair one.
+  template <CorrelationContainer::CFStep step, typename TTarget, typename TTracks>
+  void fillCorrelationsBinned(TTarget target, TTracks& tracks1, TTracks& tracks2, float multiplicity, float posZ, float eventWeight)
+  {
+    const int nPtTrigger = binned.ptTriggerEdges.size() - 1;
+    const int nPtAssoc = binned.ptAssocEdges.size() - 1;
+    const int nPhi = binned.nPhi;
+    const int nCellsTrigger = binned.nEtaTrigger * nPhi;
+    const int nCellsAssoc = binned.nEtaAssoc * nPhi;
+
+    auto getPtBin = [](std::vector<double> const& edges, float pt) {
+      auto it = std::upper_bound(edges.begin(), edges.end(), pt);
+      if (it == edges.begin() || it == edges.end()) {
+        return -1;
+      }
+      return static_cast<int>(it - edges.begin()) - 1;
+    };
+    auto getEtaBin = [this](float eta, float origin, int min, int n) {
+      return std::clamp(static_cast<int>(std::floor((eta - origin) / binned.etaWidth)) - min, 0, n - 1);
+    };
+    auto getPhiBin = [this](float phi, float origin) {
+      int bin = static_cast<int>(std::floor((phi - origin) / binned.phiWidth)) % binned.nPhi;
+      return bin < 0 ? bin + binned.nPhi : bin;
+    };
+    auto getDeltaEtaBin = [this](BinnedTrack const& trigger, BinnedTrack const& associated) {
+      return trigger.etaBin + binned.etaTriggerMin - associated.etaBin - binned.etaAssocMin - binned.deltaEtaMin;
+    };
+    auto getDeltaPhiBin = [nPhi](BinnedTrack const& trigger, BinnedTrack const& associated) {
+      return (trigger.phiBin - associated.phiBin + nPhi) % nPhi;
+    };
+    bool checkPairCharge = false;
+    if constexpr (std::experimental::is_detected<hasSign, typename TTracks::iterator>::value) {
+      checkPairCharge = (cfgPairCharge != 0);
+    }
+    auto isPairChargeAccepted = [this, checkPairCharge](int sign1, int sign2) {
+      return !checkPairCharge || (cfgPairCharge > 0) == (sign1 == sign2);
+    };
+
+    binned.triggers.clear();
+    for (auto& track1 : tracks1) {
+      if constexpr (step <= CorrelationContainer::kCFStepTracked) {
+        if (!checkObject<step>(track1)) {
           continue;
+        }
       }
 
-      if constexpr (std::experimental::is_detected<hasSign, typename TTracks1::iterator>::value) {
+      int sign = 0;
+      if constexpr (std::experimental::is_detected<hasSign, typename TTracks::iterator>::value) {
         if (cfgTriggerCharge != 0 && cfgTriggerCharge * track1.sign() < 0) {
           continue;
         }
+        sign = track1.sign() > 0 ? 1 : 0;
       }
 
       float triggerWeight = eventWeight;
@@ -324,87 +687,170 @@ struct CorrelationTask {
           triggerWeight *= getEfficiencyCorrection(cfg.mEfficiencyTrigger, track1.eta(), track1.pt(), multiplicity, posZ);
         }
       }
+      target->getTriggerHist()->Fill(step, track1.pt(), multiplicity, posZ, triggerWeight);
 
-      if (cfgMassAxis) {
-        if constexpr (std::experimental::is_detected<hasInvMass, typename TTracks1::iterator>::value)
-          target->getTriggerHist()->Fill(step, track1.pt(), multiplicity, posZ, track1.invMass(), triggerWeight);
-        else
-          LOGF(fatal, "Can not fill mass axis without invMass column. Disable cfgMassAxis.");
-      } else {
-        target->getTriggerHist()->Fill(step, track1.pt(), multiplicity, posZ, triggerWeight);
+      int ptBin = getPtBin(binned.ptTriggerEdges, track1.pt());
+      if (ptBin < 0) {
+        continue;
       }
+      binned.triggers.push_back({ptBin, getEtaBin(track1.eta(), binned.etaLow + 0.5f * binned.etaWidth, binned.etaTriggerMin, binned.nEtaTrigger),
+                                 getPhiBin(track1.phi(), binned.phiLow + 0.5f * binned.phiWidth), sign, track1.pt(), triggerWeight, track1.globalIndex()});
+    }
 
-      for (auto& track2 : tracks2) {
-        if constexpr (std::is_same<TTracks1, TTracks2>::value) {
-          if (track1.globalIndex() == track2.globalIndex()) {
-            // LOGF(info, "Track identical: %f | %f | %f || %f | %f | %f", track1.eta(), track1.phi(), track1.pt(),  track2.eta(), track2.phi(), track2.pt());
-            continue;
-          }
-        }
-        if constexpr (std::experimental::is_detected<hasProng0Id, typename TTracks1::iterator>::value) {
-          if (track2.globalIndex() == track1.cfTrackProng0Id()) // do not correlate daughter tracks of the same event
-            continue;
-        }
-        if constexpr (std::experimental::is_detected<hasProng1Id, typename TTracks1::iterator>::value) {
-          if (track2.globalIndex() == track1.cfTrackProng1Id()) // do not correlate daughter tracks of the same event
-            continue;
+    binned.associated.clear();
+    for (auto& track2 : tracks2) {
+      if constexpr (step <= CorrelationContainer::kCFStepTracked) {
+        if (!checkObject<step>(track2)) {
+          continue;
         }
+      }
 
-        if constexpr (step <= CorrelationContainer::kCFStepTracked) {
-          if (!checkObject<step>(track2)) {
-            continue;
-          }
-        }
+      if (cfgAssociatedCharge != 0 && cfgAssociatedCharge * track2.sign() < 0) {
+        continue;
+      }
 
-        if (cfgPtOrder != 0 && track2.pt() >= track1.pt()) {
-          continue;
+      int ptBin = getPtBin(binned.ptAssocEdges, track2.pt());
+      if (ptBin < 0) {
+        continue;
+      }
+
+      float associatedWeight = 1.0f;
+      if constexpr (step == CorrelationContainer::kCFStepCorrected) {
+        if (cfg.mEfficiencyAssociated) {
+          associatedWeight = getEfficiencyCorrection(cfg.mEfficiencyAssociated, track2.eta(), track2.pt(), multiplicity, posZ);
         }
+      }
+      binned.associated.push_back({ptBin, getEtaBin(track2.eta(), 0.f, binned.etaAssocMin, binned.nEtaAssoc), getPhiBin(track2.phi(), 0.f),
+                                   track2.sign() > 0 ? 1 : 0, track2.pt(), associatedWeight, track2.globalIndex()});
+    }
 
-        if (cfgAssociatedCharge != 0 && cfgAssociatedCharge * track2.sign() < 0) {
-          continue;
+    // self pairs of the same event, which are included in the convolution: both lists follow the table order
+    binned.selfPairs.clear();
+    auto getFirstIndex = [](auto& tracks) -> int64_t {
+      for (auto& track : tracks) {
+        return track.globalIndex();
+      }
+      return -1;
+    };
+    if (cfgPtOrder == 0 && getFirstIndex(tracks1) >= 0 && getFirstIndex(tracks1) == getFirstIndex(tracks2)) {
+      for (size_t i = 0, j = 0; i < binned.triggers.size() && j < binned.associated.size();) {
+        auto const& trigger = binned.triggers[i];
+        auto const& associated = binned.associated[j];
+        if (trigger.globalIndex < associated.globalIndex) {
+          i++;
+        } else if (trigger.globalIndex > associated.globalIndex) {
+          j++;
+        } else {
+          binned.selfPairs.push_back({trigger.ptBin, associated.ptBin, getDeltaEtaBin(trigger, associated), getDeltaPhiBin(trigger, associated), (double)trigger.weight * associated.weight});
+          i++;
+          j++;
         }
+      }
+    }
 
-        if constexpr (std::experimental::is_detected<hasSign, typename TTracks1::iterator>::value) {
-          if (cfgPairCharge != 0 && cfgPairCharge * track1.sign() * track2.sign() < 0) {
+    std::fill(binned.triggerMap.begin(), binned.triggerMap.end(), 0.);
+    std::fill(binned.assocMap.begin(), binned.assocMap.end(), 0.);
+    std::fill(binned.assocRowFilled.begin(), binned.assocRowFilled.end(), 0);
+    for (auto const& trigger : binned.triggers) {
+      binned.triggerMap[(trigger.ptBin * 2 + trigger.sign) * nCellsTrigger + trigger.etaBin * nPhi + trigger.phiBin] += trigger.weight;
+    }
+    for (auto const& associated : binned.associated) {
+      binned.assocMap[(associated.ptBin * 2 + associated.sign) * nCellsAssoc + associated.etaBin * nPhi + associated.phiBin] += associated.weight;
+      binned.assocRowFilled[(associated.ptBin * 2 + associated.sign) * binned.nEtaAssoc + associated.etaBin] = 1;
+    }
+
+    if (cfgPtOrder != 0) {
+      auto byPtBin = [](BinnedTrack const& a, BinnedTrack const& b) { return a.ptBin < b.ptBin; };
+      std::sort(binned.triggers.begin(), binned.triggers.end(), byPtBin);
+      std::sort(binned.associated.begin(), binned.associated.end(), byPtBin);
+      for (int p = 0; p <= nPtTrigger; p++) {
+        binned.triggerOffsets[p] = std::lower_bound(binned.triggers.begin(), binned.triggers.end(), BinnedTrack{p, 0, 0, 0, 0.f, 0.f, 0}, byPtBin) - binned.triggers.begin();
+      }
+      for (int q = 0; q <= nPtAssoc; q++) {
+        binned.assocOffsets[q] = std::lower_bound(binned.associated.begin(), binned.associated.end(), BinnedTrack{q, 0, 0, 0, 0.f, 0.f, 0}, byPtBin) - binned.associated.begin();
+      }
+    }
+
+    for (int p = 0; p < nPtTrigger; p++) {
+      for (int q = 0; q < nPtAssoc; q++) {
+        bool pairByPair = false;
+        if (cfgPtOrder != 0) {
+          if (binned.ptAssocEdges[q] >= binned.ptTriggerEdges[p + 1]) { // pT,2 >= pT,1 for all pairs
             continue;
           }
+          pairByPair = binned.ptAssocEdges[q + 1] > binned.ptTriggerEdges[p];
         }
 
-        if constexpr (std::is_same<TTracks1, TTracks2>::value) {
-          if constexpr (step >= CorrelationContainer::kCFStepReconstructed) {
-            if (cfg.mPairCuts && mPairCuts.conversionCuts(track1, track2)) {
-              continue;
+        std::fill(binned.pairs.begin(), binned.pairs.end(), 0.);
+        bool filled = false;
+        if (pairByPair) {
+          for (int i = binned.triggerOffsets[p]; i < binned.triggerOffsets[p + 1]; i++) {
+            auto const& trigger = binned.triggers[i];
+            for (int j = binned.assocOffsets[q]; j < binned.assocOffsets[q + 1]; j++) {
+              auto const& associated = binned.associated[j];
+              if (associated.pt >= trigger.pt || !isPairChargeAccepted(trigger.sign, associated.sign)) {
+                continue;
+              }
+              binned.pairs[getDeltaEtaBin(trigger, associated) * nPhi + getDeltaPhiBin(trigger, associated)] += (double)trigger.weight * associated.weight;
+              filled = true;
             }
-
-            if (cfgTwoTrackCut > 0 && mPairCuts.twoTrackCut(track1, track2, magField)) {
-              continue;
+          }
+        } else {
+          for (int sign1 = 0; sign1 < 2; sign1++) {
+            for (int sign2 = 0; sign2 < 2; sign2++) {
+              if (!isPairChargeAccepted(sign1, sign2)) {
+                continue;
+              }
+              const double* triggerMap = &binned.triggerMap[(p * 2 + sign1) * nCellsTrigger];
+              const double* assocMap = &binned.assocMap[(q * 2 + sign2) * nCellsAssoc];
+              const char* assocRowFilled = &binned.assocRowFilled[(q * 2 + sign2) * binned.nEtaAssoc];
+              for (int etaTrigger = 0; etaTrigger < binned.nEtaTrigger; etaTrigger++) {
+                for (int phiTrigger = 0; phiTrigger < nPhi; phiTrigger++) {
+                  const double weight = triggerMap[etaTrigger * nPhi + phiTrigger];
+                  if (weight == 0.) {
+                    continue;
+                  }
+                  for (int etaAssoc = 0; etaAssoc < binned.nEtaAssoc; etaAssoc++) {
+                    if (!assocRowFilled[etaAssoc]) {
+                      continue;
+                    }
+                    const double* row = &assocMap[etaAssoc * nPhi];
+                    double* out = &binned.pairs[(etaTrigger + binned.etaTriggerMin - etaAssoc - binned.etaAssocMin - binned.deltaEtaMin) * nPhi];
+                    // circular convolution in phi, split to avoid the modulo
+                    for (int phiAssoc = 0; phiAssoc <= phiTrigger; phiAssoc++) {
+                      out[phiTrigger - phiAssoc] += weight * row[phiAssoc];
+                    }
+                    for (int phiAssoc = phiTrigger + 1; phiAssoc < nPhi; phiAssoc++) {
+                      out[phiTrigger - phiAssoc + nPhi] += weight * row[phiAssoc];
+                    }
+                    filled = true;
+                  }
+                }
+              }
             }
           }
-        }
-
-        float associatedWeight = triggerWeight;
-        if constexpr (step == CorrelationContainer::kCFStepCorrected) {
-          if (cfg.mEfficiencyAssociated) {
-            associatedWeight *= efficiencyAssociatedCache[track2.filteredIndex()];
+          for (auto const& selfPair : binned.selfPairs) {
+            if (selfPair.ptTriggerBin == p && selfPair.ptAssocBin == q && !(checkPairCharge && cfgPairCharge < 0)) {
+              binned.pairs[selfPair.deltaEtaBin * nPhi + selfPair.deltaPhiBin] -= selfPair.weight;
+            }
           }
         }
-
-        float deltaPhi = track1.phi() - track2.phi();
-        if (deltaPhi > 1.5f * PI) {
-          deltaPhi -= TwoPI;
-        }
-        if (deltaPhi < -PIHalf) {
-          deltaPhi += TwoPI;
+        if (!filled) {
+          continue;
         }
 
-        // last param is the weight
-        if (cfgMassAxis) {
-          if constexpr (std::experimental::is_detected<hasInvMass, typename TTracks1::iterator>::value)
-            target->getPairHist()->Fill(step, track1.eta() - track2.eta(), track2.pt(), track1.pt(), multiplicity, deltaPhi, posZ, track1.invMass(), associatedWeight);
-          else
-            LOGF(fatal, "Can not fill mass axis without invMass column. Disable cfgMassAxis.");
-        } else {
-          target->getPairHist()->Fill(step, track1.eta() - track2.eta(), track2.pt(), track1.pt(), multiplicity, deltaPhi, posZ, associatedWeight);
+        const float ptTrigger = 0.5 * (binned.ptTriggerEdges[p] + binned.ptTriggerEdges[p + 1]);
+        const float ptAssoc = 0.5 * (binned.ptAssocEdges[q] + binned.ptAssocEdges[q + 1]);
+        for (int deltaEtaBin = 0; deltaEtaBin < binned.nDeltaEta; deltaEtaBin++) {
+          const float deltaEta = binned.etaLow + (deltaEtaBin + binned.deltaEtaMin + 0.5f) * binned.etaWidth;
+          for (int deltaPhiBin = 0; deltaPhiBin < nPhi; deltaPhiBin++) {
+            const double weight = binned.pairs[deltaEtaBin * nPhi + deltaPhiBin];
+            if (weight == 0.) {
+              continue;
+            }
+            const float deltaPhi = binned.phiLow + (deltaPhiBin + 0.5f) * binned.phiWidth;
+            target->getPairHist()->Fill(step, deltaEta, ptAssoc, ptTrigger, multiplicity, deltaPhi, posZ, (float)weight);
+          }
         }
       }
     }
@@ -613,6 +1059,67 @@ struct CorrelationTask {
   }
   PROCESS_SWITCH(CorrelationTask, processMixedDerived, "Process mixed events on derived data", false);
 
+  // Mixing with the last cfgNoMixedEvents events of the same (z-vtx, multiplicity) bin, kept in compact form across dataframes
+  // The pools are reset at each run change
+  void processMixedDerivedPool(derivedCollisions const& collisions, derivedTracks const& tracks)
+  {
+    BinningTypeDerived configurableBinningDerived{{axisVertex, axisMultiplicity}, true}; // true is for 'ignore overflows' (true by default). Underflows and overflows will have bin -1.
+
+    for (auto& collision : collisions) {
+      int bin = configurableBinningDerived.getBin({collision.posZ(), collision.multiplicity()});
+      if (bin < 0) {
+        continue;
+      }
+      if (collision.runNumber() != poolRunNumber) {
+        for (auto& pool : mixingPools) {
+          pool.events.clear();
+          pool.oldest = 0;
+        }
+        poolRunNumber = collision.runNumber();
+      }
+
+      auto groupedTracks = tracks.sliceByCached(aod::cftrack::cfCollisionId, collision.globalIndex(), cache);
+      poolCurrentEvent.clear();
+      for (auto& track : groupedTracks) {
+        poolCurrentEvent.push_back({track.pt(), track.eta(), track.phi(), track.sign(), static_cast<int>(poolCurrentEvent.size()), poolTrackCounter++});
+      }
+
+      auto& pool = mixingPools[bin];
+      if (pool.events.size() > 0) {
+        float eventWeight = 1.0f / pool.events.size();
+        int field = 0;
+        if (cfgTwoTrackCut > 0) {
+          field = getMagneticField(collision.timestamp());
+        }
+        if (cfgVerbosity > 0) {
+          LOGF(info, "processMixedDerivedPool: Mixed collision bin: %d collision: %d (%.3f, %.3f) with %d pool events", bin, collision.globalIndex(), collision.posZ(), collision.multiplicity(), pool.events.size());
+        }
+        loadEfficiency(collision.timestamp());
+
+        mixed->fillEvent(collision.multiplicity(), CorrelationContainer::kCFStepReconstructed);
+        for (auto& partner : pool.events) {
+          registry.fill(HIST("eventcount_mixed"), bin);
+          fillCorrelations<CorrelationContainer::kCFStepReconstructed>(mixed, poolCurrentEvent, partner, collision.multiplicity(), collision.posZ(), field, eventWeight);
+        }
+
+        if (cfg.mEfficiencyAssociated || cfg.mEfficiencyTrigger) {
+          mixed->fillEvent(collision.multiplicity(), CorrelationContainer::kCFStepCorrected);
+          for (auto& partner : pool.events) {
+            fillCorrelations<CorrelationContainer::kCFStepCorrected>(mixed, poolCurrentEvent, partner, collision.multiplicity(), collision.posZ(), field, eventWeight);
+          }
+        }
+      }
+
+      if (static_cast<int>(pool.events.size()) < cfgNoMixedEvents) {
+        pool.events.push_back(poolCurrentEvent);
+      } else if (cfgNoMixedEvents > 0) {
+        std::swap(pool.events[pool.oldest], poolCurrentEvent);
+        pool.oldest = (pool.oldest + 1) % cfgNoMixedEvents;
+      }
+    }
+  }
+  PROCESS_SWITCH(CorrelationTask, processMixedDerivedPool, "Process mixed events on derived data with event pools kept across dataframes", false);
+
   void processMixed2ProngDerived(derivedCollisions& collisions, derivedTracks const& tracks, soa::Filtered<aod::CF2ProngTracks> const& p2tracks)
   {
     BinningTypeDerived configurableBinningDerived{{axisVertex, axisMultiplicity}, true}; // true is for 'ignore overflows' (true by default). Underflows and overflows will have bin -1.
@@ -21,8 +21,13 @@
 #include <TProfile3D.h>
 #include <TROOT.h>
 #include <TVector2.h>
+#include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <ctime>
+#include <functional>
+#include <thread>
+#include <vector>
 
 #include "Common/Core/TrackSelection.h"
 #include "Common/Core/TableHelper.h"
@@ -65,6 +70,7 @@ float deltaphiup = constants::math::TwoPI - deltaphibinwidth / 2.0;
 bool processpairs = false;
 bool processmixedevents = false;
 bool ptorder = false;
+bool binnedpairs = false;
 
 PairCuts fPairCuts;              // pair suppression engine
 bool fUseConversionCuts = false; // suppress resonances and conversions
@@ -114,6 +120,33 @@ struct DptDptCorrelationsTask {
     std::vector<std::vector<TProfile*>> fhSum2PtPtnw_vsC{nch, {nch, nullptr}};   //!<! un-weighted accumulated \f${p_T}_1 {p_T}_2\f$ distribution vs event centrality/multiplicity 1-1,1-2,2-1,2-2, combinations
     std::vector<std::vector<TProfile*>> fhSum2DptDptnw_vsC{nch, {nch, nullptr}}; //!<! un-weighted accumulated \f$\sum ({p_T}_1- <{p_T}_1>) ({p_T}_2 - <{p_T}_2>) \f$ distribution vs \f$\Delta\eta,\;\Delta\phi\f$ distribution vs event centrality/multiplicity 1-1,1-2,2-1,2-2, combinations
 
+    /* the per collision (eta,phi) binned singles for the binned pairs processing */
+    struct BinnedSinglesContent {
+      int count = 0;          ///< number of tracks in the bin
+      double n1 = 0.0;        ///< weighted number of tracks
+      double sum1Pt = 0.0;    ///< accumulated sum of weighted \f$p_T\f$
+      double sum1Dpt = 0.0;   ///< accumulated sum of weighted \f$p_T\f$ minus \f$<p_T>\f$
+      double n1sq = 0.0;      ///< accumulated sum of the squared weights, for excluding autocorrelations
+      double sum1Ptsq = 0.0;  ///< accumulated sum of the squared weighted \f$p_T\f$
+      double sum1Dptsq = 0.0; ///< accumulated sum of the squared weighted \f$p_T\f$ minus \f$<p_T>\f$
+    };
+    struct BinnedSingles {
+      std::vector<BinnedSinglesContent> content; ///< the content of the (eta,phi) bins
+      std::vector<int> bins;                     ///< the occupied bins
+      double n1nw = 0.0;                         ///< not weighted number of tracks
+      double sum1Ptnw = 0.0;                     ///< accumulated sum of not weighted \f$p_T\f$
+      double sum1Dptnw = 0.0;                    ///< accumulated sum of not weighted \f$p_T\f$ minus \f$<p_T>\f$
+      double sum1Ptnwsq = 0.0;                   ///< accumulated sum of the squared not weighted \f$p_T\f$
+      double sum1Dptnwsq = 0.0;                  ///< accumulated sum of the squared not weighted \f$p_T\f$ minus \f$<p_T>\f$
+    };
+    std::vector<BinnedSingles> binnedSingles1{nch}; ///< binned singles of the first track list
+    std::vector<BinnedSingles> binnedSingles2{nch}; ///< binned singles of the second track list, mixed events
+    std::vector<double> accN2;                      ///< per collision \f$\Delta\eta,\;\Delta\phi\f$ accumulator of n2
+    std::vector<double> accSum2PtPt;                ///< per collision \f$\Delta\eta,\;\Delta\phi\f$ accumulator of \f$\sum {p_T}_1 {p_T}_2\f$
+    std::vector<double> accSum2DptDpt;              ///< per collision \f$\Delta\eta,\;\Delta\phi\f$ accumulator of \f$\sum ({p_T}_1- <{p_T}_1>) ({p_T}_2 - <{p_T}_2>)\f$
+
+    TList* fHistogramsList = nullptr; ///< the list holding the histograms of this instance
+
     bool ccdbstored = false;
 
     float isCCDBstored()
@@ -407,6 +440,155 @@ struct DptDptCorrelationsTask {
       }
     }
 
+    /// \brief bins the tracks of a collision in (eta,phi) for the binned pairs processing
+    /// \param tracks filtered table with the tracks
+    /// \param binned the binned singles, per track species, to fill
+    template <typename TrackListObject>
+    void binSingles(TrackListObject const& tracks, std::vector<float>* corrs, std::vector<float>* ptavgs, std::vector<BinnedSingles>& binned)
+    {
+      using namespace o2::analysis::dptdptfilter;
+
+      for (auto& singles : binned) {
+        if (singles.content.size() != static_cast<size_t>(etabins * phibins)) {
+          singles.content.assign(etabins * phibins, BinnedSinglesContent{});
+        }
+        for (int bin : singles.bins) {
+          singles.content[bin] = BinnedSinglesContent{};
+        }
+        singles.bins.clear();
+        singles.n1nw = 0.0;
+        singles.sum1Ptnw = 0.0;
+        singles.sum1Dptnw = 0.0;
+        singles.sum1Ptnwsq = 0.0;
+        singles.sum1Dptnwsq = 0.0;
+      }
+      int index = 0;
+      for (auto& track : tracks) {
+        BinnedSingles& singles = binned[track.trackacceptedid()];
+        double corr = (*corrs)[index];
+        double ptavg = (*ptavgs)[index];
+        int bin = GetEtaPhiIndex(track);
+        BinnedSinglesContent& content = singles.content[bin];
+        if (content.count == 0) {
+          singles.bins.push_back(bin);
+        }
+        double ptw = corr * track.pt();
+        content.count++;
+        content.n1 += corr;
+        content.sum1Pt += ptw;
+        content.sum1Dpt += ptw - ptavg;
+        content.n1sq += corr * corr;
+        content.sum1Ptsq += ptw * ptw;
+        content.sum1Dptsq += (ptw - ptavg) * (ptw - ptavg);
+        singles.n1nw += 1;
+        singles.sum1Ptnw += track.pt();
+        singles.sum1Dptnw += track.pt() - ptavg;
+        singles.sum1Ptnwsq += track.pt() * track.pt();
+        singles.sum1Dptnwsq += (track.pt() - ptavg) * (track.pt() - ptavg);
+        index++;
+      }
+    }
+
+    /// \brief fills the pair histograms in pair execution mode from the (eta,phi) binned singles
+    /// \param trks1 filtered table with the tracks associated to the first track in the pair
+    /// \param trks2 filtered table with the tracks associated to the second track in the pair
+    /// \param sameevent true if both tables are the same collision, autocorrelations are then excluded
+    /// \param cmul centrality - multiplicity for the collision being analyzed
+    /// The pair magnitudes factorize in the magnitudes of the single tracks, so the differential
+    /// histograms are built accumulating the products of the singles (eta,phi) bins at their
+    /// \f$\Delta\eta,\;\Delta\phi\f$ bin index difference, \f$\Delta\phi\f$ being cyclic. It reproduces
+    /// the track pair loop without pair suppression nor pT ordering, which need the individual tracks,
+    /// and without the continuous \f$\Delta\eta,\;\Delta\phi\f$ and \f${p_T}_1, {p_T}_2\f$ histograms.
+    template <typename TrackOneListObject, typename TrackTwoListObject>
+    void processBinnedTrackPairs(TrackOneListObject const& trks1, TrackTwoListObject const& trks2, std::vector<float>* corrs1, std::vector<float>* corrs2, std::vector<float>* ptavgs1, std::vector<float>* ptavgs2, bool sameevent, float cmul)
+    {
+      using namespace o2::analysis::dptdptfilter;
+
+      binSingles(trks1, corrs1, ptavgs1, binnedSingles1);
+      if (!sameevent) {
+        binSingles(trks2, corrs2, ptavgs2, binnedSingles2);
+      }
+      const std::vector<BinnedSingles>& singles2 = sameevent ? binnedSingles1 : binnedSingles2;
+
+      const int ndeltabins = (2 * etabins - 1) * phibins;
+      accN2.resize(ndeltabins);
+      accSum2PtPt.resize(ndeltabins);
+      accSum2DptDpt.resize(ndeltabins);
+      for (uint pid1 = 0; pid1 < nch; ++pid1) {
+        for (uint pid2 = 0; pid2 < nch; ++pid2) {
+          const BinnedSingles& s1 = binnedSingles1[pid1];
+          const BinnedSingles& s2 = singles2[pid2];
+          const bool autocorrelations = sameevent && (pid1 == pid2);
+          std::fill(accN2.begin(), accN2.end(), 0.0);
+          std::fill(accSum2PtPt.begin(), accSum2PtPt.end(), 0.0);
+          std::fill(accSum2DptDpt.begin(), accSum2DptDpt.end(), 0.0);
+          for (int bin1 : s1.bins) {
+            const BinnedSinglesContent& c1 = s1.content[bin1];
+            int etaix_1 = bin1 / phibins;
+            int phiix_1 = bin1 % phibins;
+            for (int bin2 : s2.bins) {
+              const BinnedSinglesContent& c2 = s2.content[bin2];
+              int deltaeta_ix = etaix_1 - bin2 / phibins + etabins - 1;
+              int deltaphi_ix = phiix_1 - bin2 % phibins;
+              if (deltaphi_ix < 0) {
+                deltaphi_ix += phibins;
+              }
+              int deltabin = deltaeta_ix * phibins + deltaphi_ix;
+              double n2 = c1.n1 * c2.n1;
+              double sum2PtPt = c1.sum1Pt * c2.sum1Pt;
+              double sum2DptDpt = c1.sum1Dpt * c2.sum1Dpt;
+              if (autocorrelations && bin1 == bin2) {
+                /* exclude autocorrelations */
+                n2 -= c1.n1sq;
+                sum2PtPt -= c1.sum1Ptsq;
+                sum2DptDpt -= c1.sum1Dptsq;
+              }
+              accN2[deltabin] += n2;
+              accSum2PtPt[deltabin] += sum2PtPt;
+              accSum2DptDpt[deltabin] += sum2DptDpt;
+            }
+          }
+
+          double n2 = 0.0;
+          double sum2PtPt = 0.0;
+          double sum2DptDpt = 0.0;
+          for (int deltaeta_ix = 0; deltaeta_ix < 2 * etabins - 1; ++deltaeta_ix) {
+            for (int deltaphi_ix = 0; deltaphi_ix < phibins; ++deltaphi_ix) {
+              int deltabin = deltaeta_ix * phibins + deltaphi_ix;
+              if (accN2[deltabin] == 0.0 && accSum2PtPt[deltabin] == 0.0 && accSum2DptDpt[deltabin] == 0.0) {
+                continue;
+              }
+              int globalbin = fhN2_vsDEtaDPhi[0][0]->GetBin(deltaeta_ix + 1, deltaphi_ix + 1);
+              fhN2_vsDEtaDPhi[pid1][pid2]->AddBinContent(globalbin, accN2[deltabin]);
+              fhSum2DptDpt_vsDEtaDPhi[pid1][pid2]->AddBinContent(globalbin, accSum2DptDpt[deltabin]);
+              fhSum2PtPt_vsDEtaDPhi[pid1][pid2]->AddBinContent(globalbin, accSum2PtPt[deltabin]);
+              n2 += accN2[deltabin];
+              sum2PtPt += accSum2PtPt[deltabin];
+              sum2DptDpt += accSum2DptDpt[deltabin];
+            }
+          }
+          double n2nw = s1.n1nw * s2.n1nw;
+          double sum2PtPtnw = s1.sum1Ptnw * s2.sum1Ptnw;
+          double sum2DptDptnw = s1.sum1Dptnw * s2.sum1Dptnw;
+          if (autocorrelations) {
+            n2nw -= s1.n1nw;
+            sum2PtPtnw -= s1.sum1Ptnwsq;
+            sum2DptDptnw -= s1.sum1Dptnwsq;
+          }
+          fhN2_vsC[pid1][pid2]->Fill(cmul, n2);
+          fhSum2PtPt_vsC[pid1][pid2]->Fill(cmul, sum2PtPt);
+          fhSum2DptDpt_vsC[pid1][pid2]->Fill(cmul, sum2DptDpt);
+          fhN2nw_vsC[pid1][pid2]->Fill(cmul, n2nw);
+          fhSum2PtPtnw_vsC[pid1][pid2]->Fill(cmul, sum2PtPtnw);
+          fhSum2DptDptnw_vsC[pid1][pid2]->Fill(cmul, sum2DptDptnw);
+          /* let's also update the number of entries in the differential histograms */
+          fhN2_vsDEtaDPhi[pid1][pid2]->SetEntries(fhN2_vsDEtaDPhi[pid1][pid2]->GetEntries() + n2);
+          fhSum2DptDpt_vsDEtaDPhi[pid1][pid2]->SetEntries(fhSum2DptDpt_vsDEtaDPhi[pid1][pid2]->GetEntries() + n2);
+          fhSum2PtPt_vsDEtaDPhi[pid1][pid2]->SetEntries(fhSum2PtPt_vsDEtaDPhi[pid1][pid2]->GetEntries() + n2);
+        }
+      }
+    }
+
     template <bool mixed, typename TrackOneListObject, typename TrackTwoListObject>
     void processCollision(TrackOneListObject const& Tracks1, TrackTwoListObject const& Tracks2, float zvtx, float centmult, int bfield)
     {
@@ -440,7 +622,13 @@ struct DptDptCorrelationsTask {
           processTracks(Tracks2, corrs2, centmult);
         }
         /* process pair magnitudes */
-        if constexpr (mixed) {
+        if (binnedpairs) {
+          if constexpr (mixed) {
+            processBinnedTrackPairs(Tracks1, Tracks2, corrs1, corrs2, ptavgs1, ptavgs2, false, centmult);
+          } else {
+            processBinnedTrackPairs(Tracks1, Tracks1, corrs1, corrs1, ptavgs1, ptavgs1, true, centmult);
+          }
+        } else if constexpr (mixed) {
           if (ptorder) {
             processTrackPairs<true>(Tracks1, Tracks2, corrs1, corrs2, ptavgs1, ptavgs2, centmult, bfield);
           } else {
@@ -465,11 +653,25 @@ struct DptDptCorrelationsTask {
       }
     }
 
+    /// \brief adds the histograms of another instance, with the same configuration, and resets them
+    /// \param other the instance to merge, e.g. the instance of a mixing thread
+    void mergeAndReset(DataCollectingEngine& other)
+    {
+      for (int i = 0; i < fHistogramsList->GetEntries(); ++i) {
+        TH1* h = static_cast<TH1*>(fHistogramsList->At(i));
+        TH1* hother = static_cast<TH1*>(other.fHistogramsList->At(i));
+        h->Add(hother);
+        hother->Reset();
+      }
+    }
+
     void init(TList* fOutputList)
     {
       using namespace correlationstask;
       using namespace o2::analysis::dptdptfilter;
 
+      fHistogramsList = fOutputList;
+
       /* create the histograms */
       Bool_t oldstatus = TH1::AddDirectoryStatus();
       TH1::AddDirectory(kFALSE);
@@ -667,6 +869,9 @@ struct DptDptCorrelationsTask {
   DataCollectingEngine<false>** dataCE;
   DataCollectingEngine<true>** dataCE_small;
   DataCollectingEngine<false>** dataCEME;
+  std::vector<std::vector<DataCollectingEngine<false>*>> dataCEMEthreads; ///< the per thread mixed events instances, per centrality/multiplicity range, the first one being dataCEME
+  std::vector<TList*> dataCEMEthreadsLists;                               ///< the histogram lists of the additional per thread instances
+  std::vector<std::function<void(int)>> mixingJobs;                       ///< the mixed collision pairs of the dataframe to process in the mixing threads
 
   /* the input file structure from CCDB */
   TList* ccdblst = nullptr;
@@ -687,6 +892,8 @@ struct DptDptCorrelationsTask {
   Configurable<bool> cfgProcessPairs{"processpairs", false, "Process pairs: false = no, just singles, true = yes, process pairs"};
   Configurable<bool> cfgProcessME{"processmixedevents", false, "Process mixed events: false = no, just same event, true = yes, also process mixed events"};
   Configurable<bool> cfgPtOrder{"ptorder", false, "enforce pT_1 < pT_2. Defalut: false"};
+  Configurable<int> cfgNMixingThreads{"nmixingthreads", 1, "Number of threads processing the mixed collision pairs of a dataframe, each with its own histograms merged at the end of the dataframe. Default: 1"};
+  Configurable<bool> cfgBinnedPairs{"binnedpairs", false, "Build the pair histograms from the (eta,phi) binned singles instead of the track pairs loop. Not compatible with pair cuts and pT ordering, and the continuous and pT vs pT pair histograms are not filled. Default: false"};
   OutputObj<TList> fOutput{"DptDptCorrelationsData", OutputObjHandlingPolicy::AnalysisObject, OutputObjSourceType::OutputObjSource};
 
   void init(InitContext& initContext)
@@ -727,6 +934,7 @@ struct DptDptCorrelationsTask {
     processpairs = cfgProcessPairs.value;
     processmixedevents = cfgProcessME.value;
     ptorder = cfgPtOrder.value;
+    binnedpairs = cfgBinnedPairs.value;
 
     /* self configure the CCDB access to the input file */
     getTaskOptionValue(initContext, "dpt-dpt-filter", "input_ccdburl", cfgCCDBUrl, false);
@@ -884,6 +1092,18 @@ struct DptDptCorrelationsTask {
             LOGF(fatal, "Mixed events cannot be used with the small DCE, please configure properly!!");
           }
           dataCEME[i] = buildCEInstance(range.Data(), true);
+          if (cfgNMixingThreads > 1) {
+            dataCEMEthreads.push_back({dataCEME[i]});
+            for (int ithread = 1; ithread < cfgNMixingThreads; ++ithread) {
+              /* the additional instances histograms are not part of the output */
+              TList* fThreadList = new TList();
+              fThreadList->SetOwner(true);
+              DataCollectingEngine<false>* dce = new DataCollectingEngine<false>();
+              dce->init(fThreadList);
+              dataCEMEthreads[i].push_back(dce);
+              dataCEMEthreadsLists.push_back(fThreadList);
+            }
+          }
         }
       }
       for (int i = 0; i < ncmranges; ++i) {
@@ -904,6 +1124,9 @@ struct DptDptCorrelationsTask {
       fPairCuts.SetTwoTrackCuts(cfgTwoTrackCut, cfgTwoTrackCutMinRadius);
       fUseTwoTrackCut = true;
     }
+    if (processpairs && binnedpairs && (ptorder || fUseConversionCuts || fUseTwoTrackCut)) {
+      LOGF(fatal, "Binned pairs processing cannot be used with pair cuts nor pT ordering, please configure properly!!");
+    }
 
     /* initialize access to the CCDB */
     ccdb->setURL(cfgCCDBUrl);
@@ -1055,6 +1278,18 @@ struct DptDptCorrelationsTask {
     /* locate the data collecting engine for the collision centrality/multiplicity */
     int ixDCE = getDCEindex(collision);
     if (!(ixDCE < 0)) {
+      auto storePtAverages = [&](auto& ptavgs) {
+        dataCEME[ixDCE]->storePtAverages(ptavgs);
+        for (uint ithread = 1; !dataCEMEthreads.empty() && ithread < dataCEMEthreads[ixDCE].size(); ++ithread) {
+          dataCEMEthreads[ixDCE][ithread]->storePtAverages(ptavgs);
+        }
+      };
+      auto storeTrackCorrections = [&](auto& corrs) {
+        dataCEME[ixDCE]->storeTrackCorrections(corrs);
+        for (uint ithread = 1; !dataCEMEthreads.empty() && ithread < dataCEMEthreads[ixDCE].size(); ++ithread) {
+          dataCEMEthreads[ixDCE][ithread]->storeTrackCorrections(corrs);
+        }
+      };
       if (ccdblst != nullptr && !(dataCEME[ixDCE]->isCCDBstored())) {
         if constexpr (gen) {
           std::vector<TH2*> ptavgs{tnames.size(), nullptr};
@@ -1066,7 +1301,7 @@ struct DptDptCorrelationsTask {
                               tnames[isp].c_str())
                 .Data()));
           }
-          dataCEME[ixDCE]->storePtAverages(ptavgs);
+          storePtAverages(ptavgs);
         } else {
           std::vector<TH3*> corrs{tnames.size(), nullptr};
           for (uint isp = 0; isp < tnames.size(); ++isp) {
@@ -1077,7 +1312,7 @@ struct DptDptCorrelationsTask {
                               tnames[isp].c_str())
                 .Data()));
           }
-          dataCEME[ixDCE]->storeTrackCorrections(corrs);
+          storeTrackCorrections(corrs);
           std::vector<TH2*> ptavgs{tnames.size(), nullptr};
           for (uint isp = 0; isp < tnames.size(); ++isp) {
             ptavgs[isp] = reinterpret_cast<TH2*>(ccdblst->FindObject(
@@ -1087,7 +1322,7 @@ struct DptDptCorrelationsTask {
                               tnames[isp].c_str())
                 .Data()));
           }
-          dataCEME[ixDCE]->storePtAverages(ptavgs);
+          storePtAverages(ptavgs);
         }
       }
 
@@ -1109,7 +1344,46 @@ struct DptDptCorrelationsTask {
       if constexpr (!gen) {
         bfield = (fUseConversionCuts || fUseTwoTrackCut) ? getMagneticField(timestamp) : 0;
       }
-      dataCEME[ixDCE]->processCollision<true>(tracks1, tracks2, collision.posZ(), collision.centmult(), bfield);
+      if (dataCEMEthreads.empty()) {
+        dataCEME[ixDCE]->processCollision<true>(tracks1, tracks2, collision.posZ(), collision.centmult(), bfield);
+      } else {
+        /* deferred to the mixing threads */
+        float zvtx = collision.posZ();
+        float centmult = collision.centmult();
+        mixingJobs.emplace_back([this, ixDCE, tracks1, tracks2, zvtx, centmult, bfield](int ithread) {
+          dataCEMEthreads[ixDCE][ithread]->processCollision<true>(tracks1, tracks2, zvtx, centmult, bfield);
+        });
+      }
+    }
+  }
+
+  /// \brief processes the deferred mixed collision pairs of the dataframe in the mixing threads
+  /// Each thread fills its own data collecting engine instances, which are merged afterwards into the output ones
+  void runMixingJobs()
+  {
+    if (mixingJobs.empty()) {
+      return;
+    }
+    int nthreads = std::min(static_cast<int>(cfgNMixingThreads), static_cast<int>(mixingJobs.size()));
+    std::atomic<size_t> nextjob{0};
+    auto worker = [&](int ithread) {
+      for (size_t ijob = nextjob++; ijob < mixingJobs.size(); ijob = nextjob++) {
+        mixingJobs[ijob](ithread);
+      }
+    };
+    std::vector<std::thread> threads;
+    for (int ithread = 1; ithread < nthreads; ++ithread) {
+      threads.emplace_back(worker, ithread);
+    }
+    worker(0);
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    mixingJobs.clear();
+    for (auto& engines : dataCEMEthreads) {
+      for (uint ithread = 1; ithread < engines.size(); ++ithread) {
+        engines[0]->mergeAndReset(*engines[ithread]);
+      }
     }
   }
 
@@ -1235,6 +1509,7 @@ struct DptDptCorrelationsTask {
       }
       processMixed<false>(collision1, tracks1, tracks2, collision1.bc_as<aod::BCsWithTimestamps>().timestamp());
     }
+    runMixingJobs();
   }
   PROCESS_SWITCH(DptDptCorrelationsTask, processRecLevelMixed, "Process reco level mixed events correlations", false);
 
@@ -1287,6 +1562,7 @@ struct DptDptCorrelationsTask {
                           tracks2,
                           collision1.bc_as<aod::BCsWithTimestamps>().timestamp());
     }
+    runMixingJobs();
   }
   PROCESS_SWITCH(DptDptCorrelationsTask,
                  processRecLevelMixedNotStored,
@@ -1316,6 +1592,7 @@ struct DptDptCorrelationsTask {
       }
       processMixed<true>(collision1, tracks1, tracks2);
     }
+    runMixingJobs();
   }
   PROCESS_SWITCH(DptDptCorrelationsTask, processGenLevelMixed, "Process generator level mixed events correlations", false);
 
@@ -1363,6 +1640,7 @@ struct DptDptCorrelationsTask {
       }
       processMixed<true>(collision1, tracks1, tracks2);
     }
+    runMixingJobs();
   }
   PROCESS_SWITCH(DptDptCorrelationsTask,
                  processGenLevelMixedNotStored,
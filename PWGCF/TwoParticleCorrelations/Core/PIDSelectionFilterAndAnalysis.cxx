@@ -199,6 +199,30 @@ PIDSelectionFilterAndAnalysis::~PIDSelectionFilterAndAnalysis()
   }
 }
 
+/// \brief Compiles the TPC and TOF nsigma cuts in a flat program evaluated in one pass
+void PIDSelectionFilterAndAnalysis::Compile()
+{
+  mCompiledCuts.Clear();
+  mCompiledState = -1;
+  int bit = 0;
+  auto addBricks = [&](auto& bricklst, int firstinput) {
+    for (int i = 0; i < kNoOfSpecies; ++i) {
+      if (bricklst[i] != nullptr) {
+        if (not mCompiledCuts.Add(bricklst[i], firstinput + i, bit)) {
+          return false;
+        }
+        bit += bricklst[i]->Length();
+      }
+    }
+    return true;
+  };
+  if (not(addBricks(mCloseNsigmasTPC, 0) and addBricks(mCloseNsigmasTOF, kNoOfSpecies))) {
+    LOGF(info, "PIDSelectionFilterAndAnalysis::Compile(), the cuts cannot be compiled, they will be filtered brick by brick");
+    return;
+  }
+  mCompiledState = 1;
+}
+
 /// \brief Calculates the length of the mask needed to store the selection cuts
 int PIDSelectionFilterAndAnalysis::CalculateMaskLength()
 {
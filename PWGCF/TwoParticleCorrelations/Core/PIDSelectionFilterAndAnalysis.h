@@ -131,6 +131,7 @@ class PIDSelectionFilterAndAnalysis : public SelectionFilterAndAnalysis
   void ConstructCutFromString(const TString&);
   virtual int CalculateMaskLength() override;
   virtual void StoreArmedMask() override;
+  void Compile();
 
   float mPTOF = 0.8f;           ///< the p threshold for cheking TOF information
   bool mRequireTOF = false;     ///< is TOF required
@@ -141,6 +142,9 @@ class PIDSelectionFilterAndAnalysis : public SelectionFilterAndAnalysis
   std::vector<CutBrick<float>*> mCloseNsigmasTOF;
   std::vector<CutBrick<float>*> mBayesProbability;
 
+  CompiledCutProgram mCompiledCuts; //! the nsigma cuts in flat form, the inputs being the TPC then the TOF nsigmas per species
+  int mCompiledState = 0;           //! 0 not compiled yet, 1 compiled, -1 some brick cannot be compiled
+
   ClassDef(PIDSelectionFilterAndAnalysis, 1);
 };
 
@@ -152,6 +156,19 @@ inline uint64_t PIDSelectionFilterAndAnalysis::Filter(TrackToFilter const& track
   mSelectedMask = 0UL;
   int bit = 0;
 
+#ifndef INCORPORATEBAYESIANPID
+  if (mCompiledState == 0) {
+    Compile();
+  }
+  if (mCompiledState > 0) {
+    float inputs[2 * kNoOfSpecies] = {track.tpcNSigmaEl(), track.tpcNSigmaMu(), track.tpcNSigmaPi(), track.tpcNSigmaKa(), track.tpcNSigmaPr(),
+                                      track.tofNSigmaEl(), track.tofNSigmaMu(), track.tofNSigmaPi(), track.tofNSigmaKa(), track.tofNSigmaPr()};
+    mCompiledCuts.Evaluate(inputs, selectedMask);
+    mSelectedMask = selectedMask;
+    return mSelectedMask;
+  }
+#endif
+
   auto filterBrickValue = [&](auto brick, auto value) {
     if (brick != nullptr) {
       std::vector<bool> res = brick->Filter(value);
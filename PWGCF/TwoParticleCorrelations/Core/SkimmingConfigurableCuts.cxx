@@ -1035,6 +1035,24 @@ int CutWithVariations<TValueToFilter>::getArmedIndex()
   return index;
 }
 
+/// Appends the predicates of the default and of the variation bricks, in the order of the Filter results
+/// \returns false if any of the bricks cannot be compiled
+template <typename TValueToFilter>
+bool CutWithVariations<TValueToFilter>::Compile(std::vector<CutPredicate>& predicates)
+{
+  for (int i = 0; i < mDefaultBricks.GetEntries(); ++i) {
+    if (not((CutBrick<TValueToFilter>*)mDefaultBricks.At(i))->Compile(predicates)) {
+      return false;
+    }
+  }
+  for (int i = 0; i < mVariationBricks.GetEntries(); ++i) {
+    if (not((CutBrick<TValueToFilter>*)mVariationBricks.At(i))->Compile(predicates)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 templateClassImp(o2::analysis::CutWithVariations);
 template class o2::analysis::PWGCF::CutWithVariations<float>;
 template class o2::analysis::PWGCF::CutWithVariations<int>;
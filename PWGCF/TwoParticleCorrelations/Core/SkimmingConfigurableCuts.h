@@ -32,6 +32,38 @@ namespace analysis
 {
 namespace PWGCF
 {
+/// \struct CutPredicate
+/// \brief Elementary comparison of a value, the compiled form of a brick component
+/// The values and limits are taken as float, exact for the integer values the bricks filter
+struct CutPredicate {
+  enum Operation : uint8_t {
+    kBELOW,          ///< value < up
+    kABOVE,          ///< low < value
+    kINSIDE,         ///< low < value < up
+    kOUTSIDE,        ///< value < low or up < value
+    kINSIDELOWCLOSED ///< low <= value < up
+  };
+  Operation mOperation = kBELOW;
+  float mLow = 0.0f;
+  float mUp = 0.0f;
+
+  bool Evaluate(float value) const
+  {
+    switch (mOperation) {
+      case kBELOW:
+        return value < mUp;
+      case kABOVE:
+        return mLow < value;
+      case kINSIDE:
+        return (mLow < value) and (value < mUp);
+      case kOUTSIDE:
+        return (value < mLow) or (mUp < value);
+      default:
+        return (mLow <= value) and (value < mUp);
+    }
+  }
+};
+
 /// \class CutBrick
 /// \brief Virtual class which implements the base component of the selection cuts
 ///
@@ -64,6 +96,9 @@ class CutBrick : public TNamed
   /// Virtual function. Return the index of the armed brick within this brick
   /// \returns The index of the armed brick within this brick. Default -1
   virtual int getArmedIndex() { return -1; }
+  /// Virtual function. Appends the predicates equivalent to the brick components, in the order of the Filter results
+  /// \returns false if the brick cannot be compiled, e.g. with function based limits. Default false
+  virtual bool Compile(std::vector<CutPredicate>&) { return false; }
 
   static CutBrick<TValueToFilter>* constructBrick(const char* name, const char* regex, const std::set<std::string>& allowed);
   static const char* mgImplementedbricks[];
@@ -114,6 +149,11 @@ class CutBrickLimit : public CutBrick<TValueToFilter>
   virtual std::vector<bool> IsArmed() override;
   virtual std::vector<bool> Filter(const TValueToFilter&) override;
   virtual int Length() override { return 1; }
+  virtual bool Compile(std::vector<CutPredicate>& predicates) override
+  {
+    predicates.push_back({CutPredicate::kBELOW, 0.0f, float(mLimit)});
+    return true;
+  }
 
  private:
   void ConstructCutFromString(const TString&);
@@ -160,6 +200,8 @@ class CutBrickFnLimit : public CutBrickLimit<TValueToFilter>
   {
     this->mLimit = TValueToFilter(mFunction.Eval(x));
   }
+  /// the limits change with the independent variable, the brick is not compiled
+  virtual bool Compile(std::vector<CutPredicate>&) override { return false; }
 
  private:
   void ConstructCutFromString(const TString&);
@@ -185,6 +227,11 @@ class CutBrickThreshold : public CutBrick<TValueToFilter>
   virtual std::vector<bool> IsArmed() override;
   virtual std::vector<bool> Filter(const TValueToFilter&) override;
   virtual int Length() override { return 1; }
+  virtual bool Compile(std::vector<CutPredicate>& predicates) override
+  {
+    predicates.push_back({CutPredicate::kABOVE, float(mThreshold), 0.0f});
+    return true;
+  }
 
  private:
   void ConstructCutFromString(const TString&);
@@ -231,6 +278,8 @@ class CutBrickFnThreshold : public CutBrickThreshold<TValueToFilter>
   {
     this->mThreshold = TValueToFilter(mFunction.Eval(x));
   }
+  /// the limits change with the independent variable, the brick is not compiled
+  virtual bool Compile(std::vector<CutPredicate>&) override { return false; }
 
  private:
   void ConstructCutFromString(const TString&);
@@ -256,6 +305,11 @@ class CutBrickRange : public CutBrick<TValueToFilter>
   virtual std::vector<bool> IsArmed() override;
   virtual std::vector<bool> Filter(const TValueToFilter&) override;
   virtual int Length() override { return 1; }
+  virtual bool Compile(std::vector<CutPredicate>& predicates) override
+  {
+    predicates.push_back({CutPredicate::kINSIDE, float(mLow), float(mUp)});
+    return true;
+  }
 
  private:
   void ConstructCutFromString(const TString&);
@@ -304,6 +358,8 @@ class CutBrickFnRange : public CutBrickRange<TValueToFilter>
     this->mLow = TValueToFilter(mLowFunction.Eval(x));
     this->mUp = TValueToFilter(mUpFunction.Eval(x));
   }
+  /// the limits change with the independent variable, the brick is not compiled
+  virtual bool Compile(std::vector<CutPredicate>&) override { return false; }
 
  private:
   void ConstructCutFromString(const TString&);
@@ -330,6 +386,11 @@ class CutBrickExtToRange : public CutBrick<TValueToFilter>
   virtual std::vector<bool> IsArmed() override;
   virtual std::vector<bool> Filter(const TValueToFilter&) override;
   virtual int Length() override { return 1; }
+  virtual bool Compile(std::vector<CutPredicate>& predicates) override
+  {
+    predicates.push_back({CutPredicate::kOUTSIDE, float(mLow), float(mUp)});
+    return true;
+  }
 
  private:
   void ConstructCutFromString(const TString&);
@@ -378,6 +439,8 @@ class CutBrickFnExtToRange : public CutBrickExtToRange<TValueToFilter>
     this->mLow = TValueToFilter(mLowFunction.Eval(x));
     this->mUp = TValueToFilter(mUpFunction.Eval(x));
   }
+  /// the limits change with the independent variable, the brick is not compiled
+  virtual bool Compile(std::vector<CutPredicate>&) override { return false; }
 
  private:
   void ConstructCutFromString(const TString&);
@@ -409,6 +472,13 @@ class CutBrickSelectorMultipleRanges : public CutBrick<TValueToFilter>
   /// The length is in brick units. The actual length is implementation dependent
   /// \returns Brick length in units of bricks
   virtual int Length() override { return mActive.size(); }
+  virtual bool Compile(std::vector<CutPredicate>& predicates) override
+  {
+    for (unsigned int i = 0; i < mActive.size(); ++i) {
+      predicates.push_back({CutPredicate::kINSIDELOWCLOSED, float(mEdges[i]), float(mEdges[i + 1])});
+    }
+    return true;
+  }
 
  private:
   void ConstructCutFromString(const TString&);
@@ -441,6 +511,7 @@ class CutWithVariations : public CutBrick<TValueToFilter>
   virtual std::vector<bool> Filter(const TValueToFilter&) override;
   virtual int Length() override;
   virtual int getArmedIndex() override;
+  virtual bool Compile(std::vector<CutPredicate>& predicates) override;
 
  private:
   void ConstructCutFromString(const TString&);
@@ -451,6 +522,76 @@ class CutWithVariations : public CutBrick<TValueToFilter>
   ClassDef(CutWithVariations, 1);
 };
 
+/// \class CompiledCutProgram
+/// \brief Flat form of the value cut bricks of a selection, evaluated in one pass without virtual calls
+/// Each brick component is a predicate on one of the input values which sets one bit of the mask, the bits
+/// being assigned in the order of the brick Filter results. The components of the gate bricks do not set
+/// bits, the selection is rejected if none of the components of a gate brick passes.
+class CompiledCutProgram
+{
+ public:
+  /// Appends the components of a brick filtering the input value input, setting the mask bits from bit on
+  /// \returns false if the brick cannot be compiled
+  template <typename TValueToFilter>
+  bool Add(CutBrick<TValueToFilter>* brick, int input, int bit)
+  {
+    size_t first = mPredicates.size();
+    if (not brick->Compile(mPredicates)) {
+      return false;
+    }
+    for (size_t i = first; i < mPredicates.size(); ++i) {
+      mInputs.push_back(input);
+      mTargets.push_back(bit++);
+    }
+    return true;
+  }
+  /// Appends the components of a gate brick filtering the input value input
+  /// \returns false if the brick cannot be compiled
+  template <typename TValueToFilter>
+  bool AddGate(CutBrick<TValueToFilter>* brick, int input)
+  {
+    size_t first = mPredicates.size();
+    if (mNGates == 32 or not brick->Compile(mPredicates)) {
+      return false;
+    }
+    for (size_t i = first; i < mPredicates.size(); ++i) {
+      mInputs.push_back(input);
+      mTargets.push_back(-1 - mNGates);
+    }
+    mNGates++;
+    return true;
+  }
+  void Clear()
+  {
+    mPredicates.clear();
+    mInputs.clear();
+    mTargets.clear();
+    mNGates = 0;
+  }
+  /// Evaluates all the predicates on the input values
+  /// \param mask the mask with the bits of the passing components set
+  /// \returns false if any gate rejects the selection
+  bool Evaluate(const float* inputs, uint64_t& mask) const
+  {
+    uint32_t gates = 0;
+    for (size_t i = 0; i < mPredicates.size(); ++i) {
+      const uint64_t pass = mPredicates[i].Evaluate(inputs[mInputs[i]]);
+      if (mTargets[i] >= 0) {
+        mask |= pass << mTargets[i];
+      } else {
+        gates |= uint32_t(pass) << (-1 - mTargets[i]);
+      }
+    }
+    return gates == ((mNGates == 32) ? 0xFFFFFFFFu : ((1u << mNGates) - 1u));
+  }
+
+ private:
+  std::vector<CutPredicate> mPredicates; ///< the brick components
+  std::vector<int> mInputs;              ///< the input value of each component
+  std::vector<int> mTargets;             ///< the mask bit of each component, or -1 - gate index for the gate components
+  int mNGates = 0;                       ///< the number of gate bricks
+};
+
 /// \class SpecialCutBrick
 /// \brief Virtual class which implements the base component of the special selection cuts
 /// Special selection cuts are needed because the tables access seems cannot be
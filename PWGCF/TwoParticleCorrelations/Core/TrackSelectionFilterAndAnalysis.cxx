@@ -251,6 +251,47 @@ int TrackSelectionFilterAndAnalysis::CalculateMaskLength()
   return length;
 }
 
+/// \brief Compiles the value cuts in a flat program evaluated in one pass
+/// The track types are still filtered by their bricks, their bits follow the charge sign ones
+void TrackSelectionFilterAndAnalysis::Compile()
+{
+  mCompiledCuts.Clear();
+  mCompiledState = -1;
+  int bit = 0;
+  auto addBrick = [&](auto brick, int input) {
+    if (brick == nullptr) {
+      return true;
+    }
+    bool compiled = mCompiledCuts.Add(brick, input, bit);
+    bit += brick->Length();
+    return compiled;
+  };
+  for (int i = 0; i < mTrackSign.GetEntries(); ++i) {
+    if (not addBrick((CutBrick<float>*)mTrackSign.At(i), kInSign)) {
+      return;
+    }
+  }
+  mTrackTypesFirstBit = bit;
+  bit += mTrackTypes.GetEntries();
+  if (not(addBrick(mNClustersTPC, kInNClustersTPC) and
+          addBrick(mNCrossedRowsTPC, kInNCrossedRowsTPC) and
+          addBrick(mNClustersITS, kInNClustersITS) and
+          addBrick(mMaxChi2PerClusterTPC, kInMaxChi2PerClusterTPC) and
+          addBrick(mMaxChi2PerClusterITS, kInMaxChi2PerClusterITS) and
+          addBrick(mMinNCrossedRowsOverFindableClustersTPC, kInMinNCrossedRowsOverFindableClustersTPC) and
+          addBrick(mMaxDcaXY, kInDcaXY) and
+          addBrick(mMaxDcaZ, kInDcaZ))) {
+    LOGF(info, "TrackSelectionFilterAndAnalysis::Compile(), the cuts cannot be compiled, they will be filtered brick by brick");
+    return;
+  }
+  if ((mPtRange != nullptr and not mCompiledCuts.AddGate(mPtRange, kInPt)) or
+      (mEtaRange != nullptr and not mCompiledCuts.AddGate(mEtaRange, kInEta))) {
+    LOGF(info, "TrackSelectionFilterAndAnalysis::Compile(), the kinematic ranges cannot be compiled, the cuts will be filtered brick by brick");
+    return;
+  }
+  mCompiledState = 1;
+}
+
 void TrackSelectionFilterAndAnalysis::SetPtRange(const TString& regex)
 {
   if (mPtRange != nullptr) {
@@ -258,6 +299,7 @@ void TrackSelectionFilterAndAnalysis::SetPtRange(const TString& regex)
   }
   mPtRange = CutBrick<float>::constructBrick("pT", regex.Data(), std::set<std::string>{"rg", "th", "lim", "xrg"});
   mMaskLength = CalculateMaskLength();
+  mCompiledState = 0;
 }
 
 void TrackSelectionFilterAndAnalysis::SetEtaRange(const TString& regex)
@@ -267,6 +309,7 @@ void TrackSelectionFilterAndAnalysis::SetEtaRange(const TString& regex)
   }
   mEtaRange = CutBrick<float>::constructBrick("eta", regex.Data(), std::set<std::string>{"rg", "th", "lim", "xrg"});
   mMaskLength = CalculateMaskLength();
+  mCompiledState = 0;
 }
 
 void TrackSelectionFilterAndAnalysis::ConstructCutFromString(const TString& cutstr)
@@ -107,6 +107,24 @@ class TrackSelectionFilterAndAnalysis : public SelectionFilterAndAnalysis
   void ConstructCutFromString(const TString&);
   int CalculateMaskLength();
   void StoreArmedMask();
+  void Compile();
+
+  /// \enum CompiledInputs
+  /// \brief The track values filtered by the compiled cuts
+  enum CompiledInputs {
+    kInSign = 0,
+    kInNClustersTPC,
+    kInNCrossedRowsTPC,
+    kInNClustersITS,
+    kInMaxChi2PerClusterTPC,
+    kInMaxChi2PerClusterITS,
+    kInMinNCrossedRowsOverFindableClustersTPC,
+    kInDcaXY,
+    kInDcaZ,
+    kInPt,
+    kInEta,
+    kNCompiledInputs
+  };
 
   TList mTrackSign;                                         /// the track charge sign list
   TList mTrackTypes;                                        /// the track types to select list
@@ -121,6 +139,10 @@ class TrackSelectionFilterAndAnalysis : public SelectionFilterAndAnalysis
   CutBrick<float>* mPtRange;                                //! the pT range cuts
   CutBrick<float>* mEtaRange;                               //! the eta range cuts
 
+  CompiledCutProgram mCompiledCuts; //! the value cuts in flat form
+  int mTrackTypesFirstBit = 0;      //! the first mask bit of the track types, not part of the compiled cuts
+  int mCompiledState = 0;           //! 0 not compiled yet, 1 compiled, -1 some brick cannot be compiled
+
   ClassDef(TrackSelectionFilterAndAnalysis, 1)
 };
 
@@ -131,6 +153,27 @@ uint64_t TrackSelectionFilterAndAnalysis::Filter(TrackToFilter const& track)
   uint64_t selectedMask = 0UL;
   int bit = 0;
 
+  if (mCompiledState == 0) {
+    Compile();
+  }
+  if (mCompiledState > 0) {
+    float inputs[kNCompiledInputs] = {float(track.sign()), float(track.tpcNClsFound()), float(track.tpcNClsCrossedRows()), float(track.itsNCls()),
+                                      track.tpcChi2NCl(), track.itsChi2NCl(), track.tpcCrossedRowsOverFindableCls(),
+                                      track.dcaXY(), track.dcaZ(), track.pt(), track.eta()};
+    if (mCompiledCuts.Evaluate(inputs, selectedMask)) {
+      bit = mTrackTypesFirstBit;
+      for (int i = 0; i < mTrackTypes.GetEntries(); ++i) {
+        if (((TrackSelectionBrick*)mTrackTypes.At(i))->Filter(track)) {
+          SETBIT(selectedMask, bit);
+        }
+        bit++;
+      }
+    } else {
+      selectedMask = 0UL;
+    }
+    return mSelectedMask = selectedMask;
+  }
+
   auto filterTrackType = [&](TrackSelectionBrick* ttype, auto trk) {
     if (ttype->Filter(trk)) {
       SETBIT(selectedMask, bit);
@@ -194,7 +237,7 @@ uint64_t TrackSelectionFilterAndAnalysis::Filter(TrackToFilter const& track)
     }
   }
   if (mEtaRange != nullptr) {
-    if (not filterBrickValueNoMask(mEtaRange, track.pt())) {
+    if (not filterBrickValueNoMask(mEtaRange, track.eta())) {
       selectedMask = 0UL;
     }
   }
@@ -0,0 +1,186 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#include "PWGDQ/Core/AnalysisCompiledCuts.h"
+
+#include <algorithm>
+
+//____________________________________________________________________________
+int AnalysisCompiledCuts::AddCut(const AnalysisCut& cut)
+{
+  //
+  // add a simple cut
+  //
+  if (GetNCuts() >= kMaxCuts) {
+    return -1;
+  }
+  fRoots.push_back(CompileCut(cut));
+  return fRoots.size() - 1;
+}
+
+//____________________________________________________________________________
+int AnalysisCompiledCuts::AddCut(const AnalysisCompositeCut& cut)
+{
+  //
+  // add a composite cut
+  //
+  if (GetNCuts() >= kMaxCuts) {
+    return -1;
+  }
+  fRoots.push_back(CompileCompositeCut(cut));
+  return fRoots.size() - 1;
+}
+
+//____________________________________________________________________________
+void AnalysisCompiledCuts::Clear()
+{
+  fPredicates.clear();
+  fNodes.clear();
+  fOperands.clear();
+  fRoots.clear();
+  fPredicateResults.clear();
+  fNodeResults.clear();
+}
+
+//____________________________________________________________________________
+bool AnalysisCompiledCuts::HasFunctions() const
+{
+  return std::any_of(fPredicates.begin(), fPredicates.end(), [](const AnalysisCut::CutContainer& cut) { return cut.fFuncLow || cut.fFuncHigh; });
+}
+
+//____________________________________________________________________________
+int AnalysisCompiledCuts::AddPredicate(const AnalysisCut::CutContainer& cut)
+{
+  //
+  // add a predicate, or reuse an identical one already added by another cut
+  //
+  auto same = [&cut](const AnalysisCut::CutContainer& other) {
+    return cut.fVar == other.fVar && cut.fLow == other.fLow && cut.fHigh == other.fHigh && cut.fExclude == other.fExclude &&
+           cut.fDepVar == other.fDepVar && cut.fDepLow == other.fDepLow && cut.fDepHigh == other.fDepHigh && cut.fDepExclude == other.fDepExclude &&
+           cut.fDepVar2 == other.fDepVar2 && cut.fDep2Low == other.fDep2Low && cut.fDep2High == other.fDep2High && cut.fDep2Exclude == other.fDep2Exclude &&
+           cut.fFuncLow == other.fFuncLow && cut.fFuncHigh == other.fFuncHigh;
+  };
+  auto it = std::find_if(fPredicates.begin(), fPredicates.end(), same);
+  if (it != fPredicates.end()) {
+    return it - fPredicates.begin();
+  }
+  fPredicates.push_back(cut);
+  fPredicateResults.push_back(0);
+  return fPredicates.size() - 1;
+}
+
+//____________________________________________________________________________
+int AnalysisCompiledCuts::AddNode(const Node& node, const std::vector<int>& operands)
+{
+  //
+  // add a node, or reuse an identical one already added by another cut
+  //
+  for (std::size_t i = 0; i < fNodes.size(); ++i) {
+    const Node& other = fNodes[i];
+    if (other.fIsLeaf == node.fIsLeaf && other.fUseAND == node.fUseAND && other.fNOperands == static_cast<int>(operands.size()) &&
+        std::equal(operands.begin(), operands.end(), fOperands.begin() + other.fFirst)) {
+      return i;
+    }
+  }
+  Node newNode = node;
+  newNode.fFirst = fOperands.size();
+  newNode.fNOperands = operands.size();
+  fOperands.insert(fOperands.end(), operands.begin(), operands.end());
+  fNodes.push_back(newNode);
+  fNodeResults.push_back(0);
+  return fNodes.size() - 1;
+}
+
+//____________________________________________________________________________
+int AnalysisCompiledCuts::CompileCut(const AnalysisCut& cut)
+{
+  //
+  // a simple cut is the AND of its predicates
+  //
+  std::vector<int> operands;
+  for (const auto& container : cut.fCuts) {
+    operands.push_back(AddPredicate(container));
+  }
+  return AddNode({true, true, 0, 0}, operands);
+}
+
+//____________________________________________________________________________
+int AnalysisCompiledCuts::CompileCompositeCut(const AnalysisCompositeCut& cut)
+{
+  //
+  // a composite cut is the AND/OR of its cuts and composite cuts, compiled first so that they come before it
+  //
+  std::vector<int> operands;
+  for (const auto& subCut : cut.fCutList) {
+    operands.push_back(CompileCut(subCut));
+  }
+  for (const auto& subCut : cut.fCompositeCutList) {
+    operands.push_back(CompileCompositeCut(subCut));
+  }
+  return AddNode({false, cut.GetUseAND(), 0, 0}, operands);
+}
+
+//____________________________________________________________________________
+bool AnalysisCompiledCuts::EvaluatePredicate(const AnalysisCut::CutContainer& cut, const float* values)
+{
+  //
+  // same decision as for a single cut in AnalysisCut::IsSelected(); a cut whose dependent variables are not in range is passed
+  //
+  if (cut.fDepVar != -1) {
+    bool inRange = (values[cut.fDepVar] > cut.fDepLow && values[cut.fDepVar] <= cut.fDepHigh);
+    if (inRange == cut.fDepExclude) {
+      return true;
+    }
+  }
+  if (cut.fDepVar2 != -1) {
+    bool inRange = (values[cut.fDepVar2] > cut.fDep2Low && values[cut.fDepVar2] <= cut.fDep2High);
+    if (inRange == cut.fDep2Exclude) {
+      return true;
+    }
+  }
+  float cutLow = cut.fFuncLow ? cut.fFuncLow->Eval(values[cut.fDepVar]) : cut.fLow;
+  float cutHigh = cut.fFuncHigh ? cut.fFuncHigh->Eval(values[cut.fDepVar]) : cut.fHigh;
+  bool inRange = (values[cut.fVar] >= cutLow && values[cut.fVar] <= cutHigh);
+  return inRange != cut.fExclude;
+}
+
+//____________________________________________________________________________
+uint64_t AnalysisCompiledCuts::Evaluate(const float* values)
+{
+  //
+  // evaluate all the predicates in one pass, then the nodes in order and return the decisions of the added cuts
+  //
+  for (std::size_t i = 0; i < fPredicates.size(); ++i) {
+    fPredicateResults[i] = EvaluatePredicate(fPredicates[i], values);
+  }
+
+  for (std::size_t i = 0; i < fNodes.size(); ++i) {
+    const Node& node = fNodes[i];
+    const int* operand = fOperands.data() + node.fFirst;
+    const char* results = node.fIsLeaf ? fPredicateResults.data() : fNodeResults.data();
+    bool decision = node.fUseAND;
+    for (int j = 0; j < node.fNOperands; ++j) {
+      if (static_cast<bool>(results[operand[j]]) != node.fUseAND) { // a failed operand for AND, a passed one for OR
+        decision = !node.fUseAND;
+        break;
+      }
+    }
+    fNodeResults[i] = decision;
+  }
+
+  uint64_t decisions = 0;
+  for (std::size_t i = 0; i < fRoots.size(); ++i) {
+    if (fNodeResults[fRoots[i]]) {
+      decisions |= (uint64_t(1) << i);
+    }
+  }
+  return decisions;
+}
@@ -0,0 +1,80 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+//
+// Contact: iarsene@cern.ch, i.c.arsene@fys.uio.no
+//
+// Flattened evaluation of a set of analysis cuts.
+// The cut trees are compiled into a table of unique range predicates, evaluated all at once,
+//   and a list of AND/OR nodes ordered such that each node comes after its operands.
+// The decisions of all the cut sets are returned as a bit map, with the bit i holding the decision of the i-th added cut.
+//
+
+#ifndef AnalysisCompiledCuts_H
+#define AnalysisCompiledCuts_H
+
+#include <cstdint>
+#include <vector>
+
+#include "PWGDQ/Core/AnalysisCut.h"
+#include "PWGDQ/Core/AnalysisCompositeCut.h"
+
+//_________________________________________________________________________
+class AnalysisCompiledCuts
+{
+ public:
+  AnalysisCompiledCuts() = default;
+  ~AnalysisCompiledCuts() = default;
+
+  static constexpr int kMaxCuts = 64;
+
+  // Add a (composite) cut, returns its bit in the decision map or -1 if the maximum number of cuts is reached
+  int AddCut(const AnalysisCut& cut);
+  int AddCut(const AnalysisCompositeCut& cut);
+  template <typename T>
+  void AddCuts(const std::vector<T>& cuts)
+  {
+    for (const auto& cut : cuts) {
+      AddCut(cut);
+    }
+  }
+
+  int GetNCuts() const { return fRoots.size(); }
+  int GetNPredicates() const { return fPredicates.size(); }
+  bool HasFunctions() const; // true if any cut limit is given by a TF1
+  void Clear();
+
+  // Evaluate all added cuts on the values array
+  uint64_t Evaluate(const float* values);
+
+ private:
+  struct Node {
+    bool fIsLeaf;   // true: AND of predicates; false: AND/OR of other nodes
+    bool fUseAND;   // AND (true) or OR (false) of the operands
+    int fFirst;     // index of the first operand in fOperands
+    int fNOperands; // number of operands
+  };
+
+  int AddPredicate(const AnalysisCut::CutContainer& cut);
+  int AddNode(const Node& node, const std::vector<int>& operands);
+  int CompileCut(const AnalysisCut& cut);
+  int CompileCompositeCut(const AnalysisCompositeCut& cut);
+  static bool EvaluatePredicate(const AnalysisCut::CutContainer& cut, const float* values);
+
+  std::vector<AnalysisCut::CutContainer> fPredicates; // unique predicates of all the cuts
+  std::vector<Node> fNodes;                           // nodes, each one after its operands
+  std::vector<int> fOperands;                         // operands of the nodes, indices in either fPredicates or fNodes
+  std::vector<int> fRoots;                            // node of each added cut
+
+  std::vector<char> fPredicateResults; // predicate decisions for the current values
+  std::vector<char> fNodeResults;      // node decisions for the current values
+};
+
+#endif
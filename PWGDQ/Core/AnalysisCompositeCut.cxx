@@ -68,3 +68,22 @@ bool AnalysisCompositeCut::IsSelected(float* values)
     return false;
   }
 }
+
+//____________________________________________________________________________
+bool AnalysisCompositeCut::UsesAnyVar(const std::vector<bool>& vars) const
+{
+  //
+  // check whether any of the cuts uses a flagged variable
+  //
+  for (const auto& cut : fCutList) {
+    if (cut.UsesAnyVar(vars)) {
+      return true;
+    }
+  }
+  for (const auto& cut : fCompositeCutList) {
+    if (cut.UsesAnyVar(vars)) {
+      return true;
+    }
+  }
+  return false;
+}
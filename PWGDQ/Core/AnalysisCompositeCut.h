@@ -43,12 +43,15 @@ class AnalysisCompositeCut : public AnalysisCut
   int GetNCuts() const { return fCutList.size() + fCompositeCutList.size(); }
 
   bool IsSelected(float* values) override;
+  bool UsesAnyVar(const std::vector<bool>& vars) const override;
 
  protected:
   bool fOptionUseAND;                                  // true (default): apply AND on all cuts; false: use OR
   std::vector<AnalysisCut> fCutList;                   // list of cuts
   std::vector<AnalysisCompositeCut> fCompositeCutList; // list of composite cuts
 
+  friend class AnalysisCompiledCuts;
+
   ClassDef(AnalysisCompositeCut, 2);
 };
 
@@ -39,3 +39,18 @@ AnalysisCut& AnalysisCut::operator=(const AnalysisCut& c)
 
 //____________________________________________________________________________
 AnalysisCut::~AnalysisCut() = default;
+
+//____________________________________________________________________________
+bool AnalysisCut::UsesAnyVar(const std::vector<bool>& vars) const
+{
+  //
+  // check whether any of the variables used by the cuts is flagged
+  //
+  auto isFlagged = [&vars](short var) { return var >= 0 && var < static_cast<int>(vars.size()) && vars[var]; };
+  for (const auto& cut : fCuts) {
+    if (isFlagged(cut.fVar) || isFlagged(cut.fDepVar) || isFlagged(cut.fDepVar2)) {
+      return true;
+    }
+  }
+  return false;
+}
@@ -39,6 +39,8 @@ class AnalysisCut : public TNamed
               int dependentVar2 = -1, float depCut2Low = 0., float depCut2High = 0., bool depCut2Exclude = false);
 
   virtual bool IsSelected(float* values);
+  // true if the decision depends on any of the flagged variables (cut or dependent variables)
+  virtual bool UsesAnyVar(const std::vector<bool>& vars) const;
 
   static std::vector<int> fgUsedVars; //! vector of used variables
 
@@ -65,6 +67,8 @@ class AnalysisCut : public TNamed
  protected:
   std::vector<CutContainer> fCuts;
 
+  friend class AnalysisCompiledCuts;
+
   ClassDef(AnalysisCut, 1);
 };
 
@@ -0,0 +1,204 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#include "PWGDQ/Core/DileptonExport.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+
+#include "Framework/Logger.h"
+
+namespace
+{
+constexpr char kExportMagic[8] = "DQDLEXP";
+constexpr uint64_t kBlockAlignment = 8;
+} // namespace
+
+//_________________________________________________________________________
+DileptonExportWriter::~DileptonExportWriter()
+{
+  Close();
+}
+
+//_________________________________________________________________________
+void DileptonExportWriter::SetOutput(const char* directory, const char* prefix)
+{
+  fDirectory = directory;
+  fPrefix = prefix;
+}
+
+//_________________________________________________________________________
+void DileptonExportWriter::SetRunNumber(int run)
+{
+  if (run == fRunNumber && IsOpen()) {
+    return;
+  }
+  Close();
+  fRunNumber = run;
+  std::string filename = fDirectory + "/" + fPrefix + "_" + std::to_string(run) + ".dqdl";
+  fFile.open(filename, std::ios::binary | std::ios::trunc);
+  if (!fFile.is_open()) {
+    LOGP(error, "DileptonExportWriter: cannot open {}, the pairs of run {} are not exported", filename, run);
+    return;
+  }
+  DileptonExportHeader header{};
+  std::memcpy(header.fMagic, kExportMagic, sizeof(header.fMagic));
+  header.fVersion = kVersion;
+  header.fRunNumber = run;
+  fFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  LOGP(info, "DileptonExportWriter: exporting the pairs of run {} to {}", run, filename);
+}
+
+//_________________________________________________________________________
+void DileptonExportWriter::AddPair(float mass, float pt, float rapidity, int sign, uint32_t cutMask, uint32_t mcFlag, float weight)
+{
+  if (!IsOpen()) {
+    return;
+  }
+  fMass.push_back(mass);
+  fPt.push_back(pt);
+  fRapidity.push_back(rapidity);
+  fWeight.push_back(weight);
+  fCutMask.push_back(cutMask);
+  fMCFlag.push_back(mcFlag);
+  fSign.push_back(static_cast<int8_t>(sign));
+  if (static_cast<int>(fMass.size()) >= fBlockSize) {
+    WriteBlock();
+  }
+}
+
+//_________________________________________________________________________
+void DileptonExportWriter::WriteBlock()
+{
+  //
+  // write the columns of the current block, padded such that the next block is aligned
+  //
+  uint32_t n = fMass.size();
+  if (n == 0) {
+    return;
+  }
+  fIndex.push_back({static_cast<uint64_t>(fFile.tellp()), n, 0});
+  auto writeColumn = [this](const auto& column) {
+    fFile.write(reinterpret_cast<const char*>(column.data()), column.size() * sizeof(column[0]));
+  };
+  writeColumn(fMass);
+  writeColumn(fPt);
+  writeColumn(fRapidity);
+  writeColumn(fWeight);
+  writeColumn(fCutMask);
+  writeColumn(fMCFlag);
+  writeColumn(fSign);
+  const char padding[kBlockAlignment] = {0};
+  fFile.write(padding, (kBlockAlignment - n % kBlockAlignment) % kBlockAlignment);
+  fNPairs += n;
+
+  fMass.clear();
+  fPt.clear();
+  fRapidity.clear();
+  fWeight.clear();
+  fCutMask.clear();
+  fMCFlag.clear();
+  fSign.clear();
+}
+
+//_________________________________________________________________________
+void DileptonExportWriter::Close()
+{
+  if (!IsOpen()) {
+    return;
+  }
+  WriteBlock();
+  fFile.write(reinterpret_cast<const char*>(fIndex.data()), fIndex.size() * sizeof(DileptonExportBlock));
+  DileptonExportTrailer trailer{};
+  trailer.fNBlocks = fIndex.size();
+  trailer.fNPairs = fNPairs;
+  std::memcpy(trailer.fMagic, kExportMagic, sizeof(trailer.fMagic));
+  fFile.write(reinterpret_cast<const char*>(&trailer), sizeof(trailer));
+  fFile.close();
+  LOGP(info, "DileptonExportWriter: {} pairs exported for run {}", fNPairs, fRunNumber);
+  fIndex.clear();
+  fNPairs = 0;
+}
+
+//_________________________________________________________________________
+bool DileptonExportReader::Open(const char* filename)
+{
+  Close();
+  int fd = open(filename, O_RDONLY);
+  if (fd < 0) {
+    LOGP(error, "DileptonExportReader: cannot open {}", filename);
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || static_cast<uint64_t>(st.st_size) < sizeof(DileptonExportHeader) + sizeof(DileptonExportTrailer)) {
+    LOGP(error, "DileptonExportReader: {} is not a dilepton export file", filename);
+    close(fd);
+    return false;
+  }
+  void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    LOGP(error, "DileptonExportReader: cannot map {} in memory", filename);
+    return false;
+  }
+  fData = static_cast<const char*>(data);
+  fSize = st.st_size;
+
+  fHeader = reinterpret_cast<const DileptonExportHeader*>(fData);
+  fTrailer = reinterpret_cast<const DileptonExportTrailer*>(fData + fSize - sizeof(DileptonExportTrailer));
+  uint64_t indexSize = fTrailer->fNBlocks * sizeof(DileptonExportBlock);
+  if (std::memcmp(fHeader->fMagic, kExportMagic, sizeof(kExportMagic)) != 0 || std::memcmp(fTrailer->fMagic, kExportMagic, sizeof(kExportMagic)) != 0 ||
+      fHeader->fVersion != DileptonExportWriter::kVersion || indexSize > fSize - sizeof(DileptonExportHeader) - sizeof(DileptonExportTrailer)) {
+    LOGP(error, "DileptonExportReader: {} is not a complete dilepton export file (version {})", filename, DileptonExportWriter::kVersion);
+    Close();
+    return false;
+  }
+  fIndex = reinterpret_cast<const DileptonExportBlock*>(fData + fSize - sizeof(DileptonExportTrailer) - indexSize);
+  return true;
+}
+
+//_________________________________________________________________________
+void DileptonExportReader::Close()
+{
+  if (fData) {
+    munmap(const_cast<char*>(fData), fSize);
+  }
+  fData = nullptr;
+  fSize = 0;
+  fHeader = nullptr;
+  fIndex = nullptr;
+  fTrailer = nullptr;
+}
+
+//_________________________________________________________________________
+DileptonExportColumns DileptonExportReader::GetBlock(uint64_t i) const
+{
+  if (i >= GetNBlocks()) {
+    return {0, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr};
+  }
+  const DileptonExportBlock& block = fIndex[i];
+  const uint32_t n = block.fNPairs;
+  const char* column = fData + block.fOffset;
+  DileptonExportColumns columns;
+  columns.fNPairs = n;
+  columns.fMass = reinterpret_cast<const float*>(column);
+  columns.fPt = columns.fMass + n;
+  columns.fRapidity = columns.fPt + n;
+  columns.fWeight = columns.fRapidity + n;
+  columns.fCutMask = reinterpret_cast<const uint32_t*>(columns.fWeight + n);
+  columns.fMCFlag = columns.fCutMask + n;
+  columns.fSign = reinterpret_cast<const int8_t*>(columns.fMCFlag + n);
+  return columns;
+}
@@ -0,0 +1,134 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+//
+// Contact: iarsene@cern.ch, i.c.arsene@fys.uio.no
+//
+// Compact columnar export of dilepton candidates, one file per run, to be refitted or re-histogrammed
+//   without running the full analysis workflow.
+// File layout (native byte order):
+//   - header: DileptonExportHeader
+//   - blocks of up to fBlockSize pairs, each one holding its columns one after the other:
+//       float mass[n], float pt[n], float rapidity[n], float weight[n], uint32_t cutMask[n], uint32_t mcFlag[n], int8_t sign[n],
+//       padded to a multiple of 8 bytes
+//   - index: one DileptonExportBlock per block, followed by the DileptonExportTrailer at the end of the file
+// The reader maps the file in memory and gives direct access to the columns of each block.
+//
+
+#ifndef DileptonExport_H
+#define DileptonExport_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+//_________________________________________________________________________
+struct DileptonExportHeader {
+  char fMagic[8];     // "DQDLEXP"
+  uint32_t fVersion;  // format version
+  int32_t fRunNumber; // run of all the pairs in the file
+};
+
+struct DileptonExportBlock {
+  uint64_t fOffset;  // position of the block in the file
+  uint32_t fNPairs;  // number of pairs in the block
+  uint32_t fPadding; // unused
+};
+
+struct DileptonExportTrailer {
+  uint64_t fNBlocks; // number of blocks
+  uint64_t fNPairs;  // total number of pairs
+  char fMagic[8];    // "DQDLEXP"
+};
+
+// Columns of a block, pointing into the mapped file
+struct DileptonExportColumns {
+  uint32_t fNPairs;
+  const float* fMass;
+  const float* fPt;
+  const float* fRapidity;
+  const float* fWeight;
+  const uint32_t* fCutMask;
+  const uint32_t* fMCFlag;
+  const int8_t* fSign;
+};
+
+//_________________________________________________________________________
+class DileptonExportWriter
+{
+ public:
+  DileptonExportWriter() = default;
+  ~DileptonExportWriter();
+
+  static constexpr uint32_t kVersion = 1;
+
+  // The files are written as <directory>/<prefix>_<run>.dqdl
+  void SetOutput(const char* directory, const char* prefix = "dileptons");
+  void SetBlockSize(int size) { fBlockSize = (size > 0 ? size : 1); }
+
+  // Close the file of the previous run, if any, and open the file of a new run
+  void SetRunNumber(int run);
+  void AddPair(float mass, float pt, float rapidity, int sign, uint32_t cutMask, uint32_t mcFlag = 0, float weight = 1.0);
+  // Write the last block and the index, then close the file
+  void Close();
+
+  bool IsOpen() const { return fFile.is_open(); }
+  uint64_t GetNPairs() const { return fNPairs; }
+
+ private:
+  void WriteBlock();
+
+  std::string fDirectory = ".";
+  std::string fPrefix = "dileptons";
+  int fBlockSize = 65536;
+  int fRunNumber = -1;
+  std::ofstream fFile;
+  uint64_t fNPairs = 0;                    // pairs written to the current file
+  std::vector<DileptonExportBlock> fIndex; // blocks written to the current file
+
+  // columns of the current block
+  std::vector<float> fMass;
+  std::vector<float> fPt;
+  std::vector<float> fRapidity;
+  std::vector<float> fWeight;
+  std::vector<uint32_t> fCutMask;
+  std::vector<uint32_t> fMCFlag;
+  std::vector<int8_t> fSign;
+};
+
+//_________________________________________________________________________
+class DileptonExportReader
+{
+ public:
+  DileptonExportReader() = default;
+  explicit DileptonExportReader(const char* filename) { Open(filename); }
+  ~DileptonExportReader() { Close(); }
+  DileptonExportReader(const DileptonExportReader&) = delete;
+  DileptonExportReader& operator=(const DileptonExportReader&) = delete;
+
+  // Map a file in memory, returns false if it cannot be read or is not a complete dilepton export file
+  bool Open(const char* filename);
+  void Close();
+
+  int GetRunNumber() const { return fHeader ? fHeader->fRunNumber : -1; }
+  uint64_t GetNBlocks() const { return fTrailer ? fTrailer->fNBlocks : 0; }
+  uint64_t GetNPairs() const { return fTrailer ? fTrailer->fNPairs : 0; }
+  DileptonExportColumns GetBlock(uint64_t i) const;
+
+ private:
+  const char* fData = nullptr;
+  uint64_t fSize = 0;
+  const DileptonExportHeader* fHeader = nullptr;
+  const DileptonExportBlock* fIndex = nullptr;
+  const DileptonExportTrailer* fTrailer = nullptr;
+};
+
+#endif
@@ -11,6 +11,7 @@
 
 #include "PWGDQ/Core/HistogramManager.h"
 
+#include <algorithm>
 #include <iostream>
 #include <memory>
 #include <fstream>
@@ -42,7 +43,9 @@ HistogramManager::HistogramManager() : TNamed("", ""),
                                        fUseDefaultVariableNames(false),
                                        fBinsAllocated(0),
                                        fVariableNames(nullptr),
-                                       fVariableUnits(nullptr)
+                                       fVariableUnits(nullptr),
+                                       fLazyHistograms(false),
+                                       fTHnFillBufferSize(0)
 {
   //
   // Constructor
@@ -58,7 +61,9 @@ HistogramManager::HistogramManager(const char* name, const char* title, const in
                                                                                               fUseDefaultVariableNames(kFALSE),
                                                                                               fBinsAllocated(0),
                                                                                               fVariableNames(),
-                                                                                              fVariableUnits()
+                                                                                              fVariableUnits(),
+                                                                                              fLazyHistograms(false),
+                                                                                              fTHnFillBufferSize(0)
 {
   //
   // Constructor
@@ -113,6 +118,7 @@ void HistogramManager::AddHistClass(const char* histClass)
   fMainList->Add(hList);
   std::list<std::vector<int>> varList;
   fVariablesMap[histClass] = varList;
+  fHistSlots[histClass].clear();
 }
 
 //_________________________________________________________________
@@ -126,7 +132,50 @@ void HistogramManager::AddHistogram(const char* histClass, const char* hname, co
   //
   // add a histogram  (this function can define TH1F,TH2F,TH3F,TProfile,TProfile2D, and TProfile3D)
   //
-  // TODO: replace the cout warning messages with LOG (same for all the other functions)
+  auto def = std::make_unique<HistDefinition>();
+  def->fNBins[0] = nXbins;
+  def->fMin[0] = xmin;
+  def->fMax[0] = xmax;
+  def->fNBins[1] = nYbins;
+  def->fMin[1] = ymin;
+  def->fMax[1] = ymax;
+  def->fNBins[2] = nZbins;
+  def->fMin[2] = zmin;
+  def->fMax[2] = zmax;
+  DefineHistogram(histClass, hname, title, isProfile, std::move(def), varX, varY, varZ, xLabels, yLabels, zLabels, varT, varW, isdouble);
+}
+
+//_________________________________________________________________
+void HistogramManager::AddHistogram(const char* histClass, const char* hname, const char* title, bool isProfile,
+                                    int nXbins, double* xbins, int varX,
+                                    int nYbins, double* ybins, int varY,
+                                    int nZbins, double* zbins, int varZ,
+                                    const char* xLabels, const char* yLabels, const char* zLabels,
+                                    int varT, int varW, bool isdouble)
+{
+  //
+  // add a histogram with non-equidistant binning
+  //
+  auto def = std::make_unique<HistDefinition>();
+  def->fVariableBins = true;
+  def->fNBins[0] = nXbins;
+  def->fBins[0] = GetSharedBins(nXbins, xbins);
+  def->fNBins[1] = nYbins;
+  def->fBins[1] = GetSharedBins(nYbins, ybins);
+  def->fNBins[2] = nZbins;
+  def->fBins[2] = GetSharedBins(nZbins, zbins);
+  DefineHistogram(histClass, hname, title, isProfile, std::move(def), varX, varY, varZ, xLabels, yLabels, zLabels, varT, varW, isdouble);
+}
+
+//_________________________________________________________________
+void HistogramManager::DefineHistogram(const char* histClass, const char* hname, const char* title, bool isProfile,
+                                       std::unique_ptr<HistDefinition> def, int varX, int varY, int varZ,
+                                       const char* xLabels, const char* yLabels, const char* zLabels,
+                                       int varT, int varW, bool isdouble)
+{
+  //
+  // register a TH1, TH2, TH3 or profile histogram with the binning given in <def>, and create it unless lazy creation is requested
+  //
 
   // get the list to which the histogram should be added
   auto* hList = reinterpret_cast<TList*>(fMainList->FindObject(histClass));
@@ -136,24 +185,11 @@ void HistogramManager::AddHistogram(const char* histClass, const char* hname, co
     return;
   }
   // check whether this histogram name was used before
-  if (hList->FindObject(hname)) {
+  if (HasHistogram(histClass, hname)) {
     LOG(warn) << "HistogramManager::AddHistogram(): Histogram " << hname << " already exists";
     return;
   }
 
-  // deduce the dimension of the histogram from parameters
-  // NOTE: in case of profile histograms, one extra variable is needed
-  int dimension = 1;
-  if (varY > kNothing) {
-    dimension = 2;
-  }
-  if (varZ > kNothing) {
-    dimension = 3;
-  }
-
-  // tokenize the title string; the user may include in it axis titles which will overwrite the defaults
-  TString titleStr(title);
-  std::unique_ptr<TObjArray> arr(titleStr.Tokenize(";"));
   // mark required variables as being used
   if (varX > kNothing) {
     fUsedVars[varX] = kTRUE;
@@ -180,353 +216,204 @@ void HistogramManager::AddHistogram(const char* histClass, const char* hname, co
   varVector.push_back(varY);
   varVector.push_back(varZ);
   varVector.push_back(varT); // variable used for profiling in case of TProfile3D
-  std::list varList = fVariablesMap[histClass];
-  varList.push_back(varVector);
-  fVariablesMap[histClass] = varList;
+  fVariablesMap[histClass].push_back(varVector);
+
+  def->fName = hname;
+  def->fTitle = title;
+  def->fIsProfile = isProfile;
+  def->fIsDouble = isdouble;
+  def->fVars[0] = varX;
+  def->fVars[1] = varY;
+  def->fVars[2] = varZ;
+  def->fVars[3] = varT;
+  def->fLabels[0] = xLabels;
+  def->fLabels[1] = yLabels;
+  def->fLabels[2] = zLabels;
+  if (fLazyHistograms) {
+    fHistSlots[histClass].push_back({hname, nullptr, std::move(def)});
+    return;
+  }
+  TH1* h = CreateHistogram(*def);
+  hList->Add(h);
+  fHistSlots[histClass].push_back({hname, h, nullptr});
+}
+
+//_________________________________________________________________
+TH1* HistogramManager::CreateHistogram(const HistDefinition& def)
+{
+  //
+  // create a TH1F, TH2F, TH3F, TProfile, TProfile2D or TProfile3D (or their double precision versions) from its definition
+  //
+  const char* hname = def.fName.c_str();
+  const int varX = def.fVars[0];
+  const int varY = def.fVars[1];
+  const int varZ = def.fVars[2];
+  const int varT = def.fVars[3];
+  const int nXbins = def.fNBins[0];
+  const int nYbins = def.fNBins[1];
+  const int nZbins = def.fNBins[2];
+  const double* xbins = def.fBins[0] ? def.fBins[0]->data() : nullptr;
+  const double* ybins = def.fBins[1] ? def.fBins[1]->data() : nullptr;
+  const double* zbins = def.fBins[2] ? def.fBins[2]->data() : nullptr;
+
+  // deduce the dimension of the histogram from parameters
+  // NOTE: in case of profile histograms, one extra variable is needed
+  int dimension = 1;
+  if (varY > kNothing) {
+    dimension = 2;
+  }
+  if (varZ > kNothing) {
+    dimension = 3;
+  }
+
+  // tokenize the title string; the user may include in it axis titles which will overwrite the defaults
+  TString titleStr(def.fTitle.c_str());
+  std::unique_ptr<TObjArray> arr(titleStr.Tokenize(";"));
+  const char* htitle = (arr->At(0) ? arr->At(0)->GetName() : "");
 
   // create and configure histograms according to required options
   TH1* h = nullptr;
   switch (dimension) {
     case 1: // TH1F
-      if (!isdouble) {
-        h = new TH1F(hname, (arr->At(0) ? arr->At(0)->GetName() : ""), nXbins, xmin, xmax);
+      if (def.fVariableBins) {
+        h = def.fIsDouble ? static_cast<TH1*>(new TH1D(hname, htitle, nXbins, xbins)) : new TH1F(hname, htitle, nXbins, xbins);
       } else {
-        h = new TH1D(hname, (arr->At(0) ? arr->At(0)->GetName() : ""), nXbins, xmin, xmax);
+        h = def.fIsDouble ? static_cast<TH1*>(new TH1D(hname, htitle, nXbins, def.fMin[0], def.fMax[0])) : new TH1F(hname, htitle, nXbins, def.fMin[0], def.fMax[0]);
       }
       fBinsAllocated += nXbins + 2;
-      // TODO: possibly make the call of Sumw2() optional for all histograms
-      h->Sumw2();
-      if (fVariableNames[varX][0]) {
-        h->GetXaxis()->SetTitle(Form("%s %s", fVariableNames[varX].Data(),
-                                     (fVariableUnits[varX][0] ? Form("(%s)", fVariableUnits[varX].Data()) : "")));
-      }
-      if (arr->At(1)) {
-        h->GetXaxis()->SetTitle(arr->At(1)->GetName());
-      }
-      if (xLabels[0] != '\0') {
-        MakeAxisLabels(h->GetXaxis(), xLabels);
-      }
-      hList->Add(h);
-      h->SetDirectory(nullptr);
       break;
 
     case 2: // either TH2F or TProfile
-      if (isProfile) {
-        h = new TProfile(hname, (arr->At(0) ? arr->At(0)->GetName() : ""), nXbins, xmin, xmax);
+      if (def.fIsProfile) {
+        if (def.fVariableBins) {
+          h = new TProfile(hname, htitle, nXbins, xbins);
+        } else {
+          h = new TProfile(hname, htitle, nXbins, def.fMin[0], def.fMax[0]);
+        }
         fBinsAllocated += nXbins + 2;
-        h->Sumw2();
         // if requested, build the profile using the profile widths instead of stat errors
         // TODO: make this option more transparent to the user ?
         if (titleStr.Contains("--s--")) {
           (reinterpret_cast<TProfile*>(h))->BuildOptions(0., 0., "s");
         }
       } else {
-        if (!isdouble) {
-          h = new TH2F(hname, (arr->At(0) ? arr->At(0)->GetName() : ""), nXbins, xmin, xmax, nYbins, ymin, ymax);
+        if (def.fVariableBins) {
+          h = def.fIsDouble ? static_cast<TH1*>(new TH2D(hname, htitle, nXbins, xbins, nYbins, ybins)) : new TH2F(hname, htitle, nXbins, xbins, nYbins, ybins);
         } else {
-          h = new TH2D(hname, (arr->At(0) ? arr->At(0)->GetName() : ""), nXbins, xmin, xmax, nYbins, ymin, ymax);
+          h = def.fIsDouble ? static_cast<TH1*>(new TH2D(hname, htitle, nXbins, def.fMin[0], def.fMax[0], nYbins, def.fMin[1], def.fMax[1]))
+                            : new TH2F(hname, htitle, nXbins, def.fMin[0], def.fMax[0], nYbins, def.fMin[1], def.fMax[1]);
         }
         fBinsAllocated += (nXbins + 2) * (nYbins + 2);
-        h->Sumw2();
-      }
-      if (fVariableNames[varX][0]) {
-        h->GetXaxis()->SetTitle(Form("%s %s", fVariableNames[varX].Data(),
-                                     (fVariableUnits[varX][0] ? Form("(%s)", fVariableUnits[varX].Data()) : "")));
-      }
-      if (arr->At(1)) {
-        h->GetXaxis()->SetTitle(arr->At(1)->GetName());
-      }
-      if (xLabels[0] != '\0') {
-        MakeAxisLabels(h->GetXaxis(), xLabels);
       }
-
-      if (fVariableNames[varY][0]) {
-        h->GetYaxis()->SetTitle(Form("%s %s", fVariableNames[varY].Data(),
-                                     (fVariableUnits[varY][0] ? Form("(%s)", fVariableUnits[varY].Data()) : "")));
-      }
-      if (fVariableNames[varY][0] && isProfile) {
-        h->GetYaxis()->SetTitle(Form("<%s> %s", fVariableNames[varY].Data(),
-                                     (fVariableUnits[varY][0] ? Form("(%s)", fVariableUnits[varY].Data()) : "")));
-      }
-      if (arr->At(2)) {
-        h->GetYaxis()->SetTitle(arr->At(2)->GetName());
-      }
-      if (yLabels[0] != '\0') {
-        MakeAxisLabels(h->GetYaxis(), yLabels);
-      }
-      hList->Add(h);
-      h->SetDirectory(nullptr);
       break;
 
     case 3: // TH3F, TProfile2D or TProfile3D
-      if (isProfile) {
+      if (def.fIsProfile) {
         if (varT > kNothing) { // TProfile3D
-          h = new TProfile3D(hname, (arr->At(0) ? arr->At(0)->GetName() : ""), nXbins, xmin, xmax, nYbins, ymin, ymax, nZbins, zmin, zmax);
+          if (def.fVariableBins) {
+            h = new TProfile3D(hname, htitle, nXbins, xbins, nYbins, ybins, nZbins, zbins);
+          } else {
+            h = new TProfile3D(hname, htitle, nXbins, def.fMin[0], def.fMax[0], nYbins, def.fMin[1], def.fMax[1], nZbins, def.fMin[2], def.fMax[2]);
+          }
           fBinsAllocated += (nXbins + 2) * (nYbins + 2) * (nZbins + 2);
-          h->Sumw2();
           if (titleStr.Contains("--s--")) {
             (reinterpret_cast<TProfile3D*>(h))->BuildOptions(0., 0., "s");
           }
         } else { // TProfile2D
-          h = new TProfile2D(hname, (arr->At(0) ? arr->At(0)->GetName() : ""), nXbins, xmin, xmax, nYbins, ymin, ymax);
+          if (def.fVariableBins) {
+            h = new TProfile2D(hname, htitle, nXbins, xbins, nYbins, ybins);
+          } else {
+            h = new TProfile2D(hname, htitle, nXbins, def.fMin[0], def.fMax[0], nYbins, def.fMin[1], def.fMax[1]);
+          }
           fBinsAllocated += (nXbins + 2) * (nYbins + 2);
-          h->Sumw2();
           if (titleStr.Contains("--s--")) {
             (reinterpret_cast<TProfile2D*>(h))->BuildOptions(0., 0., "s");
           }
         }
       } else { // TH3F
-        if (!isdouble) {
-          h = new TH3F(hname, (arr->At(0) ? arr->At(0)->GetName() : ""), nXbins, xmin, xmax, nYbins, ymin, ymax, nZbins, zmin, zmax);
+        if (def.fVariableBins) {
+          h = def.fIsDouble ? static_cast<TH1*>(new TH3D(hname, htitle, nXbins, xbins, nYbins, ybins, nZbins, zbins)) : new TH3F(hname, htitle, nXbins, xbins, nYbins, ybins, nZbins, zbins);
         } else {
-          h = new TH3D(hname, (arr->At(0) ? arr->At(0)->GetName() : ""), nXbins, xmin, xmax, nYbins, ymin, ymax, nZbins, zmin, zmax);
+          h = def.fIsDouble ? static_cast<TH1*>(new TH3D(hname, htitle, nXbins, def.fMin[0], def.fMax[0], nYbins, def.fMin[1], def.fMax[1], nZbins, def.fMin[2], def.fMax[2]))
+                            : new TH3F(hname, htitle, nXbins, def.fMin[0], def.fMax[0], nYbins, def.fMin[1], def.fMax[1], nZbins, def.fMin[2], def.fMax[2]);
         }
         fBinsAllocated += (nXbins + 2) * (nYbins + 2) * (nZbins + 2);
-        h->Sumw2();
       }
-      if (fVariableNames[varX][0]) {
-        h->GetXaxis()->SetTitle(Form("%s %s", fVariableNames[varX].Data(),
-                                     (fVariableUnits[varX][0] ? Form("(%s)", fVariableUnits[varX].Data()) : "")));
-      }
-      if (arr->At(1)) {
-        h->GetXaxis()->SetTitle(arr->At(1)->GetName());
-      }
-      if (xLabels[0] != '\0') {
-        MakeAxisLabels(h->GetXaxis(), xLabels);
-      }
-      if (fVariableNames[varY][0]) {
-        h->GetYaxis()->SetTitle(Form("%s %s", fVariableNames[varY].Data(),
-                                     (fVariableUnits[varY][0] ? Form("(%s)", fVariableUnits[varY].Data()) : "")));
-      }
-      if (arr->At(2)) {
-        h->GetYaxis()->SetTitle(arr->At(2)->GetName());
-      }
-      if (yLabels[0] != '\0') {
-        MakeAxisLabels(h->GetYaxis(), yLabels);
-      }
-      if (fVariableNames[varZ][0]) {
-        h->GetZaxis()->SetTitle(Form("%s %s", fVariableNames[varZ].Data(),
-                                     (fVariableUnits[varZ][0] ? Form("(%s)", fVariableUnits[varZ].Data()) : "")));
-      }
-      if (fVariableNames[varZ][0] && isProfile && varT < 0) { // for TProfile2D
-        h->GetZaxis()->SetTitle(Form("<%s> %s", fVariableNames[varZ].Data(),
-                                     (fVariableUnits[varZ][0] ? Form("(%s)", fVariableUnits[varZ].Data()) : "")));
-      }
-      if (arr->At(3)) {
-        h->GetZaxis()->SetTitle(arr->At(3)->GetName());
-      }
-      if (zLabels[0] != '\0') {
-        MakeAxisLabels(h->GetZaxis(), zLabels);
-      }
-      h->SetDirectory(nullptr);
-      hList->Add(h);
       break;
   } // end switch
+  // TODO: possibly make the call of Sumw2() optional for all histograms
+  h->Sumw2();
+  h->SetDirectory(nullptr);
+
+  // axis titles and labels; the axis of the averaged variable of the TProfile and TProfile2D is titled <variable>
+  SetAxisTitle(h->GetXaxis(), varX, false, arr->At(1), def.fLabels[0]);
+  if (dimension > 1) {
+    SetAxisTitle(h->GetYaxis(), varY, def.fIsProfile && dimension == 2, arr->At(2), def.fLabels[1]);
+  }
+  if (dimension > 2) {
+    SetAxisTitle(h->GetZaxis(), varZ, def.fIsProfile && varT < 0, arr->At(3), def.fLabels[2]);
+  }
+  return h;
 }
 
 //_________________________________________________________________
-void HistogramManager::AddHistogram(const char* histClass, const char* hname, const char* title, bool isProfile,
-                                    int nXbins, double* xbins, int varX,
-                                    int nYbins, double* ybins, int varY,
-                                    int nZbins, double* zbins, int varZ,
-                                    const char* xLabels, const char* yLabels, const char* zLabels,
-                                    int varT, int varW, bool isdouble)
+void HistogramManager::SetAxisTitle(TAxis* axis, int var, bool isAveraged, TObject* title, const std::string& labels)
 {
   //
-  // add a histogram
+  // set the axis title from the variable name and units, unless given in the histogram title, and the bin labels
   //
-
-  // get the list to which the histogram should be added
-  auto* hList = reinterpret_cast<TList*>(fMainList->FindObject(histClass));
-  if (!hList) {
-    LOG(warn) << "HistogramManager::AddHistogram(): Histogram list " << histClass << " not found!";
-    LOG(warn) << "         Histogram not created";
-    return;
+  if (fVariableNames[var][0]) {
+    axis->SetTitle(Form(isAveraged ? "<%s> %s" : "%s %s", fVariableNames[var].Data(),
+                        (fVariableUnits[var][0] ? Form("(%s)", fVariableUnits[var].Data()) : "")));
   }
-  // check whether this histogram name was used before
-  if (hList->FindObject(hname)) {
-    LOG(warn) << "HistogramManager::AddHistogram(): Histogram " << hname << " already exists";
-    return;
+  if (title) {
+    axis->SetTitle(title->GetName());
   }
-
-  // deduce the dimension of the histogram from parameters
-  // NOTE: in case of profile histograms, one extra variable is needed
-  int dimension = 1;
-  if (varY > kNothing) {
-    dimension = 2;
-  }
-  if (varZ > kNothing) {
-    dimension = 3;
+  if (!labels.empty()) {
+    MakeAxisLabels(axis, labels.c_str());
   }
+}
 
-  // mark required variables as being used
-  if (varX > kNothing) {
-    fUsedVars[varX] = kTRUE;
+//_________________________________________________________________
+std::shared_ptr<const std::vector<double>> HistogramManager::GetSharedBins(int nBins, const double* bins)
+{
+  //
+  // copy of the bin limits of a histogram definition; with lazy creation, identical bin limits are stored only once
+  //
+  if (!bins || nBins < 1) {
+    return nullptr;
   }
-  if (varY > kNothing) {
-    fUsedVars[varY] = kTRUE;
+  std::vector<double> limits(bins, bins + nBins + 1);
+  if (fLazyHistograms) {
+    for (const auto& shared : fSharedBins) {
+      if (*shared == limits) {
+        return shared;
+      }
+    }
   }
-  if (varZ > kNothing) {
-    fUsedVars[varZ] = kTRUE;
+  auto shared = std::make_shared<const std::vector<double>>(std::move(limits));
+  if (fLazyHistograms) {
+    fSharedBins.push_back(shared);
   }
-  if (varT > kNothing) {
-    fUsedVars[varT] = kTRUE;
+  return shared;
+}
+
+//_________________________________________________________________
+bool HistogramManager::HasHistogram(const char* histClass, const char* hname) const
+{
+  //
+  // whether a histogram with the given name is defined in the class, created or not
+  //
+  auto slotsIt = fHistSlots.find(histClass);
+  if (slotsIt == fHistSlots.end()) {
+    return false;
   }
-  if (varW > kNothing) {
-    fUsedVars[varW] = kTRUE;
+  for (const auto& slot : slotsIt->second) {
+    if (slot.fName == hname) {
+      return true;
+    }
   }
-
-  // tokenize the title string; the user may include in it axis titles which will overwrite the defaults
-  TString titleStr(title);
-  std::unique_ptr<TObjArray> arr(titleStr.Tokenize(";"));
-
-  // encode needed variable identifiers in a vector and push it to the std::list corresponding to the current histogram list
-  std::vector<int> varVector;
-  varVector.push_back(isProfile ? 1 : 0); // whether the histogram is a profile
-  varVector.push_back(0);                 // whether it is a THn
-  varVector.push_back(varW);              // variable used for weighting
-  varVector.push_back(varX);              // variables on each axis
-  varVector.push_back(varY);
-  varVector.push_back(varZ);
-  varVector.push_back(varT); // variable used for profiling in case of TProfile3D
-  std::list varList = fVariablesMap[histClass];
-  varList.push_back(varVector);
-  fVariablesMap[histClass] = varList;
-
-  TH1* h = nullptr;
-  switch (dimension) {
-    case 1:
-      if (!isdouble) {
-        h = new TH1F(hname, (arr->At(0) ? arr->At(0)->GetName() : ""), nXbins, xbins);
-      } else {
-        h = new TH1D(hname, (arr->At(0) ? arr->At(0)->GetName() : ""), nXbins, xbins);
-      }
-      fBinsAllocated += nXbins + 2;
-      h->Sumw2();
-      if (fVariableNames[varX][0]) {
-        h->GetXaxis()->SetTitle(Form("%s %s", fVariableNames[varX].Data(),
-                                     (fVariableUnits[varX][0] ? Form("(%s)", fVariableUnits[varX].Data()) : "")));
-      }
-      if (arr->At(1)) {
-        h->GetXaxis()->SetTitle(arr->At(1)->GetName());
-      }
-      if (xLabels[0] != '\0') {
-        MakeAxisLabels(h->GetXaxis(), xLabels);
-      }
-      h->SetDirectory(nullptr);
-      hList->Add(h);
-      break;
-
-    case 2:
-      if (isProfile) {
-        h = new TProfile(hname, (arr->At(0) ? arr->At(0)->GetName() : ""), nXbins, xbins);
-        fBinsAllocated += nXbins + 2;
-        h->Sumw2();
-        if (titleStr.Contains("--s--")) {
-          (reinterpret_cast<TProfile*>(h))->BuildOptions(0., 0., "s");
-        }
-      } else {
-        if (!isdouble) {
-          h = new TH2F(hname, (arr->At(0) ? arr->At(0)->GetName() : ""), nXbins, xbins, nYbins, ybins);
-        } else {
-          h = new TH2D(hname, (arr->At(0) ? arr->At(0)->GetName() : ""), nXbins, xbins, nYbins, ybins);
-        }
-        fBinsAllocated += (nXbins + 2) * (nYbins + 2);
-        h->Sumw2();
-      }
-      if (fVariableNames[varX][0]) {
-        h->GetXaxis()->SetTitle(Form("%s %s", fVariableNames[varX].Data(),
-                                     (fVariableUnits[varX][0] ? Form("(%s)", fVariableUnits[varX].Data()) : "")));
-      }
-      if (arr->At(1)) {
-        h->GetXaxis()->SetTitle(arr->At(1)->GetName());
-      }
-      if (xLabels[0] != '\0') {
-        MakeAxisLabels(h->GetXaxis(), xLabels);
-      }
-      if (fVariableNames[varY][0]) {
-        h->GetYaxis()->SetTitle(Form("%s %s", fVariableNames[varY].Data(),
-                                     (fVariableUnits[varY][0] ? Form("(%s)", fVariableUnits[varY].Data()) : "")));
-      }
-      if (fVariableNames[varY][0] && isProfile) {
-        h->GetYaxis()->SetTitle(Form("<%s> %s", fVariableNames[varY].Data(),
-                                     (fVariableUnits[varY][0] ? Form("(%s)", fVariableUnits[varY].Data()) : "")));
-      }
-
-      if (arr->At(2)) {
-        h->GetYaxis()->SetTitle(arr->At(2)->GetName());
-      }
-      if (yLabels[0] != '\0') {
-        MakeAxisLabels(h->GetYaxis(), yLabels);
-      }
-      h->SetDirectory(nullptr);
-      hList->Add(h);
-      break;
-
-    case 3:
-      if (isProfile) {
-        if (varT > kNothing) {
-          h = new TProfile3D(hname, (arr->At(0) ? arr->At(0)->GetName() : ""), nXbins, xbins, nYbins, ybins, nZbins, zbins);
-          fBinsAllocated += (nXbins + 2) * (nYbins + 2) * (nZbins + 2);
-          h->Sumw2();
-          if (titleStr.Contains("--s--")) {
-            (reinterpret_cast<TProfile3D*>(h))->BuildOptions(0., 0., "s");
-          }
-        } else {
-          h = new TProfile2D(hname, (arr->At(0) ? arr->At(0)->GetName() : ""), nXbins, xbins, nYbins, ybins);
-          fBinsAllocated += (nXbins + 2) * (nYbins + 2);
-          h->Sumw2();
-          if (titleStr.Contains("--s--")) {
-            (reinterpret_cast<TProfile2D*>(h))->BuildOptions(0., 0., "s");
-          }
-        }
-      } else {
-        if (!isdouble) {
-          h = new TH3F(hname, (arr->At(0) ? arr->At(0)->GetName() : ""), nXbins, xbins, nYbins, ybins, nZbins, zbins);
-        } else {
-          h = new TH3D(hname, (arr->At(0) ? arr->At(0)->GetName() : ""), nXbins, xbins, nYbins, ybins, nZbins, zbins);
-        }
-        fBinsAllocated += (nXbins + 2) * (nYbins + 2) * (nZbins + 2);
-        h->Sumw2();
-      }
-      if (fVariableNames[varX][0]) {
-        h->GetXaxis()->SetTitle(Form("%s %s", fVariableNames[varX].Data(),
-                                     (fVariableUnits[varX][0] ? Form("(%s)", fVariableUnits[varX].Data()) : "")));
-      }
-      if (arr->At(1)) {
-        h->GetXaxis()->SetTitle(arr->At(1)->GetName());
-      }
-      if (xLabels[0] != '\0') {
-        MakeAxisLabels(h->GetXaxis(), xLabels);
-      }
-      if (fVariableNames[varY][0]) {
-        h->GetYaxis()->SetTitle(Form("%s %s", fVariableNames[varY].Data(),
-                                     (fVariableUnits[varY][0] ? Form("(%s)", fVariableUnits[varY].Data()) : "")));
-      }
-      if (arr->At(2)) {
-        h->GetYaxis()->SetTitle(arr->At(2)->GetName());
-      }
-      if (yLabels[0] != '\0') {
-        MakeAxisLabels(h->GetYaxis(), yLabels);
-      }
-      if (fVariableNames[varZ][0]) {
-        h->GetZaxis()->SetTitle(Form("%s %s", fVariableNames[varZ].Data(),
-                                     (fVariableUnits[varZ][0] ? Form("(%s)", fVariableUnits[varZ].Data()) : "")));
-      }
-      if (fVariableNames[varZ][0] && isProfile && varT < 0) { // TProfile2D
-        h->GetZaxis()->SetTitle(Form("<%s> %s", fVariableNames[varZ].Data(),
-                                     (fVariableUnits[varZ][0] ? Form("(%s)", fVariableUnits[varZ].Data()) : "")));
-      }
-
-      if (arr->At(3)) {
-        h->GetZaxis()->SetTitle(arr->At(3)->GetName());
-      }
-      if (zLabels[0] != '\0') {
-        MakeAxisLabels(h->GetZaxis(), zLabels);
-      }
-      hList->Add(h);
-      break;
-  } // end switch(dimension)
+  return false;
 }
 
 //_________________________________________________________________
@@ -546,7 +433,7 @@ void HistogramManager::AddHistogram(const char* histClass, const char* hname, co
     return;
   }
   // check whether this histogram name was used before
-  if (hList->FindObject(hname)) {
+  if (HasHistogram(histClass, hname)) {
     LOG(warn) << "HistogramManager::AddHistogram(): Histogram " << hname << " already exists";
     return;
   }
@@ -618,6 +505,7 @@ void HistogramManager::AddHistogram(const char* histClass, const char* hname, co
       hList->Add(reinterpret_cast<THnD*>(h));
     }
   }
+  fHistSlots[histClass].push_back({hname, h, nullptr});
 
   fBinsAllocated += nbins;
 }
@@ -639,7 +527,7 @@ void HistogramManager::AddHistogram(const char* histClass, const char* hname, co
     return;
   }
   // check whether this histogram name was used before
-  if (hList->FindObject(hname)) {
+  if (HasHistogram(histClass, hname)) {
     LOG(warn) << "HistogramManager::AddHistogram(): Histogram " << hname << " already exists";
     return;
   }
@@ -725,6 +613,7 @@ void HistogramManager::AddHistogram(const char* histClass, const char* hname, co
       hList->Add(reinterpret_cast<THnD*>(h));
     }
   }
+  fHistSlots[histClass].push_back({hname, h, nullptr});
   fBinsAllocated += bins;
 }
 
@@ -732,127 +621,238 @@ void HistogramManager::AddHistogram(const char* histClass, const char* hname, co
 void HistogramManager::FillHistClass(const char* className, Float_t* values)
 {
   //
-  //  fill a class of histograms
+  // fill a class of histograms
   //
+  FillHistClass(GetHistClassHandle(className), values);
+}
 
-  // get the needed histogram list
+//____________________________________________________________________________________
+int HistogramManager::GetHistClassHandle(const char* className)
+{
+  //
+  // get the handle of the fill plan of a histogram class, creating the plan if needed
+  //
+  auto handleIt = fFillPlanHandles.find(className);
+  if (handleIt != fFillPlanHandles.end()) {
+    return handleIt->second;
+  }
   auto* hList = reinterpret_cast<TList*>(fMainList->FindObject(className));
   if (!hList) {
-    // TODO: add some meaningfull error message
-    /*LOG(warn) << "HistogramManager::FillHistClass(): Histogram list " << className << " not found!";
-    LOG(warn) << "         Histogram list not filled" << endl; */
-    return;
+    return kNothing;
   }
+  int handle = fFillPlans.size();
+  fFillPlans.push_back({className, hList, &fHistSlots[className], {}});
+  fFillPlanHandles[className] = handle;
+  CompileFillPlan(fFillPlans.back());
+  return handle;
+}
 
-  // get the corresponding std::list containng identifiers to the needed variables to be filled
-  list varList = fVariablesMap[className];
-
-  TIter next(hList);
-
-  TObject* h = nullptr;
-  bool isProfile;
-  bool isTHn;
-  int dimension = 0;
-  bool isSparse = kFALSE;
-  // TODO: At the moment, maximum 20 dimensions are foreseen for the THn histograms. We should make this more dynamic
-  //       But maybe its better to have it like to avoid dynamically allocating this array in the histogram loop
-  double fillValues[20] = {0.0};
-  int varX = -1, varY = -1, varZ = -1, varT = -1, varW = -1;
-
-  // loop over the histogram and std::list
-  // NOTE: these two should contain the same number of elements and be synchronized, otherwise its a mess
-  for (auto varIter = varList.begin(); varIter != varList.end(); varIter++) {
-    h = next(); // get the histogram
-    // decode information from the vector of indices
-    isProfile = (varIter->at(0) == 1 ? true : false);
-    isTHn = (varIter->at(1) > 0 ? true : false);
-    if (isTHn) {
-      dimension = varIter->at(1);
-    } else {
-      dimension = (reinterpret_cast<TH1*>(h))->GetDimension();
-    }
-
-    // get the various variable indices
-    varW = varIter->at(2);
-    if (isTHn) {
-      for (int i = 0; i < dimension; i++) {
-        fillValues[i] = values[varIter->at(3 + i)];
+//____________________________________________________________________________________
+void HistogramManager::CompileFillPlan(FillPlan& plan)
+{
+  //
+  // decode once the histogram types and variable indices of a histogram class
+  //
+  plan.fEntries.clear();
+  const auto& varList = fVariablesMap[plan.fClassName];
+  plan.fEntries.reserve(varList.size());
+  auto slot = plan.fSlots->begin();
+  // NOTE: the histogram slots and the std::list of variables contain the same number of elements and are synchronized
+  //   The histograms not created yet (lazy creation) have a null pointer and are created at their first fill
+  for (const auto& varVector : varList) {
+    FillEntry entry{};
+    entry.fHist = (slot++)->fHist;
+    entry.fVarW = varVector[2];
+    entry.fTHnBuffer = kNothing;
+    bool isProfile = (varVector[0] == 1);
+    int dimension = varVector[1];
+    if (dimension > 0) { // THn
+      entry.fKind = kFillTHn;
+      entry.fNVars = dimension;
+      entry.fVars.assign(varVector.begin() + 3, varVector.begin() + 3 + dimension);
+      if (static_cast<int>(fTHnFillValues.size()) < dimension) {
+        fTHnFillValues.resize(dimension);
+      }
+      if (fTHnFillBufferSize > 0) {
+        entry.fTHnBuffer = GetTHnFillBuffer(reinterpret_cast<THnBase*>(entry.fHist), dimension);
       }
     } else {
-      varX = varIter->at(3);
-      varY = varIter->at(4);
-      varZ = varIter->at(5);
-      varT = varIter->at(6);
+      // dimension of the histogram as created by CreateHistogram(), the averaged variable of a profile not counting
+      dimension = (varVector[5] > kNothing ? 3 : (varVector[4] > kNothing ? 2 : 1));
+      isProfile = isProfile && dimension > 1;
+      if (isProfile && !(dimension == 3 && varVector[6] > kNothing)) {
+        dimension -= 1;
+      }
+      entry.fKind = (isProfile ? kFillProfile : kFillTH1) + dimension - 1;
+      entry.fNVars = dimension + (isProfile ? 1 : 0);
+      entry.fVars.assign(varVector.begin() + 3, varVector.begin() + 7);
     }
+    plan.fEntries.push_back(entry);
+  }
+}
 
-    if (!isTHn) {
-      switch (dimension) {
-        case 1:
-          if (isProfile) {
-            if (varW > kNothing) {
-              (reinterpret_cast<TProfile*>(h))->Fill(values[varX], values[varY], values[varW]);
-            } else {
-              (reinterpret_cast<TProfile*>(h))->Fill(values[varX], values[varY]);
-            }
-          } else {
-            if (varW > kNothing) {
-              (reinterpret_cast<TH1*>(h))->Fill(values[varX], values[varW]);
-            } else {
-              (reinterpret_cast<TH1*>(h))->Fill(values[varX]);
-            }
-          }
-          break;
-        case 2:
-          if (isProfile) {
-            if (varW > kNothing) {
-              (reinterpret_cast<TProfile2D*>(h))->Fill(values[varX], values[varY], values[varZ], values[varW]);
-            } else {
-              (reinterpret_cast<TProfile2D*>(h))->Fill(values[varX], values[varY], values[varZ]);
-            }
-          } else {
-            if (varW > kNothing) {
-              (reinterpret_cast<TH2*>(h))->Fill(values[varX], values[varY], values[varW]);
-            } else {
-              (reinterpret_cast<TH2*>(h))->Fill(values[varX], values[varY]);
-            }
+//____________________________________________________________________________________
+void HistogramManager::FillHistClass(int handle, float* values)
+{
+  //
+  // fill a class of histograms using its precompiled fill plan
+  //
+  if (handle < 0 || handle >= static_cast<int>(fFillPlans.size())) {
+    return;
+  }
+  auto& plan = fFillPlans[handle];
+  if (plan.fEntries.size() != plan.fSlots->size()) { // histograms were added after the plan was compiled
+    CompileFillPlan(plan);
+  }
+
+  for (std::size_t iEntry = 0; iEntry < plan.fEntries.size(); ++iEntry) {
+    auto& entry = plan.fEntries[iEntry];
+    if (!entry.fHist) { // lazy histogram filled for the first time
+      auto& slot = (*plan.fSlots)[iEntry];
+      slot.fHist = CreateHistogram(*slot.fDefinition);
+      slot.fDefinition.reset();
+      plan.fList->Add(slot.fHist);
+      entry.fHist = slot.fHist;
+    }
+    const int* vars = entry.fVars.data();
+    const double weight = (entry.fVarW > kNothing ? values[entry.fVarW] : 1.0);
+    switch (entry.fKind) {
+      case kFillTH1:
+        (reinterpret_cast<TH1*>(entry.fHist))->Fill(values[vars[0]], weight);
+        break;
+      case kFillTH2:
+        (reinterpret_cast<TH2*>(entry.fHist))->Fill(values[vars[0]], values[vars[1]], weight);
+        break;
+      case kFillTH3:
+        (reinterpret_cast<TH3*>(entry.fHist))->Fill(values[vars[0]], values[vars[1]], values[vars[2]], weight);
+        break;
+      case kFillProfile:
+        (reinterpret_cast<TProfile*>(entry.fHist))->Fill(values[vars[0]], values[vars[1]], weight);
+        break;
+      case kFillProfile2D:
+        (reinterpret_cast<TProfile2D*>(entry.fHist))->Fill(values[vars[0]], values[vars[1]], values[vars[2]], weight);
+        break;
+      case kFillProfile3D:
+        (reinterpret_cast<TProfile3D*>(entry.fHist))->Fill(values[vars[0]], values[vars[1]], values[vars[2]], values[vars[3]], weight);
+        break;
+      case kFillTHn:
+        if (entry.fTHnBuffer > kNothing) {
+          auto& buffer = fTHnFillBuffers[entry.fTHnBuffer];
+          double* bufferValues = buffer.fValues.data() + buffer.fNEntries;
+          for (int i = 0; i < entry.fNVars; i++) {
+            bufferValues[i * fTHnFillBufferSize] = values[vars[i]];
           }
-          break;
-        case 3:
-          if (isProfile) {
-            if (varW > kNothing) {
-              (reinterpret_cast<TProfile3D*>(h))->Fill(values[varX], values[varY], values[varZ], values[varT], values[varW]);
-            } else {
-              (reinterpret_cast<TProfile3D*>(h))->Fill(values[varX], values[varY], values[varZ], values[varT]);
-            }
-          } else {
-            if (varW > kNothing) {
-              (reinterpret_cast<TH3*>(h))->Fill(values[varX], values[varY], values[varZ], values[varW]);
-            } else {
-              (reinterpret_cast<TH3*>(h))->Fill(values[varX], values[varY], values[varZ]);
-            }
+          buffer.fWeights[buffer.fNEntries++] = weight;
+          if (buffer.fNEntries == fTHnFillBufferSize) {
+            FlushTHnBuffer(buffer);
           }
-          break;
-
-        default:
-          break;
-      } // end switch
-      // end if(!isTHn)
-    } else {
-      if (varW > kNothing) {
-        if (isSparse) {
-          (reinterpret_cast<THnSparse*>(h))->Fill(fillValues, values[varW]);
         } else {
-          (reinterpret_cast<THn*>(h))->Fill(fillValues, values[varW]);
-        }
-      } else {
-        if (isSparse) {
-          (reinterpret_cast<THnSparse*>(h))->Fill(fillValues);
-        } else {
-          (reinterpret_cast<THn*>(h))->Fill(fillValues);
+          for (int i = 0; i < entry.fNVars; i++) {
+            fTHnFillValues[i] = values[vars[i]];
+          }
+          (reinterpret_cast<THnBase*>(entry.fHist))->Fill(fTHnFillValues.data(), weight);
         }
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+//____________________________________________________________________________________
+void HistogramManager::SetTHnFillBufferSize(int size)
+{
+  //
+  // set the number of entries buffered per THn and rebuild the fill plans accordingly
+  //
+  FlushTHnBuffers();
+  fTHnFillBuffers.clear();
+  fTHnFillBufferSize = (size > 0 ? size : 0);
+  for (auto& plan : fFillPlans) {
+    CompileFillPlan(plan);
+  }
+}
+
+//____________________________________________________________________________________
+int HistogramManager::GetTHnFillBuffer(THnBase* h, int nDimensions)
+{
+  //
+  // get the index of the fill buffer of a THn, creating the buffer if needed
+  //
+  for (std::size_t i = 0; i < fTHnFillBuffers.size(); ++i) {
+    if (fTHnFillBuffers[i].fHist == h) {
+      return i;
+    }
+  }
+  THnFillBuffer buffer{h, h->InheritsFrom(THnSparse::Class()), nDimensions, 0, {}, {}, {}, {}};
+  buffer.fValues.resize(nDimensions * fTHnFillBufferSize);
+  buffer.fWeights.resize(fTHnFillBufferSize);
+  buffer.fCoordinates.resize(nDimensions * fTHnFillBufferSize);
+  buffer.fBins.resize(fTHnFillBufferSize);
+  fTHnFillBuffers.push_back(std::move(buffer));
+  return fTHnFillBuffers.size() - 1;
+}
+
+//____________________________________________________________________________________
+void HistogramManager::FlushTHnBuffers()
+{
+  for (auto& buffer : fTHnFillBuffers) {
+    FlushTHnBuffer(buffer);
+  }
+}
+
+//____________________________________________________________________________________
+void HistogramManager::FlushTHnBuffer(THnFillBuffer& buffer)
+{
+  //
+  // fill the buffered entries of a THn: the bin coordinates are computed for all the entries one axis at a time,
+  //   then the weights are added bin by bin. For a THnSparse, the entries are sorted by bin such that each bin is looked up only once
+  //
+  const int nEntries = buffer.fNEntries;
+  if (nEntries == 0) {
+    return;
+  }
+  THnBase* h = buffer.fHist;
+  const int nDimensions = buffer.fNDimensions;
+  int* coordinates = buffer.fCoordinates.data();
+  for (int idim = 0; idim < nDimensions; ++idim) {
+    TAxis* axis = h->GetAxis(idim);
+    const double* axisValues = buffer.fValues.data() + idim * fTHnFillBufferSize;
+    for (int i = 0; i < nEntries; ++i) {
+      coordinates[i * nDimensions + idim] = axis->FindBin(axisValues[i]);
+    }
+  }
+  const bool calculateErrors = h->GetCalculateErrors();
+  if (!buffer.fIsSparse) {
+    for (int i = 0; i < nEntries; ++i) {
+      int64_t bin = h->GetBin(coordinates + i * nDimensions);
+      h->AddBinContent(bin, buffer.fWeights[i]);
+      if (calculateErrors) {
+        h->AddBinError2(bin, buffer.fWeights[i] * buffer.fWeights[i]);
+      }
+    }
+  } else {
+    auto& bins = buffer.fBins;
+    for (int i = 0; i < nEntries; ++i) {
+      bins[i] = {h->GetBin(coordinates + i * nDimensions), buffer.fWeights[i]};
+    }
+    std::sort(bins.begin(), bins.begin() + nEntries, [](const auto& a, const auto& b) { return a.first < b.first; });
+    for (int i = 0; i < nEntries;) {
+      int64_t bin = bins[i].first;
+      double sumw = 0.0;
+      double sumw2 = 0.0;
+      for (; i < nEntries && bins[i].first == bin; ++i) {
+        sumw += bins[i].second;
+        sumw2 += bins[i].second * bins[i].second;
+      }
+      h->AddBinContent(bin, sumw);
+      if (calculateErrors) {
+        h->AddBinError2(bin, sumw2);
       }
-    } // end else
-  }   // end loop over histograms
+    }
+  }
+  h->SetEntries(h->GetEntries() + nEntries);
+  buffer.fNEntries = 0;
 }
 
 //____________________________________________________________________________________
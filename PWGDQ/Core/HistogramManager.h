@@ -28,6 +28,11 @@
 #include <map>
 #include <vector>
 #include <list>
+#include <memory>
+#include <utility>
+
+class TH1;
+class THnBase;
 
 class HistogramManager : public TNamed
 {
@@ -85,6 +90,24 @@ class HistogramManager : public TNamed
                     TString* axLabels = nullptr, int varW = -1, bool useSparse = kFALSE, bool isdouble = false);
 
   void FillHistClass(const char* className, float* values);
+  // Precompiled fill plan: resolve a histogram class once into a handle and fill it with FillHistClass(handle, values),
+  //   which avoids the class lookup by name and the decoding of each histogram on every call.
+  // A handle of a non-existing class is kNothing and filling it does nothing.
+  int GetHistClassHandle(const char* className);
+  void FillHistClass(int handle, float* values);
+  // Buffered filling of the THn and THnSparse histograms: the entries of each THn are kept in a buffer of <size> entries,
+  //   which is filled at once when full, computing the bins axis by axis and adding up the entries falling in the same bin.
+  // A size of 0 (default) fills the THn histograms at each call.
+  // The buffers must be flushed with FlushTHnBuffers() before the histograms are used or written.
+  // NOTE: the sums of weighted axis values kept by THnBase for the statistics are not updated by the buffered filling
+  void SetTHnFillBufferSize(int size);
+  void FlushTHnBuffers();
+
+  // Lazy creation of the TH1, TH2, TH3 and profile histograms: AddHistogram() only records their definition and the histograms
+  //   are created at their first fill, such that no bins are allocated for the histograms which never receive entries.
+  // The histograms which are never filled are then absent from the histogram lists. Identical variable bin limits are stored once.
+  // Must be set before the histograms are added. The THn bin contents are anyway allocated by ROOT only at the first fill.
+  void SetLazyHistograms(bool flag) { fLazyHistograms = flag; }
 
   void SetUseDefaultVariableNames(bool flag) { fUseDefaultVariableNames = flag; }
   void SetDefaultVarNames(TString* vars, TString* units);
@@ -108,6 +131,82 @@ class HistogramManager : public TNamed
   TString* fVariableNames;          //! variable names
   TString* fVariableUnits;          //! variable units
 
+  // histogram definitions
+  struct HistDefinition {
+    std::string fName;                                   // histogram name
+    std::string fTitle;                                  // histogram title, possibly with the axis titles
+    bool fIsProfile = false;                             // whether the histogram is a profile
+    bool fIsDouble = false;                              // double precision histogram
+    bool fVariableBins = false;                          // non-equidistant binning, given by fBins
+    int fNBins[3] = {0, 0, 0};                           // number of bins on each axis
+    double fMin[3] = {0, 0, 0};                          // lower limits for the equidistant binning
+    double fMax[3] = {0, 0, 0};                          // upper limits for the equidistant binning
+    std::shared_ptr<const std::vector<double>> fBins[3]; // bin limits for the non-equidistant binning
+    int fVars[4] = {-1, -1, -1, -1};                     // variables on each axis and the one averaged by a TProfile3D
+    std::string fLabels[3];                              // bin labels on each axis
+  };
+  struct HistSlot {
+    std::string fName;                           // histogram name
+    TObject* fHist;                              // histogram, nullptr until its first fill for the lazy histograms
+    std::unique_ptr<HistDefinition> fDefinition; // definition of a lazy histogram not created yet
+  };
+  bool fLazyHistograms;                                                //! create the TH1 histograms at their first fill
+  std::map<std::string, std::vector<HistSlot>> fHistSlots;             //! histograms of each class, synchronized with fVariablesMap
+  std::vector<std::shared_ptr<const std::vector<double>>> fSharedBins; //! bin limits shared by the lazy histogram definitions
+
+  // fill plans
+  enum FillKind {
+    kFillTH1 = 0,
+    kFillTH2,
+    kFillTH3,
+    kFillProfile,
+    kFillProfile2D,
+    kFillProfile3D,
+    kFillTHn
+  };
+  struct FillEntry {
+    TObject* fHist;         // histogram
+    int fKind;              // one of FillKind
+    int fVarW;              // variable used for weighting
+    int fNVars;             // number of variables filled
+    std::vector<int> fVars; // variables on each axis (and the profiled one)
+    int fTHnBuffer;         // index of the fill buffer of a THn, kNothing for direct filling
+  };
+  struct FillPlan {
+    std::string fClassName;          // histogram class
+    TList* fList;                    // histogram list of the class
+    std::vector<HistSlot>* fSlots;   // histograms of the class
+    std::vector<FillEntry> fEntries; // one entry per histogram of the class
+  };
+  std::vector<FillPlan> fFillPlans;            //! fill plans, indexed by handle
+  std::map<std::string, int> fFillPlanHandles; //! handles of the fill plans, indexed by class name
+  std::vector<double> fTHnFillValues;          //! values of the THn entry being filled
+
+  // THn fill buffers
+  struct THnFillBuffer {
+    THnBase* fHist;                                // histogram
+    bool fIsSparse;                                // whether the histogram is a THnSparse
+    int fNDimensions;                              // number of axes
+    int fNEntries;                                 // number of buffered entries
+    std::vector<double> fValues;                   // buffered values, one block of fTHnFillBufferSize values per axis
+    std::vector<double> fWeights;                  // buffered weights
+    std::vector<int> fCoordinates;                 // bin coordinates of the buffered entries, computed when flushing
+    std::vector<std::pair<int64_t, double>> fBins; // global bin and weight of the buffered entries, computed when flushing
+  };
+  int fTHnFillBufferSize;                     //! number of entries buffered per THn, 0 for direct filling
+  std::vector<THnFillBuffer> fTHnFillBuffers; //! fill buffers of the THn histograms
+
+  void DefineHistogram(const char* histClass, const char* name, const char* title, bool isProfile,
+                       std::unique_ptr<HistDefinition> def, int varX, int varY, int varZ,
+                       const char* xLabels, const char* yLabels, const char* zLabels,
+                       int varT, int varW, bool isdouble);
+  TH1* CreateHistogram(const HistDefinition& def);
+  void SetAxisTitle(TAxis* axis, int var, bool isAveraged, TObject* title, const std::string& labels);
+  std::shared_ptr<const std::vector<double>> GetSharedBins(int nBins, const double* bins);
+  bool HasHistogram(const char* histClass, const char* name) const;
+  void CompileFillPlan(FillPlan& plan);
+  int GetTHnFillBuffer(THnBase* h, int nDimensions);
+  void FlushTHnBuffer(THnFillBuffer& buffer);
   void MakeAxisLabels(TAxis* ax, const char* labels);
 
   HistogramManager& operator=(const HistogramManager& c);
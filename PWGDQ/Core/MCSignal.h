@@ -59,9 +59,39 @@ process(aod::McParticles const& mcTracks) {
 #include "MCProng.h"
 #include "TNamed.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <vector>
 #include <iostream>
 
+// Ancestry of an MC particle along the chain of first mothers: the particle itself, its mother, grandmother, etc.
+struct MCAncestry {
+  static constexpr int kMaxGenerations = 12; // particle and 11 mothers, enough for the PDG-in-history checks
+  int fNGenerations = 0;                     // number of stored generations, smaller than kMaxGenerations only if the chain ends
+  int fPdgCodes[kMaxGenerations];
+  int fIndices[kMaxGenerations];     // global indices
+  uint8_t fSources[kMaxGenerations]; // bit map of the fulfilled MCProng::Source flags
+};
+
+// Per-dataframe cache of the ancestries of MC particles, each one computed once from the ancestry of its mother
+class MCSignalCache
+{
+ public:
+  void Reset(std::size_t nParticles = 0)
+  {
+    fAncestries.clear();
+    fAncestries.resize(nParticles);
+    fComputed.assign(nParticles, 0);
+  }
+
+  template <typename T>
+  const MCAncestry& GetAncestry(const T& particle);
+
+ private:
+  std::vector<MCAncestry> fAncestries; // ancestries indexed by the particle global index
+  std::vector<char> fComputed;
+};
+
 class MCSignal : public TNamed
 {
  public:
@@ -94,6 +124,18 @@ class MCSignal : public TNamed
     return CheckMC(0, checkSources, args...);
   };
 
+  // Same as above, with the particle ancestries looked up in a cache shared by all the signals, which must be reset for each dataframe.
+  // Prongs checking the generations in time, or with more generations than cached, are checked on the MC stack
+  template <typename... T>
+  bool CheckSignal(bool checkSources, MCSignalCache& cache, const T&... args)
+  {
+    if (sizeof...(args) != fNProngs) {
+      return false;
+    }
+
+    return CheckMC(0, checkSources, cache, args...);
+  };
+
   void PrintConfig();
 
  private:
@@ -104,6 +146,8 @@ class MCSignal : public TNamed
 
   template <typename T>
   bool CheckProng(int i, bool checkSources, const T& track);
+  template <typename T>
+  bool CheckProng(int i, bool checkSources, MCSignalCache& cache, const T& track);
 
   bool CheckMC(int, bool)
   {
@@ -120,8 +164,134 @@ class MCSignal : public TNamed
       return CheckMC(i + 1, checkSources, args...);
     }
   };
+
+  bool CheckMC(int, bool, MCSignalCache&)
+  {
+    return true;
+  };
+
+  template <typename T, typename... Ts>
+  bool CheckMC(int i, bool checkSources, MCSignalCache& cache, const T& track, const Ts&... args)
+  {
+    if (!CheckProng(i, checkSources, cache, track)) {
+      return false;
+    } else {
+      return CheckMC(i + 1, checkSources, cache, args...);
+    }
+  };
 };
 
+template <typename T>
+const MCAncestry& MCSignalCache::GetAncestry(const T& particle)
+{
+  using P = typename T::parent_t;
+  int index = particle.globalIndex();
+  if (index >= static_cast<int>(fAncestries.size())) {
+    fAncestries.resize(index + 1);
+    fComputed.resize(index + 1, 0);
+  }
+  if (fComputed[index]) {
+    return fAncestries[index];
+  }
+
+  MCAncestry ancestry;
+  ancestry.fPdgCodes[0] = particle.pdgCode();
+  ancestry.fIndices[0] = index;
+  ancestry.fSources[0] = (particle.isPhysicalPrimary() ? (uint8_t(1) << MCProng::kPhysicalPrimary) : 0) |
+                         (particle.producedByGenerator() ? (uint8_t(1) << MCProng::kProducedByGenerator) : (uint8_t(1) << MCProng::kProducedInTransport)) |
+                         (particle.fromBackgroundEvent() ? (uint8_t(1) << MCProng::kFromBackgroundEvent) : 0);
+  ancestry.fNGenerations = 1;
+  if (particle.has_mothers()) {
+    // the mother ancestry is computed (or taken from the cache) first and shifted by one generation
+    const MCAncestry& motherAncestry = GetAncestry(particle.template mothers_first_as<P>());
+    int nGenerations = std::min(motherAncestry.fNGenerations, MCAncestry::kMaxGenerations - 1);
+    for (int j = 0; j < nGenerations; j++) {
+      ancestry.fPdgCodes[j + 1] = motherAncestry.fPdgCodes[j];
+      ancestry.fIndices[j + 1] = motherAncestry.fIndices[j];
+      ancestry.fSources[j + 1] = motherAncestry.fSources[j];
+    }
+    ancestry.fNGenerations += nGenerations;
+  }
+  fAncestries[index] = ancestry;
+  fComputed[index] = 1;
+  return fAncestries[index];
+}
+
+template <typename T>
+bool MCSignal::CheckProng(int i, bool checkSources, MCSignalCache& cache, const T& track)
+{
+  const MCProng& prong = fProngs[i];
+  if (prong.fCheckGenerationsInTime || prong.fNGenerations > MCAncestry::kMaxGenerations) {
+    return CheckProng(i, checkSources, track);
+  }
+  const MCAncestry& ancestry = cache.GetAncestry(track);
+  // all the requested generations must exist in the stack
+  if (ancestry.fNGenerations < prong.fNGenerations) {
+    return false;
+  }
+
+  // check the PDG codes and the common ancestor (if specified)
+  for (int j = 0; j < prong.fNGenerations; j++) {
+    if (!prong.TestPDG(j, ancestry.fPdgCodes[j])) {
+      return false;
+    }
+    if (fNProngs > 1 && fCommonAncestorIdxs[i] == j) {
+      if (i == 0) {
+        fTempAncestorLabel = ancestry.fIndices[j];
+      } else if (ancestry.fIndices[j] != fTempAncestorLabel) {
+        return false;
+      }
+    }
+  }
+
+  // check the various specified sources
+  if (checkSources) {
+    // NOTE: as when walking the stack, the history moves one generation only after a generation with required sources
+    int generation = 0;
+    for (int j = 0; j < prong.fNGenerations; j++) {
+      if (!prong.fSourceBits[j]) {
+        continue;
+      }
+      uint64_t sourcesDecision = 0;
+      for (int source = 0; source < MCProng::kNSources; source++) {
+        uint64_t bit = (uint64_t(1) << source);
+        if ((prong.fSourceBits[j] & bit) && (prong.fExcludeSource[j] & bit) != static_cast<uint64_t>((ancestry.fSources[generation] & bit) > 0)) {
+          sourcesDecision |= bit;
+        }
+      }
+      if (!sourcesDecision) {
+        return false;
+      }
+      if (prong.fUseANDonSourceBitMap[j] && (sourcesDecision != prong.fSourceBits[j])) {
+        return false;
+      }
+      if (j < prong.fNGenerations - 1) {
+        generation++;
+      }
+    }
+  }
+
+  // check if the PDG codes are included or excluded in the mother history, within 11 generations
+  unsigned int nIncludedPDG = 0;
+  unsigned int nFoundPDG = 0;
+  for (unsigned int k = 0; k < prong.fPDGInHistory.size(); k++) {
+    if (!prong.fExcludePDGInHistory[k]) {
+      nIncludedPDG++;
+    }
+    for (int j = 1; j < ancestry.fNGenerations; j++) {
+      bool compare = prong.ComparePDG(ancestry.fPdgCodes[j], prong.fPDGInHistory[k], true, prong.fExcludePDGInHistory[k]);
+      if (!prong.fExcludePDGInHistory[k] && compare) {
+        nFoundPDG++;
+        break;
+      }
+      if (prong.fExcludePDGInHistory[k] && !compare) {
+        return false;
+      }
+    }
+  }
+  return nFoundPDG == nIncludedPDG;
+}
+
 template <typename T>
 bool MCSignal::CheckProng(int i, bool checkSources, const T& track)
 {
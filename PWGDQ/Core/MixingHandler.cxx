@@ -26,7 +26,10 @@ ClassImp(MixingHandler);
 MixingHandler::MixingHandler() : TNamed(),
                                  fIsInitialized(kFALSE),
                                  fVariableLimits(),
-                                 fVariables()
+                                 fVariables(),
+                                 fNCategories(0),
+                                 fPoolDepth(0),
+                                 fPool()
 {
   //
   // default constructor
@@ -37,7 +40,10 @@ MixingHandler::MixingHandler() : TNamed(),
 MixingHandler::MixingHandler(const char* name, const char* title) : TNamed(name, title),
                                                                     fIsInitialized(kFALSE),
                                                                     fVariableLimits(),
-                                                                    fVariables()
+                                                                    fVariables(),
+                                                                    fNCategories(0),
+                                                                    fPoolDepth(0),
+                                                                    fPool()
 {
   //
   // Named constructor
@@ -115,7 +121,10 @@ void MixingHandler::Init()
   for (auto v : fVariableLimits) {
     size *= (v.GetSize() - 1);
   }
-  (void)size;
+  fNCategories = size;
+  if (fPoolDepth > 0) {
+    fPool.Init(fNCategories, fPoolDepth);
+  }
   fIsInitialized = kTRUE;
 }
 
@@ -188,3 +197,16 @@ int MixingHandler::GetBinFromCategory(VarManager::Variables var, int category) c
   truncatedCategory /= norm;
   return truncatedCategory % (fVariableLimits[tempVar].GetSize() - 1);
 }
+
+//_________________________________________________________________________
+std::vector<MixingTrack>* MixingHandler::AddEventToPool(float* values)
+{
+  //
+  // Store a new event in the pool of its category, the tracks to be mixed are then added to the returned buffer
+  //
+  int category = FindEventCategory(values);
+  if (category < 0) {
+    return nullptr;
+  }
+  return fPool.AddEvent(category);
+}
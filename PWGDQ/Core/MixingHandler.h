@@ -25,6 +25,7 @@
 #include <TString.h>
 
 #include "PWGDQ/Core/HistogramManager.h"
+#include "PWGDQ/Core/MixingPool.h"
 #include "PWGDQ/Core/VarManager.h"
 
 class MixingHandler : public TNamed
@@ -38,6 +39,7 @@ class MixingHandler : public TNamed
   // setters
   void AddMixingVariable(int var, int nBins, float* binLims);
   void AddMixingVariable(int var, int nBins, std::vector<float> binLims);
+  void SetPoolDepth(int depth) { fPoolDepth = depth; } // if set before Init(), event pools of this depth are created for all categories
 
   // getters
   int GetNMixingVariables() const { return fVariables.size(); }
@@ -47,6 +49,11 @@ class MixingHandler : public TNamed
   void Init();
   int FindEventCategory(float* values);
   int GetBinFromCategory(VarManager::Variables var, int category) const;
+  int GetNCategories() const { return fNCategories; }
+
+  // event pools
+  MixingPool& GetPool() { return fPool; }
+  std::vector<MixingTrack>* AddEventToPool(float* values); // returns the track buffer of the event to be filled, or nullptr if outside the categories
 
  private:
   MixingHandler(const MixingHandler& handler);
@@ -57,8 +64,12 @@ class MixingHandler : public TNamed
 
   std::vector<TArrayF> fVariableLimits;
   std::vector<int> fVariables;
+  int fNCategories; // number of event categories
+
+  int fPoolDepth;   // number of events kept per category, no pools if 0
+  MixingPool fPool; //! event pools
 
-  ClassDef(MixingHandler, 1);
+  ClassDef(MixingHandler, 2);
 };
 
 #endif
@@ -0,0 +1,94 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#include "PWGDQ/Core/MixingPool.h"
+
+//_________________________________________________________________________
+MixingPool::MixingPool(int nCategories, int depth)
+{
+  Init(nCategories, depth);
+}
+
+//_________________________________________________________________________
+void MixingPool::Init(int nCategories, int depth)
+{
+  //
+  // Allocate one ring buffer of "depth" events per category
+  //
+  fDepth = depth > 0 ? depth : 1;
+  fPools.clear();
+  fPools.resize(nCategories > 0 ? nCategories : 0);
+  for (auto& pool : fPools) {
+    pool.fEvents.resize(fDepth);
+  }
+}
+
+//_________________________________________________________________________
+void MixingPool::Clear()
+{
+  //
+  // Remove all the stored events, keeping the allocated memory
+  //
+  for (auto& pool : fPools) {
+    for (auto& event : pool.fEvents) {
+      event.clear();
+    }
+    pool.fNext = 0;
+    pool.fNEvents = 0;
+  }
+}
+
+//_________________________________________________________________________
+int MixingPool::GetNEvents(int category) const
+{
+  if (category < 0 || category >= GetNCategories()) {
+    return 0;
+  }
+  return fPools[category].fNEvents;
+}
+
+//_________________________________________________________________________
+std::vector<MixingTrack>* MixingPool::AddEvent(int category)
+{
+  //
+  // Take the next slot of the category ring buffer, which holds the oldest event once the pool is full
+  //
+  if (category < 0 || category >= GetNCategories()) {
+    return nullptr;
+  }
+  Pool& pool = fPools[category];
+  std::vector<MixingTrack>* event = &pool.fEvents[pool.fNext];
+  event->clear();
+  pool.fNext = (pool.fNext + 1) % fDepth;
+  if (pool.fNEvents < fDepth) {
+    pool.fNEvents++;
+  }
+  return event;
+}
+
+//_________________________________________________________________________
+void MixingPool::AddEvent(int category, const std::vector<MixingTrack>& tracks)
+{
+  std::vector<MixingTrack>* event = AddEvent(category);
+  if (event) {
+    event->assign(tracks.begin(), tracks.end());
+  }
+}
+
+//_________________________________________________________________________
+const std::vector<MixingTrack>& MixingPool::GetEvent(int category, int i) const
+{
+  //
+  // i = 0 is the most recent event, i = GetNEvents(category) - 1 the oldest one
+  //
+  const Pool& pool = fPools[category];
+  return pool.fEvents[(pool.fNext - 1 - i + 2 * fDepth) % fDepth];
+}
@@ -0,0 +1,80 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+//
+// Contact: iarsene@cern.ch, i.c.arsene@fys.uio.no
+//
+// Event pools for event mixing, one per event category of the MixingHandler.
+// Each pool is a ring buffer of a fixed number of events, holding compact track records,
+//   so that the mixing within a category runs over the pool depth without re-reading the tables.
+// The memory is reused once the pools are full: a new event replaces the oldest one in its category.
+//
+
+#ifndef MixingPool_H
+#define MixingPool_H
+
+#include <cstdint>
+#include <vector>
+
+//_________________________________________________________________________
+struct MixingTrack {
+  float fPt;
+  float fEta;
+  float fPhi;
+  int8_t fCharge;
+  uint32_t fFilterMap; // bit map of the track cuts passed
+};
+
+//_________________________________________________________________________
+class MixingPool
+{
+ public:
+  MixingPool() = default;
+  MixingPool(int nCategories, int depth);
+  ~MixingPool() = default;
+
+  void Init(int nCategories, int depth);
+  void Clear();
+
+  int GetNCategories() const { return fPools.size(); }
+  int GetDepth() const { return fDepth; }
+  // number of events currently stored for a category, at most the pool depth
+  int GetNEvents(int category) const;
+
+  // Store an event in its category pool, replacing the oldest event if the pool is full.
+  // Returns the track buffer of the new event to be filled by the caller, or nullptr for an invalid category
+  std::vector<MixingTrack>* AddEvent(int category);
+  void AddEvent(int category, const std::vector<MixingTrack>& tracks);
+
+  // Tracks of the i-th stored event of a category, with i = 0 being the most recent one
+  const std::vector<MixingTrack>& GetEvent(int category, int i) const;
+
+  // Call f(tracks) for all the stored events of a category, from the most recent to the oldest
+  template <typename F>
+  void ForEachEvent(int category, F&& f) const
+  {
+    int nEvents = GetNEvents(category);
+    for (int i = 0; i < nEvents; ++i) {
+      f(GetEvent(category, i));
+    }
+  }
+
+ private:
+  struct Pool {
+    std::vector<std::vector<MixingTrack>> fEvents; // ring buffer of events, with fixed size equal to the pool depth
+    int fNext = 0;                                 // slot of the next event to be stored
+    int fNEvents = 0;                              // number of events stored
+  };
+
+  int fDepth = 0;
+  std::vector<Pool> fPools; // one pool per event category
+};
+
+#endif
@@ -8,8 +8,11 @@
 // In applying this license CERN does not waive the privileges and immunities
 // granted to it by virtue of its status as an Intergovernmental Organization
 // or submit itself to any jurisdiction.
+#include <algorithm>
 #include <cmath>
+#include <iterator>
 #include "PWGDQ/Core/VarManager.h"
+#include "Framework/Logger.h"
 #include "Tools/KFparticle/KFUtilities.h"
 
 using std::cout;
@@ -22,6 +25,8 @@ TString VarManager::fgVariableNames[VarManager::kNVars] = {""};
 TString VarManager::fgVariableUnits[VarManager::kNVars] = {""};
 bool VarManager::fgUsedVars[VarManager::kNVars] = {false};
 bool VarManager::fgUsedKF = false;
+bool VarManager::fgPruneUnusedVars = false;
+bool VarManager::fgUsedVarGroups[VarManager::kNVarGroups] = {false};
 float VarManager::fgMagField = 0.5;
 float VarManager::fgValues[VarManager::kNVars] = {0.0f};
 std::map<int, int> VarManager::fgRunMap;
@@ -39,6 +44,8 @@ o2::vertexing::DCAFitterN<3> VarManager::fgFitterThreeProngBarrel;
 o2::vertexing::FwdDCAFitterN<2> VarManager::fgFitterTwoProngFwd;
 o2::vertexing::FwdDCAFitterN<3> VarManager::fgFitterThreeProngFwd;
 o2::globaltracking::MatchGlobalFwd VarManager::mMatching;
+std::unordered_map<uint64_t, VarManager::PropagatedMuon> VarManager::fgPropagatedMuons;
+bool VarManager::fgUseMuonPropagationCache = true;
 std::map<VarManager::CalibObjects, TObject*> VarManager::fgCalibs;
 bool VarManager::fgRunTPCPostCalibration[4] = {false, false, false, false};
 
@@ -54,39 +61,103 @@ VarManager::VarManager() : TObject()
 //__________________________________________________________________
 VarManager::~VarManager() = default;
 
+namespace
+{
+// Variables needed to compute a derived variable
+const std::vector<std::pair<int, std::vector<int>>> gVarDependencies = {
+  {VarManager::kP, {VarManager::kPt, VarManager::kEta}},
+  {VarManager::kVertexingLxyOverErr, {VarManager::kVertexingLxy, VarManager::kVertexingLxyErr}},
+  {VarManager::kVertexingLzOverErr, {VarManager::kVertexingLz, VarManager::kVertexingLzErr}},
+  {VarManager::kVertexingLxyzOverErr, {VarManager::kVertexingLxyz, VarManager::kVertexingLxyzErr}},
+  {VarManager::kKFTracksDCAxyzMax, {VarManager::kKFTrack0DCAxyz, VarManager::kKFTrack1DCAxyz}},
+  {VarManager::kKFTracksDCAxyMax, {VarManager::kKFTrack0DCAxy, VarManager::kKFTrack1DCAxy}},
+  {VarManager::kTrackIsInsideTPCModule, {VarManager::kPhiTPCOuter}}};
+
+// Variables computed by each group of VarManager::VarGroups
+const std::vector<int> gVarGroupMembers[VarManager::kNVarGroups] = {
+  // kVarGroupPairPolarization
+  {VarManager::kCosThetaHE, VarManager::kPhiHE, VarManager::kCosThetaCS, VarManager::kPhiCS},
+  // kVarGroupPairVertexing
+  {VarManager::kVertexingProcCode, VarManager::kVertexingChi2PCA, VarManager::kVertexingLxy, VarManager::kVertexingLxyz, VarManager::kVertexingLz,
+   VarManager::kVertexingLxyErr, VarManager::kVertexingLxyzErr, VarManager::kVertexingLzErr, VarManager::kVertexingLxyOverErr, VarManager::kVertexingLxyzOverErr, VarManager::kVertexingLzOverErr,
+   VarManager::kVertexingTauxy, VarManager::kVertexingTauz, VarManager::kVertexingTauxyErr, VarManager::kVertexingTauzErr, VarManager::kVertexingPz, VarManager::kVertexingSV,
+   VarManager::kVertexingLxyProjected, VarManager::kVertexingLxyzProjected, VarManager::kVertexingLzProjected,
+   VarManager::kVertexingTauxyProjected, VarManager::kVertexingTauxyProjectedNs, VarManager::kVertexingTauzProjected, VarManager::kVertexingTauxyzProjected,
+   VarManager::kCosPointingAngle, VarManager::kUsedKF, VarManager::kPt1, VarManager::kEta1, VarManager::kPhi1, VarManager::kPt2, VarManager::kEta2, VarManager::kPhi2,
+   VarManager::kKFMass, VarManager::kKFChi2OverNDFGeo, VarManager::kKFCosPA, VarManager::kKFNContributorsPV,
+   VarManager::kKFTrack0DCAxyz, VarManager::kKFTrack1DCAxyz, VarManager::kKFTracksDCAxyzMax, VarManager::kKFDCAxyzBetweenProngs,
+   VarManager::kKFTrack0DCAxy, VarManager::kKFTrack1DCAxy, VarManager::kKFTracksDCAxyMax, VarManager::kKFDCAxyBetweenProngs,
+   VarManager::kKFTrack0DeviationFromPV, VarManager::kKFTrack1DeviationFromPV, VarManager::kKFTrack0DeviationxyFromPV, VarManager::kKFTrack1DeviationxyFromPV,
+   VarManager::kKFJpsiDCAxyz, VarManager::kKFJpsiDCAxy, VarManager::kKFPairDeviationFromPV, VarManager::kKFPairDeviationxyFromPV,
+   VarManager::kKFChi2OverNDFGeoTop, VarManager::kKFMassGeoTop}};
+
+const char* gVarGroupNames[VarManager::kNVarGroups] = {"pair polarization frames", "pair vertexing"};
+} // namespace
+
 //__________________________________________________________________
 void VarManager::SetVariableDependencies()
 {
   //
   // Set as used variables on which other variables calculation depends
   //
-  if (fgUsedVars[kP]) {
-    fgUsedVars[kPt] = true;
-    fgUsedVars[kEta] = true;
+  // iterate until no new variable is toggled, so that chains of dependencies are resolved
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (const auto& [var, dependencies] : gVarDependencies) {
+      if (!fgUsedVars[var]) {
+        continue;
+      }
+      for (const auto& dependency : dependencies) {
+        if (!fgUsedVars[dependency]) {
+          fgUsedVars[dependency] = true;
+          changed = true;
+        }
+      }
+    }
   }
 
-  if (fgUsedVars[kVertexingLxyOverErr]) {
-    fgUsedVars[kVertexingLxy] = true;
-    fgUsedVars[kVertexingLxyErr] = true;
+  for (int group = 0; group < kNVarGroups; ++group) {
+    fgUsedVarGroups[group] = false;
+    for (const auto& var : gVarGroupMembers[group]) {
+      if (fgUsedVars[var]) {
+        fgUsedVarGroups[group] = true;
+        break;
+      }
+    }
   }
-  if (fgUsedVars[kVertexingLzOverErr]) {
-    fgUsedVars[kVertexingLz] = true;
-    fgUsedVars[kVertexingLzErr] = true;
-  }
-  if (fgUsedVars[kVertexingLxyzOverErr]) {
-    fgUsedVars[kVertexingLxyz] = true;
-    fgUsedVars[kVertexingLxyzErr] = true;
-  }
-  if (fgUsedVars[kKFTracksDCAxyzMax]) {
-    fgUsedVars[kKFTrack0DCAxyz] = true;
-    fgUsedVars[kKFTrack1DCAxyz] = true;
-  }
-  if (fgUsedVars[kKFTracksDCAxyMax]) {
-    fgUsedVars[kKFTrack0DCAxy] = true;
-    fgUsedVars[kKFTrack1DCAxy] = true;
+}
+
+//__________________________________________________________________
+void VarManager::InitContext(VarContext& ctx)
+{
+  //
+  // Copy the static configuration into a fill context
+  //
+  std::copy(std::begin(fgUsedVars), std::end(fgUsedVars), std::begin(ctx.fUsedVars));
+  std::copy(std::begin(fgUsedVarGroups), std::end(fgUsedVarGroups), std::begin(ctx.fUsedVarGroups));
+  ctx.fPruneUnusedVars = fgPruneUnusedVars;
+  ctx.fUsedKF = fgUsedKF;
+  ctx.fMagField = fgMagField;
+  ctx.fFitterTwoProngBarrel = fgFitterTwoProngBarrel;
+  ctx.fFitterTwoProngFwd = fgFitterTwoProngFwd;
+}
+
+//__________________________________________________________________
+void VarManager::PrintUsedVars()
+{
+  //
+  // Report the used variables and the variable groups which are not computed
+  //
+  int nUsed = 0;
+  for (int i = 0; i < kNVars; ++i) {
+    nUsed += fgUsedVars[i];
   }
-  if (fgUsedVars[kTrackIsInsideTPCModule]) {
-    fgUsedVars[kPhiTPCOuter] = true;
+  LOGF(info, "VarManager: %d out of %d variables are used, pruning of unused variable groups is %s", nUsed, static_cast<int>(kNVars), fgPruneUnusedVars ? "enabled" : "disabled");
+  for (int group = 0; group < kNVarGroups; ++group) {
+    if (!fgUsedVarGroups[group]) {
+      LOGF(info, "VarManager: no variable used from the group %s, %s", gVarGroupNames[group], fgPruneUnusedVars ? "not computed" : "computed anyway");
+    }
   }
 }
 
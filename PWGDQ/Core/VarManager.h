@@ -25,6 +25,7 @@
 
 #include <vector>
 #include <map>
+#include <unordered_map>
 #include <cmath>
 #include <iostream>
 #include <utility>
@@ -706,6 +707,14 @@ class VarManager : public TObject
     for (auto& var : usedVars) {
       fgUsedVars[var] = true;
     }
+    SetVariableDependencies();
+  }
+  static void ResetUsedVars()
+  {
+    for (int i = 0; i < kNVars; ++i) {
+      fgUsedVars[i] = false;
+    }
+    SetVariableDependencies();
   }
   static bool GetUsedVar(int var)
   {
@@ -715,6 +724,25 @@ class VarManager : public TObject
     return false;
   }
 
+  // Groups of variables computed together in the Fill functions
+  // With pruning enabled, a group is computed only if at least one of its variables is used (directly or through a dependency)
+  // NOTE: variables written to tables must then be declared with SetUseVariable() as well
+  enum VarGroups {
+    kVarGroupPairPolarization = 0, // helicity and Collins-Soper frames in FillPair
+    kVarGroupPairVertexing,        // DCAFitter / KFParticle in FillPairVertexing
+    kNVarGroups
+  };
+  static void SetPruneUnusedVars(bool prune)
+  {
+    fgPruneUnusedVars = prune;
+    SetVariableDependencies();
+  }
+  static bool GetUsedVarGroup(int group)
+  {
+    return !fgPruneUnusedVars || fgUsedVarGroups[group];
+  }
+  static void PrintUsedVars(); // report the used variables and the pruned groups
+
   static void SetRunNumbers(int n, int* runs);
   static void SetRunNumbers(std::vector<int> runs);
   static float GetRunIndex(double);
@@ -756,6 +784,17 @@ class VarManager : public TObject
   static void SetupMuonMagField()
   {
     o2::mch::TrackExtrap::setField();
+    ResetMuonPropagationCache();
+  }
+  // Empty the cache of the propagated muons, to be called at the beginning of each dataframe
+  static void ResetMuonPropagationCache()
+  {
+    fgPropagatedMuons.clear();
+  }
+  static void SetUseMuonPropagationCache(bool use)
+  {
+    fgUseMuonPropagationCache = use;
+    ResetMuonPropagationCache();
   }
 
   // Setup the 2 prong DCAFitterN
@@ -837,8 +876,28 @@ class VarManager : public TObject
     return deltaPsi;
   }
 
+  // Fill state owned by a context: value array, used variables, magnetic field and two-prong fitters.
+  // The static members are the default context used by the static API, while separate VarContext instances
+  // can be filled concurrently, e.g. one per thread when parallelising the pairing loops
+  struct VarContext {
+    float fValues[kNVars] = {0.0f};
+    bool fUsedVars[kNVars] = {false};
+    bool fUsedVarGroups[kNVarGroups] = {false};
+    bool fPruneUnusedVars = false;
+    bool fUsedKF = false;
+    float fMagField = 0.5;
+    o2::vertexing::DCAFitterN<2> fFitterTwoProngBarrel;
+    o2::vertexing::FwdDCAFitterN<2> fFitterTwoProngFwd;
+  };
+  // copy the static configuration into a context, to be called again whenever it changes (e.g. at a run change)
+  static void InitContext(VarContext& ctx);
+
   template <typename T, typename C>
   static o2::dataformats::GlobalFwdTrack PropagateMuon(const T& muon, const C& collision, int endPoint = kToVertex);
+  // PropagateMuon through the per-dataframe cache, such that a muon is propagated once per collision and end point
+  // whatever the number of pairs it enters. The returned reference is valid until the next call
+  template <typename T, typename C>
+  static const o2::dataformats::GlobalFwdTrack& GetPropagatedMuon(const T& muon, const C& collision, int endPoint = kToVertex);
   template <uint32_t fillMap, typename T, typename C>
   static void FillMuonPDca(const T& muon, const C& collision, float* values = nullptr);
   template <uint32_t fillMap, typename T, typename C>
@@ -863,6 +922,8 @@ class VarManager : public TObject
   static void FillPairPropagateMuon(T1 const& muon1, T2 const& muon2, const C& collision, float* values = nullptr);
   template <int pairType, uint32_t fillMap, typename T1, typename T2>
   static void FillPair(T1 const& t1, T2 const& t2, float* values = nullptr);
+  template <int pairType, uint32_t fillMap, typename T1, typename T2>
+  static void FillPair(T1 const& t1, T2 const& t2, VarContext& ctx);
   template <typename T1, typename T2, typename T3>
   static void FillTriple(T1 const& t1, T2 const& t2, T3 const& t3, float* values = nullptr, PairCandidateType pairType = kTripleCandidateToEEPhoton);
   template <int pairType, typename T1, typename T2>
@@ -873,6 +934,8 @@ class VarManager : public TObject
   static void FillTripleMC(T1 const& t1, T2 const& t2, T3 const& t3, float* values = nullptr, PairCandidateType pairType = kTripleCandidateToEEPhoton);
   template <int pairType, uint32_t collFillMap, uint32_t fillMap, typename C, typename T>
   static void FillPairVertexing(C const& collision, T const& t1, T const& t2, bool propToSV = false, float* values = nullptr);
+  template <int pairType, uint32_t collFillMap, uint32_t fillMap, typename C, typename T>
+  static void FillPairVertexing(C const& collision, T const& t1, T const& t2, bool propToSV, VarContext& ctx);
   template <uint32_t collFillMap, uint32_t fillMap, typename C, typename T>
   static void FillTripletVertexing(C const& collision, T const& t1, T const& t2, T const& t3, PairCandidateType tripletType, float* values = nullptr);
   template <int candidateType, uint32_t collFillMap, uint32_t fillMap, typename C, typename T1>
@@ -948,7 +1011,9 @@ class VarManager : public TObject
  private:
   static bool fgUsedVars[kNVars]; // holds flags for when the corresponding variable is needed (e.g., in the histogram manager, in cuts, mixing handler, etc.)
   static bool fgUsedKF;
-  static void SetVariableDependencies(); // toggle those variables on which other used variables might depend
+  static bool fgPruneUnusedVars;            // compute only the variable groups needed by the used variables
+  static bool fgUsedVarGroups[kNVarGroups]; // flags for the variable groups containing used variables
+  static void SetVariableDependencies();    // toggle those variables on which other used variables might depend
 
   static float fgMagField;
   static std::map<int, int> fgRunMap;     // map of runs to be used in histogram axes
@@ -962,6 +1027,31 @@ class VarManager : public TObject
   static int fgITSROFBorderMarginLow;     // ITS ROF border low margin
   static int fgITSROFBorderMarginHigh;    // ITS ROF border high margin
 
+  // Non-owning view of the fill state, pointing either to the static members or to a VarContext
+  struct FillState {
+    float* values;
+    const bool* usedVars;
+    const bool* usedVarGroups;
+    bool pruneUnusedVars;
+    bool usedKF;
+    float magField;
+    o2::vertexing::DCAFitterN<2>* fitterTwoProngBarrel;
+    o2::vertexing::FwdDCAFitterN<2>* fitterTwoProngFwd;
+    bool UsedVarGroup(int group) const { return !pruneUnusedVars || usedVarGroups[group]; }
+  };
+  static FillState GetFillState(float* values)
+  {
+    return {values ? values : fgValues, fgUsedVars, fgUsedVarGroups, fgPruneUnusedVars, fgUsedKF, fgMagField, &fgFitterTwoProngBarrel, &fgFitterTwoProngFwd};
+  }
+  static FillState GetFillState(VarContext& ctx)
+  {
+    return {ctx.fValues, ctx.fUsedVars, ctx.fUsedVarGroups, ctx.fPruneUnusedVars, ctx.fUsedKF, ctx.fMagField, &ctx.fFitterTwoProngBarrel, &ctx.fFitterTwoProngFwd};
+  }
+  template <int pairType, uint32_t fillMap, typename T1, typename T2>
+  static void FillPairImpl(T1 const& t1, T2 const& t2, const FillState& state);
+  template <int pairType, uint32_t collFillMap, uint32_t fillMap, typename C, typename T>
+  static void FillPairVertexingImpl(C const& collision, T const& t1, T const& t2, bool propToSV, const FillState& state);
+
   static void FillEventDerived(float* values = nullptr);
   static void FillTrackDerived(float* values = nullptr);
   template <typename T, typename U, typename V>
@@ -974,7 +1064,7 @@ class VarManager : public TObject
   static KFPVertex createKFPVertexFromCollision(const T& collision);
   static float calculateCosPA(KFParticle kfp, KFParticle PV);
   template <int pairType, typename T1, typename T2>
-  static float calculatePhiV(const T1& t1, const T2& t2);
+  static float calculatePhiV(const T1& t1, const T2& t2, float bz);
 
   static o2::vertexing::DCAFitterN<2> fgFitterTwoProngBarrel;
   static o2::vertexing::DCAFitterN<3> fgFitterThreeProngBarrel;
@@ -982,6 +1072,17 @@ class VarManager : public TObject
   static o2::vertexing::FwdDCAFitterN<3> fgFitterThreeProngFwd;
   static o2::globaltracking::MatchGlobalFwd mMatching;
 
+  // Muons propagated in the current dataframe, keyed by muon index, collision index and end point. The parameters
+  // of the muon and of the vertex are kept to check the entry, such that a stale entry is never used
+  struct PropagatedMuon {
+    float muonZ;
+    float muonSigned1Pt;
+    float collisionPosZ;
+    o2::dataformats::GlobalFwdTrack track;
+  };
+  static std::unordered_map<uint64_t, PropagatedMuon> fgPropagatedMuons;
+  static bool fgUseMuonPropagationCache;
+
   static std::map<CalibObjects, TObject*> fgCalibs; // map of calibration histograms
   static bool fgRunTPCPostCalibration[4];           // 0-electron, 1-pion, 2-kaon, 3-proton
 
@@ -1123,6 +1224,23 @@ o2::dataformats::GlobalFwdTrack VarManager::PropagateMuon(const T& muon, const C
   return propmuon;
 }
 
+template <typename T, typename C>
+const o2::dataformats::GlobalFwdTrack& VarManager::GetPropagatedMuon(const T& muon, const C& collision, const int endPoint)
+{
+  static o2::dataformats::GlobalFwdTrack propmuon;
+  if (!fgUseMuonPropagationCache) {
+    propmuon = PropagateMuon(muon, collision, endPoint);
+    return propmuon;
+  }
+  const uint64_t key = (static_cast<uint64_t>(muon.globalIndex()) << 32) | ((static_cast<uint64_t>(collision.globalIndex()) & 0x3fffffff) << 2) | endPoint;
+  auto [entry, inserted] = fgPropagatedMuons.try_emplace(key);
+  auto& cached = entry->second;
+  if (inserted || cached.muonZ != muon.z() || cached.muonSigned1Pt != muon.signed1Pt() || cached.collisionPosZ != collision.posZ()) {
+    cached = {muon.z(), muon.signed1Pt(), collision.posZ(), PropagateMuon(muon, collision, endPoint)};
+  }
+  return cached.track;
+}
+
 template <uint32_t fillMap, typename T, typename C>
 void VarManager::FillMuonPDca(const T& muon, const C& collision, float* values)
 {
@@ -1132,8 +1250,7 @@ void VarManager::FillMuonPDca(const T& muon, const C& collision, float* values)
 
   if constexpr ((fillMap & MuonCov) > 0 || (fillMap & ReducedMuonCov) > 0) {
 
-    o2::dataformats::GlobalFwdTrack propmuon = PropagateMuon(muon, collision);
-    o2::dataformats::GlobalFwdTrack propmuonAtDCA = PropagateMuon(muon, collision, kToDCA);
+    const o2::dataformats::GlobalFwdTrack propmuonAtDCA = GetPropagatedMuon(muon, collision, kToDCA);
 
     float dcaX = (propmuonAtDCA.getX() - collision.posX());
     float dcaY = (propmuonAtDCA.getY() - collision.posY());
@@ -1156,7 +1273,7 @@ void VarManager::FillPropagateMuon(const T& muon, const C& collision, float* val
   }
 
   if constexpr ((fillMap & MuonCov) > 0 || (fillMap & ReducedMuonCov) > 0) {
-    o2::dataformats::GlobalFwdTrack propmuon = PropagateMuon(muon, collision);
+    const o2::dataformats::GlobalFwdTrack propmuon = GetPropagatedMuon(muon, collision);
     values[kPt] = propmuon.getPt();
     values[kX] = propmuon.getX();
     values[kY] = propmuon.getY();
@@ -1168,8 +1285,8 @@ void VarManager::FillPropagateMuon(const T& muon, const C& collision, float* val
     // Redo propagation only for muon tracks
     // propagation of MFT tracks alredy done in fwdtrack-extention task
     if (static_cast<int>(muon.trackType()) > 2) {
-      o2::dataformats::GlobalFwdTrack propmuonAtDCA = PropagateMuon(muon, collision, kToDCA);
-      o2::dataformats::GlobalFwdTrack propmuonAtRabs = PropagateMuon(muon, collision, kToRabs);
+      const o2::dataformats::GlobalFwdTrack propmuonAtDCA = GetPropagatedMuon(muon, collision, kToDCA);
+      const o2::dataformats::GlobalFwdTrack propmuonAtRabs = GetPropagatedMuon(muon, collision, kToRabs);
       float dcaX = (propmuonAtDCA.getX() - collision.posX());
       float dcaY = (propmuonAtDCA.getY() - collision.posY());
       values[kMuonDCAx] = dcaX;
@@ -2068,8 +2185,7 @@ void VarManager::FillTrackCollision(T const& track, C const& collision, float* v
   }
   if constexpr ((fillMap & MuonCov) > 0 || (fillMap & ReducedMuonCov) > 0) {
 
-    o2::dataformats::GlobalFwdTrack propmuon = PropagateMuon(track, collision);
-    o2::dataformats::GlobalFwdTrack propmuonAtDCA = PropagateMuon(track, collision, kToDCA);
+    const o2::dataformats::GlobalFwdTrack propmuonAtDCA = GetPropagatedMuon(track, collision, kToDCA);
 
     float dcaX = (propmuonAtDCA.getX() - collision.posX());
     float dcaY = (propmuonAtDCA.getY() - collision.posY());
@@ -2179,8 +2295,8 @@ void VarManager::FillPairPropagateMuon(T1 const& muon1, T2 const& muon2, const C
   if (!values) {
     values = fgValues;
   }
-  o2::dataformats::GlobalFwdTrack propmuon1 = PropagateMuon(muon1, collision);
-  o2::dataformats::GlobalFwdTrack propmuon2 = PropagateMuon(muon2, collision);
+  const o2::dataformats::GlobalFwdTrack propmuon1 = GetPropagatedMuon(muon1, collision);
+  const o2::dataformats::GlobalFwdTrack propmuon2 = GetPropagatedMuon(muon2, collision);
 
   float m = o2::constants::physics::MassMuon;
 
@@ -2201,9 +2317,19 @@ void VarManager::FillPairPropagateMuon(T1 const& muon1, T2 const& muon2, const C
 template <int pairType, uint32_t fillMap, typename T1, typename T2>
 void VarManager::FillPair(T1 const& t1, T2 const& t2, float* values)
 {
-  if (!values) {
-    values = fgValues;
-  }
+  FillPairImpl<pairType, fillMap>(t1, t2, GetFillState(values));
+}
+
+template <int pairType, uint32_t fillMap, typename T1, typename T2>
+void VarManager::FillPair(T1 const& t1, T2 const& t2, VarContext& ctx)
+{
+  FillPairImpl<pairType, fillMap>(t1, t2, GetFillState(ctx));
+}
+
+template <int pairType, uint32_t fillMap, typename T1, typename T2>
+void VarManager::FillPairImpl(T1 const& t1, T2 const& t2, const FillState& state)
+{
+  float* values = state.values;
 
   float m1 = o2::constants::physics::MassElectron;
   float m2 = o2::constants::physics::MassElectron;
@@ -2238,13 +2364,13 @@ void VarManager::FillPair(T1 const& t1, T2 const& t2, float* values)
   double Ptot2 = TMath::Sqrt(v2.Px() * v2.Px() + v2.Py() * v2.Py() + v2.Pz() * v2.Pz());
   values[kDeltaPtotTracks] = Ptot1 - Ptot2;
 
-  if (fgUsedVars[kPsiPair]) {
-    values[kDeltaPhiPair] = (t1.sign() * fgMagField > 0.) ? (v1.Phi() - v2.Phi()) : (v2.Phi() - v1.Phi());
+  if (state.usedVars[kPsiPair]) {
+    values[kDeltaPhiPair] = (t1.sign() * state.magField > 0.) ? (v1.Phi() - v2.Phi()) : (v2.Phi() - v1.Phi());
     double xipair = TMath::ACos((v1.Px() * v2.Px() + v1.Py() * v2.Py() + v1.Pz() * v2.Pz()) / v1.P() / v2.P());
-    values[kPsiPair] = (t1.sign() * fgMagField > 0.) ? TMath::ASin((v1.Theta() - v2.Theta()) / xipair) : TMath::ASin((v2.Theta() - v1.Theta()) / xipair);
+    values[kPsiPair] = (t1.sign() * state.magField > 0.) ? TMath::ASin((v1.Theta() - v2.Theta()) / xipair) : TMath::ASin((v2.Theta() - v1.Theta()) / xipair);
   }
 
-  if (fgUsedVars[kOpeningAngle]) {
+  if (state.usedVars[kOpeningAngle]) {
     double scalar = v1.Px() * v2.Px() + v1.Py() * v2.Py() + v1.Pz() * v2.Pz();
     double Ptot12 = Ptot1 * Ptot2;
     if (Ptot12 <= 0) {
@@ -2259,47 +2385,49 @@ void VarManager::FillPair(T1 const& t1, T2 const& t2, float* values)
     }
   }
 
-  // TO DO: get the correct values from CCDB
-  double BeamMomentum = TMath::Sqrt(fgCenterOfMassEnergy * fgCenterOfMassEnergy / 4 - fgMassofCollidingParticle * fgMassofCollidingParticle); // GeV
-  ROOT::Math::PxPyPzEVector Beam1(0., 0., -BeamMomentum, fgCenterOfMassEnergy / 2);
-  ROOT::Math::PxPyPzEVector Beam2(0., 0., BeamMomentum, fgCenterOfMassEnergy / 2);
+  if (state.UsedVarGroup(kVarGroupPairPolarization)) {
+    // TO DO: get the correct values from CCDB
+    double BeamMomentum = TMath::Sqrt(fgCenterOfMassEnergy * fgCenterOfMassEnergy / 4 - fgMassofCollidingParticle * fgMassofCollidingParticle); // GeV
+    ROOT::Math::PxPyPzEVector Beam1(0., 0., -BeamMomentum, fgCenterOfMassEnergy / 2);
+    ROOT::Math::PxPyPzEVector Beam2(0., 0., BeamMomentum, fgCenterOfMassEnergy / 2);
 
-  // Boost to center of mass frame
-  ROOT::Math::Boost boostv12{v12.BoostToCM()};
-  ROOT::Math::XYZVectorF v1_CM{(boostv12(v1).Vect()).Unit()};
-  ROOT::Math::XYZVectorF v2_CM{(boostv12(v2).Vect()).Unit()};
-  ROOT::Math::XYZVectorF Beam1_CM{(boostv12(Beam1).Vect()).Unit()};
-  ROOT::Math::XYZVectorF Beam2_CM{(boostv12(Beam2).Vect()).Unit()};
+    // Boost to center of mass frame
+    ROOT::Math::Boost boostv12{v12.BoostToCM()};
+    ROOT::Math::XYZVectorF v1_CM{(boostv12(v1).Vect()).Unit()};
+    ROOT::Math::XYZVectorF v2_CM{(boostv12(v2).Vect()).Unit()};
+    ROOT::Math::XYZVectorF Beam1_CM{(boostv12(Beam1).Vect()).Unit()};
+    ROOT::Math::XYZVectorF Beam2_CM{(boostv12(Beam2).Vect()).Unit()};
 
-  // Helicity frame
-  ROOT::Math::XYZVectorF zaxis_HE{(v12.Vect()).Unit()};
-  ROOT::Math::XYZVectorF yaxis_HE{(Beam1_CM.Cross(Beam2_CM)).Unit()};
-  ROOT::Math::XYZVectorF xaxis_HE{(yaxis_HE.Cross(zaxis_HE)).Unit()};
+    // Helicity frame
+    ROOT::Math::XYZVectorF zaxis_HE{(v12.Vect()).Unit()};
+    ROOT::Math::XYZVectorF yaxis_HE{(Beam1_CM.Cross(Beam2_CM)).Unit()};
+    ROOT::Math::XYZVectorF xaxis_HE{(yaxis_HE.Cross(zaxis_HE)).Unit()};
 
-  // Collins-Soper frame
-  ROOT::Math::XYZVectorF zaxis_CS{((Beam1_CM.Unit() - Beam2_CM.Unit()).Unit())};
-  ROOT::Math::XYZVectorF yaxis_CS{(Beam1_CM.Cross(Beam2_CM)).Unit()};
-  ROOT::Math::XYZVectorF xaxis_CS{(yaxis_CS.Cross(zaxis_CS)).Unit()};
+    // Collins-Soper frame
+    ROOT::Math::XYZVectorF zaxis_CS{((Beam1_CM.Unit() - Beam2_CM.Unit()).Unit())};
+    ROOT::Math::XYZVectorF yaxis_CS{(Beam1_CM.Cross(Beam2_CM)).Unit()};
+    ROOT::Math::XYZVectorF xaxis_CS{(yaxis_CS.Cross(zaxis_CS)).Unit()};
 
-  if (fgUsedVars[kCosThetaHE]) {
-    values[kCosThetaHE] = (t1.sign() > 0 ? zaxis_HE.Dot(v1_CM) : zaxis_HE.Dot(v2_CM));
-  }
+    if (state.usedVars[kCosThetaHE]) {
+      values[kCosThetaHE] = (t1.sign() > 0 ? zaxis_HE.Dot(v1_CM) : zaxis_HE.Dot(v2_CM));
+    }
 
-  if (fgUsedVars[kPhiHE]) {
-    values[kPhiHE] = (t1.sign() > 0 ? TMath::ATan2(yaxis_HE.Dot(v1_CM), xaxis_HE.Dot(v1_CM)) : TMath::ATan2(yaxis_HE.Dot(v2_CM), xaxis_HE.Dot(v2_CM)));
-  }
+    if (state.usedVars[kPhiHE]) {
+      values[kPhiHE] = (t1.sign() > 0 ? TMath::ATan2(yaxis_HE.Dot(v1_CM), xaxis_HE.Dot(v1_CM)) : TMath::ATan2(yaxis_HE.Dot(v2_CM), xaxis_HE.Dot(v2_CM)));
+    }
 
-  if (fgUsedVars[kCosThetaCS]) {
-    values[kCosThetaCS] = (t1.sign() > 0 ? zaxis_CS.Dot(v1_CM) : zaxis_CS.Dot(v2_CM));
-  }
+    if (state.usedVars[kCosThetaCS]) {
+      values[kCosThetaCS] = (t1.sign() > 0 ? zaxis_CS.Dot(v1_CM) : zaxis_CS.Dot(v2_CM));
+    }
 
-  if (fgUsedVars[kPhiCS]) {
-    values[kPhiCS] = (t1.sign() > 0 ? TMath::ATan2(yaxis_CS.Dot(v1_CM), xaxis_CS.Dot(v1_CM)) : TMath::ATan2(yaxis_CS.Dot(v2_CM), xaxis_CS.Dot(v2_CM)));
+    if (state.usedVars[kPhiCS]) {
+      values[kPhiCS] = (t1.sign() > 0 ? TMath::ATan2(yaxis_CS.Dot(v1_CM), xaxis_CS.Dot(v1_CM)) : TMath::ATan2(yaxis_CS.Dot(v2_CM), xaxis_CS.Dot(v2_CM)));
+    }
   }
 
   if constexpr ((pairType == kDecayToEE) && ((fillMap & TrackCov) > 0 || (fillMap & ReducedTrackBarrelCov) > 0)) {
 
-    if (fgUsedVars[kQuadDCAabsXY] || fgUsedVars[kQuadDCAsigXY] || fgUsedVars[kQuadDCAabsZ] || fgUsedVars[kQuadDCAsigZ] || fgUsedVars[kQuadDCAsigXYZ] || fgUsedVars[kSignQuadDCAsigXY]) {
+    if (state.usedVars[kQuadDCAabsXY] || state.usedVars[kQuadDCAsigXY] || state.usedVars[kQuadDCAabsZ] || state.usedVars[kQuadDCAsigZ] || state.usedVars[kQuadDCAsigXYZ] || state.usedVars[kSignQuadDCAsigXY]) {
       // Quantities based on the barrel tables
       double dca1XY = t1.dcaXY();
       double dca2XY = t2.dcaXY();
@@ -2332,7 +2460,7 @@ void VarManager::FillPair(T1 const& t1, T2 const& t2, float* values)
     }
   }
   if constexpr ((pairType == kDecayToMuMu) && ((fillMap & Muon) > 0 || (fillMap & ReducedMuon) > 0)) {
-    if (fgUsedVars[kQuadDCAabsXY]) {
+    if (state.usedVars[kQuadDCAabsXY]) {
       double dca1X = t1.fwdDcaX();
       double dca1Y = t1.fwdDcaY();
       double dca1XY = std::sqrt(dca1X * dca1X + dca1Y * dca1Y);
@@ -2342,8 +2470,8 @@ void VarManager::FillPair(T1 const& t1, T2 const& t2, float* values)
       values[kQuadDCAabsXY] = std::sqrt((dca1XY * dca1XY + dca2XY * dca2XY) / 2.);
     }
   }
-  if (fgUsedVars[kPairPhiv]) {
-    values[kPairPhiv] = calculatePhiV<pairType>(t1, t2);
+  if (state.usedVars[kPairPhiv]) {
+    values[kPairPhiv] = calculatePhiV<pairType>(t1, t2, state.magField);
   }
 }
 
@@ -2469,7 +2597,7 @@ void VarManager::FillPairME(T1 const& t1, T2 const& t2, float* values)
     }
   }
   if (fgUsedVars[kPairPhiv]) {
-    values[kPairPhiv] = calculatePhiV<pairType>(t1, t2);
+    values[kPairPhiv] = calculatePhiV<pairType>(t1, t2, fgMagField);
   }
 }
 
@@ -2546,14 +2674,28 @@ void VarManager::FillTripleMC(T1 const& t1, T2 const& t2, T3 const& t3, float* v
 
 template <int pairType, uint32_t collFillMap, uint32_t fillMap, typename C, typename T>
 void VarManager::FillPairVertexing(C const& collision, T const& t1, T const& t2, bool propToSV, float* values)
+{
+  FillPairVertexingImpl<pairType, collFillMap, fillMap>(collision, t1, t2, propToSV, GetFillState(values));
+}
+
+template <int pairType, uint32_t collFillMap, uint32_t fillMap, typename C, typename T>
+void VarManager::FillPairVertexing(C const& collision, T const& t1, T const& t2, bool propToSV, VarContext& ctx)
+{
+  FillPairVertexingImpl<pairType, collFillMap, fillMap>(collision, t1, t2, propToSV, GetFillState(ctx));
+}
+
+template <int pairType, uint32_t collFillMap, uint32_t fillMap, typename C, typename T>
+void VarManager::FillPairVertexingImpl(C const& collision, T const& t1, T const& t2, bool propToSV, const FillState& state)
 {
   // check at compile time that the event and cov matrix have the cov matrix
   constexpr bool eventHasVtxCov = ((collFillMap & Collision) > 0 || (collFillMap & ReducedEventVtxCov) > 0);
   constexpr bool trackHasCov = ((fillMap & TrackCov) > 0 || (fillMap & ReducedTrackBarrelCov) > 0);
   constexpr bool muonHasCov = ((fillMap & MuonCov) > 0 || (fillMap & ReducedMuonCov) > 0);
 
-  if (!values) {
-    values = fgValues;
+  float* values = state.values;
+  // NOTE: the KF pair kinematics overwrite the ones from FillPair, so KF vertexing is never pruned
+  if (!state.usedKF && !state.UsedVarGroup(kVarGroupPairVertexing)) {
+    return;
   }
   float m1 = o2::constants::physics::MassElectron;
   float m2 = o2::constants::physics::MassElectron;
@@ -2569,8 +2711,8 @@ void VarManager::FillPairVertexing(C const& collision, T const& t1, T const& t2,
   ROOT::Math::PtEtaPhiMVector v2(t2.pt(), t2.eta(), t2.phi(), m2);
   ROOT::Math::PtEtaPhiMVector v12 = v1 + v2;
 
-  values[kUsedKF] = fgUsedKF;
-  if (!fgUsedKF) {
+  values[kUsedKF] = state.usedKF;
+  if (!state.usedKF) {
     int procCode = 0;
 
     // TODO: use trackUtilities functions to initialize the various matrices to avoid code duplication
@@ -2588,7 +2730,7 @@ void VarManager::FillPairVertexing(C const& collision, T const& t1, T const& t2,
                                       t2.cSnpSnp(), t2.cTglY(), t2.cTglZ(), t2.cTglSnp(), t2.cTglTgl(),
                                       t2.c1PtY(), t2.c1PtZ(), t2.c1PtSnp(), t2.c1PtTgl(), t2.c1Pt21Pt2()};
       o2::track::TrackParCov pars2{t2.x(), t2.alpha(), t2pars, t2covs};
-      procCode = fgFitterTwoProngBarrel.process(pars1, pars2);
+      procCode = state.fitterTwoProngBarrel->process(pars1, pars2);
     } else if constexpr ((pairType == kDecayToMuMu) && muonHasCov) {
       // Initialize track parameters for forward
       double chi21 = t1.chi2();
@@ -2605,7 +2747,7 @@ void VarManager::FillPairVertexing(C const& collision, T const& t1, T const& t2,
                              t2.c1PtX(), t2.c1PtY(), t2.c1PtPhi(), t2.c1PtTgl(), t2.c1Pt21Pt2()};
       SMatrix55 t2covs(v2.begin(), v2.end());
       o2::track::TrackParCovFwd pars2{t2.z(), t2pars, t2covs, chi22};
-      procCode = fgFitterTwoProngFwd.process(pars1, pars2);
+      procCode = state.fitterTwoProngFwd->process(pars1, pars2);
     } else {
       return;
     }
@@ -2644,11 +2786,11 @@ void VarManager::FillPairVertexing(C const& collision, T const& t1, T const& t2,
       auto covMatrixPV = primaryVertex.getCov();
 
       if constexpr ((pairType == kDecayToEE || pairType == kDecayToKPi) && trackHasCov) {
-        secondaryVertex = fgFitterTwoProngBarrel.getPCACandidate();
-        covMatrixPCA = fgFitterTwoProngBarrel.calcPCACovMatrixFlat();
-        auto chi2PCA = fgFitterTwoProngBarrel.getChi2AtPCACandidate();
-        auto trackParVar0 = fgFitterTwoProngBarrel.getTrack(0);
-        auto trackParVar1 = fgFitterTwoProngBarrel.getTrack(1);
+        secondaryVertex = state.fitterTwoProngBarrel->getPCACandidate();
+        covMatrixPCA = state.fitterTwoProngBarrel->calcPCACovMatrixFlat();
+        auto chi2PCA = state.fitterTwoProngBarrel->getChi2AtPCACandidate();
+        auto trackParVar0 = state.fitterTwoProngBarrel->getTrack(0);
+        auto trackParVar1 = state.fitterTwoProngBarrel->getTrack(1);
         values[kVertexingChi2PCA] = chi2PCA;
         v1 = {trackParVar0.getPt(), trackParVar0.getEta(), trackParVar0.getPhi(), m1};
         v2 = {trackParVar1.getPt(), trackParVar1.getEta(), trackParVar1.getPhi(), m2};
@@ -2656,11 +2798,11 @@ void VarManager::FillPairVertexing(C const& collision, T const& t1, T const& t2,
 
       } else if constexpr (pairType == kDecayToMuMu && muonHasCov) {
         // Get pca candidate from forward DCA fitter
-        secondaryVertex = fgFitterTwoProngFwd.getPCACandidate();
-        covMatrixPCA = fgFitterTwoProngFwd.calcPCACovMatrixFlat();
-        auto chi2PCA = fgFitterTwoProngFwd.getChi2AtPCACandidate();
-        auto trackParVar0 = fgFitterTwoProngFwd.getTrack(0);
-        auto trackParVar1 = fgFitterTwoProngFwd.getTrack(1);
+        secondaryVertex = state.fitterTwoProngFwd->getPCACandidate();
+        covMatrixPCA = state.fitterTwoProngFwd->calcPCACovMatrixFlat();
+        auto chi2PCA = state.fitterTwoProngFwd->getChi2AtPCACandidate();
+        auto trackParVar0 = state.fitterTwoProngFwd->getTrack(0);
+        auto trackParVar1 = state.fitterTwoProngFwd->getTrack(1);
         values[kVertexingChi2PCA] = chi2PCA;
         v1 = {trackParVar0.getPt(), trackParVar0.getEta(), trackParVar0.getPhi(), m1};
         v2 = {trackParVar1.getPt(), trackParVar1.getEta(), trackParVar1.getPhi(), m2};
@@ -2749,7 +2891,7 @@ void VarManager::FillPairVertexing(C const& collision, T const& t1, T const& t2,
       KFGeoTwoProng.AddDaughter(trk0KF);
       KFGeoTwoProng.AddDaughter(trk1KF);
     }
-    if (fgUsedVars[kKFMass]) {
+    if (state.usedVars[kKFMass]) {
       float mass = 0., massErr = 0.;
       if (!KFGeoTwoProng.GetMass(mass, massErr))
         values[kKFMass] = mass;
@@ -2764,7 +2906,7 @@ void VarManager::FillPairVertexing(C const& collision, T const& t1, T const& t2,
       double dxPair2PV = KFGeoTwoProng.GetX() - KFPV.GetX();
       double dyPair2PV = KFGeoTwoProng.GetY() - KFPV.GetY();
       double dzPair2PV = KFGeoTwoProng.GetZ() - KFPV.GetZ();
-      if (fgUsedVars[kVertexingLxy] || fgUsedVars[kVertexingLz] || fgUsedVars[kVertexingLxyz] || fgUsedVars[kVertexingLxyErr] || fgUsedVars[kVertexingLzErr] || fgUsedVars[kVertexingTauxy] || fgUsedVars[kVertexingLxyOverErr] || fgUsedVars[kVertexingLzOverErr] || fgUsedVars[kVertexingLxyzOverErr] || fgUsedVars[kCosPointingAngle]) {
+      if (state.usedVars[kVertexingLxy] || state.usedVars[kVertexingLz] || state.usedVars[kVertexingLxyz] || state.usedVars[kVertexingLxyErr] || state.usedVars[kVertexingLzErr] || state.usedVars[kVertexingTauxy] || state.usedVars[kVertexingLxyOverErr] || state.usedVars[kVertexingLzOverErr] || state.usedVars[kVertexingLxyzOverErr] || state.usedVars[kCosPointingAngle]) {
         values[kVertexingLxy] = std::sqrt(dxPair2PV * dxPair2PV + dyPair2PV * dyPair2PV);
         values[kVertexingLz] = std::sqrt(dzPair2PV * dzPair2PV);
         values[kVertexingLxyz] = std::sqrt(dxPair2PV * dxPair2PV + dyPair2PV * dyPair2PV + dzPair2PV * dzPair2PV);
@@ -2792,7 +2934,7 @@ void VarManager::FillPairVertexing(C const& collision, T const& t1, T const& t2,
                                     (v12.P() * values[VarManager::kVertexingLxyz]);
       }
       // As defined in Run 2 (projected onto momentum)
-      if (fgUsedVars[kVertexingLxyProjected] || fgUsedVars[kVertexingLxyzProjected] || fgUsedVars[kVertexingLzProjected]) {
+      if (state.usedVars[kVertexingLxyProjected] || state.usedVars[kVertexingLxyzProjected] || state.usedVars[kVertexingLzProjected]) {
         values[kVertexingLzProjected] = (dzPair2PV * KFGeoTwoProng.GetPz()) / TMath::Sqrt(KFGeoTwoProng.GetPz() * KFGeoTwoProng.GetPz());
         values[kVertexingLxyProjected] = (dxPair2PV * KFGeoTwoProng.GetPx()) + (dyPair2PV * KFGeoTwoProng.GetPy());
         values[kVertexingLxyProjected] = values[kVertexingLxyProjected] / TMath::Sqrt((KFGeoTwoProng.GetPx() * KFGeoTwoProng.GetPx()) + (KFGeoTwoProng.GetPy() * KFGeoTwoProng.GetPy()));
@@ -2803,56 +2945,56 @@ void VarManager::FillPairVertexing(C const& collision, T const& t1, T const& t2,
         values[kVertexingTauzProjected] = values[kVertexingLzProjected] * KFGeoTwoProng.GetMass() / TMath::Abs(KFGeoTwoProng.GetPz());
       }
 
-      if (fgUsedVars[kVertexingLxyOverErr] || fgUsedVars[kVertexingLzOverErr] || fgUsedVars[kVertexingLxyzOverErr]) {
+      if (state.usedVars[kVertexingLxyOverErr] || state.usedVars[kVertexingLzOverErr] || state.usedVars[kVertexingLxyzOverErr]) {
         values[kVertexingLxyOverErr] = values[kVertexingLxy] / values[kVertexingLxyErr];
         values[kVertexingLzOverErr] = values[kVertexingLz] / values[kVertexingLzErr];
         values[kVertexingLxyzOverErr] = values[kVertexingLxyz] / values[kVertexingLxyzErr];
       }
 
-      if (fgUsedVars[kKFChi2OverNDFGeo])
+      if (state.usedVars[kKFChi2OverNDFGeo])
         values[kKFChi2OverNDFGeo] = KFGeoTwoProng.GetChi2() / KFGeoTwoProng.GetNDF();
-      if (fgUsedVars[kKFCosPA])
+      if (state.usedVars[kKFCosPA])
         values[kKFCosPA] = calculateCosPA(KFGeoTwoProng, KFPV);
 
       // in principle, they should be in FillTrack
-      if (fgUsedVars[kKFTrack0DCAxyz] || fgUsedVars[kKFTrack1DCAxyz]) {
+      if (state.usedVars[kKFTrack0DCAxyz] || state.usedVars[kKFTrack1DCAxyz]) {
         values[kKFTrack0DCAxyz] = trk0KF.GetDistanceFromVertex(KFPV);
         values[kKFTrack1DCAxyz] = trk1KF.GetDistanceFromVertex(KFPV);
       }
-      if (fgUsedVars[kKFTrack0DCAxy] || fgUsedVars[kKFTrack1DCAxy]) {
+      if (state.usedVars[kKFTrack0DCAxy] || state.usedVars[kKFTrack1DCAxy]) {
         values[kKFTrack0DCAxy] = trk0KF.GetDistanceFromVertexXY(KFPV);
         values[kKFTrack1DCAxy] = trk1KF.GetDistanceFromVertexXY(KFPV);
       }
-      if (fgUsedVars[kKFDCAxyzBetweenProngs])
+      if (state.usedVars[kKFDCAxyzBetweenProngs])
         values[kKFDCAxyzBetweenProngs] = trk0KF.GetDistanceFromParticle(trk1KF);
-      if (fgUsedVars[kKFDCAxyBetweenProngs])
+      if (state.usedVars[kKFDCAxyBetweenProngs])
         values[kKFDCAxyBetweenProngs] = trk0KF.GetDistanceFromParticleXY(trk1KF);
 
-      if (fgUsedVars[kKFTracksDCAxyzMax]) {
+      if (state.usedVars[kKFTracksDCAxyzMax]) {
         values[kKFTracksDCAxyzMax] = values[kKFTrack0DCAxyz] > values[kKFTrack1DCAxyz] ? values[kKFTrack0DCAxyz] : values[kKFTrack1DCAxyz];
       }
-      if (fgUsedVars[kKFTracksDCAxyMax]) {
+      if (state.usedVars[kKFTracksDCAxyMax]) {
         values[kKFTracksDCAxyMax] = TMath::Abs(values[kKFTrack0DCAxy]) > TMath::Abs(values[kKFTrack1DCAxy]) ? values[kKFTrack0DCAxy] : values[kKFTrack1DCAxy];
       }
-      if (fgUsedVars[kKFTrack0DeviationFromPV] || fgUsedVars[kKFTrack1DeviationFromPV]) {
+      if (state.usedVars[kKFTrack0DeviationFromPV] || state.usedVars[kKFTrack1DeviationFromPV]) {
         values[kKFTrack0DeviationFromPV] = trk0KF.GetDeviationFromVertex(KFPV);
         values[kKFTrack1DeviationFromPV] = trk1KF.GetDeviationFromVertex(KFPV);
       }
-      if (fgUsedVars[kKFTrack0DeviationxyFromPV] || fgUsedVars[kKFTrack1DeviationxyFromPV]) {
+      if (state.usedVars[kKFTrack0DeviationxyFromPV] || state.usedVars[kKFTrack1DeviationxyFromPV]) {
         values[kKFTrack0DeviationxyFromPV] = trk0KF.GetDeviationFromVertexXY(KFPV);
         values[kKFTrack1DeviationxyFromPV] = trk1KF.GetDeviationFromVertexXY(KFPV);
       }
-      if (fgUsedVars[kKFJpsiDCAxyz]) {
+      if (state.usedVars[kKFJpsiDCAxyz]) {
         values[kKFJpsiDCAxyz] = KFGeoTwoProng.GetDistanceFromVertex(KFPV);
       }
-      if (fgUsedVars[kKFJpsiDCAxy]) {
+      if (state.usedVars[kKFJpsiDCAxy]) {
         values[kKFJpsiDCAxy] = KFGeoTwoProng.GetDistanceFromVertexXY(KFPV);
       }
-      if (fgUsedVars[kKFPairDeviationFromPV] || fgUsedVars[kKFPairDeviationxyFromPV]) {
+      if (state.usedVars[kKFPairDeviationFromPV] || state.usedVars[kKFPairDeviationxyFromPV]) {
         values[kKFPairDeviationFromPV] = KFGeoTwoProng.GetDeviationFromVertex(KFPV);
         values[kKFPairDeviationxyFromPV] = KFGeoTwoProng.GetDeviationFromVertexXY(KFPV);
       }
-      if (fgUsedVars[kKFChi2OverNDFGeoTop] || fgUsedVars[kKFMassGeoTop]) {
+      if (state.usedVars[kKFChi2OverNDFGeoTop] || state.usedVars[kKFMassGeoTop]) {
         KFParticle KFGeoTopTwoProngBarrel = KFGeoTwoProng;
         KFGeoTopTwoProngBarrel.SetProductionVertex(KFPV);
         values[kKFChi2OverNDFGeoTop] = KFGeoTopTwoProngBarrel.GetChi2() / KFGeoTopTwoProngBarrel.GetNDF();
@@ -3954,7 +4096,7 @@ void VarManager::FillDileptonTrackTrack(T1 const& dilepton, T2 const& hadron1, T
 
 //__________________________________________________________________
 template <int pairType, typename T1, typename T2>
-float VarManager::calculatePhiV(T1 const& t1, T2 const& t2)
+float VarManager::calculatePhiV(T1 const& t1, T2 const& t2, float bz)
 {
   // cos(phiv) = w*a /|w||a|
   // with w = u x v
@@ -3983,7 +4125,6 @@ float VarManager::calculatePhiV(T1 const& t1, T2 const& t2)
   ROOT::Math::PtEtaPhiMVector v12 = v1 + v2;
 
   float pairPhiV = -999;
-  float bz = fgMagField;
 
   bool swapTracks = false;
   if (v1.Pt() < v2.Pt()) { // ordering of track, pt1 > pt2
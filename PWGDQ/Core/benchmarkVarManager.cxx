@@ -0,0 +1,362 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+//
+// Contact: iarsene@cern.ch, i.c.arsene@fys.uio.no
+//
+// Benchmark of the VarManager fill functions on synthetic tracks and pairs.
+// The rows provide the same getters as the skimmed tables, with realistic kinematics and track parameters:
+//   the two legs of each pair (and the third track of the triplets) originate from a common displaced vertex,
+//   such that the vertexing converges as for the signal candidates.
+// Each fill function is measured for several fill maps and for two sets of used variables:
+//   "minimal" (just the kinematics, with pruning of the unused variable groups) and "all".
+// Usage: o2-analysis-dq-benchmark-varmanager [minimal time per benchmark in seconds, default 0.5]
+//
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "PWGDQ/Core/VarManager.h"
+
+namespace
+{
+constexpr int kNCandidates = 4096; // synthetic candidates, cycled over in the benchmark loops
+
+//_________________________________________________________________________
+// Barrel track with the columns of the ReducedTracks, ReducedTracksBarrel, ReducedTracksBarrelCov and ReducedTracksBarrelPID tables
+struct SyntheticBarrelTrack {
+  float fPt, fEta, fPhi;
+  int fSign;
+  float fX, fAlpha, fY, fZ, fSnp, fTgl;
+  float fCov[15]; // cYY, cZY, cZZ, cSnpY, cSnpZ, cSnpSnp, cTglY, cTglZ, cTglSnp, cTglTgl, c1PtY, c1PtZ, c1PtSnp, c1PtTgl, c1Pt21Pt2
+  float fDcaXY, fDcaZ;
+  float fTPCSignal, fTPCnSigma[5], fTOFnSigma[5], fBeta; // n-sigmas for el, mu, pi, ka, pr
+
+  float pt() const { return fPt; }
+  float eta() const { return fEta; }
+  float phi() const { return fPhi; }
+  int sign() const { return fSign; }
+  float p() const { return fPt * std::cosh(fEta); }
+  float px() const { return fPt * std::cos(fPhi); }
+  float py() const { return fPt * std::sin(fPhi); }
+  float pz() const { return fPt * std::sinh(fEta); }
+  bool isAmbiguous() const { return false; }
+  bool filteringFlags_bit(int) const { return false; }
+
+  float tpcInnerParam() const { return p(); }
+  uint32_t flags() const { return 0; }
+  uint8_t itsClusterMap() const { return 0x7f; }
+  float trackTime() const { return 10.0; }
+  float trackTimeRes() const { return 0.2; }
+  float tofExpMom() const { return p(); }
+  float itsChi2NCl() const { return 1.5; }
+  int tpcNClsFound() const { return 140; }
+  int tpcNClsCrossedRows() const { return 145; }
+  float tpcChi2NCl() const { return 1.2; }
+  float length() const { return 380.0; }
+  uint8_t trdPattern() const { return 0; }
+  float tpcSignal() const { return fTPCSignal; }
+  float trdSignal() const { return 0.0; }
+  uint8_t detectorMap() const { return 0x7; }
+  bool hasITS() const { return true; }
+  bool hasTPC() const { return true; }
+  bool hasTRD() const { return false; }
+  bool hasTOF() const { return fBeta > 0.0; }
+  float dcaXY() const { return fDcaXY; }
+  float dcaZ() const { return fDcaZ; }
+
+  float x() const { return fX; }
+  float alpha() const { return fAlpha; }
+  float y() const { return fY; }
+  float z() const { return fZ; }
+  float snp() const { return fSnp; }
+  float tgl() const { return fTgl; }
+  float signed1Pt() const { return fSign / fPt; }
+  float cYY() const { return fCov[0]; }
+  float cZY() const { return fCov[1]; }
+  float cZZ() const { return fCov[2]; }
+  float cSnpY() const { return fCov[3]; }
+  float cSnpZ() const { return fCov[4]; }
+  float cSnpSnp() const { return fCov[5]; }
+  float cTglY() const { return fCov[6]; }
+  float cTglZ() const { return fCov[7]; }
+  float cTglSnp() const { return fCov[8]; }
+  float cTglTgl() const { return fCov[9]; }
+  float c1PtY() const { return fCov[10]; }
+  float c1PtZ() const { return fCov[11]; }
+  float c1PtSnp() const { return fCov[12]; }
+  float c1PtTgl() const { return fCov[13]; }
+  float c1Pt21Pt2() const { return fCov[14]; }
+
+  float tpcNSigmaEl() const { return fTPCnSigma[0]; }
+  float tpcNSigmaMu() const { return fTPCnSigma[1]; }
+  float tpcNSigmaPi() const { return fTPCnSigma[2]; }
+  float tpcNSigmaKa() const { return fTPCnSigma[3]; }
+  float tpcNSigmaPr() const { return fTPCnSigma[4]; }
+  float tofNSigmaEl() const { return fTOFnSigma[0]; }
+  float tofNSigmaMu() const { return fTOFnSigma[1]; }
+  float tofNSigmaPi() const { return fTOFnSigma[2]; }
+  float tofNSigmaKa() const { return fTOFnSigma[3]; }
+  float tofNSigmaPr() const { return fTOFnSigma[4]; }
+  float beta() const { return fBeta; }
+};
+
+//_________________________________________________________________________
+// Muon with the columns of the ReducedMuons, ReducedMuonsExtra and ReducedMuonsCov tables
+struct SyntheticMuon {
+  float fPt, fEta, fPhi;
+  int fSign;
+  float fX, fY, fZ, fTgl;
+  float fCov[15]; // cXX, cXY, cYY, cPhiX, cPhiY, cPhiPhi, cTglX, cTglY, cTglPhi, cTglTgl, c1PtX, c1PtY, c1PtPhi, c1PtTgl, c1Pt21Pt2
+  float fDcaX, fDcaY;
+
+  float pt() const { return fPt; }
+  float eta() const { return fEta; }
+  float phi() const { return fPhi; }
+  int sign() const { return fSign; }
+  float p() const { return fPt * std::cosh(fEta); }
+  float px() const { return fPt * std::cos(fPhi); }
+  float py() const { return fPt * std::sin(fPhi); }
+  float pz() const { return fPt * std::sinh(fEta); }
+
+  int nClusters() const { return 10; }
+  float pDca() const { return 100.0; }
+  uint32_t mchBitMap() const { return 0x3ff; }
+  float rAtAbsorberEnd() const { return 40.0; }
+  float chi2() const { return 1.0; }
+  float chi2MatchMCHMID() const { return 2.0; }
+  float chi2MatchMCHMFT() const { return 20.0; }
+  float matchScoreMCHMFT() const { return 0.0; }
+  uint8_t trackType() const { return 3; }
+  float fwdDcaX() const { return fDcaX; }
+  float fwdDcaY() const { return fDcaY; }
+  float trackTime() const { return 10.0; }
+  float trackTimeRes() const { return 0.2; }
+
+  float x() const { return fX; }
+  float y() const { return fY; }
+  float z() const { return fZ; }
+  float tgl() const { return fTgl; }
+  float signed1Pt() const { return fSign / fPt; }
+  float cXX() const { return fCov[0]; }
+  float cXY() const { return fCov[1]; }
+  float cYY() const { return fCov[2]; }
+  float cPhiX() const { return fCov[3]; }
+  float cPhiY() const { return fCov[4]; }
+  float cPhiPhi() const { return fCov[5]; }
+  float cTglX() const { return fCov[6]; }
+  float cTglY() const { return fCov[7]; }
+  float cTglPhi() const { return fCov[8]; }
+  float cTglTgl() const { return fCov[9]; }
+  float c1PtX() const { return fCov[10]; }
+  float c1PtY() const { return fCov[11]; }
+  float c1PtPhi() const { return fCov[12]; }
+  float c1PtTgl() const { return fCov[13]; }
+  float c1Pt21Pt2() const { return fCov[14]; }
+};
+
+//_________________________________________________________________________
+// Event with the columns of the ReducedEventsVtxCov table
+struct SyntheticEvent {
+  float fPosX, fPosY, fPosZ;
+
+  float posX() const { return fPosX; }
+  float posY() const { return fPosY; }
+  float posZ() const { return fPosZ; }
+  float covXX() const { return 1.0e-6; }
+  float covXY() const { return 0.0; }
+  float covYY() const { return 1.0e-6; }
+  float covXZ() const { return 0.0; }
+  float covYZ() const { return 0.0; }
+  float covZZ() const { return 4.0e-6; }
+};
+
+//_________________________________________________________________________
+class SyntheticGenerator
+{
+ public:
+  explicit SyntheticGenerator(unsigned int seed) : fEngine(seed) {}
+
+  // pT spectrum falling exponentially above the barrel / muon thresholds
+  float Pt(float ptMin, float slope) { return ptMin + std::exponential_distribution<float>(slope)(fEngine); }
+  float Uniform(float min, float max) { return std::uniform_real_distribution<float>(min, max)(fEngine); }
+  float Gaus(float mean, float sigma) { return std::normal_distribution<float>(mean, sigma)(fEngine); }
+  int Sign() { return (fEngine() & 1) ? 1 : -1; }
+
+  // Barrel track passing through the point (vx, vy, vz), parametrized at that point in the frame rotated by its azimuth
+  SyntheticBarrelTrack BarrelTrack(float vx, float vy, float vz)
+  {
+    SyntheticBarrelTrack t{};
+    t.fPt = Pt(0.15, 1.0);
+    t.fEta = Uniform(-0.9, 0.9);
+    t.fPhi = Uniform(0.0, 2.0 * M_PI);
+    t.fSign = Sign();
+    t.fAlpha = t.fPhi;
+    t.fX = std::cos(t.fAlpha) * vx + std::sin(t.fAlpha) * vy;
+    t.fY = -std::sin(t.fAlpha) * vx + std::cos(t.fAlpha) * vy;
+    t.fZ = vz;
+    t.fSnp = 0.0;
+    t.fTgl = std::sinh(t.fEta);
+    float sigma1Pt = 0.01 / t.fPt;
+    float diagonal[5] = {2.5e-5, 4.0e-5, 1.0e-6, 1.0e-6, sigma1Pt * sigma1Pt};
+    for (int i = 0, k = 0; i < 5; ++i) {
+      for (int j = 0; j <= i; ++j, ++k) {
+        t.fCov[k] = (i == j ? diagonal[i] : 0.0);
+      }
+    }
+    t.fDcaXY = t.fY;
+    t.fDcaZ = t.fZ;
+    t.fTPCSignal = Gaus(80.0, 5.0);
+    for (int i = 0; i < 5; ++i) {
+      t.fTPCnSigma[i] = Gaus(0.0, 1.0);
+      t.fTOFnSigma[i] = Gaus(0.0, 1.0);
+    }
+    t.fBeta = Uniform(0.0, 1.0) < 0.6 ? Uniform(0.9, 1.0) : -999.0;
+    return t;
+  }
+
+  // Muon passing through the point (vx, vy, vz), parametrized at that point
+  SyntheticMuon Muon(float vx, float vy, float vz)
+  {
+    SyntheticMuon t{};
+    t.fPt = Pt(0.7, 1.0);
+    t.fEta = Uniform(-4.0, -2.5);
+    t.fPhi = Uniform(-M_PI, M_PI);
+    t.fSign = Sign();
+    t.fX = vx;
+    t.fY = vy;
+    t.fZ = vz;
+    t.fTgl = std::sinh(t.fEta);
+    float sigma1Pt = 0.05 / t.fPt;
+    float diagonal[5] = {1.0e-2, 1.0e-2, 1.0e-4, 1.0e-2, sigma1Pt * sigma1Pt};
+    for (int i = 0, k = 0; i < 5; ++i) {
+      for (int j = 0; j <= i; ++j, ++k) {
+        t.fCov[k] = (i == j ? diagonal[i] : 0.0);
+      }
+    }
+    t.fDcaX = Gaus(0.0, 0.05);
+    t.fDcaY = Gaus(0.0, 0.05);
+    return t;
+  }
+
+  SyntheticEvent Event() { return {Gaus(0.0, 0.005), Gaus(0.0, 0.005), Gaus(0.0, 5.0)}; }
+
+ private:
+  std::mt19937 fEngine;
+};
+
+//_________________________________________________________________________
+struct Benchmark {
+  std::string fName;
+  std::function<void(int)> fFunction; // fills the i-th candidate
+};
+
+// Run a benchmark for at least minTime seconds, doubling the number of iterations, and return the time per call in ns
+double Run(const Benchmark& benchmark, double minTime, long& nIterations)
+{
+  using clock = std::chrono::steady_clock;
+  for (int i = 0; i < kNCandidates; ++i) { // warm up
+    benchmark.fFunction(i);
+  }
+  nIterations = kNCandidates;
+  while (true) {
+    auto start = clock::now();
+    for (long i = 0; i < nIterations; ++i) {
+      benchmark.fFunction(i % kNCandidates);
+    }
+    double elapsed = std::chrono::duration<double>(clock::now() - start).count();
+    if (elapsed >= minTime || nIterations > (1L << 40)) {
+      return elapsed * 1.0e9 / nIterations;
+    }
+    nIterations *= 2;
+  }
+}
+
+//_________________________________________________________________________
+void SetUsedVariables(bool useAll)
+{
+  VarManager::ResetUsedVars();
+  if (useAll) {
+    std::vector<char> usedVars(VarManager::kNVars, true);
+    VarManager::SetUseVars(reinterpret_cast<const bool*>(usedVars.data()));
+    VarManager::SetPruneUnusedVars(false);
+  } else {
+    VarManager::SetUseVars(std::vector<int>{VarManager::kPt, VarManager::kEta, VarManager::kPhi, VarManager::kCharge, VarManager::kMass, VarManager::kRap});
+    VarManager::SetPruneUnusedVars(true);
+  }
+}
+} // namespace
+
+//_________________________________________________________________________
+int main(int argc, char** argv)
+{
+  double minTime = (argc > 1 ? std::atof(argv[1]) : 0.5);
+
+  constexpr uint32_t kBarrelFillMap = VarManager::ObjTypes::ReducedTrack | VarManager::ObjTypes::ReducedTrackBarrel | VarManager::ObjTypes::ReducedTrackBarrelPID;
+  constexpr uint32_t kBarrelCovFillMap = kBarrelFillMap | VarManager::ObjTypes::ReducedTrackBarrelCov;
+  constexpr uint32_t kMuonFillMap = VarManager::ObjTypes::ReducedMuon | VarManager::ObjTypes::ReducedMuonExtra;
+  constexpr uint32_t kMuonCovFillMap = kMuonFillMap | VarManager::ObjTypes::ReducedMuonCov;
+  constexpr uint32_t kEventFillMap = VarManager::ObjTypes::ReducedEvent | VarManager::ObjTypes::ReducedEventVtxCov;
+
+  // synthetic candidates: events with a displaced vertex (c*tau of a few hundred microns) shared by the legs
+  SyntheticGenerator generator(12345);
+  std::vector<SyntheticEvent> events;
+  std::vector<SyntheticBarrelTrack> barrel[3];
+  std::vector<SyntheticMuon> muons[2];
+  for (int i = 0; i < kNCandidates; ++i) {
+    SyntheticEvent event = generator.Event();
+    float vx = event.fPosX + generator.Gaus(0.0, 0.02);
+    float vy = event.fPosY + generator.Gaus(0.0, 0.02);
+    float vz = event.fPosZ + generator.Gaus(0.0, 0.02);
+    events.push_back(event);
+    for (auto& tracks : barrel) {
+      tracks.push_back(generator.BarrelTrack(vx, vy, vz));
+    }
+    for (auto& tracks : muons) {
+      tracks.push_back(generator.Muon(vx, vy, vz));
+    }
+  }
+
+  const float magField = 5.0;
+  VarManager::SetMagneticField(magField);
+  VarManager::SetupTwoProngDCAFitter(magField, true, 200.0f, 4.0f, 1.0e-3f, 0.9f, false);
+  VarManager::SetupTwoProngFwdDCAFitter(magField, true, 200.0f, 1.0e-3f, 0.9f, false);
+  VarManager::SetupThreeProngDCAFitter(magField, true, 200.0f, 4.0f, 1.0e-3f, 0.9f, false);
+  VarManager::SetupFwdDCAFitterNoCorr();
+
+  std::vector<Benchmark> benchmarks = {
+    {"FillTrack<Barrel>", [&](int i) { VarManager::FillTrack<kBarrelFillMap>(barrel[0][i]); }},
+    {"FillTrack<BarrelCov>", [&](int i) { VarManager::FillTrack<kBarrelCovFillMap>(barrel[0][i]); }},
+    {"FillTrack<Muon>", [&](int i) { VarManager::FillTrack<kMuonFillMap>(muons[0][i]); }},
+    {"FillTrack<MuonCov>", [&](int i) { VarManager::FillTrack<kMuonCovFillMap>(muons[0][i]); }},
+    {"FillPair<DecayToEE,BarrelCov>", [&](int i) { VarManager::FillPair<VarManager::kDecayToEE, kBarrelCovFillMap>(barrel[0][i], barrel[1][i]); }},
+    {"FillPair<DecayToMuMu,MuonCov>", [&](int i) { VarManager::FillPair<VarManager::kDecayToMuMu, kMuonCovFillMap>(muons[0][i], muons[1][i]); }},
+    {"FillPairVertexing<DecayToEE,BarrelCov>", [&](int i) { VarManager::FillPairVertexing<VarManager::kDecayToEE, kEventFillMap, kBarrelCovFillMap>(events[i], barrel[0][i], barrel[1][i]); }},
+    {"FillPairVertexing<DecayToMuMu,MuonCov>", [&](int i) { VarManager::FillPairVertexing<VarManager::kDecayToMuMu, kEventFillMap, kMuonCovFillMap>(events[i], muons[0][i], muons[1][i]); }},
+    {"FillDileptonTrackVertexing<BtoJpsiEEK,BarrelCov>", [&](int i) { VarManager::FillDileptonTrackVertexing<VarManager::kBtoJpsiEEK, kEventFillMap, kBarrelCovFillMap>(events[i], barrel[0][i], barrel[1][i], barrel[2][i], VarManager::fgValues); }}};
+
+  printf("%-60s %15s %15s\n", "Benchmark", "Time (ns)", "Iterations");
+  printf("%s\n", std::string(92, '-').c_str());
+  for (bool useAll : {false, true}) {
+    SetUsedVariables(useAll);
+    for (const auto& benchmark : benchmarks) {
+      long nIterations = 0;
+      double time = Run(benchmark, minTime, nIterations);
+      printf("%-60s %15.1f %15ld\n", (benchmark.fName + (useAll ? "/all" : "/minimal")).c_str(), time, nIterations);
+    }
+  }
+  return 0;
+}
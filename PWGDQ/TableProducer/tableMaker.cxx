@@ -17,7 +17,10 @@
 // The skimming can optionally produce just the barrel, muon, or both barrel and muon tracks
 // The event filtering (filterPP), centrality, and V0Bits (from v0-selector) can be switched on/off by selecting one
 //  of the process functions
+#include <algorithm>
+#include <array>
 #include <iostream>
+#include <thread>
 #include "Framework/AnalysisTask.h"
 #include "Framework/AnalysisDataModel.h"
 #include "Framework/ASoAHelpers.h"
@@ -36,6 +39,7 @@
 #include "PWGDQ/Core/HistogramManager.h"
 #include "PWGDQ/Core/AnalysisCut.h"
 #include "PWGDQ/Core/AnalysisCompositeCut.h"
+#include "PWGDQ/Core/AnalysisCompiledCuts.h"
 #include "PWGDQ/Core/HistogramsLibrary.h"
 #include "PWGDQ/Core/CutsLibrary.h"
 #include "DataFormatsGlobalTracking/RecoContainerCreateTracksVariadic.h"
@@ -176,6 +180,8 @@ struct TableMaker {
   Configurable<bool> fConfigDummyRunlist{"cfgDummyRunlist", false, "If true, use dummy runlist"};
   Configurable<int> fConfigInitRunNumber{"cfgInitRunNumber", 543215, "Initial run number used in run by run checks"};
   Configurable<bool> fPropMuon{"cfgPropMuon", false, "Propgate muon tracks through absorber"};
+  Configurable<int> fConfigNThreads{"cfgNThreads", 1, "Number of threads computing the barrel track variables and selections of a collision (used only w/o QA histograms and w/o TF1 cut limits)"};
+  Configurable<int> fConfigMinTracksPerThread{"cfgMinTracksPerThread", 500, "Minimum number of barrel tracks per thread in the multi-threaded track selection"};
   Configurable<std::string> geoPath{"geoPath", "GLO/Config/GeometryAligned", "Path of the geometry file"};
   Configurable<std::string> grpmagPath{"grpmagPath", "GLO/Config/GRPMagField", "CCDB path of the GRPMagField object"};
   Configurable<std::string> grpmagPathRun2{"grpmagPathRun2", "GLO/GRP/GRP", "CCDB path of the GRPObject (Usage for Run 2)"};
@@ -188,6 +194,8 @@ struct TableMaker {
   AnalysisCompositeCut* fEventCut;              //! Event selection cut
   std::vector<AnalysisCompositeCut> fTrackCuts; //! Barrel track cuts
   std::vector<AnalysisCompositeCut> fMuonCuts;  //! Muon track cuts
+  AnalysisCompiledCuts fTrackCutsCompiled;      //! Barrel track cuts, evaluated all at once
+  AnalysisCompiledCuts fMuonCutsCompiled;       //! Muon track cuts, evaluated all at once
 
   Preslice<MyBarrelTracks> perCollisionTracks = aod::track::collisionId;
   Preslice<MyMuons> perCollisionMuons = aod::fwdtrack::collisionId;
@@ -197,6 +205,11 @@ struct TableMaker {
   bool fDoDetailedQA = false; // Bool to set detailed QA true, if QA is set true
   int fCurrentRun;            // needed to detect if the run changed and trigger update of calibrations etc.
 
+  // multi-threaded barrel track selection, filled per track of the current collision
+  bool fUseParallelTrackSelection = false;
+  std::vector<uint64_t> fParallelTrackDecisions;                   // cut decisions
+  std::vector<std::array<float, 4>> fParallelTrackNSigmaPostCalib; // TPC post-calibrated n-sigmas for electrons, pions, kaons and protons
+
   // TODO: filter on TPC dedx used temporarily until electron PID will be improved
   Filter barrelSelectedTracks = ifnode(fIsRun2.node() == true, aod::track::trackType == uint8_t(aod::track::Run2Track), aod::track::trackType == uint8_t(aod::track::Track)) && o2::aod::track::pt >= fConfigBarrelTrackPtLow && nabs(o2::aod::track::eta) <= fConfigBarrelTrackMaxAbsEta && o2::aod::track::tpcSignal >= fConfigMinTpcSignal && o2::aod::track::tpcSignal <= fConfigMaxTpcSignal && o2::aod::track::tpcChi2NCl < 4.0f && o2::aod::track::itsChi2NCl < 36.0f;
 
@@ -332,10 +345,63 @@ struct TableMaker {
         fMuonCuts.push_back(*dqcuts::GetCompositeCut(objArray->At(icut)->GetName()));
       }
     }
+    fTrackCutsCompiled.AddCuts(fTrackCuts);
+    fMuonCutsCompiled.AddCuts(fMuonCuts);
+    // the histograms and the TF1 cut limits are not thread safe
+    fUseParallelTrackSelection = (fConfigNThreads > 1 && !fConfigQA && !fConfigIsOnlyforMaps && !fTrackCutsCompiled.HasFunctions());
+    if (fConfigNThreads > 1 && !fUseParallelTrackSelection) {
+      LOG(warning) << "Multi-threaded barrel track selection disabled: not supported with QA histograms, postcalibration maps or TF1 cut limits";
+    }
 
     VarManager::SetUseVars(AnalysisCut::fgUsedVars); // provide the list of required variables so that VarManager knows what to fill
   }
 
+  // Compute the barrel track variables and selections of a collision in parallel threads, each one running over a chunk of consecutive tracks
+  //   with its own copy of the values array (starting from the event-wise variables) and of the compiled cuts.
+  // The decisions and the quantities written to the tables are stored per track and used afterwards in the sequential loop writing the tables.
+  // Returns false if the collision has too few tracks, in which case the selection is done in the sequential loop
+  template <uint32_t TTrackFillMap, typename TTracks>
+  bool runParallelTrackSelection(TTracks const& tracksBarrel)
+  {
+    int nTracks = tracksBarrel.size();
+    int nThreads = std::min(fConfigNThreads.value, nTracks / std::max(1, fConfigMinTracksPerThread.value));
+    if (nThreads < 2) {
+      return false;
+    }
+    fParallelTrackDecisions.assign(nTracks, 0);
+    fParallelTrackNSigmaPostCalib.resize(nTracks);
+
+    auto selectChunk = [&](int first, int last) {
+      float values[VarManager::kNVars];
+      std::copy(VarManager::fgValues, VarManager::fgValues + VarManager::kNVars, values);
+      AnalysisCompiledCuts cuts = fTrackCutsCompiled;
+      int iTrack = 0;
+      for (auto& track : tracksBarrel) {
+        if (iTrack >= last) {
+          break;
+        }
+        if (iTrack >= first) {
+          VarManager::FillTrack<TTrackFillMap>(track, values);
+          fParallelTrackDecisions[iTrack] = cuts.Evaluate(values);
+          fParallelTrackNSigmaPostCalib[iTrack] = {values[VarManager::kTPCnSigmaEl_Corr], values[VarManager::kTPCnSigmaPi_Corr],
+                                                   values[VarManager::kTPCnSigmaKa_Corr], values[VarManager::kTPCnSigmaPr_Corr]};
+        }
+        iTrack++;
+      }
+    };
+
+    std::vector<std::thread> threads;
+    int chunkSize = (nTracks + nThreads - 1) / nThreads;
+    for (int first = chunkSize; first < nTracks; first += chunkSize) {
+      threads.emplace_back(selectChunk, first, std::min(first + chunkSize, nTracks));
+    }
+    selectChunk(0, chunkSize); // the first chunk is processed in the calling thread
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    return true;
+  }
+
   // Templated function instantianed for all of the process functions
   template <uint32_t TEventFillMap, uint32_t TTrackFillMap, uint32_t TMuonFillMap, uint32_t TMFTFillMap = 0u, typename TEvent, typename TTracks, typename TMuons, typename TAmbiTracks, typename TAmbiMuons, typename TMFTTracks = std::nullptr_t>
   void fullSkimming(TEvent const& collision, aod::BCsWithTimestamps const&, TTracks const& tracksBarrel, TMuons const& tracksMuon, TAmbiTracks const& ambiTracksMid, TAmbiMuons const& ambiTracksFwd, TMFTTracks const& mftTracks = nullptr)
@@ -453,8 +519,12 @@ struct TableMaker {
       }
       trackBarrelPID.reserve(tracksBarrel.size());
 
+      bool parallelSelection = fUseParallelTrackSelection && runParallelTrackSelection<TTrackFillMap>(tracksBarrel);
+      int iTrack = -1;
+
       // loop over tracks
       for (auto& track : tracksBarrel) {
+        iTrack++;
         if constexpr ((TTrackFillMap & VarManager::ObjTypes::AmbiTrack) > 0) {
           if (fIsAmbiguous) {
             isAmbiguous = 0;
@@ -469,18 +539,28 @@ struct TableMaker {
 
         trackFilteringTag = uint64_t(0);
         trackTempFilterMap = uint8_t(0);
-        VarManager::FillTrack<TTrackFillMap>(track);
-        if (fDoDetailedQA) {
-          fHistMan->FillHistClass("TrackBarrel_BeforeCuts", VarManager::fgValues);
-          if (fIsAmbiguous && isAmbiguous == 1) {
-            fHistMan->FillHistClass("Ambiguous_TrackBarrel_BeforeCuts", VarManager::fgValues);
+        uint64_t trackDecisions = 0;
+        if (parallelSelection) {
+          trackDecisions = fParallelTrackDecisions[iTrack];
+          VarManager::fgValues[VarManager::kTPCnSigmaEl_Corr] = fParallelTrackNSigmaPostCalib[iTrack][0];
+          VarManager::fgValues[VarManager::kTPCnSigmaPi_Corr] = fParallelTrackNSigmaPostCalib[iTrack][1];
+          VarManager::fgValues[VarManager::kTPCnSigmaKa_Corr] = fParallelTrackNSigmaPostCalib[iTrack][2];
+          VarManager::fgValues[VarManager::kTPCnSigmaPr_Corr] = fParallelTrackNSigmaPostCalib[iTrack][3];
+        } else {
+          VarManager::FillTrack<TTrackFillMap>(track);
+          if (fDoDetailedQA) {
+            fHistMan->FillHistClass("TrackBarrel_BeforeCuts", VarManager::fgValues);
+            if (fIsAmbiguous && isAmbiguous == 1) {
+              fHistMan->FillHistClass("Ambiguous_TrackBarrel_BeforeCuts", VarManager::fgValues);
+            }
           }
+          trackDecisions = fTrackCutsCompiled.Evaluate(VarManager::fgValues);
         }
 
         // apply track cuts and fill stats histogram
         int i = 0;
         for (auto cut = fTrackCuts.begin(); cut != fTrackCuts.end(); cut++, i++) {
-          if ((*cut).IsSelected(VarManager::fgValues)) {
+          if (trackDecisions & (uint64_t(1) << i)) {
             trackTempFilterMap |= (uint8_t(1) << i);
             if (fConfigQA) {
               fHistMan->FillHistClass(Form("TrackBarrel_%s", (*cut).GetName()), VarManager::fgValues);
@@ -635,8 +715,9 @@ struct TableMaker {
 
         // check the cuts and filters
         int i = 0;
+        uint64_t muonDecisions = fMuonCutsCompiled.Evaluate(VarManager::fgValues);
         for (auto cut = fMuonCuts.begin(); cut != fMuonCuts.end(); cut++, i++) {
-          if ((*cut).IsSelected(VarManager::fgValues))
+          if (muonDecisions & (uint64_t(1) << i))
             trackTempFilterMap |= (uint8_t(1) << i);
         }
 
@@ -679,8 +760,9 @@ struct TableMaker {
         }
         // apply the muon selection cuts and fill the stats histogram
         int i = 0;
+        uint64_t muonDecisions = fMuonCutsCompiled.Evaluate(VarManager::fgValues);
         for (auto cut = fMuonCuts.begin(); cut != fMuonCuts.end(); cut++, i++) {
-          if ((*cut).IsSelected(VarManager::fgValues)) {
+          if (muonDecisions & (uint64_t(1) << i)) {
             trackTempFilterMap |= (uint8_t(1) << i);
             if (fConfigQA) {
               fHistMan->FillHistClass(Form("Muons_%s", (*cut).GetName()), VarManager::fgValues);
@@ -898,8 +980,9 @@ struct TableMaker {
 
         // apply track cuts and fill stats histogram
         int i = 0;
+        uint64_t trackDecisions = fTrackCutsCompiled.Evaluate(VarManager::fgValues);
         for (auto cut = fTrackCuts.begin(); cut != fTrackCuts.end(); cut++, i++) {
-          if ((*cut).IsSelected(VarManager::fgValues)) {
+          if (trackDecisions & (uint64_t(1) << i)) {
             trackTempFilterMap |= (uint8_t(1) << i);
             if (fConfigQA) {
               fHistMan->FillHistClass(Form("TrackBarrel_%s", (*cut).GetName()), VarManager::fgValues);
@@ -1006,8 +1089,9 @@ struct TableMaker {
 
         // check the cuts and filters
         int i = 0;
+        uint64_t muonDecisions = fMuonCutsCompiled.Evaluate(VarManager::fgValues);
         for (auto cut = fMuonCuts.begin(); cut != fMuonCuts.end(); cut++, i++) {
-          if ((*cut).IsSelected(VarManager::fgValues))
+          if (muonDecisions & (uint64_t(1) << i))
             trackTempFilterMap |= (uint8_t(1) << i);
         }
 
@@ -1046,8 +1130,9 @@ struct TableMaker {
         }
         // apply the muon selection cuts and fill the stats histogram
         int i = 0;
+        uint64_t muonDecisions = fMuonCutsCompiled.Evaluate(VarManager::fgValues);
         for (auto cut = fMuonCuts.begin(); cut != fMuonCuts.end(); cut++, i++) {
-          if ((*cut).IsSelected(VarManager::fgValues)) {
+          if (muonDecisions & (uint64_t(1) << i)) {
             trackTempFilterMap |= (uint8_t(1) << i);
             if (fConfigQA) {
               fHistMan->FillHistClass(Form("Muons_%s", (*cut).GetName()), VarManager::fgValues);
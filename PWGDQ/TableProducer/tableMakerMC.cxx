@@ -126,6 +126,7 @@ struct TableMakerMC {
 
   // list of MCsignal objects
   std::vector<MCSignal> fMCSignals;
+  MCSignalCache fMCSignalCache;
 
   OutputObj<THashList> fOutputList{"output"};
   // TODO: add statistics histograms, similar to table-maker
@@ -333,6 +334,8 @@ struct TableMakerMC {
     std::map<uint64_t, int> fEventIdx;
     std::map<uint64_t, int> fEventLabels;
     int fCounters[2] = {0, 0}; //! [0] - particle counter, [1] - event counter
+    // ancestries of the MC particles, shared by all the MC signal checks in this dataframe
+    fMCSignalCache.Reset(mcTracks.size());
 
     uint16_t mcflags = 0;
     uint64_t trackFilteringTag = 0;
@@ -470,9 +473,9 @@ struct TableMakerMC {
           bool checked = false;
           if constexpr (soa::is_soa_filtered_v<aod::McParticles_001>) {
             auto mctrack_raw = groupedMcTracks.rawIteratorAt(mctrack.globalIndex());
-            checked = sig.CheckSignal(true, mctrack_raw);
+            checked = sig.CheckSignal(true, fMCSignalCache, mctrack_raw);
           } else {
-            checked = sig.CheckSignal(true, mctrack);
+            checked = sig.CheckSignal(true, fMCSignalCache, mctrack);
           }
           if (checked) {
             mcflags |= (uint16_t(1) << i);
@@ -589,7 +592,7 @@ struct TableMakerMC {
           int j = 0; // runs over the track cuts
           // check all the specified signals and fill histograms for MC truth matched tracks
           for (auto& sig : fMCSignals) {
-            if (sig.CheckSignal(true, mctrack)) {
+            if (sig.CheckSignal(true, fMCSignalCache, mctrack)) {
               mcflags |= (uint16_t(1) << i);
               if (fDoDetailedQA) {
                 j = 0;
@@ -751,7 +754,7 @@ struct TableMakerMC {
           int j = 0; // runs over the track cuts
           // check all the specified signals and fill histograms for MC truth matched tracks
           for (auto& sig : fMCSignals) {
-            if (sig.CheckSignal(true, mctrack)) {
+            if (sig.CheckSignal(true, fMCSignalCache, mctrack)) {
               mcflags |= (uint16_t(1) << i);
               if (fDoDetailedQA) {
                 for (auto& cut : fMuonCuts) {
@@ -906,6 +909,8 @@ struct TableMakerMC {
     std::map<uint64_t, int> fEventIdx;
     std::map<uint64_t, int> fEventLabels;
     int fCounters[2] = {0, 0}; //! [0] - particle counter, [1] - event counter
+    // ancestries of the MC particles, shared by all the MC signal checks in this dataframe
+    fMCSignalCache.Reset(mcTracks.size());
 
     uint16_t mcflags = 0;
     uint64_t trackFilteringTag = 0;
@@ -1015,9 +1020,9 @@ struct TableMakerMC {
           bool checked = false;
           if constexpr (soa::is_soa_filtered_v<aod::McParticles_001>) {
             auto mctrack_raw = groupedMcTracks.rawIteratorAt(mctrack.globalIndex());
-            checked = sig.CheckSignal(true, mctrack_raw);
+            checked = sig.CheckSignal(true, fMCSignalCache, mctrack_raw);
           } else {
-            checked = sig.CheckSignal(true, mctrack);
+            checked = sig.CheckSignal(true, fMCSignalCache, mctrack);
           }
           if (checked) {
             mcflags |= (uint16_t(1) << i);
@@ -1129,7 +1134,7 @@ struct TableMakerMC {
           int j = 0; // runs over the track cuts
           // check all the specified signals and fill histograms for MC truth matched tracks
           for (auto& sig : fMCSignals) {
-            if (sig.CheckSignal(true, mctrack)) {
+            if (sig.CheckSignal(true, fMCSignalCache, mctrack)) {
               mcflags |= (uint16_t(1) << i);
               if (fDoDetailedQA) {
                 j = 0;
@@ -1289,7 +1294,7 @@ struct TableMakerMC {
           int j = 0; // runs over the track cuts
           // check all the specified signals and fill histograms for MC truth matched tracks
           for (auto& sig : fMCSignals) {
-            if (sig.CheckSignal(true, mctrack)) {
+            if (sig.CheckSignal(true, fMCSignalCache, mctrack)) {
               mcflags |= (uint16_t(1) << i);
               if (fDoDetailedQA) {
                 for (auto& cut : fMuonCuts) {
@@ -427,6 +427,7 @@ struct DQMuonsSelection {
 
   void processSelection(Collisions const& collisions, BCsWithTimestamps const& bcstimestamps, MyMuons const& muons, aod::FwdTrackAssoc const& muonAssocs)
   {
+    VarManager::ResetMuonPropagationCache();
     for (auto& collision : collisions) {
       auto muonIdsThisCollision = muonAssocs.sliceBy(fwdtrackIndicesPerCollision, collision.globalIndex());
       runMuonSelection<gkMuonFillMap>(collision, bcstimestamps, muons, muonIdsThisCollision);
@@ -829,6 +830,7 @@ struct DQFilterPPTask {
   {
     fFiltersMap.clear();
     fCEFPfilters.clear();
+    VarManager::ResetMuonPropagationCache();
 
     cout << "------------------- filterPP, n assocs barrel/muon :: " << trackAssocs.size() << " / " << muonAssocs.size() << endl;
 
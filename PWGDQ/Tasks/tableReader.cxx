@@ -11,6 +11,7 @@
 //
 // Contact: iarsene@cern.ch, i.c.arsene@fys.uio.no
 //
+#include <array>
 #include <iostream>
 #include <vector>
 #include <algorithm>
@@ -34,6 +35,7 @@
 #include "PWGDQ/Core/HistogramsLibrary.h"
 #include "PWGDQ/Core/CutsLibrary.h"
 #include "PWGDQ/Core/MixingLibrary.h"
+#include "PWGDQ/Core/DileptonExport.h"
 #include "DataFormatsParameters/GRPMagField.h"
 #include "Field/MagneticField.h"
 #include "TGeoGlobalMagField.h"
@@ -695,6 +697,15 @@ struct AnalysisEventMixing {
       histNames = fTrackMuonHistNames;
     }
 
+    // resolve the pair histogram classes once: [0-2] = +-, ++, --, [3-5] = their unambiguous variants
+    std::vector<std::array<int, 6>> histHandles(histNames.size());
+    for (size_t i = 0; i < histNames.size(); i++) {
+      for (int j = 0; j < 3; j++) {
+        histHandles[i][j] = fHistMan->GetHistClassHandle(histNames[i][j].Data());
+        histHandles[i][j + 3] = fHistMan->GetHistClassHandle(Form("%s_unambiguous", histNames[i][j].Data()));
+      }
+    }
+
     uint32_t twoTrackFilter = 0;
     for (auto& track1 : tracks1) {
       for (auto& track2 : tracks2) {
@@ -725,20 +736,20 @@ struct AnalysisEventMixing {
         for (unsigned int icut = 0; icut < ncuts; icut++) {
           if (twoTrackFilter & (uint32_t(1) << icut)) {
             if (track1.sign() * track2.sign() < 0) {
-              fHistMan->FillHistClass(histNames[icut][0].Data(), VarManager::fgValues);
+              fHistMan->FillHistClass(histHandles[icut][0], VarManager::fgValues);
               if (fConfigAmbiguousHist && !(track1.isAmbiguous() || track2.isAmbiguous())) {
-                fHistMan->FillHistClass(Form("%s_unambiguous", histNames[icut][0].Data()), VarManager::fgValues);
+                fHistMan->FillHistClass(histHandles[icut][0 + 3], VarManager::fgValues);
               }
             } else {
               if (track1.sign() > 0) {
-                fHistMan->FillHistClass(histNames[icut][1].Data(), VarManager::fgValues);
+                fHistMan->FillHistClass(histHandles[icut][1], VarManager::fgValues);
                 if (fConfigAmbiguousHist && !(track1.isAmbiguous() || track2.isAmbiguous())) {
-                  fHistMan->FillHistClass(Form("%s_unambiguous", histNames[icut][1].Data()), VarManager::fgValues);
+                  fHistMan->FillHistClass(histHandles[icut][1 + 3], VarManager::fgValues);
                 }
               } else {
-                fHistMan->FillHistClass(histNames[icut][2].Data(), VarManager::fgValues);
+                fHistMan->FillHistClass(histHandles[icut][2], VarManager::fgValues);
                 if (fConfigAmbiguousHist && !(track1.isAmbiguous() || track2.isAmbiguous())) {
-                  fHistMan->FillHistClass(Form("%s_unambiguous", histNames[icut][2].Data()), VarManager::fgValues);
+                  fHistMan->FillHistClass(histHandles[icut][2 + 3], VarManager::fgValues);
                 }
               }
             }
@@ -879,6 +890,11 @@ struct AnalysisSameEventPairing {
   Configurable<bool> fConfigAmbiguousHist{"cfgAmbiHist", false, "Enable Ambiguous histograms for time association studies"};
   Configurable<bool> fConfigMultDimuons{"cfgMultDimuons", false, "Multiplicity for Unlike Dimuons"};
   Configurable<bool> fConfigUseKFVertexing{"cfgUseKFVertexing", false, "Use KF Particle for secondary vertex reconstruction (DCAFitter is used by default)"};
+  Configurable<bool> fConfigPruneUnusedVars{"cfgPruneUnusedVars", false, "Skip the computation of pair variable groups not used by the histograms or the output tables"};
+  Configurable<int> fConfigTHnFillBufferSize{"cfgTHnFillBufferSize", 0, "Number of entries buffered per THn / THnSparse histogram before filling them at once (0: direct filling)"};
+  Configurable<bool> fConfigLazyHistograms{"cfgLazyHistograms", false, "Create the TH1, TH2, TH3 and profile histograms at their first fill (histograms never filled are not written)"};
+  Configurable<std::string> fConfigExportPairsDir{"cfgExportPairsDir", "", "If not empty, directory where the selected pairs are exported in one compact columnar file per run"};
+  Configurable<int> fConfigExportBlockSize{"cfgExportBlockSize", 65536, "Number of pairs per block in the exported pair files"};
   Configurable<bool> fUseRemoteField{"cfgUseRemoteField", false, "Chose whether to fetch the magnetic field from ccdb or set it manually"};
   Configurable<float> fConfigMagField{"cfgMagField", 5.0f, "Manually set magnetic field"};
   Configurable<std::string> ccdburl{"ccdburl", "http://alice-ccdb.cern.ch", "url of the ccdb repository"};
@@ -910,6 +926,8 @@ struct AnalysisSameEventPairing {
   std::vector<std::vector<TString>> fMuonHistNames;
   std::vector<std::vector<TString>> fTrackMuonHistNames;
   std::vector<AnalysisCompositeCut> fPairCuts;
+  DileptonExportWriter fPairExport;
+  bool fExportPairs = false;
 
   void init(o2::framework::InitContext& context)
   {
@@ -1057,8 +1075,28 @@ struct AnalysisSameEventPairing {
 
     VarManager::SetCollisionSystem((TString)fCollisionSystem, fCenterMassEnergy); // set collision system and center of mass energy
 
+    fHistMan->SetLazyHistograms(fConfigLazyHistograms);
     DefineHistograms(fHistMan, histNames.Data(), fConfigAddSEPHistogram); // define all histograms
     VarManager::SetUseVars(fHistMan->GetUsedVars());                      // provide the list of required variables so that VarManager knows what to fill
+    if (fConfigPruneUnusedVars) {
+      // the vertexing variables are written to the extra and flat tables, independently of the histograms
+      for (auto var : {VarManager::kVertexingTauz, VarManager::kVertexingLz, VarManager::kVertexingLxy, VarManager::kCosPointingAngle}) {
+        VarManager::SetUseVariable(var);
+      }
+      VarManager::SetPruneUnusedVars(true);
+      VarManager::PrintUsedVars();
+    }
+    if (fConfigTHnFillBufferSize > 0) {
+      fHistMan->SetTHnFillBufferSize(fConfigTHnFillBufferSize);
+      // the entries left in the buffers are filled before the histograms are written
+      context.services().get<CallbackService>().set<CallbackService::Id::EndOfStream>([this](EndOfStreamContext&) { fHistMan->FlushTHnBuffers(); });
+    }
+    fExportPairs = !fConfigExportPairsDir.value.empty();
+    if (fExportPairs) {
+      fPairExport.SetOutput(fConfigExportPairsDir.value.c_str());
+      fPairExport.SetBlockSize(fConfigExportBlockSize);
+      context.services().get<CallbackService>().set<CallbackService::Id::EndOfStream>([this](EndOfStreamContext&) { fPairExport.Close(); });
+    }
     fOutputList.setObject(fHistMan->GetMainHistogramList());
   }
 
@@ -1095,6 +1133,9 @@ struct AnalysisSameEventPairing {
         VarManager::SetMagneticField(fConfigMagField.value);
       }
       fCurrentRun = event.runNumber();
+      if (fExportPairs) {
+        fPairExport.SetRunNumber(fCurrentRun);
+      }
     }
 
     TString cutNames = fConfigTrackCuts.value;
@@ -1107,6 +1148,15 @@ struct AnalysisSameEventPairing {
       cutNames = fConfigMuonCuts.value;
       histNames = fTrackMuonHistNames;
     }
+
+    // resolve the pair histogram classes once: [0-2] = +-, ++, --, [3-5] = their unambiguous variants
+    std::vector<std::array<int, 6>> histHandles(histNames.size());
+    for (size_t i = 0; i < histNames.size(); i++) {
+      for (int j = 0; j < 3; j++) {
+        histHandles[i][j] = fHistMan->GetHistClassHandle(histNames[i][j].Data());
+        histHandles[i][j + 3] = fHistMan->GetHistClassHandle(Form("%s_unambiguous", histNames[i][j].Data()));
+      }
+    }
     std::unique_ptr<TObjArray> objArray(cutNames.Tokenize(","));
     int ncuts = objArray->GetEntries();
 
@@ -1173,6 +1223,9 @@ struct AnalysisSameEventPairing {
 
       // TODO: provide the type of pair to the dilepton table (e.g. ee, mumu, emu...)
       dileptonFilterMap = twoTrackFilter;
+      if (fExportPairs) {
+        fPairExport.AddPair(VarManager::fgValues[VarManager::kMass], VarManager::fgValues[VarManager::kPt], VarManager::fgValues[VarManager::kRap], t1.sign() + t2.sign(), dileptonFilterMap, dileptonMcDecision);
+      }
 
       if constexpr (TPairType == pairTypeEE) {
         dielectronList(event, VarManager::fgValues[VarManager::kMass], VarManager::fgValues[VarManager::kPt], VarManager::fgValues[VarManager::kEta], VarManager::fgValues[VarManager::kPhi], t1.sign() + t2.sign(), dileptonFilterMap, dileptonMcDecision);
@@ -1252,20 +1305,20 @@ struct AnalysisSameEventPairing {
       for (int icut = 0; icut < ncuts; icut++) {
         if (twoTrackFilter & (uint32_t(1) << icut)) {
           if (t1.sign() * t2.sign() < 0) {
-            fHistMan->FillHistClass(histNames[iCut][0].Data(), VarManager::fgValues);
+            fHistMan->FillHistClass(histHandles[iCut][0], VarManager::fgValues);
             if (fConfigAmbiguousHist && !(t1.isAmbiguous() || t2.isAmbiguous())) {
-              fHistMan->FillHistClass(Form("%s_unambiguous", histNames[iCut][0].Data()), VarManager::fgValues);
+              fHistMan->FillHistClass(histHandles[iCut][0 + 3], VarManager::fgValues);
             }
           } else {
             if (t1.sign() > 0) {
-              fHistMan->FillHistClass(histNames[iCut][1].Data(), VarManager::fgValues);
+              fHistMan->FillHistClass(histHandles[iCut][1], VarManager::fgValues);
               if (fConfigAmbiguousHist && !(t1.isAmbiguous() || t2.isAmbiguous())) {
-                fHistMan->FillHistClass(Form("%s_unambiguous", histNames[iCut][1].Data()), VarManager::fgValues);
+                fHistMan->FillHistClass(histHandles[iCut][1 + 3], VarManager::fgValues);
               }
             } else {
-              fHistMan->FillHistClass(histNames[iCut][2].Data(), VarManager::fgValues);
+              fHistMan->FillHistClass(histHandles[iCut][2], VarManager::fgValues);
               if (fConfigAmbiguousHist && !(t1.isAmbiguous() || t2.isAmbiguous())) {
-                fHistMan->FillHistClass(Form("%s_unambiguous", histNames[iCut][2].Data()), VarManager::fgValues);
+                fHistMan->FillHistClass(histHandles[iCut][2 + 3], VarManager::fgValues);
               }
             }
           }
@@ -1275,20 +1328,20 @@ struct AnalysisSameEventPairing {
             if (!(cut.IsSelected(VarManager::fgValues))) // apply pair cuts
               continue;
             if (t1.sign() * t2.sign() < 0) {
-              fHistMan->FillHistClass(histNames[iCut][0].Data(), VarManager::fgValues);
+              fHistMan->FillHistClass(histHandles[iCut][0], VarManager::fgValues);
               if (fConfigAmbiguousHist && !(t1.isAmbiguous() || t2.isAmbiguous())) {
-                fHistMan->FillHistClass(Form("%s_unambiguous", histNames[iCut][0].Data()), VarManager::fgValues);
+                fHistMan->FillHistClass(histHandles[iCut][0 + 3], VarManager::fgValues);
               }
             } else {
               if (t1.sign() > 0) {
-                fHistMan->FillHistClass(histNames[iCut][1].Data(), VarManager::fgValues);
+                fHistMan->FillHistClass(histHandles[iCut][1], VarManager::fgValues);
                 if (fConfigAmbiguousHist && !(t1.isAmbiguous() || t2.isAmbiguous())) {
-                  fHistMan->FillHistClass(Form("%s_unambiguous", histNames[iCut][1].Data()), VarManager::fgValues);
+                  fHistMan->FillHistClass(histHandles[iCut][1 + 3], VarManager::fgValues);
                 }
               } else {
-                fHistMan->FillHistClass(histNames[iCut][2].Data(), VarManager::fgValues);
+                fHistMan->FillHistClass(histHandles[iCut][2], VarManager::fgValues);
                 if (fConfigAmbiguousHist && !(t1.isAmbiguous() || t2.isAmbiguous())) {
-                  fHistMan->FillHistClass(Form("%s_unambiguous", histNames[iCut][2].Data()), VarManager::fgValues);
+                  fHistMan->FillHistClass(histHandles[iCut][2 + 3], VarManager::fgValues);
                 }
               }
             }
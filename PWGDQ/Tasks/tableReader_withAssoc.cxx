@@ -352,6 +352,13 @@ struct AnalysisTrackSelection {
   std::map<int64_t, std::vector<int64_t>> fNAssocsInBunch;    // key: track global index, value: vector of global index for events associated in-bunch (events that have in-bunch pileup or splitting)
   std::map<int64_t, std::vector<int64_t>> fNAssocsOutOfBunch; // key: track global index, value: vector of global index for events associated out-of-bunch (events that have no in-bunch pileup)
 
+  // memoisation of the track quantities not depending on the associated collision, for the tracks with several associations
+  std::vector<int> fCachedVars;         // used track variables not depending on the associated collision
+  uint32_t fCollisionCutsMask = 0;      // cuts using event variables or the DCA, evaluated for each association
+  std::vector<float> fCachedValues;     // values of fCachedVars, per track of the dataframe
+  std::vector<uint32_t> fCachedFilter;  // decisions of the cuts not depending on the associated collision, per track
+  std::vector<char> fIsTrackCached;     // true once the track is filled in the current dataframe
+
   void init(o2::framework::InitContext&)
   {
     fCurrentRun = 0;
@@ -392,6 +399,25 @@ struct AnalysisTrackSelection {
       fCCDB->setLocalObjectValidityChecking();
       fCCDB->setCreatedNotAfter(fConfigNoLaterThan.value);
     }
+
+    // variables depending on the associated collision: the event-wise ones and the DCA computed in FillTrackCollision
+    std::vector<bool> collisionVars(VarManager::kNVars, false);
+    for (int var = 0; var < VarManager::kX; var++) {
+      collisionVars[var] = true;
+    }
+    for (int var : {VarManager::kTrackDCAxy, VarManager::kTrackDCAz, VarManager::kTrackDCAsigXY, VarManager::kTrackDCAsigZ}) {
+      collisionVars[var] = true;
+    }
+    for (int var = VarManager::kX; var < VarManager::kNBarrelTrackVariables; var++) {
+      if (VarManager::GetUsedVar(var) && !collisionVars[var]) {
+        fCachedVars.push_back(var);
+      }
+    }
+    for (size_t iCut = 0; iCut < fTrackCuts.size(); iCut++) {
+      if (fTrackCuts[iCut].UsesAnyVar(collisionVars)) {
+        fCollisionCutsMask |= (uint32_t(1) << iCut);
+      }
+    }
   }
 
   template <uint32_t TEventFillMap, uint32_t TTrackFillMap, typename TEvents, typename TTracks>
@@ -424,6 +450,11 @@ struct AnalysisTrackSelection {
     uint32_t filterMap = 0;
     int iCut = 0;
 
+    const size_t nCachedVars = fCachedVars.size();
+    fCachedValues.resize(tracks.size() * nCachedVars);
+    fCachedFilter.resize(tracks.size());
+    fIsTrackCached.assign(tracks.size(), false);
+
     for (auto& assoc : assocs) {
       auto event = assoc.template reducedevent_as<TEvents>();
       if (!event.isEventSelected_bit(0)) {
@@ -435,20 +466,44 @@ struct AnalysisTrackSelection {
       VarManager::FillEvent<TEventFillMap>(event);
 
       auto track = assoc.template reducedtrack_as<TTracks>();
-      filterMap = 0;
-      VarManager::FillTrack<TTrackFillMap>(track);
+      float* cachedValues = fCachedValues.data() + track.globalIndex() * nCachedVars;
+      bool isCached = fIsTrackCached[track.globalIndex()];
+      if (isCached) {
+        // the track quantities were computed at a previous association of the track
+        for (size_t iVar = 0; iVar < nCachedVars; iVar++) {
+          VarManager::fgValues[fCachedVars[iVar]] = cachedValues[iVar];
+        }
+      } else {
+        VarManager::FillTrack<TTrackFillMap>(track);
+        for (size_t iVar = 0; iVar < nCachedVars; iVar++) {
+          cachedValues[iVar] = VarManager::fgValues[fCachedVars[iVar]];
+        }
+      }
       // compute quantities which depend on the associated collision, such as DCA
       VarManager::FillTrackCollision<TTrackFillMap>(track, event);
       if (fConfigQA) {
         fHistMan->FillHistClass("TrackBarrel_BeforeCuts", VarManager::fgValues);
       }
+      if (!isCached) {
+        // decisions of the cuts not depending on the associated collision
+        iCut = 0;
+        uint32_t cachedFilter = 0;
+        for (auto cut = fTrackCuts.begin(); cut != fTrackCuts.end(); cut++, iCut++) {
+          if (!(fCollisionCutsMask & (uint32_t(1) << iCut)) && (*cut).IsSelected(VarManager::fgValues)) {
+            cachedFilter |= (uint32_t(1) << iCut);
+          }
+        }
+        fCachedFilter[track.globalIndex()] = cachedFilter;
+        fIsTrackCached[track.globalIndex()] = true;
+      }
+      filterMap = fCachedFilter[track.globalIndex()];
       iCut = 0;
       for (auto cut = fTrackCuts.begin(); cut != fTrackCuts.end(); cut++, iCut++) {
-        if ((*cut).IsSelected(VarManager::fgValues)) {
+        if ((fCollisionCutsMask & (uint32_t(1) << iCut)) && (*cut).IsSelected(VarManager::fgValues)) {
           filterMap |= (uint32_t(1) << iCut);
-          if (fConfigQA) {
-            fHistMan->FillHistClass(Form("TrackBarrel_%s", (*cut).GetName()), VarManager::fgValues);
-          }
+        }
+        if (fConfigQA && (filterMap & (uint32_t(1) << iCut))) {
+          fHistMan->FillHistClass(Form("TrackBarrel_%s", (*cut).GetName()), VarManager::fgValues);
         }
       } // end loop over cuts
 
@@ -642,6 +697,7 @@ struct AnalysisMuonSelection {
 
   void processSkimmed(ReducedMuonsAssoc const& assocs, MyEventsVtxCovSelected const& events, MyMuonTracksWithCov const& muons)
   {
+    VarManager::ResetMuonPropagationCache();
     runMuonSelection<gkEventFillMapWithCov, gkMuonFillMapWithCov>(assocs, events, muons);
   }
   void processDummy(MyEvents&)
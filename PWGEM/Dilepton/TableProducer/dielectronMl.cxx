@@ -14,6 +14,8 @@
 /// \author Daniel Samitz, <daniel.samitz@cern.ch>, SMI Vienna
 ///         Elisa Meninno, <elisa.meninno@cern.ch>, SMI Vienna
 
+#include <vector>
+
 #include "Framework/AnalysisTask.h"
 #include "Framework/runDataProcessing.h"
 #include "Common/DataModel/TrackSelectionTables.h"
@@ -145,15 +147,26 @@ struct DielectronMlSingleTrack {
   Configurable<std::vector<std::string>> onnxFileNames{"onnxFileNames", std::vector<std::string>{""}, "ONNX file names for each pT bin (if not from CCDB full path)"};
   Configurable<int64_t> timestampCCDB{"timestampCCDB", -1, "timestamp of the ONNX file for ML model used to query in CCDB"};
   Configurable<bool> loadModelsFromCCDB{"loadModelsFromCCDB", false, "Flag to enable or disable the loading of models from CCDB"};
+  Configurable<std::string> modelPrecision{"modelPrecision", "fp32", "Precision of the ML models (fp32, fp16, int8), reduced-precision models are stored with the suffix _fp16/_int8"};
+  Configurable<int> nCandidatesValidation{"nCandidatesValidation", 0, "Number of candidates used to compare the reduced-precision models with the FP32 ones (0: no validation)"};
   // preselection cuts (from treeCreatorElectronMl.cxx)
   Configurable<int> mincrossedrows{"mincrossedrows", 70, "min. crossed rows"};
   Configurable<float> maxchi2tpc{"maxchi2tpc", 4.0, "max. chi2/NclsTPC"};
   Configurable<float> maxeta{"maxeta", 0.9, "eta acceptance"};
+  Configurable<bool> useBatchInference{"useBatchInference", false, "Flag to evaluate the models once for all the candidates of a dataframe"};
   // table output
   Configurable<bool> fillScoreTable{"fillScoreTable", false, "fill table with scores from ML model"};
 
   o2::analysis::MlResponseDielectronSingleTrack<float> mlResponse;
   o2::ccdb::CcdbApi ccdbApi;
+  std::vector<float> validationInputs;
+  int nValidationCandidates = 0;
+  // buffers of the batch inference
+  std::vector<bool> isPreselected;
+  std::vector<float> batchInputs;
+  std::vector<float> batchPts;
+  std::vector<bool> batchIsSelected;
+  std::vector<float> batchOutputs;
   std::vector<std::shared_ptr<TH1>> hModelScore;
   std::vector<std::shared_ptr<TH2>> hModelScoreVsPt;
 
@@ -163,6 +176,7 @@ struct DielectronMlSingleTrack {
   {
     if (doprocessSkimmedSingleTrack || doprocessAO2DSingleTrack) {
       mlResponse.configure(binsPtMl, cutsMl, cutDirMl, nClassesMl);
+      mlResponse.setModelPrecision(o2::ml::getModelPrecisionFromName(modelPrecision), nCandidatesValidation > 0);
       if (loadModelsFromCCDB) {
         ccdbApi.init(ccdbUrl);
         mlResponse.setModelPathsCCDB(onnxFileNames, ccdbApi, modelPathsCCDB, timestampCCDB);
@@ -182,6 +196,19 @@ struct DielectronMlSingleTrack {
     }
   }
 
+  // compare the reduced-precision models with the FP32 ones on the first candidates
+  void validateModelPrecision(std::vector<float> const& inputFeatures)
+  {
+    if (nValidationCandidates >= nCandidatesValidation) {
+      return;
+    }
+    validationInputs.insert(validationInputs.end(), inputFeatures.begin(), inputFeatures.end());
+    if (++nValidationCandidates == nCandidatesValidation) {
+      mlResponse.validateModelPrecision(validationInputs);
+      validationInputs.clear();
+    }
+  }
+
   template <typename T>
   bool applyPreSelectionCuts(T const& track)
   {
@@ -227,6 +254,7 @@ struct DielectronMlSingleTrack {
       }
       auto pt = track.pt();
       std::vector<float> inputFeatures = mlResponse.getInputFeatures(track);
+      validateModelPrecision(inputFeatures);
       std::vector<float> outputMl = {};
 
       bool isSelected = mlResponse.isSelectedMl(inputFeatures, pt, outputMl);
@@ -241,14 +269,64 @@ struct DielectronMlSingleTrack {
     }
   }
 
+  // same as runSingleTracks, with the features of all preselected tracks scored in one batch
+  template <typename T>
+  void runSingleTracksBatch(T const& tracks)
+  {
+    isPreselected.clear();
+    batchInputs.clear();
+    batchPts.clear();
+    for (const auto& track : tracks) {
+      isPreselected.push_back(applyPreSelectionCuts(track));
+      if (!isPreselected.back()) {
+        continue;
+      }
+      std::vector<float> inputFeatures = mlResponse.getInputFeatures(track);
+      validateModelPrecision(inputFeatures);
+      batchInputs.insert(batchInputs.end(), inputFeatures.begin(), inputFeatures.end());
+      batchPts.push_back(track.pt());
+    }
+    mlResponse.isSelectedMlBatch(batchInputs, batchPts, batchIsSelected, batchOutputs);
+
+    size_t iCand = 0;
+    for (size_t iTrack = 0; iTrack < isPreselected.size(); iTrack++) {
+      if (!isPreselected[iTrack]) {
+        singleTrackSelection(false);
+        if (fillScoreTable) {
+          std::vector<float> outputMl(nClassesMl, -1);
+          singleTrackScore(outputMl);
+        }
+        continue;
+      }
+      std::vector<float> outputMl(batchOutputs.begin() + iCand * nClassesMl, batchOutputs.begin() + (iCand + 1) * nClassesMl);
+      for (int classMl = 0; classMl < nClassesMl; classMl++) {
+        hModelScore[classMl]->Fill(outputMl[classMl]);
+        hModelScoreVsPt[classMl]->Fill(outputMl[classMl], batchPts[iCand]);
+      }
+      singleTrackSelection(batchIsSelected[iCand]);
+      if (fillScoreTable) {
+        singleTrackScore(outputMl);
+      }
+      iCand++;
+    }
+  }
+
   void processSkimmedSingleTrack(MySkimmedTracksWithPID const& tracks)
   {
+    if (useBatchInference) {
+      runSingleTracksBatch(tracks);
+      return;
+    }
     runSingleTracks(tracks);
   }
   PROCESS_SWITCH(DielectronMlSingleTrack, processSkimmedSingleTrack, "Apply ML selection on skimmed output on single tracks", true);
 
   void processAO2DSingleTrack(MyTracksWithPID const& tracks)
   {
+    if (useBatchInference) {
+      runSingleTracksBatch(tracks);
+      return;
+    }
     runSingleTracks(tracks);
   }
   PROCESS_SWITCH(DielectronMlSingleTrack, processAO2DSingleTrack, "Apply ML selection on skimmed output on single tracks", false);
@@ -276,11 +354,23 @@ struct DielectronMlPair {
   Configurable<std::vector<std::string>> onnxFileNames{"onnxFileNames", std::vector<std::string>{""}, "ONNX file names for each pT bin (if not from CCDB full path)"};
   Configurable<int64_t> timestampCCDB{"timestampCCDB", -1, "timestamp of the ONNX file for ML model used to query in CCDB"};
   Configurable<bool> loadModelsFromCCDB{"loadModelsFromCCDB", false, "Flag to enable or disable the loading of models from CCDB"};
+  Configurable<std::string> modelPrecision{"modelPrecision", "fp32", "Precision of the ML models (fp32, fp16, int8), reduced-precision models are stored with the suffix _fp16/_int8"};
+  Configurable<int> nCandidatesValidation{"nCandidatesValidation", 0, "Number of candidates used to compare the reduced-precision models with the FP32 ones (0: no validation)"};
+  Configurable<bool> useBatchInference{"useBatchInference", false, "Flag to evaluate the models once for all the candidates of a dataframe"};
   // table output
   Configurable<bool> fillScoreTable{"fillScoreTable", false, "fill table with scores from ML model"};
 
   o2::analysis::MlResponseDielectronPair<float> mlResponse;
   o2::ccdb::CcdbApi ccdbApi;
+  std::vector<float> validationInputs;
+  int nValidationCandidates = 0;
+  // buffers of the batch inference
+  std::vector<o2::analysis::DielectronPairLeg> legs; // by track index
+  std::vector<bool> hasLeg;
+  std::vector<float> batchInputs;
+  std::vector<float> batchMasses;
+  std::vector<bool> batchIsSelected;
+  std::vector<float> batchOutputs;
   std::vector<std::shared_ptr<TH1>> hModelScore;
   std::vector<std::shared_ptr<TH2>> hModelScoreVsM;
 
@@ -290,6 +380,7 @@ struct DielectronMlPair {
   {
     if (doprocessPair) {
       mlResponse.configure(binsMMl, cutsMl, cutDirMl, nClassesMl);
+      mlResponse.setModelPrecision(o2::ml::getModelPrecisionFromName(modelPrecision), nCandidatesValidation > 0);
       if (loadModelsFromCCDB) {
         ccdbApi.init(ccdbUrl);
         mlResponse.setModelPathsCCDB(onnxFileNames, ccdbApi, modelPathsCCDB, timestampCCDB);
@@ -309,11 +400,72 @@ struct DielectronMlPair {
     }
   }
 
-  void processPair(DielectronsExtra const& dielectrons, MySkimmedTracks const&)
+  // compare the reduced-precision models with the FP32 ones on the first candidates
+  void validateModelPrecision(std::vector<float> const& inputFeatures)
+  {
+    if (nValidationCandidates >= nCandidatesValidation) {
+      return;
+    }
+    validationInputs.insert(validationInputs.end(), inputFeatures.begin(), inputFeatures.end());
+    if (++nValidationCandidates == nCandidatesValidation) {
+      mlResponse.validateModelPrecision(validationInputs);
+      validationInputs.clear();
+    }
+  }
+
+  // same as the pair loop of processPair, with the track quantities read once per track and all the pairs scored in one batch
+  void runPairsBatch(DielectronsExtra const& dielectrons, MySkimmedTracks const& tracks)
+  {
+    legs.resize(tracks.size());
+    hasLeg.assign(tracks.size(), false);
+    auto getLeg = [&](int64_t index, auto const& track) -> o2::analysis::DielectronPairLeg const& {
+      if (!hasLeg[index]) {
+        legs[index] = o2::analysis::DielectronPairLeg(track);
+        hasLeg[index] = true;
+      }
+      return legs[index];
+    };
+
+    batchInputs.clear();
+    batchMasses.clear();
+    for (const auto& dielectron : dielectrons) {
+      const auto& leg1 = getLeg(dielectron.index0Id(), dielectron.index0_as<MySkimmedTracks>());
+      const auto& leg2 = getLeg(dielectron.index1Id(), dielectron.index1_as<MySkimmedTracks>());
+      if (leg1.sign() == leg2.sign()) {
+        continue;
+      }
+      ROOT::Math::PtEtaPhiMVector v1(leg1.pt(), leg1.eta(), leg1.phi(), o2::constants::physics::MassElectron);
+      ROOT::Math::PtEtaPhiMVector v2(leg2.pt(), leg2.eta(), leg2.phi(), o2::constants::physics::MassElectron);
+      ROOT::Math::PtEtaPhiMVector v12 = v1 + v2;
+      std::vector<float> inputFeatures = mlResponse.getInputFeatures(leg1, leg2);
+      validateModelPrecision(inputFeatures);
+      batchInputs.insert(batchInputs.end(), inputFeatures.begin(), inputFeatures.end());
+      batchMasses.push_back(v12.M());
+    }
+    mlResponse.isSelectedMlBatch(batchInputs, batchMasses, batchIsSelected, batchOutputs);
+
+    for (size_t iCand = 0; iCand < batchMasses.size(); iCand++) {
+      std::vector<float> outputMl(batchOutputs.begin() + iCand * nClassesMl, batchOutputs.begin() + (iCand + 1) * nClassesMl);
+      for (int classMl = 0; classMl < nClassesMl; classMl++) {
+        hModelScore[classMl]->Fill(outputMl[classMl]);
+        hModelScoreVsM[classMl]->Fill(outputMl[classMl], batchMasses[iCand]);
+      }
+      pairSelection(batchIsSelected[iCand]);
+      if (fillScoreTable) {
+        pairScore(outputMl);
+      }
+    }
+  }
+
+  void processPair(DielectronsExtra const& dielectrons, MySkimmedTracks const& tracks)
   {
     // dummy value for magentic field. ToDo: take it from ccdb!
     float d_bz = 1.;
     mlResponse.setBz(d_bz);
+    if (useBatchInference) {
+      runPairsBatch(dielectrons, tracks);
+      return;
+    }
     for (const auto& dielectron : dielectrons) {
       const auto& track1 = dielectron.index0_as<MySkimmedTracks>();
       const auto& track2 = dielectron.index1_as<MySkimmedTracks>();
@@ -325,6 +477,7 @@ struct DielectronMlPair {
       ROOT::Math::PtEtaPhiMVector v12 = v1 + v2;
       auto m = v12.M();
       std::vector<float> inputFeatures = mlResponse.getInputFeatures(track1, track2);
+      validateModelPrecision(inputFeatures);
       std::vector<float> outputMl = {};
 
       bool isSelected = mlResponse.isSelectedMl(inputFeatures, m, outputMl);
@@ -139,6 +139,7 @@ struct lmeelfcocktail {
   Configurable<std::string> fConfigResEtaHistName{"cfgResEtaHistName", "EtaResArr", "histogram name for eta in resolution file"};
   Configurable<std::string> fConfigResPhiPosHistName{"cfgResPhiPosHistName", "PhiPosResArr", "histogram name for phi pos in resolution file"};
   Configurable<std::string> fConfigResPhiNegHistName{"cfgResPhiNegHistName", "PhiEleResArr", "hisogram for phi neg in resolution file"};
+  Configurable<bool> fConfigUseSamplingTables{"cfgUseSamplingTables", false, "sample the resolution from tables built at init instead of the histograms"};
   Configurable<std::string> fConfigDCAFileName{"cfgDCAFileName", "", "DCA file name"};
   Configurable<std::string> fConfigDCAHistName{"cfgDCAHistName", "fh_DCAtemplate", "histogram name in DCA file"};
   Configurable<std::string> fConfigMultFileName{"cfgMultFileName", "", "multiplicity file name"};
@@ -860,6 +861,7 @@ struct lmeelfcocktail {
     smearer.setResEtaHistName(etaHistName);
     smearer.setResPhiPosHistName(phiPosHistName);
     smearer.setResPhiNegHistName(phiNegHistName);
+    smearer.setUseSamplingTables(fConfigUseSamplingTables);
     smearer.init();
   }
 
@@ -41,6 +41,7 @@ struct ApplySmearing {
   Configurable<std::string> fConfigResPhiNegHistName{"cfgResPhiNegHistName", "PhiEleResArr", "hisogram for phi neg in resolution file"};
   Configurable<std::string> fConfigEffFileName{"cfgEffFileName", "", "name of efficiency file"};
   Configurable<std::string> fConfigEffHistName{"cfgEffHistName", "fhwEffpT", "name of efficiency histogram"};
+  Configurable<bool> fConfigUseSamplingTables{"cfgUseSamplingTables", false, "sample the resolution from tables built at init instead of the histograms"};
 
   MomentumSmearer smearer;
 
@@ -53,6 +54,7 @@ struct ApplySmearing {
     smearer.setResPhiNegHistName(TString(fConfigResPhiNegHistName));
     smearer.setEffFileName(TString(fConfigEffFileName));
     smearer.setEffHistName(TString(fConfigEffHistName));
+    smearer.setUseSamplingTables(fConfigUseSamplingTables);
     smearer.init();
   }
 
@@ -65,6 +65,34 @@ enum class InputFeaturesDielectronPair : uint8_t {
   pairDcaZ
 };
 
+/// Track quantities used by the pair features, with the getters of the tracks used by getInputFeatures,
+/// such that they are read once per track when a track is in many pairs
+struct DielectronPairLeg {
+  float mPt = 0.f;
+  float mEta = 0.f;
+  float mPhi = 0.f;
+  float mDcaXY = 0.f;
+  float mDcaZ = 0.f;
+  float mCYY = 0.f;
+  float mCZZ = 0.f;
+  int mSign = 0;
+
+  template <typename T>
+  explicit DielectronPairLeg(T const& track) : mPt(track.pt()), mEta(track.eta()), mPhi(track.phi()), mDcaXY(track.dcaXY()), mDcaZ(track.dcaZ()), mCYY(track.cYY()), mCZZ(track.cZZ()), mSign(track.sign())
+  {
+  }
+  DielectronPairLeg() = default;
+
+  float pt() const { return mPt; }
+  float eta() const { return mEta; }
+  float phi() const { return mPhi; }
+  float dcaXY() const { return mDcaXY; }
+  float dcaZ() const { return mDcaZ; }
+  float cYY() const { return mCYY; }
+  float cZZ() const { return mCZZ; }
+  int sign() const { return mSign; }
+};
+
 template <typename TypeOutputScore = float>
 class MlResponseDielectronPair : public MlResponse<TypeOutputScore>
 {
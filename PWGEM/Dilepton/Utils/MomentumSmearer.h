@@ -11,11 +11,20 @@
 //
 //
 // Class to produce smeared pt,eta,phi
+// Optionally, the resolution histograms are converted to sampling tables at init: the cumulative distribution of each
+// pT bin with a guide table, such that a sample costs one random number and on average O(1) steps. The samples are
+// the same as from TH1::GetRandom for the same random numbers.
 
 #ifndef PWGEM_DILEPTON_UTILS_MOMENTUMSMEARER_H_
 #define PWGEM_DILEPTON_UTILS_MOMENTUMSMEARER_H_
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
 #include <TH1D.h>
+#include <TRandom.h>
 #include <TString.h>
 #include <TGrid.h>
 #include <TObjArray.h>
@@ -110,6 +119,14 @@ class MomentumSmearer
       fArrResoPhi_Pos = ArrResoPhi_Pos;
       fArrResoPhi_Neg = ArrResoPhi_Neg;
       fFile->Close();
+
+      if (fUseSamplingTables) {
+        LOGP(info, "Build sampling tables of the resolution histos");
+        fillSamplingTables(fArrResoPt, fTablesPt);
+        fillSamplingTables(fArrResoEta, fTablesEta);
+        fillSamplingTables(fArrResoPhi_Pos, fTablesPhi_Pos);
+        fillSamplingTables(fArrResoPhi_Neg, fTablesPhi_Neg);
+      }
     }
 
     // get efficiency histo
@@ -155,9 +172,13 @@ class MomentumSmearer
       ptbin = fArrResoPt->GetLast();
     }
     float smearing = 0.;
-    TH1D* thisHist = reinterpret_cast<TH1D*>(fArrResoPt->At(ptbin));
-    if (thisHist->GetEntries() > 0) {
-      smearing = thisHist->GetRandom() * ptgen;
+    if (fUseSamplingTables) {
+      smearing = fTablesPt[ptbin].getRandom() * ptgen;
+    } else {
+      TH1D* thisHist = reinterpret_cast<TH1D*>(fArrResoPt->At(ptbin));
+      if (thisHist->GetEntries() > 0) {
+        smearing = thisHist->GetRandom() * ptgen;
+      }
     }
     ptsmeared = ptgen - smearing;
 
@@ -170,9 +191,13 @@ class MomentumSmearer
       ptbin = fArrResoEta->GetLast();
     }
     smearing = 0.;
-    thisHist = reinterpret_cast<TH1D*>(fArrResoEta->At(ptbin));
-    if (thisHist->GetEntries() > 0) {
-      smearing = thisHist->GetRandom();
+    if (fUseSamplingTables) {
+      smearing = fTablesEta[ptbin].getRandom();
+    } else {
+      TH1D* thisHist = reinterpret_cast<TH1D*>(fArrResoEta->At(ptbin));
+      if (thisHist->GetEntries() > 0) {
+        smearing = thisHist->GetRandom();
+      }
     }
     etasmeared = etagen - smearing;
 
@@ -185,17 +210,30 @@ class MomentumSmearer
       ptbin = fArrResoPhi_Pos->GetLast();
     }
     smearing = 0.;
-    if (ch < 0) {
-      thisHist = reinterpret_cast<TH1D*>(fArrResoPhi_Neg->At(ptbin));
+    if (fUseSamplingTables) {
+      smearing = (ch < 0 ? fTablesPhi_Neg : fTablesPhi_Pos)[ptbin].getRandom();
     } else {
-      thisHist = reinterpret_cast<TH1D*>(fArrResoPhi_Pos->At(ptbin));
-    }
-    if (thisHist->GetEntries() > 0) {
-      smearing = thisHist->GetRandom();
+      TH1D* thisHist = nullptr;
+      if (ch < 0) {
+        thisHist = reinterpret_cast<TH1D*>(fArrResoPhi_Neg->At(ptbin));
+      } else {
+        thisHist = reinterpret_cast<TH1D*>(fArrResoPhi_Pos->At(ptbin));
+      }
+      if (thisHist->GetEntries() > 0) {
+        smearing = thisHist->GetRandom();
+      }
     }
     phismeared = phigen - smearing;
   }
 
+  /// Smearing of n leptons, with the same random numbers as n calls of applySmearing
+  void applySmearing(const int n, const int* ch, const float* ptgen, const float* etagen, const float* phigen, float* ptsmeared, float* etasmeared, float* phismeared)
+  {
+    for (int i = 0; i < n; i++) {
+      applySmearing(ch[i], ptgen[i], etagen[i], phigen[i], ptsmeared[i], etasmeared[i], phismeared[i]);
+    }
+  }
+
   float getEfficiency(float pt, float eta, float phi)
   {
 
@@ -261,6 +299,7 @@ class MomentumSmearer
   }
 
   // setters
+  void setUseSamplingTables(bool useSamplingTables) { fUseSamplingTables = useSamplingTables; }
   void setResFileName(TString resFileName) { fResFileName = resFileName; }
   void setResPtHistName(TString resPtHistName) { fResPtHistName = resPtHistName; }
   void setResEtaHistName(TString resEtaHistName) { fResEtaHistName = resEtaHistName; }
@@ -270,6 +309,7 @@ class MomentumSmearer
   void setEffHistName(TString effHistName) { fEffHistName = effHistName; }
 
   // getters
+  bool getUseSamplingTables() { return fUseSamplingTables; }
   TString getResFileName() { return fResFileName; }
   TString getResPtHistName() { return fResPtHistName; }
   TString getResEtaHistName() { return fResEtaHistName; }
@@ -284,7 +324,80 @@ class MomentumSmearer
   TObject* getArrEff() { return fArrEff; }
 
  private:
+  // cumulative distribution of a resolution histogram, as TH1::ComputeIntegral, with a guide table to its bins
+  struct SamplingTable {
+    std::vector<double> integral; // nbins + 1 entries, normalised to 1
+    std::vector<double> lowEdges;
+    std::vector<double> widths;
+    std::vector<int> guide; // guide[i]: last bin with integral <= i / guide.size()
+    double value = 0.;      // returned value of an empty (or invalid) histogram
+
+    void fill(TH1* hist)
+    {
+      integral.clear();
+      guide.clear();
+      value = 0.;
+      if (hist->GetEntries() <= 0) {
+        return;
+      }
+      const double sum = hist->ComputeIntegral(true);
+      if (sum == 0) {
+        return;
+      }
+      if (std::isnan(sum)) { // some bins have a negative content
+        value = std::numeric_limits<double>::quiet_NaN();
+        return;
+      }
+      const int nbins = hist->GetNbinsX();
+      const double* histIntegral = hist->GetIntegral();
+      integral.assign(histIntegral, histIntegral + nbins + 1);
+      lowEdges.resize(nbins);
+      widths.resize(nbins);
+      for (int i = 0; i < nbins; i++) {
+        lowEdges[i] = hist->GetBinLowEdge(i + 1);
+        widths[i] = hist->GetBinWidth(i + 1);
+      }
+      guide.resize(nbins);
+      int ibin = 0;
+      for (int i = 0; i < nbins; i++) {
+        const double r = static_cast<double>(i) / nbins;
+        while (ibin + 1 < nbins && integral[ibin + 1] <= r) {
+          ibin++;
+        }
+        guide[i] = ibin;
+      }
+    }
+
+    // same as TH1::GetRandom
+    double getRandom() const
+    {
+      if (integral.empty()) {
+        return value;
+      }
+      const int nbins = guide.size();
+      const double r = gRandom->Rndm();
+      int ibin = guide[std::min(static_cast<int>(r * nbins), nbins - 1)];
+      while (ibin + 1 < nbins && integral[ibin + 1] <= r) {
+        ibin++;
+      }
+      double x = lowEdges[ibin];
+      if (r > integral[ibin]) {
+        x += widths[ibin] * (r - integral[ibin]) / (integral[ibin + 1] - integral[ibin]);
+      }
+      return x;
+    }
+  };
+
+  void fillSamplingTables(TObjArray* arr, std::vector<SamplingTable>& tables)
+  {
+    tables.resize(arr->GetLast() + 1);
+    for (int i = 1; i <= arr->GetLast(); i++) {
+      tables[i].fill(reinterpret_cast<TH1*>(arr->At(i)));
+    }
+  }
+
   bool fInitialized = false;
+  bool fUseSamplingTables = false;
   TString fResFileName;
   TString fResPtHistName;
   TString fResEtaHistName;
@@ -298,6 +411,10 @@ class MomentumSmearer
   TObjArray* fArrResoPhi_Pos;
   TObjArray* fArrResoPhi_Neg;
   TObject* fArrEff;
+  std::vector<SamplingTable> fTablesPt; // sampling tables of the resolution histos, by pT bin
+  std::vector<SamplingTable> fTablesEta;
+  std::vector<SamplingTable> fTablesPhi_Pos;
+  std::vector<SamplingTable> fTablesPhi_Neg;
 };
 
 #endif // PWGEM_DILEPTON_UTILS_MOMENTUMSMEARER_H_
@@ -52,6 +52,7 @@
 #include "PWGEM/PhotonMeson/Utils/PairUtilities.h"
 #include "PWGEM/PhotonMeson/Utils/EMTrack.h"
 #include "PWGEM/PhotonMeson/Utils/EventMixingHandler.h"
+#include "PWGEM/PhotonMeson/Utils/PhotonMixingPool.h"
 #include "PWGEM/PhotonMeson/Utils/EventHistograms.h"
 #include "PWGEM/PhotonMeson/Utils/NMHistograms.h"
 
@@ -94,6 +95,7 @@ struct Pi0EtaToGammaGamma {
   Configurable<float> maxY{"maxY", 0.9, "maximum rapidity for reconstructed particles"};
   Configurable<bool> cfgDoMix{"cfgDoMix", true, "flag for event mixing"};
   Configurable<int> ndepth{"ndepth", 10, "depth for event mixing"};
+  Configurable<bool> cfgUsePooledMixing{"cfgUsePooledMixing", false, "flag to select the photons once per event and pair/mix them from compact arrays (photon-photon pairs only)"};
   ConfigurableAxis ConfVtxBins{"ConfVtxBins", {VARIABLE_WIDTH, -10.0f, -8.f, -6.f, -4.f, -2.f, 0.f, 2.f, 4.f, 6.f, 8.f, 10.f}, "Mixing bins - z-vertex"};
   ConfigurableAxis ConfCentBins{"ConfCentBins", {VARIABLE_WIDTH, 0.0f, 5.0f, 10.0f, 20.0f, 30.0f, 40.0f, 50.0f, 60.0f, 70.0f, 80.0f, 90.0f, 100.f, 999.f}, "Mixing bins - centrality"};
   ConfigurableAxis ConfEPBins{"ConfEPBins", {VARIABLE_WIDTH, -M_PI / 2, -M_PI / 4, 0.0f, +M_PI / 4, +M_PI / 2}, "Mixing bins - event plane angle"};
@@ -230,6 +232,10 @@ struct Pi0EtaToGammaGamma {
 
     emh1 = new o2::aod::pwgem::photonmeson::utils::EventMixingHandler<std::tuple<int, int, int>, std::pair<int, int64_t>, EMTrack>(ndepth);
     emh2 = new o2::aod::pwgem::photonmeson::utils::EventMixingHandler<std::tuple<int, int, int>, std::pair<int, int64_t>, EMTrack>(ndepth);
+    mixingPool = new o2::aod::pwgem::photonmeson::utils::PhotonMixingPool<std::tuple<int, int, int>>(ndepth);
+    if (cfgUsePooledMixing && (pairtype == PairType::kPCMDalitzEE || pairtype == PairType::kPCMDalitzMuMu)) {
+      LOGF(info, "Pooled mixing is only implemented for photon-photon pairs, the event mixing handler is used for dilepton-photon pairs.");
+    }
 
     o2::aod::pwgem::photonmeson::utils::eventhistogram::addEventHistograms(&fRegistry, cfgDoFlow);
     if constexpr (pairtype == PairType::kPCMDalitzEE) {
@@ -256,6 +262,8 @@ struct Pi0EtaToGammaGamma {
     emh1 = 0x0;
     delete emh2;
     emh2 = 0x0;
+    delete mixingPool;
+    mixingPool = 0x0;
 
     used_photonIds.clear();
     used_photonIds.shrink_to_fit();
@@ -467,6 +475,104 @@ struct Pi0EtaToGammaGamma {
   o2::aod::pwgem::photonmeson::utils::EventMixingHandler<std::tuple<int, int, int>, std::pair<int, int64_t>, EMTrack>* emh2 = nullptr;
   std::vector<std::pair<int, int>> used_photonIds;              // <ndf, trackId>
   std::vector<std::tuple<int, int, int, int>> used_dileptonIds; // <ndf, trackId>
+  o2::aod::pwgem::photonmeson::utils::PhotonMixingPool<std::tuple<int, int, int>>* mixingPool = nullptr;
+
+  /// \brief Same-event pairing and event mixing of photon-photon pairs with the photons selected once per event
+  /// Each photon is stored in the mixing pool with the bitmask of the legs whose cut it passes. As with the event mixing handler,
+  /// only the photons used in a same-event pair are mixed, a photon used as both legs counting twice for pairs of the same kind.
+  template <typename TSubInfos1, typename TSubInfos2, typename TCollision, typename TPhotons1, typename TPhotons2, typename TPreslice1, typename TPreslice2, typename TCut1, typename TCut2, typename TTracksMatchedWithEMC>
+  void runPooledPairing(TCollision const& collision, std::tuple<int, int, int> const& key_bin,
+                        TPhotons1 const& photons1, TPhotons2 const& photons2,
+                        TPreslice1 const& perCollision1, TPreslice2 const& perCollision2,
+                        TCut1 const& cut1, TCut2 const& cut2,
+                        TTracksMatchedWithEMC const& tracks_emc)
+  {
+    using PhotonMixingPool = o2::aod::pwgem::photonmeson::utils::PhotonMixingPool<std::tuple<int, int, int>>;
+    constexpr bool sameKinds = pairtype == PairType::kPCMPCM || pairtype == PairType::kPHOSPHOS || pairtype == PairType::kEMCEMC;
+
+    auto photons1_per_collision = photons1.sliceBy(perCollision1, collision.globalIndex());
+    auto photons2_per_collision = photons2.sliceBy(perCollision2, collision.globalIndex());
+    mixingPool->ClearEvent();
+    for (auto& g1 : photons1_per_collision) {
+      uint8_t cuts = cut1.template IsSelected<TSubInfos1>(g1) ? PhotonMixingPool::kLeg1 : 0;
+      if constexpr (sameKinds) {
+        if (cut2.template IsSelected<TSubInfos2>(g1)) {
+          cuts |= PhotonMixingPool::kLeg2;
+        }
+      }
+      if (cuts != 0) {
+        mixingPool->AddPhoton(g1.globalIndex(), g1.pt(), g1.eta(), g1.phi(), 0.f, cuts);
+      }
+    }
+    if constexpr (!sameKinds) {
+      for (auto& g2 : photons2_per_collision) {
+        if (cut2.template IsSelected<TSubInfos2>(g2)) {
+          mixingPool->AddPhoton(g2.globalIndex(), g2.pt(), g2.eta(), g2.phi(), 0.f, PhotonMixingPool::kLeg2);
+        }
+      }
+    }
+
+    auto& photons = mixingPool->GetEvent();
+    int ndiphoton = 0;
+    for (size_t i1 = 0; i1 < photons.size(); i1++) {
+      if (!(photons[i1].cuts & PhotonMixingPool::kLeg1)) {
+        continue;
+      }
+      // strictly upper combinations for the same kinds, the photons keeping the order of the table
+      for (size_t i2 = sameKinds ? i1 + 1 : 0; i2 < photons.size(); i2++) {
+        if (!(photons[i2].cuts & PhotonMixingPool::kLeg2)) {
+          continue;
+        }
+        ROOT::Math::PxPyPzEVector v12 = photons[i1].momentum() + photons[i2].momentum();
+        if (abs(v12.Rapidity()) > maxY) {
+          continue;
+        }
+        o2::aod::pwgem::photonmeson::utils::nmhistogram::fillPairInfo<0, pairtype>(&fRegistry, collision, v12, cfgDoFlow);
+
+        if constexpr (pairtype == PairType::kEMCEMC) {
+          ROOT::Math::PtEtaPhiMVector v1(photons[i1].pt, photons[i1].eta, photons[i1].phi, 0.);
+          ROOT::Math::PtEtaPhiMVector v2(photons[i2].pt, photons[i2].eta, photons[i2].phi, 0.);
+          RotationBackground<MyEMCClusters>(ROOT::Math::PtEtaPhiMVector(v12), v1, v2, photons2_per_collision, photons[i1].globalIndex, photons[i2].globalIndex, cut1, tracks_emc);
+        }
+        photons[i1].legs |= PhotonMixingPool::kLeg1;
+        photons[i2].legs |= PhotonMixingPool::kLeg2;
+        ndiphoton++;
+      }
+    } // end of pairing loop
+
+    // event mixing
+    if (!cfgDoMix || !(ndiphoton > 0)) {
+      return;
+    }
+
+    for (auto& photons_from_event_pool : mixingPool->GetPoolEvents(key_bin)) {
+      for (auto& g1 : photons) {
+        if (g1.legs == 0) {
+          continue;
+        }
+        for (auto& g2 : photons_from_event_pool) {
+          int npairs = 0;
+          if constexpr (sameKinds) {
+            npairs = PhotonMixingPool::NLegs(g1.legs) * PhotonMixingPool::NLegs(g2.legs);
+          } else { //[photon1 from event1, photon2 from event2] and [photon1 from event2, photon2 from event1]
+            npairs = ((g1.legs & PhotonMixingPool::kLeg1) && (g2.legs & PhotonMixingPool::kLeg2)) + ((g1.legs & PhotonMixingPool::kLeg2) && (g2.legs & PhotonMixingPool::kLeg1));
+          }
+          if (npairs == 0) {
+            continue;
+          }
+          ROOT::Math::PxPyPzEVector v12 = g1.momentum() + g2.momentum();
+          if (abs(v12.Rapidity()) > maxY) {
+            continue;
+          }
+          for (int ipair = 0; ipair < npairs; ipair++) {
+            o2::aod::pwgem::photonmeson::utils::nmhistogram::fillPairInfo<1, pairtype>(&fRegistry, collision, v12, cfgDoFlow);
+          }
+        }
+      }
+    } // end of loop over mixed event pool
+
+    mixingPool->AddEventToPool(key_bin);
+  }
 
   template <typename TCollisions, typename TPhotons1, typename TPhotons2, typename TSubInfos1, typename TSubInfos2, typename TPreslice1, typename TPreslice2, typename TCut1, typename TCut2, typename TTracksMatchedWithEMC, typename TTracksMatchedWithPHOS>
   void runPairing(TCollisions const& collisions,
@@ -524,6 +630,13 @@ struct Pi0EtaToGammaGamma {
       std::tuple<int, int, int> key_bin = std::make_tuple(zbin, centbin, epbin);
       std::pair<int, int64_t> key_df_collision = std::make_pair(ndf, collision.globalIndex());
 
+      if constexpr (pairtype != PairType::kPCMDalitzEE && pairtype != PairType::kPCMDalitzMuMu) {
+        if (cfgUsePooledMixing) {
+          runPooledPairing<TSubInfos1, TSubInfos2>(collision, key_bin, photons1, photons2, perCollision1, perCollision2, cut1, cut2, tracks_emc);
+          continue;
+        }
+      }
+
       if constexpr (pairtype == PairType::kPCMPCM || pairtype == PairType::kPHOSPHOS || pairtype == PairType::kEMCEMC) { // same kinds pairing
         auto photons1_per_collision = photons1.sliceBy(perCollision1, collision.globalIndex());
         auto photons2_per_collision = photons2.sliceBy(perCollision2, collision.globalIndex());
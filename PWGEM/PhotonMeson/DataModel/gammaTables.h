@@ -546,6 +546,19 @@ DECLARE_SOA_TABLE(EMPrimaryElectronsPrefilterBit, "AOD", "PRMELEPFB", emprimarye
 // iterators
 using EMPrimaryElectronPrefilterBit = EMPrimaryElectronsPrefilterBit::iterator;
 
+namespace emtracksel
+{
+enum EMTrackSelBit : uint16_t {
+  kPrimaryQuality = 0, // ITS-TPC track quality of the primary lepton skimmers
+  kElectronPID,        // electron PID (TPC hadron rejection or TOF recovery) and TOF beta of skimmer-primary-electron
+  kMuonPID,            // muon PID of skimmer-primary-muon
+};
+DECLARE_SOA_COLUMN(SelBits, selBits, uint16_t); //! bit map of the passed selections, see EMTrackSelBit
+} // namespace emtracksel
+DECLARE_SOA_TABLE(EMTrackSels, "AOD", "EMTRACKSEL", emtracksel::SelBits); // joinable with Tracks, selections computed once per track for all the EM skimmers
+// iterators
+using EMTrackSel = EMTrackSels::iterator;
+
 namespace dalitzee
 {
 DECLARE_SOA_INDEX_COLUMN(EMEvent, emevent);                                         //!
@@ -0,0 +1,158 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \brief compute once per track the collision-independent track quality and PID selections of the primary lepton skimmers.
+///        skimmer-primary-electron and skimmer-primary-muon read the bits of EMTrackSels in their process functions with the suffix EMTrackSel,
+///        such that the selections are not evaluated again by each skimmer and for each pair. The cuts are the ones configured here.
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+#include <utility>
+
+#include "Framework/runDataProcessing.h"
+#include "Framework/AnalysisTask.h"
+#include "Framework/AnalysisDataModel.h"
+#include "Common/DataModel/PIDResponse.h"
+#include "PWGEM/PhotonMeson/DataModel/gammaTables.h"
+
+using namespace o2;
+using namespace o2::soa;
+using namespace o2::framework;
+using namespace o2::framework::expressions;
+
+using MyTracks = soa::Join<aod::Tracks, aod::TracksExtra,
+                           aod::pidTPCFullEl, aod::pidTPCFullMu, aod::pidTPCFullPi, aod::pidTPCFullKa, aod::pidTPCFullPr,
+                           aod::pidTOFFullEl, aod::pidTOFFullMu, aod::pidTOFFullPi, aod::pidTOFFullKa, aod::pidTOFFullPr, aod::pidTOFbeta>;
+
+struct emTrackSelection {
+  Produces<aod::EMTrackSels> emtracksels;
+
+  // track quality, common to the primary lepton skimmers
+  Configurable<int> min_ncluster_tpc{"min_ncluster_tpc", 10, "min ncluster tpc"};
+  Configurable<int> mincrossedrows{"mincrossedrows", 70, "min. crossed rows"};
+  Configurable<float> min_tpc_cr_findable_ratio{"min_tpc_cr_findable_ratio", 0.8, "min. TPC Ncr/Nf ratio"};
+  Configurable<float> max_mean_itsob_cluster_size{"max_mean_itsob_cluster_size", 16.f, "max. <ITSob cluster size> x cos(lambda)"};
+  Configurable<int> minitsncls{"minitsncls", 4, "min. number of ITS clusters"};
+  Configurable<float> maxchi2tpc{"maxchi2tpc", 5.0, "max. chi2/NclsTPC"};
+  Configurable<float> maxchi2its{"maxchi2its", 6.0, "max. chi2/NclsITS"};
+
+  // electron PID, as in skimmer-primary-electron
+  Configurable<float> minTPCNsigmaEl{"minTPCNsigmaEl", -3.0, "min. TPC n sigma for electron inclusion"};
+  Configurable<float> maxTPCNsigmaEl{"maxTPCNsigmaEl", 4.0, "max. TPC n sigma for electron inclusion"};
+  Configurable<float> maxTOFNsigmaEl{"maxTOFNsigmaEl", 4.0, "max. TOF n sigma for electron inclusion"};
+  Configurable<float> minTPCNsigmaPi{"minTPCNsigmaPi", 0.0, "min. TPC n sigma for pion exclusion"}; // set to -2 for lowB, -999 for nominalB
+  Configurable<float> maxTPCNsigmaPi{"maxTPCNsigmaPi", 0.0, "max. TPC n sigma for pion exclusion"};
+  Configurable<float> maxTPCNsigmaKa{"maxTPCNsigmaKa", 2.0, "max. TPC n sigma for kaon exclusion"};
+  Configurable<float> maxTPCNsigmaPr{"maxTPCNsigmaPr", 2.0, "max. TPC n sigma for proton exclusion"};
+  Configurable<bool> applyKaRej_TPC{"applyKaRej_TPC", false, "flag to apply Kaon rejection in TPC"};
+  Configurable<bool> applyPrRej_TPC{"applyPrRej_TPC", false, "flag to apply Proton rejection in TPC"};
+
+  // muon PID, as in skimmer-primary-muon
+  Configurable<float> maxPin_TPC{"maxPin_TPC", 0.2, "max pin for TPC pid only"};
+  Configurable<float> maxTPCNsigmaMu_lowPin{"maxTPCNsigmaMu_lowPin", +4.0, "max. TPC n sigma for muon inclusion at low pin"};
+  Configurable<float> maxTPCNsigmaMu_highPin{"maxTPCNsigmaMu_highPin", +4.0, "max. TPC n sigma for muon inclusion at high pin"};
+  Configurable<float> maxTOFNsigmaMu_highPin{"maxTOFNsigmaMu_highPin", +4.0, "max. TOF n sigma for muon inclusion at high pin"};
+  Configurable<float> maxTPCNsigmaEl_muon{"maxTPCNsigmaEl_muon", 1.0, "max. TPC n sigma for electron exclusion in the muon PID"};
+  Configurable<float> maxTPCNsigmaPi_lowPin{"maxTPCNsigmaPi_lowPin", -2.0, "max. TPC n sigma for pion exclusion"};
+  Configurable<float> maxTOFNsigmaPi{"maxTOFNsigmaPi", -2.0, "max. TOF n sigma for pion exclusion"};
+
+  std::pair<int8_t, std::set<uint8_t>> itsRequirement = {1, {0, 1, 2}}; // any hits on 3 ITS ib layers.
+
+  template <typename TTrack>
+  bool isGoodQuality(TTrack const& track)
+  {
+    if (!track.hasITS() || !track.hasTPC()) {
+      return false;
+    }
+    if (track.tpcChi2NCl() > maxchi2tpc || track.itsChi2NCl() > maxchi2its) {
+      return false;
+    }
+    if (track.itsNCls() < minitsncls) {
+      return false;
+    }
+
+    auto hits = std::count_if(itsRequirement.second.begin(), itsRequirement.second.end(), [&](auto&& requiredLayer) { return track.itsClusterMap() & (1 << requiredLayer); });
+    if (hits < itsRequirement.first) {
+      return false;
+    }
+
+    uint32_t itsClusterSizes = track.itsClusterSizes();
+    int total_cluster_size = 0, nl = 0;
+    for (unsigned int layer = 3; layer < 7; layer++) {
+      int cluster_size_per_layer = (itsClusterSizes >> (layer * 4)) & 0xf;
+      if (cluster_size_per_layer > 0) {
+        nl++;
+      }
+      total_cluster_size += cluster_size_per_layer;
+    }
+    if (static_cast<float>(total_cluster_size) / static_cast<float>(nl) * std::cos(std::atan(track.tgl())) > max_mean_itsob_cluster_size) {
+      return false;
+    }
+
+    return track.tpcNClsFound() >= min_ncluster_tpc && track.tpcNClsCrossedRows() >= mincrossedrows && track.tpcCrossedRowsOverFindableCls() >= min_tpc_cr_findable_ratio;
+  }
+
+  template <typename TTrack>
+  bool isElectron(TTrack const& track)
+  {
+    if ((0.0 < track.beta() && track.beta() < 0.95) || 1.05 < track.beta()) {
+      return false;
+    }
+    if (track.tpcNSigmaEl() < minTPCNsigmaEl || maxTPCNsigmaEl < track.tpcNSigmaEl()) {
+      return false;
+    }
+    const bool inPionBand = minTPCNsigmaPi < track.tpcNSigmaPi() && track.tpcNSigmaPi() < maxTPCNsigmaPi;
+    const bool tpcHadRej = !inPionBand && !(applyKaRej_TPC && abs(track.tpcNSigmaKa()) < maxTPCNsigmaKa) && !(applyPrRej_TPC && abs(track.tpcNSigmaPr()) < maxTPCNsigmaPr);
+    const bool tofEl = abs(track.tofNSigmaEl()) < maxTOFNsigmaEl;
+    const bool tofRecovery = !inPionBand && tofEl;
+    const bool tofRecoveryLowB = tofEl && track.tpcInnerParam() < 0.4; // TOF recovery only at low pin.
+    return tpcHadRej || tofRecovery || tofRecoveryLowB;
+  }
+
+  template <typename TTrack>
+  bool isMuon(TTrack const& track)
+  {
+    if (abs(track.tpcNSigmaEl()) < maxTPCNsigmaEl_muon) { // reject electron first.
+      return false;
+    }
+    if (track.hasTOF()) {
+      return abs(track.tpcNSigmaMu()) < maxTPCNsigmaMu_highPin && abs(track.tofNSigmaMu()) < maxTOFNsigmaMu_highPin && track.tofNSigmaPi() < maxTOFNsigmaPi;
+    } else if (track.tpcInnerParam() < maxPin_TPC) {
+      return abs(track.tpcNSigmaMu()) < maxTPCNsigmaMu_lowPin && track.tpcNSigmaPi() < maxTPCNsigmaPi_lowPin;
+    } else { // muon at high momentum cannot be identified without TOF.
+      return false;
+    }
+  }
+
+  void process(MyTracks const& tracks)
+  {
+    emtracksels.reserve(tracks.size());
+    for (auto& track : tracks) {
+      uint16_t selBits = 0;
+      if (isGoodQuality(track)) {
+        selBits |= 1 << aod::emtracksel::kPrimaryQuality;
+      }
+      if (isElectron(track)) {
+        selBits |= 1 << aod::emtracksel::kElectronPID;
+      }
+      if (isMuon(track)) {
+        selBits |= 1 << aod::emtracksel::kMuonPID;
+      }
+      emtracksels(selBits);
+    }
+  }
+};
+
+WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
+{
+  return WorkflowSpec{adaptAnalysisTask<emTrackSelection>(cfgc, TaskName{"em-track-selection"})};
+}
@@ -21,6 +21,7 @@
 #include <map>
 #include <iterator>
 #include <utility>
+#include <vector>
 
 #include "Math/Vector4D.h"
 
@@ -114,6 +115,13 @@ struct PhotonConversionBuilder {
   Configurable<float> max_dcatopv_z_v0{"max_dcatopv_z_v0", +1e+10, "max. DCAz to PV for V0"};
   Configurable<bool> reject_v0_on_itsib{"reject_v0_on_itsib", true, "flag to reject v0s on ITSib"};
 
+  // analytic preselection before the KF fit
+  Configurable<bool> useAnalyticPreselection{"useAnalyticPreselection", false, "flag to reject V0s from the track parameters at IU before the DCA propagation and the KF fit"};
+  Configurable<float> presel_margin_pt{"presel_margin_pt", 0.1, "relative margin of the pT cuts in the preselection"};
+  Configurable<float> presel_margin_eta{"presel_margin_eta", 0.1, "margin of the eta cut in the preselection"};
+  Configurable<float> presel_margin_r{"presel_margin_r", 5.0, "margin of the Rxy cuts in the preselection in cm"};
+  Configurable<float> presel_margin_qt{"presel_margin_qt", 0.02, "margin of the qT cut in the preselection in GeV/c"};
+
   int mRunNumber;
   float d_bz;
   float maxSnp;  // max sine phi for propagation
@@ -126,6 +134,7 @@ struct PhotonConversionBuilder {
     "registry",
     {
       {"hCollisionCounter", "hCollisionCounter", {HistType::kTH1F, {{1, 0.5f, 1.5f}}}},
+      {"hV0Preselection", "V0s in the analytic preselection", {HistType::kTH1F, {{6, 0.5f, 6.5f}}}},
       {"V0/hAP", "Armenteros Podolanski;#alpha;q_{T} (GeV/c)", {HistType::kTH2F, {{200, -1.0f, 1.0f}, {250, 0, 0.25}}}},
       {"V0/hConversionPointXY", "conversion point in XY;X (cm);Y (cm)", {HistType::kTH2F, {{400, -100.0f, 100.0f}, {400, -100.f, 100.f}}}},
       {"V0/hConversionPointRZ", "conversion point in RZ;Z (cm);R_{xy} (cm)", {HistType::kTH2F, {{200, -100.0f, 100.0f}, {200, 0.f, 100.f}}}},
@@ -181,6 +190,11 @@ struct PhotonConversionBuilder {
       matCorr = o2::base::Propagator::MatCorrType::USEMatCorrTGeo;
     if (useMatCorrType == 2)
       matCorr = o2::base::Propagator::MatCorrType::USEMatCorrLUT;
+
+    const char* preselectionLabels[] = {"all", "legs", "p_{T}", "#eta", "R_{xy}", "q_{T}"};
+    for (int i = 0; i < 6; i++) {
+      registry.get<TH1>(HIST("hV0Preselection"))->GetXaxis()->SetBinLabel(i + 1, preselectionLabels[i]);
+    }
   }
 
   void initCCDB(aod::BCsWithTimestamps::iterator const& bc)
@@ -298,6 +312,113 @@ struct PhotonConversionBuilder {
     return true;
   }
 
+  // quantities of the V0 legs used by the preselection, by track global index.
+  // They are computed once per track and data frame, as a track is a leg of many V0 candidates.
+  struct LegPreselection {
+    std::vector<int8_t> status; // -1: not computed yet, 0: rejected by checkV0leg, 1: accepted
+    std::vector<float> pt;
+    std::vector<float> tgl;
+    std::vector<float> xC; // centre and radius of the helix in XY
+    std::vector<float> yC;
+    std::vector<float> rC;
+    std::vector<float> orientation; // +1 (-1) if the momentum is along (against) the counter-clockwise tangent of the helix
+    std::vector<uint8_t> isITSonly;
+
+    void reset(size_t n)
+    {
+      status.assign(n, -1);
+      for (auto* v : {&pt, &tgl, &xC, &yC, &rC, &orientation}) {
+        v->resize(n);
+      }
+      isITSonly.resize(n);
+    }
+  } legPreselection;
+
+  template <bool isMC, typename TTrack>
+  bool fillLegPreselection(TTrack const& track)
+  {
+    const auto i = track.globalIndex();
+    if (legPreselection.status[i] >= 0) {
+      return legPreselection.status[i];
+    }
+    legPreselection.status[i] = checkV0leg<isMC>(track);
+    if (legPreselection.status[i]) {
+      auto trackPar = getTrackPar(track);
+      o2::track::TrackAuxPar helix(trackPar, d_bz);
+      std::array<float, 3> xyz, pxpypz;
+      trackPar.getXYZGlo(xyz);
+      trackPar.getPxPyPzGlo(pxpypz);
+      legPreselection.pt[i] = track.pt();
+      legPreselection.tgl[i] = track.tgl();
+      legPreselection.xC[i] = helix.xC;
+      legPreselection.yC[i] = helix.yC;
+      legPreselection.rC[i] = helix.rC;
+      legPreselection.orientation[i] = (-(xyz[1] - helix.yC) * pxpypz[0] + (xyz[0] - helix.xC) * pxpypz[1]) > 0.f ? +1.f : -1.f;
+      legPreselection.isITSonly[i] = isITSonlyTrack(track);
+    }
+    return legPreselection.status[i];
+  }
+
+  // preselection of a V0 with the cuts of fillV0Table, evaluated on the helices of the legs at IU: upper bound of the V0 pT,
+  // lower bound of its |eta|, conversion point from the helix centres and momenta of the legs at their closest point to it.
+  // The fit changes these quantities by a small amount, hence the cuts are loosened by the preselection margins.
+  template <bool isMC, typename TTrack>
+  bool isPreselectedV0(TTrack const& pos, TTrack const& ele)
+  {
+    registry.fill(HIST("hV0Preselection"), 1);
+    if (!fillLegPreselection<isMC>(pos) || !fillLegPreselection<isMC>(ele)) {
+      return false;
+    }
+    registry.fill(HIST("hV0Preselection"), 2);
+
+    const auto& legs = legPreselection;
+    const auto ip = pos.globalIndex();
+    const auto ie = ele.globalIndex();
+    const float minPtFactor = 1.f - presel_margin_pt;
+    if (legs.pt[ip] + legs.pt[ie] < minPtFactor * min_pt_v0 || std::min(legs.pt[ip], legs.pt[ie]) < minPtFactor * min_pt_leg) {
+      return false;
+    }
+    if ((legs.isITSonly[ip] && minPtFactor * legs.pt[ip] > maxpt_itsonly) || (legs.isITSonly[ie] && minPtFactor * legs.pt[ie] > maxpt_itsonly)) {
+      return false;
+    }
+    registry.fill(HIST("hV0Preselection"), 3);
+
+    if (std::abs(legs.pt[ip] * legs.tgl[ip] + legs.pt[ie] * legs.tgl[ie]) > std::sinh(max_eta_v0 + presel_margin_eta) * (legs.pt[ip] + legs.pt[ie])) {
+      return false;
+    }
+    registry.fill(HIST("hV0Preselection"), 4);
+
+    const float x = (legs.xC[ip] * legs.rC[ie] + legs.xC[ie] * legs.rC[ip]) / (legs.rC[ip] + legs.rC[ie]);
+    const float y = (legs.yC[ip] * legs.rC[ie] + legs.yC[ie] * legs.rC[ip]) / (legs.rC[ip] + legs.rC[ie]);
+    const float rxy = RecoDecay::sqrtSumOfSquares(x, y);
+    if (rxy > maxX + margin_r_tpc + presel_margin_r || rxy < min_v0radius - presel_margin_r) {
+      return false;
+    }
+    if ((!pos.hasITS() || !ele.hasITS()) && rxy < max_r_req_its - presel_margin_r) {
+      return false;
+    }
+    if ((!pos.hasITS() && !ele.hasITS()) && rxy < min_r_tpconly - presel_margin_r) {
+      return false;
+    }
+    registry.fill(HIST("hV0Preselection"), 5);
+
+    std::array<float, 3> p[2];
+    int ileg = 0;
+    for (const auto i : {ip, ie}) {
+      const float d = RecoDecay::sqrtSumOfSquares(x - legs.xC[i], y - legs.yC[i]);
+      if (d < 1e-6f) {
+        return true; // conversion point at the centre of the helix, the direction of the leg is not defined
+      }
+      const float scale = legs.orientation[i] * legs.pt[i] / d;
+      p[ileg++] = {-(y - legs.yC[i]) * scale, (x - legs.xC[i]) * scale, legs.pt[i] * legs.tgl[i]};
+    }
+    if (v0_qt(p[0][0], p[0][1], p[0][2], p[1][0], p[1][1], p[1][2]) > max_qt_ap + presel_margin_qt) {
+      return false;
+    }
+    registry.fill(HIST("hV0Preselection"), 6);
+    return true;
+  }
+
   float cospaXY_KF(KFParticle kfp, KFParticle PV)
   {
     float lx = kfp.GetX() - PV.GetX(); // flight length X
@@ -626,8 +747,11 @@ struct PhotonConversionBuilder {
   std::vector<std::pair<int64_t, int64_t>> stored_v0Ids;                     //(pos.globalIndex(), ele.globalIndex())
 
   template <bool isMC, typename TCollisions, typename TV0s, typename TTracks, typename TBCs>
-  void build(TCollisions const& collisions, TV0s const& v0s, TTracks const& /*tracks*/, TBCs const&)
+  void build(TCollisions const& collisions, TV0s const& v0s, TTracks const& tracks, TBCs const&)
   {
+    if (useAnalyticPreselection) {
+      legPreselection.reset(tracks.size());
+    }
     for (auto& collision : collisions) {
       if constexpr (isMC) {
         if (!collision.has_mcCollision()) {
@@ -643,6 +767,9 @@ struct PhotonConversionBuilder {
       // LOGF(info, "n v0 = %d", v0s_per_coll.size());
       for (auto& v0 : v0s_per_coll) {
         // LOGF(info, "collision.globalIndex() = %d, v0.globalIndex() = %d, v0.posTrackId() = %d, v0.negTrackId() = %d", collision.globalIndex(), v0.globalIndex(), v0.posTrackId() , v0.negTrackId());
+        if (useAnalyticPreselection && !isPreselectedV0<isMC>(v0.template posTrack_as<TTracks>(), v0.template negTrack_as<TTracks>())) {
+          continue;
+        }
         fillV0Table<isMC, TCollisions, TTracks>(v0, false);
       } // end of v0 loop
     }   // end of collision loop
@@ -172,15 +172,9 @@ struct skimmerPrimaryElectron {
     mRunNumber = bc.runNumber();
   }
 
-  template <bool isMC, typename TCollision, typename TTrack>
-  bool checkTrack(TCollision const& collision, TTrack const& track)
+  template <typename TTrack>
+  bool isGoodQuality(TTrack const& track)
   {
-    if constexpr (isMC) {
-      if (!track.has_mcParticle()) {
-        return false;
-      }
-    }
-
     if (track.tpcChi2NCl() > maxchi2tpc) {
       return false;
     }
@@ -230,6 +224,26 @@ struct skimmerPrimaryElectron {
       return false;
     }
 
+    return true;
+  }
+
+  template <bool isMC, typename TCollision, typename TTrack>
+  bool checkTrack(TCollision const& collision, TTrack const& track)
+  {
+    if constexpr (isMC) {
+      if (!track.has_mcParticle()) {
+        return false;
+      }
+    }
+
+    if constexpr (requires { track.selBits(); }) { // quality computed by em-track-selection
+      if (!(track.selBits() & (uint16_t(1) << aod::emtracksel::kPrimaryQuality))) {
+        return false;
+      }
+    } else if (!isGoodQuality(track)) {
+      return false;
+    }
+
     gpu::gpustd::array<float, 2> dcaInfo;
     auto track_par_cov_recalc = getTrackParCov(track);
     std::array<float, 3> pVec_recalc = {0, 0, 0}; // px, py, pz
@@ -260,6 +274,9 @@ struct skimmerPrimaryElectron {
   template <typename TTrack>
   bool isElectron(TTrack const& track)
   {
+    if constexpr (requires { track.selBits(); }) { // PID and TOF beta computed by em-track-selection
+      return track.selBits() & (uint16_t(1) << aod::emtracksel::kElectronPID);
+    }
     return isElectron_TPChadrej(track) || isElectron_TOFrecovery(track) || isElectron_TOFrecovery_lowB(track);
   }
 
@@ -439,9 +456,14 @@ struct skimmerPrimaryElectron {
   Partition<MyFilteredTracks> posTracks = o2::aod::track::signed1Pt > 0.f;
   Partition<MyFilteredTracks> negTracks = o2::aod::track::signed1Pt < 0.f;
 
+  using MyFilteredTracksWithSel = soa::Filtered<soa::Join<MyTracks, aod::EMTrackSels>>;
+  Partition<MyFilteredTracksWithSel> posTracksWithSel = o2::aod::track::signed1Pt > 0.f;
+  Partition<MyFilteredTracksWithSel> negTracksWithSel = o2::aod::track::signed1Pt < 0.f;
+
   // ---------- for data ----------
 
-  void processRec_SA(aod::Collisions const& collisions, aod::BCsWithTimestamps const&, MyFilteredTracks const& tracks)
+  template <typename TTracks, typename TPartition>
+  void runRec_SA(aod::Collisions const& collisions, TTracks const& tracks, TPartition& posPart, TPartition& negPart)
   {
     stored_trackIds.reserve(tracks.size());
 
@@ -450,8 +472,8 @@ struct skimmerPrimaryElectron {
       initCCDB(bc);
       events_bz(d_bz);
 
-      auto posTracks_per_coll = posTracks->sliceByCached(o2::aod::track::collisionId, collision.globalIndex(), cache);
-      auto negTracks_per_coll = negTracks->sliceByCached(o2::aod::track::collisionId, collision.globalIndex(), cache);
+      auto posTracks_per_coll = posPart->sliceByCached(o2::aod::track::collisionId, collision.globalIndex(), cache);
+      auto negTracks_per_coll = negPart->sliceByCached(o2::aod::track::collisionId, collision.globalIndex(), cache);
       fillTrackHistogram<false>(collision, posTracks_per_coll);
       fillTrackHistogram<false>(collision, negTracks_per_coll);
 
@@ -465,8 +487,19 @@ struct skimmerPrimaryElectron {
     stored_trackIds.clear();
     stored_trackIds.shrink_to_fit();
   }
+
+  void processRec_SA(aod::Collisions const& collisions, aod::BCsWithTimestamps const&, MyFilteredTracks const& tracks)
+  {
+    runRec_SA(collisions, tracks, posTracks, negTracks);
+  }
   PROCESS_SWITCH(skimmerPrimaryElectron, processRec_SA, "process reconstructed info only", true); // standalone
 
+  void processRec_SA_EMTrackSel(aod::Collisions const& collisions, aod::BCsWithTimestamps const&, MyFilteredTracksWithSel const& tracks)
+  {
+    runRec_SA(collisions, tracks, posTracksWithSel, negTracksWithSel);
+  }
+  PROCESS_SWITCH(skimmerPrimaryElectron, processRec_SA_EMTrackSel, "process reconstructed info only, with the track selections of em-track-selection", false); // standalone
+
   Preslice<aod::TrackAssoc> trackIndicesPerCollision = aod::track_association::collisionId;
   void processRec_TTCA(aod::Collisions const& collisions, aod::BCsWithTimestamps const&, MyFilteredTracks const& tracks, aod::TrackAssoc const& trackIndices)
   {
@@ -144,15 +144,9 @@ struct skimmerPrimaryMuon {
 
   void init(InitContext const&) {}
 
-  template <bool isMC, typename TTrack>
-  bool checkTrack(TTrack const& track)
+  template <typename TTrack>
+  bool isGoodQuality(TTrack const& track)
   {
-    if constexpr (isMC) {
-      if (!track.has_mcParticle()) {
-        return false;
-      }
-    }
-
     if (!track.hasITS() || !track.hasTPC()) {
       return false;
     }
@@ -191,6 +185,26 @@ struct skimmerPrimaryMuon {
       return false;
     }
 
+    return true;
+  }
+
+  template <bool isMC, typename TTrack>
+  bool checkTrack(TTrack const& track)
+  {
+    if constexpr (isMC) {
+      if (!track.has_mcParticle()) {
+        return false;
+      }
+    }
+
+    if constexpr (requires { track.selBits(); }) { // quality computed by em-track-selection
+      if (!(track.selBits() & (uint16_t(1) << aod::emtracksel::kPrimaryQuality))) {
+        return false;
+      }
+    } else if (!isGoodQuality(track)) {
+      return false;
+    }
+
     // float rel_diff = (track.tpcInnerParam() - track.p())/track.p();
     // if (rel_diff < -0.0156432+-0.00154524/pow(track.p(),2.29244) - 0.02 || -0.0156432+-0.00154524/pow(track.p(),2.29244) + 0.02 < rel_diff) {
     //   return false;
@@ -214,6 +228,9 @@ struct skimmerPrimaryMuon {
   template <typename TTrack>
   bool isMuon(TTrack const& track)
   {
+    if constexpr (requires { track.selBits(); }) { // PID computed by em-track-selection
+      return track.selBits() & (uint16_t(1) << aod::emtracksel::kMuonPID);
+    }
     if (isInElectronBand(track)) { // reject electron first.
       return false;
     }
@@ -397,12 +414,17 @@ struct skimmerPrimaryMuon {
   using MyFilteredTracks = soa::Filtered<MyTracks>;
   Partition<MyFilteredTracks> posTracks = o2::aod::track::signed1Pt > 0.f;
   Partition<MyFilteredTracks> negTracks = o2::aod::track::signed1Pt < 0.f;
-  void processRec(aod::Collisions const& collisions, aod::BCsWithTimestamps const&, MyFilteredTracks const& tracks)
+  using MyFilteredTracksWithSel = soa::Filtered<soa::Join<MyTracks, aod::EMTrackSels>>;
+  Partition<MyFilteredTracksWithSel> posTracksWithSel = o2::aod::track::signed1Pt > 0.f;
+  Partition<MyFilteredTracksWithSel> negTracksWithSel = o2::aod::track::signed1Pt < 0.f;
+
+  template <typename TTracks, typename TPartition>
+  void runRec(aod::Collisions const& collisions, TTracks const& tracks, TPartition& posPart, TPartition& negPart)
   {
     stored_trackIds.reserve(tracks.size());
     for (auto& collision : collisions) {
-      auto posTracks_per_coll = posTracks->sliceByCached(o2::aod::track::collisionId, collision.globalIndex(), cache);
-      auto negTracks_per_coll = negTracks->sliceByCached(o2::aod::track::collisionId, collision.globalIndex(), cache);
+      auto posTracks_per_coll = posPart->sliceByCached(o2::aod::track::collisionId, collision.globalIndex(), cache);
+      auto negTracks_per_coll = negPart->sliceByCached(o2::aod::track::collisionId, collision.globalIndex(), cache);
       fillTrackHistogram<false>(posTracks_per_coll);
       fillTrackHistogram<false>(negTracks_per_coll);
 
@@ -416,8 +438,19 @@ struct skimmerPrimaryMuon {
     stored_trackIds.clear();
     stored_trackIds.shrink_to_fit();
   }
+
+  void processRec(aod::Collisions const& collisions, aod::BCsWithTimestamps const&, MyFilteredTracks const& tracks)
+  {
+    runRec(collisions, tracks, posTracks, negTracks);
+  }
   PROCESS_SWITCH(skimmerPrimaryMuon, processRec, "process reconstructed info only", true);
 
+  void processRec_EMTrackSel(aod::Collisions const& collisions, aod::BCsWithTimestamps const&, MyFilteredTracksWithSel const& tracks)
+  {
+    runRec(collisions, tracks, posTracksWithSel, negTracksWithSel);
+  }
+  PROCESS_SWITCH(skimmerPrimaryMuon, processRec_EMTrackSel, "process reconstructed info only, with the track selections of em-track-selection", false);
+
   using MyFilteredTracksMC = soa::Filtered<MyTracksMC>;
   Partition<MyFilteredTracksMC> posTracksMC = o2::aod::track::signed1Pt > 0.f;
   Partition<MyFilteredTracksMC> negTracksMC = o2::aod::track::signed1Pt < 0.f;
@@ -14,8 +14,13 @@
 // This code loops over v0 photons and makes pairs for photon HBT analysis.
 //    Please write to: daiki.sekihata@cern.ch
 
+#include <array>
+#include <cmath>
 #include <cstring>
 #include <iterator>
+#include <tuple>
+#include <type_traits>
+#include <vector>
 
 #include "TString.h"
 #include "Math/Vector4D.h"
@@ -27,6 +32,7 @@
 #include "Framework/AnalysisDataModel.h"
 #include "Framework/ASoAHelpers.h"
 #include "PWGEM/PhotonMeson/Utils/PairUtilities.h"
+#include "PWGEM/PhotonMeson/Utils/PhotonCutBitmasks.h"
 #include "PWGEM/PhotonMeson/DataModel/gammaTables.h"
 #include "PWGEM/PhotonMeson/Core/V0PhotonCut.h"
 #include "PWGEM/PhotonMeson/Core/DalitzEECut.h"
@@ -64,8 +70,10 @@ struct PhotonHBT {
   Configurable<std::string> fConfigDalitzEECuts{"cfgDalitzEECuts", "mee_all_tpchadrejortofreq_prompt", "Comma separated list of DalitzEE cuts"};
   Configurable<std::string> fConfigPHOSCuts{"cfgPHOSCuts", "test02,test03", "Comma separated list of PHOS photon cuts"};
   Configurable<std::string> fConfigPairCuts{"cfgPairCuts", "nocut", "Comma separated list of pair cuts"};
+  Configurable<bool> cfgUseCutBitmasks{"cfgUseCutBitmasks", false, "Flag to evaluate the photon cuts once per photon, the pairs are then selected from the bitmasks of the passed cuts"};
   Configurable<bool> fConfigDo3D{"cfgDo3D", false, "Flag to analyze 3D BE correlation"}; // it is very heavy.
   Configurable<float> maxY_dielectron{"maxY_dielectron", 0.9, "maximum rapidity for dielectron"};
+  Configurable<float> cfgMaxQinv{"cfgMaxQinv", 0.4, "max. q_inv of the pairs, the pairs above are rejected before the cuts and the histograms (upper edge of the q_inv axis), negative to keep all"};
 
   Configurable<std::string> fConfigEMEventCut{"cfgEMEventCut", "minbias", "em event cut"}; // only 1 event cut per wagon
   EMEventCut fEMEventCut;
@@ -241,6 +249,33 @@ struct PhotonHBT {
     LOGF(info, "Number of Pair cuts = %d", fPairCuts.size());
   }
 
+  o2::aod::pwgem::photonmeson::utils::PhotonCutBitmasks fCutBitmasks1; // cuts1 passed by photons1
+  o2::aod::pwgem::photonmeson::utils::PhotonCutBitmasks fCutBitmasks2; // cuts2 passed by photons2, unused for pairs of the same kind
+
+  /// bitmasks of the cuts passed by the photons of a table, with the same selection as IsSelectedPair
+  template <typename TPhotons, typename TCuts>
+  void FillCutBitmasks(o2::aod::pwgem::photonmeson::utils::PhotonCutBitmasks& bitmasks, TPhotons const& photons, TCuts const& cuts)
+  {
+    bitmasks.Fill(photons, cuts, [](auto const& cut, auto const& g) {
+      using TCut = std::decay_t<decltype(cut)>;
+      if constexpr (std::is_same_v<TCut, V0PhotonCut>) {
+        return cut.template IsSelected<aod::V0Legs>(g);
+      } else if constexpr (std::is_same_v<TCut, DalitzEECut>) {
+        std::tuple<MyPrimaryElectron, MyPrimaryElectron, float> pair = std::make_tuple(g.template posTrack_as<MyPrimaryElectrons>(), g.template negTrack_as<MyPrimaryElectrons>(), g.template emevent_as<MyCollisions>().bz());
+        return cut.template IsSelected<MyPrimaryElectrons>(pair);
+      } else {
+        return cut.template IsSelected<int>(g); // PHOS, track matching is not ready
+      }
+    });
+  }
+
+  template <PairType pairtype>
+  bool IsSelectedPairFromBitmasks(int64_t id1, int64_t id2, int icut1, int icut2)
+  {
+    constexpr bool sameKinds = pairtype == PairType::kPCMPCM || pairtype == PairType::kPHOSPHOS || pairtype == PairType::kEMCEMC || pairtype == PairType::kDalitzEEDalitzEE;
+    return fCutBitmasks1.IsSelected(id1, icut1) && (sameKinds ? fCutBitmasks1 : fCutBitmasks2).IsSelected(id2, icut2);
+  }
+
   template <PairType pairtype, typename TG1, typename TG2, typename TCut1, typename TCut2>
   bool IsSelectedPair(TG1 const& g1, TG2 const& g2, TCut1 const& cut1, TCut2 const& cut2)
   {
@@ -261,12 +296,56 @@ struct PhotonHBT {
     return is_selected_pair;
   }
 
+  // 4-momenta (px, py, pz, E) of the photons of the dataframe indexed by globalIndex, computed once and reused by all the same and mixed event pairs
+  std::vector<std::array<float, 4>> fMomenta1;
+  std::vector<std::array<float, 4>> fMomenta2;
+
+  template <bool withMass, typename TPhotons>
+  void FillMomenta(TPhotons const& photons, std::vector<std::array<float, 4>>& momenta)
+  {
+    momenta.clear();
+    for (auto& g : photons) {
+      if (static_cast<size_t>(g.globalIndex()) >= momenta.size()) { // filtered tables
+        momenta.resize(g.globalIndex() + 1);
+      }
+      const float px = g.pt() * std::cos(g.phi());
+      const float py = g.pt() * std::sin(g.phi());
+      const float pz = g.pt() * std::sinh(g.eta());
+      float m = 0.f;
+      if constexpr (withMass) {
+        m = g.mass();
+      }
+      momenta[g.globalIndex()] = {px, py, pz, std::sqrt(g.pt() * g.pt() + pz * pz + m * m)};
+    }
+  }
+
+  template <PairType pairtype, typename TPhotons1, typename TPhotons2>
+  void FillMomenta(TPhotons1 const& photons1, TPhotons2 const& photons2)
+  {
+    FillMomenta<pairtype == PairType::kDalitzEEDalitzEE>(photons1, fMomenta1);
+    FillMomenta<pairtype == PairType::kPCMDalitzEE || pairtype == PairType::kDalitzEEDalitzEE>(photons2, fMomenta2);
+  }
+
+  /// q_inv from the cached 4-momenta, to reject the pairs above cfgMaxQinv before the photon and pair cuts
+  bool IsInQinvRange(int64_t globalIndex1, int64_t globalIndex2)
+  {
+    if (cfgMaxQinv < 0.f) {
+      return true;
+    }
+    const auto& p1 = fMomenta1[globalIndex1];
+    const auto& p2 = fMomenta2[globalIndex2];
+    const float dpx = p1[0] - p2[0], dpy = p1[1] - p2[1], dpz = p1[2] - p2[2], dE = p1[3] - p2[3];
+    const float q2 = dpx * dpx + dpy * dpy + dpz * dpz - dE * dE; // q_inv^2 = -(p1 - p2)^2
+    return q2 < cfgMaxQinv * cfgMaxQinv;
+  }
+
   template <PairType pairtype, typename TEvents, typename TPhotons1, typename TPhotons2, typename TPreslice1, typename TPreslice2, typename TCuts1, typename TCuts2, typename TPairCuts, typename TLegs, typename TEMPrimaryElectrons>
   void SameEventPairing(TEvents const& collisions, TPhotons1 const& photons1, TPhotons2 const& photons2, TPreslice1 const& perCollision1, TPreslice2 const& perCollision2, TCuts1 const& cuts1, TCuts2 const& cuts2, TPairCuts const& paircuts, TLegs const& /*legs*/, TEMPrimaryElectrons const& /*emprimaryelectrons*/)
   {
     THashList* list_ev_pair_before = static_cast<THashList*>(fMainList->FindObject("Event")->FindObject(pairnames[pairtype].data())->FindObject(event_types[0].data()));
     THashList* list_ev_pair_after = static_cast<THashList*>(fMainList->FindObject("Event")->FindObject(pairnames[pairtype].data())->FindObject(event_types[1].data()));
     THashList* list_pair_ss = static_cast<THashList*>(fMainList->FindObject("Pair")->FindObject(pairnames[pairtype].data()));
+    FillMomenta<pairtype>(photons1, photons2);
 
     for (auto& collision : collisions) {
       if ((pairtype == kPHOSPHOS || pairtype == kPCMPHOS) && !collision.alias_bit(triggerAliases::kTVXinPHOS)) {
@@ -296,11 +375,19 @@ struct PhotonHBT {
       double values_1d[6] = {0.f};
       double values_3d[10] = {0.f};
       if constexpr (pairtype == PairType::kPCMPCM || pairtype == PairType::kPHOSPHOS || pairtype == PairType::kEMCEMC || pairtype == PairType::kDalitzEEDalitzEE) {
-        for (auto& cut : cuts1) {
+        for (size_t icut = 0; icut < cuts1.size(); icut++) {
+          auto& cut = cuts1[icut];
           for (auto& paircut : paircuts) {
             for (auto& [g1, g2] : combinations(CombinationsStrictlyUpperIndexPolicy(photons1_coll, photons2_coll))) {
+              if (!IsInQinvRange(g1.globalIndex(), g2.globalIndex())) {
+                continue;
+              }
 
-              if constexpr (pairtype == PairType::kDalitzEEDalitzEE) {
+              if (cfgUseCutBitmasks) {
+                if (!IsSelectedPairFromBitmasks<pairtype>(g1.globalIndex(), g2.globalIndex(), icut, icut)) {
+                  continue;
+                }
+              } else if constexpr (pairtype == PairType::kDalitzEEDalitzEE) {
                 auto pos1 = g1.template posTrack_as<TEMPrimaryElectrons>();
                 auto ele1 = g1.template negTrack_as<TEMPrimaryElectrons>();
                 auto pos2 = g2.template posTrack_as<TEMPrimaryElectrons>();
@@ -402,12 +489,21 @@ struct PhotonHBT {
           }    // end of pair cut loop
         }      // end of cut loop
       } else { // different subsystem pairs
-        for (auto& cut1 : cuts1) {
-          for (auto& cut2 : cuts2) {
+        for (size_t icut1 = 0; icut1 < cuts1.size(); icut1++) {
+          auto& cut1 = cuts1[icut1];
+          for (size_t icut2 = 0; icut2 < cuts2.size(); icut2++) {
+            auto& cut2 = cuts2[icut2];
             for (auto& paircut : paircuts) {
               for (auto& [g1, g2] : combinations(CombinationsFullIndexPolicy(photons1_coll, photons2_coll))) {
+                if (!IsInQinvRange(g1.globalIndex(), g2.globalIndex())) {
+                  continue;
+                }
 
-                if constexpr (pairtype == PairType::kPCMDalitzEE) {
+                if (cfgUseCutBitmasks) {
+                  if (!IsSelectedPairFromBitmasks<pairtype>(g1.globalIndex(), g2.globalIndex(), icut1, icut2)) {
+                    continue;
+                  }
+                } else if constexpr (pairtype == PairType::kPCMDalitzEE) {
                   auto pos_pv = g2.template posTrack_as<TEMPrimaryElectrons>();
                   auto ele_pv = g2.template negTrack_as<TEMPrimaryElectrons>();
                   std::tuple<MyPrimaryElectron, MyPrimaryElectron, float> pair2 = std::make_tuple(pos_pv, ele_pv, collision.bz());
@@ -508,6 +604,7 @@ struct PhotonHBT {
   void MixedEventPairing(TEvents const& collisions, TPhotons1 const& photons1, TPhotons2 const& photons2, TPreslice1 const& perCollision1, TPreslice2 const& perCollision2, TCuts1 const& cuts1, TCuts2 const& cuts2, TPairCuts const& paircuts, TLegs const& /*legs*/, TEMPrimaryElectrons const& /*emprimaryelectrons*/, TMixedBinning const& colBinning)
   {
     THashList* list_pair_ss = static_cast<THashList*>(fMainList->FindObject("Pair")->FindObject(pairnames[pairtype].data()));
+    FillMomenta<pairtype>(photons1, photons2);
     // LOGF(info, "Number of collisions after filtering: %d", collisions.size());
     for (auto& [collision1, collision2] : soa::selfCombinations(colBinning, ndepth, -1, collisions, collisions)) { // internally, CombinationsStrictlyUpperIndexPolicy(collisions, collisions) is called.
       // LOGF(info, "Mixed event globalIndex: (%d, %d) , counter = %d, ngpcm: (%d, %d), ngphos: (%d, %d), ngemc: (%d, %d)", collision1.globalIndex(), collision2.globalIndex(), nev, collision1.ngpcm(), collision2.ngpcm(), collision1.ngphos(), collision2.ngphos(), collision1.ngemc(), collision2.ngemc());
@@ -533,17 +630,26 @@ struct PhotonHBT {
       float dca_pos2_3d = 999.f, dca_ele2_3d = 999.f, dca_ee2_3d = 999.f;
       double values_1d[6] = {0.f};
       double values_3d[10] = {0.f};
-      for (auto& cut1 : cuts1) {
-        for (auto& cut2 : cuts2) {
+      for (size_t icut1 = 0; icut1 < cuts1.size(); icut1++) {
+        auto& cut1 = cuts1[icut1];
+        for (size_t icut2 = 0; icut2 < cuts2.size(); icut2++) {
+          auto& cut2 = cuts2[icut2];
           for (auto& paircut : paircuts) {
             for (auto& [g1, g2] : combinations(soa::CombinationsFullIndexPolicy(photons_coll1, photons_coll2))) {
+              if (!IsInQinvRange(g1.globalIndex(), g2.globalIndex())) {
+                continue;
+              }
               // LOGF(info, "Mixed event photon pair: (%d, %d) from events (%d, %d), photon event: (%d, %d)", g1.index(), g2.index(), collision1.index(), collision2.index(), g1.globalIndex(), g2.globalIndex());
 
               if ((pairtype == PairType::kPCMPCM || pairtype == PairType::kPHOSPHOS || pairtype == PairType::kEMCEMC || pairtype == PairType::kDalitzEEDalitzEE) && (TString(cut1.GetName()) != TString(cut2.GetName()))) {
                 continue;
               }
 
-              if constexpr (pairtype == PairType::kPCMDalitzEE) {
+              if (cfgUseCutBitmasks) {
+                if (!IsSelectedPairFromBitmasks<pairtype>(g1.globalIndex(), g2.globalIndex(), icut1, icut2)) {
+                  continue;
+                }
+              } else if constexpr (pairtype == PairType::kPCMDalitzEE) {
                 auto pos2 = g2.template posTrack_as<TEMPrimaryElectrons>();
                 auto ele2 = g2.template negTrack_as<TEMPrimaryElectrons>();
                 std::tuple<MyPrimaryElectron, MyPrimaryElectron, float> pair2 = std::make_tuple(pos2, ele2, collision1.bz());
@@ -671,6 +777,9 @@ struct PhotonHBT {
 
   void processPCMPCM(MyCollisions const&, MyFilteredCollisions const& filtered_collisions, MyV0Photons const& v0photons, aod::V0Legs const& legs)
   {
+    if (cfgUseCutBitmasks) {
+      FillCutBitmasks(fCutBitmasks1, v0photons, fPCMCuts);
+    }
     SameEventPairing<PairType::kPCMPCM>(grouped_collisions, v0photons, v0photons, perCollision_pcm, perCollision_pcm, fPCMCuts, fPCMCuts, fPairCuts, legs, nullptr);
     if (cfgCentEstimator == 0) {
       MixedEventPairing<PairType::kPCMPCM>(filtered_collisions, v0photons, v0photons, perCollision_pcm, perCollision_pcm, fPCMCuts, fPCMCuts, fPairCuts, legs, nullptr, colBinning_M);
@@ -683,6 +792,10 @@ struct PhotonHBT {
 
   void processPCMDalitzEE(MyCollisions const&, MyFilteredCollisions const& filtered_collisions, MyV0Photons const& v0photons, aod::V0Legs const& legs, filteredMyDalitzEEs const& dielectrons, MyPrimaryElectrons const& emprimaryelectrons)
   {
+    if (cfgUseCutBitmasks) {
+      FillCutBitmasks(fCutBitmasks1, v0photons, fPCMCuts);
+      FillCutBitmasks(fCutBitmasks2, dielectrons, fDalitzEECuts);
+    }
     SameEventPairing<PairType::kPCMDalitzEE>(grouped_collisions, v0photons, dielectrons, perCollision_pcm, perCollision_dalitzee, fPCMCuts, fDalitzEECuts, fPairCuts, legs, emprimaryelectrons);
     if (cfgCentEstimator == 0) {
       MixedEventPairing<PairType::kPCMDalitzEE>(filtered_collisions, v0photons, dielectrons, perCollision_pcm, perCollision_dalitzee, fPCMCuts, fDalitzEECuts, fPairCuts, legs, emprimaryelectrons, colBinning_M);
@@ -695,6 +808,9 @@ struct PhotonHBT {
 
   void processDalitzEEDalitzEE(MyCollisions const&, MyFilteredCollisions const& filtered_collisions, filteredMyDalitzEEs const& dielectrons, MyPrimaryElectrons const& emprimaryelectrons)
   {
+    if (cfgUseCutBitmasks) {
+      FillCutBitmasks(fCutBitmasks1, dielectrons, fDalitzEECuts);
+    }
     SameEventPairing<PairType::kDalitzEEDalitzEE>(grouped_collisions, dielectrons, dielectrons, perCollision_dalitzee, perCollision_dalitzee, fDalitzEECuts, fDalitzEECuts, fPairCuts, nullptr, emprimaryelectrons);
     if (cfgCentEstimator == 0) {
       MixedEventPairing<PairType::kDalitzEEDalitzEE>(filtered_collisions, dielectrons, dielectrons, perCollision_dalitzee, perCollision_dalitzee, fDalitzEECuts, fDalitzEECuts, fPairCuts, nullptr, emprimaryelectrons, colBinning_M);
@@ -707,12 +823,19 @@ struct PhotonHBT {
 
   void processPHOSPHOS(MyCollisions const&, MyFilteredCollisions const& filtered_collisions, aod::PHOSClusters const& phosclusters)
   {
+    if (cfgUseCutBitmasks) {
+      FillCutBitmasks(fCutBitmasks1, phosclusters, fPHOSCuts);
+    }
     SameEventPairing<PairType::kPHOSPHOS>(grouped_collisions, phosclusters, phosclusters, perCollision_phos, perCollision_phos, fPHOSCuts, fPHOSCuts, fPairCuts, nullptr, nullptr);
     MixedEventPairing<PairType::kPHOSPHOS>(filtered_collisions, phosclusters, phosclusters, perCollision_phos, perCollision_phos, fPHOSCuts, fPHOSCuts, fPairCuts, nullptr, nullptr, colBinning_C);
   }
 
   void processPCMPHOS(MyCollisions const&, MyFilteredCollisions const& filtered_collisions, MyV0Photons const& v0photons, aod::PHOSClusters const& phosclusters, aod::V0Legs const& legs)
   {
+    if (cfgUseCutBitmasks) {
+      FillCutBitmasks(fCutBitmasks1, v0photons, fPCMCuts);
+      FillCutBitmasks(fCutBitmasks2, phosclusters, fPHOSCuts);
+    }
     SameEventPairing<PairType::kPCMPHOS>(grouped_collisions, v0photons, phosclusters, perCollision_pcm, perCollision_phos, fPCMCuts, fPHOSCuts, fPairCuts, legs, nullptr);
     MixedEventPairing<PairType::kPCMPHOS>(filtered_collisions, v0photons, phosclusters, perCollision_pcm, perCollision_phos, fPCMCuts, fPHOSCuts, fPairCuts, legs, nullptr, colBinning_C);
   }
@@ -16,6 +16,8 @@
 
 #include <cstring>
 #include <iterator>
+#include <tuple>
+#include <type_traits>
 
 #include "TString.h"
 #include "Math/Vector4D.h"
@@ -25,6 +27,7 @@
 #include "Framework/ASoAHelpers.h"
 #include "Common/Core/RecoDecay.h"
 #include "PWGEM/PhotonMeson/Utils/PairUtilities.h"
+#include "PWGEM/PhotonMeson/Utils/PhotonCutBitmasks.h"
 #include "PWGEM/PhotonMeson/DataModel/gammaTables.h"
 #include "PWGEM/PhotonMeson/Core/V0PhotonCut.h"
 #include "PWGEM/PhotonMeson/Core/DalitzEECut.h"
@@ -66,6 +69,7 @@ struct TaggingPi0 {
   Configurable<std::string> fConfigPHOSCuts{"cfgPHOSCuts", "test02,test03", "Comma separated list of PHOS photon cuts"};
   Configurable<std::string> fConfigEMCCuts{"cfgEMCCuts", "standard", "Comma separated list of EMCal photon cuts"};
   Configurable<std::string> fConfigPairCuts{"cfgPairCuts", "nocut", "Comma separated list of pair cuts"};
+  Configurable<bool> cfgUseCutBitmasks{"cfgUseCutBitmasks", false, "Flag to evaluate the photon cuts once per photon, the pairs are then selected from the bitmasks of the passed cuts"};
 
   // Configurable for EMCal cuts
   Configurable<float> EMC_minTime{"EMC_minTime", -20., "Minimum cluster time for EMCal time cut"};
@@ -280,6 +284,35 @@ struct TaggingPi0 {
     LOGF(info, "Number of Pair cuts = %d", fPairCuts.size());
   }
 
+  o2::aod::pwgem::photonmeson::utils::PhotonCutBitmasks fCutBitmasks1; // cuts1 passed by photons1
+  o2::aod::pwgem::photonmeson::utils::PhotonCutBitmasks fCutBitmasks2; // cuts2 passed by photons2, unused for pairs of the same kind
+
+  /// bitmasks of the cuts passed by the photons of a table, with the same selection as IsSelectedPair
+  template <typename TPhotons, typename TCuts>
+  void FillCutBitmasks(o2::aod::pwgem::photonmeson::utils::PhotonCutBitmasks& bitmasks, TPhotons const& photons, TCuts const& cuts)
+  {
+    bitmasks.Fill(photons, cuts, [](auto const& cut, auto const& g) {
+      using TCut = std::decay_t<decltype(cut)>;
+      if constexpr (std::is_same_v<TCut, V0PhotonCut>) {
+        return cut.template IsSelected<aod::V0Legs>(g);
+      } else if constexpr (std::is_same_v<TCut, DalitzEECut>) {
+        std::tuple<MyPrimaryElectron, MyPrimaryElectron, float> pair = std::make_tuple(g.template posTrack_as<MyPrimaryElectrons>(), g.template negTrack_as<MyPrimaryElectrons>(), g.template emevent_as<MyCollisions>().bz());
+        return cut.template IsSelected<MyPrimaryElectrons>(pair);
+      } else if constexpr (std::is_same_v<TCut, EMCPhotonCut>) {
+        return cut.template IsSelected<aod::SkimEMCMTs>(g);
+      } else {
+        return cut.template IsSelected<int>(g);
+      }
+    });
+  }
+
+  template <PairType pairtype>
+  bool IsSelectedPairFromBitmasks(int64_t id1, int64_t id2, int icut1, int icut2)
+  {
+    constexpr bool sameKinds = false;
+    return fCutBitmasks1.IsSelected(id1, icut1) && (sameKinds ? fCutBitmasks1 : fCutBitmasks2).IsSelected(id2, icut2);
+  }
+
   template <PairType pairtype, typename TG1, typename TG2, typename TCut1, typename TCut2>
   bool IsSelectedPair(TG1 const& g1, TG2 const& g2, TCut1 const& cut1, TCut2 const& cut2)
   {
@@ -328,12 +361,18 @@ struct TaggingPi0 {
       auto photons1_coll = photons1.sliceBy(perCollision1, collision.globalIndex());
       auto photons2_coll = photons2.sliceBy(perCollision2, collision.globalIndex());
 
-      for (auto& cut1 : cuts1) {
-        for (auto& cut2 : cuts2) {
+      for (size_t icut1 = 0; icut1 < cuts1.size(); icut1++) {
+        auto& cut1 = cuts1[icut1];
+        for (size_t icut2 = 0; icut2 < cuts2.size(); icut2++) {
+          auto& cut2 = cuts2[icut2];
           for (auto& paircut : paircuts) {
             for (auto& [g1, g2] : combinations(CombinationsFullIndexPolicy(photons1_coll, photons2_coll))) {
 
-              if constexpr (pairtype == PairType::kPCMDalitzEE) {
+              if (cfgUseCutBitmasks) {
+                if (!IsSelectedPairFromBitmasks<pairtype>(g1.globalIndex(), g2.globalIndex(), icut1, icut2)) {
+                  continue;
+                }
+              } else if constexpr (pairtype == PairType::kPCMDalitzEE) {
                 auto pos_pv = g2.template posTrack_as<MyPrimaryElectrons>();
                 auto ele_pv = g2.template negTrack_as<MyPrimaryElectrons>();
                 std::tuple<MyPrimaryElectron, MyPrimaryElectron, float> pair2 = std::make_tuple(pos_pv, ele_pv, collision.bz());
@@ -419,8 +458,10 @@ struct TaggingPi0 {
       // LOGF(info, "collision1: posZ = %f, numContrib = %d , sel8 = %d | collision2: posZ = %f, numContrib = %d , sel8 = %d",
       //     collision1.posZ(), collision1.numContrib(), collision1.sel8(), collision2.posZ(), collision2.numContrib(), collision2.sel8());
 
-      for (auto& cut1 : cuts1) {
-        for (auto& cut2 : cuts2) {
+      for (size_t icut1 = 0; icut1 < cuts1.size(); icut1++) {
+        auto& cut1 = cuts1[icut1];
+        for (size_t icut2 = 0; icut2 < cuts2.size(); icut2++) {
+          auto& cut2 = cuts2[icut2];
           for (auto& paircut : paircuts) {
             for (auto& [g1, g2] : combinations(soa::CombinationsFullIndexPolicy(photons_coll1, photons_coll2))) {
               // LOGF(info, "Mixed event photon pair: (%d, %d) from events (%d, %d), photon event: (%d, %d)", g1.index(), g2.index(), collision1.index(), collision2.index(), g1.globalIndex(), g2.globalIndex());
@@ -429,7 +470,11 @@ struct TaggingPi0 {
                 continue;
               }
 
-              if constexpr (pairtype == PairType::kPCMDalitzEE) {
+              if (cfgUseCutBitmasks) {
+                if (!IsSelectedPairFromBitmasks<pairtype>(g1.globalIndex(), g2.globalIndex(), icut1, icut2)) {
+                  continue;
+                }
+              } else if constexpr (pairtype == PairType::kPCMDalitzEE) {
                 auto pos_pv = g2.template posTrack_as<MyPrimaryElectrons>();
                 auto ele_pv = g2.template negTrack_as<MyPrimaryElectrons>();
                 std::tuple<MyPrimaryElectron, MyPrimaryElectron, float> pair2 = std::make_tuple(pos_pv, ele_pv, collision1.bz());
@@ -487,6 +532,10 @@ struct TaggingPi0 {
 
   void processPCMDalitzEE(MyCollisions const&, MyFilteredCollisions const& filtered_collisions, MyV0Photons const& v0photons, aod::V0Legs const& legs, MyFilteredDalitzEEs const& dielectrons, MyPrimaryElectrons const& emprimaryelectrons)
   {
+    if (cfgUseCutBitmasks) {
+      FillCutBitmasks(fCutBitmasks1, v0photons, fPCMCuts);
+      FillCutBitmasks(fCutBitmasks2, dielectrons, fDalitzEECuts);
+    }
     SameEventPairing<PairType::kPCMDalitzEE>(grouped_collisions, v0photons, dielectrons, perCollision_pcm, perCollision_dalitz, fPCMCuts, fDalitzEECuts, fPairCuts, legs, emprimaryelectrons);
     if (cfgCentEstimator == 0) {
       MixedEventPairing<PairType::kPCMDalitzEE>(filtered_collisions, v0photons, dielectrons, perCollision_pcm, perCollision_dalitz, fPCMCuts, fDalitzEECuts, fPairCuts, legs, emprimaryelectrons, colBinning_M);
@@ -499,12 +548,20 @@ struct TaggingPi0 {
 
   void processPCMPHOS(MyCollisions const&, MyFilteredCollisions const& filtered_collisions, MyV0Photons const& v0photons, aod::PHOSClusters const& phosclusters, aod::V0Legs const& legs)
   {
+    if (cfgUseCutBitmasks) {
+      FillCutBitmasks(fCutBitmasks1, v0photons, fPCMCuts);
+      FillCutBitmasks(fCutBitmasks2, phosclusters, fPHOSCuts);
+    }
     SameEventPairing<PairType::kPCMPHOS>(grouped_collisions, v0photons, phosclusters, perCollision_pcm, perCollision_phos, fPCMCuts, fPHOSCuts, fPairCuts, legs, nullptr);
     MixedEventPairing<PairType::kPCMPHOS>(filtered_collisions, v0photons, phosclusters, perCollision_pcm, perCollision_phos, fPCMCuts, fPHOSCuts, fPairCuts, legs, nullptr, colBinning_C);
   }
 
   void processPCMEMC(MyCollisions const&, MyFilteredCollisions const& filtered_collisions, MyV0Photons const& v0photons, aod::SkimEMCClusters const& emcclusters, aod::V0Legs const& legs)
   {
+    if (cfgUseCutBitmasks) {
+      FillCutBitmasks(fCutBitmasks1, v0photons, fPCMCuts);
+      FillCutBitmasks(fCutBitmasks2, emcclusters, fEMCCuts);
+    }
     SameEventPairing<PairType::kPCMEMC>(grouped_collisions, v0photons, emcclusters, perCollision_pcm, perCollision_emc, fPCMCuts, fEMCCuts, fPairCuts, legs, nullptr);
     MixedEventPairing<PairType::kPCMEMC>(filtered_collisions, v0photons, emcclusters, perCollision_pcm, perCollision_emc, fPCMCuts, fEMCCuts, fPairCuts, legs, nullptr, colBinning_C);
   }
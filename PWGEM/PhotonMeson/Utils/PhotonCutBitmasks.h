@@ -0,0 +1,63 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \bitmasks of the photon cuts
+/// All the cuts of a list (e.g. the V0PhotonCut variations of a task) are evaluated once per photon of a table,
+/// and each photon gets the bitmask of the cuts it passes, indexed by its global index.
+/// The pair loops over the cut variations, in the same event and in the mixed events, then only test bits.
+
+#ifndef PWGEM_PHOTONMESON_UTILS_PHOTONCUTBITMASKS_H_
+#define PWGEM_PHOTONMESON_UTILS_PHOTONCUTBITMASKS_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "Framework/Logger.h"
+
+namespace o2::aod::pwgem::photonmeson::utils
+{
+class PhotonCutBitmasks
+{
+ public:
+  static constexpr size_t kMaxCuts = 64;
+
+  // isSelected(cut, photon) is called for all the cuts and photons
+  template <typename TPhotons, typename TCuts, typename TIsSelected>
+  void Fill(TPhotons const& photons, TCuts const& cuts, TIsSelected&& isSelected)
+  {
+    if (cuts.size() > kMaxCuts) {
+      LOGF(fatal, "Cut bitmasks are limited to %d cuts, %d are configured.", kMaxCuts, cuts.size());
+    }
+    fBitmasks.clear();
+    fBitmasks.reserve(photons.size());
+    for (auto& photon : photons) {
+      uint64_t bitmask = 0;
+      for (size_t icut = 0; icut < cuts.size(); icut++) {
+        if (isSelected(cuts[icut], photon)) {
+          bitmask |= uint64_t(1) << icut;
+        }
+      }
+      const size_t index = photon.globalIndex();
+      if (index >= fBitmasks.size()) {
+        fBitmasks.resize(index + 1, 0); // rows missing from a filtered table pass no cut
+      }
+      fBitmasks[index] = bitmask;
+    }
+  }
+
+  uint64_t GetBitmask(int64_t globalIndex) const { return static_cast<size_t>(globalIndex) < fBitmasks.size() ? fBitmasks[globalIndex] : 0; }
+  bool IsSelected(int64_t globalIndex, int icut) const { return (GetBitmask(globalIndex) >> icut) & 1; }
+
+ private:
+  std::vector<uint64_t> fBitmasks; // bitmask of the cuts passed by each photon, by global index
+};
+} // namespace o2::aod::pwgem::photonmeson::utils
+#endif // PWGEM_PHOTONMESON_UTILS_PHOTONCUTBITMASKS_H_
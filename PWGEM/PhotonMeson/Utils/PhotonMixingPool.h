@@ -0,0 +1,99 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \pool of selected photons for the event mixing
+/// The photons of an event are selected once, with a bitmask of the pair legs whose cut they pass,
+/// and stored with their four-momentum in a compact array. The pairing in the same event and the mixing
+/// with the events of the same (zvtx, centrality, event plane) class are loops over these arrays.
+/// Each class keeps the last ndepth events in a ring buffer, whose arrays are reused.
+
+#ifndef PWGEM_PHOTONMESON_UTILS_PHOTONMIXINGPOOL_H_
+#define PWGEM_PHOTONMESON_UTILS_PHOTONMIXINGPOOL_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "Math/Vector4D.h"
+
+namespace o2::aod::pwgem::photonmeson::utils
+{
+struct PooledPhoton {
+  float pt;
+  float eta;
+  float phi;
+  double px; // four-momentum as computed by ROOT::Math::PtEtaPhiMVector
+  double py;
+  double pz;
+  double e;
+  int64_t globalIndex;
+  uint8_t cuts; // legs whose cut the photon passes
+  uint8_t legs; // legs the photon was used for in a pair of its event
+
+  ROOT::Math::PxPyPzEVector momentum() const { return ROOT::Math::PxPyPzEVector(px, py, pz, e); }
+};
+
+template <typename T>
+class PhotonMixingPool
+{
+ public:
+  static constexpr uint8_t kLeg1 = 1 << 0;
+  static constexpr uint8_t kLeg2 = 1 << 1;
+
+  explicit PhotonMixingPool(int ndepth) : fNdepth(ndepth) {}
+
+  void ClearEvent() { fEvent.clear(); }
+  void AddPhoton(int64_t globalIndex, float pt, float eta, float phi, float mass, uint8_t cuts)
+  {
+    ROOT::Math::PtEtaPhiMVector v(pt, eta, phi, mass);
+    fEvent.push_back(PooledPhoton{pt, eta, phi, v.Px(), v.Py(), v.Pz(), v.E(), globalIndex, cuts, 0});
+  }
+  std::vector<PooledPhoton>& GetEvent() { return fEvent; }
+
+  // events in the pool of key_bin, in no particular order
+  const std::vector<std::vector<PooledPhoton>>& GetPoolEvents(T const& key_bin) { return fPools[key_bin].events; }
+
+  // call this function at the end of collision loop: the photons used in a pair are moved to the pool of key_bin,
+  // in place of the oldest event once the depth is reached
+  void AddEventToPool(T const& key_bin)
+  {
+    if (fNdepth <= 0) {
+      fEvent.clear();
+      return;
+    }
+    fEvent.erase(std::remove_if(fEvent.begin(), fEvent.end(), [](PooledPhoton const& photon) { return photon.legs == 0; }), fEvent.end());
+    auto& pool = fPools[key_bin];
+    if (static_cast<int>(pool.events.size()) < fNdepth) {
+      pool.events.emplace_back();
+      pool.events.back().swap(fEvent);
+    } else {
+      pool.events[pool.oldest].swap(fEvent);
+      pool.oldest = (pool.oldest + 1) % fNdepth;
+    }
+    fEvent.clear();
+  }
+
+  static int NLegs(uint8_t legs) { return ((legs & kLeg1) != 0) + ((legs & kLeg2) != 0); }
+
+ private:
+  struct Pool {
+    std::vector<std::vector<PooledPhoton>> events;
+    size_t oldest = 0;
+  };
+
+  int fNdepth;                      // depth of event mixing
+  std::vector<PooledPhoton> fEvent; // photons of the current event
+  std::map<T, Pool> fPools;         // map : e.g. <zbin, centbin, epbin> -> events
+};
+} // namespace o2::aod::pwgem::photonmeson::utils
+#endif // PWGEM_PHOTONMESON_UTILS_PHOTONMIXINGPOOL_H_
@@ -17,10 +17,19 @@
 #ifndef PWGHF_CORE_HFMLRESPONSE_H_
 #define PWGHF_CORE_HFMLRESPONSE_H_
 
+#include <array>
+#include <cstddef>
+#include <vector>
+
 #include "Tools/ML/MlResponse.h"
 
 namespace o2::analysis
 {
+/// Table of accessors to the input features of a candidate type, indexed by the feature enum
+/// It is generated once per candidate type, so that the configured features are gathered
+/// with one indirect call each instead of a switch over all the available features
+template <typename TContext, std::size_t NFeatures>
+using HfMlFeatureGetters = std::array<float (*)(TContext const&), NFeatures>;
 
 template <typename TypeOutputScore = float>
 class HfMlResponse : public MlResponse<TypeOutputScore>
@@ -30,6 +39,64 @@ class HfMlResponse : public MlResponse<TypeOutputScore>
   HfMlResponse() = default;
   /// Default destructor
   virtual ~HfMlResponse() = default;
+
+  // Batched ML selections of the candidates of a data frame: the input features are gathered with addToBatch,
+  // the models are evaluated once per bin of candVar by evaluateBatch, then the results are read by batch index
+
+  /// Empties the batch
+  void clearBatch()
+  {
+    mBatchInputFeatures.clear();
+    mBatchCandVars.clear();
+  }
+
+  /// Adds a candidate to the batch
+  /// \param inputFeatures is the input features of the candidate
+  /// \param candVar is the variable value (e.g. pT) used to select which model to use
+  /// \return index of the candidate in the batch
+  int addToBatch(std::vector<float> const& inputFeatures, float candVar)
+  {
+    mBatchInputFeatures.insert(mBatchInputFeatures.end(), inputFeatures.begin(), inputFeatures.end());
+    mBatchCandVars.push_back(candVar);
+    return mBatchCandVars.size() - 1;
+  }
+
+  /// Evaluates the models on the candidates of the batch, with one inference per model
+  void evaluateBatch()
+  {
+    MlResponse<TypeOutputScore>::isSelectedMlBatch(mBatchInputFeatures, mBatchCandVars, mBatchIsSelected, mBatchOutputs);
+  }
+
+  /// \param index is the index of the candidate in the batch
+  /// \return boolean telling if model predictions pass the cuts
+  bool isSelectedInBatch(int index) const { return mBatchIsSelected[index]; }
+
+  /// \param index is the index of the candidate in the batch
+  /// \param output is a container to be filled with model output
+  void getOutputInBatch(int index, std::vector<TypeOutputScore>& output) const
+  {
+    const auto nClasses = MlResponse<TypeOutputScore>::mNClasses;
+    output.assign(mBatchOutputs.begin() + index * nClasses, mBatchOutputs.begin() + (index + 1) * nClasses);
+  }
+
+ protected:
+  /// Method to append the configured input features of a candidate to a contiguous buffer
+  /// \param getters is the table of accessors of the candidate type
+  /// \param context is the candidate with its prongs
+  /// \param inputFeatures is the buffer to be filled
+  template <typename TContext, std::size_t NFeatures>
+  void gatherInputFeatures(HfMlFeatureGetters<TContext, NFeatures> const& getters, TContext const& context, std::vector<float>& inputFeatures) const
+  {
+    for (const auto& idx : MlResponse<TypeOutputScore>::mCachedIndices) {
+      inputFeatures.emplace_back(getters[idx](context));
+    }
+  }
+
+ private:
+  std::vector<float> mBatchInputFeatures;     // input features of the candidates of the batch, consecutive per candidate
+  std::vector<float> mBatchCandVars;          // variable values (e.g. pT) of the candidates of the batch
+  std::vector<bool> mBatchIsSelected;         // selection decisions of the candidates of the batch
+  std::vector<TypeOutputScore> mBatchOutputs; // model predictions of the candidates of the batch, consecutive per candidate
 };
 
 } // namespace o2::analysis
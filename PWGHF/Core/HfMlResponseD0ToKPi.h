@@ -17,6 +17,7 @@
 #ifndef PWGHF_CORE_HFMLRESPONSED0TOKPI_H_
 #define PWGHF_CORE_HFMLRESPONSED0TOKPI_H_
 
+#include <cstddef>
 #include <map>
 #include <string>
 #include <vector>
@@ -34,43 +35,33 @@
 #FEATURE, static_cast < uint8_t>(InputFeaturesD0ToKPi::FEATURE) \
   }
 
-// Check if the index of mCachedIndices (index associated to a FEATURE)
-// matches the entry in EnumInputFeatures associated to this FEATURE
-// if so, the inputFeatures vector is filled with the FEATURE's value
-// by calling the corresponding GETTER from OBJECT
-#define CHECK_AND_FILL_VEC_D0_FULL(OBJECT, FEATURE, GETTER)   \
-  case static_cast<uint8_t>(InputFeaturesD0ToKPi::FEATURE): { \
-    inputFeatures.emplace_back(OBJECT.GETTER());              \
-    break;                                                    \
+// Set the accessor of FEATURE in the table of getters
+// it returns the value of the corresponding GETTER from OBJECT
+#define SET_GETTER_D0_FULL(OBJECT, FEATURE, GETTER)                                                      \
+  getters[static_cast<uint8_t>(InputFeaturesD0ToKPi::FEATURE)] = [](Context const& context) -> float { \
+    return context.OBJECT.GETTER();                                                                      \
   }
 
-// Specific case of CHECK_AND_FILL_VEC_D0_FULL(OBJECT, FEATURE, GETTER)
+// Specific case of SET_GETTER_D0_FULL(OBJECT, FEATURE, GETTER)
 // where OBJECT is named candidate and FEATURE = GETTER
-#define CHECK_AND_FILL_VEC_D0(GETTER)                        \
-  case static_cast<uint8_t>(InputFeaturesD0ToKPi::GETTER): { \
-    inputFeatures.emplace_back(candidate.GETTER());          \
-    break;                                                   \
-  }
+#define SET_GETTER_D0(GETTER) SET_GETTER_D0_FULL(candidate, GETTER, GETTER)
 
-// Variation of CHECK_AND_FILL_VEC_D0_FULL(OBJECT, FEATURE, GETTER)
+// Variation of SET_GETTER_D0_FULL(OBJECT, FEATURE, GETTER)
 // where GETTER is a method of hfHelper
-#define CHECK_AND_FILL_VEC_D0_HFHELPER(OBJECT, FEATURE, GETTER) \
-  case static_cast<uint8_t>(InputFeaturesD0ToKPi::FEATURE): {   \
-    inputFeatures.emplace_back(hfHelper.GETTER(OBJECT));        \
-    break;                                                      \
+#define SET_GETTER_D0_HFHELPER(OBJECT, FEATURE, GETTER)                                                  \
+  getters[static_cast<uint8_t>(InputFeaturesD0ToKPi::FEATURE)] = [](Context const& context) -> float { \
+    return context.hfHelper.GETTER(context.OBJECT);                                                      \
   }
 
-// Variation of CHECK_AND_FILL_VEC_D0_HFHELPER(OBJECT, FEATURE, GETTER)
+// Variation of SET_GETTER_D0_HFHELPER(OBJECT, FEATURE, GETTER)
 // where GETTER1 and GETTER2 are methods of hfHelper, and the variable
 // is filled depending on whether it is a D0 or a D0bar
-#define CHECK_AND_FILL_VEC_D0_HFHELPER_SIGNED(OBJECT, FEATURE, GETTER1, GETTER2) \
-  case static_cast<uint8_t>(InputFeaturesD0ToKPi::FEATURE): {                    \
-    if (pdgCode == o2::constants::physics::kD0) {                                \
-      inputFeatures.emplace_back(hfHelper.GETTER1(OBJECT));                      \
-    } else {                                                                     \
-      inputFeatures.emplace_back(hfHelper.GETTER2(OBJECT));                      \
-    }                                                                            \
-    break;                                                                       \
+#define SET_GETTER_D0_HFHELPER_SIGNED(OBJECT, FEATURE, GETTER1, GETTER2)                                 \
+  getters[static_cast<uint8_t>(InputFeaturesD0ToKPi::FEATURE)] = [](Context const& context) -> float { \
+    if (context.pdgCode == o2::constants::physics::kD0) {                                                \
+      return context.hfHelper.GETTER1(context.OBJECT);                                                   \
+    }                                                                                                    \
+    return context.hfHelper.GETTER2(context.OBJECT);                                                     \
   }
 
 namespace o2::analysis
@@ -107,6 +98,7 @@ enum class InputFeaturesD0ToKPi : uint8_t {
   cpaXY,
   ct
 };
+static constexpr std::size_t NInputFeaturesD0ToKPi = static_cast<std::size_t>(InputFeaturesD0ToKPi::ct) + 1;
 
 template <typename TypeOutputScore = float>
 class HfMlResponseD0ToKPi : public HfMlResponse<TypeOutputScore>
@@ -129,49 +121,80 @@ class HfMlResponseD0ToKPi : public HfMlResponse<TypeOutputScore>
                                       T2 const& prong0, T2 const& prong1, int const& pdgCode)
   {
     std::vector<float> inputFeatures;
-
-    for (const auto& idx : MlResponse<TypeOutputScore>::mCachedIndices) {
-      switch (idx) {
-        CHECK_AND_FILL_VEC_D0(chi2PCA);
-        CHECK_AND_FILL_VEC_D0(decayLength);
-        CHECK_AND_FILL_VEC_D0(decayLengthXY);
-        CHECK_AND_FILL_VEC_D0(decayLengthNormalised);
-        CHECK_AND_FILL_VEC_D0(decayLengthXYNormalised);
-        CHECK_AND_FILL_VEC_D0(ptProng0);
-        CHECK_AND_FILL_VEC_D0(ptProng1);
-        CHECK_AND_FILL_VEC_D0_FULL(candidate, impactParameterXY0, impactParameter0);
-        CHECK_AND_FILL_VEC_D0_FULL(candidate, impactParameterXY1, impactParameter1);
-        CHECK_AND_FILL_VEC_D0(impactParameterZ0);
-        CHECK_AND_FILL_VEC_D0(impactParameterZ1);
-        // TPC PID variables
-        CHECK_AND_FILL_VEC_D0_FULL(prong0, nSigTpcPi0, tpcNSigmaPi);
-        CHECK_AND_FILL_VEC_D0_FULL(prong0, nSigTpcKa0, tpcNSigmaKa);
-        CHECK_AND_FILL_VEC_D0_FULL(prong1, nSigTpcPi1, tpcNSigmaPi);
-        CHECK_AND_FILL_VEC_D0_FULL(prong1, nSigTpcKa1, tpcNSigmaKa);
-        // TOF PID variables
-        CHECK_AND_FILL_VEC_D0_FULL(prong0, nSigTofPi0, tofNSigmaPi);
-        CHECK_AND_FILL_VEC_D0_FULL(prong0, nSigTofKa0, tofNSigmaKa);
-        CHECK_AND_FILL_VEC_D0_FULL(prong1, nSigTofPi1, tofNSigmaPi);
-        CHECK_AND_FILL_VEC_D0_FULL(prong1, nSigTofKa1, tofNSigmaKa);
-        // Combined PID variables
-        CHECK_AND_FILL_VEC_D0_FULL(prong0, nSigTpcTofPi0, tpcTofNSigmaPi);
-        CHECK_AND_FILL_VEC_D0_FULL(prong0, nSigTpcTofKa0, tpcTofNSigmaKa);
-        CHECK_AND_FILL_VEC_D0_FULL(prong1, nSigTpcTofPi1, tpcTofNSigmaPi);
-        CHECK_AND_FILL_VEC_D0_FULL(prong1, nSigTpcTofKa1, tpcTofNSigmaKa);
-
-        CHECK_AND_FILL_VEC_D0(maxNormalisedDeltaIP);
-        CHECK_AND_FILL_VEC_D0_FULL(candidate, impactParameterProduct, impactParameterProduct);
-        CHECK_AND_FILL_VEC_D0_HFHELPER_SIGNED(candidate, cosThetaStar, cosThetaStarD0, cosThetaStarD0bar);
-        CHECK_AND_FILL_VEC_D0(cpa);
-        CHECK_AND_FILL_VEC_D0(cpaXY);
-        CHECK_AND_FILL_VEC_D0_HFHELPER(candidate, ct, ctD0);
-      }
-    }
-
+    inputFeatures.reserve(MlResponse<TypeOutputScore>::mCachedIndices.size());
+    fillInputFeatures(candidate, prong0, prong1, pdgCode, inputFeatures);
     return inputFeatures;
   }
 
+  /// Method to append the input features needed for ML inference to a contiguous buffer (e.g. for batched inference)
+  /// \param candidate is the D0 candidate
+  /// \param prong0 is the candidate's prong0
+  /// \param prong1 is the candidate's prong1
+  /// \param inputFeatures is the buffer to be filled
+  template <typename T1, typename T2>
+  void fillInputFeatures(T1 const& candidate,
+                         T2 const& prong0, T2 const& prong1, int const& pdgCode, std::vector<float>& inputFeatures)
+  {
+    const FeatureContext<T1, T2> context{candidate, prong0, prong1, pdgCode, hfHelper};
+    HfMlResponse<TypeOutputScore>::gatherInputFeatures(getFeatureGetters<T1, T2>(), context, inputFeatures);
+  }
+
  protected:
+  /// Candidate and prongs from which the input features are read
+  template <typename T1, typename T2>
+  struct FeatureContext {
+    T1 const& candidate;
+    T2 const& prong0;
+    T2 const& prong1;
+    int pdgCode;
+    HfHelper& hfHelper;
+  };
+
+  /// Method to generate the table of accessors to the available input features, once per candidate type
+  template <typename T1, typename T2>
+  static HfMlFeatureGetters<FeatureContext<T1, T2>, NInputFeaturesD0ToKPi> const& getFeatureGetters()
+  {
+    using Context = FeatureContext<T1, T2>;
+    static const auto featureGetters = [] {
+      HfMlFeatureGetters<Context, NInputFeaturesD0ToKPi> getters{};
+      SET_GETTER_D0(chi2PCA);
+      SET_GETTER_D0(decayLength);
+      SET_GETTER_D0(decayLengthXY);
+      SET_GETTER_D0(decayLengthNormalised);
+      SET_GETTER_D0(decayLengthXYNormalised);
+      SET_GETTER_D0(ptProng0);
+      SET_GETTER_D0(ptProng1);
+      SET_GETTER_D0_FULL(candidate, impactParameterXY0, impactParameter0);
+      SET_GETTER_D0_FULL(candidate, impactParameterXY1, impactParameter1);
+      SET_GETTER_D0(impactParameterZ0);
+      SET_GETTER_D0(impactParameterZ1);
+      // TPC PID variables
+      SET_GETTER_D0_FULL(prong0, nSigTpcPi0, tpcNSigmaPi);
+      SET_GETTER_D0_FULL(prong0, nSigTpcKa0, tpcNSigmaKa);
+      SET_GETTER_D0_FULL(prong1, nSigTpcPi1, tpcNSigmaPi);
+      SET_GETTER_D0_FULL(prong1, nSigTpcKa1, tpcNSigmaKa);
+      // TOF PID variables
+      SET_GETTER_D0_FULL(prong0, nSigTofPi0, tofNSigmaPi);
+      SET_GETTER_D0_FULL(prong0, nSigTofKa0, tofNSigmaKa);
+      SET_GETTER_D0_FULL(prong1, nSigTofPi1, tofNSigmaPi);
+      SET_GETTER_D0_FULL(prong1, nSigTofKa1, tofNSigmaKa);
+      // Combined PID variables
+      SET_GETTER_D0_FULL(prong0, nSigTpcTofPi0, tpcTofNSigmaPi);
+      SET_GETTER_D0_FULL(prong0, nSigTpcTofKa0, tpcTofNSigmaKa);
+      SET_GETTER_D0_FULL(prong1, nSigTpcTofPi1, tpcTofNSigmaPi);
+      SET_GETTER_D0_FULL(prong1, nSigTpcTofKa1, tpcTofNSigmaKa);
+
+      SET_GETTER_D0(maxNormalisedDeltaIP);
+      SET_GETTER_D0_FULL(candidate, impactParameterProduct, impactParameterProduct);
+      SET_GETTER_D0_HFHELPER_SIGNED(candidate, cosThetaStar, cosThetaStarD0, cosThetaStarD0bar);
+      SET_GETTER_D0(cpa);
+      SET_GETTER_D0(cpaXY);
+      SET_GETTER_D0_HFHELPER(candidate, ct, ctD0);
+      return getters;
+    }();
+    return featureGetters;
+  }
+
   /// Method to fill the map of available input features
   void setAvailableInputFeatures()
   {
@@ -215,9 +238,9 @@ class HfMlResponseD0ToKPi : public HfMlResponse<TypeOutputScore>
 } // namespace o2::analysis
 
 #undef FILL_MAP_D0
-#undef CHECK_AND_FILL_VEC_D0_FULL
-#undef CHECK_AND_FILL_VEC_D0
-#undef CHECK_AND_FILL_VEC_D0_HFHELPER
-#undef CHECK_AND_FILL_VEC_D0_HFHELPER_SIGNED
+#undef SET_GETTER_D0_FULL
+#undef SET_GETTER_D0
+#undef SET_GETTER_D0_HFHELPER
+#undef SET_GETTER_D0_HFHELPER_SIGNED
 
 #endif // PWGHF_CORE_HFMLRESPONSED0TOKPI_H_
@@ -16,6 +16,7 @@
 #ifndef PWGHF_CORE_HFMLRESPONSELCTOPKPI_H_
 #define PWGHF_CORE_HFMLRESPONSELCTOPKPI_H_
 
+#include <cstddef>
 #include <vector>
 
 #include "PWGHF/Core/HfMlResponse.h"
@@ -28,31 +29,16 @@
 #FEATURE, static_cast < uint8_t>(InputFeaturesLcToPKPi::FEATURE) \
   }
 
-// Check if the index of mCachedIndices (index associated to a FEATURE)
-// matches the entry in EnumInputFeatures associated to this FEATURE
-// if so, the inputFeatures vector is filled with the FEATURE's value
-// by calling the corresponding GETTER from OBJECT
-#define CHECK_AND_FILL_VEC_LCTOPKPI_FULL(OBJECT, FEATURE, GETTER) \
-  case static_cast<uint8_t>(InputFeaturesLcToPKPi::FEATURE): {    \
-    inputFeatures.emplace_back(OBJECT.GETTER());                  \
-    break;                                                        \
+// Set the accessor of FEATURE in the table of getters
+// it returns the value of the corresponding GETTER from OBJECT
+#define SET_GETTER_LCTOPKPI_FULL(OBJECT, FEATURE, GETTER)                                                 \
+  getters[static_cast<uint8_t>(InputFeaturesLcToPKPi::FEATURE)] = [](Context const& context) -> float { \
+    return context.OBJECT.GETTER();                                                                       \
   }
 
-// Specific case of CHECK_AND_FILL_VEC_LCTOPKPI_FULL(OBJECT, FEATURE, GETTER)
+// Specific case of SET_GETTER_LCTOPKPI_FULL(OBJECT, FEATURE, GETTER)
 // where OBJECT is named candidate and FEATURE = GETTER
-#define CHECK_AND_FILL_VEC_LCTOPKPI(GETTER)                   \
-  case static_cast<uint8_t>(InputFeaturesLcToPKPi::GETTER): { \
-    inputFeatures.emplace_back(candidate.GETTER());           \
-    break;                                                    \
-  }
-
-// Variation of CHECK_AND_FILL_VEC_LCTOPKPI_FULL(OBJECT, FEATURE, GETTER)
-// where GETTER is a method of hfHelper
-#define CHECK_AND_FILL_VEC_LCTOPKPI_HFHELPER(OBJECT, FEATURE, GETTER) \
-  case static_cast<uint8_t>(InputFeaturesLcToPKPi::FEATURE): {        \
-    inputFeatures.emplace_back(hfHelper.GETTER(OBJECT));              \
-    break;                                                            \
-  }
+#define SET_GETTER_LCTOPKPI(GETTER) SET_GETTER_LCTOPKPI_FULL(candidate, GETTER, GETTER)
 
 namespace o2::analysis
 {
@@ -100,6 +86,7 @@ enum class InputFeaturesLcToPKPi : uint8_t {
   tpcTofNSigmaPr1,
   tpcTofNSigmaPr2
 };
+static constexpr std::size_t NInputFeaturesLcToPKPi = static_cast<std::size_t>(InputFeaturesLcToPKPi::tpcTofNSigmaPr2) + 1;
 
 template <typename TypeOutputScore = float>
 class HfMlResponseLcToPKPi : public HfMlResponse<TypeOutputScore>
@@ -121,61 +108,92 @@ class HfMlResponseLcToPKPi : public HfMlResponse<TypeOutputScore>
                                       T2 const& prong0, T2 const& prong1, T2 const& prong2)
   {
     std::vector<float> inputFeatures;
-
-    for (const auto& idx : MlResponse<TypeOutputScore>::mCachedIndices) {
-      switch (idx) {
-        CHECK_AND_FILL_VEC_LCTOPKPI(ptProng0);
-        CHECK_AND_FILL_VEC_LCTOPKPI(ptProng1);
-        CHECK_AND_FILL_VEC_LCTOPKPI(ptProng2);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(candidate, impactParameterXY0, impactParameter0);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(candidate, impactParameterXY1, impactParameter1);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(candidate, impactParameterXY2, impactParameter2);
-        CHECK_AND_FILL_VEC_LCTOPKPI(impactParameterZ0);
-        CHECK_AND_FILL_VEC_LCTOPKPI(impactParameterZ1);
-        CHECK_AND_FILL_VEC_LCTOPKPI(impactParameterZ2);
-        CHECK_AND_FILL_VEC_LCTOPKPI(decayLength);
-        CHECK_AND_FILL_VEC_LCTOPKPI(decayLengthXY);
-        CHECK_AND_FILL_VEC_LCTOPKPI(decayLengthXYNormalised);
-        CHECK_AND_FILL_VEC_LCTOPKPI(cpa);
-        CHECK_AND_FILL_VEC_LCTOPKPI(cpaXY);
-        CHECK_AND_FILL_VEC_LCTOPKPI(chi2PCA);
-        // TPC PID variables
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(prong0, tpcNSigmaP0, tpcNSigmaPr);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(prong0, tpcNSigmaKa0, tpcNSigmaKa);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(prong0, tpcNSigmaPi0, tpcNSigmaPi);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(prong1, tpcNSigmaP1, tpcNSigmaPr);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(prong1, tpcNSigmaKa1, tpcNSigmaKa);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(prong1, tpcNSigmaPi1, tpcNSigmaPi);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(prong2, tpcNSigmaP2, tpcNSigmaPr);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(prong2, tpcNSigmaKa2, tpcNSigmaKa);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(prong2, tpcNSigmaPi2, tpcNSigmaPi);
-        // TOF PID variables
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(prong0, tofNSigmaP0, tofNSigmaPr);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(prong0, tofNSigmaKa0, tofNSigmaKa);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(prong0, tofNSigmaPi0, tofNSigmaPi);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(prong1, tofNSigmaP1, tofNSigmaPr);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(prong1, tofNSigmaKa1, tofNSigmaKa);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(prong1, tofNSigmaPi1, tofNSigmaPi);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(prong2, tofNSigmaP2, tofNSigmaPr);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(prong2, tofNSigmaKa2, tofNSigmaKa);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(prong2, tofNSigmaPi2, tofNSigmaPi);
-        // Combined PID variables
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(prong0, tpcTofNSigmaPi0, tpcTofNSigmaPi);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(prong1, tpcTofNSigmaPi1, tpcTofNSigmaPi);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(prong2, tpcTofNSigmaPi2, tpcTofNSigmaPi);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(prong0, tpcTofNSigmaKa0, tpcTofNSigmaKa);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(prong1, tpcTofNSigmaKa1, tpcTofNSigmaKa);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(prong2, tpcTofNSigmaKa2, tpcTofNSigmaKa);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(prong0, tpcTofNSigmaPr0, tpcTofNSigmaPr);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(prong1, tpcTofNSigmaPr1, tpcTofNSigmaPr);
-        CHECK_AND_FILL_VEC_LCTOPKPI_FULL(prong2, tpcTofNSigmaPr2, tpcTofNSigmaPr);
-      }
-    }
-
+    inputFeatures.reserve(MlResponse<TypeOutputScore>::mCachedIndices.size());
+    fillInputFeatures(candidate, prong0, prong1, prong2, inputFeatures);
     return inputFeatures;
   }
 
+  /// Method to append the input features needed for ML inference to a contiguous buffer (e.g. for batched inference)
+  /// \param candidate is the Lc candidate
+  /// \param prong0 is the candidate's prong0
+  /// \param prong1 is the candidate's prong1
+  /// \param prong2 is the candidate's prong2
+  /// \param inputFeatures is the buffer to be filled
+  template <typename T1, typename T2>
+  void fillInputFeatures(T1 const& candidate,
+                         T2 const& prong0, T2 const& prong1, T2 const& prong2, std::vector<float>& inputFeatures)
+  {
+    const FeatureContext<T1, T2> context{candidate, prong0, prong1, prong2};
+    HfMlResponse<TypeOutputScore>::gatherInputFeatures(getFeatureGetters<T1, T2>(), context, inputFeatures);
+  }
+
  protected:
+  /// Candidate and prongs from which the input features are read
+  template <typename T1, typename T2>
+  struct FeatureContext {
+    T1 const& candidate;
+    T2 const& prong0;
+    T2 const& prong1;
+    T2 const& prong2;
+  };
+
+  /// Method to generate the table of accessors to the available input features, once per candidate type
+  template <typename T1, typename T2>
+  static HfMlFeatureGetters<FeatureContext<T1, T2>, NInputFeaturesLcToPKPi> const& getFeatureGetters()
+  {
+    using Context = FeatureContext<T1, T2>;
+    static const auto featureGetters = [] {
+      HfMlFeatureGetters<Context, NInputFeaturesLcToPKPi> getters{};
+      SET_GETTER_LCTOPKPI(ptProng0);
+      SET_GETTER_LCTOPKPI(ptProng1);
+      SET_GETTER_LCTOPKPI(ptProng2);
+      SET_GETTER_LCTOPKPI_FULL(candidate, impactParameterXY0, impactParameter0);
+      SET_GETTER_LCTOPKPI_FULL(candidate, impactParameterXY1, impactParameter1);
+      SET_GETTER_LCTOPKPI_FULL(candidate, impactParameterXY2, impactParameter2);
+      SET_GETTER_LCTOPKPI(impactParameterZ0);
+      SET_GETTER_LCTOPKPI(impactParameterZ1);
+      SET_GETTER_LCTOPKPI(impactParameterZ2);
+      SET_GETTER_LCTOPKPI(decayLength);
+      SET_GETTER_LCTOPKPI(decayLengthXY);
+      SET_GETTER_LCTOPKPI(decayLengthXYNormalised);
+      SET_GETTER_LCTOPKPI(cpa);
+      SET_GETTER_LCTOPKPI(cpaXY);
+      SET_GETTER_LCTOPKPI(chi2PCA);
+      // TPC PID variables
+      SET_GETTER_LCTOPKPI_FULL(prong0, tpcNSigmaP0, tpcNSigmaPr);
+      SET_GETTER_LCTOPKPI_FULL(prong0, tpcNSigmaKa0, tpcNSigmaKa);
+      SET_GETTER_LCTOPKPI_FULL(prong0, tpcNSigmaPi0, tpcNSigmaPi);
+      SET_GETTER_LCTOPKPI_FULL(prong1, tpcNSigmaP1, tpcNSigmaPr);
+      SET_GETTER_LCTOPKPI_FULL(prong1, tpcNSigmaKa1, tpcNSigmaKa);
+      SET_GETTER_LCTOPKPI_FULL(prong1, tpcNSigmaPi1, tpcNSigmaPi);
+      SET_GETTER_LCTOPKPI_FULL(prong2, tpcNSigmaP2, tpcNSigmaPr);
+      SET_GETTER_LCTOPKPI_FULL(prong2, tpcNSigmaKa2, tpcNSigmaKa);
+      SET_GETTER_LCTOPKPI_FULL(prong2, tpcNSigmaPi2, tpcNSigmaPi);
+      // TOF PID variables
+      SET_GETTER_LCTOPKPI_FULL(prong0, tofNSigmaP0, tofNSigmaPr);
+      SET_GETTER_LCTOPKPI_FULL(prong0, tofNSigmaKa0, tofNSigmaKa);
+      SET_GETTER_LCTOPKPI_FULL(prong0, tofNSigmaPi0, tofNSigmaPi);
+      SET_GETTER_LCTOPKPI_FULL(prong1, tofNSigmaP1, tofNSigmaPr);
+      SET_GETTER_LCTOPKPI_FULL(prong1, tofNSigmaKa1, tofNSigmaKa);
+      SET_GETTER_LCTOPKPI_FULL(prong1, tofNSigmaPi1, tofNSigmaPi);
+      SET_GETTER_LCTOPKPI_FULL(prong2, tofNSigmaP2, tofNSigmaPr);
+      SET_GETTER_LCTOPKPI_FULL(prong2, tofNSigmaKa2, tofNSigmaKa);
+      SET_GETTER_LCTOPKPI_FULL(prong2, tofNSigmaPi2, tofNSigmaPi);
+      // Combined PID variables
+      SET_GETTER_LCTOPKPI_FULL(prong0, tpcTofNSigmaPi0, tpcTofNSigmaPi);
+      SET_GETTER_LCTOPKPI_FULL(prong1, tpcTofNSigmaPi1, tpcTofNSigmaPi);
+      SET_GETTER_LCTOPKPI_FULL(prong2, tpcTofNSigmaPi2, tpcTofNSigmaPi);
+      SET_GETTER_LCTOPKPI_FULL(prong0, tpcTofNSigmaKa0, tpcTofNSigmaKa);
+      SET_GETTER_LCTOPKPI_FULL(prong1, tpcTofNSigmaKa1, tpcTofNSigmaKa);
+      SET_GETTER_LCTOPKPI_FULL(prong2, tpcTofNSigmaKa2, tpcTofNSigmaKa);
+      SET_GETTER_LCTOPKPI_FULL(prong0, tpcTofNSigmaPr0, tpcTofNSigmaPr);
+      SET_GETTER_LCTOPKPI_FULL(prong1, tpcTofNSigmaPr1, tpcTofNSigmaPr);
+      SET_GETTER_LCTOPKPI_FULL(prong2, tpcTofNSigmaPr2, tpcTofNSigmaPr);
+      return getters;
+    }();
+    return featureGetters;
+  }
+
   /// Method to fill the map of available input features
   void setAvailableInputFeatures()
   {
@@ -231,8 +249,7 @@ class HfMlResponseLcToPKPi : public HfMlResponse<TypeOutputScore>
 } // namespace o2::analysis
 
 #undef FILL_MAP_LCTOPKPI
-#undef CHECK_AND_FILL_VEC_LCTOPKPI_FULL
-#undef CHECK_AND_FILL_VEC_LCTOPKPI
-#undef CHECK_AND_FILL_VEC_LCTOPKPI_HFHELPER
+#undef SET_GETTER_LCTOPKPI_FULL
+#undef SET_GETTER_LCTOPKPI
 
 #endif // PWGHF_CORE_HFMLRESPONSELCTOPKPI_H_
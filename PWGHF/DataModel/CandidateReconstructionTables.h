@@ -418,6 +418,46 @@ DECLARE_SOA_TABLE(HfPvRefitDstar, "AOD", "HFPVREFITDSTAR", //!
                   hf_pv_refit::PvRefitSigmaZ2,
                   o2::soa::Marker<2>);
 
+// secondary-vertex fits of the skimmed candidates, to be used by the candidate creators instead of refitting
+namespace hf_sv_fit
+{
+DECLARE_SOA_COLUMN(SvFitX, svFitX, float);                           //! x of the secondary vertex
+DECLARE_SOA_COLUMN(SvFitY, svFitY, float);                           //! y of the secondary vertex
+DECLARE_SOA_COLUMN(SvFitZ, svFitZ, float);                           //! z of the secondary vertex
+DECLARE_SOA_COLUMN(SvFitChi2PCA, svFitChi2PCA, float);               //! chi2 of the secondary vertex at the PCA
+DECLARE_SOA_COLUMN(SvFitCovMat, svFitCovMat, float[6]);              //! covariance matrix of the secondary vertex (XX, XY, YY, XZ, YZ, ZZ)
+DECLARE_SOA_COLUMN(SvFitParProng0, svFitParProng0, float[7]);        //! X, alpha and parameters of the first prong at the secondary vertex
+DECLARE_SOA_COLUMN(SvFitCovMatProng0, svFitCovMatProng0, float[15]); //! covariance matrix of the first prong at the secondary vertex
+DECLARE_SOA_COLUMN(SvFitParProng1, svFitParProng1, float[7]);        //! X, alpha and parameters of the second prong at the secondary vertex
+DECLARE_SOA_COLUMN(SvFitCovMatProng1, svFitCovMatProng1, float[15]); //! covariance matrix of the second prong at the secondary vertex
+DECLARE_SOA_COLUMN(SvFitParProng2, svFitParProng2, float[7]);        //! X, alpha and parameters of the third prong at the secondary vertex
+DECLARE_SOA_COLUMN(SvFitCovMatProng2, svFitCovMatProng2, float[15]); //! covariance matrix of the third prong at the secondary vertex
+} // namespace hf_sv_fit
+
+DECLARE_SOA_TABLE(HfSvFit2Prong, "AOD", "HFSVFIT2PRONG", //! Secondary-vertex fits of the 2-prong candidates, joinable with Hf2Prongs
+                  hf_sv_fit::SvFitX,
+                  hf_sv_fit::SvFitY,
+                  hf_sv_fit::SvFitZ,
+                  hf_sv_fit::SvFitChi2PCA,
+                  hf_sv_fit::SvFitCovMat,
+                  hf_sv_fit::SvFitParProng0,
+                  hf_sv_fit::SvFitCovMatProng0,
+                  hf_sv_fit::SvFitParProng1,
+                  hf_sv_fit::SvFitCovMatProng1);
+
+DECLARE_SOA_TABLE(HfSvFit3Prong, "AOD", "HFSVFIT3PRONG", //! Secondary-vertex fits of the 3-prong candidates, joinable with Hf3Prongs
+                  hf_sv_fit::SvFitX,
+                  hf_sv_fit::SvFitY,
+                  hf_sv_fit::SvFitZ,
+                  hf_sv_fit::SvFitChi2PCA,
+                  hf_sv_fit::SvFitCovMat,
+                  hf_sv_fit::SvFitParProng0,
+                  hf_sv_fit::SvFitCovMatProng0,
+                  hf_sv_fit::SvFitParProng1,
+                  hf_sv_fit::SvFitCovMatProng1,
+                  hf_sv_fit::SvFitParProng2,
+                  hf_sv_fit::SvFitCovMatProng2);
+
 // general decay properties
 namespace hf_cand
 {
@@ -1682,16 +1722,16 @@ DECLARE_SOA_DYNAMIC_COLUMN(ImpactParameterProductD0, impactParameterProductD0,
                            [](float dca1, float dca2) -> float { return dca1 * dca2; });
 // Dynamic Columns for D0 candidate using PDG masses of daughters
 DECLARE_SOA_DYNAMIC_COLUMN(InvMassD0, invMassD0,
-                           [](float px0, float py0, float pz0, float px1, float py1, float pz1) -> float { return RecoDecay::m(std::array{std::array{px0, py0, pz0}, std::array{px1, py1, pz1}}, std::array{constants::physics::MassPiPlus, constants::physics::MassKPlus}); });
+                           [](float px0, float py0, float pz0, float px1, float py1, float pz1) -> float { return RecoDecay::m<constants::physics::MassPiPlus, constants::physics::MassKPlus>(std::array{std::array{px0, py0, pz0}, std::array{px1, py1, pz1}}); });
 DECLARE_SOA_DYNAMIC_COLUMN(InvMass2D0, invMass2D0,
-                           [](float px0, float py0, float pz0, float px1, float py1, float pz1) -> float { return RecoDecay::m2(std::array{std::array{px0, py0, pz0}, std::array{px1, py1, pz1}}, std::array{constants::physics::MassPiPlus, constants::physics::MassKPlus}); });
+                           [](float px0, float py0, float pz0, float px1, float py1, float pz1) -> float { return RecoDecay::m2<constants::physics::MassPiPlus, constants::physics::MassKPlus>(std::array{std::array{px0, py0, pz0}, std::array{px1, py1, pz1}}); });
 DECLARE_SOA_DYNAMIC_COLUMN(CosThetaStarD0, cosThetaStarD0,
                            [](float px0, float py0, float pz0, float px1, float py1, float pz1) -> float { return RecoDecay::cosThetaStar(std::array{std::array{px0, py0, pz0}, std::array{px1, py1, pz1}}, std::array{constants::physics::MassPiPlus, constants::physics::MassKPlus}, constants::physics::MassD0, 1); });
 // Dynamic Columns for D0Bar candidate using PDG masses of daughters
 DECLARE_SOA_DYNAMIC_COLUMN(InvMassD0Bar, invMassD0Bar,
-                           [](float px0, float py0, float pz0, float px1, float py1, float pz1) -> float { return RecoDecay::m(std::array{std::array{px0, py0, pz0}, std::array{px1, py1, pz1}}, std::array{constants::physics::MassKPlus, constants::physics::MassPiPlus}); });
+                           [](float px0, float py0, float pz0, float px1, float py1, float pz1) -> float { return RecoDecay::m<constants::physics::MassKPlus, constants::physics::MassPiPlus>(std::array{std::array{px0, py0, pz0}, std::array{px1, py1, pz1}}); });
 DECLARE_SOA_DYNAMIC_COLUMN(InvMass2D0Bar, invMass2D0Bar,
-                           [](float px0, float py0, float pz0, float px1, float py1, float pz1) -> float { return RecoDecay::m2(std::array{std::array{px0, py0, pz0}, std::array{px1, py1, pz1}}, std::array{constants::physics::MassKPlus, constants::physics::MassPiPlus}); });
+                           [](float px0, float py0, float pz0, float px1, float py1, float pz1) -> float { return RecoDecay::m2<constants::physics::MassKPlus, constants::physics::MassPiPlus>(std::array{std::array{px0, py0, pz0}, std::array{px1, py1, pz1}}); });
 DECLARE_SOA_DYNAMIC_COLUMN(CosThetaStarD0Bar, cosThetaStarD0Bar,
                            [](float px0, float py0, float pz0, float px1, float py1, float pz1) -> float { return RecoDecay::cosThetaStar(std::array{std::array{px0, py0, pz0}, std::array{px1, py1, pz1}}, std::array{constants::physics::MassKPlus, constants::physics::MassPiPlus}, constants::physics::MassD0, 0); });
 DECLARE_SOA_DYNAMIC_COLUMN(ImpactParameterProngSqSumD0, impactParameterProngSqSumD0,
@@ -1767,11 +1807,11 @@ DECLARE_SOA_EXPRESSION_COLUMN(PzDstar, pzDstar, float, 1.f * aod::hf_cand::pzPro
 // Inv Mass (accept mass array of size 3 {π , π, k})
 DECLARE_SOA_DYNAMIC_COLUMN(InvMassDstar, invMassDstar,
                            [](float pxSoftPi, float pySoftPi, float pzSoftPi, float pxProng0, float pyProng0, float pzProng0, float pxProng1, float pyProng1, float pzProng1)
-                             -> float { return RecoDecay::m(std::array{std::array{pxSoftPi, pySoftPi, pzSoftPi}, std::array{pxProng0, pyProng0, pzProng0}, std::array{pxProng1, pyProng1, pzProng1}}, std::array{constants::physics::MassPiPlus, constants::physics::MassPiPlus, constants::physics::MassKPlus}); });
+                             -> float { return RecoDecay::m<constants::physics::MassPiPlus, constants::physics::MassPiPlus, constants::physics::MassKPlus>(std::array{std::array{pxSoftPi, pySoftPi, pzSoftPi}, std::array{pxProng0, pyProng0, pzProng0}, std::array{pxProng1, pyProng1, pzProng1}}); });
 
 DECLARE_SOA_DYNAMIC_COLUMN(InvMassAntiDstar, invMassAntiDstar,
                            [](float pxSoftPi, float pySoftPi, float pzSoftPi, float pxProng0, float pyProng0, float pzProng0, float pxProng1, float pyProng1, float pzProng1)
-                             -> float { return RecoDecay::m(std::array{std::array{pxSoftPi, pySoftPi, pzSoftPi}, std::array{pxProng0, pyProng0, pzProng0}, std::array{pxProng1, pyProng1, pzProng1}}, std::array{constants::physics::MassPiPlus, constants::physics::MassKPlus, constants::physics::MassPiPlus}); });
+                             -> float { return RecoDecay::m<constants::physics::MassPiPlus, constants::physics::MassKPlus, constants::physics::MassPiPlus>(std::array{std::array{pxSoftPi, pySoftPi, pzSoftPi}, std::array{pxProng0, pyProng0, pzProng0}, std::array{pxProng1, pyProng1, pzProng1}}); });
 
 DECLARE_SOA_DYNAMIC_COLUMN(PtSoftPi, ptSoftPi, [](float pxSoftPi, float pySoftPi) -> float { return RecoDecay::pt(pxSoftPi, pySoftPi); });
 DECLARE_SOA_DYNAMIC_COLUMN(PVecSoftPi, pVecSoftPi, [](float px, float py, float pz) -> std::array<float, 3> { return std::array{px, py, pz}; });
@@ -173,6 +173,52 @@ DECLARE_SOA_TABLE(TrackRecoInfo, "AOD", "TRACKRECOINFO", //! Tracks Reconstructe
                   aod::hf_correlation_ds_hadron::TrackDcaZ,
                   aod::hf_correlation_ds_hadron::TrackTPCNClsCrossedRows);
 
+// definition of columns and tables for the HF-hadron correlations aggregated per candidate (see PWGHF/Utils/utilsCorrelations.h)
+namespace hf_correlation_binned
+{
+DECLARE_SOA_COLUMN(PtD, ptD, float);                          //! Transverse momentum of the HF candidate
+DECLARE_SOA_COLUMN(MD, mD, float);                            //! Invariant mass of the HF candidate
+DECLARE_SOA_COLUMN(MDbar, mDbar, float);                      //! Invariant mass of the HF candidate, second hypothesis (D0bar)
+DECLARE_SOA_COLUMN(SignalStatus, signalStatus, int);          //! Tag for D0,D0bar
+DECLARE_SOA_COLUMN(MlScorePrompt, mlScorePrompt, float);      //! ML prompt score of the HF candidate
+DECLARE_SOA_COLUMN(MlScoreBkg, mlScoreBkg, float);            //! ML background score of the HF candidate
+DECLARE_SOA_COLUMN(PoolBin, poolBin, int);                    //! Pool Bin of event defined using zvtx and multiplicity
+DECLARE_SOA_COLUMN(PairCells, pairCells, std::vector<int>);   //! (Delta phi, Delta eta, pT hadron) cells of the pairs
+DECLARE_SOA_COLUMN(PairCounts, pairCounts, std::vector<int>); //! Number of pairs in each cell
+} // namespace hf_correlation_binned
+
+DECLARE_SOA_TABLE(DHadronBinnedPair, "AOD", "DHBINNEDPAIR", //! D0-Hadrons pairs aggregated per D0 candidate
+                  aod::hf_correlation_binned::PtD,
+                  aod::hf_correlation_binned::MD,
+                  aod::hf_correlation_binned::MDbar,
+                  aod::hf_correlation_binned::SignalStatus,
+                  aod::hf_correlation_binned::PoolBin,
+                  aod::hf_correlation_binned::PairCells,
+                  aod::hf_correlation_binned::PairCounts);
+
+DECLARE_SOA_TABLE(DplusHadronBinnedPair, "AOD", "DPLUSHBINNED", //! D+-Hadrons pairs aggregated per D+ candidate
+                  aod::hf_correlation_binned::PtD,
+                  aod::hf_correlation_binned::MD,
+                  aod::hf_correlation_binned::PoolBin,
+                  aod::hf_correlation_binned::PairCells,
+                  aod::hf_correlation_binned::PairCounts);
+
+DECLARE_SOA_TABLE(DsHadronBinnedPair, "AOD", "DSHBINNEDPAIR", //! Ds-Hadrons pairs aggregated per Ds candidate
+                  aod::hf_correlation_binned::PtD,
+                  aod::hf_correlation_binned::MD,
+                  aod::hf_correlation_binned::MlScorePrompt,
+                  aod::hf_correlation_binned::MlScoreBkg,
+                  aod::hf_correlation_binned::PoolBin,
+                  aod::hf_correlation_binned::PairCells,
+                  aod::hf_correlation_binned::PairCounts);
+
+DECLARE_SOA_TABLE(LcHadronBinnedPair, "AOD", "LCHBINNEDPAIR", //! Lc-Hadrons pairs aggregated per Lc candidate and mass hypothesis
+                  aod::hf_correlation_binned::PtD,
+                  aod::hf_correlation_binned::MD,
+                  aod::hf_correlation_binned::PoolBin,
+                  aod::hf_correlation_binned::PairCells,
+                  aod::hf_correlation_binned::PairCounts);
+
 // definition of columns and tables for Dplus properties
 namespace hf_dplus_meson
 {
@@ -29,6 +29,7 @@
 #include "PWGHF/DataModel/CandidateReconstructionTables.h"
 #include "PWGHF/DataModel/CandidateSelectionTables.h"
 #include "PWGHF/HFC/DataModel/CorrelationTables.h"
+#include "PWGHF/Utils/utilsCorrelations.h"
 
 using namespace o2;
 using namespace o2::analysis;
@@ -169,6 +170,7 @@ struct HfCorrelatorD0Hadrons {
 
   Produces<aod::DHadronPair> entryD0HadronPair;
   Produces<aod::DHadronRecoInfo> entryD0HadronRecoInfo;
+  Produces<aod::DHadronBinnedPair> entryD0HadronBinnedPair;
 
   Configurable<int> selectionFlagD0{"selectionFlagD0", 1, "Selection Flag for D0"};
   Configurable<int> selectionFlagD0bar{"selectionFlagD0bar", 1, "Selection Flag for D0bar"};
@@ -187,7 +189,13 @@ struct HfCorrelatorD0Hadrons {
   Configurable<bool> correlateD0WithLeadingParticle{"correlateD0WithLeadingParticle", false, "Switch for correlation of D0 mesons with leading particle only"};
   Configurable<bool> storeAutoCorrelationFlag{"storeAutoCorrelationFlag", false, "Store flag that indicates if the track is paired to its D-meson mother instead of skipping it"};
 
+  o2::analysis::hf_correlations::HfBinnedCorrelations binnedPairs; // binning of the pairs aggregated per candidate
+
   HfHelper hfHelper;
+  o2::analysis::hf_correlations::BinnedAssociatedHadrons binnedHadrons;
+  std::vector<int64_t> excludedTracks; // daughters and soft pions of the current candidate
+  std::vector<int> pairCells;
+  std::vector<int> pairCounts;
 
   int leadingIndex = 0;
   double massD0{0.};
@@ -265,6 +273,11 @@ struct HfCorrelatorD0Hadrons {
     // mass histogram for D0bar background candidates only
     registry.add("hMassD0barRecBg", "D0bar background candidates - MC reco;inv. mass D0bar only (#pi K) (GeV/#it{c}^{2});entries", {HistType::kTH2F, {{massAxisNBins, massAxisMin, massAxisMax}, {vbins, "#it{p}_{T} (GeV/#it{c})"}}});
     registry.add("hCountD0TriggersGen", "D0 trigger particles - MC gen;;N of trigger D0", {HistType::kTH2F, {{1, -0.5, 0.5}, {vbins, "#it{p}_{T} (GeV/#it{c})"}}});
+
+    binnedPairs.init();
+    if (doprocessDataBinned && (correlateD0WithLeadingParticle || storeAutoCorrelationFlag)) {
+      LOGF(fatal, "processDataBinned removes the D0 daughters and correlates with all the hadrons, please disable correlateD0WithLeadingParticle and storeAutoCorrelationFlag!!");
+    }
   }
 
   // Find Leading Particle
@@ -286,9 +299,10 @@ struct HfCorrelatorD0Hadrons {
   // =======  Process starts for Data, Same event ============
 
   /// D0-h correlation pair builder - for real data and data-like analysis (i.e. reco-level w/o matching request via MC truth)
-  void processData(soa::Join<aod::Collisions, aod::Mults>::iterator const& collision,
-                   aod::TracksWDca const& tracks,
-                   soa::Join<aod::HfCand2Prong, aod::HfSelD0> const&)
+  /// \tparam binned  aggregate the pairs per candidate instead of writing one row per pair
+  template <bool binned>
+  void fillCorrelationsData(soa::Join<aod::Collisions, aod::Mults>::iterator const& collision,
+                            aod::TracksWDca const& tracks)
   {
     // protection against empty tables to be sliced
     if (selectedD0Candidates.size() == 0) {
@@ -318,6 +332,16 @@ struct HfCorrelatorD0Hadrons {
     }
     registry.fill(HIST("hMultiplicity"), nTracks);
 
+    if constexpr (binned) {
+      binnedHadrons.clear();
+      for (const auto& track : tracks) {
+        if (std::abs(track.dcaXY()) < 1. && std::abs(track.dcaZ()) < 1.) {
+          binnedHadrons.add(binnedPairs.layout, track.globalIndex(), track.phi(), track.eta(), track.pt());
+        }
+      }
+      binnedHadrons.finalize();
+    }
+
     auto selectedD0CandidatesGrouped = selectedD0Candidates->sliceByCached(aod::hf_cand::collisionId, collision.globalIndex(), cache);
 
     for (const auto& candidate1 : selectedD0CandidatesGrouped) {
@@ -362,6 +386,34 @@ struct HfCorrelatorD0Hadrons {
       registry.fill(HIST("hSelectionStatus"), candidate1.isSelD0bar() + (candidate1.isSelD0() * 2));
       registry.fill(HIST("hD0Bin"), poolBin);
 
+      if constexpr (binned) {
+        // the soft pions are removed like the daughters, the other pairs share the signal status of the candidate
+        excludedTracks = {candidate1.prong0Id(), candidate1.prong1Id()};
+        for (const auto& track : tracks) {
+          if (std::abs(track.dcaXY()) >= 1. || std::abs(track.dcaZ()) >= 1.) {
+            continue;
+          }
+          auto pSum2 = RecoDecay::p2(candidate1.pVector(), track.pVector());
+          auto ePion = track.energy(massPi);
+          double invMassDstar1 = std::sqrt((ePiK + ePion) * (ePiK + ePion) - pSum2);
+          double invMassDstar2 = std::sqrt((eKPi + ePion) * (eKPi + ePion) - pSum2);
+          if ((candidate1.isSelD0() >= selectionFlagD0 && (std::abs(invMassDstar1 - hfHelper.invMassD0ToPiK(candidate1)) - softPiMass) < ptSoftPionMax) ||
+              (candidate1.isSelD0bar() >= selectionFlagD0bar && (std::abs(invMassDstar2 - hfHelper.invMassD0barToKPi(candidate1)) - softPiMass) < ptSoftPionMax)) {
+            excludedTracks.push_back(track.globalIndex());
+          }
+        }
+        int signalStatus = 0;
+        if (candidate1.isSelD0() >= selectionFlagD0) {
+          signalStatus += aod::hf_correlation_d0_hadron::ParticleTypeData::D0Only;
+        }
+        if (candidate1.isSelD0bar() >= selectionFlagD0bar) {
+          signalStatus += aod::hf_correlation_d0_hadron::ParticleTypeData::D0barOnly;
+        }
+        binnedHadrons.correlate(binnedPairs.layout, candidate1.phi(), candidate1.eta(), excludedTracks, pairCells, pairCounts);
+        entryD0HadronBinnedPair(candidate1.pt(), hfHelper.invMassD0ToPiK(candidate1), hfHelper.invMassD0barToKPi(candidate1), signalStatus, poolBin, pairCells, pairCounts);
+        continue;
+      }
+
       // ============ D-h correlation dedicated section ==================================
 
       // ========================== track loop starts here ================================
@@ -429,8 +481,24 @@ struct HfCorrelatorD0Hadrons {
 
     } // end outer loop
   }
+
+  void processData(soa::Join<aod::Collisions, aod::Mults>::iterator const& collision,
+                   aod::TracksWDca const& tracks,
+                   soa::Join<aod::HfCand2Prong, aod::HfSelD0> const&)
+  {
+    fillCorrelationsData<false>(collision, tracks);
+  }
   PROCESS_SWITCH(HfCorrelatorD0Hadrons, processData, "Process data", false);
 
+  /// D0-h correlations aggregated per candidate, with the hadrons binned once per event
+  void processDataBinned(soa::Join<aod::Collisions, aod::Mults>::iterator const& collision,
+                         aod::TracksWDca const& tracks,
+                         soa::Join<aod::HfCand2Prong, aod::HfSelD0> const&)
+  {
+    fillCorrelationsData<true>(collision, tracks);
+  }
+  PROCESS_SWITCH(HfCorrelatorD0Hadrons, processDataBinned, "Process data, pairs aggregated per candidate", false);
+
   // ================  Process starts for MCRec, same event ========================
 
   void processMcRec(soa::Join<aod::Collisions, aod::Mults>::iterator const& collision,
@@ -27,6 +27,7 @@
 #include "PWGHF/DataModel/CandidateReconstructionTables.h"
 #include "PWGHF/DataModel/CandidateSelectionTables.h"
 #include "PWGHF/HFC/DataModel/CorrelationTables.h"
+#include "PWGHF/Utils/utilsCorrelations.h"
 
 using namespace o2;
 using namespace o2::analysis;
@@ -138,6 +139,7 @@ struct HfCorrelatorDplusHadrons {
   Produces<aod::DplusHadronRecoInfo> entryDplusHadronRecoInfo;
   Produces<aod::Dplus> entryDplus;
   Produces<aod::Hadron> entryHadron;
+  Produces<aod::DplusHadronBinnedPair> entryDplusHadronBinnedPair;
 
   Configurable<int> selectionFlagDplus{"selectionFlagDplus", 7, "Selection Flag for Dplus"}; // 7 corresponds to topo+PID cuts
   Configurable<int> applyEfficiency{"applyEfficiency", 1, "Flag for applying D-meson efficiency weights"};
@@ -156,9 +158,15 @@ struct HfCorrelatorDplusHadrons {
   ConfigurableAxis binsZVtx{"binsZVtx", {VARIABLE_WIDTH, -10.0f, -2.5f, 2.5f, 10.0f}, "Mixing bins - z-vertex"};
   ConfigurableAxis binsMultiplicityMc{"binsMultiplicityMc", {VARIABLE_WIDTH, 0.0f, 20.0f, 50.0f, 500.0f}, "Mixing bins - MC multiplicity"}; // In MCGen multiplicity is defined by counting tracks
 
+  o2::analysis::hf_correlations::HfBinnedCorrelations binnedPairs; // binning of the pairs aggregated per candidate
+
   HfHelper hfHelper;
   SliceCache cache;
   BinningType corrBinning{{binsZVtx, binsMultiplicity}, true};
+  o2::analysis::hf_correlations::BinnedAssociatedHadrons binnedHadrons;
+  std::vector<int64_t> excludedTracks;
+  std::vector<int> pairCells;
+  std::vector<int> pairCounts;
 
   // Event Mixing for the Data Mode
   using SelCollisionsWithDplus = soa::Filtered<soa::Join<aod::Collisions, aod::Mults, aod::DmesonSelection>>;
@@ -220,12 +228,15 @@ struct HfCorrelatorDplusHadrons {
     registry.add("hMassDplusMCRecBkg", "Dplus background candidates - MC reco;inv. mass (#pi K) (GeV/#it{c}^{2});entries", {HistType::kTH2F, {{massAxisBins, massAxisMin, massAxisMax}, {vbins, "#it{p}_{T} (GeV/#it{c})"}}});
     registry.add("hcountDplustriggersMCGen", "Dplus trigger particles - MC gen;;N of trigger Dplus", {HistType::kTH2F, {{1, -0.5, 0.5}, {vbins, "#it{p}_{T} (GeV/#it{c})"}}});
     corrBinning = {{binsZVtx, binsMultiplicity}, true};
+    binnedPairs.init();
   }
 
   /// Dplus-hadron correlation pair builder - for real data and data-like analysis (i.e. reco-level w/o matching request via MC truth)
-  void processData(SelCollisionsWithDplus::iterator const& collision,
-                   TracksWithDca const& tracks,
-                   CandidatesDplusData const& candidates, aod::BCsWithTimestamps const&)
+  /// \tparam binned  aggregate the pairs per candidate instead of writing one row per pair
+  template <bool binned>
+  void fillCorrelationsData(SelCollisionsWithDplus::iterator const& collision,
+                            TracksWithDca const& tracks,
+                            CandidatesDplusData const& candidates)
   {
     auto bc = collision.bc_as<aod::BCsWithTimestamps>();
     int gCollisionId = collision.globalIndex();
@@ -249,6 +260,16 @@ struct HfCorrelatorDplusHadrons {
       }
       registry.fill(HIST("hMultiplicity"), nTracks);
 
+      if constexpr (binned) {
+        binnedHadrons.clear();
+        for (const auto& track : tracks) {
+          if (track.isGlobalTrackWoDCA()) {
+            binnedHadrons.add(binnedPairs.layout, track.globalIndex(), track.phi(), track.eta(), track.pt());
+          }
+        }
+        binnedHadrons.finalize();
+      }
+
       int cntDplus = 0;
       for (const auto& candidate : candidates) {
         if (std::abs(hfHelper.yDplus(candidate)) >= yCandMax || candidate.pt() <= ptCandMin || candidate.pt() >= ptTrackMax) {
@@ -271,6 +292,13 @@ struct HfCorrelatorDplusHadrons {
         registry.fill(HIST("hSelectionStatus"), candidate.isSelDplusToPiKPi());
         registry.fill(HIST("hDplusBin"), poolBin);
         entryDplus(candidate.phi(), candidate.eta(), candidate.pt(), hfHelper.invMassDplusToPiKPi(candidate), poolBin, gCollisionId, timeStamp);
+        if constexpr (binned) {
+          excludedTracks = {candidate.prong0Id(), candidate.prong1Id(), candidate.prong2Id()};
+          binnedHadrons.correlate(binnedPairs.layout, candidate.phi(), candidate.eta(), excludedTracks, pairCells, pairCounts);
+          entryDplusHadronBinnedPair(candidate.pt(), hfHelper.invMassDplusToPiKPi(candidate), poolBin, pairCells, pairCounts);
+          cntDplus++;
+          continue;
+        }
         // Dplus-Hadron correlation dedicated section
         // if the candidate is a Dplus, search for Hadrons and evaluate correlations
         for (const auto& track : tracks) {
@@ -296,8 +324,24 @@ struct HfCorrelatorDplusHadrons {
       registry.fill(HIST("hMultFT0M"), collision.multFT0M());
     }
   }
+
+  void processData(SelCollisionsWithDplus::iterator const& collision,
+                   TracksWithDca const& tracks,
+                   CandidatesDplusData const& candidates, aod::BCsWithTimestamps const&)
+  {
+    fillCorrelationsData<false>(collision, tracks, candidates);
+  }
   PROCESS_SWITCH(HfCorrelatorDplusHadrons, processData, "Process data", false);
 
+  /// Dplus-hadron correlations aggregated per candidate, with the hadrons binned once per event
+  void processDataBinned(SelCollisionsWithDplus::iterator const& collision,
+                         TracksWithDca const& tracks,
+                         CandidatesDplusData const& candidates, aod::BCsWithTimestamps const&)
+  {
+    fillCorrelationsData<true>(collision, tracks, candidates);
+  }
+  PROCESS_SWITCH(HfCorrelatorDplusHadrons, processDataBinned, "Process data, pairs aggregated per candidate", false);
+
   /// Dplus-Hadron correlation pair builder - for MC reco-level analysis (candidates matched to true signal only, but also the various bkg sources are studied)
   void processMcRec(SelCollisionsWithDplus::iterator const& collision,
                     TracksWithDca const& tracks,
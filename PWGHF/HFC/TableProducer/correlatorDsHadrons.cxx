@@ -29,6 +29,7 @@
 #include "PWGHF/DataModel/CandidateReconstructionTables.h"
 #include "PWGHF/DataModel/CandidateSelectionTables.h"
 #include "PWGHF/HFC/DataModel/CorrelationTables.h"
+#include "PWGHF/Utils/utilsCorrelations.h"
 
 using namespace o2;
 using namespace o2::analysis;
@@ -151,6 +152,7 @@ struct HfCorrelatorDsHadrons {
   Produces<aod::DsCandRecoInfo> entryDsCandRecoInfo;
   Produces<aod::DsCandGenInfo> entryDsCandGenInfo;
   Produces<aod::TrackRecoInfo> entryTrackRecoInfo;
+  Produces<aod::DsHadronBinnedPair> entryDsHadronBinnedPair;
 
   Configurable<int> selectionFlagDs{"selectionFlagDs", 7, "Selection Flag for Ds"};
   Configurable<int> numberEventsMixed{"numberEventsMixed", 5, "Number of events mixed in ME process"};
@@ -181,8 +183,14 @@ struct HfCorrelatorDsHadrons {
   ConfigurableAxis binsBdtScore{"binsBdtScore", {100, 0., 1.}, "Bdt output scores"};
   ConfigurableAxis binsPoolBin{"binsPoolBin", {9, 0., 9.}, "PoolBin"};
 
+  o2::analysis::hf_correlations::HfBinnedCorrelations binnedPairs; // binning of the pairs aggregated per candidate
+
   HfHelper hfHelper;
   SliceCache cache;
+  o2::analysis::hf_correlations::BinnedAssociatedHadrons binnedHadrons;
+  std::vector<int64_t> excludedTracks;
+  std::vector<int> pairCells;
+  std::vector<int> pairCounts;
 
   using SelCollisionsWithDs = soa::Filtered<soa::Join<aod::Collisions, aod::Mults, aod::EvSels, aod::DmesonSelection>>;            // collisionFilter applied
   using SelCollisionsWithDsMc = soa::Filtered<soa::Join<aod::McCollisions, aod::DmesonSelection, aod::MultsExtraMC>>;              // collisionFilter applied
@@ -259,6 +267,8 @@ struct HfCorrelatorDsHadrons {
     registry.add("hEtaMcGen", "Ds,Hadron particles - MC Gen", {HistType::kTH1F, {axisEta}});
     registry.add("hPhiMcGen", "Ds,Hadron particles - MC Gen", {HistType::kTH1F, {axisPhi}});
     registry.add("hMultFT0AMcGen", "Ds,Hadron multiplicity FT0A - MC Gen", {HistType::kTH1F, {axisMultiplicity}});
+
+    binnedPairs.init();
   }
 
   /// Fill histograms of quantities independent from the daugther-mass hypothesis for data
@@ -343,9 +353,11 @@ struct HfCorrelatorDsHadrons {
   }
 
   /// Ds-hadron correlation pair builder - for real data and data-like analysis (i.e. reco-level w/o matching request via MC truth)
-  void processData(SelCollisionsWithDs::iterator const& collision,
-                   CandDsData const& candidates,
-                   MyTracksData const& tracks)
+  /// \tparam binned  aggregate the pairs per candidate instead of writing one row per pair
+  template <bool binned>
+  void fillCorrelationsData(SelCollisionsWithDs::iterator const& collision,
+                            CandDsData const& candidates,
+                            MyTracksData const& tracks)
   {
     BinningType corrBinning{{zPoolBins, multPoolBins}, true};
     registry.fill(HIST("hZVtx"), collision.posZ());
@@ -355,6 +367,16 @@ struct HfCorrelatorDsHadrons {
     int nTracks = tracks.size();
     registry.fill(HIST("hMultiplicity"), nTracks);
 
+    if constexpr (binned) {
+      binnedHadrons.clear();
+      for (const auto& track : tracks) {
+        if (track.isGlobalTrackWoDCA()) {
+          binnedHadrons.add(binnedPairs.layout, track.globalIndex(), track.phi(), track.eta(), track.pt());
+        }
+      }
+      binnedHadrons.finalize();
+    }
+
     // Ds fill histograms and Ds-Hadron correlation for DsToKKPi
     for (const auto& candidate : candidates) {
       if (std::abs(hfHelper.yDs(candidate)) > yCandMax || candidate.pt() < ptCandMin || candidate.pt() > ptCandMax) {
@@ -383,6 +405,17 @@ struct HfCorrelatorDsHadrons {
         registry.fill(HIST("hCountSelectionStatusDsToKKPiAndToPiKK"), 0.);
       }
 
+      if constexpr (binned) {
+        excludedTracks = {candidate.prong0Id(), candidate.prong1Id(), candidate.prong2Id()};
+        binnedHadrons.correlate(binnedPairs.layout, candidate.phi(), candidate.eta(), excludedTracks, pairCells, pairCounts);
+        if (candidate.isSelDsToKKPi() >= selectionFlagDs) {
+          entryDsHadronBinnedPair(candidate.pt(), hfHelper.invMassDsToKKPi(candidate), outputMl[0], outputMl[2], poolBin, pairCells, pairCounts);
+        } else if (candidate.isSelDsToPiKK() >= selectionFlagDs) {
+          entryDsHadronBinnedPair(candidate.pt(), hfHelper.invMassDsToPiKK(candidate), outputMl[0], outputMl[2], poolBin, pairCells, pairCounts);
+        }
+        continue;
+      }
+
       // Ds-Hadron correlation dedicated section
       for (const auto& track : tracks) {
         // Removing Ds daughters by checking track indices
@@ -419,8 +452,24 @@ struct HfCorrelatorDsHadrons {
       } // end track loop
     }   // end candidate loop
   }
+
+  void processData(SelCollisionsWithDs::iterator const& collision,
+                   CandDsData const& candidates,
+                   MyTracksData const& tracks)
+  {
+    fillCorrelationsData<false>(collision, candidates, tracks);
+  }
   PROCESS_SWITCH(HfCorrelatorDsHadrons, processData, "Process data", true);
 
+  /// Ds-hadron correlations aggregated per candidate, with the hadrons binned once per event
+  void processDataBinned(SelCollisionsWithDs::iterator const& collision,
+                         CandDsData const& candidates,
+                         MyTracksData const& tracks)
+  {
+    fillCorrelationsData<true>(collision, candidates, tracks);
+  }
+  PROCESS_SWITCH(HfCorrelatorDsHadrons, processDataBinned, "Process data, pairs aggregated per candidate", false);
+
   /// Ds-Hadron correlation pair builder - for MC reco-level analysis (candidates matched to true signal only, but also the various bkg sources are studied)
   void processMcRec(SelCollisionsWithDs::iterator const& collision,
                     CandDsMcReco const& candidates,
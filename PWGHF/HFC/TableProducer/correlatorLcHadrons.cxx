@@ -30,6 +30,7 @@
 #include "PWGHF/DataModel/CandidateReconstructionTables.h"
 #include "PWGHF/DataModel/CandidateSelectionTables.h"
 #include "PWGHF/HFC/DataModel/CorrelationTables.h"
+#include "PWGHF/Utils/utilsCorrelations.h"
 
 using namespace o2;
 using namespace o2::analysis;
@@ -169,6 +170,7 @@ struct HfCorrelatorLcHadronsSelection {
 struct HfCorrelatorLcHadrons {
   Produces<aod::LcHadronPair> entryLcHadronPair;
   Produces<aod::LcHadronRecoInfo> entryLcHadronRecoInfo;
+  Produces<aod::LcHadronBinnedPair> entryLcHadronBinnedPair;
 
   Configurable<int> selectionFlagLc{"selectionFlagLc", 1, "Selection Flag for Lc"};
   Configurable<int> applyEfficiency{"applyEfficiency", 1, "Flag for applying Lc efficiency weights"};
@@ -190,9 +192,15 @@ struct HfCorrelatorLcHadrons {
   ConfigurableAxis binsZVtx{"binsZVtx", {VARIABLE_WIDTH, -10.0f, -2.5f, 2.5f, 10.0f}, "Mixing bins - z-vertex"};
   ConfigurableAxis binsMultiplicityMc{"binsMultiplicityMc", {VARIABLE_WIDTH, 0.0f, 20.0f, 50.0f, 500.0f}, "Mixing bins - MC multiplicity"}; // In MCGen multiplicity is defined by counting tracks
 
+  o2::analysis::hf_correlations::HfBinnedCorrelations binnedPairs; // binning of the pairs aggregated per candidate
+
   HfHelper hfHelper;
   SliceCache cache;
   BinningType corrBinning{{binsZVtx, binsMultiplicity}, true};
+  o2::analysis::hf_correlations::BinnedAssociatedHadrons binnedHadrons;
+  std::vector<int64_t> excludedTracks;
+  std::vector<int> pairCells;
+  std::vector<int> pairCounts;
 
   // Filters for ME
   Filter collisionFilter = aod::hf_selection_lc_collision::lcSel >= filterFlagLc;
@@ -252,12 +260,14 @@ struct HfCorrelatorLcHadrons {
     registry.add("hMassLcMcRecBkg", "Lc background candidates - Mc reco;inv. mass (p k #pi) (GeV/#it{c}^{2});entries", {HistType::kTH2F, {{massAxisBins, massAxisMin, massAxisMax}, {vbins, "#it{p}_{T} (GeV/#it{c})"}}});
     registry.add("hCountLctriggersMcGen", "Lc trigger particles - Mc gen;;N of trigger Lc", {HistType::kTH2F, {{1, -0.5, 0.5}, {vbins, "#it{p}_{T} (GeV/#it{c})"}}});
     corrBinning = {{binsZVtx, binsMultiplicity}, true};
+    binnedPairs.init();
   }
 
   /// Lc-h correlation pair builder - for real data and data-like analysis (i.e. reco-level w/o matching request via Mc truth)
-  void processData(soa::Join<aod::Collisions, aod::Mults>::iterator const& collision,
-                   aod::TracksWDca const& tracks,
-                   soa::Join<aod::HfCand3Prong, aod::HfSelLc> const&)
+  /// \tparam binned  aggregate the pairs per candidate instead of writing one row per pair
+  template <bool binned>
+  void fillCorrelationsData(soa::Join<aod::Collisions, aod::Mults>::iterator const& collision,
+                            aod::TracksWDca const& tracks)
   {
     // protection against empty tables to be sliced
     if (selectedLcCandidates.size() == 0) {
@@ -283,6 +293,17 @@ struct HfCorrelatorLcHadrons {
     }
     registry.fill(HIST("hMultiplicity"), nTracks);
 
+    if constexpr (binned) {
+      binnedHadrons.clear();
+      for (const auto& track : tracks) {
+        if (std::abs(track.eta()) > etaTrackMax || track.pt() < ptTrackMin || std::abs(track.dcaXY()) >= dcaXYTrackMax || std::abs(track.dcaZ()) >= dcaZTrackMax) {
+          continue;
+        }
+        binnedHadrons.add(binnedPairs.layout, track.globalIndex(), track.phi(), track.eta(), track.pt());
+      }
+      binnedHadrons.finalize();
+    }
+
     auto selectedLcCandidatesGrouped = selectedLcCandidates->sliceByCached(aod::hf_cand::collisionId, collision.globalIndex(), cache);
 
     for (const auto& candidate : selectedLcCandidatesGrouped) {
@@ -322,6 +343,17 @@ struct HfCorrelatorLcHadrons {
         registry.fill(HIST("hMassLcData"), hfHelper.invMassLcToPiKP(candidate), efficiencyWeight);
         registry.fill(HIST("hSelectionStatusLcToPiKP"), candidate.isSelLcToPiKP());
       }
+      if constexpr (binned) {
+        excludedTracks = {candidate.prong0Id(), candidate.prong1Id(), candidate.prong2Id()};
+        binnedHadrons.correlate(binnedPairs.layout, candidate.phi(), candidate.eta(), excludedTracks, pairCells, pairCounts);
+        if (candidate.isSelLcToPKPi() >= selectionFlagLc) {
+          entryLcHadronBinnedPair(candidate.pt(), hfHelper.invMassLcToPKPi(candidate), poolBin, pairCells, pairCounts);
+        }
+        if (candidate.isSelLcToPiKP() >= selectionFlagLc) {
+          entryLcHadronBinnedPair(candidate.pt(), hfHelper.invMassLcToPiKP(candidate), poolBin, pairCells, pairCounts);
+        }
+        continue;
+      }
       // Lc-Hadron correlation dedicated section
       // if the candidate is a Lc, search for Hadrons and evaluate correlations
 
@@ -360,8 +392,24 @@ struct HfCorrelatorLcHadrons {
     registry.fill(HIST("hZvtx"), collision.posZ());
     registry.fill(HIST("hMultT0M"), collision.multFT0M());
   }
+
+  void processData(soa::Join<aod::Collisions, aod::Mults>::iterator const& collision,
+                   aod::TracksWDca const& tracks,
+                   soa::Join<aod::HfCand3Prong, aod::HfSelLc> const&)
+  {
+    fillCorrelationsData<false>(collision, tracks);
+  }
   PROCESS_SWITCH(HfCorrelatorLcHadrons, processData, "Process data", true);
 
+  /// Lc-h correlations aggregated per candidate, with the hadrons binned once per event
+  void processDataBinned(soa::Join<aod::Collisions, aod::Mults>::iterator const& collision,
+                         aod::TracksWDca const& tracks,
+                         soa::Join<aod::HfCand3Prong, aod::HfSelLc> const&)
+  {
+    fillCorrelationsData<true>(collision, tracks);
+  }
+  PROCESS_SWITCH(HfCorrelatorLcHadrons, processDataBinned, "Process data, pairs aggregated per candidate", false);
+
   /// Lc-Hadron correlation process starts for McRec
   void processMcRec(soa::Join<aod::Collisions, aod::Mults>::iterator const& collision,
                     aod::TracksWDca const& tracks,
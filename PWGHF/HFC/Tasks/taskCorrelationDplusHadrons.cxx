@@ -19,6 +19,7 @@
 #include "PWGHF/DataModel/CandidateReconstructionTables.h"
 #include "PWGHF/DataModel/CandidateSelectionTables.h"
 #include "PWGHF/Utils/utilsAnalysis.h"
+#include "PWGHF/Utils/utilsCorrelations.h"
 #include "PWGHF/HFC/DataModel/CorrelationTables.h"
 
 using namespace o2;
@@ -89,6 +90,7 @@ struct HfTaskCorrelationDplusHadrons {
   Configurable<std::vector<double>> sidebandRightInner{"sidebandRightInner", std::vector<double>{sidebandRightInner_v}, "Inner values of right sideband vs pT"};
   Configurable<std::vector<double>> sidebandRightOuter{"sidebandRightOuter", std::vector<double>{sidebandRightOuter_v}, "Outer values of right sideband vs pT"};
   Configurable<std::vector<double>> efficiencyD{"efficiencyD", std::vector<double>{efficiencyDmeson}, "Efficiency values for D meson specie under study"};
+  o2::analysis::hf_correlations::HfBinnedCorrelations binnedPairs; // same binning as in the correlator
 
   HistogramRegistry registry{
     "registry",
@@ -137,6 +139,30 @@ struct HfTaskCorrelationDplusHadrons {
     registry.get<THnSparse>(HIST("hCorrel2DVsPtBkgMCRec"))->Sumw2();
     registry.get<THnSparse>(HIST("hCorrel2DVsPtMCGen"))->GetAxis(2)->Set(nBinspTaxis, valuespTaxis);
     registry.get<THnSparse>(HIST("hCorrel2DVsPtMCGen"))->Sumw2();
+
+    binnedPairs.init();
+  }
+
+  /// Fills the correlation plots of the signal region and of the sidebands with one pair, or with the pairs of a cell
+  void fillCorrelationsData(double deltaPhi, double deltaEta, double ptD, double ptHadron, int poolBin, double massD, int pTBinD, double efficiencyWeight)
+  {
+    // check if correlation entry belongs to signal region, sidebands or is outside both, and fill correlation plots
+    if (massD > signalRegionInner->at(pTBinD) && massD < signalRegionOuter->at(pTBinD)) {
+      // in signal region
+      registry.fill(HIST("hCorrel2DVsPtSignalRegion"), deltaPhi, deltaEta, ptD, ptHadron, poolBin, efficiencyWeight);
+      registry.fill(HIST("hCorrel2DPtIntSignalRegion"), deltaPhi, deltaEta, efficiencyWeight);
+      registry.fill(HIST("hDeltaEtaPtIntSignalRegion"), deltaEta, efficiencyWeight);
+      registry.fill(HIST("hDeltaPhiPtIntSignalRegion"), deltaPhi, efficiencyWeight);
+    }
+
+    if ((massD > sidebandLeftOuter->at(pTBinD) && massD < sidebandLeftInner->at(pTBinD)) ||
+        (massD > sidebandRightInner->at(pTBinD) && massD < sidebandRightOuter->at(pTBinD))) {
+      // in sideband region
+      registry.fill(HIST("hCorrel2DVsPtSidebands"), deltaPhi, deltaEta, ptD, ptHadron, poolBin, efficiencyWeight);
+      registry.fill(HIST("hCorrel2DPtIntSidebands"), deltaPhi, deltaEta, efficiencyWeight);
+      registry.fill(HIST("hDeltaEtaPtIntSidebands"), deltaEta, efficiencyWeight);
+      registry.fill(HIST("hDeltaPhiPtIntSidebands"), deltaPhi, efficiencyWeight);
+    }
   }
 
   void processData(aod::DplusHadronPairFull const& pairEntries)
@@ -164,27 +190,39 @@ struct HfTaskCorrelationDplusHadrons {
       if (applyEfficiency) {
         efficiencyWeight = 1. / (efficiencyD->at(effBinD) * efficiencyHadron);
       }
-      // check if correlation entry belongs to signal region, sidebands or is outside both, and fill correlation plots
-      if (massD > signalRegionInner->at(pTBinD) && massD < signalRegionOuter->at(pTBinD)) {
-        // in signal region
-        registry.fill(HIST("hCorrel2DVsPtSignalRegion"), deltaPhi, deltaEta, ptD, ptHadron, poolBin, efficiencyWeight);
-        registry.fill(HIST("hCorrel2DPtIntSignalRegion"), deltaPhi, deltaEta, efficiencyWeight);
-        registry.fill(HIST("hDeltaEtaPtIntSignalRegion"), deltaEta, efficiencyWeight);
-        registry.fill(HIST("hDeltaPhiPtIntSignalRegion"), deltaPhi, efficiencyWeight);
-      }
-
-      if ((massD > sidebandLeftOuter->at(pTBinD) && massD < sidebandLeftInner->at(pTBinD)) ||
-          (massD > sidebandRightInner->at(pTBinD) && massD < sidebandRightOuter->at(pTBinD))) {
-        // in sideband region
-        registry.fill(HIST("hCorrel2DVsPtSidebands"), deltaPhi, deltaEta, ptD, ptHadron, poolBin, efficiencyWeight);
-        registry.fill(HIST("hCorrel2DPtIntSidebands"), deltaPhi, deltaEta, efficiencyWeight);
-        registry.fill(HIST("hDeltaEtaPtIntSidebands"), deltaEta, efficiencyWeight);
-        registry.fill(HIST("hDeltaPhiPtIntSidebands"), deltaPhi, efficiencyWeight);
-      }
+      fillCorrelationsData(deltaPhi, deltaEta, ptD, ptHadron, poolBin, massD, pTBinD, efficiencyWeight);
     } // end loop
   }
   PROCESS_SWITCH(HfTaskCorrelationDplusHadrons, processData, "Process data", false);
 
+  /// Dplus-Hadron correlations from the pairs aggregated per candidate, each cell filled at its bin centres with its count as weight
+  void processDataBinned(aod::DplusHadronBinnedPair const& candidates)
+  {
+    const auto& layout = binnedPairs.layout;
+    for (const auto& candidate : candidates) {
+      double ptD = candidate.ptD();
+      int effBinD = o2::analysis::findBin(binsPtEfficiency, ptD);
+      int pTBinD = o2::analysis::findBin(binsPtCorrelations, ptD);
+      if (pTBinD < 0 || effBinD < 0) {
+        continue;
+      }
+      double efficiencyWeight = 1.;
+      if (applyEfficiency) {
+        efficiencyWeight = 1. / efficiencyD->at(effBinD);
+      }
+      const auto& cells = candidate.pairCells();
+      const auto& counts = candidate.pairCounts();
+      for (size_t i = 0; i < cells.size(); i++) {
+        double ptHadron = layout.ptHadron(cells[i]);
+        if (ptHadron > 10.0) {
+          ptHadron = 10.5;
+        }
+        fillCorrelationsData(layout.deltaPhi(cells[i]), layout.deltaEta(cells[i]), ptD, ptHadron, candidate.poolBin(), candidate.mD(), pTBinD, efficiencyWeight * counts[i]);
+      }
+    }
+  }
+  PROCESS_SWITCH(HfTaskCorrelationDplusHadrons, processDataBinned, "Process data, pairs aggregated per candidate", false);
+
   /// D-Hadron correlation pair filling task, from pair tables - for MC reco-level analysis (candidates matched to true signal only, but also bkg sources are studied)
   void processMcRec(aod::DplusHadronPairFull const& pairEntries)
   {
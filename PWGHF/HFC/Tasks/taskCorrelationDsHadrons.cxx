@@ -22,6 +22,7 @@
 #include "PWGHF/DataModel/CandidateReconstructionTables.h"
 #include "PWGHF/DataModel/CandidateSelectionTables.h"
 #include "PWGHF/Utils/utilsAnalysis.h"
+#include "PWGHF/Utils/utilsCorrelations.h"
 #include "PWGHF/HFC/DataModel/CorrelationTables.h"
 
 using namespace o2;
@@ -71,6 +72,7 @@ struct HfTaskCorrelationDsHadrons {
   ConfigurableAxis binsMultFT0M{"binsMultFT0M", {600, 0., 8000.}, "Multiplicity as FT0M signal amplitude"};
   ConfigurableAxis binsPosZ{"binsPosZ", {100, -10., 10.}, "primary vertex z coordinate"};
   ConfigurableAxis binsPoolBin{"binsPoolBin", {9, 0., 9.}, "PoolBin"};
+  o2::analysis::hf_correlations::HfBinnedCorrelations binnedPairs; // same binning as in the correlator
 
   HfHelper hfHelper;
 
@@ -183,10 +185,12 @@ struct HfTaskCorrelationDsHadrons {
     registry.get<THnSparse>(HIST("hCorrel2DVsPtMcGen"))->Sumw2();
     registry.get<THnSparse>(HIST("hCorrel2DVsPtMcGenPrompt"))->Sumw2();
     registry.get<THnSparse>(HIST("hCorrel2DVsPtMcGenNonPrompt"))->Sumw2();
+
+    binnedPairs.init();
   }
 
-  void processData(DsHadronPairFullWithMl const& pairEntries,
-                   aod::DsCandRecoInfo const& candidates)
+  /// Fills the mass and ML score plots of the selected candidates
+  void fillCandidatesData(aod::DsCandRecoInfo const& candidates)
   {
     for (const auto& candidate : candidates) {
       float massD = candidate.mD();
@@ -206,6 +210,35 @@ struct HfTaskCorrelationDsHadrons {
       registry.fill(HIST("hBdtScorePrompt"), bdtScorePrompt);
       registry.fill(HIST("hBdtScoreBkg"), bdtScoreBkg);
     }
+  }
+
+  /// Fills the correlation plots of the signal region and of the sidebands with one pair, or with the pairs of a cell
+  void fillCorrelationsData(float deltaPhi, float deltaEta, float ptD, float ptHadron, int poolBin, float massD, int ptBinD, double efficiencyWeight)
+  {
+    // in signal region
+    if (massD > signalRegionInner->at(ptBinD) && massD < signalRegionOuter->at(ptBinD)) {
+      registry.fill(HIST("hCorrel2DVsPtSignalRegion"), deltaPhi, deltaEta, ptD, ptHadron, poolBin, efficiencyWeight);
+      registry.fill(HIST("hDeltaEtaPtIntSignalRegion"), deltaEta, efficiencyWeight);
+      registry.fill(HIST("hDeltaPhiPtIntSignalRegion"), deltaPhi, efficiencyWeight);
+    }
+    // in sideband left region
+    if (massD > sidebandLeftOuter->at(ptBinD) && massD < sidebandLeftInner->at(ptBinD)) {
+      registry.fill(HIST("hCorrel2DVsPtSidebandLeft"), deltaPhi, deltaEta, ptD, ptHadron, poolBin, efficiencyWeight);
+      registry.fill(HIST("hDeltaEtaPtIntSidebandLeft"), deltaEta, efficiencyWeight);
+      registry.fill(HIST("hDeltaPhiPtIntSidebandLeft"), deltaPhi, efficiencyWeight);
+    }
+    // in sideband right region
+    if (massD > sidebandRightInner->at(ptBinD) && massD < sidebandRightOuter->at(ptBinD)) {
+      registry.fill(HIST("hCorrel2DVsPtSidebandRight"), deltaPhi, deltaEta, ptD, ptHadron, poolBin, efficiencyWeight);
+      registry.fill(HIST("hDeltaEtaPtIntSidebandRight"), deltaEta, efficiencyWeight);
+      registry.fill(HIST("hDeltaPhiPtIntSidebandRight"), deltaPhi, efficiencyWeight);
+    }
+  }
+
+  void processData(DsHadronPairFullWithMl const& pairEntries,
+                   aod::DsCandRecoInfo const& candidates)
+  {
+    fillCandidatesData(candidates);
 
     for (const auto& pairEntry : pairEntries) {
       // define variables for widely used quantities
@@ -232,28 +265,42 @@ struct HfTaskCorrelationDsHadrons {
       if (applyEfficiency) {
         efficiencyWeight = 1. / (efficiencyD->at(o2::analysis::findBin(binsPtEfficiencyD, ptD)) * efficiencyHad->at(o2::analysis::findBin(binsPtEfficiencyHad, ptHadron)));
       }
+      fillCorrelationsData(deltaPhi, deltaEta, ptD, ptHadron, poolBin, massD, ptBinD, efficiencyWeight);
+    }
+  }
+  PROCESS_SWITCH(HfTaskCorrelationDsHadrons, processData, "Process data", true);
 
-      // in signal region
-      if (massD > signalRegionInner->at(ptBinD) && massD < signalRegionOuter->at(ptBinD)) {
-        registry.fill(HIST("hCorrel2DVsPtSignalRegion"), deltaPhi, deltaEta, ptD, ptHadron, poolBin, efficiencyWeight);
-        registry.fill(HIST("hDeltaEtaPtIntSignalRegion"), deltaEta, efficiencyWeight);
-        registry.fill(HIST("hDeltaPhiPtIntSignalRegion"), deltaPhi, efficiencyWeight);
-      }
-      // in sideband left region
-      if (massD > sidebandLeftOuter->at(ptBinD) && massD < sidebandLeftInner->at(ptBinD)) {
-        registry.fill(HIST("hCorrel2DVsPtSidebandLeft"), deltaPhi, deltaEta, ptD, ptHadron, poolBin, efficiencyWeight);
-        registry.fill(HIST("hDeltaEtaPtIntSidebandLeft"), deltaEta, efficiencyWeight);
-        registry.fill(HIST("hDeltaPhiPtIntSidebandLeft"), deltaPhi, efficiencyWeight);
+  /// Ds-Hadron correlations from the pairs aggregated per candidate, each cell filled at its bin centres with its count as weight.
+  /// The per-pair track cuts (DCA, TPC crossed rows) are those of the correlator.
+  void processDataBinned(aod::DsHadronBinnedPair const& binnedCandidates,
+                         aod::DsCandRecoInfo const& candidates)
+  {
+    fillCandidatesData(candidates);
+
+    const auto& layout = binnedPairs.layout;
+    for (const auto& candidate : binnedCandidates) {
+      float ptD = candidate.ptD();
+      int ptBinD = o2::analysis::findBin(binsPtD, ptD);
+      if (candidate.mlScorePrompt() < mlOutputPrompt->at(ptBinD) || candidate.mlScoreBkg() > mlOutputBkg->at(ptBinD)) {
+        continue;
       }
-      // in sideband right region
-      if (massD > sidebandRightInner->at(ptBinD) && massD < sidebandRightOuter->at(ptBinD)) {
-        registry.fill(HIST("hCorrel2DVsPtSidebandRight"), deltaPhi, deltaEta, ptD, ptHadron, poolBin, efficiencyWeight);
-        registry.fill(HIST("hDeltaEtaPtIntSidebandRight"), deltaEta, efficiencyWeight);
-        registry.fill(HIST("hDeltaPhiPtIntSidebandRight"), deltaPhi, efficiencyWeight);
+      const auto& cells = candidate.pairCells();
+      const auto& counts = candidate.pairCounts();
+      for (size_t i = 0; i < cells.size(); i++) {
+        float ptHadron = layout.ptHadron(cells[i]);
+        double efficiencyWeight = counts[i];
+        if (applyEfficiency) {
+          int effBinHad = o2::analysis::findBin(binsPtEfficiencyHad, ptHadron);
+          if (effBinHad < 0) {
+            continue;
+          }
+          efficiencyWeight /= efficiencyD->at(o2::analysis::findBin(binsPtEfficiencyD, ptD)) * efficiencyHad->at(effBinHad);
+        }
+        fillCorrelationsData(layout.deltaPhi(cells[i]), layout.deltaEta(cells[i]), ptD, ptHadron, candidate.poolBin(), candidate.mD(), ptBinD, efficiencyWeight);
       }
     }
   }
-  PROCESS_SWITCH(HfTaskCorrelationDsHadrons, processData, "Process data", true);
+  PROCESS_SWITCH(HfTaskCorrelationDsHadrons, processDataBinned, "Process data, pairs aggregated per candidate", false);
 
   /// D-Hadron correlation pair filling task, from pair tables - for MC reco-level analysis (candidates matched to true signal only, but also bkg sources are studied)
   void processMcRec(DsHadronPairFullWithMl const& pairEntries,
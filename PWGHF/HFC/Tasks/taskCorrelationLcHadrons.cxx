@@ -21,6 +21,7 @@
 #include "PWGHF/DataModel/CandidateReconstructionTables.h"
 #include "PWGHF/DataModel/CandidateSelectionTables.h"
 #include "PWGHF/Utils/utilsAnalysis.h"
+#include "PWGHF/Utils/utilsCorrelations.h"
 #include "PWGHF/HFC/DataModel/CorrelationTables.h"
 
 using namespace o2;
@@ -96,6 +97,7 @@ struct HfTaskCorrelationLcHadrons {
   Configurable<std::vector<double>> sidebandRightInner{"sidebandRightInner", std::vector<double>{vecSidebandRightInner}, "Inner values of right sideband vs Pt"};
   Configurable<std::vector<double>> sidebandRightOuter{"sidebandRightOuter", std::vector<double>{vecSidebandRightOuter}, "Outer values of right sideband vs Pt"};
   Configurable<std::vector<double>> efficiencyLc{"efficiencyLc", std::vector<double>{vecEfficiencyLc}, "Efficiency values for Lc "};
+  o2::analysis::hf_correlations::HfBinnedCorrelations binnedPairs; // same binning as in the correlator
 
   using LcHadronPairFull = soa::Join<aod::LcHadronPair, aod::LcHadronRecoInfo>;
 
@@ -146,6 +148,30 @@ struct HfTaskCorrelationLcHadrons {
     registry.get<THnSparse>(HIST("hCorrel2DVsPtBkgMcRec"))->Sumw2();
     registry.get<THnSparse>(HIST("hCorrel2DVsPtMcGen"))->GetAxis(2)->Set(nBinsPtAxis, valuesPtAxis);
     registry.get<THnSparse>(HIST("hCorrel2DVsPtMcGen"))->Sumw2();
+
+    binnedPairs.init();
+  }
+
+  /// Fills the correlation plots of the signal region and of the sidebands with one pair, or with the pairs of a cell
+  void fillCorrelationsData(double deltaPhi, double deltaEta, double ptLc, double ptHadron, int poolBin, double massLc, int ptBinLc, double efficiencyWeight)
+  {
+    // check if correlation entry belongs to signal region, sidebands or is outside both, and fill correlation plots
+    if (massLc > signalRegionInner->at(ptBinLc) && massLc < signalRegionOuter->at(ptBinLc)) {
+      // in signal region
+      registry.fill(HIST("hCorrel2DVsPtSignalRegion"), deltaPhi, deltaEta, ptLc, ptHadron, poolBin, efficiencyWeight);
+      registry.fill(HIST("hCorrel2DPtIntSignalRegion"), deltaPhi, deltaEta, efficiencyWeight);
+      registry.fill(HIST("hDeltaEtaPtIntSignalRegion"), deltaEta, efficiencyWeight);
+      registry.fill(HIST("hDeltaPhiPtIntSignalRegion"), deltaPhi, efficiencyWeight);
+    }
+
+    if ((massLc > sidebandLeftOuter->at(ptBinLc) && massLc < sidebandLeftInner->at(ptBinLc)) ||
+        (massLc > sidebandRightInner->at(ptBinLc) && massLc < sidebandRightOuter->at(ptBinLc))) {
+      // in sideband region
+      registry.fill(HIST("hCorrel2DVsPtSidebands"), deltaPhi, deltaEta, ptLc, ptHadron, poolBin, efficiencyWeight);
+      registry.fill(HIST("hCorrel2DPtIntSidebands"), deltaPhi, deltaEta, efficiencyWeight);
+      registry.fill(HIST("hDeltaEtaPtIntSidebands"), deltaEta, efficiencyWeight);
+      registry.fill(HIST("hDeltaPhiPtIntSidebands"), deltaPhi, efficiencyWeight);
+    }
   }
 
   void processData(LcHadronPairFull const& pairEntries)
@@ -172,27 +198,39 @@ struct HfTaskCorrelationLcHadrons {
       if (applyEfficiency) {
         efficiencyWeight = 1. / (efficiencyLc->at(effBinLc) * efficiencyHadron);
       }
-      // check if correlation entry belongs to signal region, sidebands or is outside both, and fill correlation plots
-      if (massLc > signalRegionInner->at(ptBinLc) && massLc < signalRegionOuter->at(ptBinLc)) {
-        // in signal region
-        registry.fill(HIST("hCorrel2DVsPtSignalRegion"), deltaPhi, deltaEta, ptLc, ptHadron, poolBin, efficiencyWeight);
-        registry.fill(HIST("hCorrel2DPtIntSignalRegion"), deltaPhi, deltaEta, efficiencyWeight);
-        registry.fill(HIST("hDeltaEtaPtIntSignalRegion"), deltaEta, efficiencyWeight);
-        registry.fill(HIST("hDeltaPhiPtIntSignalRegion"), deltaPhi, efficiencyWeight);
-      }
-
-      if ((massLc > sidebandLeftOuter->at(ptBinLc) && massLc < sidebandLeftInner->at(ptBinLc)) ||
-          (massLc > sidebandRightInner->at(ptBinLc) && massLc < sidebandRightOuter->at(ptBinLc))) {
-        // in sideband region
-        registry.fill(HIST("hCorrel2DVsPtSidebands"), deltaPhi, deltaEta, ptLc, ptHadron, poolBin, efficiencyWeight);
-        registry.fill(HIST("hCorrel2DPtIntSidebands"), deltaPhi, deltaEta, efficiencyWeight);
-        registry.fill(HIST("hDeltaEtaPtIntSidebands"), deltaEta, efficiencyWeight);
-        registry.fill(HIST("hDeltaPhiPtIntSidebands"), deltaPhi, efficiencyWeight);
-      }
+      fillCorrelationsData(deltaPhi, deltaEta, ptLc, ptHadron, poolBin, massLc, ptBinLc, efficiencyWeight);
     } // end loop
   }
   PROCESS_SWITCH(HfTaskCorrelationLcHadrons, processData, "Process data", true);
 
+  /// Lc-Hadron correlations from the pairs aggregated per candidate, each cell filled at its bin centres with its count as weight
+  void processDataBinned(aod::LcHadronBinnedPair const& candidates)
+  {
+    const auto& layout = binnedPairs.layout;
+    for (const auto& candidate : candidates) {
+      double ptLc = candidate.ptD();
+      int effBinLc = o2::analysis::findBin(binsPtEfficiency, ptLc);
+      int ptBinLc = o2::analysis::findBin(binsPtCorrelations, ptLc);
+      if (ptBinLc < 0 || effBinLc < 0) {
+        continue;
+      }
+      double efficiencyWeight = 1.;
+      if (applyEfficiency) {
+        efficiencyWeight = 1. / efficiencyLc->at(effBinLc);
+      }
+      const auto& cells = candidate.pairCells();
+      const auto& counts = candidate.pairCounts();
+      for (size_t i = 0; i < cells.size(); i++) {
+        double ptHadron = layout.ptHadron(cells[i]);
+        if (ptHadron > 10.0) {
+          ptHadron = 10.5;
+        }
+        fillCorrelationsData(layout.deltaPhi(cells[i]), layout.deltaEta(cells[i]), ptLc, ptHadron, candidate.poolBin(), candidate.mD(), ptBinLc, efficiencyWeight * counts[i]);
+      }
+    }
+  }
+  PROCESS_SWITCH(HfTaskCorrelationLcHadrons, processDataBinned, "Process data, pairs aggregated per candidate", false);
+
   /// Lc-Hadron correlation pair filling task, from pair tables - for Mc reco-level analysis (candidates matched to true signal only, but also bkg sources are studied)
   void processMcRec(LcHadronPairFull const& pairEntries)
   {
@@ -82,7 +82,6 @@ struct HfCandidateCreator2Prong {
   o2::base::MatLayerCylSet* lut;
   o2::base::Propagator::MatCorrType matCorr = o2::base::Propagator::MatCorrType::USEMatCorrLUT;
 
-  int runNumber{0};
   float toMicrometers = 10000.; // from cm to µm
   double massPi{0.};
   double massK{0.};
@@ -101,7 +100,8 @@ struct HfCandidateCreator2Prong {
     std::array<bool, 6> doprocessKF{doprocessPvRefitWithKFParticle, doprocessNoPvRefitWithKFParticle,
                                     doprocessPvRefitWithKFParticleCentFT0C, doprocessNoPvRefitWithKFParticleCentFT0C,
                                     doprocessPvRefitWithKFParticleCentFT0M, doprocessNoPvRefitWithKFParticleCentFT0M};
-    if ((std::accumulate(doprocessDF.begin(), doprocessDF.end(), 0) + std::accumulate(doprocessKF.begin(), doprocessKF.end(), 0)) != 1) {
+    std::array<bool, 2> doprocessSvFit{doprocessPvRefitWithSkimSvFit, doprocessNoPvRefitWithSkimSvFit};
+    if ((std::accumulate(doprocessDF.begin(), doprocessDF.end(), 0) + std::accumulate(doprocessKF.begin(), doprocessKF.end(), 0) + std::accumulate(doprocessSvFit.begin(), doprocessSvFit.end(), 0)) != 1) {
       LOGP(fatal, "One and only one process function must be enabled at a time.");
     }
 
@@ -111,7 +111,7 @@ struct HfCandidateCreator2Prong {
       LOGP(fatal, "At most one process function for collision monitoring can be enabled at a time.");
     }
     if (nProcessesCollisions == 1) {
-      if ((doprocessPvRefitWithDCAFitterN || doprocessNoPvRefitWithDCAFitterN || doprocessPvRefitWithKFParticle || doprocessNoPvRefitWithKFParticle) && !doprocessCollisions) {
+      if ((doprocessPvRefitWithDCAFitterN || doprocessNoPvRefitWithDCAFitterN || doprocessPvRefitWithKFParticle || doprocessNoPvRefitWithKFParticle || doprocessPvRefitWithSkimSvFit || doprocessNoPvRefitWithSkimSvFit) && !doprocessCollisions) {
         LOGP(fatal, "Process function for collision monitoring not correctly enabled. Did you enable \"processCollisions\"?");
       }
       if ((doprocessPvRefitWithDCAFitterNCentFT0C || doprocessNoPvRefitWithDCAFitterNCentFT0C || doprocessPvRefitWithKFParticleCentFT0C || doprocessNoPvRefitWithKFParticleCentFT0C) && !doprocessCollisionsCentFT0C) {
@@ -156,18 +156,23 @@ struct HfCandidateCreator2Prong {
     if (std::accumulate(doprocessKF.begin(), doprocessKF.end(), 0) == 1) {
       registry.fill(HIST("hVertexerType"), aod::hf_cand::VertexerType::KfParticle);
     }
+    if (std::accumulate(doprocessSvFit.begin(), doprocessSvFit.end(), 0) == 1) {
+      // secondary vertices fitted with DCAFitterN in the track-index skim creator
+      registry.fill(HIST("hVertexerType"), aod::hf_cand::VertexerType::DCAFitter);
+    }
 
     ccdb->setURL(ccdbUrl);
     ccdb->setCaching(true);
     ccdb->setLocalObjectValidityChecking();
-    lut = o2::base::MatLayerCylSet::rectifyPtrFromFile(ccdb->get<o2::base::MatLayerCylSet>(ccdbPathLut));
-    runNumber = 0;
+    lut = HfMagFieldContext::instance().getMatLut(ccdb, ccdbPathLut);
+    HfMagFieldContext::instance().registerFitter(df);
 
     /// candidate monitoring
     setLabelHistoCands(hCandidates);
   }
 
-  template <bool doPvRefit, o2::hf_centrality::CentralityEstimator centEstimator, typename Coll, typename CandType, typename TTracks>
+  /// \tparam useSkimSvFit uses the secondary-vertex fits of the track-index skim creator instead of refitting the candidates
+  template <bool doPvRefit, o2::hf_centrality::CentralityEstimator centEstimator, bool useSkimSvFit = false, typename Coll, typename CandType, typename TTracks>
   void runCreator2ProngWithDCAFitterN(Coll const&,
                                       CandType const& rowsTrackIndexProng2,
                                       TTracks const&,
@@ -194,38 +199,46 @@ struct HfCandidateCreator2Prong {
       /// The static instance of the propagator was already modified in the HFTrackIndexSkimCreator,
       /// but this is not true when running on Run2 data/MC already converted into AO2Ds.
       auto bc = collision.template bc_as<aod::BCsWithTimestamps>();
-      if (runNumber != bc.runNumber()) {
-        LOG(info) << ">>>>>>>>>>>> Current run number: " << runNumber;
-        initCCDB(bc, runNumber, ccdb, isRun2 ? ccdbPathGrp : ccdbPathGrpMag, lut, isRun2);
-        bz = o2::base::Propagator::Instance()->getNominalBz();
-        LOG(info) << ">>>>>>>>>>>> Magnetic field: " << bz;
-        // df.setBz(bz); /// put it outside the 'if'! Otherwise we have a difference wrt bz Configurable (< 1 permille) in Run2 conv. data
-        // df.print();
-      }
-      df.setBz(bz);
+      HfMagFieldContext::instance().update(bc, ccdb, isRun2 ? ccdbPathGrp : ccdbPathGrpMag, isRun2); // also updates df
+      bz = HfMagFieldContext::instance().getBz();
 
       // reconstruct the 2-prong secondary vertex
       hCandidates->Fill(SVFitting::BeforeFit);
-      try {
-        if (df.process(trackParVarPos1, trackParVarNeg1) == 0) {
+      std::array<double, 3> secondaryVertex;
+      float chi2PCA;
+      std::array<float, 6> covMatrixPCA;
+      o2::track::TrackParCov trackParVar0;
+      o2::track::TrackParCov trackParVar1;
+      if constexpr (useSkimSvFit) {
+        // fitted already in the track-index skim creator
+        secondaryVertex = {rowTrackIndexProng2.svFitX(), rowTrackIndexProng2.svFitY(), rowTrackIndexProng2.svFitZ()};
+        chi2PCA = rowTrackIndexProng2.svFitChi2PCA();
+        std::copy(rowTrackIndexProng2.svFitCovMat(), rowTrackIndexProng2.svFitCovMat() + covMatrixPCA.size(), covMatrixPCA.begin());
+        trackParVar0 = getSvFitTrack(rowTrackIndexProng2.svFitParProng0(), rowTrackIndexProng2.svFitCovMatProng0());
+        trackParVar1 = getSvFitTrack(rowTrackIndexProng2.svFitParProng1(), rowTrackIndexProng2.svFitCovMatProng1());
+      } else {
+        try {
+          if (df.process(trackParVarPos1, trackParVarNeg1) == 0) {
+            continue;
+          }
+        } catch (const std::runtime_error& error) {
+          LOG(info) << "Run time error found: " << error.what() << ". DCFitterN cannot work, skipping the candidate.";
+          hCandidates->Fill(SVFitting::Fail);
           continue;
         }
-      } catch (const std::runtime_error& error) {
-        LOG(info) << "Run time error found: " << error.what() << ". DCFitterN cannot work, skipping the candidate.";
-        hCandidates->Fill(SVFitting::Fail);
-        continue;
+        const auto& secondaryVertexFit = df.getPCACandidate();
+        secondaryVertex = {secondaryVertexFit[0], secondaryVertexFit[1], secondaryVertexFit[2]};
+        chi2PCA = df.getChi2AtPCACandidate();
+        covMatrixPCA = df.calcPCACovMatrixFlat();
+        trackParVar0 = df.getTrack(0);
+        trackParVar1 = df.getTrack(1);
       }
       hCandidates->Fill(SVFitting::FitOk);
 
-      const auto& secondaryVertex = df.getPCACandidate();
-      auto chi2PCA = df.getChi2AtPCACandidate();
-      auto covMatrixPCA = df.calcPCACovMatrixFlat();
       registry.fill(HIST("hCovSVXX"), covMatrixPCA[0]); // FIXME: Calculation of errorDecayLength(XY) gives wrong values without this line.
       registry.fill(HIST("hCovSVYY"), covMatrixPCA[2]);
       registry.fill(HIST("hCovSVXZ"), covMatrixPCA[3]);
       registry.fill(HIST("hCovSVZZ"), covMatrixPCA[5]);
-      auto trackParVar0 = df.getTrack(0);
-      auto trackParVar1 = df.getTrack(1);
 
       // get track momenta
       std::array<float, 3> pvec0;
@@ -299,9 +312,9 @@ struct HfCandidateCreator2Prong {
       // fill histograms
       if (fillHistograms) {
         // calculate invariant masses
-        auto arrayMomenta = std::array{pvec0, pvec1};
-        massPiK = RecoDecay::m(arrayMomenta, std::array{massPi, massK});
-        massKPi = RecoDecay::m(arrayMomenta, std::array{massK, massPi});
+        auto arrayMasses = RecoDecay::mHypotheses(std::array{pvec0, pvec1}, std::array{std::array{massPi, massK}, std::array{massK, massPi}});
+        massPiK = arrayMasses[0];
+        massKPi = arrayMasses[1];
         registry.fill(HIST("hMass2"), massPiK);
         registry.fill(HIST("hMass2"), massKPi);
       }
@@ -333,14 +346,8 @@ struct HfCandidateCreator2Prong {
       /// The static instance of the propagator was already modified in the HFTrackIndexSkimCreator,
       /// but this is not true when running on Run2 data/MC already converted into AO2Ds.
       auto bc = collision.template bc_as<aod::BCsWithTimestamps>();
-      if (runNumber != bc.runNumber()) {
-        LOG(info) << ">>>>>>>>>>>> Current run number: " << runNumber;
-        initCCDB(bc, runNumber, ccdb, isRun2 ? ccdbPathGrp : ccdbPathGrpMag, lut, isRun2);
-        bz = o2::base::Propagator::Instance()->getNominalBz();
-        LOG(info) << ">>>>>>>>>>>> Magnetic field: " << bz;
-        // df.setBz(bz); /// put it outside the 'if'! Otherwise we have a difference wrt bz Configurable (< 1 permille) in Run2 conv. data
-        // df.print();
-      }
+      HfMagFieldContext::instance().update(bc, ccdb, isRun2 ? ccdbPathGrp : ccdbPathGrpMag, isRun2);
+      bz = HfMagFieldContext::instance().getBz();
       float covMatrixPV[6];
 
       KFParticle::SetField(bz);
@@ -497,6 +504,26 @@ struct HfCandidateCreator2Prong {
   }
   PROCESS_SWITCH(HfCandidateCreator2Prong, processNoPvRefitWithKFParticle, "Run candidate creator using KFParticle package w/o PV refit and w/o centrality selections", false);
 
+  /// @brief process function using the secondary-vertex fits of the skim creator (fillSvFit) w/ PV refit and w/o centrality selections
+  void processPvRefitWithSkimSvFit(soa::Join<aod::Collisions, aod::EvSels> const& collisions,
+                                   soa::Join<aod::Hf2Prongs, aod::HfPvRefit2Prong, aod::HfSvFit2Prong> const& rowsTrackIndexProng2,
+                                   aod::TracksWCovExtra const& tracks,
+                                   aod::BCsWithTimestamps const& bcWithTimeStamps)
+  {
+    runCreator2ProngWithDCAFitterN</*doPvRefit*/ true, CentralityEstimator::None, /*useSkimSvFit*/ true>(collisions, rowsTrackIndexProng2, tracks, bcWithTimeStamps);
+  }
+  PROCESS_SWITCH(HfCandidateCreator2Prong, processPvRefitWithSkimSvFit, "Run candidate creator using the secondary-vertex fits of the skim creator w/ PV refit and w/o centrality selections", false);
+
+  /// @brief process function using the secondary-vertex fits of the skim creator (fillSvFit) w/o PV refit and w/o centrality selections
+  void processNoPvRefitWithSkimSvFit(soa::Join<aod::Collisions, aod::EvSels> const& collisions,
+                                     soa::Join<aod::Hf2Prongs, aod::HfSvFit2Prong> const& rowsTrackIndexProng2,
+                                     aod::TracksWCovExtra const& tracks,
+                                     aod::BCsWithTimestamps const& bcWithTimeStamps)
+  {
+    runCreator2ProngWithDCAFitterN</*doPvRefit*/ false, CentralityEstimator::None, /*useSkimSvFit*/ true>(collisions, rowsTrackIndexProng2, tracks, bcWithTimeStamps);
+  }
+  PROCESS_SWITCH(HfCandidateCreator2Prong, processNoPvRefitWithSkimSvFit, "Run candidate creator using the secondary-vertex fits of the skim creator w/o PV refit and w/o centrality selections", false);
+
   /////////////////////////////////////////////
   ///                                       ///
   ///   with centrality selection on FT0C   ///
@@ -653,6 +680,8 @@ struct HfCandidateCreator2ProngExpressions {
   Produces<aod::HfCand2ProngMcRec> rowMcMatchRec;
   Produces<aod::HfCand2ProngMcGen> rowMcMatchGen;
 
+  McParticleAncestry mcAncestry; // heavy-flavour ancestry of the MC particles, rebuilt for each data frame
+
   HfEventSelectionMc hfEvSelMc; // mc event selection and monitoring
   using BCsInfo = soa::Join<aod::BCs, aod::Timestamps, aod::BcSels>;
   HistogramRegistry registry{"registry"};
@@ -676,6 +705,7 @@ struct HfCandidateCreator2ProngExpressions {
                  aod::McCollisions const&,
                  BCsInfo const&)
   {
+    mcAncestry.build(mcParticles);
     rowCandidateProng2->bindExternalIndices(&tracks);
 
     int indexRec = -1;
@@ -692,14 +722,14 @@ struct HfCandidateCreator2ProngExpressions {
       std::vector<int> idxBhadMothers{};
 
       // D0(bar) → π± K∓
-      indexRec = RecoDecay::getMatchedMCRec(mcParticles, arrayDaughters, Pdg::kD0, std::array{+kPiPlus, -kKPlus}, true, &sign);
+      indexRec = RecoDecay::getMatchedMCRec(mcParticles, mcAncestry, arrayDaughters, Pdg::kD0, std::array{+kPiPlus, -kKPlus}, true, &sign);
       if (indexRec > -1) {
         flag = sign * (1 << DecayType::D0ToPiK);
       }
 
       // J/ψ → e+ e−
       if (flag == 0) {
-        indexRec = RecoDecay::getMatchedMCRec(mcParticles, arrayDaughters, Pdg::kJPsi, std::array{+kElectron, -kElectron}, true);
+        indexRec = RecoDecay::getMatchedMCRec(mcParticles, mcAncestry, arrayDaughters, Pdg::kJPsi, std::array{+kElectron, -kElectron}, true);
         if (indexRec > -1) {
           flag = 1 << DecayType::JpsiToEE;
         }
@@ -707,7 +737,7 @@ struct HfCandidateCreator2ProngExpressions {
 
       // J/ψ → μ+ μ−
       if (flag == 0) {
-        indexRec = RecoDecay::getMatchedMCRec(mcParticles, arrayDaughters, Pdg::kJPsi, std::array{+kMuonPlus, -kMuonPlus}, true);
+        indexRec = RecoDecay::getMatchedMCRec(mcParticles, mcAncestry, arrayDaughters, Pdg::kJPsi, std::array{+kMuonPlus, -kMuonPlus}, true);
         if (indexRec > -1) {
           flag = 1 << DecayType::JpsiToMuMu;
         }
@@ -716,7 +746,7 @@ struct HfCandidateCreator2ProngExpressions {
       // Check whether the particle is non-prompt (from a b quark).
       if (flag != 0) {
         auto particle = mcParticles.rawIteratorAt(indexRec);
-        origin = RecoDecay::getCharmHadronOrigin(mcParticles, particle, false, &idxBhadMothers);
+        origin = RecoDecay::getCharmHadronOrigin(mcAncestry, particle, &idxBhadMothers);
       }
       if (origin == RecoDecay::OriginType::NonPrompt) {
         auto bHadMother = mcParticles.rawIteratorAt(idxBhadMothers[0]);
@@ -763,7 +793,7 @@ struct HfCandidateCreator2ProngExpressions {
 
       // Check whether the particle is non-prompt (from a b quark).
       if (flag != 0) {
-        origin = RecoDecay::getCharmHadronOrigin(mcParticles, particle, false, &idxBhadMothers);
+        origin = RecoDecay::getCharmHadronOrigin(mcAncestry, particle, &idxBhadMothers);
       }
       if (origin == RecoDecay::OriginType::NonPrompt) {
         rowMcMatchGen(flag, origin, idxBhadMothers[0]);
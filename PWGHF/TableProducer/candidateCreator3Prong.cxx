@@ -74,7 +74,6 @@ struct HfCandidateCreator3Prong {
   o2::base::MatLayerCylSet* lut;
   o2::base::Propagator::MatCorrType matCorr = o2::base::Propagator::MatCorrType::USEMatCorrLUT;
 
-  int runNumber{0};
   float toMicrometers = 10000.; // from cm to µm
   double massPi{0.};
   double massK{0.};
@@ -83,6 +82,8 @@ struct HfCandidateCreator3Prong {
 
   using FilteredHf3Prongs = soa::Filtered<aod::Hf3Prongs>;
   using FilteredPvRefitHf3Prongs = soa::Filtered<soa::Join<aod::Hf3Prongs, aod::HfPvRefit3Prong>>;
+  using FilteredSvFitHf3Prongs = soa::Filtered<soa::Join<aod::Hf3Prongs, aod::HfSvFit3Prong>>;
+  using FilteredPvRefitSvFitHf3Prongs = soa::Filtered<soa::Join<aod::Hf3Prongs, aod::HfPvRefit3Prong, aod::HfSvFit3Prong>>;
 
   // filter candidates
   Filter filterSelected3Prongs = (createDplus && (o2::aod::hf_track_index::hfflag & static_cast<uint8_t>(BIT(aod::hf_cand_3prong::DecayType::DplusToPiKPi))) != static_cast<uint8_t>(0)) || (createDs && (o2::aod::hf_track_index::hfflag & static_cast<uint8_t>(BIT(aod::hf_cand_3prong::DecayType::DsToKKPi))) != static_cast<uint8_t>(0)) || (createLc && (o2::aod::hf_track_index::hfflag & static_cast<uint8_t>(BIT(aod::hf_cand_3prong::DecayType::LcToPKPi))) != static_cast<uint8_t>(0)) || (createXic && (o2::aod::hf_track_index::hfflag & static_cast<uint8_t>(BIT(aod::hf_cand_3prong::DecayType::XicToPKPi))) != static_cast<uint8_t>(0));
@@ -92,9 +93,10 @@ struct HfCandidateCreator3Prong {
 
   void init(InitContext const&)
   {
-    std::array<bool, 6> processes = {doprocessPvRefit, doprocessNoPvRefit,
+    std::array<bool, 8> processes = {doprocessPvRefit, doprocessNoPvRefit,
                                      doprocessPvRefitCentFT0C, doprocessNoPvRefitCentFT0C,
-                                     doprocessPvRefitCentFT0M, doprocessNoPvRefitCentFT0M};
+                                     doprocessPvRefitCentFT0M, doprocessNoPvRefitCentFT0M,
+                                     doprocessPvRefitWithSkimSvFit, doprocessNoPvRefitWithSkimSvFit};
     if (std::accumulate(processes.begin(), processes.end(), 0) != 1) {
       LOGP(fatal, "One and only one process function must be enabled at a time.");
     }
@@ -105,7 +107,7 @@ struct HfCandidateCreator3Prong {
       LOGP(fatal, "At most one process function for collision monitoring can be enabled at a time.");
     }
     if (nProcessesCollisions == 1) {
-      if ((doprocessPvRefit || doprocessNoPvRefit) && !doprocessCollisions) {
+      if ((doprocessPvRefit || doprocessNoPvRefit || doprocessPvRefitWithSkimSvFit || doprocessNoPvRefitWithSkimSvFit) && !doprocessCollisions) {
         LOGP(fatal, "Process function for collision monitoring not correctly enabled. Did you enable \"processCollisions\"?");
       }
       if ((doprocessPvRefitCentFT0C || doprocessNoPvRefitCentFT0C) && !doprocessCollisionsCentFT0C) {
@@ -152,14 +154,15 @@ struct HfCandidateCreator3Prong {
     ccdb->setURL(ccdbUrl);
     ccdb->setCaching(true);
     ccdb->setLocalObjectValidityChecking();
-    lut = o2::base::MatLayerCylSet::rectifyPtrFromFile(ccdb->get<o2::base::MatLayerCylSet>(ccdbPathLut));
-    runNumber = 0;
+    lut = HfMagFieldContext::instance().getMatLut(ccdb, ccdbPathLut);
+    HfMagFieldContext::instance().registerFitter(df);
 
     /// candidate monitoring
     setLabelHistoCands(hCandidates);
   }
 
-  template <bool doPvRefit = false, o2::hf_centrality::CentralityEstimator centEstimator, typename Coll, typename Cand>
+  /// \tparam useSkimSvFit uses the secondary-vertex fits of the track-index skim creator instead of refitting the candidates
+  template <bool doPvRefit = false, o2::hf_centrality::CentralityEstimator centEstimator, bool useSkimSvFit = false, typename Coll, typename Cand>
   void runCreator3Prong(Coll const&,
                         Cand const& rowsTrackIndexProng3,
                         aod::TracksWCovExtra const&,
@@ -188,39 +191,46 @@ struct HfCandidateCreator3Prong {
       /// The static instance of the propagator was already modified in the HFTrackIndexSkimCreator,
       /// but this is not true when running on Run2 data/MC already converted into AO2Ds.
       auto bc = collision.template bc_as<aod::BCsWithTimestamps>();
-      if (runNumber != bc.runNumber()) {
-        LOG(info) << ">>>>>>>>>>>> Current run number: " << runNumber;
-        initCCDB(bc, runNumber, ccdb, isRun2 ? ccdbPathGrp : ccdbPathGrpMag, lut, isRun2);
-        bz = o2::base::Propagator::Instance()->getNominalBz();
-        LOG(info) << ">>>>>>>>>>>> Magnetic field: " << bz;
-        // df.setBz(bz); /// put it outside the 'if'! Otherwise we have a difference wrt bz Configurable (< 1 permille) in Run2 conv. data
-        // df.print();
-      }
-      df.setBz(bz);
+      HfMagFieldContext::instance().update(bc, ccdb, isRun2 ? ccdbPathGrp : ccdbPathGrpMag, isRun2); // also updates df
+      bz = HfMagFieldContext::instance().getBz();
 
       // reconstruct the 3-prong secondary vertex
       hCandidates->Fill(SVFitting::BeforeFit);
-      try {
-        if (df.process(trackParVar0, trackParVar1, trackParVar2) == 0) {
+      std::array<double, 3> secondaryVertex;
+      float chi2PCA;
+      std::array<float, 6> covMatrixPCA;
+      if constexpr (useSkimSvFit) {
+        // fitted already in the track-index skim creator
+        secondaryVertex = {rowTrackIndexProng3.svFitX(), rowTrackIndexProng3.svFitY(), rowTrackIndexProng3.svFitZ()};
+        chi2PCA = rowTrackIndexProng3.svFitChi2PCA();
+        std::copy(rowTrackIndexProng3.svFitCovMat(), rowTrackIndexProng3.svFitCovMat() + covMatrixPCA.size(), covMatrixPCA.begin());
+        trackParVar0 = getSvFitTrack(rowTrackIndexProng3.svFitParProng0(), rowTrackIndexProng3.svFitCovMatProng0());
+        trackParVar1 = getSvFitTrack(rowTrackIndexProng3.svFitParProng1(), rowTrackIndexProng3.svFitCovMatProng1());
+        trackParVar2 = getSvFitTrack(rowTrackIndexProng3.svFitParProng2(), rowTrackIndexProng3.svFitCovMatProng2());
+      } else {
+        try {
+          if (df.process(trackParVar0, trackParVar1, trackParVar2) == 0) {
+            continue;
+          }
+        } catch (const std::runtime_error& error) {
+          LOG(info) << "Run time error found: " << error.what() << ". DCFitterN cannot work, skipping the candidate.";
+          hCandidates->Fill(SVFitting::Fail);
           continue;
         }
-      } catch (const std::runtime_error& error) {
-        LOG(info) << "Run time error found: " << error.what() << ". DCFitterN cannot work, skipping the candidate.";
-        hCandidates->Fill(SVFitting::Fail);
-        continue;
+        const auto& secondaryVertexFit = df.getPCACandidate();
+        secondaryVertex = {secondaryVertexFit[0], secondaryVertexFit[1], secondaryVertexFit[2]};
+        chi2PCA = df.getChi2AtPCACandidate();
+        covMatrixPCA = df.calcPCACovMatrixFlat();
+        trackParVar0 = df.getTrack(0);
+        trackParVar1 = df.getTrack(1);
+        trackParVar2 = df.getTrack(2);
       }
       hCandidates->Fill(SVFitting::FitOk);
 
-      const auto& secondaryVertex = df.getPCACandidate();
-      auto chi2PCA = df.getChi2AtPCACandidate();
-      auto covMatrixPCA = df.calcPCACovMatrixFlat();
       registry.fill(HIST("hCovSVXX"), covMatrixPCA[0]); // FIXME: Calculation of errorDecayLength(XY) gives wrong values without this line.
       registry.fill(HIST("hCovSVYY"), covMatrixPCA[2]);
       registry.fill(HIST("hCovSVXZ"), covMatrixPCA[3]);
       registry.fill(HIST("hCovSVZZ"), covMatrixPCA[5]);
-      trackParVar0 = df.getTrack(0);
-      trackParVar1 = df.getTrack(1);
-      trackParVar2 = df.getTrack(2);
 
       // get track momenta
       std::array<float, 3> pvec0;
@@ -337,6 +347,26 @@ struct HfCandidateCreator3Prong {
   }
   PROCESS_SWITCH(HfCandidateCreator3Prong, processNoPvRefit, "Run candidate creator without PV refit and w/o centrality selections", true);
 
+  /// @brief process function using the secondary-vertex fits of the skim creator (fillSvFit) w/ PV refit and w/o centrality selections
+  void processPvRefitWithSkimSvFit(soa::Join<aod::Collisions, aod::EvSels> const& collisions,
+                                   FilteredPvRefitSvFitHf3Prongs const& rowsTrackIndexProng3,
+                                   aod::TracksWCovExtra const& tracks,
+                                   aod::BCsWithTimestamps const& bcWithTimeStamps)
+  {
+    runCreator3Prong</*doPvRefit*/ true, CentralityEstimator::None, /*useSkimSvFit*/ true>(collisions, rowsTrackIndexProng3, tracks, bcWithTimeStamps);
+  }
+  PROCESS_SWITCH(HfCandidateCreator3Prong, processPvRefitWithSkimSvFit, "Run candidate creator using the secondary-vertex fits of the skim creator with PV refit and w/o centrality selections", false);
+
+  /// @brief process function using the secondary-vertex fits of the skim creator (fillSvFit) w/o PV refit and w/o centrality selections
+  void processNoPvRefitWithSkimSvFit(soa::Join<aod::Collisions, aod::EvSels> const& collisions,
+                                     FilteredSvFitHf3Prongs const& rowsTrackIndexProng3,
+                                     aod::TracksWCovExtra const& tracks,
+                                     aod::BCsWithTimestamps const& bcWithTimeStamps)
+  {
+    runCreator3Prong</*doPvRefit*/ false, CentralityEstimator::None, /*useSkimSvFit*/ true>(collisions, rowsTrackIndexProng3, tracks, bcWithTimeStamps);
+  }
+  PROCESS_SWITCH(HfCandidateCreator3Prong, processNoPvRefitWithSkimSvFit, "Run candidate creator using the secondary-vertex fits of the skim creator without PV refit and w/o centrality selections", false);
+
   /////////////////////////////////////////////
   ///                                       ///
   ///   with centrality selection on FT0C   ///
@@ -453,6 +483,8 @@ struct HfCandidateCreator3ProngExpressions {
   Produces<aod::HfCand3ProngMcRec> rowMcMatchRec;
   Produces<aod::HfCand3ProngMcGen> rowMcMatchGen;
 
+  McParticleAncestry mcAncestry; // heavy-flavour ancestry of the MC particles, rebuilt for each data frame
+
   bool createDplus{false};
   bool createDs{false};
   bool createLc{false};
@@ -500,6 +532,7 @@ struct HfCandidateCreator3ProngExpressions {
                  aod::McCollisions const&,
                  BCsInfo const&)
   {
+    mcAncestry.build(mcParticles);
     rowCandidateProng3->bindExternalIndices(&tracks);
 
     int indexRec = -1;
@@ -529,7 +562,7 @@ struct HfCandidateCreator3ProngExpressions {
 
       // D± → π± K∓ π±
       if (createDplus) {
-        indexRec = RecoDecay::getMatchedMCRec(mcParticles, arrayDaughters, Pdg::kDPlus, std::array{+kPiPlus, -kKPlus, +kPiPlus}, true, &sign, 2);
+        indexRec = RecoDecay::getMatchedMCRec(mcParticles, mcAncestry, arrayDaughters, Pdg::kDPlus, std::array{+kPiPlus, -kKPlus, +kPiPlus}, true, &sign, 2);
         if (indexRec > -1) {
           flag = sign * (1 << DecayType::DplusToPiKPi);
         }
@@ -538,10 +571,10 @@ struct HfCandidateCreator3ProngExpressions {
       // Ds± → K± K∓ π± and D± → K± K∓ π±
       if (flag == 0 && createDs) {
         bool isDplus = false;
-        indexRec = RecoDecay::getMatchedMCRec(mcParticles, arrayDaughters, Pdg::kDS, std::array{+kKPlus, -kKPlus, +kPiPlus}, true, &sign, 2);
+        indexRec = RecoDecay::getMatchedMCRec(mcParticles, mcAncestry, arrayDaughters, Pdg::kDS, std::array{+kKPlus, -kKPlus, +kPiPlus}, true, &sign, 2);
         if (indexRec == -1) {
           isDplus = true;
-          indexRec = RecoDecay::getMatchedMCRec(mcParticles, arrayDaughters, Pdg::kDPlus, std::array{+kKPlus, -kKPlus, +kPiPlus}, true, &sign, 2);
+          indexRec = RecoDecay::getMatchedMCRec(mcParticles, mcAncestry, arrayDaughters, Pdg::kDPlus, std::array{+kKPlus, -kKPlus, +kPiPlus}, true, &sign, 2);
         }
         if (indexRec > -1) {
           // DecayType::DsToKKPi is used to flag both Ds± → K± K∓ π± and D± → K± K∓ π±
@@ -567,7 +600,7 @@ struct HfCandidateCreator3ProngExpressions {
 
       // Λc± → p± K∓ π±
       if (flag == 0 && createLc) {
-        indexRec = RecoDecay::getMatchedMCRec(mcParticles, arrayDaughters, Pdg::kLambdaCPlus, std::array{+kProton, -kKPlus, +kPiPlus}, true, &sign, 2);
+        indexRec = RecoDecay::getMatchedMCRec(mcParticles, mcAncestry, arrayDaughters, Pdg::kLambdaCPlus, std::array{+kProton, -kKPlus, +kPiPlus}, true, &sign, 2);
         if (indexRec > -1) {
           flag = sign * (1 << DecayType::LcToPKPi);
 
@@ -594,7 +627,7 @@ struct HfCandidateCreator3ProngExpressions {
 
       // Ξc± → p± K∓ π±
       if (flag == 0 && createXic) {
-        indexRec = RecoDecay::getMatchedMCRec(mcParticles, arrayDaughters, Pdg::kXiCPlus, std::array{+kProton, -kKPlus, +kPiPlus}, true, &sign, 2);
+        indexRec = RecoDecay::getMatchedMCRec(mcParticles, mcAncestry, arrayDaughters, Pdg::kXiCPlus, std::array{+kProton, -kKPlus, +kPiPlus}, true, &sign, 2);
         if (indexRec > -1) {
           flag = sign * (1 << DecayType::XicToPKPi);
         }
@@ -603,7 +636,7 @@ struct HfCandidateCreator3ProngExpressions {
       // Check whether the particle is non-prompt (from a b quark).
       if (flag != 0) {
         auto particle = mcParticles.rawIteratorAt(indexRec);
-        origin = RecoDecay::getCharmHadronOrigin(mcParticles, particle, false, &idxBhadMothers);
+        origin = RecoDecay::getCharmHadronOrigin(mcAncestry, particle, &idxBhadMothers);
       }
       if (origin == RecoDecay::OriginType::NonPrompt) {
         auto bHadMother = mcParticles.rawIteratorAt(idxBhadMothers[0]);
@@ -699,7 +732,7 @@ struct HfCandidateCreator3ProngExpressions {
 
       // Check whether the particle is non-prompt (from a b quark).
       if (flag != 0) {
-        origin = RecoDecay::getCharmHadronOrigin(mcParticles, particle, false, &idxBhadMothers);
+        origin = RecoDecay::getCharmHadronOrigin(mcAncestry, particle, &idxBhadMothers);
       }
       if (origin == RecoDecay::OriginType::NonPrompt) {
         rowMcMatchGen(flag, origin, channel, idxBhadMothers[0]);
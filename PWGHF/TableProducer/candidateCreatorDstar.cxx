@@ -504,6 +504,8 @@ struct HfCandidateCreatorDstarExpressions {
   Produces<aod::HfCandDstarMcRec> rowsMcMatchRecDstar;
   Produces<aod::HfCandDstarMcGen> rowsMcMatchGenDstar;
 
+  McParticleAncestry mcAncestry; // heavy-flavour ancestry of the MC particles, rebuilt for each data frame
+
   HfEventSelectionMc hfEvSelMc; // mc event selection and monitoring
   using BCsInfo = soa::Join<aod::BCs, aod::Timestamps, aod::BcSels>;
   HistogramRegistry registry{"registry"};
@@ -527,6 +529,7 @@ struct HfCandidateCreatorDstarExpressions {
                  aod::McCollisions const&,
                  BCsInfo const&)
   {
+    mcAncestry.build(mcParticles);
     rowsCandidateD0->bindExternalIndices(&tracks);
     rowsCandidateDstar->bindExternalIndices(&tracks);
 
@@ -551,9 +554,9 @@ struct HfCandidateCreatorDstarExpressions {
       auto arrayDaughtersofD0 = std::array{candD0.prong0_as<aod::TracksWMc>(), candD0.prong1_as<aod::TracksWMc>()};
 
       // D*± → D0(bar) π±
-      indexRecDstar = RecoDecay::getMatchedMCRec(mcParticles, arrayDaughtersDstar, Pdg::kDStar, std::array{+kPiPlus, +kPiPlus, -kKPlus}, true, &signDstar, 2);
+      indexRecDstar = RecoDecay::getMatchedMCRec(mcParticles, mcAncestry, arrayDaughtersDstar, Pdg::kDStar, std::array{+kPiPlus, +kPiPlus, -kKPlus}, true, &signDstar, 2);
       // D0(bar) → π± K∓
-      indexRecD0 = RecoDecay::getMatchedMCRec(mcParticles, arrayDaughtersofD0, Pdg::kD0, std::array{+kPiPlus, -kKPlus}, true, &signD0);
+      indexRecD0 = RecoDecay::getMatchedMCRec(mcParticles, mcAncestry, arrayDaughtersofD0, Pdg::kD0, std::array{+kPiPlus, -kKPlus}, true, &signD0);
 
       if (indexRecDstar > -1) {
         flagDstar = signDstar * (BIT(aod::hf_cand_dstar::DecayType::DstarToD0Pi));
@@ -565,11 +568,11 @@ struct HfCandidateCreatorDstarExpressions {
       // check wether the particle is non-promt (from a B0 hadron)
       if (flagDstar != 0) {
         auto particleDstar = mcParticles.iteratorAt(indexRecDstar);
-        originDstar = RecoDecay::getCharmHadronOrigin(mcParticles, particleDstar, false, &idxBhadMothers);
+        originDstar = RecoDecay::getCharmHadronOrigin(mcAncestry, particleDstar, &idxBhadMothers);
       }
       if (flagD0 != 0) {
         auto particleD0 = mcParticles.iteratorAt(indexRecD0);
-        originD0 = RecoDecay::getCharmHadronOrigin(mcParticles, particleD0);
+        originD0 = RecoDecay::getCharmHadronOrigin(mcAncestry, particleD0);
       }
       if (originDstar == RecoDecay::OriginType::NonPrompt) {
         auto bHadMother = mcParticles.rawIteratorAt(idxBhadMothers[0]);
@@ -610,10 +613,10 @@ struct HfCandidateCreatorDstarExpressions {
 
       // check wether the particle is non-promt (from a B0 hadron)
       if (flagDstar != 0) {
-        originDstar = RecoDecay::getCharmHadronOrigin(mcParticles, particle, false, &idxBhadMothers);
+        originDstar = RecoDecay::getCharmHadronOrigin(mcAncestry, particle, &idxBhadMothers);
       }
       if (flagD0 != 0) {
-        originD0 = RecoDecay::getCharmHadronOrigin(mcParticles, particle);
+        originD0 = RecoDecay::getCharmHadronOrigin(mcAncestry, particle);
       }
 
       if (originDstar == RecoDecay::OriginType::NonPrompt) {
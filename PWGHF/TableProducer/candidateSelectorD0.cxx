@@ -65,6 +65,7 @@ struct HfCandidateSelectorD0 {
   Configurable<LabeledArray<double>> cutsMl{"cutsMl", {hf_cuts_ml::cuts[0], hf_cuts_ml::nBinsPt, hf_cuts_ml::nCutScores, hf_cuts_ml::labelsPt, hf_cuts_ml::labelsCutScore}, "ML selections per pT bin"};
   Configurable<int8_t> nClassesMl{"nClassesMl", (int8_t)hf_cuts_ml::nCutScores, "Number of classes in ML model"};
   Configurable<bool> enableDebugMl{"enableDebugMl", false, "Flag to enable histograms to monitor BDT application"};
+  Configurable<bool> applyMlBatch{"applyMlBatch", false, "Evaluate the ML models once per pT bin on all the candidates of the data frame passing the other selections"};
   Configurable<std::vector<std::string>> namesInputFeatures{"namesInputFeatures", std::vector<std::string>{"feature1", "feature2"}, "Names of ML model input features"};
   // CCDB configuration
   Configurable<std::string> ccdbUrl{"ccdbUrl", "http://alice-ccdb.cern.ch", "url of the ccdb repository"};
@@ -76,9 +77,24 @@ struct HfCandidateSelectorD0 {
   o2::analysis::HfMlResponseD0ToKPi<float> hfMlResponse;
   std::vector<float> outputMlD0 = {};
   std::vector<float> outputMlD0bar = {};
+  // selection status of the candidates of the data frame, for the batched ML selections
+  struct CandidateStatus {
+    int statusD0;
+    int statusD0bar;
+    int statusHFFlag;
+    int statusTopol;
+    int statusCand;
+    int statusPID;
+    int indexMlD0{-1};    // index of the D0 hypothesis in the ML batch, -1 if not evaluated
+    int indexMlD0bar{-1}; // index of the D0bar hypothesis in the ML batch, -1 if not evaluated
+    float massD0{0.f};
+    float massD0bar{0.f};
+  };
+  std::vector<CandidateStatus> candidateStatuses;
   o2::ccdb::CcdbApi ccdbApi;
   TrackSelectorPi selectorPion;
   TrackSelectorKa selectorKaon;
+  TrackSelectorPidStatuses pidStatuses; // statuses of the tracks as pion (0) and kaon (1)
   HfHelper hfHelper;
 
   using TracksSel = soa::Join<aod::TracksWDcaExtra, aod::TracksPidPi, aod::PidTpcTofFullPi, aod::TracksPidKa, aod::PidTpcTofFullKa>;
@@ -251,10 +267,79 @@ struct HfCandidateSelectorD0 {
 
     return true;
   }
+
+  /// Fills the tables of a candidate rejected before the ML selections, or keeps it for the batched ML selections
+  void fillCandidateWithoutMl(int statusD0, int statusD0bar, int statusHFFlag, int statusTopol, int statusCand, int statusPID)
+  {
+    if (applyMl && applyMlBatch) {
+      candidateStatuses.push_back({statusD0, statusD0bar, statusHFFlag, statusTopol, statusCand, statusPID});
+      return;
+    }
+    hfSelD0Candidate(statusD0, statusD0bar, statusHFFlag, statusTopol, statusCand, statusPID);
+    if (applyMl) {
+      hfMlD0Candidate(outputMlD0, outputMlD0bar);
+    }
+  }
+
+  /// Applies the batched ML selections and fills the tables of the candidates of the data frame, in candidate order
+  void fillCandidatesMlBatch()
+  {
+    hfMlResponse.evaluateBatch();
+    for (auto& candidateStatus : candidateStatuses) {
+      outputMlD0.clear();
+      outputMlD0bar.clear();
+      bool isSelectedMlD0 = false;
+      bool isSelectedMlD0bar = false;
+      if (candidateStatus.indexMlD0 >= 0) {
+        isSelectedMlD0 = hfMlResponse.isSelectedInBatch(candidateStatus.indexMlD0);
+        hfMlResponse.getOutputInBatch(candidateStatus.indexMlD0, outputMlD0);
+      }
+      if (candidateStatus.indexMlD0bar >= 0) {
+        isSelectedMlD0bar = hfMlResponse.isSelectedInBatch(candidateStatus.indexMlD0bar);
+        hfMlResponse.getOutputInBatch(candidateStatus.indexMlD0bar, outputMlD0bar);
+      }
+      if (!isSelectedMlD0) {
+        candidateStatus.statusD0 = 0;
+      }
+      if (!isSelectedMlD0bar) {
+        candidateStatus.statusD0bar = 0;
+      }
+
+      hfMlD0Candidate(outputMlD0, outputMlD0bar);
+
+      if (enableDebugMl) {
+        if (isSelectedMlD0) {
+          registry.fill(HIST("DebugBdt/hBdtScore1VsStatus"), outputMlD0[0], candidateStatus.statusD0);
+          registry.fill(HIST("DebugBdt/hBdtScore2VsStatus"), outputMlD0[1], candidateStatus.statusD0);
+          registry.fill(HIST("DebugBdt/hBdtScore3VsStatus"), outputMlD0[2], candidateStatus.statusD0);
+          registry.fill(HIST("DebugBdt/hMassDmesonSel"), candidateStatus.massD0);
+        }
+        if (isSelectedMlD0bar) {
+          registry.fill(HIST("DebugBdt/hBdtScore1VsStatus"), outputMlD0bar[0], candidateStatus.statusD0bar);
+          registry.fill(HIST("DebugBdt/hBdtScore2VsStatus"), outputMlD0bar[1], candidateStatus.statusD0bar);
+          registry.fill(HIST("DebugBdt/hBdtScore3VsStatus"), outputMlD0bar[2], candidateStatus.statusD0bar);
+          registry.fill(HIST("DebugBdt/hMassDmesonSel"), candidateStatus.massD0bar);
+        }
+      }
+      hfSelD0Candidate(candidateStatus.statusD0, candidateStatus.statusD0bar, candidateStatus.statusHFFlag, candidateStatus.statusTopol, candidateStatus.statusCand, candidateStatus.statusPID);
+    }
+  }
+
   template <int reconstructionType, typename CandType>
   void processSel(CandType const& candidates,
-                  TracksSel const&)
+                  TracksSel const& tracks)
   {
+    if (applyMl && applyMlBatch) {
+      candidateStatuses.clear();
+      hfMlResponse.clearBatch();
+    }
+
+    // track-level PID selection, evaluated once per track instead of once per candidate
+    if (usePid) {
+      auto detectors = usePidTpcOnly ? TrackSelectorPID::Tpc : (usePidTpcAndTof ? TrackSelectorPID::TpcAndTof : TrackSelectorPID::TpcOrTof);
+      pidStatuses.fill(tracks, detectors, selectorPion, selectorKaon);
+    }
+
     // looping over 2-prong candidates
     for (const auto& candidate : candidates) {
 
@@ -270,10 +355,7 @@ struct HfCandidateSelectorD0 {
       outputMlD0bar.clear();
 
       if (!(candidate.hfflag() & 1 << aod::hf_cand_2prong::DecayType::D0ToPiK)) {
-        hfSelD0Candidate(statusD0, statusD0bar, statusHFFlag, statusTopol, statusCand, statusPID);
-        if (applyMl) {
-          hfMlD0Candidate(outputMlD0, outputMlD0bar);
-        }
+        fillCandidateWithoutMl(statusD0, statusD0bar, statusHFFlag, statusTopol, statusCand, statusPID);
         continue;
       }
       statusHFFlag = 1;
@@ -284,10 +366,7 @@ struct HfCandidateSelectorD0 {
 
       // conjugate-independent topological selection
       if (!selectionTopol<reconstructionType>(candidate)) {
-        hfSelD0Candidate(statusD0, statusD0bar, statusHFFlag, statusTopol, statusCand, statusPID);
-        if (applyMl) {
-          hfMlD0Candidate(outputMlD0, outputMlD0bar);
-        }
+        fillCandidateWithoutMl(statusD0, statusD0bar, statusHFFlag, statusTopol, statusCand, statusPID);
         continue;
       }
       statusTopol = 1;
@@ -301,37 +380,17 @@ struct HfCandidateSelectorD0 {
       bool topolD0bar = selectionTopolConjugate<reconstructionType>(candidate, trackNeg, trackPos);
 
       if (!topolD0 && !topolD0bar) {
-        hfSelD0Candidate(statusD0, statusD0bar, statusHFFlag, statusTopol, statusCand, statusPID);
-        if (applyMl) {
-          hfMlD0Candidate(outputMlD0, outputMlD0bar);
-        }
+        fillCandidateWithoutMl(statusD0, statusD0bar, statusHFFlag, statusTopol, statusCand, statusPID);
         continue;
       }
       statusCand = 1;
 
       if (usePid) {
         // track-level PID selection
-        int pidTrackPosKaon = -1;
-        int pidTrackPosPion = -1;
-        int pidTrackNegKaon = -1;
-        int pidTrackNegPion = -1;
-
-        if (usePidTpcOnly) {
-          pidTrackPosKaon = selectorKaon.statusTpc(trackPos);
-          pidTrackPosPion = selectorPion.statusTpc(trackPos);
-          pidTrackNegKaon = selectorKaon.statusTpc(trackNeg);
-          pidTrackNegPion = selectorPion.statusTpc(trackNeg);
-        } else if (usePidTpcAndTof) {
-          pidTrackPosKaon = selectorKaon.statusTpcAndTof(trackPos);
-          pidTrackPosPion = selectorPion.statusTpcAndTof(trackPos);
-          pidTrackNegKaon = selectorKaon.statusTpcAndTof(trackNeg);
-          pidTrackNegPion = selectorPion.statusTpcAndTof(trackNeg);
-        } else {
-          pidTrackPosKaon = selectorKaon.statusTpcOrTof(trackPos);
-          pidTrackPosPion = selectorPion.statusTpcOrTof(trackPos);
-          pidTrackNegKaon = selectorKaon.statusTpcOrTof(trackNeg);
-          pidTrackNegPion = selectorPion.statusTpcOrTof(trackNeg);
-        }
+        int pidTrackPosKaon = pidStatuses.get(trackPos.globalIndex(), 1);
+        int pidTrackPosPion = pidStatuses.get(trackPos.globalIndex(), 0);
+        int pidTrackNegKaon = pidStatuses.get(trackNeg.globalIndex(), 1);
+        int pidTrackNegPion = pidStatuses.get(trackNeg.globalIndex(), 0);
 
         // int pidBayesTrackPos1Pion = selectorPion.statusBayes(trackPos);
 
@@ -355,10 +414,7 @@ struct HfCandidateSelectorD0 {
         }
 
         if (pidD0 == 0 && pidD0bar == 0) {
-          hfSelD0Candidate(statusD0, statusD0bar, statusHFFlag, statusTopol, statusCand, statusPID);
-          if (applyMl) {
-            hfMlD0Candidate(outputMlD0, outputMlD0bar);
-          }
+          fillCandidateWithoutMl(statusD0, statusD0bar, statusHFFlag, statusTopol, statusCand, statusPID);
           continue;
         }
 
@@ -378,6 +434,21 @@ struct HfCandidateSelectorD0 {
         }
       }
 
+      if (applyMl && applyMlBatch) {
+        // ML selections, evaluated after the loop for all the candidates
+        CandidateStatus candidateStatus{statusD0, statusD0bar, statusHFFlag, statusTopol, statusCand, statusPID};
+        if (statusD0 > 0) {
+          candidateStatus.indexMlD0 = hfMlResponse.addToBatch(hfMlResponse.getInputFeatures(candidate, trackPos, trackNeg, o2::constants::physics::kD0), ptCand);
+          candidateStatus.massD0 = hfHelper.invMassD0ToPiK(candidate);
+        }
+        if (statusD0bar > 0) {
+          candidateStatus.indexMlD0bar = hfMlResponse.addToBatch(hfMlResponse.getInputFeatures(candidate, trackPos, trackNeg, o2::constants::physics::kD0Bar), ptCand);
+          candidateStatus.massD0bar = hfHelper.invMassD0barToKPi(candidate);
+        }
+        candidateStatuses.push_back(candidateStatus);
+        continue;
+      }
+
       if (applyMl) {
         // ML selections
         bool isSelectedMlD0 = false;
@@ -418,6 +489,10 @@ struct HfCandidateSelectorD0 {
       }
       hfSelD0Candidate(statusD0, statusD0bar, statusHFFlag, statusTopol, statusCand, statusPID);
     }
+
+    if (applyMl && applyMlBatch) {
+      fillCandidatesMlBatch();
+    }
   }
 
   void processWithDCAFitterN(aod::HfCand2Prong const& candidates, TracksSel const& tracks)
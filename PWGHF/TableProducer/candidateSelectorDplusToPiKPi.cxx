@@ -66,6 +66,7 @@ struct HfCandidateSelectorDplusToPiKPi {
   Configurable<LabeledArray<double>> cutsMl{"cutsMl", {hf_cuts_ml::cuts[0], hf_cuts_ml::nBinsPt, hf_cuts_ml::nCutScores, hf_cuts_ml::labelsPt, hf_cuts_ml::labelsCutScore}, "ML selections per pT bin"};
   Configurable<int8_t> nClassesMl{"nClassesMl", (int8_t)hf_cuts_ml::nCutScores, "Number of classes in ML model"};
   Configurable<std::vector<std::string>> namesInputFeatures{"namesInputFeatures", std::vector<std::string>{"feature1", "feature2"}, "Names of ML model input features"};
+  Configurable<bool> applyMlBatch{"applyMlBatch", false, "Evaluate the ML models once per pT bin on all the candidates of the data frame passing the other selections"};
   // CCDB configuration
   Configurable<std::string> ccdbUrl{"ccdbUrl", "http://alice-ccdb.cern.ch", "url of the ccdb repository"};
   Configurable<std::vector<std::string>> modelPathsCCDB{"modelPathsCCDB", std::vector<std::string>{"EventFiltering/PWGHF/BDTDPlus"}, "Paths of models on CCDB"};
@@ -76,6 +77,13 @@ struct HfCandidateSelectorDplusToPiKPi {
   o2::analysis::HfMlResponseDplusToPiKPi<float> hfMlResponse;
   std::vector<float> outputMlNotPreselected = {};
   std::vector<float> outputMl = {};
+  // selection status of the candidates of the data frame, for the batched ML selections
+  struct CandidateStatus {
+    int status;
+    float pt;
+    int indexMl{-1}; // index in the ML batch, -1 if not evaluated
+  };
+  std::vector<CandidateStatus> candidateStatuses;
   o2::ccdb::CcdbApi ccdbApi;
   TrackSelectorPi selectorPion;
   TrackSelectorKa selectorKaon;
@@ -205,9 +213,49 @@ struct HfCandidateSelectorDplusToPiKPi {
     return true;
   }
 
+  /// Fills the tables of a candidate rejected before the ML selections, or keeps it for the batched ML selections
+  void fillCandidateWithoutMl(int status, float ptCand)
+  {
+    if (applyMl && applyMlBatch) {
+      candidateStatuses.push_back({status, ptCand});
+      return;
+    }
+    hfSelDplusToPiKPiCandidate(status);
+    if (applyMl) {
+      hfMlDplusToPiKPiCandidate(outputMlNotPreselected);
+    }
+  }
+
+  /// Applies the batched ML selections and fills the tables of the candidates of the data frame, in candidate order
+  void fillCandidatesMlBatch()
+  {
+    hfMlResponse.evaluateBatch();
+    for (auto& candidateStatus : candidateStatuses) {
+      if (candidateStatus.indexMl < 0) {
+        hfSelDplusToPiKPiCandidate(candidateStatus.status);
+        hfMlDplusToPiKPiCandidate(outputMlNotPreselected);
+        continue;
+      }
+      hfMlResponse.getOutputInBatch(candidateStatus.indexMl, outputMl);
+      hfMlDplusToPiKPiCandidate(outputMl);
+      if (hfMlResponse.isSelectedInBatch(candidateStatus.indexMl)) {
+        SETBIT(candidateStatus.status, aod::SelectionStep::RecoMl);
+        if (activateQA) {
+          registry.fill(HIST("hSelections"), 2 + aod::SelectionStep::RecoMl, candidateStatus.pt);
+        }
+      }
+      hfSelDplusToPiKPiCandidate(candidateStatus.status);
+    }
+  }
+
   void process(aod::HfCand3Prong const& candidates,
                TracksSel const&)
   {
+    if (applyMl && applyMlBatch) {
+      candidateStatuses.clear();
+      hfMlResponse.clearBatch();
+    }
+
     // looping over 3-prong candidates
     for (const auto& candidate : candidates) {
 
@@ -217,10 +265,7 @@ struct HfCandidateSelectorDplusToPiKPi {
       auto ptCand = candidate.pt();
 
       if (!TESTBIT(candidate.hfflag(), aod::hf_cand_3prong::DecayType::DplusToPiKPi)) {
-        hfSelDplusToPiKPiCandidate(statusDplusToPiKPi);
-        if (applyMl) {
-          hfMlDplusToPiKPiCandidate(outputMlNotPreselected);
-        }
+        fillCandidateWithoutMl(statusDplusToPiKPi, ptCand);
         if (activateQA) {
           registry.fill(HIST("hSelections"), 1, ptCand);
         }
@@ -237,10 +282,7 @@ struct HfCandidateSelectorDplusToPiKPi {
 
       // topological selection
       if (!selection(candidate, trackPos1, trackNeg, trackPos2)) {
-        hfSelDplusToPiKPiCandidate(statusDplusToPiKPi);
-        if (applyMl) {
-          hfMlDplusToPiKPiCandidate(outputMlNotPreselected);
-        }
+        fillCandidateWithoutMl(statusDplusToPiKPi, ptCand);
         continue;
       }
       SETBIT(statusDplusToPiKPi, aod::SelectionStep::RecoTopol);
@@ -264,10 +306,7 @@ struct HfCandidateSelectorDplusToPiKPi {
       }
 
       if (!selectionPID(pidTrackPos1Pion, pidTrackNegKaon, pidTrackPos2Pion)) { // exclude D±
-        hfSelDplusToPiKPiCandidate(statusDplusToPiKPi);
-        if (applyMl) {
-          hfMlDplusToPiKPiCandidate(outputMlNotPreselected);
-        }
+        fillCandidateWithoutMl(statusDplusToPiKPi, ptCand);
         continue;
       }
       SETBIT(statusDplusToPiKPi, aod::SelectionStep::RecoPID);
@@ -275,6 +314,12 @@ struct HfCandidateSelectorDplusToPiKPi {
         registry.fill(HIST("hSelections"), 2 + aod::SelectionStep::RecoPID, ptCand);
       }
 
+      if (applyMl && applyMlBatch) {
+        // ML selections, evaluated after the loop for all the candidates
+        candidateStatuses.push_back({statusDplusToPiKPi, ptCand, hfMlResponse.addToBatch(hfMlResponse.getInputFeatures(candidate, trackPos1, trackNeg, trackPos2), ptCand)});
+        continue;
+      }
+
       if (applyMl) {
         // ML selections
         std::vector<float> inputFeatures = hfMlResponse.getInputFeatures(candidate, trackPos1, trackNeg, trackPos2);
@@ -293,6 +338,10 @@ struct HfCandidateSelectorDplusToPiKPi {
 
       hfSelDplusToPiKPiCandidate(statusDplusToPiKPi);
     }
+
+    if (applyMl && applyMlBatch) {
+      fillCandidatesMlBatch();
+    }
   }
 };
 
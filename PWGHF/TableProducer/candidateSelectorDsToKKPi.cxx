@@ -65,6 +65,7 @@ struct HfCandidateSelectorDsToKKPi {
   Configurable<LabeledArray<double>> cutsMl{"cutsMl", {hf_cuts_ml::cuts[0], hf_cuts_ml::nBinsPt, hf_cuts_ml::nCutScores, hf_cuts_ml::labelsPt, hf_cuts_ml::labelsCutScore}, "ML selections per pT bin"};
   Configurable<int8_t> nClassesMl{"nClassesMl", (int8_t)hf_cuts_ml::nCutScores, "Number of classes in ML model"};
   Configurable<std::vector<std::string>> namesInputFeatures{"namesInputFeatures", std::vector<std::string>{"feature1", "feature2"}, "Names of ML model input features"};
+  Configurable<bool> applyMlBatch{"applyMlBatch", false, "Evaluate the ML models once per pT bin on all the candidates of the data frame passing the other selections"};
   // CCDB configuration
   Configurable<std::string> ccdbUrl{"ccdbUrl", "http://alice-ccdb.cern.ch", "url of the ccdb repository"};
   Configurable<std::vector<std::string>> modelPathsCCDB{"modelPathsCCDB", std::vector<std::string>{"EventFiltering/PWGHF/BDTDs"}, "Paths of models on CCDB"};
@@ -76,6 +77,15 @@ struct HfCandidateSelectorDsToKKPi {
   o2::analysis::HfMlResponseDsToKKPi<float> hfMlResponse;
   std::vector<float> outputMlDsToKKPi = {};
   std::vector<float> outputMlDsToPiKK = {};
+  // selection status of the candidates of the data frame, for the batched ML selections
+  struct CandidateStatus {
+    int statusDsToKKPi;
+    int statusDsToPiKK;
+    float pt{0.f};
+    int indexMlDsToKKPi{-1}; // index of the KKPi hypothesis in the ML batch, -1 if not evaluated
+    int indexMlDsToPiKK{-1}; // index of the PiKK hypothesis in the ML batch, -1 if not evaluated
+  };
+  std::vector<CandidateStatus> candidateStatuses;
   o2::ccdb::CcdbApi ccdbApi;
   TrackSelectorPi selectorPion;
   TrackSelectorKa selectorKaon;
@@ -233,9 +243,58 @@ struct HfCandidateSelectorDsToKKPi {
     return true;
   }
 
+  /// Fills the tables of a candidate rejected before the ML selections, or keeps it for the batched ML selections
+  void fillCandidateWithoutMl(int statusDsToKKPi, int statusDsToPiKK)
+  {
+    if (applyMl && applyMlBatch) {
+      candidateStatuses.push_back({statusDsToKKPi, statusDsToPiKK});
+      return;
+    }
+    hfSelDsToKKPiCandidate(statusDsToKKPi, statusDsToPiKK);
+    if (applyMl) {
+      hfMlDsToKKPiCandidate(outputMlDsToKKPi, outputMlDsToPiKK);
+    }
+  }
+
+  /// Applies the batched ML selections and fills the tables of the candidates of the data frame, in candidate order
+  void fillCandidatesMlBatch()
+  {
+    hfMlResponse.evaluateBatch();
+    for (auto& candidateStatus : candidateStatuses) {
+      outputMlDsToKKPi.clear();
+      outputMlDsToPiKK.clear();
+      bool isSelectedMlDsToKKPi = false;
+      bool isSelectedMlDsToPiKK = false;
+      if (candidateStatus.indexMlDsToKKPi >= 0) {
+        isSelectedMlDsToKKPi = hfMlResponse.isSelectedInBatch(candidateStatus.indexMlDsToKKPi);
+        hfMlResponse.getOutputInBatch(candidateStatus.indexMlDsToKKPi, outputMlDsToKKPi);
+      }
+      if (candidateStatus.indexMlDsToPiKK >= 0) {
+        isSelectedMlDsToPiKK = hfMlResponse.isSelectedInBatch(candidateStatus.indexMlDsToPiKK);
+        hfMlResponse.getOutputInBatch(candidateStatus.indexMlDsToPiKK, outputMlDsToPiKK);
+      }
+      hfMlDsToKKPiCandidate(outputMlDsToKKPi, outputMlDsToPiKK);
+      if (isSelectedMlDsToKKPi) {
+        SETBIT(candidateStatus.statusDsToKKPi, aod::SelectionStep::RecoMl);
+      }
+      if (isSelectedMlDsToPiKK) {
+        SETBIT(candidateStatus.statusDsToPiKK, aod::SelectionStep::RecoMl);
+      }
+      if ((isSelectedMlDsToKKPi || isSelectedMlDsToPiKK) && activateQA) {
+        registry.fill(HIST("hSelections"), 2 + aod::SelectionStep::RecoMl, candidateStatus.pt);
+      }
+      hfSelDsToKKPiCandidate(candidateStatus.statusDsToKKPi, candidateStatus.statusDsToPiKK);
+    }
+  }
+
   void process(aod::HfCand3Prong const& candidates,
                TracksSel const&)
   {
+    if (applyMl && applyMlBatch) {
+      candidateStatuses.clear();
+      hfMlResponse.clearBatch();
+    }
+
     // looping over 3-prong candidates
     for (const auto& candidate : candidates) {
 
@@ -247,10 +306,7 @@ struct HfCandidateSelectorDsToKKPi {
       outputMlDsToPiKK.clear();
 
       if (!(candidate.hfflag() & 1 << aod::hf_cand_3prong::DecayType::DsToKKPi)) {
-        hfSelDsToKKPiCandidate(statusDsToKKPi, statusDsToPiKK);
-        if (applyMl) {
-          hfMlDsToKKPiCandidate(outputMlDsToKKPi, outputMlDsToPiKK);
-        }
+        fillCandidateWithoutMl(statusDsToKKPi, statusDsToPiKK);
         if (activateQA) {
           registry.fill(HIST("hSelections"), 1, candidate.pt());
         }
@@ -268,20 +324,14 @@ struct HfCandidateSelectorDsToKKPi {
 
       // topological selections
       if (!selection(candidate)) {
-        hfSelDsToKKPiCandidate(statusDsToKKPi, statusDsToPiKK);
-        if (applyMl) {
-          hfMlDsToKKPiCandidate(outputMlDsToKKPi, outputMlDsToPiKK);
-        }
+        fillCandidateWithoutMl(statusDsToKKPi, statusDsToPiKK);
         continue;
       }
 
       bool topolDsToKKPi = selectionKKPi(candidate, trackPos1, trackNeg, trackPos2);
       bool topolDsToPiKK = selectionPiKK(candidate, trackPos1, trackNeg, trackPos2);
       if (!topolDsToKKPi && !topolDsToPiKK) {
-        hfSelDsToKKPiCandidate(statusDsToKKPi, statusDsToPiKK);
-        if (applyMl) {
-          hfMlDsToKKPiCandidate(outputMlDsToKKPi, outputMlDsToPiKK);
-        }
+        fillCandidateWithoutMl(statusDsToKKPi, statusDsToPiKK);
         continue;
       }
       if (topolDsToKKPi) {
@@ -324,10 +374,7 @@ struct HfCandidateSelectorDsToKKPi {
                            pidTrackPos2Kaon == TrackSelectorPID::Rejected);
 
       if (!pidDsToKKPi && !pidDsToPiKK) {
-        hfSelDsToKKPiCandidate(statusDsToKKPi, statusDsToPiKK);
-        if (applyMl) {
-          hfMlDsToKKPiCandidate(outputMlDsToKKPi, outputMlDsToPiKK);
-        }
+        fillCandidateWithoutMl(statusDsToKKPi, statusDsToPiKK);
         continue;
       }
       if (topolDsToKKPi && pidDsToKKPi) {
@@ -340,6 +387,19 @@ struct HfCandidateSelectorDsToKKPi {
         registry.fill(HIST("hSelections"), 2 + aod::SelectionStep::RecoPID, candidate.pt());
       }
 
+      if (applyMl && applyMlBatch) {
+        // ML selections, evaluated after the loop for all the candidates
+        CandidateStatus candidateStatus{statusDsToKKPi, statusDsToPiKK, candidate.pt()};
+        if (topolDsToKKPi && pidDsToKKPi) {
+          candidateStatus.indexMlDsToKKPi = hfMlResponse.addToBatch(hfMlResponse.getInputFeatures(candidate, trackPos1, trackNeg, trackPos2, true), candidate.pt());
+        }
+        if (topolDsToPiKK && pidDsToPiKK) {
+          candidateStatus.indexMlDsToPiKK = hfMlResponse.addToBatch(hfMlResponse.getInputFeatures(candidate, trackPos1, trackNeg, trackPos2, false), candidate.pt());
+        }
+        candidateStatuses.push_back(candidateStatus);
+        continue;
+      }
+
       if (applyMl) {
         // ML selections
         bool isSelectedMlDsToKKPi = false;
@@ -373,6 +433,10 @@ struct HfCandidateSelectorDsToKKPi {
 
       hfSelDsToKKPiCandidate(statusDsToKKPi, statusDsToPiKK);
     }
+
+    if (applyMl && applyMlBatch) {
+      fillCandidatesMlBatch();
+    }
   }
 };
 
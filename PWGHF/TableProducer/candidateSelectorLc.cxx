@@ -80,6 +80,7 @@ struct HfCandidateSelectorLc {
   Configurable<LabeledArray<double>> cutsMl{"cutsMl", {hf_cuts_ml::cuts[0], hf_cuts_ml::nBinsPt, hf_cuts_ml::nCutScores, hf_cuts_ml::labelsPt, hf_cuts_ml::labelsCutScore}, "ML selections per pT bin"};
   Configurable<int8_t> nClassesMl{"nClassesMl", (int8_t)hf_cuts_ml::nCutScores, "Number of classes in ML model"};
   Configurable<std::vector<std::string>> namesInputFeatures{"namesInputFeatures", std::vector<std::string>{"feature1", "feature2"}, "Names of ML model input features"};
+  Configurable<bool> applyMlBatch{"applyMlBatch", false, "Evaluate the ML models once per pT bin on all the candidates of the data frame passing the other selections"};
   // CCDB configuration
   Configurable<std::string> ccdbUrl{"ccdbUrl", "http://alice-ccdb.cern.ch", "url of the ccdb repository"};
   Configurable<std::vector<std::string>> modelPathsCCDB{"modelPathsCCDB", std::vector<std::string>{"EventFiltering/PWGHF/BDTLc"}, "Paths of models on CCDB"};
@@ -91,6 +92,14 @@ struct HfCandidateSelectorLc {
   o2::analysis::HfMlResponseLcToPKPi<float> hfMlResponse;
   std::vector<float> outputMlLcToPKPi = {};
   std::vector<float> outputMlLcToPiKP = {};
+  // selection status of the candidates of the data frame, for the batched ML selections
+  struct CandidateStatus {
+    bool isPreselectedLcToPKPi{false}; // LcToPKPi passing the selections before ML
+    bool isPreselectedLcToPiKP{false}; // LcToPiKP passing the selections before ML
+    float pt{0.f};
+    int indexMl{-1}; // index in the ML batch, shared by the two mass hypotheses that have the same input features
+  };
+  std::vector<CandidateStatus> candidateStatuses;
   o2::ccdb::CcdbApi ccdbApi;
   TrackSelectorPi selectorPion;
   TrackSelectorKa selectorKaon;
@@ -260,9 +269,56 @@ struct HfCandidateSelectorLc {
     return true;
   }
 
+  /// Fills the tables of a candidate rejected before the ML selections, or keeps it for the batched ML selections
+  void fillCandidateWithoutMl(int statusLcToPKPi, int statusLcToPiKP)
+  {
+    if (applyMl && applyMlBatch) {
+      candidateStatuses.emplace_back();
+      return;
+    }
+    hfSelLcCandidate(statusLcToPKPi, statusLcToPiKP);
+    if (applyMl) {
+      hfMlLcToPKPiCandidate(outputMlLcToPKPi, outputMlLcToPiKP);
+    }
+  }
+
+  /// Applies the batched ML selections and fills the tables of the candidates of the data frame, in candidate order
+  void fillCandidatesMlBatch()
+  {
+    hfMlResponse.evaluateBatch();
+    for (const auto& candidateStatus : candidateStatuses) {
+      outputMlLcToPKPi.clear();
+      outputMlLcToPiKP.clear();
+      if (candidateStatus.indexMl < 0) {
+        hfSelLcCandidate(0, 0);
+        hfMlLcToPKPiCandidate(outputMlLcToPKPi, outputMlLcToPiKP);
+        continue;
+      }
+      const bool isSelectedMl = hfMlResponse.isSelectedInBatch(candidateStatus.indexMl);
+      if (candidateStatus.isPreselectedLcToPKPi) {
+        hfMlResponse.getOutputInBatch(candidateStatus.indexMl, outputMlLcToPKPi);
+      }
+      if (candidateStatus.isPreselectedLcToPiKP) {
+        hfMlResponse.getOutputInBatch(candidateStatus.indexMl, outputMlLcToPiKP);
+      }
+      hfMlLcToPKPiCandidate(outputMlLcToPKPi, outputMlLcToPiKP);
+      if (isSelectedMl && activateQA) {
+        registry.fill(HIST("hSelections"), 2 + aod::SelectionStep::RecoMl, candidateStatus.pt);
+      }
+      const int statusLcToPKPi = isSelectedMl && candidateStatus.isPreselectedLcToPKPi ? 1 : 0;
+      const int statusLcToPiKP = isSelectedMl && candidateStatus.isPreselectedLcToPiKP ? 1 : 0;
+      hfSelLcCandidate(statusLcToPKPi, statusLcToPiKP);
+    }
+  }
+
   void process(aod::HfCand3Prong const& candidates,
                TracksSel const&)
   {
+    if (applyMl && applyMlBatch) {
+      candidateStatuses.clear();
+      hfMlResponse.clearBatch();
+    }
+
     // looping over 3-prong candidates
     for (const auto& candidate : candidates) {
 
@@ -276,10 +332,7 @@ struct HfCandidateSelectorLc {
       auto ptCand = candidate.pt();
 
       if (!(candidate.hfflag() & 1 << aod::hf_cand_3prong::DecayType::LcToPKPi)) {
-        hfSelLcCandidate(statusLcToPKPi, statusLcToPiKP);
-        if (applyMl) {
-          hfMlLcToPKPiCandidate(outputMlLcToPKPi, outputMlLcToPiKP);
-        }
+        fillCandidateWithoutMl(statusLcToPKPi, statusLcToPiKP);
         if (activateQA) {
           registry.fill(HIST("hSelections"), 1, ptCand);
         }
@@ -299,19 +352,13 @@ struct HfCandidateSelectorLc {
       // track quality selection
       bool trackQualitySel = isSelectedCandidateProngQuality(trackPos1, trackNeg, trackPos2);
       if (!trackQualitySel) {
-        hfSelLcCandidate(statusLcToPKPi, statusLcToPiKP);
-        if (applyMl) {
-          hfMlLcToPKPiCandidate(outputMlLcToPKPi, outputMlLcToPiKP);
-        }
+        fillCandidateWithoutMl(statusLcToPKPi, statusLcToPiKP);
         continue;
       }
 
       // conjugate-independent topological selection
       if (!selectionTopol(candidate)) {
-        hfSelLcCandidate(statusLcToPKPi, statusLcToPiKP);
-        if (applyMl) {
-          hfMlLcToPKPiCandidate(outputMlLcToPKPi, outputMlLcToPiKP);
-        }
+        fillCandidateWithoutMl(statusLcToPKPi, statusLcToPiKP);
         continue;
       }
 
@@ -320,10 +367,7 @@ struct HfCandidateSelectorLc {
       bool topolLcToPiKP = selectionTopolConjugate(candidate, trackPos2, trackNeg, trackPos1);
 
       if (!topolLcToPKPi && !topolLcToPiKP) {
-        hfSelLcCandidate(statusLcToPKPi, statusLcToPiKP);
-        if (applyMl) {
-          hfMlLcToPKPiCandidate(outputMlLcToPKPi, outputMlLcToPiKP);
-        }
+        fillCandidateWithoutMl(statusLcToPKPi, statusLcToPiKP);
         continue;
       }
 
@@ -383,10 +427,7 @@ struct HfCandidateSelectorLc {
       }
 
       if ((pidLcToPKPi == 0 && pidLcToPiKP == 0) || (pidBayesLcToPKPi == 0 && pidBayesLcToPiKP == 0)) {
-        hfSelLcCandidate(statusLcToPKPi, statusLcToPiKP);
-        if (applyMl) {
-          hfMlLcToPKPiCandidate(outputMlLcToPKPi, outputMlLcToPiKP);
-        }
+        fillCandidateWithoutMl(statusLcToPKPi, statusLcToPiKP);
         continue;
       }
 
@@ -394,6 +435,16 @@ struct HfCandidateSelectorLc {
         registry.fill(HIST("hSelections"), 2 + aod::SelectionStep::RecoPID, candidate.pt());
       }
 
+      if (applyMl && applyMlBatch) {
+        // ML selections, evaluated after the loop for all the candidates
+        CandidateStatus candidateStatus{pidLcToPKPi == 1 && pidBayesLcToPKPi == 1 && topolLcToPKPi, pidLcToPiKP == 1 && pidBayesLcToPiKP == 1 && topolLcToPiKP, ptCand};
+        if (candidateStatus.isPreselectedLcToPKPi || candidateStatus.isPreselectedLcToPiKP) {
+          candidateStatus.indexMl = hfMlResponse.addToBatch(hfMlResponse.getInputFeatures(candidate, trackPos1, trackNeg, trackPos2), ptCand);
+        }
+        candidateStatuses.push_back(candidateStatus);
+        continue;
+      }
+
       bool isSelectedMlLcToPKPi = true;
       bool isSelectedMlLcToPiKP = true;
       if (applyMl) {
@@ -431,6 +482,10 @@ struct HfCandidateSelectorLc {
 
       hfSelLcCandidate(statusLcToPKPi, statusLcToPiKP);
     }
+
+    if (applyMl && applyMlBatch) {
+      fillCandidatesMlBatch();
+    }
   }
 };
 
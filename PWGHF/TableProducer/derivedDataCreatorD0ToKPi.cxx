@@ -71,12 +71,25 @@ struct HfDerivedDataCreatorD0ToKPi {
   // Parameters for production of training samples
   Configurable<float> downSampleBkgFactor{"downSampleBkgFactor", 1., "Fraction of background candidates to keep for ML trainings"};
   Configurable<float> ptMaxForDownSample{"ptMaxForDownSample", 10., "Maximum pt for the application of the downsampling factor"};
+  // Writing mode
+  Configurable<bool> fillColumnar{"fillColumnar", false, "Select the collisions, candidates and MC particles first, then fill each enabled table in one loop over the selected rows"};
 
   HfHelper hfHelper;
   SliceCache cache;
   std::map<int, std::vector<int>> matchedCollisions; // indices of derived reconstructed collisions matched to the global indices of MC collisions
   std::map<int, bool> hasMcParticles;                // flags for MC collisions with HF particles
 
+  // Rows selected for the columnar filling
+  struct SelectedRow {
+    int64_t globalIndex;  // index in the original table
+    int derivedCollIndex; // index of the derived (MC) collision
+    int8_t candFlag;      // mass hypothesis of the candidate (0: D0, 1: D0bar), 0 for MC particles
+  };
+  std::vector<int64_t> collisionsToFill;     // global indices of the selected collisions
+  std::vector<SelectedRow> candidatesToFill; // selected candidates and mass hypotheses
+  std::vector<int64_t> mcCollisionsToFill;   // global indices of the selected MC collisions
+  std::vector<SelectedRow> particlesToFill;  // selected MC particles
+
   using CollisionsWCentMult = soa::Join<aod::Collisions, aod::CentFV0As, aod::CentFT0Ms, aod::CentFT0As, aod::CentFT0Cs, aod::PVMultZeqs>;
   using CollisionsWMcCentMult = soa::Join<aod::Collisions, aod::McCollisionLabels, aod::CentFV0As, aod::CentFT0Ms, aod::CentFT0As, aod::CentFT0Cs, aod::PVMultZeqs>;
   using TracksWPid = soa::Join<aod::Tracks, aod::TracksPidPi, aod::PidTpcTofFullPi, aod::TracksPidKa, aod::PidTpcTofFullKa>;
@@ -140,23 +153,29 @@ struct HfDerivedDataCreatorD0ToKPi {
     }
   };
 
+  template <typename T>
+  void fillTableCollBase(const T& collision)
+  {
+    rowCollBase(
+      collision.posX(),
+      collision.posY(),
+      collision.posZ(),
+      collision.numContrib(),
+      collision.centFT0A(),
+      collision.centFT0C(),
+      collision.centFT0M(),
+      collision.centFV0A(),
+      collision.multZeqNTracksPV());
+    // isEventReject,
+    // runNumber);
+  }
+
   template <bool isMC, typename T>
   // void fillTablesCollision(const T& collision, int isEventReject, int runNumber)
   void fillTablesCollision(const T& collision)
   {
     if (fillCollBase) {
-      rowCollBase(
-        collision.posX(),
-        collision.posY(),
-        collision.posZ(),
-        collision.numContrib(),
-        collision.centFT0A(),
-        collision.centFT0C(),
-        collision.centFT0M(),
-        collision.centFV0A(),
-        collision.multZeqNTracksPV());
-      // isEventReject,
-      // runNumber);
+      fillTableCollBase(collision);
     }
     if (fillCollId) {
       rowCollId(
@@ -191,6 +210,64 @@ struct HfDerivedDataCreatorD0ToKPi {
     }
   }
 
+  template <typename T, typename U>
+  void fillTableCandidatePar(const T& candidate, const U& prong0, const U& prong1)
+  {
+    rowCandidatePar(
+      candidate.chi2PCA(),
+      candidate.cpa(),
+      candidate.cpaXY(),
+      candidate.decayLength(),
+      candidate.decayLengthXY(),
+      candidate.decayLengthNormalised(),
+      candidate.decayLengthXYNormalised(),
+      candidate.ptProng0(),
+      candidate.ptProng1(),
+      candidate.impactParameter0(),
+      candidate.impactParameter1(),
+      candidate.impactParameterNormalised0(),
+      candidate.impactParameterNormalised1(),
+      prong0.tpcNSigmaPi(),
+      prong0.tpcNSigmaKa(),
+      prong0.tofNSigmaPi(),
+      prong0.tofNSigmaKa(),
+      prong0.tpcTofNSigmaPi(),
+      prong0.tpcTofNSigmaKa(),
+      prong1.tpcNSigmaPi(),
+      prong1.tpcNSigmaKa(),
+      prong1.tofNSigmaPi(),
+      prong1.tofNSigmaKa(),
+      prong1.tpcTofNSigmaPi(),
+      prong1.tpcTofNSigmaKa(),
+      candidate.maxNormalisedDeltaIP(),
+      candidate.impactParameterProduct());
+  }
+
+  template <typename T>
+  void fillTableCandidateParE(const T& candidate, double cosThetaStar, double topoChi2, double ct)
+  {
+    rowCandidateParE(
+      candidate.xSecondaryVertex(),
+      candidate.ySecondaryVertex(),
+      candidate.zSecondaryVertex(),
+      candidate.errorDecayLength(),
+      candidate.errorDecayLengthXY(),
+      topoChi2,
+      candidate.rSecondaryVertex(),
+      RecoDecay::p(candidate.pxProng0(), candidate.pyProng0(), candidate.pzProng0()),
+      RecoDecay::p(candidate.pxProng1(), candidate.pyProng1(), candidate.pzProng1()),
+      candidate.pxProng0(),
+      candidate.pyProng0(),
+      candidate.pzProng0(),
+      candidate.pxProng1(),
+      candidate.pyProng1(),
+      candidate.pzProng1(),
+      candidate.errorImpactParameter0(),
+      candidate.errorImpactParameter1(),
+      cosThetaStar,
+      ct);
+  }
+
   template <typename T, typename U>
   void fillTablesCandidate(const T& candidate, const U& prong0, const U& prong1, int candFlag, double invMass, double cosThetaStar, double topoChi2,
                            double ct, double y, int8_t flagMc, int8_t origin, const std::vector<float>& mlScores)
@@ -205,56 +282,10 @@ struct HfDerivedDataCreatorD0ToKPi {
         y);
     }
     if (fillCandidatePar) {
-      rowCandidatePar(
-        candidate.chi2PCA(),
-        candidate.cpa(),
-        candidate.cpaXY(),
-        candidate.decayLength(),
-        candidate.decayLengthXY(),
-        candidate.decayLengthNormalised(),
-        candidate.decayLengthXYNormalised(),
-        candidate.ptProng0(),
-        candidate.ptProng1(),
-        candidate.impactParameter0(),
-        candidate.impactParameter1(),
-        candidate.impactParameterNormalised0(),
-        candidate.impactParameterNormalised1(),
-        prong0.tpcNSigmaPi(),
-        prong0.tpcNSigmaKa(),
-        prong0.tofNSigmaPi(),
-        prong0.tofNSigmaKa(),
-        prong0.tpcTofNSigmaPi(),
-        prong0.tpcTofNSigmaKa(),
-        prong1.tpcNSigmaPi(),
-        prong1.tpcNSigmaKa(),
-        prong1.tofNSigmaPi(),
-        prong1.tofNSigmaKa(),
-        prong1.tpcTofNSigmaPi(),
-        prong1.tpcTofNSigmaKa(),
-        candidate.maxNormalisedDeltaIP(),
-        candidate.impactParameterProduct());
+      fillTableCandidatePar(candidate, prong0, prong1);
     }
     if (fillCandidateParE) {
-      rowCandidateParE(
-        candidate.xSecondaryVertex(),
-        candidate.ySecondaryVertex(),
-        candidate.zSecondaryVertex(),
-        candidate.errorDecayLength(),
-        candidate.errorDecayLengthXY(),
-        topoChi2,
-        candidate.rSecondaryVertex(),
-        RecoDecay::p(candidate.pxProng0(), candidate.pyProng0(), candidate.pzProng0()),
-        RecoDecay::p(candidate.pxProng1(), candidate.pyProng1(), candidate.pzProng1()),
-        candidate.pxProng0(),
-        candidate.pyProng0(),
-        candidate.pzProng0(),
-        candidate.pxProng1(),
-        candidate.pyProng1(),
-        candidate.pzProng1(),
-        candidate.errorImpactParameter0(),
-        candidate.errorImpactParameter1(),
-        cosThetaStar,
-        ct);
+      fillTableCandidateParE(candidate, cosThetaStar, topoChi2, ct);
     }
     if (fillCandidateSel) {
       rowCandidateSel(
@@ -297,6 +328,172 @@ struct HfDerivedDataCreatorD0ToKPi {
     }
   }
 
+  /// Fills the enabled collision and candidate tables with the selected rows, one table at a time
+  template <aod::hf_cand::VertexerType reconstructionType, bool isMl, bool isMc, typename CollType, typename CandType>
+  void fillTablesCandidateColumnar(CollType const& collisions,
+                                   Partition<CandType>& candidates)
+  {
+    const auto sizeTableColl = collisionsToFill.size();
+    if (fillCollBase) {
+      rowCollBase.reserve(sizeTableColl);
+      for (const auto& globalIndex : collisionsToFill) {
+        fillTableCollBase(collisions.rawIteratorAt(globalIndex));
+      }
+    }
+    if (fillCollId) {
+      rowCollId.reserve(sizeTableColl);
+      for (const auto& globalIndex : collisionsToFill) {
+        rowCollId(
+          globalIndex);
+      }
+    }
+
+    const auto sizeTableCand = candidatesToFill.size();
+    if (fillCandidateBase) {
+      rowCandidateBase.reserve(sizeTableCand);
+      for (const auto& row : candidatesToFill) {
+        auto candidate = candidates->rawIteratorAt(row.globalIndex);
+        float invMass;
+        if constexpr (reconstructionType == aod::hf_cand::VertexerType::KfParticle) {
+          invMass = row.candFlag == 0 ? candidate.kfGeoMassD0() : candidate.kfGeoMassD0bar();
+        } else {
+          invMass = row.candFlag == 0 ? hfHelper.invMassD0ToPiK(candidate) : hfHelper.invMassD0barToKPi(candidate);
+        }
+        rowCandidateBase(
+          row.derivedCollIndex,
+          candidate.pt(),
+          candidate.eta(),
+          candidate.phi(),
+          invMass,
+          hfHelper.yD0(candidate));
+      }
+    }
+    if (fillCandidatePar) {
+      rowCandidatePar.reserve(sizeTableCand);
+      for (const auto& row : candidatesToFill) {
+        auto candidate = candidates->rawIteratorAt(row.globalIndex);
+        fillTableCandidatePar(candidate, candidate.template prong0_as<TracksWPid>(), candidate.template prong1_as<TracksWPid>());
+      }
+    }
+    if (fillCandidateParE) {
+      rowCandidateParE.reserve(sizeTableCand);
+      for (const auto& row : candidatesToFill) {
+        auto candidate = candidates->rawIteratorAt(row.globalIndex);
+        float topolChi2PerNdf = -999.;
+        if constexpr (reconstructionType == aod::hf_cand::VertexerType::KfParticle) {
+          topolChi2PerNdf = candidate.kfTopolChi2OverNdf();
+        }
+        double cosThetaStar = row.candFlag == 0 ? hfHelper.cosThetaStarD0(candidate) : hfHelper.cosThetaStarD0bar(candidate);
+        fillTableCandidateParE(candidate, cosThetaStar, topolChi2PerNdf, hfHelper.ctD0(candidate));
+      }
+    }
+    if (fillCandidateSel) {
+      rowCandidateSel.reserve(sizeTableCand);
+      for (const auto& row : candidatesToFill) {
+        rowCandidateSel(
+          BIT(row.candFlag));
+      }
+    }
+    if (fillCandidateMl) {
+      rowCandidateMl.reserve(sizeTableCand);
+      std::vector<float> mlScores;
+      for (const auto& row : candidatesToFill) {
+        if constexpr (isMl) {
+          auto candidate = candidates->rawIteratorAt(row.globalIndex);
+          if (row.candFlag == 0) {
+            mlScores.assign(candidate.mlProbD0().begin(), candidate.mlProbD0().end());
+          } else {
+            mlScores.assign(candidate.mlProbD0bar().begin(), candidate.mlProbD0bar().end());
+          }
+        }
+        rowCandidateMl(
+          mlScores);
+      }
+    }
+    if (fillCandidateId) {
+      rowCandidateId.reserve(sizeTableCand);
+      for (const auto& row : candidatesToFill) {
+        auto candidate = candidates->rawIteratorAt(row.globalIndex);
+        rowCandidateId(
+          candidate.collisionId(),
+          candidate.prong0Id(),
+          candidate.prong1Id());
+      }
+    }
+    if (fillCandidateMc) {
+      rowCandidateMc.reserve(sizeTableCand);
+      for (const auto& row : candidatesToFill) {
+        if constexpr (isMc) {
+          auto candidate = candidates->rawIteratorAt(row.globalIndex);
+          rowCandidateMc(
+            candidate.flagMcMatchRec(),
+            candidate.originMcRec());
+        } else {
+          rowCandidateMc(
+            0,
+            0);
+        }
+      }
+    }
+  }
+
+  /// Fills the enabled MC collision and MC particle tables with the selected rows, one table at a time
+  template <typename CollisionType, typename ParticleType>
+  void fillTablesMcColumnar(CollisionType const& mcCollisions,
+                            ParticleType const& mcParticles)
+  {
+    const auto sizeTableMcColl = mcCollisionsToFill.size();
+    if (fillMcCollBase) {
+      rowMcCollBase.reserve(sizeTableMcColl);
+      for (const auto& globalIndex : mcCollisionsToFill) {
+        auto mcCollision = mcCollisions.rawIteratorAt(globalIndex);
+        rowMcCollBase(
+          mcCollision.posX(),
+          mcCollision.posY(),
+          mcCollision.posZ());
+      }
+    }
+    if (fillMcCollId) {
+      rowMcCollId.reserve(sizeTableMcColl);
+      for (const auto& globalIndex : mcCollisionsToFill) {
+        rowMcCollId(
+          globalIndex);
+      }
+    }
+    if (fillMcRCollId) {
+      rowMcRCollId.reserve(sizeTableMcColl);
+      for (const auto& globalIndex : mcCollisionsToFill) {
+        rowMcRCollId(
+          matchedCollisions[globalIndex]);
+      }
+    }
+
+    const auto sizeTablePart = particlesToFill.size();
+    if (fillParticleBase) {
+      rowParticleBase.reserve(sizeTablePart);
+      for (const auto& row : particlesToFill) {
+        auto particle = mcParticles.rawIteratorAt(row.globalIndex);
+        rowParticleBase(
+          row.derivedCollIndex,
+          particle.pt(),
+          particle.eta(),
+          particle.phi(),
+          RecoDecayPtEtaPhi::y(particle.pt(), particle.eta(), o2::constants::physics::MassD0),
+          particle.flagMcMatchGen(),
+          particle.originMcGen());
+      }
+    }
+    if (fillParticleId) {
+      rowParticleId.reserve(sizeTablePart);
+      for (const auto& row : particlesToFill) {
+        auto particle = mcParticles.rawIteratorAt(row.globalIndex);
+        rowParticleId(
+          particle.mcCollisionId(),
+          row.globalIndex);
+      }
+    }
+  }
+
   template <aod::hf_cand::VertexerType reconstructionType, bool isMl, bool isMc, bool onlyBkg, bool onlySig, typename CollType, typename CandType>
   void processCandidates(CollType const& collisions,
                          Partition<CandType>& candidates,
@@ -309,9 +506,14 @@ struct HfDerivedDataCreatorD0ToKPi {
         matchedCollisions.clear();
       }
     }
-    auto sizeTableColl = collisions.size();
-    reserveTable(rowCollBase, fillCollBase, sizeTableColl);
-    reserveTable(rowCollId, fillCollId, sizeTableColl);
+    if (fillColumnar) {
+      collisionsToFill.clear();
+      candidatesToFill.clear();
+    } else {
+      auto sizeTableColl = collisions.size();
+      reserveTable(rowCollBase, fillCollBase, sizeTableColl);
+      reserveTable(rowCollId, fillCollId, sizeTableColl);
+    }
     for (const auto& collision : collisions) {
       auto thisCollId = collision.globalIndex();
       auto candidatesThisColl = candidates->sliceByCached(aod::hf_cand::collisionId, thisCollId, cache); // FIXME
@@ -327,18 +529,29 @@ struct HfDerivedDataCreatorD0ToKPi {
         LOGF(debug, "Skipping rec. collision %d", thisCollId);
         continue;
       }
-      LOGF(debug, "Filling rec. collision %d at derived index %d", thisCollId, rowCollBase.lastIndex() + 1);
-      // fillTablesCollision(collision, 0, collision.bc().runNumber());
-      fillTablesCollision<isMc>(collision);
-
-      // Fill candidate properties
-      reserveTable(rowCandidateBase, fillCandidateBase, sizeTableCand);
-      reserveTable(rowCandidatePar, fillCandidatePar, sizeTableCand);
-      reserveTable(rowCandidateParE, fillCandidateParE, sizeTableCand);
-      reserveTable(rowCandidateSel, fillCandidateSel, sizeTableCand);
-      reserveTable(rowCandidateId, fillCandidateId, sizeTableCand);
-      if constexpr (isMc) {
-        reserveTable(rowCandidateMc, fillCandidateMc, sizeTableCand);
+      int derivedCollIndex = collisionsToFill.size();
+      if (fillColumnar) {
+        LOGF(debug, "Selecting rec. collision %d for derived index %d", thisCollId, derivedCollIndex);
+        collisionsToFill.push_back(thisCollId);
+        if constexpr (isMc) {
+          if (fillMcRCollId && collision.has_mcCollision()) {
+            matchedCollisions[collision.mcCollisionId()].push_back(derivedCollIndex);
+          }
+        }
+      } else {
+        LOGF(debug, "Filling rec. collision %d at derived index %d", thisCollId, rowCollBase.lastIndex() + 1);
+        // fillTablesCollision(collision, 0, collision.bc().runNumber());
+        fillTablesCollision<isMc>(collision);
+
+        // Fill candidate properties
+        reserveTable(rowCandidateBase, fillCandidateBase, sizeTableCand);
+        reserveTable(rowCandidatePar, fillCandidatePar, sizeTableCand);
+        reserveTable(rowCandidateParE, fillCandidateParE, sizeTableCand);
+        reserveTable(rowCandidateSel, fillCandidateSel, sizeTableCand);
+        reserveTable(rowCandidateId, fillCandidateId, sizeTableCand);
+        if constexpr (isMc) {
+          reserveTable(rowCandidateMc, fillCandidateMc, sizeTableCand);
+        }
       }
       int8_t flagMcRec = 0, origin = 0;
       for (const auto& candidate : candidatesThisColl) {
@@ -362,6 +575,15 @@ struct HfDerivedDataCreatorD0ToKPi {
             }
           }
         }
+        if (fillColumnar) {
+          if (candidate.isSelD0()) {
+            candidatesToFill.push_back({candidate.globalIndex(), derivedCollIndex, 0});
+          }
+          if (candidate.isSelD0bar()) {
+            candidatesToFill.push_back({candidate.globalIndex(), derivedCollIndex, 1});
+          }
+          continue;
+        }
         auto prong0 = candidate.template prong0_as<TracksWPid>();
         auto prong1 = candidate.template prong1_as<TracksWPid>();
         double ct = hfHelper.ctD0(candidate);
@@ -389,6 +611,9 @@ struct HfDerivedDataCreatorD0ToKPi {
         }
       }
     }
+    if (fillColumnar) {
+      fillTablesCandidateColumnar<reconstructionType, isMl, isMc>(collisions, candidates);
+    }
   }
 
   template <typename CollisionType, typename ParticleType>
@@ -413,9 +638,14 @@ struct HfDerivedDataCreatorD0ToKPi {
                           ParticleType const& mcParticles)
   {
     // Fill MC collision properties
-    auto sizeTableMcColl = mcCollisions.size();
-    reserveTable(rowMcCollBase, fillMcCollBase, sizeTableMcColl);
-    reserveTable(rowMcRCollId, fillMcRCollId, sizeTableMcColl);
+    if (fillColumnar) {
+      mcCollisionsToFill.clear();
+      particlesToFill.clear();
+    } else {
+      auto sizeTableMcColl = mcCollisions.size();
+      reserveTable(rowMcCollBase, fillMcCollBase, sizeTableMcColl);
+      reserveTable(rowMcRCollId, fillMcRCollId, sizeTableMcColl);
+    }
     for (const auto& mcCollision : mcCollisions) {
       auto thisMcCollId = mcCollision.globalIndex();
       auto particlesThisMcColl = mcParticles.sliceBy(mcParticlesPerMcCollision, thisMcCollId);
@@ -427,6 +657,15 @@ struct HfDerivedDataCreatorD0ToKPi {
         LOGF(debug, "Skipping MC collision %d", thisMcCollId);
         continue;
       }
+      if (fillColumnar) {
+        int derivedMcCollIndex = mcCollisionsToFill.size();
+        LOGF(debug, "Selecting MC collision %d for derived index %d", thisMcCollId, derivedMcCollIndex);
+        mcCollisionsToFill.push_back(thisMcCollId);
+        for (const auto& particle : particlesThisMcColl) {
+          particlesToFill.push_back({particle.globalIndex(), derivedMcCollIndex, 0});
+        }
+        continue;
+      }
       LOGF(debug, "Filling MC collision %d at derived index %d", thisMcCollId, rowMcCollBase.lastIndex() + 1);
       fillTablesMcCollision(mcCollision);
 
@@ -437,6 +676,9 @@ struct HfDerivedDataCreatorD0ToKPi {
         fillTablesParticle(particle, o2::constants::physics::MassD0);
       }
     }
+    if (fillColumnar) {
+      fillTablesMcColumnar(mcCollisions, mcParticles);
+    }
   }
 
   void processDataWithDCAFitterN(CollisionsWCentMult const& collisions,
@@ -71,12 +71,25 @@ struct HfDerivedDataCreatorLcToPKPi {
   // Parameters for production of training samples
   Configurable<float> downSampleBkgFactor{"downSampleBkgFactor", 1., "Fraction of background candidates to keep for ML trainings"};
   Configurable<float> ptMaxForDownSample{"ptMaxForDownSample", 10., "Maximum pt for the application of the downsampling factor"};
+  // Writing mode
+  Configurable<bool> fillColumnar{"fillColumnar", false, "Select the collisions, candidates and MC particles first, then fill each enabled table in one loop over the selected rows"};
 
   HfHelper hfHelper;
   SliceCache cache;
   std::map<int, std::vector<int>> matchedCollisions; // indices of derived reconstructed collisions matched to the global indices of MC collisions
   std::map<int, bool> hasMcParticles;                // flags for MC collisions with HF particles
 
+  // Rows selected for the columnar filling
+  struct SelectedRow {
+    int64_t globalIndex;  // index in the original table
+    int derivedCollIndex; // index of the derived (MC) collision
+    int8_t candFlag;      // mass hypothesis of the candidate (0: pKpi, 1: piKp), 0 for MC particles
+  };
+  std::vector<int64_t> collisionsToFill;     // global indices of the selected collisions
+  std::vector<SelectedRow> candidatesToFill; // selected candidates and mass hypotheses
+  std::vector<int64_t> mcCollisionsToFill;   // global indices of the selected MC collisions
+  std::vector<SelectedRow> particlesToFill;  // selected MC particles
+
   using CollisionsWCentMult = soa::Join<aod::Collisions, aod::CentFV0As, aod::CentFT0Ms, aod::CentFT0As, aod::CentFT0Cs, aod::PVMultZeqs>;
   using CollisionsWMcCentMult = soa::Join<aod::Collisions, aod::McCollisionLabels, aod::CentFV0As, aod::CentFT0Ms, aod::CentFT0As, aod::CentFT0Cs, aod::PVMultZeqs>;
   using TracksWPid = soa::Join<aod::Tracks, aod::TracksPidPi, aod::PidTpcTofFullPi, aod::TracksPidKa, aod::PidTpcTofFullKa, aod::TracksPidPr, aod::PidTpcTofFullPr>;
@@ -123,23 +136,29 @@ struct HfDerivedDataCreatorLcToPKPi {
     }
   };
 
+  template <typename T>
+  void fillTableCollBase(const T& collision)
+  {
+    rowCollBase(
+      collision.posX(),
+      collision.posY(),
+      collision.posZ(),
+      collision.numContrib(),
+      collision.centFT0A(),
+      collision.centFT0C(),
+      collision.centFT0M(),
+      collision.centFV0A(),
+      collision.multZeqNTracksPV());
+    // isEventReject,
+    // runNumber);
+  }
+
   template <bool isMC, typename T>
   // void fillTablesCollision(const T& collision, int isEventReject, int runNumber)
   void fillTablesCollision(const T& collision)
   {
     if (fillCollBase) {
-      rowCollBase(
-        collision.posX(),
-        collision.posY(),
-        collision.posZ(),
-        collision.numContrib(),
-        collision.centFT0A(),
-        collision.centFT0C(),
-        collision.centFT0M(),
-        collision.centFV0A(),
-        collision.multZeqNTracksPV());
-      // isEventReject,
-      // runNumber);
+      fillTableCollBase(collision);
     }
     if (fillCollId) {
       rowCollId(
@@ -174,6 +193,72 @@ struct HfDerivedDataCreatorLcToPKPi {
     }
   }
 
+  template <typename T, typename U>
+  void fillTableCandidatePar(const T& candidate, const U& prong0, const U& prong1, const U& prong2)
+  {
+    rowCandidatePar(
+      candidate.chi2PCA(),
+      candidate.nProngsContributorsPV(),
+      candidate.cpa(),
+      candidate.cpaXY(),
+      candidate.decayLength(),
+      candidate.decayLengthXY(),
+      candidate.decayLengthNormalised(),
+      candidate.decayLengthXYNormalised(),
+      candidate.ptProng0(),
+      candidate.ptProng1(),
+      candidate.ptProng2(),
+      candidate.impactParameter0(),
+      candidate.impactParameter1(),
+      candidate.impactParameter2(),
+      candidate.impactParameterNormalised0(),
+      candidate.impactParameterNormalised1(),
+      candidate.impactParameterNormalised2(),
+      prong0.tpcNSigmaPi(),
+      prong0.tpcNSigmaPr(),
+      prong0.tofNSigmaPi(),
+      prong0.tofNSigmaPr(),
+      prong0.tpcTofNSigmaPi(),
+      prong0.tpcTofNSigmaPr(),
+      prong1.tpcNSigmaKa(),
+      prong1.tofNSigmaKa(),
+      prong1.tpcTofNSigmaKa(),
+      prong2.tpcNSigmaPi(),
+      prong2.tpcNSigmaPr(),
+      prong2.tofNSigmaPi(),
+      prong2.tofNSigmaPr(),
+      prong2.tpcTofNSigmaPi(),
+      prong2.tpcTofNSigmaPr());
+  }
+
+  template <typename T>
+  void fillTableCandidateParE(const T& candidate, double ct)
+  {
+    rowCandidateParE(
+      candidate.xSecondaryVertex(),
+      candidate.ySecondaryVertex(),
+      candidate.zSecondaryVertex(),
+      candidate.errorDecayLength(),
+      candidate.errorDecayLengthXY(),
+      candidate.rSecondaryVertex(),
+      RecoDecay::p(candidate.pxProng0(), candidate.pyProng0(), candidate.pzProng0()),
+      RecoDecay::p(candidate.pxProng1(), candidate.pyProng1(), candidate.pzProng1()),
+      RecoDecay::p(candidate.pxProng2(), candidate.pyProng2(), candidate.pzProng2()),
+      candidate.pxProng0(),
+      candidate.pyProng0(),
+      candidate.pzProng0(),
+      candidate.pxProng1(),
+      candidate.pyProng1(),
+      candidate.pzProng1(),
+      candidate.pxProng2(),
+      candidate.pyProng2(),
+      candidate.pzProng2(),
+      candidate.errorImpactParameter0(),
+      candidate.errorImpactParameter1(),
+      candidate.errorImpactParameter2(),
+      ct);
+  }
+
   template <typename T, typename U>
   void fillTablesCandidate(const T& candidate, const U& prong0, const U& prong1, const U& prong2, int candFlag, double invMass,
                            double ct, double y, int8_t flagMc, int8_t origin, int8_t swapping, const std::vector<float>& mlScores)
@@ -188,64 +273,10 @@ struct HfDerivedDataCreatorLcToPKPi {
         y);
     }
     if (fillCandidatePar) {
-      rowCandidatePar(
-        candidate.chi2PCA(),
-        candidate.nProngsContributorsPV(),
-        candidate.cpa(),
-        candidate.cpaXY(),
-        candidate.decayLength(),
-        candidate.decayLengthXY(),
-        candidate.decayLengthNormalised(),
-        candidate.decayLengthXYNormalised(),
-        candidate.ptProng0(),
-        candidate.ptProng1(),
-        candidate.ptProng2(),
-        candidate.impactParameter0(),
-        candidate.impactParameter1(),
-        candidate.impactParameter2(),
-        candidate.impactParameterNormalised0(),
-        candidate.impactParameterNormalised1(),
-        candidate.impactParameterNormalised2(),
-        prong0.tpcNSigmaPi(),
-        prong0.tpcNSigmaPr(),
-        prong0.tofNSigmaPi(),
-        prong0.tofNSigmaPr(),
-        prong0.tpcTofNSigmaPi(),
-        prong0.tpcTofNSigmaPr(),
-        prong1.tpcNSigmaKa(),
-        prong1.tofNSigmaKa(),
-        prong1.tpcTofNSigmaKa(),
-        prong2.tpcNSigmaPi(),
-        prong2.tpcNSigmaPr(),
-        prong2.tofNSigmaPi(),
-        prong2.tofNSigmaPr(),
-        prong2.tpcTofNSigmaPi(),
-        prong2.tpcTofNSigmaPr());
+      fillTableCandidatePar(candidate, prong0, prong1, prong2);
     }
     if (fillCandidateParE) {
-      rowCandidateParE(
-        candidate.xSecondaryVertex(),
-        candidate.ySecondaryVertex(),
-        candidate.zSecondaryVertex(),
-        candidate.errorDecayLength(),
-        candidate.errorDecayLengthXY(),
-        candidate.rSecondaryVertex(),
-        RecoDecay::p(candidate.pxProng0(), candidate.pyProng0(), candidate.pzProng0()),
-        RecoDecay::p(candidate.pxProng1(), candidate.pyProng1(), candidate.pzProng1()),
-        RecoDecay::p(candidate.pxProng2(), candidate.pyProng2(), candidate.pzProng2()),
-        candidate.pxProng0(),
-        candidate.pyProng0(),
-        candidate.pzProng0(),
-        candidate.pxProng1(),
-        candidate.pyProng1(),
-        candidate.pzProng1(),
-        candidate.pxProng2(),
-        candidate.pyProng2(),
-        candidate.pzProng2(),
-        candidate.errorImpactParameter0(),
-        candidate.errorImpactParameter1(),
-        candidate.errorImpactParameter2(),
-        ct);
+      fillTableCandidateParE(candidate, ct);
     }
     if (fillCandidateSel) {
       rowCandidateSel(
@@ -290,6 +321,164 @@ struct HfDerivedDataCreatorLcToPKPi {
     }
   }
 
+  /// Fills the enabled collision and candidate tables with the selected rows, one table at a time
+  template <bool isMl, bool isMc, typename CollType, typename CandType>
+  void fillTablesCandidateColumnar(CollType const& collisions,
+                                   Partition<CandType>& candidates)
+  {
+    const auto sizeTableColl = collisionsToFill.size();
+    if (fillCollBase) {
+      rowCollBase.reserve(sizeTableColl);
+      for (const auto& globalIndex : collisionsToFill) {
+        fillTableCollBase(collisions.rawIteratorAt(globalIndex));
+      }
+    }
+    if (fillCollId) {
+      rowCollId.reserve(sizeTableColl);
+      for (const auto& globalIndex : collisionsToFill) {
+        rowCollId(
+          globalIndex);
+      }
+    }
+
+    const auto sizeTableCand = candidatesToFill.size();
+    if (fillCandidateBase) {
+      rowCandidateBase.reserve(sizeTableCand);
+      for (const auto& row : candidatesToFill) {
+        auto candidate = candidates->rawIteratorAt(row.globalIndex);
+        rowCandidateBase(
+          row.derivedCollIndex,
+          candidate.pt(),
+          candidate.eta(),
+          candidate.phi(),
+          row.candFlag == 0 ? hfHelper.invMassLcToPKPi(candidate) : hfHelper.invMassLcToPiKP(candidate),
+          hfHelper.yLc(candidate));
+      }
+    }
+    if (fillCandidatePar) {
+      rowCandidatePar.reserve(sizeTableCand);
+      for (const auto& row : candidatesToFill) {
+        auto candidate = candidates->rawIteratorAt(row.globalIndex);
+        fillTableCandidatePar(candidate, candidate.template prong0_as<TracksWPid>(), candidate.template prong1_as<TracksWPid>(), candidate.template prong2_as<TracksWPid>());
+      }
+    }
+    if (fillCandidateParE) {
+      rowCandidateParE.reserve(sizeTableCand);
+      for (const auto& row : candidatesToFill) {
+        auto candidate = candidates->rawIteratorAt(row.globalIndex);
+        fillTableCandidateParE(candidate, hfHelper.ctLc(candidate));
+      }
+    }
+    if (fillCandidateSel) {
+      rowCandidateSel.reserve(sizeTableCand);
+      for (const auto& row : candidatesToFill) {
+        rowCandidateSel(
+          BIT(row.candFlag));
+      }
+    }
+    if (fillCandidateMl) {
+      rowCandidateMl.reserve(sizeTableCand);
+      std::vector<float> mlScores;
+      for (const auto& row : candidatesToFill) {
+        if constexpr (isMl) {
+          auto candidate = candidates->rawIteratorAt(row.globalIndex);
+          if (row.candFlag == 0) {
+            mlScores.assign(candidate.mlProbLcToPKPi().begin(), candidate.mlProbLcToPKPi().end());
+          } else {
+            mlScores.assign(candidate.mlProbLcToPiKP().begin(), candidate.mlProbLcToPiKP().end());
+          }
+        }
+        rowCandidateMl(
+          mlScores);
+      }
+    }
+    if (fillCandidateId) {
+      rowCandidateId.reserve(sizeTableCand);
+      for (const auto& row : candidatesToFill) {
+        auto candidate = candidates->rawIteratorAt(row.globalIndex);
+        rowCandidateId(
+          candidate.collisionId(),
+          candidate.prong0Id(),
+          candidate.prong1Id(),
+          candidate.prong2Id());
+      }
+    }
+    if (fillCandidateMc) {
+      rowCandidateMc.reserve(sizeTableCand);
+      for (const auto& row : candidatesToFill) {
+        if constexpr (isMc) {
+          auto candidate = candidates->rawIteratorAt(row.globalIndex);
+          rowCandidateMc(
+            candidate.flagMcMatchRec(),
+            candidate.originMcRec(),
+            candidate.isCandidateSwapped());
+        } else {
+          rowCandidateMc(
+            0,
+            0,
+            0);
+        }
+      }
+    }
+  }
+
+  /// Fills the enabled MC collision and MC particle tables with the selected rows, one table at a time
+  template <typename CollisionType, typename ParticleType>
+  void fillTablesMcColumnar(CollisionType const& mcCollisions,
+                            ParticleType const& mcParticles)
+  {
+    const auto sizeTableMcColl = mcCollisionsToFill.size();
+    if (fillMcCollBase) {
+      rowMcCollBase.reserve(sizeTableMcColl);
+      for (const auto& globalIndex : mcCollisionsToFill) {
+        auto mcCollision = mcCollisions.rawIteratorAt(globalIndex);
+        rowMcCollBase(
+          mcCollision.posX(),
+          mcCollision.posY(),
+          mcCollision.posZ());
+      }
+    }
+    if (fillMcCollId) {
+      rowMcCollId.reserve(sizeTableMcColl);
+      for (const auto& globalIndex : mcCollisionsToFill) {
+        rowMcCollId(
+          globalIndex);
+      }
+    }
+    if (fillMcRCollId) {
+      rowMcRCollId.reserve(sizeTableMcColl);
+      for (const auto& globalIndex : mcCollisionsToFill) {
+        rowMcRCollId(
+          matchedCollisions[globalIndex]);
+      }
+    }
+
+    const auto sizeTablePart = particlesToFill.size();
+    if (fillParticleBase) {
+      rowParticleBase.reserve(sizeTablePart);
+      for (const auto& row : particlesToFill) {
+        auto particle = mcParticles.rawIteratorAt(row.globalIndex);
+        rowParticleBase(
+          row.derivedCollIndex,
+          particle.pt(),
+          particle.eta(),
+          particle.phi(),
+          RecoDecayPtEtaPhi::y(particle.pt(), particle.eta(), o2::constants::physics::MassLambdaCPlus),
+          particle.flagMcMatchGen(),
+          particle.originMcGen());
+      }
+    }
+    if (fillParticleId) {
+      rowParticleId.reserve(sizeTablePart);
+      for (const auto& row : particlesToFill) {
+        auto particle = mcParticles.rawIteratorAt(row.globalIndex);
+        rowParticleId(
+          particle.mcCollisionId(),
+          row.globalIndex);
+      }
+    }
+  }
+
   template <bool isMl, bool isMc, bool onlyBkg, bool onlySig, typename CollType, typename CandType>
   void processCandidates(CollType const& collisions,
                          Partition<CandType>& candidates,
@@ -302,9 +491,14 @@ struct HfDerivedDataCreatorLcToPKPi {
         matchedCollisions.clear();
       }
     }
-    auto sizeTableColl = collisions.size();
-    reserveTable(rowCollBase, fillCollBase, sizeTableColl);
-    reserveTable(rowCollId, fillCollId, sizeTableColl);
+    if (fillColumnar) {
+      collisionsToFill.clear();
+      candidatesToFill.clear();
+    } else {
+      auto sizeTableColl = collisions.size();
+      reserveTable(rowCollBase, fillCollBase, sizeTableColl);
+      reserveTable(rowCollId, fillCollId, sizeTableColl);
+    }
     for (const auto& collision : collisions) {
       auto thisCollId = collision.globalIndex();
       auto candidatesThisColl = candidates->sliceByCached(aod::hf_cand::collisionId, thisCollId, cache); // FIXME
@@ -320,18 +514,29 @@ struct HfDerivedDataCreatorLcToPKPi {
         LOGF(debug, "Skipping rec. collision %d", thisCollId);
         continue;
       }
-      LOGF(debug, "Filling rec. collision %d at derived index %d", thisCollId, rowCollBase.lastIndex() + 1);
-      // fillTablesCollision(collision, 0, collision.bc().runNumber());
-      fillTablesCollision<isMc>(collision);
-
-      // Fill candidate properties
-      reserveTable(rowCandidateBase, fillCandidateBase, sizeTableCand);
-      reserveTable(rowCandidatePar, fillCandidatePar, sizeTableCand);
-      reserveTable(rowCandidateParE, fillCandidateParE, sizeTableCand);
-      reserveTable(rowCandidateSel, fillCandidateSel, sizeTableCand);
-      reserveTable(rowCandidateId, fillCandidateId, sizeTableCand);
-      if constexpr (isMc) {
-        reserveTable(rowCandidateMc, fillCandidateMc, sizeTableCand);
+      int derivedCollIndex = collisionsToFill.size();
+      if (fillColumnar) {
+        LOGF(debug, "Selecting rec. collision %d for derived index %d", thisCollId, derivedCollIndex);
+        collisionsToFill.push_back(thisCollId);
+        if constexpr (isMc) {
+          if (fillMcRCollId && collision.has_mcCollision()) {
+            matchedCollisions[collision.mcCollisionId()].push_back(derivedCollIndex);
+          }
+        }
+      } else {
+        LOGF(debug, "Filling rec. collision %d at derived index %d", thisCollId, rowCollBase.lastIndex() + 1);
+        // fillTablesCollision(collision, 0, collision.bc().runNumber());
+        fillTablesCollision<isMc>(collision);
+
+        // Fill candidate properties
+        reserveTable(rowCandidateBase, fillCandidateBase, sizeTableCand);
+        reserveTable(rowCandidatePar, fillCandidatePar, sizeTableCand);
+        reserveTable(rowCandidateParE, fillCandidateParE, sizeTableCand);
+        reserveTable(rowCandidateSel, fillCandidateSel, sizeTableCand);
+        reserveTable(rowCandidateId, fillCandidateId, sizeTableCand);
+        if constexpr (isMc) {
+          reserveTable(rowCandidateMc, fillCandidateMc, sizeTableCand);
+        }
       }
       int8_t flagMcRec = 0, origin = 0, swapping = 0;
       for (const auto& candidate : candidatesThisColl) {
@@ -356,6 +561,15 @@ struct HfDerivedDataCreatorLcToPKPi {
             }
           }
         }
+        if (fillColumnar) {
+          if (candidate.isSelLcToPKPi()) {
+            candidatesToFill.push_back({candidate.globalIndex(), derivedCollIndex, 0});
+          }
+          if (candidate.isSelLcToPiKP()) {
+            candidatesToFill.push_back({candidate.globalIndex(), derivedCollIndex, 1});
+          }
+          continue;
+        }
         auto prong0 = candidate.template prong0_as<TracksWPid>();
         auto prong1 = candidate.template prong1_as<TracksWPid>();
         auto prong2 = candidate.template prong2_as<TracksWPid>();
@@ -376,6 +590,9 @@ struct HfDerivedDataCreatorLcToPKPi {
         }
       }
     }
+    if (fillColumnar) {
+      fillTablesCandidateColumnar<isMl, isMc>(collisions, candidates);
+    }
   }
 
   template <typename CollisionType, typename ParticleType>
@@ -400,9 +617,14 @@ struct HfDerivedDataCreatorLcToPKPi {
                           ParticleType const& mcParticles)
   {
     // Fill MC collision properties
-    auto sizeTableMcColl = mcCollisions.size();
-    reserveTable(rowMcCollBase, fillMcCollBase, sizeTableMcColl);
-    reserveTable(rowMcRCollId, fillMcRCollId, sizeTableMcColl);
+    if (fillColumnar) {
+      mcCollisionsToFill.clear();
+      particlesToFill.clear();
+    } else {
+      auto sizeTableMcColl = mcCollisions.size();
+      reserveTable(rowMcCollBase, fillMcCollBase, sizeTableMcColl);
+      reserveTable(rowMcRCollId, fillMcRCollId, sizeTableMcColl);
+    }
     for (const auto& mcCollision : mcCollisions) {
       auto thisMcCollId = mcCollision.globalIndex();
       auto particlesThisMcColl = mcParticles.sliceBy(mcParticlesPerMcCollision, thisMcCollId);
@@ -414,6 +636,15 @@ struct HfDerivedDataCreatorLcToPKPi {
         LOGF(debug, "Skipping MC collision %d", thisMcCollId);
         continue;
       }
+      if (fillColumnar) {
+        int derivedMcCollIndex = mcCollisionsToFill.size();
+        LOGF(debug, "Selecting MC collision %d for derived index %d", thisMcCollId, derivedMcCollIndex);
+        mcCollisionsToFill.push_back(thisMcCollId);
+        for (const auto& particle : particlesThisMcColl) {
+          particlesToFill.push_back({particle.globalIndex(), derivedMcCollIndex, 0});
+        }
+        continue;
+      }
       LOGF(debug, "Filling MC collision %d at derived index %d", thisMcCollId, rowMcCollBase.lastIndex() + 1);
       fillTablesMcCollision(mcCollision);
 
@@ -424,6 +655,9 @@ struct HfDerivedDataCreatorLcToPKPi {
         fillTablesParticle(particle, o2::constants::physics::MassLambdaCPlus);
       }
     }
+    if (fillColumnar) {
+      fillTablesMcColumnar(mcCollisions, mcParticles);
+    }
   }
 
   void processData(CollisionsWCentMult const& collisions,
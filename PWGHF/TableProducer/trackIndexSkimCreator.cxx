@@ -20,11 +20,15 @@
 /// \author Fabrizio Grosa <fgrosa@cern.ch>, CERN
 /// \author Federica Zanone <federica.zanone@cern.ch>, Heidelberg University
 
-#include <algorithm> // std::find
+#include <algorithm> // std::copy, std::find
+#include <cmath>     // std::cos, std::cosh, std::fabs
+#include <deque>     // std::deque
 #include <iterator>  // std::distance
 #include <string>    // std::string
+#include <thread>    // std::thread
 #include <vector>    // std::vector
 
+#include "CommonConstants/MathConstants.h"
 #include "CommonConstants/PhysicsConstants.h"
 #include "CCDB/BasicCCDBManager.h"             // for PV refit
 #include "DataFormatsParameters/GRPMagField.h" // for PV refit
@@ -53,6 +57,7 @@
 #include "PWGHF/Utils/utilsAnalysis.h"
 #include "PWGHF/Utils/utilsBfieldCCDB.h"
 #include "PWGHF/Utils/utilsEvSelHf.h"
+#include "PWGHF/Utils/utilsTrkCandHf.h"
 
 using namespace o2;
 using namespace o2::analysis;
@@ -92,6 +97,362 @@ enum ChannelsProtonPid {
 // kaon PID (opposite-sign track in 3-prong decays)
 constexpr int channelKaonPid = ChannelsProtonPid::NChannelsProtonPid;
 
+/// Tracks of a collision sorted in (phi, eta, pT) cells, used to form only the track combinations
+/// that can pass the pT and invariant-mass preselections of at least one channel.
+/// The invariant mass of two tracks is larger than the massless one, m^2 >= 2 pT1 pT2 (cosh(Delta eta) - cos(Delta phi)),
+/// and the invariant mass of a 3-prong candidate is larger than the one of any pair of its daughters.
+struct HfTrackCells {
+  struct Track {
+    float pt;
+    float eta;
+    float phi;
+    bool isNeverSkipped; // e.g. momentum re-propagated to the collision before the preselections
+  };
+
+  static constexpr float kMarginPt = 1.e-3f;    // absolute margin in GeV/c on the pT-sum bound
+  static constexpr float kMarginMass2 = 1.02f;  // relative margin on the invariant-mass bound
+  static constexpr float kMarginAngle = 1.e-4f; // margin in eta and rad on the cell borders
+
+  std::vector<double> binsPt{0.}; // lower limits of the pT cells, the last one is unbounded
+  int nPhi{1};
+  int nEta{1};
+  float etaMin{0.f};
+  float etaWidth{1.f};
+  std::vector<Track> tracks;           // tracks in the order of the slice
+  std::vector<std::vector<int>> cells; // positions in the slice of the other tracks of each cell, in increasing order
+  std::vector<int> neverSkipped;       // positions in the slice of the tracks that are never skipped
+  std::vector<bool> isSelected;        // whether the track at each position can be used as third prong
+
+  void setBinning(std::vector<double> const& bins, int nPhiCells, int nEtaCells)
+  {
+    binsPt = bins;
+    if (binsPt.empty() || binsPt.front() > 0.) {
+      binsPt.insert(binsPt.begin(), 0.);
+    }
+    nPhi = std::max(nPhiCells, 1);
+    nEta = std::max(nEtaCells, 1);
+    cells.resize(binsPt.size() * nPhi * nEta);
+  }
+
+  int cellIndex(int iPt, int iEta, int iPhi) const { return (iPt * nEta + iEta) * nPhi + iPhi; }
+
+  /// Adds the tracks of the slice, in order
+  /// \param isThirdProng is false for the tracks that are never used as third prong
+  void addTrack(float pt, float eta, float phi, bool isNeverSkipped, bool isThirdProng)
+  {
+    tracks.push_back({pt, eta, phi, isNeverSkipped});
+    isSelected.push_back(isThirdProng);
+  }
+
+  /// Sorts the added tracks in cells, the eta range of the cells is the one of the tracks
+  void fillCells()
+  {
+    for (auto& cell : cells) {
+      cell.clear();
+    }
+    neverSkipped.clear();
+    float etaMax = etaMin = 0.f;
+    bool isFirst = true;
+    for (const auto& track : tracks) {
+      if (!track.isNeverSkipped) {
+        etaMin = isFirst ? track.eta : std::min(etaMin, track.eta);
+        etaMax = isFirst ? track.eta : std::max(etaMax, track.eta);
+        isFirst = false;
+      }
+    }
+    etaWidth = std::max((etaMax - etaMin) / nEta, 1.e-3f);
+    for (int iTrack = 0; iTrack < static_cast<int>(tracks.size()); ++iTrack) {
+      if (!isSelected[iTrack]) {
+        continue;
+      }
+      const auto& track = tracks[iTrack];
+      if (track.isNeverSkipped) {
+        neverSkipped.push_back(iTrack);
+        continue;
+      }
+      int iPt = std::distance(binsPt.begin(), std::upper_bound(binsPt.begin(), binsPt.end(), track.pt)) - 1;
+      int iEta = std::clamp(static_cast<int>((track.eta - etaMin) / etaWidth), 0, nEta - 1);
+      int iPhi = std::clamp(static_cast<int>(track.phi / o2::constants::math::TwoPI * nPhi), 0, nPhi - 1);
+      cells[cellIndex(std::max(iPt, 0), iEta, iPhi)].push_back(iTrack);
+    }
+  }
+
+  void clear()
+  {
+    tracks.clear();
+    isSelected.clear();
+  }
+
+  /// Minimum squared invariant mass of two tracks with transverse momenta pt0, pt1 and (eta, phi) distances above dEta, dPhi
+  static float getMinMass2(float pt0, float pt1, float dEta, float dPhi)
+  {
+    return 2.f * pt0 * pt1 * (std::cosh(dEta) - std::cos(dPhi));
+  }
+
+  static float getDeltaPhi(float phi0, float phi1)
+  {
+    float dPhi = std::fabs(phi0 - phi1);
+    return dPhi > o2::constants::math::PI ? o2::constants::math::TwoPI - dPhi : dPhi;
+  }
+
+  static float getMinMass2(Track const& track0, Track const& track1)
+  {
+    return getMinMass2(track0.pt, track1.pt, track0.eta - track1.eta, getDeltaPhi(track0.phi, track1.phi));
+  }
+
+  /// Minimum squared invariant mass of a track with any track of a cell
+  float getMinMass2(Track const& track, int iPt, int iEta, int iPhi) const
+  {
+    float etaLow = etaMin + iEta * etaWidth - kMarginAngle;
+    float etaHigh = etaMin + (iEta + 1) * etaWidth + kMarginAngle;
+    float dEta = std::max({0.f, etaLow - track.eta, track.eta - etaHigh});
+    float phiLow = iPhi * o2::constants::math::TwoPI / nPhi - kMarginAngle;
+    float phiHigh = (iPhi + 1) * o2::constants::math::TwoPI / nPhi + kMarginAngle;
+    float dPhi = (track.phi >= phiLow && track.phi <= phiHigh) ? 0.f : std::max(0.f, std::min(getDeltaPhi(track.phi, phiLow), getDeltaPhi(track.phi, phiHigh)));
+    return getMinMass2(track.pt, binsPt[iPt], dEta, dPhi);
+  }
+
+  /// Positions in the slice, in increasing order and after first, of the tracks that can form a candidate with track0 and track1
+  /// \param minPt is the minimum pT of the third track for the pT sum to pass the preselections
+  /// \param maxMass2 is the maximum squared invariant mass of the preselections, no selection if negative
+  void getThirdProngs(int first, Track const& track0, Track const& track1, float minPt, float maxMass2, std::vector<int>& positions) const
+  {
+    positions.clear();
+    if (track0.isNeverSkipped || track1.isNeverSkipped) {
+      for (int iTrack = first + 1; iTrack < static_cast<int>(tracks.size()); ++iTrack) {
+        if (isSelected[iTrack]) {
+          positions.push_back(iTrack);
+        }
+      }
+      return;
+    }
+    minPt -= kMarginPt;
+    maxMass2 *= kMarginMass2;
+    for (int iPt = 0; iPt < static_cast<int>(binsPt.size()); ++iPt) {
+      if (iPt + 1 < static_cast<int>(binsPt.size()) && binsPt[iPt + 1] <= minPt) {
+        continue;
+      }
+      for (int iEta = 0; iEta < nEta; ++iEta) {
+        for (int iPhi = 0; iPhi < nPhi; ++iPhi) {
+          const auto& cell = cells[cellIndex(iPt, iEta, iPhi)];
+          if (cell.empty() || cell.back() <= first) {
+            continue;
+          }
+          if (maxMass2 > 0.f && binsPt[iPt] > 0. && (getMinMass2(track0, iPt, iEta, iPhi) >= maxMass2 || getMinMass2(track1, iPt, iEta, iPhi) >= maxMass2)) {
+            continue;
+          }
+          for (auto iTrack = std::upper_bound(cell.begin(), cell.end(), first); iTrack != cell.end(); ++iTrack) {
+            const auto& track = tracks[*iTrack];
+            if (track.pt < minPt || (maxMass2 > 0.f && (getMinMass2(track0, track) >= maxMass2 || getMinMass2(track1, track) >= maxMass2))) {
+              continue;
+            }
+            positions.push_back(*iTrack);
+          }
+        }
+      }
+    }
+    for (const auto& iTrack : neverSkipped) {
+      if (iTrack > first) {
+        positions.push_back(iTrack);
+      }
+    }
+    std::sort(positions.begin(), positions.end());
+  }
+};
+
+/// Result of the secondary-vertex fit of a 3-prong candidate
+struct HfFit3Prong {
+  int nVtx{0};                                  // number of vertices found by the fitter
+  std::array<double, 3> secondaryVertex{};      // position of the secondary vertex
+  float chi2PCA{0.f};                           // chi2 at the PCA, filled only with the covariance matrix
+  std::array<float, 6> covMatrixPCA{};          // covariance matrix of the secondary vertex, filled only if requested
+  std::array<o2::track::TrackParCov, 3> tracks; // tracks propagated to the secondary vertex
+};
+
+/// Track parameters at the primary vertex of the current collision, cached by track global index on first use
+/// and shared by all the candidates the track is combined into.
+/// If propagateToCollision is set, the tracks whose default collision is another one are re-propagated to the primary vertex of the current collision.
+struct HfTrackParCovCache {
+  struct Entry {
+    o2::track::TrackParCov trackParCov;
+    std::array<float, 3> pVec;
+    o2::gpu::gpustd::array<float, 2> dca;
+  };
+
+  bool propagateToCollision{true};
+  o2::base::Propagator::MatCorrType matCorr{o2::base::Propagator::MatCorrType::USEMatCorrNONE};
+
+  /// Invalidates the cached tracks, to be called for each collision
+  template <typename TCollision>
+  void setCollision(TCollision const& collision)
+  {
+    ++generation;
+    collisionId = collision.globalIndex();
+    primaryVertex = {collision.posX(), collision.posY(), collision.posZ()};
+    entries.clear();
+  }
+
+  /// Returns the parameters of a track at the primary vertex of the current collision
+  template <typename TTrack>
+  Entry const& get(TTrack const& track)
+  {
+    const auto globalIndex = track.globalIndex();
+    if (globalIndex >= static_cast<int64_t>(generationOfTrack.size())) {
+      generationOfTrack.resize(globalIndex + 1, 0);
+      entryOfTrack.resize(globalIndex + 1, -1);
+    }
+    if (generationOfTrack[globalIndex] == generation) {
+      return entries[entryOfTrack[globalIndex]];
+    }
+    auto& entry = entries.emplace_back(Entry{getTrackParCov(track), track.pVector(), {track.dcaXY(), track.dcaZ()}});
+    if (propagateToCollision && track.collisionId() != collisionId) { // this is not the "default" collision for this track, we have to re-propagate it
+      o2::base::Propagator::Instance()->propagateToDCABxByBz({primaryVertex[0], primaryVertex[1], primaryVertex[2]}, entry.trackParCov, 2.f, matCorr, &entry.dca);
+      getPxPyPz(entry.trackParCov, entry.pVec);
+    }
+    generationOfTrack[globalIndex] = generation;
+    entryOfTrack[globalIndex] = entries.size() - 1;
+    return entry;
+  }
+
+ private:
+  uint64_t generation{1}; // incremented for each collision, also across data frames
+  int64_t collisionId{-1};
+  std::array<float, 3> primaryVertex{};
+  std::deque<Entry> entries;               // cached tracks, a deque such that the references stay valid when adding tracks
+  std::vector<uint64_t> generationOfTrack; // generation in which each track was cached, indexed by track global index
+  std::vector<int> entryOfTrack;           // index in entries of each cached track
+};
+
+/// Primary vertex refitted without one of its contributors, obtained from the full vertex fit by subtracting the contribution of the track
+/// from the weight matrix of the vertex (inverse of its covariance matrix), with the track linearised at the vertex as in the PVertexer.
+/// The tracks are down-weighted with the same Tukey function as in the vertex fit.
+/// The removal is rejected (and a full refit is needed) if the remaining weight matrix is ill-conditioned.
+struct HfPvRefitDowndate {
+  double tukey{5.};        // Tukey parameter of the vertex fit
+  double minDetRatio{0.1}; // min. ratio between the determinants of the weight matrices after and before the removal of a track
+  int minNContrib{3};      // min. number of contributors left after the removal of a track
+
+  /// Sets the full vertex fit
+  /// \param collision is the collision with the vertex fitted with all its contributors
+  /// \return false if the covariance matrix of the vertex cannot be inverted
+  template <typename TCollision>
+  bool setVertex(TCollision const& collision)
+  {
+    nContrib = collision.numContrib();
+    vertex = {collision.posX(), collision.posY(), collision.posZ()};
+    covariance = {collision.covXX(), collision.covXY(), collision.covYY(), collision.covXZ(), collision.covYZ(), collision.covZZ()};
+    isVertexSet = invertSym3(covariance, weight, detWeight);
+    return isVertexSet;
+  }
+
+  /// Removes a track from the full vertex fit
+  /// \param trackParCov is the contributor to be removed, at its point of closest approach to the vertex
+  /// \param pvCoord is an array to be filled with the coordinates of the refitted vertex
+  /// \param pvCovMatrix is an array to be filled with the covariance matrix of the refitted vertex
+  /// \return false if the removal is ill-conditioned
+  bool removeTrack(o2::track::TrackParCov const& trackParCov, std::array<float, 3>& pvCoord, std::array<float, 6>& pvCovMatrix) const
+  {
+    if (!isVertexSet || nContrib - 1 < minNContrib) {
+      return false;
+    }
+    const double snp = trackParCov.getSnp();
+    const double csp2 = (1. - snp) * (1. + snp);
+    if (csp2 <= 0.) {
+      return false;
+    }
+    // residuals r = A * vertex - c of the straight-line track in its local frame
+    const double csp = std::sqrt(csp2);
+    const double tgP = snp / csp;
+    const double tgL = trackParCov.getTgl() / csp;
+    const double cosAlpha = std::cos(trackParCov.getAlpha());
+    const double sinAlpha = std::sin(trackParCov.getAlpha());
+    const double a[2][3] = {{-sinAlpha - tgP * cosAlpha, cosAlpha - tgP * sinAlpha, 0.},
+                            {-tgL * cosAlpha, -tgL * sinAlpha, 1.}};
+    const double xLocal = cosAlpha * vertex[0] + sinAlpha * vertex[1];
+    const double r[2] = {-sinAlpha * vertex[0] + cosAlpha * vertex[1] - trackParCov.getY() - tgP * (xLocal - trackParCov.getX()),
+                         vertex[2] - trackParCov.getZ() - tgL * (xLocal - trackParCov.getX())};
+    // track weight matrix G in the y-z plane
+    const double sigY2 = trackParCov.getSigmaY2(), sigZY = trackParCov.getSigmaZY(), sigZ2 = trackParCov.getSigmaZ2();
+    const double detCovTrack = sigY2 * sigZ2 - sigZY * sigZY;
+    if (detCovTrack <= 0.) {
+      return false;
+    }
+    const double g[2][2] = {{sigZ2 / detCovTrack, -sigZY / detCovTrack}, {-sigZY / detCovTrack, sigY2 / detCovTrack}};
+    const double chi2 = r[0] * (g[0][0] * r[0] + g[0][1] * r[1]) + r[1] * (g[1][0] * r[0] + g[1][1] * r[1]);
+    const double tukey2 = tukey * tukey;
+    if (chi2 >= tukey2) { // the track did not contribute to the vertex
+      fillVertex(vertex, covariance, pvCoord, pvCovMatrix);
+      return true;
+    }
+    const double wgh = (1. - chi2 / tukey2) * (1. - chi2 / tukey2);
+
+    // weight matrix without the track, W' = W - w * A^T G A, and gradient w * A^T G r
+    std::array<double, 6> weightRefit = weight;
+    std::array<double, 3> gradient{};
+    for (int i = 0; i < 3; ++i) {
+      for (int k = 0; k < 2; ++k) {
+        gradient[i] += wgh * a[k][i] * (g[k][0] * r[0] + g[k][1] * r[1]);
+      }
+      for (int j = 0; j <= i; ++j) {
+        double aga = 0.;
+        for (int k = 0; k < 2; ++k) {
+          aga += a[k][j] * (g[k][0] * a[0][i] + g[k][1] * a[1][i]);
+        }
+        weightRefit[indexSym3(i, j)] -= wgh * aga;
+      }
+    }
+    std::array<double, 6> covRefit{};
+    double detWeightRefit = 0.;
+    if (!invertSym3(weightRefit, covRefit, detWeightRefit) || detWeightRefit < minDetRatio * detWeight ||
+        covRefit[indexSym3(0, 0)] <= 0. || covRefit[indexSym3(1, 1)] <= 0. || covRefit[indexSym3(2, 2)] <= 0.) {
+      return false;
+    }
+    // vertex without the track, v' = v + W'^-1 * w * A^T G r
+    std::array<double, 3> vertexRefit = vertex;
+    for (int i = 0; i < 3; ++i) {
+      for (int j = 0; j < 3; ++j) {
+        vertexRefit[i] += covRefit[indexSym3(i, j)] * gradient[j];
+      }
+    }
+    fillVertex(vertexRefit, covRefit, pvCoord, pvCovMatrix);
+    return true;
+  }
+
+ private:
+  int nContrib{0};
+  bool isVertexSet{false};
+  std::array<double, 3> vertex{};
+  std::array<double, 6> covariance{}; // vertex covariance matrix, stored as xx, xy, yy, xz, yz, zz
+  std::array<double, 6> weight{};     // inverse of the vertex covariance matrix
+  double detWeight{0.};
+
+  static int indexSym3(int i, int j)
+  {
+    return i >= j ? i * (i + 1) / 2 + j : j * (j + 1) / 2 + i;
+  }
+
+  /// Inverts a symmetric 3x3 matrix stored as xx, xy, yy, xz, yz, zz
+  /// \return false if the matrix is not positive definite
+  static bool invertSym3(std::array<double, 6> const& m, std::array<double, 6>& inv, double& det)
+  {
+    const double cof00 = m[2] * m[5] - m[4] * m[4];
+    const double cof01 = m[3] * m[4] - m[1] * m[5];
+    const double cof02 = m[1] * m[4] - m[2] * m[3];
+    det = m[0] * cof00 + m[1] * cof01 + m[3] * cof02;
+    if (m[0] <= 0. || m[0] * m[2] - m[1] * m[1] <= 0. || det <= 0.) {
+      return false;
+    }
+    inv = {cof00 / det, cof01 / det, (m[0] * m[5] - m[3] * m[3]) / det, cof02 / det, (m[1] * m[3] - m[0] * m[4]) / det, (m[0] * m[2] - m[1] * m[1]) / det};
+    return true;
+  }
+
+  static void fillVertex(std::array<double, 3> const& v, std::array<double, 6> const& cov, std::array<float, 3>& pvCoord, std::array<float, 6>& pvCovMatrix)
+  {
+    std::copy(v.begin(), v.end(), pvCoord.begin());
+    std::copy(cov.begin(), cov.end(), pvCovMatrix.begin());
+  }
+};
+
 /// Event selection
 struct HfTrackIndexSkimCreatorTagSelCollisions {
   Produces<aod::HfSelCollision> rowSelectedCollision;
@@ -206,6 +567,10 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
   Configurable<bool> doPvRefit{"doPvRefit", false, "do PV refit excluding the considered track"};
   Configurable<bool> fillHistograms{"fillHistograms", true, "fill histograms"};
   Configurable<bool> debugPvRefit{"debugPvRefit", false, "debug lines for primary vertex refit"};
+  Configurable<bool> doPvRefitIncremental{"doPvRefitIncremental", false, "do the PV refit by removing the considered track from the full vertex fit, with full refit only if the removal is ill-conditioned"};
+  Configurable<double> tukeyPvRefitIncremental{"tukeyPvRefitIncremental", 5., "Tukey parameter of the original vertex fit, used to weight the removed tracks (as pvertexer.tukey)"};
+  Configurable<double> minDetRatioPvRefitIncremental{"minDetRatioPvRefitIncremental", 0.1, "min. ratio of the determinants of the vertex weight matrices after and before the track removal, below which the full refit is done"};
+  Configurable<int> minNContribPvRefitIncremental{"minNContribPvRefitIncremental", 3, "min. number of PV contributors left after the track removal, below which the full refit is done"};
   // Configurable<double> bz{"bz", 5., "bz field"};
   // quality cut
   Configurable<bool> doCutQuality{"doCutQuality", true, "apply quality cuts"};
@@ -258,6 +623,7 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
   o2::base::MatLayerCylSet* lut;
   o2::base::Propagator::MatCorrType noMatCorr = o2::base::Propagator::MatCorrType::USEMatCorrNONE;
   int runNumber;
+  HfPvRefitDowndate pvRefitDowndate;
 
   // single-track cuts
   static const int nCuts = 4;
@@ -373,8 +739,15 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
         registry.add("PvRefit/hPvRefitZChi2Minus1", "PV refit with #it{#chi}^{2}==#minus1", kTH2D, {axisCollisionZ, axisCollisionZOriginal});
         registry.add("PvRefit/hNContribPvRefitNotDoable", "N. contributors for PV refit not doable", kTH1D, {axisCollisionNContrib});
         registry.add("PvRefit/hNContribPvRefitChi2Minus1", "N. contributors original PV for PV refit #it{#chi}^{2}==#minus1", kTH1D, {axisCollisionNContrib});
+        if (doPvRefitIncremental) {
+          registry.add("PvRefit/hNContribPvRefitIncrementalFailed", "N. contributors original PV for incremental PV refit ill-conditioned", kTH1D, {axisCollisionNContrib});
+        }
       }
 
+      pvRefitDowndate.tukey = tukeyPvRefitIncremental;
+      pvRefitDowndate.minDetRatio = minDetRatioPvRefitIncremental;
+      pvRefitDowndate.minNContrib = minNContribPvRefitIncremental;
+
       ccdb->setURL(ccdbUrl);
       ccdb->setCaching(true);
       ccdb->setLocalObjectValidityChecking();
@@ -678,8 +1051,8 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
   template <typename TTrack>
   void performPvRefitTrack(aod::Collision const& collision,
                            aod::BCsWithTimestamps const&,
-                           std::vector<int64_t> vecPvContributorGlobId,
-                           std::vector<o2::track::TrackParCov> vecPvContributorTrackParCov,
+                           std::vector<int64_t> const& vecPvContributorGlobId,
+                           std::vector<o2::track::TrackParCov> const& vecPvContributorTrackParCov,
                            TTrack const& trackToRemove,
                            std::array<float, 3>& pvCoord,
                            std::array<float, 6>& pvCovMatrix,
@@ -850,6 +1223,52 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
     return;
   } /// end of performPvRefitTrack function
 
+  /// Method for the PV refit and DCA recalculation for PV contributors, removing the track from the full vertex fit
+  /// \param collision is a collision
+  /// \param trackToRemove is the PV contributor to be removed from the vertex fit
+  /// \param pvCoord is an array containing the coordinates of the refitted PV
+  /// \param pvCovMatrix is an array containing the covariance matrix values of the refitted PV
+  /// \param dcaXYdcaZ is an array containing the dcaXY and dcaZ of trackToRemove with respect to the refitted PV
+  /// \return false if the removal of the track is ill-conditioned and the full refit has to be done
+  template <typename TTrack>
+  bool performPvRefitTrackIncremental(aod::Collision const& collision,
+                                      TTrack const& trackToRemove,
+                                      std::array<float, 3>& pvCoord,
+                                      std::array<float, 6>& pvCovMatrix,
+                                      std::array<float, 2>& dcaXYdcaZ)
+  {
+    std::array<float, 3> pvCoordRefit{};
+    std::array<float, 6> pvCovMatrixRefit{};
+    if (!pvRefitDowndate.removeTrack(getTrackParCov(trackToRemove), pvCoordRefit, pvCovMatrixRefit)) {
+      if (debugPvRefit) {
+        LOG(info) << "Incremental refit ill-conditioned for track with global index " << static_cast<int>(trackToRemove.globalIndex()) << ", Ncontrib= " << collision.numContrib();
+      }
+      if (fillHistograms) {
+        registry.fill(HIST("PvRefit/hNContribPvRefitIncrementalFailed"), collision.numContrib());
+      }
+      return false;
+    }
+    if (fillHistograms) {
+      registry.fill(HIST("PvRefit/hVerticesPerTrack"), 1);
+      registry.fill(HIST("PvRefit/hVerticesPerTrack"), 2);
+      registry.fill(HIST("PvRefit/hVerticesPerTrack"), 3);
+      registry.fill(HIST("PvRefit/hPvDeltaXvsNContrib"), collision.numContrib() - 1, collision.posX() - pvCoordRefit[0]);
+      registry.fill(HIST("PvRefit/hPvDeltaYvsNContrib"), collision.numContrib() - 1, collision.posY() - pvCoordRefit[1]);
+      registry.fill(HIST("PvRefit/hPvDeltaZvsNContrib"), collision.numContrib() - 1, collision.posZ() - pvCoordRefit[2]);
+    }
+
+    /// Track propagation to the PV refit considering also the material budget
+    auto trackPar = getTrackPar(trackToRemove);
+    o2::gpu::gpustd::array<float, 2> dcaInfo{-999., -999.};
+    if (o2::base::Propagator::Instance()->propagateToDCABxByBz({pvCoordRefit[0], pvCoordRefit[1], pvCoordRefit[2]}, trackPar, 2.f, noMatCorr, &dcaInfo)) {
+      pvCoord = pvCoordRefit;
+      pvCovMatrix = pvCovMatrixRefit;
+      dcaXYdcaZ[0] = dcaInfo[0]; // [cm]
+      dcaXYdcaZ[1] = dcaInfo[1]; // [cm]
+    }
+    return true;
+  }
+
   /// Selection tag for tracks
   /// \param collision is the collision iterator
   /// \param tracks is the entire track table
@@ -871,6 +1290,16 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
                        std::vector<std::array<float, 6>>& pvRefitPvCovMatrixPerTrack)
   {
     auto thisCollId = collision.globalIndex();
+    /// PV contributors for the current collision, retrieved once for all the tracks that need the full refit
+    std::vector<int64_t> vecPvContributorGlobId = {};
+    std::vector<o2::track::TrackParCov> vecPvContributorTrackParCov = {};
+    bool isPvContributorListFilled = false;
+    bool isPvRefitIncrementalDoable = false;
+    if (doPvRefit && doPvRefitIncremental) {
+      isPvRefitIncrementalDoable = pvRefitDowndate.setVertex(collision);
+      auto bc = collision.bc_as<o2::aod::BCsWithTimestamps>();
+      initCCDB(bc, runNumber, ccdb, isRun2 ? ccdbPathGrp : ccdbPathGrpMag, lut, isRun2);
+    }
     for (const auto& trackId : trackIndicesCollision) {
       int statusProng = BIT(CandidateType::NCandidateTypes) - 1; // all bits on
       auto track = trackId.template track_as<TTracks>();
@@ -887,23 +1316,25 @@ struct HfTrackIndexSkimCreatorTagSelTracks {
         pvRefitPvCoord = {collision.posX(), collision.posY(), collision.posZ()};
         pvRefitPvCovMatrix = {collision.covXX(), collision.covXY(), collision.covYY(), collision.covXZ(), collision.covYZ(), collision.covZZ()};
 
-        /// retrieve PV contributors for the current collision
-        std::vector<int64_t> vecPvContributorGlobId = {};
-        std::vector<o2::track::TrackParCov> vecPvContributorTrackParCov = {};
-
-        for (const auto& contributor : pvContrCollision) {
-          vecPvContributorGlobId.push_back(contributor.globalIndex());
-          vecPvContributorTrackParCov.push_back(getTrackParCov(contributor));
-        }
-        if (debugPvRefit) {
-          LOG(info) << "### vecPvContributorGlobId.size()=" << vecPvContributorGlobId.size() << ", vecPvContributorTrackParCov.size()=" << vecPvContributorTrackParCov.size() << ", N. original contributors=" << collision.numContrib();
-        }
+        if (!isPvRefitIncrementalDoable || !performPvRefitTrackIncremental(collision, track, pvRefitPvCoord, pvRefitPvCovMatrix, pvRefitDcaXYDcaZ)) {
+          /// retrieve PV contributors for the current collision
+          if (!isPvContributorListFilled) {
+            for (const auto& contributor : pvContrCollision) {
+              vecPvContributorGlobId.push_back(contributor.globalIndex());
+              vecPvContributorTrackParCov.push_back(getTrackParCov(contributor));
+            }
+            isPvContributorListFilled = true;
+          }
+          if (debugPvRefit) {
+            LOG(info) << "### vecPvContributorGlobId.size()=" << vecPvContributorGlobId.size() << ", vecPvContributorTrackParCov.size()=" << vecPvContributorTrackParCov.size() << ", N. original contributors=" << collision.numContrib();
+          }
 
-        /// Perform the PV refit only for tracks with an assigned collision
-        if (debugPvRefit) {
-          LOG(info) << "[BEFORE performPvRefitTrack] track.collision().globalIndex(): " << collision.globalIndex();
+          /// Perform the PV refit only for tracks with an assigned collision
+          if (debugPvRefit) {
+            LOG(info) << "[BEFORE performPvRefitTrack] track.collision().globalIndex(): " << collision.globalIndex();
+          }
+          performPvRefitTrack(collision, bcWithTimeStamps, vecPvContributorGlobId, vecPvContributorTrackParCov, track, pvRefitPvCoord, pvRefitPvCovMatrix, pvRefitDcaXYDcaZ);
         }
-        performPvRefitTrack(collision, bcWithTimeStamps, vecPvContributorGlobId, vecPvContributorTrackParCov, track, pvRefitPvCoord, pvRefitPvCovMatrix, pvRefitDcaXYDcaZ);
         // we subtract the offset since trackIdx is the global index referred to the total track table
         pvRefitDcaPerTrack[trackIdx] = pvRefitDcaXYDcaZ;
         pvRefitPvCoordPerTrack[trackIdx] = pvRefitPvCoord;
@@ -1124,6 +1555,9 @@ struct HfTrackIndexSkimCreator {
   // Tables with ML scores for HF Filters
   Produces<aod::Hf2ProngMlProbs> rowTrackIndexMlScoreProng2;
   Produces<aod::Hf3ProngMlProbs> rowTrackIndexMlScoreProng3;
+  // Tables with the secondary-vertex fits, for the candidate creators
+  Produces<aod::HfSvFit2Prong> rowProng2SvFit;
+  Produces<aod::HfSvFit3Prong> rowProng3SvFit;
 
   Configurable<bool> isRun2{"isRun2", false, "enable Run 2 or Run 3 GRP objects for magnetic field"};
   Configurable<bool> do3Prong{"do3Prong", 0, "do 3 prong"};
@@ -1137,6 +1571,11 @@ struct HfTrackIndexSkimCreator {
   // preselection of 3-prongs using the decay length computed only with the first two tracks
   Configurable<double> minTwoTrackDecayLengthFor3Prongs{"minTwoTrackDecayLengthFor3Prongs", 0., "Minimum decay length computed with 2 tracks for 3-prongs to speedup combinatorial"};
   Configurable<double> maxTwoTrackChi2PcaFor3Prongs{"maxTwoTrackChi2PcaFor3Prongs", 1.e10, "Maximum chi2 pca computed with 2 tracks for 3-prongs to speedup combinatorial"};
+  // pre-binning of the tracks in (phi, eta, pT) cells to form only the combinations that can pass the pT and invariant-mass preselections
+  Configurable<bool> applyTrackPreBinning{"applyTrackPreBinning", false, "Skip the track combinations that cannot pass the pT and invariant-mass preselections of any channel (not applied in debug mode)"};
+  Configurable<int> nPhiCellsPreBinning{"nPhiCellsPreBinning", 18, "Number of phi cells for the pre-binning of the tracks"};
+  Configurable<int> nEtaCellsPreBinning{"nEtaCellsPreBinning", 8, "Number of eta cells for the pre-binning of the tracks"};
+  Configurable<std::vector<double>> binsPtPreBinning{"binsPtPreBinning", std::vector<double>{0., 0.5, 1., 2., 4.}, "pT cell limits for the pre-binning of the tracks, the last cell is unbounded"};
   // vertexing
   // Configurable<double> bz{"bz", 5., "magnetic field kG"};
   Configurable<bool> propagateToPCA{"propagateToPCA", true, "create tracks version propagated to PCA"};
@@ -1146,6 +1585,9 @@ struct HfTrackIndexSkimCreator {
   Configurable<double> maxDZIni{"maxDZIni", 4., "reject (if>0) PCA candidate if tracks DZ exceeds threshold"};
   Configurable<double> minParamChange{"minParamChange", 1.e-3, "stop iterations if largest change of any X is smaller than this"};
   Configurable<double> minRelChi2Change{"minRelChi2Change", 0.9, "stop iterations if chi2/chi2old > this"};
+  Configurable<int> nThreadsVertexing3Prong{"nThreadsVertexing3Prong", 1, "Number of threads for the vertex fits of the 3-prong candidates, 1 to fit them one by one (not applied in debug mode)"};
+  Configurable<int> minFitsPerThread3Prong{"minFitsPerThread3Prong", 16, "Minimum number of 3-prong vertex fits per thread"};
+  Configurable<bool> fillSvFit{"fillSvFit", false, "Fill the tables of the secondary-vertex fits of the 2- and 3-prong candidates, used by the candidate creators instead of refitting"};
   // CCDB
   Configurable<std::string> ccdbUrl{"ccdbUrl", "http://alice-ccdb.cern.ch", "url of the ccdb repository"};
   Configurable<std::string> ccdbPathLut{"ccdbPathLut", "GLO/Param/MatLUT", "Path for LUT parametrization"};
@@ -1204,6 +1646,13 @@ struct HfTrackIndexSkimCreator {
   o2::base::MatLayerCylSet* lut;
   o2::base::Propagator::MatCorrType noMatCorr = o2::base::Propagator::MatCorrType::USEMatCorrNONE;
   int runNumber;
+  // parallel vertexing of the 3-prong candidates
+  std::vector<o2::vertexing::DCAFitterN<3>> df3Workers; // 3-prong vertex fitters of the worker threads
+  std::vector<o2::track::TrackParCov> fitThirdProngs;   // third prongs of the 3-prong candidates to be fitted
+  std::vector<HfFit3Prong> fits3Prong;                  // vertex fits done by the worker threads
+  std::vector<int> fitIndices3Prong;                    // index in fits3Prong of each third prong, -1 if not fitted
+  HfFit3Prong fit3ProngSequential;                      // vertex fit of the candidates not fitted by the worker threads
+  HfTrackParCovCache trackCache;                        // tracks propagated to the primary vertex of the current collision
 
   double massPi{0.};
   double massK{0.};
@@ -1227,6 +1676,15 @@ struct HfTrackIndexSkimCreator {
   std::array<std::vector<double>, kN2ProngDecays> pTBins2Prong;
   std::array<LabeledArray<double>, kN3ProngDecays> cut3Prong;
   std::array<std::vector<double>, kN3ProngDecays> pTBins3Prong;
+  // bounds of the pT and invariant-mass preselections of all the channels, used for the pre-binning of the tracks
+  float minPt2Prong{0.f};
+  float minPt3Prong{0.f};
+  float maxMass2Prong2{-1.f}; // negative if the invariant-mass preselection is not applied for some channel or pT bin
+  float maxMass3Prong2{-1.f}; // negative if the invariant-mass preselection is not applied for some channel or pT bin
+  bool usePreBinning{false};
+  HfTrackCells cellsPos;
+  HfTrackCells cellsNeg;
+  std::vector<int> thirdProngs;
 
   // ML response
   o2::analysis::MlResponse<float> hfMlResponse2Prongs;                             // only D0
@@ -1303,6 +1761,30 @@ struct HfTrackIndexSkimCreator {
     cut3Prong = {cutsDplusToPiKPi, cutsLcToPKPi, cutsDsToKKPi, cutsXicToPKPi};
     pTBins3Prong = {binsPtDplusToPiKPi, binsPtLcToPKPi, binsPtDsToKKPi, binsPtXicToPKPi};
 
+    usePreBinning = applyTrackPreBinning && !debug;
+    if (usePreBinning) {
+      // a candidate cannot pass the preselections if its pT is below the lowest bin of all the channels
+      // or if its invariant mass is above the largest upper limit of all the channels and pT bins
+      auto getBounds = [](auto const& pTBins, auto const& cuts, float& minPt, float& maxMass2) {
+        minPt = pTBins[0].front();
+        bool hasMassCut = true;
+        double maxMass = 0.;
+        for (std::size_t iDecay = 0; iDecay < pTBins.size(); iDecay++) {
+          minPt = std::min(minPt, static_cast<float>(pTBins[iDecay].front()));
+          for (std::size_t iBin = 0; iBin + 1 < pTBins[iDecay].size(); iBin++) {
+            hasMassCut = hasMassCut && cuts[iDecay].get(iBin, 0u) >= 0. && cuts[iDecay].get(iBin, 1u) > 0.;
+            maxMass = std::max(maxMass, cuts[iDecay].get(iBin, 1u));
+          }
+        }
+        maxMass2 = hasMassCut ? maxMass * maxMass : -1.f;
+      };
+      getBounds(pTBins2Prong, cut2Prong, minPt2Prong, maxMass2Prong2);
+      getBounds(pTBins3Prong, cut3Prong, minPt3Prong, maxMass3Prong2);
+      LOGP(info, "Pre-binning of the tracks: 2-prong pT > {}, m2 < {}; 3-prong pT > {}, m2 < {}", minPt2Prong, maxMass2Prong2, minPt3Prong, maxMass3Prong2);
+    }
+    cellsPos.setBinning(binsPtPreBinning, nPhiCellsPreBinning, nEtaCellsPreBinning);
+    cellsNeg.setBinning(binsPtPreBinning, nPhiCellsPreBinning, nEtaCellsPreBinning);
+
     df2.setPropagateToPCA(propagateToPCA);
     df2.setMaxR(maxR);
     df2.setMaxDZIni(maxDZIni);
@@ -1318,6 +1800,9 @@ struct HfTrackIndexSkimCreator {
     df3.setMinRelChi2Change(minRelChi2Change);
     df3.setUseAbsDCA(useAbsDCA);
     df3.setWeightedFinalPCA(useWeightedFinalPCA);
+    if (nThreadsVertexing3Prong > 1 && !debug) {
+      df3Workers.assign(nThreadsVertexing3Prong, df3);
+    }
 
     ccdb->setURL(ccdbUrl);
     ccdb->setCaching(true);
@@ -1997,6 +2482,163 @@ struct HfTrackIndexSkimCreator {
     return;
   } /// end of performPvRefitCandProngs function
 
+  /// Reconstructs the secondary vertex of a 3-prong candidate
+  /// \param fitter is the vertex fitter
+  /// \param trackParVar0 is the first daughter track
+  /// \param trackParVar1 is the second daughter track
+  /// \param trackParVar2 is the third daughter track
+  /// \param fit is the result of the fit, with no vertex if the fit failed
+  /// \param fillCovMatrix enables the calculation of the chi2 and of the covariance matrix of the secondary vertex
+  template <typename TFitter>
+  static void fitVertex3Prong(TFitter& fitter, o2::track::TrackParCov const& trackParVar0, o2::track::TrackParCov const& trackParVar1, o2::track::TrackParCov const& trackParVar2, HfFit3Prong& fit, bool fillCovMatrix)
+  {
+    fit.nVtx = 0;
+    try {
+      fit.nVtx = fitter.process(trackParVar0, trackParVar1, trackParVar2);
+    } catch (...) {
+      fit.nVtx = 0;
+    }
+    if (fit.nVtx == 0) {
+      return;
+    }
+    const auto& secondaryVertex = fitter.getPCACandidate();
+    fit.secondaryVertex = {secondaryVertex[0], secondaryVertex[1], secondaryVertex[2]};
+    for (int iProng = 0; iProng < 3; iProng++) {
+      fit.tracks[iProng] = fitter.getTrack(iProng);
+    }
+    if (fillCovMatrix) {
+      fit.chi2PCA = fitter.getChi2AtPCACandidate();
+      fit.covMatrixPCA = fitter.calcPCACovMatrixFlat();
+    }
+  }
+
+  /// Fills the table of the secondary-vertex fits with the 2-prong candidate fitted last by df2
+  void fillSvFit2Prong()
+  {
+    const auto& secondaryVertex = df2.getPCACandidate();
+    const auto covMatrixPCA = df2.calcPCACovMatrixFlat();
+    float covMatrix[6];
+    float par[2][7];
+    float covMatrixProngs[2][15];
+    std::copy(covMatrixPCA.begin(), covMatrixPCA.end(), covMatrix);
+    for (int iProng = 0; iProng < 2; iProng++) {
+      fillSvFitTrackColumns(df2.getTrack(iProng), par[iProng], covMatrixProngs[iProng]);
+    }
+    rowProng2SvFit(secondaryVertex[0], secondaryVertex[1], secondaryVertex[2], df2.getChi2AtPCACandidate(), covMatrix,
+                   par[0], covMatrixProngs[0], par[1], covMatrixProngs[1]);
+  }
+
+  /// Fills the table of the secondary-vertex fits with a 3-prong candidate
+  /// \param fit is the vertex fit of the candidate, with its covariance matrix
+  void fillSvFit3Prong(HfFit3Prong const& fit)
+  {
+    float covMatrix[6];
+    float par[3][7];
+    float covMatrixProngs[3][15];
+    std::copy(fit.covMatrixPCA.begin(), fit.covMatrixPCA.end(), covMatrix);
+    for (int iProng = 0; iProng < 3; iProng++) {
+      fillSvFitTrackColumns(fit.tracks[iProng], par[iProng], covMatrixProngs[iProng]);
+    }
+    rowProng3SvFit(fit.secondaryVertex[0], fit.secondaryVertex[1], fit.secondaryVertex[2], fit.chi2PCA, covMatrix,
+                   par[0], covMatrixProngs[0], par[1], covMatrixProngs[1], par[2], covMatrixProngs[2]);
+  }
+
+  /// Fits in parallel the secondary vertices of the 3-prong candidates formed by a pair of tracks and each third prong passing the preselections
+  /// The results are then used in the loop over the third prongs, which writes the candidates in the same order as without worker threads
+  /// \param trackIndices is the slice of the track indices of the third prongs, at the positions in thirdProngs
+  /// \param isIdentifiedPidTrack0 is the PID flag of the track with the same charge as the third prong
+  /// \param isPairSelected is false if the pair cannot form any 3-prong candidate
+  /// \param trackParVar0 is the track with the same charge as the third prong
+  /// \param trackParVar1 is the track with the opposite charge
+  /// \param pVecTrack0 is the momentum of trackParVar0
+  /// \param pVecTrack1 is the momentum of trackParVar1
+  /// \param cutStatus is a 2D array with outcome of each selection (not used, the parallel fits are disabled in debug mode)
+  template <typename TTracks, typename TTrackIndices, typename T>
+  void fit3ProngsInParallel(TTrackIndices const& trackIndices, int8_t isIdentifiedPidTrack0, bool isPairSelected,
+                            o2::track::TrackParCov const& trackParVar0, o2::track::TrackParCov const& trackParVar1,
+                            std::array<float, 3> const& pVecTrack0, std::array<float, 3> const& pVecTrack1, T& cutStatus)
+  {
+    fitIndices3Prong.clear();
+    if (df3Workers.empty() || !isPairSelected) {
+      return;
+    }
+
+    // preselections of the candidates, as in the loop over the third prongs
+    fitIndices3Prong.assign(thirdProngs.size(), -1);
+    fitThirdProngs.clear();
+    int whichHypo[kN3ProngDecays];
+    for (std::size_t iThirdProng = 0; iThirdProng < thirdProngs.size(); ++iThirdProng) {
+      auto trackIndex = trackIndices.begin() + thirdProngs[iThirdProng];
+      if (!TESTBIT(trackIndex.isSelProng(), CandidateType::Cand3Prong)) {
+        continue;
+      }
+      const auto& trackAtPv = trackCache.get(trackIndex.template track_as<TTracks>());
+      int isSelected = BIT(kN3ProngDecays) - 1;
+      int8_t isIdentifiedPidTrack0Copy = isIdentifiedPidTrack0;
+      int8_t isIdentifiedPidTrack2 = trackIndex.isIdentifiedPid();
+      applyPreselection3Prong(pVecTrack0, pVecTrack1, trackAtPv.pVec, isIdentifiedPidTrack0Copy, isIdentifiedPidTrack2, cutStatus, whichHypo, isSelected);
+      if (isSelected == 0) {
+        continue;
+      }
+      fitIndices3Prong[iThirdProng] = fitThirdProngs.size();
+      fitThirdProngs.push_back(trackAtPv.trackParCov);
+    }
+
+    // vertex fits, in contiguous ranges of candidates, the first one in this thread
+    const int nFits = fitThirdProngs.size();
+    if (nFits == 0) {
+      return;
+    }
+    fits3Prong.resize(nFits);
+    const int nThreads = std::clamp(nFits / std::max(static_cast<int>(minFitsPerThread3Prong), 1), 1, static_cast<int>(df3Workers.size()));
+    const int nFitsPerThread = (nFits + nThreads - 1) / nThreads;
+    auto fitRange = [&](int iThread) {
+      for (int iFit = iThread * nFitsPerThread; iFit < std::min(nFits, (iThread + 1) * nFitsPerThread); ++iFit) {
+        fitVertex3Prong(df3Workers[iThread], trackParVar0, trackParVar1, fitThirdProngs[iFit], fits3Prong[iFit], fillSvFit);
+      }
+    };
+    std::vector<std::thread> threads;
+    for (int iThread = 1; iThread < nThreads; ++iThread) {
+      threads.emplace_back(fitRange, iThread);
+    }
+    fitRange(0);
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  /// Returns the secondary-vertex fit of a 3-prong candidate, done now if it was not done by the worker threads
+  /// \param iThirdProng is the index of the third prong in thirdProngs
+  HfFit3Prong const& getFit3Prong(std::size_t iThirdProng, o2::track::TrackParCov const& trackParVar0, o2::track::TrackParCov const& trackParVar1, o2::track::TrackParCov const& trackParVar2)
+  {
+    if (iThirdProng < fitIndices3Prong.size() && fitIndices3Prong[iThirdProng] >= 0) {
+      return fits3Prong[fitIndices3Prong[iThirdProng]];
+    }
+    fitVertex3Prong(df3, trackParVar0, trackParVar1, trackParVar2, fit3ProngSequential, fillSvFit);
+    return fit3ProngSequential;
+  }
+
+  /// Fills the cells with the tracks of a slice of track indices
+  /// If the pre-binning is not used, all the tracks are kept and never skipped
+  /// \param trackIndices is the slice of track indices of a collision
+  /// \param collisionId is the global index of the collision
+  /// \param cells are the cells to be filled
+  template <typename TTracks, typename TTrackIndices>
+  void fillTrackCells(TTrackIndices const& trackIndices, int64_t collisionId, HfTrackCells& cells)
+  {
+    cells.clear();
+    for (const auto& trackIndex : trackIndices) {
+      if (!usePreBinning) {
+        cells.addTrack(0.f, 0.f, 0.f, true, true);
+        continue;
+      }
+      auto track = trackIndex.template track_as<TTracks>();
+      // tracks re-propagated to this collision have a different momentum in the preselections
+      cells.addTrack(track.pt(), track.eta(), track.phi(), track.collisionId() != collisionId, TESTBIT(trackIndex.isSelProng(), CandidateType::Cand3Prong));
+    }
+    cells.fillCells();
+  }
+
   template <bool doPvRefit = false, typename TTracks>
   void run2And3Prongs(SelectedCollisions const& collisions,
                       aod::BCsWithTimestamps const& bcWithTimeStamps,
@@ -2077,6 +2719,9 @@ struct HfTrackIndexSkimCreator {
       initCCDB(bc, runNumber, ccdb, isRun2 ? ccdbPathGrp : ccdbPathGrpMag, lut, isRun2);
       df2.setBz(o2::base::Propagator::Instance()->getNominalBz());
       df3.setBz(o2::base::Propagator::Instance()->getNominalBz());
+      for (auto& fitter : df3Workers) {
+        fitter.setBz(o2::base::Propagator::Instance()->getNominalBz());
+      }
 
       // used to calculate number of candidiates per event
       auto nCand2 = rowTrackIndexProng2.lastIndex();
@@ -2088,11 +2733,15 @@ struct HfTrackIndexSkimCreator {
       //}
 
       auto thisCollId = collision.globalIndex();
+      trackCache.setCollision(collision);
 
       // first loop over positive tracks
       auto groupedTrackIndicesPos1 = positiveFor2And3Prongs->sliceByCached(aod::track::collisionId, collision.globalIndex(), cache);
+      fillTrackCells<TTracks>(groupedTrackIndicesPos1, thisCollId, cellsPos);
+      fillTrackCells<TTracks>(negativeFor2And3Prongs->sliceByCached(aod::track::collisionId, collision.globalIndex(), cache), thisCollId, cellsNeg);
       int lastFilledD0 = -1; // index to be filled in table for D* mesons
-      for (auto trackIndexPos1 = groupedTrackIndicesPos1.begin(); trackIndexPos1 != groupedTrackIndicesPos1.end(); ++trackIndexPos1) {
+      int iPos1 = 0;         // position of the first positive track in the slice
+      for (auto trackIndexPos1 = groupedTrackIndicesPos1.begin(); trackIndexPos1 != groupedTrackIndicesPos1.end(); ++trackIndexPos1, ++iPos1) {
         auto trackPos1 = trackIndexPos1.template track_as<TTracks>();
 
         // retrieve the selection flag that corresponds to this collision
@@ -2100,17 +2749,26 @@ struct HfTrackIndexSkimCreator {
         bool sel2ProngStatusPos = TESTBIT(isSelProngPos1, CandidateType::Cand2Prong);
         bool sel3ProngStatusPos1 = TESTBIT(isSelProngPos1, CandidateType::Cand3Prong);
 
-        auto trackParVarPos1 = getTrackParCov(trackPos1);
-        std::array<float, 3> pVecTrackPos1{trackPos1.pVector()};
-        o2::gpu::gpustd::array<float, 2> dcaInfoPos1{trackPos1.dcaXY(), trackPos1.dcaZ()};
-        if (thisCollId != trackPos1.collisionId()) { // this is not the "default" collision for this track, we have to re-propagate it
-          o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParVarPos1, 2.f, noMatCorr, &dcaInfoPos1);
-          getPxPyPz(trackParVarPos1, pVecTrackPos1);
-        }
+        const auto& [trackParVarPos1, pVecTrackPos1, dcaInfoPos1] = trackCache.get(trackPos1);
 
         // first loop over negative tracks
         auto groupedTrackIndicesNeg1 = negativeFor2And3Prongs->sliceByCached(aod::track::collisionId, collision.globalIndex(), cache);
-        for (auto trackIndexNeg1 = groupedTrackIndicesNeg1.begin(); trackIndexNeg1 != groupedTrackIndicesNeg1.end(); ++trackIndexNeg1) {
+        int iNeg1 = 0; // position of the first negative track in the slice
+        for (auto trackIndexNeg1 = groupedTrackIndicesNeg1.begin(); trackIndexNeg1 != groupedTrackIndicesNeg1.end(); ++trackIndexNeg1, ++iNeg1) {
+          // skip the pairs that cannot pass the pT and invariant-mass preselections of any channel
+          const auto& kinematicsPos1 = cellsPos.tracks[iPos1];
+          const auto& kinematicsNeg1 = cellsNeg.tracks[iNeg1];
+          bool isPairGoodFor2Prong{true};
+          bool isPairGoodFor3Prong{true};
+          if (!kinematicsPos1.isNeverSkipped && !kinematicsNeg1.isNeverSkipped) {
+            float minMass2Pair = HfTrackCells::getMinMass2(kinematicsPos1, kinematicsNeg1) / HfTrackCells::kMarginMass2;
+            isPairGoodFor2Prong = kinematicsPos1.pt + kinematicsNeg1.pt + ptTolerance + HfTrackCells::kMarginPt >= minPt2Prong && (maxMass2Prong2 < 0.f || minMass2Pair < maxMass2Prong2);
+            isPairGoodFor3Prong = maxMass3Prong2 < 0.f || minMass2Pair < maxMass3Prong2;
+            if (!isPairGoodFor2Prong && (!isPairGoodFor3Prong || !do3Prong)) {
+              continue;
+            }
+          }
+
           auto trackNeg1 = trackIndexNeg1.template track_as<TTracks>();
 
           // retrieve the selection flag that corresponds to this collision
@@ -2118,13 +2776,7 @@ struct HfTrackIndexSkimCreator {
           bool sel2ProngStatusNeg = TESTBIT(isSelProngNeg1, CandidateType::Cand2Prong);
           bool sel3ProngStatusNeg1 = TESTBIT(isSelProngNeg1, CandidateType::Cand3Prong);
 
-          auto trackParVarNeg1 = getTrackParCov(trackNeg1);
-          std::array<float, 3> pVecTrackNeg1{trackNeg1.pVector()};
-          o2::gpu::gpustd::array<float, 2> dcaInfoNeg1{trackNeg1.dcaXY(), trackNeg1.dcaZ()};
-          if (thisCollId != trackNeg1.collisionId()) { // this is not the "default" collision for this track, we have to re-propagate it
-            o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParVarNeg1, 2.f, noMatCorr, &dcaInfoNeg1);
-            getPxPyPz(trackParVarNeg1, pVecTrackNeg1);
-          }
+          const auto& [trackParVarNeg1, pVecTrackNeg1, dcaInfoNeg1] = trackCache.get(trackNeg1);
 
           int isSelected2ProngCand = n2ProngBit; // bitmap for checking status of two-prong candidates (1 is true, 0 is rejected)
 
@@ -2142,13 +2794,17 @@ struct HfTrackIndexSkimCreator {
 
           // 2-prong vertex reconstruction
           float pt2Prong{-1.};
-          bool is2ProngCandidateGoodFor3Prong{sel3ProngStatusPos1 && sel3ProngStatusNeg1};
+          bool is2ProngCandidateGoodFor3Prong{sel3ProngStatusPos1 && sel3ProngStatusNeg1 && isPairGoodFor3Prong};
           int nVtxFrom2ProngFitter = 0;
           if (sel2ProngStatusPos && sel2ProngStatusNeg) {
 
             // 2-prong preselections
             // TODO: in case of PV refit, the single-track DCA is calculated wrt two different PV vertices (only 1 track excluded)
-            applyPreselection2Prong(pVecTrackPos1, pVecTrackNeg1, dcaInfoPos1[0], dcaInfoNeg1[0], cutStatus2Prong, whichHypo2Prong, isSelected2ProngCand, pt2Prong);
+            if (isPairGoodFor2Prong) {
+              applyPreselection2Prong(pVecTrackPos1, pVecTrackNeg1, dcaInfoPos1[0], dcaInfoNeg1[0], cutStatus2Prong, whichHypo2Prong, isSelected2ProngCand, pt2Prong);
+            } else {
+              isSelected2ProngCand = 0;
+            }
 
             if (isSelected2ProngCand > 0) {
               // secondary vertex reconstruction and further 2-prong selections
@@ -2250,6 +2906,9 @@ struct HfTrackIndexSkimCreator {
                 if (isSelected2ProngCand > 0) {
                   // fill table row
                   rowTrackIndexProng2(thisCollId, trackPos1.globalIndex(), trackNeg1.globalIndex(), isSelected2ProngCand);
+                  if (fillSvFit) {
+                    fillSvFit2Prong();
+                  }
                   if (applyMlForHfFilters) {
                     rowTrackIndexMlScoreProng2(mlScoresD0);
                   }
@@ -2332,8 +2991,11 @@ struct HfTrackIndexSkimCreator {
           }
 
           if (do3Prong == 1 && is2ProngCandidateGoodFor3Prong) { // if 3 prongs are enabled and the first 2 tracks are selected for the 3-prong channels
-            // second loop over positive tracks
-            for (auto trackIndexPos2 = trackIndexPos1 + 1; trackIndexPos2 != groupedTrackIndicesPos1.end(); ++trackIndexPos2) {
+            // second loop over positive tracks, only over the ones that can pass the pT and invariant-mass preselections
+            cellsPos.getThirdProngs(iPos1, kinematicsPos1, kinematicsNeg1, minPt3Prong - ptTolerance - kinematicsPos1.pt - kinematicsNeg1.pt, maxMass3Prong2, thirdProngs);
+            fit3ProngsInParallel<TTracks>(groupedTrackIndicesPos1, trackIndexPos1.isIdentifiedPid(), !applyKaonPidIn3Prongs || TESTBIT(trackIndexNeg1.isIdentifiedPid(), channelKaonPid), trackParVarPos1, trackParVarNeg1, pVecTrackPos1, pVecTrackNeg1, cutStatus3Prong);
+            for (std::size_t iThirdProng = 0; iThirdProng < thirdProngs.size(); ++iThirdProng) {
+              auto trackIndexPos2 = groupedTrackIndicesPos1.begin() + thirdProngs[iThirdProng];
 
               int isSelected3ProngCand = n3ProngBit;
               if (!TESTBIT(trackIndexPos2.isSelProng(), CandidateType::Cand3Prong)) { // continue immediately
@@ -2353,17 +3015,10 @@ struct HfTrackIndexSkimCreator {
               }
 
               auto trackPos2 = trackIndexPos2.template track_as<TTracks>();
-              auto trackParVarPos2 = getTrackParCov(trackPos2);
-              o2::gpu::gpustd::array<float, 2> dcaInfoPos2{trackPos2.dcaXY(), trackPos2.dcaZ()};
+              const auto& [trackParVarPos2, pVecTrackPos2, dcaInfoPos2] = trackCache.get(trackPos2);
 
               // preselection of 3-prong candidates
               if (isSelected3ProngCand) {
-                std::array<float, 3> pVecTrackPos2{trackPos2.pVector()};
-                if (thisCollId != trackPos2.collisionId()) { // this is not the "default" collision for this track and we still did not re-propagate it, we have to re-propagate it
-                  o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParVarPos2, 2.f, noMatCorr, &dcaInfoPos2);
-                  getPxPyPz(trackParVarPos2, pVecTrackPos2);
-                }
-
                 if (debug) {
                   for (int iDecay3P = 0; iDecay3P < kN3ProngDecays; iDecay3P++) {
                     for (int iCut = 0; iCut < kNCuts3Prong[iDecay3P]; iCut++) {
@@ -2470,26 +3125,20 @@ struct HfTrackIndexSkimCreator {
                 }
               }
 
-              // reconstruct the 3-prong secondary vertex
-              int nVtxFrom3ProngFitter = 0;
-              try {
-                nVtxFrom3ProngFitter = df3.process(trackParVarPos1, trackParVarNeg1, trackParVarPos2);
-              } catch (...) {
-                continue;
-              }
-
-              if (nVtxFrom3ProngFitter == 0) {
+              // reconstruct the 3-prong secondary vertex, unless already done by the worker threads
+              const auto& fit3Prong = getFit3Prong(iThirdProng, trackParVarPos1, trackParVarNeg1, trackParVarPos2);
+              if (fit3Prong.nVtx == 0) {
                 continue;
               }
               // get secondary vertex
-              const auto& secondaryVertex3 = df3.getPCACandidate();
+              const auto& secondaryVertex3 = fit3Prong.secondaryVertex;
               // get track momenta
               std::array<float, 3> pvec0;
               std::array<float, 3> pvec1;
               std::array<float, 3> pvec2;
-              auto trackParVarPcaPos1 = df3.getTrack(0);
-              auto trackParVarPcaNeg1 = df3.getTrack(1);
-              auto trackParVarPcaPos2 = df3.getTrack(2);
+              const auto& trackParVarPcaPos1 = fit3Prong.tracks[0];
+              const auto& trackParVarPcaNeg1 = fit3Prong.tracks[1];
+              const auto& trackParVarPcaPos2 = fit3Prong.tracks[2];
               trackParVarPcaPos1.getPxPyPzGlo(pvec0);
               trackParVarPcaNeg1.getPxPyPzGlo(pvec1);
               trackParVarPcaPos2.getPxPyPzGlo(pvec2);
@@ -2510,6 +3159,9 @@ struct HfTrackIndexSkimCreator {
 
               // fill table row
               rowTrackIndexProng3(thisCollId, trackPos1.globalIndex(), trackNeg1.globalIndex(), trackPos2.globalIndex(), isSelected3ProngCand);
+              if (fillSvFit) {
+                fillSvFit3Prong(fit3Prong);
+              }
               if (applyMlForHfFilters) {
                 rowTrackIndexMlScoreProng3(mlScores3Prongs[0], mlScores3Prongs[1], mlScores3Prongs[2], mlScores3Prongs[3]);
               }
@@ -2576,8 +3228,11 @@ struct HfTrackIndexSkimCreator {
               }
             }
 
-            // second loop over negative tracks
-            for (auto trackIndexNeg2 = trackIndexNeg1 + 1; trackIndexNeg2 != groupedTrackIndicesNeg1.end(); ++trackIndexNeg2) {
+            // second loop over negative tracks, only over the ones that can pass the pT and invariant-mass preselections
+            cellsNeg.getThirdProngs(iNeg1, kinematicsNeg1, kinematicsPos1, minPt3Prong - ptTolerance - kinematicsPos1.pt - kinematicsNeg1.pt, maxMass3Prong2, thirdProngs);
+            fit3ProngsInParallel<TTracks>(groupedTrackIndicesNeg1, trackIndexNeg1.isIdentifiedPid(), !applyKaonPidIn3Prongs || TESTBIT(trackIndexPos1.isIdentifiedPid(), channelKaonPid), trackParVarNeg1, trackParVarPos1, pVecTrackNeg1, pVecTrackPos1, cutStatus3Prong);
+            for (std::size_t iThirdProng = 0; iThirdProng < thirdProngs.size(); ++iThirdProng) {
+              auto trackIndexNeg2 = groupedTrackIndicesNeg1.begin() + thirdProngs[iThirdProng];
 
               int isSelected3ProngCand = n3ProngBit;
               if (!TESTBIT(trackIndexNeg2.isSelProng(), CandidateType::Cand3Prong)) { // continue immediately
@@ -2597,17 +3252,10 @@ struct HfTrackIndexSkimCreator {
               }
 
               auto trackNeg2 = trackIndexNeg2.template track_as<TTracks>();
-              auto trackParVarNeg2 = getTrackParCov(trackNeg2);
-              o2::gpu::gpustd::array<float, 2> dcaInfoNeg2{trackNeg2.dcaXY(), trackNeg2.dcaZ()};
+              const auto& [trackParVarNeg2, pVecTrackNeg2, dcaInfoNeg2] = trackCache.get(trackNeg2);
 
               // preselection of 3-prong candidates
               if (isSelected3ProngCand) {
-                std::array<float, 3> pVecTrackNeg2{trackNeg2.pVector()};
-                if (thisCollId != trackNeg2.collisionId()) { // this is not the "default" collision for this track and we still did not re-propagate it, we have to re-propagate it
-                  o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParVarNeg2, 2.f, noMatCorr, &dcaInfoNeg2);
-                  getPxPyPz(trackParVarNeg2, pVecTrackNeg2);
-                }
-
                 if (debug) {
                   for (int iDecay3P = 0; iDecay3P < kN3ProngDecays; iDecay3P++) {
                     for (int iCut = 0; iCut < kNCuts3Prong[iDecay3P]; iCut++) {
@@ -2714,26 +3362,20 @@ struct HfTrackIndexSkimCreator {
                 }
               }
 
-              // reconstruct the 3-prong secondary vertex
-              int nVtxFrom3ProngFitterSecondLoop = 0;
-              try {
-                nVtxFrom3ProngFitterSecondLoop = df3.process(trackParVarNeg1, trackParVarPos1, trackParVarNeg2);
-              } catch (...) {
-                continue;
-              }
-
-              if (nVtxFrom3ProngFitterSecondLoop == 0) {
+              // reconstruct the 3-prong secondary vertex, unless already done by the worker threads
+              const auto& fit3Prong = getFit3Prong(iThirdProng, trackParVarNeg1, trackParVarPos1, trackParVarNeg2);
+              if (fit3Prong.nVtx == 0) {
                 continue;
               }
               // get secondary vertex
-              const auto& secondaryVertex3 = df3.getPCACandidate();
+              const auto& secondaryVertex3 = fit3Prong.secondaryVertex;
               // get track momenta
               std::array<float, 3> pvec0;
               std::array<float, 3> pvec1;
               std::array<float, 3> pvec2;
-              auto trackParVarPcaNeg1 = df3.getTrack(0);
-              auto trackParVarPcaPos1 = df3.getTrack(1);
-              auto trackParVarPcaNeg2 = df3.getTrack(2);
+              const auto& trackParVarPcaNeg1 = fit3Prong.tracks[0];
+              const auto& trackParVarPcaPos1 = fit3Prong.tracks[1];
+              const auto& trackParVarPcaNeg2 = fit3Prong.tracks[2];
               trackParVarPcaNeg1.getPxPyPzGlo(pvec0);
               trackParVarPcaPos1.getPxPyPzGlo(pvec1);
               trackParVarPcaNeg2.getPxPyPzGlo(pvec2);
@@ -2755,6 +3397,9 @@ struct HfTrackIndexSkimCreator {
 
               // fill table row
               rowTrackIndexProng3(thisCollId, trackNeg1.globalIndex(), trackPos1.globalIndex(), trackNeg2.globalIndex(), isSelected3ProngCand);
+              if (fillSvFit) {
+                fillSvFit3Prong(fit3Prong);
+              }
               if (applyMlForHfFilters) {
                 rowTrackIndexMlScoreProng3(mlScores3Prongs[0], mlScores3Prongs[1], mlScores3Prongs[2], mlScores3Prongs[3]);
               }
@@ -2831,13 +3476,7 @@ struct HfTrackIndexSkimCreator {
                   continue;
                 }
                 auto trackPos2 = trackIndexPos2.template track_as<TTracks>();
-                std::array<float, 3> pVecTrackPos2{trackPos2.pVector()};
-                if (thisCollId != trackPos2.collisionId()) { // this is not the "default" collision for this track, we have to re-propagate it
-                  auto trackParVarPos2 = getTrackParCov(trackPos2);
-                  o2::gpu::gpustd::array<float, 2> dcaInfoPos2{trackPos2.dcaXY(), trackPos2.dcaZ()};
-                  o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParVarPos2, 2.f, noMatCorr, &dcaInfoPos2);
-                  getPxPyPz(trackParVarPos2, pVecTrackPos2);
-                }
+                const auto& pVecTrackPos2 = trackCache.get(trackPos2).pVec;
 
                 uint8_t isSelectedDstar{0};
                 uint8_t cutStatus{BIT(kNCutsDstar) - 1};
@@ -2868,13 +3507,7 @@ struct HfTrackIndexSkimCreator {
                   continue;
                 }
                 auto trackNeg2 = trackIndexNeg2.template track_as<TTracks>();
-                std::array<float, 3> pVecTrackNeg2{trackNeg2.pVector()};
-                if (thisCollId != trackNeg2.collisionId()) { // this is not the "default" collision for this track, we have to re-propagate it
-                  auto trackParVarNeg2 = getTrackParCov(trackNeg2);
-                  o2::gpu::gpustd::array<float, 2> dcaInfoNeg2{trackNeg2.dcaXY(), trackNeg2.dcaZ()};
-                  o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParVarNeg2, 2.f, noMatCorr, &dcaInfoNeg2);
-                  getPxPyPz(trackParVarNeg2, pVecTrackNeg2);
-                }
+                const auto& pVecTrackNeg2 = trackCache.get(trackNeg2).pVec;
 
                 uint8_t isSelectedDstar{0};
                 uint8_t cutStatus{BIT(kNCutsDstar) - 1};
@@ -3005,6 +3638,7 @@ struct HfTrackIndexSkimCreatorCascades {
   o2::base::MatLayerCylSet* lut;
   o2::base::Propagator::MatCorrType noMatCorr = o2::base::Propagator::MatCorrType::USEMatCorrNONE;
   int runNumber;
+  HfTrackParCovCache trackCache; // bachelor tracks of the current collision, used at their default primary vertex
 
   double massP{0.};
   double massK0s{0.};
@@ -3035,6 +3669,7 @@ struct HfTrackIndexSkimCreatorCascades {
 
     massP = o2::constants::physics::MassProton;
     massK0s = o2::constants::physics::MassK0Short;
+    trackCache.propagateToCollision = false;
     massPi = o2::constants::physics::MassPiPlus;
     massLc = o2::constants::physics::MassLambdaCPlus;
 
@@ -3083,6 +3718,7 @@ struct HfTrackIndexSkimCreatorCascades {
 
       const auto thisCollId = collision.globalIndex();
       auto groupedBachTrackIndices = trackIndices.sliceBy(trackIndicesPerCollision, thisCollId);
+      trackCache.setCollision(collision);
 
       // for (const auto& bach : selectedTracks) {
       for (const auto& bachIdx : groupedBachTrackIndices) {
@@ -3102,7 +3738,7 @@ struct HfTrackIndexSkimCreatorCascades {
           continue;
         }
 
-        auto trackBach = getTrackParCov(bach);
+        const auto& trackBach = trackCache.get(bach).trackParCov;
 
         auto groupedV0s = v0s.sliceBy(v0sPerCollision, thisCollId);
         // now we loop over the V0s
@@ -3278,6 +3914,7 @@ struct HfTrackIndexSkimCreatorLfCascades {
   o2::base::MatLayerCylSet* lut;
   o2::base::Propagator::MatCorrType matCorr = o2::base::Propagator::MatCorrType::USEMatCorrLUT;
   int runNumber;
+  HfTrackParCovCache trackCache; // charm-bachelor tracks of the current collision, used at their default primary vertex
 
   // array of PDG masses of possible charm baryon daughters
   static constexpr int kN2ProngDecays = hf_cand_casc_lf::DecayType2Prong::N2ProngDecays; // number of 2-prong hadron types
@@ -3317,6 +3954,7 @@ struct HfTrackIndexSkimCreatorLfCascades {
     massP = o2::constants::physics::MassProton;
     massPi = o2::constants::physics::MassPiPlus;
     massKaon = o2::constants::physics::MassKPlus;
+    trackCache.propagateToCollision = false;
     massXi = o2::constants::physics::MassXiMinus;
     massOmega = o2::constants::physics::MassOmegaMinus;
     massLambda = o2::constants::physics::MassLambda0;
@@ -3465,6 +4103,7 @@ struct HfTrackIndexSkimCreatorLfCascades {
 
       // cascade loop
       auto thisCollId = collision.globalIndex();
+      trackCache.setCollision(collision);
       auto groupedCascades = cascades.sliceBy(cascadesPerCollision, thisCollId);
 
       for (const auto& casc : groupedCascades) {
@@ -3546,7 +4185,7 @@ struct HfTrackIndexSkimCreatorLfCascades {
           }
 
           // primary pion track to be processed with DCAFitter
-          auto trackParVarCharmBachelor1 = getTrackParCov(trackCharmBachelor1);
+          const auto& trackParVarCharmBachelor1 = trackCache.get(trackCharmBachelor1).trackParCov;
 
           // find charm baryon decay using xi PID hypothesis (xi pi channel)
           int nVtxFrom2ProngFitterXiHyp = 0;
@@ -3677,7 +4316,7 @@ struct HfTrackIndexSkimCreatorLfCascades {
               }
 
               // primary pion track to be processed with DCAFitter
-              auto trackParVarPion2 = getTrackParCov(trackCharmBachelor2);
+              const auto& trackParVarPion2 = trackCache.get(trackCharmBachelor2).trackParCov;
 
               // reconstruct Xic with DCAFitter
               int nVtxFrom3ProngFitterXiHyp = 0;
@@ -17,6 +17,9 @@
 /// \author Nicolo' Jacazio <nicolo.jacazio@cern.ch>, CERN
 /// \author Andrea Tavira García <tavira-garcia@ijclab.in2p3.fr>, IJCLab
 
+#include <random>
+#include <vector>
+
 #include "CommonConstants/PhysicsConstants.h"
 #include "Framework/AnalysisTask.h"
 #include "Framework/runDataProcessing.h"
@@ -24,6 +27,7 @@
 #include "PWGHF/Core/HfHelper.h"
 #include "PWGHF/DataModel/CandidateReconstructionTables.h"
 #include "PWGHF/DataModel/CandidateSelectionTables.h"
+#include "PWGHF/Utils/utilsReservoirSampling.h"
 
 using namespace o2;
 using namespace o2::framework;
@@ -74,6 +78,7 @@ DECLARE_SOA_COLUMN(CosThetaStar, cosThetaStar, float);
 DECLARE_SOA_COLUMN(FlagMc, flagMc, int8_t);
 DECLARE_SOA_COLUMN(OriginMcRec, originMcRec, int8_t); // is prompt or non-prompt, reco level
 DECLARE_SOA_COLUMN(OriginMcGen, originMcGen, int8_t); // is prompt or non-prompt, Gen level
+DECLARE_SOA_COLUMN(SamplingWeight, samplingWeight, float); // number of candidates represented by the row (downsampling)
 DECLARE_SOA_INDEX_COLUMN_FULL(Candidate, candidate, int, HfCand2Prong, "_0");
 DECLARE_SOA_INDEX_COLUMN(McParticle, mcParticle);
 // Events
@@ -117,7 +122,8 @@ DECLARE_SOA_TABLE(HfCandD0Lites, "AOD", "HFCANDD0LITE",
                   full::Phi,
                   full::Y,
                   full::FlagMc,
-                  full::OriginMcRec)
+                  full::OriginMcRec,
+                  full::SamplingWeight)
 
 DECLARE_SOA_TABLE(HfCandD0Fulls, "AOD", "HFCANDD0FULL",
                   full::CollisionId,
@@ -180,7 +186,8 @@ DECLARE_SOA_TABLE(HfCandD0Fulls, "AOD", "HFCANDD0FULL",
                   full::E,
                   full::FlagMc,
                   full::OriginMcRec,
-                  full::CandidateId);
+                  full::CandidateId,
+                  full::SamplingWeight);
 
 DECLARE_SOA_TABLE(HfCandD0FullEvs, "AOD", "HFCANDD0FULLEV",
                   full::CollisionId,
@@ -214,8 +221,14 @@ struct HfTreeCreatorD0ToKPi {
   // parameters for production of training samples
   Configurable<float> downSampleBkgFactor{"downSampleBkgFactor", 1., "Fraction of background candidates to keep for ML trainings"};
   Configurable<float> ptMaxForDownSample{"ptMaxForDownSample", 10., "Maximum pt for the application of the downsampling factor"};
+  Configurable<bool> applyReservoirSampling{"applyReservoirSampling", false, "Keep a fixed number of candidates per pT bin and class in each dataframe instead of applying the downsampling factor"};
+  Configurable<std::vector<double>> binsPtReservoir{"binsPtReservoir", std::vector<double>{0., 1., 2., 4., 6., 8., 12., 24.}, "pT bin limits for the reservoir sampling"};
+  Configurable<std::vector<int>> reservoirSizesBkg{"reservoirSizesBkg", std::vector<int>{100, 100, 100, 100, 100, 100, -1}, "Background (and data) candidates kept per pT bin and dataframe, negative to keep all"};
+  Configurable<std::vector<int>> reservoirSizesSig{"reservoirSizesSig", std::vector<int>{-1, -1, -1, -1, -1, -1, -1}, "Signal candidates kept per pT bin and dataframe, negative to keep all"};
+  Configurable<int> reservoirSeed{"reservoirSeed", 0, "Seed of the reservoir sampling, 0 for a random seed"};
 
   HfHelper hfHelper;
+  std::mt19937_64 generator; // reservoir sampling
 
   using TracksWPid = soa::Join<aod::Tracks, aod::TracksPidPi, aod::PidTpcTofFullPi, aod::TracksPidKa, aod::PidTpcTofFullKa>;
   using SelectedCandidatesMc = soa::Filtered<soa::Join<aod::HfCand2Prong, aod::HfCand2ProngMcRec, aod::HfSelD0>>;
@@ -236,6 +249,7 @@ struct HfTreeCreatorD0ToKPi {
     if (std::accumulate(doprocess.begin(), doprocess.end(), 0) != 1) {
       LOGP(fatal, "Only one process function can be enabled at a time.");
     }
+    generator.seed(reservoirSeed.value != 0 ? static_cast<uint64_t>(reservoirSeed.value) : std::random_device{}());
   }
 
   template <typename T>
@@ -253,7 +267,7 @@ struct HfTreeCreatorD0ToKPi {
 
   template <typename T, typename U>
   auto fillTable(const T& candidate, const U& prong0, const U& prong1, int candFlag, double invMass, double cosThetaStar, double topoChi2,
-                 double ct, double y, double e, int8_t flagMc, int8_t origin)
+                 double ct, double y, double e, int8_t flagMc, int8_t origin, float weight)
   {
     if (fillCandidateLiteTable) {
       rowCandidateLite(
@@ -291,7 +305,8 @@ struct HfTreeCreatorD0ToKPi {
         candidate.phi(),
         y,
         flagMc,
-        origin);
+        origin,
+        weight);
     } else {
       rowCandidateFull(
         candidate.collisionId(),
@@ -354,7 +369,40 @@ struct HfTreeCreatorD0ToKPi {
         e,
         flagMc,
         origin,
-        candidate.globalIndex());
+        candidate.globalIndex(),
+        weight);
+    }
+  }
+
+  template <int reconstructionType, bool doMc, typename T>
+  void fillCandidate(const T& candidate, float weight)
+  {
+    auto prong0 = candidate.template prong0_as<TracksWPid>();
+    auto prong1 = candidate.template prong1_as<TracksWPid>();
+    double yD = hfHelper.yD0(candidate);
+    double eD = hfHelper.eD0(candidate);
+    double ctD = hfHelper.ctD0(candidate);
+    float massD0, massD0bar;
+    float topolChi2PerNdf = -999.;
+    if constexpr (reconstructionType == aod::hf_cand::VertexerType::KfParticle) {
+      massD0 = candidate.kfGeoMassD0();
+      massD0bar = candidate.kfGeoMassD0bar();
+      topolChi2PerNdf = candidate.kfTopolChi2OverNdf();
+    } else {
+      massD0 = hfHelper.invMassD0ToPiK(candidate);
+      massD0bar = hfHelper.invMassD0barToKPi(candidate);
+    }
+    int8_t flagMc = 0;
+    int8_t origin = 0;
+    if constexpr (doMc) {
+      flagMc = candidate.flagMcMatchRec();
+      origin = candidate.originMcRec();
+    }
+    if (candidate.isSelD0()) {
+      fillTable(candidate, prong0, prong1, 0, massD0, hfHelper.cosThetaStarD0(candidate), topolChi2PerNdf, ctD, yD, eD, flagMc, origin, weight);
+    }
+    if (candidate.isSelD0bar()) {
+      fillTable(candidate, prong0, prong1, 1, massD0bar, hfHelper.cosThetaStarD0bar(candidate), topolChi2PerNdf, ctD, yD, eD, flagMc, origin, weight);
     }
   }
 
@@ -375,34 +423,24 @@ struct HfTreeCreatorD0ToKPi {
     } else {
       rowCandidateFull.reserve(candidates.size());
     }
+    if (applyReservoirSampling) {
+      o2::analysis::HfStratifiedReservoir<typename CandType::iterator> reservoir(binsPtReservoir, reservoirSizesBkg, reservoirSizesSig, generator);
+      for (const auto& candidate : candidates) {
+        reservoir.offer(candidate, candidate.pt(), false);
+      }
+      reservoir.flush([&](const auto& candidate, float weight) { fillCandidate<reconstructionType, false>(candidate, weight); });
+      return;
+    }
     for (const auto& candidate : candidates) {
-      if (downSampleBkgFactor < 1.) {
+      float weight = 1.f;
+      if (downSampleBkgFactor < 1. && candidate.pt() < ptMaxForDownSample) {
         float pseudoRndm = candidate.ptProng0() * 1000. - (int64_t)(candidate.ptProng0() * 1000);
-        if (candidate.pt() < ptMaxForDownSample && pseudoRndm >= downSampleBkgFactor) {
+        if (pseudoRndm >= downSampleBkgFactor) {
           continue;
         }
+        weight = 1.f / downSampleBkgFactor;
       }
-      auto prong0 = candidate.template prong0_as<TracksWPid>();
-      auto prong1 = candidate.template prong1_as<TracksWPid>();
-      double yD = hfHelper.yD0(candidate);
-      double eD = hfHelper.eD0(candidate);
-      double ctD = hfHelper.ctD0(candidate);
-      float massD0, massD0bar;
-      float topolChi2PerNdf = -999.;
-      if constexpr (reconstructionType == aod::hf_cand::VertexerType::KfParticle) {
-        massD0 = candidate.kfGeoMassD0();
-        massD0bar = candidate.kfGeoMassD0bar();
-        topolChi2PerNdf = candidate.kfTopolChi2OverNdf();
-      } else {
-        massD0 = hfHelper.invMassD0ToPiK(candidate);
-        massD0bar = hfHelper.invMassD0barToKPi(candidate);
-      }
-      if (candidate.isSelD0()) {
-        fillTable(candidate, prong0, prong1, 0, massD0, hfHelper.cosThetaStarD0(candidate), topolChi2PerNdf, ctD, yD, eD, 0, 0);
-      }
-      if (candidate.isSelD0bar()) {
-        fillTable(candidate, prong0, prong1, 1, massD0bar, hfHelper.cosThetaStarD0bar(candidate), topolChi2PerNdf, ctD, yD, eD, 0, 0);
-      }
+      fillCandidate<reconstructionType, false>(candidate, weight);
     }
   }
 
@@ -444,45 +482,36 @@ struct HfTreeCreatorD0ToKPi {
     } else {
       rowCandidateFull.reserve(candidates.size());
     }
+    o2::analysis::HfStratifiedReservoir<typename CandType::iterator> reservoir(binsPtReservoir, reservoirSizesBkg, reservoirSizesSig, generator);
     for (const auto& candidate : candidates) {
+      const bool isSignal = TESTBIT(std::abs(candidate.flagMcMatchRec()), aod::hf_cand_2prong::DecayType::D0ToPiK);
       if constexpr (onlyBkg) {
-        if (TESTBIT(std::abs(candidate.flagMcMatchRec()), aod::hf_cand_2prong::DecayType::D0ToPiK)) {
+        if (isSignal) {
           continue;
         }
-        if (downSampleBkgFactor < 1.) {
-          float pseudoRndm = candidate.ptProng0() * 1000. - (int64_t)(candidate.ptProng0() * 1000);
-          if (candidate.pt() < ptMaxForDownSample && pseudoRndm >= downSampleBkgFactor) {
-            continue;
-          }
-        }
       }
       if constexpr (onlySig) {
-        if (!TESTBIT(std::abs(candidate.flagMcMatchRec()), aod::hf_cand_2prong::DecayType::D0ToPiK)) {
+        if (!isSignal) {
           continue;
         }
       }
-      auto prong0 = candidate.template prong0_as<TracksWPid>();
-      auto prong1 = candidate.template prong1_as<TracksWPid>();
-      double yD = hfHelper.yD0(candidate);
-      double eD = hfHelper.eD0(candidate);
-      double ctD = hfHelper.ctD0(candidate);
-      float massD0, massD0bar;
-      float topolChi2PerNdf = -999.;
-      if constexpr (reconstructionType == aod::hf_cand::VertexerType::KfParticle) {
-        massD0 = candidate.kfGeoMassD0();
-        massD0bar = candidate.kfGeoMassD0bar();
-        topolChi2PerNdf = candidate.kfTopolChi2OverNdf();
-      } else {
-        massD0 = hfHelper.invMassD0ToPiK(candidate);
-        massD0bar = hfHelper.invMassD0barToKPi(candidate);
+      if (applyReservoirSampling) {
+        reservoir.offer(candidate, candidate.pt(), isSignal);
+        continue;
       }
-      if (candidate.isSelD0()) {
-        fillTable(candidate, prong0, prong1, 0, massD0, hfHelper.cosThetaStarD0(candidate), topolChi2PerNdf, ctD, yD, eD, candidate.flagMcMatchRec(), candidate.originMcRec());
-      }
-      if (candidate.isSelD0bar()) {
-        fillTable(candidate, prong0, prong1, 1, massD0bar, hfHelper.cosThetaStarD0bar(candidate), topolChi2PerNdf, ctD, yD, eD, candidate.flagMcMatchRec(), candidate.originMcRec());
+      float weight = 1.f;
+      if constexpr (onlyBkg) {
+        if (downSampleBkgFactor < 1. && candidate.pt() < ptMaxForDownSample) {
+          float pseudoRndm = candidate.ptProng0() * 1000. - (int64_t)(candidate.ptProng0() * 1000);
+          if (pseudoRndm >= downSampleBkgFactor) {
+            continue;
+          }
+          weight = 1.f / downSampleBkgFactor;
+        }
       }
+      fillCandidate<reconstructionType, true>(candidate, weight);
     }
+    reservoir.flush([&](const auto& candidate, float weight) { fillCandidate<reconstructionType, true>(candidate, weight); });
 
     // Filling particle properties
     rowCandidateFullParticles.reserve(mcParticles.size());
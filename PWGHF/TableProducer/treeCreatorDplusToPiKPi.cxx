@@ -16,6 +16,9 @@
 ///
 /// \author Alexandre Bigot <alexandre.bigot@cern.ch>, IPHC Strasbourg
 
+#include <random>
+#include <vector>
+
 #include "CommonConstants/PhysicsConstants.h"
 #include "Framework/AnalysisTask.h"
 #include "Framework/runDataProcessing.h"
@@ -23,6 +26,7 @@
 #include "PWGHF/Core/HfHelper.h"
 #include "PWGHF/DataModel/CandidateReconstructionTables.h"
 #include "PWGHF/DataModel/CandidateSelectionTables.h"
+#include "PWGHF/Utils/utilsReservoirSampling.h"
 
 using namespace o2;
 using namespace o2::framework;
@@ -76,6 +80,7 @@ DECLARE_SOA_COLUMN(Cpa, cpa, float);
 DECLARE_SOA_COLUMN(CpaXY, cpaXY, float);                                           //! Cosine pointing angle of candidate in transverse plane
 DECLARE_SOA_COLUMN(MaxNormalisedDeltaIP, maxNormalisedDeltaIP, float);             //! Maximum normalized difference between measured and expected impact parameter of candidate prongs
 DECLARE_SOA_COLUMN(Ct, ct, float);                                                 //! Proper lifetime times c of candidate (cm)
+DECLARE_SOA_COLUMN(SamplingWeight, samplingWeight, float);                         //! Number of candidates represented by the row (downsampling)
 // Events
 DECLARE_SOA_COLUMN(IsEventReject, isEventReject, int); //! Event rejection flag
 DECLARE_SOA_COLUMN(RunNumber, runNumber, int);         //! Run number
@@ -124,7 +129,8 @@ DECLARE_SOA_TABLE(HfCandDpLites, "AOD", "HFCANDDPLITE",
                   full::Phi,
                   full::Y,
                   hf_cand_3prong::FlagMcMatchRec,
-                  hf_cand_3prong::OriginMcRec)
+                  hf_cand_3prong::OriginMcRec,
+                  full::SamplingWeight)
 
 DECLARE_SOA_TABLE(HfCandDpFulls, "AOD", "HFCANDDPFULL",
                   collision::BCId,
@@ -204,7 +210,8 @@ DECLARE_SOA_TABLE(HfCandDpFulls, "AOD", "HFCANDDPFULL",
                   full::Y,
                   full::E,
                   hf_cand_3prong::FlagMcMatchRec,
-                  hf_cand_3prong::OriginMcRec);
+                  hf_cand_3prong::OriginMcRec,
+                  full::SamplingWeight);
 
 DECLARE_SOA_TABLE(HfCandDpFullEvs, "AOD", "HFCANDDPFULLEV",
                   collision::BCId,
@@ -239,9 +246,16 @@ struct HfTreeCreatorDplusToPiKPi {
   Configurable<bool> fillOnlyBackground{"fillOnlyBackground", false, "Flag to fill derived tables with background for ML trainings"};
   Configurable<float> downSampleBkgFactor{"downSampleBkgFactor", 1., "Fraction of background candidates to keep for ML trainings"};
   Configurable<float> ptMaxForDownSample{"ptMaxForDownSample", 10., "Maximum pt for the application of the downsampling factor"};
+  Configurable<bool> applyReservoirSampling{"applyReservoirSampling", false, "Keep a fixed number of candidates per pT bin and class in each dataframe instead of applying the downsampling factor"};
+  Configurable<std::vector<double>> binsPtReservoir{"binsPtReservoir", std::vector<double>{0., 1., 2., 4., 6., 8., 12., 24.}, "pT bin limits for the reservoir sampling"};
+  Configurable<std::vector<int>> reservoirSizesBkg{"reservoirSizesBkg", std::vector<int>{100, 100, 100, 100, 100, 100, -1}, "Background (and data) candidates kept per pT bin and dataframe, negative to keep all"};
+  Configurable<std::vector<int>> reservoirSizesSig{"reservoirSizesSig", std::vector<int>{-1, -1, -1, -1, -1, -1, -1}, "Signal candidates kept per pT bin and dataframe, negative to keep all"};
+  Configurable<int> reservoirSeed{"reservoirSeed", 0, "Seed of the reservoir sampling, 0 for a random seed"};
 
   HfHelper hfHelper;
+  std::mt19937_64 generator; // reservoir sampling
 
+  using SelectedCandidates = soa::Filtered<soa::Join<aod::HfCand3Prong, aod::HfSelDplusToPiKPi>>;
   using SelectedCandidatesMc = soa::Filtered<soa::Join<aod::HfCand3Prong, aod::HfCand3ProngMcRec, aod::HfSelDplusToPiKPi>>;
   using MatchedGenCandidatesMc = soa::Filtered<soa::Join<aod::McParticles, aod::HfCand3ProngMcGen>>;
   using TracksWPid = soa::Join<aod::Tracks, aod::TracksPidPi, aod::PidTpcTofFullPi, aod::TracksPidKa, aod::PidTpcTofFullKa>;
@@ -254,6 +268,7 @@ struct HfTreeCreatorDplusToPiKPi {
 
   void init(InitContext const&)
   {
+    generator.seed(reservoirSeed.value != 0 ? static_cast<uint64_t>(reservoirSeed.value) : std::random_device{}());
   }
 
   template <typename T>
@@ -270,7 +285,7 @@ struct HfTreeCreatorDplusToPiKPi {
   }
 
   template <bool doMc = false, typename T>
-  void fillCandidateTable(const T& candidate)
+  void fillCandidateTable(const T& candidate, float weight = 1.f)
   {
     int8_t flagMc = 0;
     int8_t originMc = 0;
@@ -327,7 +342,8 @@ struct HfTreeCreatorDplusToPiKPi {
         candidate.phi(),
         hfHelper.yDplus(candidate),
         flagMc,
-        originMc);
+        originMc,
+        weight);
     } else {
       rowCandidateFull(
         candidate.collision().bcId(),
@@ -407,12 +423,13 @@ struct HfTreeCreatorDplusToPiKPi {
         hfHelper.yDplus(candidate),
         hfHelper.eDplus(candidate),
         flagMc,
-        originMc);
+        originMc,
+        weight);
     }
   }
 
   void processData(aod::Collisions const& collisions,
-                   soa::Filtered<soa::Join<aod::HfCand3Prong, aod::HfSelDplusToPiKPi>> const& candidates,
+                   SelectedCandidates const& candidates,
                    TracksWPid const&)
   {
     // Filling event properties
@@ -427,14 +444,24 @@ struct HfTreeCreatorDplusToPiKPi {
     } else {
       rowCandidateFull.reserve(candidates.size());
     }
+    if (applyReservoirSampling) {
+      o2::analysis::HfStratifiedReservoir<SelectedCandidates::iterator> reservoir(binsPtReservoir, reservoirSizesBkg, reservoirSizesSig, generator);
+      for (const auto& candidate : candidates) {
+        reservoir.offer(candidate, candidate.pt(), false);
+      }
+      reservoir.flush([&](const auto& candidate, float weight) { fillCandidateTable(candidate, weight); });
+      return;
+    }
     for (const auto& candidate : candidates) {
-      if (downSampleBkgFactor < 1.) {
+      float weight = 1.f;
+      if (downSampleBkgFactor < 1. && candidate.pt() < ptMaxForDownSample) {
         float pseudoRndm = candidate.ptProng0() * 1000. - (int64_t)(candidate.ptProng0() * 1000);
-        if (candidate.pt() < ptMaxForDownSample && pseudoRndm >= downSampleBkgFactor) {
+        if (pseudoRndm >= downSampleBkgFactor) {
           continue;
         }
+        weight = 1.f / downSampleBkgFactor;
       }
-      fillCandidateTable(candidate);
+      fillCandidateTable(candidate, weight);
     }
   }
 
@@ -453,7 +480,17 @@ struct HfTreeCreatorDplusToPiKPi {
     }
 
     // Filling candidate properties
-    if (fillOnlySignal) {
+    if (applyReservoirSampling) {
+      o2::analysis::HfStratifiedReservoir<SelectedCandidatesMc::iterator> reservoir(binsPtReservoir, reservoirSizesBkg, reservoirSizesSig, generator);
+      for (const auto& candidate : candidates) {
+        const bool isSignal = std::abs(candidate.flagMcMatchRec()) == static_cast<int8_t>(BIT(aod::hf_cand_3prong::DecayType::DplusToPiKPi));
+        if ((fillOnlySignal && !isSignal) || (fillOnlyBackground && isSignal)) {
+          continue;
+        }
+        reservoir.offer(candidate, candidate.pt(), isSignal);
+      }
+      reservoir.flush([&](const auto& candidate, float weight) { fillCandidateTable<true>(candidate, weight); });
+    } else if (fillOnlySignal) {
       if (fillCandidateLiteTable) {
         rowCandidateLite.reserve(reconstructedCandSig.size());
       } else {
@@ -469,13 +506,15 @@ struct HfTreeCreatorDplusToPiKPi {
         rowCandidateFull.reserve(reconstructedCandBkg.size());
       }
       for (const auto& candidate : reconstructedCandBkg) {
-        if (downSampleBkgFactor < 1.) {
+        float weight = 1.f;
+        if (downSampleBkgFactor < 1. && candidate.pt() < ptMaxForDownSample) {
           float pseudoRndm = candidate.ptProng0() * 1000. - (int64_t)(candidate.ptProng0() * 1000);
-          if (candidate.pt() < ptMaxForDownSample && pseudoRndm >= downSampleBkgFactor) {
+          if (pseudoRndm >= downSampleBkgFactor) {
             continue;
           }
+          weight = 1.f / downSampleBkgFactor;
         }
-        fillCandidateTable<true>(candidate);
+        fillCandidateTable<true>(candidate, weight);
       }
     } else {
       if (fillCandidateLiteTable) {
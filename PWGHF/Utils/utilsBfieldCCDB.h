@@ -16,7 +16,9 @@
 #ifndef PWGHF_UTILS_UTILSBFIELDCCDB_H_
 #define PWGHF_UTILS_UTILSBFIELDCCDB_H_
 
-#include <string> // std::string
+#include <functional> // std::function
+#include <string>     // std::string
+#include <vector>     // std::vector
 
 #include "CCDB/BasicCCDBManager.h"
 #include "DataFormatsParameters/GRPMagField.h"
@@ -57,4 +59,64 @@ void initCCDB(o2::aod::BCsWithTimestamps::iterator const& bc, int& mRunNumber,
   }
 } /// end initCCDB
 
+/// \brief Run-scoped magnetic field and material LUT, shared by all the users of a device
+/// The GRP object is read and the field of the propagator is set once per run, the LUT is read and rectified once per device.
+/// The DCA fitters registered with registerFitter get the field of each new run.
+class HfMagFieldContext
+{
+ public:
+  static HfMagFieldContext& instance()
+  {
+    static HfMagFieldContext context;
+    return context;
+  }
+
+  /// \brief Returns the material LUT, read from CCDB and rectified at the first call
+  o2::base::MatLayerCylSet* getMatLut(o2::framework::Service<o2::ccdb::BasicCCDBManager> const& ccdb, std::string const& ccdbPathLut)
+  {
+    if (mLut == nullptr) {
+      mLut = o2::base::MatLayerCylSet::rectifyPtrFromFile(ccdb->get<o2::base::MatLayerCylSet>(ccdbPathLut));
+    }
+    return mLut;
+  }
+
+  /// \brief Registers a fitter (e.g. o2::vertexing::DCAFitterN) to be updated with the field of each new run
+  /// \param fitter must live as long as the device, e.g. a task member
+  template <typename TFitter>
+  void registerFitter(TFitter& fitter)
+  {
+    mFitterUpdates.push_back([&fitter](float bz) { fitter.setBz(bz); });
+    if (mRunNumber >= 0) {
+      fitter.setBz(mBz);
+    }
+  }
+
+  /// \brief Sets the field for the run of the bc, if it changed, and updates the registered fitters
+  /// \return true if the run changed
+  bool update(o2::aod::BCsWithTimestamps::iterator const& bc, o2::framework::Service<o2::ccdb::BasicCCDBManager> const& ccdb, std::string const& ccdbPathGrp, bool isRun2)
+  {
+    if (mRunNumber == bc.runNumber()) {
+      return false;
+    }
+    initCCDB(bc, mRunNumber, ccdb, ccdbPathGrp, mLut, isRun2);
+    mBz = o2::base::Propagator::Instance()->getNominalBz();
+    LOGF(info, "Magnetic field for run %d: %f kG", mRunNumber, mBz);
+    for (const auto& updateFitter : mFitterUpdates) {
+      updateFitter(mBz);
+    }
+    return true;
+  }
+
+  float getBz() const { return mBz; }
+  int getRunNumber() const { return mRunNumber; }
+
+ private:
+  HfMagFieldContext() = default;
+
+  int mRunNumber{-1};                                    ///< run of the current field
+  float mBz{0.f};                                        ///< nominal field of the current run [kG]
+  o2::base::MatLayerCylSet* mLut{nullptr};               ///< material LUT
+  std::vector<std::function<void(float)>> mFitterUpdates; ///< field setters of the registered fitters
+};
+
 #endif // PWGHF_UTILS_UTILSBFIELDCCDB_H_
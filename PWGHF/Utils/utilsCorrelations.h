@@ -0,0 +1,197 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file utilsCorrelations.h
+/// \brief Utilities for the HF-hadron correlations aggregated per trigger candidate
+///
+/// The associated hadrons of an event are binned once in (phi, eta, pT). The pairs of a trigger candidate are then
+/// the occupied cells shifted by the (phi, eta) bin of the trigger, stored as one list of (Delta phi, Delta eta,
+/// pT hadron) cells and counts per candidate instead of one row per pair.
+/// The hadrons are binned with floor and the trigger with round, such that the pairs of a Delta bin k are spread
+/// around the centre of the bin [k w, (k + 1) w) with a triangular distribution of base 2 w.
+
+#ifndef PWGHF_UTILS_UTILSCORRELATIONS_H_
+#define PWGHF_UTILS_UTILSCORRELATIONS_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "CommonConstants/MathConstants.h"
+#include "Framework/Configurable.h"
+#include "Framework/Logger.h"
+
+namespace o2::analysis::hf_correlations
+{
+/// Binning of the pairs of a trigger candidate
+struct BinnedPairLayout {
+  int nBinsDeltaPhi = 64;           // Delta phi bins over 2 pi
+  float binWidthEta = 0.1;          // width of the eta and Delta eta bins
+  int nBinsDeltaEtaHalf = 20;       // Delta eta bins from -nBinsDeltaEtaHalf to nBinsDeltaEtaHalf
+  std::vector<double> binsPtHadron; // pT bin edges of the associated hadrons
+
+  void init(int nPhi, float etaWidth, float deltaEtaMax, std::vector<double> const& ptBins)
+  {
+    if (nPhi < 1 || etaWidth <= 0. || deltaEtaMax < 0. || ptBins.size() < 2) {
+      LOGF(fatal, "Binned correlations: %d Delta phi bins, eta bin width %g, max. Delta eta %g and %d pT bin edges, please configure properly!!", nPhi, etaWidth, deltaEtaMax, static_cast<int>(ptBins.size()));
+    }
+    nBinsDeltaPhi = nPhi;
+    binWidthEta = etaWidth;
+    nBinsDeltaEtaHalf = static_cast<int>(std::ceil(deltaEtaMax / etaWidth));
+    binsPtHadron = ptBins;
+  }
+
+  int nBinsDeltaEta() const { return 2 * nBinsDeltaEtaHalf + 1; }
+  int nBinsPtHadron() const { return static_cast<int>(binsPtHadron.size()) - 1; }
+  int size() const { return nBinsDeltaPhi * nBinsDeltaEta() * nBinsPtHadron(); }
+
+  /// \param iDeltaEta  Delta eta bin, from -nBinsDeltaEtaHalf to nBinsDeltaEtaHalf
+  int cell(int iDeltaPhi, int iDeltaEta, int iPtHadron) const { return (iDeltaPhi * nBinsDeltaEta() + iDeltaEta + nBinsDeltaEtaHalf) * nBinsPtHadron() + iPtHadron; }
+
+  /// Centre of the Delta phi bin of a cell, in [-pi/2, 3pi/2)
+  double deltaPhi(int cell) const
+  {
+    const double width = o2::constants::math::TwoPI / nBinsDeltaPhi;
+    double value = (cell / (nBinsDeltaEta() * nBinsPtHadron()) + 0.5) * width;
+    return value >= 3. * o2::constants::math::PIHalf ? value - o2::constants::math::TwoPI : value;
+  }
+  /// Centre of the Delta eta bin of a cell
+  double deltaEta(int cell) const { return ((cell / nBinsPtHadron()) % nBinsDeltaEta() - nBinsDeltaEtaHalf + 0.5) * binWidthEta; }
+  /// Centre of the hadron pT bin of a cell
+  double ptHadron(int cell) const
+  {
+    const int iPt = cell % nBinsPtHadron();
+    return 0.5 * (binsPtHadron[iPt] + binsPtHadron[iPt + 1]);
+  }
+
+  int phiBinHadron(double phi) const { return wrapPhiBin(static_cast<int>(std::floor(phi / o2::constants::math::TwoPI * nBinsDeltaPhi))); }
+  int phiBinTrigger(double phi) const { return wrapPhiBin(static_cast<int>(std::floor(phi / o2::constants::math::TwoPI * nBinsDeltaPhi + 0.5))); }
+  int etaBinHadron(double eta) const { return static_cast<int>(std::floor(eta / binWidthEta)); }
+  int etaBinTrigger(double eta) const { return static_cast<int>(std::floor(eta / binWidthEta + 0.5)); }
+  /// pT bin of a hadron, -1 outside the bins
+  int ptBinHadron(double pt) const
+  {
+    if (pt < binsPtHadron.front() || pt >= binsPtHadron.back()) {
+      return -1;
+    }
+    return std::upper_bound(binsPtHadron.begin(), binsPtHadron.end(), pt) - binsPtHadron.begin() - 1;
+  }
+
+ private:
+  int wrapPhiBin(int bin) const
+  {
+    bin %= nBinsDeltaPhi;
+    return bin < 0 ? bin + nBinsDeltaPhi : bin;
+  }
+};
+
+/// Configuration of the binned pairs, to be used with the same values in the correlator and in the task
+struct HfBinnedCorrelations : o2::framework::ConfigurableGroup {
+  std::string prefix = "binnedPairs"; // JSON group name
+  o2::framework::Configurable<int> nBinsDeltaPhi{"nBinsDeltaPhi", 64, "Number of Delta phi bins over 2 pi"};
+  o2::framework::Configurable<float> binWidthEta{"binWidthEta", 0.1, "Width of the eta and Delta eta bins"};
+  o2::framework::Configurable<float> deltaEtaMax{"deltaEtaMax", 2., "Max. |Delta eta| of the pairs"};
+  o2::framework::Configurable<std::vector<double>> binsPtHadron{"binsPtHadron", std::vector<double>{0.3, 1., 2., 3., 4., 5., 6., 7., 8., 9., 10., 100.}, "pT bin limits of the associated hadrons"};
+
+  BinnedPairLayout layout;
+
+  void init() { layout.init(nBinsDeltaPhi, binWidthEta, deltaEtaMax, binsPtHadron); }
+};
+
+/// Associated hadrons of an event, binned in (phi, eta, pT)
+class BinnedAssociatedHadrons
+{
+ public:
+  /// Empties the hadrons, to be called at the beginning of each event
+  void clear()
+  {
+    mTracks.clear();
+    mCells.clear();
+  }
+
+  /// Adds a hadron, those outside the pT bins are ignored
+  void add(BinnedPairLayout const& layout, int64_t trackId, double phi, double eta, double pt)
+  {
+    const int iPt = layout.ptBinHadron(pt);
+    if (iPt < 0) {
+      return;
+    }
+    mTracks.push_back({trackId, {layout.phiBinHadron(phi), layout.etaBinHadron(eta), iPt, 0}});
+  }
+
+  /// Groups the hadrons in cells, to be called once all the hadrons of the event are added
+  void finalize()
+  {
+    std::sort(mTracks.begin(), mTracks.end(), [](auto const& a, auto const& b) { return a.second < b.second; });
+    for (auto& track : mTracks) {
+      if (mCells.empty() || mCells.back() < track.second) {
+        mCells.push_back(track.second);
+      }
+      mCells.back().count++;
+      track.second.count = static_cast<int>(mCells.size()) - 1; // index of the cell of the track from here on
+    }
+    std::sort(mTracks.begin(), mTracks.end(), [](auto const& a, auto const& b) { return a.first < b.first; });
+  }
+
+  /// Pairs of a trigger with the hadrons of the event, as (cell, count) lists
+  /// \param excludedIds  ids of the hadrons not to be paired with the trigger, e.g. its daughters
+  void correlate(BinnedPairLayout const& layout, double phiTrigger, double etaTrigger, std::vector<int64_t> const& excludedIds,
+                 std::vector<int>& cells, std::vector<int>& counts)
+  {
+    cells.clear();
+    counts.clear();
+    mCounts.resize(mCells.size());
+    for (size_t i = 0; i < mCells.size(); i++) {
+      mCounts[i] = mCells[i].count;
+    }
+    for (const auto& id : excludedIds) {
+      auto it = std::lower_bound(mTracks.begin(), mTracks.end(), id, [](auto const& track, int64_t value) { return track.first < value; });
+      if (it != mTracks.end() && it->first == id) {
+        mCounts[it->second.count]--;
+      }
+    }
+    const int iPhiTrigger = layout.phiBinTrigger(phiTrigger);
+    const int iEtaTrigger = layout.etaBinTrigger(etaTrigger);
+    for (size_t i = 0; i < mCells.size(); i++) {
+      const int iDeltaEta = mCells[i].eta - iEtaTrigger;
+      if (mCounts[i] == 0 || std::abs(iDeltaEta) > layout.nBinsDeltaEtaHalf) {
+        continue;
+      }
+      int iDeltaPhi = mCells[i].phi - iPhiTrigger;
+      if (iDeltaPhi < 0) {
+        iDeltaPhi += layout.nBinsDeltaPhi;
+      }
+      cells.push_back(layout.cell(iDeltaPhi, iDeltaEta, mCells[i].pt));
+      counts.push_back(mCounts[i]);
+    }
+  }
+
+  bool empty() const { return mTracks.empty(); }
+
+ private:
+  struct Cell {
+    int phi, eta, pt;
+    int count; // number of hadrons, or index of the cell in the track list
+    bool operator<(Cell const& other) const { return std::tie(phi, eta, pt) < std::tie(other.phi, other.eta, other.pt); }
+  };
+
+  std::vector<std::pair<int64_t, Cell>> mTracks; // hadrons with their cell
+  std::vector<Cell> mCells;                      // occupied cells
+  std::vector<int> mCounts;                      // counts of the current trigger
+};
+
+} // namespace o2::analysis::hf_correlations
+
+#endif // PWGHF_UTILS_UTILSCORRELATIONS_H_
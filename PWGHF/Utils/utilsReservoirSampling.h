@@ -0,0 +1,115 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file utilsReservoirSampling.h
+/// \brief Stratified reservoir sampling of the candidates written by the HF tree creators
+
+#ifndef PWGHF_UTILS_UTILSRESERVOIRSAMPLING_H_
+#define PWGHF_UTILS_UTILSRESERVOIRSAMPLING_H_
+
+#include <algorithm> // std::upper_bound
+#include <cstdint>
+#include <iterator> // std::distance
+#include <random>
+#include <vector>
+
+#include "Framework/Logger.h"
+
+namespace o2::analysis
+{
+/// Stratified reservoir sampling of the candidates of a dataframe
+/// The candidates are split in strata (pT bin, background/signal) and a uniform random sample of at most a fixed
+/// number of candidates is kept per stratum (algorithm R), whatever the number of candidates offered.
+/// Each kept candidate is given the weight nOffered / nKept of its stratum, such that the weighted sample preserves
+/// the normalisation. The candidates outside of the pT binning and those of the strata with a negative size are
+/// all kept, with weight 1.
+/// \tparam T  candidate type, e.g. the iterator of the candidate table
+template <typename T>
+class HfStratifiedReservoir
+{
+ public:
+  /// \param binsPt  pT bin limits
+  /// \param sizesBkg  maximum number of background candidates kept per pT bin, negative to keep all
+  /// \param sizesSig  maximum number of signal candidates kept per pT bin, negative to keep all
+  /// \param generator  random generator, shared across the dataframes
+  HfStratifiedReservoir(std::vector<double> const& binsPt, std::vector<int> const& sizesBkg, std::vector<int> const& sizesSig, std::mt19937_64& generator)
+    : mBinsPt(binsPt), mGenerator(generator)
+  {
+    const auto nBinsPt = binsPt.size() < 2 ? 0 : binsPt.size() - 1;
+    if (sizesBkg.size() != nBinsPt || sizesSig.size() != nBinsPt) {
+      LOGF(fatal, "Reservoir sampling with %d pT bins and %d (background) / %d (signal) reservoir sizes, please configure properly!!", static_cast<int>(nBinsPt), static_cast<int>(sizesBkg.size()), static_cast<int>(sizesSig.size()));
+    }
+    mStrata.resize(2 * nBinsPt + 1);
+    for (auto iBin = 0u; iBin < nBinsPt; ++iBin) {
+      mStrata[2 * iBin].size = sizesBkg[iBin];
+      mStrata[2 * iBin + 1].size = sizesSig[iBin];
+    }
+  }
+
+  /// Offers a candidate to the reservoir of its stratum
+  /// \param candidate  candidate
+  /// \param pt  transverse momentum of the candidate
+  /// \param isSignal  true for the signal candidates (MC), false otherwise
+  void offer(T const& candidate, double pt, bool isSignal)
+  {
+    Stratum& stratum = mStrata[stratumIndex(pt, isSignal)];
+    ++stratum.nOffered;
+    if (stratum.size < 0 || stratum.kept.size() < static_cast<std::size_t>(stratum.size)) {
+      stratum.kept.push_back(candidate);
+      return;
+    }
+    std::uniform_int_distribution<uint64_t> distribution(0, stratum.nOffered - 1);
+    const auto index = distribution(mGenerator);
+    if (index < static_cast<uint64_t>(stratum.size)) {
+      stratum.kept[index] = candidate;
+    }
+  }
+
+  /// Hands the kept candidates to fill(candidate, weight), stratum by stratum, and empties the reservoirs
+  template <typename TFill>
+  void flush(TFill const& fill)
+  {
+    for (auto& stratum : mStrata) {
+      if (!stratum.kept.empty()) {
+        const float weight = static_cast<float>(stratum.nOffered) / stratum.kept.size();
+        for (const auto& candidate : stratum.kept) {
+          fill(candidate, weight);
+        }
+      }
+      stratum.kept.clear();
+      stratum.nOffered = 0;
+    }
+  }
+
+ private:
+  struct Stratum {
+    int size = -1;         // maximum number of kept candidates, negative to keep all
+    uint64_t nOffered = 0; // candidates offered
+    std::vector<T> kept;   // reservoir
+  };
+
+  /// Index of the stratum of a candidate, the last one for the candidates outside of the pT binning
+  std::size_t stratumIndex(double pt, bool isSignal) const
+  {
+    if (mBinsPt.size() < 2 || pt < mBinsPt.front() || pt >= mBinsPt.back()) {
+      return mStrata.size() - 1;
+    }
+    const auto binPt = std::distance(mBinsPt.begin(), std::upper_bound(mBinsPt.begin(), mBinsPt.end(), pt)) - 1;
+    return 2 * binPt + (isSignal ? 1 : 0);
+  }
+
+  std::vector<double> mBinsPt;  // pT bin limits
+  std::vector<Stratum> mStrata; // (pT bin, background/signal), then the candidates outside of the binning
+  std::mt19937_64& mGenerator;  // random generator
+};
+} // namespace o2::analysis
+
+#endif // PWGHF_UTILS_UTILSRESERVOIRSAMPLING_H_
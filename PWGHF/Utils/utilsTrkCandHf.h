@@ -16,7 +16,11 @@
 #ifndef PWGHF_UTILS_UTILSTRKCANDHF_H_
 #define PWGHF_UTILS_UTILSTRKCANDHF_H_
 
+#include <algorithm>
+#include <array>
+
 #include "Framework/HistogramSpec.h"
+#include "ReconstructionDataFormats/Track.h"
 
 namespace o2::hf_trkcandsel
 {
@@ -41,6 +45,34 @@ void setLabelHistoCands(Histo& hCandidates)
   hCandidates->GetXaxis()->SetBinLabel(SVFitting::Fail + 1, "Run-time error in secondary vertexing");
 }
 
+/// Writes a track in the columns of the secondary-vertex fit tables
+/// \param trackParCov is the track
+/// \param par is the array of the X, alpha and the track parameters
+/// \param covMat is the array of the covariance matrix
+inline void fillSvFitTrackColumns(o2::track::TrackParCov const& trackParCov, float* par, float* covMat)
+{
+  par[0] = trackParCov.getX();
+  par[1] = trackParCov.getAlpha();
+  for (int iPar = 0; iPar < o2::track::kNParams; iPar++) {
+    par[iPar + 2] = trackParCov.getParam(iPar);
+  }
+  for (int iCov = 0; iCov < o2::track::kCovMatSize; iCov++) {
+    covMat[iCov] = trackParCov.getCov()[iCov];
+  }
+}
+
+/// Reads a track from the columns of the secondary-vertex fit tables
+/// \param par is the array of the X, alpha and the track parameters
+/// \param covMat is the array of the covariance matrix
+inline o2::track::TrackParCov getSvFitTrack(float const* par, float const* covMat)
+{
+  std::array<float, o2::track::kNParams> arrayPar;
+  std::array<float, o2::track::kCovMatSize> arrayCovMat;
+  std::copy(par + 2, par + 2 + o2::track::kNParams, arrayPar.begin());
+  std::copy(covMat, covMat + o2::track::kCovMatSize, arrayCovMat.begin());
+  return o2::track::TrackParCov(par[0], par[1], arrayPar, arrayCovMat);
+}
+
 } // namespace o2::hf_trkcandsel
 
 #endif // PWGHF_UTILS_UTILSTRKCANDHF_H_
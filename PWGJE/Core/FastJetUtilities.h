@@ -93,6 +93,53 @@ void fillTracks(const T& constituent, std::vector<fastjet::PseudoJet>& constitue
   setFastJetUserInfo(constituents, index, status);
 }
 
+/**
+ * Add track as a pseudojet object to the fastjet vector, without user info
+ *
+ * The four-vector is built from the pt, eta and phi columns and the track index is encoded in the user index as index + 1,
+ * as in setFastJetUserInfo, which avoids the allocation of a user info object per track.
+ *
+ * @param constituent constituent to be added
+ * @param constituents vector of constituents
+ * @param index global index of constituent
+ * @param mass mass hypothesis for constituent
+ */
+
+template <typename T>
+void fillTrackUserIndex(const T& constituent, std::vector<fastjet::PseudoJet>& constituents, int index, float mass = mPion)
+{
+  float pt = constituent.pt();
+  float phi = constituent.phi();
+  float pz = pt * std::sinh(constituent.eta());
+  float energy = std::sqrt((pt * pt) + (pz * pz) + (mass * mass));
+  constituents.emplace_back(pt * std::cos(phi), pt * std::sin(phi), pz, energy);
+  constituents.back().set_user_index(index + 1);
+}
+
+/**
+ * Get the status and the index of a constituent, from its user info or, for tracks filled with fillTrackUserIndex, from its user index
+ *
+ * @param constituent jet constituent
+ * @param status status of constituent type
+ * @param index global index of constituent
+ * @return false if the constituent has neither, e.g. explicit ghosts
+ */
+
+inline bool getConstituentStatusAndIndex(const fastjet::PseudoJet& constituent, int& status, int& index)
+{
+  if (constituent.has_user_info()) {
+    status = constituent.user_info<fastjet_user_info>().getStatus();
+    index = constituent.user_info<fastjet_user_info>().getIndex();
+    return true;
+  }
+  if (constituent.user_index() > 0) {
+    status = static_cast<int>(JetConstituentStatus::track);
+    index = constituent.user_index() - 1;
+    return true;
+  }
+  return false;
+}
+
 /**
  * Add cluster as a pseudojet object to the fastjet vector
  *
@@ -12,6 +12,8 @@
 // jet finder task
 //
 // Author: Hadi Hassan, Universiy of Jväskylä, hadi.hassan@cern.ch
+#include <algorithm>
+#include <cmath>
 #include <memory>
 #include <tuple>
 #include "Framework/Logger.h"
@@ -51,7 +53,25 @@ std::tuple<double, double> JetBkgSubUtils::estimateRhoAreaMedian(const std::vect
 
   // cluster the kT jets
   fastjet::ClusterSequenceArea clusterSeq(inputParticles, jetDefBkg, areaDefBkg);
+  return computeRhoAreaMedian(clusterSeq, doSparseSub);
+}
+
+std::tuple<double, double> JetBkgSubUtils::estimateRhoAreaMedian(const std::vector<fastjet::PseudoJet>& inputParticles, bool doSparseSub, JetGhostCache& ghostCache, uint64_t eventKey)
+{
+  JetBkgSubUtils::initialise();
+
+  if (inputParticles.size() == 0) {
+    return std::make_tuple(0.0, 0.0);
+  }
+
+  // cluster the kT jets with the ghosts of the event
+  const std::vector<fastjet::PseudoJet>& ghosts = ghostCache.getGhosts(eventKey);
+  fastjet::ClusterSequenceActiveAreaExplicitGhosts clusterSeq(inputParticles, jetDefBkg, ghosts, ghostCache.getGhostArea());
+  return computeRhoAreaMedian(clusterSeq, doSparseSub);
+}
 
+std::tuple<double, double> JetBkgSubUtils::computeRhoAreaMedian(const fastjet::ClusterSequenceAreaBase& clusterSeq, bool doSparseSub)
+{
   // select jets in detector acceptance
   std::vector<fastjet::PseudoJet> alljets = selRho(clusterSeq.inclusive_jets());
 
@@ -91,6 +111,61 @@ std::tuple<double, double> JetBkgSubUtils::estimateRhoAreaMedian(const std::vect
   return std::make_tuple(rho, rhoM);
 }
 
+std::tuple<double, double> JetBkgSubUtils::estimateRhoGridMedian(const std::vector<fastjet::PseudoJet>& inputParticles, bool doSparseSub)
+{
+  if (inputParticles.size() == 0) {
+    return std::make_tuple(0.0, 0.0);
+  }
+
+  // cells of about gridSpacing x gridSpacing covering the background acceptance
+  int nCellsEta = std::max(1, static_cast<int>(std::round((bkgEtaMax - bkgEtaMin) / gridSpacing)));
+  int nCellsPhi = std::max(1, static_cast<int>(std::round((bkgPhiMax - bkgPhiMin) / gridSpacing)));
+  double cellEta = (bkgEtaMax - bkgEtaMin) / nCellsEta;
+  double cellPhi = (bkgPhiMax - bkgPhiMin) / nCellsPhi;
+  int nCells = nCellsEta * nCellsPhi;
+  gridPt.assign(nCells, 0.0);
+  gridMd.assign(nCells, 0.0);
+
+  for (const auto& particle : inputParticles) {
+    int iEta = static_cast<int>(std::floor((particle.eta() - bkgEtaMin) / cellEta));
+    int iPhi = static_cast<int>(std::floor((particle.phi() - bkgPhiMin) / cellPhi));
+    if (iEta < 0 || iEta >= nCellsEta || iPhi < 0 || iPhi >= nCellsPhi) {
+      continue;
+    }
+    gridPt[iEta * nCellsPhi + iPhi] += particle.pt();
+    gridMd[iEta * nCellsPhi + iPhi] += TMath::Sqrt(particle.m() * particle.m() + particle.pt() * particle.pt()) - particle.pt();
+  }
+
+  int nCellsUsed = nCells;
+  if (doSparseSub) {
+    // only the occupied cells enter the median
+    nCellsUsed = 0;
+    for (int iCell = 0; iCell < nCells; iCell++) {
+      if (gridPt[iCell] > 0.0) {
+        gridPt[nCellsUsed] = gridPt[iCell];
+        gridMd[nCellsUsed] = gridMd[iCell];
+        nCellsUsed++;
+      }
+    }
+    if (nCellsUsed == 0) {
+      return std::make_tuple(0.0, 0.0);
+    }
+  }
+
+  double cellArea = cellEta * cellPhi;
+  double rho = TMath::Median<double>(nCellsUsed, gridPt.data()) / cellArea;
+  double rhoM = TMath::Median<double>(nCellsUsed, gridMd.data()) / cellArea;
+
+  if (doSparseSub) {
+    // the occupancy factor is the fraction of occupied cells
+    double occupancyFactor = static_cast<double>(nCellsUsed) / nCells;
+    rho *= occupancyFactor;
+    rhoM *= occupancyFactor;
+  }
+
+  return std::make_tuple(rho, rhoM);
+}
+
 std::tuple<double, double> JetBkgSubUtils::estimateRhoPerpCone(const std::vector<fastjet::PseudoJet>& inputParticles, const std::vector<fastjet::PseudoJet>& jets)
 {
 
@@ -176,6 +251,86 @@ std::vector<fastjet::PseudoJet> JetBkgSubUtils::doEventConstSub(std::vector<fast
   return constituentSub.subtract_event(inputParticles, maxEtaEvent);
 }
 
+std::vector<fastjet::PseudoJet> JetBkgSubUtils::doEventConstSubLocal(std::vector<fastjet::PseudoJet>& inputParticles, double rhoParam, double rhoMParam)
+{
+  // uniform ghost grid in |y| < maxEtaEvent, with the same placement as ConstituentSubtractor::subtract_event
+  double ghostSide = std::sqrt(ghostAreaSpec.ghost_area());
+  int nGhostsY = std::max(1, static_cast<int>(2.0 * maxEtaEvent / ghostSide + 0.5));
+  int nGhostsPhi = std::max(1, static_cast<int>(2.0 * M_PI / ghostSide + 0.5));
+  double ghostSizeY = 2.0 * maxEtaEvent / nGhostsY;
+  double ghostSizePhi = 2.0 * M_PI / nGhostsPhi;
+  double ghostAreaGrid = ghostSizeY * ghostSizePhi;
+  constSubGhostPt.assign(nGhostsY * nGhostsPhi, rhoParam * ghostAreaGrid);
+  constSubGhostMd.assign(nGhostsY * nGhostsPhi, doRhoMassSub ? rhoMParam * ghostAreaGrid : 0.0);
+
+  // pairs within constSubRMax, the ghost cells are enumerated from the grid around each particle
+  int nCellsPhiHalf = static_cast<int>(std::ceil(constSubRMax / ghostSizePhi));
+  bool allCellsPhi = 2 * nCellsPhiHalf + 1 >= nGhostsPhi;
+  constSubPairs.clear();
+  constSubParticlePt.assign(inputParticles.size(), 0.0);
+  constSubParticleMd.assign(inputParticles.size(), 0.0);
+  for (std::size_t iParticle = 0; iParticle < inputParticles.size(); iParticle++) {
+    const auto& particle = inputParticles[iParticle];
+    double y = particle.rap();
+    double phi = particle.phi();
+    if (std::abs(y) > maxEtaEvent) {
+      continue; // as in subtract_event, the particles outside of the ghost acceptance are not kept
+    }
+    constSubParticlePt[iParticle] = particle.pt();
+    constSubParticleMd[iParticle] = doRhoMassSub ? TMath::Sqrt(particle.m() * particle.m() + particle.pt() * particle.pt()) - particle.pt() : 0.0;
+    double distanceWeight = constSubAlpha != 0 ? std::pow(particle.pt(), constSubAlpha) : 1.0;
+    int iYMin = std::max(0, static_cast<int>(std::floor((y - constSubRMax + maxEtaEvent) / ghostSizeY)));
+    int iYMax = std::min(nGhostsY - 1, static_cast<int>(std::floor((y + constSubRMax + maxEtaEvent) / ghostSizeY)));
+    int iPhiCentre = static_cast<int>(std::floor(phi / ghostSizePhi));
+    int iPhiMin = allCellsPhi ? 0 : iPhiCentre - nCellsPhiHalf;
+    int iPhiMax = allCellsPhi ? nGhostsPhi - 1 : iPhiCentre + nCellsPhiHalf;
+    for (int iY = iYMin; iY <= iYMax; iY++) {
+      double deltaY = y - (-maxEtaEvent + (iY + 0.5) * ghostSizeY);
+      for (int iPhiUnwrapped = iPhiMin; iPhiUnwrapped <= iPhiMax; iPhiUnwrapped++) {
+        int iPhi = ((iPhiUnwrapped % nGhostsPhi) + nGhostsPhi) % nGhostsPhi;
+        double deltaPhi = std::abs(phi - (iPhi + 0.5) * ghostSizePhi);
+        if (deltaPhi > M_PI) {
+          deltaPhi = 2.0 * M_PI - deltaPhi;
+        }
+        double deltaR = std::sqrt(deltaY * deltaY + deltaPhi * deltaPhi);
+        if (deltaR <= constSubRMax) {
+          constSubPairs.emplace_back(distanceWeight * deltaR, iParticle, iY * nGhostsPhi + iPhi);
+        }
+      }
+    }
+  }
+
+  // the pairs are processed in increasing distance, the ties being ordered by particle and ghost
+  std::sort(constSubPairs.begin(), constSubPairs.end());
+  for (const auto& [distance, iParticle, iGhost] : constSubPairs) {
+    double subtractedPt = std::min(constSubParticlePt[iParticle], constSubGhostPt[iGhost]);
+    constSubParticlePt[iParticle] -= subtractedPt;
+    constSubGhostPt[iGhost] -= subtractedPt;
+    if (doRhoMassSub) {
+      double subtractedMd = std::min(constSubParticleMd[iParticle], constSubGhostMd[iGhost]);
+      constSubParticleMd[iParticle] -= subtractedMd;
+      constSubGhostMd[iGhost] -= subtractedMd;
+    }
+  }
+
+  // by default, the masses of all particles are set to zero. With the mass subtraction the remaining mass term is kept
+  std::vector<fastjet::PseudoJet> subtractedParticles;
+  for (std::size_t iParticle = 0; iParticle < inputParticles.size(); iParticle++) {
+    double pt = constSubParticlePt[iParticle];
+    if (pt <= 0.0) {
+      continue;
+    }
+    const auto& particle = inputParticles[iParticle];
+    double mt = constSubParticleMd[iParticle] + pt;
+    fastjet::PseudoJet subtractedParticle;
+    subtractedParticle.reset_PtYPhiM(pt, particle.rap(), particle.phi(), doRhoMassSub ? std::sqrt(std::max(mt * mt - pt * pt, 0.0)) : 0.0);
+    subtractedParticle.set_user_index(particle.user_index());
+    subtractedParticle.set_user_info_shared_ptr(particle.user_info_shared_ptr());
+    subtractedParticles.push_back(subtractedParticle);
+  }
+  return subtractedParticles;
+}
+
 std::vector<fastjet::PseudoJet> JetBkgSubUtils::doJetConstSub(std::vector<fastjet::PseudoJet>& jets, double rhoParam, double rhoMParam)
 {
   JetBkgSubUtils::initialise();
@@ -24,9 +24,11 @@
 #include <TMath.h>
 
 #include "PWGJE/Core/FastJetUtilities.h"
+#include "PWGJE/Core/JetGhostCache.h"
 
 #include "fastjet/PseudoJet.hh"
 #include "fastjet/ClusterSequenceArea.hh"
+#include "fastjet/ClusterSequenceActiveAreaExplicitGhosts.hh"
 #include "fastjet/AreaDefinition.hh"
 #include "fastjet/JetDefinition.hh"
 #include "fastjet/tools/JetMedianBackgroundEstimator.hh"
@@ -75,6 +77,20 @@ class JetBkgSubUtils
   /// @return Rho, RhoM the underlying event density
   std::tuple<double, double> estimateRhoAreaMedian(const std::vector<fastjet::PseudoJet>& inputParticles, bool doSparseSub);
 
+  /// @brief Method for estimating the jet background density using the median method or the sparse method, with cached ghosts
+  /// @param inputParticles (all particles in the event)
+  /// @param doSparseSub weather to do rho sparse subtraction
+  /// @param ghostCache ghosts of the event, shared with the other clusterings of the event
+  /// @param eventKey unique key of the event, e.g. the collision index
+  /// @return Rho, RhoM the underlying event density
+  std::tuple<double, double> estimateRhoAreaMedian(const std::vector<fastjet::PseudoJet>& inputParticles, bool doSparseSub, JetGhostCache& ghostCache, uint64_t eventKey);
+
+  /// @brief Method for estimating the jet background density as the median over a rectangular eta-phi grid, without clustering
+  /// @param inputParticles (all particles in the event)
+  /// @param doSparseSub weather to do rho sparse subtraction, the median is then taken over the occupied cells and scaled by their fraction
+  /// @return Rho, RhoM the underlying event density
+  std::tuple<double, double> estimateRhoGridMedian(const std::vector<fastjet::PseudoJet>& inputParticles, bool doSparseSub);
+
   /// @brief Background estimator using the perpendicular cone method
   /// @param inputParticles
   /// @param jets (all jets in the event)
@@ -95,6 +111,14 @@ class JetBkgSubUtils
   /// @return inputParticles, a vector of background subtracted input particles
   std::vector<fastjet::PseudoJet> doEventConstSub(std::vector<fastjet::PseudoJet>& inputParticles, double rhoParam, double rhoMParam);
 
+  /// @brief method that subtracts the background from the input particles using the event-wise cosntituent subtraction, with the particle-ghost pairs taken from a grid
+  /// @note the ghosts are placed as in the fastjet contrib, but each particle is only paired with the ghosts of the cells within constSubRMax instead of all the ghosts of the event
+  /// @param inputParticles (all the tracks/clusters/particles in the event)
+  /// @param rhoParam the underlying evvent density vs pT (to be set)
+  /// @param rhoParam the underlying evvent density vs jet mass (to be set)
+  /// @return inputParticles, a vector of background subtracted input particles
+  std::vector<fastjet::PseudoJet> doEventConstSubLocal(std::vector<fastjet::PseudoJet>& inputParticles, double rhoParam, double rhoMParam);
+
   /// @brief method that subtracts the background from jets using the jet-wise constituent subtractor
   /// @param jets (all jets in the event)
   /// @param rhoParam the underlying evvent density vs pT (to be set)
@@ -120,6 +144,7 @@ class JetBkgSubUtils
     constSubRMax = rmax_out;
   }
   void setMaxEtaEvent(float etaMaxEvent) { maxEtaEvent = etaMaxEvent; }
+  void setGridSpacing(float gridSpacing_out) { gridSpacing = gridSpacing_out; }
   void setDoRhoMassSub(bool doMSub_out = true) { doRhoMassSub = doMSub_out; }
   void setGhostAreaSpec(fastjet::GhostedAreaSpec ghostAreaSpec_out) { ghostAreaSpec = ghostAreaSpec_out; }
   void setJetDefinition(fastjet::JetDefinition jetdefbkg_out) { jetDefBkg = jetdefbkg_out; }
@@ -133,6 +158,7 @@ class JetBkgSubUtils
   float getEtaMin() const { return bkgEtaMin; }
   float getEtaMax() const { return bkgEtaMax; }
   float getEtaMaxEvent() const { return maxEtaEvent; }
+  float getGridSpacing() const { return gridSpacing; }
   float getConstSubAlpha() const { return constSubAlpha; }
   float getConstSubRMax() const { return constSubRMax; }
   float getDoRhoMassSub() const { return doRhoMassSub; }
@@ -145,6 +171,9 @@ class JetBkgSubUtils
   double getMd(fastjet::PseudoJet jet) const;
 
  protected:
+  /// @brief Median of the pT and mass densities of the kT jets
+  std::tuple<double, double> computeRhoAreaMedian(const fastjet::ClusterSequenceAreaBase& clusterSeq, bool doSparseSub);
+
   float jetBkgR = 0.2;
   float bkgEtaMin = -0.9;
   float bkgEtaMax = 0.9;
@@ -154,6 +183,7 @@ class JetBkgSubUtils
   float constSubRMax = 0.24;
   float maxEtaEvent = 0.9;
   int nHardReject = 2;
+  float gridSpacing = 0.2; /// requested eta-phi cell size of the grid median estimation
   bool doRhoMassSub = false; /// flag whether to do jet mass subtraction with the const sub
 
   fastjet::GhostedAreaSpec ghostAreaSpec = fastjet::GhostedAreaSpec();
@@ -163,6 +193,15 @@ class JetBkgSubUtils
   fastjet::AreaDefinition areaDefBkg = fastjet::AreaDefinition(fastjet::active_area_explicit_ghosts, ghostAreaSpec);
   fastjet::Selector selRho = fastjet::Selector();
 
+  std::vector<double> gridPt; //! pT per grid cell
+  std::vector<double> gridMd; //! mass term per grid cell
+
+  std::vector<std::tuple<double, int, int>> constSubPairs; //! distance, particle and ghost of the particle-ghost pairs
+  std::vector<double> constSubGhostPt;                     //! remaining pT of the ghosts
+  std::vector<double> constSubGhostMd;                     //! remaining mass term of the ghosts
+  std::vector<double> constSubParticlePt;                  //! remaining pT of the particles
+  std::vector<double> constSubParticleMd;                  //! remaining mass term of the particles
+
 }; // class JetBkgSubUtils
 
 #endif // PWGJE_CORE_JETBKGSUBUTILS_H_
@@ -63,6 +63,20 @@ int initialiseEventSelection(std::string eventSelection)
   return -1;
 }
 
+// Bit mask of an event selection in the eventSel column, 0 for no selection
+// With the mask computed once in init, the selection of a collision is a single test on the precomputed column.
+uint8_t initialiseEventSelectionBits(std::string eventSelection)
+{
+  const int bit = initialiseEventSelection(eventSelection);
+  return bit == -1 ? 0 : static_cast<uint8_t>(1 << bit);
+}
+
+template <typename T>
+bool selectCollisionBits(T const& collision, uint8_t eventSelectionBits)
+{
+  return (collision.eventSel() & eventSelectionBits) == eventSelectionBits;
+}
+
 template <typename T>
 uint8_t setEventSelectionBit(T const& collision)
 {
@@ -348,6 +362,19 @@ int initialiseTrackSelection(std::string trackSelection)
   return -1;
 }
 
+// Bit mask of a track selection in the trackSel column, 0 for no selection
+uint8_t initialiseTrackSelectionBits(std::string trackSelection)
+{
+  const int bit = initialiseTrackSelection(trackSelection);
+  return bit == -1 ? 0 : static_cast<uint8_t>(1 << bit);
+}
+
+template <typename T>
+bool selectTrackBits(T const& track, uint8_t trackSelectionBits)
+{
+  return (track.trackSel() & trackSelectionBits) == trackSelectionBits;
+}
+
 template <typename T>
 uint8_t setTrackSelectionBit(T const& track)
 {
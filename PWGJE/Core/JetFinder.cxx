@@ -60,3 +60,51 @@ fastjet::ClusterSequenceArea JetFinder::findJets(std::vector<fastjet::PseudoJet>
   }
   return clusterSeq;
 }
+
+/// Generates the explicit ghosts of the event, to be shared by all the jet radii
+/// \param eventKey unique key of the event seeding the ghosts, the ghosts are only generated once per key
+void JetFinder::generateGhosts(uint64_t eventKey)
+{
+  ghostCache.setParams(ghostEtaMax, ghostArea, gridScatter, ktScatter, ghostktMean);
+  ghostCache.getGhosts(eventKey);
+}
+
+/// Performs jet finding with the ghosts from generateGhosts()
+/// \note the pure ghost jets are removed, but the jet constituents include the ghosts
+/// \param inputParticles vector of input particles/tracks
+/// \param jets vector of jets to be filled
+/// \return ClusterSequenceActiveAreaExplicitGhosts object needed to access constituents
+fastjet::ClusterSequenceActiveAreaExplicitGhosts JetFinder::findJetsExplicitGhosts(std::vector<fastjet::PseudoJet>& inputParticles, std::vector<fastjet::PseudoJet>& jets)
+{
+  setParams();
+  jets.clear();
+  fastjet::ClusterSequenceActiveAreaExplicitGhosts clusterSeq(inputParticles, jetDef, ghostCache.getGhosts(), ghostCache.getGhostArea());
+  jets = clusterSeq.inclusive_jets();
+  jets = (selJets && !fastjet::SelectorIsPureGhost())(jets);
+  jets = fastjet::sorted_by_pt(jets);
+  if (isReclustering) {
+    jetR = jetR / 5.0;
+  }
+  return clusterSeq;
+}
+
+/// Derives the C/A jets of radius jetR from a C/A clustering with a radius larger or equal to jetR
+/// \note the C/A merging is ordered in angle only, such that the jets of radius jetR are the exclusive jets at dcut = (jetR/R)^2
+/// \param clusterSeq C/A cluster sequence with the largest radius
+/// \param jets vector of jets to be filled
+void JetFinder::findNestedJets(const fastjet::ClusterSequence& clusterSeq, std::vector<fastjet::PseudoJet>& jets)
+{
+  setParams();
+  jets.clear();
+  double clusteringR = clusterSeq.jet_def().R();
+  if (jetR < clusteringR) {
+    jets = clusterSeq.exclusive_jets((jetR * jetR) / (clusteringR * clusteringR));
+  } else {
+    jets = clusterSeq.inclusive_jets();
+  }
+  jets = (selJets && !fastjet::SelectorIsPureGhost())(jets);
+  jets = fastjet::sorted_by_pt(jets);
+  if (isReclustering) {
+    jetR = jetR / 5.0;
+  }
+}
@@ -27,10 +27,14 @@
 
 #include "fastjet/PseudoJet.hh"
 #include "fastjet/ClusterSequenceArea.hh"
+#include "fastjet/ClusterSequenceActiveAreaExplicitGhosts.hh"
 #include "fastjet/AreaDefinition.hh"
 #include "fastjet/JetDefinition.hh"
+#include "fastjet/Selector.hh"
 #include "fastjet/tools/Subtractor.hh"
 
+#include "PWGJE/Core/JetGhostCache.h"
+
 enum class JetType {
   full = 0,
   charged = 1,
@@ -72,6 +76,9 @@ class JetFinder
 
   bool isReclustering = false;
   bool isTriggering = false;
+  bool reuseGhosts = false; // multi-R mode: the ghosts are generated once per event and shared by all the jet radii
+
+  JetGhostCache ghostCache; //! explicit ghosts of the current event
 
   fastjet::JetAlgorithm algorithm = fastjet::antikt_algorithm;
   fastjet::RecombinationScheme recombScheme = fastjet::E_scheme;
@@ -93,8 +100,25 @@ class JetFinder
   /// \return ClusterSequenceArea object needed to access constituents
   fastjet::ClusterSequenceArea findJets(std::vector<fastjet::PseudoJet>& inputParticles, std::vector<fastjet::PseudoJet>& jets); // ideally find a way of passing the cluster sequence as a reeference
 
+  /// Generates the explicit ghosts of the event, to be shared by all the jet radii
+  /// \param eventKey unique key of the event seeding the ghosts, the ghosts are only generated once per key
+  void generateGhosts(uint64_t eventKey);
+
+  /// Performs jet finding with the ghosts from generateGhosts()
+  /// \note the pure ghost jets are removed, but the jet constituents include the ghosts
+  /// \param inputParticles vector of input particles/tracks
+  /// \param jets vector of jets to be filled
+  /// \return ClusterSequenceActiveAreaExplicitGhosts object needed to access constituents
+  fastjet::ClusterSequenceActiveAreaExplicitGhosts findJetsExplicitGhosts(std::vector<fastjet::PseudoJet>& inputParticles, std::vector<fastjet::PseudoJet>& jets);
+
+  /// Derives the C/A jets of radius jetR from a C/A clustering with a radius larger or equal to jetR
+  /// \note the C/A merging is ordered in angle only, such that the jets of radius jetR are the exclusive jets at dcut = (jetR/R)^2
+  /// \param clusterSeq C/A cluster sequence with the largest radius
+  /// \param jets vector of jets to be filled
+  void findNestedJets(const fastjet::ClusterSequence& clusterSeq, std::vector<fastjet::PseudoJet>& jets);
+
  private:
-  ClassDefNV(JetFinder, 1);
+  ClassDefNV(JetFinder, 2);
 };
 
 #endif // PWGJE_CORE_JETFINDER_H_
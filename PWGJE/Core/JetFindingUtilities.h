@@ -17,7 +17,10 @@
 #ifndef PWGJE_CORE_JETFINDINGUTILITIES_H_
 #define PWGJE_CORE_JETFINDINGUTILITIES_H_
 
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <thread>
 #include <vector>
 #include <string>
 #include <optional>
@@ -75,11 +78,13 @@ constexpr bool isEMCALTable()
  * @param tracks track table to be added
  * @param trackSelection track selection to be applied to tracks
  * @param candidate optional HF candidiate
+ * @param fillUserInfo attach a user info object to each track, otherwise the track index is only encoded in the user index
  */
 
 template <typename T, typename U>
-void analyseTracks(std::vector<fastjet::PseudoJet>& inputParticles, T const& tracks, int trackSelection, std::optional<U> const& candidate = std::nullopt)
+void analyseTracks(std::vector<fastjet::PseudoJet>& inputParticles, T const& tracks, int trackSelection, std::optional<U> const& candidate = std::nullopt, bool fillUserInfo = true)
 {
+  inputParticles.reserve(inputParticles.size() + tracks.size());
   for (auto& track : tracks) {
     if (!jetderiveddatautilities::selectTrack(track, trackSelection)) {
       continue;
@@ -90,7 +95,11 @@ void analyseTracks(std::vector<fastjet::PseudoJet>& inputParticles, T const& tra
         continue;
       }
     }
-    fastjetutilities::fillTracks(track, inputParticles, track.globalIndex());
+    if (fillUserInfo) {
+      fastjetutilities::fillTracks(track, inputParticles, track.globalIndex());
+    } else {
+      fastjetutilities::fillTrackUserIndex(track, inputParticles, track.globalIndex());
+    }
   }
 }
 
@@ -101,11 +110,13 @@ void analyseTracks(std::vector<fastjet::PseudoJet>& inputParticles, T const& tra
  * @param tracks track table to be added
  * @param trackSelection track selection to be applied to tracks
  * @param candidates candidiates
+ * @param fillUserInfo attach a user info object to each track, otherwise the track index is only encoded in the user index
  */
 
 template <typename T, typename U>
-void analyseTracksMultipleCandidates(std::vector<fastjet::PseudoJet>& inputParticles, T const& tracks, int trackSelection, U const& candidates)
+void analyseTracksMultipleCandidates(std::vector<fastjet::PseudoJet>& inputParticles, T const& tracks, int trackSelection, U const& candidates, bool fillUserInfo = true)
 {
+  inputParticles.reserve(inputParticles.size() + tracks.size());
   for (auto& track : tracks) {
     if (!jetderiveddatautilities::selectTrack(track, trackSelection)) {
       continue;
@@ -115,7 +126,11 @@ void analyseTracksMultipleCandidates(std::vector<fastjet::PseudoJet>& inputParti
         continue;
       }
     }
-    fastjetutilities::fillTracks(track, inputParticles, track.globalIndex());
+    if (fillUserInfo) {
+      fastjetutilities::fillTracks(track, inputParticles, track.globalIndex());
+    } else {
+      fastjetutilities::fillTrackUserIndex(track, inputParticles, track.globalIndex());
+    }
   }
 }
 
@@ -232,63 +247,260 @@ bool analyseV0s(std::vector<fastjet::PseudoJet>& inputParticles, T const& v0s, f
 }
 
 /**
- * Performs jet finding and fills jet tables
+ * Jet found in one event, with the content of its rows in the jet tables
+ */
+struct FoundJet {
+  double pt;
+  double eta;
+  double phi;
+  double energy;
+  double y;
+  double mass;
+  double area;
+  double R;
+  bool isSaved; // false for the jets only filled in the THnSparse, e.g. without candidate
+  std::vector<int> tracks;
+  std::vector<int> clusters;
+  std::vector<int> candidates;
+};
+
+/**
+ * Extracts the content of the jet tables from a jet
  *
- * @param jetFinder JetFinder object which carries jet finding parameters
- * @param inputParticles fastjet container
- * @param jetRadius jet finding radii
+ * @param jet jet to be stored, its explicit ghost constituents (without user info or index) are skipped
+ * @param R jet radius
+ * @param jetAreaFractionMin minimum jet area, as a fraction of pi*R^2
+ * @param doCandidateJetFinding set whether only jets containing a candidate are saved
+ * @param foundJet extracted jet
+ * @return false if the jet fails the area cut
+ */
+inline bool getFoundJet(fastjet::PseudoJet const& jet, double R, float jetAreaFractionMin, bool doCandidateJetFinding, FoundJet& foundJet)
+{
+  if (jet.has_area() && jet.area() < jetAreaFractionMin * M_PI * R * R) {
+    return false;
+  }
+  foundJet.pt = jet.pt();
+  foundJet.eta = jet.eta();
+  foundJet.phi = jet.phi();
+  foundJet.energy = jet.E();
+  foundJet.y = jet.rapidity();
+  foundJet.mass = jet.m();
+  foundJet.area = jet.has_area() ? jet.area() : 0.;
+  foundJet.R = R;
+  foundJet.isSaved = true;
+  foundJet.tracks.clear();
+  foundJet.clusters.clear();
+  foundJet.candidates.clear();
+  std::vector<fastjet::PseudoJet> constituents;
+  int constituentStatus, constituentIndex;
+  for (const auto& constituent : jet.constituents()) {
+    if (fastjetutilities::getConstituentStatusAndIndex(constituent, constituentStatus, constituentIndex)) {
+      constituents.push_back(constituent);
+    }
+  }
+  if (doCandidateJetFinding) {
+    bool isCandidateJet = false;
+    for (const auto& constituent : constituents) {
+      fastjetutilities::getConstituentStatusAndIndex(constituent, constituentStatus, constituentIndex);
+      if (constituentStatus == static_cast<int>(JetConstituentStatus::candidateHF)) { // note currently we cannot run V0 and HF in the same jet. If we ever need to we can seperate the loops
+        isCandidateJet = true;
+        break;
+      }
+    }
+    if (!isCandidateJet) {
+      foundJet.isSaved = false;
+      return true;
+    }
+  }
+  for (const auto& constituent : sorted_by_pt(constituents)) {
+    fastjetutilities::getConstituentStatusAndIndex(constituent, constituentStatus, constituentIndex);
+    if (constituentStatus == static_cast<int>(JetConstituentStatus::track)) {
+      foundJet.tracks.push_back(constituentIndex);
+    }
+    if (constituentStatus == static_cast<int>(JetConstituentStatus::cluster)) {
+      foundJet.clusters.push_back(constituentIndex);
+    }
+    if (constituentStatus == static_cast<int>(JetConstituentStatus::candidateHF)) {
+      foundJet.candidates.push_back(constituentIndex);
+    }
+  }
+  return true;
+}
+
+/**
+ * Fills the jet tables with a found jet
+ *
+ * @param foundJet jet to be stored
  * @param collision the collision within which jets are being found
  * @param jetsTable output table of jets
  * @param constituentsTable output table of jet constituents
- * @param doHFJetFinding set whether only jets containing a HF candidate are saved
  */
 template <typename T, typename U, typename V>
-void findJets(JetFinder& jetFinder, std::vector<fastjet::PseudoJet>& inputParticles, float jetPtMin, float jetPtMax, std::vector<double> jetRadius, float jetAreaFractionMin, T const& collision, U& jetsTable, V& constituentsTable, std::shared_ptr<THn> thnSparseJet, bool fillThnSparse, bool doCandidateJetFinding = false)
+void fillJetTables(FoundJet const& foundJet, T const& collision, U& jetsTable, V& constituentsTable, std::shared_ptr<THn> thnSparseJet, bool fillThnSparse)
+{
+  if (fillThnSparse) {
+    thnSparseJet->Fill(foundJet.R, foundJet.pt, foundJet.eta, foundJet.phi); // important for normalisation in V0Jet analyses to store all jets, including those that aren't V0s
+  }
+  if (!foundJet.isSaved) {
+    return;
+  }
+  jetsTable(collision.globalIndex(), foundJet.pt, foundJet.eta, foundJet.phi,
+            foundJet.energy, foundJet.y, foundJet.mass, foundJet.area, std::round(foundJet.R * 100));
+  constituentsTable(jetsTable.lastIndex(), foundJet.tracks, foundJet.clusters, foundJet.candidates);
+}
+
+/**
+ * Fills the jet tables with a jet
+ *
+ * @param jet jet to be stored, its explicit ghost constituents (without user info or index) are skipped
+ * @param R jet radius
+ * @param jetAreaFractionMin minimum jet area, as a fraction of pi*R^2
+ * @param collision the collision within which jets are being found
+ * @param jetsTable output table of jets
+ * @param constituentsTable output table of jet constituents
+ * @param doCandidateJetFinding set whether only jets containing a candidate are saved
+ */
+template <typename T, typename U, typename V>
+void fillJetTables(fastjet::PseudoJet const& jet, double R, float jetAreaFractionMin, T const& collision, U& jetsTable, V& constituentsTable, std::shared_ptr<THn> thnSparseJet, bool fillThnSparse, bool doCandidateJetFinding)
+{
+  FoundJet foundJet;
+  if (getFoundJet(jet, R, jetAreaFractionMin, doCandidateJetFinding, foundJet)) {
+    fillJetTables(foundJet, collision, jetsTable, constituentsTable, thnSparseJet, fillThnSparse);
+  }
+}
+
+/**
+ * Performs jet finding, without access to the tables
+ *
+ * In the multi-R mode (jetFinder.reuseGhosts), the ghosts are generated once per event, seeded by the event key, and shared by all the radii.
+ * With the C/A algorithm, the jets of all the radii are further derived from a single clustering with the largest radius.
+ *
+ * @param jetFinder JetFinder object which carries jet finding parameters
+ * @param inputParticles fastjet container
+ * @param jetRadius jet finding radii
+ * @param eventKey unique key of the event seeding the ghosts, e.g. the collision index
+ * @param foundJets found jets, in the order in which they are stored
+ * @param doCandidateJetFinding set whether only jets containing a candidate are saved
+ */
+inline void clusterJets(JetFinder& jetFinder, std::vector<fastjet::PseudoJet>& inputParticles, float jetPtMin, float jetPtMax, std::vector<double> const& jetRadius, float jetAreaFractionMin, uint64_t eventKey, std::vector<FoundJet>& foundJets, bool doCandidateJetFinding = false)
 {
-  auto jetRValues = static_cast<std::vector<double>>(jetRadius);
+  foundJets.clear();
   jetFinder.jetPtMin = jetPtMin;
   jetFinder.jetPtMax = jetPtMax;
-  for (auto R : jetRValues) {
-    jetFinder.jetR = R;
-    std::vector<fastjet::PseudoJet> jets;
-    fastjet::ClusterSequenceArea clusterSeq(jetFinder.findJets(inputParticles, jets));
+  FoundJet foundJet;
+  auto addJets = [&](std::vector<fastjet::PseudoJet> const& jets, double R) {
     for (const auto& jet : jets) {
-      if (jet.has_area() && jet.area() < jetAreaFractionMin * M_PI * R * R) {
-        continue;
-      }
-      if (fillThnSparse) {
-        thnSparseJet->Fill(R, jet.pt(), jet.eta(), jet.phi()); // important for normalisation in V0Jet analyses to store all jets, including those that aren't V0s
+      if (getFoundJet(jet, R, jetAreaFractionMin, doCandidateJetFinding, foundJet)) {
+        foundJets.push_back(foundJet);
       }
-      bool isCandidateJet = false;
-      if (doCandidateJetFinding) {
-        for (const auto& constituent : jet.constituents()) {
-          auto constituentStatus = constituent.template user_info<fastjetutilities::fastjet_user_info>().getStatus();
-          if (constituentStatus == static_cast<int>(JetConstituentStatus::candidateHF)) { // note currently we cannot run V0 and HF in the same jet. If we ever need to we can seperate the loops
-            isCandidateJet = true;
-            break;
-          }
-        }
-        if (!isCandidateJet) {
-          continue;
-        }
+    }
+  };
+  std::vector<fastjet::PseudoJet> jets;
+  if (jetFinder.reuseGhosts && jetFinder.ghostRepeatN == 1 && !jetFinder.isReclustering) {
+    jetFinder.generateGhosts(eventKey);
+    if (jetFinder.algorithm == fastjet::cambridge_algorithm) {
+      jetFinder.jetR = *std::max_element(jetRadius.begin(), jetRadius.end());
+      fastjet::ClusterSequenceActiveAreaExplicitGhosts clusterSeq(jetFinder.findJetsExplicitGhosts(inputParticles, jets));
+      for (auto R : jetRadius) {
+        jetFinder.jetR = R;
+        jetFinder.findNestedJets(clusterSeq, jets);
+        addJets(jets, R);
       }
-      std::vector<int> tracks;
-      std::vector<int> cands;
-      std::vector<int> clusters;
-      jetsTable(collision.globalIndex(), jet.pt(), jet.eta(), jet.phi(),
-                jet.E(), jet.rapidity(), jet.m(), jet.has_area() ? jet.area() : 0., std::round(R * 100));
-      for (const auto& constituent : sorted_by_pt(jet.constituents())) {
-        if (constituent.template user_info<fastjetutilities::fastjet_user_info>().getStatus() == static_cast<int>(JetConstituentStatus::track)) {
-          tracks.push_back(constituent.template user_info<fastjetutilities::fastjet_user_info>().getIndex());
-        }
-        if (constituent.template user_info<fastjetutilities::fastjet_user_info>().getStatus() == static_cast<int>(JetConstituentStatus::cluster)) {
-          clusters.push_back(constituent.template user_info<fastjetutilities::fastjet_user_info>().getIndex());
-        }
-        if (constituent.template user_info<fastjetutilities::fastjet_user_info>().getStatus() == static_cast<int>(JetConstituentStatus::candidateHF)) {
-          cands.push_back(constituent.template user_info<fastjetutilities::fastjet_user_info>().getIndex());
-        }
+    } else {
+      for (auto R : jetRadius) {
+        jetFinder.jetR = R;
+        fastjet::ClusterSequenceActiveAreaExplicitGhosts clusterSeq(jetFinder.findJetsExplicitGhosts(inputParticles, jets));
+        addJets(jets, R);
       }
-      constituentsTable(jetsTable.lastIndex(), tracks, clusters, cands);
+    }
+    return;
+  }
+  for (auto R : jetRadius) {
+    jetFinder.jetR = R;
+    fastjet::ClusterSequenceArea clusterSeq(jetFinder.findJets(inputParticles, jets));
+    addJets(jets, R);
+  }
+}
+
+/**
+ * Performs jet finding and fills jet tables
+ *
+ * In the multi-R mode (jetFinder.reuseGhosts), the ghosts are generated once per event, seeded by the collision index, and shared by all the radii.
+ * With the C/A algorithm, the jets of all the radii are further derived from a single clustering with the largest radius.
+ *
+ * @param jetFinder JetFinder object which carries jet finding parameters
+ * @param inputParticles fastjet container
+ * @param jetRadius jet finding radii
+ * @param collision the collision within which jets are being found
+ * @param jetsTable output table of jets
+ * @param constituentsTable output table of jet constituents
+ * @param doHFJetFinding set whether only jets containing a HF candidate are saved
+ */
+template <typename T, typename U, typename V>
+void findJets(JetFinder& jetFinder, std::vector<fastjet::PseudoJet>& inputParticles, float jetPtMin, float jetPtMax, std::vector<double> jetRadius, float jetAreaFractionMin, T const& collision, U& jetsTable, V& constituentsTable, std::shared_ptr<THn> thnSparseJet, bool fillThnSparse, bool doCandidateJetFinding = false)
+{
+  std::vector<FoundJet> foundJets;
+  clusterJets(jetFinder, inputParticles, jetPtMin, jetPtMax, jetRadius, jetAreaFractionMin, collision.globalIndex(), foundJets, doCandidateJetFinding);
+  for (const auto& foundJet : foundJets) {
+    fillJetTables(foundJet, collision, jetsTable, constituentsTable, thnSparseJet, fillThnSparse);
+  }
+}
+
+/**
+ * Performs the jet finding of the collisions of a dataframe in parallel and fills the jet tables in collision order
+ *
+ * The input particles are filled in the calling thread. The collisions are then clustered by the worker threads, each with its own JetFinder,
+ * and the tables are filled afterwards in collision order, such that the output does not depend on the number of threads.
+ * With ghosts, the jet finders should use the per-event ghosts (reuseGhosts) for the areas not to depend on the thread either.
+ * The clustering in several threads requires a thread-safe fastjet build (fastjet >= 3.4).
+ *
+ * @param jetFinders jet finders of the threads, the first one is used by the calling thread
+ * @param collisions collisions of the dataframe
+ * @param analyseCollision function (collision, inputParticles) filling the input particles of a collision, returning false if the collision is rejected
+ * @param jetRadius jet finding radii
+ * @param jetsTable output table of jets
+ * @param constituentsTable output table of jet constituents
+ * @param minCollisionsPerThread minimum number of collisions per thread
+ * @param doCandidateJetFinding set whether only jets containing a candidate are saved
+ */
+template <typename T, typename F, typename U, typename V>
+void findJetsParallel(std::vector<JetFinder>& jetFinders, T const& collisions, F&& analyseCollision, float jetPtMin, float jetPtMax, std::vector<double> jetRadius, float jetAreaFractionMin, U& jetsTable, V& constituentsTable, std::shared_ptr<THn> thnSparseJet, bool fillThnSparse, int minCollisionsPerThread, bool doCandidateJetFinding = false)
+{
+  std::vector<typename T::iterator> selectedCollisions;
+  std::vector<std::vector<fastjet::PseudoJet>> inputParticles;
+  std::vector<uint64_t> eventKeys;
+  for (auto const& collision : collisions) {
+    inputParticles.emplace_back();
+    if (!analyseCollision(collision, inputParticles.back())) {
+      inputParticles.pop_back();
+      continue;
+    }
+    selectedCollisions.push_back(collision);
+    eventKeys.push_back(collision.globalIndex());
+  }
+
+  // clustering, the collisions are distributed dynamically as their sizes vary a lot
+  const int nCollisions = selectedCollisions.size();
+  std::vector<std::vector<FoundJet>> foundJets(nCollisions);
+  const int nThreads = std::clamp(nCollisions / std::max(minCollisionsPerThread, 1), 1, static_cast<int>(jetFinders.size()));
+  std::atomic<int> nextCollision{0};
+  auto clusterCollisions = [&](int iThread) {
+    for (int iCollision = nextCollision++; iCollision < nCollisions; iCollision = nextCollision++) {
+      clusterJets(jetFinders[iThread], inputParticles[iCollision], jetPtMin, jetPtMax, jetRadius, jetAreaFractionMin, eventKeys[iCollision], foundJets[iCollision], doCandidateJetFinding);
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int iThread = 1; iThread < nThreads; ++iThread) {
+    threads.emplace_back(clusterCollisions, iThread);
+  }
+  clusterCollisions(0);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (int iCollision = 0; iCollision < nCollisions; iCollision++) {
+    for (const auto& foundJet : foundJets[iCollision]) {
+      fillJetTables(foundJet, selectedCollisions[iCollision], jetsTable, constituentsTable, thnSparseJet, fillThnSparse);
     }
   }
 }
@@ -0,0 +1,97 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file JetGhostCache.h
+/// \brief Per-event cache of the explicit ghosts used for the jet area determination
+///
+/// The ghosts are generated once per event, with a seed derived from the event key (e.g. the collision index),
+/// such that they are reused by all the clusterings of the event (jet radii, candidates, background estimation)
+/// and are identical in all the tasks using the same ghost parameters.
+
+#ifndef PWGJE_CORE_JETGHOSTCACHE_H_
+#define PWGJE_CORE_JETGHOSTCACHE_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "fastjet/PseudoJet.hh"
+#include "fastjet/AreaDefinition.hh"
+
+class JetGhostCache
+{
+ public:
+  /// Sets the ghost parameters, the cached ghosts are discarded if they change
+  void setParams(double ghostMaxRap, double ghostArea, double gridScatter = 1., double ktScatter = .1, double ghostktMean = 1.e-100)
+  {
+    if (ghostMaxRap == maxRap && ghostArea == area && gridScatter == scatterGrid && ktScatter == scatterKt && ghostktMean == ktMean) {
+      return;
+    }
+    maxRap = ghostMaxRap;
+    area = ghostArea;
+    scatterGrid = gridScatter;
+    scatterKt = ktScatter;
+    ktMean = ghostktMean;
+    ghostAreaSpec = fastjet::GhostedAreaSpec(maxRap, 1, area, scatterGrid, scatterKt, ktMean);
+    isCached = false;
+  }
+
+  /// Sets the seed mixed with the event keys
+  void setSeed(uint64_t seed_out)
+  {
+    seed = seed_out;
+    isCached = false;
+  }
+
+  /// Generates the ghosts of an event, unless they are already cached
+  /// \param eventKey unique key of the event, e.g. the collision index
+  /// \return ghosts of the event
+  const std::vector<fastjet::PseudoJet>& getGhosts(uint64_t eventKey)
+  {
+    if (isCached && eventKey == cachedKey) {
+      return ghosts;
+    }
+    // splitmix64 of the event key, mapped onto the seed ranges of the fastjet generator
+    uint64_t z = eventKey + seed + 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    z = z ^ (z >> 31);
+    std::vector<int> randomStatus{static_cast<int>(1 + (z & 0xffffffffULL) % 2147483562ULL), static_cast<int>(1 + (z >> 32) % 2147483398ULL)};
+    ghostAreaSpec.set_random_status(randomStatus);
+    ghosts.clear();
+    ghostAreaSpec.add_ghosts(ghosts);
+    ghostAreaActual = ghostAreaSpec.actual_ghost_area();
+    cachedKey = eventKey;
+    isCached = true;
+    return ghosts;
+  }
+
+  /// \return ghosts of the last event
+  const std::vector<fastjet::PseudoJet>& getGhosts() const { return ghosts; }
+  /// \return actual area of each ghost
+  double getGhostArea() const { return ghostAreaActual; }
+  const fastjet::GhostedAreaSpec& getGhostAreaSpec() const { return ghostAreaSpec; }
+
+ private:
+  double maxRap = -1.;
+  double area = -1.;
+  double scatterGrid = 1.;
+  double scatterKt = .1;
+  double ktMean = 1.e-100;
+  uint64_t seed = 0;
+  fastjet::GhostedAreaSpec ghostAreaSpec;
+
+  bool isCached = false;
+  uint64_t cachedKey = 0;
+  std::vector<fastjet::PseudoJet> ghosts;
+  double ghostAreaActual = 0.;
+};
+
+#endif // PWGJE_CORE_JETGHOSTCACHE_H_
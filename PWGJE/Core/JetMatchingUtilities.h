@@ -26,6 +26,9 @@
 #include <optional>
 #include <tuple>
 #include <algorithm>
+#include <cmath>
+#include <type_traits>
+#include <utility>
 
 #include "Framework/AnalysisTask.h"
 #include "Framework/AnalysisDataModel.h"
@@ -43,10 +46,13 @@
 #include "PWGHF/DataModel/CandidateSelectionTables.h"
 
 #include "PWGJE/DataModel/Jet.h"
+#include "PWGJE/Core/JetUtilities.h"
 
 namespace jetmatchingutilities
 {
 
+using jetutilities::JetEtaPhiGrid;
+
 /**
  * Duplicates jets around the phi boundary which are within the matching distance.
  *
@@ -296,103 +302,141 @@ std::tuple<std::vector<int>, std::vector<int>> MatchJetsGeometrically(
   return std::make_tuple(baseToTagMap, tagToBaseMap);
 }
 
-template <typename T, typename U>
-void MatchGeo(T const& jetsBasePerCollision, U const& jetsTagPerCollision, std::vector<std::vector<int>>& baseToTagMatchingGeo, std::vector<std::vector<int>>& tagToBaseMatchingGeo, float maxMatchingDistance)
-{
-  std::vector<double> jetsR;
-  for (const auto& jetBase : jetsBasePerCollision) {
-    if (std::find(jetsR.begin(), jetsR.end(), std::round(jetBase.r())) == jetsR.end()) {
-      jetsR.push_back(std::round(jetBase.r()));
+/**
+ * Index of the jets of one collision, grouped by jet radius with one eta-phi grid per radius.
+ *
+ * Built once per collision and jet collection, and shared by the geometrical, pT and HF matching.
+ */
+template <typename T>
+struct JetCollectionIndex {
+  using JetIterator = std::decay_t<decltype(*std::declval<T const&>().begin())>;
+
+  std::vector<int> jetsR;                    // rounded jet radius of each group
+  std::vector<std::vector<JetIterator>> jets; // jets of each group
+  std::vector<JetEtaPhiGrid> grids;           // eta-phi grid of each group
+
+  void build(T const& jetsPerCollision, double cellSize)
+  {
+    jetsR.clear();
+    jets.clear();
+    std::vector<std::vector<double>> jetsEta, jetsPhi;
+    for (const auto& jet : jetsPerCollision) {
+      int jetR = std::round(jet.r());
+      int iGroup = getGroup(jetR);
+      if (iGroup < 0) {
+        iGroup = jetsR.size();
+        jetsR.push_back(jetR);
+        jets.emplace_back();
+        jetsEta.emplace_back();
+        jetsPhi.emplace_back();
+      }
+      jets[iGroup].push_back(jet);
+      jetsEta[iGroup].push_back(jet.eta());
+      jetsPhi[iGroup].push_back(jet.phi());
     }
-  }
-  for (const auto& jetTag : jetsTagPerCollision) {
-    if (std::find(jetsR.begin(), jetsR.end(), std::round(jetTag.r())) == jetsR.end()) {
-      jetsR.push_back(std::round(jetTag.r()));
+    grids.resize(jetsR.size());
+    for (std::size_t iGroup = 0; iGroup < jetsR.size(); iGroup++) {
+      grids[iGroup].build(jetsEta[iGroup], jetsPhi[iGroup], cellSize);
     }
   }
-  for (auto jetR : jetsR) {
-    std::vector<double> jetsBasePhi;
-    std::vector<double> jetsBaseEta;
-    std::vector<int> baseToTagMatchingGeoIndex;
-    std::vector<int> tagToBaseMatchingGeoIndex;
-
-    for (const auto& jetBase : jetsBasePerCollision) {
-      if (std::round(jetBase.r()) != std::round(jetR)) {
-        continue;
-      }
-      jetsBasePhi.emplace_back(jetBase.phi());
-      jetsBaseEta.emplace_back(jetBase.eta());
-    }
-    std::vector<double> jetsTagPhi;
-    std::vector<double> jetsTagEta;
-    for (const auto& jetTag : jetsTagPerCollision) {
-      if (std::round(jetTag.r()) != std::round(jetR)) {
-        continue;
-      }
-      jetsTagPhi.emplace_back(jetTag.phi());
-      jetsTagEta.emplace_back(jetTag.eta());
+
+  /// \return index of the group of jets with radius jetR, -1 if there is none
+  int getGroup(int jetR) const
+  {
+    auto it = std::find(jetsR.begin(), jetsR.end(), jetR);
+    return it == jetsR.end() ? -1 : std::distance(jetsR.begin(), it);
+  }
+};
+
+/**
+ * Geometrical jet matching with the eta-phi grid indices of the two collections.
+ *
+ * Jets are required to match uniquely - namely: base <-> tag, within maxMatchingDistance, separately for each jet radius.
+ */
+template <typename T, typename U>
+void MatchGeo(JetCollectionIndex<T> const& jetsBaseIndex, JetCollectionIndex<U> const& jetsTagIndex, std::vector<std::vector<int>>& baseToTagMatchingGeo, std::vector<std::vector<int>>& tagToBaseMatchingGeo, float maxMatchingDistance)
+{
+  for (std::size_t iGroupBase = 0; iGroupBase < jetsBaseIndex.jetsR.size(); iGroupBase++) {
+    int iGroupTag = jetsTagIndex.getGroup(jetsBaseIndex.jetsR[iGroupBase]);
+    if (iGroupTag < 0) {
+      continue;
     }
-    std::tie(baseToTagMatchingGeoIndex, tagToBaseMatchingGeoIndex) = MatchJetsGeometrically(jetsBasePhi, jetsBaseEta, jetsTagPhi, jetsTagEta, maxMatchingDistance); // change max distnace to a function call
-    int jetBaseIndex = 0;
-    for (const auto& jetBase : jetsBasePerCollision) {
-      if (std::round(jetBase.r()) != std::round(jetR)) {
+    const auto& gridBase = jetsBaseIndex.grids[iGroupBase];
+    const auto& gridTag = jetsTagIndex.grids[iGroupTag];
+    double distance;
+    for (std::size_t iBase = 0; iBase < gridBase.size(); iBase++) {
+      int iTag = gridTag.findNearest(gridBase.getEta(iBase), gridBase.getPhi(iBase), maxMatchingDistance, distance);
+      if (iTag < 0) {
+        LOG(debug) << "Closest tag jet not found for " << iBase << "\n";
         continue;
       }
-      int jetTagIndex = baseToTagMatchingGeoIndex[jetBaseIndex];
-      int jetTagGlobalIndex;
-      if (jetTagIndex > -1 && jetTagIndex < jetsTagPerCollision.size()) {
-        jetTagGlobalIndex = jetsTagPerCollision.iteratorAt(jetTagIndex).globalIndex();
-        baseToTagMatchingGeo[jetBase.globalIndex()].push_back(jetTagGlobalIndex);
-      }
-      jetBaseIndex++;
-    }
-    int jetTagIndex = 0;
-    for (const auto& jetTag : jetsTagPerCollision) {
-      if (std::round(jetTag.r()) != std::round(jetR)) {
+      // unique matching: the base jet also has to be the closest one to the tag jet
+      if (gridBase.findNearest(gridTag.getEta(iTag), gridTag.getPhi(iTag), maxMatchingDistance, distance) != static_cast<int>(iBase)) {
         continue;
       }
-      int jetBaseIndex = tagToBaseMatchingGeoIndex[jetTagIndex];
-      int jetBaseGlobalIndex;
-      if (jetBaseIndex > -1 && jetBaseIndex < jetsBasePerCollision.size()) {
-        jetBaseGlobalIndex = jetsBasePerCollision.iteratorAt(jetBaseIndex).globalIndex();
-        tagToBaseMatchingGeo[jetTag.globalIndex()].push_back(jetBaseGlobalIndex);
-      }
-      jetTagIndex++;
+      LOG(debug) << "True match! base index: " << iBase << ", tag index: " << iTag << " with distance " << distance << "\n";
+      const auto& jetBase = jetsBaseIndex.jets[iGroupBase][iBase];
+      const auto& jetTag = jetsTagIndex.jets[iGroupTag][iTag];
+      baseToTagMatchingGeo[jetBase.globalIndex()].push_back(jetTag.globalIndex());
+      tagToBaseMatchingGeo[jetTag.globalIndex()].push_back(jetBase.globalIndex());
     }
   }
 }
 
+template <typename T, typename U>
+void MatchGeo(T const& jetsBasePerCollision, U const& jetsTagPerCollision, std::vector<std::vector<int>>& baseToTagMatchingGeo, std::vector<std::vector<int>>& tagToBaseMatchingGeo, float maxMatchingDistance)
+{
+  JetCollectionIndex<T> jetsBaseIndex;
+  JetCollectionIndex<U> jetsTagIndex;
+  jetsBaseIndex.build(jetsBasePerCollision, maxMatchingDistance);
+  jetsTagIndex.build(jetsTagPerCollision, maxMatchingDistance);
+  MatchGeo(jetsBaseIndex, jetsTagIndex, baseToTagMatchingGeo, tagToBaseMatchingGeo, maxMatchingDistance);
+}
+
 // function that does the HF matching of jets from jetsBasePerColl and jets from jetsTagPerColl; assumes both jetsBasePerColl and jetsTagPerColl have access to Mc information
 template <bool jetsBaseIsMc, bool jetsTagIsMc, typename T, typename U, typename V, typename M, typename N, typename O>
-void MatchHF(T const& jetsBasePerCollision, U const& jetsTagPerCollision, std::vector<std::vector<int>>& baseToTagMatchingHF, std::vector<std::vector<int>>& tagToBaseMatchingHF, V const& /*candidatesBase*/, M const& /*candidatesTag*/, N const& tracksBase, O const& tracksTag)
+void MatchHF(JetCollectionIndex<T> const& jetsBaseIndex, JetCollectionIndex<U> const& jetsTagIndex, std::vector<std::vector<int>>& baseToTagMatchingHF, std::vector<std::vector<int>>& tagToBaseMatchingHF, V const& /*candidatesBase*/, M const& /*candidatesTag*/, N const& tracksBase, O const& tracksTag)
 {
-  for (const auto& jetBase : jetsBasePerCollision) {
-    const auto candidateBase = jetBase.template hfcandidates_first_as<V>();
-    for (const auto& jetTag : jetsTagPerCollision) {
-      if (std::round(jetBase.r()) != std::round(jetTag.r())) {
-        continue;
-      }
-      if constexpr (jetsBaseIsMc || jetsTagIsMc) {
-        if (jethfutilities::isMatchedHFCandidate(candidateBase)) {
-          const auto candidateBaseMcId = jethfutilities::matchedParticleId(candidateBase, tracksBase, tracksTag);
+  for (std::size_t iGroupBase = 0; iGroupBase < jetsBaseIndex.jetsR.size(); iGroupBase++) {
+    int iGroupTag = jetsTagIndex.getGroup(jetsBaseIndex.jetsR[iGroupBase]);
+    if (iGroupTag < 0) {
+      continue;
+    }
+    for (const auto& jetBase : jetsBaseIndex.jets[iGroupBase]) {
+      const auto candidateBase = jetBase.template hfcandidates_first_as<V>();
+      for (const auto& jetTag : jetsTagIndex.jets[iGroupTag]) {
+        if constexpr (jetsBaseIsMc || jetsTagIsMc) {
+          if (jethfutilities::isMatchedHFCandidate(candidateBase)) {
+            const auto candidateBaseMcId = jethfutilities::matchedParticleId(candidateBase, tracksBase, tracksTag);
+            const auto candidateTag = jetTag.template hfcandidates_first_as<M>();
+            const auto candidateTagId = candidateTag.mcParticleId();
+            if (candidateBaseMcId == candidateTagId) {
+              baseToTagMatchingHF[jetBase.globalIndex()].push_back(jetTag.globalIndex());
+              tagToBaseMatchingHF[jetTag.globalIndex()].push_back(jetBase.globalIndex());
+            }
+          }
+        } else {
           const auto candidateTag = jetTag.template hfcandidates_first_as<M>();
-          const auto candidateTagId = candidateTag.mcParticleId();
-          if (candidateBaseMcId == candidateTagId) {
+          if (candidateBase.globalIndex() == candidateTag.globalIndex()) {
             baseToTagMatchingHF[jetBase.globalIndex()].push_back(jetTag.globalIndex());
             tagToBaseMatchingHF[jetTag.globalIndex()].push_back(jetBase.globalIndex());
           }
         }
-      } else {
-        const auto candidateTag = jetTag.template hfcandidates_first_as<M>();
-        if (candidateBase.globalIndex() == candidateTag.globalIndex()) {
-          baseToTagMatchingHF[jetBase.globalIndex()].push_back(jetTag.globalIndex());
-          tagToBaseMatchingHF[jetTag.globalIndex()].push_back(jetBase.globalIndex());
-        }
       }
     }
   }
 }
 
+template <bool jetsBaseIsMc, bool jetsTagIsMc, typename T, typename U, typename V, typename M, typename N, typename O>
+void MatchHF(T const& jetsBasePerCollision, U const& jetsTagPerCollision, std::vector<std::vector<int>>& baseToTagMatchingHF, std::vector<std::vector<int>>& tagToBaseMatchingHF, V const& candidatesBase, M const& candidatesTag, N const& tracksBase, O const& tracksTag)
+{
+  JetCollectionIndex<T> jetsBaseIndex;
+  JetCollectionIndex<U> jetsTagIndex;
+  jetsBaseIndex.build(jetsBasePerCollision, 1.0);
+  jetsTagIndex.build(jetsTagPerCollision, 1.0);
+  MatchHF<jetsBaseIsMc, jetsTagIsMc>(jetsBaseIndex, jetsTagIndex, baseToTagMatchingHF, tagToBaseMatchingHF, candidatesBase, candidatesTag, tracksBase, tracksTag);
+}
+
 template <bool isMc, typename T>
 auto constexpr getConstituentId(T const& track)
 {
@@ -481,48 +525,66 @@ auto getConstituents(T const& jet, U const& /*constituents*/)
 }
 
 template <bool jetsBaseIsMc, bool jetsTagIsMc, typename T, typename U, typename V, typename M, typename N, typename O>
-void MatchPt(T const& jetsBasePerCollision, U const& jetsTagPerCollision, std::vector<std::vector<int>>& baseToTagMatchingPt, std::vector<std::vector<int>>& tagToBaseMatchingPt, V const& tracksBase, M const& clustersBase, N const& tracksTag, O const& clustersTag, float minPtFraction)
+void MatchPt(JetCollectionIndex<T> const& jetsBaseIndex, JetCollectionIndex<U> const& jetsTagIndex, std::vector<std::vector<int>>& baseToTagMatchingPt, std::vector<std::vector<int>>& tagToBaseMatchingPt, V const& tracksBase, M const& clustersBase, N const& tracksTag, O const& clustersTag, float minPtFraction)
 {
   float ptSumBase;
   float ptSumTag;
-  for (const auto& jetBase : jetsBasePerCollision) {
-    auto jetBaseTracks = getConstituents(jetBase, tracksBase);
-    auto jetBaseClusters = getConstituents(jetBase, clustersBase);
-    for (const auto& jetTag : jetsTagPerCollision) {
-      if (std::round(jetBase.r()) != std::round(jetTag.r())) {
-        continue;
-      }
-      auto jetTagTracks = getConstituents(jetTag, tracksTag);
-      auto jetTagClusters = getConstituents(jetTag, clustersTag);
-
-      ptSumBase = getPtSum < jetfindingutilities::isEMCALTable<M>() || jetfindingutilities::isEMCALTable<O>(), jetsBaseIsMc, jetsTagIsMc > (jetBaseTracks, jetBaseClusters, jetTagTracks, jetTagClusters);
-      ptSumTag = getPtSum < jetfindingutilities::isEMCALTable<M>() || jetfindingutilities::isEMCALTable<O>(), jetsTagIsMc, jetsBaseIsMc > (jetTagTracks, jetTagClusters, jetBaseTracks, jetBaseClusters);
-      if (ptSumBase > jetBase.pt() * minPtFraction) {
-        baseToTagMatchingPt[jetBase.globalIndex()].push_back(jetTag.globalIndex());
-      }
-      if (ptSumTag > jetTag.pt() * minPtFraction) {
-        tagToBaseMatchingPt[jetTag.globalIndex()].push_back(jetBase.globalIndex());
+  for (std::size_t iGroupBase = 0; iGroupBase < jetsBaseIndex.jetsR.size(); iGroupBase++) {
+    int iGroupTag = jetsTagIndex.getGroup(jetsBaseIndex.jetsR[iGroupBase]);
+    if (iGroupTag < 0) {
+      continue;
+    }
+    for (const auto& jetBase : jetsBaseIndex.jets[iGroupBase]) {
+      auto jetBaseTracks = getConstituents(jetBase, tracksBase);
+      auto jetBaseClusters = getConstituents(jetBase, clustersBase);
+      for (const auto& jetTag : jetsTagIndex.jets[iGroupTag]) {
+        auto jetTagTracks = getConstituents(jetTag, tracksTag);
+        auto jetTagClusters = getConstituents(jetTag, clustersTag);
+
+        ptSumBase = getPtSum < jetfindingutilities::isEMCALTable<M>() || jetfindingutilities::isEMCALTable<O>(), jetsBaseIsMc, jetsTagIsMc > (jetBaseTracks, jetBaseClusters, jetTagTracks, jetTagClusters);
+        ptSumTag = getPtSum < jetfindingutilities::isEMCALTable<M>() || jetfindingutilities::isEMCALTable<O>(), jetsTagIsMc, jetsBaseIsMc > (jetTagTracks, jetTagClusters, jetBaseTracks, jetBaseClusters);
+        if (ptSumBase > jetBase.pt() * minPtFraction) {
+          baseToTagMatchingPt[jetBase.globalIndex()].push_back(jetTag.globalIndex());
+        }
+        if (ptSumTag > jetTag.pt() * minPtFraction) {
+          tagToBaseMatchingPt[jetTag.globalIndex()].push_back(jetBase.globalIndex());
+        }
       }
     }
   }
 }
 
+template <bool jetsBaseIsMc, bool jetsTagIsMc, typename T, typename U, typename V, typename M, typename N, typename O>
+void MatchPt(T const& jetsBasePerCollision, U const& jetsTagPerCollision, std::vector<std::vector<int>>& baseToTagMatchingPt, std::vector<std::vector<int>>& tagToBaseMatchingPt, V const& tracksBase, M const& clustersBase, N const& tracksTag, O const& clustersTag, float minPtFraction)
+{
+  JetCollectionIndex<T> jetsBaseIndex;
+  JetCollectionIndex<U> jetsTagIndex;
+  jetsBaseIndex.build(jetsBasePerCollision, 1.0);
+  jetsTagIndex.build(jetsTagPerCollision, 1.0);
+  MatchPt<jetsBaseIsMc, jetsTagIsMc>(jetsBaseIndex, jetsTagIndex, baseToTagMatchingPt, tagToBaseMatchingPt, tracksBase, clustersBase, tracksTag, clustersTag, minPtFraction);
+}
+
 // function that calls all the Match functions
 template <bool jetsBaseIsMc, bool jetsTagIsMc, typename T, typename U, typename V, typename M, typename N, typename O, typename P, typename R>
 void doAllMatching(T const& jetsBasePerCollision, U const& jetsTagPerCollision, std::vector<std::vector<int>>& baseToTagMatchingGeo, std::vector<std::vector<int>>& baseToTagMatchingPt, std::vector<std::vector<int>>& baseToTagMatchingHF, std::vector<std::vector<int>>& tagToBaseMatchingGeo, std::vector<std::vector<int>>& tagToBaseMatchingPt, std::vector<std::vector<int>>& tagToBaseMatchingHF, V const& candidatesBase, M const& candidatesTag, N const& tracksBase, O const& clustersBase, P const& tracksTag, R const& clustersTag, bool doMatchingGeo, bool doMatchingHf, bool doMatchingPt, float maxMatchingDistance, float minPtFraction)
 {
+  // index the jets once for all the matching methods
+  JetCollectionIndex<T> jetsBaseIndex;
+  JetCollectionIndex<U> jetsTagIndex;
+  jetsBaseIndex.build(jetsBasePerCollision, maxMatchingDistance);
+  jetsTagIndex.build(jetsTagPerCollision, maxMatchingDistance);
   // geometric matching
   if (doMatchingGeo) {
-    MatchGeo(jetsBasePerCollision, jetsTagPerCollision, baseToTagMatchingGeo, tagToBaseMatchingGeo, maxMatchingDistance);
+    MatchGeo(jetsBaseIndex, jetsTagIndex, baseToTagMatchingGeo, tagToBaseMatchingGeo, maxMatchingDistance);
   }
   // pt matching
   if (doMatchingPt) {
-    MatchPt<jetsBaseIsMc, jetsTagIsMc>(jetsBasePerCollision, jetsTagPerCollision, baseToTagMatchingPt, tagToBaseMatchingPt, tracksBase, clustersBase, tracksTag, clustersTag, minPtFraction);
+    MatchPt<jetsBaseIsMc, jetsTagIsMc>(jetsBaseIndex, jetsTagIndex, baseToTagMatchingPt, tagToBaseMatchingPt, tracksBase, clustersBase, tracksTag, clustersTag, minPtFraction);
   }
   // HF matching
   if constexpr (jethfutilities::isHFTable<V>()) {
     if (doMatchingHf) {
-      MatchHF<jetsBaseIsMc, jetsTagIsMc>(jetsBasePerCollision, jetsTagPerCollision, baseToTagMatchingHF, tagToBaseMatchingHF, candidatesBase, candidatesTag, tracksBase, tracksTag);
+      MatchHF<jetsBaseIsMc, jetsTagIsMc>(jetsBaseIndex, jetsTagIndex, baseToTagMatchingHF, tagToBaseMatchingHF, candidatesBase, candidatesTag, tracksBase, tracksTag);
     }
   }
 }
@@ -18,6 +18,7 @@
 #ifndef PWGJE_CORE_JETTAGGINGUTILITIES_H_
 #define PWGJE_CORE_JETTAGGINGUTILITIES_H_
 
+#include <array>
 #include <cmath>
 #include <limits>
 #include <numeric>
@@ -439,6 +440,55 @@ float getJetProbability(T const& fResoFuncjet, U const& collision, V const& jet,
   return JP;
 }
 
+/**
+ * Number of ML features of a jet: the jet pT, eta and number of constituents, then for each of the nTracks
+ * constituents with the largest signed impact parameter significance in XY its signed significances in XY and
+ * XYZ, its pT and its distance to the jet axis.
+ */
+inline int getNumMLFeatures(int nTracks)
+{
+  return 3 + 4 * nTracks;
+}
+
+/**
+ * Appends the ML features of a jet (see getNumMLFeatures) to a feature matrix holding one row per jet, such that
+ * the jets of a dataframe are scored with one model evaluation. Missing constituents are filled with zeros.
+ *
+ * @param collision: The collision of the jet, necessary for geometric sign calculations.
+ * @param jet: The jet whose features are appended.
+ * @param jtracks: Tracks in jets
+ * @param tracks: The original tracks to transform from jtracks.
+ * @param nTracks: Number of constituents in the features.
+ * @param features: The feature matrix, row major.
+ * @param trackFeatures: Buffer reused between the jets for the ordering of the constituents.
+ */
+template <typename T, typename U, typename V, typename W>
+void appendMLFeatures(T const& collision, U const& jet, V const& /*jtracks*/, W const& /*tracks*/, int nTracks, std::vector<float>& features, std::vector<std::array<float, 4>>& trackFeatures)
+{
+  trackFeatures.clear();
+  for (auto& jtrack : jet.template tracks_as<V>()) {
+    auto track = jtrack.template track_as<W>();
+    auto geoSign = getGeoSign(collision, jet, track);
+    float varSignImpXYSig = geoSign * TMath::Abs(track.dcaXY()) / TMath::Sqrt(track.sigmaDcaXY2());
+    float varSignImpXYZSig = geoSign * TMath::Abs(jtrack.dcaXYZ()) / TMath::Sqrt(jtrack.sigmaDcaXYZ2());
+    float deltaR = jetutilities::deltaR(jet, jtrack);
+    trackFeatures.push_back({varSignImpXYSig, varSignImpXYZSig, jtrack.pt(), deltaR});
+  }
+  const int nSelected = std::min(nTracks, static_cast<int>(trackFeatures.size()));
+  std::partial_sort(trackFeatures.begin(), trackFeatures.begin() + nSelected, trackFeatures.end(), [](auto const& a, auto const& b) { return a[0] > b[0]; });
+
+  features.push_back(jet.pt());
+  features.push_back(jet.eta());
+  features.push_back(trackFeatures.size());
+  for (int i = 0; i < nTracks; i++) {
+    if (i < nSelected) {
+      features.insert(features.end(), trackFeatures[i].begin(), trackFeatures[i].end());
+    } else {
+      features.insert(features.end(), 4, 0.f);
+    }
+  }
+}
+
 }; // namespace jettaggingutilities
 
 #endif // PWGJE_CORE_JETTAGGINGUTILITIES_H_
@@ -18,10 +18,13 @@
 #ifndef PWGJE_CORE_JETUTILITIES_H_
 #define PWGJE_CORE_JETUTILITIES_H_
 
+#include <algorithm>
 #include <cmath>
 #include <limits>
 #include <numeric>
+#include <stdexcept>
 #include <tuple>
+#include <utility>
 #include <vector>
 
 #include <TKDTree.h>
@@ -32,6 +35,148 @@
 namespace jetutilities
 {
 
+/**
+ * Eta-phi grid index of a collection of jets or particles, with periodic phi.
+ *
+ * The jets are sorted into cells of at least cellSize in eta and phi, such that the queries up to a distance
+ * cellSize only visit the 3x3 cells around the query point. Phi is handled natively as periodic, the jets
+ * around the phi boundary do not need to be duplicated.
+ *
+ * NOTE: Assumes, but does not validate, that 0 <= phi < 2pi.
+ */
+class JetEtaPhiGrid
+{
+ public:
+  /**
+   * Builds the grid
+   *
+   * @param jetsEta Jets eta
+   * @param jetsPhi Jets phi
+   * @param cellSize Minimum cell size, typically the maximum query distance
+   */
+  void build(const std::vector<double>& jetsEta, const std::vector<double>& jetsPhi, double cellSize)
+  {
+    eta = jetsEta;
+    phi = jetsPhi;
+    nCellsEta = 0;
+    nCellsPhi = 0;
+    if (eta.size() == 0) {
+      return;
+    }
+    const auto [etaMinIt, etaMaxIt] = std::minmax_element(eta.begin(), eta.end());
+    etaMin = *etaMinIt;
+    // limit the number of cells for small cell sizes, the queries then visit more cells
+    cellSizeEta = std::max(cellSize, (*etaMaxIt - etaMin) / maxCellsPerDimension);
+    nCellsEta = static_cast<int>((*etaMaxIt - etaMin) / cellSizeEta) + 1;
+    nCellsPhi = std::clamp(static_cast<int>(2 * M_PI / std::max(cellSize, 1.e-6)), 1, maxCellsPerDimension);
+    cellSizePhi = 2 * M_PI / nCellsPhi;
+
+    cellStart.assign(nCellsEta * nCellsPhi + 1, 0);
+    std::vector<int> jetCells(eta.size());
+    for (std::size_t i = 0; i < eta.size(); i++) {
+      jetCells[i] = std::clamp(cellIndexEta(eta[i]), 0, nCellsEta - 1) * nCellsPhi + cellIndexPhi(phi[i]);
+      cellStart[jetCells[i] + 1]++;
+    }
+    for (std::size_t iCell = 1; iCell < cellStart.size(); iCell++) {
+      cellStart[iCell] += cellStart[iCell - 1];
+    }
+    cellJets.resize(eta.size());
+    std::vector<int> cellFill(cellStart.begin(), cellStart.end() - 1);
+    for (std::size_t i = 0; i < eta.size(); i++) {
+      cellJets[cellFill[jetCells[i]]++] = i;
+    }
+  }
+
+  /**
+   * Calls f(jet index, distance) for all the jets closer than radius to the point
+   */
+  template <typename F>
+  void forEachInRadius(double pointEta, double pointPhi, double radius, F&& f) const
+  {
+    if (nCellsEta == 0) {
+      return;
+    }
+    int pointCellEta = cellIndexEta(pointEta);
+    int nRingsEta = static_cast<int>(std::ceil(radius / cellSizeEta));
+    int iEtaMin = std::max(pointCellEta - nRingsEta, 0);
+    int iEtaMax = std::min(pointCellEta + nRingsEta, nCellsEta - 1);
+    int pointCellPhi = cellIndexPhi(pointPhi);
+    int nRingsPhi = static_cast<int>(std::ceil(radius / cellSizePhi));
+    int iPhiMin = pointCellPhi - nRingsPhi;
+    int iPhiMax = pointCellPhi + nRingsPhi;
+    if (2 * nRingsPhi + 1 >= nCellsPhi) { // the query wraps around the full phi range
+      iPhiMin = 0;
+      iPhiMax = nCellsPhi - 1;
+    }
+    for (int iEta = iEtaMin; iEta <= iEtaMax; iEta++) {
+      for (int iPhi = iPhiMin; iPhi <= iPhiMax; iPhi++) {
+        int iCell = iEta * nCellsPhi + (iPhi + nCellsPhi) % nCellsPhi;
+        for (int iCellJet = cellStart[iCell]; iCellJet < cellStart[iCell + 1]; iCellJet++) {
+          int i = cellJets[iCellJet];
+          double distance = deltaR(pointEta, pointPhi, eta[i], phi[i]);
+          if (distance < radius) {
+            f(i, distance);
+          }
+        }
+      }
+    }
+  }
+
+  /**
+   * Finds the closest jet to the point within maxDistance
+   *
+   * @returns index of the closest jet, -1 if there is none within maxDistance
+   */
+  int findNearest(double pointEta, double pointPhi, double maxDistance, double& distance) const
+  {
+    int nearest = -1;
+    distance = maxDistance;
+    forEachInRadius(pointEta, pointPhi, maxDistance, [&](int i, double d) {
+      if (d < distance) {
+        nearest = i;
+        distance = d;
+      }
+    });
+    return nearest;
+  }
+
+  std::size_t size() const { return eta.size(); }
+  double getEta(int i) const { return eta[i]; }
+  double getPhi(int i) const { return phi[i]; }
+
+  static double deltaR(double eta1, double phi1, double eta2, double phi2)
+  {
+    double dPhi = std::fmod(std::abs(phi1 - phi2), 2 * M_PI);
+    if (dPhi > M_PI) {
+      dPhi = 2 * M_PI - dPhi;
+    }
+    return std::sqrt((eta1 - eta2) * (eta1 - eta2) + dPhi * dPhi);
+  }
+
+ private:
+  static constexpr int maxCellsPerDimension = 64;
+
+  int cellIndexEta(double pointEta) const { return static_cast<int>(std::floor((pointEta - etaMin) / cellSizeEta)); }
+  int cellIndexPhi(double pointPhi) const
+  {
+    double phiWrapped = std::fmod(pointPhi, 2 * M_PI);
+    if (phiWrapped < 0) {
+      phiWrapped += 2 * M_PI;
+    }
+    return std::min(static_cast<int>(phiWrapped / cellSizePhi), nCellsPhi - 1);
+  }
+
+  std::vector<double> eta;
+  std::vector<double> phi;
+  double etaMin = 0.;
+  double cellSizeEta = 1.;
+  double cellSizePhi = 1.;
+  int nCellsEta = 0;
+  int nCellsPhi = 0;
+  std::vector<int> cellStart; // first entry of each cell in cellJets
+  std::vector<int> cellJets;  // jet indices sorted by cell
+};
+
 /**
  * Match clusters and tracks.
  *
@@ -138,6 +283,68 @@ std::tuple<std::vector<std::vector<int>>, std::vector<std::vector<int>>> MatchCl
   return std::make_tuple(matchIndexTrack, matchIndexCluster);
 }
 
+/**
+ * Match clusters and tracks with eta-phi grids instead of KD-trees.
+ *
+ * Same output as MatchClustersAndTracks, the matches being ordered by increasing distance. The tracks are expected
+ * at the calorimeter surface, each cluster then only tests the tracks of the grid cells within maxMatchingDistance
+ * and vice versa. Unlike the KD-trees, the distance is periodic in phi.
+ *
+ * @param clusterPhi cluster collection phi.
+ * @param clusterEta cluster collection eta.
+ * @param trackPhi track collection phi.
+ * @param trackEta track collection eta.
+ * @param maxMatchingDistance Maximum matching distance.
+ * @param maxNumberMatches Maximum number of matches (e.g. 5 closest).
+ *
+ * @returns (cluster to track index map, track to cluster index map)
+ */
+template <typename T>
+std::tuple<std::vector<std::vector<int>>, std::vector<std::vector<int>>> MatchClustersAndTracksGrid(
+  std::vector<T>& clusterPhi,
+  std::vector<T>& clusterEta,
+  std::vector<T>& trackPhi,
+  std::vector<T>& trackEta,
+  double maxMatchingDistance,
+  int maxNumberMatches)
+{
+  const std::size_t nClusters = clusterEta.size();
+  const std::size_t nTracks = trackEta.size();
+  std::vector<std::vector<int>> matchIndexTrack(nClusters, std::vector<int>(maxNumberMatches, -1));
+  std::vector<std::vector<int>> matchIndexCluster(nTracks, std::vector<int>(maxNumberMatches, -1));
+  if (!(nClusters && nTracks)) {
+    return std::make_tuple(matchIndexTrack, matchIndexCluster);
+  }
+  if (clusterPhi.size() != clusterEta.size()) {
+    throw std::invalid_argument("cluster collection eta and phi sizes don't match. Check the inputs.");
+  }
+  if (trackPhi.size() != trackEta.size()) {
+    throw std::invalid_argument("track collection eta and phi sizes don't match. Check the inputs.");
+  }
+
+  auto findMatches = [&](const JetEtaPhiGrid& grid, const std::vector<T>& eta, const std::vector<T>& phi, std::vector<std::vector<int>>& matchIndex) {
+    std::vector<std::pair<double, int>> candidates;
+    for (std::size_t i = 0; i < eta.size(); i++) {
+      candidates.clear();
+      grid.forEachInRadius(eta[i], phi[i], maxMatchingDistance, [&](int index, double distance) {
+        candidates.emplace_back(distance, index);
+      });
+      auto nMatches = std::min(candidates.size(), static_cast<std::size_t>(maxNumberMatches));
+      std::partial_sort(candidates.begin(), candidates.begin() + nMatches, candidates.end());
+      for (std::size_t m = 0; m < nMatches; m++) {
+        matchIndex[i][m] = candidates[m].second;
+      }
+    }
+  };
+
+  JetEtaPhiGrid trackGrid, clusterGrid;
+  trackGrid.build(std::vector<double>(trackEta.begin(), trackEta.end()), std::vector<double>(trackPhi.begin(), trackPhi.end()), maxMatchingDistance);
+  clusterGrid.build(std::vector<double>(clusterEta.begin(), clusterEta.end()), std::vector<double>(clusterPhi.begin(), clusterPhi.end()), maxMatchingDistance);
+  findMatches(trackGrid, clusterEta, clusterPhi, matchIndexTrack);
+  findMatches(clusterGrid, trackEta, trackPhi, matchIndexCluster);
+  return std::make_tuple(matchIndexTrack, matchIndexCluster);
+}
+
 template <typename T, typename U>
 float deltaR(T const& A, U const& B)
 {
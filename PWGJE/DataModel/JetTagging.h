@@ -127,8 +127,10 @@ JETSV_TABLES_DEF(Charged, SecondaryVertex2Prong, "2PRONG");
     DECLARE_SOA_COLUMN(JetProb, jetProb, std::vector<float>);   \
     DECLARE_SOA_COLUMN(Algorithm2, algorithm2, int);            \
     DECLARE_SOA_COLUMN(Algorithm3, algorithm3, int);            \
+    DECLARE_SOA_COLUMN(ScoreML, scoreML, float);                \
   }                                                             \
-  DECLARE_SOA_TABLE(_jet_type_##Tags, "AOD", _description_ "Tags", _name_##tagging::Origin, _name_##tagging::JetProb, _name_##tagging::Algorithm2, _name_##tagging::Algorithm3);
+  DECLARE_SOA_TABLE(_jet_type_##Tags, "AOD", _description_ "Tags", _name_##tagging::Origin, _name_##tagging::JetProb, _name_##tagging::Algorithm2, _name_##tagging::Algorithm3); \
+  DECLARE_SOA_TABLE(_jet_type_##MLTags, "AOD", _description_ "MLTags", _name_##tagging::ScoreML);
 
 #define JETTAGGING_TABLES_DEF(_jet_type_, _description_)                                                    \
   JETTAGGING_TABLE_DEF(_jet_type_##Jet, _jet_type_##jet, _description_)                                     \
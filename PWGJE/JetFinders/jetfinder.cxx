@@ -45,6 +45,7 @@ struct JetFinderTask {
   Configurable<float> trackPhiMin{"trackPhiMin", -999, "minimum track phi"};
   Configurable<float> trackPhiMax{"trackPhiMax", 999, "maximum track phi"};
   Configurable<std::string> trackSelections{"trackSelections", "globalTracks", "set track selections"};
+  Configurable<bool> fillTrackUserInfo{"fillTrackUserInfo", false, "attach a user info object to each track, otherwise the track index is only encoded in the fastjet user index"};
   Configurable<std::string> eventSelections{"eventSelections", "sel8", "choose event selection"};
   Configurable<std::string> particleSelections{"particleSelections", "PhysicalPrimary", "set particle selections"};
 
@@ -71,10 +72,13 @@ struct JetFinderTask {
   Configurable<int> jetRecombScheme{"jetRecombScheme", 0, "jet recombination scheme. 0 = E-scheme, 1 = pT-scheme, 2 = pT2-scheme"};
   Configurable<float> jetGhostArea{"jetGhostArea", 0.005, "jet ghost area"};
   Configurable<int> ghostRepeat{"ghostRepeat", 1, "set to 0 to gain speed if you dont need area calculation"};
+  Configurable<bool> reuseGhosts{"reuseGhosts", false, "generate the ghosts once per event and share them between all the jet radii (ghostRepeat = 1 only). With C/A, all radii are derived from one clustering"};
   Configurable<bool> DoTriggering{"DoTriggering", false, "used for the charged jet trigger to remove the eta constraint on the jet axis"};
   Configurable<float> jetAreaFractionMin{"jetAreaFractionMin", -99.0, "used to make a cut on the jet areas"};
   Configurable<int> jetPtBinWidth{"jetPtBinWidth", 5, "used to define the width of the jetPt bins for the THnSparse"};
   Configurable<bool> fillTHnSparse{"fillTHnSparse", false, "switch to fill the THnSparse"};
+  Configurable<int> nThreadsJetFinding{"nThreadsJetFinding", 1, "number of threads for the jet finding of the collisions of a dataframe, used by the parallel process functions"};
+  Configurable<int> minCollisionsPerThread{"minCollisionsPerThread", 4, "minimum number of collisions clustered by each thread"};
 
   Service<o2::framework::O2DatabasePDG> pdgDatabase;
   int trackSelection = -1;
@@ -82,8 +86,12 @@ struct JetFinderTask {
   std::string particleSelection;
 
   JetFinder jetFinder;
+  std::vector<JetFinder> jetFinderWorkers; // jet finders of the threads of the parallel process functions
   std::vector<fastjet::PseudoJet> inputParticles;
 
+  Preslice<JetTracks> tracksPerCollision = aod::jtrack::collisionId;
+  Preslice<JetClusters> clustersPerCollision = aod::jcluster::collisionId;
+
   void init(InitContext const&)
   {
     trackSelection = jetderiveddatautilities::initialiseTrackSelection(static_cast<std::string>(trackSelections));
@@ -101,9 +109,14 @@ struct JetFinderTask {
     jetFinder.recombScheme = static_cast<fastjet::RecombinationScheme>(static_cast<int>(jetRecombScheme));
     jetFinder.ghostArea = jetGhostArea;
     jetFinder.ghostRepeatN = ghostRepeat;
+    jetFinder.reuseGhosts = reuseGhosts;
     if (DoTriggering) {
       jetFinder.isTriggering = true;
     }
+    jetFinderWorkers.assign(std::max(static_cast<int>(nThreadsJetFinding), 1), jetFinder);
+    for (auto& jetFinderWorker : jetFinderWorkers) {
+      jetFinderWorker.reuseGhosts = true; // ghosts seeded by the collision index, such that the jet areas do not depend on the thread
+    }
 
     auto jetRadiiBins = (std::vector<double>)jetRadius;
     if (jetRadiiBins.size() > 1) {
@@ -140,12 +153,27 @@ struct JetFinderTask {
       return;
     }
     inputParticles.clear();
-    jetfindingutilities::analyseTracks<soa::Filtered<JetTracks>, soa::Filtered<JetTracks>::iterator>(inputParticles, tracks, trackSelection);
+    jetfindingutilities::analyseTracks<soa::Filtered<JetTracks>, soa::Filtered<JetTracks>::iterator>(inputParticles, tracks, trackSelection, std::nullopt, fillTrackUserInfo);
     jetfindingutilities::findJets(jetFinder, inputParticles, jetPtMin, jetPtMax, jetRadius, jetAreaFractionMin, collision, jetsTable, constituentsTable, registry.get<THn>(HIST("hJet")), fillTHnSparse);
   }
 
   PROCESS_SWITCH(JetFinderTask, processChargedJets, "Data and reco level jet finding for charged jets", false);
 
+  void processChargedJetsParallel(soa::Filtered<JetCollisions> const& collisions,
+                                  soa::Filtered<JetTracks> const& tracks)
+  {
+    auto analyseCollision = [&](soa::Filtered<JetCollisions>::iterator const& collision, std::vector<fastjet::PseudoJet>& particles) {
+      if (!jetderiveddatautilities::selectCollision(collision, eventSelection)) {
+        return false;
+      }
+      auto tracksThisCollision = tracks.sliceBy(tracksPerCollision, collision.globalIndex());
+      jetfindingutilities::analyseTracks<soa::Filtered<JetTracks>, soa::Filtered<JetTracks>::iterator>(particles, tracksThisCollision, trackSelection, std::nullopt, fillTrackUserInfo);
+      return true;
+    };
+    jetfindingutilities::findJetsParallel(jetFinderWorkers, collisions, analyseCollision, jetPtMin, jetPtMax, jetRadius, jetAreaFractionMin, jetsTable, constituentsTable, registry.get<THn>(HIST("hJet")), fillTHnSparse, minCollisionsPerThread);
+  }
+  PROCESS_SWITCH(JetFinderTask, processChargedJetsParallel, "Data and reco level jet finding for charged jets, with the collisions of a dataframe clustered in parallel", false);
+
   void processChargedEvtWiseSubJets(soa::Filtered<JetCollisions>::iterator const& collision,
                                     soa::Filtered<JetTracksSub> const& tracks)
   {
@@ -153,7 +181,7 @@ struct JetFinderTask {
       return;
     }
     inputParticles.clear();
-    jetfindingutilities::analyseTracks<soa::Filtered<JetTracksSub>, soa::Filtered<JetTracksSub>::iterator>(inputParticles, tracks, trackSelection);
+    jetfindingutilities::analyseTracks<soa::Filtered<JetTracksSub>, soa::Filtered<JetTracksSub>::iterator>(inputParticles, tracks, trackSelection, std::nullopt, fillTrackUserInfo);
     jetfindingutilities::findJets(jetFinder, inputParticles, jetEWSPtMin, jetEWSPtMax, jetRadius, jetAreaFractionMin, collision, jetsEvtWiseSubTable, constituentsEvtWiseSubTable, registry.get<THn>(HIST("hJetEWS")), fillTHnSparse);
   }
 
@@ -179,12 +207,30 @@ struct JetFinderTask {
       return;
     }
     inputParticles.clear();
-    jetfindingutilities::analyseTracks<soa::Filtered<JetTracks>, soa::Filtered<JetTracks>::iterator>(inputParticles, tracks, trackSelection);
+    jetfindingutilities::analyseTracks<soa::Filtered<JetTracks>, soa::Filtered<JetTracks>::iterator>(inputParticles, tracks, trackSelection, std::nullopt, fillTrackUserInfo);
     jetfindingutilities::analyseClusters(inputParticles, &clusters);
     jetfindingutilities::findJets(jetFinder, inputParticles, jetPtMin, jetPtMax, jetRadius, jetAreaFractionMin, collision, jetsTable, constituentsTable, registry.get<THn>(HIST("hJet")), fillTHnSparse);
   }
   PROCESS_SWITCH(JetFinderTask, processFullJets, "Data and reco level jet finding for full and neutral jets", false);
 
+  void processFullJetsParallel(soa::Filtered<JetCollisions> const& collisions,
+                               soa::Filtered<JetTracks> const& tracks,
+                               soa::Filtered<JetClusters> const& clusters)
+  {
+    auto analyseCollision = [&](soa::Filtered<JetCollisions>::iterator const& collision, std::vector<fastjet::PseudoJet>& particles) {
+      if (!jetderiveddatautilities::eventEMCAL(collision)) {
+        return false;
+      }
+      auto tracksThisCollision = tracks.sliceBy(tracksPerCollision, collision.globalIndex());
+      auto clustersThisCollision = clusters.sliceBy(clustersPerCollision, collision.globalIndex());
+      jetfindingutilities::analyseTracks<soa::Filtered<JetTracks>, soa::Filtered<JetTracks>::iterator>(particles, tracksThisCollision, trackSelection, std::nullopt, fillTrackUserInfo);
+      jetfindingutilities::analyseClusters(particles, &clustersThisCollision);
+      return true;
+    };
+    jetfindingutilities::findJetsParallel(jetFinderWorkers, collisions, analyseCollision, jetPtMin, jetPtMax, jetRadius, jetAreaFractionMin, jetsTable, constituentsTable, registry.get<THn>(HIST("hJet")), fillTHnSparse, minCollisionsPerThread);
+  }
+  PROCESS_SWITCH(JetFinderTask, processFullJetsParallel, "Data and reco level jet finding for full and neutral jets, with the collisions of a dataframe clustered in parallel", false);
+
   void processParticleLevelChargedJets(JetMcCollision const& collision, soa::Filtered<JetParticles> const& particles)
   {
     // TODO: MC event selection?
@@ -15,8 +15,10 @@
 /// \author Florian Jonas <florian.jonas@cern.ch>
 
 #include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <memory>
+#include <thread>
 #include <unordered_map>
 #include <cmath>
 
@@ -75,6 +77,7 @@ struct EmcalCorrectionTask {
   Configurable<int> selectedCellType{"selectedCellType", 1, "EMCAL Cell type"};
   Configurable<std::string> clusterDefinitions{"clusterDefinition", "kV3Default", "cluster definition to be selected, e.g. V3Default. Multiple definitions can be specified separated by comma"};
   Configurable<float> maxMatchingDistance{"maxMatchingDistance", 0.4f, "Max matching distance track-cluster"};
+  Configurable<bool> useGridTrackMatching{"useGridTrackMatching", false, "match the clusters and tracks with eta-phi grids of cell size maxMatchingDistance instead of KD-trees"};
   Configurable<bool> hasPropagatedTracks{"hasPropagatedTracks", false, "temporary flag, only set to true when running over data which has the tracks propagated to EMCal/PHOS!"};
   Configurable<std::string> nonlinearityFunction{"nonlinearityFunction", "DATA_TestbeamFinal", "Nonlinearity correction at cluster level"};
   Configurable<bool> disableNonLin{"disableNonLin", false, "Disable NonLin correction if set to true"};
@@ -88,6 +91,8 @@ struct EmcalCorrectionTask {
   Configurable<float> exoticCellInCrossMinAmplitude{"exoticCellInCrossMinAmplitude", 0.1, "Minimum energy of cells in cross, if lower not considered in cross"};
   Configurable<bool> useWeightExotic{"useWeightExotic", false, "States if weights should be used for exotic cell cut"};
   Configurable<bool> isMC{"isMC", false, "States if run over MC"};
+  Configurable<int> nThreadsClusterizer{"nThreadsClusterizer", 1, "number of threads for the clusterization of the BCs of a dataframe, used by processFullParallel"};
+  Configurable<int> minBCsPerThread{"minBCsPerThread", 8, "minimum number of BCs with cells clusterized by each thread"};
 
   // Require EMCAL cells (CALO type 1)
   Filter emccellfilter = aod::calo::caloType == selectedCellType;
@@ -106,6 +111,16 @@ struct EmcalCorrectionTask {
   std::vector<o2::emcal::ClusterLabel> mClusterLabels;
 
   std::vector<o2::aod::EMCALClusterDefinition> mClusterDefinitions;
+  // Clusterizers and cluster factories of the additional threads of processFullParallel
+  std::vector<std::vector<std::unique_ptr<o2::emcal::Clusterizer<o2::emcal::Cell>>>> mClusterizerWorkers;
+  std::vector<o2::emcal::ClusterFactory<o2::emcal::Cell>> mClusterFactoryWorkers;
+  // Cells of a BC and their clusters for each cluster definition, filled by processFullParallel
+  struct BCClusterization {
+    std::vector<o2::emcal::Cell> cells;
+    std::vector<int64_t> cellIndices;
+    std::vector<std::vector<o2::emcal::AnalysisCluster>> clusters;
+  };
+  std::vector<BCClusterization> mBCClusterizations;
   // QA
   o2::framework::HistogramRegistry mHistManager{"EMCALCorrectionTaskQAHistograms"};
 
@@ -140,13 +155,7 @@ struct EmcalCorrectionTask {
         mClusterDefinitions.push_back(clusDef);
       }
     }
-    mClusterFactories.setGeometry(geometry);
-    mClusterFactories.SetECALogWeight(logWeight);
-    mClusterFactories.setExoticCellFraction(exoticCellFraction);
-    mClusterFactories.setExoticCellDiffTime(exoticCellDiffTime);
-    mClusterFactories.setExoticCellMinAmplitude(exoticCellMinAmplitude);
-    mClusterFactories.setExoticCellInCrossMinAmplitude(exoticCellInCrossMinAmplitude);
-    mClusterFactories.setUseWeightExotic(useWeightExotic);
+    setupClusterFactory(mClusterFactories, geometry);
     for (auto& clusterDefinition : mClusterDefinitions) {
       mClusterizers.emplace_back(std::make_unique<o2::emcal::Clusterizer<o2::emcal::Cell>>(1E9, clusterDefinition.timeMin, clusterDefinition.timeMax, clusterDefinition.gradientCut, clusterDefinition.doGradientCut, clusterDefinition.seedEnergy, clusterDefinition.minCellEnergy));
       LOG(info) << "Cluster definition initialized: " << clusterDefinition.toString();
@@ -165,6 +174,25 @@ struct EmcalCorrectionTask {
       LOG(error) << "No cluster definitions specified!";
     }
 
+    if (doprocessFullParallel && nThreadsClusterizer > 1) {
+      // the first thread uses mClusterizers and mClusterFactories
+      mClusterizerWorkers.resize(nThreadsClusterizer - 1);
+      mClusterFactoryWorkers.resize(nThreadsClusterizer - 1);
+      for (int iWorker = 0; iWorker < nThreadsClusterizer - 1; iWorker++) {
+        for (auto& clusterDefinition : mClusterDefinitions) {
+          mClusterizerWorkers[iWorker].emplace_back(std::make_unique<o2::emcal::Clusterizer<o2::emcal::Cell>>(1E9, clusterDefinition.timeMin, clusterDefinition.timeMax, clusterDefinition.gradientCut, clusterDefinition.doGradientCut, clusterDefinition.seedEnergy, clusterDefinition.minCellEnergy));
+          mClusterizerWorkers[iWorker].back()->setGeometry(geometry);
+        }
+        setupClusterFactory(mClusterFactoryWorkers[iWorker], geometry);
+      }
+      // The super module matrices are otherwise read lazily from the TGeoManager when building the first clusters,
+      // which must not happen concurrently.
+      for (int iSM = 0; iSM < geometry->GetNumberOfSuperModules(); iSM++) {
+        geometry->GetMatrixForSuperModule(iSM);
+      }
+      LOG(info) << "Clusterizing the BCs with up to " << nThreadsClusterizer.value << " threads";
+    }
+
     mNonlinearityHandler = o2::emcal::NonlinearityFactory::getInstance().getNonlinearity(static_cast<std::string>(nonlinearityFunction));
     LOG(info) << "Using nonlinearity parameterisation: " << nonlinearityFunction.value;
     LOG(info) << "Apply shaper saturation correction:  " << (hasShaperCorrection.value ? "yes" : "no");
@@ -248,20 +276,7 @@ struct EmcalCorrectionTask {
       countBC(collisionsInFoundBC.size(), true);
       std::vector<o2::emcal::Cell> cellsBC;
       std::vector<int64_t> cellIndicesBC;
-      for (auto& cell : cellsInBC) {
-        auto amplitude = cell.amplitude();
-        if (static_cast<bool>(hasShaperCorrection)) {
-          amplitude = o2::emcal::NonlinearityHandler::evaluateShaperCorrectionCellEnergy(amplitude);
-        }
-        if (applyCellAbsScale) {
-          amplitude *= GetAbsCellScale(cell.cellNumber());
-        }
-        cellsBC.emplace_back(cell.cellNumber(),
-                             amplitude,
-                             cell.time(),
-                             o2::emcal::intToChannelType(cell.cellType()));
-        cellIndicesBC.emplace_back(cell.globalIndex());
-      }
+      convertCells(cellsInBC, cellsBC, cellIndicesBC);
       LOG(detail) << "Number of cells for BC (CF): " << cellsBC.size();
       nCellsProcessed += cellsBC.size();
 
@@ -279,38 +294,7 @@ struct EmcalCorrectionTask {
       LOG(debug) << "Running clusterizers";
       for (size_t iClusterizer = 0; iClusterizer < mClusterizers.size(); iClusterizer++) {
         cellsToCluster(iClusterizer, cellsBC);
-
-        if (collisionsInFoundBC.size() == 1) {
-          // dummy loop to get the first collision
-          for (const auto& col : collisionsInFoundBC) {
-            if (col.foundBCId() == bc.globalIndex()) {
-              mHistManager.fill(HIST("hCollPerBC"), 1);
-              mHistManager.fill(HIST("hCollisionType"), 1);
-              math_utils::Point3D<float> vertex_pos = {col.posX(), col.posY(), col.posZ()};
-
-              std::vector<std::vector<int>> clusterToTrackIndexMap;
-              std::vector<std::vector<int>> trackToClusterIndexMap;
-              std::tuple<std::vector<std::vector<int>>, std::vector<std::vector<int>>> IndexMapPair{clusterToTrackIndexMap, trackToClusterIndexMap};
-              std::vector<int64_t> trackGlobalIndex;
-              doTrackMatching<collEventSels::filtered_iterator>(col, tracks, IndexMapPair, vertex_pos, trackGlobalIndex);
-
-              // Store the clusters in the table where a matching collision could
-              // be identified.
-              FillClusterTable<collEventSels::filtered_iterator>(col, vertex_pos, iClusterizer, cellIndicesBC, IndexMapPair, trackGlobalIndex);
-            }
-          }
-        } else { // ambiguous
-          // LOG(warning) << "No vertex found for event. Assuming (0,0,0).";
-          bool hasCollision = false;
-          mHistManager.fill(HIST("hCollPerBC"), collisionsInFoundBC.size());
-          if (collisionsInFoundBC.size() == 0) {
-            mHistManager.fill(HIST("hCollisionType"), 0);
-          } else {
-            hasCollision = true;
-            mHistManager.fill(HIST("hCollisionType"), 2);
-          }
-          FillAmbigousClusterTable<bcEvSels::iterator>(bc, iClusterizer, cellIndicesBC, hasCollision);
-        }
+        fillBCClusterTables(bc, collisionsInFoundBC, tracks, iClusterizer, cellIndicesBC);
 
         LOG(debug) << "Cluster loop done for clusterizer " << iClusterizer;
       } // end of clusterizer loop
@@ -318,22 +302,85 @@ struct EmcalCorrectionTask {
       nBCsProcessed++;
     } // end of bc loop
 
-    // Loop through all collisions and fill emcalcollisionmatch with a boolean stating, whether the collision was ambiguous (not the only collision in its BC)
-    for (const auto& collision : collisions) {
-      auto globalbcid = collision.foundBC_as<bcEvSels>().globalIndex();
-      auto foundColls = numberCollsInBC.find(globalbcid);
-      auto foundCells = numberCellsInBC.find(globalbcid);
-      if (foundColls != numberCollsInBC.end() && foundCells != numberCellsInBC.end()) {
-        emcalcollisionmatch(collision.globalIndex(), foundColls->second != 1, foundCells->second > 0);
-      } else {
-        LOG(warning) << "BC not found in map of number of collisions.";
-      }
-    } // end of collision loop
+    fillCollisionMatchTable(collisions, numberCollsInBC, numberCellsInBC);
 
     LOG(detail) << "Processed " << nBCsProcessed << " BCs with " << nCellsProcessed << " cells";
   }
   PROCESS_SWITCH(EmcalCorrectionTask, processFull, "run full analysis", true);
 
+  // Same as processFull, with the BCs of the dataframe clusterized in parallel.
+  // The cells are grouped by BC first, the BCs are then clusterized by the threads, each with its own clusterizers,
+  // and the clusters are corrected, matched to the tracks and stored in BC order as in processFull.
+  void processFullParallel(bcEvSels const& bcs, collEventSels const& collisions, myGlobTracks const& tracks, filteredCells const& cells)
+  {
+    LOG(debug) << "Starting process full parallel.";
+
+    int nCellsProcessed = 0;
+    std::unordered_map<uint64_t, int> numberCollsInBC; // Number of collisions mapped to the global BC index of all BCs
+    std::unordered_map<uint64_t, int> numberCellsInBC; // Number of cells mapped to the global BC index of all BCs to check whether EMCal was readout
+    std::vector<bcEvSels::iterator> bcsWithCells;
+    mBCClusterizations.clear();
+    for (auto bc : bcs) {
+      auto collisionsInFoundBC = collisions.sliceBy(collisionsPerFoundBC, bc.globalIndex());
+      auto cellsInBC = cells.sliceBy(cellsPerFoundBC, bc.globalIndex());
+
+      numberCollsInBC.insert(std::pair<uint64_t, int>(bc.globalIndex(), collisionsInFoundBC.size()));
+      numberCellsInBC.insert(std::pair<uint64_t, int>(bc.globalIndex(), cellsInBC.size()));
+
+      if (!cellsInBC.size()) {
+        countBC(collisionsInFoundBC.size(), false);
+        continue;
+      }
+      countBC(collisionsInFoundBC.size(), true);
+      bcsWithCells.push_back(bc);
+      auto& bcClusterization = mBCClusterizations.emplace_back();
+      convertCells(cellsInBC, bcClusterization.cells, bcClusterization.cellIndices);
+      nCellsProcessed += bcClusterization.cells.size();
+      fillQAHistogram(bcClusterization.cells);
+    } // end of bc loop
+
+    // clusterization, the BCs are distributed dynamically as their numbers of cells vary a lot
+    const int nBCs = mBCClusterizations.size();
+    const int nThreads = std::clamp(nBCs / std::max(static_cast<int>(minBCsPerThread), 1), 1, static_cast<int>(mClusterizerWorkers.size()) + 1);
+    std::atomic<int> nextBC{0};
+    auto clusterizeBCs = [&](int iThread) {
+      auto& clusterizers = iThread == 0 ? mClusterizers : mClusterizerWorkers[iThread - 1];
+      auto& clusterFactory = iThread == 0 ? mClusterFactories : mClusterFactoryWorkers[iThread - 1];
+      std::vector<o2::emcal::ClusterLabel> clusterLabels;
+      for (int iBC = nextBC++; iBC < nBCs; iBC = nextBC++) {
+        auto& bcClusterization = mBCClusterizations[iBC];
+        bcClusterization.clusters.resize(clusterizers.size());
+        for (size_t iClusterizer = 0; iClusterizer < clusterizers.size(); iClusterizer++) {
+          clusterizeCells(*clusterizers[iClusterizer], clusterFactory, bcClusterization.cells, bcClusterization.clusters[iClusterizer], clusterLabels);
+        }
+      }
+    };
+    std::vector<std::thread> threads;
+    for (int iThread = 1; iThread < nThreads; ++iThread) {
+      threads.emplace_back(clusterizeBCs, iThread);
+    }
+    clusterizeBCs(0);
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    mClusterLabels.clear();
+    for (int iBC = 0; iBC < nBCs; iBC++) {
+      const auto& bc = bcsWithCells[iBC];
+      auto collisionsInFoundBC = collisions.sliceBy(collisionsPerFoundBC, bc.globalIndex());
+      auto& bcClusterization = mBCClusterizations[iBC];
+      for (size_t iClusterizer = 0; iClusterizer < mClusterizers.size(); iClusterizer++) {
+        mAnalysisClusters.swap(bcClusterization.clusters[iClusterizer]);
+        fillBCClusterTables(bc, collisionsInFoundBC, tracks, iClusterizer, bcClusterization.cellIndices);
+      }
+    }
+
+    fillCollisionMatchTable(collisions, numberCollsInBC, numberCellsInBC);
+
+    LOG(detail) << "Processed " << nBCs << " BCs with cells, " << nCellsProcessed << " cells, with " << nThreads << " threads";
+  }
+  PROCESS_SWITCH(EmcalCorrectionTask, processFullParallel, "run full analysis, with the BCs of a dataframe clusterized in parallel", false);
+
   void processMCFull(bcEvSels const& bcs, collEventSels const& collisions, myGlobTracks const& tracks, filteredMCCells const& cells, aod::StoredMcParticles_001 const&)
   {
     LOG(debug) << "Starting process full.";
@@ -536,37 +583,130 @@ struct EmcalCorrectionTask {
 
   void cellsToCluster(size_t iClusterizer, const gsl::span<o2::emcal::Cell> cellsBC, std::optional<const gsl::span<o2::emcal::CellLabel>> cellLabels = std::nullopt)
   {
-    mClusterizers.at(iClusterizer)->findClusters(cellsBC);
+    clusterizeCells(*mClusterizers.at(iClusterizer), mClusterFactories, cellsBC, mAnalysisClusters, mClusterLabels, cellLabels);
+  }
+
+  // Clusterizes the cells of a BC and converts the clusters to analysis clusters.
+  // It only uses the given clusterizer and cluster factory, such that it can run in the threads of processFullParallel.
+  static void clusterizeCells(o2::emcal::Clusterizer<o2::emcal::Cell>& clusterizer, o2::emcal::ClusterFactory<o2::emcal::Cell>& clusterFactory, const gsl::span<o2::emcal::Cell> cellsBC, std::vector<o2::emcal::AnalysisCluster>& analysisClusters, std::vector<o2::emcal::ClusterLabel>& clusterLabels, std::optional<const gsl::span<o2::emcal::CellLabel>> cellLabels = std::nullopt)
+  {
+    clusterizer.findClusters(cellsBC);
 
-    auto emcalClusters = mClusterizers.at(iClusterizer)->getFoundClusters();
-    auto emcalClustersInputIndices = mClusterizers.at(iClusterizer)->getFoundClustersInputIndices();
+    auto emcalClusters = clusterizer.getFoundClusters();
+    auto emcalClustersInputIndices = clusterizer.getFoundClustersInputIndices();
     LOG(debug) << "Retrieved results. About to setup cluster factory.";
 
     // Convert to analysis clusters.
     // First, the cluster factory requires cluster and cell information in order
     // to build the clusters.
-    mAnalysisClusters.clear();
-    mClusterLabels.clear();
-    mClusterFactories.reset();
+    analysisClusters.clear();
+    clusterLabels.clear();
+    clusterFactory.reset();
     if (cellLabels) {
-      mClusterFactories.setContainer(*emcalClusters, cellsBC, *emcalClustersInputIndices, cellLabels);
+      clusterFactory.setContainer(*emcalClusters, cellsBC, *emcalClustersInputIndices, cellLabels);
     } else {
-      mClusterFactories.setContainer(*emcalClusters, cellsBC, *emcalClustersInputIndices);
+      clusterFactory.setContainer(*emcalClusters, cellsBC, *emcalClustersInputIndices);
     }
 
     LOG(debug) << "Cluster factory set up.";
     // Convert to analysis clusters.
-    for (int icl = 0; icl < mClusterFactories.getNumberOfClusters(); icl++) {
+    for (int icl = 0; icl < clusterFactory.getNumberOfClusters(); icl++) {
       o2::emcal::ClusterLabel clusterLabel;
-      auto analysisCluster = mClusterFactories.buildCluster(icl, &clusterLabel);
-      mAnalysisClusters.emplace_back(analysisCluster);
-      mClusterLabels.push_back(clusterLabel);
+      auto analysisCluster = clusterFactory.buildCluster(icl, &clusterLabel);
+      analysisClusters.emplace_back(analysisCluster);
+      clusterLabels.push_back(clusterLabel);
       LOG(debug) << "Cluster " << icl << ": E: " << analysisCluster.E()
                  << ", NCells " << analysisCluster.getNCells();
     }
     LOG(debug) << "Converted to analysis clusters.";
   }
 
+  void setupClusterFactory(o2::emcal::ClusterFactory<o2::emcal::Cell>& clusterFactory, o2::emcal::Geometry* geometry)
+  {
+    clusterFactory.setGeometry(geometry);
+    clusterFactory.SetECALogWeight(logWeight);
+    clusterFactory.setExoticCellFraction(exoticCellFraction);
+    clusterFactory.setExoticCellDiffTime(exoticCellDiffTime);
+    clusterFactory.setExoticCellMinAmplitude(exoticCellMinAmplitude);
+    clusterFactory.setExoticCellInCrossMinAmplitude(exoticCellInCrossMinAmplitude);
+    clusterFactory.setUseWeightExotic(useWeightExotic);
+  }
+
+  // Converts the cells of a BC to o2::emcal::Cell, applying the cell-level corrections
+  template <typename Cells>
+  void convertCells(Cells const& cellsInBC, std::vector<o2::emcal::Cell>& cellsBC, std::vector<int64_t>& cellIndicesBC)
+  {
+    cellsBC.reserve(cellsInBC.size());
+    cellIndicesBC.reserve(cellsInBC.size());
+    for (auto& cell : cellsInBC) {
+      auto amplitude = cell.amplitude();
+      if (static_cast<bool>(hasShaperCorrection)) {
+        amplitude = o2::emcal::NonlinearityHandler::evaluateShaperCorrectionCellEnergy(amplitude);
+      }
+      if (applyCellAbsScale) {
+        amplitude *= GetAbsCellScale(cell.cellNumber());
+      }
+      cellsBC.emplace_back(cell.cellNumber(),
+                           amplitude,
+                           cell.time(),
+                           o2::emcal::intToChannelType(cell.cellType()));
+      cellIndicesBC.emplace_back(cell.globalIndex());
+    }
+  }
+
+  // Stores the clusters in mAnalysisClusters of a BC, in the cluster table with track matching if the BC has exactly
+  // one collision and in the ambiguous cluster table otherwise
+  template <typename Collisions>
+  void fillBCClusterTables(bcEvSels::iterator const& bc, Collisions const& collisionsInFoundBC, myGlobTracks const& tracks, size_t iClusterizer, const gsl::span<int64_t> cellIndicesBC)
+  {
+    if (collisionsInFoundBC.size() == 1) {
+      // dummy loop to get the first collision
+      for (const auto& col : collisionsInFoundBC) {
+        if (col.foundBCId() == bc.globalIndex()) {
+          mHistManager.fill(HIST("hCollPerBC"), 1);
+          mHistManager.fill(HIST("hCollisionType"), 1);
+          math_utils::Point3D<float> vertex_pos = {col.posX(), col.posY(), col.posZ()};
+
+          std::vector<std::vector<int>> clusterToTrackIndexMap;
+          std::vector<std::vector<int>> trackToClusterIndexMap;
+          std::tuple<std::vector<std::vector<int>>, std::vector<std::vector<int>>> IndexMapPair{clusterToTrackIndexMap, trackToClusterIndexMap};
+          std::vector<int64_t> trackGlobalIndex;
+          doTrackMatching<collEventSels::filtered_iterator>(col, tracks, IndexMapPair, vertex_pos, trackGlobalIndex);
+
+          // Store the clusters in the table where a matching collision could
+          // be identified.
+          FillClusterTable<collEventSels::filtered_iterator>(col, vertex_pos, iClusterizer, cellIndicesBC, IndexMapPair, trackGlobalIndex);
+        }
+      }
+    } else { // ambiguous
+      // LOG(warning) << "No vertex found for event. Assuming (0,0,0).";
+      bool hasCollision = false;
+      mHistManager.fill(HIST("hCollPerBC"), collisionsInFoundBC.size());
+      if (collisionsInFoundBC.size() == 0) {
+        mHistManager.fill(HIST("hCollisionType"), 0);
+      } else {
+        hasCollision = true;
+        mHistManager.fill(HIST("hCollisionType"), 2);
+      }
+      FillAmbigousClusterTable<bcEvSels::iterator>(bc, iClusterizer, cellIndicesBC, hasCollision);
+    }
+  }
+
+  // Loop through all collisions and fill emcalcollisionmatch with a boolean stating, whether the collision was ambiguous (not the only collision in its BC)
+  void fillCollisionMatchTable(collEventSels const& collisions, std::unordered_map<uint64_t, int> const& numberCollsInBC, std::unordered_map<uint64_t, int> const& numberCellsInBC)
+  {
+    for (const auto& collision : collisions) {
+      auto globalbcid = collision.foundBC_as<bcEvSels>().globalIndex();
+      auto foundColls = numberCollsInBC.find(globalbcid);
+      auto foundCells = numberCellsInBC.find(globalbcid);
+      if (foundColls != numberCollsInBC.end() && foundCells != numberCellsInBC.end()) {
+        emcalcollisionmatch(collision.globalIndex(), foundColls->second != 1, foundCells->second > 0);
+      } else {
+        LOG(warning) << "BC not found in map of number of collisions.";
+      }
+    } // end of collision loop
+  }
+
   template <typename Collision>
   void FillClusterTable(Collision const& col, math_utils::Point3D<float> const& vertex_pos, size_t iClusterizer, const gsl::span<int64_t> cellIndicesBC, std::optional<std::tuple<std::vector<std::vector<int>>, std::vector<std::vector<int>>>> const& IndexMapPair = std::nullopt, std::optional<std::vector<int64_t>> const& trackGlobalIndex = std::nullopt)
   {
@@ -703,10 +843,17 @@ struct EmcalCorrectionTask {
       clusterPhi.emplace_back(TVector2::Phi_0_2pi(pos.Phi()));
       clusterEta.emplace_back(pos.Eta());
     }
-    IndexMapPair =
-      jetutilities::MatchClustersAndTracks(clusterPhi, clusterEta,
-                                           trackPhi, trackEta,
-                                           maxMatchingDistance, 20);
+    if (useGridTrackMatching) {
+      IndexMapPair =
+        jetutilities::MatchClustersAndTracksGrid(clusterPhi, clusterEta,
+                                                 trackPhi, trackEta,
+                                                 maxMatchingDistance, 20);
+    } else {
+      IndexMapPair =
+        jetutilities::MatchClustersAndTracks(clusterPhi, clusterEta,
+                                             trackPhi, trackEta,
+                                             maxMatchingDistance, 20);
+    }
   }
 
   template <typename Tracks>
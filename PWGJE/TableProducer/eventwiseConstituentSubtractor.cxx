@@ -47,6 +47,7 @@ struct eventWiseConstituentSubtractorTask {
   Configurable<float> rMax{"rMax", 0.24, "maximum distance of subtraction"};
   Configurable<float> eventEtaMax{"eventEtaMax", 0.9, "maximum pseudorapidity of event"};
   Configurable<bool> doRhoMassSub{"doRhoMassSub", true, "perfom mass subtraction as well"};
+  Configurable<bool> doLocalPairing{"doLocalPairing", false, "pair each track only with the ghosts within rMax, enumerated from the ghost grid, instead of all the ghosts of the event"};
 
   JetBkgSubUtils eventWiseConstituentSubtractor;
   float bkgPhiMax_;
@@ -82,7 +83,7 @@ struct eventWiseConstituentSubtractorTask {
       tracksSubtracted.clear();
       jetfindingutilities::analyseTracks(inputParticles, tracks, trackSelection, std::optional{candidate});
 
-      tracksSubtracted = eventWiseConstituentSubtractor.JetBkgSubUtils::doEventConstSub(inputParticles, bkgRho.rho(), bkgRho.rhoM());
+      tracksSubtracted = doLocalPairing ? eventWiseConstituentSubtractor.JetBkgSubUtils::doEventConstSubLocal(inputParticles, bkgRho.rho(), bkgRho.rhoM()) : eventWiseConstituentSubtractor.JetBkgSubUtils::doEventConstSub(inputParticles, bkgRho.rho(), bkgRho.rhoM());
       for (auto const& trackSubtracted : tracksSubtracted) {
 
         trackSubtractedTable(candidate.globalIndex(), trackSubtracted.pt(), trackSubtracted.eta(), trackSubtracted.phi(), trackSubtracted.E(), jetderiveddatautilities::setSingleTrackSelectionBit(trackSelection));
@@ -97,7 +98,7 @@ struct eventWiseConstituentSubtractorTask {
     tracksSubtracted.clear();
     jetfindingutilities::analyseTracks<soa::Filtered<JetTracks>, soa::Filtered<JetTracks>::iterator>(inputParticles, tracks, trackSelection);
 
-    tracksSubtracted = eventWiseConstituentSubtractor.JetBkgSubUtils::doEventConstSub(inputParticles, collision.rho(), collision.rhoM());
+    tracksSubtracted = doLocalPairing ? eventWiseConstituentSubtractor.JetBkgSubUtils::doEventConstSubLocal(inputParticles, collision.rho(), collision.rhoM()) : eventWiseConstituentSubtractor.JetBkgSubUtils::doEventConstSub(inputParticles, collision.rho(), collision.rhoM());
 
     for (auto const& trackSubtracted : tracksSubtracted) {
       trackSubtractedTable(collision.globalIndex(), trackSubtracted.pt(), trackSubtracted.eta(), trackSubtracted.phi(), trackSubtracted.E(), jetderiveddatautilities::setSingleTrackSelectionBit(trackSelection));
@@ -121,6 +121,14 @@ struct JetDerivedDataWriter {
   std::vector<bool> McCollisionFlag;
   std::vector<int> bcIndicies;
 
+  // stored row of each row of the dataframe, -1 if the row is not stored (processDataWholeTables)
+  std::vector<int32_t> storedCollisionIndices;
+  std::vector<int32_t> storedBCIndices;
+  std::vector<int32_t> storedTrackIndices;
+  std::vector<int32_t> storedD0CollisionIndices; // stored D0 collision of each collision
+  std::vector<int32_t> storedLcCollisionIndices; // stored Lc collision of each collision
+  std::vector<int32_t> trackCollisionIndices;    // collision of each track
+
   uint32_t precisionPositionMask;
   uint32_t precisionMomentumMask;
 
@@ -362,6 +370,131 @@ struct JetDerivedDataWriter {
   // to run after all jet selections
   PROCESS_SWITCH(JetDerivedDataWriter, processData, "write out data output tables", false);
 
+  // stored index of a track of the given collision, -1 if it is not stored
+  int32_t getStoredTrackIndex(int32_t trackIndex, int32_t collisionIndex)
+  {
+    if (trackIndex < 0 || trackIndex >= static_cast<int32_t>(storedTrackIndices.size()) || trackCollisionIndices[trackIndex] != collisionIndex) {
+      return -1;
+    }
+    return storedTrackIndices[trackIndex];
+  }
+
+  // writes the same tables as processData, looping once over each table of the dataframe instead of over the rows grouped per collision
+  // the indices are remapped with lookup tables of the stored rows, filled in the order in which the rows are stored
+  void processDataWholeTables(soa::Join<aod::JCollisions, aod::JCollisionPIs, aod::JCollisionBCs, aod::JChTrigSels, aod::JFullTrigSels, aod::JChHFTrigSels> const& collisions, soa::Join<aod::JBCs, aod::JBCPIs> const& bcs, soa::Join<aod::JTracks, aod::JTrackExtras, aod::JTrackPIs> const& tracks, soa::Join<aod::JClusters, aod::JClusterPIs, aod::JClusterTracks> const& clusters, CollisionsD0 const& D0Collisions, CandidatesD0Data const& D0s, CollisionsLc const& LcCollisions, CandidatesLcData const& Lcs)
+  {
+    auto isStoredCollision = [&](int32_t collisionIndex) {
+      return collisionIndex >= 0 && collisionFlag[collisionIndex];
+    };
+
+    storedCollisionIndices.assign(collisions.size(), -1);
+    storedBCIndices.assign(bcs.size(), -1);
+    for (const auto& collision : collisions) {
+      if (!collisionFlag[collision.globalIndex()]) {
+        continue;
+      }
+      int32_t storedBCID = -1;
+      if (saveBCsTable) {
+        storedBCID = storedBCIndices[collision.bcId()];
+        if (storedBCID < 0) {
+          auto bc = collision.bc_as<soa::Join<aod::JBCs, aod::JBCPIs>>();
+          storedJBCsTable(bc.runNumber(), bc.globalBC(), bc.timestamp());
+          storedJBCParentIndexTable(bc.bcId());
+          storedBCID = storedJBCsTable.lastIndex();
+          storedBCIndices[collision.bcId()] = storedBCID;
+        }
+      }
+      storedJCollisionsTable(collision.posX(), collision.posY(), collision.posZ(), collision.multiplicity(), collision.centrality(), collision.eventSel(), collision.alias_raw());
+      storedJCollisionsParentIndexTable(collision.collisionId());
+      if (saveBCsTable) {
+        storedJCollisionsBunchCrossingIndexTable(storedBCID);
+      }
+      storedJChargedTriggerSelsTable(collision.chargedTriggerSel());
+      storedJFullTriggerSelsTable(collision.fullTriggerSel());
+      storedJChargedHFTriggerSelsTable(collision.chargedHFTriggerSel());
+      storedCollisionIndices[collision.globalIndex()] = storedJCollisionsTable.lastIndex();
+    }
+
+    storedTrackIndices.assign(tracks.size(), -1);
+    trackCollisionIndices.assign(tracks.size(), -1);
+    for (const auto& track : tracks) {
+      trackCollisionIndices[track.globalIndex()] = track.collisionId();
+      if (!isStoredCollision(track.collisionId())) {
+        continue;
+      }
+      if (performTrackSelection && !(track.trackSel() & ~(1 << jetderiveddatautilities::JTrackSel::trackSign))) { // skips tracks that pass no selections. This might cause a problem with tracks matched with clusters. We should generate a track selection purely for cluster matched tracks so that they are kept
+        continue;
+      }
+      storedJTracksTable(storedCollisionIndices[track.collisionId()], o2::math_utils::detail::truncateFloatFraction(track.pt(), precisionMomentumMask), o2::math_utils::detail::truncateFloatFraction(track.eta(), precisionPositionMask), o2::math_utils::detail::truncateFloatFraction(track.phi(), precisionPositionMask), track.trackSel());
+      storedJTracksExtraTable(o2::math_utils::detail::truncateFloatFraction(track.dcaXY(), precisionPositionMask), o2::math_utils::detail::truncateFloatFraction(track.dcaZ(), precisionPositionMask), o2::math_utils::detail::truncateFloatFraction(track.sigma1Pt(), precisionMomentumMask));
+      storedJTracksParentIndexTable(track.trackId());
+      storedTrackIndices[track.globalIndex()] = storedJTracksTable.lastIndex();
+    }
+
+    if (saveClustersTable) {
+      std::vector<int> clusterStoredJTrackIDs;
+      for (const auto& cluster : clusters) {
+        if (!isStoredCollision(cluster.collisionId())) {
+          continue;
+        }
+        storedJClustersTable(storedCollisionIndices[cluster.collisionId()], cluster.id(), cluster.energy(), cluster.coreEnergy(), cluster.rawEnergy(),
+                             cluster.eta(), cluster.phi(), cluster.m02(), cluster.m20(), cluster.nCells(), cluster.time(), cluster.isExotic(), cluster.distanceToBadChannel(),
+                             cluster.nlm(), cluster.definition(), cluster.leadingCellEnergy(), cluster.subleadingCellEnergy(), cluster.leadingCellNumber(), cluster.subleadingCellNumber());
+        storedJClustersParentIndexTable(cluster.clusterId());
+
+        clusterStoredJTrackIDs.clear();
+        for (const auto& clusterTrackId : cluster.matchedTracksIds()) {
+          auto storedTrackIndex = getStoredTrackIndex(clusterTrackId, cluster.collisionId());
+          if (storedTrackIndex >= 0) {
+            clusterStoredJTrackIDs.push_back(storedTrackIndex);
+          }
+        }
+        storedJClustersMatchedTracksTable(clusterStoredJTrackIDs);
+      }
+    }
+
+    if (saveD0Table) {
+      storedD0CollisionIndices.assign(collisions.size(), -1);
+      for (const auto& D0Collision : D0Collisions) {
+        if (!isStoredCollision(D0Collision.collisionId())) {
+          continue;
+        }
+        jethfutilities::fillD0CollisionTable(D0Collision, storedD0CollisionsTable, storedD0CollisionIndices[D0Collision.collisionId()]);
+        storedD0CollisionIdsTable(storedCollisionIndices[D0Collision.collisionId()]);
+      }
+      for (const auto& D0 : D0s) {
+        if (!isStoredCollision(D0.collisionId())) {
+          continue;
+        }
+        int32_t D0Index = -1;
+        jethfutilities::fillD0CandidateTable<false>(D0, storedD0CollisionIndices[D0.collisionId()], storedD0sTable, storedD0ParsTable, storedD0ParExtrasTable, storedD0SelsTable, storedD0MlsTable, storedD0McsTable, D0Index);
+        storedD0IdsTable(storedCollisionIndices[D0.collisionId()], getStoredTrackIndex(D0.prong0Id(), D0.collisionId()), getStoredTrackIndex(D0.prong1Id(), D0.collisionId()));
+      }
+    }
+
+    if (saveLcTable) {
+      storedLcCollisionIndices.assign(collisions.size(), -1);
+      for (const auto& LcCollision : LcCollisions) {
+        if (!isStoredCollision(LcCollision.collisionId())) {
+          continue;
+        }
+        jethfutilities::fillLcCollisionTable(LcCollision, storedLcCollisionsTable, storedLcCollisionIndices[LcCollision.collisionId()]);
+        storedLcCollisionIdsTable(storedCollisionIndices[LcCollision.collisionId()]);
+      }
+      for (const auto& Lc : Lcs) {
+        if (!isStoredCollision(Lc.collisionId())) {
+          continue;
+        }
+        int32_t LcIndex = -1;
+        jethfutilities::fillLcCandidateTable<false>(Lc, storedLcCollisionIndices[Lc.collisionId()], storedLcsTable, storedLcParsTable, storedLcParExtrasTable, storedLcSelsTable, storedLcMlsTable, storedLcMcsTable, LcIndex);
+        storedLcIdsTable(storedCollisionIndices[Lc.collisionId()], getStoredTrackIndex(Lc.prong0Id(), Lc.collisionId()), getStoredTrackIndex(Lc.prong1Id(), Lc.collisionId()), getStoredTrackIndex(Lc.prong2Id(), Lc.collisionId()));
+      }
+    }
+  }
+  // process switch for output writing must be last
+  // to run after all jet selections
+  PROCESS_SWITCH(JetDerivedDataWriter, processDataWholeTables, "write out data output tables, looping over the whole tables of the dataframe", false);
+
   void processMC(soa::Join<aod::JMcCollisions, aod::JMcCollisionPIs> const& mcCollisions, soa::Join<aod::JCollisions, aod::JCollisionPIs, aod::JCollisionBCs, aod::JChTrigSels, aod::JFullTrigSels, aod::JChHFTrigSels, aod::JMcCollisionLbs> const& collisions, soa::Join<aod::JBCs, aod::JBCPIs> const&, soa::Join<aod::JTracks, aod::JTrackExtras, aod::JTrackPIs, aod::JMcTrackLbs> const& tracks, soa::Join<aod::JClusters, aod::JClusterPIs, aod::JClusterTracks, aod::JMcClusterLbs> const& clusters, soa::Join<aod::JMcParticles, aod::JMcParticlePIs> const& particles, CollisionsD0 const& D0Collisions, CandidatesD0MCD const& D0s, soa::Join<McCollisionsD0, aod::HfD0McRCollIds> const& D0McCollisions, CandidatesD0MCP const& D0Particles, CollisionsLc const& LcCollisions, CandidatesLcMCD const& Lcs, soa::Join<McCollisionsLc, aod::Hf3PMcRCollIds> const& LcMcCollisions, CandidatesLcMCP const& LcParticles)
   {
     std::map<int32_t, int32_t> bcMapping;
@@ -14,15 +14,22 @@
 /// \author Nima Zardoshti <nima.zardoshti@cern.ch>
 /// \author Hanseo Park <hanseo.park@cern.ch>
 
+#include <array>
+#include <map>
+#include <string>
+#include <vector>
+
 #include <TF1.h>
 #include <TH1.h>
 
+#include "CCDB/CcdbApi.h"
 #include "Framework/AnalysisTask.h"
 #include "Framework/AnalysisDataModel.h"
 #include "Framework/ASoA.h"
 #include "Framework/O2DatabasePDGPlugin.h"
 #include "Framework/runDataProcessing.h"
 #include "Common/Core/trackUtilities.h"
+#include "Tools/ML/model.h"
 
 #include "PWGJE/DataModel/Jet.h"
 #include "PWGJE/DataModel/JetTagging.h"
@@ -32,12 +39,15 @@
 using namespace o2;
 using namespace o2::framework;
 using namespace o2::framework::expressions;
+using namespace o2::ml;
 
-template <typename JetTableData, typename JetTableMCD, typename JetTaggingTableData, typename JetTaggingTableMCD>
+template <typename JetTableData, typename JetTableMCD, typename JetTaggingTableData, typename JetTaggingTableMCD, typename JetMLTaggingTableData, typename JetMLTaggingTableMCD>
 struct JetTaggerHFTask {
 
   Produces<JetTaggingTableData> taggingTableData;
   Produces<JetTaggingTableMCD> taggingTableMCD;
+  Produces<JetMLTaggingTableData> mlTaggingTableData;
+  Produces<JetMLTaggingTableMCD> mlTaggingTableMCD;
 
   Configurable<float> maxDeltaR{"maxDeltaR", 0.25, "maximum distance of jet axis from flavour initiating parton"};
   Configurable<bool> removeGluonShower{"removeGluonShower", true, "find jet origin removed gluon spliting"}; // true:: remove gluon spliting
@@ -54,6 +64,15 @@ struct JetTaggerHFTask {
   Configurable<float> minSignImpXYSig{"minsIPs", -40.0, "minimum of signed impact parameter significance"};
   Configurable<float> tagPoint{"tagPoint", 2.5, "tagging working point"};
 
+  // ML tagging, all the jets of a dataframe are scored with one model evaluation
+  Configurable<int> nTracksML{"nTracksML", 3, "number of constituents with the largest signed IP significance in the ML features"};
+  Configurable<int> scoreIndexML{"scoreIndexML", 1, "index of the model output stored as ML score (e.g. b-jet probability)"};
+  Configurable<std::string> onnxFileML{"onnxFileML", "model_jettagging.onnx", "ONNX file of the ML model"};
+  Configurable<std::string> ccdbUrl{"ccdbUrl", "http://alice-ccdb.cern.ch", "url of the ccdb repository"};
+  Configurable<std::string> mlModelPathCCDB{"mlModelPathCCDB", "Analysis/PWGJE/ML/HFJetTagging", "Path on CCDB of the ML model"};
+  Configurable<int64_t> timestampCCDB{"timestampCCDB", -1, "timestamp of the ONNX file for ML model used to query in CCDB"};
+  Configurable<bool> loadModelsFromCCDB{"loadModelsFromCCDB", false, "Flag to enable or disable the loading of the ML model from CCDB"};
+
   ConfigurableAxis binTrackProbability{"binTrackProbability", {100, 0.f, 1.f}, ""};
   ConfigurableAxis binJetFlavour{"binJetFlavour", {6, -0.5, 5.5}, ""};
 
@@ -77,6 +96,13 @@ struct JetTaggerHFTask {
   std::unique_ptr<TF1> fSignImpXYSigBeautyJetMC = nullptr;
   std::unique_ptr<TF1> fSignImpXYSigLfJetMC = nullptr;
 
+  o2::ccdb::CcdbApi ccdbApi;
+  OnnxModel model;
+  int nFeaturesML = 0;
+  int nScoresML = 0;
+  std::vector<float> featuresML;                     // one row of features per jet of the dataframe
+  std::vector<std::array<float, 4>> trackFeaturesML; // constituent features of the current jet
+
   HistogramRegistry registry{"registry", {}, OutputObjHandlingPolicy::AnalysisObject};
   void init(InitContext const&)
   {
@@ -142,6 +168,42 @@ struct JetTaggerHFTask {
       registry.add("h2_pos_track_probability_flavour", "positive track probability", {HistType::kTH2F, {{trackProbabilityAxis}, {jetFlavourAxis}}});
       registry.add("h2_neg_track_probability_flavour", "negative track probability", {HistType::kTH2F, {{trackProbabilityAxis}, {jetFlavourAxis}}});
     }
+
+    if (doprocessDataML || doprocessMCDML) {
+      if (loadModelsFromCCDB) {
+        ccdbApi.init(ccdbUrl);
+        std::map<std::string, std::string> metadata;
+        if (!ccdbApi.retrieveBlob(mlModelPathCCDB.value, ".", metadata, timestampCCDB.value, false, onnxFileML.value)) {
+          LOG(fatal) << "Error encountered while fetching the ML model " << mlModelPathCCDB.value << " from CCDB!";
+        }
+        auto headers = ccdbApi.retrieveHeaders(mlModelPathCCDB.value, metadata, timestampCCDB.value);
+        model.initModel(onnxFileML.value, false, 1, strtoul(headers["Valid-From"].c_str(), NULL, 0), strtoul(headers["Valid-Until"].c_str(), NULL, 0));
+      } else {
+        model.initModel(onnxFileML.value, false, 1);
+      }
+      nFeaturesML = jettaggingutilities::getNumMLFeatures(nTracksML);
+      nScoresML = model.getNumOutputNodes();
+      if (model.getNumInputNodes() != nFeaturesML) {
+        LOG(fatal) << "ML model with " << model.getNumInputNodes() << " features, " << nFeaturesML << " expected for nTracksML = " << nTracksML << ". Fix it!";
+      }
+      if (scoreIndexML < 0 || scoreIndexML >= nScoresML) {
+        LOG(fatal) << "scoreIndexML = " << scoreIndexML << " out of the " << nScoresML << " model outputs. Fix it!";
+      }
+    }
+  }
+
+  /// Scores the feature matrix of all the jets with one model evaluation and fills one table row per jet
+  template <typename T>
+  void fillMLScores(T& table, int nJets)
+  {
+    table.reserve(nJets);
+    if (nJets == 0) {
+      return;
+    }
+    float* scores = model.evalModel(featuresML);
+    for (int i = 0; i < nJets; i++) {
+      table(scores != nullptr ? scores[i * nScoresML + scoreIndexML] : -1.f);
+    }
   }
 
   void processDummy(JetCollisions const&)
@@ -228,6 +290,28 @@ struct JetTaggerHFTask {
   }
   PROCESS_SWITCH(JetTaggerHFTask, processMCD, "Fill tagging decision for mcd jets", false);
 
+  void processDataML(JetCollisions const&, JetTableData const& jets, JetTagTracksData const& jtracks, OriTracksData const& tracks)
+  {
+    featuresML.clear();
+    featuresML.reserve(jets.size() * nFeaturesML);
+    for (auto const& jet : jets) {
+      jettaggingutilities::appendMLFeatures(jet.template collision_as<JetCollisions>(), jet, jtracks, tracks, nTracksML, featuresML, trackFeaturesML);
+    }
+    fillMLScores(mlTaggingTableData, jets.size());
+  }
+  PROCESS_SWITCH(JetTaggerHFTask, processDataML, "Fill ML tagging scores for data jets", false);
+
+  void processMCDML(JetCollisions const&, JetTableMCD const& mcdjets, JetTagTracksMCD const& jtracks, OriTracksMCD const& tracks)
+  {
+    featuresML.clear();
+    featuresML.reserve(mcdjets.size() * nFeaturesML);
+    for (auto const& mcdjet : mcdjets) {
+      jettaggingutilities::appendMLFeatures(mcdjet.template collision_as<JetCollisions>(), mcdjet, jtracks, tracks, nTracksML, featuresML, trackFeaturesML);
+    }
+    fillMLScores(mlTaggingTableMCD, mcdjets.size());
+  }
+  PROCESS_SWITCH(JetTaggerHFTask, processMCDML, "Fill ML tagging scores for mcd jets", false);
+
   void processTraining(JetCollision const& /*collision*/, JetTableMCD const& /*mcdjets*/, JetTagTracksMCD const& /*tracks*/)
   {
     // To create table for ML
@@ -253,8 +337,8 @@ struct JetTaggerHFExtTask {
   PROCESS_SWITCH(JetTaggerHFExtTask, processTracks, "produces derived track table for tagging", true);
 };
 
-using JetTaggerChargedJets = JetTaggerHFTask<soa::Join<aod::ChargedJets, aod::ChargedJetConstituents>, soa::Join<aod::ChargedMCDetectorLevelJets, aod::ChargedMCDetectorLevelJetConstituents>, aod::ChargedJetTags, aod::ChargedMCDetectorLevelJetTags>;
-using JetTaggerFullJets = JetTaggerHFTask<soa::Join<aod::FullJets, aod::FullJetConstituents>, soa::Join<aod::FullMCDetectorLevelJets, aod::FullMCDetectorLevelJetConstituents>, aod::FullJetTags, aod::FullMCDetectorLevelJetTags>;
+using JetTaggerChargedJets = JetTaggerHFTask<soa::Join<aod::ChargedJets, aod::ChargedJetConstituents>, soa::Join<aod::ChargedMCDetectorLevelJets, aod::ChargedMCDetectorLevelJetConstituents>, aod::ChargedJetTags, aod::ChargedMCDetectorLevelJetTags, aod::ChargedJetMLTags, aod::ChargedMCDetectorLevelJetMLTags>;
+using JetTaggerFullJets = JetTaggerHFTask<soa::Join<aod::FullJets, aod::FullJetConstituents>, soa::Join<aod::FullMCDetectorLevelJets, aod::FullMCDetectorLevelJetConstituents>, aod::FullJetTags, aod::FullMCDetectorLevelJetTags, aod::FullJetMLTags, aod::FullMCDetectorLevelJetMLTags>;
 // using JetTaggerNeutralJets = JetTaggerHFTask<soa::Join<aod::NeutralJets, aod::NeutralJetConstituents>,soa::Join<aod::NeutralMCDetectorLevelJets, aod::NeutralMCDetectorLevelJetConstituents>, aod::NeutralJetTags, aod::NeutralMCDetectorLevelJetTags>;
 
 WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
@@ -17,6 +17,7 @@
 #include "Framework/AnalysisDataModel.h"
 #include "Framework/ASoA.h"
 #include "Framework/O2DatabasePDGPlugin.h"
+#include "Framework/HistogramRegistry.h"
 
 #include "PWGJE/Core/FastJetUtilities.h"
 #include "PWGJE/Core/JetFindingUtilities.h"
@@ -49,11 +50,22 @@ struct RhoEstimatorTask {
   Configurable<float> bkgPhiMin{"bkgPhiMin", 0., "minimim phi for determining background density"};
   Configurable<float> bkgPhiMax{"bkgPhiMax", 99.0, "maximum phi for determining background density"};
   Configurable<bool> doSparse{"doSparse", false, "perfom sparse estimation"};
+  Configurable<bool> useGhostCache{"useGhostCache", false, "generate the ghosts once per collision with a seed from the collision index, identical to the jet finder with reuseGhosts"};
+  Configurable<float> ghostMaxRap{"ghostMaxRap", 0.9, "maximum rapidity of the cached ghosts"};
+  Configurable<float> ghostArea{"ghostArea", 0.005, "area of the cached ghosts"};
+  Configurable<int> rhoMethodCharged{"rhoMethodCharged", 0, "rho estimation of processChargedCollisions. 0 = kT area median, 1 = eta-phi grid median"};
+  Configurable<int> rhoMethodCandidates{"rhoMethodCandidates", 0, "rho estimation of the HF candidate process functions. 0 = kT area median, 1 = eta-phi grid median"};
+  Configurable<float> gridSpacing{"gridSpacing", 0.2, "eta-phi cell size of the grid median estimation"};
+  Configurable<int> gridQADownscale{"gridQADownscale", 0, "compare the grid and kT area median estimations every n-th estimation, 0 = off"};
+
+  HistogramRegistry registry;
 
   JetBkgSubUtils bkgSub;
+  JetGhostCache ghostCache;
   float bkgPhiMax_;
   std::vector<fastjet::PseudoJet> inputParticles;
   int trackSelection = -1;
+  int64_t nRhoEstimations = 0;
 
   void init(o2::framework::InitContext&)
   {
@@ -65,6 +77,36 @@ struct RhoEstimatorTask {
       bkgPhiMax_ = 2.0 * M_PI;
     }
     bkgSub.setPhiMinMax(bkgPhiMin, bkgPhiMax_);
+    bkgSub.setGridSpacing(gridSpacing);
+    ghostCache.setParams(ghostMaxRap, ghostArea);
+
+    if (gridQADownscale > 0) {
+      registry.add("hRhoGridVsKt", "grid vs kT area median #rho;#rho_{kT} (GeV/#it{c});#rho_{grid} (GeV/#it{c})", {HistType::kTH2F, {{200, 0., 200.}, {200, 0., 200.}}});
+      registry.add("hRhoMGridVsKt", "grid vs kT area median #rho_{m};#rho_{m,kT} (GeV/#it{c}^{2});#rho_{m,grid} (GeV/#it{c}^{2})", {HistType::kTH2F, {{100, 0., 10.}, {100, 0., 10.}}});
+    }
+  }
+
+  std::tuple<double, double> estimateRhoKt(uint64_t collisionIndex)
+  {
+    if (useGhostCache) {
+      return bkgSub.estimateRhoAreaMedian(inputParticles, doSparse, ghostCache, collisionIndex);
+    }
+    return bkgSub.estimateRhoAreaMedian(inputParticles, doSparse);
+  }
+
+  std::tuple<double, double> estimateRho(int rhoMethod, uint64_t collisionIndex)
+  {
+    if (gridQADownscale > 0 && nRhoEstimations++ % gridQADownscale == 0) {
+      auto rhoKt = estimateRhoKt(collisionIndex);
+      auto rhoGrid = bkgSub.estimateRhoGridMedian(inputParticles, doSparse);
+      registry.fill(HIST("hRhoGridVsKt"), std::get<0>(rhoKt), std::get<0>(rhoGrid));
+      registry.fill(HIST("hRhoMGridVsKt"), std::get<1>(rhoKt), std::get<1>(rhoGrid));
+      return rhoMethod == 1 ? rhoGrid : rhoKt;
+    }
+    if (rhoMethod == 1) {
+      return bkgSub.estimateRhoGridMedian(inputParticles, doSparse);
+    }
+    return estimateRhoKt(collisionIndex);
   }
 
   Filter trackCuts = (aod::jtrack::pt >= trackPtMin && aod::jtrack::pt < trackPtMax && aod::jtrack::eta > trackEtaMin && aod::jtrack::eta < trackEtaMax && aod::jtrack::phi >= trackPhiMin && aod::jtrack::phi <= trackPhiMax);
@@ -73,45 +115,45 @@ struct RhoEstimatorTask {
   {
     inputParticles.clear();
     jetfindingutilities::analyseTracks<soa::Filtered<JetTracks>, soa::Filtered<JetTracks>::iterator>(inputParticles, tracks, trackSelection);
-    auto [rho, rhoM] = bkgSub.estimateRhoAreaMedian(inputParticles, doSparse);
+    auto [rho, rhoM] = estimateRho(rhoMethodCharged, collision.globalIndex());
     rhoChargedTable(collision.globalIndex(), rho, rhoM);
   }
   PROCESS_SWITCH(RhoEstimatorTask, processChargedCollisions, "Fill rho tables for collisions using charged tracks", true);
 
-  void processD0Collisions(JetCollision const&, soa::Filtered<JetTracks> const& tracks, CandidatesD0Data const& candidates)
+  void processD0Collisions(JetCollision const& collision, soa::Filtered<JetTracks> const& tracks, CandidatesD0Data const& candidates)
   {
     inputParticles.clear();
     for (auto& candidate : candidates) {
       inputParticles.clear();
       jetfindingutilities::analyseTracks(inputParticles, tracks, trackSelection, std::optional{candidate});
 
-      auto [rho, rhoM] = bkgSub.estimateRhoAreaMedian(inputParticles, doSparse);
+      auto [rho, rhoM] = estimateRho(rhoMethodCandidates, collision.globalIndex());
       rhoD0Table(candidate.globalIndex(), rho, rhoM);
     }
   }
   PROCESS_SWITCH(RhoEstimatorTask, processD0Collisions, "Fill rho tables for collisions with D0 candidates", false);
 
-  void processLcCollisions(JetCollision const&, soa::Filtered<JetTracks> const& tracks, CandidatesLcData const& candidates)
+  void processLcCollisions(JetCollision const& collision, soa::Filtered<JetTracks> const& tracks, CandidatesLcData const& candidates)
   {
     inputParticles.clear();
     for (auto& candidate : candidates) {
       inputParticles.clear();
       jetfindingutilities::analyseTracks(inputParticles, tracks, trackSelection, std::optional{candidate});
 
-      auto [rho, rhoM] = bkgSub.estimateRhoAreaMedian(inputParticles, doSparse);
+      auto [rho, rhoM] = estimateRho(rhoMethodCandidates, collision.globalIndex());
       rhoLcTable(candidate.globalIndex(), rho, rhoM);
     }
   }
   PROCESS_SWITCH(RhoEstimatorTask, processLcCollisions, "Fill rho tables for collisions with Lc candidates", false);
 
-  void processBplusCollisions(JetCollision const&, soa::Filtered<JetTracks> const& tracks, CandidatesBplusData const& candidates)
+  void processBplusCollisions(JetCollision const& collision, soa::Filtered<JetTracks> const& tracks, CandidatesBplusData const& candidates)
   {
     inputParticles.clear();
     for (auto& candidate : candidates) {
       inputParticles.clear();
       jetfindingutilities::analyseTracks(inputParticles, tracks, trackSelection, std::optional{candidate});
 
-      auto [rho, rhoM] = bkgSub.estimateRhoAreaMedian(inputParticles, doSparse);
+      auto [rho, rhoM] = estimateRho(rhoMethodCandidates, collision.globalIndex());
       rhoBplusTable(candidate.globalIndex(), rho, rhoM);
     }
   }
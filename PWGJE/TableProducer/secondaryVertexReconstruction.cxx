@@ -13,7 +13,11 @@
 //
 /// \author Hadi Hassan <hadi.hassan@cern.ch>
 
+#include <algorithm>
+#include <array>
+#include <cmath>
 #include <type_traits>
+#include <vector>
 
 #include <TF1.h>
 #include <TH1.h>
@@ -66,6 +70,8 @@ struct SecondaryVertexReconstruction {
   Configurable<float> ptMinTrack{"ptMinTrack", -1., "min. track pT"};
   Configurable<float> etaMinTrack{"etaMinTrack", -99999., "min. pseudorapidity"};
   Configurable<float> etaMaxTrack{"etaMaxTrack", 4., "max. pseudorapidity"};
+  Configurable<float> minIPSigXYTrack{"minIPSigXYTrack", -1., "min. |DCAxy|/sigma(DCAxy) of the prong candidates (disabled if <= 0)"};
+  Configurable<int> maxProngCandidates{"maxProngCandidates", -1, "max. number of prong candidates per jet, highest pT first (all if <= 0)"};
   Configurable<bool> fillHistograms{"fillHistograms", true, "do validation plots"};
 
   Configurable<std::string> ccdbUrl{"ccdbUrl", "http://alice-ccdb.cern.ch", "url of the ccdb repository"};
@@ -83,6 +89,14 @@ struct SecondaryVertexReconstruction {
   float toMicrometers = 10000.; // from cm to µm
   double bz{0.};
 
+  /// Jet constituent passing the preselection, with the quantities reused by all its combinations
+  struct ProngCandidate {
+    o2::track::TrackParCov trackParCov;
+    double energy;
+    float pt;
+  };
+  std::vector<ProngCandidate> prongCandidates;
+
   void init(InitContext const&)
   {
     if (fillHistograms) {
@@ -125,145 +139,170 @@ struct SecondaryVertexReconstruction {
   using JetTracksMCDwPIs = soa::Filtered<soa::Join<JetTracksMCD, aod::JTrackPIs>>;
   using OriginalTracks = soa::Join<aod::Tracks, aod::TracksCov, aod::TrackSelection, aod::TracksDCA, aod::TracksDCACov>;
 
-  template <unsigned int numProngs, typename AnyCollision, typename AnyJet, typename AnyParticles>
-  void runCreatorNProng(AnyCollision const& collision,
-                        AnyJet const& analysisJet,
-                        AnyParticles const& listoftracks,
-                        std::vector<int>& svIndices,
-                        o2::vertexing::DCAFitterN<numProngs>& df,
-                        size_t prongIndex = 0,
-                        std::vector<size_t> currentCombination = {})
+  /// Fits the secondary vertex of one combination of prong candidates and fills its table row
+  template <unsigned int numProngs, typename AnyJet>
+  void fitCombination(o2::dataformats::VertexBase const& primaryVertex,
+                      AnyJet const& analysisJet,
+                      std::array<size_t, numProngs> const& combination,
+                      std::vector<int>& svIndices,
+                      o2::vertexing::DCAFitterN<numProngs>& df)
   {
+    // Create an array of track parameters and covariance matrices for the current combination
+    std::array<o2::track::TrackParametrizationWithError<float>, numProngs> trackParVars;
+    double energySV = 0.;
+    for (unsigned int inum = 0; inum < numProngs; ++inum) {
+      const auto& prong = prongCandidates[combination[inum]];
+      energySV += prong.energy;
+      trackParVars[inum] = prong.trackParCov;
+    }
 
-    const auto& particles = analysisJet.template tracks_as<AnyParticles>();
+    // Reconstruct the secondary vertex
+    int processResult = 0;
+    std::apply([&df, &processResult](const auto&... elems) { processResult = df.process(elems...); }, trackParVars);
+    if (processResult == 0) {
+      return;
+    }
 
-    if (currentCombination.size() == numProngs) {
-      // Create an array of track parameters and covariance matrices for the current combination
-      std::array<o2::track::TrackParametrizationWithError<float>, numProngs> trackParVars;
-      double energySV = 0.;
-      for (unsigned int inum = 0; inum < numProngs; ++inum) {
-        const auto& prong = particles[currentCombination[inum]].template track_as<OriginalTracks>();
-        energySV += prong.energy(o2::constants::physics::MassPiPlus);
-        trackParVars[inum] = getTrackParCov(prong);
-      }
+    const auto& secondaryVertex = df.getPCACandidate();
+    auto chi2PCA = df.getChi2AtPCACandidate();
+    auto covMatrixPCA = df.calcPCACovMatrixFlat();
 
-      auto bc = collision.template bc_as<aod::BCsWithTimestamps>();
-      if (runNumber != bc.runNumber()) {
-        initCCDB(bc, runNumber, ccdb, ccdbPathGrpMag, lut, false);
-        bz = o2::base::Propagator::Instance()->getNominalBz();
-      }
+    // get track impact parameters
+    // This modifies track momenta!
+    auto covMatrixPV = primaryVertex.getCov();
 
-      // Use a different fitter depending on the number of prongs
-      df.setBz(bz);
+    // Get track momenta and impact parameters
+    std::array<std::array<float, 3>, numProngs> arrayMomenta;
+    std::array<o2::dataformats::DCA, numProngs> impactParameters;
+    for (unsigned int inum = 0; inum < numProngs; ++inum) {
+      trackParVars[inum].getPxPyPzGlo(arrayMomenta[inum]);
+      trackParVars[inum].propagateToDCA(primaryVertex, bz, &impactParameters[inum]);
 
-      // Reconstruct the secondary vertex
-      int processResult = 0;
-      std::apply([&df, &processResult](const auto&... elems) { processResult = df.process(elems...); }, trackParVars);
-      if (processResult == 0) {
-        return;
+      if (fillHistograms) {
+        const auto& prong = prongCandidates[combination[inum]];
+        registry.fill(HIST("hDcaXYNProngs"), prong.pt, impactParameters[inum].getY() * toMicrometers, numProngs);
+        registry.fill(HIST("hDcaZNProngs"), prong.pt, impactParameters[inum].getZ() * toMicrometers, numProngs);
       }
+    }
 
-      const auto& secondaryVertex = df.getPCACandidate();
-      auto chi2PCA = df.getChi2AtPCACandidate();
-      auto covMatrixPCA = df.calcPCACovMatrixFlat();
-
-      // get track impact parameters
-      // This modifies track momenta!
-      auto primaryVertex = getPrimaryVertex(collision);
-      auto covMatrixPV = primaryVertex.getCov();
-
-      // Get track momenta and impact parameters
-      std::array<std::array<float, 3>, numProngs> arrayMomenta;
-      std::array<o2::dataformats::DCA, numProngs> impactParameters;
-      for (unsigned int inum = 0; inum < numProngs; ++inum) {
-        trackParVars[inum].getPxPyPzGlo(arrayMomenta[inum]);
-        trackParVars[inum].propagateToDCA(primaryVertex, bz, &impactParameters[inum]);
-
-        if (fillHistograms) {
-          const auto& prong = particles[currentCombination[inum]].template track_as<OriginalTracks>();
-          registry.fill(HIST("hDcaXYNProngs"), prong.pt(), impactParameters[inum].getY() * toMicrometers, numProngs);
-          registry.fill(HIST("hDcaZNProngs"), prong.pt(), impactParameters[inum].getZ() * toMicrometers, numProngs);
-        }
-      }
+    // get uncertainty of the decay length
+    double phi, theta;
+    getPointDirection(std::array{primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ()}, secondaryVertex, phi, theta);
+    auto errorDecayLength = std::sqrt(getRotatedCovMatrixXX(covMatrixPV, phi, theta) + getRotatedCovMatrixXX(covMatrixPCA, phi, theta));
+    auto errorDecayLengthXY = std::sqrt(getRotatedCovMatrixXX(covMatrixPV, phi, 0.) + getRotatedCovMatrixXX(covMatrixPCA, phi, 0.));
+
+    // calculate invariant mass
+    std::array<double, numProngs> massArray;
+    std::fill(massArray.begin(), massArray.end(), o2::constants::physics::MassPiPlus);
+    double massSV = RecoDecay::m(std::move(arrayMomenta), massArray);
+
+    // fill candidate table rows
+    if (doprocessData3Prongs && numProngs == 3) {
+      sv3prongTableData(analysisJet.globalIndex(),
+                        primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ(),
+                        secondaryVertex[0], secondaryVertex[1], secondaryVertex[2],
+                        arrayMomenta[0][0] + arrayMomenta[1][0] + arrayMomenta[2][0],
+                        arrayMomenta[0][1] + arrayMomenta[1][1] + arrayMomenta[2][1],
+                        arrayMomenta[0][2] + arrayMomenta[1][2] + arrayMomenta[2][2],
+                        energySV, massSV, chi2PCA, errorDecayLength, errorDecayLengthXY);
+      svIndices.push_back(sv3prongTableData.lastIndex());
+    } else if (doprocessData2Prongs && numProngs == 2) {
+      sv2prongTableData(analysisJet.globalIndex(),
+                        primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ(),
+                        secondaryVertex[0], secondaryVertex[1], secondaryVertex[2],
+                        arrayMomenta[0][0] + arrayMomenta[1][0],
+                        arrayMomenta[0][1] + arrayMomenta[1][1],
+                        arrayMomenta[0][2] + arrayMomenta[1][2],
+                        energySV, massSV, chi2PCA, errorDecayLength, errorDecayLengthXY);
+      svIndices.push_back(sv2prongTableData.lastIndex());
+    } else if (doprocessMCD3Prongs && numProngs == 3) {
+      sv3prongTableMCD(analysisJet.globalIndex(),
+                       primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ(),
+                       secondaryVertex[0], secondaryVertex[1], secondaryVertex[2],
+                       arrayMomenta[0][0] + arrayMomenta[1][0] + arrayMomenta[2][0],
+                       arrayMomenta[0][1] + arrayMomenta[1][1] + arrayMomenta[2][1],
+                       arrayMomenta[0][2] + arrayMomenta[1][2] + arrayMomenta[2][2],
+                       energySV, massSV, chi2PCA, errorDecayLength, errorDecayLengthXY);
+      svIndices.push_back(sv3prongTableMCD.lastIndex());
+    } else if (doprocessMCD2Prongs && numProngs == 2) {
+      sv2prongTableMCD(analysisJet.globalIndex(),
+                       primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ(),
+                       secondaryVertex[0], secondaryVertex[1], secondaryVertex[2],
+                       arrayMomenta[0][0] + arrayMomenta[1][0],
+                       arrayMomenta[0][1] + arrayMomenta[1][1],
+                       arrayMomenta[0][2] + arrayMomenta[1][2],
+                       energySV, massSV, chi2PCA, errorDecayLength, errorDecayLengthXY);
+      svIndices.push_back(sv2prongTableMCD.lastIndex());
+    } else {
+      LOG(error) << "No process specified\n";
+    }
 
-      // get uncertainty of the decay length
-      double phi, theta;
-      getPointDirection(std::array{primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ()}, secondaryVertex, phi, theta);
-      auto errorDecayLength = std::sqrt(getRotatedCovMatrixXX(covMatrixPV, phi, theta) + getRotatedCovMatrixXX(covMatrixPCA, phi, theta));
-      auto errorDecayLengthXY = std::sqrt(getRotatedCovMatrixXX(covMatrixPV, phi, 0.) + getRotatedCovMatrixXX(covMatrixPCA, phi, 0.));
-
-      // calculate invariant mass
-      std::array<double, numProngs> massArray;
-      std::fill(massArray.begin(), massArray.end(), o2::constants::physics::MassPiPlus);
-      double massSV = RecoDecay::m(std::move(arrayMomenta), massArray);
-
-      // fill candidate table rows
-      if (doprocessData3Prongs && numProngs == 3) {
-        sv3prongTableData(analysisJet.globalIndex(),
-                          primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ(),
-                          secondaryVertex[0], secondaryVertex[1], secondaryVertex[2],
-                          arrayMomenta[0][0] + arrayMomenta[1][0] + arrayMomenta[2][0],
-                          arrayMomenta[0][1] + arrayMomenta[1][1] + arrayMomenta[2][1],
-                          arrayMomenta[0][2] + arrayMomenta[1][2] + arrayMomenta[2][2],
-                          energySV, massSV, chi2PCA, errorDecayLength, errorDecayLengthXY);
-        svIndices.push_back(sv3prongTableData.lastIndex());
-      } else if (doprocessData2Prongs && numProngs == 2) {
-        sv2prongTableData(analysisJet.globalIndex(),
-                          primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ(),
-                          secondaryVertex[0], secondaryVertex[1], secondaryVertex[2],
-                          arrayMomenta[0][0] + arrayMomenta[1][0],
-                          arrayMomenta[0][1] + arrayMomenta[1][1],
-                          arrayMomenta[0][2] + arrayMomenta[1][2],
-                          energySV, massSV, chi2PCA, errorDecayLength, errorDecayLengthXY);
-        svIndices.push_back(sv2prongTableData.lastIndex());
-      } else if (doprocessMCD3Prongs && numProngs == 3) {
-        sv3prongTableMCD(analysisJet.globalIndex(),
-                         primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ(),
-                         secondaryVertex[0], secondaryVertex[1], secondaryVertex[2],
-                         arrayMomenta[0][0] + arrayMomenta[1][0] + arrayMomenta[2][0],
-                         arrayMomenta[0][1] + arrayMomenta[1][1] + arrayMomenta[2][1],
-                         arrayMomenta[0][2] + arrayMomenta[1][2] + arrayMomenta[2][2],
-                         energySV, massSV, chi2PCA, errorDecayLength, errorDecayLengthXY);
-        svIndices.push_back(sv3prongTableMCD.lastIndex());
-      } else if (doprocessMCD2Prongs && numProngs == 2) {
-        sv2prongTableMCD(analysisJet.globalIndex(),
-                         primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ(),
-                         secondaryVertex[0], secondaryVertex[1], secondaryVertex[2],
-                         arrayMomenta[0][0] + arrayMomenta[1][0],
-                         arrayMomenta[0][1] + arrayMomenta[1][1],
-                         arrayMomenta[0][2] + arrayMomenta[1][2],
-                         energySV, massSV, chi2PCA, errorDecayLength, errorDecayLengthXY);
-        svIndices.push_back(sv2prongTableMCD.lastIndex());
-      } else {
-        LOG(error) << "No process specified\n";
-      }
+    // fill histograms
+    if (fillHistograms) {
+      double DecayLengthNormalised = RecoDecay::distance(std::array{primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ()}, std::array{secondaryVertex[0], secondaryVertex[1], secondaryVertex[2]}) / errorDecayLength;
+      double DecayLengthXYNormalised = RecoDecay::distanceXY(std::array{primaryVertex.getX(), primaryVertex.getY()}, std::array{secondaryVertex[0], secondaryVertex[1]}) / errorDecayLengthXY;
 
-      // fill histograms
-      if (fillHistograms) {
-        double DecayLengthNormalised = RecoDecay::distance(std::array{primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ()}, std::array{secondaryVertex[0], secondaryVertex[1], secondaryVertex[2]}) / errorDecayLength;
-        double DecayLengthXYNormalised = RecoDecay::distanceXY(std::array{primaryVertex.getX(), primaryVertex.getY()}, std::array{secondaryVertex[0], secondaryVertex[1]}) / errorDecayLengthXY;
+      registry.fill(HIST("hMassNProngs"), massSV, numProngs);
+      registry.fill(HIST("hLxySNProngs"), DecayLengthXYNormalised, numProngs);
+      registry.fill(HIST("hLSNProngs"), DecayLengthNormalised, numProngs);
+      registry.fill(HIST("hFeNProngs"), energySV / analysisJet.energy() > 1. ? 0.99 : energySV / analysisJet.energy(), numProngs);
+    }
+  }
 
-        registry.fill(HIST("hMassNProngs"), massSV, numProngs);
-        registry.fill(HIST("hLxySNProngs"), DecayLengthXYNormalised, numProngs);
-        registry.fill(HIST("hLSNProngs"), DecayLengthNormalised, numProngs);
-        registry.fill(HIST("hFeNProngs"), energySV / analysisJet.energy() > 1. ? 0.99 : energySV / analysisJet.energy(), numProngs);
+  template <unsigned int numProngs, typename AnyCollision, typename AnyJet, typename AnyParticles>
+  void runCreatorNProng(AnyCollision const& collision,
+                        AnyJet const& analysisJet,
+                        AnyParticles const& /*listoftracks*/,
+                        std::vector<int>& svIndices,
+                        o2::vertexing::DCAFitterN<numProngs>& df)
+  {
+    // Preselect the prong candidates once per jet, the combinations only reuse them
+    prongCandidates.clear();
+    for (const auto& particle : analysisJet.template tracks_as<AnyParticles>()) {
+      const auto& track = particle.template track_as<OriginalTracks>();
+      if (track.pt() < ptMinTrack || track.eta() < etaMinTrack || track.eta() > etaMaxTrack) {
+        continue;
       }
-
+      if (minIPSigXYTrack > 0. && std::abs(track.dcaXY()) < minIPSigXYTrack * std::sqrt(track.sigmaDcaXY2())) {
+        continue;
+      }
+      prongCandidates.push_back({getTrackParCov(track), track.energy(o2::constants::physics::MassPiPlus), track.pt()});
+    }
+    if (prongCandidates.size() < numProngs) {
       return;
     }
+    std::sort(prongCandidates.begin(), prongCandidates.end(), [](const auto& a, const auto& b) { return a.pt > b.pt; });
+    if (maxProngCandidates > 0 && prongCandidates.size() > static_cast<size_t>(maxProngCandidates)) {
+      prongCandidates.resize(maxProngCandidates);
+    }
 
-    // Recursive call to explore all combinations
-    for (size_t iprong = prongIndex; iprong < particles.size(); ++iprong) {
-
-      const auto& testTrack = particles[iprong].template track_as<OriginalTracks>();
-      if (testTrack.pt() < ptMinTrack || testTrack.eta() < etaMinTrack || testTrack.eta() > etaMaxTrack) {
-        continue;
+    auto bc = collision.template bc_as<aod::BCsWithTimestamps>();
+    if (runNumber != bc.runNumber()) {
+      initCCDB(bc, runNumber, ccdb, ccdbPathGrpMag, lut, false);
+      bz = o2::base::Propagator::Instance()->getNominalBz();
+    }
+    df.setBz(bz);
+    auto primaryVertex = getPrimaryVertex(collision);
+
+    // Loop over all the combinations i0 < i1 < ... of the prong candidates
+    const size_t nCandidates = prongCandidates.size();
+    std::array<size_t, numProngs> combination;
+    for (unsigned int inum = 0; inum < numProngs; ++inum) {
+      combination[inum] = inum;
+    }
+    while (true) {
+      fitCombination<numProngs>(primaryVertex, analysisJet, combination, svIndices, df);
+      int inum = numProngs - 1;
+      while (inum >= 0 && combination[inum] == nCandidates - numProngs + static_cast<size_t>(inum)) {
+        --inum;
+      }
+      if (inum < 0) {
+        break;
+      }
+      ++combination[inum];
+      for (unsigned int jnum = inum + 1; jnum < numProngs; ++jnum) {
+        combination[jnum] = combination[jnum - 1] + 1;
       }
-
-      currentCombination.push_back(iprong);
-      runCreatorNProng<numProngs>(
-        collision, analysisJet, listoftracks, svIndices, df, iprong + 1, currentCombination);
-      currentCombination.pop_back();
     }
   }
 
@@ -15,6 +15,8 @@
 
 //
 // Task performing jet reclustering and producing primary Lund Plane histograms
+// The primary declusterings can either be computed here or read from the substructure tables (jet-substructure task),
+// such that the jets are reclustered only once when several substructure tasks run in the same workflow
 //
 
 #include <iostream>
@@ -84,6 +86,20 @@ struct JetLundReclustering {
   Filter jetFilter = aod::jet::pt > jetPtMin&& aod::jet::r == nround(jetR.node() * 100.0f) && aod::jet::eta > jet_min_eta&& aod::jet::eta < jet_max_eta;
   Filter collisionFilter = nabs(aod::jcollision::posZ) < vertexZCut;
 
+  // Fills the primary Lund planes from one declustering step of the jet
+  template <typename T>
+  void fillLundPlane(T const& jet, double ptLeading, double ptSubLeading, double deltaR)
+  {
+    double kt = ptSubLeading * deltaR;
+    double z = ptSubLeading / (ptLeading + ptSubLeading);
+    double jetRadius = static_cast<double>(jet.r()) / 100.0;
+    double coord1 = std::log(jetRadius / deltaR);
+    double coord2 = std::log(kt);
+    double coord3 = std::log(1 / z);
+    registry.fill(HIST("PrimaryLundPlane_kT"), coord1, coord2, jet.pt());
+    registry.fill(HIST("PrimaryLundPlane_z"), coord1, coord3, jet.pt());
+  }
+
   // Reclustering function
   template <typename T>
   void jetReclustering(T const& jet)
@@ -98,15 +114,7 @@ struct JetLundReclustering {
       if (j1.pt() < j2.pt()) {
         std::swap(j1, j2);
       }
-      double deltaR = j1.delta_R(j2);
-      double kt = j2.pt() * deltaR;
-      double z = j2.pt() / (j1.pt() + j2.pt());
-      double jetRadius = static_cast<double>(jet.r()) / 100.0;
-      double coord1 = std::log(jetRadius / deltaR);
-      double coord2 = std::log(kt);
-      double coord3 = std::log(1 / z);
-      registry.fill(HIST("PrimaryLundPlane_kT"), coord1, coord2, jet.pt());
-      registry.fill(HIST("PrimaryLundPlane_z"), coord1, coord3, jet.pt());
+      fillLundPlane(jet, j1.pt(), j2.pt(), j1.delta_R(j2));
       pair = j1;
     }
   }
@@ -136,6 +144,25 @@ struct JetLundReclustering {
     }
   }
   PROCESS_SWITCH(JetLundReclustering, processChargedJets, "Process function for charged jets", false);
+
+  // Process function for charged jets, reading the primary declusterings stored by the jet-substructure task instead of reclustering the jets
+  void processChargedJetsFromSubstructure(soa::Filtered<JetCollisions>::iterator const& collision,
+                                          soa::Filtered<soa::Join<aod::ChargedJets, aod::CJetSSs>> const& jets)
+  {
+    if (!jetderiveddatautilities::selectCollision(collision, eventSelection)) {
+      return;
+    }
+    for (const auto& jet : jets) {
+      registry.fill(HIST("jet_PtEtaPhi"), jet.pt(), jet.eta(), jet.phi());
+      auto ptLeading = jet.ptLeading();
+      auto ptSubLeading = jet.ptSubLeading();
+      auto theta = jet.theta();
+      for (std::size_t iSplitting = 0; iSplitting < theta.size(); iSplitting++) {
+        fillLundPlane(jet, ptLeading[iSplitting], ptSubLeading[iSplitting], theta[iSplitting]);
+      }
+    }
+  }
+  PROCESS_SWITCH(JetLundReclustering, processChargedJetsFromSubstructure, "Process function for charged jets, using the declusterings of the jet-substructure task", false);
 };
 
 WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
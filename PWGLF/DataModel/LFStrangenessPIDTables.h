@@ -16,8 +16,10 @@
 #define PWGLF_DATAMODEL_LFSTRANGENESSPIDTABLES_H_
 
 #include <cmath>
+#include <cstdint>
 #include "Framework/AnalysisDataModel.h"
 #include "Common/Core/RecoDecay.h"
+#include "Common/DataModel/PIDResponse.h"
 #include "CommonConstants/PhysicsConstants.h"
 
 namespace o2::aod
@@ -45,6 +47,60 @@ DECLARE_SOA_TABLE(DauTrackTPCPIDs, "AOD", "DAUTRACKTPCPID", // nsigma table (for
 DECLARE_SOA_TABLE(DauTrackTOFPIDs, "AOD", "DAUTRACKTOFPID", // raw table (for posterior TOF calculation)
                   dautrack::TOFSignal, dautrack::TOFEvTime, dautrack::Length);
 
+namespace dautrackpacked
+{
+// ==== PACKED TPC INFORMATION ===
+// nsigmas in 8 bits with the binning of the tiny PID tables: steps of 0.05 in [-6.35, 6.35], values beyond are stored at the edges
+// TPC signal in 16 bits with steps of 0.05 up to 3276.75
+using binning = o2::aod::pidtpc_tiny::binning;
+static constexpr float TPCSignalPrecision = 0.05f;
+
+inline uint16_t packTPCSignal(float tpcSignal)
+{
+  const float value = std::fmin(std::fmax(tpcSignal / TPCSignalPrecision + 0.5f, 0.f), static_cast<float>(UINT16_MAX));
+  return static_cast<uint16_t>(value);
+}
+inline binning::binned_t packNSigma(float nSigma)
+{
+  const float value = std::fmin(std::fmax(nSigma, binning::binned_min), binning::binned_max);
+  return static_cast<binning::binned_t>((value / binning::bin_width) + std::copysign(0.5f, value));
+}
+
+DECLARE_SOA_COLUMN(TPCSignalStore, tpcSignalStore, uint16_t);              //! packed track TPC signal
+DECLARE_SOA_COLUMN(TPCNSigmaStoreEl, tpcNSigmaStoreEl, binning::binned_t); //! packed Nsigma electron
+DECLARE_SOA_COLUMN(TPCNSigmaStorePi, tpcNSigmaStorePi, binning::binned_t); //! packed Nsigma pion
+DECLARE_SOA_COLUMN(TPCNSigmaStoreKa, tpcNSigmaStoreKa, binning::binned_t); //! packed Nsigma kaon
+DECLARE_SOA_COLUMN(TPCNSigmaStorePr, tpcNSigmaStorePr, binning::binned_t); //! packed Nsigma proton
+DECLARE_SOA_COLUMN(TPCNSigmaStoreHe, tpcNSigmaStoreHe, binning::binned_t); //! packed Nsigma helium-3
+
+// unpacked values, with the same getters as the full DauTrackTPCPIDs table
+DECLARE_SOA_DYNAMIC_COLUMN(TPCSignal, tpcSignal, //! track TPC signal
+                           [](uint16_t tpcSignalStore) -> float { return TPCSignalPrecision * static_cast<float>(tpcSignalStore); });
+DECLARE_SOA_DYNAMIC_COLUMN(TPCNSigmaEl, tpcNSigmaEl, //! Nsigma electron
+                           [](binning::binned_t nSigmaStore) -> float { return o2::aod::pidutils::unPackInTable<binning>(nSigmaStore); });
+DECLARE_SOA_DYNAMIC_COLUMN(TPCNSigmaPi, tpcNSigmaPi, //! Nsigma pion
+                           [](binning::binned_t nSigmaStore) -> float { return o2::aod::pidutils::unPackInTable<binning>(nSigmaStore); });
+DECLARE_SOA_DYNAMIC_COLUMN(TPCNSigmaKa, tpcNSigmaKa, //! Nsigma kaon
+                           [](binning::binned_t nSigmaStore) -> float { return o2::aod::pidutils::unPackInTable<binning>(nSigmaStore); });
+DECLARE_SOA_DYNAMIC_COLUMN(TPCNSigmaPr, tpcNSigmaPr, //! Nsigma proton
+                           [](binning::binned_t nSigmaStore) -> float { return o2::aod::pidutils::unPackInTable<binning>(nSigmaStore); });
+DECLARE_SOA_DYNAMIC_COLUMN(TPCNSigmaHe, tpcNSigmaHe, //! Nsigma helium-3
+                           [](binning::binned_t nSigmaStore) -> float { return o2::aod::pidutils::unPackInTable<binning>(nSigmaStore); });
+} // namespace dautrackpacked
+
+DECLARE_SOA_TABLE(DauTrackTPCPIDsPacked, "AOD", "DAUTRACKTPCPIDP", // packed nsigma table, alternative to DauTrackTPCPIDs (for analysis)
+                  dautrackpacked::TPCSignalStore, dautrackpacked::TPCNSigmaStoreEl,
+                  dautrackpacked::TPCNSigmaStorePi, dautrackpacked::TPCNSigmaStoreKa,
+                  dautrackpacked::TPCNSigmaStorePr, dautrackpacked::TPCNSigmaStoreHe,
+
+                  // Dynamic columns for unpacking
+                  dautrackpacked::TPCSignal<dautrackpacked::TPCSignalStore>,
+                  dautrackpacked::TPCNSigmaEl<dautrackpacked::TPCNSigmaStoreEl>,
+                  dautrackpacked::TPCNSigmaPi<dautrackpacked::TPCNSigmaStorePi>,
+                  dautrackpacked::TPCNSigmaKa<dautrackpacked::TPCNSigmaStoreKa>,
+                  dautrackpacked::TPCNSigmaPr<dautrackpacked::TPCNSigmaStorePr>,
+                  dautrackpacked::TPCNSigmaHe<dautrackpacked::TPCNSigmaStoreHe>);
+
 namespace v0data
 {
 // ==== TOF INFORMATION ===
@@ -274,6 +274,12 @@ DECLARE_SOA_COLUMN(CovMatNegDau, covMatNegDau, float[21]);     //! covariance ma
 DECLARE_SOA_COLUMN(CovMatPosDauIU, covMatPosDauIU, float[21]); //! covariance matrix elements positive daughter track
 DECLARE_SOA_COLUMN(CovMatNegDauIU, covMatNegDauIU, float[21]); //! covariance matrix elements negative daughter track
 
+// Saved from finding: daughter tracks at the decay vertex, as TrackParCov (x, alpha, y, z, snp, tgl, q/pt + local cov. matrix)
+DECLARE_SOA_COLUMN(ParPosDau, parPosDau, float[7]);  //! track parameters positive daughter track at decay vertex
+DECLARE_SOA_COLUMN(ParNegDau, parNegDau, float[7]);  //! track parameters negative daughter track at decay vertex
+DECLARE_SOA_COLUMN(CovPosDau, covPosDau, float[15]); //! local covariance matrix elements positive daughter track at decay vertex
+DECLARE_SOA_COLUMN(CovNegDau, covNegDau, float[15]); //! local covariance matrix elements negative daughter track at decay vertex
+
 // Saved from KF particle fit for specic table
 DECLARE_SOA_COLUMN(KFV0Chi2, kfV0Chi2, float); //!
 
@@ -595,6 +601,11 @@ DECLARE_SOA_TABLE_FULL(V0DauCovs, "V0DauCovs", "AOD", "V0DAUCOVS", //! V0 covari
 DECLARE_SOA_TABLE_FULL(V0DauCovIUs, "V0DauCovIUs", "AOD", "V0DAUCOVIUS", //! V0 covariance matrices of the dauther tracks
                        v0data::CovMatPosDauIU, v0data::CovMatNegDauIU, o2::soa::Marker<1>);
 
+DECLARE_SOA_TABLE(V0DauTrackParCovs, "AOD", "V0DAUTRKPARCOV", //! daughter tracks at the decay vertex of all built V0s (standard and for cascades), to be re-used by the cascade builder
+                  o2::soa::Index<>, v0data::V0Id, v0data::CollisionId,
+                  v0data::ParPosDau, v0data::CovPosDau, v0data::ParNegDau, v0data::CovNegDau,
+                  v0data::DCAV0Daughters, v0data::DCAPosToPV, v0data::DCANegToPV);
+
 DECLARE_SOA_TABLE(V0fCIndices, "AOD", "V0FCINDEX", //! index table when using AO2Ds
                   o2::soa::Index<>, v0data::PosTrackId, v0data::NegTrackId, v0data::CollisionId, v0data::V0Id, o2::soa::Marker<2>);
 
@@ -746,6 +757,16 @@ DECLARE_SOA_TABLE(FindableV0s, "AOD", "FindableV0", //! Will store findable
 DECLARE_SOA_TABLE(V0FoundTags, "AOD", "V0FoundTag", //! found or not?
                   v0data::IsFound);
 
+namespace v0data
+{
+DECLARE_SOA_COLUMN(SelectionMap0, selectionMap0, uint64_t); //! selection bitmap of the first selection group (bits in PWGLF/Utils/v0SelectionBits.h)
+DECLARE_SOA_COLUMN(SelectionMap1, selectionMap1, uint64_t); //! selection bitmap of the second selection group, 0 if not configured
+DECLARE_SOA_COLUMN(SelectionMap2, selectionMap2, uint64_t); //! selection bitmap of the third selection group, 0 if not configured
+} // namespace v0data
+
+DECLARE_SOA_TABLE(V0SelectionMaps, "AOD", "V0SELECTIONMAP", //! precomputed selection bitmaps, joinable with V0Cores
+                  v0data::SelectionMap0, v0data::SelectionMap1, v0data::SelectionMap2);
+
 using FindableV0sLinked = soa::Join<FindableV0s, V0DataLink>;
 using FindableV0Linked = FindableV0sLinked::iterator;
 
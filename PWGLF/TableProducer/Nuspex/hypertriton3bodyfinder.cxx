@@ -16,6 +16,8 @@
 #include <array>
 #include <cstdlib>
 #include <iterator>
+#include <vector>
+#include <algorithm>
 
 #include "Framework/runDataProcessing.h"
 #include "Framework/AnalysisTask.h"
@@ -250,6 +252,14 @@ struct hypertriton3bodyFinder {
   Configurable<float> maxDCAXY3Body{"maxDCAXY3Body", 0.5, "DCAXY H3L to PV"}; // max DCA of 3 body decay to PV in XY
   Configurable<float> maxDCAZ3Body{"maxDCAZ3Body", 1.0, "DCAZ H3L to PV"};    // max DCA of 3 body decay to PV in Z
 
+  // bachelor prefilter, applied before the 3-body fit
+  Configurable<bool> d_UseBachPrefilter{"d_UseBachPrefilter", false, "Preselect the bachelors in direction and DCA to the V0 line before the 3-body fit"};
+  Configurable<float> maxBachDeltaPhi{"maxBachDeltaPhi", 0.5, "Max difference in phi between bachelor and V0 momenta (rad)"};
+  Configurable<float> maxBachDeltaEta{"maxBachDeltaEta", 0.5, "Max difference in eta between bachelor and V0 momenta"};
+  Configurable<float> maxBachDCAToV0Line{"maxBachDCAToV0Line", 1.0, "Max DCA of the bachelor to the V0 line through its decay point (cm)"};
+  Configurable<int> nBachPhiSectors{"nBachPhiSectors", 18, "Number of phi sectors used to bin the bachelors"};
+  Configurable<int> nBachEtaSectors{"nBachEtaSectors", 12, "Number of eta sectors used to bin the bachelors"};
+
   Configurable<int> useMatCorrType{"useMatCorrType", 2, "0: none, 1: TGeo, 2: LUT"};
   // CCDB options
   Configurable<std::string> ccdburl{"ccdb-url", "http://alice-ccdb.cern.ch", "url of the ccdb repository"};
@@ -274,6 +284,7 @@ struct hypertriton3bodyFinder {
       {"hTrueV0Counter", "hTrueV0Counter", {HistType::kTH1F, {{8, -0.5f, 7.5f}}}},
       {"hVtx3BodyCounter", "hVtx3BodyCounter", {HistType::kTH1F, {{9, -0.5f, 8.5f}}}},
       {"hTrueVtx3BodyCounter", "hTrueVtx3BodyCounter", {HistType::kTH1F, {{9, -0.5f, 8.5f}}}},
+      {"hBachPrefilterCounter", "hBachPrefilterCounter", {HistType::kTH1F, {{3, -0.5f, 2.5f}}}},
       {"hVirtLambaCounter", "hVirtualLambaCounter", {HistType::kTH1F, {{6, -0.5f, 5.5f}}}},
       {"hCFFilteredVirtLambaCounter", "hCFFilteredVirtLambaCounter", {HistType::kTH1F, {{6, -0.5f, 5.5f}}}},
     },
@@ -300,6 +311,10 @@ struct hypertriton3bodyFinder {
                  kVtxDcaDau,
                  kVtxDcaH3L,
                  kNVtxSteps };
+  enum bachstep { kBachAll = 0,
+                  kBachDirection,
+                  kBachDCAToV0,
+                  kNBachSteps };
 
   // Helper struct to do bookkeeping of building parameters
   struct {
@@ -307,6 +322,7 @@ struct hypertriton3bodyFinder {
     std::array<int32_t, kNV0Steps> truev0stats;
     std::array<int32_t, kNVtxSteps> vtxstats;
     std::array<int32_t, kNVtxSteps> truevtxstats;
+    std::array<int32_t, kNBachSteps> bachstats;
     std::array<int32_t, 12> virtLambdastats;
   } statisticsRegistry;
 
@@ -320,6 +336,9 @@ struct hypertriton3bodyFinder {
       statisticsRegistry.vtxstats[ii] = 0;
       statisticsRegistry.truevtxstats[ii] = 0;
     }
+    for (Int_t ii = 0; ii < kNBachSteps; ii++) {
+      statisticsRegistry.bachstats[ii] = 0;
+    }
     for (Int_t ii = 0; ii < 12; ii++) {
       statisticsRegistry.virtLambdastats[ii] = 0;
     }
@@ -335,6 +354,9 @@ struct hypertriton3bodyFinder {
       registry.fill(HIST("hVtx3BodyCounter"), ii, statisticsRegistry.vtxstats[ii]);
       registry.fill(HIST("hTrueVtx3BodyCounter"), ii, statisticsRegistry.truevtxstats[ii]);
     }
+    for (Int_t ii = 0; ii < kNBachSteps; ii++) {
+      registry.fill(HIST("hBachPrefilterCounter"), ii, statisticsRegistry.bachstats[ii]);
+    }
     for (Int_t ii = 0; ii < 3; ii++) {
       registry.fill(HIST("hVirtLambaCounter"), ii, statisticsRegistry.virtLambdastats[ii]);
       registry.fill(HIST("hVirtLambaCounter"), ii + 3, statisticsRegistry.virtLambdastats[ii + 3]);
@@ -368,6 +390,11 @@ struct hypertriton3bodyFinder {
   o2::vertexing::DCAFitterN<2> fitter;
   o2::vertexing::DCAFitterN<3> fitter3body;
 
+  // bachelors of the current collision for the prefilter, binned in phi and eta sectors of their momentum
+  static constexpr float BachEtaSectorMax = 1.5f; // the outermost eta sectors also take the bachelors beyond
+  std::vector<o2::track::TrackPar> mBachPars;
+  std::vector<std::vector<int>> mBachSectors;
+
   void init(InitContext&)
   {
     resetHistos();
@@ -379,6 +406,7 @@ struct hypertriton3bodyFinder {
     TString DauCounterbinLabel[3] = {"Proton", "Pion", "Deuteron"};
     TString V0CounterbinLabel[8] = {"Total", "hasSV", "V0R", "V0Pt", "TgLambda", "V0Mass", "DcaXY", "CosPA"};
     TString VtxCounterbinLabel[9] = {"Total", "bachPt", "hasSV", "VtxR", "VtxPt", "TgLambda", "CosPA", "DcaDau", "DcaH3L"};
+    TString BachCounterbinLabel[3] = {"Total", "Direction", "DcaToV0"};
     for (int i{0}; i < 3; i++) {
       registry.get<TH1>(HIST("hDauTrackCounter"))->GetXaxis()->SetBinLabel(i + 1, DauCounterbinLabel[i]);
     }
@@ -390,6 +418,9 @@ struct hypertriton3bodyFinder {
       registry.get<TH1>(HIST("hVtx3BodyCounter"))->GetXaxis()->SetBinLabel(i + 1, VtxCounterbinLabel[i]);
       registry.get<TH1>(HIST("hTrueVtx3BodyCounter"))->GetXaxis()->SetBinLabel(i + 1, VtxCounterbinLabel[i]);
     }
+    for (int i{0}; i < kNBachSteps; i++) {
+      registry.get<TH1>(HIST("hBachPrefilterCounter"))->GetXaxis()->SetBinLabel(i + 1, BachCounterbinLabel[i]);
+    }
 
     ccdb->setURL(ccdburl);
     ccdb->setCaching(true);
@@ -603,6 +634,85 @@ struct hypertriton3bodyFinder {
     return true;
   }
   //------------------------------------------------------------------
+  // Bachelor prefilter
+  int getBachPhiSector(float phi)
+  {
+    int iPhi = static_cast<int>(RecoDecay::constrainAngle(phi) / o2::constants::math::TwoPI * nBachPhiSectors);
+    return std::min(iPhi, nBachPhiSectors - 1);
+  }
+  int getBachEtaSector(float eta)
+  {
+    int iEta = static_cast<int>(std::floor((eta + BachEtaSectorMax) / (2.f * BachEtaSectorMax) * nBachEtaSectors));
+    return std::clamp(iEta, 0, nBachEtaSectors - 1);
+  }
+
+  // store the bachelors above the pT threshold in their sectors, the indices refer to the given list
+  template <typename TTrackList>
+  void fillBachelorSectors(TTrackList const& bachelors)
+  {
+    mBachPars.clear();
+    mBachSectors.assign(nBachPhiSectors * nBachEtaSectors, {});
+    for (size_t iBach = 0; iBach < bachelors.size(); iBach++) {
+      mBachPars.push_back(getTrackPar(bachelors[iBach]));
+      const auto& bachPar = mBachPars.back();
+      if (bachPar.getPt() < minbachPt) {
+        continue;
+      }
+      mBachSectors[getBachPhiSector(bachPar.getPhi()) * nBachEtaSectors + getBachEtaSector(bachPar.getEta())].push_back(iBach);
+    }
+  }
+
+  // call func(iBach) for the bachelors compatible with the V0 candidate of the 2-body fitter:
+  // momentum close in direction to the V0 one and small DCA to the V0 line through the V0 decay point
+  template <typename TFunc>
+  void forEachBachelorCandidate(TFunc&& func)
+  {
+    const auto& v0XYZ = fitter.getPCACandidate();
+    std::array<float, 3> pP, pN;
+    fitter.getTrack(0).getPxPyPzGlo(pP);
+    fitter.getTrack(1).getPxPyPzGlo(pN);
+    std::array<float, 3> pV0 = {pP[0] + pN[0], pP[1] + pN[1], pP[2] + pN[2]};
+    float phiV0 = RecoDecay::phi(pV0), etaV0 = RecoDecay::eta(pV0), pV0Mag = RecoDecay::p(pV0);
+
+    // sectors overlapping the direction window, each phi sector is visited once
+    int nPhiSectorsHalfWindow = static_cast<int>(std::ceil(maxBachDeltaPhi / o2::constants::math::TwoPI * nBachPhiSectors));
+    int iPhiV0 = getBachPhiSector(phiV0);
+    int iPhiFirst = iPhiV0 - nPhiSectorsHalfWindow, iPhiLast = iPhiV0 + nPhiSectorsHalfWindow;
+    if (iPhiLast - iPhiFirst + 1 > nBachPhiSectors) {
+      iPhiFirst = 0;
+      iPhiLast = nBachPhiSectors - 1;
+    }
+    int iEtaFirst = getBachEtaSector(etaV0 - maxBachDeltaEta), iEtaLast = getBachEtaSector(etaV0 + maxBachDeltaEta);
+
+    for (int iPhi = iPhiFirst; iPhi <= iPhiLast; iPhi++) {
+      int iPhiSector = (iPhi + nBachPhiSectors) % nBachPhiSectors;
+      for (int iEta = iEtaFirst; iEta <= iEtaLast; iEta++) {
+        for (const auto iBach : mBachSectors[iPhiSector * nBachEtaSectors + iEta]) {
+          statisticsRegistry.bachstats[kBachAll]++;
+          const auto& bachPar = mBachPars[iBach];
+          if (std::abs(RecoDecay::constrainAngle(bachPar.getPhi() - phiV0, -o2::constants::math::PI)) > maxBachDeltaPhi || std::abs(bachPar.getEta() - etaV0) > maxBachDeltaEta) {
+            continue;
+          }
+          statisticsRegistry.bachstats[kBachDirection]++;
+
+          // distance to the V0 line of the bachelor point closest to the V0 decay point
+          auto bachParAtV0 = bachPar;
+          std::array<float, 3> bachXYZ;
+          if (!bachParAtV0.propagateParamToDCA({v0XYZ[0], v0XYZ[1], v0XYZ[2]}, d_bz, nullptr, 2.f * maxBachDCAToV0Line + 10.f) || !bachParAtV0.getXYZGlo(bachXYZ)) {
+            continue;
+          }
+          std::array<float, 3> d = {bachXYZ[0] - v0XYZ[0], bachXYZ[1] - v0XYZ[1], bachXYZ[2] - v0XYZ[2]};
+          std::array<float, 3> dCrossP = {d[1] * pV0[2] - d[2] * pV0[1], d[2] * pV0[0] - d[0] * pV0[2], d[0] * pV0[1] - d[1] * pV0[0]};
+          if (RecoDecay::p(dCrossP) > maxBachDCAToV0Line * pV0Mag) {
+            continue;
+          }
+          statisticsRegistry.bachstats[kBachDCAToV0]++;
+          func(iBach);
+        }
+      }
+    }
+  }
+  //------------------------------------------------------------------
   // 3body decay vertex finder
   template <class TTrackClass, typename TCollisionTable, typename TTrackTable>
   void Decay3bodyFinder(TCollisionTable const& dCollision, TTrackTable const& dPtrack, TTrackTable const& dNtrack, TTrackTable const& dBachtrack, float const& rv0, bool isTrue3bodyVtx = false)
@@ -719,6 +829,14 @@ struct hypertriton3bodyFinder {
   template <class TTrackClass, typename TCollisionTable, typename TPosTrackTable, typename TNegTrackTable, typename TGoodTrackTable>
   void DecayFinder(TCollisionTable const& dCollision, TPosTrackTable const& dPtracks, TNegTrackTable const& dNtracks, TGoodTrackTable const& dGoodtracks)
   {
+    std::vector<typename TTrackClass::iterator> bachelors;
+    if (d_UseBachPrefilter) {
+      for (auto& t2id : dGoodtracks) {
+        bachelors.push_back(t2id.template goodTrack_as<TTrackClass>());
+      }
+      fillBachelorSectors(bachelors);
+    }
+
     for (auto& t0id : dPtracks) { // FIXME: turn into combination(...)
       auto t0 = t0id.template goodTrack_as<TTrackClass>();
 
@@ -729,6 +847,12 @@ struct hypertriton3bodyFinder {
           continue;
         }
 
+        if (d_UseBachPrefilter) {
+          forEachBachelorCandidate([&](int iBach) {
+            Decay3bodyFinder<TTrackClass>(dCollision, t0, t1, bachelors[iBach], rv0);
+          });
+          continue;
+        }
         for (auto& t2id : dGoodtracks) {
           auto t2 = t2id.template goodTrack_as<TTrackClass>();
           Decay3bodyFinder<TTrackClass>(dCollision, t0, t1, t2, rv0);
@@ -743,6 +867,14 @@ struct hypertriton3bodyFinder {
   template <class TTrackClass, typename TCollisionTable, typename TPosTrackTable, typename TNegTrackTable, typename TGoodTrackTable>
   void DecayFinderMC(TCollisionTable const& dCollision, TPosTrackTable const& dPtracks, TNegTrackTable const& dNtracks, TGoodTrackTable const& dGoodtracks)
   {
+    std::vector<typename TTrackClass::iterator> bachelors;
+    for (auto& t2id : dGoodtracks) {
+      bachelors.push_back(t2id.template goodTrack_as<TTrackClass>());
+    }
+    if (d_UseBachPrefilter) {
+      fillBachelorSectors(bachelors);
+    }
+
     for (auto& t0id : dPtracks) { // FIXME: turn into combination(...)
       auto t0 = t0id.template goodTrack_as<TTrackClass>();
       for (auto& t1id : dNtracks) {
@@ -773,8 +905,8 @@ struct hypertriton3bodyFinder {
           continue;
         }
 
-        for (auto& t2id : dGoodtracks) {
-          auto t2 = t2id.template goodTrack_as<TTrackClass>();
+        auto processBachelor = [&](int iBach) {
+          auto& t2 = bachelors[iBach];
 
           bool isTrue3bodyVtx = false;
           if (t0.has_mcParticle() && t1.has_mcParticle() && t2.has_mcParticle()) {
@@ -797,6 +929,14 @@ struct hypertriton3bodyFinder {
           }
 
           Decay3bodyFinder<TTrackClass>(dCollision, t0, t1, t2, rv0, isTrue3bodyVtx);
+        };
+
+        if (d_UseBachPrefilter) {
+          forEachBachelorCandidate(processBachelor);
+        } else {
+          for (size_t iBach = 0; iBach < bachelors.size(); iBach++) {
+            processBachelor(iBach);
+          }
         }
       }
     }
@@ -267,6 +267,7 @@ struct nucleiSpectra {
   ConfigurableAxis cfgNTPCClusBins{"cfgNTPCClusBins", {3, 89.5, 159.5}, "N TPC clusters binning"};
 
   Configurable<bool> cfgSkimmedProcessing{"cfgSkimmedProcessing", false, "Skimmed dataset processing"};
+  Configurable<std::string> cfgZorroLocalCache{"cfgZorroLocalCache", "", "Directory of the local cache of the trigger selections for the skimmed dataset processing, disabled if empty"};
 
   // CCDB options
   Configurable<int> cfgMaterialCorrection{"cfgMaterialCorrection", static_cast<int>(o2::base::Propagator::MatCorrType::USEMatCorrLUT), "Type of material correction"};
@@ -337,6 +338,7 @@ struct nucleiSpectra {
       return;
     }
     if (cfgSkimmedProcessing) {
+      zorro.setLocalCachePath(cfgZorroLocalCache);
       zorro.initCCDB(ccdb.service, bc.runNumber(), bc.timestamp(), "fHe3");
     }
     auto timestamp = bc.timestamp();
@@ -36,12 +36,15 @@
 //    david.dobrigkeit.chinellato@cern.ch
 //
 
+#include <algorithm>
 #include <cmath>
 #include <array>
 #include <cstdlib>
 #include <map>
 #include <iterator>
+#include <thread>
 #include <utility>
+#include <vector>
 
 #include "Framework/runDataProcessing.h"
 #include "Framework/RunningWorkflowInfo.h"
@@ -240,6 +243,10 @@ struct cascadeBuilder {
 
   Configurable<float> maxDaughterEta{"maxDaughterEta", 5.0, "Maximum daughter eta"};
 
+  // parallel building of the cascades of a collision (DCAFitter-based building only)
+  Configurable<int> nThreadsCascadeBuilding{"nThreadsCascadeBuilding", 1, "Number of threads for the cascade DCA fits, 1: build the cascades one by one"};
+  Configurable<int> minCascadesPerThread{"minCascadesPerThread", 32, "Minimum number of cascade DCA fits per thread"};
+
   int mRunNumber;
   float d_bz;
   float maxSnp;  // max sine phi for propagation
@@ -270,7 +277,7 @@ struct cascadeBuilder {
                   kNCascSteps };
 
   // Helper struct to pass cascade information
-  struct {
+  struct CascadeCandidate {
     int v0Id;
     int positiveId;
     int negativeId;
@@ -320,6 +327,38 @@ struct cascadeBuilder {
   o2::track::TrackParCov lV0Track;
   o2::track::TrackParCov lCascadeTrack;
 
+  // Result of the DCA fit of the V0 and the bachelor of a cascade candidate
+  struct CascadeFit {
+    int nCand = 0;
+    bool caughtException = false;
+    o2::track::TrackParCov v0Track;      // V0 at the cascade decay vertex
+    o2::track::TrackParCov bachTrack;    // bachelor at the cascade decay vertex
+    o2::track::TrackParCov cascadeTrack; // cascade from the decay vertex
+    std::array<float, 3> pca;            // cascade decay vertex
+    float chi2 = 0.f;                    // chi2 at the decay vertex
+    std::array<float, 6> pcaCov;         // decay vertex covariance, if cascade cov matrices are produced
+  };
+  CascadeFit cascadeFit; // fit of the cascade built in the calling thread
+
+  // parallel cascade building
+  std::vector<o2::vertexing::DCAFitterN<2>> fitterWorkers;       // DCA fitters of the worker threads
+  std::vector<CascadeCandidate> preselectedCandidates;           // cascade information of the preselected candidates
+  std::vector<o2::track::TrackParCov> preselectedV0Tracks;       // V0s of the preselected candidates
+  std::vector<o2::track::TrackParCov> preselectedBachelorTracks; // bachelors of the preselected candidates
+  std::vector<CascadeFit> preselectedFits;                       // DCA fits of the preselected candidates
+
+  // V0 daughters at the decay vertex from the V0 builder, re-used in the KF building instead of re-fitting the V0
+  struct V0DauFit {
+    o2::track::TrackParCov posTrack;
+    o2::track::TrackParCov negTrack;
+    float dcaV0dau;
+    float dcapostopv;
+    float dcanegtopv;
+    int collisionId;
+  };
+  std::vector<V0DauFit> v0DauFits;
+  std::vector<int> v0DauFitOfV0; // index in v0DauFits of each V0, -1 if not built by the V0 builder
+
   // Helper struct to do bookkeeping of building parameters
   struct {
     std::array<int32_t, kNCascSteps> cascstats;
@@ -535,7 +574,7 @@ struct cascadeBuilder {
       lut = o2::base::MatLayerCylSet::rectifyPtrFromFile(ccdb->get<o2::base::MatLayerCylSet>(ccdbConfigurations.lutPath));
     }
 
-    if (doprocessRun2 == false && doprocessRun3 == false && doprocessRun3withStrangenessTracking == false && doprocessRun3withKFParticle == false && doprocessFindableRun3 == false) {
+    if (doprocessRun2 == false && doprocessRun3 == false && doprocessRun3withStrangenessTracking == false && doprocessRun3withKFParticle == false && doprocessRun3withKFParticleAndV0DauFits == false && doprocessFindableRun3 == false) {
       LOGF(fatal, "Neither processRun2 nor processRun3 nor processRun3withstrangenesstracking nor processFindableRun3 enabled. Please choose one!");
     }
     if (doprocessRun2 == true && doprocessRun3 == true) {
@@ -547,6 +586,9 @@ struct cascadeBuilder {
     if (doprocessRun2 == true && doprocessRun3withStrangenessTracking == true) {
       LOGF(fatal, "Cannot enable processRun2 and processRun3withstrangenesstracking at the same time. Please choose one.");
     }
+    if (doprocessRun3withKFParticle == true && doprocessRun3withKFParticleAndV0DauFits == true) {
+      LOGF(fatal, "Cannot enable processRun3withKFParticle and processRun3withKFParticleAndV0DauFits at the same time. Please choose one.");
+    }
 
     if (d_UseAutodetectMode) {
       // Checking for subscriptions to:
@@ -677,6 +719,14 @@ struct cascadeBuilder {
     if (useMatCorrType == 2)
       matCorr = o2::base::Propagator::MatCorrType::USEMatCorrLUT;
     fitter.setMatCorrType(matCorr);
+    if (nThreadsCascadeBuilding > 1) {
+      if (useMatCorrType == 1) {
+        LOGF(warning, "TGeo material corrections cannot be used in parallel, the cascades will be built one by one");
+      } else {
+        fitterWorkers.assign(nThreadsCascadeBuilding, fitter);
+        LOGF(info, "-> Will fit the cascades with %i threads", static_cast<int>(nThreadsCascadeBuilding));
+      }
+    }
 
     matCorrCascade = o2::base::Propagator::MatCorrType::USEMatCorrNONE;
     if (useMatCorrTypeCasc == 1)
@@ -710,6 +760,9 @@ struct cascadeBuilder {
     if (d_bz_input > -990) {
       d_bz = d_bz_input;
       fitter.setBz(d_bz);
+      for (auto& fitterWorker : fitterWorkers) {
+        fitterWorker.setBz(d_bz);
+      }
       o2::parameters::GRPMagField grpmag;
       if (fabs(d_bz) > 1e-5) {
         grpmag.setL3Current(30000.f / (d_bz / 5.0f));
@@ -741,6 +794,9 @@ struct cascadeBuilder {
     mRunNumber = bc.runNumber();
     // Set magnetic field value once known
     fitter.setBz(d_bz);
+    for (auto& fitterWorker : fitterWorkers) {
+      fitterWorker.setBz(d_bz);
+    }
     /// Set magnetic field for KF vertexing
     KFParticle::SetField(d_bz);
 
@@ -926,6 +982,20 @@ struct cascadeBuilder {
 
   template <class TTrackTo, typename TCascObject, typename TV0Object>
   bool buildCascadeCandidate(TCascObject const& cascade, TV0Object const& v0)
+  {
+    if (!preselectCascadeCandidate<TTrackTo>(cascade, v0))
+      return false;
+    fitCascadeCandidate(fitter, lV0Track, lBachelorTrack, false, cascadeFit);
+    if (!selectCascadeCandidate<TTrackTo>(cascade, v0, cascadeFit))
+      return false;
+    if (createCascCovMats)
+      calculatePCACovariance(fitter, cascadeFit);
+    return true;
+  }
+
+  // Selections before the DCA fit, prepares lV0Track and lBachelorTrack
+  template <class TTrackTo, typename TCascObject, typename TV0Object>
+  bool preselectCascadeCandidate(TCascObject const& cascade, TV0Object const& v0)
   {
     // value 0.5: any considered cascade
     statisticsRegistry.cascstats[kCascAll]++;
@@ -1002,34 +1072,82 @@ struct cascadeBuilder {
       covV, 0, true);
     lV0Track.setAbsCharge(0);
     lV0Track.setPID(o2::track::PID::Lambda);
+    return true;
+  }
 
+  // DCA fit of the V0 and the bachelor, uses only the given fitter so that it can run in a worker thread
+  template <typename TFitter>
+  static void fitCascadeCandidate(TFitter& dcaFitter, o2::track::TrackParCov const& v0Track, o2::track::TrackParCov const& bachTrack, bool calculatePCACov, CascadeFit& fit)
+  {
     //---/---/---/
     // Move close to minima
-    int nCand = 0;
+    fit.nCand = 0;
+    fit.caughtException = false;
     try {
-      nCand = fitter.process(lV0Track, lBachelorTrack);
+      fit.nCand = dcaFitter.process(v0Track, bachTrack);
     } catch (...) {
+      fit.caughtException = true;
+      return;
+    }
+    if (fit.nCand == 0)
+      return;
+
+    fit.v0Track = dcaFitter.getTrack(0);
+    fit.bachTrack = dcaFitter.getTrack(1);
+    fit.chi2 = dcaFitter.getChi2AtPCACandidate();
+    const auto& vtx = dcaFitter.getPCACandidate();
+    for (int i = 0; i < 3; i++) {
+      fit.pca[i] = vtx[i];
+    }
+    fit.cascadeTrack = dcaFitter.createParentTrackParCov();
+    if (calculatePCACov)
+      calculatePCACovariance(dcaFitter, fit);
+  }
+
+  // Position covariance matrix of the last fit of the given fitter
+  template <typename TFitter>
+  static void calculatePCACovariance(TFitter& dcaFitter, CascadeFit& fit)
+  {
+    auto covVtxV = dcaFitter.calcPCACovMatrix(0);
+    fit.pcaCov[0] = covVtxV(0, 0);
+    fit.pcaCov[1] = covVtxV(1, 0);
+    fit.pcaCov[2] = covVtxV(1, 1);
+    fit.pcaCov[3] = covVtxV(2, 0);
+    fit.pcaCov[4] = covVtxV(2, 1);
+    fit.pcaCov[5] = covVtxV(2, 2);
+  }
+
+  // Selections after the DCA fit and calculation of the cascade properties
+  template <class TTrackTo, typename TCascObject, typename TV0Object>
+  bool selectCascadeCandidate(TCascObject const& cascade, TV0Object const& v0, CascadeFit const& fit)
+  {
+    auto bachTrack = cascade.template bachelor_as<TTrackTo>();
+    auto posTrack = v0.template posTrack_as<TTrackTo>();
+    auto negTrack = v0.template negTrack_as<TTrackTo>();
+    auto const& collision = cascade.collision();
+    gpu::gpustd::array<float, 2> dcaInfo;
+
+    if (fit.caughtException) {
       registry.fill(HIST("hCaughtExceptions"), 0.5f);
       LOG(error) << "Exception caught in DCA fitter process call!";
       return false;
     }
-    if (nCand == 0)
+    if (fit.nCand == 0)
       return false;
 
-    lV0Track = fitter.getTrack(0);
-    lBachelorTrack = fitter.getTrack(1);
+    lV0Track = fit.v0Track;
+    lBachelorTrack = fit.bachTrack;
 
     // DCA between cascade daughters
-    cascadecandidate.dcacascdau = TMath::Sqrt(fitter.getChi2AtPCACandidate());
+    cascadecandidate.dcacascdau = TMath::Sqrt(fit.chi2);
     if (cascadecandidate.dcacascdau > dcacascdau)
       return false;
     statisticsRegistry.cascstats[kCascDCADau]++;
 
-    fitter.getTrack(1).getPxPyPzGlo(cascadecandidate.bachP);
+    lBachelorTrack.getPxPyPzGlo(cascadecandidate.bachP);
     // get decay vertex coordinates
-    const auto& vtx = fitter.getPCACandidate();
     for (int i = 0; i < 3; i++) {
-      cascadecandidate.pos[i] = vtx[i];
+      cascadecandidate.pos[i] = fit.pca[i];
     }
 
     if (qaConfigurations.d_doQA && d_doPtDep_CosPaCut) {
@@ -1081,7 +1199,7 @@ struct cascadeBuilder {
     statisticsRegistry.cascstats[kCascDauEta]++;
 
     // Calculate DCAxy of the cascade (with bending)
-    lCascadeTrack = fitter.createParentTrackParCov();
+    lCascadeTrack = fit.cascadeTrack;
     lCascadeTrack.setAbsCharge(cascadecandidate.charge); // to be sure
     lCascadeTrack.setPID(o2::track::PID::XiMinus);       // FIXME: not OK for omegas
     dcaInfo[0] = 999;
@@ -1259,12 +1377,23 @@ struct cascadeBuilder {
     o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, bachTrackPar, 2.f, fitter.getMatCorrType(), &dcaInfo);
     cascadecandidate.bachDCAxy = dcaInfo[0];
 
-    o2::track::TrackParCov posTrackParCovForDCA = getTrackParCov(posTrack);
-    o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, posTrackParCovForDCA, 2.f, fitter.getMatCorrType(), &dcaInfo);
-    cascadecandidate.v0dcapostopv = dcaInfo[0];
-    o2::track::TrackParCov negTrackParCovForDCA = getTrackParCov(negTrack);
-    o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, negTrackParCovForDCA, 2.f, fitter.getMatCorrType(), &dcaInfo);
-    cascadecandidate.v0dcanegtopv = dcaInfo[0];
+    // V0 daughters already fitted by the V0 builder with respect to the same collision, if available
+    const V0DauFit* v0DauFit = nullptr;
+    if (v0.globalIndex() < static_cast<int64_t>(v0DauFitOfV0.size()) && v0DauFitOfV0[v0.globalIndex()] >= 0 && v0DauFits[v0DauFitOfV0[v0.globalIndex()]].collisionId == cascade.collisionId()) {
+      v0DauFit = &v0DauFits[v0DauFitOfV0[v0.globalIndex()]];
+    }
+
+    if (v0DauFit) {
+      cascadecandidate.v0dcapostopv = v0DauFit->dcapostopv;
+      cascadecandidate.v0dcanegtopv = v0DauFit->dcanegtopv;
+    } else {
+      o2::track::TrackParCov posTrackParCovForDCA = getTrackParCov(posTrack);
+      o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, posTrackParCovForDCA, 2.f, fitter.getMatCorrType(), &dcaInfo);
+      cascadecandidate.v0dcapostopv = dcaInfo[0];
+      o2::track::TrackParCov negTrackParCovForDCA = getTrackParCov(negTrack);
+      o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, negTrackParCovForDCA, 2.f, fitter.getMatCorrType(), &dcaInfo);
+      cascadecandidate.v0dcanegtopv = dcaInfo[0];
+    }
 
     if (TMath::Abs(cascadecandidate.bachDCAxy) < dcabachtopv)
       return false;
@@ -1285,7 +1414,12 @@ struct cascadeBuilder {
     //__________________________________________
     //*>~<* step 1 : V0 with dca fitter, uses material corrections implicitly
     // This is optional - move close to minima and therefore take material
-    if (kfDoDCAFitterPreMinimV0) {
+    if (kfDoDCAFitterPreMinimV0 && v0DauFit) {
+      // re-use the V0 builder fit
+      cascadecandidate.v0dcadau = v0DauFit->dcaV0dau;
+      posTrackParCov = v0DauFit->posTrack;
+      negTrackParCov = v0DauFit->negTrack;
+    } else if (kfDoDCAFitterPreMinimV0) {
       int nCand = 0;
       try {
         nCand = fitter.process(posTrackParCov, negTrackParCov);
@@ -1542,6 +1676,82 @@ struct cascadeBuilder {
     if (!validCascadeCandidate)
       return; // doesn't pass cascade selections
 
+    fillCascadeTables(cascade, cascadeFit);
+  }
+
+  // Applies a function to the V0 row of a cascade, either specific for cascades or general
+  template <typename TV0Index, typename TFunction>
+  bool applyToV0Row(TV0Index const& v0index, TFunction&& function)
+  {
+    if (v0index.has_v0Data()) {
+      return function(v0index.template v0Data_as<V0full>());
+    }
+    if (v0index.has_v0fCData()) {
+      return function(v0index.template v0fCData_as<V0fCfull>());
+    }
+    return false; // this was inadequately linked, should not happen
+  }
+
+  // Builds the cascades of a collision with the DCA fits done in parallel by the worker threads
+  // The selections before and after the fits are done in this thread, in cascade order, as they fill
+  // the statistics and the QA histograms, such that the output is the same as when building the cascades one by one
+  template <class TTrackTo, typename TCascTable, typename TGetV0Index>
+  void buildCascadesInParallel(TCascTable const& cascades, TGetV0Index const& getV0Index)
+  {
+    std::vector<typename TCascTable::iterator> preselectedCascades;
+    preselectedCascades.reserve(cascades.size());
+    preselectedCandidates.clear();
+    preselectedV0Tracks.clear();
+    preselectedBachelorTracks.clear();
+    for (auto& cascade : cascades) {
+      bool isPreselected = applyToV0Row(getV0Index(cascade), [&](auto const& v0) {
+        return preselectCascadeCandidate<TTrackTo>(cascade, v0);
+      });
+      if (!isPreselected)
+        continue;
+      preselectedCascades.push_back(cascade);
+      preselectedCandidates.push_back(cascadecandidate);
+      preselectedV0Tracks.push_back(lV0Track);
+      preselectedBachelorTracks.push_back(lBachelorTrack);
+    }
+
+    // DCA fits, in contiguous ranges of candidates, the first one in this thread
+    const int nFits = preselectedCascades.size();
+    if (nFits == 0)
+      return;
+    preselectedFits.resize(nFits);
+    const int nThreads = std::clamp(nFits / std::max(static_cast<int>(minCascadesPerThread), 1), 1, static_cast<int>(fitterWorkers.size()));
+    const int nFitsPerThread = (nFits + nThreads - 1) / nThreads;
+    const bool calculatePCACov = createCascCovMats;
+    auto fitRange = [&](int iThread) {
+      for (int iFit = iThread * nFitsPerThread; iFit < std::min(nFits, (iThread + 1) * nFitsPerThread); ++iFit) {
+        fitCascadeCandidate(fitterWorkers[iThread], preselectedV0Tracks[iFit], preselectedBachelorTracks[iFit], calculatePCACov, preselectedFits[iFit]);
+      }
+    };
+    std::vector<std::thread> threads;
+    for (int iThread = 1; iThread < nThreads; ++iThread) {
+      threads.emplace_back(fitRange, iThread);
+    }
+    fitRange(0);
+    for (auto& thread : threads) {
+      thread.join();
+    }
+
+    // selections after the fits and table filling, in cascade order
+    for (int iFit = 0; iFit < nFits; ++iFit) {
+      auto const& cascade = preselectedCascades[iFit];
+      cascadecandidate = preselectedCandidates[iFit];
+      bool isSelected = applyToV0Row(getV0Index(cascade), [&](auto const& v0) {
+        return selectCascadeCandidate<TTrackTo>(cascade, v0, preselectedFits[iFit]);
+      });
+      if (isSelected)
+        fillCascadeTables(cascade, preselectedFits[iFit]);
+    }
+  }
+
+  template <typename TCascade>
+  void fillCascadeTables(TCascade const& cascade, CascadeFit const& fit)
+  {
     // round the DCA variables to a certain precision if asked
     if (roundDCAVariables)
       roundCascadeCandidateVariables();
@@ -1568,16 +1778,12 @@ struct cascadeBuilder {
 
     // populate cascade covariance matrices if required by any other task
     if (createCascCovMats) {
-      // Calculate position covariance matrix
-      auto covVtxV = fitter.calcPCACovMatrix(0);
+      // Position covariance matrix, calculated with the fit
       // std::array<float, 6> positionCovariance;
       float positionCovariance[6];
-      positionCovariance[0] = covVtxV(0, 0);
-      positionCovariance[1] = covVtxV(1, 0);
-      positionCovariance[2] = covVtxV(1, 1);
-      positionCovariance[3] = covVtxV(2, 0);
-      positionCovariance[4] = covVtxV(2, 1);
-      positionCovariance[5] = covVtxV(2, 2);
+      for (int i = 0; i < 6; i++) {
+        positionCovariance[i] = fit.pcaCov[i];
+      }
       // store momentum covariance matrix
       std::array<float, 21> covTv0 = {0.};
       std::array<float, 21> covTbachelor = {0.};
@@ -1597,12 +1803,16 @@ struct cascadeBuilder {
   void buildStrangenessTables(TCascTable const& cascades)
   {
     statisticsRegistry.eventCounter++;
-    for (auto& cascade : cascades) {
-      // de-reference from V0 pool, either specific for cascades or general
-      // use templatizing to avoid code duplication
+    if (!fitterWorkers.empty()) {
+      buildCascadesInParallel<TTrackTo>(cascades, [](auto const& cascade) { return cascade.template v0_as<aod::V0sLinked>(); });
+    } else {
+      for (auto& cascade : cascades) {
+        // de-reference from V0 pool, either specific for cascades or general
+        // use templatizing to avoid code duplication
 
-      auto v0index = cascade.template v0_as<aod::V0sLinked>();
-      processCascadeCandidate<TTrackTo>(v0index, cascade);
+        auto v0index = cascade.template v0_as<aod::V0sLinked>();
+        processCascadeCandidate<TTrackTo>(v0index, cascade);
+      }
     }
     // En masse filling at end of process call
     fillHistos();
@@ -1613,12 +1823,16 @@ struct cascadeBuilder {
   void buildFindableStrangenessTables(TCascTable const& cascades)
   {
     statisticsRegistry.eventCounter++;
-    for (auto& cascade : cascades) {
-      // de-reference from V0 pool, either specific for cascades or general
-      // use templatizing to avoid code duplication
+    if (!fitterWorkers.empty()) {
+      buildCascadesInParallel<TTrackTo>(cascades, [](auto const& cascade) { return cascade.template findableV0_as<aod::FindableV0sLinked>(); });
+    } else {
+      for (auto& cascade : cascades) {
+        // de-reference from V0 pool, either specific for cascades or general
+        // use templatizing to avoid code duplication
 
-      auto v0index = cascade.template findableV0_as<aod::FindableV0sLinked>();
-      processCascadeCandidate<TTrackTo>(v0index, cascade);
+        auto v0index = cascade.template findableV0_as<aod::FindableV0sLinked>();
+        processCascadeCandidate<TTrackTo>(v0index, cascade);
+      }
     }
     // En masse filling at end of process call
     fillHistos();
@@ -1946,6 +2160,33 @@ struct cascadeBuilder {
   }
   PROCESS_SWITCH(cascadeBuilder, processRun3withKFParticle, "Produce Run 3 KF cascade tables", false);
 
+  void processRun3withKFParticleAndV0DauFits(aod::Collisions const& collisions, soa::Filtered<TaggedCascades> const& cascades, FullTracksExtIU const& tracks, aod::BCsWithTimestamps const& bcs, aod::V0s const& V0s, aod::V0DauTrackParCovs const& v0DauTrackParCovs)
+  {
+    // index the V0 daughters fitted by the V0 builder
+    v0DauFits.clear();
+    v0DauFitOfV0.assign(V0s.size(), -1);
+    for (const auto& v0DauTrackParCov : v0DauTrackParCovs) {
+      if (v0DauTrackParCov.v0Id() < 0 || v0DauTrackParCov.v0Id() >= static_cast<int>(V0s.size())) {
+        continue;
+      }
+      const float* parPos = v0DauTrackParCov.parPosDau();
+      const float* parNeg = v0DauTrackParCov.parNegDau();
+      std::array<float, 15> covPos;
+      std::array<float, 15> covNeg;
+      std::copy(v0DauTrackParCov.covPosDau(), v0DauTrackParCov.covPosDau() + 15, covPos.begin());
+      std::copy(v0DauTrackParCov.covNegDau(), v0DauTrackParCov.covNegDau() + 15, covNeg.begin());
+      v0DauFitOfV0[v0DauTrackParCov.v0Id()] = v0DauFits.size();
+      v0DauFits.push_back({o2::track::TrackParCov(parPos[0], parPos[1], {parPos[2], parPos[3], parPos[4], parPos[5], parPos[6]}, covPos),
+                           o2::track::TrackParCov(parNeg[0], parNeg[1], {parNeg[2], parNeg[3], parNeg[4], parNeg[5], parNeg[6]}, covNeg),
+                           v0DauTrackParCov.dcaV0daughters(), v0DauTrackParCov.dcapostopv(), v0DauTrackParCov.dcanegtopv(),
+                           v0DauTrackParCov.collisionId()});
+    }
+
+    processRun3withKFParticle(collisions, cascades, tracks, bcs, V0s);
+    v0DauFitOfV0.clear();
+  }
+  PROCESS_SWITCH(cascadeBuilder, processRun3withKFParticleAndV0DauFits, "Produce Run 3 KF cascade tables, re-using the V0 daughters fitted by the V0 builder", false);
+
   void processRun3withStrangenessTracking(aod::Collisions const& collisions, aod::V0sLinked const&, V0full const&, V0fCfull const&, soa::Filtered<TaggedCascades> const& cascades, FullTracksExtIU const&, aod::BCsWithTimestamps const&, aod::TrackedCascades const& trackedCascades)
   {
     for (const auto& collision : collisions) {
@@ -40,6 +40,7 @@
 #include "Common/DataModel/PIDResponse.h"
 #include "PWGLF/DataModel/LFStrangenessTables.h"
 #include "PWGLF/DataModel/LFStrangenessFinderTables.h"
+#include "PWGLF/Utils/strangenessFinderPrefilter.h"
 #include "Common/Core/TrackSelection.h"
 #include "Common/DataModel/TrackSelectionTables.h"
 #include "Common/DataModel/EventSelection.h"
@@ -56,6 +57,7 @@
 #include <cmath>
 #include <array>
 #include <cstdlib>
+#include <vector>
 
 using namespace o2;
 using namespace o2::framework;
@@ -137,6 +139,7 @@ struct cascadefinder {
   Produces<aod::StoredCascCores> cascdata;
 
   OutputObj<TH1F> hCandPerEvent{TH1F("hCandPerEvent", "", 100, 0, 100)};
+  OutputObj<TH1F> hPrefilterStatistics{TH1F("hPrefilterStatistics", "", 4, -0.5, 3.5)};
 
   // Configurables
   Configurable<double> d_bz{"d_bz", +5.0, "bz field"};
@@ -147,6 +150,52 @@ struct cascadefinder {
   Configurable<float> dcav0dau{"dcacascdau", 1.0, "DCA Casc Daughters"};
   Configurable<float> v0radius{"cascradius", 1.0, "cascradius"};
 
+  // V0-bachelor selections before the DCA fit
+  Configurable<bool> doTopologyPrefilter{"doTopologyPrefilter", true, "reject V0-bachelor pairs from their trajectories in the transverse plane before the DCA fit"};
+  Configurable<float> prefilterMaxDCAxy{"prefilterMaxDCAxy", 2.0, "topology prefilter: maximum transverse distance between the V0 and bachelor trajectories (cm)"};
+  Configurable<float> prefilterV0VertexTolerance{"prefilterV0VertexTolerance", 1.0, "topology prefilter: maximum distance of the cascade decay point past the V0 decay point (cm)"};
+
+  // Analytic prefilter of the V0-bachelor pairs
+  enum prefilterStep { kPrefilterAll = 0,
+                       kPrefilterDCAxy,
+                       kPrefilterPosition,
+                       kPrefilterFitted,
+                       kNPrefilterSteps };
+  o2::pwglf::TopologyPrefilter topologyPrefilter;
+  std::vector<o2::pwglf::TrajectoryXY> posBachTrajectories; // transverse-plane trajectories of the positive bachelors
+  std::vector<o2::pwglf::TrajectoryXY> negBachTrajectories; // transverse-plane trajectories of the negative bachelors
+  std::array<Long_t, kNPrefilterSteps> prefilterCounters;
+
+  void init(InitContext const&)
+  {
+    topologyPrefilter.maxDCAxy = prefilterMaxDCAxy;
+    topologyPrefilter.maxRadius = 200.; // as the fitter
+    topologyPrefilter.maxLinePath = prefilterV0VertexTolerance;
+    hPrefilterStatistics->GetXaxis()->SetBinLabel(1, "All pairs");
+    hPrefilterStatistics->GetXaxis()->SetBinLabel(2, "Rejected: transverse DCA");
+    hPrefilterStatistics->GetXaxis()->SetBinLabel(3, "Rejected: position");
+    hPrefilterStatistics->GetXaxis()->SetBinLabel(4, "Fitted");
+  }
+
+  // Returns true if the V0-bachelor pair passes the topology prefilter, and counts the pairs
+  bool passesTopologyPrefilter(o2::pwglf::TrajectoryXY const& v0Trajectory, o2::pwglf::TrajectoryXY const& bachTrajectory)
+  {
+    prefilterCounters[kPrefilterAll]++;
+    if (doTopologyPrefilter) {
+      auto decision = topologyPrefilter.check(v0Trajectory, bachTrajectory);
+      if (decision == o2::pwglf::TopologyPrefilter::kRejectedDCAxy) {
+        prefilterCounters[kPrefilterDCAxy]++;
+        return false;
+      }
+      if (decision == o2::pwglf::TopologyPrefilter::kRejectedRadius) {
+        prefilterCounters[kPrefilterPosition]++;
+        return false;
+      }
+    }
+    prefilterCounters[kPrefilterFitted]++;
+    return true;
+  }
+
   // Process: subscribes to a lot of things!
   void process(aod::Collision const& collision,
                soa::Join<aod::FullTracks, aod::TracksCov> const& /*tracks*/,
@@ -177,6 +226,17 @@ struct cascadefinder {
     fitterCasc.setUseAbsDCA(d_UseAbsDCA);
 
     Long_t lNCand = 0;
+    prefilterCounters.fill(0);
+
+    // the trajectories of the bachelors are calculated once for all the V0s
+    posBachTrajectories.clear();
+    negBachTrajectories.clear();
+    for (auto& t0id : pBachtracks) {
+      posBachTrajectories.push_back(o2::pwglf::getTrajectoryXY(getTrackPar(t0id.goodPosTrack_as<soa::Join<aod::FullTracks, aod::TracksCov>>()), d_bz));
+    }
+    for (auto& t0id : nBachtracks) {
+      negBachTrajectories.push_back(o2::pwglf::getTrajectoryXY(getTrackPar(t0id.goodNegTrack_as<soa::Join<aod::FullTracks, aod::TracksCov>>()), d_bz));
+    }
 
     std::array<float, 3> pos = {0.};
     std::array<float, 3> posXi = {0.};
@@ -226,8 +286,13 @@ struct cascadefinder {
 
         auto tV0 = o2::track::TrackParCov(vertex, momentum, covV0, 0);
         tV0.setQ2Pt(0); // No bending, please
+        auto v0Trajectory = o2::pwglf::getTrajectoryXY(vertex[0], vertex[1], momentum[0], momentum[1]);
 
+        int iBachTrack = -1;
         for (auto& t0id : nBachtracks) {
+          iBachTrack++;
+          if (!passesTopologyPrefilter(v0Trajectory, negBachTrajectories[iBachTrack]))
+            continue;
           auto t0 = t0id.goodNegTrack_as<soa::Join<aod::FullTracks, aod::TracksCov>>();
           auto bTrack = getTrackParCov(t0);
 
@@ -316,8 +381,13 @@ struct cascadefinder {
 
         auto tV0 = o2::track::TrackParCov(vertex, momentum, covV0, 0);
         tV0.setQ2Pt(0); // No bending, please
+        auto v0Trajectory = o2::pwglf::getTrajectoryXY(vertex[0], vertex[1], momentum[0], momentum[1]);
 
+        int iBachTrack = -1;
         for (auto& t0id : pBachtracks) {
+          iBachTrack++;
+          if (!passesTopologyPrefilter(v0Trajectory, posBachTrajectories[iBachTrack]))
+            continue;
           auto t0 = t0id.goodPosTrack_as<soa::Join<aod::FullTracks, aod::TracksCov>>();
           auto bTrack = getTrackParCov(t0);
 
@@ -366,6 +436,9 @@ struct cascadefinder {
     }       // end loop over anticascades
 
     hCandPerEvent->Fill(lNCand);
+    for (int i = 0; i < kNPrefilterSteps; i++) {
+      hPrefilterStatistics->Fill(i, prefilterCounters[i]);
+    }
   }
 };
 
@@ -36,12 +36,14 @@
 //    david.dobrigkeit.chinellato@cern.ch
 //
 
+#include <algorithm>
 #include <cmath>
 #include <array>
 #include <cstdlib>
 #include <map>
 #include <iterator>
 #include <utility>
+#include <vector>
 
 #include "TRandom3.h"
 #include "Framework/runDataProcessing.h"
@@ -112,6 +114,7 @@ struct lambdakzeroBuilder {
   Produces<aod::V0TraPosAtDCAs> v0dauPositions;  // auxiliary debug information
   Produces<aod::V0TraPosAtIUs> v0dauPositionsIU; // auxiliary debug information
   Produces<aod::V0Ivanovs> v0ivanovs;
+  Produces<aod::V0DauTrackParCovs> v0dauTrackParCovs; // daughters at decay vertex, for the cascade builder
 
   Produces<aod::V0fCIndices> v0fcindices;
   Produces<aod::StoredV0fCCores> v0fccores;
@@ -132,6 +135,7 @@ struct lambdakzeroBuilder {
   Configurable<int> createV0DauCovMats{"createV0DauCovMats", -1, {"Produces V0 cov matrices for daughter tracks. -1: auto, 0: don't, 1: yes. Default: auto (-1)"}};
   Configurable<int> createV0PosAtDCAs{"createV0PosAtDCAs", 0, {"Produces V0 track positions at minima. 0: don't, 1: yes. Default: no (0)"}};
   Configurable<int> createV0PosAtIUs{"createV0PosAtIUs", 0, {"Produces V0 track positions at IU. 0: don't, 1: yes. Default: no (0)"}};
+  Configurable<int> createV0DauTrackParCovs{"createV0DauTrackParCovs", -1, {"Produces the daughter tracks at the decay vertex for the cascade builder. -1: auto, 0: don't, 1: yes. Default: auto (-1)"}};
 
   Configurable<bool> storePhotonCandidates{"storePhotonCandidates", false, "store photon candidates (yes/no)"};
 
@@ -162,6 +166,9 @@ struct lambdakzeroBuilder {
 
   Configurable<int> tpcrefit{"tpcrefit", 0, "demand TPC refit"};
 
+  // batched building: pre-selection of all the V0s of a DF before any fit
+  Configurable<bool> useBatchedBuilding{"useBatchedBuilding", false, "pre-select all V0s of a DF at once (daughter DCAs to PV shared between V0s), then fit only the survivors"};
+
   // select momentum slice if desired
   Configurable<float> minimumPt{"minimumPt", 0.0f, "Minimum pT to store candidate"};
   Configurable<float> maximumPt{"maximumPt", 1000.0f, "Maximum pT to store candidate"};
@@ -440,6 +447,24 @@ struct lambdakzeroBuilder {
   o2::track::TrackParCov lPositiveTrackIU;
   o2::track::TrackParCov lNegativeTrackIU;
 
+  // Helper struct for the batched building: daughters of all the V0s of a DF
+  // N.B.: the daughters propagated to the PV are shared by all V0s with the same track and collision
+  struct {
+    std::vector<int> entryOfTrack;              // cached daughter entry of each track, -1 if none
+    std::vector<int> collisionOfTrack;          // collision the cached entry of each track refers to
+    std::vector<o2::track::TrackPar> trackPars; // daughters propagated to the DCA to the PV
+    std::vector<std::array<float, 2>> dcas;     // DCAxy and DCAz of the daughters to the PV
+    std::vector<o2::dataformats::VertexBase> primaryVertices;
+    std::vector<int> posEntries;
+    std::vector<int> negEntries;
+    std::vector<float> posDCAxy;
+    std::vector<float> negDCAxy;
+    std::vector<uint8_t> hasCollision;
+    std::vector<uint8_t> passesTPCrefit;
+    std::vector<uint8_t> isPreselected;
+    size_t nV0s;
+  } v0batch;
+
   void init(InitContext& context)
   {
     prng.SetSeed(0);
@@ -645,6 +670,8 @@ struct lambdakzeroBuilder {
       v0radius.value = loosest_radius;
     }
 
+    enableFlagIfTableRequired(context, "V0DauTrackParCovs", createV0DauTrackParCovs);
+
     //*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*
     LOGF(info, " -+*> process call configuration:");
     if (doprocessRun2 == true) {
@@ -659,6 +686,9 @@ struct lambdakzeroBuilder {
     if (createV0DauCovMats > 0) {
       LOGF(info, " ---+*> Will produce V0 cov mat table for decay daughters");
     }
+    if (createV0DauTrackParCovs > 0) {
+      LOGF(info, " ---+*> Will produce V0 daughter tracks at decay vertex table");
+    }
     //*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*+-+*
 
     // initialize O2 2-prong fitter (only once)
@@ -858,6 +888,17 @@ struct lambdakzeroBuilder {
     if (!V0.has_collision())
       statisticsRegistry.v0statsUnassociated[kV0DCAxy]++;
 
+    return fitV0Candidate<TTrackTo>(V0, primaryVertex, posTrackPar, negTrackPar, dcaInfo);
+  }
+
+  // fit the decay vertex of a V0 passing the daughter DCA selections and apply the topological selections
+  // posTrackPar and negTrackPar are the daughters at their DCA to the primary vertex, dcaInfo the DCAs of the negative daughter
+  template <class TTrackTo, typename TV0Object>
+  bool fitV0Candidate(TV0Object const& V0, o2::dataformats::VertexBase const& primaryVertex, o2::track::TrackPar const& posTrackPar, o2::track::TrackPar const& negTrackPar, gpu::gpustd::array<float, 2> const& dcaInfo)
+  {
+    auto const& posTrack = V0.template posTrack_as<TTrackTo>();
+    auto const& negTrack = V0.template negTrack_as<TTrackTo>();
+
     // Change strangenessBuilder tracks
     lPositiveTrack = getTrackParCov(posTrack);
     lNegativeTrack = getTrackParCov(negTrack);
@@ -1114,18 +1155,154 @@ struct lambdakzeroBuilder {
     return true;
   }
 
+  // get the cached entry of a V0 daughter propagated to the DCA to the PV, propagating it on first use
+  template <typename TTrack>
+  int getBatchedDaughter(TTrack const& track, int collisionId, o2::dataformats::VertexBase const& primaryVertex)
+  {
+    auto trackId = track.globalIndex();
+    if (trackId >= static_cast<int64_t>(v0batch.entryOfTrack.size())) {
+      v0batch.entryOfTrack.resize(trackId + 1, -1);
+      v0batch.collisionOfTrack.resize(trackId + 1, -1);
+    }
+    if (v0batch.entryOfTrack[trackId] >= 0 && v0batch.collisionOfTrack[trackId] == collisionId) {
+      return v0batch.entryOfTrack[trackId];
+    }
+    gpu::gpustd::array<float, 2> dcaInfo;
+    auto& trackPar = v0batch.trackPars.emplace_back(getTrackPar(track));
+    o2::base::Propagator::Instance()->propagateToDCABxByBz({primaryVertex.getX(), primaryVertex.getY(), primaryVertex.getZ()}, trackPar, 2.f, fitter.getMatCorrType(), &dcaInfo);
+    v0batch.dcas.push_back({dcaInfo[0], dcaInfo[1]});
+    v0batch.entryOfTrack[trackId] = v0batch.trackPars.size() - 1;
+    v0batch.collisionOfTrack[trackId] = collisionId;
+    return v0batch.entryOfTrack[trackId];
+  }
+
+  // pre-select all the V0s of a DF in a few passes: daughter gathering and propagation to the PV,
+  // then daughter DCA selections as a plain loop over the gathered columns
   template <class TTrackTo, typename TV0Table>
-  void buildStrangenessTables(TV0Table const& V0s)
+  void preselectV0sBatched(TV0Table const& V0s)
   {
-    // Loops over all V0s in the time frame
+    std::fill(v0batch.entryOfTrack.begin(), v0batch.entryOfTrack.end(), -1);
+    v0batch.trackPars.clear();
+    v0batch.dcas.clear();
+    v0batch.primaryVertices.clear();
+    v0batch.posEntries.clear();
+    v0batch.negEntries.clear();
+    v0batch.posDCAxy.clear();
+    v0batch.negDCAxy.clear();
+    v0batch.hasCollision.clear();
+    v0batch.passesTPCrefit.clear();
+
+    // pass 1: gather the daughters and their DCAs to the PV
     for (auto& V0 : V0s) {
-      // downscale some V0s if requested to do so
+      // downscale some V0s if requested to do so (the rest of the DF is skipped, as in the V0-by-V0 building)
       if (downscalingOptions.downscaleFactor < 1.f && (static_cast<float>(rand_r(&randomSeed)) / static_cast<float>(RAND_MAX)) > downscalingOptions.downscaleFactor) {
-        return;
+        break;
+      }
+      auto const& posTrack = V0.template posTrack_as<TTrackTo>();
+      auto const& negTrack = V0.template negTrack_as<TTrackTo>();
+
+      auto& primaryVertex = v0batch.primaryVertices.emplace_back();
+      if (V0.has_collision()) {
+        auto const& collision = V0.collision();
+        primaryVertex.setPos({collision.posX(), collision.posY(), collision.posZ()});
+        primaryVertex.setCov(collision.covXX(), collision.covXY(), collision.covYY(), collision.covXZ(), collision.covYZ(), collision.covZZ());
+      } else {
+        primaryVertex.setPos({mVtx->getX(), mVtx->getY(), mVtx->getZ()});
+      }
+      v0batch.hasCollision.push_back(V0.has_collision());
+
+      bool passesTPCrefit = !tpcrefit || ((posTrack.trackType() & o2::aod::track::TPCrefit) && (negTrack.trackType() & o2::aod::track::TPCrefit));
+      v0batch.passesTPCrefit.push_back(passesTPCrefit);
+      if (!passesTPCrefit) {
+        v0batch.posEntries.push_back(-1);
+        v0batch.negEntries.push_back(-1);
+        v0batch.posDCAxy.push_back(0.f);
+        v0batch.negDCAxy.push_back(0.f);
+        continue;
+      }
+      int posEntry = getBatchedDaughter(posTrack, V0.collisionId(), primaryVertex);
+      int negEntry = getBatchedDaughter(negTrack, V0.collisionId(), primaryVertex);
+      v0batch.posEntries.push_back(posEntry);
+      v0batch.negEntries.push_back(negEntry);
+      v0batch.posDCAxy.push_back(v0batch.dcas[posEntry][0]);
+      v0batch.negDCAxy.push_back(v0batch.dcas[negEntry][0]);
+    }
+    v0batch.nV0s = v0batch.primaryVertices.size();
+
+    // pass 2: daughter DCA selections
+    v0batch.isPreselected.resize(v0batch.nV0s);
+    const float minPosDCA = dcapostopv, minNegDCA = dcanegtopv;
+    for (size_t i = 0; i < v0batch.nV0s; i++) {
+      v0batch.isPreselected[i] = v0batch.passesTPCrefit[i] & (std::fabs(v0batch.posDCAxy[i]) >= minPosDCA) & (std::fabs(v0batch.negDCAxy[i]) >= minNegDCA);
+    }
+
+    // bookkeeping of the pre-fit selections
+    for (size_t i = 0; i < v0batch.nV0s; i++) {
+      statisticsRegistry.v0stats[kV0All]++;
+      statisticsRegistry.v0stats[kV0TPCrefit] += v0batch.passesTPCrefit[i];
+      statisticsRegistry.v0stats[kV0DCAxy] += v0batch.isPreselected[i];
+      if (!v0batch.hasCollision[i]) {
+        statisticsRegistry.v0statsUnassociated[kV0All]++;
+        statisticsRegistry.v0statsUnassociated[kV0TPCrefit] += v0batch.passesTPCrefit[i];
+        statisticsRegistry.v0statsUnassociated[kV0DCAxy] += v0batch.isPreselected[i];
       }
+    }
+  }
+
+  // build the i-th V0 of the DF after the batched pre-selection
+  template <class TTrackTo, typename TV0Object>
+  bool buildPreselectedV0Candidate(TV0Object const& V0, size_t i)
+  {
+    if (!v0batch.isPreselected[i]) {
+      return false;
+    }
+    v0candidate.posDCAxy = v0batch.posDCAxy[i];
+    v0candidate.negDCAxy = v0batch.negDCAxy[i];
+    const auto& negDCA = v0batch.dcas[v0batch.negEntries[i]];
+    return fitV0Candidate<TTrackTo>(V0, v0batch.primaryVertices[i], v0batch.trackPars[v0batch.posEntries[i]], v0batch.trackPars[v0batch.negEntries[i]], gpu::gpustd::array<float, 2>{negDCA[0], negDCA[1]});
+  }
 
-      // populates v0candidate struct declared inside strangenessbuilder
-      bool validCandidate = buildV0Candidate<TTrackTo>(V0);
+  // store the daughter tracks of the current candidate at the decay vertex
+  template <typename TV0Object>
+  void fillV0DauTrackParCovs(TV0Object const& V0)
+  {
+    float parPos[7] = {lPositiveTrack.getX(), lPositiveTrack.getAlpha(), lPositiveTrack.getY(), lPositiveTrack.getZ(), lPositiveTrack.getSnp(), lPositiveTrack.getTgl(), lPositiveTrack.getQ2Pt()};
+    float parNeg[7] = {lNegativeTrack.getX(), lNegativeTrack.getAlpha(), lNegativeTrack.getY(), lNegativeTrack.getZ(), lNegativeTrack.getSnp(), lNegativeTrack.getTgl(), lNegativeTrack.getQ2Pt()};
+    float covPos[15];
+    float covNeg[15];
+    for (int i = 0; i < 15; i++) {
+      covPos[i] = lPositiveTrack.getCov()[i];
+      covNeg[i] = lNegativeTrack.getCov()[i];
+    }
+    v0dauTrackParCovs(V0.globalIndex(), V0.collisionId(), parPos, covPos, parNeg, covNeg,
+                      v0candidate.dcaV0dau, v0candidate.posDCAxy, v0candidate.negDCAxy);
+  }
+
+  template <class TTrackTo, typename TV0Table>
+  void buildStrangenessTables(TV0Table const& V0s)
+  {
+    if (useBatchedBuilding) {
+      preselectV0sBatched<TTrackTo>(V0s);
+    }
+    size_t iV0 = 0;
+
+    // Loops over all V0s in the time frame
+    for (auto& V0 : V0s) {
+      bool validCandidate = false;
+      if (useBatchedBuilding) {
+        if (iV0 >= v0batch.nV0s) {
+          break; // downscaled
+        }
+        validCandidate = buildPreselectedV0Candidate<TTrackTo>(V0, iV0++);
+      } else {
+        // downscale some V0s if requested to do so
+        if (downscalingOptions.downscaleFactor < 1.f && (static_cast<float>(rand_r(&randomSeed)) / static_cast<float>(RAND_MAX)) > downscalingOptions.downscaleFactor) {
+          return;
+        }
+
+        // populates v0candidate struct declared inside strangenessbuilder
+        validCandidate = buildV0Candidate<TTrackTo>(V0);
+      }
 
       if (!validCandidate) {
         continue; // doesn't pass selections
@@ -1245,6 +1422,11 @@ struct lambdakzeroBuilder {
                   V0.v0Type());
       }
 
+      // daughter tracks at the decay vertex, for the cascade builder
+      if (createV0DauTrackParCovs > 0) {
+        fillV0DauTrackParCovs(V0);
+      }
+
       // populate V0 covariance matrices if required by any other task
       if (createV0CovMats) {
         // Calculate position covariance matrix
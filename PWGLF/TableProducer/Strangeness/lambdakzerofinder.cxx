@@ -32,6 +32,7 @@
 #include <cmath>
 #include <array>
 #include <cstdlib>
+#include <vector>
 
 #include <TFile.h>
 #include <TLorentzVector.h>
@@ -52,6 +53,7 @@
 #include "Common/DataModel/PIDResponse.h"
 #include "PWGLF/DataModel/LFStrangenessTables.h"
 #include "PWGLF/DataModel/LFStrangenessFinderTables.h"
+#include "PWGLF/Utils/strangenessFinderPrefilter.h"
 #include "Common/Core/TrackSelection.h"
 #include "Common/DataModel/TrackSelectionTables.h"
 #include "Common/DataModel/EventSelection.h"
@@ -133,6 +135,7 @@ struct lambdakzerofinder {
     "registry",
     {
       {"hCandPerEvent", "hCandPerEvent", {HistType::kTH1F, {{1000, 0.0f, 1000.0f}}}},
+      {"hPrefilterStatistics", "hPrefilterStatistics", {HistType::kTH1D, {{5, -0.5f, 4.5f}}}},
     },
   };
 
@@ -146,6 +149,13 @@ struct lambdakzerofinder {
   Configurable<float> v0radius{"v0radius", 5.0, "v0radius"};
   Configurable<float> maxV0DCAtoPV{"maxV0DCAtoPV", 0.5, "maximum V0 DCA to PV"};
 
+  // Pair selections before the DCA fit
+  Configurable<float> dcapostopv{"dcapostopv", 0.0, "DCA Pos To PV, before the DCA fit"};
+  Configurable<float> dcanegtopv{"dcanegtopv", 0.0, "DCA Neg To PV, before the DCA fit"};
+  Configurable<bool> doTopologyPrefilter{"doTopologyPrefilter", true, "reject pairs from their trajectories in the transverse plane before the DCA fit"};
+  Configurable<float> prefilterMaxDCAxy{"prefilterMaxDCAxy", 2.0, "topology prefilter: maximum transverse distance between the daughter trajectories (cm)"};
+  Configurable<float> prefilterRadiusTolerance{"prefilterRadiusTolerance", 1.0, "topology prefilter: tolerance on the minimum V0 radius (cm)"};
+
   // Configurables for selecting which particles to generate
   Configurable<bool> findK0Short{"findK0Short", true, "findK0Short"};
   Configurable<bool> findLambda{"findLambda", true, "findLambda"};
@@ -166,10 +176,30 @@ struct lambdakzerofinder {
   int mRunNumber;
   float d_bz;
 
+  // Analytic prefilter of the pairs
+  enum prefilterStep { kPrefilterAll = 0,
+                       kPrefilterDCAToPV,
+                       kPrefilterDCAxy,
+                       kPrefilterRadius,
+                       kPrefilterFitted,
+                       kNPrefilterSteps };
+  o2::pwglf::TopologyPrefilter topologyPrefilter;
+  std::vector<o2::pwglf::TrajectoryXY> negTrajectories; // transverse-plane trajectories of the negative tracks
+  std::array<Long_t, kNPrefilterSteps> prefilterCounters;
+
   void init(InitContext&)
   {
     mRunNumber = 0;
     d_bz = 0;
+    topologyPrefilter.maxDCAxy = prefilterMaxDCAxy;
+    topologyPrefilter.minRadius = v0radius.value - prefilterRadiusTolerance.value;
+    topologyPrefilter.maxRadius = 200.; // as the fitter
+    auto hPrefilterStatistics = registry.get<TH1>(HIST("hPrefilterStatistics"));
+    hPrefilterStatistics->GetXaxis()->SetBinLabel(1, "All pairs");
+    hPrefilterStatistics->GetXaxis()->SetBinLabel(2, "Rejected: DCA to PV");
+    hPrefilterStatistics->GetXaxis()->SetBinLabel(3, "Rejected: transverse DCA");
+    hPrefilterStatistics->GetXaxis()->SetBinLabel(4, "Rejected: radius");
+    hPrefilterStatistics->GetXaxis()->SetBinLabel(5, "Fitted");
     ccdb->setURL("https://alice-ccdb.cern.ch");
     ccdb->setCaching(true);
     ccdb->setLocalObjectValidityChecking();
@@ -302,9 +332,26 @@ struct lambdakzerofinder {
     initCCDB(bc);
 
     Long_t lNCand = 0;
+    prefilterCounters.fill(0);
+
+    // the trajectories of the negative tracks are calculated once for all the pairs
+    negTrajectories.clear();
+    if (doTopologyPrefilter) {
+      for (auto& nTrack : nTracks) {
+        negTrajectories.push_back(o2::pwglf::getTrajectoryXY(getTrackPar(nTrack.track_as<FullTracksExtIU>()), d_bz));
+      }
+    }
 
     for (auto& pTrack : pTracks) { // FIXME: turn into combination(...)
+      auto t1 = pTrack.track_as<FullTracksExtIU>();
+      bool isPosSelected = TMath::Abs(t1.dcaXY()) >= dcapostopv;
+      o2::pwglf::TrajectoryXY posTrajectory;
+      if (doTopologyPrefilter && isPosSelected) {
+        posTrajectory = o2::pwglf::getTrajectoryXY(getTrackPar(t1), d_bz);
+      }
+      int iNegTrack = -1;
       for (auto& nTrack : nTracks) {
+        iNegTrack++;
         // Check compatibility with certain hypotheses and desired building
         bool keepCandidate = false;
         if (pTrack.compatiblePi() && nTrack.compatiblePi() && findK0Short)
@@ -315,14 +362,33 @@ struct lambdakzerofinder {
           keepCandidate = true;
         if (!keepCandidate)
           continue;
+        prefilterCounters[kPrefilterAll]++;
 
-        auto t1 = pTrack.track_as<FullTracksExtIU>();
         auto t2 = nTrack.track_as<FullTracksExtIU>();
+        if (!isPosSelected || TMath::Abs(t2.dcaXY()) < dcanegtopv) {
+          prefilterCounters[kPrefilterDCAToPV]++;
+          continue;
+        }
+        if (doTopologyPrefilter) {
+          auto decision = topologyPrefilter.check(posTrajectory, negTrajectories[iNegTrack]);
+          if (decision == o2::pwglf::TopologyPrefilter::kRejectedDCAxy) {
+            prefilterCounters[kPrefilterDCAxy]++;
+            continue;
+          }
+          if (decision == o2::pwglf::TopologyPrefilter::kRejectedRadius) {
+            prefilterCounters[kPrefilterRadius]++;
+            continue;
+          }
+        }
+        prefilterCounters[kPrefilterFitted]++;
 
         lNCand += buildV0Candidate(t1, t2, collisions);
       }
     }
     registry.fill(HIST("hCandPerEvent"), lNCand);
+    for (int i = 0; i < kNPrefilterSteps; i++) {
+      registry.fill(HIST("hPrefilterStatistics"), i, prefilterCounters[i]);
+    }
   }
 };
 
@@ -21,9 +21,11 @@
 //
 
 #include <Math/Vector4D.h>
+#include <algorithm>
 #include <cmath>
 #include <array>
 #include <cstdlib>
+#include <vector>
 
 #include "Framework/runDataProcessing.h"
 #include "Framework/AnalysisTask.h"
@@ -100,6 +102,11 @@ struct lambdakzeromlselection {
   //// Casting
   std::vector<int> CastKine_SelMap, CastTopo_SelMap, Feature_SelMask;
 
+  // Batched scoring: the selected features of all the V0s of a dataframe are stored in one matrix,
+  // one row per V0, and each model is evaluated once on it
+  std::vector<float> batchFeatures; // feature matrix, shared by all the models
+  std::vector<float> batchScores;   // scores of the last evaluated model, one row per V0
+
   // CCDB configuration
   o2::ccdb::CcdbApi ccdbApi;
   Service<o2::ccdb::BasicCCDBManager> ccdb;
@@ -236,6 +243,53 @@ struct lambdakzeromlselection {
     }
   }
 
+  // Process all the candidates of a dataframe at once
+  template <typename TV0Objects, typename T>
+  void processCandidatesBatched(TV0Objects const& v0s, const std::vector<T>& Feature_SelMask)
+  {
+    batchFeatures.clear();
+    for (auto& cand : v0s) {
+      std::array<float, 18> base_features{cand.mLambda(), cand.mAntiLambda(),
+                                          cand.mGamma(), cand.mK0Short(),
+                                          cand.pt(), static_cast<float>(cand.qtarm()), cand.alpha(),
+                                          cand.positiveeta(), cand.negativeeta(), cand.eta(),
+                                          cand.z(), cand.v0radius(), static_cast<float>(TMath::ACos(cand.v0cosPA())),
+                                          cand.dcapostopv(), cand.dcanegtopv(), cand.dcaV0daughters(),
+                                          cand.dcav0topv(), cand.psipair()};
+      for (size_t i = 0; i < std::min(Feature_SelMask.size(), base_features.size()); ++i) {
+        if (Feature_SelMask[i] >= 1) { // If the mask value is true, select the corresponding element
+          batchFeatures.push_back(base_features[i]);
+        }
+      }
+    }
+    const std::size_t nV0s = v0s.size();
+    nCandidates += nV0s;
+    LOG(debug) << "Candidates processed: " << nCandidates;
+    if (nV0s == 0) {
+      return;
+    }
+
+    // calculate classifier output, the scores of the positive class are stored in order
+    auto scoreCandidates = [&](o2::ml::OnnxModel& model, auto& mlSelections) {
+      model.bindBuffers(batchFeatures, batchScores);
+      if (!model.evalModelBound()) {
+        LOG(fatal) << "Batched ML inference failed for " << nV0s << " V0s!";
+      }
+      const std::size_t nScores = batchScores.size() / nV0s;
+      for (std::size_t iV0 = 0; iV0 < nV0s; iV0++) {
+        mlSelections(batchScores[iV0 * nScores + 1]);
+      }
+    };
+    if (PredictLambda)
+      scoreCandidates(lambda_bdt, lambdaMLSelections);
+    if (PredictGamma)
+      scoreCandidates(gamma_bdt, gammaMLSelections);
+    if (PredictAntiLambda)
+      scoreCandidates(antilambda_bdt, antiLambdaMLSelections);
+    if (PredictKZeroShort)
+      scoreCandidates(kzeroshort_bdt, kzeroShortMLSelections);
+  }
+
   void processDerivedData(aod::StraCollision const& coll, V0DerivedDatas const& v0s)
   {
     histos.fill(HIST("hEventVertexZ"), coll.posZ());
@@ -259,8 +313,25 @@ struct lambdakzeromlselection {
     }
   }
 
+  void processDerivedDataBatched(aod::StraCollisions const& colls, V0DerivedDatas const& v0s)
+  {
+    for (auto& coll : colls) {
+      histos.fill(HIST("hEventVertexZ"), coll.posZ());
+    }
+    processCandidatesBatched(v0s, Feature_SelMask);
+  }
+  void processStandardDataBatched(aod::Collisions const& colls, V0OriginalDatas const& v0s)
+  {
+    for (auto& coll : colls) {
+      histos.fill(HIST("hEventVertexZ"), coll.posZ());
+    }
+    processCandidatesBatched(v0s, Feature_SelMask);
+  }
+
   PROCESS_SWITCH(lambdakzeromlselection, processStandardData, "Process standard data", false);
   PROCESS_SWITCH(lambdakzeromlselection, processDerivedData, "Process derived data", true);
+  PROCESS_SWITCH(lambdakzeromlselection, processStandardDataBatched, "Process standard data, all the V0s of a dataframe at once", false);
+  PROCESS_SWITCH(lambdakzeromlselection, processDerivedDataBatched, "Process derived data, all the V0s of a dataframe at once", false);
 };
 
 WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
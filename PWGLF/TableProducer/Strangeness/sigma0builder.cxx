@@ -49,6 +49,9 @@
 #include <TLorentzVector.h>
 #include <TPDGCode.h>
 #include <TDatabasePDG.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
 
 using namespace o2;
 using namespace o2::framework;
@@ -105,11 +108,23 @@ struct sigma0builder {
   //// Sigma0 criteria:
   Configurable<float> Sigma0Window{"Sigma0Window", 0.04, "Mass window around expected (in GeV/c2)"};
 
+  // Pairing
+  Configurable<bool> doSortedPairing{"doSortedPairing", false, "preselect photons and lambdas once per V0 and pair them in rapidity order, skipping the pairs above the mass window"};
+
   // Axis
   // base properties
   ConfigurableAxis vertexZ{"vertexZ", {30, -15.0f, 15.0f}, ""};
 
   int nSigmaCandidates = 0;
+
+  // Preselected V0s of the current collision, for the sorted pairing
+  struct PreselectedV0 {
+    int64_t index; // row in the collision slice
+    float rapidity;
+    float pt;
+  };
+  std::vector<PreselectedV0> photons;
+  std::vector<PreselectedV0> lambdas;
   void init(InitContext const&)
   {
     // Event counter
@@ -123,37 +138,17 @@ struct sigma0builder {
     float Rapidity;
   } sigmaCandidate;
 
-  // Process sigma candidate and store properties in object
+  // Photon selection, ML or standard
   template <typename TV0Object>
-  bool processSigmaCandidate(TV0Object const& lambda, TV0Object const& gamma)
+  bool isPhotonCandidate(TV0Object const& gamma)
   {
-    float GammaBDTScore = -1;
-    float LambdaBDTScore = -1;
-    float AntiLambdaBDTScore = -1;
-
-    if ((lambda.v0Type() == 0) || (gamma.v0Type() == 0))
+    if (gamma.v0Type() == 0)
       return false;
 
-    if constexpr (
-      requires { gamma.gammaBDTScore(); } &&
-      requires { lambda.lambdaBDTScore(); } &&
-      requires { lambda.antiLambdaBDTScore(); }) {
-
-      LOGF(info, "X-check: ML Selection is on!");
-      // Gamma selection:
+    if constexpr (requires { gamma.gammaBDTScore(); }) {
       if (gamma.gammaBDTScore() <= Gamma_MLThreshold)
         return false;
-
-      // Lambda and AntiLambda selection
-      if ((lambda.lambdaBDTScore() <= Lambda_MLThreshold) && (lambda.antiLambdaBDTScore() <= AntiLambda_MLThreshold))
-        return false;
-
-      GammaBDTScore = gamma.gammaBDTScore();
-      LambdaBDTScore = lambda.lambdaBDTScore();
-      AntiLambdaBDTScore = lambda.antiLambdaBDTScore();
     } else {
-      // Standard selection
-      // Gamma basic selection criteria:
       if (TMath::Abs(gamma.mGamma()) > PhotonMaxMass)
         return false;
       if ((TMath::Abs(gamma.negativeeta()) > PhotonDauPseudoRap) || (TMath::Abs(gamma.positiveeta()) > PhotonDauPseudoRap))
@@ -164,8 +159,21 @@ struct sigma0builder {
         return false;
       if ((gamma.v0radius() < PhotonMinRadius) || (gamma.v0radius() > PhotonMaxRadius))
         return false;
+    }
+    return true;
+  }
 
-      // Lambda basic selection criteria:
+  // Lambda and AntiLambda selection, ML or standard
+  template <typename TV0Object>
+  bool isLambdaCandidate(TV0Object const& lambda)
+  {
+    if (lambda.v0Type() == 0)
+      return false;
+
+    if constexpr (requires { lambda.lambdaBDTScore(); } && requires { lambda.antiLambdaBDTScore(); }) {
+      if ((lambda.lambdaBDTScore() <= Lambda_MLThreshold) && (lambda.antiLambdaBDTScore() <= AntiLambda_MLThreshold))
+        return false;
+    } else {
       if (TMath::Abs(lambda.mLambda() - 1.115683) > LambdaWindow)
         return false;
       if ((TMath::Abs(lambda.negativeeta()) > LambdaDauPseudoRap) || (TMath::Abs(lambda.positiveeta()) > LambdaDauPseudoRap))
@@ -177,6 +185,42 @@ struct sigma0builder {
       if (lambda.dcaV0daughters() > Lambdadcav0dau)
         return false;
     }
+    return true;
+  }
+
+  // Process sigma candidate and store properties in object
+  template <typename TV0Object>
+  bool processSigmaCandidate(TV0Object const& lambda, TV0Object const& gamma)
+  {
+    if constexpr (
+      requires { gamma.gammaBDTScore(); } &&
+      requires { lambda.lambdaBDTScore(); } &&
+      requires { lambda.antiLambdaBDTScore(); }) {
+      LOGF(info, "X-check: ML Selection is on!");
+    }
+
+    if (!isLambdaCandidate(lambda) || !isPhotonCandidate(gamma))
+      return false;
+
+    return buildSigmaCandidate(lambda, gamma);
+  }
+
+  // Build the sigma candidate of a selected photon and lambda, store it if in the mass window
+  template <typename TV0Object>
+  bool buildSigmaCandidate(TV0Object const& lambda, TV0Object const& gamma)
+  {
+    float GammaBDTScore = -1;
+    float LambdaBDTScore = -1;
+    float AntiLambdaBDTScore = -1;
+
+    if constexpr (
+      requires { gamma.gammaBDTScore(); } &&
+      requires { lambda.lambdaBDTScore(); } &&
+      requires { lambda.antiLambdaBDTScore(); }) {
+      GammaBDTScore = gamma.gammaBDTScore();
+      LambdaBDTScore = lambda.lambdaBDTScore();
+      AntiLambdaBDTScore = lambda.antiLambdaBDTScore();
+    }
 
     // Sigma0 candidate properties
     std::array<float, 3> pVecPhotons{gamma.px(), gamma.py(), gamma.pz()};
@@ -286,6 +330,67 @@ struct sigma0builder {
     return true;
   }
 
+  // Pairs of the photons and lambdas of a collision, onCandidate(lambda, gamma) is called for each stored candidate
+  template <typename TV0s, typename TCallback>
+  void buildSigmaCandidates(TV0s const& v0s, TCallback const& onCandidate)
+  {
+    if (!doSortedPairing) {
+      for (auto& gamma : v0s) {    // selecting photons from Sigma0
+        for (auto& lambda : v0s) { // selecting lambdas from Sigma0
+          if (processSigmaCandidate(lambda, gamma))
+            onCandidate(lambda, gamma);
+        }
+      }
+      return;
+    }
+
+    // Selections evaluated once per V0
+    photons.clear();
+    lambdas.clear();
+    int64_t index = 0;
+    for (auto const& v0 : v0s) {
+      if (isPhotonCandidate(v0))
+        photons.push_back({index, v0.eta(), v0.pt()}); // massless photon: rapidity = pseudorapidity
+      if (isLambdaCandidate(v0))
+        lambdas.push_back({index, v0.yLambda(), v0.pt()});
+      index++;
+    }
+    if (photons.empty() || lambdas.empty())
+      return;
+    std::sort(photons.begin(), photons.end(), [](auto const& a, auto const& b) { return a.rapidity < b.rapidity; });
+    auto minPhotonPt = std::min_element(photons.begin(), photons.end(), [](auto const& a, auto const& b) { return a.pt < b.pt; })->pt;
+
+    // For a photon and a Lambda of transverse masses pT(gamma) and mT(Lambda):
+    // m^2 >= m(Lambda)^2 + 2 pT(gamma) (mT(Lambda) cosh(Delta y) - pT(Lambda)),
+    // such that the pairs with cosh(Delta y) > C(pT(gamma)) are above the mass window.
+    // C decreases with pT(gamma): the rapidity range is given by the softest photon, the pairs within it are then
+    // checked with their own pT. The bound is 1 MeV/c^2 looser than the window against rounding.
+    const double massLambda2 = o2::constants::physics::MassLambda0 * o2::constants::physics::MassLambda0;
+    const double maxMass = o2::constants::physics::MassSigma0 + Sigma0Window + 1e-3;
+    const double maxMass2 = maxMass * maxMass;
+    for (auto const& lambdaCandidate : lambdas) {
+      const double mTLambda = std::sqrt(lambdaCandidate.pt * lambdaCandidate.pt + massLambda2);
+      const double coshMax = (maxMass2 - massLambda2) / (2. * minPhotonPt * mTLambda) + lambdaCandidate.pt / mTLambda;
+      if (coshMax < 1.)
+        continue;
+      const float deltaYMax = std::acosh(coshMax);
+      auto first = std::lower_bound(photons.begin(), photons.end(), lambdaCandidate.rapidity - deltaYMax, [](auto const& photon, float y) { return photon.rapidity < y; });
+      auto last = std::upper_bound(first, photons.end(), lambdaCandidate.rapidity + deltaYMax, [](float y, auto const& photon) { return y < photon.rapidity; });
+      if (first == last)
+        continue;
+
+      auto lambda = v0s.iteratorAt(lambdaCandidate.index);
+      for (auto photon = first; photon != last; ++photon) {
+        const double coshDeltaY = std::cosh(photon->rapidity - lambdaCandidate.rapidity);
+        if (massLambda2 + 2. * photon->pt * (mTLambda * coshDeltaY - lambdaCandidate.pt) > maxMass2)
+          continue;
+        auto gamma = v0s.iteratorAt(photon->index);
+        if (buildSigmaCandidate(lambda, gamma))
+          onCandidate(lambda, gamma);
+      }
+    }
+  }
+
   void processMonteCarlo(aod::StraCollisions const& collisions, V0DerivedMCDatas const& V0s, dauTracks const&)
   {
     for (const auto& coll : collisions) {
@@ -294,18 +399,13 @@ struct sigma0builder {
       auto V0Table_thisCollision = V0s.sliceBy(perCollisionMCDerived, collIdx);
 
       // V0 table sliced
-      for (auto& gamma : V0Table_thisCollision) {    // selecting photons from Sigma0
-        for (auto& lambda : V0Table_thisCollision) { // selecting lambdas from Sigma0
-          if (!processSigmaCandidate(lambda, gamma))
-            continue;
-
-          bool fIsSigma = false;
-          if ((gamma.pdgCode() == 22) && (gamma.pdgCodeMother() == 3212) && (lambda.pdgCode() == 3122) && (lambda.pdgCodeMother() == 3212) && (gamma.motherMCPartId() == lambda.motherMCPartId()))
-            fIsSigma = true;
+      buildSigmaCandidates(V0Table_thisCollision, [&](auto const& lambda, auto const& gamma) {
+        bool fIsSigma = false;
+        if ((gamma.pdgCode() == 22) && (gamma.pdgCodeMother() == 3212) && (lambda.pdgCode() == 3122) && (lambda.pdgCodeMother() == 3212) && (gamma.motherMCPartId() == lambda.motherMCPartId()))
+          fIsSigma = true;
 
-          v0MCSigmas(fIsSigma);
-        }
-      }
+        v0MCSigmas(fIsSigma);
+      });
     }
   }
 
@@ -320,18 +420,13 @@ struct sigma0builder {
       v0sigma0Coll(coll.posX(), coll.posY(), coll.posZ(), coll.centFT0M(), coll.centFT0A(), coll.centFT0C(), coll.centFV0A());
 
       // V0 table sliced
-      for (auto& gamma : V0Table_thisCollision) {    // selecting photons from Sigma0
-        for (auto& lambda : V0Table_thisCollision) { // selecting lambdas from Sigma0
-          if (!processSigmaCandidate(lambda, gamma))
-            continue;
-
-          nSigmaCandidates++;
-          if (nSigmaCandidates % 5000 == 0) {
-            LOG(info) << "Sigma0 Candidates built: " << nSigmaCandidates;
-          }
-          v0Sigma0CollRefs(v0sigma0Coll.lastIndex());
+      buildSigmaCandidates(V0Table_thisCollision, [&](auto const&, auto const&) {
+        nSigmaCandidates++;
+        if (nSigmaCandidates % 5000 == 0) {
+          LOG(info) << "Sigma0 Candidates built: " << nSigmaCandidates;
         }
-      }
+        v0Sigma0CollRefs(v0sigma0Coll.lastIndex());
+      });
     }
   }
 
@@ -346,18 +441,13 @@ struct sigma0builder {
       v0sigma0Coll(coll.posX(), coll.posY(), coll.posZ(), coll.centFT0M(), coll.centFT0A(), coll.centFT0C(), coll.centFV0A());
 
       // V0 table sliced
-      for (auto& gamma : V0Table_thisCollision) {    // selecting photons from Sigma0
-        for (auto& lambda : V0Table_thisCollision) { // selecting lambdas from Sigma0
-          if (!processSigmaCandidate(lambda, gamma))
-            continue;
-
-          nSigmaCandidates++;
-          if (nSigmaCandidates % 5000 == 0) {
-            LOG(info) << "Sigma0 Candidates built: " << nSigmaCandidates;
-          }
-          v0Sigma0CollRefs(v0sigma0Coll.lastIndex());
+      buildSigmaCandidates(V0Table_thisCollision, [&](auto const&, auto const&) {
+        nSigmaCandidates++;
+        if (nSigmaCandidates % 5000 == 0) {
+          LOG(info) << "Sigma0 Candidates built: " << nSigmaCandidates;
         }
-      }
+        v0Sigma0CollRefs(v0sigma0Coll.lastIndex());
+      });
     }
   }
   PROCESS_SWITCH(sigma0builder, processMonteCarlo, "Fill sigma0 MC table", false);
@@ -85,13 +85,14 @@ struct strangederivedbuilder {
 
   //__________________________________________________
   // track extra references
-  Produces<aod::DauTrackExtras> dauTrackExtras;   // daughter track detector properties
-  Produces<aod::DauTrackMCIds> dauTrackMCIds;     // daughter track MC Particle ID
-  Produces<aod::DauTrackTPCPIDs> dauTrackTPCPIDs; // daughter track TPC PID
-  Produces<aod::DauTrackTOFPIDs> dauTrackTOFPIDs; // daughter track TOF PID
-  Produces<aod::V0Extras> v0Extras;               // references DauTracks from V0s
-  Produces<aod::CascExtras> cascExtras;           // references DauTracks from cascades
-  Produces<aod::StraTrackExtras> straTrackExtras; // references DauTracks from tracked cascades
+  Produces<aod::DauTrackExtras> dauTrackExtras;               // daughter track detector properties
+  Produces<aod::DauTrackMCIds> dauTrackMCIds;                 // daughter track MC Particle ID
+  Produces<aod::DauTrackTPCPIDs> dauTrackTPCPIDs;             // daughter track TPC PID
+  Produces<aod::DauTrackTPCPIDsPacked> dauTrackTPCPIDsPacked; // daughter track TPC PID, packed
+  Produces<aod::DauTrackTOFPIDs> dauTrackTOFPIDs;             // daughter track TOF PID
+  Produces<aod::V0Extras> v0Extras;                           // references DauTracks from V0s
+  Produces<aod::CascExtras> cascExtras;                       // references DauTracks from cascades
+  Produces<aod::StraTrackExtras> straTrackExtras;             // references DauTracks from tracked cascades
 
   //__________________________________________________
   // cascade interlinks
@@ -165,6 +166,8 @@ struct strangederivedbuilder {
   // variables that are rounded include the DCAs but not the CosPA (precision needed)
   Configurable<bool> roundNSigmaVariables{"roundNSigmaVariables", false, "round NSigma variables"};
   Configurable<float> precisionNSigmas{"precisionNSigmas", 0.1f, "precision to keep NSigmas"};
+  // store the daughter TPC PID in DauTrackTPCPIDsPacked (8-bit NSigmas, 16-bit signal) instead of DauTrackTPCPIDs
+  Configurable<bool> packTPCPIDs{"packTPCPIDs", false, "pack daughter TPC PID in DauTrackTPCPIDsPacked"};
 
   Configurable<bool> fillRawFT0A{"fillRawFT0A", false, "Fill raw FT0A information for debug"};
   Configurable<bool> fillRawFT0C{"fillRawFT0C", true, "Fill raw FT0C information for debug"};
@@ -614,8 +617,15 @@ struct strangederivedbuilder {
           dauTrackMCIds(tr.mcParticleId()); // joinable with dauTrackExtras
         }
 
-        // round if requested
-        if (roundNSigmaVariables) {
+        // pack or round if requested
+        if (packTPCPIDs) {
+          dauTrackTPCPIDsPacked(aod::dautrackpacked::packTPCSignal(tr.tpcSignal()),
+                                aod::dautrackpacked::packNSigma(tr.tpcNSigmaEl()),
+                                aod::dautrackpacked::packNSigma(tr.tpcNSigmaPi()),
+                                aod::dautrackpacked::packNSigma(tr.tpcNSigmaKa()),
+                                aod::dautrackpacked::packNSigma(tr.tpcNSigmaPr()),
+                                aod::dautrackpacked::packNSigma(tr.tpcNSigmaHe()));
+        } else if (roundNSigmaVariables) {
           dauTrackTPCPIDs(tr.tpcSignal(),
                           roundToPrecision(tr.tpcNSigmaEl(), precisionNSigmas),
                           roundToPrecision(tr.tpcNSigmaPi(), precisionNSigmas),
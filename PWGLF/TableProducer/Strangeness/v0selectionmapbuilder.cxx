@@ -0,0 +1,118 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+//
+//  *+-+*+-+*+-+*+-+*+-+*+-+*
+//    V0 selection map builder
+//  *+-+*+-+*+-+*+-+*+-+*+-+*
+//
+//  Evaluates up to three V0 selection groups once per V0 of the derived
+//  data and stores the selection bitmaps (see PWGLF/Utils/v0SelectionBits.h)
+//  in a table joinable with V0Cores. Analyses using the same selections
+//  can then check the masks provided by v0SelectionGroup::provideMasks
+//  against the stored bitmaps instead of recomputing them.
+
+#include <cmath>
+#include <array>
+#include <cstdlib>
+#include <vector>
+
+#include "Framework/runDataProcessing.h"
+#include "Framework/AnalysisTask.h"
+#include "Framework/AnalysisDataModel.h"
+#include "Framework/ASoAHelpers.h"
+#include "PWGLF/DataModel/LFStrangenessTables.h"
+#include "PWGLF/DataModel/LFStrangenessPIDTables.h"
+#include "PWGLF/Utils/v0SelectionBits.h"
+#include "PWGLF/Utils/v0SelectionGroup.h"
+#include "PWGLF/Utils/v0SelectionTools.h"
+
+using namespace o2;
+using namespace o2::framework;
+
+using dauTracks = soa::Join<aod::DauTrackExtras, aod::DauTrackTPCPIDs>;
+using derivedV0s = soa::Join<aod::V0Cores, aod::V0CollRefs, aod::V0Extras>;
+using derivedV0sWithTOF = soa::Join<aod::V0Cores, aod::V0CollRefs, aod::V0Extras, aod::V0TOFPIDs, aod::V0TOFNSigmas>;
+
+struct v0selectionmapbuilder {
+  Produces<aod::V0SelectionMaps> v0SelectionMaps;
+
+  static constexpr int nMaxSelectionGroups = 3;
+  Configurable<int> nSelectionGroups{"nSelectionGroups", 1, "number of selection groups to evaluate (1-3)"};
+  Configurable<v0SelectionGroup> v0Selections0{"v0Selections0", {}, "V0 selection criteria, first group"};
+  Configurable<v0SelectionGroup> v0Selections1{"v0Selections1", {}, "V0 selection criteria, second group"};
+  Configurable<v0SelectionGroup> v0Selections2{"v0Selections2", {}, "V0 selection criteria, third group"};
+
+  v0data::v0SelectionColumns v0Columns;
+  std::array<std::vector<uint64_t>, nMaxSelectionGroups> selectionMaps;
+
+  void init(InitContext const&)
+  {
+    if (nSelectionGroups < 1 || nSelectionGroups > nMaxSelectionGroups) {
+      LOGF(fatal, "nSelectionGroups has to be between 1 and %d, got %d", nMaxSelectionGroups, nSelectionGroups.value);
+    }
+    for (int iGroup = 0; iGroup < nSelectionGroups; iGroup++) {
+      LOGF(info, "Selection group %d:", iGroup);
+      getSelectionGroup(iGroup).PrintSelections();
+    }
+    if (doprocessWithoutTOF) {
+      LOGF(info, "TOF information not used: TOF selection bits always set");
+    }
+  }
+
+  const v0SelectionGroup& getSelectionGroup(int iGroup)
+  {
+    return iGroup == 0 ? v0Selections0.value : (iGroup == 1 ? v0Selections1.value : v0Selections2.value);
+  }
+
+  template <typename TV0s>
+  void fillSelectionMaps(TV0s const& v0s)
+  {
+    // one pass over the rows to gather the columns, then one pass per selection
+    v0Columns.clear();
+    for (auto const& v0 : v0s) {
+      auto collision = v0.template straCollision_as<aod::StraCollisions>();
+      auto posTrackExtra = v0.template posTrackExtra_as<dauTracks>();
+      auto negTrackExtra = v0.template negTrackExtra_as<dauTracks>();
+      v0Columns.add(v0, posTrackExtra, negTrackExtra, collision);
+    }
+    for (int iGroup = 0; iGroup < nMaxSelectionGroups; iGroup++) {
+      if (iGroup < nSelectionGroups) {
+        v0data::computeReconstructionBitmaps(v0Columns, getSelectionGroup(iGroup), selectionMaps[iGroup]);
+      } else {
+        selectionMaps[iGroup].assign(v0Columns.size(), 0);
+      }
+    }
+
+    v0SelectionMaps.reserve(v0Columns.size());
+    for (size_t i = 0; i < v0Columns.size(); i++) {
+      v0SelectionMaps(selectionMaps[0][i], selectionMaps[1][i], selectionMaps[2][i]);
+    }
+  }
+
+  void processWithoutTOF(aod::StraCollisions const&, derivedV0s const& v0s, dauTracks const&)
+  {
+    fillSelectionMaps(v0s);
+  }
+
+  void processWithTOF(aod::StraCollisions const&, derivedV0sWithTOF const& v0s, dauTracks const&)
+  {
+    fillSelectionMaps(v0s);
+  }
+
+  PROCESS_SWITCH(v0selectionmapbuilder, processWithoutTOF, "evaluate the selections without TOF information", true);
+  PROCESS_SWITCH(v0selectionmapbuilder, processWithTOF, "evaluate the selections with TOF information", false);
+};
+
+WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
+{
+  return WorkflowSpec{
+    adaptAnalysisTask<v0selectionmapbuilder>(cfgc)};
+}
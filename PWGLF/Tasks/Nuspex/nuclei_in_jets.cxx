@@ -505,6 +505,11 @@ struct nuclei_in_jets {
     return R_prime;
   }
 
+  // Kinematics of the particles of the jet finder, kept between the events
+  std::vector<double> particleEta;
+  std::vector<double> particlePhi;
+  std::vector<float> particleOneOverPt2;
+
   // Process Data
   void processData(SelectedCollisions::iterator const& collision, FullTracks const& tracks)
   {
@@ -599,6 +604,18 @@ struct nuclei_in_jets {
     Int_t exit(0);
     Int_t nPartAssociated(0);
 
+    // Kinematics of the selected particles, computed once for all the iterations of the jet finder
+    particleEta.resize(nParticles);
+    particlePhi.resize(nParticles);
+    particleOneOverPt2.resize(nParticles);
+    for (int i = 0; i < nParticles; i++) {
+      auto stored_track = tracks.iteratorAt(particle_ID[i]);
+      TVector3 p_particle(stored_track.px(), stored_track.py(), stored_track.pz());
+      particleEta[i] = p_particle.Eta();
+      particlePhi[i] = p_particle.Phi();
+      particleOneOverPt2[i] = 1.0 / (p_particle.Pt() * p_particle.Pt());
+    }
+
     // Jet Finder
     do {
       // Initialization
@@ -607,21 +624,21 @@ struct nuclei_in_jets {
       int label_jet_particle(0);
       int i_jet_particle(0);
 
+      // Leading direction of this iteration
+      float one_over_pt2_lead = 1.0 / (p_leading.Pt() * p_leading.Pt());
+      double eta_lead = p_leading.Eta();
+      double phi_lead = p_leading.Phi();
+
       for (int i = 0; i < nParticles; i++) {
 
         // Skip Leading Particle & Elements already associated to the Jet
         if (particle_ID[i] == leading_ID || particle_ID[i] == -1)
           continue;
 
-        // Get Particle Momentum
-        auto stored_track = tracks.iteratorAt(particle_ID[i]);
-        TVector3 p_particle(stored_track.px(), stored_track.py(), stored_track.pz());
-
         // Variables
-        float one_over_pt2_part = 1.0 / (p_particle.Pt() * p_particle.Pt());
-        float one_over_pt2_lead = 1.0 / (p_leading.Pt() * p_leading.Pt());
-        float deltaEta = p_particle.Eta() - p_leading.Eta();
-        float deltaPhi = GetDeltaPhi(p_particle.Phi(), p_leading.Phi());
+        float one_over_pt2_part = particleOneOverPt2[i];
+        float deltaEta = particleEta[i] - eta_lead;
+        float deltaPhi = GetDeltaPhi(particlePhi[i], phi_lead);
         float min = Minimum(one_over_pt2_part, one_over_pt2_lead);
         float Delta2 = deltaEta * deltaEta + deltaPhi * deltaPhi;
 
@@ -718,6 +735,12 @@ struct nuclei_in_jets {
     // Store UE
     std::vector<int> ue_particle_ID;
 
+    // Directions of the UE cones, computed once for all the particles
+    const double eta_ue_axis1 = ue_axis1.Eta();
+    const double phi_ue_axis1 = ue_axis1.Phi();
+    const double eta_ue_axis2 = ue_axis2.Eta();
+    const double phi_ue_axis2 = ue_axis2.Phi();
+
     for (int i = 0; i < nParticles; i++) {
 
       // Skip Leading Particle & Elements already associated to the Jet
@@ -728,11 +751,11 @@ struct nuclei_in_jets {
       const auto& ue_track = tracks.iteratorAt(particle_ID[i]);
 
       // Variables
-      float deltaEta1 = ue_track.eta() - ue_axis1.Eta();
-      float deltaPhi1 = GetDeltaPhi(ue_track.phi(), ue_axis1.Phi());
+      float deltaEta1 = ue_track.eta() - eta_ue_axis1;
+      float deltaPhi1 = GetDeltaPhi(ue_track.phi(), phi_ue_axis1);
       float dr1 = TMath::Sqrt(deltaEta1 * deltaEta1 + deltaPhi1 * deltaPhi1);
-      float deltaEta2 = ue_track.eta() - ue_axis2.Eta();
-      float deltaPhi2 = GetDeltaPhi(ue_track.phi(), ue_axis2.Phi());
+      float deltaEta2 = ue_track.eta() - eta_ue_axis2;
+      float deltaPhi2 = GetDeltaPhi(ue_track.phi(), phi_ue_axis2);
       float dr2 = TMath::Sqrt(deltaEta2 * deltaEta2 + deltaPhi2 * deltaPhi2);
 
       // Store Particles in the UE
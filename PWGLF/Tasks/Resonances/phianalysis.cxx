@@ -24,6 +24,8 @@
 #include "Framework/ASoAHelpers.h"
 #include "Framework/runDataProcessing.h"
 #include "PWGLF/DataModel/LFResonanceTables.h"
+#include "PWGLF/Utils/resoDaughterCache.h"
+#include "PWGLF/Utils/rsnMixingPool.h"
 #include "DataFormatsParameters/GRPObject.h"
 #include "CommonConstants/PhysicsConstants.h"
 
@@ -54,6 +56,9 @@ struct phianalysis {
   Configurable<int> nEvtMixing{"nEvtMixing", 5, "Number of events to mix"};
   ConfigurableAxis CfgVtxBins{"CfgVtxBins", {VARIABLE_WIDTH, -10.0f, -8.f, -6.f, -4.f, -2.f, 0.f, 2.f, 4.f, 6.f, 8.f, 10.f}, "Mixing bins - z-vertex"};
   ConfigurableAxis CfgMultBins{"CfgMultBins", {VARIABLE_WIDTH, 0., 1., 5., 10., 30., 50., 70., 100., 110.}, "Mixing bins - multiplicity"};
+  ConfigurableAxis CfgEvtPlBins{"CfgEvtPlBins", {VARIABLE_WIDTH, -1.5708, -0.7854, 0., 0.7854, 1.5708}, "Mixing bins - event plane (mixing pool only)"};
+  Configurable<bool> cPoolUseEvtPl{"cPoolUseEvtPl", false, "Mixing pool: classify the events in event plane as well"};
+  Configurable<int> cPoolDepth{"cPoolDepth", 10, "Mixing pool: number of events kept per class, across data frames"};
   /// Pre-selection cuts
   Configurable<double> cMinPtcut{"cMinPtcut", 0.15, "Track minium pt cut"};
   /// DCA Selections
@@ -114,7 +119,7 @@ struct phianalysis {
     histos.add("h3phiinvmassLS", "Invariant mass of phi same sign", kTH3F, {centAxis, ptAxis, invMassAxis});
     histos.add("h3phiinvmassME", "Invariant mass of phi mixed event", kTH3F, {centAxis, ptAxis, invMassAxis});
 
-    if (doprocessMCLight) {
+    if (doprocessMCLight || doprocessMCCached) {
       // MC QA
       histos.add("QAMCTrue/trkDCAxy", "DCAxy distribution of kaon track candidates", HistType::kTH1F, {dcaxyAxis});
       histos.add("QAMCTrue/trkDCAz", "DCAz distribution of kaon track candidates", HistType::kTH1F, {dcazAxis});
@@ -123,12 +128,17 @@ struct phianalysis {
       histos.add("phiRec", "pT distribution of Reconstructed MC phi", kTH2F, {ptAxis, centAxis});
       histos.add("phiRecinvmass", "Inv mass distribution of Reconstructed MC Phi", kTH1F, {invMassAxis});
     }
+    if (doprocessMEPool) {
+      mixingPool.init(CfgVtxBins.value, CfgMultBins.value, cPoolUseEvtPl ? CfgEvtPlBins.value : std::vector<double>{}, cPoolDepth);
+    }
     // Print output histograms statistics
     LOG(info) << "Size of the histograms in phi analysis:";
     histos.print();
   }
 
   double massKa = MassKaonCharged;
+  o2::analysis::ResoDaughterCache kaonCache;                                   // selected kaons of the current collision
+  o2::analysis::rsn::MixingPool<o2::analysis::ResoDaughterCache> mixingPool; // selected kaons of the previous collisions
 
   template <typename TrackType>
   bool trackCut(const TrackType track)
@@ -286,6 +296,101 @@ struct phianalysis {
     }
   }
 
+  /// Fills the cache with the kaons of a collision passing the track and PID selections
+  template <bool FillQA, typename TracksType>
+  void fillKaonCache(const TracksType& dTracks, o2::analysis::ResoDaughterCache& kaons)
+  {
+    kaons.clear();
+    kaons.reserve(dTracks.size());
+    for (const auto& trk : dTracks) {
+      if (!trackCut(trk))
+        continue;
+      auto isTrkhasTOF = trk.hasTOF();
+      auto trkptKa = trk.pt();
+      auto trkNSigmaKaTPC = trk.tpcNSigmaKa();
+      auto trkNSigmaKaTOF = (isTrkhasTOF) ? trk.tofNSigmaKa() : -999.;
+      //// QA plots before the selection
+      if constexpr (FillQA) {
+        histos.fill(HIST("QAbefore/TPC_Nsigmaka_all"), trkptKa, trkNSigmaKaTPC);
+        if (isTrkhasTOF) {
+          histos.fill(HIST("QAbefore/TOF_Nsigma_all"), trkptKa, trkNSigmaKaTOF);
+          histos.fill(HIST("QAbefore/TOF_TPC_Mapka_all"), trkNSigmaKaTOF, trkNSigmaKaTPC);
+        }
+        histos.fill(HIST("QAbefore/trkpT"), trkptKa);
+        histos.fill(HIST("QAbefore/trkDCAxy"), trk.dcaXY());
+        histos.fill(HIST("QAbefore/trkDCAz"), trk.dcaZ());
+      }
+
+      //// Apply the selection
+      if (cUseOnlyTOFTrackKa && !isTrkhasTOF)
+        continue;
+      if (!selectionPIDKaon(trk))
+        continue;
+
+      //// QA plots after the selection
+      if constexpr (FillQA) {
+        histos.fill(HIST("QAafter/TPC_Nsigmaka_all"), trkptKa, trkNSigmaKaTPC);
+        if (isTrkhasTOF) {
+          histos.fill(HIST("QAafter/TOF_Nsigma_all"), trkptKa, trkNSigmaKaTOF);
+          histos.fill(HIST("QAafter/TOF_TPC_Mapka_all"), trkNSigmaKaTOF, trkNSigmaKaTPC);
+        }
+        histos.fill(HIST("QAafter/trkpT"), trkptKa);
+        histos.fill(HIST("QAafter/trkDCAxy"), trk.dcaXY());
+        histos.fill(HIST("QAafter/trkDCAz"), trk.dcaZ());
+      }
+
+      kaons.add(trk.globalIndex(), trk.px(), trk.py(), trk.pz(), trk.sign(), trkNSigmaKaTPC, trkNSigmaKaTOF, isTrkhasTOF);
+    }
+    kaons.finalize(massKa);
+  }
+
+  /// Same-event pairs built from the compact kaon cache: the track selection, the PID selection and the QA are done once per track,
+  /// and only the pairs with a mass in the histogram range are formed. Same pair orientation as fillHistograms.
+  template <bool IsMC, typename CollisionType, typename TracksType>
+  void fillHistogramsCached(const CollisionType& collision, const TracksType& dTracks)
+  {
+    auto multiplicity = collision.cent();
+    fillKaonCache<true>(dTracks, kaonCache);
+
+    //// Resonance reconstruction, un-like sign pairs only
+    o2::analysis::forEachPairInMassWindow(kaonCache, kaonCache, true, cInvMassStart, cInvMassEnd, [&](size_t i1, size_t i2, float mass, const std::array<float, 4>& pVec) {
+      if (kaonCache.sign(i1) * kaonCache.sign(i2) >= 0)
+        return;
+      // the first track of the pair is the one with the lower index, as in the combinations of fillHistograms
+      if (kaonCache.globalIndex(i2) < kaonCache.globalIndex(i1))
+        std::swap(i1, i2);
+      // Rapidity cut
+      if (std::abs(0.5 * std::log((pVec[3] + pVec[2]) / (pVec[3] - pVec[2]))) > 0.5)
+        return;
+      auto ptResonance = std::hypot(pVec[0], pVec[1]);
+      if (kaonCache.sign(i1) > 0) {
+        histos.fill(HIST("phiinvmassDS"), mass);
+        histos.fill(HIST("h3phiinvmassDS"), multiplicity, ptResonance, mass);
+      }
+
+      // MC
+      if constexpr (IsMC) {
+        auto trk1 = dTracks.rawIteratorAt(kaonCache.globalIndex(i1) - dTracks.offset());
+        auto trk2 = dTracks.rawIteratorAt(kaonCache.globalIndex(i2) - dTracks.offset());
+        if (abs(trk1.pdgCode()) != 321 || abs(trk2.pdgCode()) != 321)
+          return;
+        if (trk1.motherId() != trk2.motherId()) // Same mother
+          return;
+        if (abs(trk1.motherPDG()) != 333)
+          return;
+
+        // Track selection check.
+        histos.fill(HIST("QAMCTrue/trkDCAxy"), trk2.dcaXY());
+        histos.fill(HIST("QAMCTrue/trkDCAz"), trk2.dcaZ());
+
+        // MC histograms
+        histos.fill(HIST("phiRec"), ptResonance, multiplicity);
+        histos.fill(HIST("phiRecinvmass"), mass);
+        histos.fill(HIST("h3Recphiinvmass"), multiplicity, ptResonance, mass);
+      }
+    });
+  }
+
   void processDataLight(aod::ResoCollision& collision,
                         aod::ResoTracks const& resotracks)
   {
@@ -301,6 +406,20 @@ struct phianalysis {
   }
   PROCESS_SWITCH(phianalysis, processMCLight, "Process Event for MC", false);
 
+  void processDataCached(aod::ResoCollision& collision,
+                         aod::ResoTracks const& resotracks)
+  {
+    fillHistogramsCached<false>(collision, resotracks);
+  }
+  PROCESS_SWITCH(phianalysis, processDataCached, "Process Event for data with the kaon cache (QA per track, pairs in the mass range only)", false);
+
+  void processMCCached(aod::ResoCollision& collision,
+                       soa::Join<aod::ResoTracks, aod::ResoMCTracks> const& resotracks)
+  {
+    fillHistogramsCached<true>(collision, resotracks);
+  }
+  PROCESS_SWITCH(phianalysis, processMCCached, "Process Event for MC with the kaon cache (QA per track, pairs in the mass range only)", false);
+
   void processMCTrue(aod::ResoCollision& collision, aod::ResoMCParents& resoParents)
   {
     auto multiplicity = collision.cent();
@@ -331,6 +450,28 @@ struct phianalysis {
     }
   };
   PROCESS_SWITCH(phianalysis, processMELight, "Process EventMixing light without partition", false);
+
+  // Event mixing with the kaons of the previous collisions of the same class, kept in the pool across data frames
+  void processMEPool(aod::ResoCollision& collision, aod::ResoTracks const& resotracks)
+  {
+    auto multiplicity = collision.cent();
+    o2::analysis::ResoDaughterCache kaons;
+    fillKaonCache<false>(resotracks, kaons);
+    auto mixingClass = mixingPool.getClass(collision.posZ(), multiplicity, collision.evtPl());
+    mixingPool.forEachEvent(mixingClass, [&](const o2::analysis::ResoDaughterCache& pooledKaons) {
+      o2::analysis::forEachPairInMassWindow(kaons, pooledKaons, false, cInvMassStart, cInvMassEnd, [&](size_t i1, size_t i2, float mass, const std::array<float, 4>& pVec) {
+        if (kaons.sign(i1) * pooledKaons.sign(i2) >= 0)
+          return;
+        // Rapidity cut
+        if (std::abs(0.5 * std::log((pVec[3] + pVec[2]) / (pVec[3] - pVec[2]))) > 0.5)
+          return;
+        histos.fill(HIST("phiinvmassME"), mass);
+        histos.fill(HIST("h3phiinvmassME"), multiplicity, std::hypot(pVec[0], pVec[1]), mass);
+      });
+    });
+    mixingPool.add(mixingClass, std::move(kaons));
+  }
+  PROCESS_SWITCH(phianalysis, processMEPool, "Process EventMixing with the mixing pool kept across data frames", false);
 };
 
 WorkflowSpec defineDataProcessing(ConfigContext const& cfgc)
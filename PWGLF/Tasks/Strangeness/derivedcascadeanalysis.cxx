@@ -36,6 +36,8 @@
 #include <TPDGCode.h>
 #include <TDatabasePDG.h>
 
+#include <vector>
+
 // constants
 const float ctauxiPDG = 4.91;     // from PDG
 const float ctauomegaPDG = 2.461; // from PDG
@@ -145,6 +147,26 @@ struct derivedCascadeAnalysis {
   Configurable<float> dcaCacsDauPar1{"dcaCacsDauPar1", 0.5, " par for pt dep DCA cascade daughter cut, 1< p_T < 4 GeV/c"};
   Configurable<float> dcaCacsDauPar2{"dcaCacsDauPar2", 0.2, " par for pt dep DCA cascade daughter cut, p_T > 4 GeV/c"};
 
+  // systematic variations of the topological selections, evaluated in one pass over the candidates
+  // the selections above are the envelope: each variation has to be at least as tight
+  static constexpr float defaultTopoVariations[1][10] = {{0.97, 0.97, 1., 1.5, 0.04, 0.1, 0.05, 0.06, 1.4, 1.2}};
+  Configurable<bool> doTopoVariations{"doTopoVariations", false, "fill the variation-indexed mass histograms of topoVariations"};
+  Configurable<LabeledArray<float>> topoVariations{"topoVariations", {defaultTopoVariations[0], 1, 10, {"variation0"}, {"casccospa", "v0cospa", "dcacascdau", "dcav0dau", "dcaBachToPV", "dcaMesonToPV", "dcaBaryonToPV", "dcaV0ToPV", "minRadius", "minV0Radius"}}, "topological selections, one row per variation (max. 32)"};
+
+  struct TopoVariation {
+    float casccospa;
+    float v0cospa;
+    float dcacascdau;
+    float dcav0dau;
+    float dcaBachToPV;
+    float dcaMesonToPV;
+    float dcaBaryonToPV;
+    float dcaV0ToPV;
+    float minRadius;
+    float minV0Radius;
+  };
+  std::vector<TopoVariation> topoVariationCuts;
+
   Service<o2::framework::O2DatabasePDG> pdgDB;
 
   static constexpr std::string_view Index[] = {"1", "2", "3", "4", "5", "6", "7", "8", "9", "10"};
@@ -226,6 +248,33 @@ struct derivedCascadeAnalysis {
     if (doBefSelCheck)
       histos.addClone("InvMassAfterSel/", "InvMassBefSel/");
 
+    if (doTopoVariations) {
+      int nVariations = topoVariations->rows();
+      if (nVariations < 1 || nVariations > 32)
+        LOGF(fatal, "topoVariations has %d variations, 1 to 32 are supported, please configure properly!!", nVariations);
+      for (int i = 0; i < nVariations; i++) {
+        TopoVariation variation{topoVariations->get(i, "casccospa"), topoVariations->get(i, "v0cospa"), topoVariations->get(i, "dcacascdau"), topoVariations->get(i, "dcav0dau"), topoVariations->get(i, "dcaBachToPV"),
+                                topoVariations->get(i, "dcaMesonToPV"), topoVariations->get(i, "dcaBaryonToPV"), topoVariations->get(i, "dcaV0ToPV"), topoVariations->get(i, "minRadius"), topoVariations->get(i, "minV0Radius")};
+        // the pT dependent and the disabled selections are not compared
+        bool isLooser = (doCascadeCosPaCut && !doPtDepCosPaCut && variation.casccospa < casccospa) ||
+                        (doV0CosPaCut && !doPtDepV0CosPaCut && variation.v0cospa < v0cospa) ||
+                        (doDCACascadeDauCut && !doPtDepDCAcascDauCut && variation.dcacascdau > dcacascdau) ||
+                        (doDCAV0DauCut && variation.dcav0dau > dcav0dau) ||
+                        (doDCAdauToPVCut && (variation.dcaBachToPV < dcaBachToPV || variation.dcaMesonToPV < dcaMesonToPV || variation.dcaBaryonToPV < dcaBaryonToPV)) ||
+                        (doDCAV0ToPVCut && variation.dcaV0ToPV < dcaV0ToPV) ||
+                        (doCascadeRadiusCut && !doPtDepCascRadiusCut && variation.minRadius < minRadius) ||
+                        (doV0RadiusCut && !doPtDepV0RadiusCut && variation.minV0Radius < minV0Radius);
+        if (isLooser)
+          LOGF(fatal, "Topological variation %d is looser than the default selections, please configure properly!!", i);
+        topoVariationCuts.push_back(variation);
+      }
+      const AxisSpec axisVariation{nVariations, -0.5f, nVariations - 0.5f, "variation"};
+      histos.add("Variations/hNegativeCascade", "hNegativeCascade", HistType::kTHnF, {axisVariation, axisPt, isXi ? axisXiMass : axisOmegaMass, {101, 0, 101}});
+      histos.add("Variations/hPositiveCascade", "hPositiveCascade", HistType::kTHnF, {axisVariation, axisPt, isXi ? axisXiMass : axisOmegaMass, {101, 0, 101}});
+      if (isMC)
+        histos.addClone("Variations/", "VariationsMCrecTruth/");
+    }
+
     if (isMC)
       histos.addClone("InvMassAfterSel/", "InvMassAfterSelMCrecTruth/");
 
@@ -625,6 +674,49 @@ struct derivedCascadeAnalysis {
     return true;
   }
 
+  template <typename TCascade, typename TCollision>
+  uint32_t computeVariationBitmap(TCascade casc, TCollision coll)
+  // one bit per topological variation passed by the candidate
+  {
+    float casccosPA = casc.casccosPA(coll.posX(), coll.posY(), coll.posZ());
+    float v0cosPA = casc.v0cosPA(casc.x(), casc.y(), casc.z());
+    float dcaV0ToPV = TMath::Abs(casc.dcav0topv(coll.posX(), coll.posY(), coll.posZ()));
+    float dcaMesonToPV = TMath::Abs(casc.sign() < 0 ? casc.dcanegtopv() : casc.dcapostopv());
+    float dcaBaryonToPV = TMath::Abs(casc.sign() < 0 ? casc.dcapostopv() : casc.dcanegtopv());
+    uint32_t variationMap = 0;
+    for (size_t i = 0; i < topoVariationCuts.size(); i++) {
+      auto const& variation = topoVariationCuts[i];
+      if (casccosPA < variation.casccospa || v0cosPA < variation.v0cospa || casc.dcacascdaughters() > variation.dcacascdau || casc.dcaV0daughters() > variation.dcav0dau)
+        continue;
+      if (TMath::Abs(casc.dcabachtopv()) < variation.dcaBachToPV || dcaMesonToPV < variation.dcaMesonToPV || dcaBaryonToPV < variation.dcaBaryonToPV || dcaV0ToPV < variation.dcaV0ToPV)
+        continue;
+      if (casc.cascradius() < variation.minRadius || casc.v0radius() < variation.minV0Radius)
+        continue;
+      variationMap |= (uint32_t(1) << i);
+    }
+    return variationMap;
+  }
+
+  template <bool isMCTruth, typename TCascade>
+  void fillVariations(TCascade casc, uint32_t variationMap, double invmass, float centrality)
+  {
+    for (size_t i = 0; i < topoVariationCuts.size(); i++) {
+      if (!(variationMap & (uint32_t(1) << i)))
+        continue;
+      if constexpr (isMCTruth) {
+        if (casc.sign() < 0)
+          histos.fill(HIST("VariationsMCrecTruth/hNegativeCascade"), i, casc.pt(), invmass, centrality);
+        else
+          histos.fill(HIST("VariationsMCrecTruth/hPositiveCascade"), i, casc.pt(), invmass, centrality);
+      } else {
+        if (casc.sign() < 0)
+          histos.fill(HIST("Variations/hNegativeCascade"), i, casc.pt(), invmass, centrality);
+        else
+          histos.fill(HIST("Variations/hPositiveCascade"), i, casc.pt(), invmass, centrality);
+      }
+    }
+  }
+
   void processCascades(soa::Join<aod::StraCollisions, aod::StraCents, aod::StraRawCents, aod::StraEvSels>::iterator const& coll, soa::Join<aod::CascCollRefs, aod::CascCores, aod::CascExtras, aod::CascBBs, aod::CascTOFNSigmas> const& Cascades, soa::Join<aod::DauTrackExtras, aod::DauTrackTPCPIDs> const&)
   {
 
@@ -830,6 +922,9 @@ struct derivedCascadeAnalysis {
         }
       }
 
+      if (doTopoVariations)
+        fillVariations<false>(casc, computeVariationBitmap(casc, coll), invmass, coll.centFT0C());
+
       if (casc.sign() < 0) {
         histos.fill(HIST("InvMassAfterSel/hNegativeCascade"), casc.pt(), invmass, coll.centFT0C());
         if (doOccupancyCheck) {
@@ -1099,6 +1194,13 @@ struct derivedCascadeAnalysis {
         invmass = casc.mOmega();
       }
 
+      if (doTopoVariations) {
+        uint32_t variationMap = computeVariationBitmap(casc, coll);
+        fillVariations<false>(casc, variationMap, invmass, coll.centFT0C());
+        if (casc.isPhysicalPrimary() && ((isXi && TMath::Abs(casc.pdgCode()) == 3312) || (!isXi && TMath::Abs(casc.pdgCode()) == 3334)) && casc.pdgCode() * casc.sign() < 0)
+          fillVariations<true>(casc, variationMap, invmass, coll.centFT0C());
+      }
+
       if (casc.sign() < 0) {
         histos.fill(HIST("InvMassAfterSel/hNegativeCascade"), casc.pt(), invmass, coll.centFT0C());
         if (!doBachelorBaryonCut && doPtDepCutStudy)
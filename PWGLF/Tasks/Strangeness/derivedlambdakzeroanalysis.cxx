@@ -26,6 +26,8 @@
 #include <cmath>
 #include <array>
 #include <cstdlib>
+#include <string>
+#include <vector>
 
 #include <TFile.h>
 #include <TH2F.h>
@@ -137,6 +139,12 @@ struct derivedlambdakzeroanalysis {
   static constexpr float defaultLifetimeCuts[1][2] = {{30., 20.}};
   Configurable<LabeledArray<float>> lifetimecut{"lifetimecut", {defaultLifetimeCuts[0], 2, {"lifetimecutLambda", "lifetimecutK0S"}}, "lifetimecut"};
 
+  // systematic variations of the topological selections, evaluated in one pass over the candidates
+  // the selections above are the envelope: each variation has to be at least as tight
+  static constexpr float defaultTopoVariations[1][5] = {{0.97, 1.0, .05, .05, 1.2}};
+  Configurable<bool> doTopoVariations{"doTopoVariations", false, "fill the variation-indexed mass histograms of topoVariations"};
+  Configurable<LabeledArray<float>> topoVariations{"topoVariations", {defaultTopoVariations[0], 1, 5, {"variation0"}, {"v0cospa", "dcav0dau", "dcanegtopv", "dcapostopv", "v0radius"}}, "topological selections, one row per variation (max. 32)"};
+
   ConfigurableAxis axisPt{"axisPt", {VARIABLE_WIDTH, 0.0f, 0.1f, 0.2f, 0.3f, 0.4f, 0.5f, 0.6f, 0.7f, 0.8f, 0.9f, 1.0f, 1.1f, 1.2f, 1.3f, 1.4f, 1.5f, 1.6f, 1.7f, 1.8f, 1.9f, 2.0f, 2.2f, 2.4f, 2.6f, 2.8f, 3.0f, 3.2f, 3.4f, 3.6f, 3.8f, 4.0f, 4.4f, 4.8f, 5.2f, 5.6f, 6.0f, 6.5f, 7.0f, 7.5f, 8.0f, 9.0f, 10.0f, 11.0f, 12.0f, 13.0f, 14.0f, 15.0f, 17.0f, 19.0f, 21.0f, 23.0f, 25.0f, 30.0f, 35.0f, 40.0f, 50.0f}, "pt axis for analysis"};
   ConfigurableAxis axisPtXi{"axisPtXi", {VARIABLE_WIDTH, 0.0f, 0.1f, 0.2f, 0.3f, 0.4f, 0.5f, 0.6f, 0.7f, 0.8f, 0.9f, 1.0f, 1.1f, 1.2f, 1.3f, 1.4f, 1.5f, 1.6f, 1.7f, 1.8f, 1.9f, 2.0f, 2.2f, 2.4f, 2.6f, 2.8f, 3.0f, 3.2f, 3.4f, 3.6f, 3.8f, 4.0f, 4.4f, 4.8f, 5.2f, 5.6f, 6.0f, 6.5f, 7.0f, 7.5f, 8.0f, 9.0f, 10.0f, 11.0f, 12.0f, 13.0f, 14.0f, 15.0f, 17.0f, 19.0f, 21.0f, 23.0f, 25.0f, 30.0f, 35.0f, 40.0f, 50.0f}, "pt axis for feeddown from Xi"};
   ConfigurableAxis axisPtCoarse{"axisPtCoarse", {VARIABLE_WIDTH, 0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 7.0f, 10.0f, 15.0f}, "pt axis for QA"};
@@ -235,6 +243,15 @@ struct derivedlambdakzeroanalysis {
   uint64_t secondaryMaskSelectionLambda;
   uint64_t secondaryMaskSelectionAntiLambda;
 
+  struct TopoVariation {
+    float v0cospa;
+    float dcav0dau;
+    float dcanegtopv;
+    float dcapostopv;
+    float v0radius;
+  };
+  std::vector<TopoVariation> topoVariationCuts;
+
   void init(InitContext const&)
   {
     // initialise bit masks
@@ -458,6 +475,26 @@ struct derivedlambdakzeroanalysis {
     // demo // fast
     histos.add("hMassK0Short", "hMassK0Short", kTH1F, {axisK0Mass});
 
+    // topological variations
+    if (doTopoVariations) {
+      int nVariations = topoVariations->rows();
+      if (nVariations < 1 || nVariations > 32)
+        LOGF(fatal, "topoVariations has %d variations, 1 to 32 are supported, please configure properly!!", nVariations);
+      for (int i = 0; i < nVariations; i++) {
+        TopoVariation variation{topoVariations->get(i, "v0cospa"), topoVariations->get(i, "dcav0dau"), topoVariations->get(i, "dcanegtopv"), topoVariations->get(i, "dcapostopv"), topoVariations->get(i, "v0radius")};
+        if (variation.v0cospa < v0cospa || variation.dcav0dau > dcav0dau || variation.dcanegtopv < dcanegtopv || variation.dcapostopv < dcapostopv || variation.v0radius < v0radius)
+          LOGF(fatal, "Topological variation %d is looser than the default selections, please configure properly!!", i);
+        topoVariationCuts.push_back(variation);
+      }
+      const AxisSpec axisVariation{nVariations, -0.5f, nVariations - 0.5f, "variation"};
+      if (analyseK0Short)
+        histos.add("Variations/h4dMassK0Short", "h4dMassK0Short", kTHnF, {axisVariation, axisCentrality, axisPt, axisK0Mass});
+      if (analyseLambda)
+        histos.add("Variations/h4dMassLambda", "h4dMassLambda", kTHnF, {axisVariation, axisCentrality, axisPt, axisLambdaMass});
+      if (analyseAntiLambda)
+        histos.add("Variations/h4dMassAntiLambda", "h4dMassAntiLambda", kTHnF, {axisVariation, axisCentrality, axisPt, axisLambdaMass});
+    }
+
     // QA histograms if requested
     if (doCompleteTopoQA) {
       // initialize for K0short...
@@ -778,6 +815,19 @@ struct derivedlambdakzeroanalysis {
     return bitMap;
   }
 
+  template <typename TV0>
+  uint32_t computeVariationBitmap(TV0 v0)
+  // one bit per topological variation passed by the candidate
+  {
+    uint32_t variationMap = 0;
+    for (size_t i = 0; i < topoVariationCuts.size(); i++) {
+      auto const& variation = topoVariationCuts[i];
+      if (v0.v0cosPA() > variation.v0cospa && v0.dcaV0daughters() < variation.dcav0dau && TMath::Abs(v0.dcanegtopv()) > variation.dcanegtopv && TMath::Abs(v0.dcapostopv()) > variation.dcapostopv && v0.v0radius() > variation.v0radius)
+        variationMap |= (uint32_t(1) << i);
+    }
+    return variationMap;
+  }
+
   template <typename TV0>
   void analyseCandidate(TV0 v0, float pt, float centrality, uint64_t selMap)
   // precalculate this information so that a check is one mask operation, not many
@@ -802,6 +852,27 @@ struct derivedlambdakzeroanalysis {
       histos.fill(HIST("h2dNegativeITSvsTPCpts"), negTrackExtra.tpcCrossedRows(), negTrackExtra.itsNCls());
     }
 
+    // __________________________________________
+    // topological variations, on top of the default selections
+    if (doTopoVariations) {
+      bool isK0Short = verifyMask(selMap, maskSelectionK0Short) && analyseK0Short;
+      bool isLambda = verifyMask(selMap, maskSelectionLambda) && analyseLambda;
+      bool isAntiLambda = verifyMask(selMap, maskSelectionAntiLambda) && analyseAntiLambda;
+      if (isK0Short || isLambda || isAntiLambda) {
+        uint32_t variationMap = computeVariationBitmap(v0);
+        for (size_t i = 0; i < topoVariationCuts.size(); i++) {
+          if (!bitcheck(variationMap, i))
+            continue;
+          if (isK0Short)
+            histos.fill(HIST("Variations/h4dMassK0Short"), i, centrality, pt, v0.mK0Short());
+          if (isLambda)
+            histos.fill(HIST("Variations/h4dMassLambda"), i, centrality, pt, v0.mLambda());
+          if (isAntiLambda)
+            histos.fill(HIST("Variations/h4dMassAntiLambda"), i, centrality, pt, v0.mAntiLambda());
+        }
+      }
+    }
+
     // __________________________________________
     // main analysis
     if (verifyMask(selMap, maskSelectionK0Short) && analyseK0Short) {
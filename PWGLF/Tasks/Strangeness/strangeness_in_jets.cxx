@@ -754,6 +754,11 @@ struct strangeness_in_jets {
     return;
   }
 
+  // Kinematics of the particles of the jet finder, kept between the events
+  std::vector<double> particleEta;
+  std::vector<double> particlePhi;
+  std::vector<float> particleOneOverPt2;
+
   void processData(SelectedCollisions::iterator const& collision, aod::V0Datas const& fullV0s, aod::CascDataExt const& Cascades, aod::V0sLinked const& /*V0linked*/, FullTracks const& tracks)
   {
     registryQC.fill(HIST("number_of_events_data"), 0.5);
@@ -797,6 +802,18 @@ struct strangeness_in_jets {
     TVector3 p_leading(leading_track.px(), leading_track.py(), leading_track.pz());
     int nParticles = static_cast<int>(particle_ID.size());
 
+    // Kinematics of the selected particles, computed once for all the iterations of the jet finder
+    particleEta.resize(nParticles);
+    particlePhi.resize(nParticles);
+    particleOneOverPt2.resize(nParticles);
+    for (int i = 0; i < nParticles; i++) {
+      auto stored_track = tracks.iteratorAt(particle_ID[i]);
+      TVector3 p_particle(stored_track.px(), stored_track.py(), stored_track.pz());
+      particleEta[i] = p_particle.Eta();
+      particlePhi[i] = p_particle.Phi();
+      particleOneOverPt2[i] = 1.0 / (p_particle.Pt() * p_particle.Pt());
+    }
+
     // Jet Finder
     int exit(0);
     int nPartAssociated(0);
@@ -807,21 +824,21 @@ struct strangeness_in_jets {
       int label_jet_particle(0);
       int i_jet_particle(0);
 
+      // Leading direction of this iteration
+      float one_over_pt2_lead = 1.0 / (p_leading.Pt() * p_leading.Pt());
+      double eta_lead = p_leading.Eta();
+      double phi_lead = p_leading.Phi();
+
       for (int i = 0; i < nParticles; i++) {
 
         // Skip Leading Particle & Elements already associated to the Jet
         if (particle_ID[i] == leading_ID || particle_ID[i] == -1)
           continue;
 
-        // Get Particle Momentum
-        auto stored_track = tracks.iteratorAt(particle_ID[i]);
-        TVector3 p_particle(stored_track.px(), stored_track.py(), stored_track.pz());
-
         // Variables
-        float one_over_pt2_part = 1.0 / (p_particle.Pt() * p_particle.Pt());
-        float one_over_pt2_lead = 1.0 / (p_leading.Pt() * p_leading.Pt());
-        float deltaEta = p_particle.Eta() - p_leading.Eta();
-        float deltaPhi = GetDeltaPhi(p_particle.Phi(), p_leading.Phi());
+        float one_over_pt2_part = particleOneOverPt2[i];
+        float deltaEta = particleEta[i] - eta_lead;
+        float deltaPhi = GetDeltaPhi(particlePhi[i], phi_lead);
         float min = Minimum(one_over_pt2_part, one_over_pt2_lead);
         float Delta2 = deltaEta * deltaEta + deltaPhi * deltaPhi;
 
@@ -894,6 +911,14 @@ struct strangeness_in_jets {
     // Event multiplicity
     float multiplicity = collision.centFT0M();
 
+    // Directions of the jet and UE cones, computed once for all the candidates
+    const double eta_jet_axis = jet_axis.Eta();
+    const double phi_jet_axis = jet_axis.Phi();
+    const double eta_ue_axis1 = ue_axis1.Eta();
+    const double phi_ue_axis1 = ue_axis1.Phi();
+    const double eta_ue_axis2 = ue_axis2.Eta();
+    const double phi_ue_axis2 = ue_axis2.Phi();
+
     if (debug_level3 == true)
       return;
 
@@ -906,17 +931,19 @@ struct strangeness_in_jets {
         return;
 
       TVector3 v0dir(pos.px() + neg.px(), pos.py() + neg.py(), pos.pz() + neg.pz());
+      const double eta_v0dir = v0dir.Eta();
+      const double phi_v0dir = v0dir.Phi();
 
-      float deltaEta_jet = v0dir.Eta() - jet_axis.Eta();
-      float deltaPhi_jet = GetDeltaPhi(v0dir.Phi(), jet_axis.Phi());
+      float deltaEta_jet = eta_v0dir - eta_jet_axis;
+      float deltaPhi_jet = GetDeltaPhi(phi_v0dir, phi_jet_axis);
       float deltaR_jet = sqrt(deltaEta_jet * deltaEta_jet + deltaPhi_jet * deltaPhi_jet);
 
-      float deltaEta_ue1 = v0dir.Eta() - ue_axis1.Eta();
-      float deltaPhi_ue1 = GetDeltaPhi(v0dir.Phi(), ue_axis1.Phi());
+      float deltaEta_ue1 = eta_v0dir - eta_ue_axis1;
+      float deltaPhi_ue1 = GetDeltaPhi(phi_v0dir, phi_ue_axis1);
       float deltaR_ue1 = sqrt(deltaEta_ue1 * deltaEta_ue1 + deltaPhi_ue1 * deltaPhi_ue1);
 
-      float deltaEta_ue2 = v0dir.Eta() - ue_axis2.Eta();
-      float deltaPhi_ue2 = GetDeltaPhi(v0dir.Phi(), ue_axis2.Phi());
+      float deltaEta_ue2 = eta_v0dir - eta_ue_axis2;
+      float deltaPhi_ue2 = GetDeltaPhi(phi_v0dir, phi_ue_axis2);
       float deltaR_ue2 = sqrt(deltaEta_ue2 * deltaEta_ue2 + deltaPhi_ue2 * deltaPhi_ue2);
 
       // K0s
@@ -975,15 +1002,17 @@ struct strangeness_in_jets {
         return;
 
       TVector3 cascade_dir(casc.px(), casc.py(), casc.pz());
+      const double eta_cascade_dir = cascade_dir.Eta();
+      const double phi_cascade_dir = cascade_dir.Phi();
 
-      float deltaEta_jet = cascade_dir.Eta() - jet_axis.Eta();
-      float deltaPhi_jet = GetDeltaPhi(cascade_dir.Phi(), jet_axis.Phi());
+      float deltaEta_jet = eta_cascade_dir - eta_jet_axis;
+      float deltaPhi_jet = GetDeltaPhi(phi_cascade_dir, phi_jet_axis);
       float deltaR_jet = sqrt(deltaEta_jet * deltaEta_jet + deltaPhi_jet * deltaPhi_jet);
-      float deltaEta_ue1 = cascade_dir.Eta() - ue_axis1.Eta();
-      float deltaPhi_ue1 = GetDeltaPhi(cascade_dir.Phi(), ue_axis1.Phi());
+      float deltaEta_ue1 = eta_cascade_dir - eta_ue_axis1;
+      float deltaPhi_ue1 = GetDeltaPhi(phi_cascade_dir, phi_ue_axis1);
       float deltaR_ue1 = sqrt(deltaEta_ue1 * deltaEta_ue1 + deltaPhi_ue1 * deltaPhi_ue1);
-      float deltaEta_ue2 = cascade_dir.Eta() - ue_axis2.Eta();
-      float deltaPhi_ue2 = GetDeltaPhi(cascade_dir.Phi(), ue_axis2.Phi());
+      float deltaEta_ue2 = eta_cascade_dir - eta_ue_axis2;
+      float deltaPhi_ue2 = GetDeltaPhi(phi_cascade_dir, phi_ue_axis2);
       float deltaR_ue2 = sqrt(deltaEta_ue2 * deltaEta_ue2 + deltaPhi_ue2 * deltaPhi_ue2);
 
       // Xi+
@@ -1043,14 +1072,16 @@ struct strangeness_in_jets {
         continue;
 
       TVector3 track_dir(track.px(), track.py(), track.pz());
-      float deltaEta_jet = track_dir.Eta() - jet_axis.Eta();
-      float deltaPhi_jet = GetDeltaPhi(track_dir.Phi(), jet_axis.Phi());
+      const double eta_track_dir = track_dir.Eta();
+      const double phi_track_dir = track_dir.Phi();
+      float deltaEta_jet = eta_track_dir - eta_jet_axis;
+      float deltaPhi_jet = GetDeltaPhi(phi_track_dir, phi_jet_axis);
       float deltaR_jet = sqrt(deltaEta_jet * deltaEta_jet + deltaPhi_jet * deltaPhi_jet);
-      float deltaEta_ue1 = track_dir.Eta() - ue_axis1.Eta();
-      float deltaPhi_ue1 = GetDeltaPhi(track_dir.Phi(), ue_axis1.Phi());
+      float deltaEta_ue1 = eta_track_dir - eta_ue_axis1;
+      float deltaPhi_ue1 = GetDeltaPhi(phi_track_dir, phi_ue_axis1);
       float deltaR_ue1 = sqrt(deltaEta_ue1 * deltaEta_ue1 + deltaPhi_ue1 * deltaPhi_ue1);
-      float deltaEta_ue2 = track_dir.Eta() - ue_axis2.Eta();
-      float deltaPhi_ue2 = GetDeltaPhi(track_dir.Phi(), ue_axis2.Phi());
+      float deltaEta_ue2 = eta_track_dir - eta_ue_axis2;
+      float deltaPhi_ue2 = GetDeltaPhi(phi_track_dir, phi_ue_axis2);
       float deltaR_ue2 = sqrt(deltaEta_ue2 * deltaEta_ue2 + deltaPhi_ue2 * deltaPhi_ue2);
 
       // TPC
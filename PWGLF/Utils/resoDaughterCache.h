@@ -0,0 +1,214 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file  resoDaughterCache.h
+/// \brief Compact per-collision store of selected resonance daughters and pairing in an invariant-mass window.
+///        The daughters are selected once per track, stored in pT order, and the pairs are looked up in the pT
+///        interval compatible with the upper edge of the mass window instead of looping over all track combinations.
+///
+
+#ifndef PWGLF_UTILS_RESODAUGHTERCACHE_H_
+#define PWGLF_UTILS_RESODAUGHTERCACHE_H_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+#include "Common/DataModel/PIDResponse.h"
+
+namespace o2::analysis
+{
+
+class ResoDaughterCache
+{
+ public:
+  using pidBinning = o2::aod::pidtpc_tiny::binning; // 8-bit nSigma, as in the tiny PID tables
+
+  void clear()
+  {
+    mGlobalIndices.clear();
+    mPx.clear();
+    mPy.clear();
+    mPz.clear();
+    mPt.clear();
+    mE.clear();
+    mSigns.clear();
+    mHasTOF.clear();
+    mNSigmaTPC.clear();
+    mNSigmaTOF.clear();
+  }
+  void reserve(size_t n)
+  {
+    mGlobalIndices.reserve(n);
+    mPx.reserve(n);
+    mPy.reserve(n);
+    mPz.reserve(n);
+    mSigns.reserve(n);
+    mHasTOF.reserve(n);
+    mNSigmaTPC.reserve(n);
+    mNSigmaTOF.reserve(n);
+  }
+  size_t size() const { return mGlobalIndices.size(); }
+  bool empty() const { return mGlobalIndices.empty(); }
+
+  /// Adds a selected daughter. The selections are expected to be done on the full-precision values before,
+  /// the nSigma are stored with the 8-bit binning for QA and later use.
+  void add(int64_t globalIndex, float px, float py, float pz, int8_t sign, float nSigmaTPC, float nSigmaTOF, bool hasTOF)
+  {
+    mGlobalIndices.push_back(globalIndex);
+    mPx.push_back(px);
+    mPy.push_back(py);
+    mPz.push_back(pz);
+    mSigns.push_back(sign);
+    mHasTOF.push_back(hasTOF);
+    mNSigmaTPC.push_back(pack(nSigmaTPC));
+    mNSigmaTOF.push_back(pack(nSigmaTOF));
+  }
+
+  /// Sorts the daughters in pT and computes their energies with the given mass hypothesis
+  void finalize(float mass)
+  {
+    mMass = mass;
+    const size_t n = size();
+    std::vector<float> pts(n);
+    for (size_t i = 0; i < n; ++i) {
+      pts[i] = std::hypot(mPx[i], mPy[i]);
+    }
+    std::vector<size_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&pts](size_t a, size_t b) { return pts[a] < pts[b]; });
+    permute(mGlobalIndices, order);
+    permute(mPx, order);
+    permute(mPy, order);
+    permute(mPz, order);
+    permute(mSigns, order);
+    permute(mHasTOF, order);
+    permute(mNSigmaTPC, order);
+    permute(mNSigmaTOF, order);
+    mPt.resize(n);
+    mE.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+      mPt[i] = pts[order[i]];
+      mE[i] = std::sqrt(mPt[i] * mPt[i] + mPz[i] * mPz[i] + mass * mass);
+    }
+  }
+
+  float mass() const { return mMass; }
+  int64_t globalIndex(size_t i) const { return mGlobalIndices[i]; }
+  float px(size_t i) const { return mPx[i]; }
+  float py(size_t i) const { return mPy[i]; }
+  float pz(size_t i) const { return mPz[i]; }
+  float pt(size_t i) const { return mPt[i]; }
+  float e(size_t i) const { return mE[i]; }
+  int8_t sign(size_t i) const { return mSigns[i]; }
+  bool hasTOF(size_t i) const { return mHasTOF[i]; }
+  float nSigmaTPC(size_t i) const { return o2::aod::pidutils::unPackInTable<pidBinning>(mNSigmaTPC[i]); }
+  float nSigmaTOF(size_t i) const { return o2::aod::pidutils::unPackInTable<pidBinning>(mNSigmaTOF[i]); }
+
+  /// First and past-the-end positions of the daughters with ptMin <= pT <= ptMax
+  std::pair<size_t, size_t> ptRange(float ptMin, float ptMax) const
+  {
+    auto first = std::lower_bound(mPt.begin(), mPt.end(), ptMin);
+    auto last = std::upper_bound(first, mPt.end(), ptMax);
+    return {static_cast<size_t>(first - mPt.begin()), static_cast<size_t>(last - mPt.begin())};
+  }
+
+ private:
+  static pidBinning::binned_t pack(float nSigma)
+  {
+    const float value = std::fmin(std::fmax(nSigma, pidBinning::binned_min), pidBinning::binned_max);
+    return static_cast<pidBinning::binned_t>((value / pidBinning::bin_width) + std::copysign(0.5f, value));
+  }
+
+  template <typename T>
+  static void permute(std::vector<T>& values, const std::vector<size_t>& order)
+  {
+    std::vector<T> sorted(values.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+      sorted[i] = values[order[i]];
+    }
+    values.swap(sorted);
+  }
+
+  float mMass = 0.f;
+  std::vector<int64_t> mGlobalIndices; // index of the track in the table it was read from
+  std::vector<float> mPx;
+  std::vector<float> mPy;
+  std::vector<float> mPz;
+  std::vector<float> mPt; // sorted once finalized
+  std::vector<float> mE;  // energy with the mass hypothesis of finalize
+  std::vector<int8_t> mSigns;
+  std::vector<bool> mHasTOF;
+  std::vector<pidBinning::binned_t> mNSigmaTPC;
+  std::vector<pidBinning::binned_t> mNSigmaTOF;
+};
+
+/// pT interval of the second daughter for which the pair mass can be below massMax, for a first daughter of transverse momentum pt1.
+/// It uses the lower bound m^2 >= m1^2 + m2^2 + 2 (mT1 mT2 - pT1 pT2) of the pair mass, reached for collinear daughters.
+/// \return false if no pair can have a mass below massMax
+inline bool getPtRangeBelowMass(float pt1, float mass1, float mass2, float massMax, float& ptMin, float& ptMax)
+{
+  constexpr double Tolerance = 1.e-4; // relative widening against rounding, the pair mass is checked afterwards
+  const double k = 0.5 * (static_cast<double>(massMax) * massMax - static_cast<double>(mass1) * mass1 - static_cast<double>(mass2) * mass2);
+  const double m1m2 = static_cast<double>(mass1) * mass2;
+  if (k < m1m2) {
+    return false;
+  }
+  if (mass1 <= 0.f) {
+    ptMin = 0.f;
+    ptMax = std::numeric_limits<float>::max();
+    return true;
+  }
+  const double mt1 = std::sqrt(static_cast<double>(pt1) * pt1 + static_cast<double>(mass1) * mass1);
+  const double delta = mt1 * std::sqrt(k * k - m1m2 * m1m2);
+  const double mass1Sq = static_cast<double>(mass1) * mass1;
+  ptMin = static_cast<float>(std::max(0., (k * pt1 - delta) / mass1Sq * (1. - Tolerance)));
+  ptMax = static_cast<float>((k * pt1 + delta) / mass1Sq * (1. + Tolerance));
+  return true;
+}
+
+/// Calls func(i1, i2, mass, pVec) for each pair of daughters of caches 1 and 2 with massMin <= mass < massMax,
+/// where pVec holds the px, py, pz and energy of the pair.
+/// For the same cache (isSameCache), each pair of different daughters is given once, with i1 < i2.
+template <typename Func>
+void forEachPairInMassWindow(const ResoDaughterCache& cache1, const ResoDaughterCache& cache2, bool isSameCache, float massMin, float massMax, Func&& func)
+{
+  float ptMin = 0.f, ptMax = 0.f;
+  std::array<float, 4> pVec{};
+  for (size_t i1 = 0; i1 < cache1.size(); ++i1) {
+    if (!getPtRangeBelowMass(cache1.pt(i1), cache1.mass(), cache2.mass(), massMax, ptMin, ptMax)) {
+      return;
+    }
+    auto [first, last] = cache2.ptRange(ptMin, ptMax);
+    if (isSameCache) {
+      first = std::max(first, i1 + 1);
+    }
+    for (size_t i2 = first; i2 < last; ++i2) {
+      pVec = {cache1.px(i1) + cache2.px(i2), cache1.py(i1) + cache2.py(i2), cache1.pz(i1) + cache2.pz(i2), cache1.e(i1) + cache2.e(i2)};
+      const float mass2 = pVec[3] * pVec[3] - pVec[0] * pVec[0] - pVec[1] * pVec[1] - pVec[2] * pVec[2];
+      const float mass = mass2 > 0.f ? std::sqrt(mass2) : 0.f;
+      if (mass < massMin || mass >= massMax) {
+        continue;
+      }
+      func(i1, i2, mass, pVec);
+    }
+  }
+}
+
+} // namespace o2::analysis
+
+#endif // PWGLF_UTILS_RESODAUGHTERCACHE_H_
@@ -0,0 +1,53 @@
+// Copyright 2019-2024 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+///
+/// \file  rsnMixingPool.h
+/// \brief Event-mixing pool for resonance analyses, kept by the task and therefore filled across data frames.
+///        Events are classified in z-vertex, multiplicity and event plane, and each class keeps the compact
+///        daughter arrays of its last events up to a configurable depth.
+///
+
+#ifndef PWGLF_UTILS_RSNMIXINGPOOL_H_
+#define PWGLF_UTILS_RSNMIXINGPOOL_H_
+
+#include <vector>
+
+#include "Common/Core/EventPool.h"
+
+namespace o2::analysis
+{
+namespace rsn
+{
+
+/// \tparam EventData  compact content of one event (e.g. o2::analysis::ResoDaughterCache), has to be movable
+template <typename EventData>
+class MixingPool : public eventmixing::EventPool<EventData, 3>
+{
+ public:
+  /// Sets the classes and the depth and empties the pool.
+  /// The binnings are given in the ConfigurableAxis format: {VARIABLE_WIDTH, edges...} or {nBins, min, max}.
+  /// An empty event-plane binning disables the event-plane classes.
+  void init(std::vector<double> const& vzBins, std::vector<double> const& multBins, std::vector<double> const& evtPlBins, int depth)
+  {
+    eventmixing::EventPool<EventData, 3>::init({vzBins, multBins, evtPlBins}, depth);
+  }
+
+  /// Mixing class of an event, -1 if outside the binning
+  int getClass(float vz, float mult, float evtPl) const
+  {
+    return eventmixing::EventPool<EventData, 3>::getClass(vz, mult, evtPl);
+  }
+};
+
+} // namespace rsn
+} // namespace o2::analysis
+
+#endif // PWGLF_UTILS_RSNMIXINGPOOL_H_
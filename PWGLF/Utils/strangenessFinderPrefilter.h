@@ -0,0 +1,176 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+/// \file  strangenessFinderPrefilter.h
+/// \brief Analytic transverse-plane prefilter of the daughter combinations in the V0 and cascade finders
+///        The trajectories are approximated by circles (tracks) or straight lines (V0s) in the transverse plane,
+///        without material or field inhomogeneities, and a combination is rejected before any DCA fit if the
+///        trajectories cannot get close enough or if they only do so outside the allowed radial range.
+///        The transverse distance is a lower bound of the 3D DCA, such that the cut is loose by construction.
+
+#ifndef PWGLF_UTILS_STRANGENESSFINDERPREFILTER_H_
+#define PWGLF_UTILS_STRANGENESSFINDERPREFILTER_H_
+
+#include <algorithm>
+#include <cmath>
+
+#include "MathUtils/Primitive2D.h"
+
+namespace o2
+{
+namespace pwglf
+{
+
+// Trajectory in the transverse plane: circle if r > 0, straight line through (x, y) along (ux, uy) otherwise
+struct TrajectoryXY {
+  float x = 0.f;
+  float y = 0.f;
+  float r = 0.f;
+  float ux = 0.f;
+  float uy = 0.f;
+};
+
+// Transverse-plane trajectory of a track in the field bz (kG)
+template <typename TTrackPar>
+TrajectoryXY getTrajectoryXY(TTrackPar const& track, float bz)
+{
+  TrajectoryXY trajectory;
+  o2::math_utils::CircleXYf_t circle;
+  float sna, csa;
+  track.getCircleParams(bz, circle, sna, csa);
+  trajectory.x = circle.xC;
+  trajectory.y = circle.yC;
+  trajectory.r = circle.rC;
+  if (trajectory.r <= 0.f) { // straight track, the circle center is the track position
+    float phi = track.getPhi();
+    trajectory.ux = std::cos(phi);
+    trajectory.uy = std::sin(phi);
+  }
+  return trajectory;
+}
+
+// Transverse-plane trajectory of a neutral particle from its decay vertex and momentum
+inline TrajectoryXY getTrajectoryXY(float x, float y, float px, float py)
+{
+  TrajectoryXY trajectory;
+  trajectory.x = x;
+  trajectory.y = y;
+  float pt = std::hypot(px, py);
+  if (pt > 0.f) {
+    trajectory.ux = px / pt;
+    trajectory.uy = py / pt;
+  }
+  return trajectory;
+}
+
+struct TopologyPrefilter {
+  float maxDCAxy = 1.f;    // maximum transverse distance between the trajectories (cm)
+  float minRadius = 0.f;   // minimum transverse radius of the decay point (cm)
+  float maxRadius = 200.f; // maximum transverse radius of the decay point (cm)
+  float maxLinePath = 1e9; // maximum distance of the decay point past the origin of a straight trajectory along its direction (cm),
+                           // e.g. the cascade decay point precedes the V0 decay point
+
+  // kRejectedRadius: decay point outside the radial range, or too far along a straight trajectory
+  enum Decision { kAccepted = 0,
+                  kRejectedDCAxy,
+                  kRejectedRadius };
+
+  // Checks whether two trajectories can form a decay vertex within the selections
+  Decision check(TrajectoryXY const& t1, TrajectoryXY const& t2) const
+  {
+    if (t1.r > 0.f && t2.r > 0.f) {
+      return checkCircles(t1, t2);
+    }
+    if (t1.r > 0.f && t2.r <= 0.f) {
+      return checkLineCircle(t2, t1);
+    }
+    if (t1.r <= 0.f && t2.r > 0.f) {
+      return checkLineCircle(t1, t2);
+    }
+    return kAccepted; // two straight lines: not worth it, leave it to the fit
+  }
+
+ private:
+  bool isInRadialRange(float x, float y) const
+  {
+    float r2 = x * x + y * y;
+    return r2 >= minRadius * minRadius && r2 <= maxRadius * maxRadius;
+  }
+
+  Decision checkCircles(TrajectoryXY const& c1, TrajectoryXY const& c2) const
+  {
+    float dx = c2.x - c1.x;
+    float dy = c2.y - c1.y;
+    float d = std::hypot(dx, dy);
+    if (d <= 0.f) {
+      return kAccepted; // concentric circles, no information
+    }
+    float ux = dx / d;
+    float uy = dy / d;
+    if (d > c1.r + c2.r) { // outer circles: closest approach on the line between the centers
+      float gap = d - c1.r - c2.r;
+      if (gap > maxDCAxy) {
+        return kRejectedDCAxy;
+      }
+      float s = c1.r + 0.5f * gap;
+      return isInRadialRange(c1.x + s * ux, c1.y + s * uy) ? kAccepted : kRejectedRadius;
+    }
+    if (d < std::abs(c1.r - c2.r)) { // one circle inside the other one
+      float gap = std::abs(c1.r - c2.r) - d;
+      if (gap > maxDCAxy) {
+        return kRejectedDCAxy;
+      }
+      // closest approach on the line between the centers, on the side of the inner circle
+      TrajectoryXY const& outer = c1.r > c2.r ? c1 : c2;
+      float sign = c1.r > c2.r ? 1.f : -1.f;
+      float s = outer.r - 0.5f * gap;
+      return isInRadialRange(outer.x + sign * s * ux, outer.y + sign * s * uy) ? kAccepted : kRejectedRadius;
+    }
+    // crossing circles: two candidate decay points
+    float a = 0.5f * (d * d + c1.r * c1.r - c2.r * c2.r) / d;
+    float h = std::sqrt(std::max(c1.r * c1.r - a * a, 0.f));
+    float xm = c1.x + a * ux;
+    float ym = c1.y + a * uy;
+    if (isInRadialRange(xm - h * uy, ym + h * ux) || isInRadialRange(xm + h * uy, ym - h * ux)) {
+      return kAccepted;
+    }
+    return kRejectedRadius;
+  }
+
+  Decision checkLineCircle(TrajectoryXY const& line, TrajectoryXY const& circle) const
+  {
+    // foot of the perpendicular from the circle center to the line
+    float t0 = (circle.x - line.x) * line.ux + (circle.y - line.y) * line.uy;
+    float fx = line.x + t0 * line.ux;
+    float fy = line.y + t0 * line.uy;
+    float h = std::hypot(circle.x - fx, circle.y - fy);
+    if (h > circle.r) {
+      float gap = h - circle.r;
+      if (gap > maxDCAxy) {
+        return kRejectedDCAxy;
+      }
+      // half way between the line and the circle
+      float s = 0.5f * gap / h;
+      return isInRadialRange(fx + s * (circle.x - fx), fy + s * (circle.y - fy)) && t0 < maxLinePath ? kAccepted : kRejectedRadius;
+    }
+    float s = std::sqrt(circle.r * circle.r - h * h);
+    if ((isInRadialRange(fx + s * line.ux, fy + s * line.uy) && t0 + s < maxLinePath) ||
+        (isInRadialRange(fx - s * line.ux, fy - s * line.uy) && t0 - s < maxLinePath)) {
+      return kAccepted;
+    }
+    return kRejectedRadius;
+  }
+};
+
+} // namespace pwglf
+} // namespace o2
+
+#endif // PWGLF_UTILS_STRANGENESSFINDERPREFILTER_H_
@@ -12,6 +12,9 @@
 #ifndef PWGLF_UTILS_V0SELECTIONTOOLS_H_
 #define PWGLF_UTILS_V0SELECTIONTOOLS_H_
 
+#include <cmath>
+#include <cstdint>
+#include <vector>
 #include "v0SelectionBits.h"
 #include "v0SelectionGroup.h"
 
@@ -126,6 +129,160 @@ uint64_t computeReconstructionBitmap(TV0 v0, TTrack posTrackExtra, TTrack negTra
 
   return bitMap;
 }
+
+// V0 variables entering computeReconstructionBitmap, stored per column for the bulk evaluation
+struct v0SelectionColumns {
+  std::vector<float> v0radius, dcapostopv, dcanegtopv, v0cosPA, dcaV0daughters;
+  std::vector<float> yLambda, yK0Short, distOverTotMom, qtarm, alpha;
+  std::vector<int> posITSNCls, negITSNCls, posTPCCrossedRows, negTPCCrossedRows;
+  std::vector<uint8_t> posDetectorMap, negDetectorMap;
+  std::vector<float> posTPCNSigmaPi, posTPCNSigmaPr, negTPCNSigmaPi, negTPCNSigmaPr;
+  // TOF information, left empty if not available
+  std::vector<float> posTOFDeltaTLaPr, posTOFDeltaTLaPi, posTOFDeltaTK0Pi, negTOFDeltaTLaPr, negTOFDeltaTLaPi, negTOFDeltaTK0Pi;
+  std::vector<float> tofNSigmaLaPr, tofNSigmaALaPi, tofNSigmaK0PiPlus, tofNSigmaALaPr, tofNSigmaLaPi, tofNSigmaK0PiMinus;
+
+  size_t size() const { return v0radius.size(); }
+  bool hasTOF() const { return !tofNSigmaLaPr.empty(); }
+
+  void clear()
+  {
+    for (auto* column : {&v0radius, &dcapostopv, &dcanegtopv, &v0cosPA, &dcaV0daughters, &yLambda, &yK0Short, &distOverTotMom, &qtarm, &alpha,
+                         &posTPCNSigmaPi, &posTPCNSigmaPr, &negTPCNSigmaPi, &negTPCNSigmaPr,
+                         &posTOFDeltaTLaPr, &posTOFDeltaTLaPi, &posTOFDeltaTK0Pi, &negTOFDeltaTLaPr, &negTOFDeltaTLaPi, &negTOFDeltaTK0Pi,
+                         &tofNSigmaLaPr, &tofNSigmaALaPi, &tofNSigmaK0PiPlus, &tofNSigmaALaPr, &tofNSigmaLaPi, &tofNSigmaK0PiMinus}) {
+      column->clear();
+    }
+    for (auto* column : {&posITSNCls, &negITSNCls, &posTPCCrossedRows, &negTPCCrossedRows}) {
+      column->clear();
+    }
+    posDetectorMap.clear();
+    negDetectorMap.clear();
+  }
+
+  // same accessors as computeReconstructionBitmap; the TOF columns are filled if the V0 table has them
+  template <typename TV0, typename TTrack, typename TCollision>
+  void add(TV0 const& v0, TTrack const& posTrackExtra, TTrack const& negTrackExtra, TCollision const& collision)
+  {
+    v0radius.push_back(v0.v0radius());
+    dcapostopv.push_back(v0.dcapostopv());
+    dcanegtopv.push_back(v0.dcanegtopv());
+    v0cosPA.push_back(v0.v0cosPA());
+    dcaV0daughters.push_back(v0.dcaV0daughters());
+    yLambda.push_back(v0.yLambda());
+    yK0Short.push_back(v0.yK0Short());
+    distOverTotMom.push_back(v0.distovertotmom(collision.posX(), collision.posY(), collision.posZ()));
+    qtarm.push_back(v0.qtarm());
+    alpha.push_back(v0.alpha());
+
+    posITSNCls.push_back(posTrackExtra.itsNCls());
+    negITSNCls.push_back(negTrackExtra.itsNCls());
+    posTPCCrossedRows.push_back(posTrackExtra.tpcCrossedRows());
+    negTPCCrossedRows.push_back(negTrackExtra.tpcCrossedRows());
+    posDetectorMap.push_back(posTrackExtra.detectorMap());
+    negDetectorMap.push_back(negTrackExtra.detectorMap());
+    posTPCNSigmaPi.push_back(posTrackExtra.tpcNSigmaPi());
+    posTPCNSigmaPr.push_back(posTrackExtra.tpcNSigmaPr());
+    negTPCNSigmaPi.push_back(negTrackExtra.tpcNSigmaPi());
+    negTPCNSigmaPr.push_back(negTrackExtra.tpcNSigmaPr());
+
+    if constexpr (requires { v0.tofNSigmaLaPr(); v0.posTOFDeltaTLaPr(); }) {
+      posTOFDeltaTLaPr.push_back(v0.posTOFDeltaTLaPr());
+      posTOFDeltaTLaPi.push_back(v0.posTOFDeltaTLaPi());
+      posTOFDeltaTK0Pi.push_back(v0.posTOFDeltaTK0Pi());
+      negTOFDeltaTLaPr.push_back(v0.negTOFDeltaTLaPr());
+      negTOFDeltaTLaPi.push_back(v0.negTOFDeltaTLaPi());
+      negTOFDeltaTK0Pi.push_back(v0.negTOFDeltaTK0Pi());
+      tofNSigmaLaPr.push_back(v0.tofNSigmaLaPr());
+      tofNSigmaALaPi.push_back(v0.tofNSigmaALaPi());
+      tofNSigmaK0PiPlus.push_back(v0.tofNSigmaK0PiPlus());
+      tofNSigmaALaPr.push_back(v0.tofNSigmaALaPr());
+      tofNSigmaLaPi.push_back(v0.tofNSigmaLaPi());
+      tofNSigmaK0PiMinus.push_back(v0.tofNSigmaK0PiMinus());
+    }
+  }
+};
+
+// bulk version of computeReconstructionBitmap: each selection is evaluated in one pass over a column.
+// Without TOF columns, the TOF bits are set, i.e. the TOF selections are not applied.
+inline void computeReconstructionBitmaps(const v0SelectionColumns& v0s, const v0SelectionGroup& v0sels, std::vector<uint64_t>& bitMaps)
+{
+  const size_t nV0s = v0s.size();
+  bitMaps.assign(nV0s, 0);
+  auto setBits = [&](int bit, auto&& isSelected) {
+    for (size_t i = 0; i < nV0s; i++) {
+      bitMaps[i] |= static_cast<uint64_t>(isSelected(i)) << bit;
+    }
+  };
+  auto setAbsBelow = [&](int bit, const std::vector<float>& column, float cut) {
+    setBits(bit, [&](size_t i) { return std::fabs(column[i]) < cut; });
+  };
+
+  // Base topological variables
+  const float v0radius = v0sels.getv0radius(), v0radiusMax = v0sels.getv0radiusMax();
+  const float dcapostopv = v0sels.getdcapostopv(), dcanegtopv = v0sels.getdcanegtopv();
+  const float v0cospa = v0sels.getv0cospa(), dcav0dau = v0sels.getdcav0dau();
+  setBits(v0data::selRadius, [&](size_t i) { return v0s.v0radius[i] > v0radius; });
+  setBits(v0data::selRadiusMax, [&](size_t i) { return v0s.v0radius[i] < v0radiusMax; });
+  setBits(v0data::selDCAPosToPV, [&](size_t i) { return std::fabs(v0s.dcapostopv[i]) > dcapostopv; });
+  setBits(v0data::selDCANegToPV, [&](size_t i) { return std::fabs(v0s.dcanegtopv[i]) > dcanegtopv; });
+  setBits(v0data::selCosPA, [&](size_t i) { return v0s.v0cosPA[i] > v0cospa; });
+  setBits(v0data::selDCAV0Dau, [&](size_t i) { return v0s.dcaV0daughters[i] < dcav0dau; });
+
+  // rapidity
+  setAbsBelow(v0data::selLambdaRapidity, v0s.yLambda, v0sels.getRapidityCut());
+  setAbsBelow(v0data::selK0ShortRapidity, v0s.yK0Short, v0sels.getRapidityCut());
+
+  // ITS and TPC quality flags
+  const int minITSclusters = v0sels.getminITSclusters(), minTPCrows = v0sels.getminTPCrows();
+  setBits(v0data::selPosGoodITSTrack, [&](size_t i) { return v0s.posITSNCls[i] >= minITSclusters; });
+  setBits(v0data::selNegGoodITSTrack, [&](size_t i) { return v0s.negITSNCls[i] >= minITSclusters; });
+  setBits(v0data::selPosGoodTPCTrack, [&](size_t i) { return v0s.posTPCCrossedRows[i] >= minTPCrows; });
+  setBits(v0data::selNegGoodTPCTrack, [&](size_t i) { return v0s.negTPCCrossedRows[i] >= minTPCrows; });
+
+  // TPC PID
+  setAbsBelow(v0data::selTPCPIDPositivePion, v0s.posTPCNSigmaPi, v0sels.getTpcPidNsigmaCut());
+  setAbsBelow(v0data::selTPCPIDPositiveProton, v0s.posTPCNSigmaPr, v0sels.getTpcPidNsigmaCut());
+  setAbsBelow(v0data::selTPCPIDNegativePion, v0s.negTPCNSigmaPi, v0sels.getTpcPidNsigmaCut());
+  setAbsBelow(v0data::selTPCPIDNegativeProton, v0s.negTPCNSigmaPr, v0sels.getTpcPidNsigmaCut());
+
+  // TOF PID in DeltaT and NSigma
+  if (v0s.hasTOF()) {
+    setAbsBelow(v0data::selTOFDeltaTPositiveProtonLambda, v0s.posTOFDeltaTLaPr, v0sels.getmaxDeltaTimeProton());
+    setAbsBelow(v0data::selTOFDeltaTPositivePionLambda, v0s.posTOFDeltaTLaPi, v0sels.getmaxDeltaTimePion());
+    setAbsBelow(v0data::selTOFDeltaTPositivePionK0Short, v0s.posTOFDeltaTK0Pi, v0sels.getmaxDeltaTimePion());
+    setAbsBelow(v0data::selTOFDeltaTNegativeProtonLambda, v0s.negTOFDeltaTLaPr, v0sels.getmaxDeltaTimeProton());
+    setAbsBelow(v0data::selTOFDeltaTNegativePionLambda, v0s.negTOFDeltaTLaPi, v0sels.getmaxDeltaTimePion());
+    setAbsBelow(v0data::selTOFDeltaTNegativePionK0Short, v0s.negTOFDeltaTK0Pi, v0sels.getmaxDeltaTimePion());
+    setAbsBelow(v0data::selTOFNSigmaPositiveProtonLambda, v0s.tofNSigmaLaPr, v0sels.getTofPidNsigmaCutLaPr());
+    setAbsBelow(v0data::selTOFNSigmaPositivePionLambda, v0s.tofNSigmaALaPi, v0sels.getTofPidNsigmaCutLaPi());
+    setAbsBelow(v0data::selTOFNSigmaPositivePionK0Short, v0s.tofNSigmaK0PiPlus, v0sels.getTofPidNsigmaCutK0Pi());
+    setAbsBelow(v0data::selTOFNSigmaNegativeProtonLambda, v0s.tofNSigmaALaPr, v0sels.getTofPidNsigmaCutLaPr());
+    setAbsBelow(v0data::selTOFNSigmaNegativePionLambda, v0s.tofNSigmaLaPi, v0sels.getTofPidNsigmaCutLaPi());
+    setAbsBelow(v0data::selTOFNSigmaNegativePionK0Short, v0s.tofNSigmaK0PiMinus, v0sels.getTofPidNsigmaCutK0Pi());
+  } else {
+    for (const auto bit : {v0data::selTOFDeltaTPositiveProtonLambda, v0data::selTOFDeltaTPositivePionLambda, v0data::selTOFDeltaTPositivePionK0Short,
+                           v0data::selTOFDeltaTNegativeProtonLambda, v0data::selTOFDeltaTNegativePionLambda, v0data::selTOFDeltaTNegativePionK0Short,
+                           v0data::selTOFNSigmaPositiveProtonLambda, v0data::selTOFNSigmaPositivePionLambda, v0data::selTOFNSigmaPositivePionK0Short,
+                           v0data::selTOFNSigmaNegativeProtonLambda, v0data::selTOFNSigmaNegativePionLambda, v0data::selTOFNSigmaNegativePionK0Short}) {
+      setBits(bit, [](size_t) { return true; });
+    }
+  }
+
+  // ITS only and TPC only tags
+  setBits(v0data::selPosItsOnly, [&](size_t i) { return v0s.posTPCCrossedRows[i] < 1; });
+  setBits(v0data::selNegItsOnly, [&](size_t i) { return v0s.negTPCCrossedRows[i] < 1; });
+  setBits(v0data::selPosNotTPCOnly, [&](size_t i) { return v0s.posDetectorMap[i] != o2::aod::track::TPC; });
+  setBits(v0data::selNegNotTPCOnly, [&](size_t i) { return v0s.negDetectorMap[i] != o2::aod::track::TPC; });
+
+  // proper lifetime
+  const float lifetimeCutLambda = v0sels.getlifetimeCutLambda(), lifetimeCutK0Short = v0sels.getlifetimeCutK0Short();
+  setBits(v0data::selLambdaCTau, [&](size_t i) { return v0s.distOverTotMom[i] * o2::constants::physics::MassLambda0 < lifetimeCutLambda; });
+  setBits(v0data::selK0ShortCTau, [&](size_t i) { return v0s.distOverTotMom[i] * o2::constants::physics::MassK0Short < lifetimeCutK0Short; });
+
+  // armenteros
+  const float armPodCut = v0sels.getarmPodCut();
+  setBits(v0data::selK0ShortArmenteros, [&](size_t i) { return v0s.qtarm[i] * armPodCut > std::fabs(v0s.alpha[i]) || armPodCut < 1e-4; });
+}
 } // namespace v0data
 
 #endif // PWGLF_UTILS_V0SELECTIONTOOLS_H_
@@ -0,0 +1,89 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#ifndef PWGMM_LUMI_CORE_BCACCUMULATOR_H_
+#define PWGMM_LUMI_CORE_BCACCUMULATOR_H_
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "CommonConstants/LHCConstants.h"
+#include "Framework/Logger.h"
+
+namespace pwgmm::lumi
+{
+// Counters of one BC slot over a time slice
+struct BCCounters {
+  uint32_t nEntries = 0;     // readouts of the detector
+  uint32_t nVertex = 0;      // with the vertex trigger
+  uint32_t nCoincidence = 0; // with the channel coincidences on both sides
+  double chargeA = 0.;       // summed charge or amplitude, A side
+  double chargeC = 0.;       // summed charge or amplitude, C side
+};
+
+// Dense accumulators over the BC slots of an orbit, for the readouts of one time slice.
+// The filled slots are handed to a flush callback flush(sliceStart, localBC, counters), in BC order, when a readout
+// of another slice arrives and on finish(): a slice gives one row per filled BC instead of one row per readout.
+// The counters are additive, the rows of a slice split across dataframes are to be summed.
+class BCAccumulator
+{
+ public:
+  // sliceLength: length of the time slices, in the unit of the timestamps
+  void init(uint64_t sliceLength)
+  {
+    if (sliceLength == 0) {
+      LOGF(fatal, "BC accumulator with time slices of length 0, please configure properly!!");
+    }
+    mSliceLength = sliceLength;
+    mSlice = 0;
+    mFilled.clear();
+    mCounters.fill({});
+  }
+
+  // Counters of the BC of a readout, with the entry already counted
+  template <typename TFlush>
+  BCCounters& add(uint64_t timestamp, uint64_t globalBC, TFlush const& flush)
+  {
+    const uint64_t slice = timestamp / mSliceLength;
+    if (slice != mSlice) {
+      finish(flush);
+      mSlice = slice;
+    }
+    const int localBC = globalBC % o2::constants::lhc::LHCMaxBunches;
+    if (mCounters[localBC].nEntries++ == 0) {
+      mFilled.push_back(localBC);
+    }
+    return mCounters[localBC];
+  }
+
+  // Flushes the filled BCs of the current slice
+  template <typename TFlush>
+  void finish(TFlush const& flush)
+  {
+    std::sort(mFilled.begin(), mFilled.end());
+    for (const auto localBC : mFilled) {
+      flush(mSlice * mSliceLength, localBC, mCounters[localBC]);
+      mCounters[localBC] = {};
+    }
+    mFilled.clear();
+  }
+
+ private:
+  uint64_t mSliceLength = 1;
+  uint64_t mSlice = 0;
+  std::array<BCCounters, o2::constants::lhc::LHCMaxBunches> mCounters{};
+  std::vector<int> mFilled; // filled BCs of the current slice
+};
+} // namespace pwgmm::lumi
+
+#endif // PWGMM_LUMI_CORE_BCACCUMULATOR_H_
@@ -0,0 +1,42 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#ifndef PWGMM_LUMI_DATAMODEL_LUMIBCSLICES_H_
+#define PWGMM_LUMI_DATAMODEL_LUMIBCSLICES_H_
+
+#include "Framework/AnalysisDataModel.h"
+
+namespace o2::aod
+{
+namespace lumibc
+{
+enum FITDetector : uint8_t {
+  kFDD = 0,
+  kFT0
+};
+
+DECLARE_SOA_COLUMN(Detector, detector, uint8_t);          //! lumibc::FITDetector
+DECLARE_SOA_COLUMN(SliceStart, sliceStart, uint64_t);     //! start of the time slice, relative to the first timestamp (ms)
+DECLARE_SOA_COLUMN(LocalBC, localBC, uint16_t);           //! BC in the orbit
+DECLARE_SOA_COLUMN(NEntries, nEntries, uint32_t);         //! readouts of the detector
+DECLARE_SOA_COLUMN(NVertex, nVertex, uint32_t);           //! readouts with the vertex trigger
+DECLARE_SOA_COLUMN(NCoincidence, nCoincidence, uint32_t); //! readouts with the channel coincidences on both sides (FDD)
+DECLARE_SOA_COLUMN(ChargeA, chargeA, float);              //! summed charge (FDD) or amplitude (FT0), A side
+DECLARE_SOA_COLUMN(ChargeC, chargeC, float);              //! summed charge (FDD) or amplitude (FT0), C side
+} // namespace lumibc
+
+DECLARE_SOA_TABLE(LumiBCSlices, "AOD", "LUMIBCSLICE", //! FIT counters per time slice and BC, additive over the rows
+                  lumibc::Detector, lumibc::SliceStart, lumibc::LocalBC,
+                  lumibc::NEntries, lumibc::NVertex, lumibc::NCoincidence,
+                  lumibc::ChargeA, lumibc::ChargeC);
+} // namespace o2::aod
+
+#endif // PWGMM_LUMI_DATAMODEL_LUMIBCSLICES_H_
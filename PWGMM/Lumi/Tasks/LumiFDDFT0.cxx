@@ -46,6 +46,9 @@
 #include "CCDB/CcdbApi.h"
 #include "DataFormatsCalibration/MeanVertexObject.h"
 
+#include "PWGMM/Lumi/Core/BCAccumulator.h"
+#include "PWGMM/Lumi/DataModel/LumiBCSlices.h"
+
 using namespace o2;
 using namespace o2::framework;
 using namespace o2::framework::expressions;
@@ -115,6 +118,7 @@ struct LumiFDDFT0 {
   Produces<o2::aod::EventInfo> rowEventInfo;
   Produces<o2::aod::EventInfoFDD> rowEventInfofdd;
   Produces<o2::aod::EventInfoFT0> rowEventInfoft0;
+  Produces<o2::aod::LumiBCSlices> rowLumiBCSlices;
   Service<o2::ccdb::BasicCCDBManager> ccdb;
   const char* ccdbpath_grp = "GLO/Config/GRPMagField";
   const char* ccdburl = "http://alice-ccdb.cern.ch";
@@ -123,6 +127,10 @@ struct LumiFDDFT0 {
   Configurable<uint64_t> fttimestamp{"fttimestamp", 1668080173000, "First time of time stamp"};
   Configurable<int> nContribMax{"nContribMax", 2500, "Maximum number of contributors"};
   Configurable<int> nContribMin{"nContribMin", 10, "Minimum number of contributors"};
+  Configurable<uint64_t> sliceLength{"sliceLength", 1000, "Length of the time slices of processPerBC (ms)"};
+
+  pwgmm::lumi::BCAccumulator accumulatorFDD;
+  pwgmm::lumi::BCAccumulator accumulatorFT0;
 
   HistogramRegistry histos{
     "histos",
@@ -163,6 +171,11 @@ struct LumiFDDFT0 {
     uint64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
     ccdb->setCreatedNotAfter(now);
     mRunNumber = 0;
+
+    if (doprocessPerBC) {
+      accumulatorFDD.init(sliceLength);
+      accumulatorFT0.init(sliceLength);
+    }
   }
 
   void processFull(soa::Join<aod::Collisions, aod::EvSels>::iterator const& collision, aod::FDDs const& /*fdds*/, aod::FT0s const& /*ft0s*/, aod::BCsWithTimestamps const&,
@@ -387,6 +400,64 @@ struct LumiFDDFT0 {
   };
   PROCESS_SWITCH(LumiFDDFT0, processLite, "Process FDD and FT0 info", false);
 
+  void processPerBC(aod::FDDs const& fdds, aod::FT0s const& ft0s, aod::BCsWithTimestamps const&)
+  {
+    // Readouts accumulated per time slice and BC, one row per filled BC of each slice instead of one per readout
+    auto flushFDD = [&](uint64_t sliceStart, int localBC, pwgmm::lumi::BCCounters const& counters) {
+      rowLumiBCSlices(o2::aod::lumibc::kFDD, sliceStart, localBC, counters.nEntries, counters.nVertex, counters.nCoincidence, counters.chargeA, counters.chargeC);
+    };
+    auto flushFT0 = [&](uint64_t sliceStart, int localBC, pwgmm::lumi::BCCounters const& counters) {
+      rowLumiBCSlices(o2::aod::lumibc::kFT0, sliceStart, localBC, counters.nEntries, counters.nVertex, counters.nCoincidence, counters.chargeA, counters.chargeC);
+    };
+
+    for (auto& fdd : fdds) {
+      auto bc = fdd.bc_as<BCsWithTimestamps>();
+      if (bc.timestamp() < fttimestamp) // no timestamp, or before the first time stamp
+        continue;
+      auto& counters = accumulatorFDD.add(bc.timestamp() - fttimestamp, bc.globalBC(), flushFDD);
+
+      auto SideA = fdd.chargeA();
+      auto SideC = fdd.chargeC();
+      std::vector<int> channelA;
+      std::vector<int> channelC;
+      for (auto i = 0; i < 8; i++) {
+        if (SideA[i] > 0) {
+          channelA.push_back(i);
+        }
+        if (SideC[i] > 0) {
+          channelC.push_back(i);
+        }
+        counters.chargeA += SideA[i];
+        counters.chargeC += SideC[i];
+      }
+      if (checkAnyCoincidence(channelA) && checkAnyCoincidence(channelC)) {
+        counters.nCoincidence++;
+      }
+      if (std::bitset<8>(fdd.triggerMask())[o2::fdd::Triggers::bitVertex]) {
+        counters.nVertex++;
+      }
+    }
+    accumulatorFDD.finish(flushFDD);
+
+    for (auto& ft0 : ft0s) {
+      auto bc = ft0.bc_as<BCsWithTimestamps>();
+      if (bc.timestamp() < fttimestamp)
+        continue;
+      auto& counters = accumulatorFT0.add(bc.timestamp() - fttimestamp, bc.globalBC(), flushFT0);
+      for (auto amplitude : ft0.amplitudeA()) {
+        counters.chargeA += amplitude;
+      }
+      for (auto amplitude : ft0.amplitudeC()) {
+        counters.chargeC += amplitude;
+      }
+      if (std::bitset<8>(ft0.triggerMask())[o2::fdd::Triggers::bitVertex]) {
+        counters.nVertex++;
+      }
+    }
+    accumulatorFT0.finish(flushFT0);
+  };
+  PROCESS_SWITCH(LumiFDDFT0, processPerBC, "Accumulate FDD and FT0 info per time slice and BC", false);
+
   bool checkAnyCoincidence(const std::vector<int>& channels)
   {
     std::map<int, int> channelPairs = {{0, 4}, {1, 5}, {2, 6}, {3, 7}};
@@ -0,0 +1,99 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+#ifndef PWGMM_MULT_CORE_INCLUDE_DENSEFILLBUFFER_H_
+#define PWGMM_MULT_CORE_INCLUDE_DENSEFILLBUFFER_H_
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "THnSparse.h"
+
+namespace pwgmm::mult
+{
+// Fill buffer of a THnSparse with unit weights: the entries are counted in a dense local array
+// over the binning of the histogram (under- and overflow included) and added to the histogram bin
+// by bin when flushed, such that each bin of the sparse histogram is looked up once per flush
+// instead of once per entry. Bin contents, errors and number of entries are the same as for direct filling.
+class DenseFillBuffer
+{
+ public:
+  // returns false, and the buffer is not used, if the binning has more than maxBins bins
+  bool init(std::shared_ptr<THnSparse> const& hist, uint64_t maxBins)
+  {
+    mHist = nullptr;
+    const int nDimensions = hist->GetNdimensions();
+    uint64_t nBins = 1;
+    mStrides.resize(nDimensions);
+    for (int idim = nDimensions - 1; idim >= 0; --idim) {
+      mStrides[idim] = nBins;
+      nBins *= hist->GetAxis(idim)->GetNbins() + 2;
+      if (nBins > maxBins) {
+        return false;
+      }
+    }
+    mHist = hist.get();
+    mCounts.assign(nBins, 0);
+    mFilledBins.clear();
+    mNEntries = 0;
+    return true;
+  }
+  bool isActive() const { return mHist != nullptr; }
+
+  template <typename... Ts>
+  void fill(Ts... values)
+  {
+    const double x[] = {static_cast<double>(values)...};
+    uint64_t index = 0;
+    for (size_t idim = 0; idim < sizeof...(Ts); ++idim) {
+      index += mStrides[idim] * mHist->GetAxis(idim)->FindBin(x[idim]);
+    }
+    if (mCounts[index]++ == 0) {
+      mFilledBins.push_back(index);
+    }
+    ++mNEntries;
+  }
+
+  void flush()
+  {
+    if (mNEntries == 0) {
+      return;
+    }
+    const bool calculateErrors = mHist->GetCalculateErrors();
+    std::vector<int> coordinates(mStrides.size());
+    for (auto index : mFilledBins) {
+      const double count = mCounts[index];
+      auto rest = index;
+      for (size_t idim = 0; idim < mStrides.size(); ++idim) {
+        coordinates[idim] = rest / mStrides[idim];
+        rest %= mStrides[idim];
+      }
+      auto bin = mHist->GetBin(coordinates.data(), true);
+      mHist->AddBinContent(bin, count);
+      if (calculateErrors) {
+        mHist->AddBinError2(bin, count);
+      }
+      mCounts[index] = 0;
+    }
+    mHist->SetEntries(mHist->GetEntries() + mNEntries);
+    mFilledBins.clear();
+    mNEntries = 0;
+  }
+
+ private:
+  THnSparse* mHist = nullptr;
+  std::vector<uint64_t> mStrides;    // stride of each axis in the dense array
+  std::vector<uint32_t> mCounts;     // number of entries in each bin
+  std::vector<uint64_t> mFilledBins; // bins with entries since the last flush
+  uint64_t mNEntries = 0;
+};
+} // namespace pwgmm::mult
+#endif // PWGMM_MULT_CORE_INCLUDE_DENSEFILLBUFFER_H_
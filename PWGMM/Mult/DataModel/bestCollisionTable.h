@@ -43,6 +43,7 @@ namespace pwgmm::indices
 {
 DECLARE_SOA_INDEX_COLUMN(Track, track);
 DECLARE_SOA_INDEX_COLUMN(MFTTrack, mfttrack);
+DECLARE_SOA_INDEX_COLUMN_FULL(BestCollision, bestCollision, int32_t, Collisions, "_Best"); // suffix avoids the clash with the collision index of the track tables
 } // namespace pwgmm::indices
 
 DECLARE_SOA_TABLE(BestCollisionsFwd, "AOD", "BESTCOLLFWD", o2::soa::Index<>, pwgmm::indices::MFTTrackId, aod::fwdtrack::AmbDegree,
@@ -67,6 +68,13 @@ DECLARE_SOA_TABLE(ReassignedTracksExtra, "AOD", "EXRETRACKS",
                   track::PtStatic, track::PStatic, track::EtaStatic,
                   track::PhiStatic);
 
+// Best collision of each track, one row per track of the source table, such that it can be joined with it.
+// Tracks which are not reassigned keep their collision (-1 if they have none)
+DECLARE_SOA_TABLE(TrackBestCollisions, "AOD", "TRKBESTCOLL",
+                  pwgmm::indices::BestCollisionId); // joinable with Tracks
+DECLARE_SOA_TABLE(MFTTrackBestCollisions, "AOD", "MFTBESTCOLL",
+                  pwgmm::indices::BestCollisionId); // joinable with MFTTracks
+
 } // namespace o2::aod
 
 #endif // PWGMM_MULT_DATAMODEL_BESTCOLLISIONTABLE_H_
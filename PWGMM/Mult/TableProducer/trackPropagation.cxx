@@ -54,6 +54,8 @@ struct AmbiguousTrackPropagation {
   Produces<aod::BestCollFwdExtra> fwdtracksBestCollExtra;
   Produces<aod::ReassignedTracksCore> tracksReassignedCore;
   Produces<aod::ReassignedTracksExtra> tracksReassignedExtra;
+  Produces<aod::TrackBestCollisions> tracksBestCollisionIndex;
+  Produces<aod::MFTTrackBestCollisions> mftTracksBestCollisionIndex;
   Service<o2::ccdb::BasicCCDBManager> ccdb;
 
   int runNumber = -1;
@@ -72,6 +74,7 @@ struct AmbiguousTrackPropagation {
 
   Configurable<bool> produceExtra{"produceExtra", false, "Produce table with refitted track parameters"};
   Configurable<bool> produceHistos{"produceHistos", false, "Produce control histograms"};
+  Configurable<bool> produceIndex{"produceIndex", false, "Produce the best collision index tables, joinable with the track tables"};
 
   HistogramRegistry registry{
     "registry",
@@ -110,6 +113,18 @@ struct AmbiguousTrackPropagation {
     }
   }
 
+  // best collision of each track of the data frame, for the tables joinable with the track tables
+  std::vector<int32_t> bestCollisions;
+
+  template <typename P>
+  void fillBestCollisionIndex(P& table)
+  {
+    table.reserve(bestCollisions.size());
+    for (auto bestCol : bestCollisions) {
+      table(bestCol);
+    }
+  }
+
   void initCCDB(ExtBCs::iterator const& bc)
   {
     if (runNumber == bc.runNumber()) {
@@ -153,6 +168,9 @@ struct AmbiguousTrackPropagation {
     gpu::gpustd::array<float, 2> dcaInfo;
     float bestDCA[2];
     o2::track::TrackParametrization<float> bestTrackPar;
+    if (produceIndex) {
+      bestCollisions.resize(tracks.size());
+    }
     for (auto& track : tracks) {
       dcaInfo[0] = track.dcaXY(); // DCAxy
       dcaInfo[1] = track.dcaZ();  // DCAz
@@ -160,6 +178,9 @@ struct AmbiguousTrackPropagation {
       bestDCA[1] = dcaInfo[1];
 
       auto bestCol = track.has_collision() ? track.collisionId() : -1;
+      if (produceIndex) {
+        bestCollisions[track.globalIndex()] = bestCol;
+      }
       if ((track.trackCutFlag() & trackSelectionITS) != trackSelectionITS) {
         continue;
       }
@@ -210,6 +231,9 @@ struct AmbiguousTrackPropagation {
           }
         }
       }
+      if (produceIndex) {
+        bestCollisions[track.globalIndex()] = bestCol;
+      }
       tracksReassignedCore(bestCol, track.globalIndex(), bestDCA[0], bestDCA[1]);
       if (produceExtra) {
         tracksReassignedExtra(bestTrackPar.getX(), bestTrackPar.getAlpha(),
@@ -218,10 +242,13 @@ struct AmbiguousTrackPropagation {
                               bestTrackPar.getP(), bestTrackPar.getEta(), bestTrackPar.getPhi());
       }
     }
+    if (produceIndex) {
+      fillBestCollisionIndex(tracksBestCollisionIndex);
+    }
   }
   PROCESS_SWITCH(AmbiguousTrackPropagation, processCentral, "Fill ReassignedTracks for central ambiguous tracks", true);
 
-  void processMFT(aod::MFTTracks const&,
+  void processMFT(aod::MFTTracks const& tracks,
                   aod::Collisions const&, ExtBCs const& bcs,
                   aod::AmbiguousMFTTracks const& atracks)
   {
@@ -238,6 +265,12 @@ struct AmbiguousTrackPropagation {
     float dcaInfo = 0.f;
     float bestDCA = 0.f, bestDCAx = 0.f, bestDCAy = 0.f;
     o2::track::TrackParCovFwd bestTrackPar;
+    if (produceIndex) {
+      bestCollisions.resize(tracks.size());
+      for (auto const& track : tracks) {
+        bestCollisions[track.globalIndex()] = track.has_collision() ? track.collisionId() : -1;
+      }
+    }
 
     for (auto& atrack : atracks) {
       dcaInfo = 999; // DCAxy
@@ -296,6 +329,9 @@ struct AmbiguousTrackPropagation {
         registry.fill(HIST("TracksAmbDegree"), degree);
       }
 
+      if (produceIndex) {
+        bestCollisions[atrack.mfttrackId()] = bestCol;
+      }
       fwdtracksBestCollisions(-1, degree, bestCol, bestDCA, bestDCAx, bestDCAy);
       if (produceExtra) {
         fwdtracksBestCollExtra(bestTrackPar.getX(),
@@ -304,6 +340,9 @@ struct AmbiguousTrackPropagation {
                                bestTrackPar.getP(), bestTrackPar.getEta(), bestTrackPar.getPhi());
       }
     }
+    if (produceIndex) {
+      fillBestCollisionIndex(mftTracksBestCollisionIndex);
+    }
   }
   PROCESS_SWITCH(AmbiguousTrackPropagation, processMFT, "Fill BestCollisionsFwd for MFT ambiguous tracks", false);
 
@@ -384,6 +423,9 @@ struct AmbiguousTrackPropagation {
         registry.fill(HIST("TrackIsAmb"), isAmbiguous);
       }
 
+      if (produceIndex) {
+        mftTracksBestCollisionIndex(bestCol);
+      }
       fwdtracksBestCollisions(track.globalIndex(), compatibleColls.size(), bestCol, bestDCA, bestDCAx, bestDCAy);
       if (produceExtra) {
         fwdtracksBestCollExtra(bestTrackPar.getX(),
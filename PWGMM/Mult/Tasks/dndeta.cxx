@@ -28,6 +28,7 @@
 #include "Functions.h"
 #include "Selections.h"
 #include "Histograms.h"
+#include "DenseFillBuffer.h"
 
 using namespace o2;
 using namespace o2::aod::track;
@@ -63,6 +64,9 @@ struct MultiplicityCounter {
   Configurable<bool> checkFT0PVcoincidence{"checkFT0PVcoincidence", true, "Check coincidence between FT0 and PV"};
   Configurable<bool> rejectITSonly{"rejectITSonly", false, "Reject ITS-only vertex"};
 
+  Configurable<bool> useDenseFillBuffers{"useDenseFillBuffers", false, "Count the track entries of the binned histograms in dense arrays, added to the histograms once per dataframe"};
+  Configurable<int> denseFillBufferMaxBins{"denseFillBufferMaxBins", 1 << 22, "Maximum number of bins of a histogram with a dense fill buffer"};
+
   template <typename C>
   inline bool isCollisionSelected(C const& collision)
   {
@@ -108,7 +112,57 @@ struct MultiplicityCounter {
   std::vector<int> usedTracksIdsDF;
   std::vector<int> usedTracksIdsDFMC;
   std::vector<int> usedTracksIdsDFMCEff;
-  void init(InitContext&)
+
+  // dense fill buffers of the binned track histograms
+  enum FillBuffers {
+    kBufEtaZvtx,
+    kBufEtaZvtx_gt0,
+    kBufEtaZvtx_PVgt0,
+    kBufPhiEta,
+    kBufPtEta,
+    kBufDCAXYPt,
+    kBufDCAZPt,
+    kBufReassignedEtaZvtx,
+    kBufReassignedPhiEta,
+    kBufReassignedZvtxCorr,
+    kBufReassignedDCAXYPt,
+    kBufReassignedDCAZPt,
+    kBufExtraEtaZvtx,
+    kBufExtraPhiEta,
+    kBufExtraDCAXYPt,
+    kBufExtraDCAZPt,
+    kNFillBuffers
+  };
+  std::array<DenseFillBuffer, kNFillBuffers> fillBuffers;
+
+  template <typename N>
+  void initFillBuffer(FillBuffers buffer, N const& name, std::string_view path)
+  {
+    if (!fillBuffers[buffer].init(binnedRegistry.get<THnSparse>(name), denseFillBufferMaxBins)) {
+      LOGP(info, "{} has more than {} bins, it is filled directly", path, static_cast<int>(denseFillBufferMaxBins));
+    }
+  }
+
+  template <typename N, typename... Ts>
+  void fillBinned(N const& name, FillBuffers buffer, Ts... values)
+  {
+    if (fillBuffers[buffer].isActive()) {
+      fillBuffers[buffer].fill(values...);
+    } else {
+      binnedRegistry.fill(name, values...);
+    }
+  }
+
+  void flushFillBuffers()
+  {
+    for (auto& buffer : fillBuffers) {
+      if (buffer.isActive()) {
+        buffer.flush();
+      }
+    }
+  }
+
+  void init(InitContext& context)
   {
     AxisSpec MultAxis = {multBinning};
     AxisSpec CentAxis = {centBinning, "centrality"};
@@ -191,6 +245,28 @@ struct MultiplicityCounter {
         binnedRegistry.add({ReassignedPhiEta.data(), "; #varphi; #eta; centrality", {HistType::kTHnSparseF, {PhiAxis, EtaAxis, CentAxis}}});
         binnedRegistry.add({ReassignedZvtxCorr.data(), "; Z_{vtx}^{orig} (cm); Z_{vtx}^{re} (cm); centrality", {HistType::kTHnSparseF, {ZAxis, ZAxis, CentAxis}}});
       }
+      if (useDenseFillBuffers) {
+        initFillBuffer(kBufEtaZvtx, HIST(EtaZvtx), EtaZvtx);
+        initFillBuffer(kBufEtaZvtx_gt0, HIST(EtaZvtx_gt0), EtaZvtx_gt0);
+        initFillBuffer(kBufEtaZvtx_PVgt0, HIST(EtaZvtx_PVgt0), EtaZvtx_PVgt0);
+        initFillBuffer(kBufPhiEta, HIST(PhiEta), PhiEta);
+        initFillBuffer(kBufPtEta, HIST(PtEta), PtEta);
+        initFillBuffer(kBufDCAXYPt, HIST(DCAXYPt), DCAXYPt);
+        initFillBuffer(kBufDCAZPt, HIST(DCAZPt), DCAZPt);
+        if (doprocessCountingAmbiguousCentralityFT0C || doprocessCountingAmbiguousCentralityFT0M) {
+          initFillBuffer(kBufReassignedEtaZvtx, HIST(ReassignedEtaZvtx), ReassignedEtaZvtx);
+          initFillBuffer(kBufReassignedPhiEta, HIST(ReassignedPhiEta), ReassignedPhiEta);
+          initFillBuffer(kBufReassignedZvtxCorr, HIST(ReassignedZvtxCorr), ReassignedZvtxCorr);
+          initFillBuffer(kBufReassignedDCAXYPt, HIST(ReassignedDCAXYPt), ReassignedDCAXYPt);
+          initFillBuffer(kBufReassignedDCAZPt, HIST(ReassignedDCAZPt), ReassignedDCAZPt);
+          initFillBuffer(kBufExtraEtaZvtx, HIST(ExtraEtaZvtx), ExtraEtaZvtx);
+          initFillBuffer(kBufExtraPhiEta, HIST(ExtraPhiEta), ExtraPhiEta);
+          initFillBuffer(kBufExtraDCAXYPt, HIST(ExtraDCAXYPt), ExtraDCAXYPt);
+          initFillBuffer(kBufExtraDCAZPt, HIST(ExtraDCAZPt), ExtraDCAZPt);
+        }
+        // the entries of the last dataframe are added before the histograms are written
+        context.services().get<CallbackService>().set<CallbackService::Id::EndOfStream>([this](EndOfStreamContext&) { flushFillBuffers(); });
+      }
     }
 
     if (doprocessGenAmbiguous || doprocessGen || doprocessGenAmbiguousEx || doprocessGenEx) {
@@ -413,9 +489,10 @@ struct MultiplicityCounter {
 
   PROCESS_SWITCH(MultiplicityCounter, processEventStatCentralityFT0M, "Collect event sample stats (FT0M binned)", false);
 
-  // clean up used Ids each dataframe (default process is always executed first)
+  // clean up used Ids and flush the fill buffers of the previous dataframe each dataframe (default process is always executed first)
   void process(aod::Collisions const&)
   {
+    flushFillBuffers();
     usedTracksIdsDF.clear();
     usedTracksIdsDFMC.clear();
     usedTracksIdsDFMCEff.clear();
@@ -452,11 +529,11 @@ struct MultiplicityCounter {
       }
       if constexpr (fillHistos) {
         if constexpr (hasRecoCent<C>()) {
-          binnedRegistry.fill(HIST(EtaZvtx), track.eta(), z, c);
-          binnedRegistry.fill(HIST(PhiEta), track.phi(), track.eta(), c);
-          binnedRegistry.fill(HIST(PtEta), track.pt(), track.eta(), c);
-          binnedRegistry.fill(HIST(DCAXYPt), track.pt(), track.dcaXY(), c);
-          binnedRegistry.fill(HIST(DCAZPt), track.pt(), track.dcaZ(), c);
+          fillBinned(HIST(EtaZvtx), kBufEtaZvtx, track.eta(), z, c);
+          fillBinned(HIST(PhiEta), kBufPhiEta, track.phi(), track.eta(), c);
+          fillBinned(HIST(PtEta), kBufPtEta, track.pt(), track.eta(), c);
+          fillBinned(HIST(DCAXYPt), kBufDCAXYPt, track.pt(), track.dcaXY(), c);
+          fillBinned(HIST(DCAZPt), kBufDCAZPt, track.pt(), track.dcaZ(), c);
         } else {
           inclusiveRegistry.fill(HIST(EtaZvtx), track.eta(), z);
           inclusiveRegistry.fill(HIST(PhiEta), track.phi(), track.eta());
@@ -509,10 +586,10 @@ struct MultiplicityCounter {
           }
           for (auto& track : tracks) {
             if (Ntrks > 0) {
-              binnedRegistry.fill(HIST(EtaZvtx_gt0), track.eta(), z, c);
+              fillBinned(HIST(EtaZvtx_gt0), kBufEtaZvtx_gt0, track.eta(), z, c);
             }
             if (INELgt0PV) {
-              binnedRegistry.fill(HIST(EtaZvtx_PVgt0), track.eta(), z, c);
+              fillBinned(HIST(EtaZvtx_PVgt0), kBufEtaZvtx_PVgt0, track.eta(), z, c);
             }
           }
         }
@@ -571,11 +648,11 @@ struct MultiplicityCounter {
       }
       if (fillHistos) {
         if constexpr (hasRecoCent<C>()) {
-          binnedRegistry.fill(HIST(EtaZvtx), otrack.eta(), z, c);
-          binnedRegistry.fill(HIST(PhiEta), otrack.phi(), otrack.eta(), c);
-          binnedRegistry.fill(HIST(PtEta), otrack.pt(), otrack.eta(), c);
-          binnedRegistry.fill(HIST(DCAXYPt), otrack.pt(), track.bestDCAXY(), c);
-          binnedRegistry.fill(HIST(DCAZPt), otrack.pt(), track.bestDCAZ(), c);
+          fillBinned(HIST(EtaZvtx), kBufEtaZvtx, otrack.eta(), z, c);
+          fillBinned(HIST(PhiEta), kBufPhiEta, otrack.phi(), otrack.eta(), c);
+          fillBinned(HIST(PtEta), kBufPtEta, otrack.pt(), otrack.eta(), c);
+          fillBinned(HIST(DCAXYPt), kBufDCAXYPt, otrack.pt(), track.bestDCAXY(), c);
+          fillBinned(HIST(DCAZPt), kBufDCAZPt, otrack.pt(), track.bestDCAZ(), c);
         } else {
           inclusiveRegistry.fill(HIST(EtaZvtx), otrack.eta(), z);
           inclusiveRegistry.fill(HIST(PhiEta), otrack.phi(), otrack.eta());
@@ -588,11 +665,11 @@ struct MultiplicityCounter {
         usedTracksIdsDF.emplace_back(track.trackId());
         if constexpr (fillHistos) {
           if constexpr (hasRecoCent<C>()) {
-            binnedRegistry.fill(HIST(ReassignedEtaZvtx), otrack.eta(), z, c);
-            binnedRegistry.fill(HIST(ReassignedPhiEta), otrack.phi(), otrack.eta(), c);
-            binnedRegistry.fill(HIST(ReassignedZvtxCorr), otrack.template collision_as<C>().posZ(), z, c);
-            binnedRegistry.fill(HIST(ReassignedDCAXYPt), otrack.pt(), track.bestDCAXY(), c);
-            binnedRegistry.fill(HIST(ReassignedDCAZPt), otrack.pt(), track.bestDCAZ(), c);
+            fillBinned(HIST(ReassignedEtaZvtx), kBufReassignedEtaZvtx, otrack.eta(), z, c);
+            fillBinned(HIST(ReassignedPhiEta), kBufReassignedPhiEta, otrack.phi(), otrack.eta(), c);
+            fillBinned(HIST(ReassignedZvtxCorr), kBufReassignedZvtxCorr, otrack.template collision_as<C>().posZ(), z, c);
+            fillBinned(HIST(ReassignedDCAXYPt), kBufReassignedDCAXYPt, otrack.pt(), track.bestDCAXY(), c);
+            fillBinned(HIST(ReassignedDCAZPt), kBufReassignedDCAZPt, otrack.pt(), track.bestDCAZ(), c);
           } else {
             inclusiveRegistry.fill(HIST(ReassignedEtaZvtx), otrack.eta(), z);
             inclusiveRegistry.fill(HIST(ReassignedPhiEta), otrack.phi(), otrack.eta());
@@ -604,10 +681,10 @@ struct MultiplicityCounter {
       } else if (!otrack.has_collision()) {
         if constexpr (fillHistos) {
           if constexpr (hasRecoCent<C>()) {
-            binnedRegistry.fill(HIST(ExtraEtaZvtx), otrack.eta(), z, c);
-            binnedRegistry.fill(HIST(ExtraPhiEta), otrack.phi(), otrack.eta(), c);
-            binnedRegistry.fill(HIST(ExtraDCAXYPt), otrack.pt(), track.bestDCAXY(), c);
-            binnedRegistry.fill(HIST(ExtraDCAZPt), otrack.pt(), track.bestDCAZ(), c);
+            fillBinned(HIST(ExtraEtaZvtx), kBufExtraEtaZvtx, otrack.eta(), z, c);
+            fillBinned(HIST(ExtraPhiEta), kBufExtraPhiEta, otrack.phi(), otrack.eta(), c);
+            fillBinned(HIST(ExtraDCAXYPt), kBufExtraDCAXYPt, otrack.pt(), track.bestDCAXY(), c);
+            fillBinned(HIST(ExtraDCAZPt), kBufExtraDCAZPt, otrack.pt(), track.bestDCAZ(), c);
           } else {
             inclusiveRegistry.fill(HIST(ExtraEtaZvtx), otrack.eta(), z);
             inclusiveRegistry.fill(HIST(ExtraPhiEta), otrack.phi(), otrack.eta());
@@ -630,11 +707,11 @@ struct MultiplicityCounter {
       }
       if constexpr (fillHistos) {
         if constexpr (hasRecoCent<C>()) {
-          binnedRegistry.fill(HIST(EtaZvtx), track.eta(), z, c);
-          binnedRegistry.fill(HIST(PhiEta), track.phi(), track.eta(), c);
-          binnedRegistry.fill(HIST(PtEta), track.pt(), track.eta(), c);
-          binnedRegistry.fill(HIST(DCAXYPt), track.pt(), track.dcaXY(), c);
-          binnedRegistry.fill(HIST(DCAZPt), track.pt(), track.dcaZ(), c);
+          fillBinned(HIST(EtaZvtx), kBufEtaZvtx, track.eta(), z, c);
+          fillBinned(HIST(PhiEta), kBufPhiEta, track.phi(), track.eta(), c);
+          fillBinned(HIST(PtEta), kBufPtEta, track.pt(), track.eta(), c);
+          fillBinned(HIST(DCAXYPt), kBufDCAXYPt, track.pt(), track.dcaXY(), c);
+          fillBinned(HIST(DCAZPt), kBufDCAZPt, track.pt(), track.dcaZ(), c);
         } else {
           inclusiveRegistry.fill(HIST(EtaZvtx), track.eta(), z);
           inclusiveRegistry.fill(HIST(PhiEta), track.phi(), track.eta());
@@ -688,10 +765,10 @@ struct MultiplicityCounter {
           }
           for (auto& track : atracks) {
             if (Ntrks > 0) {
-              binnedRegistry.fill(HIST(EtaZvtx_gt0), track.track_as<FiTracks>().eta(), z, c);
+              fillBinned(HIST(EtaZvtx_gt0), kBufEtaZvtx_gt0, track.track_as<FiTracks>().eta(), z, c);
             }
             if (INELgt0PV) {
-              binnedRegistry.fill(HIST(EtaZvtx_PVgt0), track.track_as<FiTracks>().eta(), z, c);
+              fillBinned(HIST(EtaZvtx_PVgt0), kBufEtaZvtx_PVgt0, track.track_as<FiTracks>().eta(), z, c);
             }
           }
           for (auto& track : tracks) {
@@ -702,10 +779,10 @@ struct MultiplicityCounter {
               continue;
             }
             if (Ntrks > 0) {
-              binnedRegistry.fill(HIST(EtaZvtx_gt0), track.eta(), z, c);
+              fillBinned(HIST(EtaZvtx_gt0), kBufEtaZvtx_gt0, track.eta(), z, c);
             }
             if (INELgt0PV) {
-              binnedRegistry.fill(HIST(EtaZvtx_PVgt0), track.eta(), z, c);
+              fillBinned(HIST(EtaZvtx_PVgt0), kBufEtaZvtx_PVgt0, track.eta(), z, c);
             }
           }
         }
@@ -39,8 +39,9 @@ class DGSelector
   }
 
   // Function to check if collision passes DG filter
+  // fitSummary: optional FIT summary of the BC table of bcRange, with the FIT limits of diffCuts
   template <typename CC, typename BCs, typename TCs, typename FWs>
-  int IsSelected(DGCutparHolder diffCuts, CC& collision, BCs& bcRange, TCs& tracks, FWs& fwdtracks)
+  int IsSelected(DGCutparHolder diffCuts, CC& collision, BCs& bcRange, TCs& tracks, FWs& fwdtracks, udhelpers::FITSummary const* fitSummary = nullptr)
   {
     LOGF(debug, "Collision %f", collision.collisionTime());
     LOGF(debug, "Number of close BCs: %i", bcRange.size());
@@ -62,7 +63,7 @@ class DGSelector
       }
       */
 
-      if (udhelpers::FITveto(bc, diffCuts)) {
+      if (fitSummary ? fitSummary->FITveto(bc.globalIndex(), diffCuts) : udhelpers::FITveto(bc, diffCuts)) {
         return 1;
       }
     }
@@ -198,7 +199,7 @@ class DGSelector
 
   // Function to check if BC passes DG filter (without associated collision)
   template <typename BCs, typename TCs, typename FWs>
-  int IsSelected(DGCutparHolder diffCuts, BCs& bcRange, TCs& tracks, FWs& fwdtracks)
+  int IsSelected(DGCutparHolder diffCuts, BCs& bcRange, TCs& tracks, FWs& fwdtracks, udhelpers::FITSummary const* fitSummary = nullptr)
   {
     // return if FIT veto is found in any of the compatible BCs
     // Double Gap (DG) condition
@@ -208,7 +209,7 @@ class DGSelector
     //  2 TCE
     //  3 TOR
     for (auto const& bc : bcRange) {
-      if (udhelpers::FITveto(bc, diffCuts)) {
+      if (fitSummary ? fitSummary->FITveto(bc.globalIndex(), diffCuts) : udhelpers::FITveto(bc, diffCuts)) {
         return 1;
       }
     }
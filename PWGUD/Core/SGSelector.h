@@ -38,8 +38,9 @@ class SGSelector
     return 1;
   }
 
+  // fitSummary: optional FIT summary of the BC table of bcRange, with the FIT limits of diffCuts
   template <typename CC, typename BCs, typename BC>
-  SelectionResult<BC> IsSelected(SGCutParHolder diffCuts, CC& collision, BCs& bcRange, BC& oldbc)
+  SelectionResult<BC> IsSelected(SGCutParHolder diffCuts, CC& collision, BCs& bcRange, BC& oldbc, udhelpers::FITSummary const* fitSummary = nullptr)
   {
     //        LOGF(info, "Collision %f", collision.collisionTime());
     //        LOGF(info, "Number of close BCs: %i", bcRange.size());
@@ -58,14 +59,16 @@ class SGSelector
     float ampa = 0;
     bool gA = true, gC = true;
     for (auto const& bc : bcRange) {
-      if (!udhelpers::cleanFITA(bc, diffCuts.maxFITtime(), diffCuts.FITAmpLimits())) {
+      bool cleanA = fitSummary ? fitSummary->cleanFITA(bc.globalIndex()) : udhelpers::cleanFITA(bc, diffCuts.maxFITtime(), diffCuts.FITAmpLimits());
+      bool cleanC = fitSummary ? fitSummary->cleanFITC(bc.globalIndex()) : udhelpers::cleanFITC(bc, diffCuts.maxFITtime(), diffCuts.FITAmpLimits());
+      if (!cleanA) {
         if (gA)
           newbc = bc;
         if (!gA && std::abs(static_cast<int64_t>(bc.globalBC() - oldbc.globalBC())) < std::abs(static_cast<int64_t>(newbc.globalBC() - oldbc.globalBC())))
           newbc = bc;
         gA = false;
       }
-      if (!udhelpers::cleanFITC(bc, diffCuts.maxFITtime(), diffCuts.FITAmpLimits())) {
+      if (!cleanC) {
         if (gC)
           newbc = bc;
         if (!gC && std::abs(static_cast<int64_t>(bc.globalBC() - oldbc.globalBC())) < std::abs(static_cast<int64_t>(newbc.globalBC() - oldbc.globalBC())))
@@ -79,9 +82,9 @@ class SGSelector
     }
     if (gA && gC) { // loop once again for so-called DG events to get the most active FT0 BC
       for (auto const& bc : bcRange) {
-        if (bc.has_foundFT0()) {
-          tempampa = udhelpers::FT0AmplitudeA(bc.foundFT0());
-          tempampc = udhelpers::FT0AmplitudeC(bc.foundFT0());
+        if (fitSummary ? fitSummary->hasFT0(bc.globalIndex()) : bc.has_foundFT0()) {
+          tempampa = fitSummary ? fitSummary->ampFT0A(bc.globalIndex()) : udhelpers::FT0AmplitudeA(bc.foundFT0());
+          tempampc = fitSummary ? fitSummary->ampFT0C(bc.globalIndex()) : udhelpers::FT0AmplitudeC(bc.foundFT0());
           if (tempampa > ampa) {
             ampa = tempampa;
             newdgabc = bc;
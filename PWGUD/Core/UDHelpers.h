@@ -16,6 +16,8 @@
 #ifndef PWGUD_CORE_UDHELPERS_H_
 #define PWGUD_CORE_UDHELPERS_H_
 
+#include <algorithm>
+#include <utility>
 #include <vector>
 #include <bitset>
 #include "TLorentzVector.h"
@@ -540,6 +542,217 @@ bool FITveto(T const& bc, DGCutparHolder const& diffCuts)
   return false;
 }
 
+// -----------------------------------------------------------------------------
+// Index of the globalBCs of a BCs table (typically of a time frame), answering the
+// compatible-BC queries meanBC +- deltaBC by binary search instead of moving a BC
+// iterator around meanBC. It pays off when many windows are searched in the same table.
+// Optionally the FIT veto of each BC is cached, with a running count of vetoed BCs,
+// such that the veto in a window is known without looping over its BCs.
+class BCWindowIndex
+{
+ public:
+  // (re)build the index if bcs is not the table it was built for
+  template <typename T>
+  void update(T const& bcs)
+  {
+    auto table = bcs.asArrowTable().get();
+    if (table == mTable && static_cast<size_t>(bcs.size()) == mGlobalBCs.size() &&
+        (mGlobalBCs.empty() || mGlobalBCs.front() == bcs.iteratorAt(0).globalBC())) {
+      return;
+    }
+    mTable = table;
+    mGlobalBCs.clear();
+    mGlobalBCs.reserve(bcs.size());
+    mIsSorted = true;
+    for (auto const& bc : bcs) {
+      if (!mGlobalBCs.empty() && bc.globalBC() < mGlobalBCs.back()) {
+        mIsSorted = false;
+      }
+      mGlobalBCs.push_back(bc.globalBC());
+    }
+    if (!mIsSorted) {
+      LOGF(warning, "<BCWindowIndex> BCs are not sorted in globalBC, the BC iterator search is used");
+    }
+    mNFITvetoes.clear();
+  }
+
+  // rows [first, last) of the BCs with meanBC - deltaBC <= globalBC <= meanBC + deltaBC
+  std::pair<int64_t, int64_t> range(uint64_t meanBC, int deltaBC) const
+  {
+    uint64_t minBC = (uint64_t)deltaBC < meanBC ? meanBC - (uint64_t)deltaBC : 0;
+    uint64_t maxBC = meanBC + (uint64_t)deltaBC;
+    auto first = std::lower_bound(mGlobalBCs.begin(), mGlobalBCs.end(), minBC);
+    auto last = std::upper_bound(first, mGlobalBCs.end(), maxBC);
+    return {first - mGlobalBCs.begin(), last - mGlobalBCs.begin()};
+  }
+
+  // same as udhelpers::compatibleBCs(meanBC, deltaBC, bcs)
+  template <typename T>
+  T compatibleBCs(uint64_t meanBC, int deltaBC, T const& bcs) const
+  {
+    if (!mIsSorted) {
+      return udhelpers::compatibleBCs(meanBC, deltaBC, bcs);
+    }
+    auto [first, last] = range(meanBC, deltaBC);
+    T slice{{bcs.asArrowTable()->Slice(first, last - first)}, (uint64_t)first};
+    bcs.copyIndexBindings(slice);
+    return slice;
+  }
+
+  // same as udhelpers::compatibleBCs(collision, ndt, bcs, nMinBCs)
+  template <typename C, typename T>
+  T compatibleBCs(C const& collision, int ndt, T const& bcs, int nMinBCs = 7) const
+  {
+    if (!collision.has_foundBC() || ndt < 0) {
+      return T{{bcs.asArrowTable()->Slice(0, 0)}, (uint64_t)0};
+    }
+    uint64_t mostProbableBC = collision.template foundBC_as<T>().globalBC();
+    uint64_t meanBC = mostProbableBC + std::lround(collision.collisionTime() / o2::constants::lhc::LHCBunchSpacingNS);
+    int deltaBC = std::ceil(collision.collisionTimeRes() / o2::constants::lhc::LHCBunchSpacingNS * ndt);
+    if (deltaBC < nMinBCs) {
+      deltaBC = nMinBCs;
+    }
+    return compatibleBCs(meanBC, deltaBC, bcs);
+  }
+
+  // cache FITveto(bc, diffCuts) of all the BCs of the table given to update
+  template <typename T>
+  void fillFITveto(T const& bcs, DGCutparHolder const& diffCuts)
+  {
+    mNFITvetoes.assign(bcs.size() + 1, 0);
+    int64_t row = 0;
+    for (auto const& bc : bcs) {
+      mNFITvetoes[row + 1] = mNFITvetoes[row] + FITveto(bc, diffCuts);
+      row++;
+    }
+  }
+
+  // number of BCs with a FIT veto among the rows [first, last), fillFITveto has to be called before
+  int nFITvetoes(int64_t first, int64_t last) const { return mNFITvetoes[last] - mNFITvetoes[first]; }
+  bool hasFITveto(uint64_t meanBC, int deltaBC) const
+  {
+    auto [first, last] = range(meanBC, deltaBC);
+    return nFITvetoes(first, last) > 0;
+  }
+
+  size_t size() const { return mGlobalBCs.size(); }
+
+ private:
+  arrow::Table const* mTable = nullptr; // table the index was built for
+  bool mIsSorted = true;
+  std::vector<uint64_t> mGlobalBCs; // globalBC of each row
+  std::vector<int> mNFITvetoes;     // number of BCs with FIT veto in the rows before
+};
+
+// -----------------------------------------------------------------------------
+// Summary of the FIT signals of each BC of a BCs table (typically of a time frame), computed once
+// for given FIT time and amplitude limits: bit flags of the detectors with activity, as tested by
+// cleanFV0/FT0A/FT0C/FDDA/FDDC, of the FT0 trigger bits, and the total FT0 amplitudes.
+// The selectors use it instead of re-reading the FIT tables for each BC of each compatible-BC range.
+// The rows are the globalIndex of the BCs, such that it can be used with slices of the table.
+class FITSummary
+{
+ public:
+  enum Flags : uint16_t {
+    kActiveFV0 = 1 << 0,
+    kActiveFT0A = 1 << 1,
+    kActiveFT0C = 1 << 2,
+    kActiveFDDA = 1 << 3,
+    kActiveFDDC = 1 << 4,
+    kTVX = 1 << 5,
+    kTSC = 1 << 6,
+    kTCE = 1 << 7,
+    kHasFT0 = 1 << 8
+  };
+  static constexpr uint16_t kActiveA = kActiveFV0 | kActiveFT0A | kActiveFDDA;
+  static constexpr uint16_t kActiveC = kActiveFT0C | kActiveFDDC;
+
+  // (re)compute the summary if bcs or the limits are not the ones it was computed for
+  template <typename T>
+  void update(T const& bcs, float maxFITtime, std::vector<float> const& lims)
+  {
+    auto table = bcs.asArrowTable().get();
+    if (table == mTable && static_cast<size_t>(bcs.size()) == mFlags.size() && maxFITtime == mMaxFITtime && lims == mLims &&
+        (mFlags.empty() || mFirstBC == bcs.iteratorAt(0).globalBC())) {
+      return;
+    }
+    mTable = table;
+    mMaxFITtime = maxFITtime;
+    mLims = lims;
+    mFirstBC = bcs.size() > 0 ? bcs.iteratorAt(0).globalBC() : 0;
+    mFlags.assign(bcs.size(), 0);
+    mAmpFT0A.assign(bcs.size(), 0.f);
+    mAmpFT0C.assign(bcs.size(), 0.f);
+    int64_t row = 0;
+    for (auto const& bc : bcs) {
+      uint16_t flags = 0;
+      if (!cleanFV0(bc, maxFITtime, lims[0]))
+        flags |= kActiveFV0;
+      if (!cleanFT0A(bc, maxFITtime, lims[1]))
+        flags |= kActiveFT0A;
+      if (!cleanFT0C(bc, maxFITtime, lims[2]))
+        flags |= kActiveFT0C;
+      if (!cleanFDDA(bc, maxFITtime, lims[3]))
+        flags |= kActiveFDDA;
+      if (!cleanFDDC(bc, maxFITtime, lims[4]))
+        flags |= kActiveFDDC;
+      if (bc.has_foundFT0()) {
+        auto ft0 = bc.foundFT0();
+        flags |= kHasFT0;
+        if (TESTBIT(ft0.triggerMask(), o2::fit::Triggers::bitVertex))
+          flags |= kTVX;
+        if (TESTBIT(ft0.triggerMask(), o2::fit::Triggers::bitSCen))
+          flags |= kTSC;
+        if (TESTBIT(ft0.triggerMask(), o2::fit::Triggers::bitCen))
+          flags |= kTCE;
+        mAmpFT0A[row] = FT0AmplitudeA(ft0);
+        mAmpFT0C[row] = FT0AmplitudeC(ft0);
+      }
+      mFlags[row] = flags;
+      row++;
+    }
+  }
+
+  uint16_t flags(int64_t globalIndex) const { return mFlags[globalIndex]; }
+  bool hasFT0(int64_t globalIndex) const { return mFlags[globalIndex] & kHasFT0; }
+  float ampFT0A(int64_t globalIndex) const { return mAmpFT0A[globalIndex]; }
+  float ampFT0C(int64_t globalIndex) const { return mAmpFT0C[globalIndex]; }
+
+  // same as cleanFITA, cleanFITC and cleanFIT with the limits of update
+  bool cleanFITA(int64_t globalIndex) const { return !(mFlags[globalIndex] & kActiveA); }
+  bool cleanFITC(int64_t globalIndex) const { return !(mFlags[globalIndex] & kActiveC); }
+  bool cleanFIT(int64_t globalIndex) const { return !(mFlags[globalIndex] & (kActiveA | kActiveC)); }
+
+  // same as FITveto(bc, diffCuts), diffCuts has to have the limits of update
+  bool FITveto(int64_t globalIndex, DGCutparHolder const& diffCuts) const
+  {
+    if (diffCuts.withTVX()) {
+      return mFlags[globalIndex] & kTVX;
+    }
+    if (diffCuts.withTSC()) {
+      return mFlags[globalIndex] & kTSC;
+    }
+    if (diffCuts.withTCE()) {
+      return mFlags[globalIndex] & kTCE;
+    }
+    if (diffCuts.withTOR()) {
+      return !cleanFIT(globalIndex);
+    }
+    return false;
+  }
+
+  size_t size() const { return mFlags.size(); }
+
+ private:
+  arrow::Table const* mTable = nullptr; // table the summary was computed for
+  uint64_t mFirstBC = 0;
+  float mMaxFITtime = 0.;
+  std::vector<float> mLims;
+  std::vector<uint16_t> mFlags; // Flags of each BC
+  std::vector<float> mAmpFT0A;  // total FT0A amplitude of each BC
+  std::vector<float> mAmpFT0C;  // total FT0C amplitude of each BC
+};
+
 // -----------------------------------------------------------------------------
 
 template <typename T>
@@ -15,6 +15,8 @@
 /// \since  30.09.2022
 
 #include <algorithm>
+#include <utility>
+#include <vector>
 #include "Framework/runDataProcessing.h"
 #include "Framework/AnalysisTask.h"
 #include "PWGUD/DataModel/UDTables.h"
@@ -46,6 +48,66 @@ struct tracksWGTInBCs {
   Preslice<aod::AmbiguousTracks> perTrack = aod::ambiguous::trackId;
   Preslice<aod::AmbiguousFwdTracks> perFwdTrack = aod::ambiguous::fwdtrackId;
 
+  // tracks per BC in compressed sparse row format: the tracks of BC bcnums[i] are
+  // trackIds[offsets[i]], ..., trackIds[offsets[i + 1] - 1], in the order they were found
+  struct TracksInBCs {
+    std::vector<uint64_t> bcnums;
+    std::vector<int32_t> offsets;
+    std::vector<int32_t> trackIds;
+  };
+  std::vector<std::pair<uint64_t, int32_t>> trackBCs; // (closest BC, track index) of the tracks with good timing
+  std::vector<int32_t> bcCounts;
+  TracksInBCs tracksInBCs;
+
+  // maximum BC range of the counting sort, sparser BCs are sorted
+  static constexpr uint64_t maxCountingSortRange = 1 << 20;
+
+  // group trackBCs per BC with a counting sort: count the tracks per BC, prefix-sum the counts, scatter the tracks
+  void groupTracksInBCs()
+  {
+    tracksInBCs.bcnums.clear();
+    tracksInBCs.offsets.clear();
+    tracksInBCs.trackIds.clear();
+    if (trackBCs.empty()) {
+      tracksInBCs.offsets.push_back(0);
+      return;
+    }
+    auto [minTrackBC, maxTrackBC] = std::minmax_element(trackBCs.begin(), trackBCs.end(), [](auto const& a, auto const& b) { return a.first < b.first; });
+    const uint64_t minBC = minTrackBC->first;
+    const uint64_t range = maxTrackBC->first - minBC + 1;
+
+    if (range > maxCountingSortRange) {
+      std::stable_sort(trackBCs.begin(), trackBCs.end(), [](auto const& a, auto const& b) { return a.first < b.first; });
+      for (auto const& [bcnum, trackId] : trackBCs) {
+        if (tracksInBCs.bcnums.empty() || tracksInBCs.bcnums.back() != bcnum) {
+          tracksInBCs.bcnums.push_back(bcnum);
+          tracksInBCs.offsets.push_back(tracksInBCs.trackIds.size());
+        }
+        tracksInBCs.trackIds.push_back(trackId);
+      }
+      tracksInBCs.offsets.push_back(tracksInBCs.trackIds.size());
+      return;
+    }
+
+    bcCounts.assign(range + 1, 0);
+    for (auto const& trackBC : trackBCs) {
+      bcCounts[trackBC.first - minBC + 1]++;
+    }
+    for (uint64_t i = 0; i < range; i++) {
+      // bcCounts[i] is the first position of the tracks of BC minBC + i
+      if (bcCounts[i + 1] > 0) {
+        tracksInBCs.bcnums.push_back(minBC + i);
+        tracksInBCs.offsets.push_back(bcCounts[i]);
+      }
+      bcCounts[i + 1] += bcCounts[i];
+    }
+    tracksInBCs.offsets.push_back(trackBCs.size());
+    tracksInBCs.trackIds.resize(trackBCs.size());
+    for (auto const& trackBC : trackBCs) {
+      tracksInBCs.trackIds[bcCounts[trackBC.first - minBC]++] = trackBC.second;
+    }
+  }
+
   void init(InitContext& context)
   {
     if (context.mOptions.get<bool>("processBarrel")) {
@@ -67,8 +129,8 @@ struct tracksWGTInBCs {
     }
     int rnum = bcs.iteratorAt(0).runNumber();
 
-    // container to sort tracks with good timing according to their matching/closest BC
-    std::map<uint64_t, std::vector<int32_t>> tracksInBCList{};
+    // tracks with good timing and their matching/closest BC
+    trackBCs.clear();
     uint64_t closestBC = 0;
 
     // loop over all tracks and fill tracksInBCList
@@ -114,32 +176,35 @@ struct tracksWGTInBCs {
           closestBC = collision.foundBC_as<BCs>().globalBC();
         }
 
-        // update tracksInBCList
-        LOGF(debug, "Updating tracksInBCList with %d", closestBC);
-        tracksInBCList[closestBC].emplace_back((int32_t)track.globalIndex());
+        // update trackBCs
+        LOGF(debug, "Updating trackBCs with %d", closestBC);
+        trackBCs.emplace_back(closestBC, (int32_t)track.globalIndex());
       }
     }
+    groupTracksInBCs();
 
     // fill tracksWGTInBCs
     int indBCToStart = 0;
     int indBCToSave;
-    for (auto const& tracksInBC : tracksInBCList) {
-      LOGF(debug, "tracksInBC.first %d", tracksInBC.first);
+    for (size_t iBC = 0; iBC < tracksInBCs.bcnums.size(); iBC++) {
+      auto bcnum = tracksInBCs.bcnums[iBC];
+      LOGF(debug, "bcnum %d", bcnum);
       indBCToSave = -1;
       // find corresponding BC
       for (auto ind = indBCToStart; ind < bcs.size(); ind++) {
         auto bc = bcs.rawIteratorAt(ind);
-        if (bc.globalBC() == tracksInBC.first) {
+        if (bc.globalBC() == bcnum) {
           indBCToSave = ind;
           indBCToStart = ind;
           break;
         }
-        if (bc.globalBC() > tracksInBC.first) {
+        if (bc.globalBC() > bcnum) {
           break;
         }
       }
-      LOGF(debug, " BC %i/%u with %i tracks with good timing", indBCToSave, tracksInBC.first, tracksInBC.second.size());
-      tracksWGTInBCs(indBCToSave, rnum, tracksInBC.first, tracksInBC.second);
+      std::vector<int32_t> trackIds(tracksInBCs.trackIds.begin() + tracksInBCs.offsets[iBC], tracksInBCs.trackIds.begin() + tracksInBCs.offsets[iBC + 1]);
+      LOGF(debug, " BC %i/%u with %i tracks with good timing", indBCToSave, bcnum, trackIds.size());
+      tracksWGTInBCs(indBCToSave, rnum, bcnum, trackIds);
     }
     LOGF(debug, "barrel done");
   }
@@ -156,8 +221,8 @@ struct tracksWGTInBCs {
     }
     int rnum = bcs.iteratorAt(0).runNumber();
 
-    // container to sort forward tracks according to their matching/closest BC
-    std::map<uint64_t, std::vector<int32_t>> fwdTracksInBCList{};
+    // forward tracks with good timing and their matching/closest BC
+    trackBCs.clear();
     uint64_t closestBC = 0;
 
     // loop over all forward tracks and fill fwdTracksInBCList
@@ -198,31 +263,34 @@ struct tracksWGTInBCs {
           closestBC = collision.foundBC_as<BCs>().globalBC();
         }
 
-        // update tracksInBCList
-        LOGF(debug, "Updating fwdTracksInBCList with %d", closestBC);
-        fwdTracksInBCList[closestBC].emplace_back((int32_t)fwdTrack.globalIndex());
+        // update trackBCs
+        LOGF(debug, "Updating trackBCs with %d", closestBC);
+        trackBCs.emplace_back(closestBC, (int32_t)fwdTrack.globalIndex());
       }
     }
+    groupTracksInBCs();
 
     // fill fwdTracksWGTInBCs
     int indBCToStart = 0;
     int indBCToSave;
-    for (auto const& fwdTracksInBC : fwdTracksInBCList) {
+    for (size_t iBC = 0; iBC < tracksInBCs.bcnums.size(); iBC++) {
+      auto bcnum = tracksInBCs.bcnums[iBC];
       indBCToSave = -1;
       // find corresponding BC
       for (auto ind = indBCToStart; ind < bcs.size(); ind++) {
         auto bc = bcs.rawIteratorAt(ind);
-        if (bc.globalBC() == fwdTracksInBC.first) {
+        if (bc.globalBC() == bcnum) {
           indBCToSave = ind;
           indBCToStart = ind;
           break;
         }
-        if (bc.globalBC() > fwdTracksInBC.first) {
+        if (bc.globalBC() > bcnum) {
           break;
         }
       }
-      fwdTracksWGTInBCs(indBCToSave, rnum, fwdTracksInBC.first, fwdTracksInBC.second);
-      LOGF(debug, " BC %i/%u with %i forward tracks with good timing", indBCToSave, fwdTracksInBC.first, fwdTracksInBC.second.size());
+      std::vector<int32_t> fwdTrackIds(tracksInBCs.trackIds.begin() + tracksInBCs.offsets[iBC], tracksInBCs.trackIds.begin() + tracksInBCs.offsets[iBC + 1]);
+      fwdTracksWGTInBCs(indBCToSave, rnum, bcnum, fwdTrackIds);
+      LOGF(debug, " BC %i/%u with %i forward tracks with good timing", indBCToSave, bcnum, fwdTrackIds.size());
     }
     LOGF(debug, "forward done");
   }
@@ -253,10 +321,14 @@ struct DGBCCandProducer {
   // get a DGCutparHolder
   DGCutparHolder diffCuts = DGCutparHolder();
   Configurable<DGCutparHolder> DGCuts{"DGCuts", {}, "DG event cuts"};
+  Configurable<bool> useBCWindowIndex{"useBCWindowIndex", false, "Search the compatible BCs by binary search in an index of the BCs table"};
 
   // DG selector
   DGSelector dgSelector;
 
+  // index of the BCs table for the compatible-BC searches
+  udhelpers::BCWindowIndex bcIndex;
+
   HistogramRegistry registry{
     "registry",
     {}};
@@ -377,6 +449,10 @@ struct DGBCCandProducer {
                      TCs const& tracks, aod::FwdTracks const& fwdtracks, FTIBCs const& ftibcs,
                      aod::Zdcs const& /*zdcs*/, aod::FT0s const& ft0s, aod::FV0As const& fv0as, aod::FDDs const& fdds)
   {
+    if (useBCWindowIndex) {
+      bcIndex.update(bcs);
+    }
+
     // fill FITInfo
     auto bcnum = tibc.bcnum();
     upchelpers::FITInfo fitInfo{};
@@ -407,7 +483,7 @@ struct DGBCCandProducer {
 
         auto colTracks = tracks.sliceByCached(aod::track::collisionId, col.globalIndex(), cache);
         auto colFwdTracks = fwdtracks.sliceByCached(aod::fwdtrack::collisionId, col.globalIndex(), cache);
-        auto bcRange = udhelpers::compatibleBCs(col, diffCuts.NDtcoll(), bcs, diffCuts.minNBCs());
+        auto bcRange = useBCWindowIndex ? bcIndex.compatibleBCs(col, diffCuts.NDtcoll(), bcs, diffCuts.minNBCs()) : udhelpers::compatibleBCs(col, diffCuts.NDtcoll(), bcs, diffCuts.minNBCs());
         isDG = dgSelector.IsSelected(diffCuts, col, bcRange, colTracks, colFwdTracks);
 
         // update UDTables, case 1.
@@ -422,7 +498,7 @@ struct DGBCCandProducer {
       } else {
         LOGF(debug, "  2. BC has NO collision");
         auto tracksArray = tibc.track_as<TCs>();
-        auto bcRange = udhelpers::compatibleBCs(bc, bc.globalBC(), diffCuts.minNBCs(), bcs);
+        auto bcRange = useBCWindowIndex ? bcIndex.compatibleBCs(bc.globalBC(), diffCuts.minNBCs(), bcs) : udhelpers::compatibleBCs(bc, bc.globalBC(), diffCuts.minNBCs(), bcs);
 
         // does BC have fwdTracks?
         if (ftibcs.size() > 0) {
@@ -468,7 +544,7 @@ struct DGBCCandProducer {
 
       // the BC is not contained in the BCs table
       auto tracksArray = tibc.track_as<TCs>();
-      auto bcRange = udhelpers::compatibleBCs(bcnum, diffCuts.minNBCs(), bcs);
+      auto bcRange = useBCWindowIndex ? bcIndex.compatibleBCs(bcnum, diffCuts.minNBCs(), bcs) : udhelpers::compatibleBCs(bcnum, diffCuts.minNBCs(), bcs);
 
       // does BC have fwdTracks?
       if (ftibcs.size() > 0) {
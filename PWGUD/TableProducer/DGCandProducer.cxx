@@ -28,9 +28,11 @@ struct DGCandProducer {
   Configurable<DGCutparHolder> DGCuts{"DGCuts", {}, "DG event cuts"};
   Configurable<bool> saveAllTracks{"saveAllTracks", true, "save only PV contributors or all tracks associated to a collision"};
   Configurable<bool> fillFIThistos{"fillFIThistos", false, "fill the histograms with the FIT amplitudes"};
+  Configurable<bool> useFITSummary{"useFITSummary", false, "evaluate the FIT activity once per BC of the time frame for the FIT veto"};
 
   // DG selector
   DGSelector dgSelector;
+  udhelpers::FITSummary fitSummary;
 
   // data tables
   Produces<aod::UDCollisions> outputCollisions;
@@ -252,7 +254,10 @@ struct DGCandProducer {
     LOGF(debug, "<DGCandProducer>  Size of bcRange %d", bcRange.size());
 
     // apply DG selection
-    auto isDGEvent = dgSelector.IsSelected(diffCuts, collision, bcRange, tracks, fwdtracks);
+    if (useFITSummary) {
+      fitSummary.update(bcs, diffCuts.maxFITtime(), diffCuts.FITAmpLimits());
+    }
+    auto isDGEvent = dgSelector.IsSelected(diffCuts, collision, bcRange, tracks, fwdtracks, useFITSummary ? &fitSummary : nullptr);
 
     // save DG candidates
     registry.get<TH1>(HIST("reco/Stat"))->Fill(isDGEvent + 2, 1.);
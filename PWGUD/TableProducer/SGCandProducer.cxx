@@ -38,8 +38,10 @@ struct SGCandProducer {
   Configurable<bool> noSameBunchPileUp{"noSameBunchPileUp", true, "reject SameBunchPileUp"};
   Configurable<bool> IsGoodVertex{"IsGoodVertex", false, "Select FT0 PV vertex matching"};
   Configurable<bool> ITSTPCVertex{"ITSTPCVertex", true, "reject ITS-only vertex"}; // if one wants to look at Single Gap pp events
+  Configurable<bool> useFITSummary{"useFITSummary", false, "evaluate the FIT activity once per BC of the time frame for the gap selection"};
   //  SG selector
   SGSelector sgSelector;
+  udhelpers::FITSummary fitSummary;
 
   // data tables
   Produces<aod::SGCollisions> outputSGCollisions;
@@ -189,7 +191,10 @@ struct SGCandProducer {
 
     // obtain slice of compatible BCs
     auto bcRange = udhelpers::compatibleBCs(collision, sameCuts.NDtcoll(), bcs, sameCuts.minNBCs());
-    auto isSGEvent = sgSelector.IsSelected(sameCuts, collision, bcRange, bc);
+    if (useFITSummary) {
+      fitSummary.update(bcs, sameCuts.maxFITtime(), sameCuts.FITAmpLimits());
+    }
+    auto isSGEvent = sgSelector.IsSelected(sameCuts, collision, bcRange, bc, useFITSummary ? &fitSummary : nullptr);
     // auto isSGEvent = sgSelector.IsSelected(sameCuts, collision, bcRange, tracks);
     int issgevent = isSGEvent.value;
     if (isSGEvent.bc) {
@@ -12,10 +12,13 @@
 /// \author Diana Krupova, diana.krupova@cern.ch
 /// \since 04.06.2024
 
+#include <thread>
+
 #include "Framework/runDataProcessing.h"
 #include "Framework/AnalysisTask.h"
 #include "Framework/AnalysisDataModel.h"
 #include "Common/CCDB/EventSelectionParams.h"
+#include "Common/Core/BCNeighbourIndex.h"
 #include "Common/DataModel/EventSelection.h"
 #include "CommonConstants/LHCConstants.h"
 #include "DataFormatsFIT/Triggers.h"
@@ -85,6 +88,8 @@ struct UpcCandProducer {
   Configurable<int> fSearchITSTPC{"searchITSTPC", 0, "Search for ITS-TPC tracks near candidates"};
   Configurable<int> fSearchRangeITSTPC{"searchRangeITSTPC", 50, "BC range for ITS-TPC tracks search wrt TOF tracks"};
 
+  Configurable<int> fNThreads{"nThreads", 1, "Threads building the central/forward candidates in independent BC windows, 1: serial"};
+
   // QA histograms
   HistogramRegistry histRegistry{"HistRegistry", {}, OutputObjHandlingPolicy::AnalysisObject};
 
@@ -99,6 +104,25 @@ struct UpcCandProducer {
 
   typedef std::pair<uint64_t, std::vector<int64_t>> BCTracksPair;
 
+  // candidates built before being written, such that they can be built in parallel
+  struct BarrelCandidate {
+    uint64_t globalBC;
+    uint64_t closestBcITSTPC;
+    std::vector<int64_t> barrelTrackIDs;
+    upchelpers::FITInfo fitInfo;
+  };
+
+  struct FwdCandidate {
+    int64_t globalBC;
+    uint64_t closestBcMCH;
+    std::vector<int64_t> trkCandIDs;
+    upchelpers::FITInfo fitInfo;
+    std::vector<float> amplitudesT0A;
+    std::vector<float> amplitudesV0A;
+    std::vector<int8_t> relBCsT0A;
+    std::vector<int8_t> relBCsV0A;
+  };
+
   void init(InitContext&)
   {
     fwdSelectors.resize(upchelpers::kNFwdSels - 1, false);
@@ -247,12 +271,10 @@ struct UpcCandProducer {
 
   auto findClosestTrackBCiterNotEq(uint64_t globalBC, std::vector<BCTracksPair>& bcs)
   {
-    auto it = std::find_if(
-      bcs.begin(),
-      bcs.end(),
-      [globalBC](const auto& v) {
-        return v.first > globalBC;
-      });
+    auto it = std::upper_bound(bcs.begin(), bcs.end(), globalBC,
+                               [](uint64_t bc, const BCTracksPair& p) {
+                                 return bc < p.first;
+                               });
     auto bc1 = it->first;
     auto it1 = it;
     if (it != bcs.begin())
@@ -266,6 +288,62 @@ struct UpcCandProducer {
     return (dbc1 <= dbc2) ? it1 : it2;
   }
 
+  // splits the BCs of the sorted lists into at most nWindows windows of similar sizes, cut only at gaps larger than maxDistance:
+  // no matching within maxDistance crosses a window boundary and the candidates of the windows can be built independently
+  // returns the first BC of each window
+  std::vector<uint64_t> splitInBCWindows(const std::vector<const std::vector<BCTracksPair>*>& lists, uint64_t maxDistance, int nWindows)
+  {
+    std::vector<uint64_t> allBCs;
+    for (const auto* list : lists) {
+      for (const auto& pair : *list)
+        allBCs.push_back(pair.first);
+    }
+    std::sort(allBCs.begin(), allBCs.end());
+    std::vector<uint64_t> windowStarts;
+    if (allBCs.empty())
+      return windowStarts;
+    windowStarts.push_back(allBCs.front());
+    size_t windowSize = (allBCs.size() + nWindows - 1) / nWindows;
+    size_t nInWindow = 1;
+    for (size_t i = 1; i < allBCs.size(); ++i) {
+      if (nInWindow >= windowSize && allBCs[i] - allBCs[i - 1] > maxDistance && static_cast<int>(windowStarts.size()) < nWindows) {
+        windowStarts.push_back(allBCs[i]);
+        nInWindow = 0;
+      }
+      ++nInWindow;
+    }
+    return windowStarts;
+  }
+
+  // index ranges [first, second) of the windows in a sorted list
+  std::vector<std::pair<size_t, size_t>> getWindowRanges(const std::vector<uint64_t>& windowStarts, const std::vector<BCTracksPair>& list)
+  {
+    auto lowerBound = [&list](uint64_t globalBC) {
+      return static_cast<size_t>(std::lower_bound(list.begin(), list.end(), globalBC,
+                                                  [](const BCTracksPair& p, uint64_t bc) { return p.first < bc; }) -
+                                 list.begin());
+    };
+    std::vector<std::pair<size_t, size_t>> ranges(windowStarts.size());
+    for (size_t iw = 0; iw < windowStarts.size(); ++iw) {
+      ranges[iw].first = lowerBound(windowStarts[iw]);
+      ranges[iw].second = (iw + 1 < windowStarts.size()) ? lowerBound(windowStarts[iw + 1]) : list.size();
+    }
+    return ranges;
+  }
+
+  // runs build(iw) for each window in its own thread
+  // build must not write to the tables or histograms: the candidates are written afterwards, in BC order
+  template <typename F>
+  void buildInBCWindows(size_t nWindows, F&& build)
+  {
+    std::vector<std::thread> threads;
+    threads.reserve(nWindows);
+    for (size_t iw = 0; iw < nWindows; ++iw)
+      threads.emplace_back([&build, iw]() { build(iw); });
+    for (auto& thread : threads)
+      thread.join();
+  }
+
   template <typename TBCs>
   void skimMCInfo(o2::aod::McCollisions const& mcCollisions,
                   o2::aod::McParticles const& mcParticles,
@@ -469,11 +547,11 @@ struct UpcCandProducer {
                       o2::aod::FDDs const& /*fdds*/,
                       o2::aod::FV0As const& /*fv0as*/)
   {
-    auto it = std::find_if(v.begin(),
-                           v.end(),
-                           [midbc](const std::pair<uint64_t, int64_t>& p) { return p.first == midbc; });
+    // v is sorted in BC
+    auto it = std::lower_bound(v.begin(), v.end(), midbc,
+                               [](const std::pair<uint64_t, int64_t>& p, uint64_t bc) { return p.first < bc; });
 
-    if (it != v.end()) {
+    if (it != v.end() && it->first == midbc) {
       auto bcId = it->second;
       auto bcEntry = bcs.iteratorAt(bcId);
       if (bcEntry.has_foundFT0()) {
@@ -749,16 +827,16 @@ struct UpcCandProducer {
     std::sort(bcsMatchedTrIdsITSTPC.begin(), bcsMatchedTrIdsITSTPC.end(),
               [](const auto& left, const auto& right) { return left.first < right.first; });
 
-    std::map<uint64_t, int32_t> mapGlobalBcWithTOR{};
-    std::map<uint64_t, int32_t> mapGlobalBcWithTVX{};
-    std::map<uint64_t, int32_t> mapGlobalBcWithTSC{};
+    BCNeighbourIndex bcsWithTOR;
+    BCNeighbourIndex bcsWithTVX;
+    BCNeighbourIndex bcsWithTSC;
     for (const auto& ft0 : ft0s) {
       uint64_t globalBC = ft0.bc_as<o2::aod::BCs>().globalBC();
       int32_t globalIndex = ft0.globalIndex();
       if (!(std::abs(ft0.timeA()) > 2.f && std::abs(ft0.timeC()) > 2.f))
-        mapGlobalBcWithTOR[globalBC] = globalIndex;
+        bcsWithTOR.add(globalBC, globalIndex);
       if (TESTBIT(ft0.triggerMask(), o2::fit::Triggers::bitVertex)) { // TVX
-        mapGlobalBcWithTVX[globalBC] = globalIndex;
+        bcsWithTVX.add(globalBC, globalIndex);
       }
       if (TESTBIT(ft0.triggerMask(), o2::fit::Triggers::bitCen)) { // TVX & TCE
         histRegistry.get<TH1>(HIST("hCountersTrg"))->Fill("TCE", 1);
@@ -766,17 +844,22 @@ struct UpcCandProducer {
       if (TESTBIT(ft0.triggerMask(), o2::fit::Triggers::bitVertex) &&
           (TESTBIT(ft0.triggerMask(), o2::fit::Triggers::bitCen) ||
            TESTBIT(ft0.triggerMask(), o2::fit::Triggers::bitSCen))) { // TVX & (TSC | TCE)
-        mapGlobalBcWithTSC[globalBC] = globalIndex;
+        bcsWithTSC.add(globalBC, globalIndex);
       }
     }
 
-    std::map<uint64_t, int32_t> mapGlobalBcWithV0A{};
+    bcsWithTOR.finalize();
+    bcsWithTVX.finalize();
+    bcsWithTSC.finalize();
+
+    BCNeighbourIndex bcsWithV0A;
     for (const auto& fv0a : fv0as) {
       if (std::abs(fv0a.time()) > 15.f)
         continue;
       uint64_t globalBC = fv0a.bc_as<o2::aod::BCs>().globalBC();
-      mapGlobalBcWithV0A[globalBC] = fv0a.globalIndex();
+      bcsWithV0A.add(globalBC, fv0a.globalIndex());
     }
+    bcsWithV0A.finalize();
 
     std::map<uint64_t, int32_t> mapGlobalBcWithZdc{};
     for (const auto& zdc : zdcs) {
@@ -790,10 +873,10 @@ struct UpcCandProducer {
       mapGlobalBcWithZdc[globalBC] = zdc.globalIndex();
     }
 
-    auto nTORs = mapGlobalBcWithTOR.size();
-    auto nTSCs = mapGlobalBcWithTSC.size();
-    auto nTVXs = mapGlobalBcWithTVX.size();
-    auto nFV0As = mapGlobalBcWithV0A.size();
+    auto nTORs = bcsWithTOR.size();
+    auto nTSCs = bcsWithTSC.size();
+    auto nTVXs = bcsWithTVX.size();
+    auto nFV0As = bcsWithV0A.size();
     auto nZdcs = mapGlobalBcWithZdc.size();
     auto nBcsWithITSTPC = bcsMatchedTrIdsITSTPC.size();
 
@@ -818,11 +901,11 @@ struct UpcCandProducer {
       fitInfo.distClosestBcTVX = 999;
       fitInfo.distClosestBcV0A = 999;
       if (nTORs > 0) {
-        uint64_t closestBcTOR = findClosestBC(globalBC, mapGlobalBcWithTOR);
-        fitInfo.distClosestBcTOR = globalBC - static_cast<int64_t>(closestBcTOR);
+        auto closestTOR = bcsWithTOR.findClosestPosition(globalBC);
+        fitInfo.distClosestBcTOR = globalBC - bcsWithTOR.getGlobalBC(closestTOR);
         if (std::abs(fitInfo.distClosestBcTOR) <= fFilterFT0)
           return false;
-        auto ft0Id = mapGlobalBcWithTOR.at(closestBcTOR);
+        auto ft0Id = bcsWithTOR.getIndex(closestTOR);
         auto ft0 = ft0s.iteratorAt(ft0Id);
         fitInfo.timeFT0A = ft0.timeA();
         fitInfo.timeFT0C = ft0.timeC();
@@ -834,23 +917,21 @@ struct UpcCandProducer {
           fitInfo.ampFT0C += amp;
       }
       if (nTSCs > 0) {
-        uint64_t closestBcTSC = findClosestBC(globalBC, mapGlobalBcWithTSC);
-        fitInfo.distClosestBcTSC = globalBC - static_cast<int64_t>(closestBcTSC);
+        fitInfo.distClosestBcTSC = globalBC - bcsWithTSC.getGlobalBC(bcsWithTSC.findClosestPosition(globalBC));
         if (std::abs(fitInfo.distClosestBcTSC) <= fFilterTSC)
           return false;
       }
       if (nTVXs > 0) {
-        uint64_t closestBcTVX = findClosestBC(globalBC, mapGlobalBcWithTVX);
-        fitInfo.distClosestBcTVX = globalBC - static_cast<int64_t>(closestBcTVX);
+        fitInfo.distClosestBcTVX = globalBC - bcsWithTVX.getGlobalBC(bcsWithTVX.findClosestPosition(globalBC));
         if (std::abs(fitInfo.distClosestBcTVX) <= fFilterTVX)
           return false;
       }
       if (nFV0As > 0) {
-        uint64_t closestBcV0A = findClosestBC(globalBC, mapGlobalBcWithV0A);
-        fitInfo.distClosestBcV0A = globalBC - static_cast<int64_t>(closestBcV0A);
+        auto closestV0A = bcsWithV0A.findClosestPosition(globalBC);
+        fitInfo.distClosestBcV0A = globalBC - bcsWithV0A.getGlobalBC(closestV0A);
         if (std::abs(fitInfo.distClosestBcV0A) <= fFilterFV0)
           return false;
-        auto fv0aId = mapGlobalBcWithV0A.at(closestBcV0A);
+        auto fv0aId = bcsWithV0A.getIndex(closestV0A);
         auto fv0a = fv0as.iteratorAt(fv0aId);
         fitInfo.timeFV0A = fv0a.time();
         const auto& v0Amps = fv0a.amplitude();
@@ -860,99 +941,81 @@ struct UpcCandProducer {
       return true;
     };
 
+    // the candidates are built first and then written: building only modifies the track lists, in the BC window
+    // of the candidate, such that independent BC windows can be built in parallel
+    std::vector<int64_t> distsITSTPC{};
+
     // candidates with TOF
-    int32_t candID = 0;
-    for (auto& pair : bcsMatchedTrIdsTOF) {
+    auto buildCandidateTOF = [&](BCTracksPair& pair, BarrelCandidate& cand, std::vector<int64_t>& dists) {
       auto globalBC = pair.first;
       auto& barrelTrackIDs = pair.second;
       int32_t nTOFs = barrelTrackIDs.size();
       if (nTOFs > fNBarProngs) // too many tracks
-        continue;
+        return false;
       auto closestBcITSTPC = std::numeric_limits<uint64_t>::max();
       if (nTOFs < fNBarProngs && nBcsWithITSTPC > 0) { // adding ITS-TPC tracks
         auto itClosestBcITSTPC = findClosestTrackBCiter(globalBC, bcsMatchedTrIdsITSTPC);
         if (itClosestBcITSTPC == bcsMatchedTrIdsITSTPC.end())
-          continue;
+          return false;
         closestBcITSTPC = itClosestBcITSTPC->first;
         int64_t distClosestBcITSTPC = globalBC - static_cast<int64_t>(closestBcITSTPC);
-        histRegistry.fill(HIST("hDistToITSTPC"), std::abs(distClosestBcITSTPC));
+        dists.push_back(std::abs(distClosestBcITSTPC));
         if (std::abs(distClosestBcITSTPC) > fBcWindowITSTPC)
-          continue;
+          return false;
         auto& itstpcTracks = itClosestBcITSTPC->second;
         int32_t nITSTPCs = itstpcTracks.size();
         if ((nTOFs + nITSTPCs) != fNBarProngs)
-          continue;
+          return false;
         barrelTrackIDs.insert(barrelTrackIDs.end(), itstpcTracks.begin(), itstpcTracks.end());
         itClosestBcITSTPC->second.clear(); // BC is matched to BC with TOF, removing tracks, but leaving BC
       }
-      upchelpers::FITInfo fitInfo{};
-      if (!updateFitInfo(globalBC, fitInfo))
-        continue;
-      if (nZdcs > 0) {
-        auto itZDC = mapGlobalBcWithZdc.find(globalBC);
-        if (itZDC != mapGlobalBcWithZdc.end()) {
-          const auto& zdc = zdcs.iteratorAt(itZDC->second);
-          float timeZNA = zdc.timeZNA();
-          float timeZNC = zdc.timeZNC();
-          float eComZNA = zdc.energyCommonZNA();
-          float eComZNC = zdc.energyCommonZNC();
-          udZdcsReduced(candID, timeZNA, timeZNC, eComZNA, eComZNC);
-        }
-      }
-      uint16_t numContrib = fNBarProngs;
-      int8_t netCharge = 0;
-      float RgtrwTOF = 0.;
-      for (auto id : barrelTrackIDs) {
-        const auto& tr = barrelTracks.iteratorAt(id);
-        netCharge += tr.sign();
-        if (tr.hasTOF()) {
-          RgtrwTOF++;
-        }
-      }
-      RgtrwTOF = RgtrwTOF / static_cast<float>(numContrib);
-      // store used tracks
-      fillBarrelTracks(barrelTracks, barrelTrackIDs, candID, globalBC, closestBcITSTPC, mcBarrelTrackLabels, ambBarrelTrBCs);
-      eventCandidates(globalBC, runNumber, dummyX, dummyY, dummyZ, numContrib, netCharge, RgtrwTOF);
-      eventCandidatesSels(fitInfo.ampFT0A, fitInfo.ampFT0C, fitInfo.timeFT0A, fitInfo.timeFT0C, fitInfo.triggerMaskFT0,
-                          fitInfo.ampFDDA, fitInfo.ampFDDC, fitInfo.timeFDDA, fitInfo.timeFDDC, fitInfo.triggerMaskFDD,
-                          fitInfo.ampFV0A, fitInfo.timeFV0A, fitInfo.triggerMaskFV0A,
-                          fitInfo.BBFT0Apf, fitInfo.BBFT0Cpf, fitInfo.BGFT0Apf, fitInfo.BGFT0Cpf,
-                          fitInfo.BBFV0Apf, fitInfo.BGFV0Apf,
-                          fitInfo.BBFDDApf, fitInfo.BBFDDCpf, fitInfo.BGFDDApf, fitInfo.BGFDDCpf);
-      eventCandidatesSelsCent(fitInfo.distClosestBcTOR,
-                              fitInfo.distClosestBcTSC,
-                              fitInfo.distClosestBcTVX,
-                              fitInfo.distClosestBcV0A);
-      candID++;
-    }
+      cand.globalBC = globalBC;
+      cand.closestBcITSTPC = closestBcITSTPC;
+      cand.fitInfo = upchelpers::FITInfo{};
+      if (!updateFitInfo(globalBC, cand.fitInfo))
+        return false;
+      cand.barrelTrackIDs = barrelTrackIDs;
+      return true;
+    };
 
     // candidates without TOF
-    for (auto& pair : bcsMatchedTrIdsITSTPC) {
+    auto buildCandidateITSTPC = [&](BCTracksPair& pair, BarrelCandidate& cand, std::vector<int64_t>& dists) {
       auto globalBC = pair.first;
       auto& barrelTrackIDs = pair.second;
       int32_t nThisITSTPCs = barrelTrackIDs.size();
       if (nThisITSTPCs > fNBarProngs || nThisITSTPCs == 0) // too many tracks / already matched to TOF
-        continue;
+        return false;
       auto closestBcITSTPC = std::numeric_limits<uint64_t>::max();
       if (nThisITSTPCs < fNBarProngs) { // adding ITS-TPC tracks
         auto itClosestBcITSTPC = findClosestTrackBCiterNotEq(globalBC, bcsMatchedTrIdsITSTPC);
         if (itClosestBcITSTPC == bcsMatchedTrIdsITSTPC.end())
-          continue;
+          return false;
         closestBcITSTPC = itClosestBcITSTPC->first;
         int64_t distClosestBcITSTPC = globalBC - static_cast<int64_t>(closestBcITSTPC);
-        histRegistry.fill(HIST("hDistToITSTPC"), std::abs(distClosestBcITSTPC));
+        dists.push_back(std::abs(distClosestBcITSTPC));
         if (std::abs(distClosestBcITSTPC) > fBcWindowITSTPC)
-          continue;
+          return false;
         auto& itstpcTracks = itClosestBcITSTPC->second;
         int32_t nITSTPCs = itstpcTracks.size();
         if ((nThisITSTPCs + nITSTPCs) != fNBarProngs)
-          continue;
+          return false;
         barrelTrackIDs.insert(barrelTrackIDs.end(), itstpcTracks.begin(), itstpcTracks.end());
         itClosestBcITSTPC->second.clear();
       }
-      upchelpers::FITInfo fitInfo{};
-      if (!updateFitInfo(globalBC, fitInfo))
-        continue;
+      cand.globalBC = globalBC;
+      cand.closestBcITSTPC = closestBcITSTPC;
+      cand.fitInfo = upchelpers::FITInfo{};
+      if (!updateFitInfo(globalBC, cand.fitInfo))
+        return false;
+      cand.barrelTrackIDs = std::move(barrelTrackIDs);
+      barrelTrackIDs.clear();
+      return true;
+    };
+
+    int32_t candID = 0;
+    auto writeCandidate = [&](BarrelCandidate& cand) {
+      auto globalBC = cand.globalBC;
+      const auto& fitInfo = cand.fitInfo;
       if (nZdcs > 0) {
         auto itZDC = mapGlobalBcWithZdc.find(globalBC);
         if (itZDC != mapGlobalBcWithZdc.end()) {
@@ -967,7 +1030,7 @@ struct UpcCandProducer {
       uint16_t numContrib = fNBarProngs;
       int8_t netCharge = 0;
       float RgtrwTOF = 0.;
-      for (auto id : barrelTrackIDs) {
+      for (auto id : cand.barrelTrackIDs) {
         const auto& tr = barrelTracks.iteratorAt(id);
         netCharge += tr.sign();
         if (tr.hasTOF()) {
@@ -976,7 +1039,7 @@ struct UpcCandProducer {
       }
       RgtrwTOF = RgtrwTOF / static_cast<float>(numContrib);
       // store used tracks
-      fillBarrelTracks(barrelTracks, barrelTrackIDs, candID, globalBC, closestBcITSTPC, mcBarrelTrackLabels, ambBarrelTrBCs);
+      fillBarrelTracks(barrelTracks, cand.barrelTrackIDs, candID, globalBC, cand.closestBcITSTPC, mcBarrelTrackLabels, ambBarrelTrBCs);
       eventCandidates(globalBC, runNumber, dummyX, dummyY, dummyZ, numContrib, netCharge, RgtrwTOF);
       eventCandidatesSels(fitInfo.ampFT0A, fitInfo.ampFT0C, fitInfo.timeFT0A, fitInfo.timeFT0C, fitInfo.triggerMaskFT0,
                           fitInfo.ampFDDA, fitInfo.ampFDDC, fitInfo.timeFDDA, fitInfo.timeFDDC, fitInfo.triggerMaskFDD,
@@ -988,10 +1051,56 @@ struct UpcCandProducer {
                               fitInfo.distClosestBcTSC,
                               fitInfo.distClosestBcTVX,
                               fitInfo.distClosestBcV0A);
-      barrelTrackIDs.clear();
       candID++;
+    };
+
+    if (fNThreads <= 1) {
+      BarrelCandidate cand{};
+      for (auto& pair : bcsMatchedTrIdsTOF) {
+        if (buildCandidateTOF(pair, cand, distsITSTPC))
+          writeCandidate(cand);
+      }
+      for (auto& pair : bcsMatchedTrIdsITSTPC) {
+        if (buildCandidateITSTPC(pair, cand, distsITSTPC))
+          writeCandidate(cand);
+      }
+    } else {
+      // the windows are separated by more than the ITS-TPC matching window, the closest ITS-TPC BC of a candidate
+      // is then either in its window or too far: the candidates are the same as in the serial loops
+      auto windowStarts = splitInBCWindows({&bcsMatchedTrIdsTOF, &bcsMatchedTrIdsITSTPC}, std::max(static_cast<int>(fBcWindowITSTPC), 0), fNThreads);
+      auto rangesTOF = getWindowRanges(windowStarts, bcsMatchedTrIdsTOF);
+      auto rangesITSTPC = getWindowRanges(windowStarts, bcsMatchedTrIdsITSTPC);
+      size_t nWindows = windowStarts.size();
+      std::vector<std::vector<BarrelCandidate>> candsTOF(nWindows);
+      std::vector<std::vector<BarrelCandidate>> candsITSTPC(nWindows);
+      std::vector<std::vector<int64_t>> dists(nWindows);
+      buildInBCWindows(nWindows, [&](size_t iw) {
+        BarrelCandidate cand{};
+        for (size_t i = rangesTOF[iw].first; i < rangesTOF[iw].second; ++i) {
+          if (buildCandidateTOF(bcsMatchedTrIdsTOF[i], cand, dists[iw]))
+            candsTOF[iw].push_back(std::move(cand));
+        }
+        for (size_t i = rangesITSTPC[iw].first; i < rangesITSTPC[iw].second; ++i) {
+          if (buildCandidateITSTPC(bcsMatchedTrIdsITSTPC[i], cand, dists[iw]))
+            candsITSTPC[iw].push_back(std::move(cand));
+        }
+      });
+      // same order as the serial loops: candidates with TOF first
+      for (auto& cands : candsTOF) {
+        for (auto& cand : cands)
+          writeCandidate(cand);
+      }
+      for (auto& cands : candsITSTPC) {
+        for (auto& cand : cands)
+          writeCandidate(cand);
+      }
+      for (const auto& windowDists : dists)
+        distsITSTPC.insert(distsITSTPC.end(), windowDists.begin(), windowDists.end());
     }
 
+    for (auto dist : distsITSTPC)
+      histRegistry.fill(HIST("hDistToITSTPC"), dist);
+
     ambBarrelTrBCs.clear();
     bcsMatchedTrIdsITSTPC.clear();
     bcsMatchedTrIdsTOF.clear();
@@ -1056,9 +1165,9 @@ struct UpcCandProducer {
     std::vector<BCTracksPair> bcsMatchedTrIdsTOFTagged(nBCsWithMID);
     for (const auto& pair : bcsMatchedTrIdsTOF) {
       uint64_t bc = pair.first;
-      auto it = std::find_if(bcsMatchedTrIdsMID.begin(), bcsMatchedTrIdsMID.end(),
-                             [bc](const auto& item) { return item.first == bc; });
-      if (it != bcsMatchedTrIdsMID.end()) {
+      auto it = std::lower_bound(bcsMatchedTrIdsMID.begin(), bcsMatchedTrIdsMID.end(), bc,
+                                 [](const auto& item, uint64_t globalBC) { return item.first < globalBC; });
+      if (it != bcsMatchedTrIdsMID.end() && it->first == bc) {
         uint32_t ibc = it - bcsMatchedTrIdsMID.begin();
         bcsMatchedTrIdsTOFTagged[ibc].second = pair.second;
       }
@@ -1171,6 +1280,58 @@ struct UpcCandProducer {
     bcsMatchedTrIdsTOFTagged.clear();
   }
 
+  // FT0/FV0 information of a forward candidate, returns false if the candidate is rejected by the FT0/FV0 filters
+  bool fillFwdFITInfo(FwdCandidate& cand,
+                      std::map<uint64_t, int32_t>& mapGlobalBcWithT0A,
+                      std::map<uint64_t, int32_t>& mapGlobalBcWithV0A,
+                      o2::aod::FT0s const& ft0s,
+                      o2::aod::FV0As const& fv0as)
+  {
+    auto globalBC = cand.globalBC;
+    auto& fitInfo = cand.fitInfo;
+    fitInfo = upchelpers::FITInfo{};
+    fitInfo.timeFT0A = -999.f;
+    fitInfo.timeFT0C = -999.f;
+    fitInfo.timeFV0A = -999.f;
+    fitInfo.ampFT0A = 0.f;
+    fitInfo.ampFT0C = 0.f;
+    fitInfo.ampFV0A = 0.f;
+    cand.amplitudesT0A.clear();
+    cand.amplitudesV0A.clear();
+    cand.relBCsT0A.clear();
+    cand.relBCsV0A.clear();
+    if (!mapGlobalBcWithT0A.empty()) {
+      uint64_t closestBcT0A = findClosestBC(globalBC, mapGlobalBcWithT0A);
+      int64_t distClosestBcT0A = globalBC - static_cast<int64_t>(closestBcT0A);
+      if (std::abs(distClosestBcT0A) <= fFilterFT0)
+        return false;
+      fitInfo.distClosestBcT0A = distClosestBcT0A;
+      auto ft0Id = mapGlobalBcWithT0A.at(closestBcT0A);
+      auto ft0 = ft0s.iteratorAt(ft0Id);
+      fitInfo.timeFT0A = ft0.timeA();
+      fitInfo.timeFT0C = ft0.timeC();
+      const auto& t0AmpsA = ft0.amplitudeA();
+      const auto& t0AmpsC = ft0.amplitudeC();
+      fitInfo.ampFT0A = std::accumulate(t0AmpsA.begin(), t0AmpsA.end(), 0.f);
+      fitInfo.ampFT0C = std::accumulate(t0AmpsC.begin(), t0AmpsC.end(), 0.f);
+      fillAmplitudes(ft0s, mapGlobalBcWithT0A, cand.amplitudesT0A, cand.relBCsT0A, globalBC);
+    }
+    if (!mapGlobalBcWithV0A.empty()) {
+      uint64_t closestBcV0A = findClosestBC(globalBC, mapGlobalBcWithV0A);
+      int64_t distClosestBcV0A = globalBC - static_cast<int64_t>(closestBcV0A);
+      if (std::abs(distClosestBcV0A) <= fFilterFV0)
+        return false;
+      fitInfo.distClosestBcV0A = distClosestBcV0A;
+      auto fv0aId = mapGlobalBcWithV0A.at(closestBcV0A);
+      auto fv0a = fv0as.iteratorAt(fv0aId);
+      fitInfo.timeFV0A = fv0a.time();
+      const auto& v0Amps = fv0a.amplitude();
+      fitInfo.ampFV0A = std::accumulate(v0Amps.begin(), v0Amps.end(), 0.f);
+      fillAmplitudes(fv0as, mapGlobalBcWithV0A, cand.amplitudesV0A, cand.relBCsV0A, globalBC);
+    }
+    return true;
+  }
+
   template <typename T>
   void fillAmplitudes(const T& t,
                       const std::map<uint64_t, int32_t>& mapBCs,
@@ -1272,8 +1433,6 @@ struct UpcCandProducer {
       mapGlobalBcWithZdc[globalBC] = zdc.globalIndex();
     }
 
-    auto nFT0s = mapGlobalBcWithT0A.size();
-    auto nFV0As = mapGlobalBcWithV0A.size();
     auto nZdcs = mapGlobalBcWithZdc.size();
     auto nBcsWithMCH = bcsMatchedTrIdsMCH.size();
 
@@ -1289,13 +1448,16 @@ struct UpcCandProducer {
     // storing n-prong matches
     int32_t candID = 0;
 
-    for (auto& pair : bcsMatchedTrIdsMID) { // candidates without MFT
+    // the candidates are built first and then written, building is read-only on the track lists and the
+    // independent BC windows can thus be built in parallel
+    auto buildCandidate = [&](BCTracksPair& pair, FwdCandidate& cand) { // candidates without MFT
       auto globalBC = static_cast<int64_t>(pair.first);
       const auto& fwdTrackIDs = pair.second; // only MID-matched tracks at the moment
       int32_t nMIDs = fwdTrackIDs.size();
       if (nMIDs > fNFwdProngs) // too many tracks
-        continue;
-      std::vector<int64_t> trkCandIDs{};
+        return false;
+      auto& trkCandIDs = cand.trkCandIDs;
+      trkCandIDs.clear();
       if (nMIDs == fNFwdProngs) {
         trkCandIDs.insert(trkCandIDs.end(), fwdTrackIDs.begin(), fwdTrackIDs.end());
       }
@@ -1305,54 +1467,22 @@ struct UpcCandProducer {
         closestBcMCH = itClosestBcMCH->first;
         int64_t distClosestBcMCH = globalBC - static_cast<int64_t>(closestBcMCH);
         if (std::abs(distClosestBcMCH) > fBcWindowMCH)
-          continue;
+          return false;
         auto& mchTracks = itClosestBcMCH->second;
         int32_t nMCHs = mchTracks.size();
         if ((nMCHs + nMIDs) != fNFwdProngs)
-          continue;
+          return false;
         trkCandIDs.insert(trkCandIDs.end(), fwdTrackIDs.begin(), fwdTrackIDs.end());
         trkCandIDs.insert(trkCandIDs.end(), mchTracks.begin(), mchTracks.end());
       }
-      upchelpers::FITInfo fitInfo{};
-      fitInfo.timeFT0A = -999.f;
-      fitInfo.timeFT0C = -999.f;
-      fitInfo.timeFV0A = -999.f;
-      fitInfo.ampFT0A = 0.f;
-      fitInfo.ampFT0C = 0.f;
-      fitInfo.ampFV0A = 0.f;
-      std::vector<float> amplitudesT0A{};
-      std::vector<float> amplitudesV0A{};
-      std::vector<int8_t> relBCsT0A{};
-      std::vector<int8_t> relBCsV0A{};
-      if (nFT0s > 0) {
-        uint64_t closestBcT0A = findClosestBC(globalBC, mapGlobalBcWithT0A);
-        int64_t distClosestBcT0A = globalBC - static_cast<int64_t>(closestBcT0A);
-        if (std::abs(distClosestBcT0A) <= fFilterFT0)
-          continue;
-        fitInfo.distClosestBcT0A = distClosestBcT0A;
-        auto ft0Id = mapGlobalBcWithT0A.at(closestBcT0A);
-        auto ft0 = ft0s.iteratorAt(ft0Id);
-        fitInfo.timeFT0A = ft0.timeA();
-        fitInfo.timeFT0C = ft0.timeC();
-        const auto& t0AmpsA = ft0.amplitudeA();
-        const auto& t0AmpsC = ft0.amplitudeC();
-        fitInfo.ampFT0A = std::accumulate(t0AmpsA.begin(), t0AmpsA.end(), 0.f);
-        fitInfo.ampFT0C = std::accumulate(t0AmpsC.begin(), t0AmpsC.end(), 0.f);
-        fillAmplitudes(ft0s, mapGlobalBcWithT0A, amplitudesT0A, relBCsT0A, globalBC);
-      }
-      if (nFV0As > 0) {
-        uint64_t closestBcV0A = findClosestBC(globalBC, mapGlobalBcWithV0A);
-        int64_t distClosestBcV0A = globalBC - static_cast<int64_t>(closestBcV0A);
-        if (std::abs(distClosestBcV0A) <= fFilterFV0)
-          continue;
-        fitInfo.distClosestBcV0A = distClosestBcV0A;
-        auto fv0aId = mapGlobalBcWithV0A.at(closestBcV0A);
-        auto fv0a = fv0as.iteratorAt(fv0aId);
-        fitInfo.timeFV0A = fv0a.time();
-        const auto& v0Amps = fv0a.amplitude();
-        fitInfo.ampFV0A = std::accumulate(v0Amps.begin(), v0Amps.end(), 0.f);
-        fillAmplitudes(fv0as, mapGlobalBcWithV0A, amplitudesV0A, relBCsV0A, globalBC);
-      }
+      cand.globalBC = globalBC;
+      cand.closestBcMCH = closestBcMCH;
+      return fillFwdFITInfo(cand, mapGlobalBcWithT0A, mapGlobalBcWithV0A, ft0s, fv0as);
+    };
+
+    auto writeCandidate = [&](FwdCandidate& cand) {
+      auto globalBC = cand.globalBC;
+      const auto& fitInfo = cand.fitInfo;
       if (nZdcs > 0) {
         auto itZDC = mapGlobalBcWithZdc.find(globalBC);
         if (itZDC != mapGlobalBcWithZdc.end()) {
@@ -1367,13 +1497,13 @@ struct UpcCandProducer {
       uint16_t numContrib = fNFwdProngs;
       int8_t netCharge = 0;
       float RgtrwTOF = 0.;
-      for (auto id : trkCandIDs) {
+      for (auto id : cand.trkCandIDs) {
         auto tr = fwdTracks.iteratorAt(id);
         netCharge += tr.sign();
         selTrackIds.push_back(id);
       }
       // store used tracks
-      fillFwdTracks(fwdTracks, trkCandIDs, candID, globalBC, closestBcMCH, mcFwdTrackLabels);
+      fillFwdTracks(fwdTracks, cand.trkCandIDs, candID, globalBC, cand.closestBcMCH, mcFwdTrackLabels);
       eventCandidates(globalBC, runNumber, dummyX, dummyY, dummyZ, numContrib, netCharge, RgtrwTOF);
       eventCandidatesSels(fitInfo.ampFT0A, fitInfo.ampFT0C, fitInfo.timeFT0A, fitInfo.timeFT0C, fitInfo.triggerMaskFT0,
                           fitInfo.ampFDDA, fitInfo.ampFDDC, fitInfo.timeFDDA, fitInfo.timeFDDC, fitInfo.triggerMaskFDD,
@@ -1383,12 +1513,36 @@ struct UpcCandProducer {
                           fitInfo.BBFDDApf, fitInfo.BBFDDCpf, fitInfo.BGFDDApf, fitInfo.BGFDDCpf);
       eventCandidatesSelsFwd(fitInfo.distClosestBcV0A,
                              fitInfo.distClosestBcT0A,
-                             amplitudesT0A,
-                             relBCsT0A,
-                             amplitudesV0A,
-                             relBCsV0A);
+                             cand.amplitudesT0A,
+                             cand.relBCsT0A,
+                             cand.amplitudesV0A,
+                             cand.relBCsV0A);
       candID++;
-      trkCandIDs.clear();
+    };
+
+    if (fNThreads <= 1) {
+      FwdCandidate cand{};
+      for (auto& pair : bcsMatchedTrIdsMID) {
+        if (buildCandidate(pair, cand))
+          writeCandidate(cand);
+      }
+    } else {
+      // windows separated by more than the MID-MCH matching window, the candidates are written in BC order
+      auto windowStarts = splitInBCWindows({&bcsMatchedTrIdsMID}, std::max(static_cast<int>(fBcWindowMCH), 0), fNThreads);
+      auto ranges = getWindowRanges(windowStarts, bcsMatchedTrIdsMID);
+      size_t nWindows = windowStarts.size();
+      std::vector<std::vector<FwdCandidate>> cands(nWindows);
+      buildInBCWindows(nWindows, [&](size_t iw) {
+        FwdCandidate cand{};
+        for (size_t i = ranges[iw].first; i < ranges[iw].second; ++i) {
+          if (buildCandidate(bcsMatchedTrIdsMID[i], cand))
+            cands[iw].push_back(std::move(cand));
+        }
+      });
+      for (auto& windowCands : cands) {
+        for (auto& cand : windowCands)
+          writeCandidate(cand);
+      }
     }
 
     fillFwdClusters(selTrackIds, fwdTrkClusters);
@@ -1480,8 +1634,6 @@ struct UpcCandProducer {
       mapGlobalBcWithZdc[globalBC] = zdc.globalIndex();
     }
 
-    auto nFT0s = mapGlobalBcWithT0A.size();
-    auto nFV0As = mapGlobalBcWithV0A.size();
     auto nZdcs = mapGlobalBcWithZdc.size();
 
     // todo: calculate position of UD collision?
@@ -1496,58 +1648,27 @@ struct UpcCandProducer {
     // storing n-prong matches
     int32_t candID = 0;
 
-    for (auto& pair : bcsMatchedTrIdsGlobal) { // candidates with MFT
+    // the candidates are built first and then written, building is read-only on the track lists and the
+    // independent BC windows can thus be built in parallel
+    auto buildCandidate = [&](BCTracksPair& pair, FwdCandidate& cand) { // candidates with MFT
       auto globalBC = static_cast<int64_t>(pair.first);
       const auto& fwdTrackIDs = pair.second;
       int32_t nMFTs = fwdTrackIDs.size();
       if (nMFTs > fNFwdProngs) // too many tracks
-        continue;
-      std::vector<int64_t> trkCandIDs{};
-
+        return false;
+      auto& trkCandIDs = cand.trkCandIDs;
+      trkCandIDs.clear();
       if (nMFTs == fNFwdProngs) {
         trkCandIDs.insert(trkCandIDs.end(), fwdTrackIDs.begin(), fwdTrackIDs.end());
       }
-      uint64_t closestBcMCH = 0;
-      upchelpers::FITInfo fitInfo{};
-      fitInfo.timeFT0A = -999.f;
-      fitInfo.timeFT0C = -999.f;
-      fitInfo.timeFV0A = -999.f;
-      fitInfo.ampFT0A = 0.f;
-      fitInfo.ampFT0C = 0.f;
-      fitInfo.ampFV0A = 0.f;
-      std::vector<float> amplitudesT0A{};
-      std::vector<float> amplitudesV0A{};
-      std::vector<int8_t> relBCsT0A{};
-      std::vector<int8_t> relBCsV0A{};
-      if (nFT0s > 0) {
-        uint64_t closestBcT0A = findClosestBC(globalBC, mapGlobalBcWithT0A);
-        int64_t distClosestBcT0A = globalBC - static_cast<int64_t>(closestBcT0A);
-        if (std::abs(distClosestBcT0A) <= fFilterFT0)
-          continue;
-        fitInfo.distClosestBcT0A = distClosestBcT0A;
-        auto ft0Id = mapGlobalBcWithT0A.at(closestBcT0A);
-        auto ft0 = ft0s.iteratorAt(ft0Id);
-        fitInfo.timeFT0A = ft0.timeA();
-        fitInfo.timeFT0C = ft0.timeC();
-        const auto& t0AmpsA = ft0.amplitudeA();
-        const auto& t0AmpsC = ft0.amplitudeC();
-        fitInfo.ampFT0A = std::accumulate(t0AmpsA.begin(), t0AmpsA.end(), 0.f);
-        fitInfo.ampFT0C = std::accumulate(t0AmpsC.begin(), t0AmpsC.end(), 0.f);
-        fillAmplitudes(ft0s, mapGlobalBcWithT0A, amplitudesT0A, relBCsT0A, globalBC);
-      }
-      if (nFV0As > 0) {
-        uint64_t closestBcV0A = findClosestBC(globalBC, mapGlobalBcWithV0A);
-        int64_t distClosestBcV0A = globalBC - static_cast<int64_t>(closestBcV0A);
-        if (std::abs(distClosestBcV0A) <= fFilterFV0)
-          continue;
-        fitInfo.distClosestBcV0A = distClosestBcV0A;
-        auto fv0aId = mapGlobalBcWithV0A.at(closestBcV0A);
-        auto fv0a = fv0as.iteratorAt(fv0aId);
-        fitInfo.timeFV0A = fv0a.time();
-        const auto& v0Amps = fv0a.amplitude();
-        fitInfo.ampFV0A = std::accumulate(v0Amps.begin(), v0Amps.end(), 0.f);
-        fillAmplitudes(fv0as, mapGlobalBcWithV0A, amplitudesV0A, relBCsV0A, globalBC);
-      }
+      cand.globalBC = globalBC;
+      cand.closestBcMCH = 0;
+      return fillFwdFITInfo(cand, mapGlobalBcWithT0A, mapGlobalBcWithV0A, ft0s, fv0as);
+    };
+
+    auto writeCandidate = [&](FwdCandidate& cand) {
+      auto globalBC = cand.globalBC;
+      const auto& fitInfo = cand.fitInfo;
       if (nZdcs > 0) {
         auto itZDC = mapGlobalBcWithZdc.find(globalBC);
         if (itZDC != mapGlobalBcWithZdc.end()) {
@@ -1562,13 +1683,13 @@ struct UpcCandProducer {
       uint16_t numContrib = fNFwdProngs;
       int8_t netCharge = 0;
       float RgtrwTOF = 0.;
-      for (auto id : trkCandIDs) {
+      for (auto id : cand.trkCandIDs) {
         auto tr = fwdTracks.iteratorAt(id);
         netCharge += tr.sign();
         selTrackIdsGlobal.push_back(id);
       }
       // store used tracks
-      fillFwdTracks(fwdTracks, trkCandIDs, candID, globalBC, closestBcMCH, mcFwdTrackLabels);
+      fillFwdTracks(fwdTracks, cand.trkCandIDs, candID, globalBC, cand.closestBcMCH, mcFwdTrackLabels);
       eventCandidates(globalBC, runNumber, dummyX, dummyY, dummyZ, numContrib, netCharge, RgtrwTOF);
       eventCandidatesSels(fitInfo.ampFT0A, fitInfo.ampFT0C, fitInfo.timeFT0A, fitInfo.timeFT0C, fitInfo.triggerMaskFT0,
                           fitInfo.ampFDDA, fitInfo.ampFDDC, fitInfo.timeFDDA, fitInfo.timeFDDC, fitInfo.triggerMaskFDD,
@@ -1578,12 +1699,36 @@ struct UpcCandProducer {
                           fitInfo.BBFDDApf, fitInfo.BBFDDCpf, fitInfo.BGFDDApf, fitInfo.BGFDDCpf);
       eventCandidatesSelsFwd(fitInfo.distClosestBcV0A,
                              fitInfo.distClosestBcT0A,
-                             amplitudesT0A,
-                             relBCsT0A,
-                             amplitudesV0A,
-                             relBCsV0A);
+                             cand.amplitudesT0A,
+                             cand.relBCsT0A,
+                             cand.amplitudesV0A,
+                             cand.relBCsV0A);
       candID++;
-      trkCandIDs.clear();
+    };
+
+    if (fNThreads <= 1) {
+      FwdCandidate cand{};
+      for (auto& pair : bcsMatchedTrIdsGlobal) {
+        if (buildCandidate(pair, cand))
+          writeCandidate(cand);
+      }
+    } else {
+      // no matching between the BCs of the global tracks, the candidates are written in BC order
+      auto windowStarts = splitInBCWindows({&bcsMatchedTrIdsGlobal}, 0, fNThreads);
+      auto ranges = getWindowRanges(windowStarts, bcsMatchedTrIdsGlobal);
+      size_t nWindows = windowStarts.size();
+      std::vector<std::vector<FwdCandidate>> cands(nWindows);
+      buildInBCWindows(nWindows, [&](size_t iw) {
+        FwdCandidate cand{};
+        for (size_t i = ranges[iw].first; i < ranges[iw].second; ++i) {
+          if (buildCandidate(bcsMatchedTrIdsGlobal[i], cand))
+            cands[iw].push_back(std::move(cand));
+        }
+      });
+      for (auto& windowCands : cands) {
+        for (auto& cand : windowCands)
+          writeCandidate(cand);
+      }
     }
 
     selTrackIdsGlobal.clear();
@@ -23,10 +23,16 @@
 
 #include <TDatabasePDG.h> // FIXME
 
+#include <algorithm>
+#include <array>
+#include <vector>
+
 #include "KFParticle.h"
 #include "KFPTrack.h"
+#include "KFPTrackVector.h"
 #include "KFPVertex.h"
 #include "KFParticleBase.h"
+#include "KFParticleSIMD.h"
 #include "KFVertex.h"
 
 #include "Common/Core/RecoDecay.h"
@@ -105,6 +111,84 @@ KFPTrack createKFPTrackFromTrackParCov(const o2::track::TrackParametrizationWith
   return kfpTrack;
 }
 
+/// @brief Number of candidates processed at once by the KFParticleSIMD methods
+constexpr int KFParticleSimdWidth = sizeof(float_v) / sizeof(float);
+
+/// @brief Function to set one entry of a KFPTrackVector from o2::track::TrackParametrizationWithError tracks, without intermediate KFPTrack
+/// @param trackVector KFPTrackVector, resized to hold at least iTrack + 1 tracks
+/// @param iTrack Index of the entry
+/// @param trackparCov Track from o2::track::TrackParametrizationWithError
+/// @param trackId Track index, e.g. the global index of the track in the AO2D
+/// @param pdg PDG hypothesis of the track, -1 if none
+/// @param pvIndex Index of the primary vertex of the track, -1 if none
+inline void setKFPTrackVectorEntry(KFPTrackVector& trackVector, int iTrack,
+                                   const o2::track::TrackParametrizationWithError<float>& trackparCov,
+                                   int16_t trackSign, int trackId, int pdg = -1, int pvIndex = -1)
+{
+  std::array<float, 3> trkpos_par;
+  std::array<float, 3> trkmom_par;
+  std::array<float, 21> trk_cov;
+  trackparCov.getXYZGlo(trkpos_par);
+  trackparCov.getPxPyPzGlo(trkmom_par);
+  trackparCov.getCovXYZPxPyPzGlo(trk_cov);
+  for (int i = 0; i < 3; i++) {
+    trackVector.SetParameter(trkpos_par[i], i, iTrack);
+    trackVector.SetParameter(trkmom_par[i], i + 3, iTrack);
+  }
+  for (int i = 0; i < 21; i++) {
+    trackVector.SetCovariance(trk_cov[i], i, iTrack);
+  }
+  trackVector.SetQ(trackSign, iTrack);
+  trackVector.SetId(trackId, iTrack);
+  trackVector.SetPDG(pdg, iTrack);
+  trackVector.SetPVIndex(pvIndex, iTrack);
+}
+
+/// @brief Function to fill a KFPTrackVector with all the tracks of a table in the AO2Ds. The Covariance matrix is needed.
+/// The tracks are stored in the table order, with their global index as Id.
+/// @tparam T
+/// @param tracks Tracks from aod::Tracks, aod::TracksCov, or any table, slice or vector of such tracks
+/// @param trackVector KFPTrackVector to be filled
+template <typename T>
+void createKFPTrackVectorFromTracks(const T& tracks, KFPTrackVector& trackVector)
+{
+  trackVector.Resize(tracks.size());
+  int iTrack = 0;
+  for (const auto& track : tracks) {
+    setKFPTrackVectorEntry(trackVector, iTrack, getTrackParCov(track), track.sign(), track.globalIndex());
+    iTrack++;
+  }
+}
+
+/// @brief Function to construct the mothers of a batch of candidates with the SIMD vertex fit, KFParticleSimdWidth candidates at a time
+/// The empty slots of the last group are filled with copies of its first candidate and their results are discarded.
+/// @tparam NDaughters Number of daughters per candidate
+/// @param daughters Daughters of each candidate
+/// @param mothers Filled with the mother of each candidate, in the same order
+template <std::size_t NDaughters>
+void constructKFParticlesSIMD(std::vector<std::array<KFParticle, NDaughters>>& daughters, std::vector<KFParticle>& mothers)
+{
+  mothers.resize(daughters.size());
+  for (std::size_t iFirst = 0; iFirst < daughters.size(); iFirst += KFParticleSimdWidth) {
+    const int nCandidates = std::min<std::size_t>(KFParticleSimdWidth, daughters.size() - iFirst);
+    KFParticleSIMD daughtersSIMD[NDaughters];
+    const KFParticleSIMD* daughterPointers[NDaughters];
+    for (std::size_t iDaughter = 0; iDaughter < NDaughters; iDaughter++) {
+      KFParticle* particles[KFParticleSimdWidth];
+      for (int iCandidate = 0; iCandidate < KFParticleSimdWidth; iCandidate++) {
+        particles[iCandidate] = &daughters[iFirst + (iCandidate < nCandidates ? iCandidate : 0)][iDaughter];
+      }
+      daughtersSIMD[iDaughter] = KFParticleSIMD(particles, KFParticleSimdWidth);
+      daughterPointers[iDaughter] = &daughtersSIMD[iDaughter];
+    }
+    KFParticleSIMD motherSIMD;
+    motherSIMD.Construct(daughterPointers, NDaughters);
+    for (int iCandidate = 0; iCandidate < nCandidates; iCandidate++) {
+      motherSIMD.GetKFParticle(mothers[iFirst + iCandidate], iCandidate);
+    }
+  }
+}
+
 /// @brief Cosine of pointing angle from KFParticles
 /// @param kfp KFParticle
 /// @param PV KFParticle primary vertex
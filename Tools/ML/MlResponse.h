@@ -23,6 +23,8 @@
 #include <onnxruntime_cxx_api.h>
 #endif
 
+#include <algorithm>
+#include <cmath>
 #include <map>
 #include <string>
 #include <vector>
@@ -108,6 +110,13 @@ class MlResponse
       } else {
         LOG(fatal) << "Error encountered while accessing the ML model from " << pathsCCDB[iFile] << "! Maybe the ML model doesn't exist yet for this run number or timestamp?";
       }
+      // reduced-precision variant, flagged in the CCDB metadata and stored next to the FP32 model
+      if (mPrecision != o2::ml::ModelPrecision::FP32) {
+        std::map<std::string, std::string> metadataPrecision{{"precision", o2::ml::getModelPrecisionName(mPrecision)}};
+        if (!ccdbApi.retrieveBlob(pathsCCDB[iFile], ".", metadataPrecision, timestampCCDB, false, o2::ml::getModelPrecisionPath(onnxFiles[iFile], mPrecision))) {
+          LOGP(warning, "No {} ML model found in {}, the FP32 model will be used", o2::ml::getModelPrecisionName(mPrecision), pathsCCDB[iFile]);
+        }
+      }
     }
   }
 
@@ -121,16 +130,65 @@ class MlResponse
     mPaths = onnxFiles;
   }
 
+  /// Set the precision of the models, to be called before setting the model paths
+  /// \param precision is the precision of the models (FP16 and INT8 variants are stored with a suffix next to the FP32 models)
+  /// \param validate is a switch to keep the FP32 models as reference for validateModelPrecision
+  void setModelPrecision(o2::ml::ModelPrecision precision, bool validate = false)
+  {
+    mPrecision = precision;
+    mValidatePrecision = validate && precision != o2::ml::ModelPrecision::FP32;
+  }
+
   /// Initialize class instance (initialize OnnxModels)
   /// \param enableOptimizations is a switch to enable optimizations
   /// \param threads is the number of active threads
-  void init(bool enableOptimizations = false, int threads = 0)
+  /// \param shareSessions is a switch to share the ONNX sessions of identical models with the other instances in the process
+  void init(bool enableOptimizations = false, int threads = 0, bool shareSessions = false)
   {
     uint8_t counterModel{0};
     for (const auto& path : mPaths) {
-      mModels[counterModel].initModel(path, enableOptimizations, threads);
+      mModels[counterModel].initModel(path, enableOptimizations, threads, 0, 0, shareSessions, mPrecision);
       ++counterModel;
     }
+    if (mValidatePrecision) {
+      mReferenceModels = std::vector<o2::ml::OnnxModel>(mNModels);
+      for (auto iModel{0}; iModel < mNModels; ++iModel) {
+        if (mModels[iModel].getPrecision() != o2::ml::ModelPrecision::FP32) {
+          mReferenceModels[iModel].initModel(mPaths[iModel], enableOptimizations, threads, 0, 0, shareSessions);
+        }
+      }
+    }
+  }
+
+  /// Compare the scores of the reduced-precision models with the ones of the FP32 models on a reference sample
+  /// \param referenceInputs is a flat vector containing the features of the reference candidates, getNumInputNodes() consecutive values per candidate
+  /// \return maximum absolute deviation of the scores over all the models
+  /// \note The FP32 reference models are released afterwards
+  template <typename T1>
+  TypeOutputScore validateModelPrecision(T1& referenceInputs)
+  {
+    TypeOutputScore maxDeviation{0};
+    if (mReferenceModels.empty() || referenceInputs.empty()) {
+      LOG(warning) << "No reference models or candidates for the validation of the model precision";
+      return maxDeviation;
+    }
+    for (auto iModel{0}; iModel < mNModels; ++iModel) {
+      if (mModels[iModel].getPrecision() == o2::ml::ModelPrecision::FP32) {
+        continue;
+      }
+      const auto nCandidates = referenceInputs.size() / mModels[iModel].getNumInputNodes();
+      auto outputReduced = getModelOutputBatch(referenceInputs, iModel);
+      TypeOutputScore* outputReferencePtr = mReferenceModels[iModel].evalModel(referenceInputs);
+      std::vector<TypeOutputScore> outputReference{outputReferencePtr, outputReferencePtr + nCandidates * mNClasses};
+      TypeOutputScore maxDeviationModel{0};
+      for (std::size_t iScore{0}; iScore < outputReduced.size(); ++iScore) {
+        maxDeviationModel = std::max(maxDeviationModel, static_cast<TypeOutputScore>(std::abs(outputReduced[iScore] - outputReference[iScore])));
+      }
+      LOGP(info, "Model {} ({}): maximum deviation of the scores from the FP32 model on {} reference candidates = {}", iModel, o2::ml::getModelPrecisionName(mModels[iModel].getPrecision()), nCandidates, maxDeviationModel);
+      maxDeviation = std::max(maxDeviation, maxDeviationModel);
+    }
+    mReferenceModels.clear();
+    return maxDeviation;
   }
 
   /// Method to translate configurable input-feature strings into integers
@@ -171,20 +229,7 @@ class MlResponse
   {
     int nModel = findBin(candVar);
     auto output = getModelOutput(input, nModel);
-    uint8_t iClass{0};
-    for (const auto& outputValue : output) {
-      uint8_t dir = mCutDir.at(iClass);
-      if (dir != o2::cuts_ml::CutDirection::CutNot) {
-        if (dir == o2::cuts_ml::CutDirection::CutGreater && outputValue > mCuts.get(nModel, iClass)) {
-          return false;
-        }
-        if (dir == o2::cuts_ml::CutDirection::CutSmaller && outputValue < mCuts.get(nModel, iClass)) {
-          return false;
-        }
-      }
-      ++iClass;
-    }
-    return true;
+    return isSelectedByCuts(output.data(), nModel);
   }
 
   /// ML selections
@@ -197,36 +242,123 @@ class MlResponse
   {
     int nModel = findBin(candVar);
     output = getModelOutput(input, nModel);
-    uint8_t iClass{0};
-    for (const auto& outputValue : output) {
+    return isSelectedByCuts(output.data(), nModel);
+  }
+
+  /// Get model predictions for a batch of candidates evaluated with the same model
+  /// \param input is a flat vector containing the features of all candidates, getNumInputNodes() consecutive values per candidate
+  /// \param nModel is the model index
+  /// \return flat vector with the model predictions, mNClasses consecutive values per candidate
+  /// \note The whole batch is evaluated with a single call to the ONNX session
+  template <typename T1, typename T2>
+  std::vector<TypeOutputScore> getModelOutputBatch(T1& input, const T2& nModel)
+  {
+    if (nModel < 0 || static_cast<std::size_t>(nModel) >= mModels.size()) {
+      LOG(fatal) << "Model index " << nModel << " is out of range! The number of initialised models is " << mModels.size() << ". Please check your configurables.";
+    }
+
+    const std::size_t nFeatures = mModels[nModel].getNumInputNodes();
+    if (input.empty() || input.size() % nFeatures != 0) {
+      LOG(fatal) << "Size of the input batch (" << input.size() << ") is not a multiple of the number of model features (" << nFeatures << ")!";
+    }
+    const std::size_t nCandidates = input.size() / nFeatures;
+
+    TypeOutputScore* outputPtr = mModels[nModel].evalModel(input);
+    return std::vector<TypeOutputScore>{outputPtr, outputPtr + nCandidates * mNClasses};
+  }
+
+  /// ML selections for all the candidates of a dataframe
+  /// \param inputs is a flat vector containing the input features of all candidates, the same number of consecutive values per candidate
+  /// \param candVars is a vector with the variable values (e.g. pT) used to select which model to use, one per candidate
+  /// \param isSelected is filled with the selection decision of each candidate
+  /// \param outputs is filled with the model predictions, mNClasses consecutive values per candidate
+  /// \note Candidates are grouped per model and each model is evaluated once for the whole group.
+  ///       Candidates outside the bin limits are rejected and their scores are set to zero.
+  template <typename T1, typename T2>
+  void isSelectedMlBatch(std::vector<T1> const& inputs, std::vector<T2> const& candVars, std::vector<bool>& isSelected, std::vector<TypeOutputScore>& outputs)
+  {
+    const std::size_t nCandidates = candVars.size();
+    isSelected.assign(nCandidates, false);
+    outputs.assign(nCandidates * mNClasses, TypeOutputScore(0));
+    if (nCandidates == 0) {
+      return;
+    }
+    if (inputs.size() % nCandidates != 0) {
+      LOG(fatal) << "Size of the input batch (" << inputs.size() << ") is not a multiple of the number of candidates (" << nCandidates << ")!";
+    }
+    const std::size_t nFeatures = inputs.size() / nCandidates;
+
+    // group the candidates per model, keeping their original order within each group
+    mBatchCandidates.resize(mNModels);
+    for (auto& candidates : mBatchCandidates) {
+      candidates.clear();
+    }
+    for (std::size_t iCand{0}; iCand < nCandidates; ++iCand) {
+      int nModel = findBin(candVars[iCand]);
+      if (nModel >= 0) {
+        mBatchCandidates[nModel].push_back(iCand);
+      }
+    }
+
+    for (int iModel{0}; iModel < mNModels; ++iModel) {
+      const auto& candidates = mBatchCandidates[iModel];
+      if (candidates.empty()) {
+        continue;
+      }
+      mBatchFeatures.resize(candidates.size() * nFeatures);
+      auto itFeature = mBatchFeatures.begin();
+      for (const auto& iCand : candidates) {
+        itFeature = std::copy(inputs.begin() + iCand * nFeatures, inputs.begin() + (iCand + 1) * nFeatures, itFeature);
+      }
+      auto outputModel = getModelOutputBatch(mBatchFeatures, iModel);
+      for (std::size_t iBatch{0}; iBatch < candidates.size(); ++iBatch) {
+        const auto* scores = outputModel.data() + iBatch * mNClasses;
+        std::copy(scores, scores + mNClasses, outputs.begin() + candidates[iBatch] * mNClasses);
+        isSelected[candidates[iBatch]] = isSelectedByCuts(scores, iModel);
+      }
+    }
+  }
+
+ protected:
+  std::vector<o2::ml::OnnxModel> mModels;                           // OnnxModel objects, one for each bin
+  uint8_t mNModels = 1;                                             // number of bins
+  uint8_t mNClasses = 3;                                            // number of model classes
+  std::vector<double> mBinsLimits = {};                             // bin limits of the variable (e.g. pT) used to select which model to use
+  std::vector<std::string> mPaths = {""};                           // paths to the models, one for each bin
+  std::vector<int> mCutDir = {};                                    // direction of the cuts on the model scores (no cut is also supported)
+  o2::framework::LabeledArray<double> mCuts = {};                   // array of cut values to apply on the model scores
+  std::map<std::string, uint8_t> mAvailableInputFeatures;           // map of available input features
+  std::vector<uint8_t> mCachedIndices;                              // vector of index correspondance between configurables and available input features
+  o2::ml::ModelPrecision mPrecision = o2::ml::ModelPrecision::FP32; // requested precision of the models
+  bool mValidatePrecision = false;                                  // whether to keep the FP32 models as reference
+  std::vector<o2::ml::OnnxModel> mReferenceModels;                  // FP32 models used to validate the reduced-precision ones
+
+  virtual void setAvailableInputFeatures() { return; } // method to fill the map of available input features
+
+ private:
+  std::vector<TypeOutputScore> mBatchFeatures;            // buffer with the features of the candidates of a batch evaluated with the same model
+  std::vector<std::vector<std::size_t>> mBatchCandidates; // indices of the candidates of a batch, grouped per model
+
+  /// Applies the cuts of a given model to its predictions
+  /// \param scores is a pointer to mNClasses consecutive model predictions
+  /// \param nModel is the model index
+  /// \return boolean telling if model predictions pass the cuts
+  bool isSelectedByCuts(const TypeOutputScore* scores, int nModel)
+  {
+    for (uint8_t iClass{0}; iClass < mNClasses; ++iClass) {
       uint8_t dir = mCutDir.at(iClass);
       if (dir != o2::cuts_ml::CutDirection::CutNot) {
-        if (dir == o2::cuts_ml::CutDirection::CutGreater && outputValue > mCuts.get(nModel, iClass)) {
+        if (dir == o2::cuts_ml::CutDirection::CutGreater && scores[iClass] > mCuts.get(nModel, iClass)) {
           return false;
         }
-        if (dir == o2::cuts_ml::CutDirection::CutSmaller && outputValue < mCuts.get(nModel, iClass)) {
+        if (dir == o2::cuts_ml::CutDirection::CutSmaller && scores[iClass] < mCuts.get(nModel, iClass)) {
           return false;
         }
       }
-      ++iClass;
     }
     return true;
   }
 
- protected:
-  std::vector<o2::ml::OnnxModel> mModels;                 // OnnxModel objects, one for each bin
-  uint8_t mNModels = 1;                                   // number of bins
-  uint8_t mNClasses = 3;                                  // number of model classes
-  std::vector<double> mBinsLimits = {};                   // bin limits of the variable (e.g. pT) used to select which model to use
-  std::vector<std::string> mPaths = {""};                 // paths to the models, one for each bin
-  std::vector<int> mCutDir = {};                          // direction of the cuts on the model scores (no cut is also supported)
-  o2::framework::LabeledArray<double> mCuts = {};         // array of cut values to apply on the model scores
-  std::map<std::string, uint8_t> mAvailableInputFeatures; // map of available input features
-  std::vector<uint8_t> mCachedIndices;                    // vector of index correspondance between configurables and available input features
-
-  virtual void setAvailableInputFeatures() { return; } // method to fill the map of available input features
-
- private:
   /// Finds matching bin in mBinsLimits
   /// \param value e.g. pT
   /// \return index of the matching bin, used to access mModels
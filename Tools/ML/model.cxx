@@ -55,13 +55,26 @@ bool OnnxModel::checkHyperloop(bool verbose)
   return alienCoresFound;
 }
 
-void OnnxModel::initModel(std::string localPath, bool enableOptimizations, int threads, uint64_t from, uint64_t until)
+void OnnxModel::initModel(std::string localPath, bool enableOptimizations, int threads, uint64_t from, uint64_t until, bool shareSession, ModelPrecision precision)
 {
 
   assert(from <= until);
 
   LOG(info) << "--- ONNX-ML model ---";
   modelPath = localPath;
+  modelPrecision = ModelPrecision::FP32;
+
+  /// Reduced-precision variant, falling back to the FP32 model if not available
+  if (precision != ModelPrecision::FP32) {
+    std::string variantPath = getModelPrecisionPath(localPath, precision);
+    if (!gSystem->AccessPathName(variantPath.c_str())) {
+      modelPath = variantPath;
+      modelPrecision = precision;
+      LOGP(info, "Using {} model {}", getModelPrecisionName(precision), modelPath);
+    } else {
+      LOGP(warning, "No {} model found in {}, using the FP32 model {}", getModelPrecisionName(precision), variantPath, localPath);
+    }
+  }
   activeThreads = threads;
 
   /// Running on Hyperloop
@@ -74,12 +87,20 @@ void OnnxModel::initModel(std::string localPath, bool enableOptimizations, int t
     sessionOptions.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_EXTENDED);
   }
 
-  mEnv = std::make_shared<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "onnx-model");
+  sharedSession = shareSession;
+  if (sharedSession) {
+    /// Identical models share one session, all sessions share one environment and thread pool
+    sessionOptions.DisablePerSessionThreads();
+    mEnv = SessionRegistry::instance().getEnv(activeThreads);
+    mSession = SessionRegistry::instance().getSession(modelPath, enableOptimizations, activeThreads);
+  } else {
+    mEnv = std::make_shared<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "onnx-model");
 #if __has_include(<onnxruntime/core/session/onnxruntime_cxx_api.h>)
-  mSession = std::make_shared<Ort::Experimental::Session>(*mEnv, modelPath, sessionOptions);
+    mSession = std::make_shared<Ort::Experimental::Session>(*mEnv, modelPath, sessionOptions);
 #else
-  mSession = std::make_shared<Ort::Session>(*mEnv, modelPath.c_str(), sessionOptions);
+    mSession = std::make_shared<Ort::Session>(*mEnv, modelPath.c_str(), sessionOptions);
 #endif
+  }
 
 #if __has_include(<onnxruntime/core/session/onnxruntime_cxx_api.h>)
   mInputNames = mSession->GetInputNames();
@@ -101,6 +122,15 @@ void OnnxModel::initModel(std::string localPath, bool enableOptimizations, int t
     mOutputShapes.emplace_back(mSession->GetOutputTypeInfo(i).GetTensorTypeAndShapeInfo().GetShape());
   }
 #endif
+  mInputNamesChar.clear();
+  for (const auto& name : mInputNames) {
+    mInputNamesChar.push_back(name.c_str());
+  }
+  mOutputNamesChar.clear();
+  for (const auto& name : mOutputNames) {
+    mOutputNamesChar.push_back(name.c_str());
+  }
+
   LOG(info) << "Input Nodes:";
   for (size_t i = 0; i < mInputNames.size(); i++) {
     LOG(info) << "\t" << mInputNames[i] << " : " << printShape(mInputShapes[i]);
@@ -119,6 +149,30 @@ void OnnxModel::initModel(std::string localPath, bool enableOptimizations, int t
   LOG(info) << "--- Model initialized! ---";
 }
 
+void OnnxModel::bindTensors()
+{
+  if (!mSession || !mBoundInput || !mBoundOutput) {
+    return;
+  }
+  mIoBinding = std::make_unique<Ort::IoBinding>(*mSession);
+  mIoBinding->BindInput(mInputNamesChar[0], mBoundInput);
+  mIoBinding->BindOutput(mOutputNamesChar.back(), mBoundOutput);
+}
+
+bool OnnxModel::evalModelBound()
+{
+  if (!mIoBinding) {
+    LOG(fatal) << "No buffers bound to the model! Call bindBuffers() after initModel().";
+  }
+  try {
+    mSession->Run(mRunOptions, *mIoBinding);
+    return true;
+  } catch (const Ort::Exception& exception) {
+    LOG(error) << "Error running model inference: " << exception.what();
+  }
+  return false;
+}
+
 void OnnxModel::setActiveThreads(int threads)
 {
   activeThreads = threads;
@@ -35,6 +35,9 @@
 // ROOT includes
 #include "TSystem.h"
 
+// O2Physics includes
+#include "Tools/ML/sessionRegistry.h"
+
 // O2 includes
 #include "Framework/Logger.h"
 
@@ -44,6 +47,56 @@ namespace o2
 namespace ml
 {
 
+// Numerical precision of the model weights
+// Reduced-precision variants are expected to keep FP32 inputs and outputs and are stored next to the FP32 model
+// with a suffix before the extension, e.g. model.onnx -> model_fp16.onnx / model_int8.onnx
+enum class ModelPrecision : uint8_t {
+  FP32 = 0,
+  FP16,
+  INT8
+};
+
+// Suffix and CCDB metadata value identifying a model precision
+inline std::string getModelPrecisionName(ModelPrecision precision)
+{
+  switch (precision) {
+    case ModelPrecision::FP16:
+      return "fp16";
+    case ModelPrecision::INT8:
+      return "int8";
+    default:
+      return "fp32";
+  }
+}
+
+inline ModelPrecision getModelPrecisionFromName(const std::string& name)
+{
+  if (name == "fp16" || name == "FP16") {
+    return ModelPrecision::FP16;
+  }
+  if (name == "int8" || name == "INT8") {
+    return ModelPrecision::INT8;
+  }
+  if (!name.empty() && name != "fp32" && name != "FP32") {
+    LOG(fatal) << "Unknown model precision " << name << "! Available: fp32, fp16, int8.";
+  }
+  return ModelPrecision::FP32;
+}
+
+// Path of the variant of a model with a given precision
+inline std::string getModelPrecisionPath(const std::string& path, ModelPrecision precision)
+{
+  if (precision == ModelPrecision::FP32) {
+    return path;
+  }
+  std::string suffix = "_" + getModelPrecisionName(precision);
+  auto posExtension = path.rfind(".onnx");
+  if (posExtension == std::string::npos) {
+    return path + suffix;
+  }
+  return path.substr(0, posExtension) + suffix + path.substr(posExtension);
+}
+
 class OnnxModel
 {
 
@@ -52,7 +105,7 @@ class OnnxModel
   ~OnnxModel() = default;
 
   // Inferencing
-  void initModel(std::string, bool = false, int = 0, uint64_t = 0, uint64_t = 0);
+  void initModel(std::string, bool = false, int = 0, uint64_t = 0, uint64_t = 0, bool = false, ModelPrecision = ModelPrecision::FP32);
 
   // template methods -- best to define them in header
   template <typename T>
@@ -65,15 +118,7 @@ class OnnxModel
 #if __has_include(<onnxruntime/core/session/onnxruntime_cxx_api.h>)
       auto outputTensors = mSession->Run(mInputNames, input, mOutputNames);
 #else
-      Ort::RunOptions runOptions;
-      std::vector<const char*> inputNamesChar(mInputNames.size(), nullptr);
-      std::transform(std::begin(mInputNames), std::end(mInputNames), std::begin(inputNamesChar),
-                     [&](const std::string& str) { return str.c_str(); });
-
-      std::vector<const char*> outputNamesChar(mOutputNames.size(), nullptr);
-      std::transform(std::begin(mOutputNames), std::end(mOutputNames), std::begin(outputNamesChar),
-                     [&](const std::string& str) { return str.c_str(); });
-      auto outputTensors = mSession->Run(runOptions, inputNamesChar.data(), input.data(), input.size(), outputNamesChar.data(), outputNamesChar.size());
+      auto outputTensors = mSession->Run(mRunOptions, mInputNamesChar.data(), input.data(), input.size(), mOutputNamesChar.data(), mOutputNamesChar.size());
 #endif
       LOG(debug) << "Number of output tensors: " << outputTensors.size();
       if (outputTensors.size() != mOutputNames.size()) {
@@ -103,21 +148,48 @@ class OnnxModel
 #if __has_include(<onnxruntime/core/session/onnxruntime_cxx_api.h>)
     inputTensors.emplace_back(Ort::Experimental::Value::CreateTensor<T>(input.data(), size, inputShape));
 #else
-    Ort::MemoryInfo mem_info =
-      Ort::MemoryInfo::CreateCpu(OrtAllocatorType::OrtArenaAllocator, OrtMemType::OrtMemTypeDefault);
-    inputTensors.emplace_back(Ort::Value::CreateTensor<T>(mem_info, input.data(), size, inputShape.data(), inputShape.size()));
+    inputTensors.emplace_back(Ort::Value::CreateTensor<T>(mMemoryInfo, input.data(), size, inputShape.data(), inputShape.size()));
 #endif
     LOG(debug) << "Input shape calculated from vector: " << printShape(inputShape);
     return evalModel<T>(inputTensors);
   }
 
+  // IO-binding mode: input and output tensors are bound once to caller-owned buffers
+  // and each evaluation writes the scores of the last output node in place
+  template <typename T>
+  void bindBuffers(std::vector<T>& input, std::vector<T>& output)
+  {
+    int64_t nFeatures = mInputShapes[0][1];
+    int64_t nScores = mOutputShapes.back().back();
+    if (input.empty() || input.size() % nFeatures != 0) {
+      LOG(fatal) << "Size of the bound input buffer (" << input.size() << ") is not a multiple of the number of model features (" << nFeatures << ")!";
+    }
+    int64_t nRows = input.size() / nFeatures;
+    output.resize(nRows * nScores);
+    mBoundInputShape = {nRows, nFeatures};
+    mBoundOutputShape = {nRows, nScores};
+    mBoundInput = Ort::Value::CreateTensor<T>(mMemoryInfo, input.data(), input.size(), mBoundInputShape.data(), mBoundInputShape.size());
+    mBoundOutput = Ort::Value::CreateTensor<T>(mMemoryInfo, output.data(), output.size(), mBoundOutputShape.data(), mBoundOutputShape.size());
+    LOG(debug) << "Bound input shape: " << printShape(mBoundInputShape) << ", bound output shape: " << printShape(mBoundOutputShape);
+    bindTensors();
+  }
+
+  // Evaluate the model on the bound buffers, the scores are written to the bound output buffer
+  bool evalModelBound();
+  bool hasBoundBuffers() const { return mIoBinding != nullptr; }
+
   // Reset session
 #if __has_include(<onnxruntime/core/session/onnxruntime_cxx_api.h>)
-  void resetSession() { mSession.reset(new Ort::Experimental::Session{*mEnv, modelPath, sessionOptions}); }
+  void resetSession()
+  {
+    mSession.reset(new Ort::Experimental::Session{*mEnv, modelPath, sessionOptions});
+    bindTensors();
+  }
 #else
   void resetSession()
   {
     mSession.reset(new Ort::Session{*mEnv, modelPath.c_str(), sessionOptions});
+    bindTensors();
   }
 #endif
 
@@ -135,6 +207,8 @@ class OnnxModel
   int getNumOutputNodes() const { return mOutputShapes[0][1]; }
   uint64_t getValidityFrom() const { return validFrom; }
   uint64_t getValidityUntil() const { return validUntil; }
+  ModelPrecision getPrecision() const { return modelPrecision; }
+  const std::string& getModelPath() const { return modelPath; }
   void setActiveThreads(int);
 
  private:
@@ -152,16 +226,32 @@ class OnnxModel
   std::vector<std::vector<int64_t>> mInputShapes;
   std::vector<std::string> mOutputNames;
   std::vector<std::vector<int64_t>> mOutputShapes;
+  std::vector<const char*> mInputNamesChar;  // cached C-string views of mInputNames
+  std::vector<const char*> mOutputNamesChar; // cached C-string views of mOutputNames
+
+  // Persistent objects for the evaluation
+  Ort::RunOptions mRunOptions;
+  Ort::MemoryInfo mMemoryInfo = Ort::MemoryInfo::CreateCpu(OrtAllocatorType::OrtArenaAllocator, OrtMemType::OrtMemTypeDefault);
+
+  // IO binding to caller-owned buffers
+  std::unique_ptr<Ort::IoBinding> mIoBinding = nullptr;
+  Ort::Value mBoundInput{nullptr};
+  Ort::Value mBoundOutput{nullptr};
+  std::vector<int64_t> mBoundInputShape;
+  std::vector<int64_t> mBoundOutputShape;
 
   // Environment settings
   std::string modelPath;
   int activeThreads = 0;
+  bool sharedSession = false;                           // session and environment taken from the process-wide SessionRegistry
+  ModelPrecision modelPrecision = ModelPrecision::FP32; // precision of the loaded model
   uint64_t validFrom = 0;
   uint64_t validUntil = 0;
 
   // Internal function for printing the shape of tensors
   std::string printShape(const std::vector<int64_t>&);
   bool checkHyperloop(bool = true);
+  void bindTensors();
 };
 
 } // namespace ml
@@ -0,0 +1,112 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file     sessionRegistry.cxx
+///
+/// \brief    Process-wide registry sharing ONNX sessions between OnnxModel instances
+///
+
+#include "Tools/ML/sessionRegistry.h"
+
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <string>
+
+// O2 includes
+#include "Framework/Logger.h"
+
+namespace o2
+{
+
+namespace ml
+{
+
+SessionRegistry& SessionRegistry::instance()
+{
+  static SessionRegistry registry;
+  return registry;
+}
+
+std::shared_ptr<Ort::Env> SessionRegistry::getEnv(int threads)
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  if (!mEnv) {
+    Ort::ThreadingOptions threadingOptions;
+    threadingOptions.SetGlobalIntraOpNumThreads(threads);
+    threadingOptions.SetGlobalInterOpNumThreads(1);
+    mEnv = std::make_shared<Ort::Env>(threadingOptions, ORT_LOGGING_LEVEL_WARNING, "onnx-model-shared");
+    LOGP(info, "Created shared ONNX environment with a global pool of {} intra-op threads", threads);
+  }
+  return mEnv;
+}
+
+std::string SessionRegistry::getKey(const std::string& modelPath, bool enableOptimizations)
+{
+  std::ifstream file(modelPath, std::ios::binary);
+  if (!file) {
+    LOG(fatal) << "Cannot open ONNX model file " << modelPath;
+  }
+  std::string content{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+  return std::to_string(std::hash<std::string>{}(content)) + "_" + std::to_string(content.size()) + "_" + std::to_string(enableOptimizations);
+}
+
+std::shared_ptr<OnnxSession> SessionRegistry::getSession(const std::string& modelPath, bool enableOptimizations, int threads)
+{
+  auto env = getEnv(threads);
+  auto key = getKey(modelPath, enableOptimizations);
+
+  std::lock_guard<std::mutex> lock(mMutex);
+  auto& entry = mSessions[key];
+  if (auto session = entry.lock()) {
+    LOGP(info, "Reusing shared ONNX session for {}", modelPath);
+    return session;
+  }
+
+  Ort::SessionOptions sessionOptions;
+  sessionOptions.DisablePerSessionThreads(); // use the global thread pool of the shared environment
+  if (enableOptimizations) {
+    sessionOptions.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_EXTENDED);
+  }
+#if __has_include(<onnxruntime/core/session/onnxruntime_cxx_api.h>)
+  auto session = std::make_shared<OnnxSession>(*env, modelPath, sessionOptions);
+#else
+  auto session = std::make_shared<OnnxSession>(*env, modelPath.c_str(), sessionOptions);
+#endif
+  entry = session;
+
+  // drop the expired entries
+  for (auto it = mSessions.begin(); it != mSessions.end();) {
+    if (it->second.expired()) {
+      it = mSessions.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  return session;
+}
+
+std::size_t SessionRegistry::getNumSessions()
+{
+  std::lock_guard<std::mutex> lock(mMutex);
+  std::size_t nSessions = 0;
+  for (const auto& [key, session] : mSessions) {
+    if (!session.expired()) {
+      ++nSessions;
+    }
+  }
+  return nSessions;
+}
+
+} // namespace ml
+
+} // namespace o2
@@ -0,0 +1,82 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file     sessionRegistry.h
+///
+/// \brief    Process-wide registry sharing ONNX sessions between OnnxModel instances
+///
+
+#ifndef TOOLS_ML_SESSIONREGISTRY_H_
+#define TOOLS_ML_SESSIONREGISTRY_H_
+
+// C++ and system includes
+#if __has_include(<onnxruntime/core/session/onnxruntime_cxx_api.h>)
+#include <onnxruntime/core/session/experimental_onnxruntime_cxx_api.h>
+#else
+#include <onnxruntime_cxx_api.h>
+#endif
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace o2
+{
+
+namespace ml
+{
+
+#if __has_include(<onnxruntime/core/session/onnxruntime_cxx_api.h>)
+using OnnxSession = Ort::Experimental::Session;
+#else
+using OnnxSession = Ort::Session;
+#endif
+
+/// Sessions are de-duplicated by (hash of the model file, graph optimisation level)
+/// and are reference-counted: a session is destroyed when the last OnnxModel using it goes away.
+/// All the shared sessions run on one Ort::Env owning a global intra-op thread pool.
+class SessionRegistry
+{
+ public:
+  static SessionRegistry& instance();
+
+  /// Get the shared environment, creating it with a global thread pool at the first call
+  /// \param threads is the number of intra-op threads of the global pool (only used at creation)
+  std::shared_ptr<Ort::Env> getEnv(int threads);
+
+  /// Get a session for a given model, creating it if no other instance uses the same model
+  /// \param modelPath is the local path to the .onnx file
+  /// \param enableOptimizations is the switch for the graph optimisations
+  /// \param threads is the number of intra-op threads of the global pool
+  std::shared_ptr<OnnxSession> getSession(const std::string& modelPath, bool enableOptimizations, int threads);
+
+  /// Number of sessions currently alive in the registry
+  std::size_t getNumSessions();
+
+ private:
+  SessionRegistry() = default;
+  SessionRegistry(const SessionRegistry&) = delete;
+  SessionRegistry& operator=(const SessionRegistry&) = delete;
+
+  std::string getKey(const std::string& modelPath, bool enableOptimizations);
+
+  std::mutex mMutex;
+  std::shared_ptr<Ort::Env> mEnv = nullptr;
+  std::map<std::string, std::weak_ptr<OnnxSession>> mSessions; // key: model hash and session options
+};
+
+} // namespace ml
+
+} // namespace o2
+
+#endif // TOOLS_ML_SESSIONREGISTRY_H_
@@ -131,6 +131,23 @@ struct PidONNXModel {
     return getModelOutput(track) >= mMinCertainty;
   }
 
+  /// Evaluates the model on all the tracks of a table (or slice) with a single inference call
+  /// \return the certainty of each track, in the order of the table
+  template <typename T>
+  std::vector<float> applyModelBatch(const T& tracks)
+  {
+    return getModelOutputBatch(tracks);
+  }
+
+  template <typename T>
+  std::vector<bool> applyModelBooleanBatch(const T& tracks)
+  {
+    std::vector<float> certainties = getModelOutputBatch(tracks);
+    std::vector<bool> accepted(certainties.size());
+    std::transform(certainties.begin(), certainties.end(), accepted.begin(), [this](float certainty) { return certainty >= mMinCertainty; });
+    return accepted;
+  }
+
   PidMLDetector mDetector;
   int mPid;
   double mMinCertainty;
@@ -205,6 +222,14 @@ struct PidONNXModel {
 
   template <typename T>
   std::vector<float> createInputsSingle(const T& track)
+  {
+    std::vector<float> inputValues;
+    appendInputs(track, inputValues);
+    return inputValues;
+  }
+
+  template <typename T>
+  void appendInputs(const T& track, std::vector<float>& inputValues)
   {
     // TODO: Hardcoded for now. Planning to implement RowView extension to get runtime access to selected columns
     // sign is short, trackType and tpcNClsShared uint8_t
@@ -218,7 +243,7 @@ struct PidONNXModel {
 
     float scaledTPCSignal = (track.tpcSignal() - mScalingParams.at("fTPCSignal").first) / mScalingParams.at("fTPCSignal").second;
 
-    std::vector<float> inputValues{track.px(), track.py(), track.pz(), static_cast<float>(track.sign()), scaledX, scaledY, scaledZ, scaledAlpha, static_cast<float>(track.trackType()), scaledTPCNClsShared, scaledDcaXY, scaledDcaZ, track.p(), scaledTPCSignal};
+    inputValues.insert(inputValues.end(), {track.px(), track.py(), track.pz(), static_cast<float>(track.sign()), scaledX, scaledY, scaledZ, scaledAlpha, static_cast<float>(track.trackType()), scaledTPCNClsShared, scaledDcaXY, scaledDcaZ, track.p(), scaledTPCSignal});
 
     if (mDetector >= kTPCTOF) {
       float scaledTOFSignal = (track.tofSignal() - mScalingParams.at("fTOFSignal").first) / mScalingParams.at("fTOFSignal").second;
@@ -233,8 +258,6 @@ struct PidONNXModel {
       inputValues.push_back(scaledTRDSignal);
       inputValues.push_back(scaledTRDPattern);
     }
-
-    return inputValues;
   }
 
   // FIXME: Temporary solution, new networks will have sigmoid layer added
@@ -247,23 +270,64 @@ struct PidONNXModel {
   template <typename T>
   float getModelOutput(const T& track)
   {
-    auto input_shape = mInputShapes[0];
+    auto inputShape = mInputShapes[0];
+    inputShape[0] = 1;
     std::vector<float> inputTensorValues = createInputsSingle(track);
+    std::vector<float> certainties = runModel(inputTensorValues, inputShape);
+    return certainties.empty() ? false : certainties[0];
+  }
+
+  template <typename T>
+  std::vector<float> getModelOutputBatch(const T& tracks)
+  {
+    std::vector<float> certainties;
+    const int64_t nTracks = tracks.size();
+    if (nTracks == 0) {
+      return certainties;
+    }
+    if (mBatchSupported) {
+      auto inputShape = mInputShapes[0];
+      inputShape[0] = nTracks;
+      mBatchInputValues.clear();
+      mBatchInputValues.reserve(nTracks * inputShape.back());
+      for (const auto& track : tracks) {
+        appendInputs(track, mBatchInputValues);
+      }
+      certainties = runModel(mBatchInputValues, inputShape);
+      if (!certainties.empty()) {
+        return certainties;
+      }
+      // Models exported with a fixed batch dimension can only be evaluated track by track
+      LOG(warning) << "Batched inference failed, falling back to track-by-track evaluation";
+      mBatchSupported = false;
+    }
+    certainties.reserve(nTracks);
+    for (const auto& track : tracks) {
+      certainties.push_back(getModelOutput(track));
+    }
+    return certainties;
+  }
+
+  /// Runs the inference on N tracks stored row-wise in inputTensorValues
+  /// \return the certainty of each track, empty if the inference failed
+  std::vector<float> runModel(std::vector<float>& inputTensorValues, const std::vector<int64_t>& inputShape)
+  {
     std::vector<Ort::Value> inputTensors;
 #if __has_include(<onnxruntime/core/session/onnxruntime_cxx_api.h>)
-    inputTensors.emplace_back(Ort::Experimental::Value::CreateTensor<float>(inputTensorValues.data(), inputTensorValues.size(), input_shape));
+    inputTensors.emplace_back(Ort::Experimental::Value::CreateTensor<float>(inputTensorValues.data(), inputTensorValues.size(), inputShape));
 #else
     Ort::MemoryInfo mem_info =
       Ort::MemoryInfo::CreateCpu(OrtAllocatorType::OrtArenaAllocator, OrtMemType::OrtMemTypeDefault);
-    inputTensors.emplace_back(Ort::Value::CreateTensor<float>(mem_info, inputTensorValues.data(), inputTensorValues.size(), input_shape.data(), input_shape.size()));
+    inputTensors.emplace_back(Ort::Value::CreateTensor<float>(mem_info, inputTensorValues.data(), inputTensorValues.size(), inputShape.data(), inputShape.size()));
 
 #endif
 
     // Double-check the dimensions of the input tensor
     assert(inputTensors[0].IsTensor() &&
-           inputTensors[0].GetTensorTypeAndShapeInfo().GetShape() == input_shape);
+           inputTensors[0].GetTensorTypeAndShapeInfo().GetShape() == inputShape);
     LOG(debug) << "input tensor shape: " << printShape(inputTensors[0].GetTensorTypeAndShapeInfo().GetShape());
 
+    std::vector<float> certainties;
     try {
 #if __has_include(<onnxruntime/core/session/onnxruntime_cxx_api.h>)
       auto outputTensors = mSession->Run(mInputNames, inputTensors, mOutputNames);
@@ -284,13 +348,17 @@ struct PidONNXModel {
       assert(outputTensors.size() == mOutputNames.size() && outputTensors[0].IsTensor());
       LOG(debug) << "output tensor shape: " << printShape(outputTensors[0].GetTensorTypeAndShapeInfo().GetShape());
 
+      // One output value per track
       const float* output_value = outputTensors[0].GetTensorData<float>();
-      float certainty = sigmoid(*output_value); // FIXME: Temporary, sigmoid will be added as network layer
-      return certainty;
+      const int64_t nTracks = inputShape[0];
+      certainties.resize(nTracks);
+      for (int64_t i = 0; i < nTracks; i++) {
+        certainties[i] = sigmoid(output_value[i]); // FIXME: Temporary, sigmoid will be added as network layer
+      }
     } catch (const Ort::Exception& exception) {
       LOG(error) << "Error running model inference: " << exception.what();
     }
-    return false; // unreachable code
+    return certainties;
   }
 
   // Pretty prints a shape dimension vector
@@ -318,6 +386,9 @@ struct PidONNXModel {
   std::vector<std::vector<int64_t>> mInputShapes;
   std::vector<std::string> mOutputNames;
   std::vector<std::vector<int64_t>> mOutputShapes;
+
+  std::vector<float> mBatchInputValues; // Input values of all the tracks of a batch, reused across batches
+  bool mBatchSupported = true;          // Whether the model accepts a batch dimension larger than 1
 };
 
 #endif // TOOLS_PIDML_PIDONNXMODEL_H_
@@ -22,6 +22,7 @@
 #include "Tools/PIDML/pidOnnxModel.h"
 
 #include <string>
+#include <vector>
 
 using namespace o2;
 using namespace o2::framework;
@@ -80,22 +81,26 @@ struct SimpleApplyOnnxModel {
       pidModel = PidONNXModel(cfgPathLocal.value, cfgPathCCDB.value, cfgUseCCDB.value, ccdbApi, timestamp, cfgPid.value, static_cast<PidMLDetector>(cfgDetector.value), cfgCertainty.value);
     }
 
+    std::vector<bool> accepted = pidModel.applyModelBooleanBatch(tracks);
+    size_t iTrack = 0;
     for (auto& track : tracks) {
-      bool accepted = pidModel.applyModelBoolean(track);
       LOGF(info, "collision id: %d track id: %d accepted: %d p: %.3f; x: %.3f, y: %.3f, z: %.3f",
-           track.collisionId(), track.index(), accepted, track.p(), track.x(), track.y(), track.z());
-      pidMLResults(track.index(), cfgPid.value, accepted);
+           track.collisionId(), track.index(), static_cast<bool>(accepted[iTrack]), track.p(), track.x(), track.y(), track.z());
+      pidMLResults(track.index(), cfgPid.value, accepted[iTrack]);
+      iTrack++;
     }
   }
   PROCESS_SWITCH(SimpleApplyOnnxModel, processCollisions, "Process with collisions and bcs for CCDB", true);
 
   void processTracksOnly(BigTracks const& tracks)
   {
+    std::vector<bool> accepted = pidModel.applyModelBooleanBatch(tracks);
+    size_t iTrack = 0;
     for (auto& track : tracks) {
-      bool accepted = pidModel.applyModelBoolean(track);
       LOGF(info, "collision id: %d track id: %d accepted: %d p: %.3f; x: %.3f, y: %.3f, z: %.3f",
-           track.collisionId(), track.index(), accepted, track.p(), track.x(), track.y(), track.z());
-      pidMLResults(track.index(), cfgPid.value, accepted);
+           track.collisionId(), track.index(), static_cast<bool>(accepted[iTrack]), track.p(), track.x(), track.y(), track.z());
+      pidMLResults(track.index(), cfgPid.value, accepted[iTrack]);
+      iTrack++;
     }
   }
   PROCESS_SWITCH(SimpleApplyOnnxModel, processTracksOnly, "Process with tracks only -- faster but no CCDB", false);